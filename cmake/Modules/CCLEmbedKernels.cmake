@@ -0,0 +1,109 @@
+# - Embed prebuilt OpenCL kernel binaries into executables
+#
+# This module provides the ccl_embed_kernels() function, which runs the
+# cf4ocl ccl_c utility at build time to build OpenCL kernel sources for the
+# given target devices, and generates C sources embedding the resulting
+# binaries, optional IL and the sources themselves:
+#
+#  ccl_embed_kernels(<var> NAME <name> SOURCES <file>...
+#      [DEVICES <index>...] [OPTIONS <string>] [IL <file>] [CCL_C <exe>])
+#
+#  <var>      - Variable set to the generated files, to be added to the
+#               sources of an executable or library.
+#  NAME       - Prefix of the generated C symbols and files.
+#  SOURCES    - OpenCL C source files, concatenated in the given order.
+#  DEVICES    - Indexes of the devices (as listed by `ccl_c -l`) for which
+#               to build binaries. Devices for which the build fails are
+#               skipped with a warning. If not given, only the IL and the
+#               sources are embedded.
+#  OPTIONS    - Build options, which should also be passed at runtime.
+#  IL         - Intermediate language (e.g. SPIR-V) file to embed.
+#  CCL_C      - The ccl_c executable. If not given, the ccl_c target is used
+#               when building within the cf4ocl tree, otherwise ccl_c is
+#               searched for in the system.
+#
+# The <name>_embedded.h header is generated in the current binary directory,
+# which is added to the include directories. It declares:
+#
+#  <name>_embedded     - Table of CCLProgramEmbedded entries.
+#  <name>_num_embedded - Number of entries in <name>_embedded.
+#  <name>_src          - Null-terminated concatenated sources.
+#
+# These can be directly passed to ccl_program_new_from_embedded(), which
+# picks the binary matching the context devices and falls back to IL and
+# source if none matches. Example:
+#
+#  ccl_embed_kernels(SUM_EMBEDDED NAME sum SOURCES sum.cl DEVICES 0 1)
+#  add_executable(sum sum.c ${SUM_EMBEDDED})
+#  target_link_libraries(sum cf4ocl2)
+
+include(CMakeParseArguments)
+
+# Location of the generator script, which is run with cmake -P
+set(CCL_EMBED_KERNELS_GEN ${CMAKE_CURRENT_LIST_DIR}/CCLEmbedKernelsGen.cmake)
+
+function(ccl_embed_kernels OUT_VAR)
+
+    # Parse arguments
+    cmake_parse_arguments(CEK "" "NAME;OPTIONS;IL;CCL_C" "SOURCES;DEVICES"
+        ${ARGN})
+    if (NOT CEK_NAME OR NOT CEK_SOURCES)
+        message(FATAL_ERROR "ccl_embed_kernels: NAME and SOURCES are required")
+    endif()
+
+    # Determine ccl_c executable and dependencies
+    set(CEK_DEPENDS "")
+    if (CEK_CCL_C)
+        set(CEK_EXE ${CEK_CCL_C})
+    elseif (TARGET ccl_c)
+        set(CEK_EXE $<TARGET_FILE:ccl_c>)
+        set(CEK_DEPENDS ccl_c)
+    elseif (CEK_DEVICES)
+        find_program(CCL_C_EXECUTABLE ccl_c)
+        if (NOT CCL_C_EXECUTABLE)
+            message(FATAL_ERROR "ccl_embed_kernels: ccl_c not found")
+        endif()
+        set(CEK_EXE ${CCL_C_EXECUTABLE})
+    endif()
+
+    # Absolute paths of inputs
+    set(CEK_SOURCES_ABS "")
+    foreach(SRC ${CEK_SOURCES})
+        get_filename_component(SRC_ABS ${SRC} ABSOLUTE)
+        list(APPEND CEK_SOURCES_ABS ${SRC_ABS})
+    endforeach()
+    if (CEK_IL)
+        get_filename_component(CEK_IL ${CEK_IL} ABSOLUTE)
+    endif()
+
+    # Lists are passed to the generator script separated by pipes
+    string(REPLACE ";" "|" CEK_SOURCES_ARG "${CEK_SOURCES_ABS}")
+    string(REPLACE ";" "|" CEK_DEVICES_ARG "${CEK_DEVICES}")
+
+    # Generated files
+    set(CEK_OUT_DIR ${CMAKE_CURRENT_BINARY_DIR})
+    set(CEK_OUT_C ${CEK_OUT_DIR}/${CEK_NAME}_embedded.c)
+    set(CEK_OUT_H ${CEK_OUT_DIR}/${CEK_NAME}_embedded.h)
+
+    # Build binaries and generate C files at build time
+    add_custom_command(
+        OUTPUT ${CEK_OUT_C} ${CEK_OUT_H}
+        COMMAND ${CMAKE_COMMAND}
+            "-DCCL_C=${CEK_EXE}"
+            "-DNAME=${CEK_NAME}"
+            "-DSOURCES=${CEK_SOURCES_ARG}"
+            "-DDEVICES=${CEK_DEVICES_ARG}"
+            "-DOPTIONS=${CEK_OPTIONS}"
+            "-DIL=${CEK_IL}"
+            "-DOUT_DIR=${CEK_OUT_DIR}"
+            -P ${CCL_EMBED_KERNELS_GEN}
+        DEPENDS ${CEK_SOURCES_ABS} ${CEK_IL} ${CEK_DEPENDS}
+            ${CCL_EMBED_KERNELS_GEN}
+        COMMENT "Embedding OpenCL kernels ${CEK_NAME}"
+        VERBATIM)
+
+    # Return generated files and make the header visible
+    include_directories(${CEK_OUT_DIR})
+    set(${OUT_VAR} ${CEK_OUT_C} ${CEK_OUT_H} PARENT_SCOPE)
+
+endfunction()
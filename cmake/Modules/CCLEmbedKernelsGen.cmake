@@ -0,0 +1,143 @@
+# - Generator script for the ccl_embed_kernels() function
+#
+# Run at build time with cmake -P, with the following variables defined:
+#
+#  CCL_C   - The ccl_c executable.
+#  NAME    - Prefix of the generated C symbols and files.
+#  SOURCES - Pipe-separated list of OpenCL C source files.
+#  DEVICES - Pipe-separated list of device indexes.
+#  OPTIONS - Build options.
+#  IL      - Intermediate language file to embed (may be empty).
+#  OUT_DIR - Output directory for the generated files.
+
+# Convert the contents of a file into a comma-separated list of C hex bytes
+function(ccl_embed_hex FILE OUT_VAR)
+    file(READ ${FILE} HEX_RAW HEX)
+    string(REGEX REPLACE "(..)" "0x\\1, " HEX_C "${HEX_RAW}")
+    set(${OUT_VAR} "${HEX_C}" PARENT_SCOPE)
+endfunction()
+
+# Escape a string to be used as a C string literal
+function(ccl_embed_cstr STR OUT_VAR)
+    string(REPLACE "\\" "\\\\" STR_C "${STR}")
+    string(REPLACE "\"" "\\\"" STR_C "${STR_C}")
+    set(${OUT_VAR} "\"${STR_C}\"" PARENT_SCOPE)
+endfunction()
+
+string(REPLACE "|" ";" SOURCES "${SOURCES}")
+string(REPLACE "|" ";" DEVICES "${DEVICES}")
+
+set(OUT_C ${OUT_DIR}/${NAME}_embedded.c)
+set(OUT_H ${OUT_DIR}/${NAME}_embedded.h)
+set(BIN_DIR ${OUT_DIR}/${NAME}_embedded)
+file(MAKE_DIRECTORY ${BIN_DIR})
+
+# Device and platform names, as listed by ccl_c
+if (DEVICES)
+    execute_process(COMMAND ${CCL_C} -l
+        OUTPUT_VARIABLE DEV_LIST
+        RESULT_VARIABLE DEV_LIST_RES)
+    if (NOT DEV_LIST_RES EQUAL 0)
+        message(WARNING "Unable to list devices with ${CCL_C}, no binaries "
+            "will be embedded for ${NAME}")
+        set(DEVICES "")
+    endif()
+    string(REPLACE "\n" ";" DEV_LIST "${DEV_LIST}")
+endif()
+
+# ccl_c source and options arguments
+set(SRC_ARGS "")
+foreach(SRC ${SOURCES})
+    list(APPEND SRC_ARGS -s ${SRC})
+endforeach()
+set(OPT_ARGS "")
+if (OPTIONS)
+    set(OPT_ARGS -0 "${OPTIONS}")
+endif()
+
+# Build binaries, one per device
+set(DATA_DEFS "")
+set(ENTRIES "")
+set(NUM_ENTRIES 0)
+foreach(DEV ${DEVICES})
+
+    # Find device and platform names
+    set(DEV_NAME "")
+    foreach(LINE ${DEV_LIST})
+        if ("${LINE}" MATCHES "^${DEV}\\. (.*) \\[([^]]*)\\]$")
+            set(DEV_NAME "${CMAKE_MATCH_1}")
+            set(PLATF_NAME "${CMAKE_MATCH_2}")
+        endif()
+    endforeach()
+
+    # Build binary for device
+    set(BIN_FILE ${BIN_DIR}/dev${DEV}.bin)
+    file(REMOVE ${BIN_FILE})
+    if ("${DEV_NAME}" STREQUAL "")
+        message(WARNING "Device ${DEV} not found, skipping")
+    else()
+        execute_process(
+            COMMAND ${CCL_C} -d ${DEV} ${SRC_ARGS} ${OPT_ARGS} -o ${BIN_FILE}
+            OUTPUT_QUIET ERROR_QUIET
+            RESULT_VARIABLE BUILD_RES)
+        if (NOT BUILD_RES EQUAL 0 OR NOT EXISTS ${BIN_FILE})
+            message(WARNING "Unable to build ${NAME} for device ${DEV} "
+                "(${DEV_NAME}), skipping")
+        endif()
+    endif()
+
+    # Embed binary, if it was built
+    if (EXISTS ${BIN_FILE})
+        ccl_embed_hex(${BIN_FILE} BIN_HEX)
+        ccl_embed_cstr("${DEV_NAME}" DEV_NAME_C)
+        ccl_embed_cstr("${PLATF_NAME}" PLATF_NAME_C)
+        set(DATA_DEFS "${DATA_DEFS}static const unsigned char ${NAME}_bin${DEV}[] = { ${BIN_HEX}};\n")
+        set(ENTRIES "${ENTRIES}    { ${DEV_NAME_C}, ${PLATF_NAME_C}, ${NAME}_bin${DEV}, sizeof(${NAME}_bin${DEV}), CL_FALSE },\n")
+        math(EXPR NUM_ENTRIES "${NUM_ENTRIES} + 1")
+    endif()
+
+endforeach()
+
+# Embed IL, if given
+if (IL)
+    ccl_embed_hex(${IL} IL_HEX)
+    set(DATA_DEFS "${DATA_DEFS}static const unsigned char ${NAME}_il[] = { ${IL_HEX}};\n")
+    set(ENTRIES "${ENTRIES}    { NULL, NULL, ${NAME}_il, sizeof(${NAME}_il), CL_TRUE },\n")
+    math(EXPR NUM_ENTRIES "${NUM_ENTRIES} + 1")
+endif()
+
+# Arrays can't be empty in C
+if (NUM_ENTRIES EQUAL 0)
+    set(ENTRIES "    { NULL, NULL, NULL, 0, CL_FALSE },\n")
+endif()
+
+# Embed concatenated sources as a string literal of hex escapes, split in
+# one literal per source line to keep literals within compiler limits
+set(SRC_ESC "")
+foreach(SRC ${SOURCES})
+    file(READ ${SRC} HEX HEX)
+    set(SRC_ESC "${SRC_ESC}${HEX}0a")
+endforeach()
+string(REGEX REPLACE "(..)" "\\\\x\\1" SRC_ESC "${SRC_ESC}")
+string(REPLACE "\\x0a" "\\x0a\"\n    \"" SRC_ESC "${SRC_ESC}")
+
+# Generate header
+file(WRITE ${OUT_H}
+"/* Generated by ccl_embed_kernels(), do not edit. */\n\n"
+"#ifndef _${NAME}_EMBEDDED_H_\n"
+"#define _${NAME}_EMBEDDED_H_\n\n"
+"#include <cf4ocl2.h>\n\n"
+"extern const CCLProgramEmbedded ${NAME}_embedded[];\n"
+"extern const cl_uint ${NAME}_num_embedded;\n"
+"extern const char ${NAME}_src[];\n\n"
+"#endif\n")
+
+# Generate source
+file(WRITE ${OUT_C}
+"/* Generated by ccl_embed_kernels(), do not edit. */\n\n"
+"#include \"${NAME}_embedded.h\"\n\n"
+"${DATA_DEFS}\n"
+"const CCLProgramEmbedded ${NAME}_embedded[] = {\n"
+"${ENTRIES}};\n\n"
+"const cl_uint ${NAME}_num_embedded = ${NUM_ENTRIES};\n\n"
+"const char ${NAME}_src[] =\n    \"${SRC_ESC}\";\n")
@@ -34,6 +34,19 @@
  * Life, in OpenCL using _cf4ocl_. It demonstrates the use of double-buffering
  * with images, multiple command queues and profiling.
  *
+ * It also demonstrates a producer/consumer frame pipeline which keeps the
+ * device busy while frames are saved:
+ *
+ * * Iterations and reads are ordered with device-side event dependencies
+ *   between the execution and communication queues, so the host never waits
+ *   for an iteration to finish.
+ * * Each generation is read, without blocking, into one of a ring of pinned
+ *   host buffers, i.e. buffers allocated with `CL_MEM_ALLOC_HOST_PTR` and
+ *   kept mapped during the simulation.
+ * * Writer threads wait for each read to complete, encode the frame as PNG
+ *   and return the ring slot. The host only blocks when all ring slots are
+ *   waiting to be encoded.
+ *
  * The program accepts two command-line arguments:
  *
  * 1. Device index
@@ -75,6 +88,81 @@
 #define CA_HEIGHT 128
 #define CA_ITERS 64
 
+/* Frame pipeline settings. */
+#define CA_RING_SIZE 4
+#define CA_NUM_WRITERS 2
+
+/* Size of one frame in bytes. */
+#define CA_FRAME_SIZE (CA_WIDTH * CA_HEIGHT * sizeof(cl_uchar4))
+
+/**
+ * A frame being read from the device into a ring slot.
+ * */
+typedef struct {
+    /* Iteration, used for the image filename. */
+    cl_uint iter;
+    /* Ring slot, returned to the ring when the frame is saved. */
+    cl_uint slot;
+    /* Host memory of ring slot. */
+    cl_uchar4 * pixels;
+    /* Event of read command, frame can only be saved after it completes. */
+    CCLEvent * evt_read;
+} CAFrame;
+
+/**
+ * State shared between main thread and writer threads.
+ * */
+typedef struct {
+    /* Frames to save, a frame with NULL pixels stops a writer. */
+    GAsyncQueue * frames;
+    /* Ring slots available for reading, stored as slot index plus one. */
+    GAsyncQueue * free_slots;
+    /* Number of frames which could not be saved. */
+    gint failures;
+} CAPipeline;
+
+/**
+ * Writer thread, waits for frames to be read and saves them as PNG images.
+ * */
+static gpointer ca_writer(gpointer data) {
+
+    CAPipeline * pipeline = (CAPipeline *) data;
+    CAFrame * frame;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    char filename[sizeof(IMAGE_FILE_PREFIX ".png") + IMAGE_FILE_NUM_DIGITS];
+    int file_write_status;
+
+    while ((frame = (CAFrame *) g_async_queue_pop(pipeline->frames))->pixels
+        != NULL) {
+
+        /* Wait for frame to be read into the ring slot. */
+        ccl_event_wait(ccl_ewl(&ewl, frame->evt_read, NULL), &err);
+        if (err != NULL) {
+            fprintf(stderr, "\n%s\n", err->message);
+            g_clear_error(&err);
+            g_atomic_int_inc(&pipeline->failures);
+        } else {
+
+            /* Determine filename and save image. */
+            sprintf(filename,
+                "%s%0" G_STRINGIFY(IMAGE_FILE_NUM_DIGITS) "d.png",
+                IMAGE_FILE_PREFIX, frame->iter);
+            file_write_status = stbi_write_png(filename, CA_WIDTH,
+                CA_HEIGHT, 4, frame->pixels, CA_WIDTH * sizeof(cl_uchar4));
+            if (!file_write_status) g_atomic_int_inc(&pipeline->failures);
+        }
+
+        /* Return ring slot. */
+        g_async_queue_push(
+            pipeline->free_slots, GUINT_TO_POINTER(frame->slot + 1));
+        g_slice_free(CAFrame, frame);
+    }
+
+    g_slice_free(CAFrame, frame);
+    return NULL;
+}
+
 /**
  * Cellular automata sample main function.
  * */
@@ -90,14 +178,20 @@ int main(int argc, char * argv[]) {
     CCLQueue * queue_comm;
     CCLProgram * prg;
     CCLKernel * krnl;
-    CCLEvent * evt_comm;
-    CCLEvent * evt_exec;
+    CCLEvent * evt_comm = NULL;
+    CCLEvent * evt_exec = NULL;
+    CCLEvent * evt_read_prev;
+    CCLBuffer * ring[CA_RING_SIZE];
     /* Other variables. */
     CCLEventWaitList ewl = NULL;
     /* Profiler object. */
     CCLProf * prof;
-    /* Output images filename. */
-    char * filename;
+    /* Frame pipeline. */
+    CAPipeline pipeline;
+    CAFrame * frame;
+    GThread * writers[CA_NUM_WRITERS];
+    cl_uchar4 * ring_pixels[CA_RING_SIZE];
+    cl_uint slot;
     /* Selected device, may be given in command line. */
     int dev_idx = -1;
     /* Error handling object (must be NULL). */
@@ -106,12 +200,8 @@ int main(int argc, char * argv[]) {
     cl_bool image_ok;
     /* Initial sim state. */
     cl_uchar4 * input_image;
-    /* Simulation states. */
-    cl_uchar4 ** output_images;
     /* RNG seed, may be given in command line. */
     unsigned int seed;
-    /* Image file write status. */
-    int file_write_status;
     /* Image format. */
     cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
     /* Origin of sim space. */
@@ -147,13 +237,6 @@ int main(int argc, char * argv[]) {
         input_image[i] = (cl_uchar4) {{ state, state, state, 0xFF }};
     }
 
-    /* Allocate space for simulation results. */
-    output_images = (cl_uchar4 **)
-        malloc((CA_ITERS + 1) * sizeof(cl_uchar4 *));
-    for (cl_uint i = 0; i < CA_ITERS + 1; ++i)
-        output_images[i] = (cl_uchar4 *)
-            malloc(CA_WIDTH * CA_HEIGHT * sizeof(cl_uchar4));
-
     /* Create context using device selected from menu. */
     ctx = ccl_context_new_from_menu_full(&dev_idx, &err);
     HANDLE_ERROR(err);
@@ -211,6 +294,28 @@ int main(int argc, char * argv[]) {
     printf("\n * Global work-size: (%d, %d)\n", (int) gws[0], (int) gws[1]);
     printf(" * Local work-size: (%d, %d)\n", (int) lws[0], (int) lws[1]);
 
+    /* Create ring of pinned host buffers, which are kept mapped while the
+     * simulation runs. */
+    for (cl_uint i = 0; i < CA_RING_SIZE; ++i) {
+        ring[i] = ccl_buffer_new(ctx,
+            CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, CA_FRAME_SIZE,
+            NULL, &err);
+        HANDLE_ERROR(err);
+        ring_pixels[i] = (cl_uchar4 *) ccl_buffer_enqueue_map(ring[i],
+            queue_comm, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+            CA_FRAME_SIZE, NULL, NULL, &err);
+        HANDLE_ERROR(err);
+    }
+
+    /* Setup frame pipeline, all ring slots are initially free. */
+    pipeline.frames = g_async_queue_new();
+    pipeline.free_slots = g_async_queue_new();
+    pipeline.failures = 0;
+    for (cl_uint i = 0; i < CA_RING_SIZE; ++i)
+        g_async_queue_push(pipeline.free_slots, GUINT_TO_POINTER(i + 1));
+    for (cl_uint i = 0; i < CA_NUM_WRITERS; ++i)
+        writers[i] = g_thread_new("ca_writer", ca_writer, &pipeline);
+
     /* Start profiling. */
     prof = ccl_prof_new();
     ccl_prof_start(prof);
@@ -223,25 +328,43 @@ int main(int argc, char * argv[]) {
     /* Run CA_ITERS iterations of the CA. */
     for (cl_uint i = 0; i < CA_ITERS; ++i) {
 
-        /* Read result of last iteration. On first run it is the initial
-         * state. */
+        /* Get a free ring slot, waiting for a writer to save a frame if
+         * necessary. */
+        slot = GPOINTER_TO_UINT(g_async_queue_pop(pipeline.free_slots)) - 1;
+
+        /* Keep read of last iteration. */
+        evt_read_prev = evt_comm;
+
+        /* Read result of last iteration into ring slot, after the last
+         * iteration is over. On first run it is the initial state. */
+        if (evt_exec != NULL) ccl_event_wait_list_add(&ewl, evt_exec, NULL);
         evt_comm = ccl_image_enqueue_read(img1, queue_comm, CL_FALSE,
-            origin, region, 0, 0, output_images[i], NULL, &err);
+            origin, region, 0, 0, ring_pixels[slot], &ewl, &err);
         HANDLE_ERROR(err);
 
-        /* Execute iteration. */
+        /* Execute iteration. The image written in this iteration was read
+         * in the last one, so that read must be over. */
+        if (evt_read_prev != NULL)
+            ccl_event_wait_list_add(&ewl, evt_read_prev, NULL);
         evt_exec = ccl_kernel_set_args_and_enqueue_ndrange(
-            krnl, queue_exec, 2, NULL, gws, lws, NULL, &err,
+            krnl, queue_exec, 2, NULL, gws, lws, &ewl, &err,
             img1, img2, NULL);
         HANDLE_ERROR(err);
 
-        /* Can't start new read until this iteration is over. */
-        ccl_event_wait_list_add(&ewl, evt_comm, evt_exec, NULL);
-
-        /* Wait for events. */
-        ccl_event_wait(&ewl, &err);
+        /* Make sure both commands are submitted to the device. */
+        ccl_queue_flush(queue_comm, &err);
+        HANDLE_ERROR(err);
+        ccl_queue_flush(queue_exec, &err);
         HANDLE_ERROR(err);
 
+        /* Pass frame to writers. */
+        frame = g_slice_new(CAFrame);
+        frame->iter = i;
+        frame->slot = slot;
+        frame->pixels = ring_pixels[slot];
+        frame->evt_read = evt_comm;
+        g_async_queue_push(pipeline.frames, frame);
+
         /* Swap buffers. */
         img_aux = img1;
         img1 = img2;
@@ -249,9 +372,10 @@ int main(int argc, char * argv[]) {
 
     }
 
-    /* Read result of last iteration. */
-    ccl_image_enqueue_read(img1, queue_comm, CL_TRUE,
-        origin, region, 0, 0, output_images[CA_ITERS], &ewl, &err);
+    /* Wait for device to finish. */
+    ccl_queue_finish(queue_exec, &err);
+    HANDLE_ERROR(err);
+    ccl_queue_finish(queue_comm, &err);
     HANDLE_ERROR(err);
 
     /* Stop profiling timer and add queues for analysis. */
@@ -259,26 +383,17 @@ int main(int argc, char * argv[]) {
     ccl_prof_add_queue(prof, "Comms", queue_comm);
     ccl_prof_add_queue(prof, "Exec", queue_exec);
 
-    /* Allocate space for base filename. */
-    filename = (char *) malloc(
-        (strlen(IMAGE_FILE_PREFIX ".png") + IMAGE_FILE_NUM_DIGITS + 1)
-        * sizeof(char));
-
-    /* Write results to image files. */
-    for (cl_uint i = 0; i < CA_ITERS; ++i) {
-
-        /* Determine next filename. */
-        sprintf(filename, "%s%0" G_STRINGIFY(IMAGE_FILE_NUM_DIGITS) "d.png",
-            IMAGE_FILE_PREFIX, i);
-
-        /* Save next image. */
-        file_write_status = stbi_write_png(filename, CA_WIDTH, CA_HEIGHT, 4,
-            output_images[i], CA_WIDTH * sizeof(cl_uchar4));
+    /* Stop writers after they save the remaining frames. */
+    for (cl_uint i = 0; i < CA_NUM_WRITERS; ++i) {
+        frame = g_slice_new0(CAFrame);
+        g_async_queue_push(pipeline.frames, frame);
+    }
+    for (cl_uint i = 0; i < CA_NUM_WRITERS; ++i)
+        g_thread_join(writers[i]);
 
-        /* Give feedback if unable to save image. */
-        if (!file_write_status) {
-            ERROR_MSG_AND_EXIT("Unable to save image in file.");
-        }
+    /* Give feedback if unable to save images. */
+    if (pipeline.failures > 0) {
+        ERROR_MSG_AND_EXIT("Unable to save image in file.");
     }
 
     /* Process profiling info. */
@@ -293,11 +408,20 @@ int main(int argc, char * argv[]) {
     HANDLE_ERROR(err);
 
     /* Release host buffers. */
-    free(filename);
     free(input_image);
-    for (cl_uint i = 0; i < CA_ITERS + 1; ++i)
-        free(output_images[i]);
-    free(output_images);
+    g_async_queue_unref(pipeline.frames);
+    g_async_queue_unref(pipeline.free_slots);
+
+    /* Unmap and release ring of pinned host buffers. */
+    for (cl_uint i = 0; i < CA_RING_SIZE; ++i) {
+        ccl_buffer_enqueue_unmap(
+            ring[i], queue_comm, ring_pixels[i], NULL, &err);
+        HANDLE_ERROR(err);
+    }
+    ccl_queue_finish(queue_comm, &err);
+    HANDLE_ERROR(err);
+    for (cl_uint i = 0; i < CA_RING_SIZE; ++i)
+        ccl_buffer_destroy(ring[i]);
 
     /* Release wrappers. */
     ccl_image_destroy(img1);
@@ -34,8 +34,19 @@
  * Example which demonstrates applying a filter to an image using a
  * convolution matrix.
  *
- * The first argument should be the image file to filter, and the second
- * (optional) argument can be the index of the device to use.
+ * The first argument should be the image file to filter, the second
+ * (optional) argument can be the index of the device to use, and the
+ * third (optional) argument can be a tile size.
+ *
+ * If a tile size is given, or if the image does not fit in the device, the
+ * image is processed in square tiles, so that images larger than device
+ * memory can be filtered. Each tile is uploaded together with its halo,
+ * i.e. the pixels around the tile required by the filter, using image
+ * transfers of a region of the host image with the host image row pitch,
+ * through a staging ring of pinned host memory. Tile uploads and
+ * downloads are performed in one queue, and filtering in another, with two
+ * sets of device images, so that transfers of one tile overlap the
+ * filtering of another.
  *
  * The program will save the filtered image to file IMAGE_FILE in PNG
  * format.
@@ -65,6 +76,25 @@
 /* Output image name. */
 #define IMAGE_FILE "out.png"
 
+/* Tile size used if the image does not fit in the device. */
+#define TILE_SIZE 1024
+
+/* Size of the halo around each tile, i.e. half the filter size. */
+#define TILE_HALO 1
+
+/* Number of sets of device images for tiles. */
+#define TILE_BUFS 2
+
+/**
+ * Position of a tile in the complete image.
+ * */
+typedef struct {
+    /* Origin of tile. */
+    size_t org[3];
+    /* Region of tile. */
+    size_t reg[3];
+} Tile;
+
 /* Error handling macros. */
 #define ERROR_MSG_AND_EXIT(msg) \
     do { fprintf(stderr, "\n%s\n", msg); exit(EXIT_FAILURE); } while(0)
@@ -72,6 +102,200 @@
 #define HANDLE_ERROR(err) \
     if (err != NULL) { ERROR_MSG_AND_EXIT(err->message); }
 
+/**
+ * Filter an image in tiles, overlapping tile transfers and filtering.
+ *
+ * @param[in] ctx Context wrapper.
+ * @param[in] dev Device wrapper.
+ * @param[in] prg Program wrapper.
+ * @param[in] smplr Sampler wrapper.
+ * @param[in] input_image Input image in host.
+ * @param[out] output_image Output image in host.
+ * @param[in] width Image width.
+ * @param[in] height Image height.
+ * @param[in] tile_size Tile size.
+ * @param[out] err Return location for a CCLErr object.
+ * */
+static void filter_tiled(CCLContext * ctx, CCLDevice * dev, CCLProgram * prg,
+    CCLSampler * smplr, unsigned char * input_image,
+    unsigned char * output_image, int width, int height, int tile_size,
+    CCLErr ** err) {
+
+    /* Wrappers for OpenCL objects. */
+    CCLQueue * queue_comm = NULL;
+    CCLQueue * queue_exec = NULL;
+    CCLKernel * krnl = NULL;
+    CCLImage * tile_in[TILE_BUFS] = { NULL, NULL };
+    CCLImage * tile_out[TILE_BUFS] = { NULL, NULL };
+
+    /* Staging ring of pinned host memory for tile transfers. */
+    CCLStaging * stg = NULL;
+
+    /* Last filtering event of each set of tile images. */
+    CCLEvent * evt_exec[TILE_BUFS] = { NULL, NULL };
+    CCLEvent * evt_write;
+    CCLEventWaitList ewl = NULL;
+
+    /* Image parameters. */
+    cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
+    size_t in_dim = tile_size + 2 * TILE_HALO;
+
+    /* Host row pitch, and staged row pitch of a tile plus halo. */
+    size_t row_pitch = width * 4;
+    size_t stg_pitch = ((in_dim * 4 + CCL_STAGING_ROW_PITCH_ALIGN - 1)
+        / CCL_STAGING_ROW_PITCH_ALIGN) * CCL_STAGING_ROW_PITCH_ALIGN;
+
+    /* Number of tiles. */
+    int ntx = (width + tile_size - 1) / tile_size;
+    int nty = (height + tile_size - 1) / tile_size;
+    int ntiles = ntx * nty;
+
+    /* Tile positions, and origin and region of current tile plus halo in
+     * the complete image. */
+    Tile * tiles = g_new(Tile, ntiles);
+    size_t in_org[3] = { 0, 0, 0 };
+    size_t in_reg[3] = { 0, 0, 1 };
+    size_t zero[3] = { 0, 0, 0 };
+
+    /* Kernel arguments. */
+    cl_int2 offset, in_size, out_size;
+
+    /* Worksizes. */
+    size_t real_ws[2] = { tile_size, tile_size };
+    size_t gws[2];
+    size_t lws[2] = { 0, 0 };
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Tile uploads and downloads go into one queue, filtering into the
+     * other. */
+    queue_comm = ccl_queue_new(ctx, dev, 0, &err_internal);
+    if (err_internal) goto finish;
+    queue_exec = ccl_queue_new(ctx, dev, 0, &err_internal);
+    if (err_internal) goto finish;
+
+    /* Tiles are transferred through a staging ring in the communications
+     * queue, with slots large enough for a tile plus halo. */
+    stg = ccl_staging_new(queue_comm, stg_pitch * in_dim, TILE_BUFS + 1,
+        &err_internal);
+    if (err_internal) goto finish;
+
+    /* Create two sets of tile images, for double buffering. */
+    for (int b = 0; b < TILE_BUFS; ++b) {
+        tile_in[b] = ccl_image_new(ctx, CL_MEM_READ_ONLY,
+            &image_format, NULL, &err_internal,
+            "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+            "image_width", in_dim,
+            "image_height", in_dim,
+            NULL);
+        if (err_internal) goto finish;
+        tile_out[b] = ccl_image_new(ctx, CL_MEM_WRITE_ONLY,
+            &image_format, NULL, &err_internal,
+            "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+            "image_width", (size_t) tile_size,
+            "image_height", (size_t) tile_size,
+            NULL);
+        if (err_internal) goto finish;
+    }
+
+    /* Get kernel wrapper and determine worksizes for a complete tile. */
+    krnl = ccl_program_get_kernel(prg, "do_filter_tile", &err_internal);
+    if (err_internal) goto finish;
+    ccl_kernel_suggest_worksizes(
+        krnl, dev, 2, real_ws, gws, lws, &err_internal);
+    if (err_internal) goto finish;
+
+    printf(" * Tiles: %d x %d, tile size: %d\n", ntx, nty, tile_size);
+    printf(" * Global work-size: (%d, %d)\n", (int) gws[0], (int) gws[1]);
+    printf(" * Local work-size: (%d, %d)\n", (int) lws[0], (int) lws[1]);
+
+    /* Process tiles. The download of each tile is performed after the
+     * upload and filtering of the next one are enqueued, so that the device
+     * keeps working while the host waits for the download. */
+    for (int t = 0; t <= ntiles; ++t) {
+
+        int b = t % TILE_BUFS;
+
+        if (t < ntiles) {
+
+            /* Tile position in the complete image. */
+            tiles[t].org[0] = (t % ntx) * tile_size;
+            tiles[t].org[1] = (t / ntx) * tile_size;
+            tiles[t].org[2] = 0;
+            tiles[t].reg[0] = MIN(tile_size, width - (int) tiles[t].org[0]);
+            tiles[t].reg[1] = MIN(tile_size, height - (int) tiles[t].org[1]);
+            tiles[t].reg[2] = 1;
+
+            /* Tile plus halo, cut at the image borders. */
+            for (int d = 0; d < 2; ++d) {
+                size_t dim = d == 0 ? (size_t) width : (size_t) height;
+                in_org[d] = tiles[t].org[d] >= TILE_HALO
+                    ? tiles[t].org[d] - TILE_HALO : 0;
+                in_reg[d] =
+                    MIN(tiles[t].org[d] + tiles[t].reg[d] + TILE_HALO, dim)
+                    - in_org[d];
+            }
+
+            /* Upload tile plus halo, after the last filtering of this set
+             * of tile images is over. */
+            if (evt_exec[b] != NULL)
+                ccl_event_wait_list_add(&ewl, evt_exec[b], NULL);
+            evt_write = ccl_staging_enqueue_write_image(stg, tile_in[b],
+                zero, in_reg, row_pitch, 0, input_image
+                    + in_org[1] * row_pitch + in_org[0] * 4,
+                NULL, NULL, &ewl, &err_internal);
+            if (err_internal) goto finish;
+
+            /* Filter tile after its upload. The last download of this set
+             * of tile images is already over, since downloads return when
+             * data is in host memory. */
+            offset.s[0] = (cl_int) (tiles[t].org[0] - in_org[0]);
+            offset.s[1] = (cl_int) (tiles[t].org[1] - in_org[1]);
+            in_size.s[0] = (cl_int) in_reg[0];
+            in_size.s[1] = (cl_int) in_reg[1];
+            out_size.s[0] = (cl_int) tiles[t].reg[0];
+            out_size.s[1] = (cl_int) tiles[t].reg[1];
+            ccl_event_wait_list_add(&ewl, evt_write, NULL);
+            evt_exec[b] = ccl_kernel_set_args_and_enqueue_ndrange(
+                krnl, queue_exec, 2, NULL, gws, lws, &ewl, &err_internal,
+                tile_in[b], tile_out[b], smplr,
+                ccl_arg_priv(offset, cl_int2), ccl_arg_priv(in_size, cl_int2),
+                ccl_arg_priv(out_size, cl_int2), NULL);
+            if (err_internal) goto finish;
+            ccl_queue_flush(queue_exec, &err_internal);
+            if (err_internal) goto finish;
+        }
+
+        /* Download previous tile to its place in the host image. */
+        if (t > 0) {
+            int p = t - 1;
+            ccl_event_wait_list_add(&ewl, evt_exec[p % TILE_BUFS], NULL);
+            ccl_staging_read_image(stg, tile_out[p % TILE_BUFS], zero,
+                tiles[p].reg, row_pitch, 0, output_image
+                    + tiles[p].org[1] * row_pitch + tiles[p].org[0] * 4,
+                NULL, NULL, &ewl, &err_internal);
+            if (err_internal) goto finish;
+        }
+    }
+
+finish:
+
+    /* Propagate error, if any. */
+    if (err_internal) g_propagate_error(err, err_internal);
+
+    /* Release stuff. */
+    ccl_event_wait_list_clear(&ewl);
+    if (stg) ccl_staging_destroy(stg);
+    for (int b = 0; b < TILE_BUFS; ++b) {
+        if (tile_in[b]) ccl_image_destroy(tile_in[b]);
+        if (tile_out[b]) ccl_image_destroy(tile_out[b]);
+    }
+    if (queue_exec) ccl_queue_destroy(queue_exec);
+    if (queue_comm) ccl_queue_destroy(queue_comm);
+    g_free(tiles);
+}
+
 /**
  * Image filter main function.
  * */
@@ -103,6 +327,13 @@ int main(int argc, char * argv[]) {
     /* Image properties. */
     int width, height, n_channels;
 
+    /* Tile size, zero if image is filtered in one go. */
+    int tile_size = 0;
+
+    /* Device limits. */
+    size_t max_w, max_h;
+    cl_ulong max_alloc;
+
     /* Image file write status. */
     int file_write_status;
 
@@ -122,11 +353,18 @@ int main(int argc, char * argv[]) {
 
     /* Check arguments. */
     if (argc < 2) {
-        ERROR_MSG_AND_EXIT("Usage: image_filter <image_file> [device_index]");
-    } else if (argc >= 3) {
+        ERROR_MSG_AND_EXIT(
+            "Usage: image_filter <image_file> [device_index] [tile_size]");
+    }
+    if (argc >= 3) {
         /* Check if a device was specified in the command line. */
         dev_idx = atoi(argv[2]);
     }
+    if (argc >= 4) {
+        /* Check if a tile size was specified in the command line. */
+        tile_size = atoi(argv[3]);
+        if (tile_size <= 0) ERROR_MSG_AND_EXIT("Invalid tile size.");
+    }
 
     /* Load image. */
     input_image = stbi_load(argv[1], &width, &height, &n_channels, 4);
@@ -153,28 +391,31 @@ int main(int argc, char * argv[]) {
     if (!image_ok)
         ERROR_MSG_AND_EXIT("Selected device doesn't support images.");
 
-    /* Create a command queue. */
-    queue = ccl_queue_new(ctx, dev, 0, &err);
+    /* Get device limits for images. */
+    max_w = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_IMAGE2D_MAX_WIDTH, size_t, &err);
     HANDLE_ERROR(err);
-
-    /* Create 2D input image using loaded image data. */
-    img_in = ccl_image_new(ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-        &image_format, input_image, &err,
-        "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
-        "image_width", (size_t) width,
-        "image_height", (size_t) height,
-        NULL);
+    max_h = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_IMAGE2D_MAX_HEIGHT, size_t, &err);
     HANDLE_ERROR(err);
-
-    /* Create 2D output image. */
-    img_out = ccl_image_new(ctx, CL_MEM_WRITE_ONLY,
-        &image_format, NULL, &err,
-        "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
-        "image_width", (size_t) width,
-        "image_height", (size_t) height,
-        NULL);
+    max_alloc = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, cl_ulong, &err);
     HANDLE_ERROR(err);
 
+    /* Use tiles if the image does not fit in the device. */
+    if ((tile_size == 0) && (((size_t) width > max_w)
+        || ((size_t) height > max_h)
+        || ((cl_ulong) width * height * 4 > max_alloc))) {
+
+        tile_size = TILE_SIZE;
+    }
+
+    /* Tiles plus halo must fit in the device. */
+    if (tile_size > 0) {
+        tile_size = MIN((size_t) tile_size, max_w - 2 * TILE_HALO);
+        tile_size = MIN((size_t) tile_size, max_h - 2 * TILE_HALO);
+    }
+
     /* Create program from kernel source and compile it. */
     prg = ccl_program_new_from_source(ctx, FILTER_KERNEL, &err);
     HANDLE_ERROR(err);
@@ -182,39 +423,77 @@ int main(int argc, char * argv[]) {
     ccl_program_build(prg, NULL, &err);
     HANDLE_ERROR(err);
 
-    /* Get kernel wrapper. */
-    krnl = ccl_program_get_kernel(prg, "do_filter", &err);
-    HANDLE_ERROR(err);
-
-    /* Determine nice local and global worksizes. */
-    ccl_kernel_suggest_worksizes(krnl, dev, 2, real_ws, gws, lws, &err);
-    HANDLE_ERROR(err);
-
-    /* Show information to user. */
-    printf("\n * Image size: %d x %d, %d channels\n",
-        width, height, n_channels);
-    printf(" * Global work-size: (%d, %d)\n", (int) gws[0], (int) gws[1]);
-    printf(" * Local work-size: (%d, %d)\n", (int) lws[0], (int) lws[1]);
-
     /* Create sampler (this could also be created in-kernel). */
     smplr = ccl_sampler_new(ctx, CL_FALSE, CL_ADDRESS_CLAMP_TO_EDGE,
         CL_FILTER_NEAREST, &err);
     HANDLE_ERROR(err);
 
-    /* Apply filter. */
-    ccl_kernel_set_args_and_enqueue_ndrange(
-        krnl, queue, 2, NULL, gws, lws, NULL, &err,
-        img_in, img_out, smplr, NULL);
-    HANDLE_ERROR(err);
+    /* Show information to user. */
+    printf("\n * Image size: %d x %d, %d channels\n",
+        width, height, n_channels);
 
     /* Allocate space for output image. */
     output_image = (unsigned char *)
         malloc(width * height * 4 * sizeof(unsigned char));
 
-    /* Read image data back to host. */
-    ccl_image_enqueue_read(img_out, queue, CL_TRUE, origin, region,
-        0, 0, output_image, NULL, &err);
-    HANDLE_ERROR(err);
+    if (tile_size > 0) {
+
+        /* Filter image in tiles. */
+        filter_tiled(ctx, dev, prg, smplr, input_image, output_image,
+            width, height, tile_size, &err);
+        HANDLE_ERROR(err);
+
+    } else {
+
+        /* Create a command queue. */
+        queue = ccl_queue_new(ctx, dev, 0, &err);
+        HANDLE_ERROR(err);
+
+        /* Create 2D input image using loaded image data. */
+        img_in = ccl_image_new(ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+            &image_format, input_image, &err,
+            "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+            "image_width", (size_t) width,
+            "image_height", (size_t) height,
+            NULL);
+        HANDLE_ERROR(err);
+
+        /* Create 2D output image. */
+        img_out = ccl_image_new(ctx, CL_MEM_WRITE_ONLY,
+            &image_format, NULL, &err,
+            "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+            "image_width", (size_t) width,
+            "image_height", (size_t) height,
+            NULL);
+        HANDLE_ERROR(err);
+
+        /* Get kernel wrapper. */
+        krnl = ccl_program_get_kernel(prg, "do_filter", &err);
+        HANDLE_ERROR(err);
+
+        /* Determine nice local and global worksizes. */
+        ccl_kernel_suggest_worksizes(krnl, dev, 2, real_ws, gws, lws, &err);
+        HANDLE_ERROR(err);
+
+        printf(" * Global work-size: (%d, %d)\n", (int) gws[0], (int) gws[1]);
+        printf(" * Local work-size: (%d, %d)\n", (int) lws[0], (int) lws[1]);
+
+        /* Apply filter. */
+        ccl_kernel_set_args_and_enqueue_ndrange(
+            krnl, queue, 2, NULL, gws, lws, NULL, &err,
+            img_in, img_out, smplr, NULL);
+        HANDLE_ERROR(err);
+
+        /* Read image data back to host. */
+        ccl_image_enqueue_read(img_out, queue, CL_TRUE, origin, region,
+            0, 0, output_image, NULL, &err);
+        HANDLE_ERROR(err);
+
+        /* Release wrappers used for filtering in one go. */
+        ccl_image_destroy(img_in);
+        ccl_image_destroy(img_out);
+        ccl_queue_destroy(queue);
+    }
 
     /* Write image to file. */
     file_write_status = stbi_write_png(IMAGE_FILE, width, height, 4,
@@ -232,11 +511,8 @@ int main(int argc, char * argv[]) {
     stbi_image_free(input_image);
 
     /* Release wrappers. */
-    ccl_image_destroy(img_in);
-    ccl_image_destroy(img_out);
     ccl_sampler_destroy(smplr);
     ccl_program_destroy(prg);
-    ccl_queue_destroy(queue);
     ccl_context_destroy(ctx);
 
     /* Check all wrappers have been destroyed. */
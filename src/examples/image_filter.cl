@@ -78,3 +78,56 @@ __kernel void do_filter(__read_only image2d_t input_img,
 
     }
 }
+
+/**
+ * Filter kernel for one tile of a larger image.
+ *
+ * The input image contains the tile and its halo, i.e. the pixels around
+ * the tile required by the filter, which are only missing where the tile
+ * is at the border of the complete image. Coordinates are clamped to the
+ * part of the input image holding data, which gives the same result as
+ * filtering the complete image with a clamp-to-edge sampler.
+ *
+ * @param[in] input_img Input image with tile and halo.
+ * @param[out] output_img Output image with filtered tile.
+ * @param[in] sampler Sampler for reading image values.
+ * @param[in] offset Position of tile in input image.
+ * @param[in] in_size Size of data in input image.
+ * @param[in] out_size Size of tile.
+ * */
+__kernel void do_filter_tile(__read_only image2d_t input_img,
+    __write_only image2d_t output_img, sampler_t sampler,
+    int2 offset, int2 in_size, int2 out_size) {
+
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if ((x < out_size.x) && (y < out_size.y)) {
+
+        int half_filter = filter_size / 2;
+        int2 coord;
+        uint4 px_val;
+        float4 px_filt = { 0.0f, 0.0f, 0.0f, 0.0f };
+        uint4 px_filt_int;
+        int i, j, filter_i, filter_j;
+
+        for(i = -half_filter, filter_i = 0; i <= half_filter; i++, filter_i++) {
+            for(j = -half_filter, filter_j = 0;
+                j <= half_filter;
+                j++, filter_j++) {
+
+                coord = clamp((int2) (x + i, y + j) + offset,
+                    (int2) (0, 0), in_size - 1);
+                px_val = read_imageui(input_img, sampler, coord);
+                px_filt +=
+                    filter[filter_i * filter_size + filter_j]
+                    * convert_float4(px_val);
+
+            }
+        }
+
+        px_filt_int = convert_uint4(px_filt);
+        write_imageui(output_img, (int2)(x, y), px_filt_int);
+
+    }
+}
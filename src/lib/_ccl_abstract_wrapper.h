@@ -157,6 +157,14 @@ typedef CL_API_ENTRY cl_int (CL_API_CALL * ccl_wrapper_info_fp2)(
     size_t param_value_size, void * param_value,
     size_t * param_value_size_ret);
 
+/**
+ * @internal
+ * Status reported by ccl_wrapper_get_info_scalar_status() when the
+ * requested information is unavailable. OpenCL error codes are negative,
+ * so this value does not collide with them.
+ * */
+#define CCL_WRAPPER_INFO_UNAVAILABLE 1
+
 /* Create a new wrapper object. This function is called by the
  * concrete wrapper constructors. */
 CCLWrapper * ccl_wrapper_new(CCLClass class, void * cl_object, size_t size);
@@ -167,15 +175,31 @@ cl_bool ccl_wrapper_unref(CCLWrapper * wrapper, size_t size,
     ccl_wrapper_release_fields rel_fields_fun,
     ccl_wrapper_release_cl_object rel_cl_fun, CCLErr ** err);
 
+/* Replace the OpenCL object wrapped by a wrapper object with another
+ * OpenCL object of the same class. */
+void ccl_wrapper_rewrap(CCLWrapper * wrapper, void * cl_object,
+    ccl_wrapper_release_cl_object rel_cl_fun);
+
 /* Add a ::CCLWrapperInfo object to the info table of the
  * given wrapper. */
 void ccl_wrapper_add_info(CCLWrapper * wrapper, cl_uint param_name,
     CCLWrapperInfo * info);
 
+/* Keep a ::CCLWrapperInfo object in the info table of the given wrapper as
+ * the result of the given information query. */
+void ccl_wrapper_cache_info(CCLWrapper * wrapper, cl_uint param_name,
+    CCLInfo info_type, CCLWrapperInfo * info);
+
 /* Create a new CCLWrapperInfo* object with a given value size. */
 CCLWrapperInfo * ccl_wrapper_info_new(size_t size);
 
 /* Destroy a ::CCLWrapperInfo object. */
 void ccl_wrapper_info_destroy(CCLWrapperInfo * info);
 
+/* Get pointer to fixed-size information value, reporting failure only
+ * through a status code. */
+void * ccl_wrapper_get_info_scalar_status(CCLWrapper * wrapper1,
+    CCLWrapper * wrapper2, cl_uint param_name, size_t size,
+    CCLInfo info_type, cl_bool use_cache, cl_int * status);
+
 #endif
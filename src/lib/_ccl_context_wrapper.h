@@ -0,0 +1,77 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * This header provides the prototypes of internal context wrapper functions,
+ * such as ccl_context_get_compiled_program(). This header is not part of the
+ * _cf4ocl_ public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_CONTEXT_WRAPPER_H_
+#define __CCL_CONTEXT_WRAPPER_H_
+
+#include "ccl_oclversions.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_program_wrapper.h"
+#include "ccl_sampler_wrapper.h"
+#include "_ccl_buffer_pool.h"
+#include "_ccl_image_pool.h"
+
+/* Get a compiled program from the context cache of compiled programs. */
+CCLProgram * ccl_context_get_compiled_program(
+    CCLContext * ctx, const char * key);
+
+/* Add a compiled program to the context cache of compiled programs. */
+CCLProgram * ccl_context_add_compiled_program(
+    CCLContext * ctx, const char * key, CCLProgram * prg);
+
+/* Get a sampler from the context cache of samplers. */
+CCLSampler * ccl_context_get_cached_sampler(
+    CCLContext * ctx, const char * key);
+
+/* Add a sampler to the context cache of samplers. */
+CCLSampler * ccl_context_add_cached_sampler(
+    CCLContext * ctx, const char * key, CCLSampler * smplr);
+
+/* Get the buffer pool of a context. */
+CCLBufferPool * ccl_context_get_buffer_pool(CCLContext * ctx);
+
+/* Set the buffer pool of a context. */
+void ccl_context_set_buffer_pool(CCLContext * ctx, CCLBufferPool * pool);
+
+/* Get the image pool of a context. */
+CCLImagePool * ccl_context_get_image_pool(CCLContext * ctx);
+
+/* Set the image pool of a context. */
+void ccl_context_set_image_pool(CCLContext * ctx, CCLImagePool * pool);
+
+/* Account for the memory of a new memory object in its context. */
+cl_bool ccl_context_mem_track(CCLContext * ctx, CCLMemObj * mo,
+    size_t size, CCLErr ** err);
+
+/* Stop accounting for the memory of a memory object. */
+void ccl_context_mem_untrack(CCLMemObj * mo);
+
+#endif
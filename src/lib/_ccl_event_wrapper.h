@@ -0,0 +1,48 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Event wrapper methods for recording command dependencies. This file is
+ * only for building _cf4ocl_. Is is not part of its public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_EVENT_WRAPPER_H_
+#define __CCL_EVENT_WRAPPER_H_
+
+#include "ccl_event_wrapper.h"
+
+/* Record the events in the given wait list as the dependencies of the
+ * command which produced the event. */
+void ccl_event_set_deps(CCLEvent * evt, CCLEventWaitList * evt_wait_lst);
+
+/* Get the recorded dependencies of the command which produced the
+ * event. */
+const cl_event * ccl_event_get_deps(CCLEvent * evt, cl_uint * num_deps);
+
+/* Add the events in an event wait list to another event wait list. */
+CCLEventWaitList * ccl_event_wait_list_copy(
+    CCLEventWaitList * dst, CCLEventWaitList * src);
+
+#endif /* __CCL_EVENT_WRAPPER_H_ */
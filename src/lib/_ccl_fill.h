@@ -0,0 +1,53 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * This header provides the prototypes of the internal kernel-based fill
+ * functions used by buffer and image wrappers when the OpenCL fill
+ * commands are not available. This header is not part of the _cf4ocl_
+ * public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_FILL_H_
+#define __CCL_FILL_H_
+
+#include "ccl_oclversions.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_image_wrapper.h"
+
+/** @internal Maximum size in bytes of patterns filled by kernels. */
+#define CCL_FILL_PATTERN_MAX 128
+
+/* Fill a buffer with a pattern using a kernel. */
+CCLEvent * ccl_fill_buffer_kernel(CCLBuffer * buf, CCLQueue * cq,
+    const void * pattern, size_t pattern_size, size_t offset, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Fill a 2D image with a color using a kernel. */
+CCLEvent * ccl_fill_image_kernel(CCLImage * img, CCLQueue * cq,
+    const void * fill_color, const size_t * origin, const size_t * region,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Futures which are completed by _cf4ocl_ modules, e.g. when the command
+ * they refer to is enqueued later by another thread. This file is only
+ * for building _cf4ocl_. Is is not part of its public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_FUTURE_H_
+#define __CCL_FUTURE_H_
+
+#include "ccl_future.h"
+
+/* Create a future to be completed with ccl_future_resolve() or
+ * ccl_future_resolve_event(). */
+CCLFuture * ccl_future_new_pending(void);
+
+/* Complete a pending future with the given execution status. */
+void ccl_future_resolve(CCLFuture * fut, cl_int status);
+
+/* Complete a pending future when the given event completes. */
+void ccl_future_resolve_event(CCLFuture * fut, CCLEvent * evt);
+
+#endif /* __CCL_FUTURE_H_ */
@@ -0,0 +1,69 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Timing of host-side calls of wrapper functions, recorded by the
+ * profiler module. This file is only for building _cf4ocl_. Is is not
+ * part of its public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_HOST_TRACE_H_
+#define __CCL_HOST_TRACE_H_
+
+#include "ccl_common.h"
+
+/* Start timing a host call, returning zero if tracing is disabled. */
+guint64 ccl_host_trace_begin(void);
+
+/* Finish timing a host call started with ccl_host_trace_begin(). */
+void ccl_host_trace_end(const char * func_name, guint64 t_begin);
+
+/* Record the duration of a host call, in nanoseconds. Implemented by the
+ * profiler module. */
+void ccl_prof_host_record(const char * func_name, guint64 duration);
+
+#ifdef CCL_HOST_TRACE
+
+    /* Start timing the current wrapper function. Must be placed before
+     * any jumps to the function exit labels. */
+    #define CCL_HOST_TRACE_BEGIN \
+        guint64 ccl_host_trace_t0 = ccl_host_trace_begin()
+
+    /* Finish timing the current wrapper function. */
+    #define CCL_HOST_TRACE_END \
+        do { \
+            if (ccl_host_trace_t0 != 0) \
+                ccl_host_trace_end(G_STRFUNC, ccl_host_trace_t0); \
+        } while (0)
+
+#else
+
+    /* Host-side tracing was not compiled in. */
+    #define CCL_HOST_TRACE_BEGIN
+    #define CCL_HOST_TRACE_END
+
+#endif
+
+#endif /* __CCL_HOST_TRACE_H_ */
@@ -0,0 +1,108 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Direct ICD dispatch of frequently called OpenCL functions. This header is
+ * not part of the public API.
+ *
+ * OpenCL objects created by an installable client driver (ICD) start with
+ * a pointer to the driver's dispatch table, which the ICD loader uses to
+ * forward each call to the driver. If the library is built with the
+ * `ICD_DIRECT_DISPATCH` CMake option, the functions in this header call
+ * the driver through the object's dispatch table, skipping the loader
+ * trampoline. Otherwise, they are the regular OpenCL functions.
+ *
+ * Only functions which are called often with a valid, non-`NULL` OpenCL
+ * object as first argument are dispatched this way. Note that OpenCL
+ * layers installed in the ICD loader are bypassed by these calls.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_ICD_H_
+#define _CCL_ICD_H_
+
+#include "ccl_oclversions.h"
+
+#ifdef CCL_ICD_DISPATCH
+
+#include <CL/cl_icd.h>
+
+/**
+ * @internal
+ * Dispatch table of an OpenCL object created by an ICD.
+ *
+ * @param[in] obj An OpenCL object.
+ * */
+#define ccl_icd_table(obj) \
+    (*((struct _cl_icd_dispatch * const *) (obj)))
+
+/**
+ * @internal
+ * Call clSetKernelArg() through the kernel's dispatch table.
+ * */
+static inline cl_int CL_API_CALL ccl_icd_clSetKernelArg(cl_kernel kernel,
+    cl_uint arg_index, size_t arg_size, const void * arg_value) {
+
+    return ccl_icd_table(kernel)->clSetKernelArg(
+        kernel, arg_index, arg_size, arg_value);
+}
+
+/**
+ * @internal
+ * Call clEnqueueNDRangeKernel() through the queue's dispatch table.
+ * */
+static inline cl_int CL_API_CALL ccl_icd_clEnqueueNDRangeKernel(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t * global_work_offset, const size_t * global_work_size,
+    const size_t * local_work_size, cl_uint num_events_in_wait_list,
+    const cl_event * event_wait_list, cl_event * event) {
+
+    return ccl_icd_table(command_queue)->clEnqueueNDRangeKernel(
+        command_queue, kernel, work_dim, global_work_offset,
+        global_work_size, local_work_size, num_events_in_wait_list,
+        event_wait_list, event);
+}
+
+/**
+ * @internal
+ * Call clGetEventInfo() through the event's dispatch table.
+ * */
+static inline cl_int CL_API_CALL ccl_icd_clGetEventInfo(cl_event event,
+    cl_event_info param_name, size_t param_value_size, void * param_value,
+    size_t * param_value_size_ret) {
+
+    return ccl_icd_table(event)->clGetEventInfo(event, param_name,
+        param_value_size, param_value, param_value_size_ret);
+}
+
+#else
+
+/* Without direct dispatch, calls go through the ICD loader. */
+#define ccl_icd_clSetKernelArg clSetKernelArg
+#define ccl_icd_clEnqueueNDRangeKernel clEnqueueNDRangeKernel
+#define ccl_icd_clGetEventInfo clGetEventInfo
+
+#endif
+
+#endif /* _CCL_ICD_H_ */
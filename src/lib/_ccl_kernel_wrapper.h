@@ -20,8 +20,9 @@
  * @internal
  *
  * @file
- * This header provides the prototype of the ccl_kernel_get_arg_info_adapter()
- * function. This header is not part of the _cf4ocl_ public API.
+ * This header provides the prototypes of internal kernel wrapper functions,
+ * such as ccl_kernel_get_arg_info_adapter() and ccl_kernel_flush_args().
+ * This header is not part of the _cf4ocl_ public API.
  *
  * @author Nuno Fachada
  * @date 2019
@@ -31,7 +32,75 @@
 #ifndef __CCL_KERNEL_WRAPPER_H_
 #define __CCL_KERNEL_WRAPPER_H_
 
+#include <stdarg.h>
 #include "ccl_oclversions.h"
+#include "ccl_kernel_wrapper.h"
+
+/* Set kernel arguments given in a NULL-terminated variable argument
+ * list. */
+void ccl_kernel_set_args_va(CCLKernel * krnl, va_list args_va);
+
+/* Send the kernel arguments set since the last enqueue to the driver. */
+cl_bool ccl_kernel_flush_args(CCLKernel * krnl, CCLErr ** err);
+
+/* Get the version of the kernel arguments known by the driver. */
+cl_ulong ccl_kernel_get_args_version(CCLKernel * krnl);
+
+/**
+ * @internal
+ *
+ * @brief Work size limits of a kernel on a device, as used for
+ * determining work sizes.
+ * */
+typedef struct ccl_kernel_ws_profile {
+
+    /**
+     * Device to which the limits refer.
+     * @private
+     * */
+    cl_device_id device;
+
+    /**
+     * Maximum number of work item dimensions supported by the device.
+     * @private
+     * */
+    cl_uint dev_dims;
+
+    /**
+     * Maximum work item sizes of the device, `dev_dims` values.
+     * @private
+     * */
+    size_t * max_wi_sizes;
+
+    /**
+     * Maximum work group size for the kernel on the device.
+     * @private
+     * */
+    size_t wg_size_max;
+
+    /**
+     * Preferred work group size multiple for the kernel on the device.
+     * @private
+     * */
+    size_t wg_size_mult;
+
+    /**
+     * Subgroup (SIMD) size of the kernel on the device, or zero if unknown.
+     * @private
+     * */
+    size_t sg_size;
+
+    /**
+     * Next profile in the kernel list of profiles.
+     * @private
+     * */
+    struct ccl_kernel_ws_profile * next;
+
+} CCLKernelWSProfile;
+
+/* Get the work size limits of a kernel on a device. */
+const CCLKernelWSProfile * ccl_kernel_get_ws_profile(
+    CCLKernel * krnl, CCLDevice * dev, CCLErr ** err);
 
 #ifdef CL_VERSION_1_2
 
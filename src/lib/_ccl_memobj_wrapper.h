@@ -30,14 +30,37 @@
  * */
 
 #include "ccl_context_wrapper.h"
+#include "ccl_memobj_wrapper.h"
 #include "_ccl_abstract_wrapper.h"
 
 #ifndef __CCL_MEMOBJ_WRAPPER_H_
 #define __CCL_MEMOBJ_WRAPPER_H_
 
 /**
- * Base class for memory object wrappers, i.e., ::CCLBuffer and
- * ::CCLImage.
+ * @internal
+ *
+ * @brief Command which accessed a memory object with tracked hazards.
+ * */
+typedef struct ccl_memobj_access {
+
+    /**
+     * Command queue where the command was enqueued. A reference to the
+     * queue wrapper is kept.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Event of the command. A reference to the event wrapper is kept.
+     * @private
+     * */
+    CCLEvent * evt;
+
+} CCLMemObjAccess;
+
+/**
+ * Base class for memory object wrappers, i.e., ::CCLBuffer, ::CCLImage
+ * and ::CCLPipe.
  *
  * @ingroup CCL_MEMOBJ_WRAPPER
  * @extends ccl_wrapper
@@ -50,6 +73,86 @@ struct ccl_memobj {
      * */
     CCLWrapper base;
 
+    /**
+     * Context in which the memory object is accounted for, or `NULL` if
+     * it is not accounted for.
+     * @private
+     * */
+    CCLContext * mem_ctx;
+
+    /**
+     * Size in bytes accounted for the memory object.
+     * @private
+     * */
+    size_t mem_size;
+
+    /**
+     * Is the device where the memory object resides tracked?
+     * @private
+     * */
+    cl_bool residency;
+
+    /**
+     * Device where the memory object was last written, or `NULL` if
+     * unknown. A reference to the device wrapper is kept.
+     * @private
+     * */
+    CCLDevice * resident_dev;
+
+    /**
+     * Event of the command which last wrote the memory object, or `NULL`
+     * if unknown. A reference to the event wrapper is kept.
+     * @private
+     * */
+    CCLEvent * resident_evt;
+
+    /**
+     * Are read and write hazards of the memory object tracked?
+     * @private
+     * */
+    cl_bool hazards;
+
+    /**
+     * Is the memory object read-only for kernels?
+     * @private
+     * */
+    cl_bool hazard_read_only;
+
+    /**
+     * Command which last wrote the memory object.
+     * @private
+     * */
+    CCLMemObjAccess writer;
+
+    /**
+     * Commands which read the memory object since it was last written
+     * (array of ::CCLMemObjAccess), at most one per in-order queue.
+     * @private
+     * */
+    GArray * readers;
+
 };
 
+/* Release the fields of a memory object wrapper. */
+void ccl_memobj_release_fields(CCLMemObj * mo);
+
+/* Record that a memory object was written by a command on a queue. */
+void ccl_memobj_residency_update(
+    CCLMemObj * mo, CCLQueue * cq, CCLEvent * evt);
+
+/* Migrate memory objects last written on another device to the device of
+ * a queue. */
+CCLEvent * ccl_memobj_residency_migrate(CCLMemObj ** mos, cl_uint num_mos,
+    CCLQueue * cq, CCLErr ** err);
+
+/* Add the events a command accessing a memory object must wait for, due to
+ * read and write hazards, to an event wait list. */
+CCLEventWaitList * ccl_memobj_hazard_deps(CCLMemObj * mo, CCLQueue * cq,
+    cl_bool write, CCLEventWaitList * evt_wait_lst,
+    CCLEventWaitList * hzd_wait_lst);
+
+/* Record that a command accessed a memory object with tracked hazards. */
+void ccl_memobj_hazard_record(
+    CCLMemObj * mo, CCLQueue * cq, cl_bool write, CCLEvent * evt);
+
 #endif
@@ -0,0 +1,45 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Runtime loading of the OpenCL library. This header is not part of the
+ * public API.
+ *
+ * If the library is built with the `OPENCL_DLOPEN` CMake option, it does
+ * not link against the OpenCL library. Instead, the OpenCL library is
+ * opened with `dlopen()` the first time an OpenCL function is called, and
+ * each OpenCL function is resolved on its first call. The library path can
+ * be overridden with the `CCL_OPENCL_LIBRARY` environment variable.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_OCL_LOADER_H_
+#define _CCL_OCL_LOADER_H_
+
+#include "ccl_common.h"
+
+/* Check if the OpenCL library can be loaded, loading it if necessary. */
+cl_bool ccl_ocl_loader_check(CCLErr ** err);
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * This header provides the prototypes of the internal program binary cache
+ * functions used by ccl_program_build_full(). This header is not part of
+ * the _cf4ocl_ public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_PROGRAM_CACHE_H_
+#define __CCL_PROGRAM_CACHE_H_
+
+#include "ccl_oclversions.h"
+#include "ccl_program_cache.h"
+#include "ccl_program_wrapper.h"
+
+/* Get the cache keys of the program binaries for the given devices, or
+ * NULL if the cache is disabled or the program is not built from
+ * source. */
+gchar ** ccl_program_cache_get_keys(CCLProgram * prg, cl_uint num_devices,
+    CCLDevice * const * devs, const char * options);
+
+/* Create and build a program from the cached binaries with the given
+ * keys, or return NULL if they are not in the cache. */
+cl_program ccl_program_cache_load(cl_context context, cl_uint num_devices,
+    CCLDevice * const * devs, gchar ** keys, const char * options);
+
+/* Save the binaries of a built program in the cache. */
+void ccl_program_cache_store(CCLProgram * prg, cl_uint num_devices,
+    CCLDevice * const * devs, gchar ** keys);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * This header provides the prototypes of command queue wrapper functions
+ * used by other _cf4ocl_ modules, namely the profiler. This header is not
+ * part of the _cf4ocl_ public API.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef __CCL_QUEUE_WRAPPER_H_
+#define __CCL_QUEUE_WRAPPER_H_
+
+#include "ccl_queue_wrapper.h"
+
+/* Get the location where the OpenCL event of a command enqueued on the queue
+ * should be placed, taking into account the event-less mode. */
+cl_event * ccl_queue_event_ptr(CCLQueue * cq, cl_event * event);
+
+/* Get an event which completes after the last command enqueued on the
+ * queue, enqueueing a marker if that command has no event. */
+CCLEvent * ccl_queue_last_event(CCLQueue * cq, CCLErr ** err);
+
+/* Create an event wrapper from a given OpenCL event object, associate it
+ * with the command queue and, if required, record its dependencies. */
+CCLEvent * ccl_queue_produce_event_deps(
+    CCLQueue * cq, cl_event event, CCLEventWaitList * evt_wait_lst);
+
+/* Attach the command queue to, or detach it from, a profile object. */
+void ccl_queue_prof_attach(CCLQueue * cq, cl_bool attach);
+
+/* Function called for each terminated event drained from a queue, which
+ * returns `CL_TRUE` if the event can be released. */
+typedef cl_bool (*ccl_queue_drain_fn)(CCLEvent * evt, void * data);
+
+/* Release terminated events associated with the command queue, passing
+ * them to the given function first. */
+cl_uint ccl_queue_prof_drain(
+    CCLQueue * cq, ccl_queue_drain_fn drain_fn, void * data);
+
+/* Enqueue a marker command on the command queue, without wrapping the
+ * resulting OpenCL event. */
+cl_event ccl_queue_enqueue_marker_raw(
+    CCLQueue * cq, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+#endif /* __CCL_QUEUE_WRAPPER_H_ */
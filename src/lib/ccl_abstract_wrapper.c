@@ -30,25 +30,160 @@
 #include "_ccl_abstract_wrapper.h"
 #include "_ccl_kernel_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_icd.h"
 
 /* Generic function pointer for OpenCL clget**Info() functions. */
 typedef cl_int (*ccl_wrapper_info_fp)(void);
 
-/* Table of all existing wrappers. */
-static GHashTable * wrappers = NULL;
-/* Define lock for synchronizing access to table of all existing wrappers. */
-G_LOCK_DEFINE(wrappers);
+/* Number of shards in the table of all existing wrappers. Must be a power of
+ * two. */
+#define CCL_WRAPPERS_NSHARDS 64
+
+/* Number of bits required to index a shard. */
+#define CCL_WRAPPERS_NSHARDS_BITS 6
+
+/* Assumed size of a cache line, used for padding the wrapper table shards
+ * in order to avoid false sharing between them. */
+#define CCL_CACHE_LINE_SIZE 64
+
+/**
+ * @internal
+ *
+ * @brief A shard of the table of all existing wrappers.
+ *
+ * The table of all existing wrappers is split into several independent
+ * shards, each one with its own lock, so that threads wrapping or releasing
+ * different OpenCL objects rarely contend on the same lock.
+ * */
+union ccl_wrapper_shard {
+
+    struct {
+
+        /**
+         * Table of existing wrappers in this shard, keyed by OpenCL object.
+         * @private
+         * */
+        GHashTable * table;
+
+        /**
+         * Lock for synchronizing access to this shard. Statically allocated,
+         * so it doesn't need to be initialized.
+         * @private
+         * */
+        GMutex mutex;
+
+        /**
+         * Number of times this shard was locked for wrapping or releasing
+         * OpenCL objects. Only updated while holding the lock.
+         * @private
+         * */
+        guint64 num_locks;
+
+        /**
+         * Number of times a thread had to wait for the lock of this shard.
+         * Only updated while holding the lock.
+         * @private
+         * */
+        guint64 num_contentions;
+
+    } s;
+
+    /**
+     * Padding, guarantees that each shard occupies its own cache line.
+     * @private
+     * */
+    char pad[CCL_CACHE_LINE_SIZE];
+
+};
+
+/* Table of all existing wrappers, split into shards. */
+static union ccl_wrapper_shard wrappers[CCL_WRAPPERS_NSHARDS];
+
+/**
+ * @internal
+ *
+ * @brief Get the shard of the table of all existing wrappers where the
+ * wrapper for the given OpenCL object is (or would be) kept.
+ *
+ * OpenCL objects are pointers to driver-allocated structures, so their
+ * lower bits carry little information. Fibonacci hashing is used to spread
+ * them evenly among shards.
+ *
+ * @param[in] cl_object An OpenCL object.
+ * @return The shard responsible for `cl_object`.
+ * */
+static inline union ccl_wrapper_shard * ccl_wrapper_get_shard(
+    void * cl_object) {
+
+    guint32 key = (guint32) (((guint64) (gsize) cl_object) >> 4);
+    return &wrappers[(guint32) (key * 2654435769u)
+        >> (32 - CCL_WRAPPERS_NSHARDS_BITS)];
+}
+
+/**
+ * @internal
+ *
+ * @brief Lock a shard of the table of all existing wrappers, keeping track
+ * of lock contention.
+ *
+ * @param[in] shard Shard to lock.
+ * */
+static inline void ccl_wrapper_shard_lock(union ccl_wrapper_shard * shard) {
+
+    if (!g_mutex_trylock(&shard->s.mutex)) {
+        g_mutex_lock(&shard->s.mutex);
+        shard->s.num_contentions++;
+    }
+    shard->s.num_locks++;
+}
+
+/**
+ * @internal
+ *
+ * @brief Runtime counters for wrappers of a given class.
+ * */
+struct ccl_wrapper_class_counters {
+
+    /**
+     * Number of currently existing wrappers.
+     * @private
+     * */
+    gint live;
+
+    /**
+     * Maximum number of simultaneously existing wrappers.
+     * @private
+     * */
+    gint peak;
+
+    /**
+     * Bytes held by current information values.
+     * @private
+     * */
+    gsize info_bytes;
+
+    /**
+     * Bytes held by replaced information values.
+     * @private
+     * */
+    gsize old_info_bytes;
+
+};
+
+/* Runtime counters for each wrapper class, updated atomically. */
+static struct ccl_wrapper_class_counters class_counters[CCL_NONE + 1];
 
 /* Wrapper names ordered by their enum type. */
 static const char * ccl_class_names[] = {"Buffer", "Context", "Device", "Event",
-    "Image", "Kernel", "Platform", "Program", "Sampler", "Queue", "None", NULL};
+    "Image", "Kernel", "Platform", "Program", "Sampler", "Queue", "Pipe",
+    "None", NULL};
 
 /* Information functions. They must be in the same order as defined in the
  * CCLInfo enum. */
 static const ccl_wrapper_info_fp info_funs[] = {
     (ccl_wrapper_info_fp) clGetContextInfo,
     (ccl_wrapper_info_fp) clGetDeviceInfo,
-    (ccl_wrapper_info_fp) clGetEventInfo,
+    (ccl_wrapper_info_fp) ccl_icd_clGetEventInfo,
     (ccl_wrapper_info_fp) clGetEventProfilingInfo,
     (ccl_wrapper_info_fp) clGetImageInfo,
     (ccl_wrapper_info_fp) clGetKernelInfo,
@@ -70,96 +205,1363 @@ static const ccl_wrapper_info_fp info_funs[] = {
     (ccl_wrapper_info_fp) clGetSamplerInfo,
     (ccl_wrapper_info_fp) clGetCommandQueueInfo,
 #ifdef CL_VERSION_2_0
-    NULL /* clGetPipeInfo - not implemented yet. */
+    (ccl_wrapper_info_fp) clGetPipeInfo,
 #else
     NULL,
 #endif
 };
 
+/* Number of bits of the index of the per information type cache of
+ * information value sizes. */
+#define CCL_WRAPPER_INFO_SIZES_BITS 6
+
+/* Value in the cache of information sizes indicating that the size of the
+ * respective parameter varies between objects. */
+#define CCL_WRAPPER_INFO_SIZE_VARIES -1
+
 /**
- * Information about wrapped OpenCL objects.
+ * @internal
+ *
+ * @brief Entry in the cache of information value sizes.
+ *
+ * Fields are accessed atomically, but independently, so an entry may be
+ * momentarily inconsistent. This is harmless, since cached sizes are only
+ * used as hints, and the actual size is always returned by OpenCL.
  * */
-struct ccl_wrapper_info_table {
+struct ccl_wrapper_info_size {
 
     /**
-     * Table containing information about the wrapped OpenCL object.
+     * Name of the information parameter.
      * @private
      * */
-    GHashTable * table;
+    gint param_name;
 
     /**
-     * List of replaced information about the wrapped OpenCL object.
+     * Size of the information value, zero if unknown or
+     * ::CCL_WRAPPER_INFO_SIZE_VARIES if it varies between objects.
      * @private
      * */
-    GSList * old_info;
+    gint size;
+
+};
+
+/* Direct-mapped cache of information value sizes, per information type. */
+static struct ccl_wrapper_info_size
+    info_sizes[CCL_INFO_END][1 << CCL_WRAPPER_INFO_SIZES_BITS];
+
+/**
+ * @internal
+ *
+ * @brief Get the entry for the given parameter in the cache of information
+ * value sizes.
+ * */
+static inline struct ccl_wrapper_info_size * ccl_wrapper_info_size_entry(
+    CCLInfo info_type, cl_uint param_name) {
+
+    return &info_sizes[info_type][(guint32) (param_name * 2654435769u)
+        >> (32 - CCL_WRAPPER_INFO_SIZES_BITS)];
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the previously observed size of an information parameter.
+ *
+ * @param[in] info_type Type of information query.
+ * @param[in] param_name Name of the information parameter.
+ * @return The size of the information parameter, or zero if unknown or if
+ * it varies between objects.
+ * */
+static size_t ccl_wrapper_info_size_get(CCLInfo info_type,
+    cl_uint param_name) {
+
+    struct ccl_wrapper_info_size * entry =
+        ccl_wrapper_info_size_entry(info_type, param_name);
+    gint size;
+
+    if ((guint) g_atomic_int_get(&entry->param_name) != param_name)
+        return 0;
+    size = g_atomic_int_get(&entry->size);
+    return size > 0 ? (size_t) size : 0;
+}
+
+/**
+ * @internal
+ *
+ * @brief Keep the observed size of an information parameter. If a
+ * different size was previously observed, the parameter is marked as having
+ * a varying size, and no longer has its size cached.
+ *
+ * @param[in] info_type Type of information query.
+ * @param[in] param_name Name of the information parameter.
+ * @param[in] size Observed size of the information parameter.
+ * */
+static void ccl_wrapper_info_size_set(CCLInfo info_type,
+    cl_uint param_name, size_t size) {
+
+    struct ccl_wrapper_info_size * entry =
+        ccl_wrapper_info_size_entry(info_type, param_name);
+    gint size_old;
+
+    if (size > G_MAXINT) return;
+
+    if ((guint) g_atomic_int_get(&entry->param_name) != param_name) {
+        /* Evict whatever parameter was using this entry. */
+        g_atomic_int_set(&entry->size, 0);
+        g_atomic_int_set(&entry->param_name, (gint) param_name);
+    }
+
+    size_old = g_atomic_int_get(&entry->size);
+    if (size_old == 0)
+        g_atomic_int_compare_and_exchange(&entry->size, 0, (gint) size);
+    else if ((size_old > 0) && ((size_t) size_old != size))
+        g_atomic_int_set(&entry->size, CCL_WRAPPER_INFO_SIZE_VARIES);
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine if a given information parameter is guaranteed not to
+ * change during the lifetime of the wrapped OpenCL object, in which case it
+ * is never queried again once cached.
+ *
+ * @param[in] info_type Type of information query.
+ * @param[in] param_name Name of the information parameter.
+ * @return `CL_TRUE` if the parameter is immutable, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_wrapper_info_is_immutable(
+    CCLInfo info_type, cl_uint param_name) {
+
+    switch (info_type) {
+
+        case CCL_INFO_CONTEXT:
+            return param_name != CL_CONTEXT_REFERENCE_COUNT;
+
+        case CCL_INFO_DEVICE:
+            return (param_name != CL_DEVICE_AVAILABLE)
+#ifdef CL_VERSION_1_2
+                && (param_name != CL_DEVICE_REFERENCE_COUNT)
+#endif
+                ;
+
+        case CCL_INFO_EVENT:
+            return (param_name != CL_EVENT_COMMAND_EXECUTION_STATUS)
+                && (param_name != CL_EVENT_REFERENCE_COUNT);
+
+        case CCL_INFO_EVENT_PROFILING:
+            /* Profiling info is only cached once it is available, i.e. when
+             * the command has completed, in which case it no longer
+             * changes. */
+            return CL_TRUE;
+
+        case CCL_INFO_IMAGE:
+        case CCL_INFO_PLATFORM:
+            return CL_TRUE;
+
+        case CCL_INFO_KERNEL:
+            return param_name != CL_KERNEL_REFERENCE_COUNT;
+
+        case CCL_INFO_KERNEL_ARG:
+            return CL_TRUE;
+
+        case CCL_INFO_KERNEL_WORKGROUP:
+            /* Local memory usage depends on the kernel arguments. */
+            return param_name != CL_KERNEL_LOCAL_MEM_SIZE;
+
+        case CCL_INFO_MEMOBJ:
+            return (param_name != CL_MEM_MAP_COUNT)
+                && (param_name != CL_MEM_REFERENCE_COUNT);
+
+        case CCL_INFO_PROGRAM:
+            /* Binaries, kernel names and such change when the program is
+             * built. */
+            return (param_name == CL_PROGRAM_CONTEXT)
+                || (param_name == CL_PROGRAM_NUM_DEVICES)
+                || (param_name == CL_PROGRAM_DEVICES)
+                || (param_name == CL_PROGRAM_SOURCE);
+
+        case CCL_INFO_SAMPLER:
+            return param_name != CL_SAMPLER_REFERENCE_COUNT;
+
+        case CCL_INFO_QUEUE:
+            return param_name != CL_QUEUE_REFERENCE_COUNT;
+
+        case CCL_INFO_PIPE:
+            return CL_TRUE;
+
+        default:
+            /* Build info and everything else is always queried. */
+            return CL_FALSE;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Information value interned in the process-wide table of shared
+ * strings.
+ * */
+struct ccl_wrapper_info_shared {
 
     /**
-     * Mutex for controlling thread access to the OpenCL object
-     * information table.
+     * The shared information object. Must be the first field, so that the
+     * information object can be converted back to the shared one.
      * @private
      * */
-    GMutex mutex;
+    CCLWrapperInfo info;
+
+    /**
+     * Number of information tables holding this value. Only updated while
+     * holding the lock of the table of shared strings.
+     * @private
+     * */
+    guint refs;
 
 };
 
-/* ********************************* */
-/* ****** Protected methods ******** */
-/* ********************************* */
+/* Process-wide table of shared strings, keyed by string value (lazy
+ * initialized, destroyed when it becomes empty). */
+static GHashTable * info_shared = NULL;
+
+/* Lock protecting the table of shared strings. */
+static GMutex info_shared_lock;
 
 /**
- * Create a new ::CCLWrapper object. This function is called by the concrete
- * wrapper constructors.
+ * @internal
  *
- * @protected @memberof ccl_wrapper
+ * @brief Determine if a given information parameter is an immutable string
+ * which is usually the same in many objects (e.g. the extensions supported
+ * by sub-devices of the same device), and is therefore kept in the
+ * process-wide table of shared strings instead of being copied into each
+ * information table.
  *
- * @param[in] class Class or type of OpenCL object to wrap.
- * @param[in] cl_object OpenCL object to wrap.
- * @param[in] size Size in bytes of wrapper.
- * @return A new wrapper object.
+ * @param[in] info_type Type of information query.
+ * @param[in] param_name Name of the information parameter.
+ * @return `CL_TRUE` if the parameter is to be shared, `CL_FALSE` otherwise.
  * */
-CCLWrapper * ccl_wrapper_new(CCLClass class, void * cl_object, size_t size) {
+static cl_bool ccl_wrapper_info_is_shared(
+    CCLInfo info_type, cl_uint param_name) {
+
+    switch (info_type) {
+
+        case CCL_INFO_DEVICE:
+            switch (param_name) {
+                case CL_DEVICE_NAME:
+                case CL_DEVICE_VENDOR:
+                case CL_DRIVER_VERSION:
+                case CL_DEVICE_PROFILE:
+                case CL_DEVICE_VERSION:
+                case CL_DEVICE_EXTENSIONS:
+#ifdef CL_VERSION_1_1
+                case CL_DEVICE_OPENCL_C_VERSION:
+#endif
+#ifdef CL_VERSION_1_2
+                case CL_DEVICE_BUILT_IN_KERNELS:
+#endif
+#ifdef CL_VERSION_2_1
+                case CL_DEVICE_IL_VERSION:
+#endif
+                    return CL_TRUE;
+                default:
+                    return CL_FALSE;
+            }
 
-    /* Make sure OpenCL object is not NULL. */
-    g_return_val_if_fail(cl_object != NULL, NULL);
+        case CCL_INFO_PLATFORM:
+            switch (param_name) {
+                case CL_PLATFORM_PROFILE:
+                case CL_PLATFORM_VERSION:
+                case CL_PLATFORM_NAME:
+                case CL_PLATFORM_VENDOR:
+                case CL_PLATFORM_EXTENSIONS:
+                    return CL_TRUE;
+                default:
+                    return CL_FALSE;
+            }
 
-    /* The new wrapper object. */
-    CCLWrapper * w;
+        default:
+            return CL_FALSE;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Get a shared copy of a string information value, adding it to the
+ * process-wide table of shared strings if not already there.
+ *
+ * @param[in] info Information object holding a null-terminated string. It
+ * remains owned by the caller.
+ * @return The shared information object, with the same value as `info`,
+ * which must be released with ccl_wrapper_info_unshare().
+ * */
+static CCLWrapperInfo * ccl_wrapper_info_share(CCLWrapperInfo * info) {
 
-    /* Lock access to table of all existing wrappers. */
-    G_LOCK(wrappers);
+    struct ccl_wrapper_info_shared * shared;
 
-    /* If table of all existing wrappers is not yet initialized,
-     * initialize it. */
-    if (wrappers == NULL) {
-        wrappers = g_hash_table_new_full(
-            g_direct_hash, g_direct_equal, NULL, NULL);
+    g_mutex_lock(&info_shared_lock);
+
+    if (info_shared == NULL)
+        info_shared = g_hash_table_new(g_str_hash, g_str_equal);
+
+    shared = g_hash_table_lookup(info_shared, info->value);
+    if (shared == NULL) {
+        shared = g_slice_new(struct ccl_wrapper_info_shared);
+        shared->info.value = g_memdup(info->value, (guint) info->size);
+        shared->info.size = info->size;
+        shared->refs = 0;
+        g_hash_table_insert(info_shared, shared->info.value, shared);
     }
+    shared->refs++;
 
-    /* Check if requested wrapper already exists, and get it if so. */
-    w = g_hash_table_lookup(wrappers, cl_object);
+    g_mutex_unlock(&info_shared_lock);
 
-    if (w == NULL) {
+    return &shared->info;
+}
 
-        /* Wrapper doesn't yet exist, create it. */
-        w = (CCLWrapper *) g_slice_alloc0(size);
-        w->class = class;
-        w->cl_object = cl_object;
+/**
+ * @internal
+ *
+ * @brief Release a shared information object obtained with
+ * ccl_wrapper_info_share(), removing it from the process-wide table of
+ * shared strings if no longer used.
+ *
+ * @param[in] info Shared information object to release.
+ * */
+static void ccl_wrapper_info_unshare(CCLWrapperInfo * info) {
 
-        /* Initialize info table. */
-        w->info = g_slice_new0(struct ccl_wrapper_info_table);
-        g_mutex_init(&w->info->mutex);
+    struct ccl_wrapper_info_shared * shared =
+        (struct ccl_wrapper_info_shared *) info;
 
-        /* Insert newly created wrapper in table of all existing
-         * wrappers. */
-        g_hash_table_insert(wrappers, cl_object, w);
+    g_mutex_lock(&info_shared_lock);
 
+    if (--shared->refs == 0) {
+        g_hash_table_remove(info_shared, shared->info.value);
+        g_free(shared->info.value);
+        g_slice_free(struct ccl_wrapper_info_shared, shared);
+        if (g_hash_table_size(info_shared) == 0) {
+            g_hash_table_destroy(info_shared);
+            info_shared = NULL;
+        }
     }
 
-    /* Increase reference count of wrapper. */
-    ccl_wrapper_ref(w);
+    g_mutex_unlock(&info_shared_lock);
+}
+
+/* Initial number of slots in the information table of a wrapper. Must be a
+ * power of two. */
+#define CCL_WRAPPER_INFO_SLOTS_INIT 8
+
+/* Maximum size in bytes of information values which are queried directly
+ * into a stack buffer when refreshing already cached information. */
+#define CCL_WRAPPER_INFO_STACK_SIZE 64
+
+/* Bits of the readers field of information tables which hold the number of
+ * queries in progress. The remaining bits hold the reader generation. */
+#define CCL_WRAPPER_INFO_READERS_MASK 0xFFFFu
+
+/**
+ * @internal
+ *
+ * @brief Entry in the information table of a wrapper.
+ *
+ * Entries are never removed from the table while the wrapper exists. The key
+ * fields are immutable once the entry is published, while the info object
+ * and the validity flag are atomically updated.
+ * */
+struct ccl_wrapper_info_entry {
+
+    /**
+     * Name of the information parameter (key).
+     * @private
+     * */
+    cl_uint param_name;
+
+    /**
+     * Type of information query (key). Information added directly with
+     * ccl_wrapper_add_info() has type ::CCL_INFO_END.
+     * @private
+     * */
+    CCLInfo info_type;
+
+    /**
+     * Secondary OpenCL object involved in the query, or `NULL` (key).
+     * @private
+     * */
+    void * cl_object2;
+
+    /**
+     * Cached information object.
+     * @private
+     * */
+    CCLWrapperInfo * info;
+
+    /**
+     * Size in bytes of the value in the information object, as accounted
+     * for in the information table.
+     * @private
+     * */
+    size_t capacity;
+
+    /**
+     * Is the information parameter immutable during the lifetime of the
+     * wrapped object?
+     * @private
+     * */
+    cl_bool immutable;
+
+    /**
+     * Does the cached information hold an actual value (i.e., not a zeroed
+     * placeholder returned due to an error)?
+     * @private
+     * */
+    gint valid;
+
+    /**
+     * Is the information object kept in the process-wide table of shared
+     * strings? Shared information is never modified or replaced.
+     * @private
+     * */
+    cl_bool shared;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Open-addressing array of information table entries.
+ *
+ * Slots are only ever filled, never emptied, so readers can probe them
+ * without locking. When the array becomes too full, a larger one is
+ * published and the previous one is retired until the wrapper is destroyed.
+ * */
+struct ccl_wrapper_info_slots {
+
+    /**
+     * Number of slots minus one.
+     * @private
+     * */
+    guint mask;
+
+    /**
+     * The slots.
+     * @private
+     * */
+    struct ccl_wrapper_info_entry * entries[];
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Information object replaced in the information table, kept until
+ * no lock-free reader may still be using it.
+ * */
+struct ccl_wrapper_info_retired {
+
+    /**
+     * Replaced information object.
+     * @private
+     * */
+    CCLWrapperInfo * info;
+
+    /**
+     * Size in bytes accounted for the replaced information object.
+     * @private
+     * */
+    size_t capacity;
+
+    /**
+     * Reader generation when the information object was replaced.
+     * @private
+     * */
+    guint generation;
+
+};
+
+/**
+ * Information about wrapped OpenCL objects.
+ *
+ * Lookups are lock-free. Immutable parameters are cached once and never
+ * queried again, while refreshed values of mutable parameters are copied in
+ * place when they fit in the storage of the cached value, and published as
+ * new information objects otherwise.
+ * */
+struct ccl_wrapper_info_table {
+
+    /**
+     * Current array of information entries (lazy initialized).
+     * @private
+     * */
+    struct ccl_wrapper_info_slots * slots;
+
+    /**
+     * Number of entries in the information table.
+     * @private
+     * */
+    guint num_entries;
+
+    /**
+     * List of retired slot arrays.
+     * @private
+     * */
+    GSList * old_slots;
+
+    /**
+     * List of replaced information objects (::ccl_wrapper_info_retired).
+     * Information is only replaced when a refreshed value no longer fits in
+     * the storage allocated for it, or when it is explicitly replaced with
+     * ccl_wrapper_add_info(). Replaced objects are released once no
+     * information query in progress when they were replaced remains, i.e.
+     * once there are no readers or the reader generation has advanced.
+     * @private
+     * */
+    GSList * old_info;
+
+    /**
+     * Number of information queries in progress, which may be using
+     * information objects obtained without locking (lower bits, see
+     * ::CCL_WRAPPER_INFO_READERS_MASK), and reader generation (upper bits),
+     * advanced atomically with the last query in progress completing.
+     * @private
+     * */
+    gint readers;
+
+    /**
+     * Bytes held by current information values in this table.
+     * @private
+     * */
+    gsize info_bytes;
+
+    /**
+     * Bytes held by replaced information values in the old information
+     * list.
+     * @private
+     * */
+    gsize old_info_bytes;
+
+    /**
+     * Mutex for serializing updates to the OpenCL object information
+     * table.
+     * @private
+     * */
+    GMutex mutex;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Compute the slot index where the probing for an information table
+ * entry starts.
+ * */
+static inline guint ccl_wrapper_info_hash(cl_uint param_name,
+    CCLInfo info_type, void * cl_object2, guint mask) {
+
+    guint32 h = param_name ^ ((guint32) info_type << 24)
+        ^ (guint32) (((guint64) (gsize) cl_object2) >> 3);
+    return (guint) ((h * 2654435769u) >> 8) & mask;
+}
+
+/**
+ * @internal
+ *
+ * @brief Find an entry in the information table, without locking.
+ *
+ * @param[in] table Information table.
+ * @param[in] param_name Name of the information parameter.
+ * @param[in] info_type Type of information query.
+ * @param[in] cl_object2 Secondary OpenCL object involved in the query.
+ * @return The requested entry or `NULL` if not found.
+ * */
+static struct ccl_wrapper_info_entry * ccl_wrapper_info_lookup(
+    CCLWrapperInfoTable * table, cl_uint param_name, CCLInfo info_type,
+    void * cl_object2) {
+
+    struct ccl_wrapper_info_slots * slots = g_atomic_pointer_get(&table->slots);
+    struct ccl_wrapper_info_entry * entry;
+    guint i;
+
+    if (slots == NULL) return NULL;
+
+    /* Linear probing, stops at the first empty slot. */
+    i = ccl_wrapper_info_hash(param_name, info_type, cl_object2, slots->mask);
+    while ((entry = g_atomic_pointer_get(&slots->entries[i])) != NULL) {
+        if ((entry->param_name == param_name)
+            && (entry->info_type == info_type)
+            && (entry->cl_object2 == cl_object2))
+            return entry;
+        i = (i + 1) & slots->mask;
+    }
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Place an entry in the given slots array. Must be called with the
+ * information table mutex held, unless the slots array isn't published.
+ * */
+static void ccl_wrapper_info_slots_put(struct ccl_wrapper_info_slots * slots,
+    struct ccl_wrapper_info_entry * entry) {
+
+    guint i = ccl_wrapper_info_hash(entry->param_name, entry->info_type,
+        entry->cl_object2, slots->mask);
+    while (slots->entries[i] != NULL) i = (i + 1) & slots->mask;
+    g_atomic_pointer_set(&slots->entries[i], entry);
+}
+
+/**
+ * @internal
+ *
+ * @brief Insert a new entry in the information table, growing it if
+ * necessary. Must be called with the information table mutex held.
+ * */
+static void ccl_wrapper_info_insert(CCLWrapperInfoTable * table,
+    struct ccl_wrapper_info_entry * entry) {
+
+    struct ccl_wrapper_info_slots * slots = table->slots;
+    guint num_slots = (slots != NULL) ? slots->mask + 1 : 0;
+
+    /* Keep load factor at or below one half. */
+    if (2 * (table->num_entries + 1) > num_slots) {
+
+        struct ccl_wrapper_info_slots * new_slots;
+        guint new_num_slots =
+            MAX(CCL_WRAPPER_INFO_SLOTS_INIT, 2 * num_slots);
+
+        new_slots = g_malloc0(sizeof(struct ccl_wrapper_info_slots)
+            + new_num_slots * sizeof(struct ccl_wrapper_info_entry *));
+        new_slots->mask = new_num_slots - 1;
+
+        /* Rehash existing entries into the new slots array. */
+        for (guint i = 0; i < num_slots; ++i)
+            if (slots->entries[i] != NULL)
+                ccl_wrapper_info_slots_put(new_slots, slots->entries[i]);
+
+        /* Publish the new slots array, retire the previous one, as
+         * lock-free readers may still be probing it. */
+        g_atomic_pointer_set(&table->slots, new_slots);
+        if (slots != NULL)
+            table->old_slots = g_slist_prepend(table->old_slots, slots);
+        slots = new_slots;
+    }
+
+    ccl_wrapper_info_slots_put(slots, entry);
+    table->num_entries++;
+}
+
+/**
+ * @internal
+ *
+ * @brief Begin an information query, during which information objects
+ * obtained without locking are not released.
+ *
+ * @param[in] table Information table.
+ * */
+static inline void ccl_wrapper_info_read_begin(CCLWrapperInfoTable * table) {
+    g_atomic_int_inc(&table->readers);
+}
+
+/**
+ * @internal
+ *
+ * @brief End an information query, advancing the reader generation if no
+ * other query is in progress.
+ *
+ * @param[in] table Information table.
+ * */
+static inline void ccl_wrapper_info_read_end(CCLWrapperInfoTable * table) {
+
+    guint old_readers, new_readers;
+
+    /* The generation is advanced in the same atomic operation which
+     * completes the last query, so no query can begin in between. */
+    do {
+        old_readers = (guint) g_atomic_int_get(&table->readers);
+        new_readers = old_readers - 1;
+        if ((new_readers & CCL_WRAPPER_INFO_READERS_MASK) == 0)
+            new_readers += CCL_WRAPPER_INFO_READERS_MASK + 1;
+    } while (!g_atomic_int_compare_and_exchange(
+        &table->readers, (gint) old_readers, (gint) new_readers));
+}
+
+/**
+ * @internal
+ *
+ * @brief Release replaced information objects which no information query
+ * can still be using. Must be called with the information table mutex held.
+ *
+ * An object replaced in a given reader generation can be released once
+ * there are no readers, or once the generation has advanced, since all
+ * queries in progress when it was replaced have completed by then.
+ *
+ * @param[in] wrapper Wrapper which owns the information table.
+ * */
+static void ccl_wrapper_info_reclaim(CCLWrapper * wrapper) {
+
+    CCLWrapperInfoTable * table = wrapper->info;
+    struct ccl_wrapper_class_counters * counters =
+        &class_counters[wrapper->class];
+    GSList ** link = &table->old_info;
+    guint readers, generation;
+    cl_bool quiescent;
+
+    if (table->old_info == NULL) return;
+
+    readers = (guint) g_atomic_int_get(&table->readers);
+    generation = readers & ~CCL_WRAPPER_INFO_READERS_MASK;
+    quiescent = ((readers & CCL_WRAPPER_INFO_READERS_MASK) == 0);
+
+    while (*link != NULL) {
+        struct ccl_wrapper_info_retired * retired = (*link)->data;
+        if (quiescent || (retired->generation != generation)) {
+            GSList * next = (*link)->next;
+            table->old_info_bytes -= retired->capacity;
+            g_atomic_pointer_add(&counters->old_info_bytes,
+                -(gssize) retired->capacity);
+            ccl_wrapper_info_destroy(retired->info);
+            g_slice_free(struct ccl_wrapper_info_retired, retired);
+            g_slist_free_1(*link);
+            *link = next;
+        } else {
+            link = &(*link)->next;
+        }
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Can the cached information of an entry be refreshed in place with
+ * a value of the given size?
+ *
+ * @param[in] entry Information table entry, may be `NULL`.
+ * @param[in] size Size in bytes of the new value.
+ * @param[in] shared Is the new value a shared information object?
+ * @return `CL_TRUE` if the value can be refreshed in place, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_wrapper_info_fits(
+    struct ccl_wrapper_info_entry * entry, size_t size, cl_bool shared) {
+
+    return (entry != NULL) && !entry->shared && !shared
+        && (entry->info_type != CCL_INFO_END) && (size <= entry->capacity);
+}
+
+/**
+ * @internal
+ *
+ * @brief Refresh the cached information of an entry in place. Must be
+ * called with the information table mutex held, and only if
+ * ccl_wrapper_info_fits() holds for the new value.
+ *
+ * Values with the size of an `int` or of a pointer, such as the execution
+ * status of events, reference counts or profiling times, are stored
+ * atomically, so lock-free readers never observe partially updated values.
+ *
+ * @param[in] entry Information table entry.
+ * @param[in] value New value, or `NULL` for an all-zeros value.
+ * @param[in] size Size in bytes of the new value.
+ * @param[in] valid Does the new value hold an actual value?
+ * */
+static void ccl_wrapper_info_refresh(struct ccl_wrapper_info_entry * entry,
+    const void * value, size_t size, cl_bool valid) {
+
+    CCLWrapperInfo * info = entry->info;
+
+    if (size == sizeof(gint)) {
+        gint v = 0;
+        if (value != NULL) memcpy(&v, value, size);
+        g_atomic_int_set((gint *) info->value, v);
+    } else if (size == sizeof(gpointer)) {
+        gpointer v = NULL;
+        if (value != NULL) memcpy(&v, value, size);
+        g_atomic_pointer_set((gpointer *) info->value, v);
+    } else if (size > 0) {
+        if (value != NULL)
+            memcpy(info->value, value, size);
+        else
+            memset(info->value, 0, size);
+    }
+    info->size = size;
+    g_atomic_int_set(&entry->valid, valid);
+}
+
+/**
+ * @internal
+ *
+ * @brief Store information in the information table, updating the
+ * respective entry if it already exists. Must be called with the information
+ * table mutex held.
+ *
+ * If the entry exists and the new value fits in the storage of the cached
+ * one, the cached value is refreshed in place and `info` remains owned by
+ * the caller. Otherwise `info` is atomically published in place of the
+ * existing information object, which is retired until no information query
+ * can still be using it.
+ *
+ * @param[in] wrapper Wrapper which owns the information table.
+ * @param[in] param_name Name of the information parameter.
+ * @param[in] info_type Type of information query.
+ * @param[in] cl_object2 Secondary OpenCL object involved in the query.
+ * @param[in] info New information, owned by the table after the call if it
+ * is the returned object.
+ * @param[in] valid Does `info` hold an actual value?
+ * @param[in] shared Is `info` a shared information object obtained with
+ * ccl_wrapper_info_share()? Its size is then not accounted for in the
+ * table.
+ * @return The information object kept in the table.
+ * */
+static CCLWrapperInfo * ccl_wrapper_info_store(CCLWrapper * wrapper,
+    cl_uint param_name, CCLInfo info_type, void * cl_object2,
+    CCLWrapperInfo * info, cl_bool valid, cl_bool shared) {
+
+    CCLWrapperInfoTable * table = wrapper->info;
+    struct ccl_wrapper_class_counters * counters =
+        &class_counters[wrapper->class];
+    struct ccl_wrapper_info_entry * entry = ccl_wrapper_info_lookup(
+        table, param_name, info_type, cl_object2);
+
+    if (entry == NULL) {
+
+        /* Create and insert a new entry. */
+        entry = g_slice_new(struct ccl_wrapper_info_entry);
+        entry->param_name = param_name;
+        entry->info_type = info_type;
+        entry->cl_object2 = cl_object2;
+        entry->info = info;
+        entry->capacity = info->size;
+        entry->immutable = (info_type != CCL_INFO_END)
+            && ccl_wrapper_info_is_immutable(info_type, param_name);
+        entry->valid = valid;
+        entry->shared = shared;
+        ccl_wrapper_info_insert(table, entry);
+
+        /* Account for the new value, unless it is shared. */
+        if (!shared) {
+            table->info_bytes += info->size;
+            g_atomic_pointer_add(&counters->info_bytes, (gssize) info->size);
+        }
+
+    } else if (entry->shared) {
+
+        /* Shared information is immutable and always valid, so it was
+         * stored meanwhile by another thread. Keep it. */
+
+    } else if (ccl_wrapper_info_fits(entry, info->size, shared)) {
+
+        /* Refresh the cached value in place. */
+        ccl_wrapper_info_refresh(entry, info->value, info->size, valid);
+
+    } else {
+
+        /* Replace existing information object and retire it. */
+        struct ccl_wrapper_info_retired * retired =
+            g_slice_new(struct ccl_wrapper_info_retired);
+        retired->info = entry->info;
+        retired->capacity = entry->capacity;
+
+        /* Account for the retired and new values. */
+        size_t new_size = shared ? 0 : info->size;
+        table->info_bytes += new_size - entry->capacity;
+        table->old_info_bytes += entry->capacity;
+        g_atomic_pointer_add(&counters->info_bytes,
+            (gssize) new_size - (gssize) entry->capacity);
+        g_atomic_pointer_add(&counters->old_info_bytes,
+            (gssize) entry->capacity);
+
+        entry->capacity = info->size;
+        entry->shared = shared;
+        g_atomic_pointer_set(&entry->info, info);
+        g_atomic_int_set(&entry->valid, valid);
+
+        /* The reader generation is read after the new object is published,
+         * so queries started after it advances can't obtain the retired
+         * one. */
+        retired->generation = (guint) g_atomic_int_get(&table->readers)
+            & ~CCL_WRAPPER_INFO_READERS_MASK;
+        table->old_info = g_slist_prepend(table->old_info, retired);
+    }
+
+    /* Release replaced information no longer in use. */
+    ccl_wrapper_info_reclaim(wrapper);
+
+    return entry->info;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release all memory held by the information table of a wrapper,
+ * except the table itself.
+ * */
+static void ccl_wrapper_info_table_clear(CCLWrapper * wrapper) {
+
+    CCLWrapperInfoTable * table = wrapper->info;
+    struct ccl_wrapper_class_counters * counters =
+        &class_counters[wrapper->class];
+
+    /* Discount the values held by the table. */
+    g_atomic_pointer_add(&counters->info_bytes, -(gssize) table->info_bytes);
+    g_atomic_pointer_add(
+        &counters->old_info_bytes, -(gssize) table->old_info_bytes);
+
+    if (table->slots != NULL) {
+        for (guint i = 0; i <= table->slots->mask; ++i) {
+            struct ccl_wrapper_info_entry * entry = table->slots->entries[i];
+            if (entry != NULL) {
+                if (entry->shared)
+                    ccl_wrapper_info_unshare(entry->info);
+                else
+                    ccl_wrapper_info_destroy(entry->info);
+                g_slice_free(struct ccl_wrapper_info_entry, entry);
+            }
+        }
+        g_free(table->slots);
+    }
+    g_slist_free_full(table->old_slots, g_free);
+    for (GSList * link = table->old_info; link != NULL; link = link->next) {
+        struct ccl_wrapper_info_retired * retired = link->data;
+        ccl_wrapper_info_destroy(retired->info);
+        g_slice_free(struct ccl_wrapper_info_retired, retired);
+    }
+    g_slist_free(table->old_info);
+    g_mutex_clear(&table->mutex);
+}
+
+/* Alignment of wrapper blocks handed out by the wrapper allocator. */
+#define CCL_WRAPPER_BLOCK_ALIGN (2 * sizeof(gpointer))
+
+/* Number of wrapper blocks in each slab allocated by the wrapper
+ * allocator. */
+#define CCL_WRAPPER_SLAB_BLOCKS 64
+
+/* Maximum number of free wrapper blocks per class kept in the free list of
+ * each thread. When exceeded, half of them are returned to the global free
+ * list of the respective class. */
+#define CCL_WRAPPER_TCACHE_MAX (2 * CCL_WRAPPER_SLAB_BLOCKS)
+
+/* Round size up to the wrapper block alignment. */
+#define CCL_WRAPPER_ALIGN_SIZE(size) \
+    (((size) + CCL_WRAPPER_BLOCK_ALIGN - 1) & ~(CCL_WRAPPER_BLOCK_ALIGN - 1))
+
+/**
+ * @internal
+ *
+ * @brief Header of a free wrapper block, used for chaining free blocks.
+ * */
+struct ccl_wrapper_block {
+
+    /**
+     * Next free block.
+     * @private
+     * */
+    struct ccl_wrapper_block * next;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Global wrapper allocator state for a given wrapper class.
+ *
+ * Wrappers of the same class have the same size. Each wrapper block holds
+ * the concrete wrapper followed by its information table, so that both are
+ * obtained with a single allocation. Blocks are carved from slabs of
+ * contiguous memory, which improves locality when iterating over wrappers
+ * of the same class, e.g. queue events.
+ * */
+struct ccl_wrapper_pool {
+
+    /**
+     * Size in bytes of concrete wrappers of this class, atomically set on
+     * first allocation.
+     * @private
+     * */
+    gint wrapper_size;
+
+    /**
+     * Global list of free blocks of this class.
+     * @private
+     * */
+    struct ccl_wrapper_block * free_list;
+
+    /**
+     * Number of blocks in the global list of free blocks.
+     * @private
+     * */
+    guint num_free;
+
+    /**
+     * Lock for synchronizing access to this pool. Statically allocated, so
+     * it doesn't need to be initialized.
+     * @private
+     * */
+    GMutex mutex;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Per-thread free lists of wrapper blocks, one for each wrapper
+ * class.
+ * */
+struct ccl_wrapper_tcache {
+
+    /**
+     * Per-class lists of free blocks.
+     * @private
+     * */
+    struct ccl_wrapper_block * free_list[CCL_NONE + 1];
+
+    /**
+     * Number of blocks in each per-class list of free blocks.
+     * @private
+     * */
+    guint num_free[CCL_NONE + 1];
+
+};
+
+/* Global wrapper pools, one per wrapper class, including the CCL_NONE
+ * pseudo-class. */
+static struct ccl_wrapper_pool wrapper_pools[CCL_NONE + 1];
+
+/* Size in bytes of a wrapper block for wrappers of the given size. */
+#define CCL_WRAPPER_BLOCK_SIZE(wrapper_size) \
+    (CCL_WRAPPER_ALIGN_SIZE(wrapper_size) \
+    + CCL_WRAPPER_ALIGN_SIZE(sizeof(struct ccl_wrapper_info_table)))
+
+/**
+ * @internal
+ *
+ * @brief Return the free blocks of a thread to the global pools. Called when
+ * a thread which allocated or released wrappers terminates.
+ *
+ * @param[in] data The ::ccl_wrapper_tcache object of the terminating thread.
+ * */
+static void ccl_wrapper_tcache_release(gpointer data) {
+
+    struct ccl_wrapper_tcache * tcache = (struct ccl_wrapper_tcache *) data;
+
+    for (guint c = 0; c <= CCL_NONE; ++c) {
+
+        /* Find the last block in the thread's list for this class. */
+        struct ccl_wrapper_block * last = tcache->free_list[c];
+        if (last == NULL) continue;
+        while (last->next != NULL) last = last->next;
+
+        /* Prepend the thread's list to the global list. */
+        g_mutex_lock(&wrapper_pools[c].mutex);
+        last->next = wrapper_pools[c].free_list;
+        wrapper_pools[c].free_list = tcache->free_list[c];
+        wrapper_pools[c].num_free += tcache->num_free[c];
+        g_mutex_unlock(&wrapper_pools[c].mutex);
+    }
+
+    g_slice_free(struct ccl_wrapper_tcache, tcache);
+}
+
+/* Per-thread free lists of wrapper blocks. */
+static GPrivate wrapper_tcache = G_PRIVATE_INIT(ccl_wrapper_tcache_release);
+
+/**
+ * @internal
+ *
+ * @brief Get the free lists of wrapper blocks for the current thread,
+ * creating them if necessary.
+ *
+ * @return The free lists of wrapper blocks for the current thread.
+ * */
+static struct ccl_wrapper_tcache * ccl_wrapper_tcache_get() {
+
+    struct ccl_wrapper_tcache * tcache = g_private_get(&wrapper_tcache);
+
+    if (tcache == NULL) {
+        tcache = g_slice_new0(struct ccl_wrapper_tcache);
+        g_private_set(&wrapper_tcache, tcache);
+    }
+
+    return tcache;
+}
+
+/**
+ * @internal
+ *
+ * @brief Allocate a zeroed wrapper block, containing the concrete wrapper
+ * followed by its information table.
+ *
+ * Blocks are taken from the current thread free list for the given class.
+ * If it's empty, it's refilled with a batch of blocks from the global free
+ * list of the class or, if that is also empty, with the blocks of a newly
+ * allocated slab.
+ *
+ * @param[in] class Class of wrapper to allocate.
+ * @param[in] size Size in bytes of wrapper.
+ * @return A new zeroed wrapper, with its `info` field pointing to its
+ * zeroed information table.
+ * */
+static CCLWrapper * ccl_wrapper_alloc(CCLClass class, size_t size) {
+
+    struct ccl_wrapper_pool * pool = &wrapper_pools[class];
+    struct ccl_wrapper_tcache * tcache;
+    struct ccl_wrapper_block * block;
+    CCLWrapper * w;
+    gsize block_size = CCL_WRAPPER_BLOCK_SIZE(size);
+
+    /* Set size of wrappers of this class, if not already set. */
+    g_atomic_int_compare_and_exchange(&pool->wrapper_size, 0, (gint) size);
+
+    /* Wrapper sizes are fixed per class, this should never happen. Fall
+     * back to the slice allocator just in case. */
+    if ((size_t) g_atomic_int_get(&pool->wrapper_size) != size) {
+        block = g_slice_alloc(block_size);
+        goto init_block;
+    }
+
+    tcache = ccl_wrapper_tcache_get();
+
+    /* Refill thread free list if empty. */
+    if (tcache->free_list[class] == NULL) {
+
+        g_mutex_lock(&pool->mutex);
+
+        if (pool->free_list != NULL) {
+
+            /* Move a batch of blocks from the global free list. */
+            struct ccl_wrapper_block * last = pool->free_list;
+            guint n = 1;
+            while ((n < CCL_WRAPPER_SLAB_BLOCKS) && (last->next != NULL)) {
+                last = last->next;
+                ++n;
+            }
+            tcache->free_list[class] = pool->free_list;
+            pool->free_list = last->next;
+            pool->num_free -= n;
+            last->next = NULL;
+            tcache->num_free[class] = n;
+
+        }
+
+        g_mutex_unlock(&pool->mutex);
+
+        if (tcache->free_list[class] == NULL) {
+
+            /* Allocate a new slab and chain its blocks. Slabs are never
+             * released, their blocks are recycled. */
+            gchar * slab = g_malloc(CCL_WRAPPER_SLAB_BLOCKS * block_size);
+            for (guint i = 0; i < CCL_WRAPPER_SLAB_BLOCKS; ++i) {
+                block = (struct ccl_wrapper_block *) (slab + i * block_size);
+                block->next = (i + 1 < CCL_WRAPPER_SLAB_BLOCKS)
+                    ? (struct ccl_wrapper_block *) (slab + (i + 1) * block_size)
+                    : NULL;
+            }
+            tcache->free_list[class] = (struct ccl_wrapper_block *) slab;
+            tcache->num_free[class] = CCL_WRAPPER_SLAB_BLOCKS;
+        }
+    }
+
+    /* Pop a block from the thread free list. */
+    block = tcache->free_list[class];
+    tcache->free_list[class] = block->next;
+    tcache->num_free[class]--;
+
+init_block:
+
+    /* Initialize block, set info table location. */
+    memset(block, 0, block_size);
+    w = (CCLWrapper *) block;
+    w->info = (CCLWrapperInfoTable *)
+        (((gchar *) block) + CCL_WRAPPER_ALIGN_SIZE(size));
+
+    return w;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release a wrapper block allocated with ccl_wrapper_alloc().
+ *
+ * The block is placed in the current thread free list for its class. If
+ * that list becomes too long, half of it is moved to the global free list
+ * of the class.
+ *
+ * @param[in] w Wrapper to release.
+ * @param[in] size Size in bytes of wrapper.
+ * */
+static void ccl_wrapper_free(CCLWrapper * w, size_t size) {
+
+    CCLClass class = w->class;
+    struct ccl_wrapper_pool * pool = &wrapper_pools[class];
+    struct ccl_wrapper_tcache * tcache;
+    struct ccl_wrapper_block * block = (struct ccl_wrapper_block *) w;
+
+    /* Blocks not allocated from the pool go back to the slice
+     * allocator. */
+    if ((size_t) g_atomic_int_get(&pool->wrapper_size) != size) {
+        g_slice_free1(CCL_WRAPPER_BLOCK_SIZE(size), block);
+        return;
+    }
+
+    tcache = ccl_wrapper_tcache_get();
+
+    /* Push block into thread free list. */
+    block->next = tcache->free_list[class];
+    tcache->free_list[class] = block;
+    tcache->num_free[class]++;
+
+    /* If the thread free list is too long, move the surplus to the global
+     * free list. */
+    if (tcache->num_free[class] > CCL_WRAPPER_TCACHE_MAX) {
+
+        struct ccl_wrapper_block * first = tcache->free_list[class];
+        struct ccl_wrapper_block * last = first;
+        guint n = CCL_WRAPPER_TCACHE_MAX / 2;
+
+        for (guint i = 1; i < n; ++i) last = last->next;
+        tcache->free_list[class] = last->next;
+        tcache->num_free[class] -= n;
+
+        g_mutex_lock(&pool->mutex);
+        last->next = pool->free_list;
+        pool->free_list = first;
+        pool->num_free += n;
+        g_mutex_unlock(&pool->mutex);
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Increase the reference count of a wrapper found in the table of
+ * all existing wrappers, but only if it is not being destroyed.
+ *
+ * A reference count of zero means that the last reference was dropped and
+ * that the wrapper is about to be removed from the table and destroyed by
+ * another thread. Such a wrapper must never be resurrected. This function
+ * must be called with the lock of the wrapper's shard held, which
+ * guarantees that the wrapper memory is still valid.
+ *
+ * @param[in] w A wrapper found in the table of all existing wrappers.
+ * @return `CL_TRUE` if the reference count was increased, `CL_FALSE` if the
+ * wrapper is being destroyed.
+ * */
+static cl_bool ccl_wrapper_ref_if_alive(CCLWrapper * w) {
+
+    /* Current reference count. */
+    int ref_count;
+
+    /* Try to atomically increment the reference count, unless it is zero. */
+    do {
+        ref_count = g_atomic_int_get(&w->ref_count);
+        if (ref_count == 0) return CL_FALSE;
+    } while (!g_atomic_int_compare_and_exchange(
+        &w->ref_count, ref_count, ref_count + 1));
+
+#ifdef CCL_DEBUG_OBJ_LIFETIME
+
+    /* Log referencing of wrapper. */
+    g_debug("New/ref. CCL%s(%p)",
+        ccl_wrapper_get_class_name(w), (void *) w->cl_object);
+
+#endif
+
+    return CL_TRUE;
+}
+
+/* ********************************* */
+/* ****** Protected methods ******** */
+/* ********************************* */
+
+/**
+ * @internal
+ *
+ * @brief Increment the number of existing wrappers of the given class,
+ * updating the respective peak if necessary.
+ *
+ * @param[in] class Wrapper class.
+ * */
+static void ccl_wrapper_count_live(CCLClass class) {
+
+    struct ccl_wrapper_class_counters * counters = &class_counters[class];
+    gint live = g_atomic_int_add(&counters->live, 1) + 1;
+    gint peak;
+
+    do {
+        peak = g_atomic_int_get(&counters->peak);
+    } while ((live > peak)
+        && !g_atomic_int_compare_and_exchange(&counters->peak, peak, live));
+}
+
+/**
+ * Create a new ::CCLWrapper object. This function is called by the concrete
+ * wrapper constructors.
+ *
+ * @protected @memberof ccl_wrapper
+ *
+ * @param[in] class Class or type of OpenCL object to wrap.
+ * @param[in] cl_object OpenCL object to wrap.
+ * @param[in] size Size in bytes of wrapper.
+ * @return A new wrapper object.
+ * */
+CCLWrapper * ccl_wrapper_new(CCLClass class, void * cl_object, size_t size) {
+
+    /* Make sure OpenCL object is not NULL. */
+    g_return_val_if_fail(cl_object != NULL, NULL);
+
+    /* The new wrapper object. */
+    CCLWrapper * w;
+
+    /* Shard of the table of all existing wrappers where the wrapper for the
+     * given OpenCL object is kept. */
+    union ccl_wrapper_shard * shard = ccl_wrapper_get_shard(cl_object);
+
+    /* Lock access to the shard. */
+    ccl_wrapper_shard_lock(shard);
+
+    /* If the shard is not yet initialized, initialize it. */
+    if (shard->s.table == NULL) {
+        shard->s.table = g_hash_table_new_full(
+            g_direct_hash, g_direct_equal, NULL, NULL);
+    }
+
+    /* Check if requested wrapper already exists, and get it if so. */
+    w = g_hash_table_lookup(shard->s.table, cl_object);
+
+    /* If the wrapper exists but its last reference was dropped by another
+     * thread which has not removed it from the table yet, detach it from
+     * the table so that it is not found again, and create a new one. The
+     * destroying thread will not touch the table entry, since it no longer
+     * refers to the dying wrapper. */
+    if ((w != NULL) && (!ccl_wrapper_ref_if_alive(w))) {
+        g_hash_table_steal(shard->s.table, cl_object);
+        w = NULL;
+    }
+
+    if (w == NULL) {
+
+        /* Wrapper doesn't yet exist, create it. */
+        w = ccl_wrapper_alloc(class, size);
+        w->class = class;
+        w->cl_object = cl_object;
+
+        /* Initialize info table, allocated together with the wrapper. */
+        g_mutex_init(&w->info->mutex);
+
+        /* Insert newly created wrapper in table of all existing
+         * wrappers. */
+        g_hash_table_insert(shard->s.table, cl_object, w);
+
+        /* Set reference count of the new wrapper to 1. */
+        ccl_wrapper_ref(w);
+
+        /* Update number of existing wrappers of this class. */
+        ccl_wrapper_count_live(class);
+
+    }
 
-    /* Unlock access to table of all existing wrappers. */
-    G_UNLOCK(wrappers);
+    /* Unlock access to the shard. */
+    g_mutex_unlock(&shard->s.mutex);
 
     /* Return requested wrapper. */
     return w;
@@ -201,6 +1603,9 @@ cl_bool ccl_wrapper_unref(CCLWrapper * wrapper, size_t size,
     /* OpenCL status flag. */
     cl_int ocl_status;
 
+    /* Shard of the table of all existing wrappers where wrapper is kept. */
+    union ccl_wrapper_shard * shard;
+
 #ifdef CCL_DEBUG_OBJ_LIFETIME
 
     /* Log destruction/unreferencing of wrapper. */
@@ -209,12 +1614,34 @@ cl_bool ccl_wrapper_unref(CCLWrapper * wrapper, size_t size,
 
 #endif
 
-    /* Decrement reference count and check if it reaches 0. */
+    /* Decrement reference count and check if it reaches 0. This is a pure
+     * atomic operation, the table of all existing wrappers is only accessed
+     * when the last reference is dropped. */
     if (g_atomic_int_dec_and_test(&wrapper->ref_count)) {
 
         /* Ref. count reached 0, so wrapper will be destroyed. */
         destroyed = CL_TRUE;
 
+        /* Remove wrapper from its shard of the static table before
+         * releasing the OpenCL object, since the OpenCL implementation may
+         * reuse the object address right after the release. The wrapper is
+         * only removed if it still is the one associated with its OpenCL
+         * object, as a concurrent ccl_wrapper_new() may have replaced it.
+         * Release the shard table if empty. */
+        shard = ccl_wrapper_get_shard(wrapper->cl_object);
+        ccl_wrapper_shard_lock(shard);
+        if ((shard->s.table != NULL) && (g_hash_table_lookup(
+                shard->s.table, wrapper->cl_object) == wrapper)) {
+
+            g_hash_table_remove(shard->s.table, wrapper->cl_object);
+        }
+        if ((shard->s.table != NULL)
+            && (g_hash_table_size(shard->s.table) == 0)) {
+            g_hash_table_destroy(shard->s.table);
+            shard->s.table = NULL;
+        }
+        g_mutex_unlock(&shard->s.mutex);
+
         /* Release the OpenCL wrapped object. */
         if (rel_cl_fun != NULL) {
             ocl_status = rel_cl_fun(wrapper->cl_object);
@@ -227,32 +1654,17 @@ cl_bool ccl_wrapper_unref(CCLWrapper * wrapper, size_t size,
         }
 
         /* Destroy table containing wrapped object information. */
-        if (wrapper->info->table != NULL) {
-            g_hash_table_destroy(wrapper->info->table);
-        }
-        if (wrapper->info->old_info != NULL) {
-            g_slist_free_full(wrapper->info->old_info,
-                (GDestroyNotify) ccl_wrapper_info_destroy);
-        }
-        g_mutex_clear(&wrapper->info->mutex);
-        g_slice_free(struct ccl_wrapper_info_table, wrapper->info);
-
-        /* Remove wrapper from static table, release static table if
-         * empty. */
-        G_LOCK(wrappers);
-        g_hash_table_remove(wrappers, wrapper->cl_object);
-        if (g_hash_table_size(wrappers) == 0) {
-            g_hash_table_destroy(wrappers);
-            wrappers = NULL;
-        }
-        G_UNLOCK(wrappers);
+        ccl_wrapper_info_table_clear(wrapper);
 
         /* Destroy remaining wrapper fields. */
         if (rel_fields_fun != NULL)
             rel_fields_fun(wrapper);
 
-        /* Destroy wrapper. */
-        g_slice_free1(size, wrapper);
+        /* Update number of existing wrappers of this class. */
+        g_atomic_int_add(&class_counters[wrapper->class].live, -1);
+
+        /* Destroy wrapper, together with its info table. */
+        ccl_wrapper_free(wrapper, size);
 
     }
 
@@ -260,6 +1672,76 @@ cl_bool ccl_wrapper_unref(CCLWrapper * wrapper, size_t size,
     return destroyed;
 }
 
+/**
+ * @internal
+ *
+ * @brief Replace the OpenCL object wrapped by a wrapper object with another
+ * OpenCL object of the same class, releasing the former.
+ *
+ * The information cached for the former OpenCL object is discarded. The
+ * caller must guarantee that no other thread uses the wrapper while the
+ * OpenCL object is replaced, and that the new OpenCL object is not already
+ * wrapped.
+ *
+ * @protected @memberof ccl_wrapper
+ *
+ * @param[in] wrapper The wrapper object.
+ * @param[in] cl_object The new OpenCL object, whose reference is transferred
+ * to the wrapper.
+ * @param[in] rel_cl_fun Function for releasing the former OpenCL object.
+ * */
+void ccl_wrapper_rewrap(CCLWrapper * wrapper, void * cl_object,
+    ccl_wrapper_release_cl_object rel_cl_fun) {
+
+    /* Make sure wrapper object is not NULL. */
+    g_return_if_fail(wrapper != NULL);
+    /* Make sure OpenCL object is not NULL. */
+    g_return_if_fail(cl_object != NULL);
+
+    /* Former OpenCL object. */
+    void * cl_object_old = wrapper->cl_object;
+
+    /* Shard of the table of all existing wrappers. */
+    union ccl_wrapper_shard * shard;
+
+    /* Remove wrapper from the shard of the former OpenCL object,
+     * releasing the shard table if empty. */
+    shard = ccl_wrapper_get_shard(cl_object_old);
+    ccl_wrapper_shard_lock(shard);
+    if ((shard->s.table != NULL) && (g_hash_table_lookup(
+            shard->s.table, cl_object_old) == wrapper)) {
+
+        g_hash_table_remove(shard->s.table, cl_object_old);
+    }
+    if ((shard->s.table != NULL)
+        && (g_hash_table_size(shard->s.table) == 0)) {
+        g_hash_table_destroy(shard->s.table);
+        shard->s.table = NULL;
+    }
+    g_mutex_unlock(&shard->s.mutex);
+
+    /* Discard information about the former OpenCL object and reinitialize
+     * the info table. */
+    ccl_wrapper_info_table_clear(wrapper);
+    memset(wrapper->info, 0, sizeof(CCLWrapperInfoTable));
+    g_mutex_init(&wrapper->info->mutex);
+
+    /* Wrap the new OpenCL object and insert wrapper in its shard. */
+    wrapper->cl_object = cl_object;
+    shard = ccl_wrapper_get_shard(cl_object);
+    ccl_wrapper_shard_lock(shard);
+    if (shard->s.table == NULL) {
+        shard->s.table = g_hash_table_new_full(
+            g_direct_hash, g_direct_equal, NULL, NULL);
+    }
+    g_hash_table_insert(shard->s.table, cl_object, wrapper);
+    g_mutex_unlock(&shard->s.mutex);
+
+    /* Release the former OpenCL object. */
+    if (rel_cl_fun != NULL)
+        rel_cl_fun(cl_object_old);
+}
+
 /**
  * @internal
  *
@@ -283,43 +1765,50 @@ void ccl_wrapper_add_info(CCLWrapper * wrapper, cl_uint param_name,
     /* Lock access to info table. */
     g_mutex_lock(&wrapper->info->mutex);
 
-    /* If information table is not yet initialized, then
-     * initialize it. */
-    if (wrapper->info->table == NULL) {
-        wrapper->info->table = g_hash_table_new_full(
-            g_direct_hash, g_direct_equal,
-            NULL, (GDestroyNotify) ccl_wrapper_info_destroy);
-    }
-
-    /* Check if information with same key as already present in
-     * table... */
-    if (g_hash_table_contains(
-            wrapper->info->table, GUINT_TO_POINTER(param_name))) {
-
-        /* ...if so, move this information to the old information
-         * table. */
-
-        /* Get existing information... */
-        CCLWrapperInfo * info_old =
-            (CCLWrapperInfo *) g_hash_table_lookup(
-                wrapper->info->table, GUINT_TO_POINTER(param_name));
+    /* Keep new information in information table. If information with the
+     * same key is already present, it is moved to the old information
+     * list. */
+    ccl_wrapper_info_store(wrapper, param_name, CCL_INFO_END, NULL,
+        info, CL_TRUE, CL_FALSE);
 
-        /* ...and put it in table of old information. */
-        wrapper->info->old_info =
-            g_slist_prepend(wrapper->info->old_info, info_old);
+    /* Unlock access to info table. */
+    g_mutex_unlock(&wrapper->info->mutex);
+}
 
-        /* Remove old info from info table without destroying it. */
-        g_hash_table_steal(
-            wrapper->info->table, GUINT_TO_POINTER(param_name));
+/**
+ * @internal
+ *
+ * @brief Keep a ::CCLWrapperInfo object in the info table of the given
+ * wrapper as the result of the given information query, which is then
+ * served from cache if the respective parameter is immutable.
+ *
+ * @protected @memberof ccl_wrapper
+ *
+ * @param[in] wrapper Wrapper to add info to.
+ * @param[in] param_name Name of information parameter.
+ * @param[in] info_type Type of information query.
+ * @param[in] info Info object to add, owned by the wrapper after the call.
+ * */
+void ccl_wrapper_cache_info(CCLWrapper * wrapper, cl_uint param_name,
+    CCLInfo info_type, CCLWrapperInfo * info) {
 
-    }
+    /* Information object kept in the info table. */
+    CCLWrapperInfo * info_kept;
 
-    /* Keep new information in information table. */
-    g_hash_table_insert(wrapper->info->table,
-        GUINT_TO_POINTER(param_name), info);
+    /* Make sure wrapper is not NULL. */
+    g_return_if_fail(wrapper != NULL);
+    /* Make sure info is not NULL. */
+    g_return_if_fail(info != NULL);
+    /* Make sure info_type has a valid value. */
+    g_return_if_fail((info_type >= 0) && (info_type < CCL_INFO_END));
 
-    /* Unlock access to info table. */
+    /* Keep information in information table. If the value is copied into
+     * information already in the table, release the given object. */
+    g_mutex_lock(&wrapper->info->mutex);
+    info_kept = ccl_wrapper_info_store(wrapper, param_name, info_type, NULL,
+        info, CL_TRUE, CL_FALSE);
     g_mutex_unlock(&wrapper->info->mutex);
+    if (info_kept != info) ccl_wrapper_info_destroy(info);
 }
 
 /**
@@ -336,8 +1825,10 @@ CCLWrapperInfo * ccl_wrapper_info_new(size_t size) {
 
     CCLWrapperInfo * info = g_slice_new(CCLWrapperInfo);
 
+    /* Values are heap allocated, and not slice allocated, because their
+     * size may later be set to less than the allocated size. */
     if (size > 0)
-        info->value = g_slice_alloc0(size);
+        info->value = g_malloc0(size);
     else
         info->value = NULL;
     info->size = size;
@@ -360,8 +1851,7 @@ void ccl_wrapper_info_destroy(CCLWrapperInfo * info) {
     /* Make sure info is not NULL. */
     g_return_if_fail(info != NULL);
 
-    if (info->size > 0)
-        g_slice_free1(info->size, info->value);
+    g_free(info->value);
     g_slice_free(CCLWrapperInfo, info);
 
 }
@@ -373,6 +1863,10 @@ void ccl_wrapper_info_destroy(CCLWrapperInfo * info) {
 /**
  * Increase the reference count of the wrapper object.
  *
+ * This is a pure atomic operation which never locks the table of all
+ * existing wrappers. The caller must already own a reference to the
+ * wrapper.
+ *
  * @public @memberof ccl_wrapper
  *
  * @param[in] wrapper The wrapper object.
@@ -434,12 +1928,14 @@ void * ccl_wrapper_unwrap(CCLWrapper * wrapper) {
 }
 
 /**
- * Get information about any wrapped OpenCL object.
+ * @internal
  *
- * This function should not be directly invoked in most circumstances. Use the
- * `ccl_*_get_info_*()` macros instead.
+ * @brief Get information about any wrapped OpenCL object, possibly with a
+ * single OpenCL call.
  *
- * @public @memberof ccl_wrapper
+ * If `size_hint` is larger than zero, the value is queried directly into a
+ * buffer of that size, skipping the query for the value size. If the buffer
+ * turns out to be too small, the usual two calls are performed.
  *
  * @param[in] wrapper1 The wrapper object to query.
  * @param[in] wrapper2 A second wrapper object, required in some
@@ -447,108 +1943,204 @@ void * ccl_wrapper_unwrap(CCLWrapper * wrapper) {
  * @param[in] param_name Name of information/parameter to get.
  * @param[in] min_size Minimum size of returned information object in
  * case of error.
+ * @param[in] size_hint Expected size of the information value, or zero if
+ * unknown.
  * @param[in] info_type Type of information query to perform.
  * @param[in] use_cache `CL_TRUE` if cached information is to be used,
  * `CL_FALSE` to force a new query even if information is in cache.
+ * @param[out] status Return location for the query status, or `NULL`.
+ * It is set to `CL_SUCCESS`, to the OpenCL error code of a failed query,
+ * or to ::CCL_WRAPPER_INFO_UNAVAILABLE if the information is unavailable.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return The requested information object. This object will
- * be automatically freed when the respective wrapper object is
- * destroyed. If an error occurs, either `NULL` (if `min_size == 0`), or
- * a `min_size`d information object is returned (if `min_size > 0`).
+ * @return The requested information object (see ccl_wrapper_get_info()).
  * */
-CCL_EXPORT
-CCLWrapperInfo * ccl_wrapper_get_info(CCLWrapper * wrapper1,
+static CCLWrapperInfo * ccl_wrapper_get_info_full(CCLWrapper * wrapper1,
     CCLWrapper * wrapper2, cl_uint param_name, size_t min_size,
-    CCLInfo info_type, cl_bool use_cache, CCLErr ** err) {
-
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
-
-    /* Make sure wrapper1 is not NULL. */
-    g_return_val_if_fail(wrapper1 != NULL, NULL);
-
-    /* Make sure info_type has a valid value. */
-    g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), NULL);
+    size_t size_hint, CCLInfo info_type, cl_bool use_cache,
+    cl_int * status, CCLErr ** err) {
 
     /* Information object. */
     CCLWrapperInfo * info = NULL;
 
-    /* Does info table cache contain requested information? */
-    gboolean contains;
+    /* Information object kept in the info table. */
+    CCLWrapperInfo * info_kept;
+
+    /* Cached entry for the requested information, if any. */
+    struct ccl_wrapper_info_entry * entry;
+
+    /* Secondary OpenCL object involved in the query, part of the key. */
+    void * cl_object2 = (wrapper2 != NULL) ? wrapper2->cl_object : NULL;
 
     /* Information function to use. */
     ccl_wrapper_info_fp info_fun = info_funs[info_type];
 
-    /* Check if info table cache contains requested information. */
-    g_mutex_lock(&wrapper1->info->mutex);
-    contains = wrapper1->info->table != NULL
-        ? g_hash_table_contains(
-            wrapper1->info->table, GUINT_TO_POINTER(param_name))
-        : FALSE;
-    g_mutex_unlock(&wrapper1->info->mutex);
+    /* Let's query OpenCL object.*/
+    cl_int ocl_status = CL_SUCCESS;
+    /* Size of device information in bytes. */
+    size_t size_ret = 0;
+    /* Stack storage for small values being refreshed, which are only
+     * copied to the heap if they changed. */
+    union {
+        char bytes[CCL_WRAPPER_INFO_STACK_SIZE];
+        cl_ulong align;
+    } buf;
+    /* Wrapper info object around the stack storage. */
+    CCLWrapperInfo info_buf;
+    /* Is the information kept in the table of shared strings? */
+    cl_bool shared;
+
+    /* Assume the query will succeed. */
+    if (status != NULL) *status = CL_SUCCESS;
+
+    /* Information objects obtained without locking are not released until
+     * the query completes. */
+    ccl_wrapper_info_read_begin(wrapper1->info);
+
+    /* Check, without locking, if info table cache contains valid requested
+     * information which can be used, i.e. if the cache is to be used or if
+     * the information is immutable during the lifetime of the object. */
+    entry = ccl_wrapper_info_lookup(
+        wrapper1->info, param_name, info_type, cl_object2);
+    if ((entry != NULL) && g_atomic_int_get(&entry->valid)
+        && (use_cache || entry->immutable)) {
 
-    /* Check if it is required to query OpenCL object, i.e. if info
-     * table cache is not to be used or info table cache does not
-     * contain requested info.  */
-    if ((!use_cache) || (!contains)) {
+        /* Requested info is already present in the info table,
+         * retrieve it from there. */
+        info = g_atomic_pointer_get(&entry->info);
+        goto finish;
+    }
 
-        /* Let's query OpenCL object.*/
-        cl_int ocl_status;
-        /* Size of device information in bytes. */
-        size_t size_ret = 0;
+    /* If the size of the information is known beforehand, try to get it
+     * with a single call. */
+    if (size_hint > 0) {
+
+        /* Use stack storage if information is already cached and is small,
+         * otherwise allocate memory for information. */
+        if ((entry != NULL) && (size_hint <= CCL_WRAPPER_INFO_STACK_SIZE)) {
+            info_buf.value = buf.bytes;
+            info_buf.size = size_hint;
+            info = &info_buf;
+        } else {
+            info = ccl_wrapper_info_new(size_hint);
+        }
 
-        /* Get size of information. */
+        /* Get information and its actual size. */
         ocl_status = (wrapper2 == NULL)
             ? ((ccl_wrapper_info_fp1) info_fun)(wrapper1->cl_object,
-                param_name, 0, NULL, &size_ret)
+                param_name, size_hint, info->value, &size_ret)
             : ((ccl_wrapper_info_fp2) info_fun)(wrapper1->cl_object,
-                wrapper2->cl_object, param_name, 0, NULL, &size_ret);
-
-        /* Avoid bug in Apple OpenCL implementation. */
-#if defined(__APPLE__) || defined(__MACOSX)
-        if ((ocl_status == CL_INVALID_VALUE)
-            && (info_fun == (ccl_wrapper_info_fp) clGetEventProfilingInfo))
-            ocl_status = CL_SUCCESS;
-#endif
-
+                wrapper2->cl_object, param_name, size_hint, info->value,
+                &size_ret);
+
+        /* An invalid value may be due to a too small buffer, so in that
+         * case fall back to querying the size first. Other errors are
+         * reported immediately. */
+        if ((ocl_status == CL_SUCCESS) && (size_ret > 0)
+            && (size_ret <= size_hint)) {
+            info->size = size_ret;
+            goto store;
+        }
         ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-            CL_SUCCESS != ocl_status, ocl_status, error_handler,
-            "%s: get info [size] (OpenCL error %d: %s).",
+            (CL_SUCCESS != ocl_status) && (CL_INVALID_VALUE != ocl_status),
+            ocl_status, error_handler,
+            "%s: get info (OpenCL error %d: %s).",
             CCL_STRD, ocl_status, ccl_err(ocl_status));
-        ccl_if_err_create_goto(*err, CCL_ERROR, size_ret == 0,
-            CCL_ERROR_INFO_UNAVAILABLE_OCL, error_handler,
-            "%s: the requested info is unavailable (info size is 0).",
-            CCL_STRD);
 
-        /* Allocate memory for information. */
-        info = ccl_wrapper_info_new(size_ret);
+        /* Release buffer, it will be allocated again with correct size. */
+        if (info != &info_buf) ccl_wrapper_info_destroy(info);
+        info = NULL;
+        size_ret = 0;
+    }
 
-        /* Get information. */
-        ocl_status = (wrapper2 == NULL)
-            ? ((ccl_wrapper_info_fp1) info_fun)(wrapper1->cl_object,
-                param_name, size_ret, info->value, NULL)
-            : ((ccl_wrapper_info_fp2) info_fun)(wrapper1->cl_object,
-                wrapper2->cl_object, param_name, size_ret, info->value,
-                NULL);
-        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-            CL_SUCCESS != ocl_status, ocl_status, error_handler,
-            "%s: get context info [info] (OpenCL error %d: %s).",
-            CCL_STRD, ocl_status, ccl_err(ocl_status));
+    /* Get size of information. */
+    ocl_status = (wrapper2 == NULL)
+        ? ((ccl_wrapper_info_fp1) info_fun)(wrapper1->cl_object,
+            param_name, 0, NULL, &size_ret)
+        : ((ccl_wrapper_info_fp2) info_fun)(wrapper1->cl_object,
+            wrapper2->cl_object, param_name, 0, NULL, &size_ret);
 
-        /* Keep information in information table. */
-        ccl_wrapper_add_info(wrapper1, param_name, info);
+    /* Avoid bug in Apple OpenCL implementation. */
+#if defined(__APPLE__) || defined(__MACOSX)
+    if ((ocl_status == CL_INVALID_VALUE)
+        && (info_fun == (ccl_wrapper_info_fp) clGetEventProfilingInfo))
+        ocl_status = CL_SUCCESS;
+#endif
 
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: get info [size] (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+    ccl_if_err_create_goto(*err, CCL_ERROR, size_ret == 0,
+        CCL_ERROR_INFO_UNAVAILABLE_OCL, error_handler,
+        "%s: the requested info is unavailable (info size is 0).",
+        CCL_STRD);
+
+    /* If the information is already cached and is small, query it into
+     * stack storage, since it is likely unchanged. Otherwise allocate
+     * memory for information. */
+    if ((entry != NULL) && (size_ret <= CCL_WRAPPER_INFO_STACK_SIZE)) {
+        info_buf.value = buf.bytes;
+        info_buf.size = size_ret;
+        info = &info_buf;
     } else {
+        info = ccl_wrapper_info_new(size_ret);
+    }
 
-        /* Requested info is already present in the info table,
-         * retrieve it from there. */
-        g_mutex_lock(&wrapper1->info->mutex);
-        info = g_hash_table_lookup(
-            wrapper1->info->table, GUINT_TO_POINTER(param_name));
-        g_mutex_unlock(&wrapper1->info->mutex);
+    /* Get information. */
+    ocl_status = (wrapper2 == NULL)
+        ? ((ccl_wrapper_info_fp1) info_fun)(wrapper1->cl_object,
+            param_name, size_ret, info->value, NULL)
+        : ((ccl_wrapper_info_fp2) info_fun)(wrapper1->cl_object,
+            wrapper2->cl_object, param_name, size_ret, info->value,
+            NULL);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: get context info [info] (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+store:
+
+    /* Remember size of information for future queries of the same
+     * parameter in objects of the same type. */
+    ccl_wrapper_info_size_set(info_type, param_name, size_ret);
+
+    /* Strings which are usually the same in many objects are kept in the
+     * process-wide table of shared strings, and not copied into the
+     * information table of each object. */
+    shared = ccl_wrapper_info_is_shared(info_type, param_name)
+        && (((char *) info->value)[info->size - 1] == '\0');
+    if (shared) {
+        info_kept = ccl_wrapper_info_share(info);
+        if (info != &info_buf) ccl_wrapper_info_destroy(info);
+        info = info_kept;
+    }
+
+    /* Stack storage can't be published, so make sure it is heap allocated
+     * if the value can't be refreshed in place. */
+    g_mutex_lock(&wrapper1->info->mutex);
+    entry = ccl_wrapper_info_lookup(
+        wrapper1->info, param_name, info_type, cl_object2);
+    if ((info == &info_buf)
+        && !ccl_wrapper_info_fits(entry, info->size, shared)) {
+        info = ccl_wrapper_info_new(size_ret);
+        memcpy(info->value, buf.bytes, size_ret);
+    }
+
+    /* Keep information in information table, refreshing the cached value
+     * in place if it fits. */
+    info_kept = ccl_wrapper_info_store(wrapper1, param_name, info_type,
+        cl_object2, info, CL_TRUE, shared);
+    g_mutex_unlock(&wrapper1->info->mutex);
 
+    /* If value was refreshed in place, release the queried information. */
+    if ((info_kept != info) && (info != &info_buf)) {
+        if (shared)
+            ccl_wrapper_info_unshare(info);
+        else
+            ccl_wrapper_info_destroy(info);
     }
+    info = info_kept;
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -558,19 +2150,214 @@ error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
 
-    /* In case of error, return an all-zeros info if min_size is > 0. */
+    /* Report query status. The information is unavailable if the size
+     * query succeeded but returned zero. */
+    if (status != NULL)
+        *status = (ocl_status != CL_SUCCESS)
+            ? ocl_status : CCL_WRAPPER_INFO_UNAVAILABLE;
+
+    /* Release memory allocated for failed query, if any. */
+    if ((info != NULL) && (info != &info_buf))
+        ccl_wrapper_info_destroy(info);
+    info = NULL;
+
+    /* In case of error, return an all-zeros info if min_size is > 0. It is
+     * marked as not valid, so that the query is performed again next
+     * time. The storage of a cached value, such as the placeholder of a
+     * previous failure, is reused if large enough. */
     if (min_size > 0) {
-        if (info != NULL) ccl_wrapper_info_destroy(info);
-        info = ccl_wrapper_info_new(min_size);
-        ccl_wrapper_add_info(wrapper1, param_name, info);
+        g_mutex_lock(&wrapper1->info->mutex);
+        entry = ccl_wrapper_info_lookup(
+            wrapper1->info, param_name, info_type, cl_object2);
+        if (ccl_wrapper_info_fits(entry, min_size, CL_FALSE)) {
+            ccl_wrapper_info_refresh(entry, NULL, min_size, CL_FALSE);
+            info = entry->info;
+        } else {
+            info = ccl_wrapper_info_new(min_size);
+            info_kept = ccl_wrapper_info_store(wrapper1, param_name,
+                info_type, cl_object2, info, CL_FALSE, CL_FALSE);
+            if (info_kept != info) ccl_wrapper_info_destroy(info);
+            info = info_kept;
+        }
+        g_mutex_unlock(&wrapper1->info->mutex);
     }
 
 finish:
 
+    ccl_wrapper_info_read_end(wrapper1->info);
+
     /* Return the requested information. */
     return info;
 }
 
+/**
+ * Get information about any wrapped OpenCL object.
+ *
+ * This function should not be directly invoked in most circumstances. Use the
+ * `ccl_*_get_info_*()` macros instead.
+ *
+ * Parameters which cannot change during the lifetime of the OpenCL object
+ * (e.g. most device information) are only queried once, and are then
+ * returned from cache without locking, even if `use_cache` is `CL_FALSE`.
+ * Mutable parameters are queried again, and the cached value is refreshed
+ * in place when it fits in the storage of the previous value, so the same
+ * information object is returned and memory use stays constant when
+ * polling, e.g., the execution status of an event. Otherwise, the value is
+ * returned in a new information object, and the previous one is released
+ * once no information query in progress can still be using it. As such,
+ * the value of a mutable parameter is only valid until the next query of
+ * the same parameter in the same wrapper.
+ *
+ * The size of each queried parameter is remembered per information type,
+ * so that parameters with a size which doesn't vary between objects (e.g.
+ * `CL_DEVICE_MAX_WORK_ITEM_SIZES`) are obtained with a single OpenCL call
+ * in subsequent queries.
+ *
+ * Device and platform strings, such as `CL_DEVICE_EXTENSIONS` or
+ * `CL_PLATFORM_VERSION`, are kept in a process-wide table and shared by all
+ * wrappers with the same value, so the returned value must not be modified.
+ *
+ * @public @memberof ccl_wrapper
+ *
+ * @param[in] wrapper1 The wrapper object to query.
+ * @param[in] wrapper2 A second wrapper object, required in some
+ * queries.
+ * @param[in] param_name Name of information/parameter to get.
+ * @param[in] min_size Minimum size of returned information object in
+ * case of error.
+ * @param[in] info_type Type of information query to perform.
+ * @param[in] use_cache `CL_TRUE` if cached information is to be used,
+ * `CL_FALSE` to force a new query even if information is in cache.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The requested information object. This object will
+ * be automatically freed when the respective wrapper object is
+ * destroyed. If an error occurs, either `NULL` (if `min_size == 0`), or
+ * a `min_size`d information object is returned (if `min_size > 0`).
+ * */
+CCL_EXPORT
+CCLWrapperInfo * ccl_wrapper_get_info(CCLWrapper * wrapper1,
+    CCLWrapper * wrapper2, cl_uint param_name, size_t min_size,
+    CCLInfo info_type, cl_bool use_cache, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
+
+    /* Make sure wrapper1 is not NULL. */
+    g_return_val_if_fail(wrapper1 != NULL, NULL);
+
+    /* Make sure info_type has a valid value. */
+    g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), NULL);
+
+    /* Get information, using the previously observed size of this
+     * parameter, if any, to avoid querying the size. */
+    return ccl_wrapper_get_info_full(wrapper1, wrapper2, param_name,
+        min_size, ccl_wrapper_info_size_get(info_type, param_name),
+        info_type, use_cache, NULL, err);
+}
+
+/**
+ * Get pointer to a fixed-size (scalar) information value.
+ *
+ * This function should not be directly invoked in most circumstances. Use the
+ * `ccl_*_get_info_scalar()` macros instead.
+ *
+ * Since the size of the value is known, the information is obtained with a
+ * single OpenCL call, instead of first querying the value size.
+ *
+ * @public @memberof ccl_wrapper
+ *
+ * @param[in] wrapper1 The wrapper object to query.
+ * @param[in] wrapper2 A second wrapper object, required in some
+ * queries.
+ * @param[in] param_name Name of information/parameter to get value of.
+ * @param[in] size Size of the value, which is also the minimum size of the
+ * returned value in case of error.
+ * @param[in] info_type Type of information query to perform.
+ * @param[in] use_cache `CL_TRUE` if cached information is to be used,
+ * `CL_FALSE` to force a new query even if information is in cache.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A pointer to the requested information value. This
+ * value will be automatically freed when the wrapper object is
+ * destroyed. If an error occurs, a pointer to a `size`d zero value is
+ * returned.
+ * */
+CCL_EXPORT
+void * ccl_wrapper_get_info_scalar(CCLWrapper * wrapper1,
+    CCLWrapper * wrapper2, cl_uint param_name, size_t size,
+    CCLInfo info_type, cl_bool use_cache, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Make sure wrapper1 is not NULL. */
+    g_return_val_if_fail(wrapper1 != NULL, NULL);
+
+    /* Make sure info_type has a valid value. */
+    g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), NULL);
+
+    /* Get information object. */
+    ccl_wrapper_info_read_begin(wrapper1->info);
+    CCLWrapperInfo * diw = ccl_wrapper_get_info_full(wrapper1, wrapper2,
+        param_name, size, size, info_type, use_cache, NULL, err);
+
+    /* Get value if information object is not NULL. */
+    void * value = diw != NULL ? diw->value : NULL;
+    ccl_wrapper_info_read_end(wrapper1->info);
+
+    return value;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get pointer to a fixed-size (scalar) information value, reporting
+ * failure only through a status code.
+ *
+ * Unlike ccl_wrapper_get_info_scalar(), no error object is created and no
+ * error message is formatted, and no zero value is allocated on failure.
+ * This is meant for queries which are expected to fail in some
+ * circumstances (e.g. information unavailable in some platforms) and for
+ * polling loops, where such failures are frequent and cheap to handle.
+ *
+ * @param[in] wrapper1 The wrapper object to query.
+ * @param[in] wrapper2 A second wrapper object, required in some
+ * queries.
+ * @param[in] param_name Name of information/parameter to get value of.
+ * @param[in] size Size of the value.
+ * @param[in] info_type Type of information query to perform.
+ * @param[in] use_cache `CL_TRUE` if cached information is to be used,
+ * `CL_FALSE` to force a new query even if information is in cache.
+ * @param[out] status Return location for the query status: `CL_SUCCESS`,
+ * the OpenCL error code of a failed query, or
+ * ::CCL_WRAPPER_INFO_UNAVAILABLE if the information is unavailable.
+ * @return A pointer to the requested information value, or `NULL` if the
+ * query failed.
+ * */
+void * ccl_wrapper_get_info_scalar_status(CCLWrapper * wrapper1,
+    CCLWrapper * wrapper2, cl_uint param_name, size_t size,
+    CCLInfo info_type, cl_bool use_cache, cl_int * status) {
+
+    /* Make sure wrapper1 and status are not NULL. */
+    g_return_val_if_fail(wrapper1 != NULL, NULL);
+    g_return_val_if_fail(status != NULL, NULL);
+
+    /* Make sure info_type has a valid value. */
+    g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), NULL);
+
+    /* Get information object, ignoring error reporting. */
+    ccl_wrapper_info_read_begin(wrapper1->info);
+    CCLWrapperInfo * diw = ccl_wrapper_get_info_full(wrapper1, wrapper2,
+        param_name, 0, size, info_type, use_cache, status, NULL);
+
+    /* Get value if information object is not NULL. */
+    void * value = diw != NULL ? diw->value : NULL;
+    ccl_wrapper_info_read_end(wrapper1->info);
+
+    return value;
+}
+
 /**
  * Get pointer to information value.
  *
@@ -609,11 +2396,15 @@ void * ccl_wrapper_get_info_value(CCLWrapper * wrapper1,
     g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), NULL);
 
     /* Get information object. */
+    ccl_wrapper_info_read_begin(wrapper1->info);
     CCLWrapperInfo * diw = ccl_wrapper_get_info(wrapper1, wrapper2,
         param_name, min_size, info_type, use_cache, err);
 
-    /* Return value if information object is not NULL. */
-    return diw != NULL ? diw->value : NULL;
+    /* Get value if information object is not NULL. */
+    void * value = diw != NULL ? diw->value : NULL;
+    ccl_wrapper_info_read_end(wrapper1->info);
+
+    return value;
 }
 
 /**
@@ -651,11 +2442,61 @@ size_t ccl_wrapper_get_info_size(CCLWrapper * wrapper1,
     g_return_val_if_fail((info_type >= 0) && (info_type < CCL_INFO_END), 0);
 
     /* Get information object. */
+    ccl_wrapper_info_read_begin(wrapper1->info);
     CCLWrapperInfo * diw = ccl_wrapper_get_info(wrapper1, wrapper2,
         param_name, min_size, info_type, use_cache, err);
 
-    /* Return value if information object is not NULL. */
-    return diw != NULL ? diw->size : 0;
+    /* Get size if information object is not NULL. */
+    size_t size = diw != NULL ? diw->size : 0;
+    ccl_wrapper_info_read_end(wrapper1->info);
+
+    return size;
+}
+
+/**
+ * Get runtime statistics about existing wrappers.
+ *
+ * Unlike ccl_wrapper_memcheck(), which only reports whether any wrapper
+ * still exists, this function provides, for each wrapper class, the number
+ * of existing wrappers, its peak, and the memory held by information caches,
+ * as well as lock contention counters for the table of all existing
+ * wrappers. It is cheap enough to be periodically called for monitoring
+ * purposes. Counters are updated concurrently, so the returned values are
+ * a snapshot which may be slightly inconsistent if other threads are
+ * creating or destroying wrappers.
+ *
+ * @public @memberof ccl_wrapper
+ *
+ * @param[out] stats Location where to place the statistics.
+ * */
+CCL_EXPORT
+void ccl_wrapper_get_stats(CCLWrapperStats * stats) {
+
+    /* Make sure stats is not NULL. */
+    g_return_if_fail(stats != NULL);
+
+    /* Get per class counters. */
+    for (guint i = 0; i <= CCL_NONE; ++i) {
+        stats->classes[i].live =
+            (cl_uint) g_atomic_int_get(&class_counters[i].live);
+        stats->classes[i].peak =
+            (cl_uint) g_atomic_int_get(&class_counters[i].peak);
+        stats->classes[i].info_bytes =
+            (size_t) g_atomic_pointer_get(&class_counters[i].info_bytes);
+        stats->classes[i].old_info_bytes =
+            (size_t) g_atomic_pointer_get(&class_counters[i].old_info_bytes);
+    }
+
+    /* Sum lock counters of all shards of the table of all existing
+     * wrappers. */
+    stats->table_locks = 0;
+    stats->table_contentions = 0;
+    for (guint i = 0; i < CCL_WRAPPERS_NSHARDS; ++i) {
+        g_mutex_lock(&wrappers[i].s.mutex);
+        stats->table_locks += wrappers[i].s.num_locks;
+        stats->table_contentions += wrappers[i].s.num_contentions;
+        g_mutex_unlock(&wrappers[i].s.mutex);
+    }
 }
 
 /**
@@ -674,7 +2515,7 @@ CCL_EXPORT
 cl_bool ccl_wrapper_memcheck() {
 
     /* Check return variable. */
-    cl_bool check;
+    cl_bool check = CL_TRUE;
 
 #ifndef NDEBUG
 
@@ -688,57 +2529,70 @@ cl_bool ccl_wrapper_memcheck() {
     gpointer addr;
 
     /* Log string. */
-    GString * logstr = NULL;
+    GString * logstr = g_string_new("");
+
+    /* Number of existing wrappers. */
+    guint num_wrappers = 0;
 
 #endif
 
-    /* Lock access to wrappers variable. */
-    G_LOCK(wrappers);
+    /* Check each shard of the table of all existing wrappers. */
+    for (guint i = 0; i < CCL_WRAPPERS_NSHARDS; ++i) {
 
-    /* Check if wrappers variable is set. */
-    check = (wrappers == NULL);
+        /* Lock access to the current shard. */
+        g_mutex_lock(&wrappers[i].s.mutex);
 
-#ifndef NDEBUG
+        /* Check if the current shard is empty. */
+        if (wrappers[i].s.table != NULL) {
 
-    /* In debug mode, log existing wrappers. */
-    if (check) {
+            check = CL_FALSE;
 
-        /* Wrappers table is empty. */
-        g_debug("Wrappers table is empty");
+#ifndef NDEBUG
 
-    } else {
+            /* In debug mode, add existing wrappers to log string. */
+            num_wrappers += g_hash_table_size(wrappers[i].s.table);
 
-        /* Wrappers table is not empty, list them. */
+            /* Initialize iterator. */
+            g_hash_table_iter_init(&iter, wrappers[i].s.table);
 
-        /* Initialize iterator. */
-        g_hash_table_iter_init(&iter, wrappers);
+            /* Iterate over existing wrappers... */
+            while(g_hash_table_iter_next(&iter, &addr, (gpointer) &obj)) {
 
-        /* Initialize log string. */
-        logstr = g_string_new("");
-        g_string_append_printf(logstr,
-            "There are %u wrappers in table: ", g_hash_table_size(wrappers));
+                /*...and add their name and address to log string. */
+                g_string_append_printf(logstr, "\n%s(%p) ",
+                    ccl_wrapper_get_class_name(obj), addr);
 
-        /* Iterate over existing wrappers... */
-        while(g_hash_table_iter_next(&iter, &addr, (gpointer) &obj)) {
+            }
 
-            /*...and add their name and address to log string. */
-            g_string_append_printf(logstr, "\n%s(%p) ",
-                ccl_wrapper_get_class_name(obj), addr);
+#endif
 
         }
 
-        /* Log existing wrappers.*/
-        g_debug("%s\n", logstr->str);
+        /* Unlock access to the current shard. */
+        g_mutex_unlock(&wrappers[i].s.mutex);
+
+    }
+
+#ifndef NDEBUG
+
+    /* In debug mode, log existing wrappers. */
+    if (check) {
+
+        /* Wrappers table is empty. */
+        g_debug("Wrappers table is empty");
+
+    } else {
 
-        /* Release string. */
-        g_string_free(logstr, TRUE);
+        /* Wrappers table is not empty, log them. */
+        g_debug("There are %u wrappers in table: %s\n",
+            num_wrappers, logstr->str);
 
     }
 
-#endif
+    /* Release string. */
+    g_string_free(logstr, TRUE);
 
-    /* Unlock access to wrappers variable. */
-    G_UNLOCK(wrappers);
+#endif
 
     /* Return check. */
     return check;
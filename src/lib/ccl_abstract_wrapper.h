@@ -52,6 +52,67 @@ typedef struct ccl_wrapper_info {
 
 } CCLWrapperInfo;
 
+/**
+ * Runtime statistics for wrappers of a given class.
+ * */
+typedef struct ccl_wrapper_class_stats {
+
+    /**
+     * Number of currently existing wrappers.
+     * @public
+     * */
+    cl_uint live;
+
+    /**
+     * Maximum number of simultaneously existing wrappers.
+     * @public
+     * */
+    cl_uint peak;
+
+    /**
+     * Bytes held by current information values in the wrappers info
+     * caches.
+     * @public
+     * */
+    size_t info_bytes;
+
+    /**
+     * Bytes held by replaced information values, which are released once
+     * no information query can still be using them.
+     * @public
+     * */
+    size_t old_info_bytes;
+
+} CCLWrapperClassStats;
+
+/**
+ * Runtime statistics for all wrappers. Obtained with
+ * ccl_wrapper_get_stats().
+ * */
+typedef struct ccl_wrapper_stats {
+
+    /**
+     * Statistics per wrapper class, indexed by ::CCLClass.
+     * @public
+     * */
+    CCLWrapperClassStats classes[CCL_NONE + 1];
+
+    /**
+     * Number of times the table of all existing wrappers was locked for
+     * wrapping or releasing OpenCL objects.
+     * @public
+     * */
+    cl_ulong table_locks;
+
+    /**
+     * Number of times the table of all existing wrappers was contended,
+     * i.e. a thread had to wait because another thread held the lock.
+     * @public
+     * */
+    cl_ulong table_contentions;
+
+} CCLWrapperStats;
+
 /* Increase the reference count of the wrapper object. */
 CCL_EXPORT
 void ccl_wrapper_ref(CCLWrapper * wrapper);
@@ -77,12 +138,22 @@ void * ccl_wrapper_get_info_value(CCLWrapper * wrapper1,
     CCLWrapper * wrapper2, cl_uint param_name, size_t min_size,
     CCLInfo info_type, cl_bool use_cache, CCLErr ** err);
 
+/* Get pointer to fixed-size information value. */
+CCL_EXPORT
+void * ccl_wrapper_get_info_scalar(CCLWrapper * wrapper1,
+    CCLWrapper * wrapper2, cl_uint param_name, size_t size,
+    CCLInfo info_type, cl_bool use_cache, CCLErr ** err);
+
 /* Get information size. */
 CCL_EXPORT
 size_t ccl_wrapper_get_info_size(CCLWrapper * wrapper1,
     CCLWrapper * wrapper2, cl_uint param_name, size_t min_size,
     CCLInfo info_type, cl_bool use_cache, CCLErr ** err);
 
+/* Get runtime statistics about existing wrappers. */
+CCL_EXPORT
+void ccl_wrapper_get_stats(CCLWrapperStats * stats);
+
 /* Debug function which checks if memory allocated by wrappers
  * has been properly freed. */
 CCL_EXPORT
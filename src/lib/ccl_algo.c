@@ -0,0 +1,1298 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of parallel reduction, scan, compaction and sort
+ * primitives.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_algo.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_device_wrapper.h"
+#include "ccl_buffer_pool.h"
+#include "ccl_kernel_tune.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ * Prefix of the keys of the algorithm programs in the context cache of
+ * compiled programs.
+ * */
+#define CCL_ALGO_PROGRAM_KEY "ccl_algo"
+
+/**
+ * @internal
+ * Maximum work-group size used by the algorithm kernels.
+ * */
+#define CCL_ALGO_WG_MAX 256
+
+/**
+ * @internal
+ * Source of the algorithm kernels. The element type, the operation and
+ * the use of sub-groups are selected with preprocessor definitions. When
+ * `CCL_ALGO_FLAGS` is defined, input elements are `uint` flags which are
+ * loaded as one if non-zero and as zero otherwise, as required for
+ * compaction.
+ *
+ * Scans are performed in two kernels: `ccl_algo_scan_blocks` scans a
+ * contiguous chunk of the input per work-group and saves the total of
+ * each chunk, and `ccl_algo_scan_add` combines each chunk with the
+ * totals of the preceding ones. The number of work-groups never exceeds
+ * the work-group size, so that totals are combined by one work-group.
+ * */
+static const char * ccl_algo_src =
+    "#if defined(CCL_ALGO_TYPE_DOUBLE)\n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+    "typedef double T;\n"
+    "#define T_MIN (-INFINITY)\n"
+    "#define T_MAX INFINITY\n"
+    "#elif defined(CCL_ALGO_TYPE_FLOAT)\n"
+    "typedef float T;\n"
+    "#define T_MIN (-INFINITY)\n"
+    "#define T_MAX INFINITY\n"
+    "#elif defined(CCL_ALGO_TYPE_LONG)\n"
+    "typedef long T;\n"
+    "#define T_MIN LONG_MIN\n"
+    "#define T_MAX LONG_MAX\n"
+    "#elif defined(CCL_ALGO_TYPE_ULONG)\n"
+    "typedef ulong T;\n"
+    "#define T_MIN 0\n"
+    "#define T_MAX ULONG_MAX\n"
+    "#elif defined(CCL_ALGO_TYPE_UINT)\n"
+    "typedef uint T;\n"
+    "#define T_MIN 0\n"
+    "#define T_MAX UINT_MAX\n"
+    "#else\n"
+    "typedef int T;\n"
+    "#define T_MIN INT_MIN\n"
+    "#define T_MAX INT_MAX\n"
+    "#endif\n"
+    "#if defined(CCL_ALGO_OP_MIN)\n"
+    "#define OP(a, b) min(a, b)\n"
+    "#define ID ((T) T_MAX)\n"
+    "#define SG_OP min\n"
+    "#elif defined(CCL_ALGO_OP_MAX)\n"
+    "#define OP(a, b) max(a, b)\n"
+    "#define ID ((T) T_MIN)\n"
+    "#define SG_OP max\n"
+    "#else\n"
+    "#define OP(a, b) ((a) + (b))\n"
+    "#define ID ((T) 0)\n"
+    "#define SG_OP add\n"
+    "#endif\n"
+    "#ifdef CCL_ALGO_FLAGS\n"
+    "typedef uint IN_T;\n"
+    "#define LOAD(x) ((T) ((x) != 0))\n"
+    "#else\n"
+    "typedef T IN_T;\n"
+    "#define LOAD(x) (x)\n"
+    "#endif\n"
+    "#define CAT_(a, b) a ## b\n"
+    "#define CAT(a, b) CAT_(a, b)\n"
+    "#ifdef CCL_ALGO_SUBGROUPS\n"
+    "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n"
+    "#define LID (get_sub_group_id() * get_max_sub_group_size()"
+    " + get_sub_group_local_id())\n"
+    "#else\n"
+    "#define LID get_local_id(0)\n"
+    "#endif\n"
+    "T ccl_algo_wg_tree(T x, uint m, __local T * tmp) {\n"
+    "    uint lid = get_local_id(0), p = 1;\n"
+    "    while (p < m) p <<= 1;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    if (lid < p) tmp[lid] = (lid < m) ? x : ID;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (uint s = p >> 1; s > 0; s >>= 1) {\n"
+    "        if (lid < s) tmp[lid] = OP(tmp[lid], tmp[lid + s]);\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "    x = tmp[0];\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    return x;\n"
+    "}\n"
+    "T ccl_algo_wg_reduce(T x, __local T * tmp) {\n"
+    "#ifdef CCL_ALGO_SUBGROUPS\n"
+    "    uint lid = get_local_id(0), nsg = get_num_sub_groups();\n"
+    "    x = CAT(sub_group_reduce_, SG_OP)(x);\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    if (get_sub_group_local_id() == 0) tmp[get_sub_group_id()] = x;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    return ccl_algo_wg_tree((lid < nsg) ? tmp[lid] : ID, nsg, tmp);\n"
+    "#else\n"
+    "    return ccl_algo_wg_tree(x, get_local_size(0), tmp);\n"
+    "#endif\n"
+    "}\n"
+    "T ccl_algo_wg_scan(T x, __local T * tmp, T * excl, T * total) {\n"
+    "    uint lid = get_local_id(0);\n"
+    "#ifdef CCL_ALGO_SUBGROUPS\n"
+    "    uint sg = get_sub_group_id(), nsg = get_num_sub_groups();\n"
+    "    T incl = CAT(sub_group_scan_inclusive_, SG_OP)(x);\n"
+    "    T pre = CAT(sub_group_scan_exclusive_, SG_OP)(x);\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    if (get_sub_group_local_id() == get_sub_group_size() - 1)\n"
+    "        tmp[sg] = incl;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    T v = (lid < nsg) ? tmp[lid] : ID;\n"
+    "    for (uint s = 1; s < nsg; s <<= 1) {\n"
+    "        T y = ((lid >= s) && (lid < nsg)) ? tmp[lid - s] : ID;\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "        v = OP(y, v);\n"
+    "        if (lid < nsg) tmp[lid] = v;\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "    *excl = (sg > 0) ? OP(tmp[sg - 1], pre) : pre;\n"
+    "    incl = (sg > 0) ? OP(tmp[sg - 1], incl) : incl;\n"
+    "    *total = tmp[nsg - 1];\n"
+    "#else\n"
+    "    uint wg = get_local_size(0);\n"
+    "    T incl = x;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    tmp[lid] = x;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (uint s = 1; s < wg; s <<= 1) {\n"
+    "        T y = (lid >= s) ? tmp[lid - s] : ID;\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "        incl = OP(y, incl);\n"
+    "        tmp[lid] = incl;\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "    *excl = (lid > 0) ? tmp[lid - 1] : ID;\n"
+    "    *total = tmp[wg - 1];\n"
+    "#endif\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    return incl;\n"
+    "}\n"
+    "__kernel void ccl_algo_reduce(__global const IN_T * in,\n"
+    "    __global T * out, ulong n, __local T * tmp) {\n"
+    "    T x = ID;\n"
+    "    for (ulong i = get_global_id(0); i < n; i += get_global_size(0))\n"
+    "        x = OP(x, LOAD(in[i]));\n"
+    "    x = ccl_algo_wg_reduce(x, tmp);\n"
+    "    if (get_local_id(0) == 0) out[get_group_id(0)] = x;\n"
+    "}\n"
+    "__kernel void ccl_algo_scan_blocks(__global const IN_T * in,\n"
+    "    __global T * out, __global T * sums, ulong n, ulong chunk,\n"
+    "    uint inclusive, __local T * tmp) {\n"
+    "    ulong start = get_group_id(0) * chunk;\n"
+    "    ulong end = min(start + chunk, n);\n"
+    "    T carry = ID, excl, total;\n"
+    "    for (ulong b = start; b < end; b += get_local_size(0)) {\n"
+    "        ulong i = b + LID;\n"
+    "        T x = (i < end) ? LOAD(in[i]) : ID;\n"
+    "        T incl = ccl_algo_wg_scan(x, tmp, &excl, &total);\n"
+    "        if (i < end) out[i] = OP(carry, inclusive ? incl : excl);\n"
+    "        carry = OP(carry, total);\n"
+    "    }\n"
+    "    if (get_local_id(0) == 0) sums[get_group_id(0)] = carry;\n"
+    "}\n"
+    "__kernel void ccl_algo_scan_add(__global T * out,\n"
+    "    __global const T * sums, ulong n, ulong chunk, __local T * tmp) {\n"
+    "    uint g = get_group_id(0), lid = get_local_id(0);\n"
+    "    if (g == 0) return;\n"
+    "    T off = ccl_algo_wg_reduce((lid < g) ? sums[lid] : ID, tmp);\n"
+    "    ulong end = min((g + 1) * chunk, n);\n"
+    "    for (ulong i = g * chunk + lid; i < end; i += get_local_size(0))\n"
+    "        out[i] = OP(off, out[i]);\n"
+    "}\n"
+    "__kernel void ccl_algo_scatter(__global const T * in,\n"
+    "    __global const uint * flags, __global const uint * pos,\n"
+    "    __global T * out, __global uint * count, ulong n) {\n"
+    "    ulong i = get_global_id(0);\n"
+    "    if (i >= n) return;\n"
+    "    if (flags[i]) out[pos[i]] = in[i];\n"
+    "    if (i == n - 1) *count = pos[i] + (flags[i] != 0);\n"
+    "}\n";
+
+/**
+ * @internal
+ * Number of bits of the radix sort digits.
+ * */
+#define CCL_ALGO_SORT_BITS 4
+
+/**
+ * @internal
+ * Number of work-items per compute unit used by the radix sort.
+ * */
+#define CCL_ALGO_SORT_WI_PER_CU 1024
+
+/**
+ * @internal
+ * Source of the radix sort kernels. Keys are sorted as unsigned integers
+ * of 32 bits, or of 64 bits if `CCL_ALGO_SORT_64` is defined. Signed and
+ * floating point keys are mapped to unsigned integers of the same order
+ * when extracting digits. Values are moved with the keys if
+ * `CCL_ALGO_SORT_VALS` is defined.
+ *
+ * Each pass sorts one digit. The keys are split in one contiguous chunk
+ * per work-group. `ccl_algo_sort_hist` counts the digits of each chunk,
+ * digit-major, so that the exclusive scan of the counts gives the first
+ * output position of each digit of each chunk. `ccl_algo_sort_scatter`
+ * then moves the keys of each chunk to their positions, in order, so
+ * that the sort is stable.
+ * */
+static const char * ccl_algo_sort_src =
+    "#ifdef CCL_ALGO_SORT_64\n"
+    "typedef ulong K;\n"
+    "#define SIGN_BIT 0x8000000000000000UL\n"
+    "#define SIGN_SHIFT 63\n"
+    "#else\n"
+    "typedef uint K;\n"
+    "#define SIGN_BIT 0x80000000U\n"
+    "#define SIGN_SHIFT 31\n"
+    "#endif\n"
+    "#ifdef CCL_ALGO_SORT_VALS_64\n"
+    "typedef ulong V;\n"
+    "#else\n"
+    "typedef uint V;\n"
+    "#endif\n"
+    "#if defined(CCL_ALGO_SORT_FLOAT)\n"
+    "#define ORDER(k) ((k) ^ (((K) 0 - ((k) >> SIGN_SHIFT)) | SIGN_BIT))\n"
+    "#elif defined(CCL_ALGO_SORT_SIGNED)\n"
+    "#define ORDER(k) ((k) ^ SIGN_BIT)\n"
+    "#else\n"
+    "#define ORDER(k) (k)\n"
+    "#endif\n"
+    "#define R (1 << " G_STRINGIFY(CCL_ALGO_SORT_BITS) ")\n"
+    "#define DIGIT(k, s) ((uint) ((ORDER(k) >> (s)) & (R - 1)))\n"
+    "__kernel void ccl_algo_sort_hist(__global const K * keys,\n"
+    "    __global uint * hist, ulong n, uint shift, uint cap,\n"
+    "    __local uint * cnt) {\n"
+    "    uint lid = get_local_id(0), wg = get_local_size(0);\n"
+    "    uint g = get_group_id(0), groups = get_num_groups(0);\n"
+    "    ulong chunk = (n + groups - 1) / groups;\n"
+    "    ulong end = min((g + 1) * chunk, n);\n"
+    "    for (uint r = lid; r < R; r += wg) cnt[r] = 0;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (ulong i = g * chunk + lid; i < end; i += wg)\n"
+    "        atomic_inc(&cnt[DIGIT(keys[i], shift)]);\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    if (g < cap)\n"
+    "        for (uint r = lid; r < R; r += wg) hist[r * cap + g] = cnt[r];\n"
+    "}\n"
+    "__kernel void ccl_algo_sort_scatter(__global const K * keys_in,\n"
+    "    __global K * keys_out,\n"
+    "#ifdef CCL_ALGO_SORT_VALS\n"
+    "    __global const V * vals_in, __global V * vals_out,\n"
+    "#endif\n"
+    "    __global const uint * offs, ulong n, uint shift,\n"
+    "    __local uchar * digits, __local uint * base, __local uint * cnt) {\n"
+    "    uint lid = get_local_id(0), wg = get_local_size(0);\n"
+    "    uint g = get_group_id(0), groups = get_num_groups(0);\n"
+    "    ulong chunk = (n + groups - 1) / groups;\n"
+    "    ulong start = min(g * chunk, n), end = min(start + chunk, n);\n"
+    "    for (uint r = lid; r < R; r += wg) base[r] = offs[r * groups + g];\n"
+    "    for (ulong b = start; b < end; b += wg) {\n"
+    "        ulong i = b + lid;\n"
+    "        uint d = (i < end) ? DIGIT(keys_in[i], shift) : R;\n"
+    "        digits[lid] = (uchar) d;\n"
+    "        for (uint r = lid; r < R; r += wg) cnt[r] = 0;\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "        if (d < R) {\n"
+    "            uint rank = 0;\n"
+    "            for (uint j = 0; j < lid; ++j) rank += (digits[j] == d);\n"
+    "            uint dst = base[d] + rank;\n"
+    "            keys_out[dst] = keys_in[i];\n"
+    "#ifdef CCL_ALGO_SORT_VALS\n"
+    "            vals_out[dst] = vals_in[i];\n"
+    "#endif\n"
+    "            atomic_inc(&cnt[d]);\n"
+    "        }\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "        for (uint r = lid; r < R; r += wg) base[r] += cnt[r];\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "}\n";
+
+/**
+ * @internal
+ * Names of element types, used in build options and program keys.
+ * */
+static const char * const ccl_algo_type_names[] =
+    { "INT", "UINT", "LONG", "ULONG", "FLOAT", "DOUBLE" };
+
+/**
+ * @internal
+ * Names of operations, used in build options and program keys.
+ * */
+static const char * const ccl_algo_op_names[] = { "SUM", "MIN", "MAX" };
+
+/**
+ * @internal
+ *
+ * @brief Largest power of two not greater than the given value.
+ *
+ * @param[in] x A positive value.
+ * @return Largest power of two not greater than `x`.
+ * */
+static size_t ccl_algo_pow2_floor(size_t x) {
+    size_t p = 1;
+    while (p <= x / 2) p <<= 1;
+    return p;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get a program from the context cache of compiled programs,
+ * building it from the given source the first time it is required.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] dev Device for which to build the program, or `NULL` to
+ * build it for all devices in the context.
+ * @param[in] src Program source.
+ * @param[in] key Key of program in the context cache.
+ * @param[in] opts Build options.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new reference to the program, which should be released with
+ * ::ccl_program_destroy(), or `NULL` if an error occurs.
+ * */
+static CCLProgram * ccl_algo_program_cached(CCLContext * ctx,
+    CCLDevice * dev, const char * src, const char * key, const char * opts,
+    CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLProgram * prg;
+
+    /* Build program if not yet available in context. */
+    prg = ccl_context_get_compiled_program(ctx, key);
+    if (prg == NULL) {
+        prg = ccl_program_new_from_source(ctx, src, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (dev != NULL)
+            ccl_program_build_full(
+                prg, 1, &dev, opts, NULL, NULL, &err_internal);
+        else
+            ccl_program_build(prg, opts, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        prg = ccl_context_add_compiled_program(ctx, key, prg);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release program, if any. */
+    if (prg != NULL) ccl_program_destroy(prg);
+    prg = NULL;
+
+finish:
+
+    /* Return program. */
+    return prg;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the algorithm program for the given element type and
+ * operation, building it the first time it is required in the context of
+ * the given queue, and keeping it in the context cache of compiled
+ * programs.
+ *
+ * If the device of the queue supports sub-groups, the program is built
+ * only for that device, with sub-group functions enabled. The base
+ * work-group size is determined from the device maximum work-group size
+ * and local memory size.
+ *
+ * @param[in] cq Command queue where the algorithm is to be enqueued.
+ * @param[in] type Element type.
+ * @param[in] op Operation.
+ * @param[in] flags Load input elements as compaction flags?
+ * @param[out] wg Location where to place the base work-group size.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new reference to the program, which should be released with
+ * ::ccl_program_destroy(), or `NULL` if an error occurs.
+ * */
+static CCLProgram * ccl_algo_program_get(CCLQueue * cq, CCLAlgoType type,
+    CCLAlgoOp op, cl_bool flags, size_t * wg, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLDevice * dev;
+    const CCLDeviceCaps * caps;
+    CCLProgram * prg = NULL;
+    GString * key = g_string_new(CCL_ALGO_PROGRAM_KEY);
+    GString * opts = g_string_new(NULL);
+    cl_bool subgroups;
+    size_t max_wg;
+
+    /* Get context, device and device capabilities. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    caps = ccl_device_get_caps(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Double precision elements require device support. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (type == CCL_ALGO_DOUBLE)
+        && !(caps->extensions & CCL_DEVICE_EXT_KHR_FP64),
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: device does not support double precision elements.",
+        CCL_STRD);
+
+    /* Work-groups keep one element per work-item in local memory. */
+    max_wg = MIN((size_t) CCL_ALGO_WG_MAX, caps->max_work_group_size);
+    max_wg = MIN(max_wg,
+        (size_t) (caps->local_mem_size / ccl_algo_type_size(type)));
+    *wg = ccl_algo_pow2_floor(max_wg);
+
+    /* Determine program key and build options. */
+    subgroups = (caps->extensions & CCL_DEVICE_EXT_KHR_SUBGROUPS) != 0;
+    g_string_append_printf(key, ":%s:%s",
+        ccl_algo_type_names[type], ccl_algo_op_names[op]);
+    g_string_append_printf(opts, "-DCCL_ALGO_TYPE_%s -DCCL_ALGO_OP_%s",
+        ccl_algo_type_names[type], ccl_algo_op_names[op]);
+    if (flags) {
+        g_string_append(key, ":flags");
+        g_string_append(opts, " -DCCL_ALGO_FLAGS");
+    }
+    if (subgroups) {
+        g_string_append_printf(key, ":sg:%p", (void *) dev);
+        g_string_append(opts, " -DCCL_ALGO_SUBGROUPS");
+        if (caps->opencl_c_version >= 200)
+            g_string_append(opts, " -cl-std=CL2.0");
+    }
+
+    /* Get program from context cache, building it if necessary. */
+    prg = ccl_algo_program_cached(ctx, subgroups ? dev : NULL, ccl_algo_src,
+        key->str, opts->str, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release temporary strings. */
+    g_string_free(key, TRUE);
+    g_string_free(opts, TRUE);
+
+    /* Return program. */
+    return prg;
+}
+
+/**
+ * @internal
+ *
+ * @brief Create an algorithm kernel, and limit the work-group size to
+ * the maximum supported by the kernel on the device of the given queue.
+ *
+ * @param[in] prg Algorithm program.
+ * @param[in] cq Command queue where the kernel is to be enqueued.
+ * @param[in] kernel_name Name of kernel.
+ * @param[in,out] wg Work-group size to limit.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new kernel wrapper object, which should be released with
+ * ::ccl_kernel_destroy(), or `NULL` if an error occurs.
+ * */
+static CCLKernel * ccl_algo_kernel_new(CCLProgram * prg, CCLQueue * cq,
+    const char * kernel_name, size_t * wg, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLDevice * dev;
+    CCLKernel * krnl = NULL;
+    size_t krnl_wg;
+
+    /* Create a kernel of its own for this call, so that concurrent calls
+     * don't share kernel arguments. */
+    krnl = ccl_kernel_new(prg, kernel_name, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Limit work-group size. */
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl_wg = ccl_kernel_get_workgroup_info_scalar(krnl, dev,
+        CL_KERNEL_WORK_GROUP_SIZE, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    *wg = MIN(*wg, ccl_algo_pow2_floor(krnl_wg));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release kernel, if any. */
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+    krnl = NULL;
+
+finish:
+
+    /* Return kernel. */
+    return krnl;
+}
+
+/**
+ * @internal
+ *
+ * @brief Enqueue a scan with the kernels of the given program.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] prg Algorithm program.
+ * @param[in] wg Base work-group size.
+ * @param[in] in Input buffer.
+ * @param[out] out Output buffer, may be the same as `in`.
+ * @param[in] tsize Size in bytes of output elements.
+ * @param[in] inclusive Perform an inclusive scan?
+ * @param[in] n Number of elements.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the scan starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last scan kernel, or `NULL` if an error occurs.
+ * */
+static CCLEvent * ccl_algo_scan_full(CCLQueue * cq, CCLProgram * prg,
+    size_t wg, CCLBuffer * in, CCLBuffer * out, size_t tsize,
+    cl_bool inclusive, size_t n, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLKernel * krnl_blocks = NULL;
+    CCLKernel * krnl_add = NULL;
+    CCLBuffer * sums = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_ulong n_arg = n, chunk;
+    cl_uint incl_arg = inclusive ? 1 : 0;
+    size_t groups, gws;
+
+    /* Get kernels and limit work-group size to what both support. */
+    krnl_blocks = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_scan_blocks", &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl_add = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_scan_add", &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Each work-group scans a chunk of whole tiles. The number of
+     * work-groups never exceeds the work-group size. */
+    groups = MIN((n + wg - 1) / wg, wg);
+    chunk = (((n + groups - 1) / groups + wg - 1) / wg) * wg;
+    groups = (size_t) ((n + chunk - 1) / chunk);
+    gws = groups * wg;
+
+    /* Get buffer for totals of chunks from the context buffer pool. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    sums = ccl_buffer_pool_get(
+        ctx, CL_MEM_READ_WRITE, groups * tsize, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Scan chunks. */
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_blocks, cq, 1, NULL,
+        &gws, &wg, evt_wait_lst, &err_internal, in, out, sums,
+        ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(chunk, cl_ulong),
+        ccl_arg_priv(incl_arg, cl_uint), ccl_arg_full(NULL, wg * tsize),
+        NULL);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_event_set_name(evt, "ALGO_SCAN");
+
+    /* Combine chunks with totals of preceding chunks. */
+    if (groups > 1) {
+        evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_add, cq, 1, NULL,
+            &gws, &wg, ccl_ewl(&ewl, evt, NULL), &err_internal, out, sums,
+            ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(chunk, cl_ulong),
+            ccl_arg_full(NULL, wg * tsize), NULL);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_set_name(evt, "ALGO_SCAN_ADD");
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release temporary objects, which remain valid while the scan
+     * runs. */
+    if (sums != NULL) ccl_buffer_pool_put(ctx, sums);
+    if (krnl_blocks != NULL) ccl_kernel_destroy(krnl_blocks);
+    if (krnl_add != NULL) ccl_kernel_destroy(krnl_add);
+
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    ccl_event_wait_list_clear(&ewl);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Get the size in bytes of elements of the given type.
+ *
+ * @param[in] type Element type.
+ * @return Size in bytes of elements of the given type.
+ * */
+CCL_EXPORT
+size_t ccl_algo_type_size(CCLAlgoType type) {
+
+    switch (type) {
+        case CCL_ALGO_INT:
+        case CCL_ALGO_UINT:
+        case CCL_ALGO_FLOAT:
+            return 4;
+        case CCL_ALGO_LONG:
+        case CCL_ALGO_ULONG:
+        case CCL_ALGO_DOUBLE:
+            return 8;
+        default:
+            g_return_val_if_reached(0);
+    }
+}
+
+/**
+ * Enqueue the reduction of the elements of a buffer to a single value.
+ *
+ * The reduction is performed in two passes: each work-group first
+ * reduces a strided part of the input, and a single work-group then
+ * reduces the partial results.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] in Buffer with the elements to reduce.
+ * @param[out] out Buffer where to place the result, in its first
+ * element.
+ * @param[in] type Element type.
+ * @param[in] op Reduction operation.
+ * @param[in] n Number of elements to reduce, must be positive.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the reduction starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last reduction kernel, or `NULL` if an error
+ * occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_algo_reduce(CCLQueue * cq, CCLBuffer * in, CCLBuffer * out,
+    CCLAlgoType type, CCLAlgoOp op, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure in is not NULL. */
+    g_return_val_if_fail(in != NULL, NULL);
+    /* Make sure out is not NULL. */
+    g_return_val_if_fail(out != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * part = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_ulong n_arg = n;
+    size_t tsize, wg, groups, gws;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (n == 0)
+        || (type > CCL_ALGO_DOUBLE) || (op > CCL_ALGO_MAX),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: invalid element type, operation or number of elements.",
+        CCL_STRD);
+    tsize = ccl_algo_type_size(type);
+
+    /* Get program and kernel. */
+    prg = ccl_algo_program_get(cq, type, op, CL_FALSE, &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_reduce", &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* First pass, if more than one work-group is required. The buffer
+     * of partial results is taken from the context buffer pool. */
+    groups = MIN((n + wg - 1) / wg, wg);
+    if (groups > 1) {
+        ctx = ccl_queue_get_context(cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        part = ccl_buffer_pool_get(
+            ctx, CL_MEM_READ_WRITE, groups * tsize, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        gws = groups * wg;
+        evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL,
+            &gws, &wg, evt_wait_lst, &err_internal, in, part,
+            ccl_arg_priv(n_arg, cl_ulong), ccl_arg_full(NULL, wg * tsize),
+            NULL);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_set_name(evt, "ALGO_REDUCE");
+        in = part;
+        n_arg = groups;
+        evt_wait_lst = ccl_ewl(&ewl, evt, NULL);
+    }
+
+    /* Final pass with a single work-group. */
+    gws = wg;
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL,
+        &gws, &wg, evt_wait_lst, &err_internal, in, out,
+        ccl_arg_priv(n_arg, cl_ulong), ccl_arg_full(NULL, wg * tsize),
+        NULL);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_event_set_name(evt, "ALGO_REDUCE");
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release temporary objects. */
+    if (part != NULL) ccl_buffer_pool_put(ctx, part);
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+    if (prg != NULL) ccl_program_destroy(prg);
+
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    ccl_event_wait_list_clear(&ewl);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue the inclusive or exclusive prefix scan of the elements of a
+ * buffer.
+ *
+ * Element @f$i@f$ of the output is the given operation applied to input
+ * elements @f$0@f$ to @f$i@f$ (inclusive scan) or @f$0@f$ to @f$i-1@f$
+ * (exclusive scan, where the first element is the identity of the
+ * operation). The scan can be performed in place.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] in Buffer with the elements to scan.
+ * @param[out] out Buffer where to place the scan, may be the same as
+ * `in`.
+ * @param[in] type Element type.
+ * @param[in] op Scan operation.
+ * @param[in] inclusive `CL_TRUE` for an inclusive scan, `CL_FALSE` for
+ * an exclusive scan.
+ * @param[in] n Number of elements to scan, must be positive.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the scan starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last scan kernel, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_algo_scan(CCLQueue * cq, CCLBuffer * in, CCLBuffer * out,
+    CCLAlgoType type, CCLAlgoOp op, cl_bool inclusive, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure in is not NULL. */
+    g_return_val_if_fail(in != NULL, NULL);
+    /* Make sure out is not NULL. */
+    g_return_val_if_fail(out != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLProgram * prg = NULL;
+    CCLEvent * evt = NULL;
+    size_t wg;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (n == 0)
+        || (type > CCL_ALGO_DOUBLE) || (op > CCL_ALGO_MAX),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: invalid element type, operation or number of elements.",
+        CCL_STRD);
+
+    /* Get program and perform scan. */
+    prg = ccl_algo_program_get(cq, type, op, CL_FALSE, &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    evt = ccl_algo_scan_full(cq, prg, wg, in, out, ccl_algo_type_size(type),
+        inclusive, n, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release our reference to the program, which the cache keeps. */
+    if (prg != NULL) ccl_program_destroy(prg);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue the compaction of the elements of a buffer whose flags are
+ * non-zero.
+ *
+ * Elements of `in` whose corresponding `cl_uint` element of `flags` is
+ * non-zero are copied to the start of `out`, keeping their relative
+ * order. The number of copied elements is placed in the first `cl_uint`
+ * element of `count`. Compaction is performed with an exclusive scan of
+ * the flags, which gives the output position of each element.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] in Buffer with the elements to compact.
+ * @param[in] flags Buffer with one `cl_uint` flag per element.
+ * @param[out] out Buffer where to place the selected elements, which must
+ * not be the same as `in`.
+ * @param[out] count Buffer where to place the number of selected
+ * elements, as a `cl_uint`.
+ * @param[in] type Element type.
+ * @param[in] n Number of elements, must be positive and fit in a
+ * `cl_uint`.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the compaction starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last compaction kernel, or `NULL` if an error
+ * occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_algo_compact(CCLQueue * cq, CCLBuffer * in,
+    CCLBuffer * flags, CCLBuffer * out, CCLBuffer * count, CCLAlgoType type,
+    size_t n, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure in is not NULL. */
+    g_return_val_if_fail(in != NULL, NULL);
+    /* Make sure flags is not NULL. */
+    g_return_val_if_fail(flags != NULL, NULL);
+    /* Make sure out is not NULL. */
+    g_return_val_if_fail(out != NULL, NULL);
+    /* Make sure count is not NULL. */
+    g_return_val_if_fail(count != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLProgram * prg_flags = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * pos = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_ulong n_arg = n;
+    size_t wg, wg_type;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (n == 0) || (n > G_MAXUINT32)
+        || (type > CCL_ALGO_DOUBLE) || (in == out),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: invalid element type or number of elements, or input and "
+        "output buffers are the same.", CCL_STRD);
+
+    /* Get programs for scanning flags and for scattering elements. */
+    prg_flags = ccl_algo_program_get(
+        cq, CCL_ALGO_UINT, CCL_ALGO_SUM, CL_TRUE, &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    prg = ccl_algo_program_get(
+        cq, type, CCL_ALGO_SUM, CL_FALSE, &wg_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_scatter", &wg_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Output positions are the exclusive scan of the flags. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    pos = ccl_buffer_pool_get(
+        ctx, CL_MEM_READ_WRITE, n * sizeof(cl_uint), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    evt = ccl_algo_scan_full(cq, prg_flags, wg, flags, pos, sizeof(cl_uint),
+        CL_FALSE, n, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Scatter selected elements to their positions. */
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &n,
+        NULL, ccl_ewl(&ewl, evt, NULL), &err_internal, in, flags, pos, out,
+        count, ccl_arg_priv(n_arg, cl_ulong), NULL);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_event_set_name(evt, "ALGO_COMPACT");
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release temporary objects, which remain valid while the compaction
+     * runs. */
+    if (pos != NULL) ccl_buffer_pool_put(ctx, pos);
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (prg_flags != NULL) ccl_program_destroy(prg_flags);
+
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    ccl_event_wait_list_clear(&ewl);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Enqueue the radix sort of keys, and optionally of values by
+ * key.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] keys Buffer with the keys to sort.
+ * @param[in,out] vals Buffer with the values to sort by key, or `NULL`.
+ * @param[in] type Key type.
+ * @param[in] val_size Size in bytes of values, 4 or 8, ignored if `vals`
+ * is `NULL`.
+ * @param[in] n Number of keys.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the sort starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last sort kernel, or `NULL` if an error occurs.
+ * */
+static CCLEvent * ccl_algo_sort_full(CCLQueue * cq, CCLBuffer * keys,
+    CCLBuffer * vals, CCLAlgoType type, size_t val_size, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLDevice * dev;
+    const CCLDeviceCaps * caps;
+    CCLProgram * prg = NULL;
+    CCLProgram * prg_scan = NULL;
+    CCLKernel * krnl_hist = NULL;
+    CCLKernel * krnl_scatter = NULL;
+    CCLBuffer * keys_tmp = NULL, * vals_tmp = NULL, * hist = NULL;
+    CCLBuffer * keys_src, * keys_dst, * vals_src, * vals_dst, * swap;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_command_queue_properties qprop;
+    GString * key = g_string_new(CCL_ALGO_PROGRAM_KEY "_sort");
+    GString * opts = g_string_new(NULL);
+    size_t key_size, wg, wg_scan, gws, lws, rws;
+    cl_ulong n_arg = n;
+    cl_uint shift, cap, groups;
+    cl_uint radix = 1 << CCL_ALGO_SORT_BITS;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (n == 0) || (n > G_MAXUINT32)
+        || (type > CCL_ALGO_DOUBLE)
+        || ((vals != NULL) && (val_size != 4) && (val_size != 8)),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: invalid key type, value size or number of keys.", CCL_STRD);
+    key_size = ccl_algo_type_size(type);
+
+    /* Get context, device and device capabilities. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    caps = ccl_device_get_caps(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Determine program key and build options. */
+    g_string_append_printf(key, ":%s", ccl_algo_type_names[type]);
+    if (key_size == 8) g_string_append(opts, " -DCCL_ALGO_SORT_64");
+    if ((type == CCL_ALGO_INT) || (type == CCL_ALGO_LONG))
+        g_string_append(opts, " -DCCL_ALGO_SORT_SIGNED");
+    if ((type == CCL_ALGO_FLOAT) || (type == CCL_ALGO_DOUBLE))
+        g_string_append(opts, " -DCCL_ALGO_SORT_FLOAT");
+    if (vals != NULL) {
+        g_string_append_printf(key, ":v%u", (unsigned int) val_size);
+        g_string_append(opts, " -DCCL_ALGO_SORT_VALS");
+        if (val_size == 8) g_string_append(opts, " -DCCL_ALGO_SORT_VALS_64");
+    }
+
+    /* Get sort and scan programs, and sort kernels. */
+    prg = ccl_algo_program_cached(
+        ctx, NULL, ccl_algo_sort_src, key->str, opts->str, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    prg_scan = ccl_algo_program_get(
+        cq, CCL_ALGO_UINT, CCL_ALGO_SUM, CL_FALSE, &wg_scan, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    wg = ccl_algo_pow2_floor(
+        MIN((size_t) CCL_ALGO_WG_MAX, caps->max_work_group_size));
+    krnl_hist = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_sort_hist", &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl_scatter = ccl_algo_kernel_new(
+        prg, cq, "ccl_algo_sort_scatter", &wg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Number of work-items, which doesn't depend on the number of keys
+     * for large sorts, so that tuning results are reused. */
+    rws = MIN(((n + wg - 1) / wg) * wg,
+        (size_t) caps->max_compute_units * CCL_ALGO_SORT_WI_PER_CU);
+
+    /* Tune the local work size of the histogram kernel, which is also
+     * used for the scatter kernel, if the queue allows it. Tuning runs
+     * the kernel without writing results. Otherwise use the largest
+     * work-group size. */
+    qprop = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    lws = wg;
+    if (qprop & CL_QUEUE_PROFILING_ENABLE) {
+        shift = 0;
+        cap = 0;
+        ccl_kernel_set_args(krnl_hist, keys, keys,
+            ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(shift, cl_uint),
+            ccl_arg_priv(cap, cl_uint),
+            ccl_arg_full(NULL, radix * sizeof(cl_uint)), NULL);
+        ccl_kernel_tune_worksizes(
+            krnl_hist, cq, 1, &rws, &gws, &lws, 0, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    } else {
+        gws = ((rws + lws - 1) / lws) * lws;
+    }
+    groups = (cl_uint) (gws / lws);
+    cap = groups;
+
+    /* Get temporary buffers from the context buffer pool. */
+    keys_tmp = ccl_buffer_pool_get(
+        ctx, CL_MEM_READ_WRITE, n * key_size, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    if (vals != NULL) {
+        vals_tmp = ccl_buffer_pool_get(
+            ctx, CL_MEM_READ_WRITE, n * val_size, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+    hist = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE,
+        radix * groups * sizeof(cl_uint), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Sort one digit per pass. The number of passes is even, so the
+     * sorted keys and values end up in the original buffers. */
+    keys_src = keys;
+    keys_dst = keys_tmp;
+    vals_src = vals;
+    vals_dst = vals_tmp;
+    for (shift = 0; shift < 8 * key_size; shift += CCL_ALGO_SORT_BITS) {
+
+        /* Count digits of each chunk. */
+        evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_hist, cq, 1,
+            NULL, &gws, &lws, evt_wait_lst, &err_internal, keys_src, hist,
+            ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(shift, cl_uint),
+            ccl_arg_priv(cap, cl_uint),
+            ccl_arg_full(NULL, radix * sizeof(cl_uint)), NULL);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_set_name(evt, "ALGO_SORT_HIST");
+        evt_wait_lst = ccl_ewl(&ewl, evt, NULL);
+
+        /* Determine output positions. */
+        evt = ccl_algo_scan_full(cq, prg_scan, wg_scan, hist, hist,
+            sizeof(cl_uint), CL_FALSE, radix * groups, evt_wait_lst,
+            &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        evt_wait_lst = ccl_ewl(&ewl, evt, NULL);
+
+        /* Move keys, and values if any, to their positions. */
+        if (vals != NULL) {
+            evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_scatter, cq,
+                1, NULL, &gws, &lws, evt_wait_lst, &err_internal, keys_src,
+                keys_dst, vals_src, vals_dst, hist,
+                ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(shift, cl_uint),
+                ccl_arg_full(NULL, lws),
+                ccl_arg_full(NULL, radix * sizeof(cl_uint)),
+                ccl_arg_full(NULL, radix * sizeof(cl_uint)), NULL);
+        } else {
+            evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_scatter, cq,
+                1, NULL, &gws, &lws, evt_wait_lst, &err_internal, keys_src,
+                keys_dst, hist,
+                ccl_arg_priv(n_arg, cl_ulong), ccl_arg_priv(shift, cl_uint),
+                ccl_arg_full(NULL, lws),
+                ccl_arg_full(NULL, radix * sizeof(cl_uint)),
+                ccl_arg_full(NULL, radix * sizeof(cl_uint)), NULL);
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_set_name(evt, "ALGO_SORT_SCATTER");
+        evt_wait_lst = ccl_ewl(&ewl, evt, NULL);
+
+        /* Swap source and destination. */
+        swap = keys_src; keys_src = keys_dst; keys_dst = swap;
+        swap = vals_src; vals_src = vals_dst; vals_dst = swap;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Return temporary buffers to the pool and release other temporary
+     * objects, which remain valid while the sort runs. */
+    if (keys_tmp != NULL) ccl_buffer_pool_put(ctx, keys_tmp);
+    if (vals_tmp != NULL) ccl_buffer_pool_put(ctx, vals_tmp);
+    if (hist != NULL) ccl_buffer_pool_put(ctx, hist);
+    if (krnl_hist != NULL) ccl_kernel_destroy(krnl_hist);
+    if (krnl_scatter != NULL) ccl_kernel_destroy(krnl_scatter);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (prg_scan != NULL) ccl_program_destroy(prg_scan);
+    g_string_free(key, TRUE);
+    g_string_free(opts, TRUE);
+
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    ccl_event_wait_list_clear(&ewl);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue the radix sort of the elements of a buffer, in ascending order.
+ *
+ * Keys of all types are sorted by their numerical value. Floating point
+ * keys are sorted by their IEEE-754 bit pattern, so that negative zero
+ * comes before positive zero and NaNs are placed at the ends. The sort is
+ * performed in place, with temporary buffers taken from the context
+ * buffer pool. If the command queue was created with
+ * `CL_QUEUE_PROFILING_ENABLE`, the work-group size is tuned with
+ * ::ccl_kernel_tune_worksizes() the first time a device sorts a given
+ * key type.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] keys Buffer with the keys to sort.
+ * @param[in] type Key type.
+ * @param[in] n Number of keys, must be positive and fit in a `cl_uint`.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the sort starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last sort kernel, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_algo_sort(CCLQueue * cq, CCLBuffer * keys, CCLAlgoType type,
+    size_t n, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure keys is not NULL. */
+    g_return_val_if_fail(keys != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_algo_sort_full(
+        cq, keys, NULL, type, 0, n, evt_wait_lst, err);
+}
+
+/**
+ * Enqueue the stable radix sort of key-value pairs by key, in ascending
+ * order.
+ *
+ * Keys are sorted as with ::ccl_algo_sort(), and values are moved with
+ * their keys. Values with equal keys keep their relative order.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] keys Buffer with the keys to sort.
+ * @param[in,out] vals Buffer with the values to sort by key.
+ * @param[in] type Key type.
+ * @param[in] val_size Size in bytes of values, 4 or 8.
+ * @param[in] n Number of key-value pairs, must be positive and fit in a
+ * `cl_uint`.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the sort starts. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the last sort kernel, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_algo_sort_by_key(CCLQueue * cq, CCLBuffer * keys,
+    CCLBuffer * vals, CCLAlgoType type, size_t val_size, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure keys is not NULL. */
+    g_return_val_if_fail(keys != NULL, NULL);
+    /* Make sure vals is not NULL. */
+    g_return_val_if_fail(vals != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_algo_sort_full(
+        cq, keys, vals, type, val_size, n, evt_wait_lst, err);
+}
@@ -0,0 +1,166 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of parallel reduction, scan, compaction and sort primitives.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_ALGO_H_
+#define _CCL_ALGO_H_
+
+#include "ccl_common.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_ALGO Parallel primitives
+ * @ingroup CCL_BUFFER_WRAPPER
+ *
+ * This module provides device-tuned parallel reduction, prefix scan,
+ * stream compaction and radix sort of buffers of scalar values.
+ *
+ * ::ccl_algo_reduce() reduces the elements of a buffer to a single value
+ * with a sum, minimum or maximum operation. ::ccl_algo_scan() computes
+ * the inclusive or exclusive prefix scan of a buffer with the same
+ * operations. ::ccl_algo_compact() copies the elements of a buffer whose
+ * flags are non-zero to the start of another buffer, keeping their
+ * order, and returns the number of copied elements in a device buffer.
+ * ::ccl_algo_sort() sorts the elements of a buffer in place, and
+ * ::ccl_algo_sort_by_key() sorts 32 or 64-bit values by their keys.
+ *
+ * Kernels are tuned for the device of the command queue: the work-group
+ * size is limited by the device local memory size, and reductions and
+ * scans within work-groups use sub-group functions if the device supports
+ * the `cl_khr_subgroups` extension, falling back to local memory
+ * otherwise. The programs are built once per context, element type,
+ * operation and device capabilities, and kept in the context cache of
+ * compiled programs.
+ *
+ * Operations are asynchronous: the event of the last kernel of each
+ * operation is returned, so that further commands can wait on it.
+ * Temporary buffers are taken from the context buffer pool, so that
+ * repeated operations make no allocations once the pool is enabled with
+ * ::ccl_buffer_pool_enable().
+ *
+ * @attention If the buffer pool of the context is enabled, operations
+ * should all be enqueued in the same in-order command queue, as
+ * temporary buffers are returned to the pool as soon as the operation
+ * is enqueued.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLBuffer * data, * sum, * pfx;
+ * CCLEvent * evt;
+ * CCLEventWaitList ewl = NULL;
+ * cl_float total;
+ * @endcode
+ * @code{.c}
+ * evt = ccl_algo_reduce(cq, data, sum, CCL_ALGO_FLOAT, CCL_ALGO_SUM, n,
+ *     NULL, NULL);
+ * ccl_buffer_enqueue_read(sum, cq, CL_TRUE, 0, sizeof(cl_float), &total,
+ *     ccl_ewl(&ewl, evt, NULL), NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_algo_scan(cq, data, pfx, CCL_ALGO_FLOAT, CCL_ALGO_SUM, CL_FALSE,
+ *     n, NULL, NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/**
+ * Element types supported by the parallel primitives.
+ * */
+typedef enum ccl_algo_type {
+
+    /** `cl_int` elements. */
+    CCL_ALGO_INT    = 0,
+    /** `cl_uint` elements. */
+    CCL_ALGO_UINT   = 1,
+    /** `cl_long` elements. */
+    CCL_ALGO_LONG   = 2,
+    /** `cl_ulong` elements. */
+    CCL_ALGO_ULONG  = 3,
+    /** `cl_float` elements. */
+    CCL_ALGO_FLOAT  = 4,
+    /** `cl_double` elements, requires the `cl_khr_fp64` extension. */
+    CCL_ALGO_DOUBLE = 5
+
+} CCLAlgoType;
+
+/**
+ * Operations supported by reductions and scans.
+ * */
+typedef enum ccl_algo_op {
+
+    /** Sum of elements. */
+    CCL_ALGO_SUM = 0,
+    /** Minimum of elements. */
+    CCL_ALGO_MIN = 1,
+    /** Maximum of elements. */
+    CCL_ALGO_MAX = 2
+
+} CCLAlgoOp;
+
+/* Get the size in bytes of elements of the given type. */
+CCL_EXPORT
+size_t ccl_algo_type_size(CCLAlgoType type);
+
+/* Enqueue the reduction of the elements of a buffer to a single value. */
+CCL_EXPORT
+CCLEvent * ccl_algo_reduce(CCLQueue * cq, CCLBuffer * in, CCLBuffer * out,
+    CCLAlgoType type, CCLAlgoOp op, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue the inclusive or exclusive prefix scan of the elements of a
+ * buffer. */
+CCL_EXPORT
+CCLEvent * ccl_algo_scan(CCLQueue * cq, CCLBuffer * in, CCLBuffer * out,
+    CCLAlgoType type, CCLAlgoOp op, cl_bool inclusive, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue the compaction of the elements of a buffer whose flags are
+ * non-zero. */
+CCL_EXPORT
+CCLEvent * ccl_algo_compact(CCLQueue * cq, CCLBuffer * in,
+    CCLBuffer * flags, CCLBuffer * out, CCLBuffer * count, CCLAlgoType type,
+    size_t n, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue the radix sort of the elements of a buffer, in ascending
+ * order. */
+CCL_EXPORT
+CCLEvent * ccl_algo_sort(CCLQueue * cq, CCLBuffer * keys, CCLAlgoType type,
+    size_t n, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue the stable radix sort of key-value pairs by key, in ascending
+ * order. */
+CCL_EXPORT
+CCLEvent * ccl_algo_sort_by_key(CCLQueue * cq, CCLBuffer * keys,
+    CCLBuffer * vals, CCLAlgoType type, size_t val_size, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/** @} */
+
+#endif
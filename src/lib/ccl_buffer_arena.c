@@ -0,0 +1,370 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of sub-buffer arenas.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_buffer_arena.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_device_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Sub-buffer allocated from an arena.
+ * */
+typedef struct ccl_buffer_arena_entry {
+
+    /**
+     * Sub-buffer wrapper.
+     * @private
+     * */
+    CCLBuffer * buf;
+
+    /**
+     * Offset in bytes of sub-buffer in parent buffer.
+     * @private
+     * */
+    size_t offset;
+
+    /**
+     * Size in bytes of sub-buffer.
+     * @private
+     * */
+    size_t size;
+
+} CCLBufferArenaEntry;
+
+/**
+ * Sub-buffer arena class.
+ * */
+struct ccl_buffer_arena {
+
+    /**
+     * Parent buffer.
+     * @private
+     * */
+    CCLBuffer * parent;
+
+    /**
+     * Sub-buffers created from parent buffer, in allocation order
+     * (array of ::CCLBufferArenaEntry). Entries beyond
+     * ::ccl_buffer_arena::num_live were allocated before the last reset,
+     * and are kept for reuse.
+     * @private
+     * */
+    GArray * entries;
+
+    /**
+     * Number of sub-buffers allocated since the last reset.
+     * @private
+     * */
+    guint num_live;
+
+    /**
+     * Size in bytes of parent buffer.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * Number of bytes allocated since the last reset.
+     * @private
+     * */
+    size_t used;
+
+    /**
+     * Alignment in bytes of sub-buffer origins.
+     * @private
+     * */
+    size_t alignment;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Destroy sub-buffers kept by an arena, starting at the given
+ * entry.
+ *
+ * @param[in] arena A sub-buffer arena.
+ * @param[in] first Index of first entry to destroy.
+ * */
+static void ccl_buffer_arena_truncate(CCLBufferArena * arena, guint first) {
+
+    for (guint i = first; i < arena->entries->len; ++i)
+        ccl_buffer_destroy(
+            g_array_index(arena->entries, CCLBufferArenaEntry, i).buf);
+    g_array_set_size(arena->entries, first);
+}
+
+/**
+ * @addtogroup CCL_BUFFER_ARENA
+ * @{
+ */
+
+/**
+ * Create a new sub-buffer arena, allocating its parent buffer.
+ *
+ * @public @memberof ccl_buffer_arena
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] flags OpenCL memory flags of parent buffer, as used in
+ * clCreateBuffer(), which are inherited by sub-buffers.
+ * @param[in] size Size in bytes of parent buffer, i.e. of the memory
+ * available for sub-buffers between resets.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new sub-buffer arena, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBufferArena * ccl_buffer_arena_new(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLBufferArena * arena = NULL;
+    CCLBuffer * parent = NULL;
+    CCLDevice * dev;
+    const CCLDeviceCaps * caps;
+    cl_uint num_devs;
+    size_t alignment = 1;
+
+    /* Sub-buffer origins must be aligned for all devices in context. */
+    num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    for (cl_uint i = 0; i < num_devs; ++i) {
+        dev = ccl_context_get_device(ctx, i, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        caps = ccl_device_get_caps(dev, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        alignment = MAX(alignment, caps->mem_base_addr_align);
+    }
+
+    /* Allocate parent buffer. */
+    parent = ccl_buffer_new(ctx, flags, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create arena. */
+    arena = g_slice_new0(CCLBufferArena);
+    arena->parent = parent;
+    arena->entries = g_array_new(FALSE, FALSE, sizeof(CCLBufferArenaEntry));
+    arena->size = size;
+    arena->alignment = alignment;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return arena. */
+    return arena;
+}
+
+/**
+ * Destroy a sub-buffer arena, its sub-buffers and its parent buffer.
+ *
+ * @public @memberof ccl_buffer_arena
+ *
+ * @param[in] arena The sub-buffer arena to destroy.
+ * */
+CCL_EXPORT
+void ccl_buffer_arena_destroy(CCLBufferArena * arena) {
+
+    /* Make sure arena is not NULL. */
+    g_return_if_fail(arena != NULL);
+
+    ccl_buffer_arena_truncate(arena, 0);
+    g_array_free(arena->entries, TRUE);
+    ccl_buffer_destroy(arena->parent);
+    g_slice_free(CCLBufferArena, arena);
+}
+
+/**
+ * Allocate a sub-buffer from an arena. The sub-buffer origin is aligned
+ * to the largest `CL_DEVICE_MEM_BASE_ADDR_ALIGN` of the context devices.
+ * If the allocation has the same offset and size as the respective
+ * allocation before the last reset, the same sub-buffer is returned.
+ *
+ * @public @memberof ccl_buffer_arena
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] arena A sub-buffer arena.
+ * @param[in] size Size in bytes of sub-buffer.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A sub-buffer wrapper object owned by the arena, or `NULL` if an
+ * error occurs, e.g. if there is not enough memory left in the arena.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_arena_alloc(CCLBufferArena * arena, size_t size,
+    CCLErr ** err) {
+
+    /* Make sure arena is not NULL. */
+    g_return_val_if_fail(arena != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLBufferArenaEntry entry = { NULL, 0, size };
+    CCLBufferArenaEntry * cached;
+
+    /* Determine aligned offset of sub-buffer. */
+    entry.offset = ((arena->used + arena->alignment - 1) / arena->alignment)
+        * arena->alignment;
+
+    /* Check that sub-buffer fits in arena. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, size == 0, CCL_ERROR_ARGS,
+        error_handler, "%s: sub-buffer size must be non-zero.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (entry.offset > arena->size) || (size > arena->size - entry.offset),
+        CCL_ERROR_OTHER, error_handler,
+        "%s: not enough memory left in arena for %lu bytes.",
+        CCL_STRD, (unsigned long) size);
+
+    /* Reuse sub-buffer allocated at the same position before the last
+     * reset, if it represents the same region. Otherwise sub-buffers
+     * from the previous allocation sequence no longer match. */
+    if (arena->num_live < arena->entries->len) {
+        cached = &g_array_index(
+            arena->entries, CCLBufferArenaEntry, arena->num_live);
+        if ((cached->offset == entry.offset) && (cached->size == size)) {
+            entry.buf = cached->buf;
+        } else {
+            ccl_buffer_arena_truncate(arena, arena->num_live);
+        }
+    }
+
+    /* Create sub-buffer if it could not be reused. */
+    if (entry.buf == NULL) {
+        entry.buf = ccl_buffer_new_from_region(
+            arena->parent, 0, entry.offset, size, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        g_array_append_val(arena->entries, entry);
+    }
+
+    /* Bump offset. */
+    arena->num_live++;
+    arena->used = entry.offset + size;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    entry.buf = NULL;
+
+finish:
+
+    /* Return sub-buffer. */
+    return entry.buf;
+}
+
+/**
+ * Give back all sub-buffers allocated from an arena, so that its memory
+ * is reused by subsequent allocations. Sub-buffer wrappers are kept for
+ * reuse by allocations with the same offset and size.
+ *
+ * @public @memberof ccl_buffer_arena
+ *
+ * @param[in] arena A sub-buffer arena.
+ * */
+CCL_EXPORT
+void ccl_buffer_arena_reset(CCLBufferArena * arena) {
+
+    /* Make sure arena is not NULL. */
+    g_return_if_fail(arena != NULL);
+
+    arena->num_live = 0;
+    arena->used = 0;
+}
+
+/**
+ * Get number of bytes allocated from an arena since the last reset,
+ * including alignment padding.
+ *
+ * @public @memberof ccl_buffer_arena
+ *
+ * @param[in] arena A sub-buffer arena.
+ * @return Number of bytes allocated from arena.
+ * */
+CCL_EXPORT
+size_t ccl_buffer_arena_get_used(CCLBufferArena * arena) {
+
+    /* Make sure arena is not NULL. */
+    g_return_val_if_fail(arena != NULL, 0);
+
+    return arena->used;
+}
+
+/**
+ * Get alignment in bytes of sub-buffers allocated from an arena.
+ *
+ * @public @memberof ccl_buffer_arena
+ *
+ * @param[in] arena A sub-buffer arena.
+ * @return Alignment in bytes of sub-buffer origins.
+ * */
+CCL_EXPORT
+size_t ccl_buffer_arena_get_alignment(CCLBufferArena * arena) {
+
+    /* Make sure arena is not NULL. */
+    g_return_val_if_fail(arena != NULL, 0);
+
+    return arena->alignment;
+}
+
+/**
+ * Get parent buffer of an arena.
+ *
+ * @public @memberof ccl_buffer_arena
+ *
+ * @param[in] arena A sub-buffer arena.
+ * @return Parent buffer wrapper object, owned by the arena.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_arena_get_parent(CCLBufferArena * arena) {
+
+    /* Make sure arena is not NULL. */
+    g_return_val_if_fail(arena != NULL, NULL);
+
+    return arena->parent;
+}
+
+/** @} */
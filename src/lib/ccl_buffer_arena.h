@@ -0,0 +1,126 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of sub-buffer arenas.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_BUFFER_ARENA_H_
+#define _CCL_BUFFER_ARENA_H_
+
+#include "ccl_common.h"
+#include "ccl_buffer_wrapper.h"
+
+/**
+ * @defgroup CCL_BUFFER_ARENA Sub-buffer arenas
+ * @ingroup CCL_BUFFER_WRAPPER
+ *
+ * This module provides arenas which carve many small sub-buffers out of
+ * one large parent buffer, replacing frequent clCreateBuffer() calls for
+ * short-lived buffers.
+ *
+ * An arena is created with ::ccl_buffer_arena_new(), which allocates the
+ * parent buffer and determines the largest `CL_DEVICE_MEM_BASE_ADDR_ALIGN`
+ * of the context devices. Sub-buffers are obtained with
+ * ::ccl_buffer_arena_alloc(), which bumps an offset in the parent buffer,
+ * aligned as required for sub-buffer origins. All sub-buffers are given
+ * back at once with ::ccl_buffer_arena_reset(), e.g. at the end of each
+ * frame or request.
+ *
+ * Sub-buffer wrappers are kept by the arena across resets: if the
+ * sequence of allocations after a reset repeats the one before it, the
+ * respective sub-buffers are reused, and no OpenCL objects are created
+ * at all.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLBufferArena * arena;
+ * CCLBuffer * a, * b;
+ * @endcode
+ * @code{.c}
+ * arena = ccl_buffer_arena_new(ctx, CL_MEM_READ_WRITE, 16 << 20, NULL);
+ * @endcode
+ * @code{.c}
+ * for (frame = 0; frame < num_frames; ++frame) {
+ *     a = ccl_buffer_arena_alloc(arena, size_a, NULL);
+ *     b = ccl_buffer_arena_alloc(arena, size_b, NULL);
+ *     ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+ *         NULL, NULL, NULL, a, b, NULL);
+ *     ccl_queue_finish(cq, NULL);
+ *     ccl_buffer_arena_reset(arena);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_buffer_arena_destroy(arena);
+ * @endcode
+ *
+ * @attention Sub-buffers are owned by the arena and should not be
+ * destroyed by client code. After a reset, their memory is handed out
+ * again, so commands using them should have completed, or should have
+ * been enqueued in the same in-order queue as all commands using
+ * subsequently allocated sub-buffers. Arenas are not thread-safe.
+ *
+ * @note Requires OpenCL >= 1.1
+ *
+ * @{
+ */
+
+/**
+ * Sub-buffer arena class.
+ * */
+typedef struct ccl_buffer_arena CCLBufferArena;
+
+/* Create a new sub-buffer arena. */
+CCL_EXPORT
+CCLBufferArena * ccl_buffer_arena_new(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, CCLErr ** err);
+
+/* Destroy a sub-buffer arena, its sub-buffers and its parent buffer. */
+CCL_EXPORT
+void ccl_buffer_arena_destroy(CCLBufferArena * arena);
+
+/* Allocate an aligned sub-buffer from an arena. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_arena_alloc(CCLBufferArena * arena, size_t size,
+    CCLErr ** err);
+
+/* Give back all sub-buffers allocated from an arena. */
+CCL_EXPORT
+void ccl_buffer_arena_reset(CCLBufferArena * arena);
+
+/* Get number of bytes allocated from an arena since the last reset. */
+CCL_EXPORT
+size_t ccl_buffer_arena_get_used(CCLBufferArena * arena);
+
+/* Get alignment in bytes of sub-buffers allocated from an arena. */
+CCL_EXPORT
+size_t ccl_buffer_arena_get_alignment(CCLBufferArena * arena);
+
+/* Get parent buffer of an arena. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_arena_get_parent(CCLBufferArena * arena);
+
+/** @} */
+
+#endif
@@ -0,0 +1,454 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of context-level buffer pools.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "_ccl_buffer_pool.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Key of a bucket of pooled buffers.
+ * */
+typedef struct ccl_buffer_pool_key {
+
+    /**
+     * Memory flags of buffers.
+     * @private
+     * */
+    cl_mem_flags flags;
+
+    /**
+     * Size class of buffers.
+     * @private
+     * */
+    size_t size_class;
+
+} CCLBufferPoolKey;
+
+/**
+ * @internal
+ *
+ * @brief Buffer pool of a context.
+ * */
+struct ccl_buffer_pool {
+
+    /**
+     * Buckets of pooled buffers (keys: ::CCLBufferPoolKey*; values:
+     * `GQueue*` of ::CCLBuffer*, most recently pooled first).
+     * @private
+     * */
+    GHashTable * buckets;
+
+    /**
+     * Total size in bytes of pooled buffers.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * High-water mark in bytes, i.e. maximum total size of pooled
+     * buffers.
+     * @private
+     * */
+    size_t max_size;
+
+};
+
+/* Lock protecting the buffer pools of all contexts. */
+static GMutex pool_lock;
+
+/**
+ * @internal
+ *
+ * @brief Hash function for bucket keys.
+ *
+ * @param[in] key Bucket key.
+ * @return Hash value.
+ * */
+static guint ccl_buffer_pool_key_hash(gconstpointer key) {
+
+    const CCLBufferPoolKey * k = (const CCLBufferPoolKey *) key;
+    return (guint) (k->size_class * 31 + k->flags);
+}
+
+/**
+ * @internal
+ *
+ * @brief Equality function for bucket keys.
+ *
+ * @param[in] a First bucket key.
+ * @param[in] b Second bucket key.
+ * @return `TRUE` if keys are equal, `FALSE` otherwise.
+ * */
+static gboolean ccl_buffer_pool_key_equal(gconstpointer a, gconstpointer b) {
+
+    const CCLBufferPoolKey * k1 = (const CCLBufferPoolKey *) a;
+    const CCLBufferPoolKey * k2 = (const CCLBufferPoolKey *) b;
+    return (k1->flags == k2->flags) && (k1->size_class == k2->size_class);
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the buffers in a bucket and the bucket itself.
+ *
+ * @param[in] bucket Bucket of pooled buffers.
+ * */
+static void ccl_buffer_pool_bucket_free(gpointer bucket) {
+
+    g_queue_free_full((GQueue *) bucket, (GDestroyNotify) ccl_buffer_destroy);
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine size class of a buffer size, i.e. the size rounded up
+ * (or down) to a multiple of a quarter of the previous power of two.
+ *
+ * @param[in] size Buffer size.
+ * @param[in] round_up Round size up if `CL_TRUE`, down otherwise.
+ * @return Size class of buffer size.
+ * */
+static size_t ccl_buffer_pool_size_class(size_t size, cl_bool round_up) {
+
+    /* Previous power of two and size class granularity. */
+    size_t pow2 = CCL_BUFFER_POOL_MIN_CLASS, step;
+
+    /* Small sizes have the smallest size class. */
+    if (size <= CCL_BUFFER_POOL_MIN_CLASS)
+        return CCL_BUFFER_POOL_MIN_CLASS;
+
+    /* Determine largest power of two not above size (below it, if
+     * rounding up). */
+    while ((round_up ? pow2 * 2 < size : pow2 * 2 <= size)
+            && (pow2 * 2 > pow2))
+        pow2 *= 2;
+    step = pow2 / 4;
+
+    /* Round size to multiple of granularity. */
+    return round_up
+        ? pow2 + ((size - pow2 + step - 1) / step) * step
+        : pow2 + ((size - pow2) / step) * step;
+}
+
+/**
+ * @internal
+ *
+ * @brief Destroy a buffer pool, releasing pooled buffers.
+ *
+ * @param[in] pool Buffer pool to destroy.
+ * */
+void ccl_buffer_pool_destroy(CCLBufferPool * pool) {
+
+    g_hash_table_destroy(pool->buckets);
+    g_slice_free(CCLBufferPool, pool);
+}
+
+/**
+ * @addtogroup CCL_BUFFER_POOL
+ * @{
+ */
+
+/**
+ * Enable the buffer pool of a context, or change the high-water mark of
+ * an enabled pool. Pooled buffers beyond the new high-water mark are
+ * released.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] max_size High-water mark in bytes, i.e. maximum total size
+ * of pooled buffers, or 0 for ::CCL_BUFFER_POOL_MAX_SIZE.
+ * */
+CCL_EXPORT
+void ccl_buffer_pool_enable(CCLContext * ctx, size_t max_size) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    /* Buffer pool of context. */
+    CCLBufferPool * pool;
+
+    /* Effective high-water mark. */
+    size_t max = max_size > 0 ? max_size : CCL_BUFFER_POOL_MAX_SIZE;
+
+    g_mutex_lock(&pool_lock);
+
+    /* Create pool if it does not exist yet. */
+    pool = ccl_context_get_buffer_pool(ctx);
+    if (pool == NULL) {
+        pool = g_slice_new0(CCLBufferPool);
+        pool->buckets = g_hash_table_new_full(ccl_buffer_pool_key_hash,
+            ccl_buffer_pool_key_equal, g_free, ccl_buffer_pool_bucket_free);
+        ccl_context_set_buffer_pool(ctx, pool);
+    }
+
+    /* Set high-water mark. */
+    pool->max_size = max;
+
+    g_mutex_unlock(&pool_lock);
+
+    /* Release buffers beyond high-water mark. */
+    ccl_buffer_pool_trim(ctx, max);
+}
+
+/**
+ * Disable the buffer pool of a context, releasing pooled buffers.
+ *
+ * @param[in] ctx Context wrapper object.
+ * */
+CCL_EXPORT
+void ccl_buffer_pool_disable(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    /* Buffer pool of context. */
+    CCLBufferPool * pool;
+
+    /* Detach pool from context. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_buffer_pool(ctx);
+    ccl_context_set_buffer_pool(ctx, NULL);
+    g_mutex_unlock(&pool_lock);
+
+    /* Destroy pool, if any. */
+    if (pool != NULL)
+        ccl_buffer_pool_destroy(pool);
+}
+
+/**
+ * Get a buffer from the buffer pool of a context. If the pool has a
+ * buffer with the given flags and with the size class of the given size,
+ * it is reused, otherwise a new buffer with the size class of the given
+ * size is created. If the pool is not enabled, a new buffer with the
+ * given size is created.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] flags OpenCL memory flags as used in clCreateBuffer(), which
+ * cannot include `CL_MEM_USE_HOST_PTR` nor `CL_MEM_COPY_HOST_PTR`.
+ * @param[in] size Minimum size in bytes of buffer.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A buffer wrapper object, which should be returned to the pool
+ * with ccl_buffer_pool_put(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_pool_get(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure no host pointer is required. */
+    g_return_val_if_fail(
+        (flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) == 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Buffer pool of context, bucket key and bucket. */
+    CCLBufferPool * pool;
+    CCLBufferPoolKey key;
+    GQueue * bucket;
+    /* Buffer to return. */
+    CCLBuffer * buf = NULL;
+
+    /* Bucket key. */
+    key.flags = flags;
+    key.size_class = ccl_buffer_pool_size_class(size, CL_TRUE);
+
+    /* Take most recently pooled buffer from bucket, if any. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_buffer_pool(ctx);
+    if (pool != NULL) {
+        bucket = g_hash_table_lookup(pool->buckets, &key);
+        if ((bucket != NULL) && (!g_queue_is_empty(bucket))) {
+            buf = g_queue_pop_head(bucket);
+            pool->size -= key.size_class;
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Otherwise create a new buffer, with the size class of the given
+     * size if the pool is enabled. */
+    if (buf == NULL)
+        buf = ccl_buffer_new(ctx, flags,
+            pool != NULL ? key.size_class : size, NULL, err);
+
+    /* Return buffer. */
+    return buf;
+}
+
+/**
+ * Return a buffer to the buffer pool of a context, consuming the caller's
+ * reference to it. The buffer is released instead of being pooled if the
+ * pool is not enabled, if the buffer is still referenced elsewhere, or if
+ * pooling it would exceed the pool high-water mark.
+ *
+ * @param[in] ctx Context wrapper object, which must be the buffer context.
+ * @param[in] buf Buffer wrapper object, usually obtained with
+ * ccl_buffer_pool_get().
+ * */
+CCL_EXPORT
+void ccl_buffer_pool_put(CCLContext * ctx, CCLBuffer * buf) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+    /* Make sure buf is not NULL. */
+    g_return_if_fail(buf != NULL);
+
+    /* Buffer pool of context, bucket key and bucket. */
+    CCLBufferPool * pool;
+    CCLBufferPoolKey key, * p_key;
+    GQueue * bucket;
+    /* Buffer flags and size. */
+    cl_mem_flags flags;
+    size_t size;
+    /* Was buffer pooled? */
+    cl_bool pooled = CL_FALSE;
+
+    /* Get buffer flags and size (zero if unable to get them, in which case
+     * the buffer is not pooled). */
+    flags = ccl_memobj_get_info_scalar(buf, CL_MEM_FLAGS, cl_mem_flags, NULL);
+    size = ccl_memobj_get_info_scalar(buf, CL_MEM_SIZE, size_t, NULL);
+
+    /* Pool buffer if it is only referenced by the caller, and if it is not
+     * too small. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_buffer_pool(ctx);
+    if ((pool != NULL) && (size >= CCL_BUFFER_POOL_MIN_CLASS)
+        && (ccl_wrapper_ref_count((CCLWrapper *) buf) == 1)) {
+
+        /* Bucket key is the largest size class not above buffer size. */
+        key.flags = flags;
+        key.size_class = ccl_buffer_pool_size_class(size, CL_FALSE);
+
+        /* Pool buffer only if within high-water mark. */
+        if (pool->size + key.size_class <= pool->max_size) {
+
+            /* Get bucket, creating it if necessary. */
+            bucket = g_hash_table_lookup(pool->buckets, &key);
+            if (bucket == NULL) {
+                bucket = g_queue_new();
+                p_key = g_new(CCLBufferPoolKey, 1);
+                *p_key = key;
+                g_hash_table_insert(pool->buckets, p_key, bucket);
+            }
+
+            /* Keep buffer, accounting for the size of its class. */
+            g_queue_push_head(bucket, buf);
+            pool->size += key.size_class;
+            pooled = CL_TRUE;
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Release buffer if it was not pooled. */
+    if (!pooled)
+        ccl_buffer_destroy(buf);
+}
+
+/**
+ * Release pooled buffers of a context, least recently pooled first within
+ * each bucket, until the total size of pooled buffers is within the given
+ * size.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] max_size Maximum total size in bytes of the buffers which
+ * remain in the pool, e.g. 0 for releasing all of them.
+ * @return Total size in bytes of the released buffers.
+ * */
+CCL_EXPORT
+size_t ccl_buffer_pool_trim(CCLContext * ctx, size_t max_size) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    /* Buffer pool of context. */
+    CCLBufferPool * pool;
+    /* Bucket iterator. */
+    GHashTableIter iter;
+    gpointer p_key, p_bucket;
+    /* Buffers to release and their total size. */
+    GSList * bufs = NULL;
+    size_t released = 0;
+
+    /* Remove buffers to release from pool. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_buffer_pool(ctx);
+    if (pool != NULL) {
+        g_hash_table_iter_init(&iter, pool->buckets);
+        while ((pool->size > max_size)
+                && g_hash_table_iter_next(&iter, &p_key, &p_bucket)) {
+
+            GQueue * bucket = (GQueue *) p_bucket;
+            size_t size_class = ((CCLBufferPoolKey *) p_key)->size_class;
+
+            while ((pool->size > max_size) && !g_queue_is_empty(bucket)) {
+                bufs = g_slist_prepend(bufs, g_queue_pop_tail(bucket));
+                pool->size -= size_class;
+                released += size_class;
+            }
+            if (g_queue_is_empty(bucket))
+                g_hash_table_iter_remove(&iter);
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Release buffers outside lock. */
+    g_slist_free_full(bufs, (GDestroyNotify) ccl_buffer_destroy);
+
+    /* Return total size of released buffers. */
+    return released;
+}
+
+/**
+ * Get total size in bytes of the buffers in the pool of a context.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @return Total size in bytes of pooled buffers, which is zero if the
+ * pool is not enabled.
+ * */
+CCL_EXPORT
+size_t ccl_buffer_pool_get_size(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    /* Buffer pool of context and its size. */
+    CCLBufferPool * pool;
+    size_t size = 0;
+
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_buffer_pool(ctx);
+    if (pool != NULL)
+        size = pool->size;
+    g_mutex_unlock(&pool_lock);
+
+    /* Return total size of pooled buffers. */
+    return size;
+}
+
+/** @} */
@@ -0,0 +1,108 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of context-level buffer pools.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_BUFFER_POOL_H_
+#define _CCL_BUFFER_POOL_H_
+
+#include "ccl_common.h"
+#include "ccl_buffer_wrapper.h"
+
+/**
+ * @defgroup CCL_BUFFER_POOL Buffer pools
+ * @ingroup CCL_BUFFER_WRAPPER
+ *
+ * This module provides an opt-in pool of buffers attached to a context,
+ * which reuses released buffers instead of creating new ones, avoiding
+ * the cost of clCreateBuffer() for short-lived temporary buffers.
+ *
+ * Once enabled for a context with ::ccl_buffer_pool_enable(), buffers
+ * obtained with ::ccl_buffer_pool_get() and returned with
+ * ::ccl_buffer_pool_put() are kept in buckets by memory flags and size
+ * class. Size classes are spaced by a quarter of a power of two, so
+ * buffers may be up to 25% larger than requested. When the total size of
+ * pooled buffers would exceed the pool high-water mark, returned buffers
+ * are released instead of being pooled. Pooled buffers can be released
+ * with ::ccl_buffer_pool_trim(), and are released when the pool is
+ * disabled or the context is destroyed.
+ *
+ * If the pool is not enabled, ::ccl_buffer_pool_get() and
+ * ::ccl_buffer_pool_put() simply create and destroy buffers.
+ *
+ * @attention A buffer should only be returned to the pool when no
+ * commands using it are pending, or if all commands which will use it
+ * when reused are enqueued in the same in-order queue. Buffers created
+ * with a host pointer and sub-buffers should not be returned to the pool.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * ccl_buffer_pool_enable(ctx, 0);
+ * @endcode
+ * @code{.c}
+ * tmp = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, size, NULL);
+ * ccl_kernel_set_arg(krnl, 0, tmp);
+ * ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, NULL, NULL, NULL);
+ * ccl_buffer_pool_put(ctx, tmp);
+ * @endcode
+ *
+ * @{
+ */
+
+/** Default high-water mark in bytes of buffer pools. */
+#define CCL_BUFFER_POOL_MAX_SIZE (64 * 1024 * 1024)
+
+/** Smallest size class in bytes of buffer pools. */
+#define CCL_BUFFER_POOL_MIN_CLASS 256
+
+/* Enable the buffer pool of a context. */
+CCL_EXPORT
+void ccl_buffer_pool_enable(CCLContext * ctx, size_t max_size);
+
+/* Disable the buffer pool of a context, releasing pooled buffers. */
+CCL_EXPORT
+void ccl_buffer_pool_disable(CCLContext * ctx);
+
+/* Get a buffer from the buffer pool of a context. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_pool_get(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, CCLErr ** err);
+
+/* Return a buffer to the buffer pool of a context. */
+CCL_EXPORT
+void ccl_buffer_pool_put(CCLContext * ctx, CCLBuffer * buf);
+
+/* Release pooled buffers until the pool is within the given size. */
+CCL_EXPORT
+size_t ccl_buffer_pool_trim(CCLContext * ctx, size_t max_size);
+
+/* Get total size in bytes of the buffers in the pool of a context. */
+CCL_EXPORT
+size_t ccl_buffer_pool_get_size(CCLContext * ctx);
+
+/** @} */
+
+#endif
@@ -27,8 +27,15 @@
 
 #include "ccl_buffer_wrapper.h"
 #include "ccl_image_wrapper.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_device_wrapper.h"
 #include "_ccl_memobj_wrapper.h"
+#include "_ccl_fill.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_queue_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
+#include <string.h>
 
 /**
  * Buffer wrapper class
@@ -42,8 +49,371 @@ struct ccl_buffer {
      * @private
      * */
     CCLMemObj mo;
+
+    /**
+     * Whether the buffer was created in zero-copy mode on unified
+     * memory, in which case reads and writes are performed by mapping.
+     * @private
+     * */
+    cl_bool zero_copy;
 };
 
+/**
+ * @internal
+ *
+ * @brief Read or write a zero-copy buffer by mapping the given region
+ * and copying data from or to the mapped host memory.
+ *
+ * @param[in] buf Zero-copy buffer wrapper object.
+ * @param[in] cq Command-queue wrapper object.
+ * @param[in] is_read Whether to read (`CL_TRUE`) or write (`CL_FALSE`).
+ * @param[in] blocking Whether to wait for the device to regain access
+ * to the region.
+ * @param[in] offset The offset in bytes in the buffer object.
+ * @param[in] size The size in bytes of data being read or written.
+ * @param[in,out] ptr The pointer to host memory.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the region is mapped.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object of the unmap command, or `NULL` if an
+ * error occurs.
+ * */
+static CCLEvent * ccl_buffer_zero_copy_transfer(CCLBuffer * buf,
+    CCLQueue * cq, cl_bool is_read, cl_bool blocking, size_t offset,
+    size_t size, void * ptr, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    void * map_ptr;
+
+    /* Map region. On unified memory this does not copy data, but the
+     * host still has to wait for the region to become available. */
+    map_ptr = ccl_buffer_enqueue_map(buf, cq, CL_TRUE,
+        is_read ? CL_MAP_READ : CL_MAP_WRITE, offset, size, evt_wait_lst,
+        NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Copy data from or to mapped region. */
+    if (is_read)
+        memcpy(ptr, map_ptr, size);
+    else
+        memcpy(map_ptr, ptr, size);
+
+    /* Give region back to the device. */
+    evt = ccl_memobj_enqueue_unmap(
+        (CCLMemObj *) buf, cq, map_ptr, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Wait for unmap if transfer is blocking. */
+    if (blocking) {
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case the map failed early. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Compare buffer ranges by offset, for sorting.
+ *
+ * @param[in] a First buffer range.
+ * @param[in] b Second buffer range.
+ * @param[in] user_data Unused.
+ * @return Negative, zero or positive value if the offset of `a` is
+ * respectively smaller, equal or larger than the offset of `b`.
+ * */
+static gint ccl_buffer_range_comp(
+    gconstpointer a, gconstpointer b, gpointer user_data) {
+
+    size_t off_a = ((const CCLBufferRange *) a)->offset;
+    size_t off_b = ((const CCLBufferRange *) b)->offset;
+
+    CCL_UNUSED(user_data);
+
+    return (off_a > off_b) - (off_a < off_b);
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine the run of sorted buffer ranges, starting at the given
+ * range, which can be transferred with a single command.
+ *
+ * A run is either a sequence of contiguous ranges, transferred with a
+ * plain read or write, or a sequence of equally sized ranges separated by
+ * a constant stride, transferred with a rectangular read or write.
+ *
+ * @param[in] sorted Buffer ranges sorted by offset.
+ * @param[in] num_ranges Number of buffer ranges.
+ * @param[in] first Index of first range of run.
+ * @param[in] rect Whether strided runs are allowed.
+ * @param[out] stride Distance in bytes between consecutive ranges of a
+ * strided run, or zero if the run is contiguous.
+ * @return Number of ranges in run.
+ * */
+static cl_uint ccl_buffer_range_run(const CCLBufferRange * sorted,
+    cl_uint num_ranges, cl_uint first, cl_bool rect, size_t * stride) {
+
+    cl_uint next = first + 1;
+
+    *stride = 0;
+
+    if ((next < num_ranges) && (sorted[next].offset
+        == sorted[first].offset + sorted[first].size)) {
+
+        /* Contiguous ranges, possibly with different sizes. */
+        while ((next < num_ranges) && (sorted[next].offset
+            == sorted[next - 1].offset + sorted[next - 1].size))
+            ++next;
+
+    } else if (rect && (next < num_ranges)
+        && (sorted[next].size == sorted[first].size)) {
+
+        /* Equally sized ranges separated by a constant stride. */
+        *stride = sorted[next].offset - sorted[first].offset;
+        while ((next < num_ranges)
+            && (sorted[next].size == sorted[first].size)
+            && (sorted[next].offset - sorted[next - 1].offset == *stride))
+            ++next;
+    }
+
+    return next - first;
+}
+
+/**
+ * @internal
+ *
+ * @brief Event callback which releases staging memory of a batched
+ * buffer write.
+ *
+ * @param[in] event Unused.
+ * @param[in] event_command_exec_status Unused.
+ * @param[in] user_data Staging memory to release.
+ * */
+static void CL_CALLBACK ccl_buffer_ranges_free(cl_event event,
+    cl_int event_command_exec_status, void * user_data) {
+
+    CCL_UNUSED(event);
+    CCL_UNUSED(event_command_exec_status);
+
+    g_free(user_data);
+}
+
+/**
+ * @internal
+ *
+ * @brief Read or write a list of buffer ranges with as few commands as
+ * possible.
+ *
+ * Ranges are sorted by offset and grouped into runs with
+ * ccl_buffer_range_run(). Runs with more than one range are transferred
+ * through host staging memory, into which data is packed before writes
+ * and from which it is scattered after reads. Each command waits on the
+ * previous one, so that the event of the last command identifies the
+ * whole transfer.
+ *
+ * @param[in] buf Buffer wrapper object.
+ * @param[in] cq Command-queue wrapper object.
+ * @param[in] is_read Whether to read (`CL_TRUE`) or write (`CL_FALSE`).
+ * @param[in] blocking Whether to wait for the transfer to complete.
+ * Reads always wait.
+ * @param[in] ranges Buffer ranges to transfer.
+ * @param[in] num_ranges Number of buffer ranges.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the transfer starts.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object of the last command, or `NULL` if an
+ * error occurs.
+ * */
+static CCLEvent * ccl_buffer_transfer_ranges(CCLBuffer * buf,
+    CCLQueue * cq, cl_bool is_read, cl_bool blocking,
+    const CCLBufferRange * ranges, cl_uint num_ranges,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEventWaitList * cmd_ewl;
+    CCLBufferRange * sorted = NULL;
+    char * staging = NULL;
+    char * host;
+    size_t staging_size = 0, pos = 0, stride, span;
+    cl_uint count;
+    cl_bool rect;
+    double ocl_ver;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, num_ranges == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: at least one buffer range must be given.", CCL_STRD);
+
+    /* Strided runs are transferred with rectangular reads and writes,
+     * which require OpenCL >= 1.1. */
+    ocl_ver = ccl_memobj_get_opencl_version(
+        (CCLMemObj *) buf, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+#ifdef CL_VERSION_1_1
+    rect = (ocl_ver >= 110) ? CL_TRUE : CL_FALSE;
+#else
+    CCL_UNUSED(ocl_ver);
+    rect = CL_FALSE;
+#endif
+
+    /* Sort a copy of the ranges by offset. */
+    sorted = g_memdup(ranges, num_ranges * sizeof(CCLBufferRange));
+    g_qsort_with_data(sorted, num_ranges, sizeof(CCLBufferRange),
+        ccl_buffer_range_comp, NULL);
+
+    /* Ranges must not be empty or overlap. */
+    for (cl_uint i = 0; i < num_ranges; ++i) {
+        ccl_if_err_create_goto(*err, CCL_ERROR, sorted[i].size == 0,
+            CCL_ERROR_ARGS, error_handler,
+            "%s: buffer ranges must not be empty.", CCL_STRD);
+        ccl_if_err_create_goto(*err, CCL_ERROR, (i > 0) && (sorted[i].offset
+            < sorted[i - 1].offset + sorted[i - 1].size),
+            CCL_ERROR_ARGS, error_handler,
+            "%s: buffer ranges must not overlap.", CCL_STRD);
+    }
+
+    /* Determine size of staging memory, i.e. the total size of runs
+     * with more than one range. */
+    for (cl_uint first = 0; first < num_ranges; first += count) {
+        count = ccl_buffer_range_run(
+            sorted, num_ranges, first, rect, &stride);
+        if (count > 1)
+            for (cl_uint i = first; i < first + count; ++i)
+                staging_size += sorted[i].size;
+    }
+    if (staging_size > 0)
+        staging = g_malloc(staging_size);
+
+    /* Enqueue one command per run. */
+    for (cl_uint first = 0; first < num_ranges; first += count) {
+
+        count = ccl_buffer_range_run(
+            sorted, num_ranges, first, rect, &stride);
+
+        /* Single ranges are transferred directly, others through staging
+         * memory, packing data into it before writes. */
+        span = 0;
+        if (count == 1) {
+            host = sorted[first].ptr;
+            span = sorted[first].size;
+        } else {
+            host = staging + pos;
+            for (cl_uint i = first; i < first + count; ++i) {
+                if (!is_read)
+                    memcpy(host + span, sorted[i].ptr, sorted[i].size);
+                span += sorted[i].size;
+            }
+            pos += span;
+        }
+
+        /* The first command waits on the client events, the following
+         * ones on the previous command. */
+        cmd_ewl = (evt == NULL) ? evt_wait_lst : ccl_ewl(&ewl, evt, NULL);
+
+        if (stride == 0) {
+            /* Contiguous run. */
+            evt = is_read
+                ? ccl_buffer_enqueue_read(buf, cq, CL_FALSE,
+                    sorted[first].offset, span, host, cmd_ewl, &err_internal)
+                : ccl_buffer_enqueue_write(buf, cq, CL_FALSE,
+                    sorted[first].offset, span, host, cmd_ewl, &err_internal);
+        } else {
+            /* Strided run, one row per range. */
+            size_t buffer_origin[3] = { sorted[first].offset, 0, 0 };
+            size_t host_origin[3] = { 0, 0, 0 };
+            size_t region[3] = { sorted[first].size, count, 1 };
+            evt = is_read
+                ? ccl_buffer_enqueue_read_rect(buf, cq, CL_FALSE,
+                    buffer_origin, host_origin, region, stride, 0,
+                    region[0], 0, host, cmd_ewl, &err_internal)
+                : ccl_buffer_enqueue_write_rect(buf, cq, CL_FALSE,
+                    buffer_origin, host_origin, region, stride, 0,
+                    region[0], 0, host, cmd_ewl, &err_internal);
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    if (blocking || is_read || ((staging != NULL) && !rect)) {
+
+        /* Wait for transfer. */
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Scatter read data from staging memory. */
+        pos = 0;
+        for (cl_uint first = 0; is_read && (first < num_ranges);
+            first += count) {
+            count = ccl_buffer_range_run(
+                sorted, num_ranges, first, rect, &stride);
+            for (cl_uint i = first; (count > 1) && (i < first + count); ++i) {
+                memcpy(sorted[i].ptr, staging + pos, sorted[i].size);
+                pos += sorted[i].size;
+            }
+        }
+
+    } else if (staging != NULL) {
+
+        /* Release staging memory when the write completes. */
+        ccl_event_set_callback(evt, CL_COMPLETE, ccl_buffer_ranges_free,
+            staging, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        staging = NULL;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Make sure enqueued commands no longer use staging memory. */
+    if ((staging != NULL) && (evt != NULL))
+        ccl_queue_finish(cq, NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case no command was enqueued. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Release temporary memory. */
+    g_free(staging);
+    g_free(sorted);
+
+    /* Return event. */
+    return evt;
+}
+
 /**
  * @addtogroup CCL_BUFFER_WRAPPER
  * @{
@@ -84,7 +454,8 @@ CCLBuffer * ccl_buffer_new_wrap(cl_mem mem_object) {
 CCL_EXPORT
 void ccl_buffer_destroy(CCLBuffer * buf) {
 
-    ccl_wrapper_unref((CCLWrapper *) buf, sizeof(CCLBuffer), NULL,
+    ccl_wrapper_unref((CCLWrapper *) buf, sizeof(CCLBuffer),
+        (ccl_wrapper_release_fields) ccl_memobj_release_fields,
         (ccl_wrapper_release_cl_object) clReleaseMemObject, NULL);
 }
 
@@ -116,6 +487,7 @@ CCLBuffer * ccl_buffer_new(CCLContext * ctx, cl_mem_flags flags,
     cl_int ocl_status;
     cl_mem buffer;
     CCLBuffer * buf = NULL;
+    CCLErr * err_internal = NULL;
 
     /* Create OpenCL buffer. */
     buffer = clCreateBuffer(ccl_context_unwrap(ctx), flags, size,
@@ -128,6 +500,103 @@ CCLBuffer * ccl_buffer_new(CCLContext * ctx, cl_mem_flags flags,
     /* Wrap OpenCL buffer. */
     buf = ccl_buffer_new_wrap(buffer);
 
+    /* Account for buffer memory in context. */
+    ccl_context_mem_track(ctx, (CCLMemObj *) buf, size, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release buffer, if it was created. */
+    if (buf != NULL) {
+        ccl_buffer_destroy(buf);
+        buf = NULL;
+    }
+
+finish:
+
+    /* Return new buffer wrapper. */
+    return buf;
+}
+
+/**
+ * Create a ::CCLBuffer wrapper object in zero-copy mode, if all devices
+ * in the context share memory with the host.
+ *
+ * If all devices in the context report `CL_DEVICE_HOST_UNIFIED_MEMORY`,
+ * e.g. CPUs and integrated GPUs, the buffer is allocated with
+ * `CL_MEM_ALLOC_HOST_PTR`, so that the OpenCL implementation provides
+ * host memory with the alignment required for sharing it with the
+ * devices. ::ccl_buffer_enqueue_read() and ::ccl_buffer_enqueue_write()
+ * on such buffers map the region and copy data directly, instead of
+ * having the device transfer it. Otherwise, e.g. on discrete GPUs, a
+ * regular buffer is created.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] ctx Context wrapper.
+ * @param[in] flags OpenCL memory flags as used in clCreateBuffer(),
+ * excluding host pointer flags.
+ * @param[in] size The size in bytes of the buffer memory object to be
+ * allocated.
+ * @param[in] host_ptr Data with which to initialize the buffer, or `NULL`
+ * to leave it uninitialized. The size of the buffer that `host_ptr`
+ * points to must be >= size bytes.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new wrapper object, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_zero_copy(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, void * host_ptr, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLBuffer * buf = NULL;
+    CCLDevice * dev;
+    cl_uint num_devs;
+    cl_bool unified = CL_TRUE;
+
+    /* Host pointer flags are determined by this function. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, flags & (CL_MEM_USE_HOST_PTR
+        | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR), CCL_ERROR_ARGS,
+        error_handler, "%s: host pointer flags cannot be specified for "
+        "zero-copy buffers.", CCL_STRD);
+
+    /* Check if all devices share memory with the host. */
+    num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    for (cl_uint i = 0; (i < num_devs) && unified; ++i) {
+        dev = ccl_context_get_device(ctx, i, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        unified = ccl_device_get_info_scalar(dev,
+            CL_DEVICE_HOST_UNIFIED_MEMORY, cl_bool, &err_internal);
+        if (err_internal != NULL) {
+            /* Query may be unavailable on recent platforms, in which case
+             * assume memory is not unified. */
+            g_clear_error(&err_internal);
+            unified = CL_FALSE;
+        }
+    }
+
+    /* Let the OpenCL implementation allocate shareable host memory. */
+    if (unified) flags |= CL_MEM_ALLOC_HOST_PTR;
+    if (host_ptr != NULL) flags |= CL_MEM_COPY_HOST_PTR;
+
+    /* Create buffer. */
+    buf = ccl_buffer_new(ctx, flags, size, host_ptr, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    buf->zero_copy = unified;
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -142,10 +611,33 @@ finish:
     return buf;
 }
 
+/**
+ * Check if buffer was created in zero-copy mode on unified memory with
+ * ::ccl_buffer_new_zero_copy().
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] buf Buffer wrapper object.
+ * @return `CL_TRUE` if the buffer is zero-copy, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_buffer_is_zero_copy(CCLBuffer * buf) {
+
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, CL_FALSE);
+
+    return buf->zero_copy;
+}
+
 /**
  * Read from a buffer object to host memory. This function wraps the
  * clEnqueueReadBuffer() OpenCL function.
  *
+ * If the buffer was created in zero-copy mode on unified memory, the
+ * region is mapped and copied to host memory instead. The region is
+ * then ready when this function returns, even if the read is
+ * non-blocking.
+ *
  * @public @memberof ccl_buffer
  *
  * @param[in] buf Buffer wrapper object where to read from.
@@ -177,14 +669,29 @@ CCLEvent * ccl_buffer_enqueue_read(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Map zero-copy buffers instead of reading them. */
+    if (buf->zero_copy)
+        return ccl_buffer_zero_copy_transfer(buf, cq, CL_TRUE,
+            blocking_read, offset, size, ptr, evt_wait_lst, err);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     cl_int ocl_status;
     cl_event event = NULL;
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
 
     ocl_status = clEnqueueReadBuffer(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(buf), blocking_read, offset, size, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to read buffer (OpenCL error %d: %s).",
@@ -193,7 +700,10 @@ CCLEvent * ccl_buffer_enqueue_read(CCLBuffer * buf, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) buf, cq, CL_FALSE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -211,6 +721,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -219,6 +732,11 @@ finish:
  * Write to a buffer object from host memory. This function wraps the
  * clEnqueueWriteBuffer() OpenCL function.
  *
+ * If the buffer was created in zero-copy mode on unified memory, the
+ * region is mapped and host memory is copied to it instead. Host memory
+ * can then be reused when this function returns, even if the write is
+ * non-blocking.
+ *
  * @public @memberof ccl_buffer
  *
  * @param[out] buf Buffer wrapper object where to write to.
@@ -251,14 +769,29 @@ CCLEvent * ccl_buffer_enqueue_write(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Map zero-copy buffers instead of writing them. */
+    if (buf->zero_copy)
+        return ccl_buffer_zero_copy_transfer(buf, cq, CL_FALSE,
+            blocking_write, offset, size, ptr, evt_wait_lst, err);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     cl_int ocl_status;
     cl_event event = NULL;
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     ocl_status = clEnqueueWriteBuffer(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(buf), blocking_write, offset, size, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to write buffer (OpenCL error %d: %s).",
@@ -267,7 +800,13 @@ CCLEvent * ccl_buffer_enqueue_write(CCLBuffer * buf, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record device where buffer was written, if tracked. */
+    ccl_memobj_residency_update((CCLMemObj *) buf, cq, evt);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) buf, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -285,6 +824,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -329,17 +871,26 @@ void * ccl_buffer_enqueue_map(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     cl_int ocl_status;
     cl_event event = NULL;
     CCLEvent * evt_inner = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     void * ptr = NULL;
 
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq,
+        map_flags != CL_MAP_READ, evt_wait_lst, &hzd_ewl);
+
     /* Perform buffer map. */
     ptr = clEnqueueMapBuffer(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(buf), blocking_map, map_flags, offset, size,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
         ccl_event_wait_list_get_clevents(evt_wait_lst),
-        &event, &ocl_status);
+        ccl_queue_event_ptr(cq, &event), &ocl_status);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to map buffer (OpenCL error %d: %s).",
@@ -348,10 +899,14 @@ void * ccl_buffer_enqueue_map(CCLBuffer * buf, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt_inner = ccl_queue_produce_event(cq, event);
+    evt_inner = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
     if (evt != NULL)
         *evt = evt_inner;
 
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record(
+        (CCLMemObj *) buf, cq, map_flags != CL_MAP_READ, evt_inner);
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -368,10 +923,144 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return host pointer. */
     return ptr;
 }
 
+/**
+ * @internal
+ *
+ * @brief Mapped buffer region handed to a `GBytes` object by
+ * ::ccl_buffer_enqueue_read_bytes().
+ * */
+struct ccl_buffer_bytes {
+
+    /** Mapped buffer. */
+    CCLBuffer * buf;
+
+    /** Command queue in which the region was mapped. */
+    CCLQueue * cq;
+
+    /** Pointer to the mapped region. */
+    void * ptr;
+};
+
+/**
+ * @internal
+ *
+ * @brief Unmap a buffer region when the last reference to the `GBytes`
+ * object wrapping it is dropped.
+ *
+ * @param[in] data A `struct ccl_buffer_bytes` object.
+ * */
+static void ccl_buffer_bytes_unmap(gpointer data) {
+
+    struct ccl_buffer_bytes * bb = (struct ccl_buffer_bytes *) data;
+    CCLErr * err_internal = NULL;
+
+    /* Give region back to the device. There is no error reporting
+     * location at this point, so just warn. */
+    ccl_buffer_enqueue_unmap(bb->buf, bb->cq, bb->ptr, NULL, &err_internal);
+    if (err_internal != NULL) {
+        g_warning("Unable to unmap buffer region: %s", err_internal->message);
+        g_error_free(err_internal);
+    }
+
+    /* Release references taken when the region was mapped. */
+    ccl_buffer_unref(bb->buf);
+    ccl_queue_unref(bb->cq);
+    g_slice_free(struct ccl_buffer_bytes, bb);
+}
+
+/**
+ * Read from a buffer object into a `GBytes` object backed by a mapped
+ * region of the buffer, avoiding a copy into separately allocated host
+ * memory.
+ *
+ * The region is mapped for reading with a blocking call to
+ * ::ccl_buffer_enqueue_map(), so its contents are available when this
+ * function returns. The region is unmapped in `cq` when the last
+ * reference to the returned `GBytes` object is dropped, and the buffer
+ * and queue wrappers are kept alive until then. The data is only truly
+ * zero-copy for buffers whose memory is accessible by the host, e.g.
+ * buffers created with ::ccl_buffer_new_zero_copy() or with the
+ * `CL_MEM_ALLOC_HOST_PTR` flag; for other buffers the OpenCL
+ * implementation copies the region into a host staging area when
+ * mapping, which still replaces the read plus copy into a `GBytes`.
+ *
+ * Since unmapping enqueues a command in `cq`, the last reference should
+ * be dropped in a thread where it is safe to enqueue commands in `cq`,
+ * and before writing to the region from the device.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] buf Buffer wrapper object where to read from.
+ * @param[in] cq Command-queue wrapper object in which the map and unmap
+ * commands will be queued.
+ * @param[in] offset The offset in bytes in the buffer object to read
+ * from.
+ * @param[in] size The size in bytes of data being read.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] evt An event wrapper object that identifies the map
+ * command. If `NULL`, no event will be returned.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A `GBytes` object with the read data, which should be released
+ * with `g_bytes_unref()`, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+GBytes * ccl_buffer_enqueue_read_bytes(CCLBuffer * buf, CCLQueue * cq,
+    size_t offset, size_t size, CCLEventWaitList * evt_wait_lst,
+    CCLEvent ** evt, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    struct ccl_buffer_bytes * bb;
+    GBytes * bytes = NULL;
+    void * ptr;
+
+    /* Map region for reading, waiting for its contents. */
+    ptr = ccl_buffer_enqueue_map(buf, cq, CL_TRUE, CL_MAP_READ, offset,
+        size, evt_wait_lst, evt, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Keep buffer and queue alive until the region is unmapped. */
+    bb = g_slice_new(struct ccl_buffer_bytes);
+    bb->buf = buf;
+    bb->cq = cq;
+    bb->ptr = ptr;
+    ccl_buffer_ref(buf);
+    ccl_queue_ref(cq);
+
+    /* Hand mapped region to a GBytes object. */
+    bytes = g_bytes_new_with_free_func(
+        ptr, size, ccl_buffer_bytes_unmap, bb);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return GBytes object. */
+    return bytes;
+}
+
 /**
  * Copy from one buffer object to another. This function wraps the
  * clEnqueueCopyBuffer() OpenCL function.
@@ -410,15 +1099,27 @@ CCLEvent * ccl_buffer_enqueue_copy(CCLBuffer * src_buf,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     cl_int ocl_status;
     cl_event event = NULL;
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory objects. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) src_buf, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) dst_buf, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     ocl_status = clEnqueueCopyBuffer(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(src_buf), ccl_memobj_unwrap(dst_buf),
         src_offset, dst_offset, size,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to write buffer (OpenCL error %d: %s).",
@@ -427,7 +1128,14 @@ CCLEvent * ccl_buffer_enqueue_copy(CCLBuffer * src_buf,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record device where buffer was written, if tracked. */
+    ccl_memobj_residency_update((CCLMemObj *) dst_buf, cq, evt);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) src_buf, cq, CL_FALSE, evt);
+    ccl_memobj_hazard_record((CCLMemObj *) dst_buf, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -445,6 +1153,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -493,19 +1204,31 @@ CCLEvent * ccl_buffer_enqueue_copy_to_image(CCLBuffer * src_buf,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory objects. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) src_buf, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) dst_img, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Copy buffer to image. */
     ocl_status = clEnqueueCopyBufferToImage(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(src_buf), ccl_memobj_unwrap(dst_img),
         src_offset, dst_origin, region,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to copy buffer to image (OpenCL error %d: %s).",
@@ -514,7 +1237,11 @@ CCLEvent * ccl_buffer_enqueue_copy_to_image(CCLBuffer * src_buf,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) src_buf, cq, CL_FALSE, evt);
+    ccl_memobj_hazard_record((CCLMemObj *) dst_img, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -532,6 +1259,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -688,12 +1418,17 @@ CCLEvent * ccl_buffer_enqueue_read_rect(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     /* OpenCL version of the underlying platform. */
     double ocl_ver;
     /* Internal error handling object. */
@@ -701,6 +1436,7 @@ CCLEvent * ccl_buffer_enqueue_read_rect(CCLBuffer * buf, CCLQueue * cq,
 
 #ifndef CL_VERSION_1_1
 
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(blocking_read);
     CCL_UNUSED(buffer_origin);
     CCL_UNUSED(host_origin);
@@ -738,13 +1474,18 @@ CCLEvent * ccl_buffer_enqueue_read_rect(CCLBuffer * buf, CCLQueue * cq,
         "%s: rect. buffer reads require OpenCL version 1.1 or newer.",
         CCL_STRD);
 
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+
     /* Read rectangular region of buffer. */
     ocl_status = clEnqueueReadBufferRect(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(buf), blocking_read, buffer_origin,
         host_origin, region, buffer_row_pitch, buffer_slice_pitch,
         host_row_pitch, host_slice_pitch, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue a rectangular buffer read (OpenCL error %d: %s).",
@@ -753,7 +1494,10 @@ CCLEvent * ccl_buffer_enqueue_read_rect(CCLBuffer * buf, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) buf, cq, CL_FALSE, evt);
 
 #endif
 
@@ -773,6 +1517,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -829,12 +1576,17 @@ CCLEvent * ccl_buffer_enqueue_write_rect(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     /* OpenCL version of the underlying platform. */
     double ocl_ver;
     /* Internal error handling object. */
@@ -842,6 +1594,7 @@ CCLEvent * ccl_buffer_enqueue_write_rect(CCLBuffer * buf, CCLQueue * cq,
 
 #ifndef CL_VERSION_1_1
 
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(blocking_write);
     CCL_UNUSED(buffer_origin);
     CCL_UNUSED(host_origin);
@@ -878,13 +1631,18 @@ CCLEvent * ccl_buffer_enqueue_write_rect(CCLBuffer * buf, CCLQueue * cq,
         "%s: rect. buffer writes require OpenCL version 1.1 or newer.",
         CCL_STRD);
 
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
+
     /* Write rectangular region of buffer. */
     ocl_status = clEnqueueWriteBufferRect(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(buf), blocking_write, buffer_origin,
         host_origin, region, buffer_row_pitch, buffer_slice_pitch,
         host_row_pitch, host_slice_pitch, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue a rectangular buffer write (OpenCL error %d: %s).",
@@ -893,7 +1651,13 @@ CCLEvent * ccl_buffer_enqueue_write_rect(CCLBuffer * buf, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record device where buffer was written, if tracked. */
+    ccl_memobj_residency_update((CCLMemObj *) buf, cq, evt);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) buf, cq, CL_TRUE, evt);
 
 #endif
 
@@ -914,6 +1678,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -969,12 +1736,17 @@ CCLEvent * ccl_buffer_enqueue_copy_rect(CCLBuffer * src_buf,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     /* OpenCL version of the underlying platform. */
     double ocl_ver;
     /* Internal error handling object. */
@@ -982,6 +1754,7 @@ CCLEvent * ccl_buffer_enqueue_copy_rect(CCLBuffer * src_buf,
 
 #ifndef CL_VERSION_1_1
 
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(src_origin);
     CCL_UNUSED(dst_origin);
     CCL_UNUSED(region);
@@ -1017,13 +1790,20 @@ CCLEvent * ccl_buffer_enqueue_copy_rect(CCLBuffer * src_buf,
         "%s: rect. buffer copy requires OpenCL version 1.1 or newer.",
         CCL_STRD);
 
+    /* Wait for conflicting commands on the memory objects. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) src_buf, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) dst_buf, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
+
     /* Copy rectangular region between buffers. */
     ocl_status = clEnqueueCopyBufferRect(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(src_buf), ccl_memobj_unwrap(dst_buf),
         src_origin, dst_origin, region, src_row_pitch, src_slice_pitch,
         dst_row_pitch, dst_slice_pitch,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue a rectangular buffer copy (OpenCL error %d: %s).",
@@ -1032,7 +1812,14 @@ CCLEvent * ccl_buffer_enqueue_copy_rect(CCLBuffer * src_buf,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record device where buffer was written, if tracked. */
+    ccl_memobj_residency_update((CCLMemObj *) dst_buf, cq, evt);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) src_buf, cq, CL_FALSE, evt);
+    ccl_memobj_hazard_record((CCLMemObj *) dst_buf, cq, CL_TRUE, evt);
 
 #endif
 
@@ -1052,6 +1839,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -1060,14 +1850,18 @@ finish:
  * Fill a buffer object with a pattern of a given pattern size. This
  * function wraps the clEnqueueFillBuffer() OpenCL function.
  *
+ * If clEnqueueFillBuffer() is not available, i.e. with OpenCL < 1.2, or
+ * if the pattern size is not a power of two, the buffer is filled by a
+ * built-in kernel, which is built once per context. In this case, the
+ * returned event is the event of the kernel.
+ *
  * @public @memberof ccl_buffer
- * @note Requires OpenCL >= 1.2
  *
  * @param[out] buf Buffer wrapper object to fill.
  * @param[in] cq Command-queue wrapper object in which the fill command
  * will be queued.
  * @param[in] pattern A pointer to the data pattern.
- * @param[in] pattern_size Size of data pattern in bytes.
+ * @param[in] pattern_size Size of data pattern in bytes, at most 128.
  * @param[in] offset The location in bytes of the region being filled in
  * buffer and must be a multiple of pattern_size.
  * @param[in] size The size in bytes of region being filled in buffer.
@@ -1091,68 +1885,87 @@ CCLEvent * ccl_buffer_enqueue_fill(CCLBuffer * buf, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     /* OpenCL version of the underlying platform. */
     double ocl_ver;
     /* Internal error handling object. */
     CCLErr * err_internal = NULL;
+    /* Use the OpenCL fill command? */
+    cl_bool native = CL_FALSE;
 
-#ifndef CL_VERSION_1_2
+#ifdef CL_VERSION_1_2
 
-    CCL_UNUSED(pattern);
-    CCL_UNUSED(pattern_size);
-    CCL_UNUSED(offset);
-    CCL_UNUSED(size);
-    CCL_UNUSED(evt_wait_lst);
+    /* Check that context platform is >= OpenCL 1.2 */
+    ocl_ver = ccl_memobj_get_opencl_version(
+        (CCLMemObj *) buf, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* clEnqueueFillBuffer() requires OpenCL >= 1.2 and a pattern size
+     * which is a power of two, up to 128 bytes. */
+    native = (ocl_ver >= 120) && (pattern_size > 0)
+        && (pattern_size <= 128) && !(pattern_size & (pattern_size - 1));
+
+#else
+
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(ocl_status);
     CCL_UNUSED(event);
-    CCL_UNUSED(evt);
     CCL_UNUSED(ocl_ver);
-    CCL_UNUSED(err_internal);
 
-    /* If cf4ocl was not compiled with support for OpenCL >= 1.2, always throw
-     * error. */
-    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
-        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
-        "%s: Buffer fill requires cf4ocl to be deployed with "
-        "support for OpenCL version 1.1 or newer.",
-        CCL_STRD);
+#endif
 
-#else
+    if (native) {
 
-    /* Check that context platform is >= OpenCL 1.2 */
-    ocl_ver = ccl_memobj_get_opencl_version(
-        (CCLMemObj *) buf, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+#ifdef CL_VERSION_1_2
 
-    /* If OpenCL version is not >= 1.2, throw error. */
-    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
-        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
-        "%s: Buffer fill requires OpenCL version 1.2 or newer.",
-        CCL_STRD);
+        /* Wait for conflicting commands on the memory object. */
+        evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) buf, cq, CL_TRUE,
+            evt_wait_lst, &hzd_ewl);
 
-    /* Fill buffer. */
-    ocl_status = clEnqueueFillBuffer(ccl_queue_unwrap(cq),
-        ccl_memobj_unwrap(buf), pattern, pattern_size, offset, size,
-        ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: unable to enqueue a fill buffer command (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
+        /* Fill buffer. */
+        ocl_status = clEnqueueFillBuffer(ccl_queue_unwrap(cq),
+            ccl_memobj_unwrap(buf), pattern, pattern_size, offset, size,
+            ccl_event_wait_list_get_num_events(evt_wait_lst),
+            ccl_event_wait_list_get_clevents(evt_wait_lst),
+            ccl_queue_event_ptr(cq, &event));
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to enqueue a fill buffer command "
+            "(OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
 
-    /* Wrap event and associate it with the respective command queue.
-     * The event object will be released automatically when the command
-     * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+        /* Wrap event and associate it with the respective command
+         * queue. The event object will be released automatically when
+         * the command queue is released. */
+        evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+        /* Record device where buffer was written, if tracked. */
+        ccl_memobj_residency_update((CCLMemObj *) buf, cq, evt);
+
+        /* Record access to memory object, if hazards are tracked. */
+        ccl_memobj_hazard_record((CCLMemObj *) buf, cq, CL_TRUE, evt);
 
 #endif
 
+    } else {
+
+        /* Otherwise fill buffer with a kernel, which is built once per
+         * context. */
+        evt = ccl_fill_buffer_kernel(buf, cq, pattern, pattern_size, offset,
+            size, evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -1169,8 +1982,102 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
 
+/**
+ * Write a list of disjoint host memory ranges into a buffer, coalescing
+ * them into as few commands as possible.
+ *
+ * Ranges are sorted by offset. Contiguous ranges are written with one
+ * ::ccl_buffer_enqueue_write() command, and equally sized ranges
+ * separated by a constant stride with one
+ * ::ccl_buffer_enqueue_write_rect() command (OpenCL >= 1.1). Data of
+ * ranges grouped in this way is first packed into host staging memory,
+ * so host memory of the ranges can be reused as soon as this function
+ * returns. Staging memory of non-blocking writes is released when the
+ * write completes.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[out] buf Buffer wrapper object where to write to.
+ * @param[in] cq Command-queue wrapper object in which the write commands
+ * will be queued.
+ * @param[in] blocking_write Indicates if the write operation is blocking
+ * or non-blocking. Non-blocking writes are blocking if the platform
+ * OpenCL version is 1.0 and some ranges have been coalesced.
+ * @param[in] ranges Ranges to write, which must not be empty or overlap.
+ * @param[in] num_ranges Number of ranges to write.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first write command can be executed. The list will be
+ * cleared and can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the last write command,
+ * which completes after all the others, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_write_ranges(CCLBuffer * buf, CCLQueue * cq,
+    cl_bool blocking_write, const CCLBufferRange * ranges,
+    cl_uint num_ranges, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure ranges is not NULL. */
+    g_return_val_if_fail(ranges != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_buffer_transfer_ranges(buf, cq, CL_FALSE, blocking_write,
+        ranges, num_ranges, evt_wait_lst, err);
+}
+
+/**
+ * Read a list of disjoint buffer ranges into host memory, coalescing
+ * them into as few commands as possible.
+ *
+ * Ranges are grouped as in ::ccl_buffer_enqueue_write_ranges(). Grouped
+ * ranges are read into host staging memory, and scattered from there
+ * into the host memory of each range. As such, this function always
+ * waits for the read commands to complete.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] buf Buffer wrapper object where to read from.
+ * @param[in] cq Command-queue wrapper object in which the read commands
+ * will be queued.
+ * @param[in] ranges Ranges to read, which must not be empty or overlap.
+ * @param[in] num_ranges Number of ranges to read.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first read command can be executed. The list will be
+ * cleared and can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the last read command,
+ * or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_read_ranges(CCLBuffer * buf, CCLQueue * cq,
+    const CCLBufferRange * ranges, cl_uint num_ranges,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure ranges is not NULL. */
+    g_return_val_if_fail(ranges != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_buffer_transfer_ranges(buf, cq, CL_TRUE, CL_TRUE,
+        ranges, num_ranges, evt_wait_lst, err);
+}
+
 /** @} */
@@ -42,6 +42,21 @@
  * represent a specific region in the original buffer (which is the only
  * sub-buffer type, up to OpenCL 2.1).
  *
+ * Buffers created with ::ccl_buffer_new_zero_copy() use host memory shared
+ * with the devices when all of them report unified memory, in which case
+ * ::ccl_buffer_enqueue_read() and ::ccl_buffer_enqueue_write() map the
+ * buffer instead of transferring data.
+ *
+ * Results can be handed to GLib-based code without an additional copy
+ * with ::ccl_buffer_enqueue_read_bytes(), which returns a `GBytes` object
+ * backed by a mapped region of the buffer. The region is unmapped when
+ * the last reference to the `GBytes` object is dropped.
+ *
+ * Many small disjoint ranges of a buffer can be written or read with
+ * ::ccl_buffer_enqueue_write_ranges() and ::ccl_buffer_enqueue_read_ranges(),
+ * which coalesce contiguous or regularly strided ranges into single
+ * commands, instead of enqueuing one command per range.
+ *
  * Buffer wrapper objects can be directly passed as kernel arguments to
  * functions such as ::ccl_kernel_set_args_and_enqueue_ndrange() or
  * ::ccl_kernel_set_args_v().
@@ -87,6 +102,31 @@
  * @{
  * */
 
+/**
+ * Host memory range of a buffer, used in batched reads and writes.
+ * */
+typedef struct ccl_buffer_range {
+
+    /**
+     * Offset in bytes of range in buffer.
+     * @public
+     * */
+    size_t offset;
+
+    /**
+     * Size in bytes of range.
+     * @public
+     * */
+    size_t size;
+
+    /**
+     * Host memory to write range from or read range into.
+     * @public
+     * */
+    void * ptr;
+
+} CCLBufferRange;
+
 /* Get the buffer wrapper for the given OpenCL buffer. */
 CCL_EXPORT
 CCLBuffer * ccl_buffer_new_wrap(cl_mem mem_object);
@@ -96,6 +136,16 @@ CCL_EXPORT
 CCLBuffer * ccl_buffer_new(CCLContext * ctx, cl_mem_flags flags,
     size_t size, void * host_ptr, CCLErr ** err);
 
+/* Create a ::CCLBuffer wrapper object in zero-copy mode, if all devices
+ * in the context share memory with the host. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_zero_copy(CCLContext * ctx, cl_mem_flags flags,
+    size_t size, void * host_ptr, CCLErr ** err);
+
+/* Check if buffer was created in zero-copy mode on unified memory. */
+CCL_EXPORT
+cl_bool ccl_buffer_is_zero_copy(CCLBuffer * buf);
+
 /* Decrements the reference count of the wrapper object. If it
  * reaches 0, the wrapper object is destroyed. */
 CCL_EXPORT
@@ -121,6 +171,13 @@ void * ccl_buffer_enqueue_map(CCLBuffer * buf, CCLQueue * cq,
     size_t size, CCLEventWaitList * evt_wait_lst, CCLEvent ** evt,
     CCLErr ** err);
 
+/* Read from a buffer object into a GBytes object backed by a mapped
+ * region of the buffer. */
+CCL_EXPORT
+GBytes * ccl_buffer_enqueue_read_bytes(CCLBuffer * buf, CCLQueue * cq,
+    size_t offset, size_t size, CCLEventWaitList * evt_wait_lst,
+    CCLEvent ** evt, CCLErr ** err);
+
 /* Copy from one buffer object to another. */
 CCL_EXPORT
 CCLEvent * ccl_buffer_enqueue_copy(CCLBuffer * src_buf,
@@ -178,6 +235,20 @@ CCLEvent * ccl_buffer_enqueue_fill(CCLBuffer * buf, CCLQueue * cq,
     const void * pattern, size_t pattern_size, size_t offset,
     size_t size, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
 
+/* Write a list of host memory ranges into a buffer, coalescing them into
+ * as few commands as possible. */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_write_ranges(CCLBuffer * buf, CCLQueue * cq,
+    cl_bool blocking_write, const CCLBufferRange * ranges,
+    cl_uint num_ranges, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Read a list of buffer ranges into host memory, coalescing them into as
+ * few commands as possible. */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_read_ranges(CCLBuffer * buf, CCLQueue * cq,
+    const CCLBufferRange * ranges, cl_uint num_ranges,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
 /**
  * Enqueues a command to unmap a previously mapped buffer object. This
  * is a utility macro that expands to ::ccl_memobj_enqueue_unmap(),
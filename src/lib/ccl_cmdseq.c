@@ -0,0 +1,979 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of recorded command sequences and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_cmdseq.h"
+#include "ccl_device_wrapper.h"
+#include "_ccl_kernel_wrapper.h"
+#include "_ccl_queue_wrapper.h"
+#include "_ccl_defs.h"
+#include "_ccl_icd.h"
+#include "_ccl_host_trace.h"
+
+/* Use cl_khr_command_buffer if the OpenCL headers define it. Extension
+ * functions are obtained with clGetExtensionFunctionAddressForPlatform(),
+ * available since OpenCL 1.2. */
+#if defined(cl_khr_command_buffer) && defined(CL_VERSION_1_2)
+#define CCL_CMDSEQ_KHR
+#endif
+
+/**
+ * @internal
+ *
+ * @brief Type of recorded command.
+ * */
+typedef enum ccl_cmdseq_cmd_type {
+
+    /** Kernel launch. */
+    CCL_CMDSEQ_NDRANGE,
+    /** Write from host memory to buffer. */
+    CCL_CMDSEQ_WRITE,
+    /** Read from buffer to host memory. */
+    CCL_CMDSEQ_READ,
+    /** Copy between buffers. */
+    CCL_CMDSEQ_COPY
+
+} CCLCmdSeqCmdType;
+
+/**
+ * @internal
+ *
+ * @brief A recorded command.
+ * */
+struct ccl_cmdseq_cmd {
+
+    /**
+     * Command type.
+     * @private
+     * */
+    CCLCmdSeqCmdType type;
+
+    /**
+     * Kernel to launch.
+     * @private
+     * */
+    CCLKernel * krnl;
+
+    /**
+     * Version of kernel arguments when the command was recorded in the
+     * command buffer.
+     * @private
+     * */
+    cl_ulong args_version;
+
+    /**
+     * Number of work dimensions.
+     * @private
+     * */
+    cl_uint work_dim;
+
+    /**
+     * Global work offset, global and local work sizes.
+     * @private
+     * */
+    size_t sizes[3 * CCL_CMDSEQ_MAX_DIMS];
+
+    /**
+     * Was a global work offset given?
+     * @private
+     * */
+    cl_bool has_offset;
+
+    /**
+     * Was a local work size given?
+     * @private
+     * */
+    cl_bool has_lws;
+
+    /**
+     * Buffer to transfer or copy from.
+     * @private
+     * */
+    CCLBuffer * buf;
+
+    /**
+     * Buffer to copy to.
+     * @private
+     * */
+    CCLBuffer * dst_buf;
+
+    /**
+     * Offset in `buf`.
+     * @private
+     * */
+    size_t offset;
+
+    /**
+     * Offset in `dst_buf`.
+     * @private
+     * */
+    size_t dst_offset;
+
+    /**
+     * Size in bytes to transfer or copy.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * Host memory to transfer to or from.
+     * @private
+     * */
+    void * ptr;
+
+};
+
+/**
+ * Recorded command sequence class.
+ * */
+struct ccl_cmdseq {
+
+    /**
+     * Command queue where commands are replayed.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Recorded commands.
+     * @private
+     * */
+    GArray * cmds;
+
+    /**
+     * Is the command queue in-order?
+     * @private
+     * */
+    cl_bool in_order;
+
+    /**
+     * Does the sequence contain host transfer commands?
+     * @private
+     * */
+    cl_bool has_host_cmds;
+
+#ifdef CCL_CMDSEQ_KHR
+
+    /**
+     * Is cl_khr_command_buffer supported for the command queue?
+     * @private
+     * */
+    cl_bool khr;
+
+    /**
+     * Does the device support simultaneous use of command buffers?
+     * @private
+     * */
+    cl_bool khr_simultaneous;
+
+    /**
+     * Recorded command buffer, or `NULL` if not (or no longer) recorded.
+     * @private
+     * */
+    cl_command_buffer_khr cmdbuf;
+
+    /**
+     * Event of last replay, if the device doesn't support simultaneous
+     * use of command buffers.
+     * @private
+     * */
+    cl_event last_event;
+
+    /** @private */
+    clCreateCommandBufferKHR_fn create_fn;
+    /** @private */
+    clFinalizeCommandBufferKHR_fn finalize_fn;
+    /** @private */
+    clReleaseCommandBufferKHR_fn release_fn;
+    /** @private */
+    clEnqueueCommandBufferKHR_fn enqueue_fn;
+    /** @private */
+    clCommandNDRangeKernelKHR_fn ndrange_fn;
+    /** @private */
+    clCommandCopyBufferKHR_fn copy_fn;
+
+#endif
+
+};
+
+#ifdef CCL_CMDSEQ_KHR
+
+/**
+ * @internal
+ *
+ * @brief Determine if the cl_khr_command_buffer extension can be used
+ * with the command queue of a command sequence, and if so, get the
+ * extension functions. Any errors simply disable the extension.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] props Command queue properties.
+ * */
+static void ccl_cmdseq_khr_init(
+    CCLCmdSeq * seq, cl_command_queue_properties props) {
+
+    CCLErr * err_internal = NULL;
+    CCLDevice * dev;
+    const CCLDeviceCaps * dev_caps;
+    cl_platform_id platf;
+    cl_command_queue_properties required;
+    cl_device_command_buffer_capabilities_khr caps;
+
+    seq->khr = CL_FALSE;
+
+    /* Check that device supports extension. */
+    dev = ccl_queue_get_device(seq->cq, &err_internal);
+    if (dev == NULL) goto finish;
+    dev_caps = ccl_device_get_caps(dev, &err_internal);
+    if ((dev_caps == NULL)
+            || !(dev_caps->extensions & CCL_DEVICE_EXT_KHR_COMMAND_BUFFER))
+        goto finish;
+
+    /* Check that queue has the required properties. */
+    required = ccl_device_get_info_scalar(dev,
+        CL_DEVICE_COMMAND_BUFFER_REQUIRED_QUEUE_PROPERTIES_KHR,
+        cl_command_queue_properties, &err_internal);
+    if (err_internal != NULL) goto finish;
+    caps = ccl_device_get_info_scalar(dev,
+        CL_DEVICE_COMMAND_BUFFER_CAPABILITIES_KHR,
+        cl_device_command_buffer_capabilities_khr, &err_internal);
+    if (err_internal != NULL) goto finish;
+    if ((props & required) != required) goto finish;
+    if (!seq->in_order
+            && !(caps & CL_COMMAND_BUFFER_CAPABILITY_OUT_OF_ORDER_KHR))
+        goto finish;
+    seq->khr_simultaneous =
+        (caps & CL_COMMAND_BUFFER_CAPABILITY_SIMULTANEOUS_USE_KHR)
+        ? CL_TRUE : CL_FALSE;
+
+    /* Get extension functions. */
+    platf = ccl_device_get_info_scalar(dev, CL_DEVICE_PLATFORM,
+        cl_platform_id, &err_internal);
+    if (err_internal != NULL) goto finish;
+    seq->create_fn = (clCreateCommandBufferKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clCreateCommandBufferKHR");
+    seq->finalize_fn = (clFinalizeCommandBufferKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clFinalizeCommandBufferKHR");
+    seq->release_fn = (clReleaseCommandBufferKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clReleaseCommandBufferKHR");
+    seq->enqueue_fn = (clEnqueueCommandBufferKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clEnqueueCommandBufferKHR");
+    seq->ndrange_fn = (clCommandNDRangeKernelKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clCommandNDRangeKernelKHR");
+    seq->copy_fn = (clCommandCopyBufferKHR_fn)
+        clGetExtensionFunctionAddressForPlatform(platf,
+            "clCommandCopyBufferKHR");
+
+    seq->khr = (seq->create_fn != NULL) && (seq->finalize_fn != NULL)
+        && (seq->release_fn != NULL) && (seq->enqueue_fn != NULL)
+        && (seq->ndrange_fn != NULL) && (seq->copy_fn != NULL);
+
+finish:
+
+    /* Errors only mean that the extension is not used. */
+    if (err_internal != NULL) g_error_free(err_internal);
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the recorded command buffer of a command sequence, if
+ * any, so that it's re-recorded on the next replay.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * */
+static void ccl_cmdseq_khr_invalidate(CCLCmdSeq * seq) {
+
+    if (seq->last_event != NULL) {
+        clWaitForEvents(1, &seq->last_event);
+        clReleaseEvent(seq->last_event);
+        seq->last_event = NULL;
+    }
+    if (seq->cmdbuf != NULL) {
+        seq->release_fn(seq->cmdbuf);
+        seq->cmdbuf = NULL;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Record the commands of a command sequence in a command buffer.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if command buffer was recorded, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_cmdseq_khr_record(CCLCmdSeq * seq, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    cl_command_queue queue = ccl_queue_unwrap(seq->cq);
+    cl_command_buffer_properties_khr props[] =
+        { CL_COMMAND_BUFFER_FLAGS_KHR, CL_COMMAND_BUFFER_SIMULTANEOUS_USE_KHR,
+          0 };
+    cl_sync_point_khr sync_point = 0;
+    cl_int ocl_status;
+    cl_bool ret_status;
+
+    /* Create command buffer. */
+    seq->cmdbuf = seq->create_fn(1, &queue,
+        seq->khr_simultaneous ? props : NULL, &ocl_status);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to create command buffer (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Record commands, each depending on the previous one. */
+    for (guint i = 0; i < seq->cmds->len; ++i) {
+
+        struct ccl_cmdseq_cmd * cmd =
+            &g_array_index(seq->cmds, struct ccl_cmdseq_cmd, i);
+
+        if (cmd->type == CCL_CMDSEQ_NDRANGE) {
+            cmd->args_version = ccl_kernel_get_args_version(cmd->krnl);
+            ocl_status = seq->ndrange_fn(seq->cmdbuf, NULL, NULL,
+                ccl_kernel_unwrap(cmd->krnl), cmd->work_dim,
+                cmd->has_offset ? cmd->sizes : NULL,
+                cmd->sizes + CCL_CMDSEQ_MAX_DIMS,
+                cmd->has_lws ? cmd->sizes + 2 * CCL_CMDSEQ_MAX_DIMS : NULL,
+                i > 0 ? 1 : 0, i > 0 ? &sync_point : NULL,
+                &sync_point, NULL);
+        } else {
+            ocl_status = seq->copy_fn(seq->cmdbuf, NULL,
+                ccl_buffer_unwrap(cmd->buf), ccl_buffer_unwrap(cmd->dst_buf),
+                cmd->offset, cmd->dst_offset, cmd->size,
+                i > 0 ? 1 : 0, i > 0 ? &sync_point : NULL,
+                &sync_point, NULL);
+        }
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to record command %u (OpenCL error %d: %s).",
+            CCL_STRD, i, ocl_status, ccl_err(ocl_status));
+    }
+
+    /* Finalize command buffer. */
+    ocl_status = seq->finalize_fn(seq->cmdbuf);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to finalize command buffer (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ccl_cmdseq_khr_invalidate(seq);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Replay a command sequence using its command buffer, recording
+ * it first if necessary.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] evt_wait_lst Event wait list. Not cleared by this function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The OpenCL event of the replay, or `NULL` if an error occurs.
+ * */
+static cl_event ccl_cmdseq_khr_replay(CCLCmdSeq * seq,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    cl_command_queue queue = ccl_queue_unwrap(seq->cq);
+    cl_event event = NULL;
+    cl_int ocl_status;
+
+    /* Send pending kernel arguments to the driver. If any value changed
+     * since the command buffer was recorded, record it again. */
+    for (guint i = 0; i < seq->cmds->len; ++i) {
+
+        struct ccl_cmdseq_cmd * cmd =
+            &g_array_index(seq->cmds, struct ccl_cmdseq_cmd, i);
+
+        if (cmd->type != CCL_CMDSEQ_NDRANGE) continue;
+
+        ccl_kernel_flush_args(cmd->krnl, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if ((seq->cmdbuf != NULL) && (cmd->args_version
+                != ccl_kernel_get_args_version(cmd->krnl)))
+            ccl_cmdseq_khr_invalidate(seq);
+    }
+    if (seq->cmdbuf == NULL) {
+        ccl_cmdseq_khr_record(seq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Without simultaneous use, the previous replay must complete before
+     * the command buffer can be enqueued again. */
+    if (seq->last_event != NULL) {
+        clWaitForEvents(1, &seq->last_event);
+        clReleaseEvent(seq->last_event);
+        seq->last_event = NULL;
+    }
+
+    /* Enqueue command buffer. */
+    ocl_status = seq->enqueue_fn(1, &queue, seq->cmdbuf,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue command buffer (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Keep event of this replay if required. */
+    if (!seq->khr_simultaneous) {
+        clRetainEvent(event);
+        seq->last_event = event;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    event = NULL;
+
+finish:
+
+    /* Return event. */
+    return event;
+}
+
+#endif /* CCL_CMDSEQ_KHR */
+
+/**
+ * @internal
+ *
+ * @brief Replay a command sequence by enqueuing its commands directly.
+ * On in-order queues only the last command produces an event; on
+ * out-of-order queues each command waits on the previous one.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] evt_wait_lst Event wait list for the first command. Not
+ * cleared by this function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The OpenCL event of the last command, or `NULL` if an error
+ * occurs.
+ * */
+static cl_event ccl_cmdseq_loop_replay(CCLCmdSeq * seq,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    cl_command_queue queue = ccl_queue_unwrap(seq->cq);
+    cl_event prev_event = NULL;
+    cl_event event = NULL;
+    cl_uint num_waits;
+    const cl_event * waits;
+    cl_int ocl_status = CL_SUCCESS;
+    guint last = seq->cmds->len - 1;
+
+    for (guint i = 0; i <= last; ++i) {
+
+        struct ccl_cmdseq_cmd * cmd =
+            &g_array_index(seq->cmds, struct ccl_cmdseq_cmd, i);
+        cl_event * event_ptr = ((i == last) || !seq->in_order)
+            ? &event : NULL;
+
+        /* Determine what the command waits on. */
+        if (i == 0) {
+            num_waits = ccl_event_wait_list_get_num_events(evt_wait_lst);
+            waits = ccl_event_wait_list_get_clevents(evt_wait_lst);
+        } else if (!seq->in_order) {
+            num_waits = 1;
+            waits = &prev_event;
+        } else {
+            num_waits = 0;
+            waits = NULL;
+        }
+
+        /* Enqueue command. */
+        switch (cmd->type) {
+            case CCL_CMDSEQ_NDRANGE:
+                ccl_kernel_flush_args(cmd->krnl, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                ocl_status = ccl_icd_clEnqueueNDRangeKernel(queue,
+                    ccl_kernel_unwrap(cmd->krnl), cmd->work_dim,
+                    cmd->has_offset ? cmd->sizes : NULL,
+                    cmd->sizes + CCL_CMDSEQ_MAX_DIMS,
+                    cmd->has_lws ? cmd->sizes + 2 * CCL_CMDSEQ_MAX_DIMS
+                        : NULL,
+                    num_waits, waits, event_ptr);
+                break;
+            case CCL_CMDSEQ_WRITE:
+                ocl_status = clEnqueueWriteBuffer(queue,
+                    ccl_buffer_unwrap(cmd->buf), CL_FALSE, cmd->offset,
+                    cmd->size, cmd->ptr, num_waits, waits, event_ptr);
+                break;
+            case CCL_CMDSEQ_READ:
+                ocl_status = clEnqueueReadBuffer(queue,
+                    ccl_buffer_unwrap(cmd->buf), CL_FALSE, cmd->offset,
+                    cmd->size, cmd->ptr, num_waits, waits, event_ptr);
+                break;
+            case CCL_CMDSEQ_COPY:
+                ocl_status = clEnqueueCopyBuffer(queue,
+                    ccl_buffer_unwrap(cmd->buf),
+                    ccl_buffer_unwrap(cmd->dst_buf), cmd->offset,
+                    cmd->dst_offset, cmd->size, num_waits, waits, event_ptr);
+                break;
+        }
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to replay command %u (OpenCL error %d: %s).",
+            CCL_STRD, i, ocl_status, ccl_err(ocl_status));
+
+        /* Release event of previous command, which is no longer
+         * required. */
+        if (prev_event != NULL) clReleaseEvent(prev_event);
+        prev_event = (i < last) ? event : NULL;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    if (prev_event != NULL) clReleaseEvent(prev_event);
+    event = NULL;
+
+finish:
+
+    /* Return event of last command. */
+    return event;
+}
+
+/**
+ * @internal
+ *
+ * @brief Append a command to a command sequence.
+ *
+ * @private @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] cmd Command to append.
+ * */
+static void ccl_cmdseq_append(
+    CCLCmdSeq * seq, struct ccl_cmdseq_cmd * cmd) {
+
+    g_array_append_vals(seq->cmds, cmd, 1);
+
+#ifdef CCL_CMDSEQ_KHR
+    /* Recorded command buffer no longer matches sequence. */
+    if (seq->khr) ccl_cmdseq_khr_invalidate(seq);
+#endif
+}
+
+/**
+ * @addtogroup CCL_CMDSEQ
+ * @{
+ */
+
+/**
+ * Create a new, empty, command sequence for the given command queue.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] cq Command queue wrapper object where commands are
+ * replayed.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new command sequence, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLCmdSeq * ccl_cmdseq_new(CCLQueue * cq, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLCmdSeq * seq = NULL;
+    cl_command_queue_properties props;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, cq == NULL, CCL_ERROR_ARGS,
+        error_handler, "%s: command queue must not be NULL.", CCL_STRD);
+
+    /* Get queue properties. */
+    props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create command sequence. */
+    seq = g_slice_new0(CCLCmdSeq);
+    seq->cq = cq;
+    ccl_queue_ref(cq);
+    seq->cmds = g_array_new(FALSE, FALSE, sizeof(struct ccl_cmdseq_cmd));
+    seq->in_order = (props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE)
+        ? CL_FALSE : CL_TRUE;
+
+#ifdef CCL_CMDSEQ_KHR
+    ccl_cmdseq_khr_init(seq, props);
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return command sequence. */
+    return seq;
+}
+
+/**
+ * Destroy a command sequence, releasing its references to the command
+ * queue, kernels and buffers.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq The command sequence to destroy.
+ * */
+CCL_EXPORT
+void ccl_cmdseq_destroy(CCLCmdSeq * seq) {
+
+    /* Make sure seq is not NULL. */
+    g_return_if_fail(seq != NULL);
+
+#ifdef CCL_CMDSEQ_KHR
+    if (seq->khr) ccl_cmdseq_khr_invalidate(seq);
+#endif
+
+    /* Release references held by commands. */
+    for (guint i = 0; i < seq->cmds->len; ++i) {
+        struct ccl_cmdseq_cmd * cmd =
+            &g_array_index(seq->cmds, struct ccl_cmdseq_cmd, i);
+        if (cmd->krnl != NULL) ccl_kernel_unref(cmd->krnl);
+        if (cmd->buf != NULL) ccl_buffer_unref(cmd->buf);
+        if (cmd->dst_buf != NULL) ccl_buffer_unref(cmd->dst_buf);
+    }
+
+    g_array_free(seq->cmds, TRUE);
+    ccl_queue_unref(seq->cq);
+    g_slice_free(CCLCmdSeq, seq);
+}
+
+/**
+ * Record a kernel launch in a command sequence. The kernel is launched
+ * with the arguments it has when the sequence is replayed.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] work_dim The number of dimensions used to specify the
+ * global work-items and work-items in the work-group, at most
+ * ::CCL_CMDSEQ_MAX_DIMS.
+ * @param[in] global_work_offset Can be used to specify an array of
+ * `work_dim` unsigned values that describe the offset used to calculate
+ * the global ID of a work-item.
+ * @param[in] global_work_size An array of `work_dim` unsigned values
+ * that describe the number of global work-items in `work_dim`
+ * dimensions that will execute the kernel function.
+ * @param[in] local_work_size An array of `work_dim` unsigned values
+ * that describe the number of work-items that make up a work-group that
+ * will execute the specified kernel.
+ * */
+CCL_EXPORT
+void ccl_cmdseq_add_ndrange(CCLCmdSeq * seq, CCLKernel * krnl,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size) {
+
+    /* Make sure seq and krnl are not NULL. */
+    g_return_if_fail(seq != NULL);
+    g_return_if_fail(krnl != NULL);
+    /* Make sure work dimensions are valid. */
+    g_return_if_fail((work_dim > 0) && (work_dim <= CCL_CMDSEQ_MAX_DIMS));
+    g_return_if_fail(global_work_size != NULL);
+
+    struct ccl_cmdseq_cmd cmd = { .type = CCL_CMDSEQ_NDRANGE };
+
+    cmd.krnl = krnl;
+    ccl_kernel_ref(krnl);
+    cmd.work_dim = work_dim;
+    if (global_work_offset != NULL) {
+        cmd.has_offset = CL_TRUE;
+        memcpy(cmd.sizes, global_work_offset, work_dim * sizeof(size_t));
+    }
+    memcpy(cmd.sizes + CCL_CMDSEQ_MAX_DIMS, global_work_size,
+        work_dim * sizeof(size_t));
+    if (local_work_size != NULL) {
+        cmd.has_lws = CL_TRUE;
+        memcpy(cmd.sizes + 2 * CCL_CMDSEQ_MAX_DIMS, local_work_size,
+            work_dim * sizeof(size_t));
+    }
+
+    ccl_cmdseq_append(seq, &cmd);
+}
+
+/**
+ * Record a write from host memory to a buffer in a command sequence. The
+ * host memory is read when the sequence is replayed, and must not be
+ * modified until the replay completes.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] buf Buffer wrapper object to write to.
+ * @param[in] offset The offset in bytes in the buffer object to write to.
+ * @param[in] size The size in bytes of data being written.
+ * @param[in] ptr The pointer to buffer in host memory where data is to
+ * be written from.
+ * */
+CCL_EXPORT
+void ccl_cmdseq_add_write(CCLCmdSeq * seq, CCLBuffer * buf,
+    size_t offset, size_t size, const void * ptr) {
+
+    /* Make sure seq and buf are not NULL. */
+    g_return_if_fail(seq != NULL);
+    g_return_if_fail(buf != NULL);
+
+    struct ccl_cmdseq_cmd cmd = { .type = CCL_CMDSEQ_WRITE };
+
+    cmd.buf = buf;
+    ccl_buffer_ref(buf);
+    cmd.offset = offset;
+    cmd.size = size;
+    cmd.ptr = (void *) ptr;
+    seq->has_host_cmds = CL_TRUE;
+
+    ccl_cmdseq_append(seq, &cmd);
+}
+
+/**
+ * Record a read from a buffer to host memory in a command sequence. The
+ * host memory is written when the sequence is replayed, and only holds
+ * the result after the replay completes.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] buf Buffer wrapper object to read from.
+ * @param[in] offset The offset in bytes in the buffer object to read
+ * from.
+ * @param[in] size The size in bytes of data being read.
+ * @param[out] ptr The pointer to buffer in host memory where data is to
+ * be read into.
+ * */
+CCL_EXPORT
+void ccl_cmdseq_add_read(CCLCmdSeq * seq, CCLBuffer * buf,
+    size_t offset, size_t size, void * ptr) {
+
+    /* Make sure seq and buf are not NULL. */
+    g_return_if_fail(seq != NULL);
+    g_return_if_fail(buf != NULL);
+
+    struct ccl_cmdseq_cmd cmd = { .type = CCL_CMDSEQ_READ };
+
+    cmd.buf = buf;
+    ccl_buffer_ref(buf);
+    cmd.offset = offset;
+    cmd.size = size;
+    cmd.ptr = ptr;
+    seq->has_host_cmds = CL_TRUE;
+
+    ccl_cmdseq_append(seq, &cmd);
+}
+
+/**
+ * Record a copy between buffers in a command sequence.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in] src_buf Source buffer wrapper object.
+ * @param[in] dst_buf Destination buffer wrapper object.
+ * @param[in] src_offset The offset where to begin copying data from
+ * `src_buf`.
+ * @param[in] dst_offset The offset where to begin copying data into
+ * `dst_buf`.
+ * @param[in] size Size in bytes to copy.
+ * */
+CCL_EXPORT
+void ccl_cmdseq_add_copy(CCLCmdSeq * seq, CCLBuffer * src_buf,
+    CCLBuffer * dst_buf, size_t src_offset, size_t dst_offset,
+    size_t size) {
+
+    /* Make sure seq and buffers are not NULL. */
+    g_return_if_fail(seq != NULL);
+    g_return_if_fail(src_buf != NULL);
+    g_return_if_fail(dst_buf != NULL);
+
+    struct ccl_cmdseq_cmd cmd = { .type = CCL_CMDSEQ_COPY };
+
+    cmd.buf = src_buf;
+    ccl_buffer_ref(src_buf);
+    cmd.dst_buf = dst_buf;
+    ccl_buffer_ref(dst_buf);
+    cmd.offset = src_offset;
+    cmd.dst_offset = dst_offset;
+    cmd.size = size;
+
+    ccl_cmdseq_append(seq, &cmd);
+}
+
+/**
+ * Is the command sequence replayed using the `cl_khr_command_buffer`
+ * extension? This is the case if the extension is supported by the
+ * command queue device (and by the OpenCL headers _cf4ocl_ was built
+ * with), and the sequence contains no host transfer commands.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @return `CL_TRUE` if the sequence is replayed using a command buffer,
+ * `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_cmdseq_is_native(CCLCmdSeq * seq) {
+
+    /* Make sure seq is not NULL. */
+    g_return_val_if_fail(seq != NULL, CL_FALSE);
+
+#ifdef CCL_CMDSEQ_KHR
+    return seq->khr && !seq->has_host_cmds;
+#else
+    return CL_FALSE;
+#endif
+}
+
+/**
+ * Replay the commands recorded in a command sequence.
+ *
+ * @public @memberof ccl_cmdseq
+ *
+ * @param[in] seq A command sequence.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the sequence can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies completion of the
+ * sequence.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_cmdseq_replay(
+    CCLCmdSeq * seq, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure seq is not NULL. */
+    g_return_val_if_fail(seq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    CCLErr * err_internal = NULL;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+
+    /* Check that there is something to replay. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, seq->cmds->len == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: command sequence is empty.", CCL_STRD);
+
+    /* Replay commands. */
+    if (ccl_cmdseq_is_native(seq)) {
+#ifdef CCL_CMDSEQ_KHR
+        event = ccl_cmdseq_khr_replay(seq, evt_wait_lst, &err_internal);
+#endif
+    } else {
+        event = ccl_cmdseq_loop_replay(seq, evt_wait_lst, &err_internal);
+    }
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Wrap event and associate it with the command queue. */
+    evt = ccl_queue_produce_event_deps(seq->cq, event, evt_wait_lst);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event wrapper. */
+    return evt;
+}
+
+/** @} */
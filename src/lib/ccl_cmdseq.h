@@ -0,0 +1,144 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of recorded command sequences and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_CMDSEQ_H_
+#define _CCL_CMDSEQ_H_
+
+#include "ccl_common.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+
+/**
+ * @defgroup CCL_CMDSEQ Command sequences
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides recorded command sequences, which capture a
+ * sequence of buffer transfers and kernel launches on a command queue
+ * once, and allow to replay it repeatedly with minimal host overhead.
+ *
+ * Commands are added to a sequence with the `ccl_cmdseq_add_*()`
+ * functions, which mirror the respective `ccl_*_enqueue_*()` functions.
+ * Kernel arguments are not recorded: on each replay, kernels use the
+ * arguments set with ::ccl_kernel_set_arg() and related functions (or
+ * via @ref CCL_KERNEL_LAUNCH "prepared launches"), and host transfer
+ * commands read from or write to the host memory given when recording,
+ * so new data and arguments can be provided between replays.
+ *
+ * If the queue device supports the `cl_khr_command_buffer` extension
+ * and the sequence only contains kernel launches and buffer copies, the
+ * sequence is replayed with a single clEnqueueCommandBufferKHR() call.
+ * The command buffer is only re-recorded when kernel arguments actually
+ * change. Otherwise, replays use a tight loop over the pre-resolved
+ * OpenCL objects, in which only the last command produces an event on
+ * in-order queues.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLCmdSeq * seq;
+ * CCLQueue * cq;
+ * CCLKernel * krnl;
+ * CCLBuffer * buf;
+ * CCLEvent * evt;
+ * cl_float host[N];
+ * size_t gws = N;
+ * @endcode
+ * @code{.c}
+ * seq = ccl_cmdseq_new(cq, NULL);
+ * ccl_cmdseq_add_write(seq, buf, 0, sizeof(host), host);
+ * ccl_cmdseq_add_ndrange(seq, krnl, 1, NULL, &gws, NULL);
+ * ccl_cmdseq_add_read(seq, buf, 0, sizeof(host), host);
+ * @endcode
+ * @code{.c}
+ * for (frame = 0; frame < num_frames; ++frame) {
+ *     update_host_data(host);
+ *     evt = ccl_cmdseq_replay(seq, NULL, NULL);
+ *     ccl_event_wait(ccl_ewl(&ewl, evt, NULL), NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_cmdseq_destroy(seq);
+ * @endcode
+ *
+ * @attention Command sequences are not thread-safe. A kernel recorded
+ * more than once in the same sequence uses the same arguments in all
+ * its launches.
+ *
+ * @{
+ */
+
+/**
+ * Recorded command sequence class.
+ * */
+typedef struct ccl_cmdseq CCLCmdSeq;
+
+/** Maximum number of work dimensions of recorded kernel launches. */
+#define CCL_CMDSEQ_MAX_DIMS 3
+
+/* Create a new, empty, command sequence for the given command queue. */
+CCL_EXPORT
+CCLCmdSeq * ccl_cmdseq_new(CCLQueue * cq, CCLErr ** err);
+
+/* Destroy a command sequence. */
+CCL_EXPORT
+void ccl_cmdseq_destroy(CCLCmdSeq * seq);
+
+/* Record a kernel launch in a command sequence. */
+CCL_EXPORT
+void ccl_cmdseq_add_ndrange(CCLCmdSeq * seq, CCLKernel * krnl,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size);
+
+/* Record a write from host memory to a buffer in a command sequence. */
+CCL_EXPORT
+void ccl_cmdseq_add_write(CCLCmdSeq * seq, CCLBuffer * buf,
+    size_t offset, size_t size, const void * ptr);
+
+/* Record a read from a buffer to host memory in a command sequence. */
+CCL_EXPORT
+void ccl_cmdseq_add_read(CCLCmdSeq * seq, CCLBuffer * buf,
+    size_t offset, size_t size, void * ptr);
+
+/* Record a copy between buffers in a command sequence. */
+CCL_EXPORT
+void ccl_cmdseq_add_copy(CCLCmdSeq * seq, CCLBuffer * src_buf,
+    CCLBuffer * dst_buf, size_t src_offset, size_t dst_offset,
+    size_t size);
+
+/* Is the command sequence replayed using the cl_khr_command_buffer
+ * extension? */
+CCL_EXPORT
+cl_bool ccl_cmdseq_is_native(CCLCmdSeq * seq);
+
+/* Replay the commands recorded in a command sequence. */
+CCL_EXPORT
+CCLEvent * ccl_cmdseq_replay(
+    CCLCmdSeq * seq, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/** @} */
+
+#endif
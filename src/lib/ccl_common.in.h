@@ -116,8 +116,10 @@ typedef enum ccl_class {
     CCL_SAMPLER   = 8,
     /** Queue object. */
     CCL_QUEUE     = 9,
+    /** Pipe object. */
+    CCL_PIPE      = 10,
     /** No object, enumeration termination marker. */
-    CCL_NONE      = 10
+    CCL_NONE      = 11
 
 } CCLClass;
 
@@ -181,8 +183,8 @@ typedef struct ccl_wrapper CCLWrapper;
 typedef struct ccl_dev_container CCLDevContainer;
 
 /**
- * Base class for memory object wrappers, i.e., ::CCLBuffer and
- * ::CCLImage.
+ * Base class for memory object wrappers, i.e., ::CCLBuffer, ::CCLImage
+ * and ::CCLPipe.
  *
  * @ingroup CCL_MEMOBJ_WRAPPER
  * @extends ccl_wrapper
@@ -237,6 +239,14 @@ typedef struct ccl_image CCLImage;
  */
 typedef struct ccl_kernel CCLKernel;
 
+/**
+ * Pipe wrapper class
+ *
+ * @ingroup CCL_PIPE_WRAPPER
+ * @extends ccl_memobj
+ * */
+typedef struct ccl_pipe CCLPipe;
+
 /**
  * Platform wrapper class.
  *
@@ -317,6 +327,12 @@ typedef enum ccl_error_code {
     CCL_ERROR_UNSUPPORTED_OCL      = 6,
     /** Object information is unavailable. */
     CCL_ERROR_INFO_UNAVAILABLE_OCL = 7,
+    /** The operation did not complete within the given time. */
+    CCL_ERROR_TIMEOUT              = 8,
+    /** Allocation would exceed the memory budget of the context. */
+    CCL_ERROR_MEM_BUDGET           = 9,
+    /** The OpenCL library could not be loaded. */
+    CCL_ERROR_OPENCL_UNAVAILABLE   = 10,
     /** Any other errors. */
     CCL_ERROR_OTHER                = 15
 } CCLErrorCode;
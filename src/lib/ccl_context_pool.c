@@ -0,0 +1,642 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of a pool of warm contexts with attached command queues
+ * and programs.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+
+#include "ccl_context_pool.h"
+#include "ccl_device_wrapper.h"
+#include "_ccl_defs.h"
+#include <string.h>
+
+/**
+ * A context checked out from a pool, with one command queue per device
+ * and a cache of built programs.
+ * */
+struct ccl_context_lease {
+
+    /**
+     * Context wrapper.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Command queue wrappers, one per device of the pool.
+     * @private
+     * */
+    CCLQueue ** queues;
+
+    /**
+     * Number of command queues.
+     * @private
+     * */
+    cl_uint num_queues;
+
+    /**
+     * Cache of built programs (keys: SHA-256 of sources and options;
+     * values: program wrappers).
+     * @private
+     * */
+    GHashTable * prgs;
+
+};
+
+/**
+ * Pool of warm contexts.
+ * */
+struct ccl_context_pool {
+
+    /**
+     * Devices of the contexts in the pool.
+     * @private
+     * */
+    CCLDevice ** devices;
+
+    /**
+     * Number of devices.
+     * @private
+     * */
+    cl_uint num_devices;
+
+    /**
+     * Properties of the command queues of leases.
+     * @private
+     * */
+    cl_command_queue_properties queue_props;
+
+    /**
+     * Idle leases, most recently returned last.
+     * @private
+     * */
+    GPtrArray * idle;
+
+    /**
+     * Number of leases checked out.
+     * @private
+     * */
+    cl_uint num_leased;
+
+    /**
+     * Lock protecting idle leases and the number of leases checked out.
+     * @private
+     * */
+    GMutex lock;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Destroy a lease, releasing its programs, queues and context.
+ *
+ * @private @memberof ccl_context_lease
+ *
+ * @param[in] lease Lease to destroy.
+ * */
+static void ccl_context_lease_destroy(CCLContextLease * lease) {
+
+    if (lease->prgs != NULL)
+        g_hash_table_destroy(lease->prgs);
+    for (cl_uint i = 0; i < lease->num_queues; ++i)
+        if (lease->queues[i] != NULL)
+            ccl_queue_destroy(lease->queues[i]);
+    g_free(lease->queues);
+    if (lease->ctx != NULL)
+        ccl_context_destroy(lease->ctx);
+    g_slice_free(CCLContextLease, lease);
+}
+
+/**
+ * @internal
+ *
+ * @brief Create a lease with a new context and command queues for the
+ * devices of a pool.
+ *
+ * @private @memberof ccl_context_lease
+ *
+ * @param[in] pool Pool of warm contexts.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new lease, or `NULL` if an error occurs.
+ * */
+static CCLContextLease * ccl_context_lease_new(
+    CCLContextPool * pool, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContextLease * lease;
+
+    lease = g_slice_new0(CCLContextLease);
+    lease->queues = g_new0(CCLQueue *, pool->num_devices);
+    lease->num_queues = pool->num_devices;
+    lease->prgs = g_hash_table_new_full(g_str_hash, g_str_equal,
+        g_free, (GDestroyNotify) ccl_program_destroy);
+
+    /* Create context. */
+    lease->ctx = ccl_context_new_from_devices_full(NULL, pool->num_devices,
+        pool->devices, NULL, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create one command queue per device. */
+    for (cl_uint i = 0; i < pool->num_devices; ++i) {
+        lease->queues[i] = ccl_queue_new(lease->ctx, pool->devices[i],
+            pool->queue_props, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    ccl_context_lease_destroy(lease);
+    lease = NULL;
+
+finish:
+
+    /* Return lease. */
+    return lease;
+}
+
+/**
+ * @internal
+ *
+ * @brief Reset the state of a lease returned to a pool, waiting for its
+ * queues to finish and releasing their events.
+ *
+ * @private @memberof ccl_context_lease
+ *
+ * @param[in] lease Lease to reset.
+ * @return `CL_TRUE` if the lease can be reused, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_context_lease_reset(CCLContextLease * lease) {
+
+    CCLErr * err_internal = NULL;
+
+    for (cl_uint i = 0; i < lease->num_queues; ++i) {
+        ccl_queue_finish(lease->queues[i], &err_internal);
+        if (err_internal != NULL) {
+            g_debug("Context lease not reused: %s", err_internal->message);
+            g_error_free(err_internal);
+            return CL_FALSE;
+        }
+        ccl_queue_gc(lease->queues[i]);
+    }
+    ccl_context_reset_mem_peak(lease->ctx);
+
+    return CL_TRUE;
+}
+
+/**
+ * @addtogroup CCL_CONTEXT_POOL
+ * @{
+ */
+
+/**
+ * Create a pool of warm contexts for the devices selected by the given
+ * filters. Devices are only selected once, when the pool is created.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] filters Filters for selecting devices, which are freed by
+ * this function.
+ * @param[in] queue_props Properties of the command queues created for
+ * each device in each context.
+ * @param[in] num_warm Number of contexts to create up front.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new pool of warm contexts, which should be destroyed with
+ * ::ccl_context_pool_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContextPool * ccl_context_pool_new(CCLDevSelFilters * filters,
+    cl_command_queue_properties queue_props, cl_uint num_warm,
+    CCLErr ** err) {
+
+    /* Make sure filters is not NULL. */
+    g_return_val_if_fail(filters != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLDevSelDevices devices = NULL;
+    CCLContextPool * pool = NULL;
+
+    /* Select devices. */
+    devices = ccl_devsel_select(filters, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, devices->len == 0,
+        CCL_ERROR_DEVICE_NOT_FOUND, error_handler,
+        "%s: no device found for selected filters.", CCL_STRD);
+
+    /* Create pool. */
+    pool = ccl_context_pool_new_from_devices(devices->len,
+        (CCLDevice * const *) devices->pdata, queue_props, num_warm,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Free array of selected devices; the pool keeps its own references. */
+    if (devices != NULL) ccl_devsel_devices_destroy(devices);
+
+    /* Return pool. */
+    return pool;
+}
+
+/**
+ * Create a pool of warm contexts for the given devices.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] num_devices Number of devices.
+ * @param[in] devices Device wrappers, which are kept alive by the pool.
+ * @param[in] queue_props Properties of the command queues created for
+ * each device in each context.
+ * @param[in] num_warm Number of contexts to create up front.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new pool of warm contexts, which should be destroyed with
+ * ::ccl_context_pool_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContextPool * ccl_context_pool_new_from_devices(cl_uint num_devices,
+    CCLDevice * const * devices, cl_command_queue_properties queue_props,
+    cl_uint num_warm, CCLErr ** err) {
+
+    /* Make sure there are devices. */
+    g_return_val_if_fail(num_devices > 0, NULL);
+    /* Make sure devices is not NULL. */
+    g_return_val_if_fail(devices != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLContextPool * pool;
+    CCLContextLease * lease;
+
+    /* Create pool, keeping references to devices. */
+    pool = g_slice_new0(CCLContextPool);
+    pool->devices = g_new(CCLDevice *, num_devices);
+    pool->num_devices = num_devices;
+    for (cl_uint i = 0; i < num_devices; ++i) {
+        ccl_device_ref(devices[i]);
+        pool->devices[i] = devices[i];
+    }
+    pool->queue_props = queue_props;
+    pool->idle = g_ptr_array_new();
+    g_mutex_init(&pool->lock);
+
+    /* Create warm contexts. */
+    for (cl_uint i = 0; i < num_warm; ++i) {
+        lease = ccl_context_lease_new(pool, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        g_ptr_array_add(pool->idle, lease);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    ccl_context_pool_destroy(pool);
+    pool = NULL;
+
+finish:
+
+    /* Return pool. */
+    return pool;
+}
+
+/**
+ * Destroy a pool of warm contexts, releasing its idle leases. All leases
+ * should have been returned to the pool.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] pool Pool of warm contexts to destroy.
+ * */
+CCL_EXPORT
+void ccl_context_pool_destroy(CCLContextPool * pool) {
+
+    /* Make sure pool is not NULL. */
+    g_return_if_fail(pool != NULL);
+
+    /* Leases checked out would be left dangling. */
+    g_warn_if_fail(pool->num_leased == 0);
+
+    /* Release idle leases and devices. */
+    for (guint i = 0; i < pool->idle->len; ++i)
+        ccl_context_lease_destroy(g_ptr_array_index(pool->idle, i));
+    g_ptr_array_free(pool->idle, TRUE);
+    for (cl_uint i = 0; i < pool->num_devices; ++i)
+        ccl_device_destroy(pool->devices[i]);
+    g_free(pool->devices);
+    g_mutex_clear(&pool->lock);
+    g_slice_free(CCLContextPool, pool);
+}
+
+/**
+ * Check out a lease from a pool of warm contexts. The most recently
+ * returned idle lease is reused, if any; otherwise a new lease, with a
+ * new context and command queues, is created. This function is
+ * thread-safe.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] pool Pool of warm contexts.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A lease, which should be returned with
+ * ::ccl_context_pool_release(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContextLease * ccl_context_pool_acquire(
+    CCLContextPool * pool, CCLErr ** err) {
+
+    /* Make sure pool is not NULL. */
+    g_return_val_if_fail(pool != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLContextLease * lease = NULL;
+
+    /* Take most recently returned idle lease, if any. */
+    g_mutex_lock(&pool->lock);
+    if (pool->idle->len > 0)
+        lease = g_ptr_array_remove_index(pool->idle, pool->idle->len - 1);
+    pool->num_leased++;
+    g_mutex_unlock(&pool->lock);
+
+    /* Otherwise create a new one, outside the lock, since this is slow. */
+    if (lease == NULL) {
+        lease = ccl_context_lease_new(pool, err);
+        if (lease == NULL) {
+            g_mutex_lock(&pool->lock);
+            pool->num_leased--;
+            g_mutex_unlock(&pool->lock);
+        }
+    }
+
+    /* Return lease. */
+    return lease;
+}
+
+/**
+ * Return a lease to a pool of warm contexts. The pool waits for the
+ * command queues of the lease to finish, releases their events and
+ * resets the memory high-water mark of the context, keeping the lease
+ * for reuse. If this fails, the lease is released instead. This function
+ * is thread-safe.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] pool Pool of warm contexts.
+ * @param[in] lease Lease checked out from the pool.
+ * */
+CCL_EXPORT
+void ccl_context_pool_release(
+    CCLContextPool * pool, CCLContextLease * lease) {
+
+    /* Make sure pool is not NULL. */
+    g_return_if_fail(pool != NULL);
+    /* Make sure lease is not NULL. */
+    g_return_if_fail(lease != NULL);
+
+    /* Reset lease outside the lock, since waiting for queues is slow. */
+    if (!ccl_context_lease_reset(lease)) {
+        ccl_context_lease_destroy(lease);
+        lease = NULL;
+    }
+
+    g_mutex_lock(&pool->lock);
+    if (lease != NULL)
+        g_ptr_array_add(pool->idle, lease);
+    pool->num_leased--;
+    g_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Release idle leases, least recently returned first, until the pool has
+ * at most the given number of idle leases.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] pool Pool of warm contexts.
+ * @param[in] max_idle Maximum number of idle leases to keep.
+ * @return Number of released leases.
+ * */
+CCL_EXPORT
+cl_uint ccl_context_pool_trim(CCLContextPool * pool, cl_uint max_idle) {
+
+    /* Make sure pool is not NULL. */
+    g_return_val_if_fail(pool != NULL, 0);
+
+    GPtrArray * trimmed = g_ptr_array_new();
+    cl_uint num_trimmed;
+
+    /* Take least recently returned idle leases. */
+    g_mutex_lock(&pool->lock);
+    while (pool->idle->len > max_idle)
+        g_ptr_array_add(trimmed, g_ptr_array_remove_index(pool->idle, 0));
+    g_mutex_unlock(&pool->lock);
+
+    /* Release them outside the lock. */
+    num_trimmed = trimmed->len;
+    for (guint i = 0; i < trimmed->len; ++i)
+        ccl_context_lease_destroy(g_ptr_array_index(trimmed, i));
+    g_ptr_array_free(trimmed, TRUE);
+
+    /* Return number of released leases. */
+    return num_trimmed;
+}
+
+/**
+ * Get the number of idle leases in a pool of warm contexts.
+ *
+ * @public @memberof ccl_context_pool
+ *
+ * @param[in] pool Pool of warm contexts.
+ * @return Number of idle leases.
+ * */
+CCL_EXPORT
+cl_uint ccl_context_pool_get_num_idle(CCLContextPool * pool) {
+
+    /* Make sure pool is not NULL. */
+    g_return_val_if_fail(pool != NULL, 0);
+
+    cl_uint num_idle;
+
+    g_mutex_lock(&pool->lock);
+    num_idle = pool->idle->len;
+    g_mutex_unlock(&pool->lock);
+
+    return num_idle;
+}
+
+/**
+ * Get the context of a lease.
+ *
+ * @public @memberof ccl_context_lease
+ *
+ * @param[in] lease Lease checked out from a pool.
+ * @return The context wrapper of the lease, which belongs to the lease
+ * and should not be destroyed.
+ * */
+CCL_EXPORT
+CCLContext * ccl_context_lease_get_context(CCLContextLease * lease) {
+
+    /* Make sure lease is not NULL. */
+    g_return_val_if_fail(lease != NULL, NULL);
+
+    return lease->ctx;
+}
+
+/**
+ * Get the command queue of a lease for the device with the given index.
+ *
+ * @public @memberof ccl_context_lease
+ *
+ * @param[in] lease Lease checked out from a pool.
+ * @param[in] index Index of device in the pool.
+ * @return The command queue wrapper for the device, which belongs to the
+ * lease and should not be destroyed.
+ * */
+CCL_EXPORT
+CCLQueue * ccl_context_lease_get_queue(
+    CCLContextLease * lease, cl_uint index) {
+
+    /* Make sure lease is not NULL. */
+    g_return_val_if_fail(lease != NULL, NULL);
+    /* Make sure index is within bounds. */
+    g_return_val_if_fail(index < lease->num_queues, NULL);
+
+    return lease->queues[index];
+}
+
+/**
+ * Get a program built from the given sources and options for all the
+ * devices of a lease, building it only if it is not cached in the lease.
+ * Since leases are reused, jobs which build the same programs only build
+ * them, and create their kernels, the first time.
+ *
+ * @public @memberof ccl_context_lease
+ *
+ * @param[in] lease Lease checked out from a pool.
+ * @param[in] count Number of source code strings.
+ * @param[in] strings Source code strings.
+ * @param[in] options Build options, may be `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A built program wrapper, which belongs to the lease and should
+ * not be destroyed, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProgram * ccl_context_lease_get_program(CCLContextLease * lease,
+    cl_uint count, const char ** strings, const char * options,
+    CCLErr ** err) {
+
+    /* Make sure lease is not NULL. */
+    g_return_val_if_fail(lease != NULL, NULL);
+    /* Make sure strings is not NULL. */
+    g_return_val_if_fail(strings != NULL, NULL);
+    /* Make sure count > 0. */
+    g_return_val_if_fail(count > 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLProgram * prg = NULL;
+    GChecksum * checksum;
+    gchar * key;
+
+    /* Determine key of program. Each field is hashed with its terminating
+     * null character, so that consecutive fields can't be confused. */
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    for (cl_uint i = 0; i < count; ++i)
+        g_checksum_update(checksum,
+            (const guchar *) strings[i], strlen(strings[i]) + 1);
+    g_checksum_update(checksum, (const guchar *) "", 1);
+    if (options != NULL)
+        g_checksum_update(
+            checksum, (const guchar *) options, strlen(options) + 1);
+    key = g_strdup(g_checksum_get_string(checksum));
+    g_checksum_free(checksum);
+
+    /* If program was already built in this lease, we're done. */
+    prg = g_hash_table_lookup(lease->prgs, key);
+    if (prg != NULL) goto finish;
+
+    /* Otherwise, build it. */
+    prg = ccl_program_new_from_sources(
+        lease->ctx, count, strings, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    ccl_program_build(prg, options, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Keep built program in lease cache, which takes ownership of key. */
+    g_hash_table_insert(lease->prgs, key, prg);
+    key = NULL;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release program, if created. */
+    if (prg != NULL) ccl_program_destroy(prg);
+    prg = NULL;
+
+finish:
+
+    /* Free key, if not kept in cache. */
+    g_free(key);
+
+    /* Return built program. */
+    return prg;
+}
+
+/** @} */
@@ -0,0 +1,161 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of a pool of warm contexts with attached command queues and
+ * programs.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_CONTEXT_POOL_H_
+#define _CCL_CONTEXT_POOL_H_
+
+#include "ccl_common.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_device_selector.h"
+#include "ccl_program_wrapper.h"
+#include "ccl_queue_wrapper.h"
+
+/**
+ * @defgroup CCL_CONTEXT_POOL Context pools
+ * @ingroup CCL_CONTEXT_WRAPPER
+ *
+ * This module provides a pool of warm contexts for programs which run
+ * many short-lived jobs, each of which would otherwise create a context
+ * and its command queues, build its programs and tear everything down
+ * again. Creating a context alone takes tens to hundreds of milliseconds
+ * with some OpenCL implementations.
+ *
+ * A pool is created for a set of devices with ::ccl_context_pool_new()
+ * or ::ccl_context_pool_new_from_devices(), optionally creating some
+ * contexts up front. Each job checks out a lease with
+ * ::ccl_context_pool_acquire(), which holds a context with one command
+ * queue per device (::ccl_context_lease_get_context() and
+ * ::ccl_context_lease_get_queue()) and a cache of built programs
+ * (::ccl_context_lease_get_program()), and returns it with
+ * ::ccl_context_pool_release(). Leases are reused by later jobs, so only
+ * the first jobs pay for creating contexts, queues and programs. Idle
+ * leases are released with ::ccl_context_pool_trim() and when the pool is
+ * destroyed.
+ *
+ * When a lease is returned, the pool waits for its queues to finish,
+ * releases their events and resets the memory high-water mark of the
+ * context. If this fails, the lease is released instead of being reused.
+ *
+ * Acquiring and releasing leases is thread-safe, but a lease should
+ * only be used by one job at a time.
+ *
+ * @attention Memory objects and other wrappers created by a job in the
+ * context of a lease should be released by the job, since they are not
+ * released when the lease is returned. Likewise, kernel arguments set in
+ * kernels of cached programs are kept, and should be set again by each
+ * job.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLContextPool * pool;
+ * CCLContextLease * lease;
+ * CCLProgram * prg;
+ * @endcode
+ * @code{.c}
+ * pool = ccl_context_pool_new(&filters, 0, 2, NULL);
+ * @endcode
+ * @code{.c}
+ * lease = ccl_context_pool_acquire(pool, NULL);
+ * prg = ccl_context_lease_get_program(lease, 1, &src, NULL, NULL);
+ * ccl_program_enqueue_kernel(prg, "job", ccl_context_lease_get_queue(lease, 0),
+ *     1, NULL, &gws, NULL, NULL, NULL, ccl_arg_priv(n, cl_uint), NULL);
+ * ccl_context_pool_release(pool, lease);
+ * @endcode
+ * @code{.c}
+ * ccl_context_pool_destroy(pool);
+ * @endcode
+ *
+ * @{
+ */
+
+/**
+ * Pool of warm contexts.
+ * */
+typedef struct ccl_context_pool CCLContextPool;
+
+/**
+ * A context checked out from a pool, with one command queue per device
+ * and a cache of built programs.
+ * */
+typedef struct ccl_context_lease CCLContextLease;
+
+/* Create a pool of warm contexts for the devices selected by the given
+ * filters. */
+CCL_EXPORT
+CCLContextPool * ccl_context_pool_new(CCLDevSelFilters * filters,
+    cl_command_queue_properties queue_props, cl_uint num_warm,
+    CCLErr ** err);
+
+/* Create a pool of warm contexts for the given devices. */
+CCL_EXPORT
+CCLContextPool * ccl_context_pool_new_from_devices(cl_uint num_devices,
+    CCLDevice * const * devices, cl_command_queue_properties queue_props,
+    cl_uint num_warm, CCLErr ** err);
+
+/* Destroy a pool of warm contexts. */
+CCL_EXPORT
+void ccl_context_pool_destroy(CCLContextPool * pool);
+
+/* Check out a lease from a pool of warm contexts. */
+CCL_EXPORT
+CCLContextLease * ccl_context_pool_acquire(
+    CCLContextPool * pool, CCLErr ** err);
+
+/* Return a lease to a pool of warm contexts. */
+CCL_EXPORT
+void ccl_context_pool_release(
+    CCLContextPool * pool, CCLContextLease * lease);
+
+/* Release idle leases until the pool has at most the given number. */
+CCL_EXPORT
+cl_uint ccl_context_pool_trim(CCLContextPool * pool, cl_uint max_idle);
+
+/* Get the number of idle leases in a pool of warm contexts. */
+CCL_EXPORT
+cl_uint ccl_context_pool_get_num_idle(CCLContextPool * pool);
+
+/* Get the context of a lease. */
+CCL_EXPORT
+CCLContext * ccl_context_lease_get_context(CCLContextLease * lease);
+
+/* Get the command queue of a lease for the device with the given index. */
+CCL_EXPORT
+CCLQueue * ccl_context_lease_get_queue(
+    CCLContextLease * lease, cl_uint index);
+
+/* Get a program built from the given sources and options, building it
+ * only if it is not cached in the lease. */
+CCL_EXPORT
+CCLProgram * ccl_context_lease_get_program(CCLContextLease * lease,
+    cl_uint count, const char ** strings, const char * options,
+    CCLErr ** err);
+
+/** @} */
+
+#endif
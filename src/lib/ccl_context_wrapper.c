@@ -26,6 +26,8 @@
  * */
 
 #include "ccl_context_wrapper.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_memobj_wrapper.h"
 #include "_ccl_abstract_dev_container_wrapper.h"
 #include "_ccl_defs.h"
 
@@ -48,8 +50,123 @@ struct ccl_context {
      * */
     CCLPlatform * platf;
 
+    /**
+     * Cache of compiled (not linked) programs, indexed by key (lazy
+     * initialized).
+     * @private
+     * */
+    GHashTable * compiled_prgs;
+
+    /**
+     * Pool of buffers, or `NULL` if not enabled.
+     * @private
+     * */
+    CCLBufferPool * buf_pool;
+
+    /**
+     * Pool of images, or `NULL` if not enabled.
+     * @private
+     * */
+    CCLImagePool * img_pool;
+
+    /**
+     * Memory objects accounted for in the context (lazy initialized).
+     * @private
+     * */
+    GHashTable * mem_objs;
+
+    /**
+     * Total size in bytes of memory objects accounted for.
+     * @private
+     * */
+    size_t mem_used;
+
+    /**
+     * Maximum total size in bytes of memory objects accounted for.
+     * @private
+     * */
+    size_t mem_peak;
+
+    /**
+     * Memory budget in bytes, or 0 if there is no budget.
+     * @private
+     * */
+    size_t mem_budget;
+
+    /**
+     * Cache of supported image formats (set of
+     * ::CCLContextImageFormats, lazy initialized).
+     * @private
+     * */
+    GHashTable * img_fmts;
+
+    /**
+     * Cache of samplers, indexed by canonical property list (lazy
+     * initialized).
+     * @private
+     * */
+    GHashTable * samplers;
+
 };
 
+/**
+ * @internal
+ *
+ * @brief Image formats supported by a context for given memory flags and
+ * image type.
+ * */
+typedef struct ccl_context_img_fmts {
+
+    /**
+     * Memory flags.
+     * @private
+     * */
+    cl_mem_flags flags;
+
+    /**
+     * Image type.
+     * @private
+     * */
+    cl_mem_object_type image_type;
+
+    /**
+     * Supported image formats.
+     * @private
+     * */
+    cl_image_format * formats;
+
+    /**
+     * Number of supported image formats.
+     * @private
+     * */
+    cl_uint num_formats;
+
+    /**
+     * Keys of supported image formats (see ccl_context_img_fmt_key()).
+     * @private
+     * */
+    gint64 * keys;
+
+    /**
+     * Set of keys of supported image formats.
+     * @private
+     * */
+    GHashTable * supported;
+
+} CCLContextImageFormats;
+
+/* Lock protecting the compiled program caches of all contexts. */
+static GMutex compiled_prgs_lock;
+
+/* Lock protecting the image format caches of all contexts. */
+static GMutex img_fmts_lock;
+
+/* Lock protecting the sampler caches of all contexts. */
+static GMutex samplers_lock;
+
+/* Lock protecting the memory accounting of all contexts. */
+static GMutex mem_lock;
+
 /**
  * @internal
  *
@@ -72,6 +189,39 @@ static void ccl_context_release_fields(CCLContext * ctx) {
     if (ctx->platf) {
         ccl_platform_unref(ctx->platf);
     }
+
+    /* Release cached compiled programs. */
+    if (ctx->compiled_prgs != NULL)
+        g_hash_table_destroy(ctx->compiled_prgs);
+
+    /* Release cached image formats. */
+    if (ctx->img_fmts != NULL)
+        g_hash_table_destroy(ctx->img_fmts);
+
+    /* Release cached samplers. */
+    if (ctx->samplers != NULL)
+        g_hash_table_destroy(ctx->samplers);
+
+    /* Release pooled buffers. */
+    if (ctx->buf_pool != NULL)
+        ccl_buffer_pool_destroy(ctx->buf_pool);
+
+    /* Release pooled images. */
+    if (ctx->img_pool != NULL)
+        ccl_image_pool_destroy(ctx->img_pool);
+
+    /* Memory objects which outlive the context are no longer accounted
+     * for. */
+    if (ctx->mem_objs != NULL) {
+        GHashTableIter iter;
+        gpointer mo;
+        g_mutex_lock(&mem_lock);
+        g_hash_table_iter_init(&iter, ctx->mem_objs);
+        while (g_hash_table_iter_next(&iter, &mo, NULL))
+            ((CCLMemObj *) mo)->mem_ctx = NULL;
+        g_mutex_unlock(&mem_lock);
+        g_hash_table_destroy(ctx->mem_objs);
+    }
 }
 
 /**
@@ -184,6 +334,291 @@ static CCLWrapperInfo * ccl_context_get_cldevices(
     return ccl_context_get_info(devcon, CL_CONTEXT_DEVICES, err);
 }
 
+/**
+ * @internal
+ *
+ * @brief Get the buffer pool of a context. Callers must hold the lock
+ * protecting buffer pools.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @return The buffer pool of the context, or `NULL` if not enabled.
+ * */
+CCLBufferPool * ccl_context_get_buffer_pool(CCLContext * ctx) {
+
+    return ctx->buf_pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Set the buffer pool of a context. Callers must hold the lock
+ * protecting buffer pools.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] pool The buffer pool, or `NULL` for no pool.
+ * */
+void ccl_context_set_buffer_pool(CCLContext * ctx, CCLBufferPool * pool) {
+
+    ctx->buf_pool = pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the image pool of a context. Callers must hold the lock
+ * protecting image pools.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @return The image pool of the context, or `NULL` if not enabled.
+ * */
+CCLImagePool * ccl_context_get_image_pool(CCLContext * ctx) {
+
+    return ctx->img_pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Set the image pool of a context. Callers must hold the lock
+ * protecting image pools.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] pool The image pool, or `NULL` for no pool.
+ * */
+void ccl_context_set_image_pool(CCLContext * ctx, CCLImagePool * pool) {
+
+    ctx->img_pool = pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Account for the memory of a new memory object in its context.
+ *
+ * If accounting for the memory object would exceed the context memory
+ * budget, pooled buffers of the context are released first. If the budget
+ * is still exceeded, the memory object is not accounted for and an error
+ * is reported, in which case the caller should destroy it.
+ *
+ * @param[in] ctx Context of the memory object.
+ * @param[in] mo The new memory object.
+ * @param[in] size Size in bytes of the memory object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the memory object was accounted for, `CL_FALSE`
+ * if the budget would be exceeded.
+ * */
+cl_bool ccl_context_mem_track(CCLContext * ctx, CCLMemObj * mo,
+    size_t size, CCLErr ** err) {
+
+    size_t excess = 0, pool_size;
+    cl_bool tracked = CL_FALSE;
+
+    /* Determine by how much the budget would be exceeded. */
+    g_mutex_lock(&mem_lock);
+    if ((ctx->mem_budget > 0) && (ctx->mem_used + size > ctx->mem_budget))
+        excess = ctx->mem_used + size - ctx->mem_budget;
+    g_mutex_unlock(&mem_lock);
+
+    /* Release pooled buffers to make room. Released buffers are no longer
+     * accounted for, so the lock must not be held. */
+    if (excess > 0) {
+        pool_size = ccl_buffer_pool_get_size(ctx);
+        ccl_buffer_pool_trim(ctx, pool_size > excess ? pool_size - excess : 0);
+    }
+
+    g_mutex_lock(&mem_lock);
+
+    /* Account for memory object if within budget. */
+    if ((ctx->mem_budget == 0) || (ctx->mem_used + size <= ctx->mem_budget)) {
+        if (ctx->mem_objs == NULL)
+            ctx->mem_objs = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_add(ctx->mem_objs, mo);
+        mo->mem_ctx = ctx;
+        mo->mem_size = size;
+        ctx->mem_used += size;
+        ctx->mem_peak = MAX(ctx->mem_peak, ctx->mem_used);
+        tracked = CL_TRUE;
+    }
+
+    g_mutex_unlock(&mem_lock);
+
+    ccl_if_err_create_goto(*err, CCL_ERROR, !tracked,
+        CCL_ERROR_MEM_BUDGET, error_handler,
+        "%s: allocating %lu bytes would exceed memory budget of context "
+        "(%lu bytes).", CCL_STRD, (unsigned long) size,
+        (unsigned long) ctx->mem_budget);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return whether memory object was accounted for. */
+    return tracked;
+}
+
+/**
+ * @internal
+ *
+ * @brief Stop accounting for the memory of a memory object. Used as the
+ * ccl_wrapper_release_fields() function of memory object wrappers.
+ *
+ * @param[in] mo Memory object being released.
+ * */
+void ccl_context_mem_untrack(CCLMemObj * mo) {
+
+    g_mutex_lock(&mem_lock);
+    if (mo->mem_ctx != NULL) {
+        mo->mem_ctx->mem_used -= mo->mem_size;
+        g_hash_table_remove(mo->mem_ctx->mem_objs, mo);
+        mo->mem_ctx = NULL;
+    }
+    g_mutex_unlock(&mem_lock);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get a compiled program from the context cache of compiled
+ * programs.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] key Key of compiled program.
+ * @return A new reference to the compiled program wrapper, which should be
+ * released with ccl_program_destroy(), or `NULL` if no compiled program with
+ * the given key is cached.
+ * */
+CCLProgram * ccl_context_get_compiled_program(
+    CCLContext * ctx, const char * key) {
+
+    CCLProgram * prg = NULL;
+
+    g_mutex_lock(&compiled_prgs_lock);
+    if (ctx->compiled_prgs != NULL)
+        prg = g_hash_table_lookup(ctx->compiled_prgs, key);
+    if (prg != NULL)
+        ccl_program_ref(prg);
+    g_mutex_unlock(&compiled_prgs_lock);
+
+    return prg;
+}
+
+/**
+ * @internal
+ *
+ * @brief Add a compiled program to the context cache of compiled programs.
+ * If a program with the same key was meanwhile added by another thread, the
+ * given program is not added, and the existing one is returned instead.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] key Key of compiled program.
+ * @param[in] prg Compiled program wrapper. The caller's reference to it is
+ * consumed.
+ * @return A new reference to the cached program wrapper, which is `prg`
+ * unless a program with the same key was already cached.
+ * */
+CCLProgram * ccl_context_add_compiled_program(
+    CCLContext * ctx, const char * key, CCLProgram * prg) {
+
+    CCLProgram * prg_cached;
+
+    g_mutex_lock(&compiled_prgs_lock);
+    if (ctx->compiled_prgs == NULL) {
+        ctx->compiled_prgs = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, (GDestroyNotify) ccl_program_destroy);
+    }
+    prg_cached = g_hash_table_lookup(ctx->compiled_prgs, key);
+    if (prg_cached == NULL) {
+        /* Cache keeps its own reference. */
+        ccl_program_ref(prg);
+        g_hash_table_insert(ctx->compiled_prgs, g_strdup(key), prg);
+        prg_cached = prg;
+    } else {
+        ccl_program_ref(prg_cached);
+    }
+    g_mutex_unlock(&compiled_prgs_lock);
+
+    /* Release given program if another one was cached. */
+    if (prg_cached != prg)
+        ccl_program_destroy(prg);
+
+    return prg_cached;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get a sampler from the context cache of samplers.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] key Canonical property list of sampler.
+ * @return A new reference to the sampler wrapper, which should be released
+ * with ccl_sampler_destroy(), or `NULL` if no sampler with the given key is
+ * cached.
+ * */
+CCLSampler * ccl_context_get_cached_sampler(
+    CCLContext * ctx, const char * key) {
+
+    CCLSampler * smplr = NULL;
+
+    g_mutex_lock(&samplers_lock);
+    if (ctx->samplers != NULL)
+        smplr = g_hash_table_lookup(ctx->samplers, key);
+    if (smplr != NULL)
+        ccl_sampler_ref(smplr);
+    g_mutex_unlock(&samplers_lock);
+
+    return smplr;
+}
+
+/**
+ * @internal
+ *
+ * @brief Add a sampler to the context cache of samplers. If a sampler with
+ * the same key was meanwhile added by another thread, the given sampler is
+ * not added, and the existing one is returned instead.
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] key Canonical property list of sampler.
+ * @param[in] smplr Sampler wrapper. The caller's reference to it is
+ * consumed.
+ * @return A new reference to the cached sampler wrapper, which is `smplr`
+ * unless a sampler with the same key was already cached.
+ * */
+CCLSampler * ccl_context_add_cached_sampler(
+    CCLContext * ctx, const char * key, CCLSampler * smplr) {
+
+    CCLSampler * smplr_cached;
+
+    g_mutex_lock(&samplers_lock);
+    if (ctx->samplers == NULL) {
+        ctx->samplers = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, (GDestroyNotify) ccl_sampler_destroy);
+    }
+    smplr_cached = g_hash_table_lookup(ctx->samplers, key);
+    if (smplr_cached == NULL) {
+        /* Cache keeps its own reference. */
+        ccl_sampler_ref(smplr);
+        g_hash_table_insert(ctx->samplers, g_strdup(key), smplr);
+        smplr_cached = smplr;
+    } else {
+        ccl_sampler_ref(smplr_cached);
+    }
+    g_mutex_unlock(&samplers_lock);
+
+    /* Release given sampler if another one was cached. */
+    if (smplr_cached != smplr)
+        ccl_sampler_destroy(smplr);
+
+    return smplr_cached;
+}
+
 /**
  * @addtogroup CCL_CONTEXT_WRAPPER
  * @{
@@ -576,10 +1011,174 @@ finish:
     return platf;
 }
 
+/**
+ * @internal
+ *
+ * @brief Key of an image format in the set of supported image formats.
+ *
+ * @param[in] fmt Image format.
+ * @return Key of image format.
+ * */
+static gint64 ccl_context_img_fmt_key(const cl_image_format * fmt) {
+
+    return ((gint64) fmt->image_channel_order << 32)
+        | (gint64) fmt->image_channel_data_type;
+}
+
+/**
+ * @internal
+ *
+ * @brief Hash function of cached image format lists, which combines
+ * memory flags and image type.
+ *
+ * @param[in] v Cached image format list.
+ * @return Hash value.
+ * */
+static guint ccl_context_img_fmts_hash(gconstpointer v) {
+
+    const CCLContextImageFormats * e = v;
+
+    return (guint) (e->flags ^ (e->flags >> 32)) * 31u
+        + (guint) e->image_type;
+}
+
+/**
+ * @internal
+ *
+ * @brief Equality function of cached image format lists.
+ *
+ * @param[in] a Cached image format list.
+ * @param[in] b Cached image format list.
+ * @return `TRUE` if lists refer to the same memory flags and image type,
+ * `FALSE` otherwise.
+ * */
+static gboolean ccl_context_img_fmts_equal(gconstpointer a, gconstpointer b) {
+
+    const CCLContextImageFormats * ea = a;
+    const CCLContextImageFormats * eb = b;
+
+    return (ea->flags == eb->flags) && (ea->image_type == eb->image_type);
+}
+
+/**
+ * @internal
+ *
+ * @brief Free a cached image format list.
+ *
+ * @param[in] v Cached image format list.
+ * */
+static void ccl_context_img_fmts_free(gpointer v) {
+
+    CCLContextImageFormats * e = v;
+
+    g_hash_table_destroy(e->supported);
+    g_free(e->keys);
+    g_free(e->formats);
+    g_slice_free(CCLContextImageFormats, e);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the image formats supported by a context for given memory
+ * flags and image type, querying them only the first time.
+ *
+ * @param[in] ctx A context wrapper object.
+ * @param[in] flags Memory flags.
+ * @param[in] image_type The image type.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Cached image format list, or `NULL` if an error occurs.
+ * */
+static CCLContextImageFormats * ccl_context_get_img_fmts(CCLContext * ctx,
+    cl_mem_flags flags, cl_mem_object_type image_type, CCLErr ** err) {
+
+    CCLContextImageFormats key = { flags, image_type, NULL, 0, NULL, NULL };
+    CCLContextImageFormats * e = NULL, * cached;
+    cl_int ocl_status;
+    cl_uint num_formats;
+    cl_image_format * formats = NULL;
+
+    /* Look for formats in cache. */
+    g_mutex_lock(&img_fmts_lock);
+    if (ctx->img_fmts != NULL)
+        e = g_hash_table_lookup(ctx->img_fmts, &key);
+    g_mutex_unlock(&img_fmts_lock);
+    if (e != NULL) goto finish;
+
+    /* Get number of image formats. */
+    ocl_status = clGetSupportedImageFormats(ccl_context_unwrap(ctx),
+        flags, image_type, 0, NULL, &num_formats);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: get number of supported image formats (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        num_formats == 0, CCL_ERROR_OTHER, error_handler,
+        "%s: number of returned supported image formats is 0.",
+        CCL_STRD);
+
+    /* Get image formats. */
+    formats = g_new(cl_image_format, num_formats);
+    ocl_status = clGetSupportedImageFormats(ccl_context_unwrap(ctx),
+        flags, image_type, num_formats, formats, NULL);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: get supported image formats (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Build set of supported formats. */
+    e = g_slice_new(CCLContextImageFormats);
+    e->flags = flags;
+    e->image_type = image_type;
+    e->formats = formats;
+    e->num_formats = num_formats;
+    e->keys = g_new(gint64, num_formats);
+    e->supported = g_hash_table_new(g_int64_hash, g_int64_equal);
+    for (cl_uint i = 0; i < num_formats; ++i) {
+        e->keys[i] = ccl_context_img_fmt_key(&formats[i]);
+        g_hash_table_add(e->supported, &e->keys[i]);
+    }
+    formats = NULL;
+
+    /* Keep formats in cache, unless another thread did it meanwhile. */
+    g_mutex_lock(&img_fmts_lock);
+    if (ctx->img_fmts == NULL) {
+        ctx->img_fmts = g_hash_table_new_full(ccl_context_img_fmts_hash,
+            ccl_context_img_fmts_equal, NULL, ccl_context_img_fmts_free);
+    }
+    cached = g_hash_table_lookup(ctx->img_fmts, e);
+    if (cached == NULL) {
+        g_hash_table_add(ctx->img_fmts, e);
+    } else {
+        ccl_context_img_fmts_free(e);
+        e = cached;
+    }
+    g_mutex_unlock(&img_fmts_lock);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    g_free(formats);
+
+finish:
+
+    /* Return cached formats. */
+    return e;
+}
+
 /**
  * Get the list of image formats supported by a given context. This
  * function wraps the clGetSupportedImageFormats() OpenCL function.
  *
+ * The list is queried only the first time it is requested for a given
+ * combination of memory flags and image type, and is kept in the context
+ * afterwards.
+ *
  * @public @memberof ccl_context
  *
  * @param[in] ctx A context wrapper object.
@@ -606,48 +1205,23 @@ const cl_image_format * ccl_context_get_supported_image_formats(
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-    /* Information object. We use it to keep image format information
-     * in the information table, so that it can be automatically
-     * destroyed when the context is destroyed. */
-    CCLWrapperInfo * info = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Cached image formats. */
+    CCLContextImageFormats * e;
 
     /* Variable to return. */
     const cl_image_format * image_formats = NULL;
 
-    /* Let's query OpenCL object.*/
-    cl_int ocl_status;
-
-    /* Get number of image formats. */
-    ocl_status = clGetSupportedImageFormats(ccl_context_unwrap(ctx),
-        flags, image_type, 0, NULL, num_image_formats);
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: get number of supported image formats (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
-    ccl_if_err_create_goto(*err, CCL_ERROR,
-        *num_image_formats == 0, CCL_ERROR_OTHER, error_handler,
-        "%s: number of returned supported image formats is 0.",
-        CCL_STRD);
-
-    /* Allocate memory for number of image formats. */
-    info = ccl_wrapper_info_new(
-        (*num_image_formats) * sizeof(cl_image_format));
-
-    /* Get image formats. */
-    ocl_status = clGetSupportedImageFormats(ccl_context_unwrap(ctx),
-        flags, image_type, *num_image_formats,
-        (cl_image_format *) info->value, NULL);
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: get supported image formats (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
-
-    /* Keep information in information table for latter disposal. */
-    ccl_wrapper_add_info((CCLWrapper *) ctx, CL_IMAGE_FORMAT, info);
+    /* Get image formats, querying them if not yet cached. */
+    e = ccl_context_get_img_fmts(ctx, flags, image_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
-    image_formats = (const cl_image_format *) info->value;
+    image_formats = e->formats;
+    *num_image_formats = e->num_formats;
     goto finish;
 
 error_handler:
@@ -661,6 +1235,61 @@ finish:
     return image_formats;
 }
 
+/**
+ * Check if an image format is supported by a given context. The list of
+ * supported image formats is queried only the first time it is required
+ * for a given combination of memory flags and image type, as in
+ * ::ccl_context_get_supported_image_formats(), after which the check is
+ * performed in constant time.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx A context wrapper object.
+ * @param[in] flags Allocation and usage information about the image
+ * memory object being queried.
+ * @param[in] image_type The image type. Acceptable values depend on the
+ * OpenCL version.
+ * @param[in] image_format The image format to check.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if image format is supported, `CL_FALSE` if it is not
+ * supported or if an error occurs.
+ * */
+CCL_EXPORT
+cl_bool ccl_context_is_image_format_supported(CCLContext * ctx,
+    cl_mem_flags flags, cl_mem_object_type image_type,
+    const cl_image_format * image_format, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, CL_FALSE);
+    /* Make sure image_format is not NULL. */
+    g_return_val_if_fail(image_format != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Cached image formats. */
+    CCLContextImageFormats * e;
+
+    /* Key of image format. */
+    gint64 key = ccl_context_img_fmt_key(image_format);
+
+    /* Get image formats, querying them if not yet cached. */
+    e = ccl_context_get_img_fmts(ctx, flags, image_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return g_hash_table_contains(e->supported, &key) ? CL_TRUE : CL_FALSE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
 /**
  * Get ::CCLDevice wrapper at given index.
  *
@@ -722,4 +1351,128 @@ CCLDevice * const * ccl_context_get_all_devices(
         (CCLDevContainer *) ctx, ccl_context_get_cldevices, err);
 }
 
+/**
+ * Get the total size of the memory objects allocated in a context. This
+ * includes buffers created with ::ccl_buffer_new() (and functions based
+ * on it, such as the buffer pool) and images created with
+ * ::ccl_image_new() or ::ccl_image_new_v(), which have not yet been
+ * destroyed. Sub-buffers and images created from buffers share the
+ * memory of their buffer and are not accounted for.
+ *
+ * OpenCL memory objects belong to contexts, not to devices. For
+ * single-device contexts, this is the memory used in the device.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx The context wrapper object.
+ * @return Total size in bytes of live memory objects.
+ * */
+CCL_EXPORT
+size_t ccl_context_get_mem_used(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    size_t used;
+
+    g_mutex_lock(&mem_lock);
+    used = ctx->mem_used;
+    g_mutex_unlock(&mem_lock);
+
+    return used;
+}
+
+/**
+ * Get the high-water mark of the memory allocated in a context, i.e. the
+ * maximum value returned by ::ccl_context_get_mem_used() since the
+ * context was created or the high-water mark was last reset.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx The context wrapper object.
+ * @return High-water mark in bytes.
+ * */
+CCL_EXPORT
+size_t ccl_context_get_mem_peak(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    size_t peak;
+
+    g_mutex_lock(&mem_lock);
+    peak = ctx->mem_peak;
+    g_mutex_unlock(&mem_lock);
+
+    return peak;
+}
+
+/**
+ * Reset the high-water mark of the memory allocated in a context to the
+ * memory currently allocated.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx The context wrapper object.
+ * */
+CCL_EXPORT
+void ccl_context_reset_mem_peak(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    g_mutex_lock(&mem_lock);
+    ctx->mem_peak = ctx->mem_used;
+    g_mutex_unlock(&mem_lock);
+}
+
+/**
+ * Set a soft memory budget for a context. When creating a buffer or an
+ * image would make the total size of memory objects in the context (see
+ * ::ccl_context_get_mem_used()) exceed the budget, pooled buffers of the
+ * context are released first. If the budget would still be exceeded, the
+ * memory object is not created and a ::CCL_ERROR_MEM_BUDGET error is
+ * reported, before the OpenCL implementation runs out of device memory.
+ *
+ * Setting a budget does not release memory objects already allocated.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] budget Memory budget in bytes, or 0 for no budget.
+ * */
+CCL_EXPORT
+void ccl_context_set_mem_budget(CCLContext * ctx, size_t budget) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    g_mutex_lock(&mem_lock);
+    ctx->mem_budget = budget;
+    g_mutex_unlock(&mem_lock);
+}
+
+/**
+ * Get the memory budget of a context.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] ctx The context wrapper object.
+ * @return Memory budget in bytes, or 0 if there is no budget.
+ * */
+CCL_EXPORT
+size_t ccl_context_get_mem_budget(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    size_t budget;
+
+    g_mutex_lock(&mem_lock);
+    budget = ctx->mem_budget;
+    g_mutex_unlock(&mem_lock);
+
+    return budget;
+}
+
 /** @}*/
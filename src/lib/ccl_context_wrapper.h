@@ -75,6 +75,13 @@
  * * ::ccl_context_get_device()
  * * ::ccl_context_get_num_devices()
  *
+ * Contexts account for the memory of the buffers and images created in
+ * them, which is reported by ::ccl_context_get_mem_used() and
+ * ::ccl_context_get_mem_peak(). An optional soft memory budget, set with
+ * ::ccl_context_set_mem_budget(), makes buffer and image creation fail
+ * with a ::CCL_ERROR_MEM_BUDGET error instead of exceeding it, after
+ * releasing pooled buffers if possible.
+ *
  * _Example: using all devices in a platform_
  *
  * ```c
@@ -351,6 +358,12 @@ const cl_image_format * ccl_context_get_supported_image_formats(
     CCLContext * ctx, cl_mem_flags flags, cl_mem_object_type image_type,
     cl_uint * num_image_formats, CCLErr ** err);
 
+/* Check if an image format is supported by a given context. */
+CCL_EXPORT
+cl_bool ccl_context_is_image_format_supported(CCLContext * ctx,
+    cl_mem_flags flags, cl_mem_object_type image_type,
+    const cl_image_format * image_format, CCLErr ** err);
+
 /* Get ::CCLDevice wrapper at given index. */
 CCL_EXPORT
 CCLDevice * ccl_context_get_device(
@@ -365,6 +378,26 @@ CCL_EXPORT
 CCLDevice * const * ccl_context_get_all_devices(CCLContext * ctx,
     CCLErr ** err);
 
+/* Get the total size of the memory objects allocated in a context. */
+CCL_EXPORT
+size_t ccl_context_get_mem_used(CCLContext * ctx);
+
+/* Get the high-water mark of the memory allocated in a context. */
+CCL_EXPORT
+size_t ccl_context_get_mem_peak(CCLContext * ctx);
+
+/* Reset the high-water mark of the memory allocated in a context. */
+CCL_EXPORT
+void ccl_context_reset_mem_peak(CCLContext * ctx);
+
+/* Set a soft memory budget for a context. */
+CCL_EXPORT
+void ccl_context_set_mem_budget(CCLContext * ctx, size_t budget);
+
+/* Get the memory budget of a context. */
+CCL_EXPORT
+size_t ccl_context_get_mem_budget(CCLContext * ctx);
+
 /**
  * Get a ::CCLWrapperInfo context information object.
  *
@@ -401,7 +434,7 @@ CCLDevice * const * ccl_context_get_all_devices(CCLContext * ctx,
  * If an error occurs, zero is returned.
  * */
 #define ccl_context_get_info_scalar(ctx, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) ctx, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) ctx, \
         NULL, param_name, sizeof(param_type), \
         CCL_INFO_CONTEXT, CL_FALSE, err))
 
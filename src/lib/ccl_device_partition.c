@@ -0,0 +1,334 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of affinity-aware device partitions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_device_partition.h"
+#include "ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * Affinity-aware device partition class.
+ * */
+struct ccl_device_partition {
+
+    /**
+     * Partitioned (parent) device, which owns the sub-devices.
+     * @private
+     * */
+    CCLDevice * dev;
+
+    /**
+     * Sub-devices, one per affinity domain.
+     * @private
+     * */
+    CCLDevice * const * subdevs;
+
+    /**
+     * Number of sub-devices.
+     * @private
+     * */
+    cl_uint num_subdevs;
+
+    /**
+     * Context containing the sub-devices.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Command queues, one per sub-device.
+     * @private
+     * */
+    CCLQueue ** queues;
+
+};
+
+/**
+ * @addtogroup CCL_DEVICE_PARTITION
+ * @{
+ */
+
+/**
+ * Partition a device by affinity domain, creating a context with the
+ * resulting sub-devices and a command queue for each sub-device.
+ *
+ * @public @memberof ccl_device_partition
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] dev Device wrapper object to partition.
+ * @param[in] domain Affinity domain by which to partition the device,
+ * e.g. `CL_DEVICE_AFFINITY_DOMAIN_NUMA` or
+ * `CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE`. If 0,
+ * `CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE` is used.
+ * @param[in] properties Properties of the command queues.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new device partition, or `NULL` if an error occurs, e.g. if the
+ * device cannot be partitioned by the given affinity domain.
+ * */
+CCL_EXPORT
+CCLDevicePartition * ccl_device_partition_new(CCLDevice * dev,
+    cl_device_affinity_domain domain, cl_command_queue_properties properties,
+    CCLErr ** err) {
+
+    /* Make sure dev is not NULL. */
+    g_return_val_if_fail(dev != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLDevicePartition * part = NULL;
+    cl_device_partition_property props[] = {
+        CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN,
+        (cl_device_partition_property) (domain != 0
+            ? domain : CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE),
+        0 };
+
+    part = g_slice_new0(CCLDevicePartition);
+
+    /* Partition device. Sub-devices are owned by the parent device,
+     * which is kept alive by the partition. */
+    part->subdevs = ccl_device_create_subdevices(
+        dev, props, &part->num_subdevs, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_device_ref(dev);
+    part->dev = dev;
+
+    /* Create context with sub-devices. */
+    part->ctx = ccl_context_new_from_devices(
+        part->num_subdevs, part->subdevs, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create one queue per sub-device. */
+    part->queues = g_new0(CCLQueue *, part->num_subdevs);
+    for (cl_uint i = 0; i < part->num_subdevs; ++i) {
+        part->queues[i] = ccl_queue_new(
+            part->ctx, part->subdevs[i], properties, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    ccl_device_partition_destroy(part);
+    part = NULL;
+
+finish:
+
+    /* Return partition. */
+    return part;
+}
+
+/**
+ * Destroy a device partition, its queues and its context. Sub-devices
+ * are released with the parent device.
+ *
+ * @public @memberof ccl_device_partition
+ *
+ * @param[in] part The device partition to destroy.
+ * */
+CCL_EXPORT
+void ccl_device_partition_destroy(CCLDevicePartition * part) {
+
+    /* Make sure part is not NULL. */
+    g_return_if_fail(part != NULL);
+
+    if (part->queues != NULL) {
+        for (cl_uint i = 0; i < part->num_subdevs; ++i)
+            if (part->queues[i] != NULL)
+                ccl_queue_destroy(part->queues[i]);
+        g_free(part->queues);
+    }
+    if (part->ctx != NULL)
+        ccl_context_destroy(part->ctx);
+    if (part->dev != NULL)
+        ccl_device_unref(part->dev);
+    g_slice_free(CCLDevicePartition, part);
+}
+
+/**
+ * Get number of affinity domains, i.e. of sub-devices, of a device
+ * partition.
+ *
+ * @public @memberof ccl_device_partition
+ *
+ * @param[in] part A device partition.
+ * @return Number of affinity domains.
+ * */
+CCL_EXPORT
+cl_uint ccl_device_partition_get_num_domains(CCLDevicePartition * part) {
+
+    /* Make sure part is not NULL. */
+    g_return_val_if_fail(part != NULL, 0);
+
+    return part->num_subdevs;
+}
+
+/**
+ * Get context of a device partition, which contains all its sub-devices.
+ *
+ * @public @memberof ccl_device_partition
+ *
+ * @param[in] part A device partition.
+ * @return Context wrapper object, owned by the partition.
+ * */
+CCL_EXPORT
+CCLContext * ccl_device_partition_get_context(CCLDevicePartition * part) {
+
+    /* Make sure part is not NULL. */
+    g_return_val_if_fail(part != NULL, NULL);
+
+    return part->ctx;
+}
+
+/**
+ * Get sub-device of an affinity domain.
+ *
+ * @public @memberof ccl_device_partition
+ *
+ * @param[in] part A device partition.
+ * @param[in] index Index of affinity domain.
+ * @return Sub-device wrapper object, owned by the partitioned device.
+ * */
+CCL_EXPORT
+CCLDevice * ccl_device_partition_get_device(
+    CCLDevicePartition * part, cl_uint index) {
+
+    /* Make sure part is not NULL. */
+    g_return_val_if_fail(part != NULL, NULL);
+    /* Make sure index is valid. */
+    g_return_val_if_fail(index < part->num_subdevs, NULL);
+
+    return part->subdevs[index];
+}
+
+/**
+ * Get command queue of an affinity domain.
+ *
+ * @public @memberof ccl_device_partition
+ *
+ * @param[in] part A device partition.
+ * @param[in] index Index of affinity domain.
+ * @return Command queue wrapper object, owned by the partition.
+ * */
+CCL_EXPORT
+CCLQueue * ccl_device_partition_get_queue(
+    CCLDevicePartition * part, cl_uint index) {
+
+    /* Make sure part is not NULL. */
+    g_return_val_if_fail(part != NULL, NULL);
+    /* Make sure index is valid. */
+    g_return_val_if_fail(index < part->num_subdevs, NULL);
+
+    return part->queues[index];
+}
+
+/**
+ * Create a buffer whose memory is local to an affinity domain.
+ *
+ * The buffer is allocated with `CL_MEM_ALLOC_HOST_PTR`, and is zeroed by
+ * a fill command enqueued in the queue of the affinity domain before it
+ * is returned. The fill is thus the first access to the memory, which,
+ * on CPU devices and operating systems with a first-touch page placement
+ * policy, places the buffer pages on the NUMA node of the sub-device.
+ *
+ * @public @memberof ccl_device_partition
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] part A device partition.
+ * @param[in] index Index of affinity domain.
+ * @param[in] flags OpenCL memory flags, as used in clCreateBuffer(),
+ * excluding `CL_MEM_USE_HOST_PTR` and `CL_MEM_COPY_HOST_PTR`.
+ * @param[in] size Size in bytes of buffer.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new zeroed buffer wrapper object, which should be freed with
+ * ccl_buffer_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_device_partition_buffer_new(CCLDevicePartition * part,
+    cl_uint index, cl_mem_flags flags, size_t size, CCLErr ** err) {
+
+    /* Make sure part is not NULL. */
+    g_return_val_if_fail(part != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    cl_uchar zero = 0;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, index >= part->num_subdevs,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: invalid affinity domain index.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: domain-local buffers cannot use or copy host memory.",
+        CCL_STRD);
+
+    /* Allocate buffer. */
+    buf = ccl_buffer_new(part->ctx, flags | CL_MEM_ALLOC_HOST_PTR, size,
+        NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* First touch buffer memory with the sub-device. */
+    evt = ccl_buffer_enqueue_fill(buf, part->queues[index], &zero,
+        sizeof(cl_uchar), 0, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release buffer, if created. */
+    if (buf != NULL) ccl_buffer_destroy(buf);
+    buf = NULL;
+
+finish:
+
+    /* Return buffer. */
+    return buf;
+}
+
+/** @} */
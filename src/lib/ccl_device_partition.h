@@ -0,0 +1,129 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of affinity-aware device partitions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_DEVICE_PARTITION_H_
+#define _CCL_DEVICE_PARTITION_H_
+
+#include "ccl_common.h"
+#include "ccl_device_wrapper.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+
+/**
+ * @defgroup CCL_DEVICE_PARTITION Device partitions
+ * @ingroup CCL_DEVICE_WRAPPER
+ *
+ * This module partitions a device by affinity domain, e.g. by NUMA node
+ * or by shared L3 cache, and sets up a context with the resulting
+ * sub-devices and a command queue for each of them.
+ *
+ * A partition is created with ::ccl_device_partition_new(). Work is then
+ * distributed over the sub-devices, each one enqueued in the respective
+ * queue, given by ::ccl_device_partition_get_queue(). Buffers used by
+ * the commands of one sub-device should be created with
+ * ::ccl_device_partition_buffer_new(), which allocates host-accessible
+ * memory and first touches it with the sub-device, so that, on CPU
+ * devices and operating systems with a first-touch page placement
+ * policy, the memory is placed on the NUMA node of the sub-device
+ * instead of being accessed remotely.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLDevicePartition * part;
+ * CCLBuffer * bufs[MAX_DOMAINS];
+ * cl_uint n;
+ * @endcode
+ * @code{.c}
+ * part = ccl_device_partition_new(cpu, CL_DEVICE_AFFINITY_DOMAIN_NUMA,
+ *     0, NULL);
+ * n = ccl_device_partition_get_num_domains(part);
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < n; ++i) {
+ *     bufs[i] = ccl_device_partition_buffer_new(part, i,
+ *         CL_MEM_READ_WRITE, size / n, NULL);
+ *     ccl_kernel_set_args_and_enqueue_ndrange(krnl[i],
+ *         ccl_device_partition_get_queue(part, i), 1, NULL, &gws, NULL,
+ *         NULL, NULL, bufs[i], NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < n; ++i) {
+ *     ccl_queue_finish(ccl_device_partition_get_queue(part, i), NULL);
+ *     ccl_buffer_destroy(bufs[i]);
+ * }
+ * ccl_device_partition_destroy(part);
+ * @endcode
+ *
+ * @note Requires OpenCL >= 1.2
+ *
+ * @{
+ */
+
+/**
+ * Affinity-aware device partition class.
+ * */
+typedef struct ccl_device_partition CCLDevicePartition;
+
+/* Partition a device by affinity domain. */
+CCL_EXPORT
+CCLDevicePartition * ccl_device_partition_new(CCLDevice * dev,
+    cl_device_affinity_domain domain, cl_command_queue_properties properties,
+    CCLErr ** err);
+
+/* Destroy a device partition, its queues and its context. */
+CCL_EXPORT
+void ccl_device_partition_destroy(CCLDevicePartition * part);
+
+/* Get number of affinity domains (sub-devices) of a device partition. */
+CCL_EXPORT
+cl_uint ccl_device_partition_get_num_domains(CCLDevicePartition * part);
+
+/* Get context of a device partition. */
+CCL_EXPORT
+CCLContext * ccl_device_partition_get_context(CCLDevicePartition * part);
+
+/* Get sub-device of an affinity domain. */
+CCL_EXPORT
+CCLDevice * ccl_device_partition_get_device(
+    CCLDevicePartition * part, cl_uint index);
+
+/* Get command queue of an affinity domain. */
+CCL_EXPORT
+CCLQueue * ccl_device_partition_get_queue(
+    CCLDevicePartition * part, cl_uint index);
+
+/* Create a buffer whose memory is local to an affinity domain. */
+CCL_EXPORT
+CCLBuffer * ccl_device_partition_buffer_new(CCLDevicePartition * part,
+    cl_uint index, cl_mem_flags flags, size_t size, CCLErr ** err);
+
+/** @} */
+
+#endif
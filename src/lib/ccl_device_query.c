@@ -1196,6 +1196,152 @@ CCL_EXPORT
 const int ccl_devquery_info_map_size =
     sizeof(ccl_devquery_info_map) / sizeof(CCLDevQueryMap) - 1;
 
+/**
+ * @internal
+ *
+ * @brief A suffix of a parameter name in the device information map.
+ * */
+typedef struct ccl_devquery_suffix {
+
+    /**
+     * Row of the parameter in the device information map.
+     * @private
+     * */
+    guint16 row;
+
+    /**
+     * Offset of the suffix in the parameter name.
+     * @private
+     * */
+    guint16 offset;
+
+} CCLDevQuerySuffix;
+
+/**
+ * @internal
+ *
+ * @brief Lookup index over the device information map, built once on
+ * first use and never freed.
+ * */
+typedef struct ccl_devquery_index {
+
+    /**
+     * Parameter names to respective row in the device information map
+     * plus one.
+     * @private
+     * */
+    GHashTable * names;
+
+    /**
+     * Alphabetically sorted suffixes of all parameter names.
+     * @private
+     * */
+    CCLDevQuerySuffix * suffixes;
+
+    /**
+     * Number of suffixes.
+     * @private
+     * */
+    guint num_suffixes;
+
+} CCLDevQueryIndex;
+
+/**
+ * @internal
+ *
+ * @brief Get the string of a parameter name suffix.
+ *
+ * @param[in] sfx Parameter name suffix.
+ * @return The string of the parameter name suffix.
+ * */
+#define ccl_devquery_suffix_str(sfx) \
+    (ccl_devquery_info_map[(sfx)->row].param_name + (sfx)->offset)
+
+/**
+ * @internal
+ *
+ * @brief Compare two parameter name suffixes, for sorting purposes.
+ *
+ * @param[in] a First suffix.
+ * @param[in] b Second suffix.
+ * @return Negative, zero or positive if `a` is respectively less than,
+ * equal to or greater than `b`.
+ * */
+static int ccl_devquery_suffix_cmp(const void * a, const void * b) {
+
+    const CCLDevQuerySuffix * sa = (const CCLDevQuerySuffix *) a;
+    const CCLDevQuerySuffix * sb = (const CCLDevQuerySuffix *) b;
+    int cmp_res = strcmp(
+        ccl_devquery_suffix_str(sa), ccl_devquery_suffix_str(sb));
+
+    /* Equal suffixes are ordered by row. */
+    if (cmp_res == 0) cmp_res = (int) sa->row - (int) sb->row;
+    return cmp_res;
+}
+
+/**
+ * @internal
+ *
+ * @brief Build the lookup index over the device information map. Called
+ * only once, via `g_once()`.
+ *
+ * @param[in] data Unused.
+ * @return A ::CCLDevQueryIndex object.
+ * */
+static gpointer ccl_devquery_index_build(gpointer data) {
+
+    CCLDevQueryIndex * index;
+    guint num_suffixes = 0;
+    guint k = 0;
+
+    CCL_UNUSED(data);
+
+    index = g_slice_new0(CCLDevQueryIndex);
+
+    /* Exact lookups. */
+    index->names = g_hash_table_new(g_str_hash, g_str_equal);
+    for (gint i = 0; i < ccl_devquery_info_map_size; ++i) {
+        g_hash_table_insert(index->names,
+            (gpointer) ccl_devquery_info_map[i].param_name,
+            GINT_TO_POINTER(i + 1));
+        num_suffixes += strlen(ccl_devquery_info_map[i].param_name);
+    }
+
+    /* Substring lookups: a substring of a parameter name is a prefix of
+     * one of its suffixes, so matching rows are found with a binary
+     * search over all the sorted suffixes. */
+    index->suffixes = g_new(CCLDevQuerySuffix, num_suffixes);
+    for (gint i = 0; i < ccl_devquery_info_map_size; ++i) {
+        guint len = strlen(ccl_devquery_info_map[i].param_name);
+        for (guint j = 0; j < len; ++j) {
+            index->suffixes[k].row = (guint16) i;
+            index->suffixes[k].offset = (guint16) j;
+            ++k;
+        }
+    }
+    index->num_suffixes = num_suffixes;
+    qsort(index->suffixes, num_suffixes, sizeof(CCLDevQuerySuffix),
+        ccl_devquery_suffix_cmp);
+
+    return (gpointer) index;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the lookup index over the device information map, building
+ * it on the first call.
+ *
+ * @return The lookup index over the device information map.
+ * */
+static CCLDevQueryIndex * ccl_devquery_index_get(void) {
+
+    static GOnce index_once = G_ONCE_INIT;
+
+    return (CCLDevQueryIndex *) g_once(
+        &index_once, ccl_devquery_index_build, NULL);
+}
+
 /**
  * @addtogroup CCL_DEVICE_QUERY
  * @{
@@ -1218,35 +1364,13 @@ int ccl_devquery_get_index(const char * name) {
     /* Make sure name is not NULL. */
     g_return_val_if_fail(name != NULL, -1);
 
-    /* Search indexes. */
-    gint idx_middle;
-    guint idx_start, idx_end;
-
-    /* String comparison result. */
-    gint cmp_res;
-
-    /* Found info flag. */
-    gboolean found = FALSE;
-
-    /* Binary search. */
-    idx_start = 0;
-    idx_end = ccl_devquery_info_map_size - 1;
-    while (idx_end >= idx_start) {
-        idx_middle = (idx_start + idx_end) / 2;
-        cmp_res = g_strcmp0(
-            name, ccl_devquery_info_map[idx_middle].param_name);
-        if (cmp_res == 0) {
-            found = TRUE;
-            break;
-        }
-        if (cmp_res > 0)
-            idx_start = idx_middle + 1;
-        else
-            idx_end = idx_middle - 1;
-    }
+    /* Index of the device information map object plus one, or zero if
+     * not found. */
+    gint idx_plus_one = GPOINTER_TO_INT(g_hash_table_lookup(
+        ccl_devquery_index_get()->names, name));
 
     /* Return result */
-    return found ? idx_middle : -1;
+    return idx_plus_one - 1;
 }
 
 /**
@@ -1357,31 +1481,41 @@ const CCLDevQueryMap * ccl_devquery_match(const char * substr, int * idx) {
     /* Make sure idx is not NULL. */
     g_return_val_if_fail(idx != NULL, NULL);
 
-    /* Found flag. */
-    gboolean found = FALSE;
+    /* Lookup index and suffix search bounds. */
+    CCLDevQueryIndex * index = ccl_devquery_index_get();
+    guint lo = 0, hi = index->num_suffixes, mid;
+    gsize len = strlen(substr);
 
-    /* Found result. */
-    const CCLDevQueryMap * info_row = NULL;
+    /* Next matching row. */
+    gint row = ccl_devquery_info_map_size;
 
-    /* Linear search. */
-    for ( ; *idx < ccl_devquery_info_map_size; (*idx)++) {
-        if (g_strstr_len(
-            ccl_devquery_info_map[*idx].param_name, -1, substr)) {
-
-            found = TRUE;
-            break;
-        }
+    /* Find the first suffix not less than the substring. */
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (strcmp(ccl_devquery_suffix_str(&index->suffixes[mid]), substr)
+                < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    /* Set found result. */
-    if (found)
-        info_row = &ccl_devquery_info_map[*idx];
+    /* Suffixes starting with the substring are contiguous, get the first
+     * matching row from the given index onwards. */
+    for ( ; (lo < index->num_suffixes) && (strncmp(
+            ccl_devquery_suffix_str(&index->suffixes[lo]), substr, len) == 0);
+            ++lo) {
+        if ((index->suffixes[lo].row >= *idx)
+                && (index->suffixes[lo].row < row))
+            row = index->suffixes[lo].row;
+    }
 
-    /* Increment index (for next iteration). */
+    /* Set index for next iteration, past the matching row. */
+    if (*idx < row) *idx = row;
     (*idx)++;
 
     /* Return result. */
-    return info_row;
+    return (row < ccl_devquery_info_map_size)
+        ? &ccl_devquery_info_map[row] : NULL;
 }
 
 /** @} */
@@ -27,6 +27,7 @@
  * */
 
 #include "ccl_device_selector.h"
+#include "_ccl_platforms.h"
 #include "_ccl_defs.h"
 
 /**
@@ -36,6 +37,22 @@
  * */
 typedef void (*ccl_devsel_fp)(void);
 
+/**
+ * @internal
+ * Characters not allowed in device selection cache groups, which are
+ * replaced by underscores.
+ * */
+#define CCL_DEVSEL_CACHE_INVALID "[]=\n\r"
+
+/* Lock protecting the device selection cache. */
+static GMutex devsel_lock;
+
+/* In-memory copy of the device selection cache, loaded on first use. */
+static GKeyFile * devsel_cache = NULL;
+
+/* Device selection cache file, or NULL to use the default location. */
+static gchar * devsel_cache_file = NULL;
+
 /**
  * Device filter class, includes a filter function (independent
  * or dependent) and the respective filter data.
@@ -307,6 +324,129 @@ finish:
 
 }
 
+/**
+ * @internal
+ * Load the device selection cache from disk, if not already loaded. Must
+ * be called with the device selection cache lock held.
+ * */
+static void ccl_devsel_cache_load() {
+
+    /* Is cache already loaded? */
+    if (devsel_cache != NULL) return;
+
+    /* Determine cache file, if not set. */
+    if (devsel_cache_file == NULL) {
+        const char * env_file = g_getenv(CCL_DEVSEL_CACHE_ENV);
+        devsel_cache_file = ((env_file != NULL) && (*env_file != '\0'))
+            ? g_strdup(env_file)
+            : g_build_filename(
+                g_get_user_cache_dir(), "cf4ocl", "devsel.ini", NULL);
+    }
+
+    /* A missing or invalid cache file just means that nothing was
+     * selected yet. */
+    devsel_cache = g_key_file_new();
+    g_key_file_load_from_file(
+        devsel_cache, devsel_cache_file, G_KEY_FILE_NONE, NULL);
+}
+
+/**
+ * @internal
+ * Save the device selection cache to disk. Must be called with the device
+ * selection cache lock held. Failing to save the cache is not an error,
+ * since the selection is still valid, so only a warning is issued.
+ * */
+static void ccl_devsel_cache_save() {
+
+    /* Internal error object. */
+    GError * err_save = NULL;
+    /* Cache file directory. */
+    gchar * dir = g_path_get_dirname(devsel_cache_file);
+
+    /* Make sure cache directory exists and save cache. */
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_key_file_save_to_file(devsel_cache, devsel_cache_file, &err_save)) {
+        g_warning("Unable to save device selection cache: %s",
+            err_save->message);
+        g_error_free(err_save);
+    }
+    g_free(dir);
+}
+
+/**
+ * @internal
+ * Determine the fingerprint of a list of devices, which changes whenever
+ * devices, their platforms or their drivers change.
+ *
+ * @param[in] devices List of device wrappers.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The fingerprint, which should be freed with g_free(), or `NULL`
+ * if an error occurs.
+ * */
+static gchar * ccl_devsel_fingerprint(
+    CCLDevSelDevices devices, CCLErr ** err) {
+
+    /* Device information used in fingerprint. */
+    const cl_device_info params[] = { CL_DEVICE_NAME, CL_DEVICE_VENDOR,
+        CL_DEVICE_VERSION, CL_DRIVER_VERSION };
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+    /* Concatenated device information. */
+    GString * ids = g_string_new(NULL);
+    /* Fingerprint. */
+    gchar * fp = NULL;
+    /* Information string. */
+    char * info;
+
+    for (guint i = 0; i < devices->len; ++i) {
+        CCLDevice * dev = (CCLDevice *) g_ptr_array_index(devices, i);
+        for (guint j = 0; j < G_N_ELEMENTS(params); ++j) {
+            info = ccl_device_get_info_array(
+                dev, params[j], char, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            g_string_append_printf(ids, "%s|", info);
+        }
+        g_string_append_printf(ids, "%u;", ccl_device_get_info_scalar(
+            dev, CL_DEVICE_VENDOR_ID, cl_uint, &err_internal));
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+    fp = g_compute_checksum_for_string(G_CHECKSUM_SHA1, ids->str, -1);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    g_string_free(ids, TRUE);
+    return fp;
+}
+
+/**
+ * @internal
+ * Free a set of filters and set it to `NULL`, so that the variable can be
+ * reused by client code.
+ *
+ * @param[in,out] filters Set of filters.
+ * */
+static void ccl_devsel_filters_free(CCLDevSelFilters * filters) {
+
+    /* Free individual filters. */
+    for (guint i = 0; i < (*filters)->len; i++)
+        g_slice_free(CCLDevSelFilter, g_ptr_array_index(*filters, i));
+
+    /* Free filter array. */
+    g_ptr_array_free(*filters, CL_TRUE);
+
+    /* Set filters to NULL, so variable can be reused by client. */
+    *filters = NULL;
+}
+
 /**
  * @addtogroup CCL_DEVICE_SELECTOR
  * @{
@@ -319,6 +459,11 @@ finish:
  * See ::CCLDevSelDevices for information on how to access individual device
  * wrappers within the object.
  *
+ * Devices are taken from the process-wide snapshot of platforms and
+ * devices, so they are only enumerated through the ICD loader the first
+ * time this function (or ::ccl_platforms_new()) is called, or after
+ * ::ccl_platforms_refresh().
+ *
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
  * @return An object containing device wrappers for all OpenCL devices present
@@ -332,76 +477,32 @@ CCLDevSelDevices ccl_devsel_devices_new(CCLErr ** err) {
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-    /* Platforms wrapper object. */
-    CCLPlatforms * platforms = NULL;
-
-    /* Platform wrapper object. */
-    CCLPlatform * platform = NULL;
-
-    /* Device wrapper object. */
-    CCLDevice * device = NULL;
-
     /* Array of device wrapper objects. Devices will be selected from
      * this array.  */
     GPtrArray * devices = NULL;
 
-    /* Number of platforms. */
-    guint num_platfs;
+    /* IDs of all devices in the system. */
+    cl_device_id * dev_ids;
+
+    /* Number of devices in the system. */
+    cl_uint num_devs;
 
     /* Internal error handling object. */
     CCLErr * err_internal = NULL;
 
-    /* Get all OpenCL platforms in system wrapped in a CCLPlatforms
-     * object. */
-    platforms = ccl_platforms_new(&err_internal);
+    /* Get IDs of all OpenCL devices in system from the discovery
+     * snapshot. */
+    dev_ids = ccl_platforms_get_snapshot_devices(&num_devs, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Determine number of platforms. */
-    num_platfs = ccl_platforms_count(platforms);
-
     /* Create array of device wrapper objects. */
     devices = g_ptr_array_new_with_free_func(
         (GDestroyNotify) ccl_device_destroy);
 
-    /* Cycle through OpenCL platforms. */
-    for (guint i = 0; i < num_platfs; i++) {
-
-        /* Get next platform wrapper. */
-        platform = ccl_platforms_get(platforms, i);
-
-        /* Get number of devices in current platform.*/
-        guint num_devices = ccl_platform_get_num_devices(
-            platform, &err_internal);
-
-        /* Is this a platform without devices? */
-        if ((err_internal) && (err_internal->domain == CCL_OCL_ERROR) &&
-                (err_internal->code == CL_DEVICE_NOT_FOUND)) {
-
-            /* Clear "device not found" error. */
-            ccl_err_clear(&err_internal);
-
-            /* Skip this platform. */
-            continue;
-        }
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-
-        /* Cycle through devices in current platform. */
-        for (guint j = 0; j < num_devices; j++) {
-
-            /* Get current device wrapper. */
-            device = ccl_platform_get_device(platform, j, &err_internal);
-            ccl_if_err_propagate_goto(err, err_internal, error_handler);
-
-            /* Add device wrapper to array of device wrapper objects. */
-            g_ptr_array_add(devices, (gpointer) device);
-
-            /* Update device reference (because it is kept also in
-             * the array of device wrapper objects). */
-            ccl_device_ref(device);
-
-        }
-
-    }
+    /* Wrap device IDs, adding the wrappers (with a new reference) to the
+     * array of device wrapper objects. */
+    for (cl_uint i = 0; i < num_devs; i++)
+        g_ptr_array_add(devices, (gpointer) ccl_device_new_wrap(dev_ids[i]));
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -413,8 +514,8 @@ error_handler:
 
 finish:
 
-    /* Free platforms wrapper object. */
-    if (platforms != NULL) ccl_platforms_destroy(platforms);
+    /* Free array of device IDs. */
+    g_free(dev_ids);
 
     /* Return the selected devices. */
     return devices;
@@ -655,20 +756,180 @@ error_handler:
 
 finish:
 
-    /* Free individual filters. */
-    for (guint i = 0; i < (*filters)->len; i++)
-        g_slice_free(CCLDevSelFilter, g_ptr_array_index(*filters, i));
+    /* Free filters. */
+    ccl_devsel_filters_free(filters);
 
-    /* Free filter array. */
-    g_ptr_array_free(*filters, CL_TRUE);
+    /* Return the selected devices. */
+    return devices;
+}
 
-    /* Set filters to NULL, so variable can be reused by client. */
-    *filters = NULL;
+/**
+ * Select one or more OpenCL devices based on the provided filters,
+ * reusing the result of a previous selection, possibly made by a previous
+ * run of the program, if the devices in the system did not change since.
+ *
+ * Since filters cannot be compared, the filter set is identified by a key
+ * chosen by client code. For each key, the selected devices are kept in a
+ * cache file, together with a fingerprint of the names, vendors, versions
+ * and driver versions of all devices in the system. If a selection for the
+ * given key is found and the fingerprint matches, filters are not
+ * evaluated; otherwise, the selection is performed with
+ * ::ccl_devsel_select() and cached. The cache file is given by the
+ * `CCL_DEVSEL_CACHE` environment variable or by
+ * ::ccl_devsel_cache_set_file(), and defaults to `cf4ocl/devsel.ini` under
+ * the user cache directory.
+ *
+ * Filters are freed and `filters` is set to `NULL`, as in
+ * ::ccl_devsel_select().
+ *
+ * @param[in] filters Filters used to select device(s).
+ * @param[in] key Key identifying the filter set.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return One or more OpenCL devices selected based on the provided filters.
+ * */
+CCL_EXPORT
+CCLDevSelDevices ccl_devsel_select_cached(CCLDevSelFilters * filters,
+    const char * key, CCLErr ** err) {
+
+    /* Make sure filters and key are not NULL. */
+    g_return_val_if_fail(filters != NULL, NULL);
+    g_return_val_if_fail(key != NULL, NULL);
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* All devices in the system and selected devices. */
+    CCLDevSelDevices all = NULL, devices = NULL;
+    /* Fingerprint of devices in the system and cached fingerprint. */
+    gchar * fp = NULL, * fp_cached = NULL;
+    /* Cache group. */
+    gchar * group = g_strdelimit(g_strdup(key), CCL_DEVSEL_CACHE_INVALID, '_');
+    /* Indexes of selected devices in list of all devices. */
+    gint * idxs = NULL;
+    gsize num_idxs = 0;
+
+    /* Get all devices in the system and their fingerprint. */
+    all = ccl_devsel_devices_new(&err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    fp = ccl_devsel_fingerprint(all, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Look for a cached selection with same fingerprint. */
+    g_mutex_lock(&devsel_lock);
+    ccl_devsel_cache_load();
+    fp_cached = g_key_file_get_string(
+        devsel_cache, group, "fingerprint", NULL);
+    if (g_strcmp0(fp, fp_cached) == 0)
+        idxs = g_key_file_get_integer_list(
+            devsel_cache, group, "devices", &num_idxs, NULL);
+    g_mutex_unlock(&devsel_lock);
+
+    /* Validate cached selection. */
+    for (gsize i = 0; (idxs != NULL) && (i < num_idxs); ++i) {
+        if ((idxs[i] < 0) || ((guint) idxs[i] >= all->len)) {
+            g_free(idxs);
+            idxs = NULL;
+        }
+    }
+
+    if ((idxs != NULL) && (num_idxs > 0)) {
+
+        /* Use cached selection. */
+        devices = g_ptr_array_new_with_free_func(
+            (GDestroyNotify) ccl_device_destroy);
+        for (gsize i = 0; i < num_idxs; ++i) {
+            CCLDevice * dev = g_ptr_array_index(all, idxs[i]);
+            ccl_device_ref(dev);
+            g_ptr_array_add(devices, dev);
+        }
+        ccl_devsel_filters_free(filters);
+
+    } else {
+
+        /* Perform selection. */
+        devices = ccl_devsel_select(filters, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Cache selection, if not empty. Device wrappers are unique, so
+         * selected devices are found by address in the list of all
+         * devices. */
+        if (devices->len > 0) {
+            g_free(idxs);
+            idxs = g_new(gint, devices->len);
+            for (guint i = 0; i < devices->len; ++i) {
+                idxs[i] = -1;
+                for (guint j = 0; j < all->len; ++j) {
+                    if (g_ptr_array_index(devices, i)
+                            == g_ptr_array_index(all, j)) {
+                        idxs[i] = (gint) j;
+                        break;
+                    }
+                }
+            }
+            g_mutex_lock(&devsel_lock);
+            ccl_devsel_cache_load();
+            g_key_file_set_string(devsel_cache, group, "fingerprint", fp);
+            g_key_file_set_integer_list(
+                devsel_cache, group, "devices", idxs, devices->len);
+            ccl_devsel_cache_save();
+            g_mutex_unlock(&devsel_lock);
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Filters are freed even if an error occurs. */
+    if (*filters != NULL) ccl_devsel_filters_free(filters);
+
+finish:
+
+    /* Release temporary storage. */
+    if (all != NULL) ccl_devsel_devices_destroy(all);
+    g_free(fp);
+    g_free(fp_cached);
+    g_free(idxs);
+    g_free(group);
 
     /* Return the selected devices. */
     return devices;
 }
 
+/**
+ * Set the file where the device selection cache is kept, overriding the
+ * `CCL_DEVSEL_CACHE` environment variable. Selections cached in memory
+ * are discarded, and the new file is loaded on next use.
+ *
+ * @param[in] filename Device selection cache file, or `NULL` to use the
+ * `CCL_DEVSEL_CACHE` environment variable or, if not set, the default
+ * location, `cf4ocl/devsel.ini` under the user cache directory.
+ * */
+CCL_EXPORT
+void ccl_devsel_cache_set_file(const char * filename) {
+
+    g_mutex_lock(&devsel_lock);
+
+    /* Set new file. */
+    g_free(devsel_cache_file);
+    devsel_cache_file = g_strdup(filename);
+
+    /* Discard cache loaded from previous file. */
+    if (devsel_cache != NULL) {
+        g_key_file_free(devsel_cache);
+        devsel_cache = NULL;
+    }
+
+    g_mutex_unlock(&devsel_lock);
+}
+
 /**
  * @addtogroup CCL_DEVICE_SELECTOR_INDEP_FILTERS
  * @{
@@ -101,6 +101,11 @@
  * * ::ccl_devsel_get_device_strings()
  * * ::ccl_devsel_print_device_strings()
  *
+ * Short-lived programs can avoid evaluating filters on every run with
+ * ::ccl_devsel_select_cached(), which keeps the selection for a given
+ * filter set in a cache file, and reuses it as long as the devices in the
+ * system, their platforms and their drivers do not change.
+ *
  * Finally, the device selector module also offers the
  * ::ccl_devsel_devices_new() function, which returns a ::CCLDevSelDevices
  * object containing device wrappers for all OpenCL devices in the system. This
@@ -236,6 +241,20 @@ CCL_EXPORT
 CCLDevSelDevices ccl_devsel_select(
     CCLDevSelFilters * filters, CCLErr ** err);
 
+/** Environment variable which specifies the device selection cache file
+ * used by ::ccl_devsel_select_cached(). */
+#define CCL_DEVSEL_CACHE_ENV "CCL_DEVSEL_CACHE"
+
+/* Select devices based on the provided filters, reusing a cached
+ * selection if the devices in the system did not change. */
+CCL_EXPORT
+CCLDevSelDevices ccl_devsel_select_cached(CCLDevSelFilters * filters,
+    const char * key, CCLErr ** err);
+
+/* Set the file where the device selection cache is kept. */
+CCL_EXPORT
+void ccl_devsel_cache_set_file(const char * filename);
+
 /**
  * @defgroup CCL_DEVICE_SELECTOR_INDEP_FILTERS Independent filters
  *
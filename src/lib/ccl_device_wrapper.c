@@ -44,6 +44,12 @@ struct ccl_device {
      * */
     CCLWrapper base;
 
+    /**
+     * Device capabilities (lazy initialized).
+     * @private
+     * */
+    CCLDeviceCaps * caps;
+
 #ifdef CL_VERSION_1_2
     /**
      * List of sub-device arrays.
@@ -54,6 +60,63 @@ struct ccl_device {
 
 };
 
+/* Lock protecting the capabilities of all devices. */
+static GMutex caps_lock;
+
+/**
+ * @internal
+ *
+ * @brief Names of known device extensions, indexed by the bit position of
+ * the respective ::CCLDeviceExt value.
+ * */
+static const char * const ccl_device_ext_names[] = {
+    "cl_khr_fp64",
+    "cl_khr_fp16",
+    "cl_khr_global_int32_base_atomics",
+    "cl_khr_local_int32_base_atomics",
+    "cl_khr_int64_base_atomics",
+    "cl_khr_byte_addressable_store",
+    "cl_khr_3d_image_writes",
+    "cl_khr_image2d_from_buffer",
+    "cl_khr_depth_images",
+    "cl_khr_mipmap_image",
+    "cl_khr_gl_sharing",
+    "cl_khr_subgroups",
+    "cl_khr_il_program",
+    "cl_khr_command_buffer",
+    "cl_khr_priority_hints",
+    "cl_khr_throttle_hints",
+    "cl_intel_required_subgroup_size",
+    NULL
+};
+
+/**
+ * @internal
+ *
+ * @brief Parse a space-separated list of extensions into a bitset of
+ * known extensions.
+ *
+ * @param[in] exts Space-separated list of extensions.
+ * @return Bitwise OR of ::CCLDeviceExt values.
+ * */
+static cl_bitfield ccl_device_parse_extensions(const char * exts) {
+
+    cl_bitfield bits = 0;
+    gchar ** names = g_strsplit(exts, " ", -1);
+
+    for (guint i = 0; names[i] != NULL; ++i) {
+        for (guint j = 0; ccl_device_ext_names[j] != NULL; ++j) {
+            if (g_strcmp0(names[i], ccl_device_ext_names[j]) == 0) {
+                bits |= ((cl_bitfield) 1) << j;
+                break;
+            }
+        }
+    }
+    g_strfreev(names);
+
+    return bits;
+}
+
 #ifdef CL_VERSION_1_2
 
 /**
@@ -81,6 +144,8 @@ static void ccl_device_release_subdev_arrays(gpointer data) {
     g_free(subdevs);
 }
 
+#endif
+
 /**
  * @internal
  *
@@ -96,12 +161,16 @@ static void ccl_device_release_fields(CCLDevice * dev) {
     /* Make sure device wrapper object is not NULL. */
     g_return_if_fail(dev != NULL);
 
+    /* Release device capabilities. */
+    if (dev->caps != NULL)
+        g_slice_free(CCLDeviceCaps, dev->caps);
+
+#ifdef CL_VERSION_1_2
     /* Release list of arrays of sub-devices. */
     g_slist_free_full(dev->subdev_arrays,
         ccl_device_release_subdev_arrays);
-}
-
 #endif
+}
 
 /**
  * @addtogroup CCL_DEVICE_WRAPPER
@@ -161,12 +230,14 @@ void ccl_device_destroy(CCLDevice * dev) {
 
         /* If OpenCL < 1.2, don't pass OpenCL specific destructors. */
         ccl_wrapper_unref((CCLWrapper *) dev, sizeof(CCLDevice),
-            NULL, NULL, NULL);
+            (ccl_wrapper_release_fields) ccl_device_release_fields,
+            NULL, NULL);
     }
 
 #else
 
-    ccl_wrapper_unref((CCLWrapper *) dev, sizeof(CCLDevice), NULL, NULL, NULL);
+    ccl_wrapper_unref((CCLWrapper *) dev, sizeof(CCLDevice),
+        (ccl_wrapper_release_fields) ccl_device_release_fields, NULL, NULL);
 
 #endif
 }
@@ -253,6 +324,121 @@ cl_uint ccl_device_get_opencl_c_version(CCLDevice * dev, CCLErr ** err) {
 
 }
 
+/**
+ * Get the capabilities of a device. The capabilities are queried in one
+ * batch the first time this function is called for the device, and are
+ * afterwards returned as an immutable object whose fields can be read
+ * directly, avoiding the device information cache in hot paths.
+ *
+ * @public @memberof ccl_device
+ *
+ * @param[in] dev The device wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The device capabilities, which are owned by the device wrapper
+ * object and should not be modified or freed by client code, or `NULL` if
+ * an error occurs.
+ * */
+CCL_EXPORT
+const CCLDeviceCaps * ccl_device_get_caps(CCLDevice * dev, CCLErr ** err) {
+
+    /* Make sure dev is not NULL. */
+    g_return_val_if_fail(dev != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLDeviceCaps * caps = NULL;
+    const char * exts;
+
+    /* Return capabilities if they were already queried. */
+    g_mutex_lock(&caps_lock);
+    caps = dev->caps;
+    g_mutex_unlock(&caps_lock);
+    if (caps != NULL) goto finish;
+
+    /* Query capabilities. */
+    caps = g_slice_new0(CCLDeviceCaps);
+
+    caps->opencl_version = ccl_device_get_opencl_version(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* CL_DEVICE_OPENCL_C_VERSION is only available since OpenCL 1.1. */
+    if (caps->opencl_version >= 110) {
+        caps->opencl_c_version =
+            ccl_device_get_opencl_c_version(dev, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    } else {
+        caps->opencl_c_version = 100;
+    }
+
+    caps->type = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_TYPE, cl_device_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->max_compute_units = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MAX_COMPUTE_UNITS, cl_uint, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->max_work_group_size = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->mem_base_addr_align = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MEM_BASE_ADDR_ALIGN, cl_uint, &err_internal) / 8;
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->global_mem_size = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_GLOBAL_MEM_SIZE, cl_ulong, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->local_mem_size = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_LOCAL_MEM_SIZE, cl_ulong, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->max_mem_alloc_size = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, cl_ulong, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    caps->image_support = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_IMAGE_SUPPORT, cl_bool, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    exts = ccl_device_get_info_array(
+        dev, CL_DEVICE_EXTENSIONS, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    caps->extensions = ccl_device_parse_extensions(exts);
+
+    /* Keep capabilities in device wrapper, unless another thread did so
+     * meanwhile. */
+    g_mutex_lock(&caps_lock);
+    if (dev->caps == NULL) {
+        dev->caps = caps;
+    } else {
+        g_slice_free(CCLDeviceCaps, caps);
+        caps = dev->caps;
+    }
+    g_mutex_unlock(&caps_lock);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release partially filled capabilities. */
+    g_slice_free(CCLDeviceCaps, caps);
+    caps = NULL;
+
+finish:
+
+    /* Return capabilities. */
+    return caps;
+}
+
 /**
  * Creates a `NULL`-terminated array of sub-devices that each reference
  * a non-intersecting set of compute units within the given parent
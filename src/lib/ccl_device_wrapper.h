@@ -68,9 +68,106 @@
  * dev = ccl_context_get_device(ctx, 0, NULL);
  * ```
  *
+ * Frequently checked device capabilities, such as the OpenCL version, the
+ * maximum work-group size or the supported extensions, can also be
+ * fetched in one batch with ::ccl_device_get_caps(), which returns an
+ * immutable ::CCLDeviceCaps object whose fields are read directly:
+ *
+ * ```c
+ * const CCLDeviceCaps * caps = ccl_device_get_caps(dev, NULL);
+ * if (caps && (caps->extensions & CCL_DEVICE_EXT_KHR_FP64)) { ... }
+ * ```
+ *
  * @{
  */
 
+/**
+ * Known device extensions, as bits of ::CCLDeviceCaps::extensions.
+ * */
+typedef enum ccl_device_ext {
+
+    /** `cl_khr_fp64` extension. */
+    CCL_DEVICE_EXT_KHR_FP64                     = 1 << 0,
+    /** `cl_khr_fp16` extension. */
+    CCL_DEVICE_EXT_KHR_FP16                     = 1 << 1,
+    /** `cl_khr_global_int32_base_atomics` extension. */
+    CCL_DEVICE_EXT_KHR_GLOBAL_INT32_BASE_ATOMICS = 1 << 2,
+    /** `cl_khr_local_int32_base_atomics` extension. */
+    CCL_DEVICE_EXT_KHR_LOCAL_INT32_BASE_ATOMICS = 1 << 3,
+    /** `cl_khr_int64_base_atomics` extension. */
+    CCL_DEVICE_EXT_KHR_INT64_BASE_ATOMICS       = 1 << 4,
+    /** `cl_khr_byte_addressable_store` extension. */
+    CCL_DEVICE_EXT_KHR_BYTE_ADDRESSABLE_STORE   = 1 << 5,
+    /** `cl_khr_3d_image_writes` extension. */
+    CCL_DEVICE_EXT_KHR_3D_IMAGE_WRITES          = 1 << 6,
+    /** `cl_khr_image2d_from_buffer` extension. */
+    CCL_DEVICE_EXT_KHR_IMAGE2D_FROM_BUFFER      = 1 << 7,
+    /** `cl_khr_depth_images` extension. */
+    CCL_DEVICE_EXT_KHR_DEPTH_IMAGES             = 1 << 8,
+    /** `cl_khr_mipmap_image` extension. */
+    CCL_DEVICE_EXT_KHR_MIPMAP_IMAGE             = 1 << 9,
+    /** `cl_khr_gl_sharing` extension. */
+    CCL_DEVICE_EXT_KHR_GL_SHARING               = 1 << 10,
+    /** `cl_khr_subgroups` extension. */
+    CCL_DEVICE_EXT_KHR_SUBGROUPS                = 1 << 11,
+    /** `cl_khr_il_program` extension. */
+    CCL_DEVICE_EXT_KHR_IL_PROGRAM               = 1 << 12,
+    /** `cl_khr_command_buffer` extension. */
+    CCL_DEVICE_EXT_KHR_COMMAND_BUFFER           = 1 << 13,
+    /** `cl_khr_priority_hints` extension. */
+    CCL_DEVICE_EXT_KHR_PRIORITY_HINTS           = 1 << 14,
+    /** `cl_khr_throttle_hints` extension. */
+    CCL_DEVICE_EXT_KHR_THROTTLE_HINTS           = 1 << 15,
+    /** `cl_intel_required_subgroup_size` extension. */
+    CCL_DEVICE_EXT_INTEL_REQUIRED_SUBGROUP_SIZE = 1 << 16
+
+} CCLDeviceExt;
+
+/**
+ * Immutable snapshot of frequently checked device capabilities, obtained
+ * with ::ccl_device_get_caps().
+ * */
+typedef struct ccl_device_caps {
+
+    /** OpenCL version, as returned by ccl_device_get_opencl_version(). */
+    cl_uint opencl_version;
+
+    /** OpenCL C version, as returned by
+     * ccl_device_get_opencl_c_version(). */
+    cl_uint opencl_c_version;
+
+    /** Device type (`CL_DEVICE_TYPE`). */
+    cl_device_type type;
+
+    /** Number of compute units (`CL_DEVICE_MAX_COMPUTE_UNITS`). */
+    cl_uint max_compute_units;
+
+    /** Maximum work-group size (`CL_DEVICE_MAX_WORK_GROUP_SIZE`). */
+    size_t max_work_group_size;
+
+    /** Alignment in bytes of memory object origins
+     * (`CL_DEVICE_MEM_BASE_ADDR_ALIGN`, which is given in bits). */
+    cl_uint mem_base_addr_align;
+
+    /** Size in bytes of global memory (`CL_DEVICE_GLOBAL_MEM_SIZE`). */
+    cl_ulong global_mem_size;
+
+    /** Size in bytes of local memory (`CL_DEVICE_LOCAL_MEM_SIZE`). */
+    cl_ulong local_mem_size;
+
+    /** Maximum size in bytes of a memory object allocation
+     * (`CL_DEVICE_MAX_MEM_ALLOC_SIZE`). */
+    cl_ulong max_mem_alloc_size;
+
+    /** Are images supported (`CL_DEVICE_IMAGE_SUPPORT`)? */
+    cl_bool image_support;
+
+    /** Known extensions supported by device (bitwise OR of
+     * ::CCLDeviceExt values). */
+    cl_bitfield extensions;
+
+} CCLDeviceCaps;
+
 /* Decrements the reference count of the device wrapper object.
  * If it reaches 0, the device wrapper object is destroyed. */
 CCL_EXPORT
@@ -88,6 +185,10 @@ cl_uint ccl_device_get_opencl_version(CCLDevice * dev, CCLErr ** err);
 CCL_EXPORT
 cl_uint ccl_device_get_opencl_c_version(CCLDevice * dev, CCLErr ** err);
 
+/* Get the capabilities of a device. */
+CCL_EXPORT
+const CCLDeviceCaps * ccl_device_get_caps(CCLDevice * dev, CCLErr ** err);
+
 /* Creates an array of sub-devices that each reference a
  * non-intersecting set of compute units within the given device. */
 CCL_EXPORT
@@ -131,7 +232,7 @@ CCLDevice * const * ccl_device_create_subdevices(CCLDevice * dev,
  * If an error occurs, zero is returned.
  * */
 #define ccl_device_get_info_scalar(dev, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) dev, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) dev, \
         NULL, param_name, sizeof(param_type), \
         CCL_INFO_DEVICE, CL_FALSE, err))
 
@@ -0,0 +1,446 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of the benchmark-ranked device selection filter.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_devsel_bench.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_program_wrapper.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ * Number of work-items of the compute benchmark.
+ * */
+#define CCL_DEVSEL_BENCH_COMPUTE_WI (1 << 18)
+
+/**
+ * @internal
+ * Number of floating-point operations per work-item of the compute
+ * benchmark (256 iterations of two multiply-adds).
+ * */
+#define CCL_DEVSEL_BENCH_COMPUTE_FLOPS (256 * 2 * 2)
+
+/**
+ * @internal
+ * Source of the benchmark kernels.
+ * */
+static const char * ccl_devsel_bench_src =
+    "__kernel void ccl_bench_copy(__global const float4 * a,\n"
+    "    __global float4 * b) {\n"
+    "    size_t i = get_global_id(0);\n"
+    "    b[i] = a[i];\n"
+    "}\n"
+    "__kernel void ccl_bench_empty() {\n"
+    "}\n"
+    "__kernel void ccl_bench_fma(__global float * out, float a) {\n"
+    "    float x = (float) get_global_id(0);\n"
+    "    float y = a;\n"
+    "    for (int i = 0; i < 256; ++i) {\n"
+    "        x = mad(x, a, y);\n"
+    "        y = mad(y, a, x);\n"
+    "    }\n"
+    "    out[get_global_id(0)] = x + y;\n"
+    "}\n";
+
+/* Cache of benchmark results, indexed by OpenCL device (lazy
+ * initialized). */
+static GHashTable * bench_cache = NULL;
+
+/* Lock protecting the cache of benchmark results. */
+static GMutex bench_lock;
+
+/**
+ * @internal
+ *
+ * @brief Device and respective benchmark score, used for ranking.
+ * */
+typedef struct ccl_devsel_bench_score {
+
+    /**
+     * Device wrapper.
+     * @private
+     * */
+    CCLDevice * dev;
+
+    /**
+     * Score, higher is better.
+     * @private
+     * */
+    double score;
+
+} CCLDevSelBenchScore;
+
+/**
+ * @internal
+ *
+ * @brief Compare device scores, ordering higher scores first.
+ *
+ * @param[in] a First device score.
+ * @param[in] b Second device score.
+ * @return A negative value if `a` should come before `b`, a positive value
+ * if it should come after `b`, or 0 if they have the same score.
+ * */
+static gint ccl_devsel_bench_score_cmp(gconstpointer a, gconstpointer b) {
+
+    double sa = ((const CCLDevSelBenchScore *) a)->score;
+    double sb = ((const CCLDevSelBenchScore *) b)->score;
+
+    return (sa > sb) ? -1 : ((sa < sb) ? 1 : 0);
+}
+
+/**
+ * @internal
+ *
+ * @brief Execute a kernel a number of times after a warm-up run, and get
+ * the fastest execution time.
+ *
+ * @param[in] krnl Kernel wrapper object, with all arguments set.
+ * @param[in] cq Command queue wrapper object, with profiling enabled.
+ * @param[in] gws Global work size.
+ * @param[out] time Location where to place the fastest device execution
+ * time, in nanoseconds.
+ * @param[out] wall Location where to place the fastest host time, in
+ * microseconds, from enqueuing to completion.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devsel_bench_time(CCLKernel * krnl, CCLQueue * cq,
+    size_t gws, cl_ulong * time, gint64 * wall, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt;
+    cl_ulong tstart, tend;
+    gint64 wstart;
+    cl_bool ret_status;
+
+    *time = CL_ULONG_MAX;
+    *wall = G_MAXINT64;
+
+    /* First execution is a warm-up run, and is not timed. */
+    for (cl_uint t = 0; t <= CCL_DEVSEL_BENCH_TRIALS; ++t) {
+
+        /* Execute kernel and wait for it to finish. */
+        wstart = g_get_monotonic_time();
+        evt = ccl_kernel_enqueue_ndrange(
+            krnl, cq, 1, NULL, &gws, NULL, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Skip warm-up run. */
+        if (t == 0) continue;
+
+        /* Keep fastest times. */
+        *wall = MIN(*wall, g_get_monotonic_time() - wstart);
+        tstart = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        tend = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        *time = MIN(*time, MAX(tend - tstart, 1));
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Run the microbenchmark on a device.
+ *
+ * @param[in] dev Device wrapper object.
+ * @param[out] bench Location where to place benchmark results.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devsel_bench_run(
+    CCLDevice * dev, CCLDevSelBench * bench, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl;
+    CCLBuffer * a = NULL, * b = NULL;
+    const CCLDeviceCaps * caps;
+    size_t size;
+    cl_ulong time;
+    gint64 wall;
+    cl_float mad_a = 0.999f;
+    cl_bool ret_status;
+
+    /* Determine size of bandwidth buffers. */
+    caps = ccl_device_get_caps(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    size = MIN(CCL_DEVSEL_BENCH_BUFSIZE, caps->max_mem_alloc_size / 2);
+    size = MAX(size - size % (4 * sizeof(cl_float)), 4 * sizeof(cl_float));
+
+    /* Create context, profiling queue and program for the device. */
+    ctx = ccl_context_new_from_devices(1, &dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    prg = ccl_program_new_from_source(
+        ctx, ccl_devsel_bench_src, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_program_build(prg, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Memory bandwidth: each work-item reads and writes a float4. */
+    a = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_program_get_kernel(prg, "ccl_bench_copy", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_kernel_set_args(krnl, a, b, NULL);
+    ccl_devsel_bench_time(krnl, cq, size / (4 * sizeof(cl_float)),
+        &time, &wall, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    bench->bandwidth = (2.0 * size) / time;
+
+    /* Launch latency: host time of an empty kernel. */
+    krnl = ccl_program_get_kernel(prg, "ccl_bench_empty", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_devsel_bench_time(krnl, cq, 1, &time, &wall, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    bench->latency = (double) wall;
+
+    /* Compute throughput: dependent multiply-adds, written to buffer a. */
+    ccl_buffer_destroy(a);
+    a = ccl_buffer_new(ctx, CL_MEM_WRITE_ONLY,
+        CCL_DEVSEL_BENCH_COMPUTE_WI * sizeof(cl_float), NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_program_get_kernel(prg, "ccl_bench_fma", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_kernel_set_args(krnl, a, ccl_arg_priv(mad_a, cl_float), NULL);
+    ccl_devsel_bench_time(krnl, cq, CCL_DEVSEL_BENCH_COMPUTE_WI,
+        &time, &wall, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    bench->compute = ((double) CCL_DEVSEL_BENCH_COMPUTE_WI
+        * CCL_DEVSEL_BENCH_COMPUTE_FLOPS) / time;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release benchmark objects. */
+    if (a != NULL) ccl_buffer_destroy(a);
+    if (b != NULL) ccl_buffer_destroy(b);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (cq != NULL) ccl_queue_destroy(cq);
+    if (ctx != NULL) ccl_context_destroy(ctx);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @addtogroup CCL_DEVSEL_BENCH
+ * @{
+ */
+
+/**
+ * Benchmark a device, measuring its global memory bandwidth, kernel
+ * launch latency and compute throughput. The benchmark is only run the
+ * first time this function is called for a device; afterwards, cached
+ * results are returned.
+ *
+ * @param[in] dev Device wrapper object.
+ * @param[out] bench Location where to place benchmark results.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_devsel_bench(
+    CCLDevice * dev, CCLDevSelBench * bench, CCLErr ** err) {
+
+    /* Make sure dev and bench are not NULL. */
+    g_return_val_if_fail(dev != NULL, CL_FALSE);
+    g_return_val_if_fail(bench != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLDevSelBench * cached = NULL;
+    cl_device_id dev_id = ccl_device_unwrap(dev);
+    cl_bool ret_status;
+
+    /* Look for cached results. */
+    g_mutex_lock(&bench_lock);
+    if (bench_cache != NULL)
+        cached = g_hash_table_lookup(bench_cache, dev_id);
+    if (cached != NULL)
+        *bench = *cached;
+    g_mutex_unlock(&bench_lock);
+    if (cached != NULL) return CL_TRUE;
+
+    /* Run benchmark outside the lock, as it can take a while. */
+    ret_status = ccl_devsel_bench_run(dev, bench, err);
+
+    /* Cache results. */
+    if (ret_status) {
+        g_mutex_lock(&bench_lock);
+        if (bench_cache == NULL)
+            bench_cache = g_hash_table_new_full(
+                g_direct_hash, g_direct_equal, NULL, g_free);
+        g_hash_table_replace(
+            bench_cache, dev_id, g_memdup(bench, sizeof(CCLDevSelBench)));
+        g_mutex_unlock(&bench_lock);
+    }
+
+    return ret_status;
+}
+
+/**
+ * Dependent filter function which ranks devices by a benchmark metric,
+ * obtained with ::ccl_devsel_bench(). Devices are sorted from best to
+ * worst, and only the best ones are kept. Devices which cannot be
+ * benchmarked, e.g. due to lack of a compiler, are ranked last.
+ *
+ * @param[in] devices List of device wrappers.
+ * @param[in] data Pointer to a ::CCLDevSelFastest object. If `NULL`,
+ * the device with the highest compute throughput is selected.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The best devices, from best to worst, or `NULL` if an error
+ * occurs.
+ * */
+CCL_EXPORT
+CCLDevSelDevices ccl_devsel_dep_fastest(
+    CCLDevSelDevices devices, void * data, CCLErr ** err) {
+
+    /* Make sure devices is not NULL. */
+    g_return_val_if_fail(devices != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLDevSelFastest dflt = { CCL_DEVSEL_METRIC_COMPUTE, 1 };
+    CCLDevSelFastest * fastest = (data != NULL)
+        ? (CCLDevSelFastest *) data : &dflt;
+    CCLErr * err_internal = NULL;
+    CCLDevSelBench bench;
+    CCLDevSelBenchScore entry;
+    GArray * scores;
+    guint num_keep;
+
+    /* Check metric. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        fastest->metric > CCL_DEVSEL_METRIC_COMPUTE,
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: Unknown benchmark metric.", CCL_STRD);
+
+    /* Score devices. The list keeps its own device references. */
+    scores = g_array_sized_new(
+        FALSE, FALSE, sizeof(CCLDevSelBenchScore), devices->len);
+    for (guint i = 0; i < devices->len; ++i) {
+        entry.dev = (CCLDevice *) g_ptr_array_index(devices, i);
+        entry.score = -G_MAXDOUBLE;
+        if (ccl_devsel_bench(entry.dev, &bench, &err_internal)) {
+            switch (fastest->metric) {
+                case CCL_DEVSEL_METRIC_BANDWIDTH:
+                    entry.score = bench.bandwidth;
+                    break;
+                case CCL_DEVSEL_METRIC_LATENCY:
+                    entry.score = -bench.latency;
+                    break;
+                case CCL_DEVSEL_METRIC_COMPUTE:
+                    entry.score = bench.compute;
+                    break;
+            }
+        } else {
+            g_debug("%s: device could not be benchmarked: %s",
+                CCL_STRD, err_internal->message);
+            g_clear_error(&err_internal);
+        }
+        ccl_device_ref(entry.dev);
+        g_array_append_val(scores, entry);
+    }
+
+    /* Sort devices from best to worst, keeping the best ones. */
+    g_array_sort(scores, ccl_devsel_bench_score_cmp);
+    num_keep = ((fastest->top_k == 0) || (fastest->top_k > scores->len))
+        ? scores->len : fastest->top_k;
+    g_ptr_array_remove_range(devices, 0, devices->len);
+    for (guint i = 0; i < scores->len; ++i) {
+        entry = g_array_index(scores, CCLDevSelBenchScore, i);
+        if (i < num_keep)
+            g_ptr_array_add(devices, entry.dev);
+        else
+            ccl_device_unref(entry.dev);
+    }
+    g_array_free(scores, TRUE);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Free array object containing device wrappers and set it to NULL. */
+    g_ptr_array_free(devices, TRUE);
+    devices = NULL;
+
+finish:
+
+    /* Return filtered devices. */
+    return devices;
+}
+
+/** @} */
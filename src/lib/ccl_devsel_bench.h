@@ -0,0 +1,130 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of the benchmark-ranked device selection filter.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_DEVSEL_BENCH_H_
+#define _CCL_DEVSEL_BENCH_H_
+
+#include "ccl_common.h"
+#include "ccl_device_selector.h"
+
+/**
+ * @defgroup CCL_DEVSEL_BENCH Benchmark-ranked device selection
+ * @ingroup CCL_DEVICE_SELECTOR_DEP_FILTERS
+ *
+ * This module provides the ::ccl_devsel_dep_fastest() dependent filter,
+ * which ranks devices by running a short microbenchmark on each of them,
+ * instead of relying on static device properties. The microbenchmark,
+ * run by ::ccl_devsel_bench(), measures:
+ *
+ * * global memory bandwidth, with a buffer copy kernel;
+ * * launch latency, as the host time to enqueue and complete an empty
+ *   kernel;
+ * * compute throughput, with a kernel of dependent multiply-adds.
+ *
+ * Results are cached per device for the lifetime of the process, so each
+ * device is only benchmarked once, even if the filter is used for several
+ * device selections.
+ *
+ * _Example: create a context with the device with highest memory
+ * bandwidth among all GPUs_
+ *
+ * @code{.c}
+ * CCLDevSelFilters filters = NULL;
+ * CCLDevSelFastest fastest = { CCL_DEVSEL_METRIC_BANDWIDTH, 1 };
+ * @endcode
+ * @code{.c}
+ * ccl_devsel_add_indep_filter(&filters, ccl_devsel_indep_type_gpu, NULL);
+ * ccl_devsel_add_dep_filter(&filters, ccl_devsel_dep_fastest, &fastest);
+ * ctx = ccl_context_new_from_filters(&filters, NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/** Size in bytes of the buffers used to measure memory bandwidth. */
+#define CCL_DEVSEL_BENCH_BUFSIZE (16 << 20)
+
+/** Number of timed runs of each benchmark (the best one is kept). */
+#define CCL_DEVSEL_BENCH_TRIALS 3
+
+/**
+ * Device benchmark metrics.
+ * */
+typedef enum ccl_devsel_metric {
+
+    /** Global memory bandwidth (higher is better). */
+    CCL_DEVSEL_METRIC_BANDWIDTH = 0,
+    /** Kernel launch latency (lower is better). */
+    CCL_DEVSEL_METRIC_LATENCY   = 1,
+    /** Compute throughput (higher is better). */
+    CCL_DEVSEL_METRIC_COMPUTE   = 2
+
+} CCLDevSelMetric;
+
+/**
+ * Results of a device microbenchmark.
+ * */
+typedef struct ccl_devsel_bench {
+
+    /** Global memory bandwidth, in GB/s. */
+    double bandwidth;
+
+    /** Kernel launch latency, in microseconds. */
+    double latency;
+
+    /** Compute throughput, in GFLOP/s. */
+    double compute;
+
+} CCLDevSelBench;
+
+/**
+ * Data for the ::ccl_devsel_dep_fastest() filter.
+ * */
+typedef struct ccl_devsel_fastest {
+
+    /** Metric by which devices are ranked. */
+    CCLDevSelMetric metric;
+
+    /** Number of best devices to keep, or 0 to keep all devices, sorted
+     * from best to worst. */
+    cl_uint top_k;
+
+} CCLDevSelFastest;
+
+/* Benchmark a device, or get its cached benchmark results. */
+CCL_EXPORT
+cl_bool ccl_devsel_bench(
+    CCLDevice * dev, CCLDevSelBench * bench, CCLErr ** err);
+
+/* Dependent filter function which ranks devices by a benchmark metric. */
+CCL_EXPORT
+CCLDevSelDevices ccl_devsel_dep_fastest(
+    CCLDevSelDevices devices, void * data, CCLErr ** err);
+
+/** @} */
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of GLib main loop sources for event completion.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+
+#include "ccl_event_source.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Main loop source which dispatches when events complete.
+ * */
+struct ccl_event_source {
+
+    /**
+     * Parent source.
+     * @private
+     * */
+    GSource source;
+
+    /**
+     * Number of events which have not yet completed.
+     * @private
+     * */
+    gint pending;
+
+    /**
+     * Execution status, `CL_COMPLETE` or the first negative status.
+     * @private
+     * */
+    gint status;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Implementation of the `prepare` and `check` source functions,
+ * which tell if all events have completed.
+ *
+ * @param[in] source The event source.
+ * @return `TRUE` if all events have completed, `FALSE` otherwise.
+ * */
+static gboolean ccl_event_source_ready(GSource * source) {
+
+    struct ccl_event_source * esrc = (struct ccl_event_source *) source;
+
+    return g_atomic_int_get(&esrc->pending) == 0;
+}
+
+/**
+ * @internal
+ *
+ * @brief Implementation of the `prepare` source function.
+ *
+ * @param[in] source The event source.
+ * @param[out] timeout Always -1, since the source is woken up by the event
+ * callbacks.
+ * @return `TRUE` if all events have completed, `FALSE` otherwise.
+ * */
+static gboolean ccl_event_source_prepare(GSource * source, gint * timeout) {
+
+    *timeout = -1;
+    return ccl_event_source_ready(source);
+}
+
+/**
+ * @internal
+ *
+ * @brief Implementation of the `dispatch` source function, which invokes
+ * the ::ccl_event_source_fn callback.
+ *
+ * @param[in] source The event source.
+ * @param[in] callback The ::ccl_event_source_fn callback, if set.
+ * @param[in] user_data User data for the callback.
+ * @return Always `G_SOURCE_REMOVE`, since events only complete once.
+ * */
+static gboolean ccl_event_source_dispatch(
+    GSource * source, GSourceFunc callback, gpointer user_data) {
+
+    struct ccl_event_source * esrc = (struct ccl_event_source *) source;
+
+    if (callback != NULL)
+        ((ccl_event_source_fn) callback)(
+            g_atomic_int_get(&esrc->status), user_data);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Functions of event sources. */
+static GSourceFuncs ccl_event_source_funcs = {
+    ccl_event_source_prepare,
+    ccl_event_source_ready,
+    ccl_event_source_dispatch,
+    NULL, NULL, NULL
+};
+
+#ifdef CL_VERSION_1_1
+
+/**
+ * @internal
+ *
+ * @brief Event callback which updates an event source, waking up its main
+ * context once all events have completed.
+ *
+ * @param[in] event The completed event.
+ * @param[in] status Execution status of `event`.
+ * @param[in] user_data The event source.
+ * */
+static void CL_CALLBACK ccl_event_source_notify(
+    cl_event event, cl_int status, void * user_data) {
+
+    GSource * source = (GSource *) user_data;
+    struct ccl_event_source * esrc = (struct ccl_event_source *) source;
+    GMainContext * context;
+
+    CCL_UNUSED(event);
+
+    /* Keep the first error. */
+    if (status < 0)
+        g_atomic_int_compare_and_exchange(&esrc->status, CL_COMPLETE, status);
+
+    /* Wake up main context if this was the last event. */
+    if (g_atomic_int_dec_and_test(&esrc->pending)
+            && !g_source_is_destroyed(source)) {
+        context = g_source_get_context(source);
+        if (context != NULL) g_main_context_wakeup(context);
+    }
+
+    /* Release the reference held by this callback. */
+    g_source_unref(source);
+}
+
+#endif
+
+/**
+ * @internal
+ *
+ * @brief Create an event source for the given OpenCL events.
+ *
+ * @param[in] num_evts Number of events.
+ * @param[in] evts OpenCL events.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new event source, or `NULL` if an error occurs.
+ * */
+static GSource * ccl_event_source_create(
+    cl_uint num_evts, const cl_event * evts, CCLErr ** err) {
+
+    /* The event source. */
+    GSource * source = NULL;
+
+#ifndef CL_VERSION_1_1
+
+    CCL_UNUSED(num_evts);
+    CCL_UNUSED(evts);
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 1.1, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Event sources require cf4ocl to be deployed with "
+        "support for OpenCL version 1.1 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* OpenCL function return status. */
+    cl_int ocl_status;
+    /* The event source state. */
+    struct ccl_event_source * esrc;
+
+    /* Create source. */
+    source = g_source_new(
+        &ccl_event_source_funcs, sizeof(struct ccl_event_source));
+    g_source_set_name(source, "ccl_event_source");
+    esrc = (struct ccl_event_source *) source;
+    esrc->pending = (gint) num_evts;
+    esrc->status = CL_COMPLETE;
+
+    /* Register a callback for each event, each one holding a reference
+     * to the source. */
+    for (cl_uint i = 0; i < num_evts; ++i) {
+        g_source_ref(source);
+        ocl_status = clSetEventCallback(
+            evts[i], CL_COMPLETE, ccl_event_source_notify, source);
+        if (ocl_status != CL_SUCCESS) g_source_unref(source);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to set event callback (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+    }
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release source, callbacks already set keep their references. */
+    if (source != NULL) g_source_unref(source);
+    source = NULL;
+
+finish:
+
+    /* Return event source. */
+    return source;
+}
+
+/**
+ * @addtogroup CCL_EVENT_SOURCE
+ * @{
+ */
+
+/**
+ * Create a main loop source which dispatches when an event completes. The
+ * source callback, of type ::ccl_event_source_fn, should be set with
+ * `g_source_set_callback()`.
+ *
+ * @public @memberof ccl_event
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] evt Event wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new `GSource`, which should be released with
+ * `g_source_unref()`, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+GSource * ccl_event_source_new(CCLEvent * evt, CCLErr ** err) {
+
+    /* Make sure evt is not NULL. */
+    g_return_val_if_fail(evt != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* OpenCL event. */
+    cl_event event = ccl_event_unwrap(evt);
+
+    return ccl_event_source_create(1, &event, err);
+}
+
+/**
+ * Create a main loop source which dispatches when all events in a wait
+ * list complete. The source callback, of type ::ccl_event_source_fn,
+ * should be set with `g_source_set_callback()`. If the wait list is empty,
+ * the source dispatches on the first main context iteration.
+ *
+ * @public @memberof ccl_event
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in,out] evt_wait_lst Event wait list. The list will be cleared
+ * and can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new `GSource`, which should be released with
+ * `g_source_unref()`, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+GSource * ccl_event_wait_list_source_new(
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* The event source. */
+    GSource * source;
+
+    /* Create source for events in wait list. */
+    source = ccl_event_source_create(
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst), err);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event source. */
+    return source;
+}
+
+/** @} */
@@ -0,0 +1,95 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of GLib main loop sources for event completion.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+
+#ifndef _CCL_EVENT_SOURCE_H_
+#define _CCL_EVENT_SOURCE_H_
+
+#include "ccl_common.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_EVENT_SOURCE Event sources
+ * @ingroup CCL_EVENT_WRAPPER
+ *
+ * This module provides GLib main loop sources (`GSource`) which dispatch
+ * once an event, or all the events in a wait list, complete. These allow
+ * applications built around a `GMainLoop` to handle many commands in
+ * flight from a single thread, without blocking in ::ccl_event_wait().
+ *
+ * Event sources are created with ::ccl_event_source_new() or
+ * ::ccl_event_wait_list_source_new(), and are used as any other `GSource`:
+ * a ::ccl_event_source_fn callback is set with `g_source_set_callback()`,
+ * and the source is attached to a main context with `g_source_attach()`.
+ * The callback is invoked in the main context thread with the execution
+ * status of the events, after which the source is removed. Event sources
+ * require OpenCL >= 1.1.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * gboolean on_read(cl_int status, gpointer user_data) {
+ *     if (status == CL_COMPLETE) reply((struct job *) user_data);
+ *     return G_SOURCE_REMOVE;
+ * }
+ * @endcode
+ * @code{.c}
+ * evt = ccl_buffer_enqueue_read(
+ *     buf, cq, CL_FALSE, 0, size, job->data, NULL, NULL);
+ * src = ccl_event_source_new(evt, NULL);
+ * g_source_set_callback(src, (GSourceFunc) on_read, job, NULL);
+ * g_source_attach(src, NULL);
+ * g_source_unref(src);
+ * @endcode
+ *
+ * @{
+ */
+
+/**
+ * Callback function of event sources.
+ *
+ * @param[in] status Execution status of the events, `CL_COMPLETE` if all
+ * events completed successfully, or the first negative status otherwise.
+ * @param[in] user_data User data given to `g_source_set_callback()`.
+ * @return Ignored, the source is always removed after dispatching, since
+ * events only complete once.
+ * */
+typedef gboolean (*ccl_event_source_fn)(cl_int status, gpointer user_data);
+
+/* Create a main loop source which dispatches when an event completes. */
+CCL_EXPORT
+GSource * ccl_event_source_new(CCLEvent * evt, CCLErr ** err);
+
+/* Create a main loop source which dispatches when all events in a wait
+ * list complete. */
+CCL_EXPORT
+GSource * ccl_event_wait_list_source_new(
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/** @} */
+
+#endif
@@ -28,7 +28,10 @@
 #include "ccl_event_wrapper.h"
 #include "ccl_queue_wrapper.h"
 #include "_ccl_abstract_wrapper.h"
+#include "_ccl_event_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_icd.h"
+#include "_ccl_host_trace.h"
 
 /**
  * Event wrapper class.
@@ -44,11 +47,30 @@ struct ccl_event {
     CCLWrapper base;
 
     /**
-     * Event name, for profiling purposes only.
+     * Event name (interned), for profiling purposes only.
      * @private
      * */
     const char * name;
 
+    /**
+     * User tag, for profiling purposes only.
+     * @private
+     * */
+    char * tag;
+
+    /**
+     * OpenCL events on which the command which produced this event waited,
+     * if recorded, for profiling purposes only.
+     * @private
+     * */
+    cl_event * deps;
+
+    /**
+     * Number of recorded dependencies.
+     * @private
+     * */
+    cl_uint num_deps;
+
 };
 
 /**
@@ -80,6 +102,28 @@ CCLEvent * ccl_event_new_wrap(cl_event event) {
     return evt;
 }
 
+/**
+ * @internal
+ *
+ * @brief Implementation of ccl_wrapper_release_fields() function for
+ * ::CCLEvent wrapper objects.
+ *
+ * @private @memberof ccl_event
+ *
+ * @param[in] evt A ::CCLEvent wrapper object.
+ * */
+static void ccl_event_release_fields(CCLEvent * evt) {
+
+    /* Make sure evt wrapper object is not NULL. */
+    g_return_if_fail(evt != NULL);
+
+    /* Release recorded dependencies. */
+    g_free(evt->deps);
+
+    /* Release user tag. */
+    g_free(evt->tag);
+}
+
 /**
  * Decrements the reference count of the event wrapper object.
  * If it reaches 0, the event wrapper object is destroyed.
@@ -92,7 +136,66 @@ CCL_EXPORT
 void ccl_event_destroy(CCLEvent * evt) {
 
     ccl_wrapper_unref((CCLWrapper *) evt, sizeof(CCLEvent),
-        NULL, (ccl_wrapper_release_cl_object) clReleaseEvent, NULL);
+        (ccl_wrapper_release_fields) ccl_event_release_fields,
+        (ccl_wrapper_release_cl_object) clReleaseEvent, NULL);
+}
+
+/**
+ * @internal
+ *
+ * @brief Record the events in the given wait list as the dependencies of
+ * the command which produced the event, replacing previously recorded
+ * dependencies.
+ *
+ * The dependencies are kept as OpenCL event handles, which are not
+ * retained, and are therefore only useful for identifying events.
+ *
+ * @private @memberof ccl_event
+ *
+ * @param[in] evt The event wrapper object.
+ * @param[in] evt_wait_lst Event wait list with which the command was
+ * enqueued, or `NULL`.
+ * */
+void ccl_event_set_deps(CCLEvent * evt, CCLEventWaitList * evt_wait_lst) {
+
+    /* Make sure evt wrapper object is not NULL. */
+    g_return_if_fail(evt != NULL);
+
+    /* Release previously recorded dependencies. */
+    g_free(evt->deps);
+
+    /* Keep a copy of the events in the wait list. */
+    evt->num_deps = ccl_event_wait_list_get_num_events(evt_wait_lst);
+    evt->deps = (evt->num_deps > 0)
+        ? g_memdup(ccl_event_wait_list_get_clevents(evt_wait_lst),
+            evt->num_deps * sizeof(cl_event))
+        : NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the recorded dependencies of the command which produced the
+ * event.
+ *
+ * @private @memberof ccl_event
+ *
+ * @param[in] evt The event wrapper object.
+ * @param[out] num_deps Location where to place the number of recorded
+ * dependencies.
+ * @return The OpenCL events on which the command waited, or `NULL` if no
+ * dependencies were recorded.
+ * */
+const cl_event * ccl_event_get_deps(CCLEvent * evt, cl_uint * num_deps) {
+
+    /* Make sure evt wrapper object is not NULL. */
+    g_return_val_if_fail(evt != NULL, NULL);
+    /* Make sure num_deps is not NULL. */
+    g_return_val_if_fail(num_deps != NULL, NULL);
+
+    /* Return recorded dependencies. */
+    *num_deps = evt->num_deps;
+    return evt->deps;
 }
 
 /**
@@ -101,6 +204,10 @@ void ccl_event_destroy(CCLEvent * evt) {
  * This is used to distinguish from different event is profiling is to
  * be performed using the @ref CCL_PROFILER "profiler module".
  *
+ * The name is interned with g_intern_string(), so it does not need to
+ * remain valid after this call, and events with equal names share the
+ * same name pointer.
+ *
  * @public @memberof ccl_event
  *
  * @param[in] evt The event wrapper object.
@@ -112,8 +219,8 @@ void ccl_event_set_name(CCLEvent * evt, const char * name) {
     /* Make sure evt wrapper object is not NULL. */
     g_return_if_fail(evt != NULL);
 
-    /* Set event name. */
-    evt->name = name;
+    /* Set event name, interning it. */
+    evt->name = g_intern_string(name);
 }
 
 /**
@@ -138,11 +245,205 @@ const char * ccl_event_get_name(CCLEvent * evt) {
     return evt->name;
 }
 
+/**
+ * Set a user tag of the event, e.g. a request or frame identifier, for
+ * profiling purposes.
+ *
+ * Unlike the event name, the tag does not affect how events are
+ * aggregated. It is kept with the slowest instances of each event name
+ * (see ccl_prof_set_slowest()), so that outliers can be traced back to
+ * their origin. The tag is copied.
+ *
+ * @public @memberof ccl_event
+ *
+ * @param[in] evt The event wrapper object.
+ * @param[in] tag Tag to associate with event, or `NULL` to remove it.
+ * */
+CCL_EXPORT
+void ccl_event_set_tag(CCLEvent * evt, const char * tag) {
+
+    /* Make sure evt wrapper object is not NULL. */
+    g_return_if_fail(evt != NULL);
+
+    /* Replace event tag. */
+    g_free(evt->tag);
+    evt->tag = g_strdup(tag);
+}
+
+/**
+ * Get the user tag of the event, as set with ccl_event_set_tag().
+ *
+ * @public @memberof ccl_event
+ *
+ * @param[in] evt The event wrapper object.
+ * @return Tag associated with event, or `NULL` if no tag was set.
+ * */
+CCL_EXPORT
+const char * ccl_event_get_tag(CCLEvent * evt) {
+
+    /* Make sure evt wrapper object is not NULL. */
+    g_return_val_if_fail(evt != NULL, NULL);
+
+    /* Return event tag. */
+    return evt->tag;
+}
+
+/**
+ * Get the name of the given command type, as used by
+ * ccl_event_get_final_name() for events without an explicitly set name.
+ *
+ * @param[in] ct Command type.
+ * @return Name of command type (e.g. "NDRANGE_KERNEL"), or `NULL` if the
+ * command type is unknown.
+ * */
+CCL_EXPORT
+const char * ccl_event_command_type_name(cl_command_type ct) {
+
+    /* Name to return. */
+    const char * name;
+
+    switch (ct) {
+        case CL_COMMAND_NDRANGE_KERNEL:
+            name = "NDRANGE_KERNEL";
+            break;
+        case CL_COMMAND_NATIVE_KERNEL:
+            name = "NATIVE_KERNEL";
+            break;
+        case CL_COMMAND_READ_BUFFER:
+            name = "READ_BUFFER";
+            break;
+        case CL_COMMAND_WRITE_BUFFER:
+            name = "WRITE_BUFFER";
+            break;
+        case CL_COMMAND_COPY_BUFFER:
+            name = "COPY_BUFFER";
+            break;
+        case CL_COMMAND_READ_IMAGE:
+            name = "READ_IMAGE";
+            break;
+        case CL_COMMAND_WRITE_IMAGE:
+            name = "WRITE_IMAGE";
+            break;
+        case CL_COMMAND_COPY_IMAGE:
+            name = "COPY_IMAGE";
+            break;
+        case CL_COMMAND_COPY_BUFFER_TO_IMAGE:
+            name = "COPY_BUFFER_TO_IMAGE";
+            break;
+        case CL_COMMAND_COPY_IMAGE_TO_BUFFER:
+            name = "COPY_IMAGE_TO_BUFFER";
+            break;
+        case CL_COMMAND_MAP_BUFFER:
+            name = "MAP_BUFFER";
+            break;
+        case CL_COMMAND_MAP_IMAGE:
+            name = "MAP_IMAGE";
+            break;
+        case CL_COMMAND_UNMAP_MEM_OBJECT:
+            name = "UNMAP_MEM_OBJECT";
+            break;
+        case CL_COMMAND_MARKER:
+            name = "MARKER";
+            break;
+        case CL_COMMAND_ACQUIRE_GL_OBJECTS:
+            name = "ACQUIRE_GL_OBJECTS";
+            break;
+        case CL_COMMAND_RELEASE_GL_OBJECTS:
+            name = "RELEASE_GL_OBJECTS";
+            break;
+        case CL_COMMAND_READ_BUFFER_RECT:
+            name = "READ_BUFFER_RECT";
+            break;
+        case CL_COMMAND_WRITE_BUFFER_RECT:
+            name = "WRITE_BUFFER_RECT";
+            break;
+        case CL_COMMAND_COPY_BUFFER_RECT:
+            name = "COPY_BUFFER_RECT";
+            break;
+        case CL_COMMAND_USER:
+            /* This is here just for completeness, as a user
+             * event can't be profiled. */
+            name = "USER";
+            break;
+        case CL_COMMAND_BARRIER:
+            name = "BARRIER";
+            break;
+        case CL_COMMAND_MIGRATE_MEM_OBJECTS:
+            name = "MIGRATE_MEM_OBJECTS";
+            break;
+        case CL_COMMAND_FILL_BUFFER:
+            name = "FILL_BUFFER";
+            break;
+        case CL_COMMAND_FILL_IMAGE:
+            name = "FILL_IMAGE";
+            break;
+        case CL_COMMAND_SVM_FREE:
+            name = "SVM_FREE";
+            break;
+        case CL_COMMAND_SVM_MEMCPY:
+            name = "SVM_MEMCPY";
+            break;
+        case CL_COMMAND_SVM_MEMFILL:
+            name = "SVM_MEMFILL";
+            break;
+        case CL_COMMAND_SVM_MAP:
+            name = "SVM_MAP";
+            break;
+        case CL_COMMAND_SVM_UNMAP:
+            name = "SVM_UNMAP";
+            break;
+        case CL_COMMAND_SVM_MIGRATE_MEM:
+            name = "SVM_MIGRATE_MEM";
+            break;
+        case CL_COMMAND_GL_FENCE_SYNC_OBJECT_KHR:
+            name = "GL_FENCE_SYNC_OBJECT_KHR";
+            break;
+        #if defined(__MSC_VER)
+        case CL_COMMAND_ACQUIRE_D3D10_OBJECTS_KHR:
+            name = "ACQUIRE_D3D10_OBJECTS_KHR";
+            break;
+        case CL_COMMAND_RELEASE_D3D10_OBJECTS_KHR:
+            name = "RELEASE_D3D10_OBJECTS_KHR";
+            break;
+        case CL_COMMAND_ACQUIRE_DX9_MEDIA_SURFACES_KHR:
+            name = "ACQUIRE_DX9_MEDIA_SURFACES_KHR";
+            break;
+        case CL_COMMAND_RELEASE_DX9_MEDIA_SURFACES_KHR:
+            name = "RELEASE_DX9_MEDIA_SURFACES_KHR";
+            break;
+        case CL_COMMAND_ACQUIRE_D3D11_OBJECTS_KHR:
+            name = "ACQUIRE_D3D11_OBJECTS_KHR";
+            break;
+        case CL_COMMAND_RELEASE_D3D11_OBJECTS_KHR:
+            name = "RELEASE_D3D11_OBJECTS_KHR";
+            break;
+        #endif
+        case CL_COMMAND_ACQUIRE_EGL_OBJECTS_KHR:
+            name = "ACQUIRE_EGL_OBJECTS_KHR";
+            break;
+        case CL_COMMAND_RELEASE_EGL_OBJECTS_KHR:
+            name = "RELEASE_EGL_OBJECTS_KHR";
+            break;
+        case CL_COMMAND_EGL_FENCE_SYNC_OBJECT_KHR:
+            name = "EGL_FENCE_SYNC_OBJECT_KHR";
+            break;
+        default:
+            name = NULL;
+            break;
+    }
+
+    /* Return name. */
+    return name;
+}
+
 /**
  * Get the final event name for profiling purposes. If a name was not
  * explicitly set with ccl_event_set_name(), it will return a name
  * based on the type of command associated with the event.
  *
+ * The returned name is always interned, so final names can be compared
+ * by pointer.
+ *
  * This is used to distinguish from different event is profiling is to
  * be performed using the @ref CCL_PROFILER "profiler module".
  *
@@ -183,133 +484,14 @@ const char * ccl_event_get_final_name(CCLEvent * evt) {
             return NULL;
         }
 
-        switch (ct) {
-            case CL_COMMAND_NDRANGE_KERNEL:
-                final_name = "NDRANGE_KERNEL";
-                break;
-            case CL_COMMAND_NATIVE_KERNEL:
-                final_name = "NATIVE_KERNEL";
-                break;
-            case CL_COMMAND_READ_BUFFER:
-                final_name = "READ_BUFFER";
-                break;
-            case CL_COMMAND_WRITE_BUFFER:
-                final_name = "WRITE_BUFFER";
-                break;
-            case CL_COMMAND_COPY_BUFFER:
-                final_name = "COPY_BUFFER";
-                break;
-            case CL_COMMAND_READ_IMAGE:
-                final_name = "READ_IMAGE";
-                break;
-            case CL_COMMAND_WRITE_IMAGE:
-                final_name = "WRITE_IMAGE";
-                break;
-            case CL_COMMAND_COPY_IMAGE:
-                final_name = "COPY_IMAGE";
-                break;
-            case CL_COMMAND_COPY_BUFFER_TO_IMAGE:
-                final_name = "COPY_BUFFER_TO_IMAGE";
-                break;
-            case CL_COMMAND_COPY_IMAGE_TO_BUFFER:
-                final_name = "COPY_IMAGE_TO_BUFFER";
-                break;
-            case CL_COMMAND_MAP_BUFFER:
-                final_name = "MAP_BUFFER";
-                break;
-            case CL_COMMAND_MAP_IMAGE:
-                final_name = "MAP_IMAGE";
-                break;
-            case CL_COMMAND_UNMAP_MEM_OBJECT:
-                final_name = "UNMAP_MEM_OBJECT";
-                break;
-            case CL_COMMAND_MARKER:
-                final_name = "MARKER";
-                break;
-            case CL_COMMAND_ACQUIRE_GL_OBJECTS:
-                final_name = "ACQUIRE_GL_OBJECTS";
-                break;
-            case CL_COMMAND_RELEASE_GL_OBJECTS:
-                final_name = "RELEASE_GL_OBJECTS";
-                break;
-            case CL_COMMAND_READ_BUFFER_RECT:
-                final_name = "READ_BUFFER_RECT";
-                break;
-            case CL_COMMAND_WRITE_BUFFER_RECT:
-                final_name = "WRITE_BUFFER_RECT";
-                break;
-            case CL_COMMAND_COPY_BUFFER_RECT:
-                final_name = "COPY_BUFFER_RECT";
-                break;
-            case CL_COMMAND_USER:
-                /* This is here just for completeness, as a user
-                 * event can't be profiled. */
-                final_name = "USER";
-                break;
-            case CL_COMMAND_BARRIER:
-                final_name = "BARRIER";
-                break;
-            case CL_COMMAND_MIGRATE_MEM_OBJECTS:
-                final_name = "MIGRATE_MEM_OBJECTS";
-                break;
-            case CL_COMMAND_FILL_BUFFER:
-                final_name = "FILL_BUFFER";
-                break;
-            case CL_COMMAND_FILL_IMAGE:
-                final_name = "FILL_IMAGE";
-                break;
-            case CL_COMMAND_SVM_FREE:
-                final_name = "SVM_FREE";
-                break;
-            case CL_COMMAND_SVM_MEMCPY:
-                final_name = "SVM_MEMCPY";
-                break;
-            case CL_COMMAND_SVM_MEMFILL:
-                final_name = "SVM_MEMFILL";
-                break;
-            case CL_COMMAND_SVM_MAP:
-                final_name = "SVM_MAP";
-                break;
-            case CL_COMMAND_SVM_UNMAP:
-                final_name = "SVM_UNMAP";
-                break;
-            case CL_COMMAND_GL_FENCE_SYNC_OBJECT_KHR:
-                final_name = "GL_FENCE_SYNC_OBJECT_KHR";
-                break;
-            #if defined(__MSC_VER)
-            case CL_COMMAND_ACQUIRE_D3D10_OBJECTS_KHR:
-                final_name = "ACQUIRE_D3D10_OBJECTS_KHR";
-                break;
-            case CL_COMMAND_RELEASE_D3D10_OBJECTS_KHR:
-                final_name = "RELEASE_D3D10_OBJECTS_KHR";
-                break;
-            case CL_COMMAND_ACQUIRE_DX9_MEDIA_SURFACES_KHR:
-                final_name = "ACQUIRE_DX9_MEDIA_SURFACES_KHR";
-                break;
-            case CL_COMMAND_RELEASE_DX9_MEDIA_SURFACES_KHR:
-                final_name = "RELEASE_DX9_MEDIA_SURFACES_KHR";
-                break;
-            case CL_COMMAND_ACQUIRE_D3D11_OBJECTS_KHR:
-                final_name = "ACQUIRE_D3D11_OBJECTS_KHR";
-                break;
-            case CL_COMMAND_RELEASE_D3D11_OBJECTS_KHR:
-                final_name = "RELEASE_D3D11_OBJECTS_KHR";
-                break;
-            #endif
-            case CL_COMMAND_ACQUIRE_EGL_OBJECTS_KHR:
-                final_name = "ACQUIRE_EGL_OBJECTS_KHR";
-                break;
-            case CL_COMMAND_RELEASE_EGL_OBJECTS_KHR:
-                final_name = "RELEASE_EGL_OBJECTS_KHR";
-                break;
-            case CL_COMMAND_EGL_FENCE_SYNC_OBJECT_KHR:
-                final_name = "EGL_FENCE_SYNC_OBJECT_KHR";
-                break;
-            default:
-                final_name = "UNKNOWN";
-                g_warning("Unknown event command type: 0x%x", ct);
-                break;
+        final_name = ccl_event_command_type_name(ct);
+        if (final_name == NULL) {
+            final_name = "UNKNOWN";
+            g_warning("Unknown event command type: 0x%x", ct);
         }
+
+        /* Intern name, so that it can be compared by pointer. */
+        final_name = g_intern_static_string(final_name);
     }
 
     /* Return final name. */
@@ -431,6 +613,80 @@ finish:
     return ocl_ver;
 }
 
+/**
+ * Get the four profiling instants of the command which fired the given
+ * event, i.e. when it was queued, submitted, started and ended, with as
+ * few calls as possible.
+ *
+ * The completion instant of the command, including child commands it
+ * enqueued in on-device queues (`CL_PROFILING_COMMAND_COMPLETE`), is also
+ * fetched if available, and is otherwise set to the end instant.
+ *
+ * Unlike ::ccl_event_get_profiling_info_scalar(), this function queries
+ * OpenCL directly and does not keep the values in the information cache
+ * of the event wrapper. The command queue must have been created with
+ * the `CL_QUEUE_PROFILING_ENABLE` property, and the command must have
+ * completed.
+ *
+ * @public @memberof ccl_event
+ *
+ * @param[in] evt An event wrapper object.
+ * @param[out] timings Location where to place the profiling instants.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_event_get_timings(
+    CCLEvent * evt, CCLEventTimings * timings, CCLErr ** err) {
+
+    /* Make sure evt and timings are not NULL. */
+    g_return_val_if_fail(evt != NULL, CL_FALSE);
+    g_return_val_if_fail(timings != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Profiling instants to fetch, in the order of the timings struct. */
+    static const cl_profiling_info params[] = {
+        CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_SUBMIT,
+        CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END };
+    cl_ulong * instants[] = {
+        &timings->queued, &timings->submit, &timings->start, &timings->end };
+    /* OpenCL status. */
+    cl_int ocl_status;
+
+    /* Fetch instants. */
+    for (guint i = 0; i < 4; ++i) {
+        ocl_status = clGetEventProfilingInfo(ccl_event_unwrap(evt),
+            params[i], sizeof(cl_ulong), instants[i], NULL);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error in clGetEventProfilingInfo() (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+    }
+
+    /* Fetch completion instant of child commands, not available before
+     * OpenCL 2.0. */
+    timings->complete = timings->end;
+#ifdef CL_VERSION_2_0
+    if (clGetEventProfilingInfo(ccl_event_unwrap(evt),
+        CL_PROFILING_COMMAND_COMPLETE, sizeof(cl_ulong), &timings->complete,
+        NULL) != CL_SUCCESS)
+        timings->complete = timings->end;
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
 /**
  * Wrapper for OpenCL clSetEventCallback() function.
  *
@@ -698,6 +954,172 @@ finish:
     return ret_status;
 }
 
+/* Maximum number of cleared event wait lists kept per thread. */
+#define CCL_EVENT_WAIT_LIST_POOL_SIZE 16
+
+/* Cleared event wait lists with heap storage larger than this number
+ * of events give back their heap storage before being pooled. */
+#define CCL_EVENT_WAIT_LIST_MAX_KEPT 256
+
+/**
+ * @internal
+ *
+ * @brief Per-thread pool of cleared event wait lists.
+ * */
+struct ccl_event_wait_list_pool {
+
+    /**
+     * First list in pool.
+     * @private
+     * */
+    CCLEventWaitList first;
+
+    /**
+     * Number of lists in pool.
+     * @private
+     * */
+    guint num_lists;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Release the storage of an event wait list.
+ *
+ * @param[in] ewl Event wait list to release.
+ * */
+static void ccl_event_wait_list_free(CCLEventWaitList ewl) {
+
+    if (ewl->evts != ewl->inline_evts)
+        g_free(ewl->evts);
+    g_slice_free(struct ccl_event_wait_list, ewl);
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the pooled event wait lists of a thread. Called when a
+ * thread which cleared event wait lists terminates.
+ *
+ * @param[in] data The ::ccl_event_wait_list_pool of the terminating
+ * thread.
+ * */
+static void ccl_event_wait_list_pool_release(gpointer data) {
+
+    struct ccl_event_wait_list_pool * pool =
+        (struct ccl_event_wait_list_pool *) data;
+
+    while (pool->first != NULL) {
+        CCLEventWaitList ewl = pool->first;
+        pool->first = ewl->next;
+        ccl_event_wait_list_free(ewl);
+    }
+    g_slice_free(struct ccl_event_wait_list_pool, pool);
+}
+
+/* Per-thread pools of cleared event wait lists. */
+static GPrivate ewl_pool = G_PRIVATE_INIT(ccl_event_wait_list_pool_release);
+
+/**
+ * @internal
+ *
+ * @brief Get an empty event wait list, reusing a pooled one from the
+ * current thread if available.
+ *
+ * @return An empty event wait list.
+ * */
+static CCLEventWaitList ccl_event_wait_list_new() {
+
+    struct ccl_event_wait_list_pool * pool = g_private_get(&ewl_pool);
+    CCLEventWaitList ewl;
+
+    if ((pool != NULL) && (pool->first != NULL)) {
+
+        /* Reuse pooled list, keeping its storage. */
+        ewl = pool->first;
+        pool->first = ewl->next;
+        pool->num_lists--;
+
+    } else {
+
+        /* Create new list with inline storage. */
+        ewl = g_slice_new(struct ccl_event_wait_list);
+        ewl->capacity = CCL_EVENT_WAIT_LIST_INLINE_SIZE;
+        ewl->evts = ewl->inline_evts;
+
+    }
+
+    ewl->num_evts = 0;
+    ewl->next = NULL;
+
+    return ewl;
+}
+
+/**
+ * @internal
+ *
+ * @brief Return an event wait list to the pool of the current thread,
+ * or release it if the pool is full.
+ *
+ * @param[in] ewl Event wait list to recycle.
+ * */
+static void ccl_event_wait_list_recycle(CCLEventWaitList ewl) {
+
+    struct ccl_event_wait_list_pool * pool = g_private_get(&ewl_pool);
+
+    /* Create pool for current thread if necessary. */
+    if (pool == NULL) {
+        pool = g_slice_new0(struct ccl_event_wait_list_pool);
+        g_private_set(&ewl_pool, pool);
+    }
+
+    /* Release list if pool is already full. */
+    if (pool->num_lists >= CCL_EVENT_WAIT_LIST_POOL_SIZE) {
+        ccl_event_wait_list_free(ewl);
+        return;
+    }
+
+    /* Don't hold on to unusually large heap storage. */
+    if (ewl->capacity > CCL_EVENT_WAIT_LIST_MAX_KEPT) {
+        g_free(ewl->evts);
+        ewl->evts = ewl->inline_evts;
+        ewl->capacity = CCL_EVENT_WAIT_LIST_INLINE_SIZE;
+    }
+
+    ewl->next = pool->first;
+    pool->first = ewl;
+    pool->num_lists++;
+}
+
+/**
+ * @internal
+ *
+ * @brief Append an OpenCL event to an event wait list, moving the list
+ * to heap storage or growing it if it's full.
+ *
+ * @param[in] ewl Event wait list.
+ * @param[in] clevt OpenCL event to append.
+ * */
+static void ccl_event_wait_list_append(CCLEventWaitList ewl,
+    cl_event clevt) {
+
+    if (ewl->num_evts == ewl->capacity) {
+
+        /* Double capacity. */
+        ewl->capacity *= 2;
+        if (ewl->evts == ewl->inline_evts) {
+            ewl->evts = g_new(cl_event, ewl->capacity);
+            memcpy(ewl->evts, ewl->inline_evts,
+                ewl->num_evts * sizeof(cl_event));
+        } else {
+            ewl->evts = g_renew(cl_event, ewl->evts, ewl->capacity);
+        }
+    }
+
+    ewl->evts[ewl->num_evts++] = clevt;
+}
+
 /**
  * Add event wrapper objects to an event wait list (variable argument
  * list version).
@@ -721,7 +1143,7 @@ CCLEventWaitList * ccl_event_wait_list_add(
 
     /* Initialize list if required. */
     if (*evt_wait_lst == NULL)
-        *evt_wait_lst = g_ptr_array_new();
+        *evt_wait_lst = ccl_event_wait_list_new();
 
     /* Initialize variable argument list. */
     va_start(al, evt_wait_lst);
@@ -729,8 +1151,8 @@ CCLEventWaitList * ccl_event_wait_list_add(
     /* Get arguments (i.e. event wrapper objects). */
     while ((evt = va_arg(al, CCLEvent *)) != NULL) {
 
-        /* Add event wrapper to array. */
-        g_ptr_array_add(*evt_wait_lst, ccl_event_unwrap(evt));
+        /* Add wrapped cl_event to list. */
+        ccl_event_wait_list_append(*evt_wait_lst, ccl_event_unwrap(evt));
 
     }
 
@@ -738,12 +1160,42 @@ CCLEventWaitList * ccl_event_wait_list_add(
     va_end(al);
 
     /* Signal bug if no events have been given. */
-    g_return_val_if_fail((*evt_wait_lst)->len > 0, NULL);
+    g_return_val_if_fail((*evt_wait_lst)->num_evts > 0, NULL);
 
     /* Return event wait list. */
     return evt_wait_lst;
 }
 
+/**
+ * @internal
+ *
+ * @brief Add the events in an event wait list to another event wait
+ * list, leaving the former unchanged, e.g. so that the same dependencies
+ * can be used by commands enqueued in several queues.
+ *
+ * @param[out] dst Event wait list to which events are added.
+ * @param[in] src Event wait list whose events are added, or `NULL`.
+ * @return `dst` if it contains events, or `NULL` otherwise, so that the
+ * return value can be passed directly to `ccl_*_enqueue_*()` functions.
+ * */
+CCLEventWaitList * ccl_event_wait_list_copy(
+    CCLEventWaitList * dst, CCLEventWaitList * src) {
+
+    /* Check that dst is not NULL. */
+    g_return_val_if_fail(dst != NULL, NULL);
+
+    /* Append events of source list, if any. */
+    if ((src != NULL) && (*src != NULL)) {
+        if (*dst == NULL)
+            *dst = ccl_event_wait_list_new();
+        for (cl_uint i = 0; i < (*src)->num_evts; ++i)
+            ccl_event_wait_list_append(*dst, (*src)->evts[i]);
+    }
+
+    /* Return event wait list, or NULL if empty. */
+    return (*dst != NULL) && ((*dst)->num_evts > 0) ? dst : NULL;
+}
+
 /**
  * Add event wrapper objects to an event wait list (array version).
  *
@@ -766,13 +1218,13 @@ CCLEventWaitList * ccl_event_wait_list_add_v(
 
     /* Initialize list if required. */
     if (*evt_wait_lst == NULL)
-        *evt_wait_lst = g_ptr_array_new();
+        *evt_wait_lst = ccl_event_wait_list_new();
 
     /* Cycle through array of event wrapper objects. */
     for (guint i = 0; evts[i] != NULL; ++i) {
 
-        /* Add wrapped cl_event to array. */
-        g_ptr_array_add(*evt_wait_lst, ccl_event_unwrap(evts[i]));
+        /* Add wrapped cl_event to list. */
+        ccl_event_wait_list_append(*evt_wait_lst, ccl_event_unwrap(evts[i]));
 
     }
 
@@ -785,7 +1237,8 @@ CCLEventWaitList * ccl_event_wait_list_add_v(
  *
  * This function will rarely be called from client code because event
  * wait lists are automatically cleared when passed to
- * `ccl_*_enqueue_*()` functions.
+ * `ccl_*_enqueue_*()` functions. The list storage is kept in a
+ * per-thread pool for reuse by subsequent additions.
  *
  * @param[out] evt_wait_lst Event wait list.
  * */
@@ -793,43 +1246,333 @@ CCL_EXPORT
 void ccl_event_wait_list_clear(CCLEventWaitList * evt_wait_lst) {
 
     if ((evt_wait_lst != NULL) && (*evt_wait_lst != NULL)) {
-        g_ptr_array_free(*evt_wait_lst, TRUE);
+        ccl_event_wait_list_recycle(*evt_wait_lst);
         *evt_wait_lst = NULL;
     }
 }
 
 /**
- * Waits on the host thread for commands identified by events
- * in the wait list to complete. This function is a wrapper for the
- * clWaitForEvents() OpenCL function.
+ * @internal
+ *
+ * @brief Check if an OpenCL event has finished, i.e. if its command has
+ * completed or was abnormally terminated. The execution status is queried
+ * directly, bypassing the information cache of event wrappers.
+ *
+ * @param[in] clevt OpenCL event.
+ * @param[out] ocl_status Location where to put the status of the query.
+ * @return `CL_TRUE` if the event has finished, `CL_FALSE` if it has not
+ * or if the query failed.
+ * */
+static cl_bool ccl_event_wait_list_finished(cl_event clevt,
+    cl_int * ocl_status) {
+
+    cl_int exec_status;
+
+    *ocl_status = ccl_icd_clGetEventInfo(clevt,
+        CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &exec_status,
+        NULL);
+    return (*ocl_status == CL_SUCCESS) && (exec_status <= CL_COMPLETE);
+}
+
+/**
+ * Check which events in an event wait list have finished, without
+ * blocking and without changing the list.
+ *
+ * The execution status of each event is queried directly, bypassing the
+ * information cache of event wrappers, so that polling many events
+ * repeatedly does not grow the cache. Events whose commands were
+ * abnormally terminated are also considered finished; their status can be
+ * checked with ::ccl_event_get_info_scalar().
+ *
+ * @param[in] evt_wait_lst Event wait list, which may be empty.
+ * @param[out] finished Array with at least as many elements as there are
+ * events in the list, where the finished state of each event is placed,
+ * in the order in which events were added, or `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Number of finished events in the list, or 0 if an error occurs.
+ * */
+CCL_EXPORT
+cl_uint ccl_event_wait_list_poll(CCLEventWaitList * evt_wait_lst,
+    cl_bool * finished, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+    cl_uint num_evts = ccl_event_wait_list_get_num_events(evt_wait_lst);
+    cl_uint num_finished = 0;
+    cl_int ocl_status;
+    cl_bool done;
+
+    for (cl_uint i = 0; i < num_evts; ++i) {
+
+        done = ccl_event_wait_list_finished(
+            (*evt_wait_lst)->evts[i], &ocl_status);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error while polling events (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+        if (finished != NULL) finished[i] = done;
+        if (done) num_finished++;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return num_finished;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return 0;
+}
+
+/**
+ * Remove finished events from an event wait list, keeping the order of
+ * the remaining events, so that drivers get shorter dependency lists. If
+ * no events remain, the list is cleared.
+ *
+ * Events which completed successfully are removed. Events whose commands
+ * were abnormally terminated, or whose status cannot be queried, are kept,
+ * so that the command which waits on them fails as it would otherwise.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, NULL,
+ *     ccl_event_wait_list_prune(&ewl), NULL);
+ * @endcode
+ *
+ * @param[in,out] evt_wait_lst Event wait list.
+ * @return `evt_wait_lst` if it still contains events, or `NULL` otherwise,
+ * so that the return value can be passed directly to `ccl_*_enqueue_*()`
+ * functions.
+ * */
+CCL_EXPORT
+CCLEventWaitList * ccl_event_wait_list_prune(
+    CCLEventWaitList * evt_wait_lst) {
+
+    cl_uint num_evts = ccl_event_wait_list_get_num_events(evt_wait_lst);
+    cl_uint num_kept = 0;
+    cl_int exec_status;
+    cl_event clevt;
+
+    for (cl_uint i = 0; i < num_evts; ++i) {
+        clevt = (*evt_wait_lst)->evts[i];
+        if ((ccl_icd_clGetEventInfo(clevt,
+                CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int),
+                &exec_status, NULL) != CL_SUCCESS)
+                || (exec_status != CL_COMPLETE))
+            (*evt_wait_lst)->evts[num_kept++] = clevt;
+    }
+
+    if (num_kept == 0) {
+        ccl_event_wait_list_clear(evt_wait_lst);
+        return NULL;
+    }
+    (*evt_wait_lst)->num_evts = num_kept;
+    return evt_wait_lst;
+}
+
+/* Default spin-polling time of ccl_event_wait(), in microseconds. */
+static cl_ulong event_wait_spin_usec = 0;
+
+/**
+ * @internal
+ *
+ * @brief Poll the execution status of the events in an array, moving
+ * completed events to the end of the array.
+ *
+ * @param[in,out] evts Array of OpenCL events.
+ * @param[in,out] num_evts Number of events in `evts` which have not yet
+ * completed.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if no errors occurred, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_event_wait_poll(
+    cl_event * evts, cl_uint * num_evts, CCLErr ** err) {
+
+    /* OpenCL status. */
+    cl_int ocl_status;
+    /* Execution status of current event. */
+    cl_int exec_status;
+    /* Auxiliary event for swapping. */
+    cl_event evt_aux;
+
+    for (cl_uint i = 0; i < *num_evts; ) {
+
+        /* Get execution status of current event. */
+        ocl_status = ccl_icd_clGetEventInfo(evts[i],
+            CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int),
+            &exec_status, NULL);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error while polling events (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+        /* Failed commands are reported like clWaitForEvents() does. */
+#ifdef CL_VERSION_1_1
+        ocl_status = CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST;
+#else
+        ocl_status = exec_status;
+#endif
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            exec_status < 0, ocl_status, error_handler,
+            "%s: error while waiting for events (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+        if (exec_status == CL_COMPLETE) {
+            /* Move completed event to the end of the array. */
+            (*num_evts)--;
+            evt_aux = evts[i];
+            evts[i] = evts[*num_evts];
+            evts[*num_evts] = evt_aux;
+        } else {
+            i++;
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Flush the command queues of the given events, ignoring errors.
+ * User events, which have no queue, are skipped.
+ *
+ * @param[in] evts Array of OpenCL events.
+ * @param[in] num_evts Number of events in `evts`.
+ * */
+static void ccl_event_wait_flush(const cl_event * evts, cl_uint num_evts) {
+
+    cl_command_queue cq, cq_prev = NULL;
+
+    for (cl_uint i = 0; i < num_evts; ++i) {
+        if ((ccl_icd_clGetEventInfo(evts[i], CL_EVENT_COMMAND_QUEUE,
+                sizeof(cl_command_queue), &cq, NULL) == CL_SUCCESS)
+                && (cq != NULL) && (cq != cq_prev)) {
+            clFlush(cq);
+            cq_prev = cq;
+        }
+    }
+}
+
+/**
+ * Waits on the host thread for commands identified by events in the wait
+ * list to complete, first spin-polling the execution status of the events
+ * and then blocking, optionally with a timeout.
+ *
+ * Spin-polling avoids the wakeup latency of blocking waits in some OpenCL
+ * implementations, which may be larger than the execution time of short
+ * commands, at the cost of keeping the host thread busy. If the commands
+ * did not complete during the spin-polling phase, the function blocks with
+ * clWaitForEvents() if no timeout is given, or polls with increasing sleep
+ * intervals, up to one millisecond, until the timeout expires.
  *
  * @param[in,out] evt_wait_lst List of events that need to complete
  * before this command can be executed. The list will be cleared and
  * can be reused by client code.
+ * @param[in] spin_usec Maximum time to spin-poll, in microseconds.
+ * @param[in] timeout_usec Maximum time to wait, in microseconds, or a
+ * negative value to wait indefinitely. If the commands don't complete in
+ * time, a ::CCL_ERROR_TIMEOUT error is reported.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
  * @return `CL_TRUE` if operation is successful, or `CL_FALSE`
  * otherwise.
  * */
 CCL_EXPORT
-cl_bool ccl_event_wait(CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+cl_bool ccl_event_wait_full(CCLEventWaitList * evt_wait_lst,
+    cl_ulong spin_usec, cl_long timeout_usec, CCLErr ** err) {
 
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL status. */
     cl_int ocl_status;
     /* Function return status. */
     cl_bool ret_status;
+    /* Number of events in wait list. */
+    cl_uint num_total = ccl_event_wait_list_get_num_events(evt_wait_lst);
+    /* Events which have not yet completed. */
+    cl_uint num_evts = num_total;
+    cl_event * evts = NULL;
+    /* Start time, spin-polling deadline and time out deadline. */
+    gint64 start, spin_end, timeout_end;
+    /* Sleep interval between polls after spin-polling. */
+    gulong sleep_usec = 1;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Without spin-polling nor timeout (or without events, for which
+     * clWaitForEvents() reports an error), simply wait for events. */
+    if ((num_evts == 0) || ((spin_usec == 0) && (timeout_usec < 0))) {
+        ocl_status = clWaitForEvents(
+            num_evts, ccl_event_wait_list_get_clevents(evt_wait_lst));
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error while waiting for events (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+        goto success;
+    }
 
-    /* OpenCL wait for events. */
-    ocl_status = clWaitForEvents(
-        ccl_event_wait_list_get_num_events(evt_wait_lst),
+    /* Copy events, since completed ones are moved around. */
+    evts = g_slice_copy(num_total * sizeof(cl_event),
         ccl_event_wait_list_get_clevents(evt_wait_lst));
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: error while waiting for events (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Unlike clWaitForEvents(), polling doesn't flush the queues of the
+     * events, whose commands might not even have been submitted yet. */
+    ccl_event_wait_flush(evts, num_evts);
+
+    /* Determine deadlines. */
+    start = g_get_monotonic_time();
+    spin_end = start + (gint64) spin_usec;
+    timeout_end = start + timeout_usec;
+    if ((timeout_usec >= 0) && (timeout_end < spin_end))
+        spin_end = timeout_end;
+
+    /* Spin-poll. */
+    do {
+        ccl_event_wait_poll(evts, &num_evts, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    } while ((num_evts > 0) && (g_get_monotonic_time() < spin_end));
+
+    /* Block if there is no timeout. */
+    if ((num_evts > 0) && (timeout_usec < 0)) {
+        ocl_status = clWaitForEvents(num_evts, evts);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error while waiting for events (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+        num_evts = 0;
+    }
+
+    /* Otherwise, poll with increasing sleeps until the timeout. */
+    while ((num_evts > 0) && (g_get_monotonic_time() < timeout_end)) {
+        g_usleep(sleep_usec);
+        if (sleep_usec < 1000) sleep_usec *= 2;
+        ccl_event_wait_poll(evts, &num_evts, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+    ccl_if_err_create_goto(*err, CCL_ERROR, num_evts > 0,
+        CCL_ERROR_TIMEOUT, error_handler,
+        "%s: timed out while waiting for events.", CCL_STRD);
+
+success:
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -843,11 +1586,57 @@ error_handler:
 
 finish:
 
+    /* Release copy of events. */
+    if (evts != NULL)
+        g_slice_free1(num_total * sizeof(cl_event), evts);
+
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return status. */
     return ret_status;
 }
 
+/**
+ * Set the time ::ccl_event_wait() spin-polls the execution status of
+ * events before blocking. By default, ::ccl_event_wait() blocks
+ * immediately.
+ *
+ * @attention This function is not thread-safe and should be called before
+ * any waits are performed.
+ *
+ * @param[in] spin_usec Maximum time to spin-poll, in microseconds, or
+ * zero for blocking immediately.
+ * */
+CCL_EXPORT
+void ccl_event_wait_set_spin_time(cl_ulong spin_usec) {
+
+    event_wait_spin_usec = spin_usec;
+}
+
+/**
+ * Waits on the host thread for commands identified by events
+ * in the wait list to complete. This function is a wrapper for the
+ * clWaitForEvents() OpenCL function, preceded by a spin-polling phase if
+ * set with ::ccl_event_wait_set_spin_time().
+ *
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_event_wait(CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Wait for events, without timeout. */
+    return ccl_event_wait_full(
+        evt_wait_lst, event_wait_spin_usec, -1, err);
+}
+
 /** @} */
@@ -72,6 +72,9 @@
  * * ::ccl_event_get_profiling_info_array()
  * * ::ccl_event_get_profiling_info()
  *
+ * The four profiling instants of a command can also be obtained at once,
+ * without being cached, with ::ccl_event_get_timings().
+ *
  * @{
  */
 
@@ -89,6 +92,31 @@
 typedef void (CL_CALLBACK * ccl_event_callback)(cl_event event,
     cl_int event_command_exec_status, void * user_data);
 
+/**
+ * Profiling instants of a command, in nanoseconds, as returned by
+ * ::ccl_event_get_timings().
+ * */
+typedef struct ccl_event_timings {
+
+    /** When the command was enqueued by the host. */
+    cl_ulong queued;
+
+    /** When the command was submitted to the device. */
+    cl_ulong submit;
+
+    /** When the command started executing. */
+    cl_ulong start;
+
+    /** When the command finished executing. */
+    cl_ulong end;
+
+    /** When the command and all child commands it enqueued in on-device
+     * queues finished executing (OpenCL >= 2.0), or `end` if not
+     * available. */
+    cl_ulong complete;
+
+} CCLEventTimings;
+
 /* Get the event wrapper for the given OpenCL event. */
 CCL_EXPORT
 CCLEvent * ccl_event_new_wrap(cl_event event);
@@ -105,6 +133,18 @@ void ccl_event_set_name(CCLEvent * evt, const char * name);
 CCL_EXPORT
 const char * ccl_event_get_name(CCLEvent * evt);
 
+/* Set a user tag of the event for profiling purposes. */
+CCL_EXPORT
+void ccl_event_set_tag(CCLEvent * evt, const char * tag);
+
+/* Get the user tag of the event. */
+CCL_EXPORT
+const char * ccl_event_get_tag(CCLEvent * evt);
+
+/* Get the name of the given command type. */
+CCL_EXPORT
+const char * ccl_event_command_type_name(cl_command_type ct);
+
 /* Get the final event name for profiling purposes. */
 CCL_EXPORT
 const char * ccl_event_get_final_name(CCLEvent * evt);
@@ -117,6 +157,12 @@ cl_command_type ccl_event_get_command_type(CCLEvent * evt, CCLErr ** err);
 CCL_EXPORT
 cl_uint ccl_event_get_opencl_version(CCLEvent * evt, CCLErr ** err);
 
+/* Get the profiling instants of the command which fired the given event,
+ * without caching them. */
+CCL_EXPORT
+cl_bool ccl_event_get_timings(
+    CCLEvent * evt, CCLEventTimings * timings, CCLErr ** err);
+
 /* Wrapper for OpenCL clSetEventCallback() function. */
 CCL_EXPORT
 cl_bool ccl_event_set_callback(CCLEvent * evt,
@@ -168,7 +214,7 @@ cl_bool ccl_user_event_set_status(
  * If an error occurs, zero is returned.
  * */
 #define ccl_event_get_info_scalar(evt, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) evt, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) evt, \
         NULL, param_name, sizeof(param_type), CCL_INFO_EVENT, CL_FALSE, err))
 
 /**
@@ -230,7 +276,7 @@ cl_bool ccl_user_event_set_status(
  * If an error occurs, zero is returned.
  * */
 #define ccl_event_get_profiling_info_scalar(evt, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) evt, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) evt, \
         NULL, param_name, sizeof(param_type), \
         CCL_INFO_EVENT_PROFILING, CL_FALSE, err))
 
@@ -302,6 +348,19 @@ cl_bool ccl_user_event_set_status(
  * wait lists should be freed with the ::ccl_event_wait_list_clear()
  * function.
  *
+ * Event wait lists store up to ::CCL_EVENT_WAIT_LIST_INLINE_SIZE
+ * events inline, only resorting to heap storage for larger lists.
+ * Cleared wait lists are kept in a small per-thread pool and reused by
+ * the next ::ccl_event_wait_list_add() or ::ccl_event_wait_list_add_v()
+ * call, so the usual populate-consume cycle does not allocate memory.
+ *
+ * ::ccl_event_wait_list_poll() checks which events in a wait list have
+ * finished without blocking, querying their execution status directly
+ * instead of through the information cache of event wrappers.
+ * ::ccl_event_wait_list_prune() removes completed events from a wait list
+ * before it is passed to an enqueue function, so that drivers get shorter
+ * dependency lists.
+ *
  * _Example 1:_
  *
  * ```c
@@ -339,8 +398,50 @@ cl_bool ccl_user_event_set_status(
  * @{
  */
 
+/** Number of events stored inline in an event wait list. */
+#define CCL_EVENT_WAIT_LIST_INLINE_SIZE 8
+
+/**
+ * Event wait list storage. Client code should only access it through
+ * the ::CCLEventWaitList type and the `ccl_event_wait_list_*()`
+ * functions and macros.
+ * */
+struct ccl_event_wait_list {
+
+    /**
+     * Number of events in list.
+     * @private
+     * */
+    cl_uint num_evts;
+
+    /**
+     * Number of events which fit in the current storage.
+     * @private
+     * */
+    cl_uint capacity;
+
+    /**
+     * OpenCL events, points to `inline_evts` or to heap storage.
+     * @private
+     * */
+    cl_event * evts;
+
+    /**
+     * Next list in the per-thread pool of cleared lists.
+     * @private
+     * */
+    struct ccl_event_wait_list * next;
+
+    /**
+     * Inline storage for small lists.
+     * @private
+     * */
+    cl_event inline_evts[CCL_EVENT_WAIT_LIST_INLINE_SIZE];
+
+};
+
 /** A list of event objects on which enqueued commands can wait. */
-typedef GPtrArray * CCLEventWaitList;
+typedef struct ccl_event_wait_list * CCLEventWaitList;
 
 /**
  * Alias the for the ::ccl_event_wait_list_add() function. Intended as
@@ -364,6 +465,17 @@ CCLEventWaitList * ccl_event_wait_list_add_v(
 CCL_EXPORT
 void ccl_event_wait_list_clear(CCLEventWaitList * evt_wait_lst);
 
+/* Check which events in an event wait list have finished, without
+ * blocking. */
+CCL_EXPORT
+cl_uint ccl_event_wait_list_poll(CCLEventWaitList * evt_wait_lst,
+    cl_bool * finished, CCLErr ** err);
+
+/* Remove finished events from an event wait list. */
+CCL_EXPORT
+CCLEventWaitList * ccl_event_wait_list_prune(
+    CCLEventWaitList * evt_wait_lst);
+
 /**
  * Get number of events in the event wait list.
  *
@@ -375,7 +487,7 @@ void ccl_event_wait_list_clear(CCLEventWaitList * evt_wait_lst);
  * */
 #define ccl_event_wait_list_get_num_events(evt_wait_lst) \
     ((((evt_wait_lst) != NULL) && (*(evt_wait_lst) != NULL)) \
-    ? (*(evt_wait_lst))->len \
+    ? (*(evt_wait_lst))->num_evts \
     : 0)
 
 /**
@@ -389,7 +501,7 @@ void ccl_event_wait_list_clear(CCLEventWaitList * evt_wait_lst);
  * */
 #define ccl_event_wait_list_get_clevents(evt_wait_lst) \
     ((((evt_wait_lst) != NULL) && (*(evt_wait_lst) != NULL)) \
-        ? (const cl_event *) (*(evt_wait_lst))->pdata \
+        ? (const cl_event *) (*(evt_wait_lst))->evts \
         : NULL)
 
 /** @} */
@@ -399,6 +511,16 @@ void ccl_event_wait_list_clear(CCLEventWaitList * evt_wait_lst);
 CCL_EXPORT
 cl_bool ccl_event_wait(CCLEventWaitList * evt_wait_lst, CCLErr ** err);
 
+/* Waits on the host thread for commands identified by events in the
+ * wait list to complete, spin-polling first and optionally timing out. */
+CCL_EXPORT
+cl_bool ccl_event_wait_full(CCLEventWaitList * evt_wait_lst,
+    cl_ulong spin_usec, cl_long timeout_usec, CCLErr ** err);
+
+/* Set the time ccl_event_wait() spin-polls before blocking. */
+CCL_EXPORT
+void ccl_event_wait_set_spin_time(cl_ulong spin_usec);
+
 /** @} */
 
 #endif
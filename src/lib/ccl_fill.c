@@ -0,0 +1,330 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of kernel-based buffer and image fills.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "_ccl_fill.h"
+#include "_ccl_context_wrapper.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "_ccl_defs.h"
+#include <string.h>
+
+/**
+ * @internal
+ * Key of the fill program in the context cache of compiled programs.
+ * */
+#define CCL_FILL_PROGRAM_KEY "ccl_fill"
+
+/**
+ * @internal
+ * Source of the fill kernels. Patterns are passed by value in a structure
+ * of ::CCL_FILL_PATTERN_MAX bytes. Buffer offsets and sizes are given in
+ * bytes for `ccl_fill_buffer` and in 32-bit words for `ccl_fill_buffer4`.
+ * */
+static const char * ccl_fill_src =
+    "typedef struct { uint w[" G_STRINGIFY(CCL_FILL_PATTERN_MAX) " / 4]; }"
+    " ccl_fill_pattern;\n"
+    "__kernel void ccl_fill_buffer(__global uchar * dst, ulong offset,\n"
+    "    ulong size, ccl_fill_pattern pat, uint pat_size) {\n"
+    "    ulong i = get_global_id(0);\n"
+    "    if (i < size) dst[offset + i] = ((uchar *) pat.w)[i % pat_size];\n"
+    "}\n"
+    "__kernel void ccl_fill_buffer4(__global uint * dst, ulong offset,\n"
+    "    ulong size, ccl_fill_pattern pat, uint pat_size) {\n"
+    "    ulong i = get_global_id(0);\n"
+    "    if (i < size) dst[offset + i] = pat.w[i % pat_size];\n"
+    "}\n"
+    "__kernel void ccl_fill_image_f(__write_only image2d_t img,\n"
+    "    int2 origin, float4 color) {\n"
+    "    write_imagef(img, origin\n"
+    "        + (int2) (get_global_id(0), get_global_id(1)), color);\n"
+    "}\n"
+    "__kernel void ccl_fill_image_i(__write_only image2d_t img,\n"
+    "    int2 origin, int4 color) {\n"
+    "    write_imagei(img, origin\n"
+    "        + (int2) (get_global_id(0), get_global_id(1)), color);\n"
+    "}\n"
+    "__kernel void ccl_fill_image_ui(__write_only image2d_t img,\n"
+    "    int2 origin, uint4 color) {\n"
+    "    write_imageui(img, origin\n"
+    "        + (int2) (get_global_id(0), get_global_id(1)), color);\n"
+    "}\n";
+
+/**
+ * @internal
+ *
+ * @brief Create a fill kernel, building the fill program the first time
+ * it is required in the context of the given queue, and keeping it in
+ * the context cache of compiled programs.
+ *
+ * @param[in] cq Command queue where the fill is to be enqueued.
+ * @param[in] kernel_name Name of fill kernel.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new kernel wrapper object, which should be released with
+ * ::ccl_kernel_destroy(), or `NULL` if an error occurs.
+ * */
+static CCLKernel * ccl_fill_kernel_new(
+    CCLQueue * cq, const char * kernel_name, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+
+    /* Get context of queue. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Build fill program if not yet available in context. */
+    prg = ccl_context_get_compiled_program(ctx, CCL_FILL_PROGRAM_KEY);
+    if (prg == NULL) {
+        prg = ccl_program_new_from_source(ctx, ccl_fill_src, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_program_build(prg, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        prg = ccl_context_add_compiled_program(
+            ctx, CCL_FILL_PROGRAM_KEY, prg);
+    }
+
+    /* Create a kernel of its own for this fill, so that concurrent fills
+     * don't share kernel arguments. */
+    krnl = ccl_kernel_new(prg, kernel_name, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release our reference to the program, which the cache keeps. */
+    if (prg != NULL) ccl_program_destroy(prg);
+
+    /* Return kernel. */
+    return krnl;
+}
+
+/**
+ * @internal
+ *
+ * @brief Fill a buffer with a pattern using a kernel, one work-item per
+ * byte, or per 32-bit word if the pattern, offset and size are multiples
+ * of four bytes. Unlike clEnqueueFillBuffer(), the pattern size doesn't
+ * need to be a power of two.
+ *
+ * @param[out] buf Buffer wrapper object to fill.
+ * @param[in] cq Command-queue wrapper object in which the fill kernel will
+ * be queued.
+ * @param[in] pattern A pointer to the data pattern.
+ * @param[in] pattern_size Size of data pattern in bytes, at most
+ * ::CCL_FILL_PATTERN_MAX.
+ * @param[in] offset The location in bytes of the region being filled in
+ * buffer. Must be a multiple of `pattern_size`.
+ * @param[in] size The size in bytes of region being filled in buffer.
+ * Must be a multiple of `pattern_size`.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object of the fill kernel, or `NULL` if an error
+ * occurs.
+ * */
+CCLEvent * ccl_fill_buffer_kernel(CCLBuffer * buf, CCLQueue * cq,
+    const void * pattern, size_t pattern_size, size_t offset, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLKernel * krnl = NULL;
+    CCLEvent * evt = NULL;
+    guchar pat[CCL_FILL_PATTERN_MAX] = { 0 };
+    cl_bool words;
+    cl_ulong off_arg, size_arg;
+    cl_uint pat_size_arg;
+    size_t gws;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (pattern_size == 0) || (pattern_size > CCL_FILL_PATTERN_MAX)
+        || (offset % pattern_size != 0) || (size % pattern_size != 0)
+        || (size == 0), CCL_ERROR_ARGS, error_handler,
+        "%s: pattern size must be between 1 and %d bytes, and offset and "
+        "non-zero size must be multiples of it.",
+        CCL_STRD, CCL_FILL_PATTERN_MAX);
+
+    /* Use one work-item per 32-bit word if possible. */
+    words = (pattern_size % 4 == 0);
+    memcpy(pat, pattern, pattern_size);
+    off_arg = words ? offset / 4 : offset;
+    size_arg = words ? size / 4 : size;
+    pat_size_arg = (cl_uint) (words ? pattern_size / 4 : pattern_size);
+    gws = (size_t) size_arg;
+
+    /* Get fill kernel. */
+    krnl = ccl_fill_kernel_new(
+        cq, words ? "ccl_fill_buffer4" : "ccl_fill_buffer", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Fill buffer. */
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+        NULL, evt_wait_lst, &err_internal, buf,
+        ccl_arg_priv(off_arg, cl_ulong), ccl_arg_priv(size_arg, cl_ulong),
+        ccl_arg_new(pat, CCL_FILL_PATTERN_MAX),
+        ccl_arg_priv(pat_size_arg, cl_uint), NULL);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release kernel, which remains valid while the fill runs. */
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Fill a region of a 2D image with a color using a kernel. The
+ * image must be writable by kernels.
+ *
+ * @param[out] img Image wrapper object to fill.
+ * @param[in] cq Command-queue wrapper object in which the fill kernel will
+ * be queued.
+ * @param[in] fill_color The fill color, a four component vector of
+ * `cl_float`, `cl_int` or `cl_uint` values, depending on the image
+ * channel data type.
+ * @param[in] origin The @f$(x, y, 0)@f$ offset in pixels of the region.
+ * @param[in] region The @f$(width, height, 1)@f$ in pixels of the region.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object of the fill kernel, or `NULL` if an error
+ * occurs.
+ * */
+CCLEvent * ccl_fill_image_kernel(CCLImage * img, CCLQueue * cq,
+    const void * fill_color, const size_t * origin, const size_t * region,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLKernel * krnl = NULL;
+    CCLEvent * evt = NULL;
+    cl_image_format fmt;
+    size_t depth;
+    const char * kernel_name;
+    cl_int2 orig2;
+
+    /* Only 2D images can be written by kernels without extensions. */
+    depth = ccl_image_get_info_scalar(
+        img, CL_IMAGE_DEPTH, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (depth > 1) || (origin[2] != 0) || (region[2] != 1),
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Image fill of non-2D images requires OpenCL version 1.2 or "
+        "newer.", CCL_STRD);
+
+    /* Select kernel according to image channel data type. */
+    fmt = ccl_image_get_info_scalar(
+        img, CL_IMAGE_FORMAT, cl_image_format, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    switch (fmt.image_channel_data_type) {
+        case CL_SIGNED_INT8:
+        case CL_SIGNED_INT16:
+        case CL_SIGNED_INT32:
+            kernel_name = "ccl_fill_image_i";
+            break;
+        case CL_UNSIGNED_INT8:
+        case CL_UNSIGNED_INT16:
+        case CL_UNSIGNED_INT32:
+            kernel_name = "ccl_fill_image_ui";
+            break;
+        default:
+            kernel_name = "ccl_fill_image_f";
+    }
+
+    /* Check region. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (region[0] == 0) || (region[1] == 0), CCL_ERROR_ARGS, error_handler,
+        "%s: region to fill must not be empty.", CCL_STRD);
+
+    /* Get fill kernel. */
+    krnl = ccl_fill_kernel_new(cq, kernel_name, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Fill image. */
+    orig2.s[0] = (cl_int) origin[0];
+    orig2.s[1] = (cl_int) origin[1];
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 2, NULL, region,
+        NULL, evt_wait_lst, &err_internal, img,
+        ccl_arg_priv(orig2, cl_int2),
+        ccl_arg_new((void *) fill_color, sizeof(cl_float4)), NULL);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release kernel, which remains valid while the fill runs. */
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
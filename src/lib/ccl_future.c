@@ -0,0 +1,715 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of futures and continuations on top of events.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+
+#include "_ccl_future.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Kinds of continuations.
+ * */
+enum ccl_future_cont_kind {
+
+    /** Run a host function in the thread pool. */
+    CCL_FUTURE_CONT_THEN,
+
+    /** Count towards a ::ccl_future_when_all() future. */
+    CCL_FUTURE_CONT_ALL,
+
+    /** Count towards a ::ccl_future_when_any() future. */
+    CCL_FUTURE_CONT_ANY
+
+};
+
+/**
+ * @internal
+ *
+ * @brief State shared by the continuations of a combined future.
+ * */
+struct ccl_future_join {
+
+    /**
+     * Number of futures which have not yet completed.
+     * @private
+     * */
+    gint pending;
+
+    /**
+     * Was the combined future already completed (any futures only)?
+     * @private
+     * */
+    gint fired;
+
+    /**
+     * Execution status of the combined future (all futures only).
+     * @private
+     * */
+    gint status;
+
+    /**
+     * The combined future.
+     * @private
+     * */
+    CCLFuture * target;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief A continuation waiting for a future to complete.
+ * */
+struct ccl_future_cont {
+
+    /**
+     * Kind of continuation.
+     * @private
+     * */
+    enum ccl_future_cont_kind kind;
+
+    /**
+     * Future completed by this continuation (then continuations only).
+     * @private
+     * */
+    CCLFuture * target;
+
+    /**
+     * Continuation function (then continuations only).
+     * @private
+     * */
+    ccl_future_fn fn;
+
+    /**
+     * User data for continuation function.
+     * @private
+     * */
+    void * user_data;
+
+    /**
+     * Execution status of the future after which the continuation runs.
+     * @private
+     * */
+    cl_int status;
+
+    /**
+     * Shared state of combined future (all and any continuations only).
+     * @private
+     * */
+    struct ccl_future_join * join;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Future class.
+ * */
+struct ccl_future {
+
+    /**
+     * Lock protecting the future state.
+     * @private
+     * */
+    GMutex lock;
+
+    /**
+     * Condition signaled when the future completes.
+     * @private
+     * */
+    GCond cond;
+
+    /**
+     * Reference count, one owned by the client and one by whatever
+     * completes the future.
+     * @private
+     * */
+    gint ref_count;
+
+    /**
+     * Has the future completed?
+     * @private
+     * */
+    cl_bool done;
+
+    /**
+     * Execution status of the future, valid once completed.
+     * @private
+     * */
+    cl_int status;
+
+    /**
+     * Continuations waiting for the future to complete.
+     * @private
+     * */
+    GSList * conts;
+
+};
+
+/* Lock protecting the continuations thread pool. */
+static GMutex future_lock;
+
+/* Thread pool which runs continuations, created on first use. */
+static GThreadPool * future_pool = NULL;
+
+/* Maximum number of threads for running continuations, zero for one
+ * thread per processor. */
+static cl_uint future_max_threads = 0;
+
+/**
+ * @internal
+ *
+ * @brief Create a new, uncompleted, future.
+ *
+ * @param[in] ref_count Initial reference count.
+ * @return A new future.
+ * */
+static CCLFuture * ccl_future_alloc(gint ref_count) {
+
+    CCLFuture * fut = g_slice_new0(CCLFuture);
+
+    g_mutex_init(&fut->lock);
+    g_cond_init(&fut->cond);
+    fut->ref_count = ref_count;
+
+    return fut;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release a reference to a future, freeing it if it was the last
+ * one.
+ *
+ * @param[in] fut The future.
+ * */
+static void ccl_future_unref(CCLFuture * fut) {
+
+    if (g_atomic_int_dec_and_test(&fut->ref_count)) {
+        g_slist_free(fut->conts);
+        g_mutex_clear(&fut->lock);
+        g_cond_clear(&fut->cond);
+        g_slice_free(CCLFuture, fut);
+    }
+}
+
+static void ccl_future_dispatch(struct ccl_future_cont * cont, cl_int status);
+
+/**
+ * @internal
+ *
+ * @brief Complete a future and dispatch its continuations. Only the
+ * first completion of a future has effect.
+ *
+ * @param[in] fut The future.
+ * @param[in] status Execution status, `CL_COMPLETE` or a negative value.
+ * */
+static void ccl_future_complete(CCLFuture * fut, cl_int status) {
+
+    GSList * conts;
+
+    /* Set future state and wake up waiting threads. */
+    g_mutex_lock(&fut->lock);
+    if (fut->done) {
+        g_mutex_unlock(&fut->lock);
+        return;
+    }
+    fut->done = CL_TRUE;
+    fut->status = status;
+    conts = g_slist_reverse(fut->conts);
+    fut->conts = NULL;
+    g_cond_broadcast(&fut->cond);
+    g_mutex_unlock(&fut->lock);
+
+    /* Dispatch continuations in the order they were added. */
+    for (GSList * it = conts; it != NULL; it = it->next)
+        ccl_future_dispatch((struct ccl_future_cont *) it->data, status);
+    g_slist_free(conts);
+}
+
+/**
+ * @internal
+ *
+ * @brief Thread pool function which runs a continuation.
+ *
+ * @param[in] data The continuation.
+ * @param[in] pool_data Not used.
+ * */
+static void ccl_future_run(gpointer data, gpointer pool_data) {
+
+    struct ccl_future_cont * cont = (struct ccl_future_cont *) data;
+    cl_int status;
+
+    CCL_UNUSED(pool_data);
+
+    /* Run continuation, only negative values are errors. */
+    status = cont->fn(cont->status, cont->user_data);
+    ccl_future_complete(cont->target, status < 0 ? status : CL_COMPLETE);
+    ccl_future_unref(cont->target);
+    g_slice_free(struct ccl_future_cont, cont);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the continuations thread pool, creating it if necessary.
+ *
+ * @return The continuations thread pool.
+ * */
+static GThreadPool * ccl_future_pool_get() {
+
+    GThreadPool * pool;
+
+    g_mutex_lock(&future_lock);
+    if (future_pool == NULL) {
+        future_pool = g_thread_pool_new(ccl_future_run, NULL,
+            future_max_threads > 0
+                ? (gint) future_max_threads : (gint) g_get_num_processors(),
+            FALSE, NULL);
+    }
+    pool = future_pool;
+    g_mutex_unlock(&future_lock);
+
+    return pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Dispatch a continuation of a completed future. Then
+ * continuations are handed to the thread pool, while combined futures are
+ * updated directly, since that is cheap.
+ *
+ * @param[in] cont The continuation.
+ * @param[in] status Execution status of the completed future.
+ * */
+static void ccl_future_dispatch(struct ccl_future_cont * cont, cl_int status) {
+
+    struct ccl_future_join * join = cont->join;
+
+    switch (cont->kind) {
+
+        case CCL_FUTURE_CONT_THEN:
+
+            cont->status = status;
+            g_thread_pool_push(ccl_future_pool_get(), cont, NULL);
+            return;
+
+        case CCL_FUTURE_CONT_ALL:
+
+            /* Keep the first error. */
+            if (status < 0)
+                g_atomic_int_compare_and_exchange(
+                    &join->status, CL_COMPLETE, status);
+            break;
+
+        case CCL_FUTURE_CONT_ANY:
+
+            /* Complete with the status of the first future. */
+            if (g_atomic_int_compare_and_exchange(&join->fired, 0, 1))
+                ccl_future_complete(join->target, status);
+            break;
+    }
+
+    /* The last future to complete releases the shared state, completing
+     * the combined future if all futures were required. */
+    if (g_atomic_int_dec_and_test(&join->pending)) {
+        if (cont->kind == CCL_FUTURE_CONT_ALL)
+            ccl_future_complete(
+                join->target, g_atomic_int_get(&join->status));
+        ccl_future_unref(join->target);
+        g_slice_free(struct ccl_future_join, join);
+    }
+    g_slice_free(struct ccl_future_cont, cont);
+}
+
+/**
+ * @internal
+ *
+ * @brief Add a continuation to a future, dispatching it immediately if the
+ * future has already completed.
+ *
+ * @param[in] fut The future.
+ * @param[in] cont The continuation.
+ * */
+static void ccl_future_add_cont(
+    CCLFuture * fut, struct ccl_future_cont * cont) {
+
+    cl_int status;
+
+    g_mutex_lock(&fut->lock);
+    if (!fut->done) {
+        fut->conts = g_slist_prepend(fut->conts, cont);
+        g_mutex_unlock(&fut->lock);
+        return;
+    }
+    status = fut->status;
+    g_mutex_unlock(&fut->lock);
+
+    ccl_future_dispatch(cont, status);
+}
+
+/**
+ * @internal
+ *
+ * @brief Create a combined future.
+ *
+ * @param[in] kind Kind of combination, all or any.
+ * @param[in] num_futs Number of futures to combine.
+ * @param[in] futs Futures to combine.
+ * @return The combined future.
+ * */
+static CCLFuture * ccl_future_combine(enum ccl_future_cont_kind kind,
+    cl_uint num_futs, CCLFuture * const * futs) {
+
+    /* Combined future, one reference for the client and one for the
+     * shared state. */
+    CCLFuture * fut = ccl_future_alloc(2);
+    /* Shared state. */
+    struct ccl_future_join * join = g_slice_new0(struct ccl_future_join);
+    /* Current continuation. */
+    struct ccl_future_cont * cont;
+
+    join->pending = (gint) num_futs;
+    join->status = CL_COMPLETE;
+    join->target = fut;
+
+    for (cl_uint i = 0; i < num_futs; ++i) {
+        cont = g_slice_new0(struct ccl_future_cont);
+        cont->kind = kind;
+        cont->join = join;
+        ccl_future_add_cont(futs[i], cont);
+    }
+
+    return fut;
+}
+
+/**
+ * @internal
+ *
+ * @brief Event callback which completes a future.
+ *
+ * @param[in] event Event on which the future depends.
+ * @param[in] status Execution status of `event`.
+ * @param[in] user_data The future.
+ * */
+static void CL_CALLBACK ccl_future_event_cb(
+    cl_event event, cl_int status, void * user_data) {
+
+    CCLFuture * fut = (CCLFuture *) user_data;
+
+    CCL_UNUSED(event);
+
+    ccl_future_complete(fut, status < 0 ? status : CL_COMPLETE);
+    ccl_future_unref(fut);
+}
+
+/**
+ * @internal
+ *
+ * @brief Create a future which is completed later, with
+ * ccl_future_resolve() or ccl_future_resolve_event(), e.g. by a thread
+ * which enqueues the respective command.
+ *
+ * @return A new future, with one reference for the client, released with
+ * ::ccl_future_destroy(), and one for whatever resolves it.
+ * */
+CCLFuture * ccl_future_new_pending() {
+
+    return ccl_future_alloc(2);
+}
+
+/**
+ * @internal
+ *
+ * @brief Complete a pending future with the given execution status,
+ * releasing the reference of whatever resolves it.
+ *
+ * @param[in] fut A future created with ccl_future_new_pending().
+ * @param[in] status Execution status, `CL_COMPLETE` or a negative value.
+ * */
+void ccl_future_resolve(CCLFuture * fut, cl_int status) {
+
+    ccl_future_complete(fut, status < 0 ? status : CL_COMPLETE);
+    ccl_future_unref(fut);
+}
+
+/**
+ * @internal
+ *
+ * @brief Complete a pending future when the given event completes, with
+ * the execution status of the event. If the completion of the event
+ * cannot be tracked, the future completes immediately with
+ * `CL_INVALID_OPERATION`.
+ *
+ * @param[in] fut A future created with ccl_future_new_pending().
+ * @param[in] evt Event wrapper object.
+ * */
+void ccl_future_resolve_event(CCLFuture * fut, CCLEvent * evt) {
+
+    if (!ccl_event_set_callback(
+            evt, CL_COMPLETE, ccl_future_event_cb, fut, NULL))
+        ccl_future_resolve(fut, CL_INVALID_OPERATION);
+}
+
+/**
+ * @addtogroup CCL_FUTURE
+ * @{
+ */
+
+/**
+ * Create a future which completes when the given event completes, with
+ * the execution status of the event.
+ *
+ * @public @memberof ccl_future
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] evt Event wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new future, which should be released with
+ * ::ccl_future_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLFuture * ccl_future_new(CCLEvent * evt, CCLErr ** err) {
+
+    /* Make sure evt is not NULL. */
+    g_return_val_if_fail(evt != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* The future, one reference for the client and one for the event
+     * callback. */
+    CCLFuture * fut = ccl_future_alloc(2);
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Complete future when the event completes. */
+    ccl_event_set_callback(
+        evt, CL_COMPLETE, ccl_future_event_cb, fut, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Callback was not set, release both references. */
+    ccl_future_unref(fut);
+    ccl_future_unref(fut);
+    fut = NULL;
+
+finish:
+
+    /* Return future. */
+    return fut;
+}
+
+/**
+ * Chain a continuation after a future. The continuation runs in the
+ * _cf4ocl_ thread pool once `fut` completes, receiving its execution
+ * status, even if it is an error.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] fut The future after which the continuation runs.
+ * @param[in] fn Continuation function.
+ * @param[in] user_data User data passed to `fn`.
+ * @return A new future, which completes when the continuation returns,
+ * with the status returned by the continuation. It should be released with
+ * ::ccl_future_destroy().
+ * */
+CCL_EXPORT
+CCLFuture * ccl_future_then(
+    CCLFuture * fut, ccl_future_fn fn, void * user_data) {
+
+    /* Make sure fut is not NULL. */
+    g_return_val_if_fail(fut != NULL, NULL);
+    /* Make sure fn is not NULL. */
+    g_return_val_if_fail(fn != NULL, NULL);
+
+    /* Future completed by the continuation, one reference for the client
+     * and one for the continuation. */
+    CCLFuture * target = ccl_future_alloc(2);
+    /* Continuation. */
+    struct ccl_future_cont * cont = g_slice_new0(struct ccl_future_cont);
+
+    cont->kind = CCL_FUTURE_CONT_THEN;
+    cont->target = target;
+    cont->fn = fn;
+    cont->user_data = user_data;
+
+    /* The continuation may run, and release its reference to the target,
+     * before this function returns. */
+    ccl_future_add_cont(fut, cont);
+
+    return target;
+}
+
+/**
+ * Create a future which completes when all the given futures complete.
+ * Its execution status is `CL_COMPLETE` if all futures completed
+ * successfully, or the first error status otherwise.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] num_futs Number of futures in `futs`.
+ * @param[in] futs Futures to wait for.
+ * @return A new future, which should be released with
+ * ::ccl_future_destroy().
+ * */
+CCL_EXPORT
+CCLFuture * ccl_future_when_all(cl_uint num_futs, CCLFuture * const * futs) {
+
+    /* Make sure futs is not NULL. */
+    g_return_val_if_fail((num_futs == 0) || (futs != NULL), NULL);
+
+    /* Without futures to wait for, the future is already complete. */
+    if (num_futs == 0) {
+        CCLFuture * fut = ccl_future_alloc(1);
+        ccl_future_complete(fut, CL_COMPLETE);
+        return fut;
+    }
+
+    return ccl_future_combine(CCL_FUTURE_CONT_ALL, num_futs, futs);
+}
+
+/**
+ * Create a future which completes when any of the given futures completes,
+ * with the execution status of that future.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] num_futs Number of futures in `futs`, which must be larger
+ * than zero.
+ * @param[in] futs Futures to wait for.
+ * @return A new future, which should be released with
+ * ::ccl_future_destroy().
+ * */
+CCL_EXPORT
+CCLFuture * ccl_future_when_any(cl_uint num_futs, CCLFuture * const * futs) {
+
+    /* Make sure there are futures to wait for. */
+    g_return_val_if_fail((num_futs > 0) && (futs != NULL), NULL);
+
+    return ccl_future_combine(CCL_FUTURE_CONT_ANY, num_futs, futs);
+}
+
+/**
+ * Check if a future has completed.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] fut The future.
+ * @return `CL_TRUE` if the future has completed, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_future_is_ready(CCLFuture * fut) {
+
+    /* Make sure fut is not NULL. */
+    g_return_val_if_fail(fut != NULL, CL_FALSE);
+
+    cl_bool done;
+
+    g_mutex_lock(&fut->lock);
+    done = fut->done;
+    g_mutex_unlock(&fut->lock);
+
+    return done;
+}
+
+/**
+ * Wait for a future to complete and return its execution status.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] fut The future.
+ * @return `CL_COMPLETE` if the future completed successfully, or a
+ * negative value otherwise.
+ * */
+CCL_EXPORT
+cl_int ccl_future_wait(CCLFuture * fut) {
+
+    /* Make sure fut is not NULL. */
+    g_return_val_if_fail(fut != NULL, CL_INVALID_VALUE);
+
+    cl_int status;
+
+    g_mutex_lock(&fut->lock);
+    while (!fut->done)
+        g_cond_wait(&fut->cond, &fut->lock);
+    status = fut->status;
+    g_mutex_unlock(&fut->lock);
+
+    return status;
+}
+
+/**
+ * Destroy a future. Continuations already chained after the future still
+ * run when it completes.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] fut The future to destroy.
+ * */
+CCL_EXPORT
+void ccl_future_destroy(CCLFuture * fut) {
+
+    /* Make sure fut is not NULL. */
+    g_return_if_fail(fut != NULL);
+
+    /* Release the reference owned by the client. */
+    ccl_future_unref(fut);
+}
+
+/**
+ * Set the maximum number of threads used for running continuations. By
+ * default, one thread per processor is used.
+ *
+ * @public @memberof ccl_future
+ *
+ * @param[in] max_threads Maximum number of threads, or zero for one
+ * thread per processor.
+ * */
+CCL_EXPORT
+void ccl_future_set_max_threads(cl_uint max_threads) {
+
+    g_mutex_lock(&future_lock);
+    future_max_threads = max_threads;
+    if (future_pool != NULL) {
+        g_thread_pool_set_max_threads(future_pool, max_threads > 0
+            ? (gint) max_threads : (gint) g_get_num_processors(), NULL);
+    }
+    g_mutex_unlock(&future_lock);
+}
+
+/** @} */
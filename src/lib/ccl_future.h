@@ -0,0 +1,136 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of futures and continuations on top of events.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+
+#ifndef _CCL_FUTURE_H_
+#define _CCL_FUTURE_H_
+
+#include "ccl_common.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_FUTURE Futures
+ * @ingroup CCL_EVENT_WRAPPER
+ *
+ * This module provides futures, i.e. handles to values which become
+ * available in the future, namely the completion of OpenCL commands, and
+ * continuations, i.e. host functions which run when a future completes.
+ *
+ * A future is created from an event with ::ccl_future_new(). Host work is
+ * chained after a future with ::ccl_future_then(), and futures are
+ * combined with ::ccl_future_when_all() and ::ccl_future_when_any(). Each
+ * of these functions returns a new future, so chains and graphs of host
+ * work can be built without blocking the host thread. Continuations run
+ * in a thread pool managed by _cf4ocl_, and never inside the threads in
+ * which the OpenCL implementation invokes event callbacks.
+ *
+ * Futures complete with an execution status, `CL_COMPLETE` on success or
+ * a negative value otherwise, which is passed to continuations and
+ * returned by ::ccl_future_wait(). Futures created from events require
+ * OpenCL >= 1.1.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * cl_int postprocess(cl_int status, void * user_data) {
+ *     if (status < 0) return status;
+ *     encode_frame((struct frame *) user_data);
+ *     return CL_COMPLETE;
+ * }
+ * @endcode
+ * @code{.c}
+ * CCLFuture * fut_read, * fut_done;
+ * @endcode
+ * @code{.c}
+ * evt = ccl_buffer_enqueue_read(
+ *     buf, cq, CL_FALSE, 0, size, f->data, NULL, NULL);
+ * fut_read = ccl_future_new(evt, NULL);
+ * fut_done = ccl_future_then(fut_read, postprocess, f);
+ * @endcode
+ * @code{.c}
+ * status = ccl_future_wait(fut_done);
+ * ccl_future_destroy(fut_done);
+ * ccl_future_destroy(fut_read);
+ * @endcode
+ *
+ * @{
+ */
+
+/**
+ * Future class.
+ * */
+typedef struct ccl_future CCLFuture;
+
+/**
+ * A continuation function.
+ *
+ * @param[in] status Execution status of the future after which the
+ * continuation runs, `CL_COMPLETE` or a negative value.
+ * @param[in] user_data User data given to ::ccl_future_then().
+ * @return `CL_COMPLETE` if the continuation completed successfully, or a
+ * negative integer value, which will be the execution status of the
+ * future returned by ::ccl_future_then(), otherwise.
+ * */
+typedef cl_int (*ccl_future_fn)(cl_int status, void * user_data);
+
+/* Create a future which completes when the given event completes. */
+CCL_EXPORT
+CCLFuture * ccl_future_new(CCLEvent * evt, CCLErr ** err);
+
+/* Chain a continuation after a future. */
+CCL_EXPORT
+CCLFuture * ccl_future_then(
+    CCLFuture * fut, ccl_future_fn fn, void * user_data);
+
+/* Create a future which completes when all the given futures complete. */
+CCL_EXPORT
+CCLFuture * ccl_future_when_all(cl_uint num_futs, CCLFuture * const * futs);
+
+/* Create a future which completes when any of the given futures
+ * completes. */
+CCL_EXPORT
+CCLFuture * ccl_future_when_any(cl_uint num_futs, CCLFuture * const * futs);
+
+/* Check if a future has completed. */
+CCL_EXPORT
+cl_bool ccl_future_is_ready(CCLFuture * fut);
+
+/* Wait for a future to complete and return its execution status. */
+CCL_EXPORT
+cl_int ccl_future_wait(CCLFuture * fut);
+
+/* Destroy a future. */
+CCL_EXPORT
+void ccl_future_destroy(CCLFuture * fut);
+
+/* Set the maximum number of threads used for running continuations. */
+CCL_EXPORT
+void ccl_future_set_max_threads(cl_uint max_threads);
+
+/** @} */
+
+#endif
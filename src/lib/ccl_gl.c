@@ -0,0 +1,519 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Implementation of OpenGL interoperability functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_gl.h"
+#include "ccl_platforms.h"
+#include "_ccl_memobj_wrapper.h"
+#include "_ccl_queue_wrapper.h"
+#include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
+
+/**
+ * @internal
+ *
+ * @brief Enqueue the acquisition or release of memory objects created
+ * from OpenGL objects.
+ *
+ * @param[in] mos Memory objects created from OpenGL objects.
+ * @param[in] num_mos Number of memory objects.
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] evt_wait_lst Event wait list, cleared by this function.
+ * @param[in] acquire Acquire objects if `CL_TRUE`, release them otherwise.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object for the command, or `NULL` if an error
+ * occurs.
+ * */
+static CCLEvent * ccl_gl_enqueue_objects(CCLMemObj * const * mos,
+    cl_uint num_mos, CCLQueue * cq, CCLEventWaitList * evt_wait_lst,
+    cl_bool acquire, CCLErr ** err) {
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    /* OpenCL function status. */
+    cl_int ocl_status;
+    /* OpenCL event. */
+    cl_event event = NULL;
+    /* Event wrapper. */
+    CCLEvent * evt;
+    /* Array of OpenCL memory objects. */
+    cl_mem * mem_objects;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Gather OpenCL memory objects in an array, and wait for conflicting
+     * commands on them. Acquires and releases hand the objects over
+     * between APIs, so they are considered to write the objects. */
+    mem_objects = (cl_mem *) g_slice_alloc(sizeof(cl_mem) * num_mos);
+    for (cl_uint i = 0; i < num_mos; ++i) {
+        mem_objects[i] = ccl_memobj_unwrap(mos[i]);
+        evt_wait_lst = ccl_memobj_hazard_deps(
+            mos[i], cq, CL_TRUE, evt_wait_lst, &hzd_ewl);
+    }
+
+    /* Acquire or release memory objects. */
+    ocl_status = (acquire ? clEnqueueAcquireGLObjects
+        : clEnqueueReleaseGLObjects)(ccl_queue_unwrap(cq),
+        num_mos, (const cl_mem *) mem_objects,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to %s OpenGL objects (OpenCL error %d: %s).",
+        CCL_STRD, acquire ? "acquire" : "release",
+        ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    for (cl_uint i = 0; i < num_mos; ++i)
+        ccl_memobj_hazard_record(mos[i], cq, CL_TRUE, evt);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Release stuff. */
+    g_slice_free1(sizeof(cl_mem) * num_mos, mem_objects);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return evt. */
+    return evt;
+}
+
+/**
+ * Create a context sharing objects with the given OpenGL context.
+ *
+ * The context contains the OpenCL device currently associated with the
+ * OpenGL context, as reported by the first platform which supports the
+ * `cl_khr_gl_sharing` extension and knows the OpenGL context. This
+ * function is not supported on macOS, where ::ccl_context_new_from_gl_full()
+ * should be used with the `CL_CONTEXT_PROPERTY_USE_CGL_SHAREGROUP_APPLE`
+ * property.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] gl_context The OpenGL context, e.g. as returned by
+ * `glXGetCurrentContext()` or `wglGetCurrentContext()`.
+ * @param[in] gl_display The display of the OpenGL context, i.e. the GLX
+ * display, as returned by `glXGetCurrentDisplay()`, or, on Windows, the
+ * device context, as returned by `wglGetCurrentDC()`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new context wrapper object or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContext * ccl_context_new_from_gl(
+    void * gl_context, void * gl_display, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+#ifdef __APPLE__
+
+    CCL_UNUSED(gl_context);
+    CCL_UNUSED(gl_display);
+
+    g_set_error(err, CCL_ERROR, CCL_ERROR_UNSUPPORTED_OCL,
+        "%s: GL context sharing on macOS requires the CGL share group "
+        "property, use ccl_context_new_from_gl_full().", CCL_STRD);
+    return NULL;
+
+#else
+
+    /* OpenGL sharing properties. */
+    const cl_context_properties gl_properties[] = {
+        CL_GL_CONTEXT_KHR, (cl_context_properties) gl_context,
+#ifdef _WIN32
+        CL_WGL_HDC_KHR, (cl_context_properties) gl_display,
+#else
+        CL_GLX_DISPLAY_KHR, (cl_context_properties) gl_display,
+#endif
+        0 };
+
+    return ccl_context_new_from_gl_full(gl_properties, err);
+
+#endif
+
+}
+
+/**
+ * Create a context sharing objects with OpenGL, given the sharing
+ * properties.
+ *
+ * Platforms which support the `cl_khr_gl_sharing` extension are checked in
+ * turn for a device associated with the OpenGL context described by the
+ * given properties, using `clGetGLContextInfoKHR()`. The context is
+ * created with the first device found, and with the given properties plus
+ * the `CL_CONTEXT_PLATFORM` property of the respective platform.
+ *
+ * @public @memberof ccl_context
+ *
+ * @param[in] gl_properties Zero-terminated list of OpenGL sharing
+ * properties and respective values, e.g. `CL_GL_CONTEXT_KHR` and
+ * `CL_EGL_DISPLAY_KHR`. It must not contain the `CL_CONTEXT_PLATFORM`
+ * property.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new context wrapper object or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContext * ccl_context_new_from_gl_full(
+    const cl_context_properties * gl_properties, CCLErr ** err) {
+
+    /* Make sure gl_properties is not NULL. */
+    g_return_val_if_fail(gl_properties != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Context wrapper to return. */
+    CCLContext * ctx = NULL;
+    /* Platforms in the system. */
+    CCLPlatforms * platforms = NULL;
+    /* Context properties, including the platform. */
+    cl_context_properties * properties = NULL;
+    /* Number of OpenGL sharing properties. */
+    guint num_props = 0;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Copy OpenGL sharing properties, leaving room for the platform. */
+    while (gl_properties[num_props] != 0) num_props += 2;
+    properties = g_new(cl_context_properties, num_props + 3);
+    memcpy(properties, gl_properties,
+        sizeof(cl_context_properties) * num_props);
+    properties[num_props] = CL_CONTEXT_PLATFORM;
+    properties[num_props + 2] = 0;
+
+    /* Get platforms. */
+    platforms = ccl_platforms_new(&err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Find the first platform with a device associated with the OpenGL
+     * context. */
+    for (cl_uint i = 0; i < ccl_platforms_count(platforms); ++i) {
+
+        CCLPlatform * platf = ccl_platforms_get(platforms, i);
+        CCLDevice * dev;
+        cl_device_id device = NULL;
+        size_t size_ret = 0;
+        cl_int ocl_status;
+        char * exts;
+
+        /* Skip platforms without OpenGL sharing. */
+        exts = ccl_platform_get_info_string(
+            platf, CL_PLATFORM_EXTENSIONS, NULL);
+        if ((exts == NULL) || (strstr(exts, "cl_khr_gl_sharing") == NULL))
+            continue;
+
+        /* Get device associated with the OpenGL context, if any. */
+        properties[num_props + 1] =
+            (cl_context_properties) ccl_platform_unwrap(platf);
+        ocl_status = clGetGLContextInfoKHR(properties,
+            CL_CURRENT_DEVICE_FOR_GL_CONTEXT_KHR, sizeof(cl_device_id),
+            &device, &size_ret);
+        if ((ocl_status != CL_SUCCESS) || (size_ret == 0) || (device == NULL))
+            continue;
+
+        /* Create context with device. */
+        dev = ccl_device_new_wrap(device);
+        ctx = ccl_context_new_from_devices_full(
+            properties, 1, &dev, NULL, NULL, &err_internal);
+        ccl_device_destroy(dev);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        break;
+    }
+
+    /* Throw error if no device was found. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ctx == NULL,
+        CCL_ERROR_DEVICE_NOT_FOUND, error_handler,
+        "%s: no OpenCL device associated with the OpenGL context was found.",
+        CCL_STRD);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release stuff. */
+    if (platforms != NULL) ccl_platforms_destroy(platforms);
+    g_free(properties);
+
+    /* Return context wrapper. */
+    return ctx;
+
+}
+
+/**
+ * Create a ::CCLBuffer wrapper object from an OpenGL buffer object.
+ *
+ * The OpenGL buffer memory is not accounted for in the memory budget of
+ * the context, since it is owned by OpenGL.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] ctx Context wrapper created with OpenGL sharing, e.g. with
+ * ::ccl_context_new_from_gl().
+ * @param[in] flags OpenCL memory flags, only `CL_MEM_READ_ONLY`,
+ * `CL_MEM_WRITE_ONLY` and `CL_MEM_READ_WRITE` are allowed.
+ * @param[in] bufobj Name of the OpenGL buffer object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new buffer wrapper object or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_from_gl_buffer(CCLContext * ctx,
+    cl_mem_flags flags, cl_GLuint bufobj, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    cl_int ocl_status;
+    cl_mem buffer;
+    CCLBuffer * buf = NULL;
+
+    /* Create OpenCL buffer from OpenGL buffer. */
+    buffer = clCreateFromGLBuffer(
+        ccl_context_unwrap(ctx), flags, bufobj, &ocl_status);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to create buffer from OpenGL buffer %u "
+        "(OpenCL error %d: %s).",
+        CCL_STRD, bufobj, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap OpenCL buffer. */
+    buf = ccl_buffer_new_wrap(buffer);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return new buffer wrapper. */
+    return buf;
+}
+
+/**
+ * Create a ::CCLImage wrapper object from an OpenGL texture object.
+ *
+ * The OpenGL texture memory is not accounted for in the memory budget of
+ * the context, since it is owned by OpenGL.
+ *
+ * @public @memberof ccl_image
+ *
+ * @param[in] ctx Context wrapper created with OpenGL sharing, e.g. with
+ * ::ccl_context_new_from_gl().
+ * @param[in] flags OpenCL memory flags, only `CL_MEM_READ_ONLY`,
+ * `CL_MEM_WRITE_ONLY` and `CL_MEM_READ_WRITE` are allowed.
+ * @param[in] target OpenGL texture target, e.g. `GL_TEXTURE_2D`.
+ * @param[in] miplevel Mipmap level of the texture to use.
+ * @param[in] texture Name of the OpenGL texture object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new image wrapper object or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLImage * ccl_image_new_from_gl_texture(CCLContext * ctx,
+    cl_mem_flags flags, cl_GLenum target, cl_GLint miplevel,
+    cl_GLuint texture, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLImage * img = NULL;
+
+#ifndef CL_VERSION_1_2
+
+    CCL_UNUSED(flags);
+    CCL_UNUSED(target);
+    CCL_UNUSED(miplevel);
+    CCL_UNUSED(texture);
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 1.2, always throw
+     * error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Images from OpenGL textures require cf4ocl to be "
+        "deployed with support for OpenCL version 1.2 or newer.",
+        CCL_STRD);
+
+#else
+
+    cl_int ocl_status;
+    cl_mem image;
+    cl_uint ocl_ver;
+    CCLErr * err_internal = NULL;
+
+    /* Check that context platform is >= OpenCL 1.2 */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If OpenCL version is not >= 1.2, throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: images from OpenGL textures require OpenCL version 1.2 or "
+        "newer.", CCL_STRD);
+
+    /* Create OpenCL image from OpenGL texture. */
+    image = clCreateFromGLTexture(ccl_context_unwrap(ctx), flags, target,
+        miplevel, texture, &ocl_status);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to create image from OpenGL texture %u "
+        "(OpenCL error %d: %s).",
+        CCL_STRD, texture, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap OpenCL image. */
+    img = ccl_image_new_wrap(image);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return new image wrapper. */
+    return img;
+}
+
+/**
+ * Enqueue the acquisition of memory objects created from OpenGL objects.
+ *
+ * OpenGL must have finished using the objects, e.g. by calling
+ * `glFinish()`, before this function is called. The acquisition waits for
+ * commands on the memory objects tracked by cf4ocl, and further tracked
+ * commands on them wait for the acquisition.
+ *
+ * @public @memberof ccl_memobj
+ *
+ * @param[in] mos Memory objects created from OpenGL objects.
+ * @param[in] num_mos Number of memory objects.
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] evt_wait_lst List of events that need to complete before
+ * this command can be executed. The list will be cleared and can be reused
+ * by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL` if
+ * an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_memobj_enqueue_acquire_gl(CCLMemObj * const * mos,
+    cl_uint num_mos, CCLQueue * cq, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure mos is not NULL. */
+    g_return_val_if_fail(mos != NULL, NULL);
+    /* Make sure num_mos > 0. */
+    g_return_val_if_fail(num_mos > 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_gl_enqueue_objects(mos, num_mos, cq, evt_wait_lst,
+        CL_TRUE, err);
+}
+
+/**
+ * Enqueue the release of memory objects created from OpenGL objects.
+ *
+ * The release waits for commands on the memory objects tracked by cf4ocl.
+ * OpenGL may use the objects after the release completes, e.g. after
+ * calling ::ccl_queue_finish() on the command queue.
+ *
+ * @public @memberof ccl_memobj
+ *
+ * @param[in] mos Memory objects created from OpenGL objects.
+ * @param[in] num_mos Number of memory objects.
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] evt_wait_lst List of events that need to complete before
+ * this command can be executed. The list will be cleared and can be reused
+ * by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL` if
+ * an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_memobj_enqueue_release_gl(CCLMemObj * const * mos,
+    cl_uint num_mos, CCLQueue * cq, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure mos is not NULL. */
+    g_return_val_if_fail(mos != NULL, NULL);
+    /* Make sure num_mos > 0. */
+    g_return_val_if_fail(num_mos > 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    return ccl_gl_enqueue_objects(mos, num_mos, cq, evt_wait_lst,
+        CL_FALSE, err);
+}
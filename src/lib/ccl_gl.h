@@ -0,0 +1,129 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of OpenGL interoperability functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_GL_H_
+#define _CCL_GL_H_
+
+#include "ccl_common.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_image_wrapper.h"
+
+/**
+ * @defgroup CCL_GL OpenGL interoperability
+ * @ingroup CCL_MEMOBJ_WRAPPER
+ *
+ * This module provides wrappers for the `cl_khr_gl_sharing` extension,
+ * which allow kernels to read and write OpenGL buffers and textures
+ * directly, without copying them through host memory.
+ *
+ * A context sharing objects with the current OpenGL context is created
+ * with ::ccl_context_new_from_gl(), which takes the OpenGL context and
+ * display (GLX display on X11, device context on Windows) and selects the
+ * OpenCL device associated with them. ::ccl_context_new_from_gl_full()
+ * accepts an explicit list of sharing properties instead, e.g. for EGL.
+ *
+ * OpenGL buffers and textures are wrapped with
+ * ::ccl_buffer_new_from_gl_buffer() and ::ccl_image_new_from_gl_texture().
+ * Before being used by OpenCL commands, they must be acquired with
+ * ::ccl_memobj_enqueue_acquire_gl(), after OpenGL is done with them
+ * (e.g. after `glFinish()`), and they must be released with
+ * ::ccl_memobj_enqueue_release_gl() before OpenGL uses them again. Both
+ * functions take part in the read and write hazard tracking of memory
+ * objects, so that tracked commands wait for the acquire and the release
+ * waits for tracked commands.
+ *
+ * These functions don't require applications to link with OpenGL, since
+ * OpenGL objects are only referred to by their names. Creating images from
+ * textures requires OpenCL 1.2 or newer.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLContext * ctx;
+ * CCLBuffer * vbo_buf;
+ * CCLQueue * cq;
+ * CCLEvent * evt;
+ * CCLEventWaitList ewl = NULL;
+ * @endcode
+ * @code{.c}
+ * ctx = ccl_context_new_from_gl(
+ *     glXGetCurrentContext(), glXGetCurrentDisplay(), NULL);
+ * vbo_buf = ccl_buffer_new_from_gl_buffer(ctx, CL_MEM_WRITE_ONLY, vbo, NULL);
+ * @endcode
+ * @code{.c}
+ * glFinish();
+ * evt = ccl_memobj_enqueue_acquire_gl(
+ *     (CCLMemObj **) &vbo_buf, 1, cq, NULL, NULL);
+ * evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+ *     NULL, ccl_ewl(&ewl, evt, NULL), NULL, vbo_buf, NULL);
+ * ccl_memobj_enqueue_release_gl((CCLMemObj **) &vbo_buf, 1, cq,
+ *     ccl_ewl(&ewl, evt, NULL), NULL);
+ * ccl_queue_finish(cq, NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/* Create a context sharing objects with the given OpenGL context. */
+CCL_EXPORT
+CCLContext * ccl_context_new_from_gl(
+    void * gl_context, void * gl_display, CCLErr ** err);
+
+/* Create a context sharing objects with OpenGL, given the sharing
+ * properties. */
+CCL_EXPORT
+CCLContext * ccl_context_new_from_gl_full(
+    const cl_context_properties * gl_properties, CCLErr ** err);
+
+/* Create a buffer wrapper object from an OpenGL buffer object. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_from_gl_buffer(CCLContext * ctx,
+    cl_mem_flags flags, cl_GLuint bufobj, CCLErr ** err);
+
+/* Create an image wrapper object from an OpenGL texture object. */
+CCL_EXPORT
+CCLImage * ccl_image_new_from_gl_texture(CCLContext * ctx,
+    cl_mem_flags flags, cl_GLenum target, cl_GLint miplevel,
+    cl_GLuint texture, CCLErr ** err);
+
+/* Enqueue the acquisition of memory objects created from OpenGL
+ * objects. */
+CCL_EXPORT
+CCLEvent * ccl_memobj_enqueue_acquire_gl(CCLMemObj * const * mos,
+    cl_uint num_mos, CCLQueue * cq, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
+/* Enqueue the release of memory objects created from OpenGL objects. */
+CCL_EXPORT
+CCLEvent * ccl_memobj_enqueue_release_gl(CCLMemObj * const * mos,
+    cl_uint num_mos, CCLQueue * cq, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
+/** @} */
+
+#endif
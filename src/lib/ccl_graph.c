@@ -0,0 +1,849 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of task graphs.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_graph.h"
+#include "_ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Type of task graph node.
+ * */
+typedef enum ccl_graph_node_type {
+
+    /** Kernel node. */
+    CCL_GRAPH_NODE_KERNEL,
+
+    /** Buffer copy node. */
+    CCL_GRAPH_NODE_COPY,
+
+    /** Host node. */
+    CCL_GRAPH_NODE_HOST
+
+} CCLGraphNodeType;
+
+/**
+ * Task graph node class.
+ * */
+struct ccl_graph_node {
+
+    /**
+     * Node type.
+     * @private
+     * */
+    CCLGraphNodeType type;
+
+    /**
+     * Node name, used as name of the node events (interned string), or
+     * `NULL`.
+     * @private
+     * */
+    const char * name;
+
+    /**
+     * Kernel of kernel nodes.
+     * @private
+     * */
+    CCLKernel * krnl;
+
+    /**
+     * Number of dimensions of kernel nodes.
+     * @private
+     * */
+    cl_uint work_dim;
+
+    /**
+     * Global work offset of kernel nodes.
+     * @private
+     * */
+    size_t offset[3];
+
+    /**
+     * Global work size of kernel nodes.
+     * @private
+     * */
+    size_t gws[3];
+
+    /**
+     * Local work size of kernel nodes.
+     * @private
+     * */
+    size_t lws[3];
+
+    /**
+     * Were a global work offset and a local work size given?
+     * @private
+     * */
+    cl_bool has_offset, has_lws;
+
+    /**
+     * Source and destination buffers of copy nodes.
+     * @private
+     * */
+    CCLBuffer * src_buf, * dst_buf;
+
+    /**
+     * Source offset, destination offset and size in bytes of copy nodes.
+     * @private
+     * */
+    size_t src_offset, dst_offset, size;
+
+    /**
+     * Function and user data of host nodes.
+     * @private
+     * */
+    ccl_graph_host_fn fn;
+    void * user_data;
+
+    /**
+     * Direct predecessors of node, as given by edges.
+     * @private
+     * */
+    GPtrArray * preds;
+
+    /**
+     * Predecessors whose events the node waits on, derived on
+     * instantiation.
+     * @private
+     * */
+    GPtrArray * deps;
+
+    /**
+     * Number of direct successors of node which are command nodes.
+     * @private
+     * */
+    guint num_cmd_succs;
+
+    /**
+     * Position of node in topological order.
+     * @private
+     * */
+    guint index;
+
+    /**
+     * Command queue assigned to node, or `NULL` for host nodes.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Event of node in the last launch, or `NULL`.
+     * @private
+     * */
+    CCLEvent * evt;
+
+};
+
+/**
+ * Task graph class.
+ * */
+struct ccl_graph {
+
+    /**
+     * Nodes, in insertion order before instantiation, and in
+     * topological order after it.
+     * @private
+     * */
+    GPtrArray * nodes;
+
+    /**
+     * Command queues of instantiated graph.
+     * @private
+     * */
+    CCLQueue ** queues;
+
+    /**
+     * Number of command queues.
+     * @private
+     * */
+    cl_uint num_queues;
+
+    /**
+     * Total number of events in derived wait lists.
+     * @private
+     * */
+    cl_uint num_deps;
+
+    /**
+     * Event wait list with the events of the command nodes of the last
+     * launch on which no other command node depends.
+     * @private
+     * */
+    CCLEventWaitList done;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Create a task graph node and add it to a graph.
+ *
+ * @param[in] graph A task graph.
+ * @param[in] type Node type.
+ * @param[in] name Node name, or `NULL`.
+ * @return A new node, owned by the graph.
+ * */
+static CCLGraphNode * ccl_graph_node_new(
+    CCLGraph * graph, CCLGraphNodeType type, const char * name) {
+
+    CCLGraphNode * node = g_slice_new0(CCLGraphNode);
+
+    node->type = type;
+    node->name = name != NULL ? g_intern_string(name) : NULL;
+    node->preds = g_ptr_array_new();
+    node->deps = g_ptr_array_new();
+    g_ptr_array_add(graph->nodes, node);
+
+    return node;
+}
+
+/**
+ * @internal
+ *
+ * @brief Destroy a task graph node. Compatible with `GDestroyNotify`.
+ *
+ * @param[in] data A task graph node.
+ * */
+static void ccl_graph_node_destroy(gpointer data) {
+
+    CCLGraphNode * node = (CCLGraphNode *) data;
+
+    if (node->evt != NULL) ccl_event_destroy(node->evt);
+    if (node->krnl != NULL) ccl_kernel_unref(node->krnl);
+    if (node->src_buf != NULL) ccl_buffer_unref(node->src_buf);
+    if (node->dst_buf != NULL) ccl_buffer_unref(node->dst_buf);
+    g_ptr_array_free(node->preds, TRUE);
+    g_ptr_array_free(node->deps, TRUE);
+    g_slice_free(CCLGraphNode, node);
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the events of the last launch of a task graph.
+ *
+ * @param[in] graph A task graph.
+ * */
+static void ccl_graph_release_evts(CCLGraph * graph) {
+
+    CCLGraphNode * node;
+
+    for (guint i = 0; i < graph->nodes->len; ++i) {
+        node = g_ptr_array_index(graph->nodes, i);
+        if (node->evt != NULL) {
+            ccl_event_destroy(node->evt);
+            node->evt = NULL;
+        }
+    }
+    ccl_event_wait_list_clear(&graph->done);
+}
+
+/**
+ * @internal
+ *
+ * @brief Sort the nodes of a task graph in topological order.
+ *
+ * @param[in] graph A task graph.
+ * @return `CL_TRUE` if nodes were sorted, or `CL_FALSE` if the graph has
+ * cycles.
+ * */
+static cl_bool ccl_graph_sort(CCLGraph * graph) {
+
+    guint num_nodes = graph->nodes->len;
+    guint * in_degree = g_new0(guint, num_nodes);
+    GPtrArray * order = g_ptr_array_sized_new(num_nodes);
+    CCLGraphNode * node;
+    cl_bool sorted;
+
+    /* Count the predecessors of each node, indexing nodes by insertion
+     * order. */
+    for (guint i = 0; i < num_nodes; ++i) {
+        node = g_ptr_array_index(graph->nodes, i);
+        node->index = i;
+        in_degree[i] = node->preds->len;
+        if (node->type == CCL_GRAPH_NODE_HOST) continue;
+        for (guint j = 0; j < node->preds->len; ++j)
+            ((CCLGraphNode *)
+                g_ptr_array_index(node->preds, j))->num_cmd_succs++;
+    }
+
+    /* Repeatedly take nodes whose predecessors are all taken, keeping
+     * insertion order among ready nodes. */
+    for (cl_bool progress = CL_TRUE; progress; ) {
+        progress = CL_FALSE;
+        for (guint i = 0; i < num_nodes; ++i) {
+            if (in_degree[i] != 0) continue;
+            node = g_ptr_array_index(graph->nodes, i);
+            g_ptr_array_add(order, node);
+            in_degree[i] = G_MAXUINT;
+            progress = CL_TRUE;
+            for (guint j = 0; j < num_nodes; ++j) {
+                CCLGraphNode * succ = g_ptr_array_index(graph->nodes, j);
+                for (guint k = 0; k < succ->preds->len; ++k)
+                    if (g_ptr_array_index(succ->preds, k) == node)
+                        in_degree[j]--;
+            }
+        }
+    }
+
+    /* If all nodes were taken, replace them with the sorted ones. */
+    sorted = (order->len == num_nodes);
+    if (sorted) {
+        for (guint i = 0; i < num_nodes; ++i) {
+            node = g_ptr_array_index(order, i);
+            node->index = i;
+            g_ptr_array_index(graph->nodes, i) = node;
+        }
+    }
+
+    g_ptr_array_free(order, TRUE);
+    g_free(in_degree);
+    return sorted;
+}
+
+/**
+ * @addtogroup CCL_GRAPH
+ * @{
+ */
+
+/**
+ * Create a new, empty, task graph.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @return A new task graph.
+ * */
+CCL_EXPORT
+CCLGraph * ccl_graph_new(void) {
+
+    CCLGraph * graph = g_slice_new0(CCLGraph);
+
+    graph->nodes = g_ptr_array_new_with_free_func(ccl_graph_node_destroy);
+
+    return graph;
+}
+
+/**
+ * Destroy a task graph and its nodes, releasing the kernels, buffers and
+ * command queues used by the graph.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph The task graph to destroy.
+ * */
+CCL_EXPORT
+void ccl_graph_destroy(CCLGraph * graph) {
+
+    /* Make sure graph is not NULL. */
+    g_return_if_fail(graph != NULL);
+
+    ccl_event_wait_list_clear(&graph->done);
+    g_ptr_array_free(graph->nodes, TRUE);
+    for (cl_uint i = 0; i < graph->num_queues; ++i)
+        ccl_queue_destroy(graph->queues[i]);
+    g_free(graph->queues);
+    g_slice_free(CCLGraph, graph);
+}
+
+/**
+ * Add a kernel node to a task graph, which executes a kernel over the
+ * given range. The kernel arguments are not kept by the node, and must
+ * be set before launching the graph.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph which has not been instantiated.
+ * @param[in] name Node name, used as name of the node events for
+ * profiling purposes, or `NULL`.
+ * @param[in] krnl A kernel wrapper object, which is kept alive by the
+ * graph.
+ * @param[in] work_dim The number of dimensions used to specify the global
+ * work-items and work-items in the work-group.
+ * @param[in] global_work_offset Offset of the range, or `NULL` for no
+ * offset.
+ * @param[in] global_work_size Global work size of the range.
+ * @param[in] local_work_size Local work size, or `NULL` to let the OpenCL
+ * implementation determine it.
+ * @return A new node, owned by the graph.
+ * */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_kernel(CCLGraph * graph, const char * name,
+    CCLKernel * krnl, cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size) {
+
+    /* Make sure graph is not NULL and was not instantiated. */
+    g_return_val_if_fail(graph != NULL, NULL);
+    g_return_val_if_fail(graph->num_queues == 0, NULL);
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure the range is valid. */
+    g_return_val_if_fail((work_dim >= 1) && (work_dim <= 3), NULL);
+    g_return_val_if_fail(global_work_size != NULL, NULL);
+
+    CCLGraphNode * node =
+        ccl_graph_node_new(graph, CCL_GRAPH_NODE_KERNEL, name);
+
+    ccl_kernel_ref(krnl);
+    node->krnl = krnl;
+    node->work_dim = work_dim;
+    node->has_offset = (global_work_offset != NULL);
+    node->has_lws = (local_work_size != NULL);
+    for (cl_uint i = 0; i < work_dim; ++i) {
+        node->offset[i] = node->has_offset ? global_work_offset[i] : 0;
+        node->gws[i] = global_work_size[i];
+        node->lws[i] = node->has_lws ? local_work_size[i] : 0;
+    }
+
+    return node;
+}
+
+/**
+ * Add a buffer copy node to a task graph, which copies data from a
+ * buffer to another buffer.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph which has not been instantiated.
+ * @param[in] name Node name, used as name of the node events for
+ * profiling purposes, or `NULL`.
+ * @param[in] src_buf Source buffer, which is kept alive by the graph.
+ * @param[in] dst_buf Destination buffer, which is kept alive by the
+ * graph.
+ * @param[in] src_offset The offset where to begin copying data from
+ * `src_buf`.
+ * @param[in] dst_offset The offset where to begin copying data into
+ * `dst_buf`.
+ * @param[in] size Size in bytes to copy.
+ * @return A new node, owned by the graph.
+ * */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_copy(CCLGraph * graph, const char * name,
+    CCLBuffer * src_buf, CCLBuffer * dst_buf, size_t src_offset,
+    size_t dst_offset, size_t size) {
+
+    /* Make sure graph is not NULL and was not instantiated. */
+    g_return_val_if_fail(graph != NULL, NULL);
+    g_return_val_if_fail(graph->num_queues == 0, NULL);
+    /* Make sure buffers are not NULL. */
+    g_return_val_if_fail(src_buf != NULL, NULL);
+    g_return_val_if_fail(dst_buf != NULL, NULL);
+
+    CCLGraphNode * node =
+        ccl_graph_node_new(graph, CCL_GRAPH_NODE_COPY, name);
+
+    ccl_buffer_ref(src_buf);
+    ccl_buffer_ref(dst_buf);
+    node->src_buf = src_buf;
+    node->dst_buf = dst_buf;
+    node->src_offset = src_offset;
+    node->dst_offset = dst_offset;
+    node->size = size;
+
+    return node;
+}
+
+/**
+ * Add a host node to a task graph, which runs a function in the host.
+ *
+ * When the graph is launched, the host node function is called by
+ * ::ccl_graph_launch() after waiting for the dependencies of the node,
+ * and the nodes which depend on the host node are only enqueued after
+ * the function returns.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph which has not been instantiated.
+ * @param[in] name Node name, or `NULL`.
+ * @param[in] fn Host node function.
+ * @param[in] user_data User data passed to `fn`.
+ * @return A new node, owned by the graph.
+ * */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_host(CCLGraph * graph, const char * name,
+    ccl_graph_host_fn fn, void * user_data) {
+
+    /* Make sure graph is not NULL and was not instantiated. */
+    g_return_val_if_fail(graph != NULL, NULL);
+    g_return_val_if_fail(graph->num_queues == 0, NULL);
+    /* Make sure fn is not NULL. */
+    g_return_val_if_fail(fn != NULL, NULL);
+
+    CCLGraphNode * node =
+        ccl_graph_node_new(graph, CCL_GRAPH_NODE_HOST, name);
+
+    node->fn = fn;
+    node->user_data = user_data;
+
+    return node;
+}
+
+/**
+ * Add an edge between two nodes of a task graph, indicating that the
+ * `from` node must complete before the `to` node starts. Repeated edges
+ * are ignored.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph which has not been instantiated.
+ * @param[in] from Node which must complete first.
+ * @param[in] to Node which depends on `from`.
+ * */
+CCL_EXPORT
+void ccl_graph_add_edge(
+    CCLGraph * graph, CCLGraphNode * from, CCLGraphNode * to) {
+
+    /* Make sure graph is not NULL and was not instantiated. */
+    g_return_if_fail(graph != NULL);
+    g_return_if_fail(graph->num_queues == 0);
+    /* Make sure nodes are not NULL and are distinct. */
+    g_return_if_fail((from != NULL) && (to != NULL) && (from != to));
+
+    for (guint i = 0; i < to->preds->len; ++i)
+        if (g_ptr_array_index(to->preds, i) == from) return;
+    g_ptr_array_add(to->preds, from);
+}
+
+/**
+ * Instantiate a task graph over a set of command queues, so that it can
+ * be launched.
+ *
+ * The nodes are sorted in topological order, and each command node is
+ * assigned to a queue: a node continues in the queue of a predecessor if
+ * that predecessor is the last node assigned to its queue, and otherwise
+ * goes to the queue with the fewest nodes. The wait list of each node is
+ * then derived from its predecessors, dropping predecessors which are
+ * also predecessors of other predecessors, predecessors which are host
+ * nodes, whose completion follows from the launch order, and
+ * predecessors in the same in-order queue.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph which has not been instantiated.
+ * @param[in] queues Command queues, which are kept alive by the graph.
+ * @param[in] num_queues Number of command queues.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise, e.g. if the graph has cycles.
+ * */
+CCL_EXPORT
+cl_bool ccl_graph_instantiate(CCLGraph * graph, CCLQueue * const * queues,
+    cl_uint num_queues, CCLErr ** err) {
+
+    /* Make sure graph is not NULL and was not instantiated. */
+    g_return_val_if_fail(graph != NULL, CL_FALSE);
+    g_return_val_if_fail(graph->num_queues == 0, CL_FALSE);
+    /* Make sure queues are given. */
+    g_return_val_if_fail((queues != NULL) && (num_queues > 0), CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status = CL_FALSE;
+    guint num_nodes = graph->nodes->len;
+    guint8 * anc = NULL;
+    cl_bool * in_order = g_new0(cl_bool, num_queues);
+    CCLGraphNode ** tails = g_new0(CCLGraphNode *, num_queues);
+    guint * loads = g_new0(guint, num_queues);
+    CCLGraphNode * node, * pred;
+    cl_command_queue_properties props;
+    cl_uint q;
+    cl_bool implied;
+
+    /* Determine which queues are in-order. */
+    for (cl_uint i = 0; i < num_queues; ++i) {
+        props = ccl_queue_get_info_scalar(queues[i], CL_QUEUE_PROPERTIES,
+            cl_command_queue_properties, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        in_order[i] = !(props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+    }
+
+    /* Sort nodes. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, !ccl_graph_sort(graph),
+        CCL_ERROR_ARGS, error_handler, "%s: task graph has cycles.",
+        CCL_STRD);
+
+    /* Determine ancestors of each node, i.e. anc[v * n + u] is set if
+     * node u must complete before node v starts. */
+    anc = g_new0(guint8, num_nodes * num_nodes);
+    for (guint v = 0; v < num_nodes; ++v) {
+        node = g_ptr_array_index(graph->nodes, v);
+        for (guint j = 0; j < node->preds->len; ++j) {
+            pred = g_ptr_array_index(node->preds, j);
+            anc[v * num_nodes + pred->index] = 1;
+            for (guint u = 0; u < pred->index; ++u)
+                anc[v * num_nodes + u] |= anc[pred->index * num_nodes + u];
+        }
+    }
+
+    /* Assign command nodes to queues, continuing chains of dependent
+     * nodes in the same queue. */
+    for (guint v = 0; v < num_nodes; ++v) {
+        node = g_ptr_array_index(graph->nodes, v);
+        if (node->type == CCL_GRAPH_NODE_HOST) continue;
+        q = 0;
+        for (cl_uint i = 1; i < num_queues; ++i)
+            if (loads[i] < loads[q]) q = i;
+        for (guint j = 0; j < node->preds->len; ++j) {
+            pred = g_ptr_array_index(node->preds, j);
+            for (cl_uint i = 0; i < num_queues; ++i) {
+                if (tails[i] == pred) {
+                    q = i;
+                    j = node->preds->len;
+                    break;
+                }
+            }
+        }
+        node->cq = queues[q];
+        tails[q] = node;
+        loads[q]++;
+    }
+
+    /* Derive minimal wait lists. */
+    for (guint v = 0; v < num_nodes; ++v) {
+        node = g_ptr_array_index(graph->nodes, v);
+        for (guint j = 0; j < node->preds->len; ++j) {
+            pred = g_ptr_array_index(node->preds, j);
+            implied = (pred->type == CCL_GRAPH_NODE_HOST);
+            for (guint k = 0; k < num_nodes && !implied; ++k) {
+                if (k == pred->index) continue;
+                implied = anc[v * num_nodes + k]
+                    && anc[k * num_nodes + pred->index];
+            }
+            for (cl_uint i = 0; i < num_queues && !implied; ++i)
+                implied = in_order[i] && (node->cq == queues[i])
+                    && (pred->cq == queues[i]);
+            if (implied) continue;
+            g_ptr_array_add(node->deps, pred);
+            graph->num_deps++;
+        }
+    }
+
+    /* Keep queues. */
+    graph->queues = g_new(CCLQueue *, num_queues);
+    for (cl_uint i = 0; i < num_queues; ++i) {
+        ccl_queue_ref(queues[i]);
+        graph->queues[i] = queues[i];
+    }
+    graph->num_queues = num_queues;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    g_free(anc);
+    g_free(in_order);
+    g_free(tails);
+    g_free(loads);
+    return ret_status;
+}
+
+/**
+ * Launch an instantiated task graph, enqueuing its command nodes and
+ * running its host nodes in topological order.
+ *
+ * The events of the previous launch are released, so that the events of
+ * this launch can be obtained with ::ccl_graph_node_get_event().
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph An instantiated task graph.
+ * @param[in,out] evt_wait_lst List of events that need to complete before
+ * the nodes without predecessors start. The list will be cleared and can
+ * be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wait list, owned by the graph, with the events of the
+ * command nodes on which no other command node depends, or `NULL` if an
+ * error occurs. The list is cleared if used as a wait list, and is
+ * replaced by the next launch.
+ * */
+CCL_EXPORT
+CCLEventWaitList * ccl_graph_launch(CCLGraph * graph,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure graph is not NULL. */
+    g_return_val_if_fail(graph != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEventWaitList * done = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLGraphNode * node, * dep;
+    CCLEvent * evt;
+
+    /* Check that graph was instantiated. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, graph->num_queues == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: task graph must be instantiated before launch.", CCL_STRD);
+
+    /* Discard events of last launch. */
+    ccl_graph_release_evts(graph);
+
+    for (guint v = 0; v < graph->nodes->len; ++v) {
+
+        node = g_ptr_array_index(graph->nodes, v);
+
+        /* Build wait list of node. */
+        if (node->preds->len == 0)
+            ccl_event_wait_list_copy(&ewl, evt_wait_lst);
+        for (guint j = 0; j < node->deps->len; ++j) {
+            dep = g_ptr_array_index(node->deps, j);
+            ccl_ewl(&ewl, dep->evt, NULL);
+        }
+
+        /* Run node. */
+        evt = NULL;
+        switch (node->type) {
+            case CCL_GRAPH_NODE_KERNEL:
+                evt = ccl_kernel_enqueue_ndrange(node->krnl, node->cq,
+                    node->work_dim, node->has_offset ? node->offset : NULL,
+                    node->gws, node->has_lws ? node->lws : NULL, &ewl,
+                    &err_internal);
+                break;
+            case CCL_GRAPH_NODE_COPY:
+                evt = ccl_buffer_enqueue_copy(node->src_buf, node->dst_buf,
+                    node->cq, node->src_offset, node->dst_offset,
+                    node->size, &ewl, &err_internal);
+                break;
+            case CCL_GRAPH_NODE_HOST:
+                if (ccl_event_wait_list_get_num_events(&ewl) > 0)
+                    ccl_event_wait(&ewl, &err_internal);
+                ccl_event_wait_list_clear(&ewl);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                if (!node->fn(node->user_data, &err_internal)) {
+                    ccl_if_err_propagate_goto(
+                        err, err_internal, error_handler);
+                    ccl_if_err_create_goto(*err, CCL_ERROR, CL_TRUE,
+                        CCL_ERROR_OTHER, error_handler,
+                        "%s: host node '%s' failed.", CCL_STRD,
+                        node->name != NULL ? node->name : "(unnamed)");
+                }
+                break;
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (node->type == CCL_GRAPH_NODE_HOST) continue;
+
+        /* Keep event of command node, which other nodes wait on. */
+        ccl_if_err_create_goto(*err, CCL_ERROR, evt == NULL,
+            CCL_ERROR_OTHER, error_handler,
+            "%s: task graph queues must not be in event-less mode.",
+            CCL_STRD);
+        ccl_event_ref(evt);
+        node->evt = evt;
+        if (node->name != NULL) ccl_event_set_name(evt, node->name);
+        if (node->num_cmd_succs == 0) ccl_ewl(&graph->done, evt, NULL);
+    }
+    done = &graph->done;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Wait list of node may not have been cleared. */
+    ccl_event_wait_list_clear(&ewl);
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return wait list with events of last command nodes. */
+    return done;
+}
+
+/**
+ * Get the total number of events in the wait lists derived for the
+ * nodes of an instantiated task graph, i.e. the number of dependencies
+ * which are not implied by other dependencies or by the queue order.
+ *
+ * @public @memberof ccl_graph
+ *
+ * @param[in] graph A task graph.
+ * @return Number of events in derived wait lists.
+ * */
+CCL_EXPORT
+cl_uint ccl_graph_get_num_deps(CCLGraph * graph) {
+
+    /* Make sure graph is not NULL. */
+    g_return_val_if_fail(graph != NULL, 0);
+
+    return graph->num_deps;
+}
+
+/**
+ * Get the command queue assigned to a node of an instantiated task
+ * graph.
+ *
+ * @public @memberof ccl_graph_node
+ *
+ * @param[in] node A task graph node.
+ * @return Command queue wrapper object, owned by the graph, or `NULL` for
+ * host nodes and nodes of graphs which were not instantiated.
+ * */
+CCL_EXPORT
+CCLQueue * ccl_graph_node_get_queue(CCLGraphNode * node) {
+
+    /* Make sure node is not NULL. */
+    g_return_val_if_fail(node != NULL, NULL);
+
+    return node->cq;
+}
+
+/**
+ * Get the event of a command node of a task graph in the last launch,
+ * e.g. to inspect its profiling information.
+ *
+ * @public @memberof ccl_graph_node
+ *
+ * @param[in] node A task graph node.
+ * @return Event wrapper object, owned by the graph until the next launch,
+ * or `NULL` for host nodes and nodes which were not launched.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_graph_node_get_event(CCLGraphNode * node) {
+
+    /* Make sure node is not NULL. */
+    g_return_val_if_fail(node != NULL, NULL);
+
+    return node->evt;
+}
+
+/** @} */
@@ -0,0 +1,173 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of task graphs.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_GRAPH_H_
+#define _CCL_GRAPH_H_
+
+#include "ccl_common.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_GRAPH Task graphs
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides task graphs, which describe pipelines as directed
+ * acyclic graphs of commands, so that client code does not need to build
+ * the event wait lists of each command by hand.
+ *
+ * A graph is created with ::ccl_graph_new(), and its nodes are added with
+ * ::ccl_graph_add_kernel(), ::ccl_graph_add_copy() and
+ * ::ccl_graph_add_host(). Kernel nodes execute a kernel over a range,
+ * copy nodes copy data between buffers, and host nodes run a function in
+ * the host. Edges added with ::ccl_graph_add_edge() indicate that a node
+ * must complete before another one starts.
+ *
+ * Once complete, the graph is instantiated with ::ccl_graph_instantiate()
+ * over one or more command queues, e.g. one out-of-order queue or
+ * several in-order queues. Instantiation sorts the nodes, assigns each
+ * command node to a queue, preferring to continue chains of dependent
+ * nodes in the same queue, and derives the minimal wait list of each
+ * node: dependencies implied by other dependencies, and dependencies on
+ * earlier nodes of the same in-order queue, are dropped. The graph can
+ * then be launched many times with ::ccl_graph_launch(), which enqueues
+ * all command nodes and runs host nodes in topological order. Events of
+ * command nodes are named after their nodes, so that the profiler
+ * reports them by node name.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLGraph * graph;
+ * CCLGraphNode * upload, * filter, * download;
+ * CCLQueue * queues[] = { cq1, cq2 };
+ * @endcode
+ * @code{.c}
+ * graph = ccl_graph_new();
+ * upload = ccl_graph_add_copy(graph, "upload", staging, img, 0, 0, size);
+ * filter = ccl_graph_add_kernel(graph, "filter", krnl, 2, NULL, gws, lws);
+ * download = ccl_graph_add_copy(graph, "download", out, result, 0, 0, size);
+ * ccl_graph_add_edge(graph, upload, filter);
+ * ccl_graph_add_edge(graph, filter, download);
+ * ccl_graph_instantiate(graph, queues, 2, NULL);
+ * @endcode
+ * @code{.c}
+ * for (frame = 0; frame < num_frames; ++frame)
+ *     ccl_event_wait(ccl_graph_launch(graph, NULL, NULL), NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_graph_destroy(graph);
+ * @endcode
+ *
+ * @attention Kernel arguments must be set before launching the graph, and
+ * are shared by all nodes of the same kernel. Host nodes block the
+ * launching thread until their dependencies complete. A graph must only
+ * be used by one host thread at a time, and its queues must not be in
+ * event-less mode.
+ *
+ * @{
+ */
+
+/**
+ * Task graph class.
+ * */
+typedef struct ccl_graph CCLGraph;
+
+/**
+ * Task graph node class.
+ * */
+typedef struct ccl_graph_node CCLGraphNode;
+
+/**
+ * A host node function, run by ::ccl_graph_launch() once the
+ * dependencies of the node have completed.
+ *
+ * @param[in] user_data User data given to ::ccl_graph_add_host().
+ * @param[out] err Return location for a ::CCLErr object.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+typedef cl_bool (*ccl_graph_host_fn)(void * user_data, CCLErr ** err);
+
+/* Create a new, empty, task graph. */
+CCL_EXPORT
+CCLGraph * ccl_graph_new(void);
+
+/* Destroy a task graph and its nodes. */
+CCL_EXPORT
+void ccl_graph_destroy(CCLGraph * graph);
+
+/* Add a kernel node to a task graph. */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_kernel(CCLGraph * graph, const char * name,
+    CCLKernel * krnl, cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size);
+
+/* Add a buffer copy node to a task graph. */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_copy(CCLGraph * graph, const char * name,
+    CCLBuffer * src_buf, CCLBuffer * dst_buf, size_t src_offset,
+    size_t dst_offset, size_t size);
+
+/* Add a host node to a task graph. */
+CCL_EXPORT
+CCLGraphNode * ccl_graph_add_host(CCLGraph * graph, const char * name,
+    ccl_graph_host_fn fn, void * user_data);
+
+/* Add an edge between two nodes of a task graph. */
+CCL_EXPORT
+void ccl_graph_add_edge(
+    CCLGraph * graph, CCLGraphNode * from, CCLGraphNode * to);
+
+/* Instantiate a task graph over a set of command queues. */
+CCL_EXPORT
+cl_bool ccl_graph_instantiate(CCLGraph * graph, CCLQueue * const * queues,
+    cl_uint num_queues, CCLErr ** err);
+
+/* Launch an instantiated task graph. */
+CCL_EXPORT
+CCLEventWaitList * ccl_graph_launch(CCLGraph * graph,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Get total number of events in the wait lists derived for a task
+ * graph. */
+CCL_EXPORT
+cl_uint ccl_graph_get_num_deps(CCLGraph * graph);
+
+/* Get command queue assigned to a node of a task graph. */
+CCL_EXPORT
+CCLQueue * ccl_graph_node_get_queue(CCLGraphNode * node);
+
+/* Get event of a node of a task graph in the last launch. */
+CCL_EXPORT
+CCLEvent * ccl_graph_node_get_event(CCLGraphNode * node);
+
+/** @} */
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of bulk conversion functions between single and half
+ * precision floating point arrays.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_half.h"
+#include "_ccl_defs.h"
+
+/* Hardware conversion instructions available for the host processor. On
+ * x86, F16C and AVX-512 are compiled in with target attributes and
+ * selected at runtime, so no special compiler flags are required. */
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+    #define CCL_HALF_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #define CCL_HALF_NEON
+    #include <arm_neon.h>
+#endif
+
+/**
+ * @internal
+ *
+ * @brief Convert a single precision value to half precision, rounding to
+ * the nearest even value.
+ *
+ * @param[in] f Single precision value.
+ * @return Half precision value.
+ * */
+static inline cl_half ccl_half_from_float1(cl_float f) {
+
+    union { cl_float f; cl_uint u; } v;
+    cl_uint sign, abs, h;
+
+    v.f = f;
+    sign = (v.u >> 16) & 0x8000;
+    abs = v.u & 0x7FFFFFFF;
+
+    if (abs >= 0x7F800000) {
+        /* Infinity or NaN, keeping NaNs quiet. */
+        h = (abs > 0x7F800000) ? (0x7E00 | ((abs >> 13) & 0x3FF)) : 0x7C00;
+    } else if (abs >= 0x477FF000) {
+        /* Values which round to more than the largest half. */
+        h = 0x7C00;
+    } else if (abs >= 0x38800000) {
+        /* Normal half: rebias exponent and round mantissa. */
+        h = abs - 0x38000000;
+        h = (h + 0xFFF + ((h >> 13) & 1)) >> 13;
+    } else if (abs > 0x33000000) {
+        /* Subnormal half: shift mantissa with the implicit bit. */
+        cl_uint m = (abs & 0x7FFFFF) | 0x800000;
+        cl_uint shift = 126 - (abs >> 23);
+        cl_uint rem = m & ((1u << shift) - 1);
+        cl_uint half = 1u << (shift - 1);
+        h = m >> shift;
+        if ((rem > half) || ((rem == half) && (h & 1))) h++;
+    } else {
+        /* Values which round to zero. */
+        h = 0;
+    }
+
+    return (cl_half) (sign | h);
+}
+
+/**
+ * @internal
+ *
+ * @brief Convert a half precision value to single precision. The
+ * conversion is exact.
+ *
+ * @param[in] h Half precision value.
+ * @return Single precision value.
+ * */
+static inline cl_float ccl_half_to_float1(cl_half h) {
+
+    union { cl_float f; cl_uint u; } v;
+    cl_uint sign = ((cl_uint) h & 0x8000) << 16;
+    cl_uint exp = ((cl_uint) h >> 10) & 0x1F;
+    cl_uint mant = (cl_uint) h & 0x3FF;
+
+    if (exp == 0x1F) {
+        /* Infinity or NaN, keeping NaNs quiet. */
+        v.u = sign | 0x7F800000 | (mant != 0 ? 0x400000 : 0) | (mant << 13);
+    } else if (exp != 0) {
+        /* Normal value. */
+        v.u = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if (mant != 0) {
+        /* Subnormal value, which is normal in single precision. */
+        exp = 113;
+        while (!(mant & 0x400)) {
+            mant <<= 1;
+            exp--;
+        }
+        v.u = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+    } else {
+        /* Zero. */
+        v.u = sign;
+    }
+
+    return v.f;
+}
+
+#ifdef CCL_HALF_X86
+
+/**
+ * @internal
+ *
+ * @brief Convert single to half precision with AVX-512 instructions,
+ * sixteen values at a time.
+ *
+ * @return Number of converted values, which is a multiple of sixteen.
+ * */
+__attribute__((target("avx512f")))
+static size_t ccl_half_from_float_avx512(
+    cl_half * dst, const cl_float * src, size_t n) {
+
+    size_t i;
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m512 f = _mm512_loadu_ps(src + i);
+        _mm256_storeu_si256((__m256i *) (dst + i),
+            _mm512_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    return i;
+}
+
+/**
+ * @internal
+ *
+ * @brief Convert half to single precision with AVX-512 instructions,
+ * sixteen values at a time.
+ *
+ * @return Number of converted values, which is a multiple of sixteen.
+ * */
+__attribute__((target("avx512f")))
+static size_t ccl_half_to_float_avx512(
+    cl_float * dst, const cl_half * src, size_t n) {
+
+    size_t i;
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m256i h = _mm256_loadu_si256((const __m256i *) (src + i));
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(h));
+    }
+    return i;
+}
+
+/**
+ * @internal
+ *
+ * @brief Convert single to half precision with F16C instructions, eight
+ * values at a time.
+ *
+ * @return Number of converted values, which is a multiple of eight.
+ * */
+__attribute__((target("avx,f16c")))
+static size_t ccl_half_from_float_f16c(
+    cl_half * dst, const cl_float * src, size_t n) {
+
+    size_t i;
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256 f = _mm256_loadu_ps(src + i);
+        _mm_storeu_si128((__m128i *) (dst + i),
+            _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    return i;
+}
+
+/**
+ * @internal
+ *
+ * @brief Convert half to single precision with F16C instructions, eight
+ * values at a time.
+ *
+ * @return Number of converted values, which is a multiple of eight.
+ * */
+__attribute__((target("avx,f16c")))
+static size_t ccl_half_to_float_f16c(
+    cl_float * dst, const cl_half * src, size_t n) {
+
+    size_t i;
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+#endif
+
+/**
+ * Convert an array of single precision values to half precision. Values
+ * are rounded to the nearest even half precision value, and values out
+ * of range are converted to infinity.
+ *
+ * The best conversion instructions available in the host processor are
+ * used. `dst` and `src` must not overlap.
+ *
+ * @param[out] dst Location where to place `n` half precision values.
+ * @param[in] src Array of `n` single precision values.
+ * @param[in] n Number of values to convert.
+ * */
+CCL_EXPORT
+void ccl_half_from_float_array(
+    cl_half * dst, const cl_float * src, size_t n) {
+
+    /* Make sure dst and src are not NULL. */
+    g_return_if_fail((dst != NULL) || (n == 0));
+    g_return_if_fail((src != NULL) || (n == 0));
+
+    /* Number of values already converted. */
+    size_t i = 0;
+
+    /* Convert as many values as possible with vector instructions. */
+#if defined(CCL_HALF_X86)
+    if (__builtin_cpu_supports("avx512f"))
+        i = ccl_half_from_float_avx512(dst, src, n);
+    else if (__builtin_cpu_supports("f16c"))
+        i = ccl_half_from_float_f16c(dst, src, n);
+#elif defined(CCL_HALF_NEON)
+    for (; i + 4 <= n; i += 4)
+        vst1_u16((uint16_t *) (dst + i), vreinterpret_u16_f16(
+            vcvt_f16_f32(vld1q_f32((const float32_t *) (src + i)))));
+#endif
+
+    /* Convert remaining values one at a time. */
+    for (; i < n; ++i)
+        dst[i] = ccl_half_from_float1(src[i]);
+}
+
+/**
+ * Convert an array of half precision values to single precision. The
+ * conversion is exact.
+ *
+ * The best conversion instructions available in the host processor are
+ * used. `dst` and `src` must not overlap.
+ *
+ * @param[out] dst Location where to place `n` single precision values.
+ * @param[in] src Array of `n` half precision values.
+ * @param[in] n Number of values to convert.
+ * */
+CCL_EXPORT
+void ccl_half_to_float_array(
+    cl_float * dst, const cl_half * src, size_t n) {
+
+    /* Make sure dst and src are not NULL. */
+    g_return_if_fail((dst != NULL) || (n == 0));
+    g_return_if_fail((src != NULL) || (n == 0));
+
+    /* Number of values already converted. */
+    size_t i = 0;
+
+    /* Convert as many values as possible with vector instructions. */
+#if defined(CCL_HALF_X86)
+    if (__builtin_cpu_supports("avx512f"))
+        i = ccl_half_to_float_avx512(dst, src, n);
+    else if (__builtin_cpu_supports("f16c"))
+        i = ccl_half_to_float_f16c(dst, src, n);
+#elif defined(CCL_HALF_NEON)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32((float32_t *) (dst + i), vcvt_f32_f16(vreinterpret_f16_u16(
+            vld1_u16((const uint16_t *) (src + i)))));
+#endif
+
+    /* Convert remaining values one at a time. */
+    for (; i < n; ++i)
+        dst[i] = ccl_half_to_float1(src[i]);
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of bulk conversion functions between single and half
+ * precision floating point arrays.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_HALF_H_
+#define _CCL_HALF_H_
+
+#include "ccl_common.h"
+
+/**
+ * @defgroup CCL_HALF Half precision conversion
+ *
+ * This module provides bulk conversion functions between arrays of
+ * `cl_float` and arrays of `cl_half`, the host representation of the
+ * OpenCL `half` type.
+ *
+ * Converting large arrays one value at a time is slow. The functions in
+ * this module use the hardware conversion instructions of the host
+ * processor when available: F16C or AVX-512 on x86 (detected at runtime)
+ * and NEON on 64-bit ARM. Otherwise, a portable implementation is used.
+ * In all cases, conversion to half precision rounds to the nearest even
+ * value, and out of range values are converted to infinity.
+ *
+ * The functions operate on plain host memory, so they can be used
+ * directly on mapped buffers. Half precision data can also be converted
+ * on the fly into the slots of a staging ring with
+ * ::ccl_staging_enqueue_write_half().
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * cl_half * h;
+ * @endcode
+ * @code{.c}
+ * h = ccl_buffer_enqueue_map(buf, cq, CL_TRUE, CL_MAP_WRITE, 0,
+ *     n * sizeof(cl_half), NULL, NULL, NULL);
+ * ccl_half_from_float_array(h, weights, n);
+ * ccl_buffer_enqueue_unmap(buf, cq, h, NULL, NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/* Convert an array of single precision values to half precision. */
+CCL_EXPORT
+void ccl_half_from_float_array(
+    cl_half * dst, const cl_float * src, size_t n);
+
+/* Convert an array of half precision values to single precision. */
+CCL_EXPORT
+void ccl_half_to_float_array(
+    cl_float * dst, const cl_half * src, size_t n);
+
+/** @} */
+
+#endif
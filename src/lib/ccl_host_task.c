@@ -0,0 +1,284 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of host tasks and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_host_task.h"
+#include "ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief A host task waiting to run or running.
+ * */
+struct ccl_host_task {
+
+    /**
+     * Host task function.
+     * @private
+     * */
+    ccl_host_task_fn fn;
+
+    /**
+     * User data for host task function.
+     * @private
+     * */
+    void * user_data;
+
+    /**
+     * User event which signals the host task completion. Only the OpenCL
+     * object is kept, so that no wrappers are referenced by running host
+     * tasks.
+     * @private
+     * */
+    cl_event uevent;
+
+};
+
+/* Lock protecting the host task thread pool. */
+static GMutex host_task_lock;
+
+/* Thread pool which runs host tasks, created on first use. */
+static GThreadPool * host_task_pool = NULL;
+
+/* Maximum number of threads for running host tasks, zero for one
+ * thread per processor. */
+static cl_uint host_task_max_threads = 0;
+
+/**
+ * @internal
+ *
+ * @brief Signal the completion of a host task and release it.
+ *
+ * @param[in] task The host task.
+ * @param[in] status Execution status of host task, `CL_COMPLETE` or a
+ * negative value.
+ * */
+static void ccl_host_task_finish(struct ccl_host_task * task, cl_int status) {
+
+#ifdef CL_VERSION_1_1
+    clSetUserEventStatus(task->uevent, status);
+#else
+    CCL_UNUSED(status);
+#endif
+    clReleaseEvent(task->uevent);
+    g_slice_free(struct ccl_host_task, task);
+}
+
+/**
+ * @internal
+ *
+ * @brief Thread pool function which runs a host task.
+ *
+ * @param[in] data The host task.
+ * @param[in] pool_data Not used.
+ * */
+static void ccl_host_task_run(gpointer data, gpointer pool_data) {
+
+    struct ccl_host_task * task = (struct ccl_host_task *) data;
+    cl_int status;
+
+    CCL_UNUSED(pool_data);
+
+    /* Run host function, only negative values are errors. */
+    status = task->fn(task->user_data);
+    ccl_host_task_finish(task, status < 0 ? status : CL_COMPLETE);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the host task thread pool, creating it if necessary.
+ *
+ * @return The host task thread pool.
+ * */
+static GThreadPool * ccl_host_task_pool_get() {
+
+    GThreadPool * pool;
+
+    g_mutex_lock(&host_task_lock);
+    if (host_task_pool == NULL) {
+        host_task_pool = g_thread_pool_new(ccl_host_task_run, NULL,
+            host_task_max_threads > 0
+                ? (gint) host_task_max_threads : (gint) g_get_num_processors(),
+            FALSE, NULL);
+    }
+    pool = host_task_pool;
+    g_mutex_unlock(&host_task_lock);
+
+    return pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Event callback which hands a host task to the thread pool once
+ * the commands it depends on have completed.
+ *
+ * @param[in] event Event on which the host task depends.
+ * @param[in] status Execution status of `event`.
+ * @param[in] user_data The host task.
+ * */
+static void CL_CALLBACK ccl_host_task_ready(
+    cl_event event, cl_int status, void * user_data) {
+
+    struct ccl_host_task * task = (struct ccl_host_task *) user_data;
+
+    CCL_UNUSED(event);
+
+    /* If the commands on which the host task depends failed, propagate
+     * their error without running the host task. */
+    if (status < 0)
+        ccl_host_task_finish(task, status);
+    else
+        g_thread_pool_push(ccl_host_task_pool_get(), task, NULL);
+}
+
+/**
+ * @addtogroup CCL_HOST_TASK
+ * @{
+ */
+
+/**
+ * Enqueue a host task, which runs a host function in a thread pool,
+ * ordered with the commands in the queue. The host function starts once
+ * all commands previously enqueued in `cq` and the events in
+ * `evt_wait_lst` have completed, and commands enqueued afterwards in `cq`
+ * only start after the host function returns.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] fn Host function to run.
+ * @param[in] user_data User data passed to `fn`.
+ * @param[in,out] evt_wait_lst List of events that need to complete before
+ * the host task can be executed. The list will be cleared and can be
+ * reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event wrapper object which completes when the host task
+ * completes, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_enqueue_host_task(CCLQueue * cq, ccl_host_task_fn fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure fn is not NULL. */
+    g_return_val_if_fail(fn != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Queue context. */
+    CCLContext * ctx;
+    /* User event signaling host task completion. */
+    CCLEvent * uevt = NULL;
+    /* Events of barriers before and after the host task. */
+    CCLEvent * evt_start, * evt = NULL;
+    /* Event wait list for barrier after the host task. */
+    CCLEventWaitList ewl = NULL;
+    /* The host task. */
+    struct ccl_host_task * task;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Create user event which signals host task completion. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    uevt = ccl_user_event_new(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Barrier which completes when the host task can start. */
+    evt_start = ccl_enqueue_barrier(cq, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Barrier which blocks the queue until the host task completes. */
+    evt = ccl_enqueue_barrier(cq, ccl_ewl(&ewl, uevt, NULL), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Setup host task. */
+    task = g_slice_new(struct ccl_host_task);
+    task->fn = fn;
+    task->user_data = user_data;
+    task->uevent = ccl_event_unwrap(uevt);
+    clRetainEvent(task->uevent);
+
+    /* Start host task when the commands it depends on have completed. */
+    ccl_event_set_callback(
+        evt_start, CL_COMPLETE, ccl_host_task_ready, task, &err_internal);
+    if (err_internal != NULL) {
+        /* Host task will not run, unblock the queue with an error. */
+        ccl_host_task_finish(task, CL_INVALID_OPERATION);
+    }
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* In case of error, return NULL. */
+    evt = NULL;
+
+finish:
+
+    /* Release our reference to the user event. */
+    if (uevt != NULL) ccl_event_destroy(uevt);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Set the maximum number of threads used for running host tasks. By
+ * default, one thread per processor is used.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] max_threads Maximum number of threads, or zero for one
+ * thread per processor.
+ * */
+CCL_EXPORT
+void ccl_host_task_set_max_threads(cl_uint max_threads) {
+
+    g_mutex_lock(&host_task_lock);
+    host_task_max_threads = max_threads;
+    if (host_task_pool != NULL) {
+        g_thread_pool_set_max_threads(host_task_pool, max_threads > 0
+            ? (gint) max_threads : (gint) g_get_num_processors(), NULL);
+    }
+    g_mutex_unlock(&host_task_lock);
+}
+
+/** @} */
@@ -0,0 +1,93 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of host tasks and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_HOST_TASK_H_
+#define _CCL_HOST_TASK_H_
+
+#include "ccl_common.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_HOST_TASK Host tasks
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides host tasks, i.e. host functions which are
+ * enqueued in a command queue as if they were OpenCL commands, and which
+ * are executed by a thread pool managed by _cf4ocl_.
+ *
+ * Unlike ::ccl_kernel_enqueue_native(), host tasks don't require the
+ * device to support native kernels. A host task starts once all
+ * commands previously enqueued in the queue, and the events in the
+ * given wait list, have completed; commands enqueued afterwards in the
+ * same queue only start after the host task finishes. Since host tasks
+ * run in their own threads, commands in other queues which don't
+ * depend on the host task keep the devices busy meanwhile.
+ *
+ * Ordering is implemented with barriers and a user event, so host tasks
+ * require OpenCL >= 1.1.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * cl_int CL_CALLBACK postprocess(void * user_data) {
+ *     struct frame * f = (struct frame *) user_data;
+ *     encode_frame(f);
+ *     return CL_COMPLETE;
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_buffer_enqueue_read(buf, cq, CL_FALSE, 0, size, f->data, NULL, NULL);
+ * ccl_enqueue_host_task(cq, postprocess, f, NULL, NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/**
+ * A host task function.
+ *
+ * @param[in] user_data User data given to ::ccl_enqueue_host_task().
+ * @return `CL_COMPLETE` if the host task completed successfully, or a
+ * negative integer value, which will be the execution status of the
+ * host task, otherwise.
+ * */
+typedef cl_int (CL_CALLBACK * ccl_host_task_fn)(void * user_data);
+
+/* Enqueue a host task, which runs a host function in a thread pool,
+ * ordered with the commands in the queue. */
+CCL_EXPORT
+CCLEvent * ccl_enqueue_host_task(CCLQueue * cq, ccl_host_task_fn fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Set the maximum number of threads used for running host tasks. */
+CCL_EXPORT
+void ccl_host_task_set_max_threads(cl_uint max_threads);
+
+/** @} */
+
+#endif
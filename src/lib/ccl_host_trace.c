@@ -0,0 +1,133 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of the timing of host-side calls of wrapper functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+/* Required for clock_gettime() when compiling with -std=c99. */
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 199309L
+    #include <time.h>
+#else
+    #include <windows.h>
+#endif
+
+#include "ccl_profiler.h"
+#include "_ccl_host_trace.h"
+
+/**
+ * @internal
+ * Is host-side tracing enabled?
+ * */
+static volatile gint host_trace_enabled = 0;
+
+/**
+ * @internal
+ *
+ * @brief Get current instant of a monotonic host clock, in nanoseconds.
+ *
+ * @return Current instant of a monotonic host clock, in nanoseconds.
+ * */
+static guint64 ccl_host_trace_now(void) {
+
+#if defined(_WIN32)
+
+    /* Use performance counter. */
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER count;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (guint64) (count.QuadPart / freq.QuadPart) * 1000000000
+        + (guint64) (count.QuadPart % freq.QuadPart) * 1000000000
+        / freq.QuadPart;
+
+#elif defined(CLOCK_MONOTONIC)
+
+    /* Use POSIX monotonic clock. */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (guint64) ts.tv_sec * 1000000000 + (guint64) ts.tv_nsec;
+
+#else
+
+    /* Fall back to GLib monotonic clock, with microsecond resolution. */
+    return (guint64) g_get_monotonic_time() * 1000;
+
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Start timing a host call.
+ *
+ * @return Instant at which the call started, in nanoseconds, or zero if
+ * host-side tracing is disabled.
+ * */
+guint64 ccl_host_trace_begin(void) {
+
+    if (!g_atomic_int_get(&host_trace_enabled)) return 0;
+    return ccl_host_trace_now();
+}
+
+/**
+ * @internal
+ *
+ * @brief Finish timing a host call, recording its duration.
+ *
+ * @param[in] func_name Name of wrapper function, which must be a static
+ * string, since it is used as key.
+ * @param[in] t_begin Instant at which the call started, as returned by
+ * ccl_host_trace_begin().
+ * */
+void ccl_host_trace_end(const char * func_name, guint64 t_begin) {
+
+    ccl_prof_host_record(func_name, ccl_host_trace_now() - t_begin);
+}
+
+/**
+ * Enable or disable tracing of host-side calls of wrapper functions.
+ *
+ * When enabled, the host time spent in the main wrapper entry points,
+ * e.g. ::ccl_kernel_enqueue_ndrange(), the `ccl_buffer_enqueue_*()`
+ * functions, ::ccl_wrapper_get_info() or ::ccl_program_build_full(), is
+ * recorded in per-function histograms. These include the time spent in the
+ * respective OpenCL calls, i.e. in the driver. Recorded calls are
+ * available in profile objects after ::ccl_prof_calc(), via the
+ * ::ccl_prof_iter_host_init() and ::ccl_prof_iter_host_next() functions
+ * and in the profiling summary.
+ *
+ * Host-side tracing is disabled by default. It can be compiled out of the
+ * library by disabling the `HOST_TRACE` CMake option, in which case this
+ * function has no effect.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] enable `CL_TRUE` to enable tracing, `CL_FALSE` to disable it.
+ * */
+CCL_EXPORT
+void ccl_prof_host_trace_enable(cl_bool enable) {
+
+    g_atomic_int_set(&host_trace_enabled, enable ? 1 : 0);
+}
@@ -0,0 +1,717 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of context-level image pools and image rings.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "_ccl_image_pool.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Key of a bucket of pooled images.
+ * */
+typedef struct ccl_image_pool_key {
+
+    /**
+     * Memory flags of images.
+     * @private
+     * */
+    cl_mem_flags flags;
+
+    /**
+     * Format of images.
+     * @private
+     * */
+    cl_image_format format;
+
+    /**
+     * Type of images.
+     * @private
+     * */
+    cl_mem_object_type image_type;
+
+    /**
+     * Width, height, depth and array size of images, where unused
+     * dimensions are 1.
+     * @private
+     * */
+    size_t dims[4];
+
+} CCLImagePoolKey;
+
+/**
+ * @internal
+ *
+ * @brief Bucket of pooled images.
+ * */
+typedef struct ccl_image_pool_bucket {
+
+    /**
+     * Pooled images, most recently pooled first.
+     * @private
+     * */
+    GQueue imgs;
+
+    /**
+     * Size in bytes of each image in bucket.
+     * @private
+     * */
+    size_t img_size;
+
+} CCLImagePoolBucket;
+
+/**
+ * @internal
+ *
+ * @brief Image pool of a context.
+ * */
+struct ccl_image_pool {
+
+    /**
+     * Buckets of pooled images (keys: ::CCLImagePoolKey*; values:
+     * ::CCLImagePoolBucket*).
+     * @private
+     * */
+    GHashTable * buckets;
+
+    /**
+     * Total size in bytes of pooled images.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * High-water mark in bytes, i.e. maximum total size of pooled images.
+     * @private
+     * */
+    size_t max_size;
+
+};
+
+/**
+ * Ring of images for double or triple buffering.
+ * */
+struct ccl_image_ring {
+
+    /**
+     * Context whose image pool provides the images.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Images in ring.
+     * @private
+     * */
+    CCLImage ** imgs;
+
+    /**
+     * Event of the last command using each image, or `NULL` if none is
+     * pending (array of `cl_event`, of size ::ccl_image_ring::num_imgs).
+     * @private
+     * */
+    cl_event * evts;
+
+    /**
+     * Number of images in ring.
+     * @private
+     * */
+    cl_uint num_imgs;
+
+    /**
+     * Index of image last returned by ccl_image_ring_next().
+     * @private
+     * */
+    cl_uint cur;
+
+};
+
+/* Lock protecting the image pools of all contexts. */
+static GMutex pool_lock;
+
+/**
+ * @internal
+ *
+ * @brief Initialize a bucket key, setting unused image dimensions to 1, so
+ * that keys for images described by client code match keys for images
+ * described by OpenCL.
+ *
+ * @param[out] key Bucket key to initialize.
+ * @param[in] flags Memory flags of image.
+ * @param[in] image_format Format of image.
+ * @param[in] image_type Type of image.
+ * @param[in] width Width of image.
+ * @param[in] height Height of image.
+ * @param[in] depth Depth of image.
+ * @param[in] array_size Array size of image.
+ * */
+static void ccl_image_pool_key_init(CCLImagePoolKey * key,
+    cl_mem_flags flags, const cl_image_format * image_format,
+    cl_mem_object_type image_type, size_t width, size_t height,
+    size_t depth, size_t array_size) {
+
+    key->flags = flags;
+    key->format = *image_format;
+    key->image_type = image_type;
+    key->dims[0] = width;
+    key->dims[1] = MAX(height, 1);
+    key->dims[2] = image_type == CL_MEM_OBJECT_IMAGE3D ? MAX(depth, 1) : 1;
+    key->dims[3] = MAX(array_size, 1);
+}
+
+/**
+ * @internal
+ *
+ * @brief Hash function for bucket keys.
+ *
+ * @param[in] key Bucket key.
+ * @return Hash value.
+ * */
+static guint ccl_image_pool_key_hash(gconstpointer key) {
+
+    const CCLImagePoolKey * k = (const CCLImagePoolKey *) key;
+    guint h = (guint) k->flags * 31 + (guint) k->image_type;
+
+    h = h * 31 + (guint) k->format.image_channel_order;
+    h = h * 31 + (guint) k->format.image_channel_data_type;
+    for (guint i = 0; i < 4; ++i)
+        h = h * 31 + (guint) k->dims[i];
+    return h;
+}
+
+/**
+ * @internal
+ *
+ * @brief Equality function for bucket keys.
+ *
+ * @param[in] a First bucket key.
+ * @param[in] b Second bucket key.
+ * @return `TRUE` if keys are equal, `FALSE` otherwise.
+ * */
+static gboolean ccl_image_pool_key_equal(gconstpointer a, gconstpointer b) {
+
+    const CCLImagePoolKey * k1 = (const CCLImagePoolKey *) a;
+    const CCLImagePoolKey * k2 = (const CCLImagePoolKey *) b;
+    return (k1->flags == k2->flags)
+        && (k1->image_type == k2->image_type)
+        && (k1->format.image_channel_order
+            == k2->format.image_channel_order)
+        && (k1->format.image_channel_data_type
+            == k2->format.image_channel_data_type)
+        && (k1->dims[0] == k2->dims[0]) && (k1->dims[1] == k2->dims[1])
+        && (k1->dims[2] == k2->dims[2]) && (k1->dims[3] == k2->dims[3]);
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the images in a bucket and the bucket itself.
+ *
+ * @param[in] bucket Bucket of pooled images.
+ * */
+static void ccl_image_pool_bucket_free(gpointer bucket) {
+
+    CCLImagePoolBucket * b = (CCLImagePoolBucket *) bucket;
+    g_queue_clear_full(&b->imgs, (GDestroyNotify) ccl_image_destroy);
+    g_slice_free(CCLImagePoolBucket, b);
+}
+
+/**
+ * @internal
+ *
+ * @brief Destroy an image pool, releasing pooled images.
+ *
+ * @param[in] pool Image pool to destroy.
+ * */
+void ccl_image_pool_destroy(CCLImagePool * pool) {
+
+    g_hash_table_destroy(pool->buckets);
+    g_slice_free(CCLImagePool, pool);
+}
+
+/**
+ * @addtogroup CCL_IMAGE_POOL
+ * @{
+ */
+
+/**
+ * Enable the image pool of a context, or change the high-water mark of
+ * an enabled pool. Pooled images beyond the new high-water mark are
+ * released.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] max_size High-water mark in bytes, i.e. maximum total size
+ * of pooled images, or 0 for ::CCL_IMAGE_POOL_MAX_SIZE.
+ * */
+CCL_EXPORT
+void ccl_image_pool_enable(CCLContext * ctx, size_t max_size) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    /* Image pool of context. */
+    CCLImagePool * pool;
+
+    /* Effective high-water mark. */
+    size_t max = max_size > 0 ? max_size : CCL_IMAGE_POOL_MAX_SIZE;
+
+    g_mutex_lock(&pool_lock);
+
+    /* Create pool if it does not exist yet. */
+    pool = ccl_context_get_image_pool(ctx);
+    if (pool == NULL) {
+        pool = g_slice_new0(CCLImagePool);
+        pool->buckets = g_hash_table_new_full(ccl_image_pool_key_hash,
+            ccl_image_pool_key_equal, g_free, ccl_image_pool_bucket_free);
+        ccl_context_set_image_pool(ctx, pool);
+    }
+
+    /* Set high-water mark. */
+    pool->max_size = max;
+
+    g_mutex_unlock(&pool_lock);
+
+    /* Release images beyond high-water mark. */
+    ccl_image_pool_trim(ctx, max);
+}
+
+/**
+ * Disable the image pool of a context, releasing pooled images.
+ *
+ * @param[in] ctx Context wrapper object.
+ * */
+CCL_EXPORT
+void ccl_image_pool_disable(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+
+    /* Image pool of context. */
+    CCLImagePool * pool;
+
+    /* Detach pool from context. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_image_pool(ctx);
+    ccl_context_set_image_pool(ctx, NULL);
+    g_mutex_unlock(&pool_lock);
+
+    /* Destroy pool, if any. */
+    if (pool != NULL)
+        ccl_image_pool_destroy(pool);
+}
+
+/**
+ * Get an image from the image pool of a context. If the pool has an
+ * image with the given flags, format, type and dimensions, it is reused,
+ * otherwise a new image is created with ::ccl_image_new_v().
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] flags OpenCL memory flags as used in ::ccl_image_new_v(),
+ * which cannot include `CL_MEM_USE_HOST_PTR` nor `CL_MEM_COPY_HOST_PTR`.
+ * @param[in] image_format Format of image.
+ * @param[in] img_dsc Type and dimensions of image. Pitches must be 0, and
+ * no memory object can be specified.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An image wrapper object, which should be returned to the pool
+ * with ccl_image_pool_put(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLImage * ccl_image_pool_get(CCLContext * ctx, cl_mem_flags flags,
+    const cl_image_format * image_format, const CCLImageDesc * img_dsc,
+    CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure image_format and img_dsc are not NULL. */
+    g_return_val_if_fail((image_format != NULL) && (img_dsc != NULL), NULL);
+    /* Make sure no host pointer or memory object is required. */
+    g_return_val_if_fail(
+        (flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) == 0, NULL);
+    g_return_val_if_fail(img_dsc->memobj == NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Image pool of context, bucket key and bucket. */
+    CCLImagePool * pool;
+    CCLImagePoolKey key;
+    CCLImagePoolBucket * bucket;
+    /* Image to return. */
+    CCLImage * img = NULL;
+
+    /* Bucket key. */
+    ccl_image_pool_key_init(&key, flags, image_format, img_dsc->image_type,
+        img_dsc->image_width, img_dsc->image_height, img_dsc->image_depth,
+        img_dsc->image_array_size);
+
+    /* Take most recently pooled image from bucket, if any. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_image_pool(ctx);
+    if (pool != NULL) {
+        bucket = g_hash_table_lookup(pool->buckets, &key);
+        if ((bucket != NULL) && (!g_queue_is_empty(&bucket->imgs))) {
+            img = g_queue_pop_head(&bucket->imgs);
+            pool->size -= bucket->img_size;
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Otherwise create a new image. */
+    if (img == NULL)
+        img = ccl_image_new_v(ctx, flags, image_format, img_dsc, NULL, err);
+
+    /* Return image. */
+    return img;
+}
+
+/**
+ * Return an image to the image pool of a context, consuming the caller's
+ * reference to it. The image is released instead of being pooled if the
+ * pool is not enabled, if the image is still referenced elsewhere, if it
+ * was created with a host pointer, or if pooling it would exceed the pool
+ * high-water mark.
+ *
+ * @param[in] ctx Context wrapper object, which must be the image context.
+ * @param[in] img Image wrapper object, usually obtained with
+ * ccl_image_pool_get().
+ * */
+CCL_EXPORT
+void ccl_image_pool_put(CCLContext * ctx, CCLImage * img) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_if_fail(ctx != NULL);
+    /* Make sure img is not NULL. */
+    g_return_if_fail(img != NULL);
+
+    /* Image pool of context, bucket key and bucket. */
+    CCLImagePool * pool;
+    CCLImagePoolKey key, * p_key;
+    CCLImagePoolBucket * bucket;
+    /* Image description. */
+    cl_mem_flags flags;
+    cl_image_format fmt;
+    size_t size, array_size = 0;
+    /* Was image pooled? */
+    cl_bool pooled = CL_FALSE;
+
+    /* Get image description (zero if unable to get it, in which case the
+     * image is not pooled). */
+    flags = ccl_memobj_get_info_scalar(img, CL_MEM_FLAGS, cl_mem_flags, NULL);
+    size = ccl_memobj_get_info_scalar(img, CL_MEM_SIZE, size_t, NULL);
+    fmt = ccl_image_get_info_scalar(
+        img, CL_IMAGE_FORMAT, cl_image_format, NULL);
+#ifdef CL_VERSION_1_2
+    if (ccl_memobj_get_opencl_version((CCLMemObj *) img, NULL) >= 120)
+        array_size = ccl_image_get_info_scalar(
+            img, CL_IMAGE_ARRAY_SIZE, size_t, NULL);
+#endif
+    ccl_image_pool_key_init(&key, flags, &fmt,
+        ccl_memobj_get_info_scalar(
+            img, CL_MEM_TYPE, cl_mem_object_type, NULL),
+        ccl_image_get_info_scalar(img, CL_IMAGE_WIDTH, size_t, NULL),
+        ccl_image_get_info_scalar(img, CL_IMAGE_HEIGHT, size_t, NULL),
+        ccl_image_get_info_scalar(img, CL_IMAGE_DEPTH, size_t, NULL),
+        array_size);
+
+    /* Pool image if it is only referenced by the caller, and if it does
+     * not use host memory. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_image_pool(ctx);
+    if ((pool != NULL) && (size > 0)
+        && !(flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR))
+        && (ccl_wrapper_ref_count((CCLWrapper *) img) == 1)
+        && (pool->size + size <= pool->max_size)) {
+
+        /* Get bucket, creating it if necessary. */
+        bucket = g_hash_table_lookup(pool->buckets, &key);
+        if (bucket == NULL) {
+            bucket = g_slice_new0(CCLImagePoolBucket);
+            bucket->img_size = size;
+            p_key = g_new(CCLImagePoolKey, 1);
+            *p_key = key;
+            g_hash_table_insert(pool->buckets, p_key, bucket);
+        }
+
+        /* Keep image. */
+        g_queue_push_head(&bucket->imgs, img);
+        pool->size += bucket->img_size;
+        pooled = CL_TRUE;
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Release image if it was not pooled. */
+    if (!pooled)
+        ccl_image_destroy(img);
+}
+
+/**
+ * Release pooled images of a context, least recently pooled first within
+ * each bucket, until the total size of pooled images is within the given
+ * size.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] max_size Maximum total size in bytes of the images which
+ * remain in the pool, e.g. 0 for releasing all of them.
+ * @return Total size in bytes of the released images.
+ * */
+CCL_EXPORT
+size_t ccl_image_pool_trim(CCLContext * ctx, size_t max_size) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    /* Image pool of context. */
+    CCLImagePool * pool;
+    /* Bucket iterator. */
+    GHashTableIter iter;
+    gpointer p_key, p_bucket;
+    /* Images to release and their total size. */
+    GSList * imgs = NULL;
+    size_t released = 0;
+
+    /* Remove images to release from pool. */
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_image_pool(ctx);
+    if (pool != NULL) {
+        g_hash_table_iter_init(&iter, pool->buckets);
+        while ((pool->size > max_size)
+                && g_hash_table_iter_next(&iter, &p_key, &p_bucket)) {
+
+            CCLImagePoolBucket * bucket = (CCLImagePoolBucket *) p_bucket;
+
+            while ((pool->size > max_size)
+                    && !g_queue_is_empty(&bucket->imgs)) {
+                imgs = g_slist_prepend(imgs, g_queue_pop_tail(&bucket->imgs));
+                pool->size -= bucket->img_size;
+                released += bucket->img_size;
+            }
+            if (g_queue_is_empty(&bucket->imgs))
+                g_hash_table_iter_remove(&iter);
+        }
+    }
+    g_mutex_unlock(&pool_lock);
+
+    /* Release images outside lock. */
+    g_slist_free_full(imgs, (GDestroyNotify) ccl_image_destroy);
+
+    /* Return total size of released images. */
+    return released;
+}
+
+/**
+ * Get total size in bytes of the images in the pool of a context.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @return Total size in bytes of pooled images, which is zero if the
+ * pool is not enabled.
+ * */
+CCL_EXPORT
+size_t ccl_image_pool_get_size(CCLContext * ctx) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, 0);
+
+    /* Image pool of context and its size. */
+    CCLImagePool * pool;
+    size_t size = 0;
+
+    g_mutex_lock(&pool_lock);
+    pool = ccl_context_get_image_pool(ctx);
+    if (pool != NULL)
+        size = pool->size;
+    g_mutex_unlock(&pool_lock);
+
+    /* Return total size of pooled images. */
+    return size;
+}
+
+/**
+ * Create a ring of images with the same description, obtained from the
+ * image pool of a context with ccl_image_pool_get().
+ *
+ * @public @memberof ccl_image_ring
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] flags OpenCL memory flags of images, as in
+ * ccl_image_pool_get().
+ * @param[in] image_format Format of images.
+ * @param[in] img_dsc Type and dimensions of images, as in
+ * ccl_image_pool_get().
+ * @param[in] num_imgs Number of images in ring, e.g. 2 for double
+ * buffering or 3 for triple buffering.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new image ring, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLImageRing * ccl_image_ring_new(CCLContext * ctx, cl_mem_flags flags,
+    const cl_image_format * image_format, const CCLImageDesc * img_dsc,
+    cl_uint num_imgs, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLImageRing * ring = NULL;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, num_imgs == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: image rings must have at least one image.", CCL_STRD);
+
+    /* Create ring. */
+    ring = g_slice_new0(CCLImageRing);
+    ring->ctx = ctx;
+    ccl_context_ref(ctx);
+    ring->imgs = g_new0(CCLImage *, num_imgs);
+    ring->evts = g_new0(cl_event, num_imgs);
+    ring->num_imgs = num_imgs;
+    ring->cur = num_imgs - 1;
+
+    /* Get images from pool. */
+    for (cl_uint i = 0; i < num_imgs; ++i) {
+        ring->imgs[i] = ccl_image_pool_get(
+            ctx, flags, image_format, img_dsc, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Destroy partially created ring. */
+    if (ring != NULL) {
+        ccl_image_ring_destroy(ring);
+        ring = NULL;
+    }
+
+finish:
+
+    /* Return ring. */
+    return ring;
+}
+
+/**
+ * Destroy an image ring, waiting for pending commands using its images
+ * and returning them to the image pool of the context with
+ * ccl_image_pool_put().
+ *
+ * @public @memberof ccl_image_ring
+ *
+ * @param[in] ring The image ring to destroy.
+ * */
+CCL_EXPORT
+void ccl_image_ring_destroy(CCLImageRing * ring) {
+
+    /* Make sure ring is not NULL. */
+    g_return_if_fail(ring != NULL);
+
+    for (cl_uint i = 0; i < ring->num_imgs; ++i) {
+
+        /* Wait for last command using image. */
+        if (ring->evts[i] != NULL) {
+            clWaitForEvents(1, &ring->evts[i]);
+            clReleaseEvent(ring->evts[i]);
+        }
+
+        /* Return image to pool. */
+        if (ring->imgs[i] != NULL)
+            ccl_image_pool_put(ring->ctx, ring->imgs[i]);
+    }
+
+    g_free(ring->evts);
+    g_free(ring->imgs);
+    ccl_context_unref(ring->ctx);
+    g_slice_free(CCLImageRing, ring);
+}
+
+/**
+ * Get the next image of a ring, waiting for the last command using it to
+ * complete, if necessary. Images are returned in a round-robin fashion.
+ *
+ * @public @memberof ccl_image_ring
+ *
+ * @param[in] ring An image ring.
+ * @param[in] evt Event of the last command using the image previously
+ * returned by this function, or `NULL` if there is no such command or
+ * if it is the first call.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The next image of the ring, owned by the ring, or `NULL` if an
+ * error occurs.
+ * */
+CCL_EXPORT
+CCLImage * ccl_image_ring_next(CCLImageRing * ring, CCLEvent * evt,
+    CCLErr ** err) {
+
+    /* Make sure ring is not NULL. */
+    g_return_val_if_fail(ring != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* OpenCL status. */
+    cl_int ocl_status = CL_SUCCESS;
+
+    /* Keep a reference to the OpenCL event of the last use of the current
+     * image, since event wrappers are owned by command queues. */
+    if (evt != NULL) {
+        if (ring->evts[ring->cur] != NULL)
+            clReleaseEvent(ring->evts[ring->cur]);
+        ring->evts[ring->cur] = ccl_event_unwrap(evt);
+        clRetainEvent(ring->evts[ring->cur]);
+    }
+
+    /* Advance to next image, and wait for its last use. */
+    ring->cur = (ring->cur + 1) % ring->num_imgs;
+    if (ring->evts[ring->cur] != NULL) {
+        ocl_status = clWaitForEvents(1, &ring->evts[ring->cur]);
+        clReleaseEvent(ring->evts[ring->cur]);
+        ring->evts[ring->cur] = NULL;
+    }
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: error while waiting for ring image (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return ring->imgs[ring->cur];
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return NULL;
+}
+
+/** @} */
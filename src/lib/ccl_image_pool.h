@@ -0,0 +1,151 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of context-level image pools and image rings.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_IMAGE_POOL_H_
+#define _CCL_IMAGE_POOL_H_
+
+#include "ccl_common.h"
+#include "ccl_image_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_IMAGE_POOL Image pools
+ * @ingroup CCL_IMAGE_WRAPPER
+ *
+ * This module provides an opt-in pool of images attached to a context,
+ * which reuses released images instead of creating new ones, and rings
+ * of images for double or triple buffering.
+ *
+ * Once enabled for a context with ::ccl_image_pool_enable(), images
+ * obtained with ::ccl_image_pool_get() and returned with
+ * ::ccl_image_pool_put() are kept in buckets by memory flags, image
+ * format, image type and dimensions, so that images are only reused for
+ * requests with exactly the same description. When the total size of
+ * pooled images would exceed the pool high-water mark, returned images
+ * are released instead of being pooled. Pooled images can be released
+ * with ::ccl_image_pool_trim(), and are released when the pool is
+ * disabled or the context is destroyed. If the pool is not enabled,
+ * ::ccl_image_pool_get() and ::ccl_image_pool_put() simply create and
+ * destroy images.
+ *
+ * An image ring, created with ::ccl_image_ring_new(), holds a fixed
+ * number of images with the same description, obtained from the image
+ * pool. Each call to ::ccl_image_ring_next() takes the event of the last
+ * command using the image previously returned, and returns the next
+ * image in the ring once the last command using it has completed. When
+ * images are resized, the ring is destroyed with ::ccl_image_ring_destroy(),
+ * which returns its images to the pool, and a new ring is created.
+ *
+ * @attention An image should only be returned to the pool when no
+ * commands using it are pending, or if all commands which will use it
+ * when reused are enqueued in the same in-order queue. Images created
+ * with a host pointer or from another memory object should not be
+ * returned to the pool.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLImageDesc dsc = CCL_IMAGE_DESC_BLANK;
+ * CCLImageRing * ring;
+ * CCLImage * frame;
+ * CCLEvent * evt = NULL;
+ * @endcode
+ * @code{.c}
+ * ccl_image_pool_enable(ctx, 0);
+ * dsc.image_type = CL_MEM_OBJECT_IMAGE2D;
+ * dsc.image_width = width;
+ * dsc.image_height = height;
+ * ring = ccl_image_ring_new(ctx, CL_MEM_READ_WRITE, &fmt, &dsc, 3, NULL);
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < num_frames; ++i) {
+ *     frame = ccl_image_ring_next(ring, evt, NULL);
+ *     ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq_comp, 2, NULL,
+ *         gws, NULL, NULL, NULL, frame, NULL);
+ *     evt = ccl_image_enqueue_read(frame, cq_comm, CL_FALSE, origin,
+ *         region, 0, 0, host_frames[i], NULL, NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_image_ring_destroy(ring);
+ * @endcode
+ *
+ * @{
+ */
+
+/** Default high-water mark in bytes of image pools. */
+#define CCL_IMAGE_POOL_MAX_SIZE (64 * 1024 * 1024)
+
+/**
+ * Ring of images for double or triple buffering.
+ * */
+typedef struct ccl_image_ring CCLImageRing;
+
+/* Enable the image pool of a context. */
+CCL_EXPORT
+void ccl_image_pool_enable(CCLContext * ctx, size_t max_size);
+
+/* Disable the image pool of a context, releasing pooled images. */
+CCL_EXPORT
+void ccl_image_pool_disable(CCLContext * ctx);
+
+/* Get an image from the image pool of a context. */
+CCL_EXPORT
+CCLImage * ccl_image_pool_get(CCLContext * ctx, cl_mem_flags flags,
+    const cl_image_format * image_format, const CCLImageDesc * img_dsc,
+    CCLErr ** err);
+
+/* Return an image to the image pool of a context. */
+CCL_EXPORT
+void ccl_image_pool_put(CCLContext * ctx, CCLImage * img);
+
+/* Release pooled images until the pool is within the given size. */
+CCL_EXPORT
+size_t ccl_image_pool_trim(CCLContext * ctx, size_t max_size);
+
+/* Get total size in bytes of the images in the pool of a context. */
+CCL_EXPORT
+size_t ccl_image_pool_get_size(CCLContext * ctx);
+
+/* Create a ring of images obtained from the image pool of a context. */
+CCL_EXPORT
+CCLImageRing * ccl_image_ring_new(CCLContext * ctx, cl_mem_flags flags,
+    const cl_image_format * image_format, const CCLImageDesc * img_dsc,
+    cl_uint num_imgs, CCLErr ** err);
+
+/* Destroy an image ring, returning its images to the image pool. */
+CCL_EXPORT
+void ccl_image_ring_destroy(CCLImageRing * ring);
+
+/* Get the next image of a ring, once its last use has completed. */
+CCL_EXPORT
+CCLImage * ccl_image_ring_next(CCLImageRing * ring, CCLEvent * evt,
+    CCLErr ** err);
+
+/** @} */
+
+#endif
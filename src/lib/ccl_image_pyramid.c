@@ -0,0 +1,288 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of image pyramid generation.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_image_pyramid.h"
+#include "ccl_image_pool.h"
+#include "ccl_kernel_wrapper.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ * Key of the pyramid program in the context cache of compiled programs.
+ * */
+#define CCL_PYRAMID_PROGRAM_KEY "ccl_pyramid"
+
+/**
+ * @internal
+ * Source of the pyramid kernels, which average 2x2 blocks of the source
+ * image into each pixel of the destination image. Integer formats are
+ * rounded to the nearest value.
+ * */
+static const char * ccl_pyramid_src =
+    "__constant sampler_t ccl_pyramid_smp = CLK_NORMALIZED_COORDS_FALSE\n"
+    "    | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;\n"
+    "__kernel void ccl_pyramid_f(__read_only image2d_t src,\n"
+    "    __write_only image2d_t dst) {\n"
+    "    int2 d = (int2) (get_global_id(0), get_global_id(1));\n"
+    "    int2 s = 2 * d;\n"
+    "    float4 v = read_imagef(src, ccl_pyramid_smp, s)\n"
+    "        + read_imagef(src, ccl_pyramid_smp, s + (int2) (1, 0))\n"
+    "        + read_imagef(src, ccl_pyramid_smp, s + (int2) (0, 1))\n"
+    "        + read_imagef(src, ccl_pyramid_smp, s + (int2) (1, 1));\n"
+    "    write_imagef(dst, d, v * 0.25f);\n"
+    "}\n"
+    "__kernel void ccl_pyramid_i(__read_only image2d_t src,\n"
+    "    __write_only image2d_t dst) {\n"
+    "    int2 d = (int2) (get_global_id(0), get_global_id(1));\n"
+    "    int2 s = 2 * d;\n"
+    "    int4 v = read_imagei(src, ccl_pyramid_smp, s)\n"
+    "        + read_imagei(src, ccl_pyramid_smp, s + (int2) (1, 0))\n"
+    "        + read_imagei(src, ccl_pyramid_smp, s + (int2) (0, 1))\n"
+    "        + read_imagei(src, ccl_pyramid_smp, s + (int2) (1, 1));\n"
+    "    write_imagei(dst, d, (v + (int4) (2)) >> 2);\n"
+    "}\n"
+    "__kernel void ccl_pyramid_ui(__read_only image2d_t src,\n"
+    "    __write_only image2d_t dst) {\n"
+    "    int2 d = (int2) (get_global_id(0), get_global_id(1));\n"
+    "    int2 s = 2 * d;\n"
+    "    uint4 v = read_imageui(src, ccl_pyramid_smp, s)\n"
+    "        + read_imageui(src, ccl_pyramid_smp, s + (int2) (1, 0))\n"
+    "        + read_imageui(src, ccl_pyramid_smp, s + (int2) (0, 1))\n"
+    "        + read_imageui(src, ccl_pyramid_smp, s + (int2) (1, 1));\n"
+    "    write_imageui(dst, d, (v + (uint4) (2)) >> 2);\n"
+    "}\n";
+
+/**
+ * @internal
+ *
+ * @brief Get the pyramid program of a context, building it the first time
+ * it is required and keeping it in the context cache of compiled
+ * programs.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The pyramid program, which should be released with
+ * ::ccl_program_destroy(), or `NULL` if an error occurs.
+ * */
+static CCLProgram * ccl_pyramid_program_get(CCLContext * ctx, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLProgram * prg;
+
+    /* Build program if not yet available in context. */
+    prg = ccl_context_get_compiled_program(ctx, CCL_PYRAMID_PROGRAM_KEY);
+    if (prg == NULL) {
+        prg = ccl_program_new_from_source(
+            ctx, ccl_pyramid_src, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_program_build(prg, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        prg = ccl_context_add_compiled_program(
+            ctx, CCL_PYRAMID_PROGRAM_KEY, prg);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return prg;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    if (prg != NULL) ccl_program_destroy(prg);
+    return NULL;
+}
+
+/**
+ * @addtogroup CCL_IMAGE_PYRAMID
+ * @{
+ */
+
+/**
+ * Enqueue the generation of a pyramid of a 2D image. For each level, an
+ * image with half the width and height of the previous level (and at
+ * least one pixel) is obtained with ::ccl_image_pool_get(), and a kernel
+ * which averages each 2x2 block of the previous level into one pixel is
+ * enqueued. Each kernel waits for the previous level, so the queue can
+ * be out-of-order.
+ *
+ * @public @memberof ccl_image
+ *
+ * @param[in] img 2D image wrapper object, the base of the pyramid.
+ * @param[in] cq Command queue wrapper object where kernels are enqueued.
+ * @param[in] num_levels Number of levels to generate, besides the base.
+ * @param[out] levels Array of `num_levels` locations where to place the
+ * level images, from finest to coarsest. Level images should be returned
+ * with ::ccl_image_pool_put() (or destroyed) by client code.
+ * @param[out] evts Array of `num_levels` locations where to place the
+ * event of each level, or `NULL` if events are not required.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first level can be generated. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if generation of all levels was enqueued, or
+ * `CL_FALSE` otherwise, in which case no level images are returned.
+ * */
+CCL_EXPORT
+cl_bool ccl_image_enqueue_pyramid(CCLImage * img, CCLQueue * cq,
+    cl_uint num_levels, CCLImage ** levels, CCLEvent ** evts,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure img is not NULL. */
+    g_return_val_if_fail(img != NULL, CL_FALSE);
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, CL_FALSE);
+    /* Make sure levels is not NULL. */
+    g_return_val_if_fail(levels != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLImage * src = img;
+    CCLImageDesc img_dsc = CCL_IMAGE_DESC_BLANK;
+    cl_image_format fmt;
+    cl_mem_object_type type;
+    const char * kernel_name;
+    cl_bool ret_status;
+    size_t gws[2];
+
+    /* No levels created yet. */
+    for (cl_uint i = 0; i < num_levels; ++i)
+        levels[i] = NULL;
+
+    /* Check arguments. */
+    type = ccl_memobj_get_info_scalar(
+        img, CL_MEM_TYPE, cl_mem_object_type, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (type != CL_MEM_OBJECT_IMAGE2D) || (num_levels == 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: pyramids require a 2D image and at least one level.",
+        CCL_STRD);
+
+    /* Get base image description. */
+    fmt = ccl_image_get_info_scalar(
+        img, CL_IMAGE_FORMAT, cl_image_format, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    img_dsc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    img_dsc.image_width = ccl_image_get_info_scalar(
+        img, CL_IMAGE_WIDTH, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    img_dsc.image_height = ccl_image_get_info_scalar(
+        img, CL_IMAGE_HEIGHT, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Select kernel according to image channel data type. */
+    switch (fmt.image_channel_data_type) {
+        case CL_SIGNED_INT8:
+        case CL_SIGNED_INT16:
+        case CL_SIGNED_INT32:
+            kernel_name = "ccl_pyramid_i";
+            break;
+        case CL_UNSIGNED_INT8:
+        case CL_UNSIGNED_INT16:
+        case CL_UNSIGNED_INT32:
+            kernel_name = "ccl_pyramid_ui";
+            break;
+        default:
+            kernel_name = "ccl_pyramid_f";
+    }
+
+    /* Get pyramid kernel, of its own so that concurrent pyramids don't
+     * share kernel arguments. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    prg = ccl_pyramid_program_get(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_kernel_new(prg, kernel_name, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Generate each level from the previous one. */
+    for (cl_uint i = 0; i < num_levels; ++i) {
+
+        /* Get level image. */
+        img_dsc.image_width = MAX(img_dsc.image_width / 2, 1);
+        img_dsc.image_height = MAX(img_dsc.image_height / 2, 1);
+        levels[i] = ccl_image_pool_get(ctx, CL_MEM_READ_WRITE, &fmt,
+            &img_dsc, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Enqueue kernel, waiting for the previous level. */
+        gws[0] = img_dsc.image_width;
+        gws[1] = img_dsc.image_height;
+        evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 2, NULL,
+            gws, NULL, i == 0 ? evt_wait_lst : ccl_ewl(&ewl, evt, NULL),
+            &err_internal, src, levels[i], NULL);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_set_name(evt, "PYRAMID_LEVEL");
+        if (evts != NULL) evts[i] = evt;
+        src = levels[i];
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+    /* Release levels created so far. */
+    for (cl_uint i = 0; i < num_levels; ++i) {
+        if (levels[i] != NULL) {
+            ccl_image_destroy(levels[i]);
+            levels[i] = NULL;
+        }
+    }
+
+finish:
+
+    /* Release kernel, which remains valid while the levels are generated,
+     * and our reference to the program, which the cache keeps. */
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+    if (prg != NULL) ccl_program_destroy(prg);
+
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    ccl_event_wait_list_clear(&ewl);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/** @} */
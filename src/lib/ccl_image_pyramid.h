@@ -0,0 +1,81 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of image pyramid generation.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_IMAGE_PYRAMID_H_
+#define _CCL_IMAGE_PYRAMID_H_
+
+#include "ccl_common.h"
+#include "ccl_image_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_IMAGE_PYRAMID Image pyramids
+ * @ingroup CCL_IMAGE_WRAPPER
+ *
+ * This module generates multi-scale pyramids of 2D images on the device.
+ *
+ * ::ccl_image_enqueue_pyramid() creates a chain of images, each with half
+ * the width and height of the previous one, and enqueues a 2x2 box filter
+ * kernel for each level, reading from the previous level. The kernels are
+ * built once per context and kept in the context cache of compiled
+ * programs. An event is returned for each level, so that consumers of a
+ * level can wait only for it, instead of for the whole pyramid.
+ *
+ * Level images are obtained with ::ccl_image_pool_get(), and thus are
+ * recycled if the context image pool is enabled. They should be returned
+ * with ::ccl_image_pool_put() (or destroyed) when no longer required.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLImage * levels[4];
+ * CCLEvent * evts[4];
+ * CCLEventWaitList ewl = NULL;
+ * @endcode
+ * @code{.c}
+ * ccl_image_enqueue_pyramid(img, cq, 4, levels, evts, NULL, NULL);
+ * ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq_comp, 2, NULL, gws,
+ *     NULL, ccl_ewl(&ewl, evts[0], NULL), NULL, levels[0], NULL);
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < 4; ++i)
+ *     ccl_image_pool_put(ctx, levels[i]);
+ * @endcode
+ *
+ * @{
+ */
+
+/* Enqueue the generation of a pyramid of an image. */
+CCL_EXPORT
+cl_bool ccl_image_enqueue_pyramid(CCLImage * img, CCLQueue * cq,
+    cl_uint num_levels, CCLImage ** levels, CCLEvent ** evts,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/** @} */
+
+#endif
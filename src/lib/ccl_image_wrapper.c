@@ -27,8 +27,13 @@
 
 #include "ccl_image_wrapper.h"
 #include "ccl_buffer_wrapper.h"
+#include "ccl_device_wrapper.h"
 #include "_ccl_memobj_wrapper.h"
+#include "_ccl_fill.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_queue_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
 
 /**
  * Image wrapper class.
@@ -171,7 +176,8 @@ CCLImage * ccl_image_new_wrap(cl_mem mem_object) {
 CCL_EXPORT
 void ccl_image_destroy(CCLImage * img) {
 
-    ccl_wrapper_unref((CCLWrapper *) img, sizeof(CCLImage), NULL,
+    ccl_wrapper_unref((CCLWrapper *) img, sizeof(CCLImage),
+        (ccl_wrapper_release_fields) ccl_memobj_release_fields,
         (ccl_wrapper_release_cl_object) clReleaseMemObject, NULL);
 }
 
@@ -298,6 +304,16 @@ CCLImage * ccl_image_new_v(CCLContext * ctx, cl_mem_flags flags,
     /* Wrap image. */
     img = ccl_image_new_wrap(image);
 
+    /* Account for image memory in context, unless the image shares the
+     * memory of a buffer. */
+    if (img_dsc->memobj == NULL) {
+        size_t size = ccl_memobj_get_info_scalar(
+            img, CL_MEM_SIZE, size_t, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_context_mem_track(ctx, (CCLMemObj *) img, size, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -307,6 +323,12 @@ error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
 
+    /* Release image, if it was created. */
+    if (img != NULL) {
+        ccl_image_destroy(img);
+        img = NULL;
+    }
+
 finish:
 
     /* Return image wrapper. */
@@ -437,6 +459,271 @@ CCLImage * ccl_image_new(CCLContext * ctx, cl_mem_flags flags,
 
 }
 
+#ifdef CL_VERSION_1_2
+
+/**
+ * @internal
+ *
+ * @brief Determine the size in bytes of each element of an image with the
+ * given format.
+ *
+ * @param[in] image_format Image format.
+ * @return Size in bytes of image elements, or 0 if the format is unknown.
+ * */
+static size_t ccl_image_format_elem_size(
+    const cl_image_format * image_format) {
+
+    size_t num_channels, channel_size;
+
+    /* Packed formats have a fixed element size. */
+    switch (image_format->image_channel_data_type) {
+        case CL_UNORM_SHORT_565:
+        case CL_UNORM_SHORT_555:
+            return 2;
+        case CL_UNORM_INT_101010:
+            return 4;
+        case CL_SNORM_INT8:
+        case CL_UNORM_INT8:
+        case CL_SIGNED_INT8:
+        case CL_UNSIGNED_INT8:
+            channel_size = 1;
+            break;
+        case CL_SNORM_INT16:
+        case CL_UNORM_INT16:
+        case CL_SIGNED_INT16:
+        case CL_UNSIGNED_INT16:
+        case CL_HALF_FLOAT:
+            channel_size = 2;
+            break;
+        case CL_SIGNED_INT32:
+        case CL_UNSIGNED_INT32:
+        case CL_FLOAT:
+            channel_size = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    /* Determine number of channels. */
+    switch (image_format->image_channel_order) {
+        case CL_R:
+        case CL_A:
+        case CL_Rx:
+        case CL_INTENSITY:
+        case CL_LUMINANCE:
+            num_channels = 1;
+            break;
+        case CL_RG:
+        case CL_RA:
+        case CL_RGx:
+            num_channels = 2;
+            break;
+        case CL_RGBA:
+        case CL_BGRA:
+        case CL_ARGB:
+            num_channels = 4;
+            break;
+        default:
+            return 0;
+    }
+
+    return num_channels * channel_size;
+}
+
+#endif
+
+/**
+ * Create an image which shares the storage of a buffer, so that data in
+ * the buffer can be accessed through samplers without copying it to an
+ * image. If `height` is 0, a 1D image buffer is created. Otherwise, a 2D
+ * image is created from the buffer, which requires OpenCL 2.0 or the
+ * `cl_khr_image2d_from_buffer` extension on all devices of the context.
+ * In this case, the row pitch must be a multiple of the largest
+ * `CL_DEVICE_IMAGE_PITCH_ALIGNMENT` of the context devices (in pixels),
+ * which is checked before the image is created.
+ *
+ * The image does not account for memory in the context, since it shares
+ * the buffer memory. The row pitch of the created image can be queried
+ * with ::ccl_image_get_info_scalar() and `CL_IMAGE_ROW_PITCH`.
+ *
+ * @public @memberof ccl_image
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] buf Buffer wrapper object whose storage is shared with the
+ * image.
+ * @param[in] flags Specifies allocation and usage information about the
+ * image wrapper object being created. Host pointer flags are not allowed.
+ * @param[in] image_format A pointer to the OpenCL `cl_image_format`
+ * structure, which describes format properties of the image.
+ * @param[in] width Width of the image in pixels.
+ * @param[in] height Height of the image in pixels, or 0 for a 1D image
+ * buffer.
+ * @param[in] row_pitch Scan-line pitch in bytes of 2D images, or 0 to use
+ * the image width in bytes rounded up to the required pitch alignment.
+ * Ignored for 1D image buffers.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new image wrapper object or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLImage * ccl_image_new_from_buffer(CCLBuffer * buf, cl_mem_flags flags,
+    const cl_image_format * image_format, size_t width, size_t height,
+    size_t row_pitch, CCLErr ** err) {
+
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure image_format is not NULL. */
+    g_return_val_if_fail(image_format != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Image wrapper object. */
+    CCLImage * img = NULL;
+    /* Context wrapper of buffer. */
+    CCLContext * ctx = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* OpenCL context of buffer. */
+    cl_context context;
+    /* OpenCL platform version. */
+    cl_uint ocl_ver;
+
+    /* Get context wrapper of buffer. */
+    context = ccl_memobj_get_info_scalar(
+        buf, CL_MEM_CONTEXT, cl_context, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ctx = ccl_context_new_wrap(context);
+
+    /* Images from buffers require OpenCL >= 1.2. */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifndef CL_VERSION_1_2
+
+    CCL_UNUSED(flags);
+    CCL_UNUSED(width);
+    CCL_UNUSED(height);
+    CCL_UNUSED(row_pitch);
+    CCL_UNUSED(ocl_ver);
+    ccl_if_err_create_goto(*err, CCL_ERROR, CL_TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: images from buffers require cf4ocl to be deployed with "
+        "support for OpenCL version 1.2 or newer.", CCL_STRD);
+
+#else
+
+    /* Image description. */
+    CCLImageDesc img_dsc = CCL_IMAGE_DESC_BLANK;
+    /* Size of image elements and of buffer, in bytes. */
+    size_t elem_size, buf_size;
+
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: images from buffers require OpenCL version 1.2 or newer.",
+        CCL_STRD);
+
+    /* Check arguments. */
+    elem_size = ccl_image_format_elem_size(image_format);
+    ccl_if_err_create_goto(*err, CCL_ERROR, elem_size == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: unknown image format.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR, width == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: image width must be non-zero.", CCL_STRD);
+    buf_size = ccl_memobj_get_info_scalar(
+        buf, CL_MEM_SIZE, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    img_dsc.image_width = width;
+    img_dsc.memobj = (CCLMemObj *) buf;
+
+    if (height == 0) {
+
+        /* 1D image buffer. */
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            width * elem_size > buf_size, CCL_ERROR_ARGS, error_handler,
+            "%s: image is larger than buffer.", CCL_STRD);
+        img_dsc.image_type = CL_MEM_OBJECT_IMAGE1D_BUFFER;
+
+    } else {
+
+        /* 2D image from buffer, determine pitch alignment required by
+         * all devices. */
+        size_t align = 1, dev_align;
+        cl_uint num_devs;
+        CCLDevice * dev;
+        const CCLDeviceCaps * caps;
+        size_t pitch_align;
+
+        num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        for (cl_uint i = 0; i < num_devs; ++i) {
+            dev = ccl_context_get_device(ctx, i, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            if (ocl_ver < 200) {
+                caps = ccl_device_get_caps(dev, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                ccl_if_err_create_goto(*err, CCL_ERROR, !(caps->extensions
+                        & CCL_DEVICE_EXT_KHR_IMAGE2D_FROM_BUFFER),
+                    CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+                    "%s: 2D images from buffers require OpenCL version "
+                    "2.0 or the cl_khr_image2d_from_buffer extension.",
+                    CCL_STRD);
+            }
+            dev_align = ccl_device_get_info_scalar(dev,
+                CL_DEVICE_IMAGE_PITCH_ALIGNMENT, cl_uint, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            ccl_if_err_create_goto(*err, CCL_ERROR, dev_align == 0,
+                CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+                "%s: device does not support 2D images from buffers.",
+                CCL_STRD);
+            align = MAX(align, dev_align);
+        }
+
+        /* Determine and check row pitch. */
+        pitch_align = align * elem_size;
+        if (row_pitch == 0)
+            row_pitch = ((width * elem_size + pitch_align - 1)
+                / pitch_align) * pitch_align;
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (row_pitch < width * elem_size) || (row_pitch % pitch_align),
+            CCL_ERROR_ARGS, error_handler,
+            "%s: row pitch must be at least the image width and a "
+            "multiple of %lu bytes.", CCL_STRD, (unsigned long) pitch_align);
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            row_pitch * height > buf_size, CCL_ERROR_ARGS, error_handler,
+            "%s: image is larger than buffer.", CCL_STRD);
+
+        img_dsc.image_type = CL_MEM_OBJECT_IMAGE2D;
+        img_dsc.image_height = height;
+        img_dsc.image_row_pitch = row_pitch;
+    }
+
+    /* Create image. */
+    img = ccl_image_new_v(ctx, flags, image_format, &img_dsc, NULL,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release context wrapper. */
+    if (ctx != NULL) ccl_context_unref(ctx);
+
+    /* Return image wrapper. */
+    return img;
+}
+
 /**
  * Read from an image or image array object to host memory. This
  * function wraps the clEnqueueReadImage() OpenCL function.
@@ -483,19 +770,29 @@ CCLEvent * ccl_image_enqueue_read(CCLImage * img, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) img, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Read image from device into host. */
     ocl_status = clEnqueueReadImage(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(img), blocking_read, origin, region,
         row_pitch, slice_pitch, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue an image read (OpenCL error %d: %s).",
@@ -504,7 +801,10 @@ CCLEvent * ccl_image_enqueue_read(CCLImage * img, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) img, cq, CL_FALSE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -522,6 +822,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -572,19 +875,29 @@ CCLEvent * ccl_image_enqueue_write(CCLImage * img, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) img, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Write image to device from host. */
     ocl_status = clEnqueueWriteImage(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(img), blocking_write, origin, region,
         input_row_pitch, input_slice_pitch, ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue an image write (OpenCL error %d: %s).",
@@ -593,7 +906,10 @@ CCLEvent * ccl_image_enqueue_write(CCLImage * img, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) img, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -611,6 +927,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -660,19 +979,31 @@ CCLEvent * ccl_image_enqueue_copy(CCLImage * src_img, CCLImage * dst_img,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory objects. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) src_img, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) dst_img, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Copy image. */
     ocl_status = clEnqueueCopyImage(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(src_img), ccl_memobj_unwrap(dst_img),
         src_origin, dst_origin, region,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue an image copy (OpenCL error %d: %s).",
@@ -681,7 +1012,11 @@ CCLEvent * ccl_image_enqueue_copy(CCLImage * src_img, CCLImage * dst_img,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) src_img, cq, CL_FALSE, evt);
+    ccl_memobj_hazard_record((CCLMemObj *) dst_img, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -699,6 +1034,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -747,19 +1085,31 @@ CCLEvent * ccl_image_enqueue_copy_to_buffer(CCLImage * src_img,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory objects. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) src_img, cq, CL_FALSE,
+        evt_wait_lst, &hzd_ewl);
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) dst_buf, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Copy image to buffer. */
     ocl_status = clEnqueueCopyImageToBuffer(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(src_img), ccl_memobj_unwrap(dst_buf),
         src_origin, region, dst_offset,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to copy image to buffer (OpenCL error %d: %s).",
@@ -768,7 +1118,11 @@ CCLEvent * ccl_image_enqueue_copy_to_buffer(CCLImage * src_img,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    ccl_memobj_hazard_record((CCLMemObj *) src_img, cq, CL_FALSE, evt);
+    ccl_memobj_hazard_record((CCLMemObj *) dst_buf, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -786,6 +1140,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -843,18 +1200,27 @@ void * ccl_image_enqueue_map(CCLImage * img, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     cl_int ocl_status;
     cl_event event = NULL;
     CCLEvent * evt_inner = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     void * ptr = NULL;
 
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) img, cq,
+        map_flags != CL_MAP_READ, evt_wait_lst, &hzd_ewl);
+
     /* Perform image map. */
     ptr = clEnqueueMapImage(ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(img), blocking_map, map_flags,
         origin, region, image_row_pitch, image_slice_pitch,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
         ccl_event_wait_list_get_clevents(evt_wait_lst),
-        &event, &ocl_status);
+        ccl_queue_event_ptr(cq, &event), &ocl_status);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to map image (OpenCL error %d: %s).",
@@ -863,10 +1229,14 @@ void * ccl_image_enqueue_map(CCLImage * img, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt_inner = ccl_queue_produce_event(cq, event);
+    evt_inner = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
     if (evt != NULL)
         *evt = evt_inner;
 
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record(
+        (CCLMemObj *) img, cq, map_flags != CL_MAP_READ, evt_inner);
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -883,6 +1253,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return host pointer. */
     return ptr;
 }
@@ -891,8 +1264,13 @@ finish:
  * Fill an image object with a specified color. This function wraps the
  * clEnqueueFillImage() OpenCL function.
  *
+ * With OpenCL < 1.2, clEnqueueFillImage() is not available, and 2D
+ * images are filled by a built-in kernel instead, which is built once per
+ * context. In this case, the image must not be read-only for kernels, and
+ * the returned event is the event of the kernel.
+ *
  * @public @memberof ccl_image
- * @note Requires OpenCL >= 1.2
+ * @note Requires OpenCL >= 1.2 for images other than 2D images.
  *
  * @param[out] img Image wrapper object to fill.
  * @param[in] cq Command-queue wrapper object in which the fill command
@@ -926,66 +1304,82 @@ CCLEvent * ccl_image_enqueue_fill(CCLImage * img, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event object. */
     cl_event event = NULL;
     /* Event wrapper object. */
     CCLEvent * evt = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
     /* OpenCL version of the underlying platform. */
     double ocl_ver;
     /* Internal error handling object. */
     CCLErr * err_internal = NULL;
+    /* Use the OpenCL fill command? */
+    cl_bool native = CL_FALSE;
 
-#ifndef CL_VERSION_1_2
+#ifdef CL_VERSION_1_2
+
+    /* Check that context platform is >= OpenCL 1.2 */
+    ocl_ver = ccl_memobj_get_opencl_version(
+        (CCLMemObj *) img, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* clEnqueueFillImage() requires OpenCL >= 1.2. */
+    native = (ocl_ver >= 120);
+
+#else
 
-    CCL_UNUSED(fill_color);
-    CCL_UNUSED(origin);
-    CCL_UNUSED(region);
-    CCL_UNUSED(evt_wait_lst);
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(ocl_status);
     CCL_UNUSED(event);
     CCL_UNUSED(ocl_ver);
-    CCL_UNUSED(err_internal);
 
-    /* If cf4ocl was not compiled with support for OpenCL >= 1.2, always throw
-     * error. */
-    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
-        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
-        "%s: Image fill requires cf4ocl to be deployed with "
-        "support for OpenCL version 1.2 or newer.",
-        CCL_STRD);
+#endif
 
-#else
+    if (native) {
 
-    /* Check that context platform is >= OpenCL 1.2 */
-    ocl_ver = ccl_memobj_get_opencl_version(
-        (CCLMemObj *) img, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+#ifdef CL_VERSION_1_2
 
-    /* If OpenCL version is not >= 1.2, throw error. */
-    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
-        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
-        "%s: Image fill requires OpenCL version 1.2 or newer.",
-        CCL_STRD);
+        /* Wait for conflicting commands on the memory object. */
+        evt_wait_lst = ccl_memobj_hazard_deps((CCLMemObj *) img, cq, CL_TRUE,
+            evt_wait_lst, &hzd_ewl);
 
-    /* Fill image. */
-    ocl_status = clEnqueueFillImage(ccl_queue_unwrap(cq),
-        ccl_memobj_unwrap(img), fill_color, origin, region,
-        ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: unable to enqueue a fill image command (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
+        /* Fill image. */
+        ocl_status = clEnqueueFillImage(ccl_queue_unwrap(cq),
+            ccl_memobj_unwrap(img), fill_color, origin, region,
+            ccl_event_wait_list_get_num_events(evt_wait_lst),
+            ccl_event_wait_list_get_clevents(evt_wait_lst),
+            ccl_queue_event_ptr(cq, &event));
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to enqueue a fill image command "
+            "(OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
 
-    /* Wrap event and associate it with the respective command queue.
-     * The event object will be released automatically when the command
-     * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+        /* Wrap event and associate it with the respective command
+         * queue. The event object will be released automatically when
+         * the command queue is released. */
+        evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+        /* Record access to memory object, if hazards are tracked. */
+        ccl_memobj_hazard_record((CCLMemObj *) img, cq, CL_TRUE, evt);
 
 #endif
 
+    } else {
+
+        /* Otherwise fill 2D image with a kernel, which is built once per
+         * context. */
+        evt = ccl_fill_image_kernel(img, cq, fill_color, origin, region,
+            evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -1002,6 +1396,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
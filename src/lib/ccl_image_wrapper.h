@@ -223,6 +223,12 @@ CCLImage * ccl_image_new(CCLContext * ctx, cl_mem_flags flags,
     const cl_image_format * image_format, void * host_ptr, CCLErr ** err,
     ...);
 
+/* Create an image which shares the storage of a buffer. */
+CCL_EXPORT
+CCLImage * ccl_image_new_from_buffer(CCLBuffer * buf, cl_mem_flags flags,
+    const cl_image_format * image_format, size_t width, size_t height,
+    size_t row_pitch, CCLErr ** err);
+
 /* Read from an image or image array object to host memory. */
 CCL_EXPORT
 CCLEvent * ccl_image_enqueue_read(CCLImage * img, CCLQueue * cq,
@@ -348,7 +354,7 @@ CCLEvent * ccl_image_enqueue_fill(CCLImage * img, CCLQueue * cq,
  * If an error occurs, zero is returned.
  * */
 #define ccl_image_get_info_scalar(img, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) img, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) img, \
         NULL, param_name, sizeof(param_type), CCL_INFO_IMAGE, CL_FALSE, err))
 
 /**
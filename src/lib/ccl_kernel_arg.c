@@ -39,16 +39,82 @@
  * a real ::CCLWrapper object.
  * */
 #define ccl_arg_is_local(arg) \
-     (arg->info == (void *) &arg_local_marker)
+     ((arg->info == (void *) &arg_local_marker) \
+     || (arg->info == (void *) &arg_inline_marker) \
+     || (arg->info == (void *) &arg_stack_marker))
 
 /**
  * @internal
  *
- * @brief Marker which determines if argument is local/private or a
- * real ::CCLWrapper object.
+ * @brief Marker which determines if argument is local/private, with
+ * its value kept in a separate heap copy, or a real ::CCLWrapper
+ * object.
  * */
 static char arg_local_marker;
 
+/**
+ * @internal
+ *
+ * @brief Marker for local/private arguments allocated by
+ * ::ccl_arg_new() with their value stored inline.
+ * */
+static char arg_inline_marker;
+
+/**
+ * @internal
+ *
+ * @brief Marker for local/private arguments in storage provided by
+ * client code, initialized with ::ccl_arg_init().
+ * */
+static char arg_stack_marker;
+
+/**
+ * @internal
+ *
+ * @brief Marker for shared virtual memory pointer arguments, initialized
+ * with ::ccl_arg_svm_init().
+ * */
+static char arg_svm_marker;
+
+/* The inline storage must extend the layout of wrapper objects. */
+G_STATIC_ASSERT(G_STRUCT_OFFSET(CCLArgStack, class)
+    == G_STRUCT_OFFSET(CCLWrapper, class));
+G_STATIC_ASSERT(G_STRUCT_OFFSET(CCLArgStack, cl_object)
+    == G_STRUCT_OFFSET(CCLWrapper, cl_object));
+G_STATIC_ASSERT(G_STRUCT_OFFSET(CCLArgStack, info)
+    == G_STRUCT_OFFSET(CCLWrapper, info));
+G_STATIC_ASSERT(G_STRUCT_OFFSET(CCLArgStack, ref_count)
+    == G_STRUCT_OFFSET(CCLWrapper, ref_count));
+
+/**
+ * @internal
+ *
+ * @brief Initialize a local/private argument in the given storage.
+ *
+ * @param[in] storage Argument storage.
+ * @param[in] value Argument value, copied into inline storage if not
+ * `NULL`.
+ * @param[in] size Argument size.
+ * @param[in] marker Argument marker.
+ * @return The initialized argument.
+ * */
+static CCLArg * ccl_arg_init_full(CCLArgStack * storage, void * value,
+    size_t size, char * marker) {
+
+    storage->class = CCL_NONE;
+    storage->info = (void *) marker;
+    storage->ref_count = (int) size;
+
+    if (value != NULL) {
+        memcpy(storage->value.bytes, value, size);
+        storage->cl_object = storage->value.bytes;
+    } else {
+        storage->cl_object = NULL;
+    }
+
+    return (CCLArg *) storage;
+}
+
 /**
  * @internal
  *
@@ -81,8 +147,14 @@ CCLArg * ccl_arg_new(void * value, size_t size) {
     /* Make sure size is > 0. */
     g_return_val_if_fail(size > 0, NULL);
 
+    /* Keep local arguments and small values inline. */
+    if ((value == NULL) || (size <= CCL_ARG_INLINE_SIZE))
+        return ccl_arg_init_full(g_slice_new(CCLArgStack), value, size,
+            &arg_inline_marker);
+
     CCLArg * arg = g_slice_new(CCLArg);
 
+    arg->class = CCL_NONE;
     arg->cl_object = g_memdup((const void *) value, (guint) size);
     arg->info = (void *) &arg_local_marker;
     arg->ref_count = (gint) size;
@@ -90,6 +162,37 @@ CCLArg * ccl_arg_new(void * value, size_t size) {
     return arg;
 }
 
+/**
+ * Initialize a kernel argument in storage provided by client code,
+ * typically on the stack. No memory is allocated, and the argument is
+ * not released by kernels or by ::ccl_arg_destroy().
+ *
+ * @attention Client code shouldn't directly use this function, but use
+ * ccl_arg_priv_stack() or ccl_arg_local_stack() instead.
+ *
+ * @param[out] storage Storage for the argument.
+ * @param[in] value Argument value, or `NULL` for local arguments.
+ * @param[in] size Argument size. Must not be larger than
+ * ::CCL_ARG_INLINE_SIZE if `value` is not `NULL`.
+ * @return The argument, or `NULL` if the value doesn't fit in the
+ * storage.
+ * */
+CCL_EXPORT
+CCLArg * ccl_arg_init(CCLArgStack * storage, void * value, size_t size) {
+
+    /* Make sure storage is not NULL. */
+    g_return_val_if_fail(storage != NULL, NULL);
+
+    /* Make sure size is > 0. */
+    g_return_val_if_fail(size > 0, NULL);
+
+    /* Make sure value fits in storage. */
+    g_return_val_if_fail(
+        (value == NULL) || (size <= CCL_ARG_INLINE_SIZE), NULL);
+
+    return ccl_arg_init_full(storage, value, size, &arg_stack_marker);
+}
+
 /**
  * Destroy a kernel argument.
  *
@@ -103,9 +206,11 @@ void ccl_arg_destroy(CCLArg * arg) {
     /* Make sure arg is not NULL. */
     g_return_if_fail(arg != NULL);
 
-    if ccl_arg_is_local(arg) {
+    if (arg->info == (void *) &arg_local_marker) {
         g_free(arg->cl_object);
         g_slice_free(CCLArg, arg);
+    } else if (arg->info == (void *) &arg_inline_marker) {
+        g_slice_free(CCLArgStack, (CCLArgStack *) arg);
     }
 }
 
@@ -146,3 +251,50 @@ void * ccl_arg_value(CCLArg * arg) {
         ? arg->cl_object
         : &arg->cl_object;
 }
+
+/**
+ * Initialize a shared virtual memory pointer kernel argument in storage
+ * provided by client code, typically on the stack. No memory is
+ * allocated, and the argument is not released by kernels or by
+ * ::ccl_arg_destroy().
+ *
+ * @attention Client code shouldn't directly use this function, but use
+ * ccl_arg_svm() instead.
+ *
+ * @param[out] storage Storage for the argument.
+ * @param[in] svm_ptr SVM pointer.
+ * @return The argument.
+ * */
+CCL_EXPORT
+CCLArg * ccl_arg_svm_init(CCLArgStack * storage, void * svm_ptr) {
+
+    /* Make sure storage is not NULL. */
+    g_return_val_if_fail(storage != NULL, NULL);
+
+    /* The pointer value is kept in the object field, the same way as the
+     * OpenCL object of real wrappers. */
+    storage->class = CCL_NONE;
+    storage->cl_object = svm_ptr;
+    storage->info = (void *) &arg_svm_marker;
+    storage->ref_count = 0;
+
+    return (CCLArg *) storage;
+}
+
+/**
+ * Determine if kernel argument is a shared virtual memory pointer.
+ *
+ * @warning Client code shouldn't directly use this function.
+ *
+ * @param[in] arg Kernel argument.
+ * @return `CL_TRUE` if argument was created with ccl_arg_svm(), `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_arg_is_svm(CCLArg * arg) {
+
+    /* Make sure arg is not NULL. */
+    g_return_val_if_fail(arg != NULL, CL_FALSE);
+
+    return arg->info == (void *) &arg_svm_marker;
+}
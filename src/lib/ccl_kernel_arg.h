@@ -42,10 +42,50 @@
  * */
 typedef CCLWrapper CCLArg;
 
+/**
+ * Maximum size in bytes of private argument values which are stored
+ * inline in ::CCLArg* objects, i.e. without a separate heap copy.
+ * */
+#define CCL_ARG_INLINE_SIZE 16
+
+/**
+ * Storage for a private or local kernel argument which is allocated by
+ * client code, typically on the stack. Its layout mirrors the one of
+ * ::CCLWrapper objects, followed by inline storage for the argument
+ * value. Client code should not access its fields directly, but use
+ * the ::ccl_arg_priv_stack() and ::ccl_arg_local_stack() macros.
+ * */
+typedef struct ccl_arg_stack {
+
+    /** @private */
+    CCLClass class;
+
+    /** @private */
+    void * cl_object;
+
+    /** @private */
+    void * info;
+
+    /** @private */
+    int ref_count;
+
+    /** @private */
+    union {
+        unsigned char bytes[CCL_ARG_INLINE_SIZE];
+        cl_long l;
+        cl_double d;
+    } value;
+
+} CCLArgStack;
+
 /* Create a new kernel argument. */
 CCL_EXPORT
 CCLArg * ccl_arg_new(void * value, size_t size);
 
+/* Initialize a kernel argument in storage provided by client code. */
+CCL_EXPORT
+CCLArg * ccl_arg_init(CCLArgStack * storage, void * value, size_t size);
+
 /* Destroy a kernel argument. */
 CCL_EXPORT
 void ccl_arg_destroy(CCLArg * arg);
@@ -58,6 +98,15 @@ size_t ccl_arg_size(CCLArg * arg);
 CCL_EXPORT
 void * ccl_arg_value(CCLArg * arg);
 
+/* Initialize a shared virtual memory pointer kernel argument in storage
+ * provided by client code. */
+CCL_EXPORT
+CCLArg * ccl_arg_svm_init(CCLArgStack * storage, void * svm_ptr);
+
+/* Determine if kernel argument is a shared virtual memory pointer. */
+CCL_EXPORT
+cl_bool ccl_arg_is_svm(CCLArg * arg);
+
 /**
  * @defgroup CCL_KERNEL_ARG Kernel argument wrappers
  * @ingroup CCL_KERNEL_WRAPPER
@@ -71,7 +120,9 @@ void * ccl_arg_value(CCLArg * arg);
  * can be directly passed as global kernel arguments to these functions.
  * However, local and private kernel arguments need to be passed using
  * the macros provided in this module, namely ::ccl_arg_local() and
- * ::ccl_arg_priv(), respectively.
+ * ::ccl_arg_priv(), respectively. Pointers to
+ * @ref CCL_SVM "shared virtual memory" are passed using the
+ * ::ccl_arg_svm() macro.
  *
  * The ::ccl_arg_skip constant can be passed to methods which accept a
  * variable list of ordered arguments in order to skip a specific
@@ -105,8 +156,15 @@ void * ccl_arg_value(CCLArg * arg);
  * @{
  *
  * @note The ::ccl_arg_local() and ::ccl_arg_priv() macros invoke the
- * ::ccl_arg_new() function, which returns a new ::CCLArg* object. ::CCLArg*
- * objects are destroyed when the kernel to which they were passed is released.
+ * ::ccl_arg_new() function, which returns a new ::CCLArg* object. Values of
+ * up to ::CCL_ARG_INLINE_SIZE bytes are stored inline in the object. The
+ * kernel keeps a copy of the argument value, and ::CCLArg* objects are
+ * destroyed as soon as they are set in the kernel.
+ * The ::ccl_arg_priv_stack() and ::ccl_arg_local_stack() macros create
+ * arguments on the stack of the calling function instead, and thus perform
+ * no heap allocation at all. These are only valid within the statement
+ * (or block) where they are used, but can be safely passed to any of the
+ * functions which set kernel arguments.
  * For further control of argument instantiation, client code can use the
  * ::ccl_arg_full() macro instead of the ::ccl_arg_new() function in order to
  * respect the @ref ug_new_destroy "new/destroy" rule.
@@ -128,8 +186,8 @@ extern const CCLArg * ccl_arg_skip;
 /**
  * Define a private kernel argument.
  *
- * The created object is automatically released when kernel is
- * enqueued.
+ * The created object is automatically released when it is set as a
+ * kernel argument.
  *
  * @param[in] value Argument value. Must be a variable, not a literal
  * value.
@@ -144,8 +202,8 @@ extern const CCLArg * ccl_arg_skip;
  * Defines a local kernel argument, which allocates local memory
  * within the kernel with the specified size.
  *
- * The created object is automatically released when kernel is
- * enqueued.
+ * The created object is automatically released when it is set as a
+ * kernel argument.
  *
  * @param[in] count Number of values of type given in next parameter.
  * @param[in] type Argument scalar type, such as `cl_int`, `cl_float`,
@@ -158,8 +216,8 @@ extern const CCLArg * ccl_arg_skip;
 /**
  * Defines a kernel argument with more control.
  *
- * The created object is automatically released when kernel is
- * enqueued.
+ * The created object is automatically released when it is set as a
+ * kernel argument.
  *
  * @param[in] value Memory location of argument value. Can be NULL if
  * argument is local.
@@ -169,6 +227,58 @@ extern const CCLArg * ccl_arg_skip;
 #define ccl_arg_full(value, size) \
     ccl_arg_new(value, size)
 
+/**
+ * Define a private kernel argument on the stack of the calling
+ * function. No memory is allocated.
+ *
+ * The created object is only valid in the block where this macro is
+ * used, and is not released by the kernel.
+ *
+ * @param[in] value Argument value. Must be a variable, not a literal
+ * value.
+ * @param[in] type Argument scalar or vector type, such as `cl_int`,
+ * `cl_float4`, etc. Must not be larger than ::CCL_ARG_INLINE_SIZE
+ * bytes.
+ * @return A private ::CCLArg* kernel argument.
+ * */
+#define ccl_arg_priv_stack(value, type) \
+    ccl_arg_init(&(CCLArgStack) { CCL_NONE, NULL, NULL, 0, { { 0 } } }, \
+        &value, sizeof(type))
+
+/**
+ * Defines a local kernel argument on the stack of the calling
+ * function, which allocates local memory within the kernel with the
+ * specified size. No host memory is allocated.
+ *
+ * The created object is only valid in the block where this macro is
+ * used, and is not released by the kernel.
+ *
+ * @param[in] count Number of values of type given in next parameter.
+ * @param[in] type Argument scalar type, such as `cl_int`, `cl_float`,
+ * etc.
+ * @return A local ::CCLArg* kernel argument.
+ * */
+#define ccl_arg_local_stack(count, type) \
+    ccl_arg_init(&(CCLArgStack) { CCL_NONE, NULL, NULL, 0, { { 0 } } }, \
+        NULL, count * sizeof(type))
+
+/**
+ * Defines a shared virtual memory (SVM) pointer kernel argument, which
+ * is set with clSetKernelArgSVMPointer(). The pointer may point anywhere
+ * within an SVM allocation. No memory is allocated.
+ *
+ * The created object is only valid in the block where this macro is
+ * used, and is not released by the kernel.
+ *
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] svm_ptr SVM pointer, e.g. obtained with ::ccl_svm_get_ptr().
+ * @return An SVM pointer ::CCLArg* kernel argument.
+ * */
+#define ccl_arg_svm(svm_ptr) \
+    ccl_arg_svm_init(&(CCLArgStack) { CCL_NONE, NULL, NULL, 0, { { 0 } } }, \
+        (void *) (svm_ptr))
+
 /** @} */
 
 #endif
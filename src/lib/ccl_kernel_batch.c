@@ -0,0 +1,444 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of coalesced launches of many small invocations of the
+ * same kernel.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_kernel_batch.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * Coalesced kernel launches class.
+ *
+ * Launches are collected in one of two sets of host arrays, while the
+ * other set may still be uploaded from by the previous enqueue.
+ * */
+struct ccl_batch {
+
+    /**
+     * Kernel to launch.
+     * @private
+     * */
+    CCLKernel * krnl;
+
+    /**
+     * Command queue where the kernel is enqueued.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Index of the first of the three kernel parameters declared with
+     * `CCL_BATCH_PARAMS()`.
+     * @private
+     * */
+    cl_uint arg_index;
+
+    /**
+     * Size in bytes of the arguments structure of each launch.
+     * @private
+     * */
+    size_t args_size;
+
+    /**
+     * Arguments structures of launches, for each set.
+     * @private
+     * */
+    GByteArray * args[2];
+
+    /**
+     * Start of each launch in the concatenated work, for each set (arrays
+     * of `cl_uint`).
+     * @private
+     * */
+    GArray * starts[2];
+
+    /**
+     * Set where launches are being collected.
+     * @private
+     * */
+    guint cur;
+
+    /**
+     * Total number of work-items of launches being collected.
+     * @private
+     * */
+    cl_ulong total;
+
+    /**
+     * Event of the last upload from the other set, or `NULL` if none is
+     * pending.
+     * @private
+     * */
+    cl_event upload_evt;
+
+    /**
+     * Device buffer with arguments structures.
+     * @private
+     * */
+    CCLBuffer * args_buf;
+
+    /**
+     * Device buffer with launch starts.
+     * @private
+     * */
+    CCLBuffer * starts_buf;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Make sure a device buffer of a batch has at least the given size,
+ * replacing it with a larger one if necessary. Buffers only grow, at
+ * least doubling in size, so that steady state batches don't allocate.
+ *
+ * @param[in] batch A batch of coalesced kernel launches.
+ * @param[in,out] buf Location of the buffer, which may be `NULL`.
+ * @param[in] size Required size in bytes.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the buffer is large enough, `CL_FALSE` if an error
+ * occurs.
+ * */
+static cl_bool ccl_batch_reserve(CCLBatch * batch, CCLBuffer ** buf,
+    size_t size, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx;
+    size_t cur_size = 0;
+
+    /* Get current size. */
+    if (*buf != NULL) {
+        cur_size = ccl_memobj_get_info_scalar(
+            *buf, CL_MEM_SIZE, size_t, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (cur_size >= size) goto finish;
+    }
+
+    /* Replace buffer. Commands still using the old buffer are not
+     * affected by its release. */
+    ctx = ccl_queue_get_context(batch->cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    if (*buf != NULL) {
+        ccl_buffer_destroy(*buf);
+        *buf = NULL;
+    }
+    *buf = ccl_buffer_new(ctx, CL_MEM_READ_ONLY, MAX(size, 2 * cur_size),
+        NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+finish:
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @addtogroup CCL_KERNEL_BATCH
+ * @{
+ */
+
+/**
+ * Create a new batch of coalesced launches of a kernel. Other kernel
+ * arguments should be set as usual, and are shared by all launches.
+ *
+ * @public @memberof ccl_batch
+ *
+ * @param[in] krnl Kernel wrapper object, whose kernel declares its batch
+ * parameters with `CCL_BATCH_PARAMS()`.
+ * @param[in] cq In-order command queue wrapper object where the kernel is
+ * enqueued.
+ * @param[in] arg_index Index of the first of the three kernel parameters
+ * declared with `CCL_BATCH_PARAMS()`.
+ * @param[in] args_size Size in bytes of the arguments structure of each
+ * launch, which must match the size of its OpenCL C type.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new batch, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBatch * ccl_batch_new(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint arg_index, size_t args_size, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLBatch * batch = NULL;
+    cl_command_queue_properties props;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (krnl == NULL) || (cq == NULL) || (args_size == 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: kernel, command queue and arguments size must be set.",
+        CCL_STRD);
+
+    /* Device buffers are overwritten by the next enqueue, so the queue must
+     * be in-order. */
+    props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, CCL_ERROR_ARGS,
+        error_handler, "%s: batches require in-order queues.", CCL_STRD);
+
+    /* Create batch and keep references to kernel and queue. */
+    batch = g_slice_new0(CCLBatch);
+    batch->krnl = krnl;
+    ccl_kernel_ref(krnl);
+    batch->cq = cq;
+    ccl_queue_ref(cq);
+    batch->arg_index = arg_index;
+    batch->args_size = args_size;
+    for (guint i = 0; i < 2; ++i) {
+        batch->args[i] = g_byte_array_new();
+        batch->starts[i] = g_array_new(FALSE, FALSE, sizeof(cl_uint));
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return batch. */
+    return batch;
+}
+
+/**
+ * Destroy a batch of coalesced kernel launches, waiting for pending
+ * uploads and releasing its references to the kernel and command queue
+ * wrappers. Launches added since the last enqueue are discarded.
+ *
+ * @public @memberof ccl_batch
+ *
+ * @param[in] batch The batch to destroy.
+ * */
+CCL_EXPORT
+void ccl_batch_destroy(CCLBatch * batch) {
+
+    /* Make sure batch is not NULL. */
+    g_return_if_fail(batch != NULL);
+
+    if (batch->upload_evt != NULL) {
+        clWaitForEvents(1, &batch->upload_evt);
+        clReleaseEvent(batch->upload_evt);
+    }
+    for (guint i = 0; i < 2; ++i) {
+        g_byte_array_free(batch->args[i], TRUE);
+        g_array_free(batch->starts[i], TRUE);
+    }
+    if (batch->args_buf != NULL) ccl_buffer_destroy(batch->args_buf);
+    if (batch->starts_buf != NULL) ccl_buffer_destroy(batch->starts_buf);
+    ccl_kernel_unref(batch->krnl);
+    ccl_queue_unref(batch->cq);
+    g_slice_free(CCLBatch, batch);
+}
+
+/**
+ * Add a launch to a batch. The launch is only enqueued, together with the
+ * other launches in the batch, by ::ccl_batch_enqueue().
+ *
+ * @public @memberof ccl_batch
+ *
+ * @param[in] batch A batch of coalesced kernel launches.
+ * @param[in] work_items Number of work-items of the launch, which must be
+ * larger than 0.
+ * @param[in] args Arguments structure of the launch, which is copied.
+ * */
+CCL_EXPORT
+void ccl_batch_add(CCLBatch * batch, size_t work_items, const void * args) {
+
+    /* Make sure batch is not NULL. */
+    g_return_if_fail(batch != NULL);
+    /* Make sure args is not NULL. */
+    g_return_if_fail(args != NULL);
+    /* Make sure the launch has work-items. */
+    g_return_if_fail(work_items > 0);
+
+    /* Starts beyond 32 bits are detected when enqueuing. */
+    cl_uint start = (cl_uint) MIN(batch->total, G_MAXUINT32);
+
+    g_byte_array_append(batch->args[batch->cur], args,
+        (guint) batch->args_size);
+    g_array_append_val(batch->starts[batch->cur], start);
+    batch->total += work_items;
+}
+
+/**
+ * Get the number of launches added to a batch since it was last enqueued.
+ *
+ * @public @memberof ccl_batch
+ *
+ * @param[in] batch A batch of coalesced kernel launches.
+ * @return Number of launches in the batch.
+ * */
+CCL_EXPORT
+cl_uint ccl_batch_get_num_launches(CCLBatch * batch) {
+
+    /* Make sure batch is not NULL. */
+    g_return_val_if_fail(batch != NULL, 0);
+
+    return batch->starts[batch->cur]->len;
+}
+
+/**
+ * Enqueue all launches added to a batch as a single one-dimensional
+ * NDRange over their concatenated work-items. The arguments structures
+ * and launch starts are uploaded with non-blocking writes, and the
+ * batch can immediately be reused for further launches. If the batch is
+ * empty, a marker is enqueued instead.
+ *
+ * @public @memberof ccl_batch
+ *
+ * @param[in] batch A batch of coalesced kernel launches.
+ * @param[in] local_work_size Number of work-items in each work-group, or
+ * `NULL` to let the OpenCL implementation decide. If set, the global work
+ * size is rounded up to a multiple of it.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the kernel can be executed. The list will be cleared and can be
+ * reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the kernel execution, or
+ * `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_batch_enqueue(CCLBatch * batch,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    /* Make sure batch is not NULL. */
+    g_return_val_if_fail(batch != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    CCLEvent * evt_upload;
+    GByteArray * args = batch->args[batch->cur];
+    GArray * starts = batch->starts[batch->cur];
+    cl_uint num = starts->len;
+    cl_uint total;
+    size_t gws;
+
+    /* If there is nothing to launch, enqueue a marker. */
+    if (num == 0) {
+        evt = ccl_enqueue_marker(batch->cq, evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        goto finish;
+    }
+
+    /* Work-item indexes are 32-bit in kernels. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, batch->total > G_MAXUINT32,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: total number of work-items in batch exceeds 32 bits.",
+        CCL_STRD);
+    total = (cl_uint) batch->total;
+    g_array_append_val(starts, total);
+
+    /* Upload arguments structures and launch starts. */
+    ccl_batch_reserve(batch, &batch->args_buf, args->len, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_batch_reserve(batch, &batch->starts_buf,
+        starts->len * sizeof(cl_uint), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_buffer_enqueue_write(batch->args_buf, batch->cq, CL_FALSE, 0,
+        args->len, args->data, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    evt_upload = ccl_buffer_enqueue_write(batch->starts_buf, batch->cq,
+        CL_FALSE, 0, starts->len * sizeof(cl_uint), starts->data, NULL,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Enqueue kernel over the concatenated work. */
+    gws = total;
+    if (local_work_size != NULL)
+        gws = ((gws + *local_work_size - 1) / *local_work_size)
+            * *local_work_size;
+    ccl_kernel_set_arg(batch->krnl, batch->arg_index, batch->args_buf);
+    ccl_kernel_set_arg(batch->krnl, batch->arg_index + 1, batch->starts_buf);
+    ccl_kernel_set_arg(batch->krnl, batch->arg_index + 2,
+        ccl_arg_priv(num, cl_uint));
+    evt = ccl_kernel_enqueue_ndrange(batch->krnl, batch->cq, 1, NULL, &gws,
+        local_work_size, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Collect further launches in the other set of host arrays, once its
+     * previous upload is done. The current set is kept until its upload
+     * is done, keeping a reference to the OpenCL event, since event
+     * wrappers are owned by the command queue. */
+    if (batch->upload_evt != NULL) {
+        clWaitForEvents(1, &batch->upload_evt);
+        clReleaseEvent(batch->upload_evt);
+    }
+    batch->upload_evt = ccl_event_unwrap(evt_upload);
+    clRetainEvent(batch->upload_evt);
+    batch->cur = 1 - batch->cur;
+    g_byte_array_set_size(batch->args[batch->cur], 0);
+    g_array_set_size(batch->starts[batch->cur], 0);
+    batch->total = 0;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Keep launches, without the final start, so that enqueue can be
+     * retried. */
+    if (starts->len > num) g_array_set_size(starts, num);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/** @} */
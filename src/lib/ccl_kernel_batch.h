@@ -0,0 +1,158 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of coalesced launches of many small invocations of the same
+ * kernel.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_KERNEL_BATCH_H_
+#define _CCL_KERNEL_BATCH_H_
+
+#include "ccl_common.h"
+#include "ccl_kernel_wrapper.h"
+
+/**
+ * @defgroup CCL_KERNEL_BATCH Coalesced kernel launches
+ * @ingroup CCL_KERNEL_WRAPPER
+ *
+ * This module coalesces many small launches of the same kernel, which
+ * differ only in their number of work-items and in a small structure of
+ * arguments, into a single one-dimensional NDRange.
+ *
+ * Launches are collected with ::ccl_batch_add(), which appends the
+ * arguments structure of each launch to a host array. When the batch is
+ * enqueued with ::ccl_batch_enqueue(), the arguments and the start of
+ * each launch in the concatenated work are uploaded to device buffers,
+ * and the kernel is enqueued once over the work-items of all launches.
+ *
+ * The kernel declares three consecutive parameters with the
+ * `CCL_BATCH_PARAMS(type)` macro, where `type` is the OpenCL C type of the
+ * arguments structure, and starts with the `CCL_BATCH_PROLOGUE(launch,
+ * item)` macro, which declares the index of the launch the work-item
+ * belongs to and the index of the work-item within that launch, and
+ * returns from work-items past the end of the concatenated work. Both
+ * macros are defined in ::CCL_BATCH_SRC, which must be prepended to the
+ * program sources. The arguments of the launch are then available in
+ * `ccl_batch_args[launch]`.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * const char * kernel_src =
+ *     "typedef struct { uint offset; uint len; } seg_t;\n"
+ *     "__kernel void scale(__global float * data, float factor,\n"
+ *     "    CCL_BATCH_PARAMS(seg_t)) {\n"
+ *     "    CCL_BATCH_PROLOGUE(launch, item);\n"
+ *     "    data[ccl_batch_args[launch].offset + item] *= factor;\n"
+ *     "}\n";
+ * const char * srcs[] = { CCL_BATCH_SRC, kernel_src };
+ * struct { cl_uint offset; cl_uint len; } seg;
+ * CCLBatch * batch;
+ * size_t lws = 64;
+ * @endcode
+ * @code{.c}
+ * prg = ccl_program_new_from_sources(ctx, 2, srcs, NULL, NULL);
+ * ccl_program_build(prg, NULL, NULL);
+ * krnl = ccl_kernel_new(prg, "scale", NULL);
+ * ccl_kernel_set_args(krnl, buf, ccl_arg_priv(factor, cl_float), NULL);
+ * batch = ccl_batch_new(krnl, cq, 2, sizeof(seg), NULL);
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < num_segs; ++i) {
+ *     seg.offset = seg_offsets[i];
+ *     seg.len = seg_lens[i];
+ *     ccl_batch_add(batch, seg.len, &seg);
+ * }
+ * ccl_batch_enqueue(batch, &lws, NULL, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_batch_destroy(batch);
+ * @endcode
+ *
+ * @attention Batches are not thread-safe, and the kernel arguments set by
+ * ::ccl_batch_enqueue() are kept by the kernel wrapper, like any other
+ * argument.
+ *
+ * @{
+ */
+
+/**
+ * OpenCL C source of the helper macros for kernels launched in batches,
+ * to be prepended to the program sources.
+ * */
+#define CCL_BATCH_SRC \
+    "#define CCL_BATCH_PARAMS(type) \\\n" \
+    "    __global const type * ccl_batch_args, \\\n" \
+    "    __global const uint * ccl_batch_starts, \\\n" \
+    "    const uint ccl_batch_num\n" \
+    "#define CCL_BATCH_PROLOGUE(launch, item) \\\n" \
+    "    uint launch, item; \\\n" \
+    "    if (!ccl_batch_locate(ccl_batch_starts, ccl_batch_num, \\\n" \
+    "        &launch, &item)) return\n" \
+    "int ccl_batch_locate(__global const uint * starts, uint num,\n" \
+    "    uint * launch, uint * item) {\n" \
+    "    uint gid = (uint) get_global_id(0);\n" \
+    "    uint lo = 0, hi = num;\n" \
+    "    if (gid >= starts[num]) return 0;\n" \
+    "    while (hi - lo > 1) {\n" \
+    "        uint mid = lo + (hi - lo) / 2;\n" \
+    "        if (starts[mid] <= gid) lo = mid; else hi = mid;\n" \
+    "    }\n" \
+    "    *launch = lo;\n" \
+    "    *item = gid - starts[lo];\n" \
+    "    return 1;\n" \
+    "}\n"
+
+/**
+ * Coalesced kernel launches class.
+ * */
+typedef struct ccl_batch CCLBatch;
+
+/* Create a new batch of coalesced launches of a kernel. */
+CCL_EXPORT
+CCLBatch * ccl_batch_new(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint arg_index, size_t args_size, CCLErr ** err);
+
+/* Destroy a batch of coalesced kernel launches. */
+CCL_EXPORT
+void ccl_batch_destroy(CCLBatch * batch);
+
+/* Add a launch to a batch. */
+CCL_EXPORT
+void ccl_batch_add(CCLBatch * batch, size_t work_items, const void * args);
+
+/* Get the number of launches added to a batch since it was last
+ * enqueued. */
+CCL_EXPORT
+cl_uint ccl_batch_get_num_launches(CCLBatch * batch);
+
+/* Enqueue all launches added to a batch as a single NDRange. */
+CCL_EXPORT
+CCLEvent * ccl_batch_enqueue(CCLBatch * batch,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
+/** @} */
+
+#endif
@@ -0,0 +1,279 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of prepared kernel launch objects and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_kernel_launch.h"
+#include "_ccl_kernel_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * Prepared kernel launch class.
+ * */
+struct ccl_launch {
+
+    /**
+     * Kernel to launch.
+     * @private
+     * */
+    CCLKernel * krnl;
+
+    /**
+     * Command queue where kernel is enqueued.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Number of work dimensions.
+     * @private
+     * */
+    cl_uint work_dim;
+
+    /**
+     * Global work offset, or `NULL` if not set.
+     * @private
+     * */
+    size_t * global_work_offset;
+
+    /**
+     * Global work size.
+     * @private
+     * */
+    size_t * global_work_size;
+
+    /**
+     * Local work size, or `NULL` if not set.
+     * @private
+     * */
+    size_t * local_work_size;
+
+    /**
+     * Storage for offset, global and local work sizes, `work_dim`
+     * values each.
+     * @private
+     * */
+    size_t * sizes;
+
+};
+
+/**
+ * @addtogroup CCL_KERNEL_LAUNCH
+ * @{
+ */
+
+/**
+ * Create a new prepared kernel launch object. The kernel and command
+ * queue wrappers are referenced by the launch object, and the work
+ * sizes are copied, so client code can release or modify them
+ * afterwards.
+ *
+ * @public @memberof ccl_launch
+ *
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] cq A command queue wrapper object.
+ * @param[in] work_dim The number of dimensions used to specify the
+ * global work-items and work-items in the work-group.
+ * @param[in] global_work_offset Can be used to specify an array of
+ * `work_dim` unsigned values that describe the offset used to calculate
+ * the global ID of a work-item.
+ * @param[in] global_work_size An array of `work_dim` unsigned values
+ * that describe the number of global work-items in `work_dim`
+ * dimensions that will execute the kernel function.
+ * @param[in] local_work_size An array of `work_dim` unsigned values
+ * that describe the number of work-items that make up a work-group that
+ * will execute the specified kernel.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @param[in] ... A `NULL`-terminated list of arguments to set, as in
+ * ::ccl_kernel_set_args().
+ * @return A new prepared kernel launch object, or `NULL` if an error
+ * occurs.
+ * */
+CCL_EXPORT
+CCLLaunch * ccl_launch_new(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    CCLErr ** err, ...) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Launch object. */
+    CCLLaunch * lnch = NULL;
+    /* The va_list, which represents the variable argument list. */
+    va_list args_va;
+    /* Current argument. */
+    void * arg;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (krnl == NULL) || (cq == NULL), CCL_ERROR_ARGS, error_handler,
+        "%s: kernel and command queue must not be NULL.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (work_dim == 0) || (global_work_size == NULL), CCL_ERROR_ARGS,
+        error_handler, "%s: work dimensions and global work size must "
+        "be specified.", CCL_STRD);
+
+    /* Create launch object and keep references to kernel and queue. */
+    lnch = g_slice_new0(CCLLaunch);
+    lnch->krnl = krnl;
+    ccl_kernel_ref(krnl);
+    lnch->cq = cq;
+    ccl_queue_ref(cq);
+
+    /* Keep copies of work sizes. */
+    lnch->work_dim = work_dim;
+    lnch->sizes = g_slice_alloc0(3 * work_dim * sizeof(size_t));
+    lnch->global_work_size = lnch->sizes + work_dim;
+    memcpy(lnch->global_work_size, global_work_size,
+        work_dim * sizeof(size_t));
+    ccl_launch_set_offset(lnch, global_work_offset);
+    if (local_work_size != NULL) {
+        lnch->local_work_size = lnch->sizes + 2 * work_dim;
+        memcpy(lnch->local_work_size, local_work_size,
+            work_dim * sizeof(size_t));
+    }
+
+    /* Set kernel arguments, if any. */
+    va_start(args_va, err);
+    ccl_kernel_set_args_va(krnl, args_va);
+    va_end(args_va);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Arguments were not consumed by the kernel, release them here. */
+    va_start(args_va, err);
+    while ((arg = va_arg(args_va, void *)) != NULL) {
+        if (arg != ccl_arg_skip) ccl_arg_destroy((CCLArg *) arg);
+    }
+    va_end(args_va);
+
+finish:
+
+    /* Return launch object. */
+    return lnch;
+}
+
+/**
+ * Destroy a prepared kernel launch object, releasing its references to
+ * the kernel and command queue wrappers.
+ *
+ * @public @memberof ccl_launch
+ *
+ * @param[in] lnch The prepared kernel launch object.
+ * */
+CCL_EXPORT
+void ccl_launch_destroy(CCLLaunch * lnch) {
+
+    /* Make sure lnch is not NULL. */
+    g_return_if_fail(lnch != NULL);
+
+    ccl_kernel_unref(lnch->krnl);
+    ccl_queue_unref(lnch->cq);
+    g_slice_free1(3 * lnch->work_dim * sizeof(size_t), lnch->sizes);
+    g_slice_free(CCLLaunch, lnch);
+}
+
+/**
+ * Set one argument of a prepared kernel launch. The argument is only
+ * sent to the driver on the next enqueue, and only if its value
+ * differs from the one last sent.
+ *
+ * @public @memberof ccl_launch
+ *
+ * @param[in] lnch The prepared kernel launch object.
+ * @param[in] arg_index Argument index.
+ * @param[in] arg Argument to set. Arguments must be of type ::CCLArg*,
+ * ::CCLBuffer*, ::CCLImage*, ::CCLPipe* or ::CCLSampler*.
+ * */
+CCL_EXPORT
+void ccl_launch_set_arg(CCLLaunch * lnch, cl_uint arg_index, void * arg) {
+
+    /* Make sure lnch is not NULL. */
+    g_return_if_fail(lnch != NULL);
+
+    ccl_kernel_set_arg(lnch->krnl, arg_index, arg);
+}
+
+/**
+ * Set the global work offset of a prepared kernel launch.
+ *
+ * @public @memberof ccl_launch
+ *
+ * @param[in] lnch The prepared kernel launch object.
+ * @param[in] global_work_offset An array of `work_dim` unsigned values
+ * that describe the offset used to calculate the global ID of a
+ * work-item, or `NULL` for no offset.
+ * */
+CCL_EXPORT
+void ccl_launch_set_offset(
+    CCLLaunch * lnch, const size_t * global_work_offset) {
+
+    /* Make sure lnch is not NULL. */
+    g_return_if_fail(lnch != NULL);
+
+    if (global_work_offset != NULL) {
+        lnch->global_work_offset = lnch->sizes;
+        memcpy(lnch->global_work_offset, global_work_offset,
+            lnch->work_dim * sizeof(size_t));
+    } else {
+        lnch->global_work_offset = NULL;
+    }
+}
+
+/**
+ * Enqueue a prepared kernel launch for execution on its device.
+ *
+ * @public @memberof ccl_launch
+ *
+ * @param[in] lnch The prepared kernel launch object.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_launch_enqueue(
+    CCLLaunch * lnch, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure lnch is not NULL. */
+    g_return_val_if_fail(lnch != NULL, NULL);
+
+    return ccl_kernel_enqueue_ndrange(lnch->krnl, lnch->cq,
+        lnch->work_dim, lnch->global_work_offset, lnch->global_work_size,
+        lnch->local_work_size, evt_wait_lst, err);
+}
+
+/** @} */
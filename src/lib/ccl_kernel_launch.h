@@ -0,0 +1,114 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of prepared kernel launch objects and related functions.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_KERNEL_LAUNCH_H_
+#define _CCL_KERNEL_LAUNCH_H_
+
+#include "ccl_common.h"
+#include "ccl_kernel_wrapper.h"
+
+/**
+ * @defgroup CCL_KERNEL_LAUNCH Prepared kernel launches
+ * @ingroup CCL_KERNEL_WRAPPER
+ *
+ * This module provides prepared launch objects, which capture a kernel,
+ * a command queue, the work dimensions and sizes, and the kernel
+ * arguments, in order to repeatedly enqueue the same kernel with as
+ * little host overhead as possible.
+ *
+ * Arguments are kept in the kernel argument table, so only arguments
+ * updated with ::ccl_launch_set_arg() between enqueues, and whose value
+ * actually changed, are sent to the driver. Together with the
+ * ::ccl_arg_priv_stack() macro, repeated launches perform no heap
+ * allocations for arguments.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLLaunch * lnch;
+ * CCLKernel * krnl;
+ * CCLQueue * cq;
+ * CCLBuffer * buf;
+ * size_t gws = 1024, lws = 64, offset = 0;
+ * cl_uint iter = 0;
+ * @endcode
+ * @code{.c}
+ * lnch = ccl_launch_new(krnl, cq, 1, &offset, &gws, &lws, NULL,
+ *     buf, ccl_arg_priv_stack(iter, cl_uint), NULL);
+ * @endcode
+ * @code{.c}
+ * for (iter = 0; iter < 1000; ++iter) {
+ *     offset = iter * gws;
+ *     ccl_launch_set_offset(lnch, &offset);
+ *     ccl_launch_set_arg(lnch, 1, ccl_arg_priv_stack(iter, cl_uint));
+ *     ccl_launch_enqueue(lnch, NULL, NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_launch_destroy(lnch);
+ * @endcode
+ *
+ * @attention Like kernel wrappers, launch objects are not thread-safe.
+ * Since arguments are kept by the kernel, launch objects sharing the same
+ * kernel wrapper also share its arguments.
+ *
+ * @{
+ */
+
+/**
+ * Prepared kernel launch class.
+ * */
+typedef struct ccl_launch CCLLaunch;
+
+/* Create a new prepared kernel launch object. */
+CCL_EXPORT
+CCLLaunch * ccl_launch_new(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    CCLErr ** err, ...);
+
+/* Destroy a prepared kernel launch object. */
+CCL_EXPORT
+void ccl_launch_destroy(CCLLaunch * lnch);
+
+/* Set one argument of a prepared kernel launch. */
+CCL_EXPORT
+void ccl_launch_set_arg(CCLLaunch * lnch, cl_uint arg_index, void * arg);
+
+/* Set the global work offset of a prepared kernel launch. */
+CCL_EXPORT
+void ccl_launch_set_offset(
+    CCLLaunch * lnch, const size_t * global_work_offset);
+
+/* Enqueue a prepared kernel launch. */
+CCL_EXPORT
+CCLEvent * ccl_launch_enqueue(
+    CCLLaunch * lnch, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/** @} */
+
+#endif
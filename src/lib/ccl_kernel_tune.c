@@ -0,0 +1,684 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of the empirical work size auto-tuner.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include <math.h>
+#include "ccl_kernel_tune.h"
+#include "_ccl_kernel_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ * Characters not allowed in tuning cache groups and keys, which are
+ * replaced by underscores.
+ * */
+#define CCL_KERNEL_TUNE_CACHE_INVALID "[]=\n\r"
+
+/* Lock protecting the tuning cache. */
+static GMutex tune_lock;
+
+/* In-memory copy of the tuning cache, loaded on first use. */
+static GKeyFile * tune_cache = NULL;
+
+/* Tuning cache file, or NULL to use the default location. */
+static gchar * tune_cache_file = NULL;
+
+/**
+ * @internal
+ * Load the tuning cache from disk, if not already loaded. Must be
+ * called with the tuning cache lock held.
+ * */
+static void ccl_kernel_tune_cache_load() {
+
+    /* Is cache already loaded? */
+    if (tune_cache != NULL) return;
+
+    /* Determine default cache file, if not set. */
+    if (tune_cache_file == NULL)
+        tune_cache_file = g_build_filename(
+            g_get_user_cache_dir(), "cf4ocl", "worksizes.ini", NULL);
+
+    /* A missing or invalid cache file just means that nothing was
+     * tuned yet. */
+    tune_cache = g_key_file_new();
+    g_key_file_load_from_file(
+        tune_cache, tune_cache_file, G_KEY_FILE_NONE, NULL);
+}
+
+/**
+ * @internal
+ * Save the tuning cache to disk. Must be called with the tuning cache
+ * lock held. Failing to save the cache is not an error, since tuning
+ * results are still valid, so only a warning is issued.
+ * */
+static void ccl_kernel_tune_cache_save() {
+
+    /* Internal error object. */
+    GError * err_save = NULL;
+    /* Cache file directory. */
+    gchar * dir = g_path_get_dirname(tune_cache_file);
+
+    /* Make sure cache directory exists and save cache. */
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_key_file_save_to_file(tune_cache, tune_cache_file, &err_save)) {
+        g_warning("Unable to save work size tuning cache: %s",
+            err_save->message);
+        g_error_free(err_save);
+    }
+    g_free(dir);
+}
+
+/**
+ * @internal
+ * Lookup tuned local work sizes in the tuning cache.
+ *
+ * @param[in] group Cache group (device identification).
+ * @param[in] key Cache key (kernel and problem identification).
+ * @param[in] dims Number of dimensions.
+ * @param[in] real_worksize The real worksize.
+ * @param[in] exact Must local work sizes be divisors of the real worksize?
+ * @param[out] lws Location where to place cached local work sizes.
+ * @return `CL_TRUE` if valid local work sizes were found in the cache,
+ * `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_kernel_tune_cache_lookup(const char * group,
+    const char * key, cl_uint dims, const size_t * real_worksize,
+    cl_bool exact, size_t * lws) {
+
+    /* Cached values. */
+    gint * values;
+    gsize num_values = 0;
+    /* Are cached values valid? */
+    cl_bool found = CL_FALSE;
+
+    g_mutex_lock(&tune_lock);
+
+    /* Get cached values, if any. */
+    ccl_kernel_tune_cache_load();
+    values = g_key_file_get_integer_list(
+        tune_cache, group, key, &num_values, NULL);
+
+    /* Only use cached values if they make sense for this problem (e.g.
+     * in case the cache file was edited by hand). */
+    if ((values != NULL) && (num_values == dims)) {
+        found = CL_TRUE;
+        for (cl_uint i = 0; i < dims; ++i) {
+            if ((values[i] <= 0)
+                || (exact && (real_worksize[i] % values[i] != 0)))
+            {
+                found = CL_FALSE;
+                break;
+            }
+            lws[i] = (size_t) values[i];
+        }
+    }
+
+    g_mutex_unlock(&tune_lock);
+
+    g_free(values);
+    return found;
+}
+
+/**
+ * @internal
+ * Keep tuned local work sizes in the tuning cache, and save it to disk.
+ *
+ * @param[in] group Cache group (device identification).
+ * @param[in] key Cache key (kernel and problem identification).
+ * @param[in] dims Number of dimensions.
+ * @param[in] lws Tuned local work sizes.
+ * */
+static void ccl_kernel_tune_cache_store(const char * group,
+    const char * key, cl_uint dims, const size_t * lws) {
+
+    /* Values to cache. */
+    gint * values = g_new(gint, dims);
+    for (cl_uint i = 0; i < dims; ++i)
+        values[i] = (gint) lws[i];
+
+    g_mutex_lock(&tune_lock);
+
+    ccl_kernel_tune_cache_load();
+    g_key_file_set_integer_list(tune_cache, group, key, values, dims);
+    ccl_kernel_tune_cache_save();
+
+    g_mutex_unlock(&tune_lock);
+
+    g_free(values);
+}
+
+/**
+ * @internal
+ * Is the given error due to the device rejecting a local work size?
+ *
+ * @param[in] err Error object.
+ * @return `CL_TRUE` if the error is due to the device rejecting a local
+ * work size, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_kernel_tune_rejected(CCLErr * err) {
+
+    return (err->domain == CCL_OCL_ERROR)
+        && ((err->code == CL_INVALID_WORK_GROUP_SIZE)
+            || (err->code == CL_INVALID_WORK_ITEM_SIZE)
+            || (err->code == CL_OUT_OF_RESOURCES));
+}
+
+/**
+ * @internal
+ * Time the execution of a kernel with the given local work size.
+ *
+ * @param[in] krnl Kernel wrapper object.
+ * @param[in] cq Command queue wrapper object, with profiling enabled.
+ * @param[in] dims Number of dimensions.
+ * @param[in] real_worksize The real worksize.
+ * @param[in] exact If `CL_TRUE`, the global work size is the real work
+ * size; otherwise it is the real work size rounded up to a multiple of
+ * the local work size.
+ * @param[in] lws Candidate local work size.
+ * @param[out] gws Storage for `dims` global work size values.
+ * @param[in] num_trials Number of timed executions.
+ * @param[out] time Location where to place the fastest execution time,
+ * in nanoseconds, or `CL_ULONG_MAX` if the device does not accept the
+ * candidate local work size.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_kernel_tune_time(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint dims, const size_t * real_worksize, cl_bool exact,
+    const size_t * lws, size_t * gws, cl_uint num_trials,
+    cl_ulong * time, CCLErr ** err) {
+
+    /* Event wait list. */
+    CCLEventWaitList ewl = NULL;
+    /* Kernel execution event. */
+    CCLEvent * evt;
+    /* Execution start and end instants. */
+    cl_ulong tstart, tend;
+    /* Function return status. */
+    cl_bool ret_status;
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Determine global work size. */
+    for (cl_uint i = 0; i < dims; ++i) {
+        gws[i] = exact ? real_worksize[i]
+            : ((real_worksize[i] + lws[i] - 1) / lws[i]) * lws[i];
+    }
+
+    /* First execution is a warm-up run, and is not timed. */
+    *time = CL_ULONG_MAX;
+    for (cl_uint t = 0; t <= num_trials; ++t) {
+
+        /* Execute kernel and wait for it to finish. */
+        evt = ccl_kernel_enqueue_ndrange(krnl, cq, dims, NULL, gws, lws,
+            NULL, &err_internal);
+        if ((err_internal != NULL) && ccl_kernel_tune_rejected(err_internal)) {
+            /* Device does not accept this local work size, skip it. */
+            g_error_free(err_internal);
+            *time = CL_ULONG_MAX;
+            break;
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Skip warm-up run. */
+        if (t == 0) continue;
+
+        /* Keep fastest execution time. */
+        tstart = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        tend = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        *time = MIN(*time, tend - tstart);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Compare two durations, for sorting. Compatible with
+ * `GCompareFunc`.
+ *
+ * @param[in] a First duration.
+ * @param[in] b Second duration.
+ * @return Negative, zero or positive if `a` is smaller than, equal to or
+ * larger than `b`.
+ * */
+static gint ccl_kernel_bench_cmp(gconstpointer a, gconstpointer b) {
+
+    cl_ulong ta = *((const cl_ulong *) a);
+    cl_ulong tb = *((const cl_ulong *) b);
+
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * @addtogroup CCL_KERNEL_TUNE
+ * @{
+ */
+
+/**
+ * Determine the fastest local (and optionally global) work sizes for the
+ * given real work size, by timing candidate local work sizes on the
+ * device associated with the given command queue.
+ *
+ * Parameters have the same meaning as in ::ccl_kernel_suggest_worksizes().
+ * If a result for the same device, driver, kernel, problem size and
+ * local work size limits is found in the tuning cache, it is used
+ * directly, and no kernel is executed.
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @param[in] krnl Kernel wrapper object, with all arguments set.
+ * @param[in] cq Command queue wrapper object, created with the
+ * `CL_QUEUE_PROFILING_ENABLE` property.
+ * @param[in] dims The number of dimensions used to specify the global
+ * work-items and work-items in the work-group.
+ * @param[in] real_worksize The real worksize.
+ * @param[out] gws Location where to place a global worksize which is
+ * equal or larger than `real_worksize` and a multiple of `lws`, or `NULL`
+ * if the global worksize must be equal to `real_worksize`.
+ * @param[in,out] lws As an input, the maximum allowed local work size for
+ * each dimension, or zeros if only the kernel and device limits apply; as
+ * an output, the fastest local work size found.
+ * @param[in] num_trials Number of timed executions of each candidate,
+ * or zero to use ::CCL_KERNEL_TUNE_TRIALS.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_kernel_tune_worksizes(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint dims, const size_t * real_worksize, size_t * gws, size_t * lws,
+    cl_uint num_trials, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, CL_FALSE);
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, CL_FALSE);
+    /* Make sure dims not zero. */
+    g_return_val_if_fail(dims > 0, CL_FALSE);
+    /* Make sure real_worksize is not NULL. */
+    g_return_val_if_fail(real_worksize != NULL, CL_FALSE);
+    /* Make sure lws is not NULL. */
+    g_return_val_if_fail(lws != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Queue properties. */
+    cl_command_queue_properties qprop;
+    /* Queue device. */
+    CCLDevice * dev;
+    /* Kernel and device work size limits. */
+    const CCLKernelWSProfile * prof;
+    /* Kernel work group size limit and preferred multiple. */
+    size_t wg_size_max, wg_size_mult = 1;
+    /* Storage for user limits, effective limits, heuristic, best and
+     * candidate local work sizes, and candidate global work size, dims
+     * values each. */
+    size_t * ws = NULL;
+    size_t * lim, * max_wi, * heur, * best, * cand, * cgws;
+    /* Must local work sizes be divisors of the real work size? */
+    cl_bool exact = (gws == NULL);
+    /* Total real work size. */
+    size_t real_ws = 1;
+    /* Execution times. */
+    cl_ulong best_time, cand_time;
+    /* Tuning cache group and key. */
+    gchar * group = NULL;
+    GString * key = NULL;
+    /* Device and kernel identification. */
+    char * dev_name, * drv_ver, * krnl_name;
+    /* Function return status. */
+    cl_bool ret_status;
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Use default number of trials if none given. */
+    if (num_trials == 0) num_trials = CCL_KERNEL_TUNE_TRIALS;
+
+    /* Check that queue has profiling enabled. */
+    qprop = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (qprop & CL_QUEUE_PROFILING_ENABLE) == 0, CCL_ERROR_ARGS,
+        error_handler,
+        "%s: work size tuning requires a queue with profiling enabled.",
+        CCL_STRD);
+
+    /* Get queue device. */
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Build tuning cache group from device name and driver version. */
+    dev_name = ccl_device_get_info_array(
+        dev, CL_DEVICE_NAME, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    drv_ver = ccl_device_get_info_array(
+        dev, CL_DRIVER_VERSION, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    group = g_strdup_printf("%s / %s", dev_name, drv_ver);
+    g_strdelimit(group, CCL_KERNEL_TUNE_CACHE_INVALID, '_');
+
+    /* Build tuning cache key from kernel name, real work size, local work
+     * size limits and global work size type. */
+    krnl_name = ccl_kernel_get_info_array(
+        krnl, CL_KERNEL_FUNCTION_NAME, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    key = g_string_new(krnl_name);
+    for (cl_uint i = 0; i < dims; ++i)
+        g_string_append_printf(key, "%c%lu", i == 0 ? '/' : 'x',
+            (unsigned long) real_worksize[i]);
+    for (cl_uint i = 0; i < dims; ++i)
+        g_string_append_printf(key, "%c%lu", i == 0 ? '/' : 'x',
+            (unsigned long) lws[i]);
+    g_string_append(key, exact ? "/exact" : "/padded");
+    g_strdelimit(key->str, CCL_KERNEL_TUNE_CACHE_INVALID, '_');
+
+    /* Setup work size storage. */
+    ws = g_slice_alloc(6 * dims * sizeof(size_t));
+    lim = ws;
+    max_wi = ws + dims;
+    heur = ws + 2 * dims;
+    best = ws + 3 * dims;
+    cand = ws + 4 * dims;
+    cgws = ws + 5 * dims;
+    memcpy(lim, lws, dims * sizeof(size_t));
+
+    /* Was this problem already tuned? If so, we're done. */
+    if (ccl_kernel_tune_cache_lookup(
+        group, key->str, dims, real_worksize, exact, best))
+    {
+        goto tuned;
+    }
+
+    /* Get the heuristic suggestion, which is always a candidate. */
+    memcpy(heur, lim, dims * sizeof(size_t));
+    ccl_kernel_suggest_worksizes(krnl, dev, dims, real_worksize,
+        exact ? NULL : cgws, heur, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Get device and kernel limits. The preferred work group size
+     * multiple is only used to discard small candidates, so ignore it
+     * if it's just the maximum work group size (e.g. OpenCL 1.0). */
+    prof = ccl_kernel_get_ws_profile(krnl, dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    wg_size_max = prof->wg_size_max;
+    if (prof->wg_size_mult < prof->wg_size_max)
+        wg_size_mult = prof->wg_size_mult;
+
+    /* Apply user limits and determine total real work size. */
+    for (cl_uint i = 0; i < dims; ++i) {
+        max_wi[i] = (lim[i] != 0)
+            ? MIN(prof->max_wi_sizes[i], lim[i]) : prof->max_wi_sizes[i];
+        real_ws *= real_worksize[i];
+    }
+
+    /* Time heuristic suggestion. */
+    memcpy(best, heur, dims * sizeof(size_t));
+    ccl_kernel_tune_time(krnl, cq, dims, real_worksize, exact, heur, cgws,
+        num_trials, &best_time, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Go through power-of-two candidates, in odometer order. */
+    for (cl_uint i = 0; i < dims; ++i) cand[i] = 1;
+    while (TRUE) {
+
+        /* Check if candidate is within limits, is not too small and was
+         * not already timed. */
+        size_t wg_size = 1;
+        cl_bool valid = CL_TRUE;
+        for (cl_uint i = 0; i < dims; ++i) {
+            wg_size *= cand[i];
+            if (exact && (real_worksize[i] % cand[i] != 0))
+                valid = CL_FALSE;
+        }
+        if ((wg_size > wg_size_max)
+            || ((wg_size < wg_size_mult) && (wg_size < real_ws))
+            || (memcmp(cand, heur, dims * sizeof(size_t)) == 0))
+        {
+            valid = CL_FALSE;
+        }
+
+        /* If so, time it and keep it if it's the fastest so far. */
+        if (valid) {
+            ccl_kernel_tune_time(krnl, cq, dims, real_worksize, exact, cand,
+                cgws, num_trials, &cand_time, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            if (cand_time < best_time) {
+                best_time = cand_time;
+                memcpy(best, cand, dims * sizeof(size_t));
+            }
+        }
+
+        /* Next candidate: no component is larger than the device limit,
+         * nor twice as large as the real work size. */
+        cl_uint d;
+        for (d = 0; d < dims; ++d) {
+            cand[d] *= 2;
+            if ((cand[d] <= max_wi[d])
+                && (cand[d] / 2 < real_worksize[d])) break;
+            cand[d] = 1;
+        }
+        if (d == dims) break;
+    }
+
+    /* Throw error if the device did not accept any candidate. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, best_time == CL_ULONG_MAX,
+        CCL_ERROR_OTHER, error_handler,
+        "%s: no candidate local work size could be executed.", CCL_STRD);
+
+    /* Keep result in tuning cache. */
+    ccl_kernel_tune_cache_store(group, key->str, dims, best);
+
+tuned:
+
+    /* Set output work sizes. */
+    memcpy(lws, best, dims * sizeof(size_t));
+    if (!exact) {
+        for (cl_uint i = 0; i < dims; ++i)
+            gws[i] = ((real_worksize[i] + lws[i] - 1) / lws[i]) * lws[i];
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release temporary storage. */
+    if (ws != NULL) g_slice_free1(6 * dims * sizeof(size_t), ws);
+    if (key != NULL) g_string_free(key, TRUE);
+    g_free(group);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Set the file where the work size tuning cache is kept. Results cached
+ * in memory are discarded, and the new file is loaded on next use.
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @param[in] filename Tuning cache file, or `NULL` to use the default
+ * location, `cf4ocl/worksizes.ini` under the user cache directory.
+ * */
+CCL_EXPORT
+void ccl_kernel_tune_cache_set_file(const char * filename) {
+
+    g_mutex_lock(&tune_lock);
+
+    /* Set new file. */
+    g_free(tune_cache_file);
+    tune_cache_file = g_strdup(filename);
+
+    /* Discard cache loaded from previous file. */
+    if (tune_cache != NULL) {
+        g_key_file_free(tune_cache);
+        tune_cache = NULL;
+    }
+
+    g_mutex_unlock(&tune_lock);
+}
+
+/**
+ * Time a kernel over the given range a number of times, and return
+ * statistics of its execution times, e.g. for microbenchmarks.
+ *
+ * A first, untimed, warm-up execution is performed. Each timed execution
+ * is waited for before the next one is enqueued, and its duration is
+ * determined from its start and end profiling instants with
+ * ::ccl_event_get_timings().
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @param[in] krnl Kernel wrapper object, with all arguments set.
+ * @param[in] cq Command queue wrapper object, created with the
+ * `CL_QUEUE_PROFILING_ENABLE` property.
+ * @param[in] work_dim The number of dimensions used to specify the global
+ * work-items and work-items in the work-group.
+ * @param[in] global_work_offset Offset of the range, or `NULL` for no
+ * offset.
+ * @param[in] global_work_size Global work size of the range.
+ * @param[in] local_work_size Local work size, or `NULL` to let the OpenCL
+ * implementation determine it.
+ * @param[in] num_runs Number of timed executions, or 0 to use
+ * ::CCL_KERNEL_BENCH_RUNS.
+ * @param[out] stats Location where to place the statistics.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_kernel_benchmark(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    cl_uint num_runs, CCLKernelBenchStats * stats, CCLErr ** err) {
+
+    /* Make sure krnl, cq and stats are not NULL. */
+    g_return_val_if_fail(krnl != NULL, CL_FALSE);
+    g_return_val_if_fail(cq != NULL, CL_FALSE);
+    g_return_val_if_fail(stats != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLEventTimings timings;
+    cl_ulong * times;
+    double sum = 0, sum_sq = 0;
+
+    /* Determine number of timed executions. */
+    if (num_runs == 0) num_runs = CCL_KERNEL_BENCH_RUNS;
+    times = g_new(cl_ulong, num_runs);
+
+    /* First execution is a warm-up run, and is not timed. */
+    for (cl_uint r = 0; r <= num_runs; ++r) {
+
+        /* Execute kernel and wait for it to finish. */
+        evt = ccl_kernel_enqueue_ndrange(krnl, cq, work_dim,
+            global_work_offset, global_work_size, local_work_size,
+            NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Skip warm-up run. */
+        if (r == 0) continue;
+
+        /* Keep execution time. */
+        ccl_event_get_timings(evt, &timings, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        times[r - 1] = timings.end > timings.start
+            ? timings.end - timings.start : 0;
+        sum += times[r - 1];
+        sum_sq += (double) times[r - 1] * times[r - 1];
+    }
+
+    /* Determine statistics. */
+    qsort(times, num_runs, sizeof(cl_ulong), ccl_kernel_bench_cmp);
+    stats->num_runs = num_runs;
+    stats->min = times[0];
+    stats->max = times[num_runs - 1];
+    stats->median = (num_runs % 2) ? times[num_runs / 2]
+        : (times[num_runs / 2 - 1] + times[num_runs / 2]) / 2;
+    stats->mean = sum / num_runs;
+    stats->stddev = sqrt(MAX(sum_sq / num_runs - stats->mean * stats->mean,
+        0.0));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    g_free(times);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/** @} */
@@ -0,0 +1,136 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of the empirical work size auto-tuner.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_KERNEL_TUNE_H_
+#define _CCL_KERNEL_TUNE_H_
+
+#include "ccl_common.h"
+#include "ccl_kernel_wrapper.h"
+
+/**
+ * @defgroup CCL_KERNEL_TUNE Work size auto-tuning
+ * @ingroup CCL_KERNEL_WRAPPER
+ *
+ * This module provides an empirical alternative to
+ * ::ccl_kernel_suggest_worksizes(), which times a set of candidate local
+ * work sizes on the actual device and picks the fastest one.
+ *
+ * Candidates are the local work size suggested by
+ * ::ccl_kernel_suggest_worksizes() plus power-of-two local work sizes
+ * within the kernel and device limits. Each candidate is timed using
+ * profiling events, so the command queue must have been created with
+ * the `CL_QUEUE_PROFILING_ENABLE` property. Since the kernel is actually
+ * executed with the arguments currently set, tuning should be performed
+ * with representative (and disposable) data.
+ *
+ * Results are kept in an on-disk tuning cache, keyed by device name,
+ * driver version, kernel name and problem size, so tuning is only
+ * performed once for each combination. By default, the cache is kept in
+ * `cf4ocl/worksizes.ini` under the user cache directory, but a
+ * different file can be specified with ::ccl_kernel_tune_cache_set_file().
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLKernel * krnl;
+ * CCLQueue * cq;
+ * size_t rws[2] = { 1920, 1080 };
+ * size_t gws[2];
+ * size_t lws[2] = { 0, 0 };
+ * @endcode
+ * @code{.c}
+ * cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, NULL);
+ * ccl_kernel_set_args(krnl, buf_in, buf_out, NULL);
+ * ccl_kernel_tune_worksizes(krnl, cq, 2, rws, gws, lws, 0, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_kernel_enqueue_ndrange(krnl, cq, 2, NULL, gws, lws, NULL, NULL);
+ * @endcode
+ *
+ * For microbenchmarks, ::ccl_kernel_benchmark() times a kernel over a
+ * given range a number of times, and returns the minimum, maximum,
+ * median, mean and standard deviation of its execution times.
+ *
+ * @{
+ */
+
+/** Number of timed runs per candidate local work size used when zero
+ * is given to ::ccl_kernel_tune_worksizes(). */
+#define CCL_KERNEL_TUNE_TRIALS 3
+
+/** Number of timed runs used when zero is given to
+ * ::ccl_kernel_benchmark(). */
+#define CCL_KERNEL_BENCH_RUNS 10
+
+/**
+ * Statistics of the execution times of a kernel, in nanoseconds, as
+ * returned by ::ccl_kernel_benchmark().
+ * */
+typedef struct ccl_kernel_bench_stats {
+
+    /** Number of timed executions. */
+    cl_uint num_runs;
+
+    /** Minimum execution time. */
+    cl_ulong min;
+
+    /** Maximum execution time. */
+    cl_ulong max;
+
+    /** Median execution time. */
+    cl_ulong median;
+
+    /** Mean execution time. */
+    double mean;
+
+    /** Standard deviation of execution times. */
+    double stddev;
+
+} CCLKernelBenchStats;
+
+/* Determine the fastest local (and optionally global) work sizes for
+ * the given real work size, by timing candidates on the device. */
+CCL_EXPORT
+cl_bool ccl_kernel_tune_worksizes(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint dims, const size_t * real_worksize, size_t * gws, size_t * lws,
+    cl_uint num_trials, CCLErr ** err);
+
+/* Set the file where the work size tuning cache is kept. */
+CCL_EXPORT
+void ccl_kernel_tune_cache_set_file(const char * filename);
+
+/* Time a kernel a number of times and return statistics of its execution
+ * times. */
+CCL_EXPORT
+cl_bool ccl_kernel_benchmark(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    cl_uint num_runs, CCLKernelBenchStats * stats, CCLErr ** err);
+
+/** @} */
+
+#endif
@@ -27,8 +27,126 @@
 
 #include "ccl_kernel_wrapper.h"
 #include "ccl_program_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_image_wrapper.h"
 #include "_ccl_abstract_wrapper.h"
+#include "_ccl_kernel_wrapper.h"
+#include "_ccl_memobj_wrapper.h"
+#include "_ccl_queue_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_icd.h"
+#include "_ccl_host_trace.h"
+
+/* Number of kernel arguments tracked by each word of the dirty
+ * bitmask. */
+#define CCL_KERNEL_ARGS_PER_WORD (8 * sizeof(gulong))
+
+/**
+ * @internal
+ *
+ * @brief Copy of a kernel argument value. Values of up to
+ * ::CCL_ARG_INLINE_SIZE bytes are stored inline.
+ * */
+struct ccl_kernel_arg_value {
+
+    /**
+     * Size in bytes of value, or 0 if no value is set.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * Is the value `NULL` (e.g. a local argument)?
+     * @private
+     * */
+    cl_bool null_value;
+
+    /**
+     * Is the value a shared virtual memory pointer?
+     * @private
+     * */
+    cl_bool svm;
+
+    /**
+     * Is the value the handle of an OpenCL object (e.g. a memory object
+     * or a sampler) or a shared virtual memory pointer? Handles of
+     * released objects may be reused by new ones, so such values are
+     * always sent to the driver.
+     * @private
+     * */
+    cl_bool handle;
+
+    /**
+     * Heap storage for values larger than ::CCL_ARG_INLINE_SIZE.
+     * @private
+     * */
+    void * heap;
+
+    /**
+     * Size in bytes of `heap`.
+     * @private
+     * */
+    size_t capacity;
+
+    /**
+     * Inline storage for small values.
+     * @private
+     * */
+    unsigned char bytes[CCL_ARG_INLINE_SIZE];
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Get the storage location of a kernel argument value copy.
+ *
+ * @param[in] v A ::ccl_kernel_arg_value object.
+ * @return Storage location of value.
+ * */
+#define ccl_kernel_arg_value_data(v) \
+    ((v)->size > CCL_ARG_INLINE_SIZE ? (v)->heap : (void *) (v)->bytes)
+
+/**
+ * @internal
+ *
+ * @brief Get the location of a kernel argument value copy.
+ *
+ * @param[in] v A ::ccl_kernel_arg_value object.
+ * @return Location of value, or `NULL` if value is `NULL`.
+ * */
+#define ccl_kernel_arg_value_get(v) \
+    ((v)->null_value ? NULL : ccl_kernel_arg_value_data(v))
+
+/**
+ * @internal
+ *
+ * @brief State of a kernel argument position.
+ * */
+struct ccl_kernel_arg_slot {
+
+    /**
+     * Value set by client code but not yet sent to the driver, valid if
+     * the respective dirty bit is set.
+     * @private
+     * */
+    struct ccl_kernel_arg_value pending;
+
+    /**
+     * Value last sent to the driver.
+     * @private
+     * */
+    struct ccl_kernel_arg_value sent;
+
+    /**
+     * Memory object with tracked residency or hazards last set in this
+     * position, or `NULL`. A reference to the memory object wrapper is
+     * kept.
+     * @private
+     * */
+    CCLMemObj * mo;
+
+};
 
 /**
  * Kernel wrapper class.
@@ -44,13 +162,322 @@ struct ccl_kernel {
     CCLWrapper base;
 
     /**
-     * Kernel arguments.
+     * Kernel arguments, indexed by argument position.
+     * @private
+     * */
+    struct ccl_kernel_arg_slot * args;
+
+    /**
+     * Number of argument positions in `args`.
+     * @private
+     * */
+    cl_uint num_args;
+
+    /**
+     * Bitmask of argument positions with pending arguments.
+     * @private
+     * */
+    gulong * dirty;
+
+    /**
+     * Number of times an argument value was sent to the driver.
+     * @private
+     * */
+    cl_ulong args_version;
+
+    /**
+     * Number of argument positions with memory objects whose residency or
+     * hazards are tracked.
+     * @private
+     * */
+    cl_uint num_tracked;
+
+    /**
+     * Work size limits of the kernel, one for each device on which
+     * work sizes were determined.
+     * @private
+     * */
+    CCLKernelWSProfile * ws_profiles;
+
+    /**
+     * Descriptors of kernel arguments, or `NULL` if not yet fetched.
+     * @private
+     * */
+    CCLKernelArgDesc * arg_descs;
+
+    /**
+     * Number of descriptors in `arg_descs`.
+     * @private
+     * */
+    cl_uint num_arg_descs;
+
+    /**
+     * Storage of argument names and type names referenced by `arg_descs`.
+     * @private
+     * */
+    GStringChunk * arg_strs;
+
+    /**
+     * Could descriptors of kernel arguments not be fetched? If so,
+     * arguments are not validated on launch.
      * @private
      * */
-    GHashTable * args;
+    cl_bool arg_descs_unavailable;
 
 };
 
+/**
+ * @internal
+ *
+ * @brief Keep a copy of a kernel argument value, only allocating memory
+ * if the value doesn't fit in the inline storage or in the existing heap
+ * storage.
+ *
+ * @param[in] v A ::ccl_kernel_arg_value object.
+ * @param[in] value Value to copy, may be `NULL`.
+ * @param[in] size Size in bytes of value.
+ * */
+static void ccl_kernel_arg_value_set(
+    struct ccl_kernel_arg_value * v, const void * value, size_t size) {
+
+    v->size = size;
+    v->null_value = (value == NULL);
+
+    if (value == NULL) return;
+
+    if ((size > CCL_ARG_INLINE_SIZE) && (v->capacity < size)) {
+        g_free(v->heap);
+        v->heap = g_malloc(size);
+        v->capacity = size;
+    }
+    memcpy(ccl_kernel_arg_value_data(v), value, size);
+}
+
+/**
+ * @internal
+ *
+ * @brief Send a pending kernel argument to the driver, unless it is a
+ * private or local argument whose value is the same as the one last sent
+ * for that position.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl A ::CCLKernel wrapper object.
+ * @param[in] arg_index Argument index.
+ * @param[out] sent Set to `CL_TRUE` if the argument was sent to the
+ * driver.
+ * @return `CL_SUCCESS` or the error returned by clSetKernelArg().
+ * */
+static cl_int ccl_kernel_flush_arg(
+    CCLKernel * krnl, cl_uint arg_index, cl_bool * sent) {
+
+    struct ccl_kernel_arg_slot * slot = &krnl->args[arg_index];
+    struct ccl_kernel_arg_value swap;
+    void * value = ccl_kernel_arg_value_get(&slot->pending);
+    cl_int ocl_status;
+
+    *sent = CL_FALSE;
+
+    /* Skip driver call if private or local value is unchanged since
+     * last sent. */
+    if (!slot->pending.handle && !slot->sent.handle
+            && (slot->sent.size == slot->pending.size)
+            && (slot->sent.null_value == slot->pending.null_value)
+            && (slot->sent.svm == slot->pending.svm)
+            && ((value == NULL) || (memcmp(ccl_kernel_arg_value_data(
+                &slot->sent), value, slot->pending.size) == 0)))
+        return CL_SUCCESS;
+
+    /* Send argument to driver. */
+    if (slot->pending.svm) {
+#ifdef CL_VERSION_2_0
+        ocl_status = clSetKernelArgSVMPointer(
+            ccl_kernel_unwrap(krnl), arg_index, *((void **) value));
+#else
+        ocl_status = CL_INVALID_OPERATION;
+#endif
+    } else {
+        ocl_status = ccl_icd_clSetKernelArg(
+            ccl_kernel_unwrap(krnl), arg_index, slot->pending.size, value);
+    }
+    if (ocl_status != CL_SUCCESS)
+        return ocl_status;
+
+    /* Remember value sent by swapping copies, so that storage of the
+     * previously sent value is reused for the next pending one. */
+    swap = slot->sent;
+    slot->sent = slot->pending;
+    slot->pending = swap;
+    *sent = CL_TRUE;
+    krnl->args_version++;
+
+    return CL_SUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * @brief Send the kernel arguments set since the last enqueue to the
+ * driver, skipping private and local arguments whose value is unchanged.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl A ::CCLKernel wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if all pending arguments were set, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool ccl_kernel_flush_args(CCLKernel * krnl, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Number of words in dirty bitmask. */
+    cl_uint num_words = (krnl->num_args + CCL_KERNEL_ARGS_PER_WORD - 1)
+        / CCL_KERNEL_ARGS_PER_WORD;
+    /* OpenCL status flag. */
+    cl_int ocl_status;
+    /* Was current argument sent? */
+    cl_bool sent;
+    /* Function return status. */
+    cl_bool ret_status;
+
+#ifdef CCL_CHECK_KERNEL_ARGS
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Validate arguments against their descriptors, fetching these on
+     * first launch. Launches of kernels whose argument info is not
+     * available are not validated. */
+    if (!krnl->arg_descs_unavailable) {
+        if (krnl->arg_descs == NULL) {
+            ccl_kernel_get_arg_descs(krnl, NULL, &err_internal);
+            if (err_internal != NULL) {
+                g_debug("%s: kernel arguments not validated: %s",
+                    CCL_STRD, err_internal->message);
+                g_clear_error(&err_internal);
+                krnl->arg_descs_unavailable = CL_TRUE;
+            }
+        }
+        if (krnl->arg_descs != NULL) {
+            ccl_kernel_check_args(krnl, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        }
+    }
+
+#endif
+
+    /* Set pending kernel arguments. */
+    for (cl_uint w = 0; w < num_words; ++w) {
+        while (krnl->dirty[w] != 0) {
+            cl_uint arg_index = w * CCL_KERNEL_ARGS_PER_WORD
+                + (cl_uint) g_bit_nth_lsf(krnl->dirty[w], -1);
+            ocl_status = ccl_kernel_flush_arg(krnl, arg_index, &sent);
+            ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+                CL_SUCCESS != ocl_status, ocl_status, error_handler,
+                "%s: unable to set kernel arg %d (OpenCL error %d: %s).",
+                CCL_STRD, arg_index, ocl_status, ccl_err(ocl_status));
+            krnl->dirty[w] &= krnl->dirty[w] - 1;
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the version of the kernel arguments known by the driver,
+ * which changes whenever an argument value is sent to the driver.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl A ::CCLKernel wrapper object.
+ * @return Version of the kernel arguments known by the driver.
+ * */
+cl_ulong ccl_kernel_get_args_version(CCLKernel * krnl) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, 0);
+
+    return krnl->args_version;
+}
+
+/**
+ * @internal
+ *
+ * @brief Set the memory object with tracked residency or hazards of a
+ * kernel argument position, keeping a reference to it and releasing the
+ * previous one.
+ *
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] slot Kernel argument position.
+ * @param[in] mo Memory object wrapper, or `NULL`.
+ * */
+static void ccl_kernel_arg_slot_set_mo(CCLKernel * krnl,
+    struct ccl_kernel_arg_slot * slot, CCLMemObj * mo) {
+
+    if (mo != NULL) {
+        ccl_memobj_ref(mo);
+        krnl->num_tracked++;
+    }
+    if (slot->mo != NULL) {
+        if (((CCLWrapper *) slot->mo)->class == CCL_IMAGE)
+            ccl_image_destroy((CCLImage *) slot->mo);
+        else
+            ccl_buffer_destroy((CCLBuffer *) slot->mo);
+        krnl->num_tracked--;
+    }
+    slot->mo = mo;
+}
+
+/**
+ * @internal
+ *
+ * @brief Migrate memory objects with tracked residency set as kernel
+ * arguments to the device of the given queue, if they were last written
+ * on another device.
+ *
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] cq Command queue where the kernel is to be enqueued.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the migration, or `NULL` if no migration was required
+ * or if an error occurs.
+ * */
+static CCLEvent * ccl_kernel_migrate_args(
+    CCLKernel * krnl, CCLQueue * cq, CCLErr ** err) {
+
+    CCLMemObj ** mos = g_new(CCLMemObj *, krnl->num_tracked);
+    CCLEvent * evt;
+    cl_uint num_mos = 0;
+
+    for (cl_uint i = 0; i < krnl->num_args; ++i)
+        if (krnl->args[i].mo != NULL)
+            mos[num_mos++] = krnl->args[i].mo;
+
+    evt = ccl_memobj_residency_migrate(mos, num_mos, cq, err);
+
+    g_free(mos);
+    return evt;
+}
+
 /**
  * @internal
  *
@@ -67,9 +494,54 @@ static void ccl_kernel_release_fields(CCLKernel * krnl) {
     g_return_if_fail(krnl != NULL);
 
     /* Free kernel arguments. */
-    if (krnl->args != NULL)
-        g_hash_table_destroy(krnl->args);
+    for (cl_uint i = 0; i < krnl->num_args; ++i) {
+        g_free(krnl->args[i].pending.heap);
+        g_free(krnl->args[i].sent.heap);
+        ccl_kernel_arg_slot_set_mo(krnl, &krnl->args[i], NULL);
+    }
+    g_free(krnl->args);
+    g_free(krnl->dirty);
+
+    /* Free work size limits. */
+    while (krnl->ws_profiles != NULL) {
+        CCLKernelWSProfile * prof = krnl->ws_profiles;
+        krnl->ws_profiles = prof->next;
+        g_free(prof->max_wi_sizes);
+        g_slice_free(CCLKernelWSProfile, prof);
+    }
+
+    /* Free argument descriptors. */
+    g_free(krnl->arg_descs);
+    if (krnl->arg_strs != NULL)
+        g_string_chunk_free(krnl->arg_strs);
+
+}
 
+/**
+ * @internal
+ *
+ * @brief Set kernel arguments given in a `NULL`-terminated variable
+ * argument list, skipping ::ccl_arg_skip arguments.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl A ::CCLKernel wrapper object.
+ * @param[in] args_va Variable argument list of kernel arguments.
+ * */
+void ccl_kernel_set_args_va(CCLKernel * krnl, va_list args_va) {
+
+    /* Current argument. */
+    void * arg;
+
+    /* Cycle through the arguments. */
+    for (cl_uint i = 0; (arg = va_arg(args_va, void *)) != NULL; ++i) {
+
+        /* Ignore "skip" arguments. */
+        if (arg == ccl_arg_skip) continue;
+
+        /* Set the i^th kernel argument. */
+        ccl_kernel_set_arg(krnl, i, arg);
+    }
 }
 
 /**
@@ -163,6 +635,89 @@ finish:
     return krnl;
 }
 
+/**
+ * Create a new kernel wrapper object which is a copy of the given
+ * kernel, including the argument values known by the OpenCL
+ * implementation. Requires OpenCL >= 2.1.
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @param[in] krnl The kernel wrapper object to copy.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new kernel wrapper object, which should be released with
+ * ccl_kernel_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLKernel * ccl_kernel_clone(CCLKernel * krnl, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+
+    /* Kernel wrapper object. */
+    CCLKernel * krnl_clone = NULL;
+
+#ifndef CL_VERSION_2_1
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.1, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Kernel cloning requires cf4ocl to be deployed with support "
+        "for OpenCL version 2.1 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* OpenCL return status. */
+    cl_int ocl_status;
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* The OpenCL kernel object. */
+    cl_kernel kernel = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that platform is >= OpenCL 2.1. */
+    ocl_ver = ccl_kernel_get_opencl_version(krnl, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If OpenCL version is not >= 2.1, throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 210,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Kernel cloning requires OpenCL version 2.1 or newer.",
+        CCL_STRD);
+
+    /* Clone kernel. */
+    kernel = clCloneKernel(ccl_kernel_unwrap(krnl), &ocl_status);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to clone kernel (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Create kernel wrapper. */
+    krnl_clone = ccl_kernel_new_wrap(kernel);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return kernel wrapper. */
+    return krnl_clone;
+}
+
 /**
  * Decrements the reference count of the kernel wrapper object.
  * If it reaches 0, the kernel wrapper object is destroyed.
@@ -183,8 +738,13 @@ void ccl_kernel_destroy(CCLKernel * krnl) {
  * Set one kernel argument. The argument is not immediately set with the
  * clSetKernelArg() OpenCL function, but is instead kept in an argument
  * table for this kernel. The clSetKernelArg() function is called only
- * before kernel execution for arguments which have not yet been set or
- * have not been updated meanwhile.
+ * before kernel execution for arguments which have been set meanwhile,
+ * and only if their value differs from the one last sent to the
+ * driver.
+ *
+ * @attention Arguments set directly on the wrapped OpenCL kernel with
+ * clSetKernelArg() are not tracked by the wrapper, and may cause an
+ * argument later set with this function to not be sent to the driver.
  *
  * @warning This function is not thread-safe. For multi-threaded
  * access to the same kernel function, create multiple instances of
@@ -196,7 +756,7 @@ void ccl_kernel_destroy(CCLKernel * krnl) {
  * @param[in] krnl A kernel wrapper object.
  * @param[in] arg_index Argument index.
  * @param[in] arg Argument to set. Arguments must be of type ::CCLArg*,
- * ::CCLBuffer*, ::CCLImage* or ::CCLSampler*.
+ * ::CCLBuffer*, ::CCLImage*, ::CCLPipe* or ::CCLSampler*.
  * */
 CCL_EXPORT
 void ccl_kernel_set_arg(CCLKernel * krnl, cl_uint arg_index, void * arg) {
@@ -204,15 +764,52 @@ void ccl_kernel_set_arg(CCLKernel * krnl, cl_uint arg_index, void * arg) {
     /* Make sure krnl is not NULL. */
     g_return_if_fail(krnl != NULL);
 
-    /* Initialize table of kernel arguments if necessary. */
-    if (krnl->args == NULL) {
-        krnl->args = g_hash_table_new_full(g_direct_hash,
-            g_direct_equal, NULL, (GDestroyNotify) ccl_arg_destroy);
+    /* Memory object set as argument, if any. */
+    CCLMemObj * mo;
+
+    /* Grow table of kernel arguments if necessary. */
+    if (arg_index >= krnl->num_args) {
+
+        cl_uint num_args = MAX(2 * krnl->num_args, arg_index + 1);
+        cl_uint old_words = (krnl->num_args + CCL_KERNEL_ARGS_PER_WORD - 1)
+            / CCL_KERNEL_ARGS_PER_WORD;
+        cl_uint num_words = (num_args + CCL_KERNEL_ARGS_PER_WORD - 1)
+            / CCL_KERNEL_ARGS_PER_WORD;
+
+        krnl->args = g_renew(struct ccl_kernel_arg_slot, krnl->args,
+            num_args);
+        memset(krnl->args + krnl->num_args, 0,
+            (num_args - krnl->num_args) * sizeof(struct ccl_kernel_arg_slot));
+        krnl->num_args = num_args;
+
+        if (num_words > old_words) {
+            krnl->dirty = g_renew(gulong, krnl->dirty, num_words);
+            memset(krnl->dirty + old_words, 0,
+                (num_words - old_words) * sizeof(gulong));
+        }
     }
 
-    /* Keep argument in table. */
-    g_hash_table_replace(krnl->args, GUINT_TO_POINTER(arg_index),
-        (gpointer) arg);
+    /* Keep a copy of the argument value in table, replacing the
+     * previously pending one if any. */
+    ccl_kernel_arg_value_set(&krnl->args[arg_index].pending,
+        ccl_arg_value((CCLArg *) arg), ccl_arg_size((CCLArg *) arg));
+    krnl->args[arg_index].pending.svm = ccl_arg_is_svm((CCLArg *) arg);
+    krnl->args[arg_index].pending.handle = krnl->args[arg_index].pending.svm
+        || (((CCLWrapper *) arg)->class != CCL_NONE);
+
+    /* Keep memory objects whose residency or hazards are tracked. */
+    mo = ((((CCLWrapper *) arg)->class == CCL_BUFFER)
+        || (((CCLWrapper *) arg)->class == CCL_IMAGE))
+        ? (CCLMemObj *) arg : NULL;
+    ccl_kernel_arg_slot_set_mo(krnl, &krnl->args[arg_index],
+        (mo != NULL) && (mo->residency || mo->hazards) ? mo : NULL);
+
+    /* Release the argument. */
+    ccl_arg_destroy((CCLArg *) arg);
+
+    /* Mark argument as pending. */
+    krnl->dirty[arg_index / CCL_KERNEL_ARGS_PER_WORD] |=
+        1UL << (arg_index % CCL_KERNEL_ARGS_PER_WORD);
 }
 
 /**
@@ -239,8 +836,8 @@ void ccl_kernel_set_arg(CCLKernel * krnl, cl_uint arg_index, void * arg) {
  *
  * @param[in] krnl A kernel wrapper object.
  * @param[in] ... A `NULL`-terminated list of arguments to set.
- * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage* or
- * ::CCLSampler*.
+ * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage*,
+ * ::CCLPipe* or ::CCLSampler*.
  * */
 CCL_EXPORT
 void ccl_kernel_set_args(CCLKernel * krnl, ...) {
@@ -250,199 +847,523 @@ void ccl_kernel_set_args(CCLKernel * krnl, ...) {
 
     /* The va_list, which represents the variable argument list. */
     va_list args_va;
-    /* Array of arguments, created from the va_list. */
-    void ** args_array = NULL;
-    /* Number of arguments. */
-    guint num_args = 0;
-    /* Aux. arg. when cycling through the va_list. */
-    void * aux_arg;
-
-    /* Initialize the va_list. */
+
+    /* Set arguments directly from the va_list. */
     va_start(args_va, krnl);
+    ccl_kernel_set_args_va(krnl, args_va);
+    va_end(args_va);
 
-    /* Get first argument. */
-    aux_arg = va_arg(args_va, void *);
+}
 
-    /* Check if any arguments are given, and if so, populate array
-     * of arguments. */
-    if (aux_arg != NULL) {
+/**
+ * Set all kernel arguments. This function accepts a `NULL`-terminated
+ * array of kernel arguments. Each argument is individually set using
+ * the ::ccl_kernel_set_arg() function.
+ *
+ * The ::ccl_kernel_set_args() function performs the same operation but
+ * accepts a `NULL`-terminated variable list of arguments instead.
+ *
+ * If the ::ccl_arg_skip constant is passed in place of a specific
+ * argument, that argument will not be set by this function call. Any
+ * previously set argument continues to be valid.
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @warning This function is not thread-safe. For multi-threaded
+ * access to the same kernel function, create multiple instances of
+ * a kernel wrapper for the given kernel function with
+ * ::ccl_kernel_new(), one for each thread.
+ *
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] args A `NULL`-terminated array of arguments to set.
+ * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage*,
+ * ::CCLPipe* or ::CCLSampler*.
+ * */
+CCL_EXPORT
+void ccl_kernel_set_args_v(CCLKernel * krnl, void ** args) {
 
-        /* 1. Determine number of arguments. */
+    /* Make sure krnl is not NULL. */
+    g_return_if_fail(krnl != NULL);
+    /* Make sure args is not NULL. */
+    g_return_if_fail(args != NULL);
 
-        while (aux_arg != NULL) {
-            num_args++;
-            aux_arg = va_arg(args_va, void *);
-        }
-        va_end(args_va);
+    /* Cycle through the arguments. */
+    for (guint i = 0; args[i] != NULL; ++i) {
 
-        /* 2. Populate array of arguments. */
+        /* Get next argument. */
+        CCLArg * arg = args[i];
 
-        args_array = g_slice_alloc((num_args + 1) * sizeof(void *));
-        va_start(args_va, krnl);
+        /* Ignore "skip" arguments. */
+        if (arg == ccl_arg_skip) continue;
 
-        for (guint i = 0; i < num_args; ++i) {
-            aux_arg = va_arg(args_va, void *);
-            args_array[i] = aux_arg;
-        }
-        va_end(args_va);
-        args_array[num_args] = NULL;
+        /* Set the i^th kernel argument. */
+        ccl_kernel_set_arg(krnl, i, arg);
+    }
+}
 
-    } else {
+/**
+ * Enqueues a kernel for execution on a device.
+ *
+ * Internally, this function calls the clSetKernelArg() OpenCL function
+ * for each argument defined with the ::ccl_kernel_set_arg() function
+ * since the last enqueue whose value differs from the one last sent,
+ * and the executes the kernel using the clEnqueueNDRangeKernel() OpenCL
+ * function.
+ *
+ * @warning This function is not thread-safe. For multi-threaded
+ * access to the same kernel function, create multiple instances of
+ * a kernel wrapper for the given kernel function with
+ * ::ccl_kernel_new(), one for each thread.
+ *
+ * @public @memberof ccl_kernel
+ *
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] cq A command queue wrapper object.
+ * @param[in] work_dim The number of dimensions used to specify the
+ * global work-items and work-items in the work-group.
+ * @param[in] global_work_offset Can be used to specify an array of
+ * `work_dim` unsigned values that describe the offset used to calculate
+ * the global ID of a work-item.
+ * @param[in] global_work_size An array of `work_dim` unsigned values
+ * that describe the number of global work-items in `work_dim`
+ * dimensions that will execute the kernel function.
+ * @param[in] local_work_size An array of `work_dim` unsigned values
+ * that describe the number of work-items that make up a work-group that
+ * will execute the specified kernel.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_kernel_enqueue_ndrange(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-        /* Close the variable argument list if no arguments are given. */
-        va_end(args_va);
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    /* OpenCL status flag. */
+    cl_int ocl_status;
+
+    /* OpenCL event. */
+    cl_event event = NULL;
+    /* Event wrapper. */
+    CCLEvent * evt;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Event of migration of memory objects. */
+    CCLEvent * mig_evt;
+    /* Wait list with dependencies due to migrations and memory object
+     * hazards. */
+    CCLEventWaitList dep_ewl = NULL;
+    /* Memory object set as argument. */
+    CCLMemObj * mo;
+
+    /* Migrate arguments last written on another device to the queue
+     * device. The kernel waits for the migration. */
+    if (krnl->num_tracked > 0) {
+        mig_evt = ccl_kernel_migrate_args(krnl, cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (mig_evt != NULL)
+            evt_wait_lst = ccl_ewl(
+                evt_wait_lst != NULL ? evt_wait_lst : &dep_ewl,
+                mig_evt, NULL);
     }
 
-    /* If any arguments are given... */
-    if (num_args > 0) {
+    /* Wait for conflicting commands on memory object arguments. Kernels
+     * are considered to write memory objects which are not read-only. */
+    for (cl_uint i = 0; (krnl->num_tracked > 0) && (i < krnl->num_args); ++i) {
+        mo = krnl->args[i].mo;
+        if (mo != NULL)
+            evt_wait_lst = ccl_memobj_hazard_deps(mo, cq,
+                !mo->hazard_read_only, evt_wait_lst, &dep_ewl);
+    }
 
-        /* Call the array version of this function.*/
-        ccl_kernel_set_args_v(krnl, args_array);
+    /* Set pending kernel arguments. */
+    ccl_kernel_flush_args(krnl, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-        /* Free the array of arguments. */
-        g_slice_free1((num_args + 1) * sizeof(void *), args_array);
+    /* Run kernel. */
+    ocl_status = ccl_icd_clEnqueueNDRangeKernel(ccl_queue_unwrap(cq),
+        ccl_kernel_unwrap(krnl), work_dim, global_work_offset,
+        global_work_size, local_work_size,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue kernel (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
 
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Tracked arguments are now resident in the queue device, and were
+     * accessed by the kernel. */
+    for (cl_uint i = 0; (krnl->num_tracked > 0) && (i < krnl->num_args); ++i) {
+        mo = krnl->args[i].mo;
+        if (mo != NULL) {
+            ccl_memobj_residency_update(mo, cq, evt);
+            ccl_memobj_hazard_record(mo, cq, !mo->hazard_read_only, evt);
+        }
     }
 
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return evt. */
+    return evt;
 }
 
 /**
- * Set all kernel arguments. This function accepts a `NULL`-terminated
- * array of kernel arguments. Each argument is individually set using
- * the ::ccl_kernel_set_arg() function.
+ * Enqueues a kernel for execution on a device, splitting the global work
+ * size in tiles which are enqueued back to back as separate
+ * clEnqueueNDRangeKernel() commands, using the global work offset to
+ * select each tile.
  *
- * The ::ccl_kernel_set_args() function performs the same operation but
- * accepts a `NULL`-terminated variable list of arguments instead.
- *
- * If the ::ccl_arg_skip constant is passed in place of a specific
- * argument, that argument will not be set by this function call. Any
- * previously set argument continues to be valid.
- *
- * @public @memberof ccl_kernel
+ * This is useful for problems too large for a single launch, e.g. due to
+ * display driver watchdog timeouts or 32-bit index limits in kernels. Tiles
+ * are enqueued in order of increasing offset, with the first dimension
+ * varying fastest. The last tile in each dimension may be smaller than the
+ * tile size. Kernels should therefore not assume that the global work size
+ * is the one of the whole problem.
  *
  * @warning This function is not thread-safe. For multi-threaded
  * access to the same kernel function, create multiple instances of
  * a kernel wrapper for the given kernel function with
  * ::ccl_kernel_new(), one for each thread.
  *
+ * @public @memberof ccl_kernel
+ *
  * @param[in] krnl A kernel wrapper object.
- * @param[in] args A `NULL`-terminated array of arguments to set.
- * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage* or
- * ::CCLSampler*.
+ * @param[in] cq A command queue wrapper object.
+ * @param[in] work_dim The number of dimensions used to specify the
+ * global work-items and work-items in the work-group.
+ * @param[in] global_work_offset Can be used to specify an array of
+ * `work_dim` unsigned values that describe the offset of the whole
+ * problem.
+ * @param[in] global_work_size An array of `work_dim` unsigned values
+ * that describe the number of global work-items of the whole problem.
+ * @param[in] local_work_size An array of `work_dim` unsigned values
+ * that describe the number of work-items that make up a work-group that
+ * will execute the specified kernel.
+ * @param[in] tile_size An array of `work_dim` unsigned values that
+ * describe the maximum global work size of each tile. If
+ * `local_work_size` is given, each value must be a multiple of the
+ * respective local work size.
+ * @param[in] flush_interval Number of tiles after which the command queue
+ * is flushed, so that the device starts executing them while remaining
+ * tiles are enqueued, or zero for no flushes.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the tiles can be executed. The list will be cleared and can be
+ * reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object which completes when all tiles have
+ * completed. If there is more than one tile, this is the event of a
+ * marker command enqueued after the tiles.
  * */
 CCL_EXPORT
-void ccl_kernel_set_args_v(CCLKernel * krnl, void ** args) {
+CCLEvent * ccl_kernel_enqueue_ndrange_tiled(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    const size_t * tile_size, cl_uint flush_interval,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Event wrapper. */
+    CCLEvent * evt = NULL;
+    /* Storage for tile position, offset and size, work_dim values each. */
+    size_t * ws = NULL;
+    size_t * pos, * tile_offset, * tile_gws;
+    /* Number of tiles. */
+    cl_ulong num_tiles = 1;
+    /* Queue properties. */
+    cl_command_queue_properties qprop;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (work_dim == 0) || (global_work_size == NULL) || (tile_size == NULL),
+        CCL_ERROR_ARGS, error_handler, "%s: work dimensions, global work "
+        "size and tile size must be specified.", CCL_STRD);
+    for (cl_uint i = 0; i < work_dim; ++i) {
+        ccl_if_err_create_goto(*err, CCL_ERROR, (tile_size[i] == 0)
+            || ((local_work_size != NULL)
+                && (tile_size[i] % local_work_size[i] != 0)),
+            CCL_ERROR_ARGS, error_handler, "%s: tile sizes must be non-zero "
+            "multiples of the local work size.", CCL_STRD);
+        num_tiles *= (global_work_size[i] + tile_size[i] - 1) / tile_size[i];
+    }
+
+    /* If there's only one tile, enqueue kernel directly. */
+    if (num_tiles <= 1) {
+        evt = ccl_kernel_enqueue_ndrange(krnl, cq, work_dim,
+            global_work_offset, global_work_size, local_work_size,
+            evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        goto finish;
+    }
+
+    /* On in-order queues, it's enough that the first tile waits on the
+     * given events. On out-of-order queues, use a barrier so that all
+     * tiles wait on them. */
+    if (ccl_event_wait_list_get_num_events(evt_wait_lst) > 0) {
+        qprop = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+            cl_command_queue_properties, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (qprop & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+            ccl_enqueue_barrier(cq, evt_wait_lst, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        }
+    }
 
-    /* Make sure krnl is not NULL. */
-    g_return_if_fail(krnl != NULL);
-    /* Make sure args is not NULL. */
-    g_return_if_fail(args != NULL);
+    /* Setup tile storage. */
+    ws = g_slice_alloc0(3 * work_dim * sizeof(size_t));
+    pos = ws;
+    tile_offset = ws + work_dim;
+    tile_gws = ws + 2 * work_dim;
 
-    /* Cycle through the arguments. */
-    for (guint i = 0; args[i] != NULL; ++i) {
+    /* Enqueue tiles. */
+    for (cl_ulong t = 0; t < num_tiles; ++t) {
 
-        /* Get next argument. */
-        CCLArg * arg = args[i];
+        /* Determine tile offset and size. */
+        for (cl_uint i = 0; i < work_dim; ++i) {
+            tile_offset[i] = pos[i]
+                + (global_work_offset != NULL ? global_work_offset[i] : 0);
+            tile_gws[i] = MIN(tile_size[i], global_work_size[i] - pos[i]);
+        }
 
-        /* Ignore "skip" arguments. */
-        if (arg == ccl_arg_skip) continue;
+        /* Enqueue tile. Event wait list is cleared after first tile. */
+        ccl_kernel_enqueue_ndrange(krnl, cq, work_dim, tile_offset,
+            tile_gws, local_work_size, evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-        /* Set the i^th kernel argument. */
-        ccl_kernel_set_arg(krnl, i, arg);
+        /* Flush queue if requested. */
+        if ((flush_interval > 0) && ((t + 1) % flush_interval == 0)
+            && (t + 1 < num_tiles))
+        {
+            ccl_queue_flush(cq, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        }
+
+        /* Next tile position. */
+        for (cl_uint i = 0; i < work_dim; ++i) {
+            pos[i] += tile_size[i];
+            if (pos[i] < global_work_size[i]) break;
+            pos[i] = 0;
+        }
     }
+
+    /* Aggregate tiles with a marker, which completes when all previously
+     * enqueued commands have completed. */
+    evt = ccl_enqueue_marker(cq, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release tile storage. */
+    if (ws != NULL) g_slice_free1(3 * work_dim * sizeof(size_t), ws);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return evt. */
+    return evt;
 }
 
 /**
- * Enqueues a kernel for execution on a device.
+ * Enqueues a one-dimensional kernel on a buffer in chunks, pipelining the
+ * upload of each chunk, its processing by the kernel and its download,
+ * so that transfers overlap with computation.
  *
- * Internally, this function calls the clSetKernelArg() OpenCL function
- * for each argument defined with the ::ccl_kernel_set_arg() function,
- * and the executes the kernel using the clEnqueueNDRangeKernel() OpenCL
- * function.
+ * The buffer is processed in place: for each chunk, the respective part
+ * of host memory is written to the buffer, the kernel is enqueued with a
+ * global work offset and size selecting the chunk, and the result is read
+ * back to the same part of host memory. Work-item _i_ is expected to
+ * process element _i_ of the buffer, which must be set as a kernel
+ * argument by client code.
+ *
+ * Uploads, kernels and downloads are enqueued on the first, second and
+ * third queue, respectively, wrapping around if fewer queues are given.
+ * With three queues, the upload of chunk _k+1_ can overlap with the
+ * kernel of chunk _k_ and the download of chunk _k-1_. Stages are chained
+ * with events, and queues are flushed after each chunk so that devices
+ * start processing early chunks while later ones are enqueued.
  *
  * @warning This function is not thread-safe. For multi-threaded
  * access to the same kernel function, create multiple instances of
  * a kernel wrapper for the given kernel function with
  * ::ccl_kernel_new(), one for each thread.
  *
+ * @attention Queues should be in-order and share the context of the
+ * buffer. Host memory must not be accessed until the returned event has
+ * completed.
+ *
  * @public @memberof ccl_kernel
  *
  * @param[in] krnl A kernel wrapper object.
- * @param[in] cq A command queue wrapper object.
- * @param[in] work_dim The number of dimensions used to specify the
- * global work-items and work-items in the work-group.
- * @param[in] global_work_offset Can be used to specify an array of
- * `work_dim` unsigned values that describe the offset used to calculate
- * the global ID of a work-item.
- * @param[in] global_work_size An array of `work_dim` unsigned values
- * that describe the number of global work-items in `work_dim`
- * dimensions that will execute the kernel function.
- * @param[in] local_work_size An array of `work_dim` unsigned values
- * that describe the number of work-items that make up a work-group that
- * will execute the specified kernel.
+ * @param[in] cqs Array of one to three command queue wrapper objects.
+ * @param[in] num_queues Number of command queues in `cqs`.
+ * @param[in] buf Buffer wrapper object to process.
+ * @param[in,out] host_ptr Host memory from where data is written to the
+ * buffer and to where results are read back.
+ * @param[in] elem_size Size in bytes of each buffer element.
+ * @param[in] num_elems Number of elements to process, which is also the
+ * global work size of the whole problem.
+ * @param[in] chunk_size Number of elements of each chunk. If
+ * `local_work_size` is given, it must be a multiple of the local work
+ * size.
+ * @param[in] local_work_size Number of work-items that make up a
+ * work-group, or `NULL` to let the OpenCL implementation decide.
  * @param[in,out] evt_wait_lst List of events that need to complete
- * before this command can be executed. The list will be cleared and
- * can be reused by client code.
+ * before the first chunk is uploaded. The list will be cleared and can be
+ * reused by client code.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return Event wrapper object that identifies this command.
+ * @return Event wrapper object of the download of the last chunk, which
+ * completes when all chunks have been processed and read back, or `NULL`
+ * if an error occurs.
  * */
 CCL_EXPORT
-CCLEvent * ccl_kernel_enqueue_ndrange(CCLKernel * krnl, CCLQueue * cq,
-    cl_uint work_dim, const size_t * global_work_offset,
-    const size_t * global_work_size, const size_t * local_work_size,
-    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+CCLEvent * ccl_kernel_enqueue_ndrange_pipelined(CCLKernel * krnl,
+    CCLQueue ** cqs, cl_uint num_queues, CCLBuffer * buf, void * host_ptr,
+    size_t elem_size, size_t num_elems, size_t chunk_size,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
 
     /* Make sure krnl is not NULL. */
     g_return_val_if_fail(krnl != NULL, NULL);
-    /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-    /* OpenCL status flag. */
-    cl_int ocl_status;
-
-    /* OpenCL event. */
-    cl_event event;
-    /* Event wrapper. */
-    CCLEvent * evt;
+    /* Event wrappers of the last upload, of the upload of the current
+     * chunk, and of the last kernel or download. */
+    CCLEvent * evt_write = NULL, * evt_chunk, * evt = NULL;
+    /* Event wait list chaining stages. */
+    CCLEventWaitList ewl = NULL;
+    /* Queues for uploads, kernels and downloads. */
+    CCLQueue * cq_write, * cq_krnl, * cq_read;
+    /* Number of chunks, and offset and size of current chunk. */
+    size_t num_chunks, offset, count;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
 
-    /* Iterator for table of kernel arguments. */
-    GHashTableIter iter;
-    gpointer arg_index_ptr, arg_ptr;
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (cqs == NULL) || (num_queues == 0) || (num_queues > 3)
+        || (host_ptr == NULL) || (elem_size == 0) || (num_elems == 0)
+        || (chunk_size == 0), CCL_ERROR_ARGS, error_handler,
+        "%s: one to three queues, host memory, element size, number of "
+        "elements and chunk size must be specified.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR, (local_work_size != NULL)
+        && (chunk_size % *local_work_size != 0),
+        CCL_ERROR_ARGS, error_handler, "%s: chunk size must be a "
+        "multiple of the local work size.", CCL_STRD);
+
+    /* Assign queues to stages. */
+    cq_write = cqs[0];
+    cq_krnl = cqs[1 % num_queues];
+    cq_read = cqs[2 % num_queues];
+    num_chunks = (num_elems + chunk_size - 1) / chunk_size;
+
+    /* Upload first chunk, after the given events. */
+    evt_write = ccl_buffer_enqueue_write(buf, cq_write, CL_FALSE, 0,
+        MIN(chunk_size, num_elems) * elem_size, host_ptr, evt_wait_lst,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Set pending kernel arguments. */
-    if (krnl->args != NULL) {
-        g_hash_table_iter_init(&iter, krnl->args);
-        while (g_hash_table_iter_next(&iter, &arg_index_ptr, &arg_ptr)) {
-            cl_uint arg_index = GPOINTER_TO_UINT(arg_index_ptr);
-            CCLArg * arg = (CCLArg *) arg_ptr;
-            ocl_status = clSetKernelArg(ccl_kernel_unwrap(krnl), arg_index,
-                ccl_arg_size(arg), ccl_arg_value(arg));
-            ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-                CL_SUCCESS != ocl_status, ocl_status, error_handler,
-                "%s: unable to set kernel arg %d (OpenCL error %d: %s).",
-                CCL_STRD, arg_index, ocl_status, ccl_err(ocl_status));
-            g_hash_table_iter_remove(&iter);
+    /* Process chunks. */
+    for (size_t k = 0; k < num_chunks; ++k) {
+
+        /* Determine chunk offset and size. */
+        offset = k * chunk_size;
+        count = MIN(chunk_size, num_elems - offset);
+        evt_chunk = evt_write;
+
+        /* Upload next chunk before enqueuing the download of this one,
+         * so that it is not held behind it when queues are shared. */
+        if (k + 1 < num_chunks) {
+            evt_write = ccl_buffer_enqueue_write(buf, cq_write, CL_FALSE,
+                (offset + chunk_size) * elem_size,
+                MIN(chunk_size, num_elems - offset - chunk_size) * elem_size,
+                (char *) host_ptr + (offset + chunk_size) * elem_size, NULL,
+                &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
         }
-    }
 
-    /* Run kernel. */
-    ocl_status = clEnqueueNDRangeKernel(ccl_queue_unwrap(cq),
-        ccl_kernel_unwrap(krnl), work_dim, global_work_offset,
-        global_work_size, local_work_size,
-        ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
-    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
-        CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: unable to enqueue kernel (OpenCL error %d: %s).",
-        CCL_STRD, ocl_status, ccl_err(ocl_status));
+        /* Process chunk once it is uploaded. */
+        evt = ccl_kernel_enqueue_ndrange(krnl, cq_krnl, 1, &offset, &count,
+            local_work_size, ccl_ewl(&ewl, evt_chunk, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Wrap event and associate it with the respective command queue.
-     * The event object will be released automatically when the command
-     * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+        /* Download chunk once it is processed. */
+        evt = ccl_buffer_enqueue_read(buf, cq_read, CL_FALSE,
+            offset * elem_size, count * elem_size,
+            (char *) host_ptr + offset * elem_size,
+            ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Flush queues, so that devices start on enqueued commands and
+         * events waited on by other queues are guaranteed to complete. */
+        for (cl_uint i = 0; i < num_queues; ++i) {
+            ccl_queue_flush(cqs[i], &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        }
+    }
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -458,7 +1379,8 @@ error_handler:
 
 finish:
 
-    /* Clear event wait list. */
+    /* Clear event wait lists. */
+    ccl_event_wait_list_clear(&ewl);
     ccl_event_wait_list_clear(evt_wait_lst);
 
     /* Return evt. */
@@ -527,61 +1449,16 @@ CCLEvent * ccl_kernel_set_args_and_enqueue_ndrange(
     CCLEvent * evt;
     /* The va_list, which represents the variable argument list. */
     va_list args_va;
-    /* Array of arguments, to be created from the va_list. */
-    void ** args_array = NULL;
-    /* Number of arguments. */
-    guint num_args = 0;
-    /* Aux. arg. when cycling through the va_list. */
-    void * aux_arg;
-
-    /* Initialize the va_list. */
-    va_start(args_va, err);
-
-    /* Get first argument. */
-    aux_arg = va_arg(args_va, void *);
-
-    /* Check if any arguments are given, and if so, populate array
-     * of arguments. */
-    if (aux_arg != NULL) {
-
-        /* 1. Determine number of arguments. */
-
-        while (aux_arg != NULL) {
-            num_args++;
-            aux_arg = va_arg(args_va, void *);
-        }
-        va_end(args_va);
-
-        /* 2. Populate array of arguments. */
-
-        args_array = g_slice_alloc((num_args + 1) * sizeof(void *));
-        va_start(args_va, err);
-
-        for (guint i = 0; i < num_args; ++i) {
-            aux_arg = va_arg(args_va, void *);
-            args_array[i] = aux_arg;
-        }
-        va_end(args_va);
-        args_array[num_args] = NULL;
 
-    } else {
-
-        /* Close the variable argument list if no arguments are given. */
-        va_end(args_va);
-    }
+    /* Set kernel arguments directly from the va_list. */
+    va_start(args_va, err);
+    ccl_kernel_set_args_va(krnl, args_va);
+    va_end(args_va);
 
-    /* Set kernel arguments and run it. */
+    /* Run kernel. */
     evt = ccl_kernel_set_args_and_enqueue_ndrange_v(krnl, cq, work_dim,
         global_work_offset, global_work_size, local_work_size,
-        evt_wait_lst, args_array, err);
-
-    /* If any arguments are given... */
-    if (num_args > 0) {
-
-        /* Free the array of arguments. */
-        g_slice_free1((num_args + 1) * sizeof(void *), args_array);
-
-    }
+        evt_wait_lst, NULL, err);
 
     /* Return event wrapper. */
     return evt;
@@ -626,8 +1503,8 @@ CCLEvent * ccl_kernel_set_args_and_enqueue_ndrange(
  * before this command can be executed. The list will be cleared and
  * can be reused by client code.
  * @param[in] args A `NULL`-terminated list of arguments to set.
- * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage* or
- * ::CCLSampler*.
+ * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage*,
+ * ::CCLPipe* or ::CCLSampler*.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
  * @return Event wrapper object that identifies this command.
@@ -719,6 +1596,9 @@ CCLEvent * ccl_kernel_enqueue_native(CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL status flag. */
     cl_int ocl_status;
     /* OpenCL event. */
@@ -742,7 +1622,8 @@ CCLEvent * ccl_kernel_enqueue_native(CCLQueue * cq,
     ocl_status = clEnqueueNativeKernel(ccl_queue_unwrap(cq), user_func,
         args, cb_args, num_mos, (const cl_mem *) mem_list, args_mem_loc,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to enqueue native kernel (OpenCL error %d: %s).",
@@ -751,7 +1632,7 @@ CCLEvent * ccl_kernel_enqueue_native(CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -771,6 +1652,9 @@ finish:
     if (num_mos > 0)
         g_slice_free1(sizeof(cl_mem) * num_mos, mem_list);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event wrapper. */
     return evt;
 }
@@ -815,51 +1699,317 @@ cl_uint ccl_kernel_get_opencl_version(CCLKernel * krnl, CCLErr ** err) {
     /* Get context wrapper. */
     ctx = ccl_context_new_wrap(context);
 
-    /* Get OpenCL version. */
-    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    /* Get OpenCL version. */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Unref. the context wrapper. */
+    ccl_context_unref(ctx);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ocl_ver = 0;
+
+finish:
+
+    /* Return event wrapper. */
+    return ocl_ver;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get a `size_t` kernel workgroup information value which may be
+ * unavailable in some platforms.
+ *
+ * Unavailable information is expected, so it is reported by leaving the
+ * value at zero, without creating (and then discarding) an error object.
+ * Only actual query failures produce an error.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl Kernel wrapper object.
+ * @param[in] dev Device wrapper object.
+ * @param[in] param_name Name of workgroup information to get.
+ * @param[out] value Location where to place the value, which is set to
+ * zero if the information is unavailable.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the value was obtained or is unavailable,
+ * `CL_FALSE` if an error occurred.
+ * */
+static cl_bool ccl_kernel_get_workgroup_info_size_opt(CCLKernel * krnl,
+    CCLDevice * dev, cl_kernel_work_group_info param_name, size_t * value,
+    CCLErr ** err) {
+
+    /* Query status. */
+    cl_int status;
+    /* Pointer to information value. */
+    size_t * info;
+
+    info = ccl_wrapper_get_info_scalar_status((CCLWrapper *) krnl,
+        (CCLWrapper *) dev, param_name, sizeof(size_t),
+        CCL_INFO_KERNEL_WORKGROUP, CL_FALSE, &status);
+    *value = (info != NULL) ? *info : 0;
+
+    /* Only format an error message for actual failures. */
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        (status != CL_SUCCESS) && (status != CCL_WRAPPER_INFO_UNAVAILABLE),
+        status, error_handler,
+        "%s: unable to get kernel workgroup info (OpenCL error %d: %s).",
+        CCL_STRD, status, ccl_err(status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/* Number of work dimensions for which ccl_kernel_suggest_worksizes()
+ * does not allocate temporary memory. */
+#define CCL_KERNEL_WS_DIMS 3
+
+/**
+ * @internal
+ *
+ * @brief Determine the subgroup (SIMD) size of a kernel on a device.
+ *
+ * The subgroup size required at compile time with the
+ * `intel_reqd_sub_group_size` attribute is used if the device supports the
+ * `cl_intel_required_subgroup_size` extension. Otherwise, the maximum
+ * subgroup size for a one-dimensional work-group of the largest size
+ * allowed for the kernel is used. Both queries require OpenCL >= 2.1, and
+ * the subgroup size is unknown on older platforms or if the queries fail.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl Kernel wrapper object.
+ * @param[in] dev Device wrapper object.
+ * @param[in] ocl_ver OpenCL version of the kernel platform.
+ * @param[in] wg_size_max Maximum work group size for the kernel.
+ * @return The subgroup size, or zero if unknown.
+ * */
+static size_t ccl_kernel_ws_subgroup_size(CCLKernel * krnl,
+    CCLDevice * dev, cl_uint ocl_ver, size_t wg_size_max) {
+
+    /* Subgroup size. */
+    size_t sg_size = 0;
+
+#ifndef CL_VERSION_2_1
+
+    CCL_UNUSED(krnl);
+    CCL_UNUSED(dev);
+    CCL_UNUSED(ocl_ver);
+    CCL_UNUSED(wg_size_max);
+
+#else
+
+    /* Device capabilities. */
+    const CCLDeviceCaps * caps;
+    /* Query status. */
+    cl_int status;
+
+    if ((ocl_ver < 210) || (wg_size_max == 0)) return 0;
+
+    caps = ccl_device_get_caps(dev, NULL);
+    if (caps == NULL) return 0;
+
+    /* Use the size required by the kernel, if any... */
+    if (caps->extensions & CCL_DEVICE_EXT_INTEL_REQUIRED_SUBGROUP_SIZE) {
+        status = clGetKernelSubGroupInfo(ccl_kernel_unwrap(krnl),
+            ccl_device_unwrap(dev), CL_KERNEL_COMPILE_SUB_GROUP_SIZE_INTEL,
+            0, NULL, sizeof(size_t), &sg_size, NULL);
+        if (status != CL_SUCCESS) sg_size = 0;
+    }
+
+    /* ...otherwise use the size chosen by the compiler. */
+    if (sg_size == 0) {
+        status = clGetKernelSubGroupInfo(ccl_kernel_unwrap(krnl),
+            ccl_device_unwrap(dev), CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE,
+            sizeof(size_t), &wg_size_max, sizeof(size_t), &sg_size, NULL);
+        if (status != CL_SUCCESS) sg_size = 0;
+    }
+
+#endif
+
+    return sg_size;
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine the work size limits of a kernel on a device.
+ *
+ * @private @memberof ccl_kernel
+ *
+ * @param[in] krnl Kernel wrapper object. If `NULL`, use only device
+ * information.
+ * @param[in] dev Device wrapper object.
+ * @param[out] prof Location where to place the work size limits. The
+ * maximum work item sizes point to the device information, and are
+ * valid while the device wrapper is.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_kernel_ws_profile_load(CCLKernel * krnl,
+    CCLDevice * dev, CCLKernelWSProfile * prof, CCLErr ** err) {
+
+    /* Function return status. */
+    cl_bool ret_status;
+    /* Error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Initialize profile. */
+    prof->device = ccl_device_unwrap(dev);
+    prof->wg_size_max = 0;
+    prof->wg_size_mult = 0;
+    prof->sg_size = 0;
+    prof->next = NULL;
+
+    /* Get maximum dimensions and work item sizes for device. */
+    prof->dev_dims = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, cl_uint, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    prof->max_wi_sizes = ccl_device_get_info_array(
+        dev, CL_DEVICE_MAX_WORK_ITEM_SIZES, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If kernel is not NULL, query it about workgroup size preferences
+     * and capabilities. */
+    if (krnl != NULL) {
+
+        /* Determine maximum workgroup size. */
+        ccl_kernel_get_workgroup_info_size_opt(krnl, dev,
+            CL_KERNEL_WORK_GROUP_SIZE, &prof->wg_size_max, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_1_1
+
+        /* Determine preferred workgroup size multiple (OpenCL >= 1.1). */
+
+        /* Get OpenCL version of the underlying platform. */
+        cl_uint ocl_ver = ccl_kernel_get_opencl_version(krnl, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* If OpenCL version of the underlying platform is >= 1.1 ... */
+        if (ocl_ver >= 110) {
+
+            /* ...use CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE... */
+            ccl_kernel_get_workgroup_info_size_opt(krnl, dev,
+                CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+                &prof->wg_size_mult, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+            /* Determine subgroup size (OpenCL >= 2.1). */
+            prof->sg_size = ccl_kernel_ws_subgroup_size(
+                krnl, dev, ocl_ver, prof->wg_size_max);
+
+        } else {
+
+            /* ...otherwise just use CL_KERNEL_WORK_GROUP_SIZE. */
+            prof->wg_size_mult = prof->wg_size_max;
+
+        }
+
+#else
+
+        prof->wg_size_mult = prof->wg_size_max;
+
+#endif
+
+    }
 
-    /* Unref. the context wrapper. */
-    ccl_context_unref(ctx);
+    /* If it was not possible to obtain wg_size_mult and wg_size_max, either
+     * because kernel is NULL or the information was unavailable, use values
+     * obtained from device. */
+    if ((prof->wg_size_max == 0) && (prof->wg_size_mult == 0)) {
+        prof->wg_size_max = ccl_device_get_info_scalar(
+            dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, size_t, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        prof->wg_size_mult = prof->wg_size_max;
+    }
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
     goto finish;
 
 error_handler:
 
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
-    ocl_ver = 0;
+    ret_status = CL_FALSE;
 
 finish:
 
-    /* Return event wrapper. */
-    return ocl_ver;
+    /* Return status. */
+    return ret_status;
 }
 
 /**
  * @internal
  *
- * @brief Helper macro which tests if the error is a
- * `CCL_ERROR_INFO_UNAVAILABLE_OCL` error, and if so, generates a warning and
- * clears the error. Otherwise it tests the error in the same way as
- * ccl_if_err_propagate_goto().
+ * @brief Get the work size limits of a kernel on a device. Limits are
+ * determined on first use and kept by the kernel wrapper, so subsequent
+ * calls for the same device don't query the OpenCL implementation.
+ *
+ * @private @memberof ccl_kernel
  *
- * @param[out] err Destination CCLErr** object.
- * @param[in] err_internal Source CCLErr* object.
- * @param[in] error_handler Label to goto if an error other than
- * `CCL_ERROR_INFO_UNAVAILABLE_OCL` is detected.
+ * @param[in] krnl Kernel wrapper object.
+ * @param[in] dev Device wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The work size limits of the kernel on the device, which are
+ * valid while the kernel wrapper is, or `NULL` if an error occurs.
  * */
-#define ccl_if_err_not_info_unavailable_propagate_goto( \
-            err, err_internal, error_handler) \
-    if (((err_internal) != NULL) && ((err_internal)->domain == CCL_ERROR) && \
-            ((err_internal)->code == CCL_ERROR_INFO_UNAVAILABLE_OCL)) { \
-        g_warning("In %s: %s", CCL_STRD, (err_internal)->message); \
-        ccl_err_clear(&(err_internal)); \
-    } else { \
-        ccl_if_err_propagate_goto(err, err_internal, error_handler); \
-    }
+const CCLKernelWSProfile * ccl_kernel_get_ws_profile(
+    CCLKernel * krnl, CCLDevice * dev, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure dev is not NULL. */
+    g_return_val_if_fail(dev != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Work size limits. */
+    CCLKernelWSProfile * prof;
+    CCLKernelWSProfile prof_new;
+    /* Device whose limits are requested. */
+    cl_device_id device = ccl_device_unwrap(dev);
+
+    /* Are limits for this device already known? */
+    for (prof = krnl->ws_profiles; prof != NULL; prof = prof->next)
+        if (prof->device == device) return prof;
+
+    /* No, determine them. */
+    if (!ccl_kernel_ws_profile_load(krnl, dev, &prof_new, err))
+        return NULL;
+
+    /* Keep them in the kernel, with a copy of the device maximum work
+     * item sizes, which may not outlive the device wrapper. */
+    prof = g_slice_dup(CCLKernelWSProfile, &prof_new);
+    prof->max_wi_sizes = g_new(size_t, prof->dev_dims);
+    memcpy(prof->max_wi_sizes, prof_new.max_wi_sizes,
+        prof->dev_dims * sizeof(size_t));
+    prof->next = krnl->ws_profiles;
+    krnl->ws_profiles = prof;
+
+    return prof;
+}
 
 /**
  * Suggest appropriate local (and optionally global) work sizes for the
@@ -871,6 +2021,14 @@ finish:
  * such, kernels enqueued with global work sizes suggested by this
  * function should check if their global ID is within `real_worksize`.
  *
+ * If the subgroup (SIMD) size of the kernel on the device is known (see
+ * ::ccl_kernel_get_subgroup_size()), suggested local work sizes are
+ * preferably multiples of it, so that work-groups are made of full
+ * subgroups. In particular, when `gws` is not `NULL`, small local work
+ * sizes are grown to a multiple of the subgroup size within the kernel
+ * and device limits, since partial subgroups occupy the whole SIMD width
+ * anyway.
+ *
  * @public @memberof ccl_kernel
  *
  * @param[in] krnl Kernel wrapper object. If `NULL`, use only device
@@ -913,92 +2071,60 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
 
-    /* The preferred workgroup size. */
-    size_t wg_size_mult = 0;
-    size_t wg_size_max = 0;
+    /* Work size limits of kernel and device. */
+    const CCLKernelWSProfile * prof;
+    CCLKernelWSProfile prof_dev;
+    size_t wg_size_mult, wg_size_max, sg_size;
     size_t wg_size = 1, wg_size_aux;
-    size_t * max_wi_sizes;
-    cl_uint dev_dims;
+    /* Effective maximum work item sizes, considering user limits. */
+    size_t max_wi_sizes_aux[CCL_KERNEL_WS_DIMS];
+    size_t * max_wi_sizes = NULL;
     cl_bool ret_status;
     size_t real_ws = 1;
 
     /* Error handling object. */
     CCLErr * err_internal = NULL;
 
-    /* Check if device supports the requested dims. */
-    dev_dims = ccl_device_get_info_scalar(
-        dev, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, cl_uint, &err_internal);
+    /* Get work size limits, which are kept by the kernel, if given. */
+    if (krnl != NULL) {
+        prof = ccl_kernel_get_ws_profile(krnl, dev, &err_internal);
+    } else {
+        ccl_kernel_ws_profile_load(NULL, dev, &prof_dev, &err_internal);
+        prof = &prof_dev;
+    }
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
-    ccl_if_err_create_goto(*err, CCL_ERROR, dims > dev_dims,
+    wg_size_max = prof->wg_size_max;
+    wg_size_mult = prof->wg_size_mult;
+    sg_size = prof->sg_size;
+
+    /* Align the preferred workgroup size multiple with the subgroup size,
+     * using their least common multiple if within the kernel limits. */
+    if ((sg_size > 1) && (wg_size_mult > 0) && (wg_size_mult % sg_size)) {
+        size_t gcd = wg_size_mult, rem = sg_size, lcm;
+        while (rem != 0) {
+            size_t aux = gcd % rem;
+            gcd = rem;
+            rem = aux;
+        }
+        lcm = wg_size_mult / gcd * sg_size;
+        wg_size_mult = (lcm <= wg_size_max) ? lcm : sg_size;
+    }
+
+    /* Check if device supports the requested dims. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, dims > prof->dev_dims,
         CCL_ERROR_UNSUPPORTED_OCL, error_handler,
         "%s: device only supports a maximum of %d dimension(s), "
         "but %d were requested.",
-        CCL_STRD, dev_dims, dims);
-
-    /* Get max. work item sizes for device. */
-    max_wi_sizes = ccl_device_get_info_array(
-        dev, CL_DEVICE_MAX_WORK_ITEM_SIZES, size_t, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        CCL_STRD, prof->dev_dims, dims);
 
     /* For each dimension, if the user specified a maximum local work
      * size, the effective maximum local work size will be the minimum
      * between the user value and the device value. */
+    max_wi_sizes = (dims <= CCL_KERNEL_WS_DIMS)
+        ? max_wi_sizes_aux : g_new(size_t, dims);
     for (cl_uint i = 0; i < dims; ++i) {
-        if (lws[i] != 0)
-            max_wi_sizes[i] = MIN(max_wi_sizes[i], lws[i]);
-    }
-
-    /* If kernel is not NULL, query it about workgroup size preferences
-     * and capabilities. */
-    if (krnl != NULL) {
-
-        /* Determine maximum workgroup size. */
-        wg_size_max = ccl_kernel_get_workgroup_info_scalar(krnl, dev,
-            CL_KERNEL_WORK_GROUP_SIZE, size_t, &err_internal);
-        ccl_if_err_not_info_unavailable_propagate_goto(
-            err, err_internal, error_handler);
-
-#ifdef CL_VERSION_1_1
-
-        /* Determine preferred workgroup size multiple (OpenCL >= 1.1). */
-
-        /* Get OpenCL version of the underlying platform. */
-        cl_uint ocl_ver = ccl_kernel_get_opencl_version(krnl, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-
-        /* If OpenCL version of the underlying platform is >= 1.1 ... */
-        if (ocl_ver >= 110) {
-
-            /* ...use CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE... */
-            wg_size_mult = ccl_kernel_get_workgroup_info_scalar(
-                krnl, dev, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
-                size_t, &err_internal);
-            ccl_if_err_not_info_unavailable_propagate_goto(
-                err, err_internal, error_handler);
-
-        } else {
-
-            /* ...otherwise just use CL_KERNEL_WORK_GROUP_SIZE. */
-            wg_size_mult = wg_size_max;
-
-        }
-
-#else
-
-        wg_size_mult = wg_size_max;
-
-#endif
-
-    }
-
-    /* If it was not possible to obtain wg_size_mult and wg_size_max, either
-     * because kernel is NULL or the information was unavailable, use values
-     * obtained from device. */
-    if ((wg_size_max == 0) && (wg_size_mult == 0)) {
-        wg_size_max = ccl_device_get_info_scalar(
-            dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, size_t, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-        wg_size_mult = wg_size_max;
+        max_wi_sizes[i] = (lws[i] != 0)
+            ? MIN(prof->max_wi_sizes[i], lws[i]) : prof->max_wi_sizes[i];
     }
 
     /* Try to find an appropriate local worksize. */
@@ -1048,7 +2174,21 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
 
     /* If output variable gws is not NULL... */
     if (gws != NULL) {
-        /* ...find a global worksize which is a multiple of the local
+        /* ...grow the local worksize until workgroups are made of full
+         * subgroups, if the kernel and device limits allow it... */
+        if (sg_size > 1) {
+            wg_size = 1;
+            for (cl_uint i = 0; i < dims; ++i) wg_size *= lws[i];
+            for (cl_uint i = 0; (i < dims) && (wg_size % sg_size); ++i) {
+                while ((wg_size % sg_size)
+                    && (lws[i] * 2 <= max_wi_sizes[i])
+                    && (wg_size * 2 <= wg_size_max)) {
+                    lws[i] *= 2;
+                    wg_size *= 2;
+                }
+            }
+        }
+        /* ...and find a global worksize which is a multiple of the local
          * worksize and is big enough to handle the real worksize. */
         for (cl_uint i = 0; i < dims; ++i) {
             gws[i] = ((real_worksize[i] / lws[i])
@@ -1086,6 +2226,9 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
                      * new one. Must be a divisor of real_worksize[i]
                      * and respect the kernel and device maximum lws.*/
                     cl_uint best_lws_i = 1;
+                    /* Best divisor which keeps the workgroup made of
+                     * full subgroups, if any. */
+                    cl_uint best_sg_lws_i = 0;
                     for (cl_uint j = 2; j <= real_worksize[i] / 2; ++j) {
                         /* If current value is higher than the kernel
                          * and device limits, stop searching and use
@@ -1095,11 +2238,17 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
                         /* Otherwise check if current value is divisor
                          * of lws[i]. If so, keep it as the best so
                          * far. */
-                        if (real_worksize[i] % j == 0)
+                        if (real_worksize[i] % j == 0) {
                             best_lws_i = j;
+                            if ((sg_size > 1)
+                                && ((wg_size * j) % sg_size == 0))
+                                best_sg_lws_i = j;
+                        }
                     }
-                    /* Keep the best divisor for current dimension. */
-                    lws[i] = best_lws_i;
+                    /* Keep the best divisor for current dimension,
+                     * preferring the ones aligned with the subgroup
+                     * size. */
+                    lws[i] = (best_sg_lws_i > 0) ? best_sg_lws_i : best_lws_i;
                 }
                 /* Update absolute workgroup size (all dimensions). */
                 wg_size *= lws[i];
@@ -1120,10 +2269,52 @@ error_handler:
 
 finish:
 
+    /* Release effective maximum work item sizes, if allocated. */
+    if (max_wi_sizes != max_wi_sizes_aux) g_free(max_wi_sizes);
+
     /* Return status. */
     return ret_status;
 }
 
+/**
+ * Get the subgroup (SIMD) size of a kernel on a device, to which the local
+ * work sizes suggested by ::ccl_kernel_suggest_worksizes() are aligned.
+ *
+ * If the device supports the `cl_intel_required_subgroup_size` extension
+ * and the kernel was compiled with the `intel_reqd_sub_group_size`
+ * attribute, the required size is returned. Otherwise, the
+ * `CL_KERNEL_MAX_SUB_GROUP_SIZE_FOR_NDRANGE` for a one-dimensional
+ * work-group of the maximum size allowed for the kernel is returned. The
+ * value is determined on first use and kept by the kernel wrapper.
+ *
+ * @public @memberof ccl_kernel
+ * @note Requires OpenCL >= 2.1, otherwise zero is returned.
+ *
+ * @param[in] krnl Kernel wrapper object.
+ * @param[in] dev Device wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The subgroup size of the kernel on the device, or zero if it is
+ * unknown or if an error occurs.
+ * */
+CCL_EXPORT
+size_t ccl_kernel_get_subgroup_size(
+    CCLKernel * krnl, CCLDevice * dev, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, 0);
+    /* Make sure dev is not NULL. */
+    g_return_val_if_fail(dev != NULL, 0);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+    /* Work size limits of kernel and device. */
+    const CCLKernelWSProfile * prof;
+
+    prof = ccl_kernel_get_ws_profile(krnl, dev, err);
+    return (prof != NULL) ? prof->sg_size : 0;
+}
+
 #ifdef CL_VERSION_1_2
 
 /**
@@ -1248,4 +2439,348 @@ finish:
     return info;
 }
 
+#ifdef CL_VERSION_1_2
+
+/**
+ * @internal
+ *
+ * @brief Get a string kernel argument info value, keeping it in the given
+ * string chunk.
+ *
+ * @param[in] kernel OpenCL kernel.
+ * @param[in] idx Argument index.
+ * @param[in] param_name Name of string argument info to get.
+ * @param[in] chunk String chunk where to keep the value.
+ * @param[out] str Location where to place the kept value.
+ * @return `CL_SUCCESS` or the error returned by clGetKernelArgInfo().
+ * */
+static cl_int ccl_kernel_arg_info_str(cl_kernel kernel, cl_uint idx,
+    cl_kernel_arg_info param_name, GStringChunk * chunk, const char ** str) {
+
+    size_t size;
+    gchar * value;
+    cl_int ocl_status;
+
+    ocl_status = clGetKernelArgInfo(
+        kernel, idx, param_name, 0, NULL, &size);
+    if (ocl_status != CL_SUCCESS) return ocl_status;
+
+    value = g_malloc0(size + 1);
+    ocl_status = clGetKernelArgInfo(
+        kernel, idx, param_name, size, value, NULL);
+    if (ocl_status == CL_SUCCESS)
+        *str = g_string_chunk_insert_const(chunk, value);
+    g_free(value);
+
+    return ocl_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine the size in bytes of a kernel argument value expected
+ * by clSetKernelArg(), from its type name and address qualifier.
+ *
+ * @param[in] type_name Argument type name.
+ * @param[in] addr Argument address qualifier.
+ * @return Size in bytes of argument value, or zero if unknown.
+ * */
+static size_t ccl_kernel_arg_type_size(
+    const char * type_name, cl_kernel_arg_address_qualifier addr) {
+
+    /* Sizes of OpenCL C scalar types. */
+    static const struct { const char * name; size_t size; } scalars[] = {
+        { "char", 1 }, { "uchar", 1 }, { "short", 2 }, { "ushort", 2 },
+        { "int", 4 }, { "uint", 4 }, { "long", 8 }, { "ulong", 8 },
+        { "half", 2 }, { "float", 4 }, { "double", 8 } };
+
+    /* Size of local memory is given by client code, and global, constant
+     * and image arguments are memory objects. */
+    if (addr == CL_KERNEL_ARG_ADDRESS_LOCAL) return 0;
+    if (addr != CL_KERNEL_ARG_ADDRESS_PRIVATE) return sizeof(cl_mem);
+
+    /* Opaque private types. */
+    if (g_strcmp0(type_name, "sampler_t") == 0) return sizeof(cl_sampler);
+    if (g_strcmp0(type_name, "queue_t") == 0)
+        return sizeof(cl_command_queue);
+
+    /* Scalar and vector types, where 3-component vectors have the size of
+     * 4-component ones. */
+    for (guint i = 0; i < G_N_ELEMENTS(scalars); ++i) {
+        size_t len = strlen(scalars[i].name);
+        const char * suffix = type_name + len;
+        char * end;
+        gulong n;
+        if (strncmp(type_name, scalars[i].name, len) != 0) continue;
+        if (*suffix == '\0') return scalars[i].size;
+        if (!g_ascii_isdigit(*suffix)) continue;
+        n = strtoul(suffix, &end, 10);
+        if ((*end == '\0') && ((n == 2) || (n == 3) || (n == 4) || (n == 8)
+                || (n == 16)))
+            return scalars[i].size * (n == 3 ? 4 : n);
+    }
+
+    /* Structures and other types are unknown. */
+    return 0;
+}
+
+#endif
+
+/**
+ * Get the descriptors of all kernel arguments, i.e. their name, type name,
+ * qualifiers and expected value size.
+ *
+ * The argument info is fetched from the driver on the first call only,
+ * and the returned table is kept in the kernel wrapper, so that it can be
+ * used without further driver calls, e.g. by ccl_kernel_check_args().
+ * Argument names are only available if the program was built with the
+ * `-cl-kernel-arg-info` option, while the remaining info is generally
+ * available for programs built from source.
+ *
+ * @public @memberof ccl_kernel
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] krnl The kernel wrapper object.
+ * @param[out] num_args Location where to place the number of kernel
+ * arguments, or `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Table of descriptors of kernel arguments, which will be
+ * automatically freed when the kernel wrapper object is destroyed, or
+ * `NULL` if an error occurs or if the kernel has no arguments.
+ * */
+CCL_EXPORT
+const CCLKernelArgDesc * ccl_kernel_get_arg_descs(
+    CCLKernel * krnl, cl_uint * num_args, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Descriptors and storage of their strings, while being fetched. */
+    CCLKernelArgDesc * descs = NULL;
+    GStringChunk * strs = NULL;
+
+    /* Return cached descriptors, if already fetched. */
+    if (krnl->arg_descs != NULL) goto finish;
+
+#ifndef CL_VERSION_1_2
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 1.2, always throw
+     * error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Obtaining kernel argument information requires cf4ocl to be "
+        "deployed with support for OpenCL version 1.2 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* OpenCL kernel. */
+    cl_kernel kernel = ccl_kernel_unwrap(krnl);
+    /* Number of kernel arguments. */
+    cl_uint num_descs;
+    /* OpenCL status flag. */
+    cl_int ocl_status;
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* Error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that context platform is >= OpenCL 1.2 */
+    ocl_ver = ccl_kernel_get_opencl_version(krnl, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: information about kernel arguments requires OpenCL" \
+        " version 1.2 or newer.", CCL_STRD);
+
+    /* Get number of kernel arguments. */
+    num_descs = ccl_kernel_get_info_scalar(
+        krnl, CL_KERNEL_NUM_ARGS, cl_uint, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    if (num_descs == 0) goto finish;
+
+    /* Fetch info of each argument. */
+    descs = g_new0(CCLKernelArgDesc, num_descs);
+    strs = g_string_chunk_new(256);
+    for (cl_uint i = 0; i < num_descs; ++i) {
+
+        ocl_status = clGetKernelArgInfo(kernel, i,
+            CL_KERNEL_ARG_ADDRESS_QUALIFIER,
+            sizeof(cl_kernel_arg_address_qualifier),
+            &descs[i].address_qualifier, NULL);
+        if (ocl_status == CL_SUCCESS)
+            ocl_status = clGetKernelArgInfo(kernel, i,
+                CL_KERNEL_ARG_ACCESS_QUALIFIER,
+                sizeof(cl_kernel_arg_access_qualifier),
+                &descs[i].access_qualifier, NULL);
+        if (ocl_status == CL_SUCCESS)
+            ocl_status = clGetKernelArgInfo(kernel, i,
+                CL_KERNEL_ARG_TYPE_QUALIFIER,
+                sizeof(cl_kernel_arg_type_qualifier),
+                &descs[i].type_qualifier, NULL);
+        if (ocl_status == CL_SUCCESS)
+            ocl_status = ccl_kernel_arg_info_str(kernel, i,
+                CL_KERNEL_ARG_TYPE_NAME, strs, &descs[i].type_name);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to get info of kernel argument %u (OpenCL error "
+            "%d: %s).", CCL_STRD, i, ocl_status, ccl_err(ocl_status));
+
+        /* Argument names are optional. */
+        if (ccl_kernel_arg_info_str(kernel, i, CL_KERNEL_ARG_NAME, strs,
+                &descs[i].name) != CL_SUCCESS)
+            descs[i].name = NULL;
+
+        descs[i].size = ccl_kernel_arg_type_size(
+            descs[i].type_name, descs[i].address_qualifier);
+    }
+
+    /* Keep descriptors. */
+    krnl->arg_descs = descs;
+    krnl->num_arg_descs = num_descs;
+    krnl->arg_strs = strs;
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Discard partially fetched descriptors. */
+    g_free(descs);
+    if (strs != NULL) g_string_chunk_free(strs);
+
+finish:
+
+    /* Return descriptors. */
+    if (num_args != NULL) *num_args = krnl->num_arg_descs;
+    return krnl->arg_descs;
+}
+
+/**
+ * Validate the arguments set in a kernel against the descriptors of its
+ * arguments, as fetched by ccl_kernel_get_arg_descs(), without any driver
+ * calls once the descriptors are fetched.
+ *
+ * The following is checked for each argument: that it was set; that local
+ * memory arguments are set with ::ccl_arg_local() or similar; that global,
+ * constant and image arguments are set with memory objects or SVM
+ * pointers; and that private arguments are set with values of the
+ * expected size, if known.
+ *
+ * If the library is compiled with the `CHECK_KERNEL_ARGS` CMake option,
+ * this function is called on every launch of kernels whose argument info
+ * is available.
+ *
+ * @public @memberof ccl_kernel
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] krnl The kernel wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if arguments are valid, `CL_FALSE` otherwise (in which
+ * case an error with the ::CCL_ERROR_ARGS code is reported).
+ * */
+CCL_EXPORT
+cl_bool ccl_kernel_check_args(CCLKernel * krnl, CCLErr ** err) {
+
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Descriptors of kernel arguments. */
+    const CCLKernelArgDesc * descs;
+    const CCLKernelArgDesc * desc;
+    cl_uint num_descs;
+    /* Current value of argument. */
+    const struct ccl_kernel_arg_value * v;
+    /* Function return status. */
+    cl_bool ret_status;
+    /* Error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Get argument descriptors. */
+    descs = ccl_kernel_get_arg_descs(krnl, &num_descs, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    for (cl_uint i = 0; i < num_descs; ++i) {
+
+        desc = &descs[i];
+
+        /* Get current value of argument, i.e. the pending one if set
+         * since the last launch, or the one last sent otherwise. */
+        v = NULL;
+        if (i < krnl->num_args)
+            v = (krnl->dirty[i / CCL_KERNEL_ARGS_PER_WORD]
+                & (1UL << (i % CCL_KERNEL_ARGS_PER_WORD)))
+                ? &krnl->args[i].pending : &krnl->args[i].sent;
+
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (v == NULL) || (v->size == 0), CCL_ERROR_ARGS, error_handler,
+            "%s: argument %u ('%s %s') is not set.", CCL_STRD, i,
+            desc->type_name, desc->name != NULL ? desc->name : "");
+
+        switch (desc->address_qualifier) {
+
+#ifdef CL_VERSION_1_2
+            case CL_KERNEL_ARG_ADDRESS_LOCAL:
+                ccl_if_err_create_goto(*err, CCL_ERROR,
+                    !v->null_value || v->svm, CCL_ERROR_ARGS,
+                    error_handler,
+                    "%s: argument %u ('%s %s') expects a local memory "
+                    "size.", CCL_STRD, i, desc->type_name,
+                    desc->name != NULL ? desc->name : "");
+                break;
+
+            case CL_KERNEL_ARG_ADDRESS_PRIVATE:
+                ccl_if_err_create_goto(*err, CCL_ERROR,
+                    v->null_value || v->svm
+                    || ((desc->size > 0) && (v->size != desc->size)),
+                    CCL_ERROR_ARGS, error_handler,
+                    "%s: argument %u ('%s %s') expects a value of %u "
+                    "bytes, but %s of %u bytes was given.", CCL_STRD, i,
+                    desc->type_name, desc->name != NULL ? desc->name : "",
+                    (unsigned int) desc->size,
+                    v->null_value ? "local memory" : "a value",
+                    (unsigned int) v->size);
+                break;
+#endif
+
+            default:
+                /* Global, constant and image arguments. */
+                ccl_if_err_create_goto(*err, CCL_ERROR,
+                    !v->svm && (v->size != sizeof(cl_mem)),
+                    CCL_ERROR_ARGS, error_handler,
+                    "%s: argument %u ('%s %s') expects a memory object.",
+                    CCL_STRD, i, desc->type_name,
+                    desc->name != NULL ? desc->name : "");
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
 /** @} */
@@ -35,6 +35,12 @@
 #include "ccl_queue_wrapper.h"
 #include "ccl_memobj_wrapper.h"
 
+/* Compile-time subgroup size query of the cl_intel_required_subgroup_size
+ * extension, for OpenCL headers which predate it. */
+#ifndef CL_KERNEL_COMPILE_SUB_GROUP_SIZE_INTEL
+    #define CL_KERNEL_COMPILE_SUB_GROUP_SIZE_INTEL 0x410A
+#endif
+
 /**
  * @defgroup CCL_KERNEL_WRAPPER Kernel wrapper
  *
@@ -82,6 +88,15 @@
  * * ::ccl_kernel_get_arg_info_array()
  * * ::ccl_kernel_get_arg_info()
  *
+ * Since each argument info query is a driver call, the
+ * ::ccl_kernel_get_arg_descs() function fetches the info of all
+ * arguments once per kernel wrapper into a compact table of
+ * ::CCLKernelArgDesc descriptors, which is kept for subsequent calls. The
+ * ::ccl_kernel_check_args() function validates the arguments set in a
+ * kernel against this table without any driver calls. If the library is
+ * compiled with the `CHECK_KERNEL_ARGS` CMake option, arguments are
+ * validated in this way on every launch, e.g. in debug or canary builds.
+ *
  * _Example: getting a kernel wrapper from a program wrapper_
  *
  * ```c
@@ -111,6 +126,53 @@
  * @{
  */
 
+/**
+ * Descriptor of a kernel argument, as fetched by
+ * ::ccl_kernel_get_arg_descs().
+ * */
+typedef struct ccl_kernel_arg_desc {
+
+    /**
+     * Argument name, or `NULL` if not available, e.g. if the program was
+     * not built with the `-cl-kernel-arg-info` option.
+     * @public
+     * */
+    const char * name;
+
+    /**
+     * Argument type name, e.g. `float4` or `float*`.
+     * @public
+     * */
+    const char * type_name;
+
+    /**
+     * Argument address qualifier, e.g. `CL_KERNEL_ARG_ADDRESS_GLOBAL`.
+     * @public
+     * */
+    cl_kernel_arg_address_qualifier address_qualifier;
+
+    /**
+     * Argument access qualifier, e.g. `CL_KERNEL_ARG_ACCESS_READ_ONLY`.
+     * @public
+     * */
+    cl_kernel_arg_access_qualifier access_qualifier;
+
+    /**
+     * Argument type qualifiers, e.g. `CL_KERNEL_ARG_TYPE_CONST`.
+     * @public
+     * */
+    cl_kernel_arg_type_qualifier type_qualifier;
+
+    /**
+     * Size in bytes of the argument value expected by clSetKernelArg(),
+     * derived from the type name and address qualifier, or zero if it is
+     * not known (e.g. for local memory or structure arguments).
+     * @public
+     * */
+    size_t size;
+
+} CCLKernelArgDesc;
+
 /* Get the kernel wrapper for the given OpenCL kernel. */
 CCL_EXPORT
 CCLKernel * ccl_kernel_new_wrap(cl_kernel kernel);
@@ -120,6 +182,11 @@ CCL_EXPORT
 CCLKernel * ccl_kernel_new(
     CCLProgram * prg, const char * kernel_name, CCLErr ** err);
 
+/* Create a new kernel wrapper object which is a copy of the given
+ * kernel. */
+CCL_EXPORT
+CCLKernel * ccl_kernel_clone(CCLKernel * krnl, CCLErr ** err);
+
 /* Decrements the reference count of the kernel wrapper object.
  * If it reaches 0, the kernel wrapper object is destroyed. */
 CCL_EXPORT
@@ -146,6 +213,23 @@ CCLEvent * ccl_kernel_enqueue_ndrange(CCLKernel * krnl, CCLQueue * cq,
     const size_t * global_work_size, const size_t * local_work_size,
     CCLEventWaitList * evt_wait_lst, CCLErr ** err);
 
+/* Enqueues a kernel for execution on a device, split in tiles. */
+CCL_EXPORT
+CCLEvent * ccl_kernel_enqueue_ndrange_tiled(CCLKernel * krnl, CCLQueue * cq,
+    cl_uint work_dim, const size_t * global_work_offset,
+    const size_t * global_work_size, const size_t * local_work_size,
+    const size_t * tile_size, cl_uint flush_interval,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueues a kernel on a buffer in chunks, pipelining transfers and
+ * computation. */
+CCL_EXPORT
+CCLEvent * ccl_kernel_enqueue_ndrange_pipelined(CCLKernel * krnl,
+    CCLQueue ** cqs, cl_uint num_queues, CCLBuffer * buf, void * host_ptr,
+    size_t elem_size, size_t num_elems, size_t chunk_size,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
 /* Set kernel arguments and enqueue it for execution. */
 CCL_EXPORT
 CCLEvent * ccl_kernel_set_args_and_enqueue_ndrange(CCLKernel * krnl,
@@ -182,6 +266,12 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
     cl_uint dims, const size_t * real_worksize, size_t * gws, size_t * lws,
     CCLErr ** err);
 
+/* Get the subgroup (SIMD) size of a kernel on a device, to which the
+ * suggested local worksizes are aligned. */
+CCL_EXPORT
+size_t ccl_kernel_get_subgroup_size(
+    CCLKernel * krnl, CCLDevice * dev, CCLErr ** err);
+
 /**
  * Get a ::CCLWrapperInfo kernel information object.
  *
@@ -218,7 +308,7 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
  * If an error occurs, zero is returned.
  * */
 #define ccl_kernel_get_info_scalar(krnl, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) (krnl), \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) (krnl), \
         NULL, (param_name), sizeof(param_type), \
         CCL_INFO_KERNEL, CL_FALSE, (err)))
 
@@ -286,7 +376,7 @@ cl_bool ccl_kernel_suggest_worksizes(CCLKernel * krnl, CCLDevice * dev,
  * */
 #define ccl_kernel_get_workgroup_info_scalar(krnl, dev, param_name, \
     param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) (krnl), \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) (krnl), \
         (CCLWrapper *) (dev), (param_name), sizeof(param_type), \
         CCL_INFO_KERNEL_WORKGROUP, CL_FALSE, (err)))
 
@@ -322,6 +412,17 @@ CCL_EXPORT
 CCLWrapperInfo * ccl_kernel_get_arg_info(CCLKernel * krnl, cl_uint idx,
     cl_kernel_arg_info param_name, CCLErr ** err);
 
+/* Get the descriptors of all kernel arguments, which are fetched once per
+ * kernel wrapper. */
+CCL_EXPORT
+const CCLKernelArgDesc * ccl_kernel_get_arg_descs(
+    CCLKernel * krnl, cl_uint * num_args, CCLErr ** err);
+
+/* Validate the arguments set in a kernel against the descriptors of its
+ * arguments. */
+CCL_EXPORT
+cl_bool ccl_kernel_check_args(CCLKernel * krnl, CCLErr ** err);
+
 /**
  * Macro which returns a scalar kernel argument information
  * value.
@@ -17,8 +17,14 @@
  * */
 
 #include "ccl_memobj_wrapper.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_image_wrapper.h"
+#include "ccl_pipe_wrapper.h"
 #include "_ccl_memobj_wrapper.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_queue_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
 
  /**
  * @file
@@ -29,6 +35,485 @@
  * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
  * */
 
+/**
+ * @internal
+ *
+ * @brief Forget the device where a memory object was last written.
+ *
+ * @param[in] mo A memory object wrapper object.
+ * */
+static void ccl_memobj_residency_clear(CCLMemObj * mo) {
+
+    if (mo->resident_dev != NULL) ccl_device_destroy(mo->resident_dev);
+    if (mo->resident_evt != NULL) ccl_event_destroy(mo->resident_evt);
+    mo->resident_dev = NULL;
+    mo->resident_evt = NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release the queue and event references of a memory object
+ * access, and reset it.
+ *
+ * @param[in] acc Memory object access.
+ * */
+static void ccl_memobj_access_clear(CCLMemObjAccess * acc) {
+
+    if (acc->cq != NULL) ccl_queue_destroy(acc->cq);
+    if (acc->evt != NULL) ccl_event_destroy(acc->evt);
+    acc->cq = NULL;
+    acc->evt = NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Forget the commands which accessed a memory object.
+ *
+ * @param[in] mo A memory object wrapper object.
+ * */
+static void ccl_memobj_hazard_clear(CCLMemObj * mo) {
+
+    ccl_memobj_access_clear(&mo->writer);
+    if (mo->readers != NULL) {
+        for (guint i = 0; i < mo->readers->len; ++i)
+            ccl_memobj_access_clear(
+                &g_array_index(mo->readers, CCLMemObjAccess, i));
+        g_array_free(mo->readers, TRUE);
+        mo->readers = NULL;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Is the given command queue an in-order queue? Queues whose
+ * properties cannot be determined are considered out-of-order.
+ *
+ * @param[in] cq A command queue wrapper object.
+ * @return `CL_TRUE` if queue executes commands in order, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_memobj_queue_in_order(CCLQueue * cq) {
+
+    CCLErr * err_internal = NULL;
+    cl_command_queue_properties props;
+
+    props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    if (err_internal != NULL) {
+        g_error_free(err_internal);
+        return CL_FALSE;
+    }
+    return !(props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+}
+
+/**
+ * @internal
+ *
+ * @brief Memory object whose destruction is deferred until a set of
+ * events completes.
+ * */
+typedef struct ccl_memobj_deferred {
+
+    /**
+     * Memory object to destroy.
+     * @private
+     * */
+    CCLMemObj * mo;
+
+    /**
+     * Number of events which did not complete yet.
+     * @private
+     * */
+    gint pending;
+
+} CCLMemObjDeferred;
+
+/* Lock for creating the deferred destructions thread pool. */
+static GMutex deferred_lock;
+
+/* Thread pool, with a single thread, where parked memory objects are
+ * destroyed. */
+static GThreadPool * deferred_pool = NULL;
+
+/**
+ * @internal
+ *
+ * @brief Destroy a buffer, image or pipe wrapper object.
+ *
+ * @param[in] mo Memory object wrapper to destroy.
+ * */
+static void ccl_memobj_destroy(CCLMemObj * mo) {
+
+    if (((CCLWrapper *) mo)->class == CCL_IMAGE)
+        ccl_image_destroy((CCLImage *) mo);
+    else if (((CCLWrapper *) mo)->class == CCL_PIPE)
+        ccl_pipe_destroy((CCLPipe *) mo);
+    else
+        ccl_buffer_destroy((CCLBuffer *) mo);
+}
+
+/**
+ * @internal
+ *
+ * @brief Destroy the memory object of a deferred destruction. Used as the
+ * function of the deferred destructions thread pool.
+ *
+ * @param[in] data Deferred destruction.
+ * @param[in] pool_data Not used.
+ * */
+static void ccl_memobj_deferred_run(gpointer data, gpointer pool_data) {
+
+    CCLMemObjDeferred * dfr = (CCLMemObjDeferred *) data;
+
+    CCL_UNUSED(pool_data);
+
+    ccl_memobj_destroy(dfr->mo);
+    g_slice_free(CCLMemObjDeferred, dfr);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the deferred destructions thread pool, creating it if
+ * necessary.
+ *
+ * @return The deferred destructions thread pool.
+ * */
+static GThreadPool * ccl_memobj_deferred_pool_get() {
+
+    GThreadPool * pool;
+
+    g_mutex_lock(&deferred_lock);
+    if (deferred_pool == NULL) {
+        deferred_pool = g_thread_pool_new(
+            ccl_memobj_deferred_run, NULL, 1, FALSE, NULL);
+    }
+    pool = deferred_pool;
+    g_mutex_unlock(&deferred_lock);
+
+    return pool;
+}
+
+/**
+ * @internal
+ *
+ * @brief Account for the completion of events of a deferred destruction,
+ * destroying the memory object when all of them completed.
+ *
+ * Event callbacks must not call expensive or blocking OpenCL functions,
+ * such as the ones which release the memory object and the queues and
+ * events referenced by its tracking information. As such, when called from
+ * an event callback, the memory object is handed to the deferred
+ * destructions thread pool instead of being destroyed in place.
+ *
+ * @param[in] dfr Deferred destruction.
+ * @param[in] count Number of completed events.
+ * @param[in] in_callback Is the function being called from an event
+ * callback?
+ * */
+static void ccl_memobj_deferred_done(
+    CCLMemObjDeferred * dfr, gint count, cl_bool in_callback) {
+
+    if (g_atomic_int_add(&dfr->pending, -count) == count) {
+        if (in_callback)
+            g_thread_pool_push(ccl_memobj_deferred_pool_get(), dfr, NULL);
+        else
+            ccl_memobj_deferred_run(dfr, NULL);
+    }
+}
+
+#ifdef CL_VERSION_1_1
+
+/**
+ * @internal
+ *
+ * @brief Event callback of deferred destructions.
+ *
+ * @param[in] event Completed event.
+ * @param[in] event_command_exec_status Execution status of event.
+ * @param[in] user_data Deferred destruction.
+ * */
+static void CL_CALLBACK ccl_memobj_deferred_cb(cl_event event,
+    cl_int event_command_exec_status, void * user_data) {
+
+    CCL_UNUSED(event);
+    CCL_UNUSED(event_command_exec_status);
+
+    ccl_memobj_deferred_done((CCLMemObjDeferred *) user_data, 1, CL_TRUE);
+}
+
+#endif
+
+/**
+ * @internal
+ *
+ * @brief Release the fields of a memory object wrapper. Used as the
+ * ccl_wrapper_release_fields() function of buffer and image wrappers.
+ *
+ * @param[in] mo Memory object wrapper being released.
+ * */
+void ccl_memobj_release_fields(CCLMemObj * mo) {
+
+    /* Stop accounting for memory object in its context. */
+    ccl_context_mem_untrack(mo);
+
+    /* Release residency information. */
+    ccl_memobj_residency_clear(mo);
+
+    /* Release hazard information. */
+    ccl_memobj_hazard_clear(mo);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get an event for tracking a command enqueued on the given queue.
+ *
+ * Commands enqueued on event-less queues have no event, so a marker is
+ * enqueued after them and its event is used instead (see
+ * ccl_queue_last_event()). If the marker can't be enqueued, the queue is
+ * finished, so that the command has completed and doesn't need to be
+ * waited for.
+ *
+ * @param[in] cq Command queue where the command was enqueued.
+ * @param[in] evt Event of the command, or `NULL` if it has none.
+ * @return Event to track the command with, or `NULL` if the command has
+ * completed.
+ * */
+static CCLEvent * ccl_memobj_access_event(CCLQueue * cq, CCLEvent * evt) {
+
+    if (evt == NULL) {
+        evt = ccl_queue_last_event(cq, NULL);
+        if (evt == NULL) ccl_queue_finish(cq, NULL);
+    }
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Record that a memory object was written by a command on the
+ * given queue, if the residency of the memory object is tracked.
+ *
+ * If the command has no event, i.e. it was enqueued on an event-less queue,
+ * a marker is enqueued after it, so that a later migration waits for the
+ * write to complete (see ccl_memobj_access_event()).
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @param[in] cq Command queue where the command was enqueued.
+ * @param[in] evt Event of the command, or `NULL` if it has none.
+ * */
+void ccl_memobj_residency_update(
+    CCLMemObj * mo, CCLQueue * cq, CCLEvent * evt) {
+
+    CCLDevice * dev;
+
+    if (!mo->residency) return;
+
+    /* Make sure the write can be waited for. */
+    evt = ccl_memobj_access_event(cq, evt);
+
+    /* Keep references to new device and event before releasing the
+     * previous ones, which may be the same. */
+    dev = ccl_queue_get_device(cq, NULL);
+    if (dev != NULL) ccl_device_ref(dev);
+    if (evt != NULL) ccl_event_ref(evt);
+    ccl_memobj_residency_clear(mo);
+    mo->resident_dev = dev;
+    mo->resident_evt = evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Migrate the tracked memory objects which were last written on
+ * another device to the device of the given queue, after the commands
+ * which wrote them. Memory objects already resident in the queue device,
+ * untracked memory objects and memory objects never written are skipped.
+ *
+ * @param[in] mos Memory object wrapper objects, possibly repeated.
+ * @param[in] num_mos Number of memory object wrapper objects.
+ * @param[in] cq Command queue where the migration is enqueued.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event of the migration, or `NULL` if no migration was required
+ * or if an error occurs.
+ * */
+CCLEvent * ccl_memobj_residency_migrate(CCLMemObj ** mos, cl_uint num_mos,
+    CCLQueue * cq, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLMemObj ** moving = NULL;
+    CCLDevice * dev;
+    cl_uint num_moving = 0, j;
+
+    /* Get device of queue. */
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Select memory objects resident in other devices, once each, waiting
+     * for the commands which last wrote them. */
+    moving = g_new(CCLMemObj *, num_mos);
+    for (cl_uint i = 0; i < num_mos; ++i) {
+        if (!mos[i]->residency || (mos[i]->resident_dev == NULL)
+            || (mos[i]->resident_dev == dev))
+            continue;
+        for (j = 0; (j < num_moving) && (moving[j] != mos[i]); ++j);
+        if (j < num_moving) continue;
+        moving[num_moving++] = mos[i];
+        if (mos[i]->resident_evt != NULL)
+            ccl_ewl(&ewl, mos[i]->resident_evt, NULL);
+    }
+
+    /* Migrate selected memory objects, which then reside in the queue
+     * device. */
+    if (num_moving > 0) {
+        evt = ccl_memobj_enqueue_migrate(
+            moving, num_moving, cq, 0, &ewl, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        for (j = 0; j < num_moving; ++j)
+            ccl_memobj_residency_update(moving[j], cq, evt);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Release temporary stuff. */
+    ccl_event_wait_list_clear(&ewl);
+    g_free(moving);
+
+    /* Return migration event. */
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Add the events which a command accessing a memory object must
+ * wait for to an event wait list, if the hazards of the memory object are
+ * tracked. Reads wait for the last write (read-after-write), and writes
+ * also wait for the reads since then (write-after-read and
+ * write-after-write). Commands previously enqueued on the same in-order
+ * queue are skipped, since the queue already orders them.
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @param[in] cq Command queue where the command is to be enqueued.
+ * @param[in] write Does the command write the memory object?
+ * @param[in] evt_wait_lst Event wait list of the command, or `NULL`.
+ * @param[in] hzd_wait_lst Empty event wait list to use if `evt_wait_lst`
+ * is `NULL` and dependencies are added. It is cleared when the returned
+ * list is cleared.
+ * @return Event wait list to use for the command.
+ * */
+CCLEventWaitList * ccl_memobj_hazard_deps(CCLMemObj * mo, CCLQueue * cq,
+    cl_bool write, CCLEventWaitList * evt_wait_lst,
+    CCLEventWaitList * hzd_wait_lst) {
+
+    CCLMemObjAccess * acc;
+    cl_bool in_order;
+
+    if (!mo->hazards) return evt_wait_lst;
+
+    in_order = ccl_memobj_queue_in_order(cq);
+    if (evt_wait_lst == NULL) evt_wait_lst = hzd_wait_lst;
+
+    /* Read-after-write and write-after-write. */
+    acc = &mo->writer;
+    if ((acc->evt != NULL) && !(in_order && (acc->cq == cq)))
+        ccl_ewl(evt_wait_lst, acc->evt, NULL);
+
+    /* Write-after-read. */
+    for (guint i = 0; write && (i < mo->readers->len); ++i) {
+        acc = &g_array_index(mo->readers, CCLMemObjAccess, i);
+        if (!(in_order && (acc->cq == cq)))
+            ccl_ewl(evt_wait_lst, acc->evt, NULL);
+    }
+
+    /* Return the list only if dependencies were added to it. */
+    return (evt_wait_lst == hzd_wait_lst) && (*hzd_wait_lst == NULL)
+        ? NULL : evt_wait_lst;
+}
+
+/**
+ * @internal
+ *
+ * @brief Record that a command accessed a memory object, if the hazards of
+ * the memory object are tracked. A write replaces the last write and
+ * forgets the reads since then. A read replaces the previous read on the
+ * same in-order queue, which it follows anyway.
+ *
+ * If the command has no event, i.e. it was enqueued on an event-less queue,
+ * a marker is enqueued after it and recorded instead (see
+ * ccl_memobj_access_event()).
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @param[in] cq Command queue where the command was enqueued.
+ * @param[in] write Does the command write the memory object?
+ * @param[in] evt Event of the command, or `NULL` if it has none.
+ * */
+void ccl_memobj_hazard_record(
+    CCLMemObj * mo, CCLQueue * cq, cl_bool write, CCLEvent * evt) {
+
+    CCLMemObjAccess acc;
+    CCLMemObjAccess * reader;
+    guint i;
+
+    if (!mo->hazards) return;
+
+    /* Make sure the command can be waited for. A command which still has
+     * no event has completed, and so have the commands it waited for. */
+    evt = ccl_memobj_access_event(cq, evt);
+    acc.cq = (evt != NULL) ? cq : NULL;
+    acc.evt = evt;
+
+    /* Keep references to queue and event before releasing the replaced
+     * access, which may refer to the same ones. */
+    if (evt != NULL) {
+        ccl_queue_ref(cq);
+        ccl_event_ref(evt);
+    }
+
+    if (write) {
+
+        /* Forget reads, which the write waited for. */
+        for (i = 0; i < mo->readers->len; ++i)
+            ccl_memobj_access_clear(
+                &g_array_index(mo->readers, CCLMemObjAccess, i));
+        g_array_set_size(mo->readers, 0);
+        ccl_memobj_access_clear(&mo->writer);
+        mo->writer = acc;
+
+    } else if (evt != NULL) {
+
+        /* Replace previous read on the same in-order queue. */
+        for (i = 0; i < mo->readers->len; ++i) {
+            reader = &g_array_index(mo->readers, CCLMemObjAccess, i);
+            if (reader->cq == cq) break;
+        }
+        if ((i < mo->readers->len) && ccl_memobj_queue_in_order(cq)) {
+            ccl_memobj_access_clear(reader);
+            *reader = acc;
+        } else {
+            g_array_append_val(mo->readers, acc);
+        }
+    }
+}
+
 /**
  * @addtogroup CCL_MEMOBJ_WRAPPER
  * @{
@@ -127,18 +612,28 @@ CCLEvent * ccl_memobj_enqueue_unmap(CCLMemObj * mo, CCLQueue * cq,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event. */
-    cl_event event;
+    cl_event event = NULL;
     /* Event wrapper. */
     CCLEvent * evt;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
+
+    /* Wait for conflicting commands on the memory object. */
+    evt_wait_lst = ccl_memobj_hazard_deps(mo, cq, CL_TRUE,
+        evt_wait_lst, &hzd_ewl);
 
     /* Enqueue unmap command. */
     ocl_status = clEnqueueUnmapMemObject (ccl_queue_unwrap(cq),
         ccl_memobj_unwrap(mo), mapped_ptr,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to unmap memory object (OpenCL error %d: %s).",
@@ -147,7 +642,10 @@ CCLEvent * ccl_memobj_enqueue_unmap(CCLMemObj * mo, CCLQueue * cq,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory object, if hazards are tracked. */
+    ccl_memobj_hazard_record(mo, cq, CL_TRUE, evt);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -166,6 +664,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return evt. */
     return evt;
 }
@@ -295,10 +796,13 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL function status. */
     cl_int ocl_status;
     /* OpenCL event. */
-    cl_event event;
+    cl_event event = NULL;
     /* Event wrapper. */
     CCLEvent * evt;
     /* OpenCL version. */
@@ -307,9 +811,12 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
     CCLErr * err_internal = NULL;
     /* Array of OpenCL memory objects. */
     cl_mem * mem_objects = NULL;
+    /* Wait list with dependencies due to memory object hazards. */
+    CCLEventWaitList hzd_ewl = NULL;
 
 #ifndef CL_VERSION_1_2
 
+    CCL_UNUSED(hzd_ewl);
     CCL_UNUSED(flags);
     CCL_UNUSED(evt_wait_lst);
     CCL_UNUSED(ocl_status);
@@ -341,16 +848,21 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
     /* Allocate memory for memory objects. */
     mem_objects = (cl_mem *) g_slice_alloc(sizeof(cl_mem) * num_mos);
 
-    /* Gather OpenCL memory objects in a array. */
+    /* Gather OpenCL memory objects in a array, and wait for conflicting
+     * commands on them. Migrations are considered to write the memory
+     * objects. */
     for (cl_uint i = 0; i < num_mos; ++i) {
         mem_objects[i] = ccl_memobj_unwrap(mos[i]);
+        evt_wait_lst = ccl_memobj_hazard_deps(
+            mos[i], cq, CL_TRUE, evt_wait_lst, &hzd_ewl);
     }
 
     /* Migrate memory objects. */
     ocl_status = clEnqueueMigrateMemObjects(ccl_queue_unwrap(cq),
         num_mos, (const cl_mem*) mem_objects, flags,
         ccl_event_wait_list_get_num_events(evt_wait_lst),
-        ccl_event_wait_list_get_clevents(evt_wait_lst), &event);
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: unable to migrate memory objects (OpenCL error %d: %s).",
@@ -359,7 +871,11 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Record access to memory objects, if hazards are tracked. */
+    for (cl_uint i = 0; i < num_mos; ++i)
+        ccl_memobj_hazard_record(mos[i], cq, CL_TRUE, evt);
 
 #endif
 
@@ -383,8 +899,348 @@ finish:
     /* Release stuff. */
     if (mem_objects) g_slice_free1(sizeof(cl_mem) * num_mos, mem_objects);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return evt. */
     return evt;
 }
 
+/**
+ * Enable or disable tracking of the device where a memory object resides.
+ *
+ * When tracking is enabled, the device of the queue where the memory
+ * object was last written, and the event of the respective command, are
+ * recorded. Kernels and buffer writes, copies and fills are considered
+ * to write the memory object. When a kernel which takes the memory object
+ * as argument is enqueued on a queue of another device, the memory object
+ * is first migrated to that device with ::ccl_memobj_enqueue_migrate(),
+ * after the command which last wrote it. Migrations to the device where
+ * the memory object already resides are skipped.
+ *
+ * Tracking only affects kernel arguments set after it is enabled. Kernel
+ * wrappers keep a reference to tracked memory objects set as their
+ * arguments, until the argument is replaced or the kernel is destroyed.
+ *
+ * Writes enqueued on event-less queues (see ::ccl_queue_set_eventless())
+ * have no event, so a marker is enqueued after each of them, and its event
+ * is recorded instead.
+ *
+ * @public @memberof ccl_memobj
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @param[in] enable Enable (`CL_TRUE`) or disable (`CL_FALSE`) tracking.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation completes successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_memobj_set_residency_tracking(
+    CCLMemObj * mo, cl_bool enable, CCLErr ** err) {
+
+    /* Make sure mo is not NULL. */
+    g_return_val_if_fail(mo != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* OpenCL version. */
+    cl_uint ocl_ver;
+    /* Return status. */
+    cl_bool ret_status;
+
+    if (enable) {
+
+#ifndef CL_VERSION_1_2
+
+        CCL_UNUSED(ocl_ver);
+        CCL_UNUSED(err_internal);
+
+        /* Migrations require cf4ocl to be compiled with OpenCL >= 1.2. */
+        ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+            CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+            "%s: Residency tracking requires cf4ocl to be "
+            "deployed with support for OpenCL version 1.2 or newer.",
+            CCL_STRD);
+
+#else
+
+        /* Check that context platform is >= OpenCL 1.2 */
+        ocl_ver = ccl_memobj_get_opencl_version(mo, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 120,
+            CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+            "%s: residency tracking requires OpenCL version 1.2 or newer.",
+            CCL_STRD);
+
+#endif
+
+    } else {
+
+        /* Forget where memory object resides. */
+        ccl_memobj_residency_clear(mo);
+    }
+
+    mo->residency = enable;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Get the device where a memory object was last written, if its
+ * residency is tracked.
+ *
+ * @public @memberof ccl_memobj
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @return The device wrapper object of the device where the memory object
+ * was last written, or `NULL` if unknown or if residency is not tracked.
+ * The device wrapper should not be destroyed by client code.
+ * */
+CCL_EXPORT
+CCLDevice * ccl_memobj_get_resident_device(CCLMemObj * mo) {
+
+    /* Make sure mo is not NULL. */
+    g_return_val_if_fail(mo != NULL, NULL);
+
+    return mo->resident_dev;
+}
+
+/**
+ * Enable or disable tracking of read and write hazards of a memory object.
+ *
+ * When tracking is enabled, the last command which wrote the memory
+ * object and the commands which read it since then are recorded. Commands
+ * which subsequently access the memory object, through kernel arguments or
+ * the `ccl_*_enqueue_*()` functions, automatically wait for the minimum
+ * set of those commands: reads wait for the last write, and writes wait
+ * for the last write and for the reads since then. Commands enqueued on
+ * the same in-order queue are not waited for, since the queue already
+ * orders them. This makes it possible to use memory objects in several
+ * queues without specifying event dependencies by hand and without
+ * calling ::ccl_queue_finish().
+ *
+ * Kernels are considered to write all their memory object arguments,
+ * unless the memory object was created with the `CL_MEM_READ_ONLY` flag.
+ * As with residency tracking, only kernel arguments set after tracking is
+ * enabled are considered, and kernel wrappers keep a reference to the
+ * tracked memory objects set as their arguments.
+ *
+ * @public @memberof ccl_memobj
+ *
+ * Commands enqueued on event-less queues (see ::ccl_queue_set_eventless())
+ * have no event, so a marker is enqueued after each of them, and its event
+ * is recorded instead.
+ *
+ * @param[in] mo A memory object wrapper object.
+ * @param[in] enable Enable (`CL_TRUE`) or disable (`CL_FALSE`) tracking.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation completes successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_memobj_set_hazard_tracking(
+    CCLMemObj * mo, cl_bool enable, CCLErr ** err) {
+
+    /* Make sure mo is not NULL. */
+    g_return_val_if_fail(mo != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* Memory object flags. */
+    cl_mem_flags flags;
+    /* Return status. */
+    cl_bool ret_status;
+
+    if (enable && !mo->hazards) {
+
+        /* Kernels don't write read-only memory objects. */
+        flags = ccl_memobj_get_info_scalar(
+            mo, CL_MEM_FLAGS, cl_mem_flags, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        mo->hazard_read_only = (flags & CL_MEM_READ_ONLY) ? CL_TRUE : CL_FALSE;
+        mo->readers = g_array_new(FALSE, FALSE, sizeof(CCLMemObjAccess));
+
+    } else if (!enable) {
+
+        /* Forget commands which accessed memory object. */
+        ccl_memobj_hazard_clear(mo);
+    }
+
+    mo->hazards = enable;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Release a memory object wrapper object after the given events complete,
+ * without waiting for them.
+ *
+ * This function is an asynchronous alternative to ::ccl_buffer_destroy()
+ * and ::ccl_image_destroy(), for memory objects still being used by
+ * commands in flight. The memory object is parked until its last-use
+ * events complete, and a callback set on each of them hands it to a
+ * thread owned by _cf4ocl_ when the last one does, where it is released.
+ * The host thread never waits for the commands, and doesn't rely on the
+ * driver deferring the release of the memory object.
+ *
+ * If hazards of the memory object are tracked (see
+ * ::ccl_memobj_set_hazard_tracking()), the last command which wrote it
+ * and the commands which read it since then are also waited for, so that
+ * `evt_wait_lst` can be `NULL`. If there are no events to wait for, the
+ * memory object is released immediately.
+ *
+ * @public @memberof ccl_memobj
+ * @note Requires OpenCL >= 1.1 to wait for events. With OpenCL 1.0, the
+ * memory object is released immediately, leaving its deferred release to
+ * the driver.
+ *
+ * @attention The memory object wrapper is released from another thread.
+ * Client code should not use it after calling this function.
+ *
+ * @param[in] mo The memory object wrapper object to release.
+ * @param[in,out] evt_wait_lst List of last-use events of the memory
+ * object, or `NULL`. The list will be cleared and can be reused by client
+ * code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation completes successfully, `CL_FALSE`
+ * otherwise. The memory object is released in either case.
+ * */
+CCL_EXPORT
+cl_bool ccl_memobj_destroy_deferred(CCLMemObj * mo,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure mo is not NULL. */
+    g_return_val_if_fail(mo != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* OpenCL function status. */
+    cl_int ocl_status = CL_SUCCESS;
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* Wait list with events of tracked accesses. */
+    CCLEventWaitList hzd_ewl = NULL;
+    /* Deferred destruction. */
+    CCLMemObjDeferred * dfr;
+    /* Events to wait for. */
+    const cl_event * events;
+    cl_uint num_events, num_set = 0;
+    /* Return status. */
+    cl_bool ret_status;
+
+    /* Also wait for tracked accesses. */
+    if (mo->hazards) {
+        if (evt_wait_lst == NULL) evt_wait_lst = &hzd_ewl;
+        if (mo->writer.evt != NULL)
+            ccl_ewl(evt_wait_lst, mo->writer.evt, NULL);
+        for (guint i = 0; i < mo->readers->len; ++i)
+            ccl_ewl(evt_wait_lst,
+                g_array_index(mo->readers, CCLMemObjAccess, i).evt, NULL);
+    }
+    events = ccl_event_wait_list_get_clevents(evt_wait_lst);
+    num_events = ccl_event_wait_list_get_num_events(evt_wait_lst);
+
+    /* Park memory object. A guard count keeps it parked until all
+     * callbacks are set. */
+    dfr = g_slice_new(CCLMemObjDeferred);
+    dfr->mo = mo;
+    dfr->pending = (gint) num_events + 1;
+
+    /* Event callbacks require OpenCL >= 1.1. */
+    ocl_ver = (num_events > 0)
+        ? ccl_memobj_get_opencl_version(mo, &err_internal) : 0;
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_1_1
+
+    /* Create the thread pool where the memory object is destroyed, so that
+     * event callbacks only hand it over. */
+    if ((ocl_ver >= 110) && (num_events > 0))
+        ccl_memobj_deferred_pool_get();
+
+    /* Release memory object when each event completes. */
+    for (num_set = 0; (ocl_ver >= 110) && (num_set < num_events); ++num_set) {
+        ocl_status = clSetEventCallback(events[num_set], CL_COMPLETE,
+            ccl_memobj_deferred_cb, dfr);
+        if (ocl_status != CL_SUCCESS) break;
+    }
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to set event callback (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+#else
+
+    CCL_UNUSED(events);
+    CCL_UNUSED(ocl_ver);
+    CCL_UNUSED(ocl_status);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Drop guard count and count events without callback as completed,
+     * releasing memory object if no callbacks are pending. */
+    ccl_memobj_deferred_done(
+        dfr, (gint) (num_events - num_set) + 1, CL_FALSE);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return status. */
+    return ret_status;
+}
+
 /** @} */
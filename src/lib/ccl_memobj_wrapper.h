@@ -55,6 +55,22 @@
  * * ::ccl_memobj_get_info_array()
  * * ::ccl_memobj_get_info()
  *
+ * In multi-device contexts, memory objects can opt in to residency
+ * tracking with ::ccl_memobj_set_residency_tracking(), in which case
+ * they are automatically migrated to the device of the queue where a
+ * kernel using them is enqueued, if they were last written on another
+ * device.
+ *
+ * With multiple queues, memory objects can also opt in to hazard
+ * tracking with ::ccl_memobj_set_hazard_tracking(), in which case
+ * commands accessing them automatically wait for the previous commands
+ * they conflict with, i.e., for the last write and, if they write, for
+ * the reads since then.
+ *
+ * Memory objects still in use by commands in flight can be released with
+ * ::ccl_memobj_destroy_deferred(), which releases them from event
+ * callbacks once their last-use events complete, without waiting.
+ *
  * @{
  */
 
@@ -94,6 +110,28 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
      CCLQueue * cq, cl_mem_migration_flags flags,
      CCLEventWaitList * evt_wait_lst, CCLErr ** err);
 
+/* Enable or disable tracking of the device where a memory object
+ * resides. */
+CCL_EXPORT
+cl_bool ccl_memobj_set_residency_tracking(
+    CCLMemObj * mo, cl_bool enable, CCLErr ** err);
+
+/* Get the device where a memory object was last written. */
+CCL_EXPORT
+CCLDevice * ccl_memobj_get_resident_device(CCLMemObj * mo);
+
+/* Enable or disable tracking of read and write hazards of a memory
+ * object. */
+CCL_EXPORT
+cl_bool ccl_memobj_set_hazard_tracking(
+    CCLMemObj * mo, cl_bool enable, CCLErr ** err);
+
+/* Release a memory object wrapper object after the given events
+ * complete, without waiting for them. */
+CCL_EXPORT
+cl_bool ccl_memobj_destroy_deferred(CCLMemObj * mo,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
 /**
  * Get a ::CCLWrapperInfo memory object information object.
  *
@@ -130,7 +168,7 @@ CCLEvent * ccl_memobj_enqueue_migrate(CCLMemObj ** mos, cl_uint num_mos,
  * If an error occurs, zero is returned.
  * */
 #define ccl_memobj_get_info_scalar(mo, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) mo, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) mo, \
         NULL, param_name, sizeof(param_type), CCL_INFO_MEMOBJ, CL_FALSE, err))
 
 /**
@@ -0,0 +1,463 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of throughput-proportional multi-device kernel dispatch.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_multi_dispatch.h"
+#include "_ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * Multi-device dispatcher class.
+ * */
+struct ccl_multi_dispatch {
+
+    /**
+     * Context whose devices execute dispatched kernels.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Number of devices.
+     * @private
+     * */
+    cl_uint num_devs;
+
+    /**
+     * Profiling-enabled command queues, one per device.
+     * @private
+     * */
+    CCLQueue ** queues;
+
+    /**
+     * Current share of the range given to each device. Shares add up
+     * to 1.
+     * @private
+     * */
+    double * shares;
+
+    /**
+     * Events of the parts of the last dispatch which are yet to be
+     * profiled, or `NULL` for devices which got no part of the range.
+     * @private
+     * */
+    CCLEvent ** evts;
+
+    /**
+     * Number of work-items, along the split dimension, of the parts of
+     * the last dispatch.
+     * @private
+     * */
+    size_t * items;
+
+    /**
+     * Event wait list with the events of the last dispatch.
+     * @private
+     * */
+    CCLEventWaitList done;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Release the events of the last dispatch kept for profiling.
+ *
+ * @param[in] md A multi-device dispatcher.
+ * */
+static void ccl_multi_dispatch_release_evts(CCLMultiDispatch * md) {
+
+    for (cl_uint i = 0; i < md->num_devs; ++i) {
+        if (md->evts[i] != NULL) {
+            ccl_event_destroy(md->evts[i]);
+            md->evts[i] = NULL;
+        }
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Update the shares of the devices with the profiling information
+ * of the last dispatch, if all its parts have completed. This function
+ * does not block.
+ *
+ * @param[in] md A multi-device dispatcher.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_multi_dispatch_update(
+    CCLMultiDispatch * md, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status = CL_FALSE;
+    double * thr = g_new0(double, md->num_devs);
+    double thr_total = 0, share_measured = 0, share_total = 0;
+    cl_ulong t_start, t_end;
+    cl_int status;
+
+    /* Determine throughput of each device in the last dispatch, unless
+     * some part is still executing, in which case shares are kept. */
+    for (cl_uint i = 0; i < md->num_devs; ++i) {
+        if (md->evts[i] == NULL) continue;
+        status = ccl_event_get_info_scalar(md->evts[i],
+            CL_EVENT_COMMAND_EXECUTION_STATUS, cl_int, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (status != CL_COMPLETE) goto done;
+        t_start = ccl_event_get_profiling_info_scalar(md->evts[i],
+            CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        t_end = ccl_event_get_profiling_info_scalar(md->evts[i],
+            CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (t_end <= t_start) goto done;
+        thr[i] = (double) md->items[i] / (double) (t_end - t_start);
+        thr_total += thr[i];
+        share_measured += md->shares[i];
+    }
+    if (thr_total <= 0) goto done;
+
+    /* Move shares of the measured devices, which jointly keep their
+     * total share, towards their relative throughput. Devices without a
+     * part in the last dispatch keep their share. */
+    for (cl_uint i = 0; i < md->num_devs; ++i) {
+        if (md->evts[i] != NULL)
+            md->shares[i] += CCL_MULTI_DISPATCH_SMOOTHING
+                * (share_measured * thr[i] / thr_total - md->shares[i]);
+        md->shares[i] = MAX(md->shares[i], CCL_MULTI_DISPATCH_MIN_SHARE);
+        share_total += md->shares[i];
+    }
+    for (cl_uint i = 0; i < md->num_devs; ++i)
+        md->shares[i] /= share_total;
+
+done:
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    g_free(thr);
+    return ret_status;
+}
+
+/**
+ * @addtogroup CCL_MULTI_DISPATCH
+ * @{
+ */
+
+/**
+ * Create a new multi-device dispatcher, with a profiling-enabled command
+ * queue for each device in the given context. All devices initially get
+ * the same share of dispatched ranges.
+ *
+ * @public @memberof ccl_multi_dispatch
+ *
+ * @param[in] ctx Context wrapper object, which is kept alive by the
+ * dispatcher.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new multi-device dispatcher, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLMultiDispatch * ccl_multi_dispatch_new(CCLContext * ctx, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLMultiDispatch * md = NULL;
+    CCLDevice * dev;
+    cl_uint num_devs;
+
+    /* Get number of devices in context. */
+    num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create dispatcher. */
+    md = g_slice_new0(CCLMultiDispatch);
+    ccl_context_ref(ctx);
+    md->ctx = ctx;
+    md->num_devs = num_devs;
+    md->queues = g_new0(CCLQueue *, num_devs);
+    md->shares = g_new(double, num_devs);
+    md->evts = g_new0(CCLEvent *, num_devs);
+    md->items = g_new0(size_t, num_devs);
+
+    /* Create one profiling-enabled queue per device. */
+    for (cl_uint i = 0; i < num_devs; ++i) {
+        md->shares[i] = 1.0 / num_devs;
+        dev = ccl_context_get_device(ctx, i, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        md->queues[i] = ccl_queue_new(
+            ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    if (md != NULL) ccl_multi_dispatch_destroy(md);
+    md = NULL;
+
+finish:
+
+    /* Return dispatcher. */
+    return md;
+}
+
+/**
+ * Destroy a multi-device dispatcher and its command queues, releasing
+ * its context.
+ *
+ * @public @memberof ccl_multi_dispatch
+ *
+ * @param[in] md The multi-device dispatcher to destroy.
+ * */
+CCL_EXPORT
+void ccl_multi_dispatch_destroy(CCLMultiDispatch * md) {
+
+    /* Make sure md is not NULL. */
+    g_return_if_fail(md != NULL);
+
+    ccl_multi_dispatch_release_evts(md);
+    ccl_event_wait_list_clear(&md->done);
+    for (cl_uint i = 0; i < md->num_devs; ++i)
+        if (md->queues[i] != NULL)
+            ccl_queue_destroy(md->queues[i]);
+    g_free(md->queues);
+    g_free(md->shares);
+    g_free(md->evts);
+    g_free(md->items);
+    ccl_context_unref(md->ctx);
+    g_slice_free(CCLMultiDispatch, md);
+}
+
+/**
+ * Split the range of a kernel over the devices of a multi-device
+ * dispatcher, and enqueue each part in the command queue of the
+ * respective device.
+ *
+ * The range is split along its last dimension, in proportion to the
+ * current shares of the devices, which are first updated with the
+ * profiling information of the previous dispatch, if it has completed.
+ * The kernel arguments must be set before calling this function.
+ *
+ * @public @memberof ccl_multi_dispatch
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] md A multi-device dispatcher.
+ * @param[in] krnl A kernel wrapper object.
+ * @param[in] work_dim The number of dimensions used to specify the global
+ * work-items and work-items in the work-group.
+ * @param[in] global_work_offset Offset of the range, or `NULL` for no
+ * offset.
+ * @param[in] global_work_size Global work size of the range.
+ * @param[in] local_work_size Local work size, or `NULL` to let the OpenCL
+ * implementation determine it. If given, each part of the range is a
+ * multiple of the local work size.
+ * @param[in,out] evt_wait_lst List of events that need to complete before
+ * any part of the range is executed. The list will be cleared and can be
+ * reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wait list, owned by the dispatcher, with the events of all
+ * parts of the range, or `NULL` if an error occurs. The list is cleared if
+ * used as a wait list, and is replaced by the next dispatch.
+ * */
+CCL_EXPORT
+CCLEventWaitList * ccl_multi_dispatch_enqueue_ndrange(
+    CCLMultiDispatch * md, CCLKernel * krnl, cl_uint work_dim,
+    const size_t * global_work_offset, const size_t * global_work_size,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    /* Make sure md is not NULL. */
+    g_return_val_if_fail(md != NULL, NULL);
+    /* Make sure krnl is not NULL. */
+    g_return_val_if_fail(krnl != NULL, NULL);
+    /* Make sure global_work_size is not NULL. */
+    g_return_val_if_fail(global_work_size != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEventWaitList * done = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt;
+    size_t offset[3] = { 0, 0, 0 }, gws[3], granularity, units;
+    size_t * counts = g_new(size_t, md->num_devs);
+    size_t assigned = 0, first = 0;
+    cl_uint dim = work_dim - 1;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (work_dim < 1) || (work_dim > 3), CCL_ERROR_ARGS, error_handler,
+        "%s: work_dim must be between 1 and 3.", CCL_STRD);
+    granularity = local_work_size != NULL ? local_work_size[dim] : 1;
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (granularity == 0) || (global_work_size[dim] % granularity != 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: global work size must be a multiple of local work size.",
+        CCL_STRD);
+
+    /* Update shares with last dispatch, and discard its events. */
+    ccl_multi_dispatch_update(md, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_multi_dispatch_release_evts(md);
+    ccl_event_wait_list_clear(&md->done);
+
+    /* Split range in work-groups, handing the ones left over by
+     * rounding down to the first devices. */
+    units = global_work_size[dim] / granularity;
+    for (cl_uint i = 0; i < md->num_devs; ++i) {
+        counts[i] = (size_t) (units * md->shares[i]);
+        assigned += counts[i];
+    }
+    for (cl_uint i = 0; assigned < units; i = (i + 1) % md->num_devs) {
+        counts[i]++;
+        assigned++;
+    }
+
+    /* Enqueue each part of the range in the queue of its device. */
+    for (cl_uint i = 0; i < work_dim; ++i) {
+        if (global_work_offset != NULL) offset[i] = global_work_offset[i];
+        gws[i] = global_work_size[i];
+    }
+    for (cl_uint i = 0; i < md->num_devs; ++i) {
+        md->items[i] = counts[i] * granularity;
+        if (counts[i] == 0) continue;
+        offset[dim] = (global_work_offset != NULL
+            ? global_work_offset[dim] : 0) + first * granularity;
+        gws[dim] = md->items[i];
+        evt = ccl_kernel_enqueue_ndrange(krnl, md->queues[i], work_dim,
+            offset, gws, local_work_size,
+            ccl_event_wait_list_copy(&ewl, evt_wait_lst), &err_internal);
+        ccl_event_wait_list_clear(&ewl);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_ref(evt);
+        md->evts[i] = evt;
+        ccl_ewl(&md->done, evt, NULL);
+        first += counts[i];
+    }
+    done = &md->done;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+    g_free(counts);
+
+    /* Return wait list with events of all parts. */
+    return done;
+}
+
+/**
+ * Get number of devices of a multi-device dispatcher.
+ *
+ * @public @memberof ccl_multi_dispatch
+ *
+ * @param[in] md A multi-device dispatcher.
+ * @return Number of devices.
+ * */
+CCL_EXPORT
+cl_uint ccl_multi_dispatch_get_num_devices(CCLMultiDispatch * md) {
+
+    /* Make sure md is not NULL. */
+    g_return_val_if_fail(md != NULL, 0);
+
+    return md->num_devs;
+}
+
+/**
+ * Get command queue of a device of a multi-device dispatcher, e.g. for
+ * commands which transfer the data of the part of the range given to
+ * the device.
+ *
+ * @public @memberof ccl_multi_dispatch
+ *
+ * @param[in] md A multi-device dispatcher.
+ * @param[in] index Index of device in the context of the dispatcher.
+ * @return Command queue wrapper object, owned by the dispatcher.
+ * */
+CCL_EXPORT
+CCLQueue * ccl_multi_dispatch_get_queue(CCLMultiDispatch * md, cl_uint index) {
+
+    /* Make sure md is not NULL. */
+    g_return_val_if_fail(md != NULL, NULL);
+    /* Make sure index is valid. */
+    g_return_val_if_fail(index < md->num_devs, NULL);
+
+    return md->queues[index];
+}
+
+/**
+ * Get current share of dispatched ranges given to a device of a
+ * multi-device dispatcher.
+ *
+ * @public @memberof ccl_multi_dispatch
+ *
+ * @param[in] md A multi-device dispatcher.
+ * @param[in] index Index of device in the context of the dispatcher.
+ * @return Share of the range, between 0 and 1, given to the device.
+ * */
+CCL_EXPORT
+double ccl_multi_dispatch_get_share(CCLMultiDispatch * md, cl_uint index) {
+
+    /* Make sure md is not NULL. */
+    g_return_val_if_fail(md != NULL, 0);
+    /* Make sure index is valid. */
+    g_return_val_if_fail(index < md->num_devs, 0);
+
+    return md->shares[index];
+}
+
+/** @} */
@@ -0,0 +1,140 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of throughput-proportional multi-device kernel dispatch.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_MULTI_DISPATCH_H_
+#define _CCL_MULTI_DISPATCH_H_
+
+#include "ccl_common.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_kernel_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_MULTI_DISPATCH Multi-device dispatch
+ * @ingroup CCL_KERNEL_WRAPPER
+ *
+ * This module splits the execution of a kernel over all the devices of a
+ * context, e.g. of a context with several GPUs created with
+ * ::ccl_context_new_from_filters_full(), in proportion to the measured
+ * throughput of each device.
+ *
+ * A dispatcher is created with ::ccl_multi_dispatch_new(), which creates
+ * a profiling-enabled command queue for each device in the context. Each
+ * call to ::ccl_multi_dispatch_enqueue_ndrange() splits the global work
+ * size along its last dimension (i.e. rows, for 2D ranges), in multiples
+ * of the local work size, and enqueues one part of the range in each
+ * queue using the global work offset. Initially, all devices get the
+ * same share of the range. Once the commands of a dispatch have
+ * completed, their profiling information is used to move the shares
+ * towards the throughput of each device in the following dispatches, so
+ * that, over iterations, all devices finish their parts at roughly the
+ * same time. The completion of all parts of a dispatch is given by a
+ * single event wait list.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLMultiDispatch * md;
+ * CCLEventWaitList * done;
+ * size_t gws[] = { width, height };
+ * size_t lws[] = { 16, 16 };
+ * @endcode
+ * @code{.c}
+ * md = ccl_multi_dispatch_new(ctx, NULL);
+ * @endcode
+ * @code{.c}
+ * for (iter = 0; iter < num_iters; ++iter) {
+ *     ccl_kernel_set_args(krnl, in, out, NULL);
+ *     done = ccl_multi_dispatch_enqueue_ndrange(
+ *         md, krnl, 2, NULL, gws, lws, NULL, NULL);
+ *     ccl_event_wait(done, NULL);
+ *     swap(&in, &out);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_multi_dispatch_destroy(md);
+ * @endcode
+ *
+ * @attention Memory objects accessed by the kernel must be shared by all
+ * devices in the context, and each work-item should only write the data
+ * it is responsible for. Memory objects with hazard tracking enabled (see
+ * ::ccl_memobj_set_hazard_tracking()) make the parts of a dispatch wait
+ * for each other, and should therefore be avoided.
+ *
+ * @{
+ */
+
+/**
+ * Fraction of the difference between the measured and the current share
+ * of a device by which the share of the device is updated after each
+ * profiled dispatch.
+ * */
+#define CCL_MULTI_DISPATCH_SMOOTHING 0.5
+
+/**
+ * Minimum share of the range given to each device, so that the
+ * throughput of all devices keeps being measured.
+ * */
+#define CCL_MULTI_DISPATCH_MIN_SHARE 0.01
+
+/**
+ * Multi-device dispatcher class.
+ * */
+typedef struct ccl_multi_dispatch CCLMultiDispatch;
+
+/* Create a new multi-device dispatcher for the devices of a context. */
+CCL_EXPORT
+CCLMultiDispatch * ccl_multi_dispatch_new(CCLContext * ctx, CCLErr ** err);
+
+/* Destroy a multi-device dispatcher and its queues. */
+CCL_EXPORT
+void ccl_multi_dispatch_destroy(CCLMultiDispatch * md);
+
+/* Split and enqueue a kernel over the devices of a dispatcher. */
+CCL_EXPORT
+CCLEventWaitList * ccl_multi_dispatch_enqueue_ndrange(
+    CCLMultiDispatch * md, CCLKernel * krnl, cl_uint work_dim,
+    const size_t * global_work_offset, const size_t * global_work_size,
+    const size_t * local_work_size, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
+/* Get number of devices of a multi-device dispatcher. */
+CCL_EXPORT
+cl_uint ccl_multi_dispatch_get_num_devices(CCLMultiDispatch * md);
+
+/* Get command queue of a device of a multi-device dispatcher. */
+CCL_EXPORT
+CCLQueue * ccl_multi_dispatch_get_queue(CCLMultiDispatch * md, cl_uint index);
+
+/* Get current share of the range given to a device. */
+CCL_EXPORT
+double ccl_multi_dispatch_get_share(CCLMultiDispatch * md, cl_uint index);
+
+/** @} */
+
+#endif
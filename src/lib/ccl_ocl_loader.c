@@ -0,0 +1,272 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of runtime loading of the OpenCL library.
+ *
+ * This file is only compiled if the library is built with the
+ * `OPENCL_DLOPEN` CMake option. It defines every function in the OpenCL
+ * core API as a stub which resolves the real function in the OpenCL
+ * library on its first call, opening the library if required.
+ * The stubs are not exported from the library, so they don't interpose
+ * the OpenCL API of applications which also use OpenCL directly.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include <dlfcn.h>
+
+#include "_ccl_ocl_loader.h"
+#include "_ccl_defs.h"
+
+/* Error code returned by the ICD loader when no platforms are available,
+ * also returned by the stubs when the OpenCL library cannot be loaded. */
+#ifndef CL_PLATFORM_NOT_FOUND_KHR
+    #define CL_PLATFORM_NOT_FOUND_KHR -1001
+#endif
+
+/**
+ * @internal
+ * Environment variable which overrides the OpenCL library path.
+ * */
+#define CCL_OCL_LOADER_ENV "CCL_OPENCL_LIBRARY"
+
+/**
+ * @internal
+ * @brief Result of opening the OpenCL library.
+ * */
+typedef struct ccl_ocl_loader {
+
+    /**
+     * Handle of the OpenCL library, or `NULL` if it could not be opened.
+     * @private
+     * */
+    void * handle;
+
+    /**
+     * Reason why the OpenCL library could not be opened, or `NULL` if it
+     * was opened successfully.
+     * @private
+     * */
+    gchar * error;
+
+} CCLOclLoader;
+
+/**
+ * @internal
+ * Paths tried when opening the OpenCL library, in order.
+ * */
+static const char * const ccl_ocl_loader_paths[] = {
+#if defined(__APPLE__) || defined(__MACOSX)
+    "/System/Library/Frameworks/OpenCL.framework/OpenCL",
+#else
+    "libOpenCL.so.1",
+    "libOpenCL.so",
+#endif
+    NULL
+};
+
+/**
+ * @internal
+ *
+ * @brief Open the OpenCL library. Called only once, via `g_once()`.
+ *
+ * @param[in] data Unused.
+ * @return A ::CCLOclLoader object, which is never freed.
+ * */
+static gpointer ccl_ocl_loader_open(gpointer data) {
+
+    const gchar * env_path;
+    CCLOclLoader * loader;
+
+    CCL_UNUSED(data);
+
+    loader = g_slice_new0(CCLOclLoader);
+
+    /* A path given by the user overrides the default paths. */
+    env_path = g_getenv(CCL_OCL_LOADER_ENV);
+    if ((env_path != NULL) && (*env_path != '\0')) {
+        loader->handle = dlopen(env_path, RTLD_NOW | RTLD_LOCAL);
+        if (loader->handle == NULL)
+            loader->error = g_strdup(dlerror());
+    } else {
+        for (guint i = 0; ccl_ocl_loader_paths[i] != NULL; ++i) {
+            loader->handle =
+                dlopen(ccl_ocl_loader_paths[i], RTLD_NOW | RTLD_LOCAL);
+            if (loader->handle != NULL) break;
+            /* Keep the error of the first, most specific, path. */
+            if (loader->error == NULL)
+                loader->error = g_strdup(dlerror());
+        }
+        if (loader->handle != NULL) {
+            g_free(loader->error);
+            loader->error = NULL;
+        }
+    }
+
+    if (loader->handle != NULL)
+        g_debug("OpenCL library loaded at runtime.");
+    else
+        g_debug("Unable to load OpenCL library: %s", loader->error);
+
+    return (gpointer) loader;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the OpenCL library loader, opening the library on the first
+ * call.
+ *
+ * @return The OpenCL library loader.
+ * */
+static CCLOclLoader * ccl_ocl_loader_get(void) {
+
+    static GOnce loader_once = G_ONCE_INIT;
+
+    return (CCLOclLoader *) g_once(&loader_once, ccl_ocl_loader_open, NULL);
+}
+
+/**
+ * @internal
+ *
+ * @brief Resolve an OpenCL function in the OpenCL library.
+ *
+ * @param[in] name Name of the OpenCL function.
+ * @param[in,out] cache Location where the resolved function is cached.
+ * @param[out] status Error code to return from the stub if the function
+ * cannot be resolved.
+ * @return The resolved function, or `NULL` if the function cannot be
+ * resolved.
+ * */
+static void * ccl_ocl_loader_sym(
+    const char * name, gpointer * cache, cl_int * status) {
+
+    CCLOclLoader * loader;
+    void * sym = g_atomic_pointer_get(cache);
+
+    /* Fast path, function already resolved. */
+    if (sym != NULL) return sym;
+
+    loader = ccl_ocl_loader_get();
+    if (loader->handle == NULL) {
+        *status = CL_PLATFORM_NOT_FOUND_KHR;
+        return NULL;
+    }
+
+    /* Concurrent resolution of the same function is harmless. */
+    sym = dlsym(loader->handle, name);
+    if (sym == NULL) {
+        g_debug("OpenCL function '%s' not found in OpenCL library.", name);
+        *status = CL_INVALID_OPERATION;
+        return NULL;
+    }
+    g_atomic_pointer_set(cache, sym);
+
+    return sym;
+}
+
+/* Stub for a function returning a cl_int status. */
+#define CCL_OCL_FUN_INT(name, params, args) \
+    CCL_NO_EXPORT CL_API_ENTRY cl_int CL_API_CALL name params { \
+        static gpointer ccl_cache = NULL; \
+        cl_int (CL_API_CALL * ccl_fun) params; \
+        cl_int ccl_status = CL_SUCCESS; \
+        void * ccl_sym = ccl_ocl_loader_sym(#name, &ccl_cache, &ccl_status); \
+        if (ccl_sym == NULL) return ccl_status; \
+        *(void **) (&ccl_fun) = ccl_sym; \
+        return ccl_fun args; \
+    }
+
+/* Stub for a function returning an object, with an error code argument. */
+#define CCL_OCL_FUN_OBJ(type, name, params, args) \
+    CCL_NO_EXPORT CL_API_ENTRY type CL_API_CALL name params { \
+        static gpointer ccl_cache = NULL; \
+        type (CL_API_CALL * ccl_fun) params; \
+        cl_int ccl_status = CL_SUCCESS; \
+        void * ccl_sym = ccl_ocl_loader_sym(#name, &ccl_cache, &ccl_status); \
+        if (ccl_sym == NULL) { \
+            if (errcode_ret != NULL) *errcode_ret = ccl_status; \
+            return NULL; \
+        } \
+        *(void **) (&ccl_fun) = ccl_sym; \
+        return ccl_fun args; \
+    }
+
+/* Stub for a function returning a pointer, without error code argument. */
+#define CCL_OCL_FUN_PTR(type, name, params, args) \
+    CCL_NO_EXPORT CL_API_ENTRY type CL_API_CALL name params { \
+        static gpointer ccl_cache = NULL; \
+        type (CL_API_CALL * ccl_fun) params; \
+        cl_int ccl_status = CL_SUCCESS; \
+        void * ccl_sym = ccl_ocl_loader_sym(#name, &ccl_cache, &ccl_status); \
+        if (ccl_sym == NULL) return NULL; \
+        *(void **) (&ccl_fun) = ccl_sym; \
+        return ccl_fun args; \
+    }
+
+/* Stub for a function returning nothing. */
+#define CCL_OCL_FUN_VOID(name, params, args) \
+    CCL_NO_EXPORT CL_API_ENTRY void CL_API_CALL name params { \
+        static gpointer ccl_cache = NULL; \
+        void (CL_API_CALL * ccl_fun) params; \
+        cl_int ccl_status = CL_SUCCESS; \
+        void * ccl_sym = ccl_ocl_loader_sym(#name, &ccl_cache, &ccl_status); \
+        if (ccl_sym == NULL) return; \
+        *(void **) (&ccl_fun) = ccl_sym; \
+        ccl_fun args; \
+    }
+
+/* Define the stubs. */
+#include "_ccl_ocl_funs.h"
+
+#undef CCL_OCL_FUN_INT
+#undef CCL_OCL_FUN_OBJ
+#undef CCL_OCL_FUN_PTR
+#undef CCL_OCL_FUN_VOID
+
+/**
+ * @internal
+ *
+ * @brief Check if the OpenCL library can be loaded, loading it if
+ * necessary.
+ *
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored. A ::CCL_ERROR_OPENCL_UNAVAILABLE error is
+ * reported if the OpenCL library cannot be loaded.
+ * @return `CL_TRUE` if the OpenCL library is loaded, `CL_FALSE` otherwise.
+ * */
+cl_bool ccl_ocl_loader_check(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLOclLoader * loader = ccl_ocl_loader_get();
+
+    if (loader->handle == NULL) {
+        g_set_error(err, CCL_ERROR, CCL_ERROR_OPENCL_UNAVAILABLE,
+            "%s: OpenCL library not available: %s",
+            CCL_STRD, loader->error);
+        return CL_FALSE;
+    }
+
+    return CL_TRUE;
+}
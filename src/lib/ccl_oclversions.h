@@ -138,6 +138,10 @@
     typedef cl_bitfield         cl_device_svm_capabilities;
     typedef cl_bitfield         cl_queue_properties;
     typedef cl_bitfield         cl_sampler_properties;
+    typedef cl_bitfield         cl_svm_mem_flags;
+    /* cl_mem_flags and cl_svm_mem_flags - bitfield */
+    #define CL_MEM_SVM_FINE_GRAIN_BUFFER                (1 << 10)
+    #define CL_MEM_SVM_ATOMICS                          (1 << 11)
     /* cl_command_type */
     #define CL_COMMAND_SVM_FREE                         0x1209
     #define CL_COMMAND_SVM_MEMCPY                       0x120A
@@ -178,6 +182,8 @@
     #define CL_DEVICE_IL_VERSION                             0x105B
     #define CL_DEVICE_MAX_NUM_SUB_GROUPS                     0x105C
     #define CL_DEVICE_SUB_GROUP_INDEPENDENT_FORWARD_PROGRESS 0x105D
+    /* cl_command_type */
+    #define CL_COMMAND_SVM_MIGRATE_MEM                  0x120E
     /* cl_channel_type */
     #define CL_UNORM_INT_101010_2                       0x10E0
 
@@ -0,0 +1,228 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Implementation of a wrapper class and its methods for OpenCL pipe objects.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_pipe_wrapper.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_device_wrapper.h"
+#include "_ccl_memobj_wrapper.h"
+#include "_ccl_context_wrapper.h"
+#include "_ccl_defs.h"
+
+/**
+ * Pipe wrapper class
+ *
+ * @extends ccl_memobj
+ * */
+struct ccl_pipe {
+
+    /**
+     * Parent wrapper object.
+     * @private
+     * */
+    CCLMemObj mo;
+
+};
+
+/**
+ * @addtogroup CCL_PIPE_WRAPPER
+ * @{
+ */
+
+/**
+ * Get the pipe wrapper for the given OpenCL pipe.
+ *
+ * If the wrapper doesn't exist, its created with a reference count of 1.
+ * Otherwise, the existing wrapper is returned and its reference count is
+ * incremented by 1.
+ *
+ * This function will rarely be called from client code, except when
+ * clients wish to directly wrap an OpenCL pipe in a ::CCLPipe wrapper
+ * object.
+ *
+ * @protected @memberof ccl_pipe
+ *
+ * @param[in] mem_object The OpenCL pipe to be wrapped.
+ * @return The ::CCLPipe wrapper for the given OpenCL pipe.
+ * */
+CCL_EXPORT
+CCLPipe * ccl_pipe_new_wrap(cl_mem mem_object) {
+
+    return (CCLPipe *) ccl_wrapper_new(
+        CCL_PIPE, (void *) mem_object, sizeof(CCLPipe));
+}
+
+/**
+ * Decrements the reference count of the wrapper object. If it reaches 0,
+ * the wrapper object is destroyed.
+ *
+ * @public @memberof ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * */
+CCL_EXPORT
+void ccl_pipe_destroy(CCLPipe * pipe) {
+
+    ccl_wrapper_unref((CCLWrapper *) pipe, sizeof(CCLPipe),
+        (ccl_wrapper_release_fields) ccl_memobj_release_fields,
+        (ccl_wrapper_release_cl_object) clReleaseMemObject, NULL);
+}
+
+/**
+ * Create a new pipe wrapper object. This function wraps the clCreatePipe()
+ * OpenCL function.
+ *
+ * The packet size is validated against the `CL_DEVICE_PIPE_MAX_PACKET_SIZE`
+ * of all devices in the context, and the pipe memory is accounted for in
+ * the context.
+ *
+ * @public @memberof ccl_pipe
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] ctx Context wrapper.
+ * @param[in] flags OpenCL memory flags as used in clCreatePipe(), i.e. zero,
+ * `CL_MEM_READ_WRITE` or `CL_MEM_HOST_NO_ACCESS`.
+ * @param[in] packet_size Size in bytes of a pipe packet.
+ * @param[in] max_packets Maximum number of packets the pipe can hold.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new pipe wrapper object, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLPipe * ccl_pipe_new(CCLContext * ctx, cl_mem_flags flags,
+    cl_uint packet_size, cl_uint max_packets, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Pipe wrapper object. */
+    CCLPipe * pipe = NULL;
+
+#ifndef CL_VERSION_2_0
+
+    CCL_UNUSED(flags);
+    CCL_UNUSED(packet_size);
+    CCL_UNUSED(max_packets);
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.0, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Pipes require cf4ocl to be deployed with support for OpenCL "
+        "version 2.0 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* OpenCL status flag. */
+    cl_int ocl_status;
+    /* OpenCL pipe object. */
+    cl_mem mem_object;
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* Devices in context. */
+    CCLDevice * const * devs;
+    /* Number of devices in context. */
+    cl_uint num_devs;
+    /* Maximum packet size of current device. */
+    cl_uint max_packet_size;
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that platform is >= OpenCL 2.0. */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 200,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Pipes require OpenCL version 2.0 or newer.",
+        CCL_STRD);
+
+    /* Check packet size against the limits of all devices in context. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (packet_size == 0) || (max_packets == 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: Pipe packet size and maximum number of packets must be "
+        "positive.", CCL_STRD);
+    num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    devs = ccl_context_get_all_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    for (cl_uint i = 0; i < num_devs; ++i) {
+        max_packet_size = ccl_device_get_info_scalar(devs[i],
+            CL_DEVICE_PIPE_MAX_PACKET_SIZE, cl_uint, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_if_err_create_goto(*err, CCL_ERROR, max_packet_size == 0,
+            CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+            "%s: Device %u does not support pipes.", CCL_STRD, i);
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            packet_size > max_packet_size,
+            CCL_ERROR_ARGS, error_handler,
+            "%s: Pipe packet size (%u bytes) exceeds the maximum of "
+            "device %u (%u bytes).",
+            CCL_STRD, packet_size, i, max_packet_size);
+    }
+
+    /* Create OpenCL pipe. */
+    mem_object = clCreatePipe(ccl_context_unwrap(ctx), flags, packet_size,
+        max_packets, NULL, &ocl_status);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to create pipe (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap OpenCL pipe. */
+    pipe = ccl_pipe_new_wrap(mem_object);
+
+    /* Account for pipe memory in context. */
+    ccl_context_mem_track(ctx, (CCLMemObj *) pipe,
+        (size_t) packet_size * max_packets, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release pipe, if it was created. */
+    if (pipe != NULL) {
+        ccl_pipe_destroy(pipe);
+        pipe = NULL;
+    }
+
+finish:
+
+    /* Return new pipe wrapper. */
+    return pipe;
+}
+
+/** @} */
@@ -0,0 +1,194 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of a wrapper class and its methods for OpenCL pipe objects.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_PIPE_WRAPPER_H_
+#define _CCL_PIPE_WRAPPER_H_
+
+#include "ccl_memobj_wrapper.h"
+
+/**
+ * @defgroup CCL_PIPE_WRAPPER Pipe wrapper
+ *
+ * The pipe wrapper module provides functionality for simple handling of
+ * OpenCL pipe objects (OpenCL >= 2.0).
+ *
+ * A pipe is a FIFO of fixed-size packets through which kernels running
+ * concurrently, e.g. in an out-of-order queue or in different queues, can
+ * stream data to each other with the `read_pipe()` and `write_pipe()`
+ * OpenCL C built-in functions. The OpenCL implementation may keep pipe
+ * storage on chip, avoiding round-trips of intermediate data through
+ * global memory. Pipes are created with ::ccl_pipe_new(), which checks
+ * the packet size against the `CL_DEVICE_PIPE_MAX_PACKET_SIZE` of the
+ * context devices, and cannot be read or written by the host.
+ *
+ * Pipe wrapper objects can be directly passed as kernel arguments to
+ * functions such as ::ccl_kernel_set_args_and_enqueue_ndrange() or
+ * ::ccl_kernel_set_args(). Programs using pipes must be built with the
+ * `-cl-std=CL2.0` option.
+ *
+ * Information about pipe objects can be fetched using the pipe
+ * @ref ug_getinfo "info macros":
+ *
+ * * ::ccl_pipe_get_info_scalar()
+ * * ::ccl_pipe_get_info_array()
+ * * ::ccl_pipe_get_info()
+ *
+ * Since pipes are memory objects, the @ref CCL_MEMOBJ_WRAPPER
+ * "memory object" info macros can also be used.
+ *
+ * Instantiation and destruction of pipe wrappers follows the _cf4ocl_
+ * @ref ug_new_destroy "new/destroy" rule.
+ *
+ * _Example:_
+ *
+ * ```c
+ * CCLPipe * pipe;
+ * ```
+ *
+ * ```c
+ * pipe = ccl_pipe_new(ctx, 0, sizeof(cl_float4), 1024, NULL);
+ * ccl_kernel_set_arg(krnl_producer, 0, pipe);
+ * ccl_kernel_set_arg(krnl_consumer, 0, pipe);
+ * ```
+ *
+ * ```c
+ * ccl_pipe_destroy(pipe);
+ * ```
+ *
+ * @{
+ */
+
+/* Get the pipe wrapper for the given OpenCL pipe. */
+CCL_EXPORT
+CCLPipe * ccl_pipe_new_wrap(cl_mem mem_object);
+
+/* Decrements the reference count of the wrapper object. If it reaches 0, the
+ * wrapper object is destroyed. */
+CCL_EXPORT
+void ccl_pipe_destroy(CCLPipe * pipe);
+
+/* Create a new pipe wrapper object. */
+CCL_EXPORT
+CCLPipe * ccl_pipe_new(CCLContext * ctx, cl_mem_flags flags,
+    cl_uint packet_size, cl_uint max_packets, CCLErr ** err);
+
+/**
+ * Get a ::CCLWrapperInfo pipe information object.
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * @param[in] param_name Name of information/parameter to get.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The requested pipe information object. This object will be
+ * automatically freed when the pipe wrapper object is destroyed. If an error
+ * occurs, `NULL` is returned.
+ * */
+#define ccl_pipe_get_info(pipe, param_name, err) \
+    ccl_wrapper_get_info((CCLWrapper *) pipe, NULL, param_name, 0, \
+        CCL_INFO_PIPE, CL_FALSE, err)
+
+/**
+ * Macro which returns a scalar pipe information value.
+ *
+ * Use with care. In case an error occurs, zero is returned, which might be
+ * ambiguous if zero is a valid return value. In this case, it is necessary to
+ * check the error object.
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * @param[in] param_name Name of information/parameter to get value of.
+ * @param[in] param_type Type of parameter (e.g. `cl_uint`, `size_t`, etc.).
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The requested pipe information value. This value will be
+ * automatically freed when the pipe wrapper object is destroyed. If an error
+ * occurs, zero is returned.
+ * */
+#define ccl_pipe_get_info_scalar(pipe, param_name, param_type, err) \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) pipe, \
+        NULL, param_name, sizeof(param_type), CCL_INFO_PIPE, CL_FALSE, err))
+
+/**
+ * Macro which returns an array pipe information value.
+ *
+ * Use with care. In case an error occurs, `NULL` is returned, which might be
+ * ambiguous if `NULL` is a valid return value. In this case, it is necessary
+ * to check the error object.
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * @param[in] param_name Name of information/parameter to get value of.
+ * @param[in] param_type Type of parameter in array (e.g. `char`, `size_t`,
+ * etc.).
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The requested pipe information value. This value will be
+ * automatically freed when the pipe wrapper object is destroyed. If an error
+ * occurs, `NULL` is returned.
+ * */
+#define ccl_pipe_get_info_array(pipe, param_name, param_type, err) \
+    (param_type *) ccl_wrapper_get_info_value((CCLWrapper *) pipe, \
+        NULL, param_name, sizeof(param_type), CCL_INFO_PIPE, CL_FALSE, err)
+
+/**
+ * Increase the reference count of the pipe wrapper object.
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * */
+#define ccl_pipe_ref(pipe) \
+    ccl_wrapper_ref((CCLWrapper *) pipe)
+
+/**
+ * Alias to ccl_pipe_destroy().
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe Pipe wrapper object to destroy if reference count is 1,
+ * otherwise just decrement the reference count.
+ * */
+#define ccl_pipe_unref(pipe) ccl_pipe_destroy(pipe)
+
+/**
+ * Get the OpenCL pipe object.
+ *
+ * @relates ccl_pipe
+ *
+ * @param[in] pipe The pipe wrapper object.
+ * @return The OpenCL pipe object.
+ * */
+#define ccl_pipe_unwrap(pipe) \
+    ((cl_mem) ccl_wrapper_unwrap((CCLWrapper *) pipe))
+
+/** @} */
+
+#endif
@@ -0,0 +1,576 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of multi-stage pipelines.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_pipeline.h"
+#include "ccl_host_task.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Host task argument of a host stage for a slot.
+ * */
+struct ccl_pipeline_host_arg {
+
+    /**
+     * Pipeline stage.
+     * @private
+     * */
+    struct ccl_pipeline_stage * stage;
+
+    /**
+     * Slot of item.
+     * @private
+     * */
+    cl_uint slot;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief A pipeline stage.
+ * */
+struct ccl_pipeline_stage {
+
+    /**
+     * Stage name, used as name of the stage events (interned string), or
+     * `NULL`.
+     * @private
+     * */
+    const char * name;
+
+    /**
+     * In-order command queue of stage.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Function of device stages, or `NULL`.
+     * @private
+     * */
+    ccl_pipeline_device_fn device_fn;
+
+    /**
+     * Function of host stages, or `NULL`.
+     * @private
+     * */
+    ccl_pipeline_host_fn host_fn;
+
+    /**
+     * User data passed to stage function.
+     * @private
+     * */
+    void * user_data;
+
+    /**
+     * Host task arguments, one per slot, for host stages.
+     * @private
+     * */
+    struct ccl_pipeline_host_arg * host_args;
+
+};
+
+/**
+ * Multi-stage pipeline class.
+ * */
+struct ccl_pipeline {
+
+    /**
+     * Context of stage queues.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Device of stage queues.
+     * @private
+     * */
+    CCLDevice * dev;
+
+    /**
+     * Properties of stage queues.
+     * @private
+     * */
+    cl_command_queue_properties properties;
+
+    /**
+     * Number of slots, i.e. maximum number of items in flight.
+     * @private
+     * */
+    cl_uint num_slots;
+
+    /**
+     * Stages of pipeline, in order.
+     * @private
+     * */
+    GPtrArray * stages;
+
+    /**
+     * Event of the last stage of the item in flight in each slot, or
+     * `NULL` if slot is free.
+     * @private
+     * */
+    CCLEvent ** slot_evts;
+
+    /**
+     * Number of items pushed into the pipeline.
+     * @private
+     * */
+    cl_ulong num_items;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Destroy a pipeline stage. Compatible with `GDestroyNotify`.
+ *
+ * @param[in] data A pipeline stage.
+ * */
+static void ccl_pipeline_stage_destroy(gpointer data) {
+
+    struct ccl_pipeline_stage * stage = (struct ccl_pipeline_stage *) data;
+
+    ccl_queue_destroy(stage->cq);
+    g_free(stage->host_args);
+    g_slice_free(struct ccl_pipeline_stage, stage);
+}
+
+/**
+ * @internal
+ *
+ * @brief Host task function which runs a host stage for a slot.
+ *
+ * @param[in] user_data Host task argument of stage.
+ * @return Execution status returned by host stage function.
+ * */
+static cl_int CL_CALLBACK ccl_pipeline_host_run(void * user_data) {
+
+    struct ccl_pipeline_host_arg * arg =
+        (struct ccl_pipeline_host_arg *) user_data;
+
+    return arg->stage->host_fn(arg->slot, arg->stage->user_data);
+}
+
+/**
+ * @internal
+ *
+ * @brief Add a stage to a pipeline, creating its command queue.
+ *
+ * @param[in] pl A multi-stage pipeline.
+ * @param[in] name Stage name, or `NULL`.
+ * @param[in] device_fn Function of device stage, or `NULL`.
+ * @param[in] host_fn Function of host stage, or `NULL`.
+ * @param[in] user_data User data passed to stage function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_pipeline_add_stage(CCLPipeline * pl, const char * name,
+    ccl_pipeline_device_fn device_fn, ccl_pipeline_host_fn host_fn,
+    void * user_data, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLQueue * cq;
+    struct ccl_pipeline_stage * stage;
+
+    /* Create in-order queue of stage. */
+    cq = ccl_queue_new(pl->ctx, pl->dev,
+        pl->properties & ~CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create stage. */
+    stage = g_slice_new0(struct ccl_pipeline_stage);
+    stage->name = name != NULL ? g_intern_string(name) : NULL;
+    stage->cq = cq;
+    stage->device_fn = device_fn;
+    stage->host_fn = host_fn;
+    stage->user_data = user_data;
+    if (host_fn != NULL) {
+        stage->host_args =
+            g_new(struct ccl_pipeline_host_arg, pl->num_slots);
+        for (cl_uint i = 0; i < pl->num_slots; ++i) {
+            stage->host_args[i].stage = stage;
+            stage->host_args[i].slot = i;
+        }
+    }
+    g_ptr_array_add(pl->stages, stage);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @addtogroup CCL_PIPELINE
+ * @{
+ */
+
+/**
+ * Create a new multi-stage pipeline, without stages.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] ctx Context wrapper object, which is kept alive by the
+ * pipeline.
+ * @param[in] dev Device in which the command queues of stages are
+ * created.
+ * @param[in] properties Properties of the command queues of stages, e.g.
+ * `CL_QUEUE_PROFILING_ENABLE`. Queues are always in-order.
+ * @param[in] num_slots Maximum number of items in flight, or 0 to use
+ * ::CCL_PIPELINE_NUM_SLOTS.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new pipeline, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLPipeline * ccl_pipeline_new(CCLContext * ctx, CCLDevice * dev,
+    cl_command_queue_properties properties, cl_uint num_slots,
+    CCLErr ** err) {
+
+    /* Make sure ctx and dev are not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    g_return_val_if_fail(dev != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLPipeline * pl = g_slice_new0(CCLPipeline);
+
+    ccl_context_ref(ctx);
+    pl->ctx = ctx;
+    pl->dev = dev;
+    pl->properties = properties;
+    pl->num_slots = num_slots > 0 ? num_slots : CCL_PIPELINE_NUM_SLOTS;
+    pl->stages = g_ptr_array_new_with_free_func(ccl_pipeline_stage_destroy);
+    pl->slot_evts = g_new0(CCLEvent *, pl->num_slots);
+
+    return pl;
+}
+
+/**
+ * Destroy a multi-stage pipeline and its command queues, releasing its
+ * context. Items in flight are waited for, ignoring their errors.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl The pipeline to destroy.
+ * */
+CCL_EXPORT
+void ccl_pipeline_destroy(CCLPipeline * pl) {
+
+    /* Make sure pl is not NULL. */
+    g_return_if_fail(pl != NULL);
+
+    /* Host stages may still use the pipeline, so finish all queues. */
+    for (guint i = 0; i < pl->stages->len; ++i)
+        ccl_queue_finish(((struct ccl_pipeline_stage *)
+            g_ptr_array_index(pl->stages, i))->cq, NULL);
+
+    for (cl_uint i = 0; i < pl->num_slots; ++i)
+        if (pl->slot_evts[i] != NULL)
+            ccl_event_destroy(pl->slot_evts[i]);
+    g_free(pl->slot_evts);
+    g_ptr_array_free(pl->stages, TRUE);
+    ccl_context_unref(pl->ctx);
+    g_slice_free(CCLPipeline, pl);
+}
+
+/**
+ * Add a device stage to a pipeline, after the stages added so far. The
+ * stage gets its own command queue.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline, into which no items were pushed.
+ * @param[in] name Stage name, used as name of the stage events for
+ * profiling purposes, or `NULL`.
+ * @param[in] fn Function which enqueues the commands of the stage.
+ * @param[in] user_data User data passed to `fn`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_pipeline_add_device_stage(CCLPipeline * pl, const char * name,
+    ccl_pipeline_device_fn fn, void * user_data, CCLErr ** err) {
+
+    /* Make sure pl is not NULL and no items were pushed. */
+    g_return_val_if_fail(pl != NULL, CL_FALSE);
+    g_return_val_if_fail(pl->num_items == 0, CL_FALSE);
+    /* Make sure fn is not NULL. */
+    g_return_val_if_fail(fn != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    return ccl_pipeline_add_stage(pl, name, fn, NULL, user_data, err);
+}
+
+/**
+ * Add a host stage to a pipeline, after the stages added so far. The
+ * stage gets its own command queue, in which it runs as a host task.
+ *
+ * @public @memberof ccl_pipeline
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] pl A multi-stage pipeline, into which no items were pushed.
+ * @param[in] name Stage name, used as name of the stage events for
+ * profiling purposes, or `NULL`.
+ * @param[in] fn Function which processes items in the host.
+ * @param[in] user_data User data passed to `fn`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_pipeline_add_host_stage(CCLPipeline * pl, const char * name,
+    ccl_pipeline_host_fn fn, void * user_data, CCLErr ** err) {
+
+    /* Make sure pl is not NULL and no items were pushed. */
+    g_return_val_if_fail(pl != NULL, CL_FALSE);
+    g_return_val_if_fail(pl->num_items == 0, CL_FALSE);
+    /* Make sure fn is not NULL. */
+    g_return_val_if_fail(fn != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    return ccl_pipeline_add_stage(pl, name, NULL, fn, user_data, err);
+}
+
+/**
+ * Start a new item through all the stages of a pipeline.
+ *
+ * The stages of the item are enqueued in their command queues, each one
+ * waiting for the previous stage of the item, so that this function
+ * doesn't wait for the item to be processed. However, if all slots are
+ * in use, this function first waits for the last stage of the oldest
+ * item in flight, whose slot is then given to the new item.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline with at least one stage.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise. After an error, the pipeline should only be destroyed.
+ * */
+CCL_EXPORT
+cl_bool ccl_pipeline_push(CCLPipeline * pl, CCLErr ** err) {
+
+    /* Make sure pl is not NULL. */
+    g_return_val_if_fail(pl != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status = CL_FALSE;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt = NULL;
+    struct ccl_pipeline_stage * stage;
+    cl_uint slot = (cl_uint) (pl->num_items % pl->num_slots);
+
+    /* Check that pipeline has stages. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, pl->stages->len == 0,
+        CCL_ERROR_ARGS, error_handler, "%s: pipeline has no stages.",
+        CCL_STRD);
+
+    /* Wait for the slot to be free. */
+    if (pl->slot_evts[slot] != NULL) {
+        ccl_event_wait(
+            ccl_ewl(&ewl, pl->slot_evts[slot], NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_destroy(pl->slot_evts[slot]);
+        pl->slot_evts[slot] = NULL;
+    }
+
+    /* Enqueue stages, each one waiting for the previous one. */
+    for (guint i = 0; i < pl->stages->len; ++i) {
+        stage = g_ptr_array_index(pl->stages, i);
+        if (evt != NULL) ccl_ewl(&ewl, evt, NULL);
+        if (stage->host_fn != NULL) {
+            evt = ccl_enqueue_host_task(stage->cq, ccl_pipeline_host_run,
+                &stage->host_args[slot], &ewl, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        } else {
+            if (ccl_event_wait_list_get_num_events(&ewl) > 0) {
+                ccl_enqueue_barrier(stage->cq, &ewl, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            }
+            evt = stage->device_fn(
+                stage->cq, slot, stage->user_data, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            ccl_if_err_create_goto(*err, CCL_ERROR, evt == NULL,
+                CCL_ERROR_OTHER, error_handler,
+                "%s: device stage function returned no event.", CCL_STRD);
+        }
+        if (stage->name != NULL) ccl_event_set_name(evt, stage->name);
+    }
+
+    /* Keep event of last stage, which frees the slot. */
+    ccl_event_ref(evt);
+    pl->slot_evts[slot] = evt;
+    pl->num_items++;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(&ewl);
+
+    return ret_status;
+}
+
+/**
+ * Wait for all the items in flight in a pipeline to complete their last
+ * stage.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_pipeline_finish(CCLPipeline * pl, CCLErr ** err) {
+
+    /* Make sure pl is not NULL. */
+    g_return_val_if_fail(pl != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    CCLEventWaitList ewl = NULL;
+
+    /* Wait for the items in all slots. */
+    for (cl_uint i = 0; i < pl->num_slots; ++i)
+        if (pl->slot_evts[i] != NULL)
+            ccl_ewl(&ewl, pl->slot_evts[i], NULL);
+    if (ccl_event_wait_list_get_num_events(&ewl) > 0) {
+        ccl_event_wait(&ewl, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Free slots. */
+    for (cl_uint i = 0; i < pl->num_slots; ++i) {
+        if (pl->slot_evts[i] != NULL) {
+            ccl_event_destroy(pl->slot_evts[i]);
+            pl->slot_evts[i] = NULL;
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(&ewl);
+
+    return CL_FALSE;
+}
+
+/**
+ * Get number of items pushed into a pipeline.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline.
+ * @return Number of items pushed into the pipeline.
+ * */
+CCL_EXPORT
+cl_ulong ccl_pipeline_get_num_items(CCLPipeline * pl) {
+
+    /* Make sure pl is not NULL. */
+    g_return_val_if_fail(pl != NULL, 0);
+
+    return pl->num_items;
+}
+
+/**
+ * Get number of slots of a pipeline, i.e. the maximum number of items in
+ * flight.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline.
+ * @return Number of slots.
+ * */
+CCL_EXPORT
+cl_uint ccl_pipeline_get_num_slots(CCLPipeline * pl) {
+
+    /* Make sure pl is not NULL. */
+    g_return_val_if_fail(pl != NULL, 0);
+
+    return pl->num_slots;
+}
+
+/**
+ * Get command queue of a stage of a pipeline, e.g. to inspect the
+ * profiling information of its commands.
+ *
+ * @public @memberof ccl_pipeline
+ *
+ * @param[in] pl A multi-stage pipeline.
+ * @param[in] stage Index of stage, in the order stages were added.
+ * @return Command queue wrapper object, owned by the pipeline.
+ * */
+CCL_EXPORT
+CCLQueue * ccl_pipeline_get_queue(CCLPipeline * pl, cl_uint stage) {
+
+    /* Make sure pl is not NULL. */
+    g_return_val_if_fail(pl != NULL, NULL);
+    /* Make sure stage is valid. */
+    g_return_val_if_fail(stage < pl->stages->len, NULL);
+
+    return ((struct ccl_pipeline_stage *)
+        g_ptr_array_index(pl->stages, stage))->cq;
+}
+
+/** @} */
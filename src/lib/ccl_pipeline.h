@@ -0,0 +1,186 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of multi-stage pipelines.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_PIPELINE_H_
+#define _CCL_PIPELINE_H_
+
+#include "ccl_common.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_device_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_PIPELINE Multi-stage pipelines
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides producer/consumer pipelines, in which a stream of
+ * items, e.g. video frames, goes through a sequence of host and device
+ * stages, with a bounded number of items in flight.
+ *
+ * A pipeline is created with ::ccl_pipeline_new(), which takes the
+ * number of slots, i.e. the maximum number of items in flight (2 for
+ * double buffering, 3 for triple buffering, and so on). Item `i` uses
+ * slot `i % num_slots`, so that stages can keep per-slot buffers. Stages
+ * are added in order with ::ccl_pipeline_add_device_stage(), for
+ * functions which enqueue commands, e.g. transfers or kernels, and with
+ * ::ccl_pipeline_add_host_stage(), for functions which run in the host,
+ * e.g. decoding or encoding. Each stage has its own in-order command
+ * queue, and host stages run as host tasks (see ::ccl_enqueue_host_task())
+ * in that queue.
+ *
+ * Each call to ::ccl_pipeline_push() starts a new item, enqueuing all its
+ * stages, each waiting for the previous stage of the same item, without
+ * blocking the host. Since stages have their own queues, different
+ * stages work on different items at the same time, and throughput
+ * approaches the one of the slowest stage. When all slots are in use,
+ * ::ccl_pipeline_push() blocks until the oldest item in flight completes
+ * its last stage, providing back-pressure. ::ccl_pipeline_finish() waits
+ * for all items in flight. Events of stages are named after their stages
+ * for profiling purposes.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * cl_int decode(cl_uint slot, void * user_data) {
+ *     struct stream * s = (struct stream *) user_data;
+ *     return decode_frame(s, s->frames[slot]) ? CL_COMPLETE : -1;
+ * }
+ * CCLEvent * upload(CCLQueue * cq, cl_uint slot, void * user_data,
+ *     CCLErr ** err) {
+ *     struct stream * s = (struct stream *) user_data;
+ *     return ccl_buffer_enqueue_write(s->bufs[slot], cq, CL_FALSE, 0,
+ *         s->size, s->frames[slot], NULL, err);
+ * }
+ * @endcode
+ * @code{.c}
+ * pl = ccl_pipeline_new(ctx, dev, 0, 3, NULL);
+ * ccl_pipeline_add_host_stage(pl, "decode", decode, &s, NULL);
+ * ccl_pipeline_add_device_stage(pl, "upload", upload, &s, NULL);
+ * ccl_pipeline_add_device_stage(pl, "filter", filter, &s, NULL);
+ * ccl_pipeline_add_device_stage(pl, "download", download, &s, NULL);
+ * ccl_pipeline_add_host_stage(pl, "encode", encode, &s, NULL);
+ * @endcode
+ * @code{.c}
+ * for (frame = 0; frame < num_frames; ++frame)
+ *     ccl_pipeline_push(pl, NULL);
+ * ccl_pipeline_finish(pl, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_pipeline_destroy(pl);
+ * @endcode
+ *
+ * @attention Stage functions of one stage are called in item order, but
+ * host stage functions run in host task threads, so data shared between
+ * stages should be kept per slot. A pipeline must only be used by one
+ * host thread at a time.
+ *
+ * @note Host stages require OpenCL >= 1.1
+ *
+ * @{
+ */
+
+/**
+ * Default number of slots of a pipeline, i.e. triple buffering.
+ * */
+#define CCL_PIPELINE_NUM_SLOTS 3
+
+/**
+ * Multi-stage pipeline class.
+ * */
+typedef struct ccl_pipeline CCLPipeline;
+
+/**
+ * A device stage function, which enqueues the commands of the stage for
+ * an item.
+ *
+ * @param[in] cq Command queue of the stage, in which the commands must be
+ * enqueued. Commands only start after the previous stage of the item
+ * completes.
+ * @param[in] slot Slot of the item.
+ * @param[in] user_data User data given when adding the stage.
+ * @param[out] err Return location for a ::CCLErr object.
+ * @return Event of the last command of the stage, or `NULL` if an error
+ * occurs.
+ * */
+typedef CCLEvent * (*ccl_pipeline_device_fn)(
+    CCLQueue * cq, cl_uint slot, void * user_data, CCLErr ** err);
+
+/**
+ * A host stage function, which processes an item in the host.
+ *
+ * @param[in] slot Slot of the item.
+ * @param[in] user_data User data given when adding the stage.
+ * @return `CL_COMPLETE` if the stage completed successfully, or a
+ * negative integer value, which will be the execution status of the
+ * stage, otherwise.
+ * */
+typedef cl_int (*ccl_pipeline_host_fn)(cl_uint slot, void * user_data);
+
+/* Create a new multi-stage pipeline. */
+CCL_EXPORT
+CCLPipeline * ccl_pipeline_new(CCLContext * ctx, CCLDevice * dev,
+    cl_command_queue_properties properties, cl_uint num_slots,
+    CCLErr ** err);
+
+/* Destroy a multi-stage pipeline, waiting for items in flight. */
+CCL_EXPORT
+void ccl_pipeline_destroy(CCLPipeline * pl);
+
+/* Add a device stage to a pipeline. */
+CCL_EXPORT
+cl_bool ccl_pipeline_add_device_stage(CCLPipeline * pl, const char * name,
+    ccl_pipeline_device_fn fn, void * user_data, CCLErr ** err);
+
+/* Add a host stage to a pipeline. */
+CCL_EXPORT
+cl_bool ccl_pipeline_add_host_stage(CCLPipeline * pl, const char * name,
+    ccl_pipeline_host_fn fn, void * user_data, CCLErr ** err);
+
+/* Start a new item through all the stages of a pipeline. */
+CCL_EXPORT
+cl_bool ccl_pipeline_push(CCLPipeline * pl, CCLErr ** err);
+
+/* Wait for all the items in flight in a pipeline. */
+CCL_EXPORT
+cl_bool ccl_pipeline_finish(CCLPipeline * pl, CCLErr ** err);
+
+/* Get number of items pushed into a pipeline. */
+CCL_EXPORT
+cl_ulong ccl_pipeline_get_num_items(CCLPipeline * pl);
+
+/* Get number of slots of a pipeline. */
+CCL_EXPORT
+cl_uint ccl_pipeline_get_num_slots(CCLPipeline * pl);
+
+/* Get command queue of a stage of a pipeline. */
+CCL_EXPORT
+CCLQueue * ccl_pipeline_get_queue(CCLPipeline * pl, cl_uint stage);
+
+/** @} */
+
+#endif
@@ -160,7 +160,7 @@ cl_uint ccl_platform_get_opencl_version(CCLPlatform * platf, CCLErr ** err);
  * If an error occurs, zero is returned.
  * */
 #define ccl_platform_get_info_scalar(platf, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) platf, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) platf, \
         NULL, param_name, sizeof(param_type), \
         CCL_INFO_PLATFORM, CL_FALSE, err))
 
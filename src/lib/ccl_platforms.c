@@ -27,7 +27,11 @@
  * */
 
 #include "ccl_platforms.h"
+#include "_ccl_platforms.h"
 #include "_ccl_defs.h"
+#ifdef CCL_OCL_DLOPEN
+    #include "_ccl_ocl_loader.h"
+#endif
 
 /**
  * Class which represents the OpenCL platforms available
@@ -49,80 +53,145 @@ struct ccl_platforms {
 };
 
 /**
- * @addtogroup CCL_PLATFORMS
- * @{
- */
+ * @internal
+ *
+ * @brief Process-wide snapshot of the OpenCL platforms and devices
+ * available in the system.
+ * */
+struct ccl_platforms_snapshot {
+
+    /**
+     * Has the snapshot been built?
+     * @private
+     * */
+    gboolean valid;
+
+    /**
+     * IDs of platforms available in the system.
+     * @private
+     * */
+    cl_platform_id * platf_ids;
+
+    /**
+     * Number of platforms available in the system.
+     * @private
+     * */
+    cl_uint num_platfs;
+
+    /**
+     * IDs of devices available in the system, in platform order.
+     * @private
+     * */
+    cl_device_id * dev_ids;
+
+    /**
+     * Number of devices available in the system.
+     * @private
+     * */
+    cl_uint num_devs;
+};
+
+/* Discovery snapshot of platforms and devices. */
+static struct ccl_platforms_snapshot snapshot;
+
+/* Lock protecting the discovery snapshot. */
+static GMutex snapshot_lock;
 
 /**
- * Creates a new ::CCLPlatforms* object, which contains the list
- * of OpenCL platforms available in the system.
+ * @internal
  *
- * @public @memberof ccl_platforms
+ * @brief Discard the discovery snapshot. Must be called with
+ * `snapshot_lock` held.
+ * */
+static void ccl_platforms_snapshot_clear() {
+
+    g_free(snapshot.platf_ids);
+    g_free(snapshot.dev_ids);
+    snapshot.platf_ids = NULL;
+    snapshot.dev_ids = NULL;
+    snapshot.num_platfs = 0;
+    snapshot.num_devs = 0;
+    snapshot.valid = FALSE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Enumerate platforms and devices through the ICD loader and keep
+ * their IDs in the discovery snapshot, if it has not yet been built. Must
+ * be called with `snapshot_lock` held.
  *
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return A new ::CCLPlatforms object, or `NULL` in case an error occurs.
+ * @return `CL_TRUE` if snapshot is valid, `CL_FALSE` otherwise.
  * */
-CCL_EXPORT
-CCLPlatforms * ccl_platforms_new(CCLErr ** err) {
-
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+static cl_bool ccl_platforms_snapshot_build(CCLErr ** err) {
 
     /* Return status of OpenCL functions. */
     cl_int ocl_status;
 
-    /* Object which represents the list of OpenCL platforms available
-     * in the system. */
-    CCLPlatforms * platforms = NULL;
+    /* Number of devices in current platform. */
+    cl_uint num_devs;
 
-    /* Size in bytes of array of platform IDs. */
-    gsize platf_ids_size;
+    /* Function return status. */
+    cl_bool ret_status;
 
-    /* Array of platform IDs. */
-    cl_platform_id * platf_ids = NULL;
+    /* Nothing to do if snapshot is already built. */
+    if (snapshot.valid) return CL_TRUE;
 
-    /* Allocate memory for the CCLPlatforms object. */
-    platforms = g_slice_new0(CCLPlatforms);
+#ifdef CCL_OCL_DLOPEN
+    /* Report a missing OpenCL library as such, and not as a generic
+     * OpenCL error. */
+    if (!ccl_ocl_loader_check(err)) goto error_handler;
+#endif
 
     /* Get number of platforms */
-    ocl_status = clGetPlatformIDs(0, NULL, &platforms->num_platfs);
+    ocl_status = clGetPlatformIDs(0, NULL, &snapshot.num_platfs);
     ccl_if_err_create_goto(*err, CCL_ERROR,
-        platforms->num_platfs == 0, CCL_ERROR_DEVICE_NOT_FOUND,
+        snapshot.num_platfs == 0, CCL_ERROR_DEVICE_NOT_FOUND,
         error_handler, "%s: no OpenCL platforms found.", CCL_STRD);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: get number of platforms (OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
-    /* Determine size in bytes of array of platform IDs. */
-    platf_ids_size = sizeof(cl_platform_id) * platforms->num_platfs;
-
-    /* Allocate memory for array of platform IDs. */
-    platf_ids = (cl_platform_id *) g_slice_alloc(platf_ids_size);
-
     /* Get existing platform IDs. */
-    ocl_status = clGetPlatformIDs(platforms->num_platfs, platf_ids, NULL);
+    snapshot.platf_ids = g_new(cl_platform_id, snapshot.num_platfs);
+    ocl_status = clGetPlatformIDs(
+        snapshot.num_platfs, snapshot.platf_ids, NULL);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
         "%s: get platforms IDs (OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
-    /* Allocate memory for array of platform wrapper objects. */
-    platforms->platfs =
-        g_slice_alloc(sizeof(CCLPlatform *) * platforms->num_platfs);
-
-    /* Wrap platform IDs in platform wrapper objects. */
-    for (guint i = 0; i < platforms->num_platfs; i++) {
-        /* Add platform wrapper object to array of wrapper objects. */
-        platforms->platfs[i] = ccl_platform_new_wrap(platf_ids[i]);
+    /* Get device IDs of each platform, skipping platforms without
+     * devices. */
+    for (cl_uint i = 0; i < snapshot.num_platfs; ++i) {
+
+        ocl_status = clGetDeviceIDs(snapshot.platf_ids[i],
+            CL_DEVICE_TYPE_ALL, 0, NULL, &num_devs);
+        if (ocl_status == CL_DEVICE_NOT_FOUND) continue;
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: get number of devices (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+        snapshot.dev_ids = g_renew(
+            cl_device_id, snapshot.dev_ids, snapshot.num_devs + num_devs);
+        ocl_status = clGetDeviceIDs(snapshot.platf_ids[i],
+            CL_DEVICE_TYPE_ALL, num_devs,
+            snapshot.dev_ids + snapshot.num_devs, NULL);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: get device IDs (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+        snapshot.num_devs += num_devs;
     }
 
-    /* Free array of platform ids. */
-    g_slice_free1(platf_ids_size, platf_ids);
-
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
+    snapshot.valid = TRUE;
+    ret_status = CL_TRUE;
     goto finish;
 
 error_handler:
@@ -130,12 +199,113 @@ error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
 
-    /* Destroy the CCLPlatforms object (no need to check for NULL since to get
-     * here, the object must have been created). */
-    ccl_platforms_destroy(platforms);
+    /* Discard partially built snapshot. */
+    ccl_platforms_snapshot_clear();
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the IDs of all devices in the discovery snapshot, building the
+ * snapshot if required.
+ *
+ * @param[out] num_devs Location where to put the number of devices.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A copy of the array of device IDs, which should be freed with
+ * g_free(), or `NULL` if an error occurs or if there are no devices.
+ * */
+cl_device_id * ccl_platforms_get_snapshot_devices(
+    cl_uint * num_devs, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    cl_device_id * dev_ids = NULL;
+
+    g_mutex_lock(&snapshot_lock);
+    if (ccl_platforms_snapshot_build(err)) {
+        *num_devs = snapshot.num_devs;
+        dev_ids = g_new(cl_device_id, snapshot.num_devs);
+        for (cl_uint i = 0; i < snapshot.num_devs; ++i)
+            dev_ids[i] = snapshot.dev_ids[i];
+    } else {
+        *num_devs = 0;
+    }
+    g_mutex_unlock(&snapshot_lock);
+
+    return dev_ids;
+}
+
+/**
+ * @addtogroup CCL_PLATFORMS
+ * @{
+ */
+
+/**
+ * Creates a new ::CCLPlatforms* object, which contains the list
+ * of OpenCL platforms available in the system.
+ *
+ * Platforms are enumerated through the ICD loader only once per process,
+ * the first time platforms or devices are requested. The resulting
+ * snapshot is reused by this function, by the device selector and by the
+ * context constructors, until ::ccl_platforms_refresh() is called.
+ *
+ * @public @memberof ccl_platforms
+ *
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new ::CCLPlatforms object, or `NULL` in case an error occurs.
+ * */
+CCL_EXPORT
+CCLPlatforms * ccl_platforms_new(CCLErr ** err) {
 
-    /* Set platforms to NULL, indicating an error occurred.*/
-    platforms = NULL;
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Object which represents the list of OpenCL platforms available
+     * in the system. */
+    CCLPlatforms * platforms = NULL;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Get discovery snapshot, building it if required. */
+    g_mutex_lock(&snapshot_lock);
+    if (ccl_platforms_snapshot_build(&err_internal)) {
+
+        /* Allocate memory for the CCLPlatforms object. */
+        platforms = g_slice_new0(CCLPlatforms);
+        platforms->num_platfs = snapshot.num_platfs;
+
+        /* Allocate memory for array of platform wrapper objects. */
+        platforms->platfs =
+            g_slice_alloc(sizeof(CCLPlatform *) * platforms->num_platfs);
+
+        /* Wrap platform IDs in platform wrapper objects. */
+        for (guint i = 0; i < platforms->num_platfs; i++) {
+            /* Add platform wrapper object to array of wrapper objects. */
+            platforms->platfs[i] =
+                ccl_platform_new_wrap(snapshot.platf_ids[i]);
+        }
+    }
+    g_mutex_unlock(&snapshot_lock);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
 
 finish:
 
@@ -211,4 +381,33 @@ CCLPlatform * ccl_platforms_get(CCLPlatforms * platforms, cl_uint index) {
     return platforms->platfs[index];
 }
 
+/**
+ * Discard the process-wide snapshot of OpenCL platforms and devices and
+ * enumerate them again through the ICD loader, e.g. after devices have
+ * been added to or removed from the system. Existing ::CCLPlatforms
+ * objects and wrappers are not affected.
+ *
+ * @public @memberof ccl_platforms
+ *
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if platforms and devices were successfully enumerated,
+ * `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_platforms_refresh(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    cl_bool ret_status;
+
+    g_mutex_lock(&snapshot_lock);
+    ccl_platforms_snapshot_clear();
+    ret_status = ccl_platforms_snapshot_build(err);
+    g_mutex_unlock(&snapshot_lock);
+
+    return ret_status;
+}
+
 /** @} */
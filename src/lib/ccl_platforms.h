@@ -44,6 +44,12 @@
  * get the number of platforms in the list, while the
  * ::ccl_platforms_get() will return the @f$i^{th}@f$ platform.
  *
+ * Platforms and devices are enumerated only once per process, and the
+ * resulting snapshot is shared by ::ccl_platforms_new(), the
+ * @ref CCL_DEVICE_SELECTOR "device selector" and the context
+ * constructors. The ::ccl_platforms_refresh() function enumerates them
+ * again.
+ *
  *  _Example:_
  *
  * @dontinclude list_devices.c
@@ -88,6 +94,11 @@ cl_uint ccl_platforms_count(CCLPlatforms * platforms);
 CCL_EXPORT
 CCLPlatform * ccl_platforms_get(CCLPlatforms * platforms, cl_uint index);
 
+/* Enumerate OpenCL platforms and devices again, discarding the
+ * process-wide discovery snapshot. */
+CCL_EXPORT
+cl_bool ccl_platforms_refresh(CCLErr ** err);
+
 /** @} */
 
 #endif
@@ -27,7 +27,16 @@
  * */
 
 #include "ccl_profiler.h"
+#include "_ccl_queue_wrapper.h"
+#include "_ccl_event_wrapper.h"
+#include "_ccl_host_trace.h"
+#include "_ccl_future.h"
 #include "_ccl_defs.h"
+#include <math.h>
+
+#ifdef CCL_PROF_ZLIB
+#include <zlib.h>
+#endif
 
 /**
  * @internal
@@ -85,6 +94,251 @@ typedef struct ccl_prof_sort_data {
 
 } CCLProfSort;
 
+/**
+ * @internal
+ *
+ * Time interval in which an event used device time, used when determining
+ * event overlaps.
+ * */
+typedef struct ccl_prof_interval {
+
+    /** Event name. */
+    const char * event_name;
+
+    /** Event name ID. */
+    cl_uint ueid;
+
+    /** Drain in which the event was processed (zero if profiling is not
+     * incremental). */
+    cl_uint gen;
+
+    /** Event start instant. */
+    cl_ulong start;
+
+    /** Event end instant. */
+    cl_ulong end;
+
+} CCLProfInterval;
+
+/**
+ * @internal
+ *
+ * Start or end instant of a ::CCLProfInterval, used when sweeping through
+ * event intervals.
+ * */
+typedef struct ccl_prof_endpoint {
+
+    /** Instant. */
+    cl_ulong instant;
+
+    /** Index of interval. */
+    guint idx;
+
+    /** Is this the end instant of the interval? */
+    gboolean end;
+
+} CCLProfEndpoint;
+
+/**
+ * @internal
+ *
+ * Profiled command in the graph of command dependencies, used when
+ * determining the critical path.
+ * */
+typedef struct ccl_prof_node {
+
+    /** OpenCL event of command. */
+    cl_event event;
+
+    /** Recorded dependencies of command. */
+    cl_event * deps;
+
+    /** Number of recorded dependencies. */
+    cl_uint num_deps;
+
+    /** Index of previous command in the same in-order queue, or -1. */
+    gint prev;
+
+    /** Index of command profiling information in ::CCLProf::infos. */
+    guint info;
+
+} CCLProfNode;
+
+/**
+ * @internal
+ *
+ * Utilization of a command queue or device, with the state required
+ * for determining it over events sorted by start time.
+ * */
+typedef struct ccl_prof_util_acc {
+
+    /** Utilization, kept as first member so it can be returned to
+     * client code. */
+    CCLProfUtil util;
+
+    /** Start of first event. */
+    cl_ulong t_first;
+
+    /** Latest end of events so far. */
+    cl_ulong t_last;
+
+    /** Was any event added? */
+    gboolean started;
+
+} CCLProfUtilAcc;
+
+/**
+ * @internal
+ *
+ * Raw profiling data of an event, as fetched from OpenCL.
+ * */
+typedef struct ccl_prof_raw {
+
+    /** Event wrapper. */
+    CCLEvent * evt;
+
+    /** Queued, submit, start and end instants. */
+    cl_ulong instants[4];
+
+    /** Type of command which produced the event. */
+    cl_command_type command_type;
+
+    /** OpenCL status of fetch. */
+    cl_int status;
+
+} CCLProfRaw;
+
+/**
+ * @internal
+ *
+ * Fetching of raw profiling data of the events in a command queue.
+ * */
+typedef struct ccl_prof_fetch_task {
+
+    /** Command queue name. */
+    const char * cq_name;
+
+    /** Command queue wrapper. */
+    CCLQueue * cq;
+
+    /** Is the command queue in-order? */
+    gboolean in_order;
+
+    /** Raw profiling data of queue events (array of ::CCLProfRaw), or
+     * `NULL` if events are to be fetched while they are added. */
+    GArray * raws;
+
+} CCLProfFetchTask;
+
+/**
+ * @internal
+ *
+ * @brief Number of bits of histogram sub-buckets. Event durations are
+ * kept with a relative error below 1 / 2^CCL_PROF_HIST_SUB_BITS.
+ * */
+#define CCL_PROF_HIST_SUB_BITS 6
+
+/**
+ * @internal
+ *
+ * Log-linear (HDR-style) histogram of event durations, used for
+ * determining percentiles in bounded memory.
+ * */
+typedef struct ccl_prof_hist {
+
+    /** Event name, since aggregate statistics may be reordered. */
+    const char * event_name;
+
+    /** Counts per bucket (array of `guint`), grown as required. */
+    GArray * counts;
+
+    /** Running mean of event durations. */
+    double mean;
+
+    /** Running sum of squared differences from the mean. */
+    double m2;
+
+    /** Number of events seen, including events not sampled. */
+    guint seen;
+
+    /** Number of events sampled. */
+    guint sampled;
+
+    /** Sum of durations of events in histogram. */
+    cl_ulong total_time;
+
+    /** Sum of latencies, from queued to start instants, of sampled
+     * events. */
+    cl_ulong total_latency;
+
+    /** Sums of performance counters of sampled events (array of
+     * `double`), or `NULL` if no counters were collected. */
+    double * counters;
+
+    /** Sum of durations of sampled events for which counters were
+     * collected. */
+    cl_ulong counters_time;
+
+    /** Sum of occupancies of sampled events, weighted by duration. */
+    double occupancy_time;
+
+    /** Slowest sampled events (array of ::CCLProfSlow), kept as a
+     * min-heap of durations, or `NULL` if not kept. */
+    GArray * slowest;
+
+    /** Are the slowest events sorted by decreasing duration instead of
+     * being kept as a min-heap? */
+    cl_bool slowest_sorted;
+
+} CCLProfHist;
+
+/**
+ * @internal
+ *
+ * Live busy time of a command queue, updated as events are added for
+ * profiling, for the purpose of exporting metrics.
+ * */
+typedef struct ccl_prof_queue_live {
+
+    /** Sum of durations of events. */
+    cl_ulong busy_time;
+
+    /** Start of earliest event. */
+    cl_ulong t_first;
+
+    /** End of latest event. */
+    cl_ulong t_last;
+
+} CCLProfQueueLive;
+
+/**
+ * @internal
+ *
+ * Statistics of the host-side calls of a wrapper function.
+ * */
+typedef struct ccl_prof_host_call {
+
+    /** Aggregate statistics, where the event name is the function name. */
+    CCLProfAgg agg;
+
+    /** Histogram of call durations. */
+    CCLProfHist hist;
+
+} CCLProfHostCall;
+
+/**
+ * @internal
+ * Statistics of host-side calls of wrapper functions (keys: function
+ * names; values: ::CCLProfHostCall*), shared by all threads.
+ * */
+static GHashTable * host_calls = NULL;
+
+/**
+ * @internal
+ * Mutex protecting the statistics of host-side calls.
+ * */
+static GMutex host_calls_mutex;
+
 /**
  * Profile class, contains profiling information of OpenCL queues and events.
  *
@@ -102,7 +356,8 @@ struct ccl_prof {
 
     /**
      * Hash table with keys equal to the events name, and values
-     * equal to a unique id for each event name.
+     * equal to a unique id for each event name. Since event names are
+     * interned, keys are hashed and compared by pointer.
      * @private
      * */
     GHashTable * event_names;
@@ -126,53 +381,148 @@ struct ccl_prof {
     cl_uint num_events;
 
     /**
-     * Instants (start and end) of all events.
+     * Instants (start and end) of all events (array of ::CCLProfInst).
      * @private
      * */
-    GList * instants;
+    GArray * instants;
 
     /**
-     * List of all events profiling information.
+     * Array of all events profiling information (array of
+     * ::CCLProfInfo).
      * @private
      * */
-    GList * infos;
+    GArray * infos;
 
     /**
      * Aggregate statistics for all events in
-     * ::CCLProf::instants.
+     * ::CCLProf::instants (array of ::CCLProfAgg).
+     * @private
+     * */
+    GArray * aggs;
+
+    /**
+     * Histograms of event durations (array of ::CCLProfHist), with the
+     * same indexes as ::CCLProf::aggs before it is sorted.
+     * @private
+     * */
+    GArray * hists;
+
+    /**
+     * Array of event overlaps (array of ::CCLProfOverlap).
+     * @private
+     * */
+    GArray * overlaps;
+
+    /**
+     * Profiled commands in the graph of command dependencies (array of
+     * ::CCLProfNode), kept until calculations are made.
+     * @private
+     * */
+    GArray * nodes;
+
+    /**
+     * Slacks of profiled commands (array of ::CCLProfSlack).
+     * @private
+     * */
+    GArray * slacks;
+
+    /**
+     * Duration of the critical path.
+     * @private
+     * */
+    cl_ulong crit_duration;
+
+    /**
+     * Utilization of command queues (keys: queue names; values:
+     * ::CCLProfUtilAcc*).
+     * @private
+     * */
+    GHashTable * queue_utils;
+
+    /**
+     * Utilization of devices (keys: OpenCL device IDs; values:
+     * ::CCLProfUtilAcc*).
+     * @private
+     * */
+    GHashTable * device_utils;
+
+    /**
+     * Live busy time of command queues (keys: queue names; values:
+     * ::CCLProfQueueLive*).
+     * @private
+     * */
+    GHashTable * queue_live;
+
+    /**
+     * Statistics of host-side calls of wrapper functions, copied when
+     * calculations are made (array of ::CCLProfAgg).
+     * @private
+     * */
+    GArray * host_aggs;
+
+    /**
+     * Host-side ranges, in the order they were pushed until calculations
+     * are made (array of ::CCLProfRange).
+     * @private
+     * */
+    GArray * ranges;
+
+    /**
+     * Index of the enclosing range of each host-side range, or `G_MAXUINT`
+     * for outermost ranges, with the same indexes as ::CCLProf::ranges
+     * before it is sorted (array of `guint`).
+     * @private
+     * */
+    GArray * range_parents;
+
+    /**
+     * Indexes of currently open host-side ranges, innermost last (array
+     * of `guint`).
+     * @private
+     * */
+    GArray * range_stack;
+
+    /**
+     * Aggregate event statistics iterator (index in array).
+     * @private
+     * */
+    guint agg_iter;
+
+    /**
+     * Event info iterator (index in array).
      * @private
      * */
-    GList * aggs;
+    guint info_iter;
 
     /**
-     * List of event overlaps.
+     * Event instant iterator (index in array).
      * @private
      * */
-    GList * overlaps;
+    guint inst_iter;
 
     /**
-     * Aggregate event statistics iterator.
+     * Overlaps iterator (index in array).
      * @private
      * */
-    GList * agg_iter;
+    guint overlap_iter;
 
     /**
-     * Event info iterator.
+     * Command slacks iterator (index in array).
      * @private
      * */
-    GList * info_iter;
+    guint slack_iter;
 
     /**
-     * Event instant iterator.
+     * Host-side call statistics iterator (index in array).
      * @private
      * */
-    GList * inst_iter;
+    guint host_iter;
 
     /**
-     * Overlaps iterator.
+     * Host-side ranges iterator (index in array).
      * @private
      * */
-    GList * overlap_iter;
+    guint range_iter;
 
     /**
      * Total time taken by all events.
@@ -192,6 +542,132 @@ struct ccl_prof {
      * */
     cl_ulong t_start;
 
+    /**
+     * Sparse event overlap accumulator (keys: pairs of event name IDs;
+     * values: ::CCLProfOverlap objects).
+     * @private
+     * */
+    GHashTable * overlap_acc;
+
+    /**
+     * Total overlap time.
+     * @private
+     * */
+    cl_ulong total_overlap;
+
+    /**
+     * Number of times terminated events were drained from the command
+     * queues with ccl_prof_drain().
+     * @private
+     * */
+    cl_uint drains;
+
+    /**
+     * Intervals of drained events which may still overlap with events not
+     * yet drained.
+     * @private
+     * */
+    GArray * window;
+
+    /**
+     * Table of events not yet drained (keys: event wrappers; values:
+     * first drain in which the event was pending).
+     * @private
+     * */
+    GHashTable * pending;
+
+    /**
+     * Offsets from device clocks to the host timebase, in nanoseconds
+     * (keys: queue names; values: `gint64`), or `NULL` if clocks were not
+     * synchronized with ccl_prof_sync_clocks().
+     * @private
+     * */
+    GHashTable * clock_offsets;
+
+    /**
+     * Sample one in every `sample_period` events of each name (zero or one
+     * if all events are sampled).
+     * @private
+     * */
+    cl_uint sample_period;
+
+    /**
+     * Fraction of randomly sampled events (zero if events are not
+     * randomly sampled).
+     * @private
+     * */
+    double sample_fraction;
+
+    /**
+     * Random number generator for random sampling.
+     * @private
+     * */
+    GRand * sample_rand;
+
+    /**
+     * Ratio between estimated and sampled total time of all events.
+     * @private
+     * */
+    double sample_scale;
+
+    /**
+     * Number of performance counters collected per command.
+     * @private
+     * */
+    cl_uint num_counters;
+
+    /**
+     * Names of performance counters (`NULL`-terminated).
+     * @private
+     * */
+    gchar ** counter_names;
+
+    /**
+     * Function which collects performance counters, or `NULL` if counters
+     * are not collected.
+     * @private
+     * */
+    ccl_prof_counters_fn counters_fn;
+
+    /**
+     * User data passed to ::CCLProf::counters_fn.
+     * @private
+     * */
+    void * counters_data;
+
+    /**
+     * Index of the ::CCL_PROF_COUNTER_BYTES counter, or -1 if not given.
+     * @private
+     * */
+    gint counter_bytes;
+
+    /**
+     * Index of the ::CCL_PROF_COUNTER_OCCUPANCY counter, or -1 if not
+     * given.
+     * @private
+     * */
+    gint counter_occupancy;
+
+    /**
+     * Performance counters of the command being added.
+     * @private
+     * */
+    double * counter_values;
+
+    /**
+     * Number of slowest instances kept per event name (zero if none are
+     * kept).
+     * @private
+     * */
+    cl_uint slowest_k;
+
+    /**
+     * Background writer to which drained events are streamed, or `NULL`
+     * if events are not streamed.
+     * @private
+     * */
+    CCLProfWriter * writer;
+
     /**
      * Summary string.
      * @private
@@ -215,59 +691,326 @@ static CCLProfExportOptions export_options = {
     .zero_start = CL_TRUE
 };
 
+/** @internal Size of the buffer in which the background writer formats
+ * records before writing them. */
+#define CCL_PROF_WRITER_BUF_SIZE (1 << 20)
+
+/** @internal Number of records passed to the background writer at once. */
+#define CCL_PROF_WRITER_BATCH 4096
+
 /**
  * @internal
  *
- * @brief Create new event instant.
- *
- * @private @memberof ccl_prof_inst
- *
- * @param[in] event_name Name of event.
- * @param[in] queue_name Name of command queue associated with event.
- * @param[in] id Id of event.
- * @param[in] instant Even instant in nanoseconds.
- * @param[in] type Type of event instant: ::CCL_PROF_INST_TYPE_START or
- * ::CCL_PROF_INST_TYPE_END.
- * @return A new event instant.
- */
-static CCLProfInst * ccl_prof_inst_new(const char * event_name,
-    const char * queue_name, cl_uint id, cl_ulong instant,
-    CCLProfInstType type) {
+ * @brief Event record passed to a background profile writer.
+ * */
+typedef struct ccl_prof_writer_rec {
 
-    /* Allocate memory for event instant data structure. */
-    CCLProfInst * inst = g_slice_new(CCLProfInst);
+    /** Name of queue which produced the event (interned). */
+    const char * queue_name;
 
-    /* Initialize structure fields. */
-    inst->event_name = event_name;
-    inst->queue_name = queue_name;
-    inst->id = id;
-    inst->instant = instant;
-    inst->type = type;
+    /** Name of event (interned). */
+    const char * event_name;
+
+    /** Event start and end instants, in nanoseconds. */
+    cl_ulong t_start, t_end;
+
+} CCLProfWriterRec;
+
+/**
+ * Background profile writer class.
+ * */
+struct ccl_prof_writer {
+
+    /**
+     * File where records are written to, if not compressed.
+     * @private
+     * */
+    FILE * fp;
+
+#ifdef CCL_PROF_ZLIB
+    /**
+     * File where records are written to, if compressed.
+     * @private
+     * */
+    gzFile gz;
+#endif
+
+    /**
+     * Export options at the time the writer was created, with owned
+     * strings.
+     * @private
+     * */
+    CCLProfExportOptions opts;
+
+    /**
+     * Batch of records being filled by the producer.
+     * @private
+     * */
+    GArray * batch;
+
+    /**
+     * Batches of records passed to the writer thread, followed by the
+     * writer itself, which signals the end of records.
+     * @private
+     * */
+    GAsyncQueue * batches;
+
+    /**
+     * Writer thread.
+     * @private
+     * */
+    GThread * thread;
+
+    /**
+     * Future completed when all records are written and the file is
+     * closed, or `NULL` if not requested with ccl_prof_writer_finish().
+     * @private
+     * */
+    CCLFuture * fut;
+
+    /**
+     * Was the end of records signaled?
+     * @private
+     * */
+    cl_bool finished;
+
+    /**
+     * First error which occurred in the writer thread, if any.
+     * @private
+     * */
+    CCLErr * err;
+
+    /**
+     * Last queue and event names given by the producer, and their
+     * interned versions.
+     * @private
+     * */
+    const char * last_queue_name, * last_queue_name_int;
+    const char * last_event_name, * last_event_name_int;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Add an event record to the batch being filled by the producer
+ * of a background profile writer, passing the batch to the writer thread
+ * when full.
+ *
+ * @private @memberof ccl_prof_writer
+ *
+ * @param[in] writer Background profile writer.
+ * @param[in] queue_name Name of queue which produced the event.
+ * @param[in] event_name Name of event.
+ * @param[in] t_start Event start instant.
+ * @param[in] t_end Event end instant.
+ * */
+static void ccl_prof_writer_push(CCLProfWriter * writer,
+    const char * queue_name, const char * event_name, cl_ulong t_start,
+    cl_ulong t_end) {
+
+    CCLProfWriterRec rec;
 
-    /* Return event instant data structure. */
-    return inst;
+    /* Names are interned, since the profile object may be destroyed
+     * before records are written. Consecutive records mostly have the
+     * same names, so avoid looking them up again. */
+    if (queue_name != writer->last_queue_name) {
+        writer->last_queue_name = queue_name;
+        writer->last_queue_name_int = g_intern_string(queue_name);
+    }
+    if (event_name != writer->last_event_name) {
+        writer->last_event_name = event_name;
+        writer->last_event_name_int = g_intern_string(event_name);
+    }
+    rec.queue_name = writer->last_queue_name_int;
+    rec.event_name = writer->last_event_name_int;
+    rec.t_start = t_start;
+    rec.t_end = t_end;
+
+    if (writer->batch == NULL)
+        writer->batch = g_array_sized_new(
+            FALSE, FALSE, sizeof(CCLProfWriterRec), CCL_PROF_WRITER_BATCH);
+    g_array_append_val(writer->batch, rec);
+
+    if (writer->batch->len >= CCL_PROF_WRITER_BATCH) {
+        g_async_queue_push(writer->batches, writer->batch);
+        writer->batch = NULL;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Pass the records added so far by the producer of a background
+ * profile writer to the writer thread.
+ *
+ * @private @memberof ccl_prof_writer
+ *
+ * @param[in] writer Background profile writer.
+ * */
+static void ccl_prof_writer_submit(CCLProfWriter * writer) {
+
+    if (writer->batch != NULL) {
+        g_async_queue_push(writer->batches, writer->batch);
+        writer->batch = NULL;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Write and clear the formatted records of a background profile
+ * writer, unless a previous write failed. Only called by the writer
+ * thread.
+ *
+ * @private @memberof ccl_prof_writer
+ *
+ * @param[in] writer Background profile writer.
+ * @param[in,out] buf Formatted records.
+ * */
+static void ccl_prof_writer_write(CCLProfWriter * writer, GString * buf) {
+
+    size_t written;
+
+    if ((writer->err == NULL) && (buf->len > 0)) {
+
+#ifdef CCL_PROF_ZLIB
+        if (writer->gz != NULL) {
+            int gz_written =
+                gzwrite(writer->gz, buf->str, (unsigned) buf->len);
+            written = (gz_written > 0) ? (size_t) gz_written : 0;
+        } else
+#endif
+        {
+            written = fwrite(buf->str, 1, buf->len, writer->fp);
+        }
+
+        if (written != buf->len)
+            g_set_error(&writer->err, CCL_ERROR, CCL_ERROR_STREAM_WRITE,
+                "%s: Error while exporting profiling information "
+                "(writing to file).", CCL_STRD);
+    }
+
+    g_string_truncate(buf, 0);
+}
+
+/**
+ * @internal
+ *
+ * @brief Close the file of a background profile writer.
+ *
+ * @private @memberof ccl_prof_writer
+ *
+ * @param[in] writer Background profile writer.
+ * */
+static void ccl_prof_writer_close(CCLProfWriter * writer) {
+
+    int close_status = 0;
+
+#ifdef CCL_PROF_ZLIB
+    if (writer->gz != NULL) {
+        close_status = (gzclose(writer->gz) == Z_OK) ? 0 : EOF;
+        writer->gz = NULL;
+    }
+#endif
+    if (writer->fp != NULL) {
+        close_status = fclose(writer->fp);
+        writer->fp = NULL;
+    }
+
+    if ((close_status != 0) && (writer->err == NULL))
+        g_set_error(&writer->err, CCL_ERROR, CCL_ERROR_STREAM_WRITE,
+            "%s: Error while exporting profiling information "
+            "(closing file).", CCL_STRD);
+}
+
+/**
+ * @internal
+ *
+ * @brief Writer thread function, which formats and writes the batches of
+ * records passed to the writer until the end of records is signaled,
+ * then closes the file and completes the future of the writer, if any.
+ *
+ * @param[in] data Background profile writer.
+ * @return `NULL`.
+ * */
+static gpointer ccl_prof_writer_loop(gpointer data) {
+
+    CCLProfWriter * writer = (CCLProfWriter *) data;
+    CCLProfExportOptions * opts = &writer->opts;
+    GString * buf = g_string_sized_new(CCL_PROF_WRITER_BUF_SIZE + 1024);
+    GArray * batch;
+
+    /* The writer itself signals the end of records. */
+    while ((batch = g_async_queue_pop(writer->batches)) != data) {
+
+        /* Format records, writing them whenever the buffer is full. After
+         * an error, records are just discarded. */
+        for (guint i = 0; (i < batch->len) && (writer->err == NULL); ++i) {
+            CCLProfWriterRec * rec =
+                &g_array_index(batch, CCLProfWriterRec, i);
+            g_string_append_printf(buf, "%s%s%s%s%lu%s%lu%s%s%s%s%s",
+                opts->queue_delim, rec->queue_name, opts->queue_delim,
+                opts->separator, (unsigned long) rec->t_start,
+                opts->separator, (unsigned long) rec->t_end,
+                opts->separator, opts->evname_delim, rec->event_name,
+                opts->evname_delim, opts->newline);
+            if (buf->len >= CCL_PROF_WRITER_BUF_SIZE)
+                ccl_prof_writer_write(writer, buf);
+        }
+        g_array_free(batch, TRUE);
+    }
+
+    /* Write remaining records and close file. */
+    ccl_prof_writer_write(writer, buf);
+    g_string_free(buf, TRUE);
+    ccl_prof_writer_close(writer);
+
+    /* Signal completion. */
+    if (writer->fut != NULL)
+        ccl_future_resolve(writer->fut,
+            writer->err == NULL ? CL_COMPLETE : CL_INVALID_OPERATION);
+
+    return NULL;
 }
 
 /**
  * @internal
  *
- * @brief Free an event instant.
+ * @brief Add new event instant to an array of event instants.
  *
  * @private @memberof ccl_prof_inst
  *
- * @param[in] instant Event instant to destroy.
+ * @param[in] instants Array of event instants.
+ * @param[in] event_name Name of event.
+ * @param[in] queue_name Name of command queue associated with event.
+ * @param[in] id Id of event.
+ * @param[in] instant Even instant in nanoseconds.
+ * @param[in] type Type of event instant: ::CCL_PROF_INST_TYPE_START or
+ * ::CCL_PROF_INST_TYPE_END.
  */
-static void ccl_prof_inst_destroy(CCLProfInst * instant) {
+static void ccl_prof_inst_add(GArray * instants, const char * event_name,
+    const char * queue_name, cl_uint id, cl_ulong instant,
+    CCLProfInstType type) {
 
-    g_return_if_fail(instant != NULL);
+    /* Event instant data structure. */
+    CCLProfInst inst;
 
-    g_slice_free(CCLProfInst, instant);
+    /* Initialize structure fields. */
+    inst.event_name = event_name;
+    inst.queue_name = queue_name;
+    inst.id = id;
+    inst.instant = instant;
+    inst.type = type;
+
+    /* Add event instant to array. */
+    g_array_append_val(instants, inst);
 }
 
 /**
  * @internal
  *
- * @brief Compares two event instants for sorting within a `GList`. It is an
+ * @brief Compares two event instants for sorting within a `GArray`. It is an
  * implementation of `GCompareDataFunc` from GLib.
  *
  * @private @memberof ccl_prof_inst
@@ -310,41 +1053,11 @@ static gint ccl_prof_inst_comp(
     }
 }
 
-/**
- * @internal
- *
- * @brief Create a new aggregate statistic for events of a given type.
- *
- * @private @memberof ccl_prof_agg
- *
- * @param[in] event_name Name of event.
- * @return New aggregate statistic.
- * */
-static CCLProfAgg * ccl_prof_agg_new(const char * event_name) {
-    CCLProfAgg * agg = g_slice_new(CCLProfAgg);
-    agg->event_name = event_name;
-    return agg;
-}
-
-/**
- * @internal
- *
- * @brief Free an aggregate statistic.
- *
- * @private @memberof ccl_prof_agg
- *
- * @param[in] agg Aggregate statistic to free.
- * */
-static void ccl_prof_agg_destroy(CCLProfAgg * agg) {
-    g_return_if_fail(agg != NULL);
-    g_slice_free(CCLProfAgg, agg);
-}
-
 /**
  * @internal
  *
  * @brief Compares two aggregate event data instances for sorting within a
- * `GList`. It is an implementation of `GCompareDataFunc` from GLib.
+ * `GArray`. It is an implementation of `GCompareDataFunc` from GLib.
  *
  * @private @memberof ccl_prof_agg
  *
@@ -385,10 +1098,12 @@ static gint ccl_prof_agg_comp(
 /**
  * @internal
  *
- * @brief Create a new event profiling information object.
+ * @brief Add new event profiling information object to an array of
+ * event profiling information objects.
  *
  * @private @memberof ccl_prof_info
  *
+ * @param[in] infos Array of event profiling information objects.
  * @param[in] event_name Name of event.
  * @param[in] command_type Type of command which produced the event.
  * @param[in] queue_name Name of command queue which generated this event.
@@ -401,45 +1116,30 @@ static gint ccl_prof_agg_comp(
  * event starts execution on the device.
  * @param[in] t_end Device time in nanoseconds when the command identified by
  * event has finished execution on the device.
- * @return A new event profiling information object.
  * */
-static CCLProfInfo * ccl_prof_info_new(const char * event_name,
+static void ccl_prof_info_add(GArray * infos, const char * event_name,
     cl_command_type command_type, const char * queue_name,
     cl_ulong t_queued, cl_ulong t_submit, cl_ulong t_start,
     cl_ulong t_end) {
 
-    CCLProfInfo * info = g_slice_new(CCLProfInfo);
+    CCLProfInfo info;
 
-    info->event_name = event_name;
-    info->command_type = command_type;
-    info->queue_name = queue_name;
-    info->t_queued = t_queued;
-    info->t_submit = t_submit;
-    info->t_start = t_start;
-    info->t_end = t_end;
-
-    return info;
-}
+    info.event_name = event_name;
+    info.command_type = command_type;
+    info.queue_name = queue_name;
+    info.t_queued = t_queued;
+    info.t_submit = t_submit;
+    info.t_start = t_start;
+    info.t_end = t_end;
 
-/**
- * @internal
- *
- * @brief Free an event profiling information object.
- *
- * @private @memberof ccl_prof_info
- *
- * @param[in] info Event profiling information object to free.
- * */
-static void ccl_prof_info_destroy(CCLProfInfo * info) {
-    g_return_if_fail(info != NULL);
-    g_slice_free(CCLProfInfo, info);
+    g_array_append_val(infos, info);
 }
 
 /**
  * @internal
  *
  * @brief Compares two event profiling information instances for sorting within
- * a `GList`. It is an implementation of `GCompareDataFunc` from GLib.
+ * a `GArray`. It is an implementation of `GCompareDataFunc` from GLib.
  *
  * @private @memberof ccl_prof_info
  *
@@ -498,47 +1198,32 @@ static gint ccl_prof_info_comp(
 /**
  * @internal
  *
- * @brief Create a new event overlap object.
+ * @brief Add new event overlap object to an array of event overlaps.
  *
  * @private @memberof ccl_prof_overlap
  *
+ * @param[in] overlaps Array of event overlaps.
  * @param[in] event1_name Name of first overlapping event.
  * @param[in] event2_name Name of second overlapping event.
  * @param[in] duration Overlap duration in nanoseconds.
- * @return A new event overlap object.
  * */
-static CCLProfOverlap * ccl_prof_overlap_new(const char * event1_name,
-    const char * event2_name, cl_ulong duration) {
+static void ccl_prof_overlap_add(GArray * overlaps,
+    const char * event1_name, const char * event2_name, cl_ulong duration) {
 
-    CCLProfOverlap * ovlp = g_slice_new(CCLProfOverlap);
+    CCLProfOverlap ovlp;
 
-    ovlp->event1_name = event1_name;
-    ovlp->event2_name = event2_name;
-    ovlp->duration = duration;
-
-    return ovlp;
-}
-
-/**
- * @internal
- *
- * @brief Destroy an event overlap object.
- *
- * @private @memberof ccl_prof_overlap
- *
- * @param[in] ovlp Event overlap object to destroy.
- * */
-static void ccl_prof_overlap_destroy(CCLProfOverlap * ovlp) {
+    ovlp.event1_name = event1_name;
+    ovlp.event2_name = event2_name;
+    ovlp.duration = duration;
 
-    g_return_if_fail(ovlp != NULL);
-    g_slice_free(CCLProfOverlap, ovlp);
+    g_array_append_val(overlaps, ovlp);
 }
 
 /**
  * @internal
  *
- * @brief Compares two event overlap instances for sorting within a `GList`. It
- * is an implementation of `GCompareDataFunc` from GLib.
+ * @brief Compares two event overlap instances for sorting within a `GArray`.
+ * It is an implementation of `GCompareDataFunc` from GLib.
  *
  * @private @memberof ccl_prof_overlap
  *
@@ -585,1278 +1270,5298 @@ static gint ccl_prof_overlap_comp(
 /**
  * @internal
  *
- * @brief Add event for profiling.
+ * @brief Compares two command slack instances for sorting within a
+ * `GArray`. It is an implementation of `GCompareDataFunc` from GLib.
  *
- * @private @memberof ccl_prof
+ * @private @memberof ccl_prof_slack
  *
- * @param[in] prof Profile object.
- * @param[in] cq_name Command queue name.
- * @param[in] evt Event wrapper object.
- * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
- * reporting is to be ignored.
- * */
-static void ccl_prof_add_event(
-    CCLProf * prof, const char * cq_name, CCLEvent * evt, CCLErr ** err) {
+ * @param[in] a First command slack instance to compare.
+ * @param[in] b Second command slack instance to compare.
+ * @param[in] userdata Defines the sort criteria and order.
+ * @return Negative value if `a < b`; zero if `a == b`; positive value if
+ * `a > b`.
+ */
+static gint ccl_prof_slack_comp(
+    gconstpointer a, gconstpointer b, gpointer userdata) {
 
-    /* Make sure err is NULL or it is not set. */
-    g_return_if_fail(err == NULL || *err == NULL);
-    /* Make sure profile object is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* Make sure command queue name is not NULL. */
-    g_return_if_fail(cq_name != NULL);
-    /* Make sure event wrapper is not NULL. */
-    g_return_if_fail(evt != NULL);
+    /* Cast input parameters to command slack data structures. */
+    CCLProfSlack * slk1 = (CCLProfSlack *) a;
+    CCLProfSlack * slk2 = (CCLProfSlack *) b;
+    CCLProfSort sort = ccl_prof_get_sort(userdata);
+    /* Perform comparison. */
+    switch ((CCLProfSlackSort) sort.criteria) {
 
-    /* Event name ID. */
-    cl_uint * event_name_id;
-    /* Specific event ID. */
-    cl_uint event_id;
-    /* Event instants. */
-    cl_ulong instant_queued, instant_submit, instant_start, instant_end;
-    /* Type of command which produced the event. */
-    cl_command_type command_type;
-    /* Event instant objects. */
-    CCLProfInst * evinst_start;
-    CCLProfInst * evinst_end;
-    /* Internal error handling object. */
-    CCLErr * err_internal = NULL;
+        /* Sort command slacks by slack. */
+        case CCL_PROF_SLACK_SORT_SLACK:
+            return CCL_PROF_CMP_INT(slk1->slack, slk2->slack, sort.order);
 
-    /* Event name. */
-    const char * event_name;
+        /* Sort command slacks by start time. */
+        case CCL_PROF_SLACK_SORT_T_START:
+            return CCL_PROF_CMP_INT(slk1->t_start, slk2->t_start,
+                sort.order);
 
-    /* Get event name. */
-    event_name = ccl_event_get_final_name(evt);
+        /* We shouldn't get here. */
+        default:
+            g_warning("Unknown PROF_SLACK sort criteria/order.");
+            return 0;
+    }
+}
 
-    /* Get event queued instant. */
-    instant_queued = ccl_event_get_profiling_info_scalar(
-        evt, CL_PROFILING_COMMAND_QUEUED, cl_ulong, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+/**
+ * @internal
+ *
+ * @brief Compares two host-side range instances for sorting within a
+ * `GArray`. It is an implementation of `GCompareDataFunc` from GLib.
+ *
+ * @private @memberof ccl_prof_range
+ *
+ * @param[in] a First host-side range instance to compare.
+ * @param[in] b Second host-side range instance to compare.
+ * @param[in] userdata Defines the sort criteria and order.
+ * @return Negative value if `a < b`; zero if `a == b`; positive value if
+ * `a > b`.
+ */
+static gint ccl_prof_range_comp(
+    gconstpointer a, gconstpointer b, gpointer userdata) {
 
-    /* Get event submit instant. */
-    instant_submit = ccl_event_get_profiling_info_scalar(
-        evt, CL_PROFILING_COMMAND_SUBMIT, cl_ulong, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    /* Cast input parameters to host-side range data structures. */
+    CCLProfRange * rng1 = (CCLProfRange *) a;
+    CCLProfRange * rng2 = (CCLProfRange *) b;
+    CCLProfSort sort = ccl_prof_get_sort(userdata);
+    /* Perform comparison. */
+    switch ((CCLProfRangeSort) sort.criteria) {
 
-    /* Get event start instant. */
-    instant_start = ccl_event_get_profiling_info_scalar(
-        evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        /* Sort host-side ranges by start time. */
+        case CCL_PROF_RANGE_SORT_T_START:
+            return CCL_PROF_CMP_INT(rng1->t_start, rng2->t_start,
+                sort.order);
 
-    /* Get event end instant. */
-    instant_end = ccl_event_get_profiling_info_scalar(
-        evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        /* Sort host-side ranges by device time. */
+        case CCL_PROF_RANGE_SORT_DEVICE_TIME:
+            return CCL_PROF_CMP_INT(rng1->device_time, rng2->device_time,
+                sort.order);
 
-    /* Get command type. */
-    command_type = ccl_event_get_info_scalar(
-        evt, CL_EVENT_COMMAND_TYPE, cl_command_type, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        /* We shouldn't get here. */
+        default:
+            g_warning("Unknown PROF_RANGE sort criteria/order.");
+            return 0;
+    }
+}
 
-    /* If we get here, update number of profilable events, and get an ID
-     * for the given event. */
-    event_id = ++prof->num_events;
+/**
+ * @internal
+ *
+ * @brief Get the histogram bucket of the given event duration.
+ *
+ * Durations below 2^(::CCL_PROF_HIST_SUB_BITS + 1) have their own bucket.
+ * Larger durations are grouped in 2^::CCL_PROF_HIST_SUB_BITS buckets per
+ * power of two.
+ *
+ * @param[in] duration Event duration.
+ * @return Histogram bucket.
+ * */
+static guint ccl_prof_hist_bucket(cl_ulong duration) {
 
-    /* Check if event name is already registered in the table of event
-     * names... */
-    if (!g_hash_table_contains(prof->event_names, event_name)) {
-        /* ...if not, register it. */
-        event_name_id =
-            GUINT_TO_POINTER(g_hash_table_size(prof->event_names));
-        g_hash_table_insert(
-            prof->event_names,
-            (gpointer) event_name,
-            (gpointer) event_name_id);
-    }
+    /* Position of most significant bit. */
+    guint msb = 0;
 
-    /* If end instant occurs after start instant... */
-    if (instant_end > instant_start) {
+    /* Durations in the linear range have their own bucket. */
+    if (duration < (2 << CCL_PROF_HIST_SUB_BITS))
+        return (guint) duration;
 
-        /* Add event start instant to list of event instants. */
-        evinst_start = ccl_prof_inst_new(event_name, cq_name, event_id,
-            instant_start, CCL_PROF_INST_TYPE_START);
-        prof->instants = g_list_prepend(
-            prof->instants, (gpointer) evinst_start);
+    /* Find most significant bit. */
+    while ((duration >> msb) > 1) msb++;
 
-        /* Add event end instant to list of event instants. */
-        evinst_end = ccl_prof_inst_new(event_name, cq_name, event_id,
-            instant_end, CCL_PROF_INST_TYPE_END);
-        prof->instants = g_list_prepend(
-            prof->instants, (gpointer) evinst_end);
+    /* Return bucket given by position of most significant bit and the
+     * following CCL_PROF_HIST_SUB_BITS bits. */
+    return ((msb - CCL_PROF_HIST_SUB_BITS + 1) << CCL_PROF_HIST_SUB_BITS)
+        + (guint) (duration >> (msb - CCL_PROF_HIST_SUB_BITS))
+        - (1 << CCL_PROF_HIST_SUB_BITS);
+}
 
-        /* Check if start instant is the oldest instant. If so, keep it. */
-        if (instant_start < prof->t_start)
-            prof->t_start = instant_start;
+/**
+ * @internal
+ *
+ * @brief Get the highest event duration in the given histogram bucket.
+ *
+ * @param[in] bucket Histogram bucket.
+ * @return Highest event duration in the given histogram bucket.
+ * */
+static cl_ulong ccl_prof_hist_bucket_max(guint bucket) {
 
-    } else {
+    /* Shift and sub-bucket of bucket. */
+    guint shift;
+    cl_ulong sub;
 
-        g_info("Event '%s' did not use device time. As such its "\
-            "start and end instants will not be added to the list of "\
-            "event instants.", event_name);
+    /* Buckets in the linear range have a single duration. */
+    if (bucket < (2 << CCL_PROF_HIST_SUB_BITS))
+        return bucket;
 
-    }
+    /* Determine shift and sub-bucket. */
+    shift = (bucket >> CCL_PROF_HIST_SUB_BITS) - 1;
+    sub = (bucket & ((1 << CCL_PROF_HIST_SUB_BITS) - 1))
+        + (1 << CCL_PROF_HIST_SUB_BITS);
 
-    /* Add event information to list of event information..*/
-    prof->infos = g_list_prepend(prof->infos,
-        (gpointer) ccl_prof_info_new(event_name, command_type, cq_name,
-            instant_queued, instant_submit, instant_start, instant_end));
+    /* Return highest duration in bucket. */
+    return ((sub + 1) << shift) - 1;
+}
 
-    /* If we got here, everything is OK. */
-    g_assert(err == NULL || *err == NULL);
-    goto finish;
+/**
+ * @internal
+ *
+ * @brief Add an event duration to a histogram and to the respective
+ * aggregate statistic.
+ *
+ * @param[in,out] hist Histogram of event durations.
+ * @param[in,out] agg Aggregate statistic.
+ * @param[in] duration Event duration.
+ * */
+static void ccl_prof_hist_add(
+    CCLProfHist * hist, CCLProfAgg * agg, cl_ulong duration) {
+
+    /* Histogram bucket. */
+    guint bucket = ccl_prof_hist_bucket(duration);
+    /* Difference from mean. */
+    double delta;
+
+    /* Grow histogram if required and update bucket count. */
+    if (bucket >= hist->counts->len)
+        g_array_set_size(hist->counts, bucket + 1);
+    g_array_index(hist->counts, guint, bucket)++;
+
+    /* Update count, total, minimum and maximum. */
+    hist->total_time += duration;
+    agg->count++;
+    agg->min_time = MIN(agg->min_time, duration);
+    agg->max_time = MAX(agg->max_time, duration);
+
+    /* Update running mean and sum of squared differences (Welford's
+     * algorithm). */
+    delta = duration - hist->mean;
+    hist->mean += delta / agg->count;
+    hist->m2 += delta * (duration - hist->mean);
+}
 
-error_handler:
-    /* If we got here there was an error, verify that it is so. */
-    g_assert(err == NULL || *err != NULL);
+/**
+ * @internal
+ *
+ * @brief Determine a percentile of event durations from a histogram.
+ *
+ * The highest duration of the bucket containing the percentile is
+ * returned, limited by the minimum and maximum durations.
+ *
+ * @param[in] hist Histogram of event durations.
+ * @param[in] agg Aggregate statistic with count, minimum and maximum.
+ * @param[in] pct Percentile, between 0 and 100.
+ * @return The given percentile of event durations.
+ * */
+static cl_ulong ccl_prof_hist_percentile(
+    CCLProfHist * hist, const CCLProfAgg * agg, double pct) {
+
+    /* Rank of percentile and number of events counted so far. */
+    guint64 rank, counted = 0;
+
+    /* Determine rank of percentile. */
+    rank = (guint64) ceil(pct / 100.0 * agg->count);
+    if (rank == 0) rank = 1;
+
+    /* Find bucket containing the percentile. */
+    for (guint i = 0; i < hist->counts->len; ++i) {
+        counted += g_array_index(hist->counts, guint, i);
+        if (counted >= rank)
+            return CLAMP(
+                ccl_prof_hist_bucket_max(i), agg->min_time, agg->max_time);
+    }
 
-finish:
+    /* We shouldn't get here. */
+    return agg->max_time;
+}
 
-    /* Return. */
-    return;
+/**
+ * @internal
+ *
+ * @brief Fetch the raw profiling data of an event, i.e. its four profiling
+ * instants and command type, directly from OpenCL, bypassing the cache of
+ * the event wrapper.
+ *
+ * This function is thread-safe, as long as different threads fetch data
+ * of different events.
+ *
+ * @param[in] evt Event wrapper.
+ * @param[out] raw Location where to place raw profiling data.
+ * @return `CL_SUCCESS` or the first OpenCL error code returned.
+ * */
+static cl_int ccl_prof_fetch(CCLEvent * evt, CCLProfRaw * raw) {
+
+    /* Profiling instants to fetch. */
+    static const cl_profiling_info params[] = {
+        CL_PROFILING_COMMAND_QUEUED, CL_PROFILING_COMMAND_SUBMIT,
+        CL_PROFILING_COMMAND_START, CL_PROFILING_COMMAND_END };
+    /* OpenCL event. */
+    cl_event event = ccl_event_unwrap(evt);
+    /* OpenCL status. */
+    cl_int ocl_status = CL_SUCCESS;
+
+    /* Fetch instants and command type. */
+    raw->evt = evt;
+    for (guint i = 0; (i < 4) && (ocl_status == CL_SUCCESS); ++i)
+        ocl_status = clGetEventProfilingInfo(event, params[i],
+            sizeof(cl_ulong), &raw->instants[i], NULL);
+    if (ocl_status == CL_SUCCESS)
+        ocl_status = clGetEventInfo(event, CL_EVENT_COMMAND_TYPE,
+            sizeof(cl_command_type), &raw->command_type, NULL);
+
+    /* Return status. */
+    raw->status = ocl_status;
+    return ocl_status;
 }
 
 /**
  * @internal
  *
- * @brief Process command queues, i.e., add the respective events for
- * profiling.
+ * @brief Attribute a profiled event to the host-side ranges which were
+ * open when it was queued, i.e. to the innermost such range and all the
+ * ranges enclosing it.
  *
  * @private @memberof ccl_prof
  *
  * @param[in] prof Profile object.
- * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
- * reporting is to be ignored.
- */
-static void ccl_prof_process_queues(CCLProf * prof, CCLErr ** err) {
-
-    /* Make sure err is NULL or it is not set. */
-    g_return_if_fail(err == NULL || *err == NULL);
-    /* Make sure profile object is not NULL. */
-    g_return_if_fail(prof != NULL);
-
-    /* Hash table iterator. */
-    GHashTableIter iter;
-    /* Command queue name and wrapper. */
-    gpointer cq_name;
-    gpointer cq;
-    /* Queue properties. */
-    cl_command_queue_properties qprop;
-    /* Internal error reporting object. */
-    CCLErr * err_internal = NULL;
+ * @param[in] t_queued Instant in the host timebase when the event was
+ * queued.
+ * @param[in] duration Event duration.
+ * */
+static void ccl_prof_range_attribute(
+    CCLProf * prof, cl_ulong t_queued, cl_ulong duration) {
+
+    /* Bounds of binary search and current range. */
+    guint lo = 0, hi = prof->ranges->len, curr;
+    CCLProfRange * rng;
+
+    /* Ranges are kept in the order they were pushed, thus sorted by start
+     * time: find the last range pushed before the event was queued. */
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index(prof->ranges, CCLProfRange, mid).t_start
+                <= t_queued)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-    /* Iterate over the command queues. */
-    g_hash_table_iter_init(&iter, prof->queues);
-    while (g_hash_table_iter_next(&iter, &cq_name, &cq)) {
+    /* Ranges are properly nested, so the innermost range open when the
+     * event was queued is either this one or one of its enclosing ranges.
+     * Ranges still open have a zero end instant. */
+    curr = lo > 0 ? lo - 1 : G_MAXUINT;
+    while (curr != G_MAXUINT) {
+        rng = &g_array_index(prof->ranges, CCLProfRange, curr);
+        if ((rng->t_end == 0) || (t_queued < rng->t_end)) break;
+        curr = g_array_index(prof->range_parents, guint, curr);
+    }
 
-        /* Check that queue has profiling enabled. */
-        qprop = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
-            cl_command_queue_properties, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-        ccl_if_err_create_goto(*err, CCL_ERROR,
-            (qprop & CL_QUEUE_PROFILING_ENABLE) == 0, CCL_ERROR_OTHER,
-            error_handler,
-            "%s: the '%s' queue does not have profiling enabled.",
-            CCL_STRD, (char *) cq_name);
+    /* Add event to the innermost range and to all enclosing ranges. */
+    while (curr != G_MAXUINT) {
+        rng = &g_array_index(prof->ranges, CCLProfRange, curr);
+        rng->num_events++;
+        rng->device_time += duration;
+        curr = g_array_index(prof->range_parents, guint, curr);
+    }
+}
 
-        /* Iterate over the events in current command queue. */
-        CCLEvent * evt;
-        ccl_queue_iter_event_init((CCLQueue *) cq);
-        while ((evt = ccl_queue_iter_event_next((CCLQueue *) cq))) {
+/**
+ * @internal
+ *
+ * @brief Duration of one of the slowest event instances.
+ *
+ * @param[in] slow A ::CCLProfSlow object.
+ * @return Duration of event instance.
+ * */
+#define ccl_prof_slow_duration(slow) \
+    ((slow)->info.t_end - (slow)->info.t_start)
 
-            /* Add event for profiling. */
-            ccl_prof_add_event(
-                prof, (const char *) cq_name, evt, &err_internal);
-            if ((err_internal != NULL) &&
-                (((err_internal->domain == CCL_OCL_ERROR) &&
-                 (err_internal->code == CL_PROFILING_INFO_NOT_AVAILABLE))
-                ||
-                 ((err_internal->domain == CCL_ERROR) &&
-                 (err_internal->code == CCL_ERROR_INFO_UNAVAILABLE_OCL)))) {
-
-                /* Some types of events in certain platforms don't
-                 * provide profiling info. Don't stop profiling,
-                 * ignore this specific event, but log a message
-                 * saying so. */
-                g_info("The '%s' event does not have profiling info",
-                    ccl_event_get_final_name(evt));
-                ccl_err_clear(&err_internal);
-                continue;
-            }
-            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+/**
+ * @internal
+ *
+ * @brief Keep an event instance if it is one of the slowest with its name,
+ * replacing the fastest of the kept instances if required.
+ *
+ * @param[in] prof Profile object.
+ * @param[in,out] hist Histogram of event name.
+ * @param[in] slow Event instance, whose tag is copied if kept.
+ * */
+static void ccl_prof_slowest_add(
+    CCLProf * prof, CCLProfHist * hist, const CCLProfSlow * slow) {
+
+    CCLProfSlow * heap;
+    CCLProfSlow swap;
+    guint i, n, child;
+
+    /* Create min-heap of slowest instances, if required. */
+    if (hist->slowest == NULL)
+        hist->slowest = g_array_sized_new(
+            FALSE, FALSE, sizeof(CCLProfSlow), prof->slowest_k);
+
+    /* If instances were sorted by decreasing duration, reversing them
+     * yields a min-heap. */
+    n = hist->slowest->len;
+    heap = (CCLProfSlow *) hist->slowest->data;
+    if (hist->slowest_sorted) {
+        for (i = 0; i < n / 2; ++i) {
+            swap = heap[i];
+            heap[i] = heap[n - 1 - i];
+            heap[n - 1 - i] = swap;
+        }
+        hist->slowest_sorted = CL_FALSE;
+    }
 
+    if (n < prof->slowest_k) {
+
+        /* Heap not full, add instance and sift it up. */
+        g_array_append_val(hist->slowest, *slow);
+        heap = (CCLProfSlow *) hist->slowest->data;
+        heap[n].tag = g_strdup(slow->tag);
+        for (i = n; i > 0; i = (i - 1) / 2) {
+            if (ccl_prof_slow_duration(&heap[(i - 1) / 2])
+                    <= ccl_prof_slow_duration(&heap[i]))
+                break;
+            swap = heap[i];
+            heap[i] = heap[(i - 1) / 2];
+            heap[(i - 1) / 2] = swap;
         }
 
-        /* Release queue events. */
-        ccl_queue_gc((CCLQueue *) cq);
+    } else if (ccl_prof_slow_duration(slow)
+            > ccl_prof_slow_duration(&heap[0])) {
+
+        /* Heap full, replace fastest instance and sift it down. */
+        g_free((gchar *) heap[0].tag);
+        heap[0] = *slow;
+        heap[0].tag = g_strdup(slow->tag);
+        for (i = 0; (child = 2 * i + 1) < n; i = child) {
+            if ((child + 1 < n) && (ccl_prof_slow_duration(&heap[child + 1])
+                    < ccl_prof_slow_duration(&heap[child])))
+                child++;
+            if (ccl_prof_slow_duration(&heap[i])
+                    <= ccl_prof_slow_duration(&heap[child]))
+                break;
+            swap = heap[i];
+            heap[i] = heap[child];
+            heap[child] = swap;
+        }
     }
+}
 
-    /* If we got here, everything is OK. */
-    g_assert(err == NULL || *err == NULL);
-    goto finish;
+/**
+ * @internal
+ *
+ * @brief Collect the performance counters of a command and add them to the
+ * histogram of its event name.
+ *
+ * @param[in] prof Profile object.
+ * @param[in,out] hist Histogram of event name.
+ * @param[in] evt Event wrapper of the command.
+ * @param[in] command_type Type of command which produced the event.
+ * @param[in] duration Duration of the command.
+ * */
+static void ccl_prof_counters_add(CCLProf * prof, CCLProfHist * hist,
+    CCLEvent * evt, cl_command_type command_type, cl_ulong duration) {
+
+    /* Collect counters, skipping commands for which none are available. */
+    if (!prof->counters_fn(evt, command_type, prof->counter_values,
+            prof->counters_data))
+        return;
+
+    /* Sum counters. */
+    if (hist->counters == NULL)
+        hist->counters = g_new0(double, prof->num_counters);
+    for (cl_uint i = 0; i < prof->num_counters; ++i)
+        hist->counters[i] += prof->counter_values[i];
+    hist->counters_time += duration;
+
+    /* Weight occupancy by duration. */
+    if (prof->counter_occupancy >= 0)
+        hist->occupancy_time +=
+            prof->counter_values[prof->counter_occupancy] * duration;
+}
 
-error_handler:
-    /* If we got here there was an error, verify that it is so. */
-    g_assert(err == NULL || *err != NULL);
+/**
+ * @internal
+ *
+ * @brief Achieved bandwidth of the events in a histogram, derived from the
+ * ::CCL_PROF_COUNTER_BYTES counter.
+ *
+ * @param[in] prof Profile object.
+ * @param[in] hist Histogram of event name.
+ * @return Bandwidth in bytes per second, or zero if not available.
+ * */
+static double ccl_prof_hist_bandwidth(CCLProf * prof, CCLProfHist * hist) {
 
-finish:
+    return ((hist->counters != NULL) && (prof->counter_bytes >= 0)
+            && (hist->counters_time > 0))
+        ? hist->counters[prof->counter_bytes] * 1e9 / hist->counters_time
+        : 0.0;
+}
 
-    /* Return. */
-    return;
+/**
+ * @internal
+ *
+ * @brief Mean occupancy of the events in a histogram, weighted by
+ * duration, derived from the ::CCL_PROF_COUNTER_OCCUPANCY counter.
+ *
+ * @param[in] prof Profile object.
+ * @param[in] hist Histogram of event name.
+ * @return Mean occupancy, or zero if not available.
+ * */
+static double ccl_prof_hist_occupancy(CCLProf * prof, CCLProfHist * hist) {
+
+    return ((hist->counters != NULL) && (prof->counter_occupancy >= 0)
+            && (hist->counters_time > 0))
+        ? hist->occupancy_time / hist->counters_time
+        : 0.0;
 }
 
 /**
  * @internal
  *
- * @brief Determine aggregate event statistics.
+ * @brief Add event for profiling.
  *
  * @private @memberof ccl_prof
  *
- * @param[in] prof The profile object.
+ * Events not sampled (see ccl_prof_set_sampling()) are only counted.
+ * Aggregate statistics are updated immediately. If `intervals` is `NULL`,
+ * the event instants and profiling information are kept in the profile
+ * object. Otherwise, only the event interval is added to `intervals`, for
+ * the purpose of determining overlaps in incremental mode.
+ *
+ * @param[in] prof Profile object.
+ * @param[in] cq_name Command queue name.
+ * @param[in] evt Event wrapper object, or `NULL` if the event was loaded
+ * from an exported profile, in which case `raw` must be given.
+ * @param[in] event_name Interned final name of the event.
+ * @param[in] raw Previously fetched raw profiling data of event, or `NULL`
+ * if it is to be fetched by this function.
+ * @param[out] intervals Array of event intervals, or `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
  * */
-static void ccl_prof_calc_agg(CCLProf * prof) {
+static void ccl_prof_add_event(CCLProf * prof, const char * cq_name,
+    CCLEvent * evt, const char * event_name, const CCLProfRaw * raw,
+    GArray * intervals, CCLErr ** err) {
 
+    /* Make sure err is NULL or it is not set. */
+    g_return_if_fail(err == NULL || *err == NULL);
     /* Make sure profile object is not NULL. */
     g_return_if_fail(prof != NULL);
+    /* Make sure command queue name is not NULL. */
+    g_return_if_fail(cq_name != NULL);
+    /* Make sure event wrapper or raw profiling data is given. */
+    g_return_if_fail(evt != NULL || raw != NULL);
 
-    /* Hash table iterator. */
-    GHashTableIter iter;
-    /* Aux. hash table for aggregate statistics. */
-    GHashTable * agg_table;
-    /* A pointer for a event name. */
-    gpointer event_name;
-    /* Aggregate event info. */
-    CCLProfAgg * evagg = NULL;
-    /* Type of sorting to perform on event list. */
-    int sort_type;
-    /* Aux. pointer for event data structure kept in a GList. */
-    GList * curr_evinst_container = NULL;
-    /* A pointer to a CCLProfAgg (agg. event info) variable. */
-    gpointer value_agg;
-    /* Auxiliary aggregate event info variable.*/
-    CCLProfAgg * curr_agg = NULL;
+    /* Event name ID. */
+    cl_uint ueid;
+    gpointer p_ueid;
+    /* Aggregate statistic for event name. */
+    CCLProfAgg * agg;
+    /* Histogram of event durations for event name. */
+    CCLProfHist * hist;
+    /* Event interval. */
+    CCLProfInterval interval;
+    /* Specific event ID. */
+    cl_uint event_id;
+    /* Event instants. */
+    cl_ulong instant_queued, instant_submit, instant_start, instant_end;
+    /* Type of command which produced the event. */
+    cl_command_type command_type;
+    /* Raw profiling data fetched by this function. */
+    CCLProfRaw raw_fetched;
+    /* Offset from device clock to host timebase. */
+    gint64 * p_offset = NULL;
+    /* Live busy time of command queue. */
+    CCLProfQueueLive * live;
+    /* Event instance, if it is one of the slowest. */
+    CCLProfSlow slow;
 
-    /* Create table of aggregate statistics. */
-    agg_table = g_hash_table_new(g_str_hash, g_str_equal);
+    /* Check if event name is already registered in the table of event
+     * names... */
+    if (!g_hash_table_lookup_extended(prof->event_names, event_name,
+        NULL, &p_ueid)) {
+
+        /* ...if not, register it... */
+        ueid = g_hash_table_size(prof->event_names);
+        g_hash_table_insert(prof->event_names,
+            (gpointer) event_name, GUINT_TO_POINTER(ueid));
+
+        /* ...and create the respective aggregate statistic. */
+        g_array_set_size(prof->aggs, ueid + 1);
+        agg = &g_array_index(prof->aggs, CCLProfAgg, ueid);
+        agg->event_name = event_name;
+        agg->absolute_time = 0;
+        agg->relative_time = 0;
+        agg->count = 0;
+        agg->min_time = CL_ULONG_MAX;
+        agg->max_time = 0;
+        agg->counters = NULL;
+        agg->bandwidth = 0;
+        agg->occupancy = 0;
+
+        /* Create the respective histogram of event durations. */
+        g_array_set_size(prof->hists, ueid + 1);
+        hist = &g_array_index(prof->hists, CCLProfHist, ueid);
+        hist->event_name = event_name;
+        hist->counts = g_array_new(FALSE, TRUE, sizeof(guint));
+        hist->mean = 0;
+        hist->m2 = 0;
+        hist->seen = 0;
+        hist->sampled = 0;
+        hist->total_time = 0;
+        hist->total_latency = 0;
+        hist->counters = NULL;
+        hist->counters_time = 0;
+        hist->occupancy_time = 0;
+        hist->slowest = NULL;
+        hist->slowest_sorted = CL_FALSE;
 
-    /* Initalize table, and set aggregate values to zero. */
-    g_hash_table_iter_init(&iter, prof->event_names);
-    while (g_hash_table_iter_next(&iter, &event_name, NULL)) {
-        evagg = ccl_prof_agg_new(event_name);
-        evagg->absolute_time = 0;
-        g_hash_table_insert(
-            agg_table, event_name, (gpointer) evagg);
+    } else {
+
+        /* ...otherwise get the existing aggregate statistic. */
+        ueid = GPOINTER_TO_UINT(p_ueid);
+        agg = &g_array_index(prof->aggs, CCLProfAgg, ueid);
+        hist = &g_array_index(prof->hists, CCLProfHist, ueid);
     }
 
-    /* Sort event instants by eid, and then by START, END order. */
-    sort_type = CCL_PROF_INST_SORT_ID | CCL_PROF_SORT_ASC;
-    prof->instants = g_list_sort_with_data(
-        prof->instants, ccl_prof_inst_comp,
-        (gpointer) &sort_type);
+    /* Skip event if it is not sampled. */
+    hist->seen++;
+    if ((prof->sample_period > 1)
+            && ((hist->seen - 1) % prof->sample_period != 0))
+        goto finish;
+    if ((prof->sample_fraction > 0)
+            && (g_rand_double(prof->sample_rand) >= prof->sample_fraction))
+        goto finish;
+    hist->sampled++;
+
+    /* Fetch event instants and command type, if not already fetched. */
+    if (raw == NULL) {
+        ccl_prof_fetch(evt, &raw_fetched);
+        raw = &raw_fetched;
+    }
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != raw->status, raw->status, error_handler,
+        "%s: unable to get event profiling info (OpenCL error %d: %s).",
+        CCL_STRD, raw->status, ccl_err(raw->status));
+    instant_queued = raw->instants[0];
+    instant_submit = raw->instants[1];
+    instant_start = raw->instants[2];
+    instant_end = raw->instants[3];
+    command_type = raw->command_type;
+
+    /* If clocks were synchronized, convert instants to the host
+     * timebase. */
+    if ((prof->clock_offsets != NULL) && ((p_offset =
+        g_hash_table_lookup(prof->clock_offsets, cq_name)) != NULL)) {
+
+        instant_queued += (cl_ulong) *p_offset;
+        instant_submit += (cl_ulong) *p_offset;
+        instant_start += (cl_ulong) *p_offset;
+        instant_end += (cl_ulong) *p_offset;
+    }
 
-    /* Iterate through all event instants and determine total times. */
-    curr_evinst_container = prof->instants;
-    while (curr_evinst_container) {
+    /* If we get here, update number of profilable events, and get an ID
+     * for the given event. */
+    event_id = ++prof->num_events;
 
-        /* Loop aux. variables. */
-        CCLProfInst * curr_evinst = NULL;
-        cl_ulong start_inst, end_inst;
+    /* Attribute event to the host-side ranges open when it was queued,
+     * which is only possible if instants are in the host timebase. */
+    if ((p_offset != NULL) && (prof->ranges->len > 0))
+        ccl_prof_range_attribute(prof, instant_queued,
+            instant_end > instant_start ? instant_end - instant_start : 0);
 
-        /* Get START event instant. */
-        curr_evinst = (CCLProfInst *) curr_evinst_container->data;
-        start_inst = curr_evinst->instant;
+    /* If end instant occurs after start instant... */
+    if (instant_end > instant_start) {
 
-        /* Get END event instant */
-        curr_evinst_container = curr_evinst_container->next;
-        curr_evinst = (CCLProfInst *) curr_evinst_container->data;
-        end_inst = curr_evinst->instant;
+        /* Update aggregate statistics. */
+        agg->absolute_time += instant_end - instant_start;
+        prof->total_events_time += instant_end - instant_start;
+        ccl_prof_hist_add(hist, agg, instant_end - instant_start);
+        if (instant_start > instant_queued)
+            hist->total_latency += instant_start - instant_queued;
+
+        /* Collect performance counters of command, if requested. */
+        if ((evt != NULL) && (prof->counters_fn != NULL))
+            ccl_prof_counters_add(prof, hist, evt, command_type,
+                instant_end - instant_start);
+
+        /* Keep event if it is one of the slowest with its name. */
+        if (prof->slowest_k > 0) {
+            slow.info.event_name = event_name;
+            slow.info.command_type = command_type;
+            slow.info.queue_name = cq_name;
+            slow.info.t_queued = instant_queued;
+            slow.info.t_submit = instant_submit;
+            slow.info.t_start = instant_start;
+            slow.info.t_end = instant_end;
+            slow.tag = (evt != NULL) ? ccl_event_get_tag(evt) : NULL;
+            ccl_prof_slowest_add(prof, hist, &slow);
+        }
 
-        /* Add new interval to respective aggregate value. */
-        curr_agg = (CCLProfAgg *) g_hash_table_lookup(
-            agg_table, curr_evinst->event_name);
-        curr_agg->absolute_time += end_inst - start_inst;
-        prof->total_events_time += end_inst - start_inst;
+        /* Update live busy time of command queue. */
+        live = g_hash_table_lookup(prof->queue_live, cq_name);
+        if (live == NULL) {
+            live = g_new(CCLProfQueueLive, 1);
+            live->busy_time = 0;
+            live->t_first = instant_start;
+            live->t_last = instant_end;
+            g_hash_table_insert(prof->queue_live, (gpointer) cq_name, live);
+        }
+        live->busy_time += instant_end - instant_start;
+        live->t_first = MIN(live->t_first, instant_start);
+        live->t_last = MAX(live->t_last, instant_end);
 
-        /* Get next START event instant. */
-        curr_evinst_container = curr_evinst_container->next;
-    }
+        if (intervals == NULL) {
+
+            /* Add event start instant to array of event instants. */
+            ccl_prof_inst_add(prof->instants, event_name, cq_name,
+                event_id, instant_start, CCL_PROF_INST_TYPE_START);
+
+            /* Add event end instant to array of event instants. */
+            ccl_prof_inst_add(prof->instants, event_name, cq_name,
+                event_id, instant_end, CCL_PROF_INST_TYPE_END);
+
+        } else {
+
+            /* Add event interval to array of intervals. */
+            interval.event_name = event_name;
+            interval.ueid = ueid;
+            interval.gen = prof->drains;
+            interval.start = instant_start;
+            interval.end = instant_end;
+            g_array_append_val(intervals, interval);
+        }
+
+        /* Check if start instant is the oldest instant. If so, keep it. */
+        if (instant_start < prof->t_start)
+            prof->t_start = instant_start;
+
+    } else {
+
+        g_info("Event '%s' did not use device time. As such its "\
+            "start and end instants will not be added to the list of "\
+            "event instants.", event_name);
 
-    /* Determine relative times. */
-    g_hash_table_iter_init(&iter, agg_table);
-    while (g_hash_table_iter_next(&iter, &event_name, &value_agg)) {
-        curr_agg = (CCLProfAgg *) value_agg;
-        curr_agg->relative_time =
-            ((double) curr_agg->absolute_time)
-            /
-            ((double) prof->total_events_time);
     }
 
-    /* Keep a list of aggregates. */
-    prof->aggs = g_hash_table_get_values(agg_table);
+    /* Add event information to array of event information, or stream it
+     * to the background writer if events are being drained. */
+    if (intervals == NULL)
+        ccl_prof_info_add(prof->infos, event_name, command_type, cq_name,
+            instant_queued, instant_submit, instant_start, instant_end);
+    else if (prof->writer != NULL)
+        ccl_prof_writer_push(prof->writer, cq_name, event_name,
+            instant_start, instant_end);
 
-    /* Release aux. hash table. */
-    g_hash_table_destroy(agg_table);
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return. */
+    return;
 }
 
 /**
  * @internal
  *
- * @brief Determine event overlaps for the given profile object.
+ * @brief Detach a command queue from a profile object and release it.
  *
  * @private @memberof ccl_prof
  *
- * @param[in] prof Profile object.
- */
-static void ccl_prof_calc_overlaps(CCLProf * prof) {
-
-    /* Make sure profile object is not NULL. */
-    g_return_if_fail(prof != NULL);
+ * @param[in] cq Command queue wrapper object.
+ * */
+static void ccl_prof_queue_release(CCLQueue * cq) {
 
-    /* Total overlap time. */
-    cl_ulong total_overlap = 0;
-    /* Overlap matrix. */
-    cl_ulong * overlap_matrix = NULL;
-    /* Number of event names. */
-    cl_uint num_event_names;
-    /* Helper table to account for all overlapping events. */
-    GHashTable * overlaps = NULL;
-    /* Occurring events table. */
-    GHashTable * occurring_events = NULL;
-    /* Type of sorting to perform. */
-    CCLProfInstSort sort_type;
-    /* Container for current event instants. */
-    GList * curr_evinst_container;
-
-    /* Determine number of event names. */
-    num_event_names = g_hash_table_size(prof->event_names);
-
-    /* Initialize overlap matrix. */
-    overlap_matrix = g_slice_alloc0(
-        sizeof(cl_ulong) * num_event_names * num_event_names);
-
-    /* Initialize helper table to account for all overlapping events. */
-    overlaps = g_hash_table_new_full(g_direct_hash, g_direct_equal,
-        NULL, (GDestroyNotify) g_hash_table_destroy);
-
-    /* Setup ocurring events table (key: eventID, value: eventNameID) */
-    occurring_events = g_hash_table_new(g_int_hash, g_int_equal);
-
-    /* Sort all event instants. */
-    sort_type = CCL_PROF_INST_SORT_INSTANT | CCL_PROF_SORT_ASC;
-    prof->instants = g_list_sort_with_data(prof->instants,
-        ccl_prof_inst_comp, (gpointer) &sort_type);
-
-    /* Iterate through all event instants */
-    curr_evinst_container = prof->instants;
-    while (curr_evinst_container) {
-
-        /* ** Loop aux. variables. ** */
-
-        /* Current event instant. */
-        CCLProfInst * curr_evinst = NULL;
-        /* Inner hash table (is value for overlap hash table). */
-        GHashTable * inner_table = NULL;
-        /* Hash table iterator. */
-        GHashTableIter iter;
-        /* Hashtable key, event name ID for current event, event
-         * name ID for occurring event. */
-        gpointer key_eid, ueid_curr_ev, ueid_occu_ev;
-        /* Keys for start and end event instants. */
-        cl_uint eid_key1, eid_key2;
-        /* Event overlap in nanoseconds. */
-        cl_ulong eff_overlap;
-
-        /* Get current event instant. */
-        curr_evinst = (CCLProfInst *) curr_evinst_container->data;
-
-        /* Check if event time is START or END time */
-        if (curr_evinst->type == CCL_PROF_INST_TYPE_START) {
-            /* Event START instant. */
-
-            /* 1 - Check for overlaps with ocurring events */
-
-            g_hash_table_iter_init(&iter, occurring_events);
-            while (g_hash_table_iter_next (&iter, &key_eid, NULL)) {
-
-                /* The first hash table key will be the smaller event id. */
-                eid_key1 = curr_evinst->id <= *((cl_uint *) key_eid)
-                    ? curr_evinst->id
-                    : *((cl_uint *) key_eid);
-                /* The second hash table key will be the larger event id. */
-                eid_key2 = curr_evinst->id > *((cl_uint *) key_eid)
-                    ? curr_evinst->id
-                    : *((cl_uint *) key_eid);
-                /* Check if the first key (smaller id) is already in the
-                 * hash table... */
-                if (!g_hash_table_lookup_extended(overlaps,
-                    GUINT_TO_POINTER(eid_key1), NULL,
-                    (gpointer) &inner_table)) {
-                    /* ...if not in table, add it to table, creating a new
-                     * inner table as value. Inner table will be initalized
-                     * with second key (larger id) as key and event start
-                     * instant as value. */
-                    inner_table = g_hash_table_new(
-                        g_direct_hash, g_direct_equal);
-                    g_hash_table_insert(
-                        overlaps, GUINT_TO_POINTER(eid_key1), inner_table);
-                }
-                /* Add second key (larger id) to inner tabler, setting the
-                 * start instant as the value. */
-                g_hash_table_insert(
-                    inner_table,
-                    GUINT_TO_POINTER(eid_key2),
-                    &(curr_evinst->instant));
-            }
+    ccl_queue_prof_attach(cq, CL_FALSE);
+    ccl_queue_destroy(cq);
+}
 
-            /* 2 - Add event to occurring events. */
-            g_hash_table_insert(
-                occurring_events,
-                &(curr_evinst->id), /* eid */
-                g_hash_table_lookup(prof->event_names,
-                    curr_evinst->event_name) /* ueid */
-            );
+/**
+ * @internal
+ *
+ * @brief Check that a command queue has profiling enabled.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in] cq_name Command queue name.
+ * @param[in] cq Command queue wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The command queue properties.
+ */
+static cl_command_queue_properties ccl_prof_check_queue(
+    const char * cq_name, CCLQueue * cq, CCLErr ** err) {
 
-        } else {
-            /* Event END instant. */
-
-            /* 1 - Remove event from ocurring events */
-            g_hash_table_remove(occurring_events, &(curr_evinst->id));
-
-            /* 2 - Check for overlap termination with current events */
-            g_hash_table_iter_init(&iter, occurring_events);
-            while (g_hash_table_iter_next(&iter, &key_eid, &ueid_occu_ev)) {
-                /* The first hash table key will be the smaller event id. */
-                eid_key1 = curr_evinst->id <= *((cl_uint *) key_eid)
-                    ? curr_evinst->id
-                    : *((cl_uint *) key_eid);
-                /* The second hash table key will be the larger event id. */
-                eid_key2 = curr_evinst->id > *((cl_uint *) key_eid)
-                    ? curr_evinst->id
-                    : *((cl_uint *) key_eid);
-                /* Get effective overlap in nanoseconds. */
-                inner_table = g_hash_table_lookup(
-                    overlaps, GUINT_TO_POINTER(eid_key1));
-                eff_overlap =
-                    curr_evinst->instant
-                    -
-                    *((cl_ulong *) g_hash_table_lookup(
-                        inner_table, GUINT_TO_POINTER(eid_key2)));
-                /* Add overlap to overlap matrix. */
-                ueid_curr_ev = g_hash_table_lookup(
-                    prof->event_names, curr_evinst->event_name);
-                cl_uint ueid_min =
-                    GPOINTER_TO_UINT(ueid_curr_ev)
-                        <= GPOINTER_TO_UINT(ueid_occu_ev)
-                    ? GPOINTER_TO_UINT(ueid_curr_ev)
-                    : GPOINTER_TO_UINT(ueid_occu_ev);
-                cl_uint ueid_max =
-                    GPOINTER_TO_UINT(ueid_curr_ev)
-                        > GPOINTER_TO_UINT(ueid_occu_ev)
-                    ? GPOINTER_TO_UINT(ueid_curr_ev)
-                    : GPOINTER_TO_UINT(ueid_occu_ev);
-                overlap_matrix[ueid_min * num_event_names + ueid_max] +=
-                    eff_overlap;
-                total_overlap += eff_overlap;
-            }
-        }
+    /* Queue properties. */
+    cl_command_queue_properties qprop = 0;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
 
-        /* Get next event instant. */
-        curr_evinst_container = curr_evinst_container->next;
-    }
-
-    /* Populate list of overlaps. */
-    for (cl_uint i = 0; i < num_event_names; i++) {
-        for (cl_uint j = 0; j < num_event_names; j++) {
-            if (overlap_matrix[i * num_event_names + j] > 0) {
-                /* There is an overlap here, create overlap object... */
-                CCLProfOverlap * ovlp = ccl_prof_overlap_new(
-                    (const char *) g_hash_table_lookup(
-                        prof->event_name_ids, GUINT_TO_POINTER(i)),
-                    (const char *) g_hash_table_lookup(
-                        prof->event_name_ids, GUINT_TO_POINTER(j)),
-                    overlap_matrix[i * num_event_names + j]);
-                /*  ...and add it to list of overlaps. */
-                prof->overlaps = g_list_prepend(
-                    prof->overlaps, (gpointer) ovlp);
-            }
-        }
-    }
+    /* Check that queue has profiling enabled. */
+    qprop = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (qprop & CL_QUEUE_PROFILING_ENABLE) == 0, CCL_ERROR_OTHER,
+        error_handler,
+        "%s: the '%s' queue does not have profiling enabled.",
+        CCL_STRD, cq_name);
 
-    /* Determine and save effective events time. */
-    prof->total_events_eff_time = prof->total_events_time - total_overlap;
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
 
-    /* Free the overlaps matrix. */
-    g_slice_free1(
-        sizeof(cl_ulong) * num_event_names * num_event_names, overlap_matrix);
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
 
-    /* Free overlaps hash table. */
-    g_hash_table_destroy(overlaps);
+finish:
 
-    /* Free occurring_events hash table. */
-    g_hash_table_destroy(occurring_events);
+    /* Return queue properties. */
+    return qprop;
 }
 
 /**
- * @addtogroup CCL_PROFILER
- * @{
- */
-
-/**
- * Create a new profile object.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Release the recorded dependencies of profiled commands and clear
+ * the array of profiled commands.
  *
- * @return A new profile object.
+ * @private @memberof ccl_prof
+ *
+ * @param[in,out] nodes Array of profiled commands.
  * */
-CCL_EXPORT
-CCLProf * ccl_prof_new() {
-
-    /* Allocate memory for new profile data structure. */
-    CCLProf * prof = g_slice_new0(CCLProf);
-
-    /* Set absolute start time to maximum possible. */
-    prof->t_start = CL_ULONG_MAX;
+static void ccl_prof_nodes_clear(GArray * nodes) {
 
-    /* Return new profile data structure */
-    return prof;
+    for (guint i = 0; i < nodes->len; ++i)
+        g_free(g_array_index(nodes, CCLProfNode, i).deps);
+    g_array_set_size(nodes, 0);
 }
 
 /**
- * Destroy a profile object.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Determine the offset from the clock of the device associated
+ * with a command queue to the host timebase.
  *
- * @param[in] prof Profile object to destroy.
+ * If the platform and device support OpenCL >= 2.1, the device and host
+ * timers are sampled with clGetDeviceAndHostTimer(), and the host timer
+ * is related to the host timebase with clGetHostTimer(). Otherwise, the
+ * offset is estimated by enqueuing a marker and relating its end instant
+ * to the host time at which it was enqueued and waited for. For the
+ * latter to be accurate, the queue should be idle.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Offset in nanoseconds which converts device instants to the host
+ * timebase, i.e. to nanoseconds of g_get_monotonic_time().
  * */
-CCL_EXPORT
-void ccl_prof_destroy(CCLProf * prof) {
+static gint64 ccl_prof_clock_offset(CCLQueue * cq, CCLErr ** err) {
+
+    /* Host times before and after sampling device clock, in
+     * microseconds. */
+    gint64 host_before, host_after;
+    /* Device instant. */
+    cl_ulong dev_instant;
+    /* Offset to return. */
+    gint64 offset = 0;
+    /* Marker event. */
+    cl_event marker = NULL;
+    /* OpenCL status. */
+    cl_int ocl_status;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
 
-    /* Profile to destroy cannot be NULL. */
-    g_return_if_fail(prof != NULL);
+#ifdef CL_VERSION_2_1
 
-    /* Destroy table of event names. */
-    if (prof->event_names != NULL)
-        g_hash_table_destroy(prof->event_names);
+    /* Device associated with queue. */
+    CCLDevice * dev;
+    /* OpenCL version of device and platform. */
+    cl_uint dev_ver, platf_ver;
+    /* Host timer instants. */
+    cl_ulong host_instant, host_instant2;
 
-    /* Destroy table of event IDs. */
-    if (prof->event_name_ids != NULL)
-        g_hash_table_destroy(prof->event_name_ids);
+    /* Get device and OpenCL versions. */
+    dev = ccl_queue_get_device(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    dev_ver = ccl_device_get_opencl_version(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    platf_ver = ccl_context_get_opencl_version(
+        ccl_queue_get_context(cq, NULL), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Destroy table of command queue wrappers. */
-    if (prof->queues != NULL)
-        g_hash_table_destroy(prof->queues);
+    /* Sample device and host timers, if supported. */
+    if ((dev_ver >= 210) && (platf_ver >= 210)) {
+
+        host_before = g_get_monotonic_time();
+        ocl_status = clGetDeviceAndHostTimer(
+            ccl_device_unwrap(dev), &dev_instant, &host_instant);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error in clGetDeviceAndHostTimer() (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+        ocl_status = clGetHostTimer(ccl_device_unwrap(dev), &host_instant2);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: error in clGetHostTimer() (OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+        host_after = g_get_monotonic_time();
+
+        /* Device to host timer offset, plus host timer to host timebase
+         * offset. */
+        offset = (gint64) (host_instant - dev_instant)
+            + (host_before + host_after) * 500
+            - (gint64) host_instant2;
+
+        goto finish;
+    }
 
-    /* Destroy list of all event instants. */
-    if (prof->instants != NULL)
-        g_list_free_full(
-            prof->instants, (GDestroyNotify) ccl_prof_inst_destroy);
+#endif
 
-    /* Destroy list of event profiling information. */
-    if (prof->infos != NULL)
-        g_list_free_full(
-            prof->infos, (GDestroyNotify) ccl_prof_info_destroy);
+    /* Enqueue marker and wait for it. */
+    host_before = g_get_monotonic_time();
+    marker = ccl_queue_enqueue_marker_raw(cq, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ocl_status = clWaitForEvents(1, &marker);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: error in clWaitForEvents() (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+    host_after = g_get_monotonic_time();
+
+    /* Get marker end instant. */
+    ocl_status = clGetEventProfilingInfo(marker, CL_PROFILING_COMMAND_END,
+        sizeof(cl_ulong), &dev_instant, NULL);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: error in clGetEventProfilingInfo() (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Assume the marker terminated midway between enqueuing it and
+     * waiting for it. */
+    offset = (host_before + host_after) * 500 - (gint64) dev_instant;
 
-    /* Destroy list of aggregate statistics. */
-    if (prof->aggs != NULL)
-        g_list_free_full(
-            prof->aggs, (GDestroyNotify) ccl_prof_agg_destroy);
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
 
-    /* Free the overlap matrix. */
-    if (prof->overlaps != NULL)
-        g_list_free_full(
-            prof->overlaps, (GDestroyNotify) ccl_prof_overlap_destroy);
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
 
-    /* Free the summary string. */
-    if (prof->summary != NULL)
-        g_free(prof->summary);
+finish:
 
-    /* Destroy timer. */
-    if (prof->timer != NULL)
-        g_timer_destroy(prof->timer);
+    /* Release marker event. */
+    if (marker != NULL) clReleaseEvent(marker);
 
-    /* Destroy profile data structure. */
-    g_slice_free(CCLProf, prof);
+    /* Return offset. */
+    return offset;
 }
 
 /**
- * Starts the global profiler timer. Only required if client wishes to compare
- * the effectively elapsed time with the OpenCL kernels time.
- *
- * @public @memberof ccl_prof
+ * @internal
  *
- * @param[in] prof A profile object.
- * */
-CCL_EXPORT
-void ccl_prof_start(CCLProf * prof) {
-
-    /* Make sure profile is not NULL. */
-    g_return_if_fail(prof != NULL);
-
-    /* Start timer. */
-    prof->timer = g_timer_new();
-}
-
-/**
- * Stops the global profiler timer.
- * Only required if ccl_prof_start() was called.
+ * @brief Add event of a command queue for profiling, ignoring events
+ * which don't provide profiling info.
  *
- * @public @memberof ccl_prof
+ * @private @memberof ccl_prof
  *
- * @param[in] prof A profile object.
- * */
-CCL_EXPORT
-void ccl_prof_stop(CCLProf * prof) {
+ * @param[in] prof Profile object.
+ * @param[in] cq_name Command queue name.
+ * @param[in] evt Event wrapper object.
+ * @param[in] raw Previously fetched raw profiling data of event, or `NULL`
+ * (see ccl_prof_add_event()).
+ * @param[out] intervals Array of event intervals, or `NULL` (see
+ * ccl_prof_add_event()).
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ */
+static void ccl_prof_add_queue_event(CCLProf * prof, const char * cq_name,
+    CCLEvent * evt, const CCLProfRaw * raw, GArray * intervals,
+    CCLErr ** err) {
 
-    /* Make sure profile is not NULL. */
-    g_return_if_fail(prof != NULL);
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
 
-    /* Stop timer. */
-    g_timer_stop(prof->timer);
+    /* Add event for profiling. */
+    ccl_prof_add_event(prof, cq_name, evt, ccl_event_get_final_name(evt),
+        raw, intervals, &err_internal);
+    if ((err_internal != NULL) &&
+        (((err_internal->domain == CCL_OCL_ERROR) &&
+         (err_internal->code == CL_PROFILING_INFO_NOT_AVAILABLE))
+        ||
+         ((err_internal->domain == CCL_ERROR) &&
+         (err_internal->code == CCL_ERROR_INFO_UNAVAILABLE_OCL)))) {
+
+        /* Some types of events in certain platforms don't
+         * provide profiling info. Don't stop profiling,
+         * ignore this specific event, but log a message
+         * saying so. */
+        g_info("The '%s' event does not have profiling info",
+            ccl_event_get_final_name(evt));
+        ccl_err_clear(&err_internal);
+    }
+    g_propagate_error(err, err_internal);
 }
 
 /**
- * If profiling has started but not stopped, returns the time since the
- * profiling started. If profiling has been stopped, returns the elapsed time
- * between the time it started and the time it stopped.
- *
- * @public @memberof ccl_prof
+ * @internal
  *
- * @param[in] prof A profile object.
- * @return number of seconds elapsed, including any fractional part.
- * */
-CCL_EXPORT
-double ccl_prof_time_elapsed(CCLProf * prof) {
-
-    /* Make sure profile is not NULL. */
-    g_return_val_if_fail(prof != NULL, 0.0);
-
-    /* Stop timer. */
-    return g_timer_elapsed(prof->timer, NULL);
-}
-
-/**
- * Add a command queue wrapper for profiling.
+ * @brief Fetch the raw profiling data of all events in a command queue. It
+ * is an implementation of `GFunc` from GLib, executed by the worker threads
+ * of ccl_prof_process_queues().
  *
- * @public @memberof ccl_prof
+ * @private @memberof ccl_prof
  *
- * @param[in] prof A profile object.
- * @param[in] cq_name Command queue name.
- * @param[in] cq Command queue wrapper object.
+ * @param[in,out] data Fetching task (::CCLProfFetchTask*).
+ * @param[in] user_data Unused.
  * */
-CCL_EXPORT
-void ccl_prof_add_queue(CCLProf * prof, const char * cq_name, CCLQueue * cq) {
-
-    /* Make sure profile is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* Make sure cq is not NULL. */
-    g_return_if_fail(cq != NULL);
-    /* Must be added before calculations. */
-    g_return_if_fail(prof->calc == FALSE);
-
-    /* Check if table needs to be created first. */
-    if (prof->queues == NULL) {
-        prof->queues = g_hash_table_new_full(
-            g_str_hash, g_direct_equal, NULL,
-            (GDestroyNotify) ccl_queue_destroy);
+static void ccl_prof_fetch_queue(gpointer data, gpointer user_data) {
+
+    /* Fetching task. */
+    CCLProfFetchTask * task = (CCLProfFetchTask *) data;
+    /* Current event and respective raw profiling data. */
+    CCLEvent * evt;
+    CCLProfRaw raw;
+
+    /* Avoid compiler warnings. */
+    (void) user_data;
+
+    /* Fetch raw data of all events in queue. Errors are reported when
+     * the events are added for profiling. */
+    ccl_queue_iter_event_init(task->cq);
+    while ((evt = ccl_queue_iter_event_next(task->cq))) {
+        ccl_prof_fetch(evt, &raw);
+        g_array_append_val(task->raws, raw);
     }
-    /* Warn if table already contains a queue with the specified
-     * name. */
-    if (g_hash_table_contains(prof->queues, cq_name))
-        g_warning("Profile object already contains a queue named '%s'." \
-            "The existing queue will be replaced.", cq_name);
-
-    /* Add queue to queue table. */
-    g_hash_table_replace(prof->queues, (gpointer) cq_name, cq);
-
-    /* Increment queue ref. count. */
-    ccl_queue_ref(cq);
 }
 
 /**
- * Determine aggregate statistics for the given profile object.
+ * @internal
  *
- * The command queues to be profiled will have their events garbage collected
- * with ::ccl_queue_gc(). As such, they can be reused and re-added for
- * profiling to a new profile object.
+ * @brief Process command queues, i.e., add the respective events for
+ * profiling.
  *
- * @public @memberof ccl_prof
+ * If more than one queue is profiled and sampling is disabled, the
+ * profiling data of the events in each queue is first fetched in parallel
+ * by a pool of threads, one queue per thread. Events are then added for
+ * profiling in the same order as if fetched sequentially, so results do
+ * not depend on the number of threads.
  *
- * @param[in] prof A profile object.
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return `CL_TRUE` if function terminates successfully, or `CL_FALSE`
- * otherwise.
- * */
-CCL_EXPORT
-cl_bool ccl_prof_calc(CCLProf * prof, CCLErr ** err) {
+ */
+static void ccl_prof_process_queues(CCLProf * prof, CCLErr ** err) {
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, CL_FALSE);
     /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
-    /* Calculations can only be performed once. */
-    g_return_val_if_fail(prof->calc == FALSE, CL_FALSE);
-    /* There must be some queues to process. */
-    g_return_val_if_fail(prof->queues != NULL, CL_FALSE);
-
-    /* Internal error handling object. */
-    CCLErr * err_internal = NULL;
-
-    /* Function return status flag. */
-    cl_bool status;
+    g_return_if_fail(err == NULL || *err == NULL);
+    /* Make sure profile object is not NULL. */
+    g_return_if_fail(prof != NULL);
 
     /* Hash table iterator. */
     GHashTableIter iter;
+    /* Command queue name and wrapper. */
+    gpointer cq_name;
+    gpointer cq;
+    /* Fetching tasks, one per queue. */
+    guint num_tasks = g_hash_table_size(prof->queues);
+    CCLProfFetchTask * tasks = g_new0(CCLProfFetchTask, num_tasks);
+    CCLProfFetchTask * task;
+    /* Pool of threads for fetching profiling data in parallel. */
+    GThreadPool * pool = NULL;
+    /* Current event and respective raw profiling data. */
+    CCLEvent * evt;
+    const CCLProfRaw * raw;
+    /* Profiled command and index of the previous one in the queue. */
+    CCLProfNode node;
+    gint prev;
+    /* Recorded dependencies of command. */
+    const cl_event * deps;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
 
-    /* Auxiliary pointers for determining the table of event_ids. */
-    gpointer p_evt_name, p_id;
+    /* Check that queues have profiling enabled, and check if they are
+     * in-order. */
+    g_hash_table_iter_init(&iter, prof->queues);
+    for (guint i = 0; g_hash_table_iter_next(&iter, &cq_name, &cq); ++i) {
+        tasks[i].cq_name = (const char *) cq_name;
+        tasks[i].cq = (CCLQueue *) cq;
+        tasks[i].in_order = (ccl_prof_check_queue((const char *) cq_name,
+            (CCLQueue *) cq, &err_internal)
+            & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) == 0;
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
 
-    /* Create table of event names. */
-    prof->event_names = g_hash_table_new(g_str_hash, g_str_equal);
+    /* Fetch profiling data in parallel, unless events are sampled, in
+     * which case sampled out events are not fetched at all. If the thread
+     * pool can't be created, fetch data sequentially. */
+    if ((num_tasks > 1) && (prof->sample_period <= 1)
+            && (prof->sample_fraction <= 0)) {
+
+        pool = g_thread_pool_new(ccl_prof_fetch_queue, NULL,
+            (gint) MIN(num_tasks, g_get_num_processors()), FALSE, NULL);
+        for (guint i = 0; (pool != NULL) && (i < num_tasks); ++i) {
+            tasks[i].raws = g_array_new(FALSE, FALSE, sizeof(CCLProfRaw));
+            g_thread_pool_push(pool, &tasks[i], NULL);
+        }
+        /* Wait for all tasks to finish. */
+        if (pool != NULL)
+            g_thread_pool_free(pool, FALSE, TRUE);
+    }
 
-    /* Process queues and respective events. */
-    ccl_prof_process_queues(prof, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    /* Add events of each queue for profiling. */
+    for (guint i = 0; i < num_tasks; ++i) {
+
+        task = &tasks[i];
+        prev = -1;
+        raw = NULL;
+        if (task->raws == NULL)
+            ccl_queue_iter_event_init(task->cq);
+
+        /* Iterate over the events in current command queue, or over
+         * their previously fetched profiling data. */
+        for (guint j = 0; ; ++j) {
+
+            /* Get next event. */
+            if (task->raws != NULL) {
+                if (j >= task->raws->len) break;
+                raw = &g_array_index(task->raws, CCLProfRaw, j);
+                evt = raw->evt;
+            } else if (!(evt = ccl_queue_iter_event_next(task->cq))) {
+                break;
+            }
 
-    /* Obtain the event_ids table (by reversing the event_names table) */
-    prof->event_name_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
-    /* Populate table. */
-    g_hash_table_iter_init(&iter, prof->event_names);
-    while (g_hash_table_iter_next(&iter, &p_evt_name, &p_id)) {
-        g_hash_table_insert(prof->event_name_ids, p_id, p_evt_name);
-    }
+            /* Add event for profiling. */
+            node.info = prof->infos->len;
+            ccl_prof_add_queue_event(
+                prof, task->cq_name, evt, raw, NULL, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Calculate aggregate statistics. */
-    ccl_prof_calc_agg(prof);
+            /* If event was profiled, add it to the graph of command
+             * dependencies, since its dependencies may be released with
+             * the queue events. */
+            if (prof->infos->len > node.info) {
+                node.event = ccl_event_unwrap(evt);
+                deps = ccl_event_get_deps(evt, &node.num_deps);
+                node.deps = (node.num_deps > 0)
+                    ? g_memdup(deps, node.num_deps * sizeof(cl_event))
+                    : NULL;
+                node.prev = task->in_order ? prev : -1;
+                g_array_append_val(prof->nodes, node);
+                prev = prof->nodes->len - 1;
+            }
+        }
 
-    /* Determine event overlaps. */
-    ccl_prof_calc_overlaps(prof);
+        /* Release queue events. */
+        ccl_queue_gc(task->cq);
+    }
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
-    status = CL_TRUE;
-    prof->calc = TRUE;
     goto finish;
 
 error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
-    status = CL_FALSE;
 
 finish:
 
-    /* Return status. */
-    return status;
+    /* Release fetching tasks. */
+    for (guint i = 0; i < num_tasks; ++i)
+        if (tasks[i].raws != NULL)
+            g_array_free(tasks[i].raws, TRUE);
+    g_free(tasks);
 }
 
 /**
- * Return aggregate statistics for events with the given name.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Determine the critical path through the graph of profiled
+ * commands, and the slack of each command.
  *
- * @param[in] prof Profile object.
- * @param[in] event_name Event name.
- * @return Aggregate statistics for events with the given name.
- */
-CCL_EXPORT
-const CCLProfAgg * ccl_prof_get_agg(CCLProf * prof, const char * event_name) {
+ * The graph is composed of the profiled commands, with their durations,
+ * and of the dependencies between them, i.e. the previous command in the
+ * same in-order queue and the recorded wait list events which were also
+ * profiled. The earliest start of each command is determined in
+ * topological order, and the latest start which does not increase the
+ * duration of the critical path in reverse topological order. The slack
+ * is the difference between both.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof The profile object.
+ * */
+static void ccl_prof_calc_critical_path(CCLProf * prof) {
+
+    /* Number of commands. */
+    guint n = prof->nodes->len;
+    /* Table of command indexes (keys: OpenCL events; values: index + 1). */
+    GHashTable * ids;
+    /* Dependency edges, as pairs of command indexes. */
+    GArray * edges;
+    /* Successors of each command, and offsets of successors of each
+     * command in the former. */
+    guint * succs, * succ_offs;
+    /* Number of successors already placed for each command. */
+    guint * num_placed;
+    /* Number of pending dependencies of each command. */
+    guint * num_pending;
+    /* Commands in topological order. */
+    guint * order;
+    guint num_ordered = 0;
+    /* Durations, earliest start and latest start of commands. */
+    cl_ulong * dur, * es, * ls;
+    /* Auxiliary variables. */
+    CCLProfNode * node;
+    CCLProfSlack slack;
+    guint edge[2];
+
+    /* Nothing to do if there are no commands. */
+    if (n == 0) return;
+
+    /* Map events to commands and determine durations. */
+    ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    dur = g_new0(cl_ulong, n);
+    for (guint i = 0; i < n; ++i) {
+        CCLProfInfo * info;
+        node = &g_array_index(prof->nodes, CCLProfNode, i);
+        info = &g_array_index(prof->infos, CCLProfInfo, node->info);
+        g_hash_table_insert(ids, node->event, GUINT_TO_POINTER(i + 1));
+        if (info->t_end > info->t_start)
+            dur[i] = info->t_end - info->t_start;
+    }
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
-    /* Make sure event name is not NULL. */
-    g_return_val_if_fail(event_name != NULL, NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
+    /* Collect dependency edges. */
+    edges = g_array_new(FALSE, FALSE, 2 * sizeof(guint));
+    num_pending = g_new0(guint, n);
+    succ_offs = g_new0(guint, n + 1);
+    for (guint i = 0; i < n; ++i) {
+        node = &g_array_index(prof->nodes, CCLProfNode, i);
+        edge[1] = i;
+        if (node->prev >= 0) {
+            edge[0] = (guint) node->prev;
+            g_array_append_val(edges, edge);
+        }
+        for (cl_uint j = 0; j < node->num_deps; ++j) {
+            guint id = GPOINTER_TO_UINT(
+                g_hash_table_lookup(ids, node->deps[j]));
+            if ((id > 0) && (id - 1 != i) && ((gint) id - 1 != node->prev)) {
+                edge[0] = id - 1;
+                g_array_append_val(edges, edge);
+            }
+        }
+    }
 
-    /* Find the aggregate statistic for the given event. */
-    CCLProfAgg * agg = NULL;
-    GList * agg_container = prof->aggs;
-    while (agg_container != NULL) {
-        const char * curr_event_name =
-            ((CCLProfAgg *) agg_container->data)->event_name;
-        if (g_strcmp0(event_name, curr_event_name) == 0) {
-            agg = (CCLProfAgg *) agg_container->data;
-            break;
+    /* Build successor lists. */
+    for (guint e = 0; e < edges->len; ++e) {
+        guint * curr = &g_array_index(edges, guint, 2 * e);
+        succ_offs[curr[0] + 1]++;
+        num_pending[curr[1]]++;
+    }
+    for (guint i = 0; i < n; ++i)
+        succ_offs[i + 1] += succ_offs[i];
+    succs = g_new(guint, MAX(edges->len, 1));
+    num_placed = g_new0(guint, n);
+    for (guint e = 0; e < edges->len; ++e) {
+        guint * curr = &g_array_index(edges, guint, 2 * e);
+        succs[succ_offs[curr[0]] + num_placed[curr[0]]++] = curr[1];
+    }
+    g_free(num_placed);
+
+    /* Determine topological order and earliest starts. */
+    order = g_new(guint, n);
+    es = g_new0(cl_ulong, n);
+    for (guint i = 0; i < n; ++i)
+        if (num_pending[i] == 0) order[num_ordered++] = i;
+    for (guint k = 0; k < num_ordered; ++k) {
+        guint i = order[k];
+        for (guint e = succ_offs[i]; e < succ_offs[i + 1]; ++e) {
+            guint j = succs[e];
+            es[j] = MAX(es[j], es[i] + dur[i]);
+            if (--num_pending[j] == 0) order[num_ordered++] = j;
         }
-        agg_container = agg_container->next;
     }
 
-    /* Return result. */
-    return agg;
+    /* Cycles should not occur, because commands can only depend on
+     * previously enqueued commands. */
+    if (num_ordered < n) {
+        g_warning("Dependency cycle found among profiled commands. "
+            "Command slacks will not be determined.");
+        goto finish;
+    }
+
+    /* Determine duration of critical path. */
+    prof->crit_duration = 0;
+    for (guint i = 0; i < n; ++i)
+        prof->crit_duration = MAX(prof->crit_duration, es[i] + dur[i]);
+
+    /* Determine latest starts in reverse topological order. */
+    ls = g_new(cl_ulong, n);
+    for (guint k = n; k > 0; --k) {
+        guint i = order[k - 1];
+        cl_ulong lf = prof->crit_duration;
+        for (guint e = succ_offs[i]; e < succ_offs[i + 1]; ++e)
+            lf = MIN(lf, ls[succs[e]]);
+        ls[i] = lf - dur[i];
+    }
+
+    /* Save command slacks. */
+    for (guint i = 0; i < n; ++i) {
+        CCLProfInfo * info;
+        node = &g_array_index(prof->nodes, CCLProfNode, i);
+        info = &g_array_index(prof->infos, CCLProfInfo, node->info);
+        slack.event_name = info->event_name;
+        slack.queue_name = info->queue_name;
+        slack.t_start = info->t_start;
+        slack.t_end = info->t_end;
+        slack.slack = ls[i] - es[i];
+        g_array_append_val(prof->slacks, slack);
+    }
+    g_free(ls);
+
+finish:
+
+    /* Release temporary data and profiled commands. */
+    g_hash_table_destroy(ids);
+    g_array_free(edges, TRUE);
+    g_free(succs);
+    g_free(succ_offs);
+    g_free(num_pending);
+    g_free(order);
+    g_free(dur);
+    g_free(es);
+    ccl_prof_nodes_clear(prof->nodes);
 }
 
 /**
- * Initialize an iterator for profiled aggregate event instances.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Add an event to the utilization of a command queue or device.
+ * Events must be added by start time.
  *
- * @param[in] prof Profile object.
- * @param[in] sort Bitfield of ::CCLProfAggSort OR ::CCLProfSortOrder,
- * for example `CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_DESC`.
+ * @private @memberof ccl_prof_util_acc
+ *
+ * @param[in,out] acc Utilization of command queue or device.
+ * @param[in] info Profiling info of event to add.
  * */
-CCL_EXPORT
-void ccl_prof_iter_agg_init(CCLProf * prof, int sort) {
-
-    /* Make sure prof is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_if_fail(prof->calc == TRUE);
-
-    /* Sort list of aggregate statistics as requested by client. */
-    prof->aggs = g_list_sort_with_data(prof->aggs, ccl_prof_agg_comp, &sort);
+static void ccl_prof_util_add(CCLProfUtilAcc * acc, CCLProfInfo * info) {
+
+    /* Event start and end. */
+    cl_ulong t_start = info->t_start;
+    cl_ulong t_end = MAX(info->t_end, info->t_start);
+
+    if (!acc->started) {
+
+        /* First event. */
+        acc->t_first = t_start;
+        acc->t_last = t_end;
+        acc->util.busy_time = t_end - t_start;
+        acc->started = TRUE;
+
+    } else if (t_start > acc->t_last) {
+
+        /* Event starts after an idle gap. */
+        cl_ulong gap = t_start - acc->t_last;
+        acc->util.num_gaps++;
+        acc->util.idle_time += gap;
+        acc->util.max_gap = MAX(acc->util.max_gap, gap);
+        /* Part of the gap before the event was queued by the host. */
+        if (info->t_queued > acc->t_last)
+            acc->util.host_lag_time +=
+                MIN(info->t_queued, t_start) - acc->t_last;
+        acc->util.busy_time += t_end - t_start;
+        acc->t_last = t_end;
+
+    } else if (t_end > acc->t_last) {
+
+        /* Event overlaps previous events and ends after them. */
+        acc->util.busy_time += t_end - acc->t_last;
+        acc->t_last = t_end;
+    }
 
-    /* Set the iterator as the first element in list. */
-    prof->agg_iter = prof->aggs;
+    /* Update span. */
+    acc->util.span = acc->t_last - acc->t_first;
 }
 
 /**
- * Return the next aggregate statistic instance.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Compares the start times of two event profiling infos, given by
+ * reference. It is an implementation of `GCompareFunc` from GLib.
  *
- * @param[in] prof Profile object.
- * @return The next aggregate statistic instance or `NULL` if no more instances
- * are left.
+ * @private @memberof ccl_prof_info
+ *
+ * @param[in] a Reference to first event profiling info.
+ * @param[in] b Reference to second event profiling info.
+ * @return Negative value if `a < b`; zero if `a == b`; positive value if
+ * `a > b`.
  * */
-CCL_EXPORT
-const CCLProfAgg * ccl_prof_iter_agg_next(CCLProf * prof) {
-
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
+static gint ccl_prof_info_ref_comp(gconstpointer a, gconstpointer b) {
 
-    /* The aggregate statistic to return. */
-    CCLProfAgg * agg;
-
-    /* Check if there are any more left. */
-    if (prof->agg_iter != NULL) {
-        /* Yes, send current one, pass to the next. */
-        agg = (CCLProfAgg *) prof->agg_iter->data;
-        prof->agg_iter = prof->agg_iter->next;
-    } else {
-        /* Nothing left. */
-        agg = NULL;
-    }
+    /* Cast input parameters to event profiling infos. */
+    CCLProfInfo * info1 = *((CCLProfInfo **) a);
+    CCLProfInfo * info2 = *((CCLProfInfo **) b);
 
-    /* Return the aggregate statistic. */
-    return (const CCLProfAgg *) agg;
+    /* Perform comparison. */
+    return CCL_PROF_CMP_INT(
+        info1->t_start, info2->t_start, CCL_PROF_SORT_ASC);
 }
 
 /**
- * Initialize an iterator for event profiling info instances.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Determine the utilization of each command queue and of each
+ * device, i.e. busy time and idle gaps, by sweeping the profiled events in
+ * order of start time.
  *
- * @param[in] prof Profile object.
- * @param[in] sort Bitfield of ::CCLProfInfoSort OR ::CCLProfSortOrder,
- * for example `CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC`.
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof The profile object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
  * */
-CCL_EXPORT
-void ccl_prof_iter_info_init(CCLProf * prof, int sort) {
+static void ccl_prof_calc_util(CCLProf * prof, CCLErr ** err) {
 
-    /* Make sure prof is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_if_fail(prof->calc == TRUE);
+    /* Device utilization of each queue (keys: queue names; values:
+     * ::CCLProfUtilAcc*, owned by the table of device utilization). */
+    GHashTable * queue_devs;
+    /* Profiling infos sorted by start time. */
+    GPtrArray * sorted = NULL;
+    /* Hash table iterator. */
+    GHashTableIter iter;
+    /* Command queue name and wrapper. */
+    gpointer cq_name;
+    gpointer cq;
+    /* Device wrapper and respective utilization. */
+    CCLDevice * dev;
+    CCLProfUtilAcc * acc;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
+
+    /* Create tables. */
+    prof->queue_utils = g_hash_table_new_full(
+        g_str_hash, g_str_equal, NULL, g_free);
+    prof->device_utils = g_hash_table_new_full(
+        g_direct_hash, g_direct_equal, NULL, g_free);
+    queue_devs = g_hash_table_new(g_str_hash, g_str_equal);
+
+    /* Create utilization objects for each queue and device. */
+    g_hash_table_iter_init(&iter, prof->queues);
+    while (g_hash_table_iter_next(&iter, &cq_name, &cq)) {
+
+        /* Queue utilization. */
+        acc = g_new0(CCLProfUtilAcc, 1);
+        acc->util.name = (const char *) cq_name;
+        g_hash_table_insert(prof->queue_utils, cq_name, acc);
+
+        /* Device utilization, shared by queues on the same device. */
+        dev = ccl_queue_get_device((CCLQueue *) cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        acc = g_hash_table_lookup(
+            prof->device_utils, ccl_device_unwrap(dev));
+        if (acc == NULL) {
+            acc = g_new0(CCLProfUtilAcc, 1);
+            acc->util.name = ccl_device_get_info_array(
+                dev, CL_DEVICE_NAME, char, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            g_hash_table_insert(
+                prof->device_utils, ccl_device_unwrap(dev), acc);
+        }
+        g_hash_table_insert(queue_devs, cq_name, acc);
+    }
+
+    /* Sort profiling infos by start time. */
+    sorted = g_ptr_array_sized_new(prof->infos->len);
+    for (guint i = 0; i < prof->infos->len; ++i)
+        g_ptr_array_add(sorted, &g_array_index(prof->infos, CCLProfInfo, i));
+    g_ptr_array_sort(sorted, ccl_prof_info_ref_comp);
+
+    /* Add events to the utilization of the respective queue and device. */
+    for (guint i = 0; i < sorted->len; ++i) {
+        CCLProfInfo * info = g_ptr_array_index(sorted, i);
+        acc = g_hash_table_lookup(prof->queue_utils, info->queue_name);
+        if (acc == NULL) {
+            /* Queue of events added with ccl_prof_add_info(), whose
+             * device is unknown. */
+            acc = g_new0(CCLProfUtilAcc, 1);
+            acc->util.name = info->queue_name;
+            g_hash_table_insert(
+                prof->queue_utils, (gpointer) info->queue_name, acc);
+        }
+        ccl_prof_util_add(acc, info);
+        acc = g_hash_table_lookup(queue_devs, info->queue_name);
+        if (acc != NULL) ccl_prof_util_add(acc, info);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
 
-    /* Sort list of event prof. infos as requested by client. */
-    prof->infos = g_list_sort_with_data(
-        prof->infos, ccl_prof_info_comp, &sort);
+finish:
 
-    /* Set the iterator as the first element in list. */
-    prof->info_iter = prof->infos;
+    /* Release temporary data. */
+    g_hash_table_destroy(queue_devs);
+    if (sorted != NULL)
+        g_ptr_array_free(sorted, TRUE);
 }
 
 /**
- * Return the next event profiling info instance.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Release the statistics of the host-side calls of a wrapper
+ * function. It is an implementation of `GDestroyNotify` from GLib.
  *
- * @param[in] prof Profile object.
- * @return The next event profiling info instance or `NULL` if no more
- * instances are left.
+ * @private @memberof ccl_prof_host_call
+ *
+ * @param[in] data Statistics of host-side calls (::CCLProfHostCall*).
  * */
-CCL_EXPORT
-const CCLProfInfo * ccl_prof_iter_info_next(CCLProf * prof) {
-
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
-
-    /* The event profiling info instance to return. */
-    CCLProfInfo * info;
-
-    /* Check if there are any more left. */
-    if (prof->info_iter != NULL) {
-        /* Yes, send current one, pass to the next. */
-        info = (CCLProfInfo *) prof->info_iter->data;
-        prof->info_iter = prof->info_iter->next;
-    } else {
-        /* Nothing left. */
-        info = NULL;
-    }
+static void ccl_prof_host_call_free(gpointer data) {
 
-    /* Return the profiling info instance. */
-    return (const CCLProfInfo *) info;
+    CCLProfHostCall * call = (CCLProfHostCall *) data;
+    g_array_free(call->hist.counts, TRUE);
+    g_free(call);
 }
 
 /**
- * Initialize an iterator for event instant instances.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Record the duration of a host-side call of a wrapper function.
+ * This function is thread-safe.
  *
- * @param[in] prof Profile object.
- * @param[in] sort Bitfield of ::CCLProfInstSort OR ::CCLProfSortOrder,
- * for example `CCL_PROF_INST_SORT_INSTANT | CCL_PROF_SORT_ASC`.
+ * @param[in] func_name Name of wrapper function, which must be a static
+ * string, since it is used as key.
+ * @param[in] duration Duration of call, in nanoseconds.
  * */
-CCL_EXPORT
-void ccl_prof_iter_inst_init(CCLProf * prof, int sort) {
-
-    /* Make sure prof is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_if_fail(prof->calc == TRUE);
+void ccl_prof_host_record(const char * func_name, guint64 duration) {
+
+    /* Statistics of host-side calls of function. */
+    CCLProfHostCall * call;
+
+    g_mutex_lock(&host_calls_mutex);
+
+    /* Create table of host-side calls, if required. */
+    if (host_calls == NULL)
+        host_calls = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+            NULL, ccl_prof_host_call_free);
+
+    /* Get statistics of function, creating them if required. */
+    call = g_hash_table_lookup(host_calls, func_name);
+    if (call == NULL) {
+        call = g_new0(CCLProfHostCall, 1);
+        call->agg.event_name = func_name;
+        call->agg.min_time = CL_ULONG_MAX;
+        call->hist.event_name = func_name;
+        call->hist.counts = g_array_new(FALSE, TRUE, sizeof(guint));
+        g_hash_table_insert(host_calls, (gpointer) func_name, call);
+    }
 
-    /* Sort list of event instants as requested by client. */
-    prof->instants = g_list_sort_with_data(
-        prof->instants, ccl_prof_inst_comp, &sort);
+    /* Update statistics. */
+    call->agg.absolute_time += duration;
+    call->hist.seen++;
+    call->hist.sampled++;
+    ccl_prof_hist_add(&call->hist, &call->agg, duration);
 
-    /* Set the iterator as the first element in list. */
-    prof->inst_iter = prof->instants;
+    g_mutex_unlock(&host_calls_mutex);
 }
 
 /**
- * Return the next event instant instance.
+ * Discard the statistics of host-side calls of wrapper functions recorded
+ * so far.
  *
  * @public @memberof ccl_prof
- *
- * @param[in] prof Profile object.
- * @return The next event instant instance or `NULL` if no more instances
- * are left.
  * */
 CCL_EXPORT
-const CCLProfInst * ccl_prof_iter_inst_next(CCLProf * prof) {
-
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
-
-    /* The event profiling info instance to return. */
-    CCLProfInst * inst;
+void ccl_prof_host_trace_reset(void) {
 
-    /* Check if there are any more left. */
-    if (prof->inst_iter != NULL) {
-        /* Yes, send current one, pass to the next. */
-        inst = (CCLProfInst *) prof->inst_iter->data;
-        prof->inst_iter = prof->inst_iter->next;
-    } else {
-        /* Nothing left. */
-        inst = NULL;
+    g_mutex_lock(&host_calls_mutex);
+    if (host_calls != NULL) {
+        g_hash_table_destroy(host_calls);
+        host_calls = NULL;
     }
-
-    /* Return the profiling info instance. */
-    return (const CCLProfInst *) inst;
+    g_mutex_unlock(&host_calls_mutex);
 }
 
 /**
- * Initialize an iterator for overlap instances.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Copy the statistics of host-side calls of wrapper functions
+ * recorded so far to the profile object, determining duration statistics.
  *
- * @param[in] prof Profile object.
- * @param[in] sort Bitfield of ::CCLProfOverlapSort OR ::CCLProfSortOrder, for
- * example `CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC`.
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof The profile object.
  * */
-CCL_EXPORT
-void ccl_prof_iter_overlap_init(CCLProf * prof, int sort) {
+static void ccl_prof_calc_host(CCLProf * prof) {
 
-    /* Make sure prof is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_if_fail(prof->calc == TRUE);
+    /* Hash table iterator. */
+    GHashTableIter iter;
+    gpointer p_call;
+    /* Total host time of all calls. */
+    cl_ulong total_time = 0;
+
+    g_mutex_lock(&host_calls_mutex);
+
+    /* Copy aggregate statistics and determine duration statistics. */
+    if (host_calls != NULL) {
+        g_hash_table_iter_init(&iter, host_calls);
+        while (g_hash_table_iter_next(&iter, NULL, &p_call)) {
+            CCLProfHostCall * call = (CCLProfHostCall *) p_call;
+            CCLProfAgg agg = call->agg;
+            agg.mean_time = call->hist.mean;
+            agg.std_time = sqrt(call->hist.m2 / agg.count);
+            agg.p50_time =
+                ccl_prof_hist_percentile(&call->hist, &agg, 50.0);
+            agg.p90_time =
+                ccl_prof_hist_percentile(&call->hist, &agg, 90.0);
+            agg.p99_time =
+                ccl_prof_hist_percentile(&call->hist, &agg, 99.0);
+            agg.p999_time =
+                ccl_prof_hist_percentile(&call->hist, &agg, 99.9);
+            total_time += agg.absolute_time;
+            g_array_append_val(prof->host_aggs, agg);
+        }
+    }
 
-    /* Sort list of overlaps as requested by client. */
-    prof->overlaps = g_list_sort_with_data(
-        prof->overlaps, ccl_prof_overlap_comp, &sort);
+    g_mutex_unlock(&host_calls_mutex);
 
-    /* Set the iterator as the first element in list. */
-    prof->overlap_iter = prof->overlaps;
+    /* Determine relative times. */
+    for (guint i = 0; i < prof->host_aggs->len; ++i) {
+        CCLProfAgg * agg = &g_array_index(prof->host_aggs, CCLProfAgg, i);
+        agg->relative_time = (total_time > 0)
+            ? ((double) agg->absolute_time) / ((double) total_time) : 0;
+    }
 }
 
 /**
- * Return the next overlap instance.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Determine relative aggregate event statistics.
  *
- * @param[in] prof Profile object.
- * @return The next overlap instance or `NULL` if no more instances are left.
+ * Absolute times are accumulated as events are added for profiling. If
+ * events were sampled, absolute times and counts are scaled to estimate
+ * the values for all events.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof The profile object.
  * */
-CCL_EXPORT
-const CCLProfOverlap * ccl_prof_iter_overlap_next(CCLProf * prof) {
+static void ccl_prof_calc_agg(CCLProf * prof) {
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
+    /* Make sure profile object is not NULL. */
+    g_return_if_fail(prof != NULL);
 
-    /* The overlap instance to return. */
-    CCLProfOverlap * ovlp;
+    /* Auxiliary aggregate event info variable.*/
+    CCLProfAgg * curr_agg = NULL;
 
-    /* Check if there are any more left. */
-    if (prof->overlap_iter != NULL) {
-        /* Yes, send current one, pass to the next. */
-        ovlp = (CCLProfOverlap *) prof->overlap_iter->data;
-        prof->overlap_iter = prof->overlap_iter->next;
-    } else {
-        /* Nothing left. */
-        ovlp = NULL;
+    /* Auxiliary histogram variable. */
+    CCLProfHist * curr_hist = NULL;
+
+    /* Sampled total time of all events. */
+    cl_ulong sampled_time = prof->total_events_time;
+
+    /* Ratio between seen and sampled events of the current name. */
+    double ratio;
+
+    /* Determine duration statistics, which are estimated from the
+     * sampled events, and scale absolute times and counts by the ratio
+     * between seen and sampled events. */
+    prof->total_events_time = 0;
+    for (guint i = 0; i < prof->aggs->len; ++i) {
+        curr_agg = &g_array_index(prof->aggs, CCLProfAgg, i);
+        curr_hist = &g_array_index(prof->hists, CCLProfHist, i);
+
+        /* Events without duration are not accounted for. */
+        if (curr_agg->count == 0) {
+            curr_agg->min_time = 0;
+            continue;
+        }
+        curr_agg->mean_time = curr_hist->mean;
+        curr_agg->std_time = sqrt(curr_hist->m2 / curr_agg->count);
+        curr_agg->p50_time =
+            ccl_prof_hist_percentile(curr_hist, curr_agg, 50.0);
+        curr_agg->p90_time =
+            ccl_prof_hist_percentile(curr_hist, curr_agg, 90.0);
+        curr_agg->p99_time =
+            ccl_prof_hist_percentile(curr_hist, curr_agg, 99.0);
+        curr_agg->p999_time =
+            ccl_prof_hist_percentile(curr_hist, curr_agg, 99.9);
+
+        /* Performance counters and derived metrics, which refer to the
+         * sampled events only. */
+        curr_agg->counters = curr_hist->counters;
+        curr_agg->bandwidth = ccl_prof_hist_bandwidth(prof, curr_hist);
+        curr_agg->occupancy = ccl_prof_hist_occupancy(prof, curr_hist);
+
+        if (curr_hist->sampled < curr_hist->seen) {
+            ratio = (double) curr_hist->seen / curr_hist->sampled;
+            curr_agg->absolute_time =
+                (cl_ulong) (curr_agg->absolute_time * ratio + 0.5);
+            curr_agg->count = (cl_uint) (curr_agg->count * ratio + 0.5);
+        }
+        prof->total_events_time += curr_agg->absolute_time;
     }
+    prof->sample_scale = (sampled_time > 0)
+        ? (double) prof->total_events_time / sampled_time : 1.0;
 
-    /* Return the overlap instance. */
-    return (const CCLProfOverlap *) ovlp;
+    /* Determine relative times. */
+    for (guint i = 0; i < prof->aggs->len; ++i) {
+        curr_agg = &g_array_index(prof->aggs, CCLProfAgg, i);
+        curr_agg->relative_time =
+            ((double) curr_agg->absolute_time)
+            /
+            ((double) prof->total_events_time);
+    }
 }
 
 /**
- * Get duration of all events in nanoseconds.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Compares two interval endpoints for sorting within a `GArray`.
+ * End instants come before start instants occurring at the same time.
  *
- * @param[in] prof Profile object.
- * @return The duration of all events in nanoseconds.
+ * @param[in] a First endpoint.
+ * @param[in] b Second endpoint.
+ * @return Negative value if a < b, zero if a == b, positive value if
+ * a > b.
  * */
-CCL_EXPORT
-cl_ulong ccl_prof_get_duration(CCLProf * prof) {
+static gint ccl_prof_endpoint_comp(gconstpointer a, gconstpointer b) {
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, 0);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, 0);
+    const CCLProfEndpoint * ep1 = (const CCLProfEndpoint *) a;
+    const CCLProfEndpoint * ep2 = (const CCLProfEndpoint *) b;
 
-    /* Return requested data. */
-    return prof->total_events_time;
+    if (ep1->instant != ep2->instant)
+        return ep1->instant < ep2->instant ? -1 : 1;
+    return (ep2->end ? 1 : 0) - (ep1->end ? 1 : 0);
 }
 
 /**
- * Get effective duration of all events in nanoseconds, i.e. the duration of
- * all events minus event overlaps.
- *
- * If no overlaps occur, this function will return the same value as
- * ::ccl_prof_get_duration().
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Compare keys of the sparse overlap accumulator, for sorting
+ * purposes.
  *
- * @param[in] prof Profile object.
- * @return The effective duration of all events in nanoseconds, i.e. the
- * duration of all events minus event overlaps.
+ * @param[in] a First key.
+ * @param[in] b Second key.
+ * @return Negative value if a < b, zero if a == b, positive value if
+ * a > b.
  * */
-CCL_EXPORT
-cl_ulong ccl_prof_get_eff_duration(CCLProf * prof) {
+static gint ccl_prof_overlap_key_comp(gconstpointer a, gconstpointer b) {
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, 0);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, 0);
+    gsize key1 = GPOINTER_TO_SIZE(a);
+    gsize key2 = GPOINTER_TO_SIZE(b);
 
-    /* Return requested data. */
-    return prof->total_events_eff_time;
+    return key1 < key2 ? -1 : (key1 > key2 ? 1 : 0);
 }
 
 /**
- * Print a summary of the profiling info. More specifically, this function
- * prints a table of aggregate event statistics (sorted by absolute time), and
- * a table of event overlaps (sorted by overlap duration).
+ * @internal
  *
- * For more control of where and how this summary is printed, use the
- * ccl_prof_get_summary() function.
+ * @brief Accumulate the overlaps between the given event intervals.
  *
- * @public @memberof ccl_prof
+ * Interval endpoints are swept in chronological order, keeping an array
+ * with the currently occurring events. When an event ends, its overlap
+ * with each occurring event is the time since the latest of both start
+ * instants, and is accumulated in a sparse table keyed by the pair of
+ * event name IDs. Only overlaps involving at least one interval of the
+ * given generation are accumulated, so that, in incremental mode,
+ * overlaps between previously drained events are not accounted twice.
+ *
+ * @private @memberof ccl_prof
  *
  * @param[in] prof Profile object.
- * */
-CCL_EXPORT
-void ccl_prof_print_summary(CCLProf * prof) {
+ * @param[in] intervals Array of event intervals.
+ * @param[in] gen Generation of intervals added since the last call.
+ */
+static void ccl_prof_fold_overlaps(
+    CCLProf * prof, GArray * intervals, cl_uint gen) {
+
+    /* Interval endpoints. */
+    GArray * endpoints = NULL;
+    /* Currently occurring events (indexes of intervals). */
+    GArray * active = NULL;
+    /* Auxiliary endpoint. */
+    CCLProfEndpoint ep;
+
+    /* Get interval endpoints and sort them. */
+    endpoints = g_array_sized_new(
+        FALSE, FALSE, sizeof(CCLProfEndpoint), 2 * intervals->len);
+    for (guint i = 0; i < intervals->len; ++i) {
+        CCLProfInterval * ival =
+            &g_array_index(intervals, CCLProfInterval, i);
+        ep.idx = i;
+        ep.instant = ival->start;
+        ep.end = FALSE;
+        g_array_append_val(endpoints, ep);
+        ep.instant = ival->end;
+        ep.end = TRUE;
+        g_array_append_val(endpoints, ep);
+    }
+    g_array_sort(endpoints, ccl_prof_endpoint_comp);
 
-    /* Make sure prof is not NULL. */
-    g_return_if_fail(prof != NULL);
-    /* This function can only be called after calculations are made. */
-    g_return_if_fail(prof->calc == TRUE);
+    /* Initialize array of occurring events. */
+    active = g_array_new(FALSE, FALSE, sizeof(guint));
 
-    /* Summary to print. */
-    const char * summary;
+    /* Iterate through all endpoints. */
+    for (guint n = 0; n < endpoints->len; ++n) {
 
-    /* Get the summary. */
-    summary = ccl_prof_get_summary(prof,
-        CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC,
-        CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC);
+        /* Current endpoint and respective interval. */
+        CCLProfEndpoint * curr_ep =
+            &g_array_index(endpoints, CCLProfEndpoint, n);
+        CCLProfInterval * curr_ev =
+            &g_array_index(intervals, CCLProfInterval, curr_ep->idx);
 
-    /* Print summary. */
+        if (!curr_ep->end) {
+
+            /* Event START instant, add event to occurring events. */
+            g_array_append_val(active, curr_ep->idx);
+
+        } else {
+
+            /* Event END instant, remove event from occurring events. */
+            guint idx;
+            for (idx = 0; idx < active->len; ++idx) {
+                if (g_array_index(active, guint, idx) == curr_ep->idx)
+                    break;
+            }
+            g_assert(idx < active->len);
+            g_array_remove_index_fast(active, idx);
+
+            /* Account for overlaps with remaining occurring events. */
+            for (guint k = 0; k < active->len; ++k) {
+
+                /* Occurring event. */
+                CCLProfInterval * occu_ev = &g_array_index(intervals,
+                    CCLProfInterval, g_array_index(active, guint, k));
+                /* Event overlap in nanoseconds. */
+                cl_ulong eff_overlap;
+                /* Smaller and larger event name IDs. */
+                CCLProfInterval * ev_min, * ev_max;
+                /* Accumulator key and value. */
+                gpointer key;
+                CCLProfOverlap * acc;
+
+                /* Skip overlaps already accounted for. */
+                if ((curr_ev->gen != gen) && (occu_ev->gen != gen))
+                    continue;
+
+                /* Determine overlap. */
+                eff_overlap =
+                    curr_ep->instant - MAX(curr_ev->start, occu_ev->start);
+
+                /* Key is given by the smaller and larger name IDs. */
+                ev_min = curr_ev->ueid <= occu_ev->ueid ? curr_ev : occu_ev;
+                ev_max = curr_ev->ueid <= occu_ev->ueid ? occu_ev : curr_ev;
+                key = GSIZE_TO_POINTER(
+                    (gsize) ev_max->ueid * (ev_max->ueid + 1) / 2
+                    + ev_min->ueid);
+
+                /* Accumulate overlap. */
+                acc = g_hash_table_lookup(prof->overlap_acc, key);
+                if (acc == NULL) {
+                    acc = g_new(CCLProfOverlap, 1);
+                    acc->event1_name = ev_min->event_name;
+                    acc->event2_name = ev_max->event_name;
+                    acc->duration = 0;
+                    g_hash_table_insert(prof->overlap_acc, key, acc);
+                }
+                acc->duration += eff_overlap;
+                prof->total_overlap += eff_overlap;
+            }
+        }
+    }
+
+    /* Free arrays of endpoints and occurring events. */
+    g_array_free(endpoints, TRUE);
+    g_array_free(active, TRUE);
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine event overlaps for the given profile object.
+ *
+ * In incremental mode, overlaps have already been accumulated when
+ * draining events.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ */
+static void ccl_prof_calc_overlaps(CCLProf * prof) {
+
+    /* Make sure profile object is not NULL. */
+    g_return_if_fail(prof != NULL);
+
+    /* List of keys of the overlap accumulator. */
+    GList * keys = NULL;
+
+    /* Accumulate overlaps between all events, if not done
+     * incrementally. */
+    if (prof->drains == 0) {
+
+        /* Event intervals. */
+        GArray * intervals = g_array_sized_new(
+            FALSE, FALSE, sizeof(CCLProfInterval), prof->infos->len);
+        CCLProfInterval ival;
+
+        /* Get intervals of events which used device time. */
+        for (guint i = 0; i < prof->infos->len; ++i) {
+            CCLProfInfo * info = &g_array_index(prof->infos, CCLProfInfo, i);
+            if (info->t_end <= info->t_start) continue;
+            ival.event_name = info->event_name;
+            ival.ueid = GPOINTER_TO_UINT(g_hash_table_lookup(
+                prof->event_names, info->event_name));
+            ival.gen = 0;
+            ival.start = info->t_start;
+            ival.end = info->t_end;
+            g_array_append_val(intervals, ival);
+        }
+
+        /* Accumulate overlaps. */
+        ccl_prof_fold_overlaps(prof, intervals, 0);
+        g_array_free(intervals, TRUE);
+    }
+
+    /* Populate array of overlaps, in order of event name IDs. */
+    keys = g_list_sort(g_hash_table_get_keys(prof->overlap_acc),
+        ccl_prof_overlap_key_comp);
+    for (GList * curr = keys; curr != NULL; curr = curr->next) {
+        CCLProfOverlap * acc = g_hash_table_lookup(
+            prof->overlap_acc, curr->data);
+        ccl_prof_overlap_add(prof->overlaps,
+            acc->event1_name, acc->event2_name, acc->duration);
+    }
+
+    /* Determine and save effective events time. If events were
+     * sampled, the total overlap is scaled as the total events time. */
+    prof->total_events_eff_time = prof->total_events_time - MIN(
+        prof->total_events_time,
+        (cl_ulong) (prof->total_overlap * prof->sample_scale + 0.5));
+
+    /* Free list of keys. */
+    g_list_free(keys);
+}
+
+/**
+ * @internal
+ *
+ * @brief Data passed to ccl_prof_drain_event() when draining events.
+ * */
+typedef struct ccl_prof_drain_data {
+
+    /** Profile object. */
+    CCLProf * prof;
+
+    /** Name of queue being drained. */
+    const char * cq_name;
+
+    /** Intervals of drained events. */
+    GArray * intervals;
+
+    /** Error which occurred while draining events, if any. */
+    CCLErr * err;
+
+} CCLProfDrainData;
+
+/**
+ * @internal
+ *
+ * @brief Add a terminated event drained from a queue for profiling.
+ * Implementation of ::ccl_queue_drain_fn.
+ *
+ * @param[in] evt Terminated event.
+ * @param[in] data A ::CCLProfDrainData object.
+ * @return `CL_TRUE` if the event can be released, `CL_FALSE` if an error
+ * occurred.
+ * */
+static cl_bool ccl_prof_drain_event(CCLEvent * evt, void * data) {
+
+    CCLProfDrainData * drain = (CCLProfDrainData *) data;
+
+    /* After an error, keep remaining events. */
+    if (drain->err != NULL) return CL_FALSE;
+
+    /* Add event for profiling. */
+    ccl_prof_add_queue_event(drain->prof, drain->cq_name, evt, NULL,
+        drain->intervals, &drain->err);
+
+    /* Release event if it was successfully added. */
+    return drain->err == NULL ? CL_TRUE : CL_FALSE;
+}
+
+/**
+ * @addtogroup CCL_PROFILER
+ * @{
+ */
+
+/**
+ * Create a new profile object.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @return A new profile object.
+ * */
+CCL_EXPORT
+CCLProf * ccl_prof_new() {
+
+    /* Allocate memory for new profile data structure. */
+    CCLProf * prof = g_slice_new0(CCLProf);
+
+    /* Create arrays of event instants, event profiling information,
+     * aggregate statistics and event overlaps. */
+    prof->instants = g_array_new(FALSE, FALSE, sizeof(CCLProfInst));
+    prof->infos = g_array_new(FALSE, FALSE, sizeof(CCLProfInfo));
+    prof->aggs = g_array_new(FALSE, FALSE, sizeof(CCLProfAgg));
+    prof->hists = g_array_new(FALSE, FALSE, sizeof(CCLProfHist));
+    prof->overlaps = g_array_new(FALSE, FALSE, sizeof(CCLProfOverlap));
+
+    /* Create arrays of profiled commands and command slacks. */
+    prof->nodes = g_array_new(FALSE, FALSE, sizeof(CCLProfNode));
+    prof->slacks = g_array_new(FALSE, FALSE, sizeof(CCLProfSlack));
+
+    /* Create table of event names, which are interned. */
+    prof->event_names = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    /* Create sparse overlap accumulator. */
+    prof->overlap_acc = g_hash_table_new_full(
+        g_direct_hash, g_direct_equal, NULL, g_free);
+
+    /* Create table of live queue busy times. */
+    prof->queue_live = g_hash_table_new_full(
+        g_str_hash, g_str_equal, NULL, g_free);
+
+    /* Create array of host-side call statistics. */
+    prof->host_aggs = g_array_new(FALSE, FALSE, sizeof(CCLProfAgg));
+
+    /* Create arrays of host-side ranges. */
+    prof->ranges = g_array_new(FALSE, FALSE, sizeof(CCLProfRange));
+    prof->range_parents = g_array_new(FALSE, FALSE, sizeof(guint));
+    prof->range_stack = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    /* Set absolute start time to maximum possible. */
+    prof->t_start = CL_ULONG_MAX;
+
+    /* Return new profile data structure */
+    return prof;
+}
+
+/**
+ * Destroy a profile object.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object to destroy.
+ * */
+CCL_EXPORT
+void ccl_prof_destroy(CCLProf * prof) {
+
+    /* Profile to destroy cannot be NULL. */
+    g_return_if_fail(prof != NULL);
+
+    /* Destroy table of event names. */
+    g_hash_table_destroy(prof->event_names);
+
+    /* Destroy table of event IDs. */
+    if (prof->event_name_ids != NULL)
+        g_hash_table_destroy(prof->event_name_ids);
+
+    /* Destroy table of command queue wrappers. */
+    if (prof->queues != NULL)
+        g_hash_table_destroy(prof->queues);
+
+    /* Destroy array of all event instants. */
+    g_array_free(prof->instants, TRUE);
+
+    /* Destroy array of event profiling information. */
+    g_array_free(prof->infos, TRUE);
+
+    /* Destroy array of aggregate statistics. */
+    g_array_free(prof->aggs, TRUE);
+
+    /* Destroy histograms of event durations, performance counters and
+     * slowest instances. */
+    for (guint i = 0; i < prof->hists->len; ++i) {
+        CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+        g_array_free(hist->counts, TRUE);
+        g_free(hist->counters);
+        if (hist->slowest != NULL) {
+            for (guint j = 0; j < hist->slowest->len; ++j)
+                g_free((gchar *) g_array_index(
+                    hist->slowest, CCLProfSlow, j).tag);
+            g_array_free(hist->slowest, TRUE);
+        }
+    }
+    g_array_free(prof->hists, TRUE);
+
+    /* Destroy array of event overlaps. */
+    g_array_free(prof->overlaps, TRUE);
+
+    /* Destroy arrays of profiled commands and command slacks. */
+    ccl_prof_nodes_clear(prof->nodes);
+    g_array_free(prof->nodes, TRUE);
+    g_array_free(prof->slacks, TRUE);
+
+    /* Destroy tables of queue and device utilization. */
+    if (prof->queue_utils != NULL)
+        g_hash_table_destroy(prof->queue_utils);
+    if (prof->device_utils != NULL)
+        g_hash_table_destroy(prof->device_utils);
+
+    /* Destroy overlap accumulator. */
+    g_hash_table_destroy(prof->overlap_acc);
+
+    /* Destroy table of live queue busy times. */
+    g_hash_table_destroy(prof->queue_live);
+
+    /* Destroy array of host-side call statistics. */
+    g_array_free(prof->host_aggs, TRUE);
+
+    /* Destroy arrays of host-side ranges, and the range names. */
+    for (guint i = 0; i < prof->ranges->len; ++i)
+        g_free((gchar *) g_array_index(prof->ranges, CCLProfRange, i).name);
+    g_array_free(prof->ranges, TRUE);
+    g_array_free(prof->range_parents, TRUE);
+    g_array_free(prof->range_stack, TRUE);
+
+    /* Destroy incremental mode data. */
+    if (prof->window != NULL)
+        g_array_free(prof->window, TRUE);
+    if (prof->pending != NULL)
+        g_hash_table_destroy(prof->pending);
+
+    /* Destroy table of clock offsets. */
+    if (prof->clock_offsets != NULL)
+        g_hash_table_destroy(prof->clock_offsets);
+
+    /* Destroy random number generator used for sampling. */
+    if (prof->sample_rand != NULL)
+        g_rand_free(prof->sample_rand);
+
+    /* Free performance counter names and values. */
+    g_strfreev(prof->counter_names);
+    g_free(prof->counter_values);
+
+    /* Free the summary string. */
+    if (prof->summary != NULL)
+        g_free(prof->summary);
+
+    /* Destroy timer. */
+    if (prof->timer != NULL)
+        g_timer_destroy(prof->timer);
+
+    /* Destroy profile data structure. */
+    g_slice_free(CCLProf, prof);
+}
+
+/**
+ * Set the profile object to only analyze a sample of events, reducing
+ * profiling overhead.
+ *
+ * If `period` is larger than one, only one in every `period` events with
+ * the same name is sampled. If `fraction` is larger than zero, events are
+ * randomly sampled with the given probability, using a generator seeded
+ * with `seed`, for reproducibility. Both criteria can be combined.
+ *
+ * Events which are not sampled are only counted, so their profiling info
+ * is not queried or kept. Absolute times, relative times and counts in
+ * aggregate statistics (::CCLProfAgg), as well as the total and effective
+ * durations, are scaled by the ratio between seen and sampled events of
+ * each name, estimating their values for all events. The remaining
+ * duration statistics, the event overlaps and the event profiling info
+ * and instants refer to the sampled events only.
+ *
+ * This function must be called before any events are processed, i.e.
+ * before ccl_prof_drain() or ccl_prof_calc().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[in] period Sample one in every `period` events of each name, or
+ * zero or one to disable periodic sampling.
+ * @param[in] fraction Fraction of randomly sampled events, between zero
+ * and one, or zero to disable random sampling.
+ * @param[in] seed Seed for random sampling.
+ * */
+CCL_EXPORT
+void ccl_prof_set_sampling(
+    CCLProf * prof, cl_uint period, double fraction, guint32 seed) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Make sure fraction is valid. */
+    g_return_if_fail((fraction >= 0) && (fraction <= 1));
+    /* Sampling can only be set before events are processed. */
+    g_return_if_fail((prof->calc == FALSE) && (prof->drains == 0));
+
+    /* Keep sampling period and fraction. */
+    prof->sample_period = period;
+    prof->sample_fraction = fraction;
+
+    /* Create or reseed random number generator. */
+    if (prof->sample_rand == NULL)
+        prof->sample_rand = g_rand_new_with_seed(seed);
+    else
+        g_rand_set_seed(prof->sample_rand, seed);
+}
+
+/**
+ * Set a function which collects the performance counters of each profiled
+ * command, from which derived metrics are reported.
+ *
+ * The function is called for each sampled command with a duration when
+ * its event is added for profiling, and places the values of the
+ * `num_counters` counters in the given array. Counters are summed per
+ * event name in ::CCLProfAgg::counters. If counters named
+ * ::CCL_PROF_COUNTER_BYTES or ::CCL_PROF_COUNTER_OCCUPANCY are given, the
+ * achieved bandwidth and the mean occupancy, weighted by duration, of each
+ * event name are derived in ::CCLProfAgg::bandwidth and
+ * ::CCLProfAgg::occupancy, respectively. Derived metrics are shown in the
+ * summary, and all counters are exported by ccl_prof_export_metrics().
+ *
+ * Counters can be obtained, for example, from the
+ * `CL_PROFILING_COMMAND_PERFCOUNTERS_INTEL` raw report of events of queues
+ * created with the `CL_QUEUE_MDAPI_PROPERTIES_INTEL` property of the
+ * `cl_intel_performance_query` extension, decoded with the Intel Metrics
+ * Discovery API, or from equivalent vendor interfaces. Since counters are
+ * only collected when events are added, i.e. by ccl_prof_drain() or
+ * ccl_prof_calc(), the events must not have been released by then, and
+ * counters are not collected for events loaded from binary profile files.
+ *
+ * This function must be called before any events are processed, i.e.
+ * before ccl_prof_drain() or ccl_prof_calc().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[in] num_counters Number of counters collected per command.
+ * @param[in] names Names of the counters, which are copied.
+ * @param[in] fn Function which collects the counters of a command, or
+ * `NULL` to disable the collection of counters.
+ * @param[in] user_data User data passed to `fn`.
+ * */
+CCL_EXPORT
+void ccl_prof_set_counters(CCLProf * prof, cl_uint num_counters,
+    const char * const * names, ccl_prof_counters_fn fn, void * user_data) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Make sure counter names are given. */
+    g_return_if_fail((fn == NULL) || ((num_counters > 0) && (names != NULL)));
+    /* Counters can only be set before events are processed. */
+    g_return_if_fail((prof->calc == FALSE) && (prof->drains == 0));
+
+    /* Discard previously set counters. */
+    g_strfreev(prof->counter_names);
+    g_free(prof->counter_values);
+    prof->counter_names = NULL;
+    prof->counter_values = NULL;
+    prof->num_counters = 0;
+    prof->counter_bytes = -1;
+    prof->counter_occupancy = -1;
+
+    /* Keep collecting function. */
+    prof->counters_fn = fn;
+    prof->counters_data = user_data;
+    if (fn == NULL) return;
+
+    /* Keep counter names, locating the well-known counters. */
+    prof->num_counters = num_counters;
+    prof->counter_names = g_new0(gchar *, num_counters + 1);
+    for (cl_uint i = 0; i < num_counters; ++i) {
+        prof->counter_names[i] = g_strdup(names[i]);
+        if (g_strcmp0(names[i], CCL_PROF_COUNTER_BYTES) == 0)
+            prof->counter_bytes = (gint) i;
+        else if (g_strcmp0(names[i], CCL_PROF_COUNTER_OCCUPANCY) == 0)
+            prof->counter_occupancy = (gint) i;
+    }
+    prof->counter_values = g_new0(double, num_counters);
+}
+
+/**
+ * Set the profile object to keep the `k` slowest instances of each event
+ * name, with their instants, queue and user tag (see ccl_event_set_tag()).
+ *
+ * Only `k` instances are kept per event name, in a min-heap of durations,
+ * so outliers can be investigated without keeping all event profiling
+ * info, namely when events are drained with ccl_prof_drain(). Only
+ * sampled events (see ccl_prof_set_sampling()) with a duration are
+ * considered. The slowest instances are obtained with
+ * ccl_prof_get_slowest().
+ *
+ * This function must be called before any events are processed, i.e.
+ * before ccl_prof_drain() or ccl_prof_calc().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[in] k Number of slowest instances to keep per event name, or
+ * zero to keep none.
+ * */
+CCL_EXPORT
+void ccl_prof_set_slowest(CCLProf * prof, cl_uint k) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Slowest instances can only be kept if set before events are
+     * processed. */
+    g_return_if_fail((prof->calc == FALSE) && (prof->drains == 0));
+
+    /* Keep number of slowest instances. */
+    prof->slowest_k = k;
+}
+
+/**
+ * Starts the global profiler timer. Only required if client wishes to compare
+ * the effectively elapsed time with the OpenCL kernels time.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * */
+CCL_EXPORT
+void ccl_prof_start(CCLProf * prof) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+
+    /* Start timer. */
+    prof->timer = g_timer_new();
+}
+
+/**
+ * Stops the global profiler timer.
+ * Only required if ccl_prof_start() was called.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * */
+CCL_EXPORT
+void ccl_prof_stop(CCLProf * prof) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+
+    /* Stop timer. */
+    g_timer_stop(prof->timer);
+}
+
+/**
+ * If profiling has started but not stopped, returns the time since the
+ * profiling started. If profiling has been stopped, returns the elapsed time
+ * between the time it started and the time it stopped.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @return number of seconds elapsed, including any fractional part.
+ * */
+CCL_EXPORT
+double ccl_prof_time_elapsed(CCLProf * prof) {
+
+    /* Make sure profile is not NULL. */
+    g_return_val_if_fail(prof != NULL, 0.0);
+
+    /* Stop timer. */
+    return g_timer_elapsed(prof->timer, NULL);
+}
+
+/**
+ * Open a named host-side range, such as a frame or a request, nested in
+ * the innermost currently open range, if any. Profiled events queued
+ * while the range is open are attributed to it (and to the ranges
+ * enclosing it), as long as the clocks of the profiled queues are
+ * synchronized with ccl_prof_sync_clocks(). Ranges must be closed with
+ * ccl_prof_range_pop(); ranges still open when calculations are made are
+ * closed at that instant.
+ *
+ * @attention Host-side ranges are not thread-safe, and should be pushed
+ * and popped by the thread which enqueues the profiled commands.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] name Range name, which is copied.
+ * */
+CCL_EXPORT
+void ccl_prof_range_push(CCLProf * prof, const char * name) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Make sure name is not NULL. */
+    g_return_if_fail(name != NULL);
+    /* Ranges can only be pushed before calculations are made. */
+    g_return_if_fail(prof->calc == FALSE);
+
+    /* New range and index of enclosing range. */
+    CCLProfRange rng;
+    guint parent = prof->range_stack->len > 0
+        ? g_array_index(prof->range_stack, guint, prof->range_stack->len - 1)
+        : G_MAXUINT;
+    guint idx = prof->ranges->len;
+
+    /* Initialize range, using the host timebase of ccl_prof_sync_clocks(). */
+    rng.name = g_strdup(name);
+    rng.t_start = (cl_ulong) g_get_monotonic_time() * 1000;
+    rng.t_end = 0;
+    rng.depth = prof->range_stack->len;
+    rng.num_events = 0;
+    rng.device_time = 0;
+
+    /* Keep range and its enclosing range, and mark range as open. */
+    g_array_append_val(prof->ranges, rng);
+    g_array_append_val(prof->range_parents, parent);
+    g_array_append_val(prof->range_stack, idx);
+}
+
+/**
+ * Close the innermost open host-side range, opened with
+ * ccl_prof_range_push().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * */
+CCL_EXPORT
+void ccl_prof_range_pop(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* There must be an open range. */
+    g_return_if_fail(prof->range_stack->len > 0);
+
+    /* Index of innermost open range. */
+    guint idx = g_array_index(
+        prof->range_stack, guint, prof->range_stack->len - 1);
+
+    /* Set range end instant and mark it as closed. */
+    g_array_index(prof->ranges, CCLProfRange, idx).t_end =
+        (cl_ulong) g_get_monotonic_time() * 1000;
+    g_array_set_size(prof->range_stack, prof->range_stack->len - 1);
+}
+
+/**
+ * Add a command queue wrapper for profiling.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[in] cq_name Command queue name.
+ * @param[in] cq Command queue wrapper object.
+ * */
+CCL_EXPORT
+void ccl_prof_add_queue(CCLProf * prof, const char * cq_name, CCLQueue * cq) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+    /* Must be added before calculations. */
+    g_return_if_fail(prof->calc == FALSE);
+
+    /* Check if table needs to be created first. */
+    if (prof->queues == NULL) {
+        prof->queues = g_hash_table_new_full(
+            g_str_hash, g_direct_equal, NULL,
+            (GDestroyNotify) ccl_prof_queue_release);
+    }
+    /* Warn if table already contains a queue with the specified
+     * name. */
+    if (g_hash_table_contains(prof->queues, cq_name))
+        g_warning("Profile object already contains a queue named '%s'." \
+            "The existing queue will be replaced.", cq_name);
+
+    /* Increment queue ref. count and attach it to the profile object, so
+     * that its events are not automatically released. This is done before
+     * adding the queue to the table, in case it replaces itself. */
+    ccl_queue_ref(cq);
+    ccl_queue_prof_attach(cq, CL_TRUE);
+
+    /* Add queue to queue table. */
+    g_hash_table_replace(prof->queues, (gpointer) cq_name, cq);
+}
+
+/**
+ * Add the profiling information of an event which was not profiled by
+ * this object, such as an event loaded from a profile exported with
+ * ccl_prof_export_info() or ccl_prof_export_binary(), possibly in another
+ * process.
+ *
+ * Added events are processed by ccl_prof_calc() as if they had been
+ * produced by a queue with the given queue name, so that aggregate
+ * statistics, percentiles, overlaps and queue utilization of profiles
+ * exported in several runs can be determined and merged with the same
+ * code which analyzes live profiles. Event and queue names are copied.
+ * Device utilization and command slacks are not available for added
+ * events, since the respective devices and dependencies are unknown.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] info Profiling information of event.
+ * */
+CCL_EXPORT
+void ccl_prof_add_info(CCLProf * prof, const CCLProfInfo * info) {
+
+    /* Make sure profile is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* Make sure event information is not NULL. */
+    g_return_if_fail(info != NULL);
+    /* Must be added before calculations. */
+    g_return_if_fail(prof->calc == FALSE);
+    /* Events can't be added in incremental mode. */
+    g_return_if_fail(prof->drains == 0);
+
+    /* Raw profiling data of event. */
+    CCLProfRaw raw = { NULL,
+        { info->t_queued, info->t_submit, info->t_start, info->t_end },
+        info->command_type, CL_SUCCESS };
+
+    /* Create an empty table of queues, if required, so that the profile
+     * object can be analyzed. */
+    if (prof->queues == NULL) {
+        prof->queues = g_hash_table_new_full(
+            g_str_hash, g_direct_equal, NULL,
+            (GDestroyNotify) ccl_prof_queue_release);
+    }
+
+    /* Add event for profiling, with interned names, which are never
+     * freed. Adding raw profiling data never fails. */
+    ccl_prof_add_event(prof, g_intern_string(info->queue_name), NULL,
+        g_intern_string(info->event_name), &raw, NULL, NULL);
+}
+
+/**
+ * Synchronize the clocks of the devices associated with the command queues
+ * added for profiling with the host, so that all event instants are
+ * converted to a common host timebase.
+ *
+ * By default, event instants come from the clock of each device, and
+ * cannot be compared between devices. After this function is called,
+ * instants of events processed by ccl_prof_drain() or ccl_prof_calc() are
+ * converted to nanoseconds of the host monotonic clock, i.e. of
+ * `g_get_monotonic_time() * 1000`, allowing events in several devices, as
+ * well as host-side phases timed with g_get_monotonic_time(), to be
+ * analyzed as a single timeline.
+ *
+ * Device clocks are sampled with clGetDeviceAndHostTimer() if the platform
+ * and device support OpenCL >= 2.1. Otherwise, the offset between each
+ * device and the host is estimated by enqueuing a marker on the
+ * respective queue and waiting for it, so the queues should be idle when
+ * this function is called. Since device clocks may drift, this function
+ * can be called again, e.g. before each ccl_prof_drain(), in which case
+ * the most recent offsets are used.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_sync_clocks(CCLProf * prof, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* Clocks must be synchronized before calculations. */
+    g_return_val_if_fail(prof->calc == FALSE, CL_FALSE);
+
+    /* Hash table iterator. */
+    GHashTableIter iter;
+    /* Command queue name and wrapper. */
+    gpointer cq_name, cq;
+    /* Clock offset. */
+    gint64 * p_offset;
+    /* Function return status. */
+    cl_bool status;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that queues have been added. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, prof->queues == NULL,
+        CCL_ERROR_OTHER, error_handler,
+        "%s: no queues have been added for profiling.", CCL_STRD);
+
+    /* Create table of clock offsets, if necessary. */
+    if (prof->clock_offsets == NULL)
+        prof->clock_offsets = g_hash_table_new_full(
+            g_str_hash, g_str_equal, NULL, g_free);
+
+    /* Determine clock offset for each queue. */
+    g_hash_table_iter_init(&iter, prof->queues);
+    while (g_hash_table_iter_next(&iter, &cq_name, &cq)) {
+        p_offset = g_new(gint64, 1);
+        *p_offset = ccl_prof_clock_offset((CCLQueue *) cq, &err_internal);
+        g_hash_table_replace(prof->clock_offsets, cq_name, p_offset);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * Drain terminated events from the command queues added for profiling,
+ * folding them into running aggregate statistics and overlap totals, and
+ * release them.
+ *
+ * This function enables the incremental mode of the profile object, and
+ * can be called periodically while the profiled workload runs, so that
+ * memory used by events stays bounded. Events which have not yet
+ * terminated are kept in the command queues until a later call.
+ *
+ * In incremental mode, ::ccl_prof_calc() drains the remaining events,
+ * which must all have terminated, and only aggregate statistics and
+ * overlaps are available. Individual event information and event
+ * instants are not kept, so ::ccl_prof_iter_info_next() and
+ * ::ccl_prof_iter_inst_next() do not return any instances, and
+ * ::ccl_prof_export_info() exports no information.
+ *
+ * Intervals of drained events are kept while events which were pending
+ * at the time may still overlap them, so overlaps between events drained
+ * in different calls are accounted for.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, or `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_drain(CCLProf * prof, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* Events can only be drained before calculations. */
+    g_return_val_if_fail(prof->calc == FALSE, CL_FALSE);
+    /* There must be some queues to drain. */
+    g_return_val_if_fail(prof->queues != NULL, CL_FALSE);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* Function return status flag. */
+    cl_bool status;
+    /* Hash table iterator. */
+    GHashTableIter iter;
+    /* Command queue name and wrapper. */
+    gpointer cq_name, cq;
+    /* Drain data. */
+    CCLProfDrainData drain = { prof, NULL, NULL, NULL };
+    /* Events still pending after this drain. */
+    GHashTable * pending = NULL;
+    /* Oldest drain in which pending events were already pending. */
+    cl_uint oldest_gen = G_MAXUINT;
+    /* Number of kept intervals. */
+    guint num_kept = 0;
+
+    /* Create incremental mode data, if not yet created. */
+    if (prof->window == NULL) {
+        prof->window = g_array_new(FALSE, FALSE, sizeof(CCLProfInterval));
+        prof->pending = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    /* Start a new drain. */
+    prof->drains++;
+    drain.intervals = prof->window;
+    pending = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    /* Iterate over the command queues. */
+    g_hash_table_iter_init(&iter, prof->queues);
+    while (g_hash_table_iter_next(&iter, &cq_name, &cq)) {
+
+        /* Check that queue has profiling enabled. */
+        ccl_prof_check_queue(
+            (const char *) cq_name, (CCLQueue *) cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Add terminated events for profiling and release them. */
+        drain.cq_name = (const char *) cq_name;
+        ccl_queue_prof_drain((CCLQueue *) cq, ccl_prof_drain_event, &drain);
+        ccl_if_err_propagate_goto(err, drain.err, error_handler);
+
+        /* Keep track of events which have not terminated, and of the first
+         * drain in which they were pending. */
+        CCLEvent * evt;
+        ccl_queue_iter_event_init((CCLQueue *) cq);
+        while ((evt = ccl_queue_iter_event_next((CCLQueue *) cq))) {
+            gpointer gen;
+            if (!g_hash_table_lookup_extended(
+                prof->pending, evt, NULL, &gen)) {
+                gen = GUINT_TO_POINTER(prof->drains);
+            }
+            g_hash_table_insert(pending, evt, gen);
+            oldest_gen = MIN(oldest_gen, GPOINTER_TO_UINT(gen));
+        }
+    }
+
+    /* Replace table of pending events. */
+    g_hash_table_destroy(prof->pending);
+    prof->pending = pending;
+    pending = NULL;
+
+    /* Accumulate overlaps involving the drained events. */
+    ccl_prof_fold_overlaps(prof, prof->window, prof->drains);
+
+    /* Only keep intervals which may overlap with pending events, i.e.
+     * those drained since pending events started to be pending. */
+    for (guint i = 0; i < prof->window->len; ++i) {
+        CCLProfInterval * ival =
+            &g_array_index(prof->window, CCLProfInterval, i);
+        if (ival->gen >= oldest_gen) {
+            g_array_index(prof->window, CCLProfInterval, num_kept) = *ival;
+            num_kept++;
+        }
+    }
+    g_array_set_size(prof->window, num_kept);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+    /* Accumulate overlaps involving the events drained before the
+     * error, keeping all intervals and the previous pending events. */
+    ccl_prof_fold_overlaps(prof, prof->window, prof->drains);
+    g_hash_table_destroy(pending);
+
+finish:
+
+    /* Pass the profiling info of drained events to the background
+     * writer, if set. */
+    if (prof->writer != NULL)
+        ccl_prof_writer_submit(prof->writer);
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * Determine aggregate statistics for the given profile object.
+ *
+ * The command queues to be profiled will have their events garbage collected
+ * with ::ccl_queue_gc(). As such, they can be reused and re-added for
+ * profiling to a new profile object.
+ *
+ * If more than one queue is profiled and sampling is disabled, the
+ * profiling info of the events in the several queues is fetched in
+ * parallel, so no events should be enqueued on the profiled queues while
+ * this function executes.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof A profile object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, or `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_calc(CCLProf * prof, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* Calculations can only be performed once. */
+    g_return_val_if_fail(prof->calc == FALSE, CL_FALSE);
+    /* There must be some queues to process. */
+    g_return_val_if_fail(prof->queues != NULL, CL_FALSE);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Function return status flag. */
+    cl_bool status;
+
+    /* Hash table iterator. */
+    GHashTableIter iter;
+
+    /* Auxiliary pointers for determining the table of event_ids. */
+    gpointer p_evt_name, p_id;
+
+    /* Close host-side ranges which are still open. */
+    while (prof->range_stack->len > 0)
+        ccl_prof_range_pop(prof);
+
+    if (prof->drains > 0) {
+
+        /* In incremental mode, drain remaining events, which must all
+         * have terminated. */
+        ccl_prof_drain(prof, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            g_hash_table_size(prof->pending) > 0, CCL_ERROR_OTHER,
+            error_handler, "%s: %u profiled events have not terminated.",
+            CCL_STRD, g_hash_table_size(prof->pending));
+
+    } else {
+
+        /* Process queues and respective events. */
+        ccl_prof_process_queues(prof, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Determine critical path and command slacks. */
+        ccl_prof_calc_critical_path(prof);
+
+        /* Determine queue and device utilization. */
+        ccl_prof_calc_util(prof, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Obtain the event_ids table (by reversing the event_names table) */
+    prof->event_name_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    /* Populate table. */
+    g_hash_table_iter_init(&iter, prof->event_names);
+    while (g_hash_table_iter_next(&iter, &p_evt_name, &p_id)) {
+        g_hash_table_insert(prof->event_name_ids, p_id, p_evt_name);
+    }
+
+    /* Calculate aggregate statistics. */
+    ccl_prof_calc_agg(prof);
+
+    /* Copy statistics of host-side calls. */
+    ccl_prof_calc_host(prof);
+
+    /* Determine event overlaps. */
+    ccl_prof_calc_overlaps(prof);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    prof->calc = TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * Return aggregate statistics for events with the given name.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] event_name Event name.
+ * @return Aggregate statistics for events with the given name.
+ */
+CCL_EXPORT
+const CCLProfAgg * ccl_prof_get_agg(CCLProf * prof, const char * event_name) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* Make sure event name is not NULL. */
+    g_return_val_if_fail(event_name != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* Find the aggregate statistic for the given event. */
+    CCLProfAgg * agg = NULL;
+    for (guint i = 0; i < prof->aggs->len; ++i) {
+        CCLProfAgg * curr_agg = &g_array_index(prof->aggs, CCLProfAgg, i);
+        if (g_strcmp0(event_name, curr_agg->event_name) == 0) {
+            agg = curr_agg;
+            break;
+        }
+    }
+
+    /* Return result. */
+    return agg;
+}
+
+/**
+ * @internal
+ *
+ * @brief Compares the durations of two of the slowest event instances, in
+ * order to sort them by decreasing duration.
+ *
+ * @param[in] a First instance.
+ * @param[in] b Second instance.
+ * @return Negative value if a is slower than b, zero if both are equally
+ * slow, positive value otherwise.
+ * */
+static gint ccl_prof_slow_comp(gconstpointer a, gconstpointer b) {
+
+    cl_ulong d1 = ccl_prof_slow_duration((const CCLProfSlow *) a);
+    cl_ulong d2 = ccl_prof_slow_duration((const CCLProfSlow *) b);
+
+    return d1 > d2 ? -1 : (d1 < d2 ? 1 : 0);
+}
+
+/**
+ * Return the slowest instances of events with the given name, as kept
+ * with ccl_prof_set_slowest(), sorted by decreasing duration.
+ *
+ * Unlike most profile functions, this function can also be called before
+ * ccl_prof_calc(), in which case the returned instances reflect the
+ * events processed so far by ccl_prof_drain().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] event_name Event name.
+ * @param[out] num_slow Location where to place the number of returned
+ * instances.
+ * @return Slowest instances of events with the given name, which remain
+ * valid until events are processed again or the profile object is
+ * destroyed, or `NULL` if no instances were kept for the given name.
+ * */
+CCL_EXPORT
+const CCLProfSlow * ccl_prof_get_slowest(
+    CCLProf * prof, const char * event_name, cl_uint * num_slow) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* Make sure event name is not NULL. */
+    g_return_val_if_fail(event_name != NULL, NULL);
+    /* Make sure num_slow is not NULL. */
+    g_return_val_if_fail(num_slow != NULL, NULL);
+
+    /* Histogram of the given event name. */
+    CCLProfHist * hist = NULL;
+
+    /* Find the histogram for the given event. */
+    *num_slow = 0;
+    for (guint i = 0; i < prof->hists->len; ++i) {
+        CCLProfHist * curr_hist = &g_array_index(prof->hists, CCLProfHist, i);
+        if (g_strcmp0(event_name, curr_hist->event_name) == 0) {
+            hist = curr_hist;
+            break;
+        }
+    }
+    if ((hist == NULL) || (hist->slowest == NULL)) return NULL;
+
+    /* Sort slowest instances by decreasing duration, if not already
+     * sorted. */
+    if (!hist->slowest_sorted) {
+        g_array_sort(hist->slowest, ccl_prof_slow_comp);
+        hist->slowest_sorted = CL_TRUE;
+    }
+
+    /* Return result. */
+    *num_slow = hist->slowest->len;
+    return (const CCLProfSlow *) hist->slowest->data;
+}
+
+/**
+ * Initialize an iterator for profiled aggregate event instances.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfAggSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_DESC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_agg_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of aggregate statistics as requested by client. */
+    g_array_sort_with_data(prof->aggs, ccl_prof_agg_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->agg_iter = 0;
+}
+
+/**
+ * Return the next aggregate statistic instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next aggregate statistic instance or `NULL` if no more instances
+ * are left.
+ * */
+CCL_EXPORT
+const CCLProfAgg * ccl_prof_iter_agg_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The aggregate statistic to return. */
+    CCLProfAgg * agg;
+
+    /* Check if there are any more left. */
+    if (prof->agg_iter < prof->aggs->len) {
+        /* Yes, send current one, pass to the next. */
+        agg = &g_array_index(prof->aggs, CCLProfAgg, prof->agg_iter);
+        prof->agg_iter++;
+    } else {
+        /* Nothing left. */
+        agg = NULL;
+    }
+
+    /* Return the aggregate statistic. */
+    return (const CCLProfAgg *) agg;
+}
+
+/**
+ * Initialize an iterator for host-side range instances, delimited with
+ * ccl_prof_range_push() and ccl_prof_range_pop().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfRangeSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_RANGE_SORT_T_START | CCL_PROF_SORT_ASC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_range_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of host-side ranges as requested by client. */
+    g_array_sort_with_data(prof->ranges, ccl_prof_range_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->range_iter = 0;
+}
+
+/**
+ * Return the next host-side range instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next host-side range instance, or `NULL` if no more
+ * ranges are left.
+ * */
+CCL_EXPORT
+const CCLProfRange * ccl_prof_iter_range_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The host-side range to return. */
+    CCLProfRange * rng;
+
+    /* Check if there are any more left. */
+    if (prof->range_iter < prof->ranges->len) {
+        /* Yes, send current one, pass to the next. */
+        rng = &g_array_index(prof->ranges, CCLProfRange, prof->range_iter);
+        prof->range_iter++;
+    } else {
+        /* Nothing left. */
+        rng = NULL;
+    }
+
+    /* Return the host-side range. */
+    return (const CCLProfRange *) rng;
+}
+
+/**
+ * Initialize an iterator for statistics of host-side calls of wrapper
+ * functions, recorded while host-side tracing was enabled with
+ * ::ccl_prof_host_trace_enable(). In these ::CCLProfAgg* objects, the
+ * event name is the name of the wrapper function, the count is the number
+ * of calls and the absolute time is the total host time spent in them.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfAggSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_host_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of host-side call statistics as requested by client. */
+    g_array_sort_with_data(prof->host_aggs, ccl_prof_agg_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->host_iter = 0;
+}
+
+/**
+ * Return the next statistics of host-side calls of a wrapper function.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next statistics of host-side calls, or `NULL` if no more
+ * functions are left.
+ * */
+CCL_EXPORT
+const CCLProfAgg * ccl_prof_iter_host_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The host-side call statistics to return. */
+    CCLProfAgg * agg;
+
+    /* Check if there are any more left. */
+    if (prof->host_iter < prof->host_aggs->len) {
+        /* Yes, send current one, pass to the next. */
+        agg = &g_array_index(prof->host_aggs, CCLProfAgg, prof->host_iter);
+        prof->host_iter++;
+    } else {
+        /* Nothing left. */
+        agg = NULL;
+    }
+
+    /* Return the host-side call statistics. */
+    return (const CCLProfAgg *) agg;
+}
+
+/**
+ * Initialize an iterator for event profiling info instances.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfInfoSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_info_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of event prof. infos as requested by client. */
+    g_array_sort_with_data(prof->infos, ccl_prof_info_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->info_iter = 0;
+}
+
+/**
+ * Return the next event profiling info instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next event profiling info instance or `NULL` if no more
+ * instances are left.
+ * */
+CCL_EXPORT
+const CCLProfInfo * ccl_prof_iter_info_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The event profiling info instance to return. */
+    CCLProfInfo * info;
+
+    /* Check if there are any more left. */
+    if (prof->info_iter < prof->infos->len) {
+        /* Yes, send current one, pass to the next. */
+        info = &g_array_index(prof->infos, CCLProfInfo, prof->info_iter);
+        prof->info_iter++;
+    } else {
+        /* Nothing left. */
+        info = NULL;
+    }
+
+    /* Return the profiling info instance. */
+    return (const CCLProfInfo *) info;
+}
+
+/**
+ * Initialize an iterator for event instant instances.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfInstSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_INST_SORT_INSTANT | CCL_PROF_SORT_ASC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_inst_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of event instants as requested by client. */
+    g_array_sort_with_data(prof->instants, ccl_prof_inst_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->inst_iter = 0;
+}
+
+/**
+ * Return the next event instant instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next event instant instance or `NULL` if no more instances
+ * are left.
+ * */
+CCL_EXPORT
+const CCLProfInst * ccl_prof_iter_inst_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The event profiling info instance to return. */
+    CCLProfInst * inst;
+
+    /* Check if there are any more left. */
+    if (prof->inst_iter < prof->instants->len) {
+        /* Yes, send current one, pass to the next. */
+        inst = &g_array_index(prof->instants, CCLProfInst, prof->inst_iter);
+        prof->inst_iter++;
+    } else {
+        /* Nothing left. */
+        inst = NULL;
+    }
+
+    /* Return the profiling info instance. */
+    return (const CCLProfInst *) inst;
+}
+
+/**
+ * Initialize an iterator for overlap instances.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfOverlapSort OR ::CCLProfSortOrder, for
+ * example `CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_overlap_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of overlaps as requested by client. */
+    g_array_sort_with_data(prof->overlaps, ccl_prof_overlap_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->overlap_iter = 0;
+}
+
+/**
+ * Return the next overlap instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next overlap instance or `NULL` if no more instances are left.
+ * */
+CCL_EXPORT
+const CCLProfOverlap * ccl_prof_iter_overlap_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The overlap instance to return. */
+    CCLProfOverlap * ovlp;
+
+    /* Check if there are any more left. */
+    if (prof->overlap_iter < prof->overlaps->len) {
+        /* Yes, send current one, pass to the next. */
+        ovlp = &g_array_index(prof->overlaps, CCLProfOverlap, prof->overlap_iter);
+        prof->overlap_iter++;
+    } else {
+        /* Nothing left. */
+        ovlp = NULL;
+    }
+
+    /* Return the overlap instance. */
+    return (const CCLProfOverlap *) ovlp;
+}
+
+/**
+ * Initialize an iterator for command slack instances.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] sort Bitfield of ::CCLProfSlackSort OR ::CCLProfSortOrder, for
+ * example `CCL_PROF_SLACK_SORT_SLACK | CCL_PROF_SORT_ASC`.
+ * */
+CCL_EXPORT
+void ccl_prof_iter_slack_init(CCLProf * prof, int sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Sort array of command slacks as requested by client. */
+    g_array_sort_with_data(prof->slacks, ccl_prof_slack_comp, &sort);
+
+    /* Set the iterator as the first element in array. */
+    prof->slack_iter = 0;
+}
+
+/**
+ * Return the next command slack instance.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The next command slack instance or `NULL` if no more instances
+ * are left.
+ * */
+CCL_EXPORT
+const CCLProfSlack * ccl_prof_iter_slack_next(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* The command slack instance to return. */
+    CCLProfSlack * slk;
+
+    /* Check if there are any more left. */
+    if (prof->slack_iter < prof->slacks->len) {
+        /* Yes, send current one, pass to the next. */
+        slk = &g_array_index(prof->slacks, CCLProfSlack, prof->slack_iter);
+        prof->slack_iter++;
+    } else {
+        /* Nothing left. */
+        slk = NULL;
+    }
+
+    /* Return the command slack instance. */
+    return (const CCLProfSlack *) slk;
+}
+
+/**
+ * Get duration of the critical path through the command dependencies, in
+ * nanoseconds, i.e. the shortest possible duration of all events given
+ * their dependencies and individual durations.
+ *
+ * Returns zero if events were drained with ::ccl_prof_drain().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The duration of the critical path in nanoseconds.
+ * */
+CCL_EXPORT
+cl_ulong ccl_prof_get_critical_duration(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, 0);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, 0);
+
+    /* Return requested data. */
+    return prof->crit_duration;
+}
+
+/**
+ * Return utilization of the command queue with the given name.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] queue_name Command queue name.
+ * @return Utilization of the command queue with the given name, or `NULL`
+ * if no such queue was added to the profile object or if events were
+ * drained with ::ccl_prof_drain().
+ * */
+CCL_EXPORT
+const CCLProfUtil * ccl_prof_get_queue_util(
+    CCLProf * prof, const char * queue_name) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* Make sure queue name is not NULL. */
+    g_return_val_if_fail(queue_name != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* Return requested data. */
+    return (prof->queue_utils != NULL) ? (const CCLProfUtil *)
+        g_hash_table_lookup(prof->queue_utils, queue_name) : NULL;
+}
+
+/**
+ * Return utilization of the given device, i.e. of the union of events in
+ * all profiled command queues associated with the device.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] dev Device wrapper object.
+ * @return Utilization of the given device, or `NULL` if no queue
+ * associated with the device was added to the profile object or if events
+ * were drained with ::ccl_prof_drain().
+ * */
+CCL_EXPORT
+const CCLProfUtil * ccl_prof_get_device_util(
+    CCLProf * prof, CCLDevice * dev) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* Make sure device is not NULL. */
+    g_return_val_if_fail(dev != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* Return requested data. */
+    return (prof->device_utils != NULL) ? (const CCLProfUtil *)
+        g_hash_table_lookup(prof->device_utils, ccl_device_unwrap(dev))
+        : NULL;
+}
+
+/**
+ * Get duration of all events in nanoseconds.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The duration of all events in nanoseconds.
+ * */
+CCL_EXPORT
+cl_ulong ccl_prof_get_duration(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, 0);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, 0);
+
+    /* Return requested data. */
+    return prof->total_events_time;
+}
+
+/**
+ * Get effective duration of all events in nanoseconds, i.e. the duration of
+ * all events minus event overlaps.
+ *
+ * If no overlaps occur, this function will return the same value as
+ * ::ccl_prof_get_duration().
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @return The effective duration of all events in nanoseconds, i.e. the
+ * duration of all events minus event overlaps.
+ * */
+CCL_EXPORT
+cl_ulong ccl_prof_get_eff_duration(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, 0);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, 0);
+
+    /* Return requested data. */
+    return prof->total_events_eff_time;
+}
+
+/**
+ * @internal
+ *
+ * @brief Compares the names of two utilization objects. It is an
+ * implementation of `GCompareFunc` from GLib.
+ *
+ * @private @memberof ccl_prof_util
+ *
+ * @param[in] a First utilization object.
+ * @param[in] b Second utilization object.
+ * @return Negative value if `a < b`; zero if `a == b`; positive value if
+ * `a > b`.
+ * */
+static gint ccl_prof_util_comp(gconstpointer a, gconstpointer b) {
+
+    return g_strcmp0(
+        ((const CCLProfUtil *) a)->name, ((const CCLProfUtil *) b)->name);
+}
+
+/**
+ * @internal
+ *
+ * @brief Append a table of queue or device utilization to a summary.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in,out] str_obj Summary string.
+ * @param[in] title Table title.
+ * @param[in] utils Table of utilization objects (values are
+ * ::CCLProfUtil*).
+ * */
+static void ccl_prof_summary_util(
+    GString * str_obj, const char * title, GHashTable * utils) {
+
+    /* Utilization objects, sorted by name. */
+    GList * util_list, * curr;
+
+    /* Sort utilization objects by name, so that tables are reproducible. */
+    util_list = g_list_sort(
+        g_hash_table_get_values(utils), ccl_prof_util_comp);
+
+    /* Show table. */
+    g_string_append(str_obj, title);
+    g_string_append(str_obj,
+        "   ---------------------------------------------------------------"
+        "-------------------------\n");
+    g_string_append(str_obj,
+        "   | Name                   |   Busy (s) | Util. (%) |  Gaps | "
+        "Max gap (s) | Host lag (%) |\n");
+    g_string_append(str_obj,
+        "   ---------------------------------------------------------------"
+        "-------------------------\n");
+    for (curr = util_list; curr != NULL; curr = curr->next) {
+        const CCLProfUtil * util = (const CCLProfUtil *) curr->data;
+        g_string_append_printf(str_obj,
+            "   | %-22.22s | %10.4e | %9.4f | %5u | %11.4e | %12.4f |\n",
+            util->name, util->busy_time * 1e-9,
+            util->span > 0 ? util->busy_time * 100.0 / util->span : 100.0,
+            util->num_gaps, util->max_gap * 1e-9,
+            util->idle_time > 0
+                ? util->host_lag_time * 100.0 / util->idle_time : 0.0);
+    }
+    g_string_append(str_obj,
+        "   ---------------------------------------------------------------"
+        "-------------------------\n");
+
+    /* Release list. */
+    g_list_free(util_list);
+}
+
+/**
+ * @internal
+ *
+ * @brief Statistics of host-side ranges with the same name, shown in the
+ * summary.
+ * */
+typedef struct ccl_prof_range_sum {
+
+    /** Name of ranges. */
+    const char * name;
+
+    /** Number of ranges. */
+    cl_uint count;
+
+    /** Total host time of ranges. */
+    cl_ulong host_time;
+
+    /** Total device time of ranges. */
+    cl_ulong device_time;
+
+    /** Total number of events attributed to ranges. */
+    cl_uint num_events;
+
+} CCLProfRangeSum;
+
+/**
+ * @internal
+ *
+ * @brief Append a table of host-side ranges, grouped by name in the
+ * order they were first pushed, to a summary.
+ *
+ * @private @memberof ccl_prof
+ *
+ * @param[in,out] str_obj Summary string.
+ * @param[in] prof Profile object.
+ * */
+static void ccl_prof_summary_ranges(GString * str_obj, CCLProf * prof) {
+
+    /* Range statistics, in order of first range, and table of their
+     * indexes (keys: range names). */
+    GArray * sums = g_array_new(FALSE, FALSE, sizeof(CCLProfRangeSum));
+    GHashTable * idxs = g_hash_table_new(g_str_hash, g_str_equal);
+    const CCLProfRange * rng;
+    CCLProfRangeSum * sum;
+    gpointer p_idx;
+
+    /* Group ranges by name. */
+    ccl_prof_iter_range_init(prof,
+        CCL_PROF_RANGE_SORT_T_START | CCL_PROF_SORT_ASC);
+    while ((rng = ccl_prof_iter_range_next(prof)) != NULL) {
+        if (g_hash_table_lookup_extended(idxs, rng->name, NULL, &p_idx)) {
+            sum = &g_array_index(
+                sums, CCLProfRangeSum, GPOINTER_TO_UINT(p_idx));
+        } else {
+            g_hash_table_insert(idxs,
+                (gpointer) rng->name, GUINT_TO_POINTER(sums->len));
+            g_array_set_size(sums, sums->len + 1);
+            sum = &g_array_index(sums, CCLProfRangeSum, sums->len - 1);
+            sum->name = rng->name;
+            sum->count = 0;
+            sum->host_time = 0;
+            sum->device_time = 0;
+            sum->num_events = 0;
+        }
+        sum->count++;
+        sum->host_time += rng->t_end - rng->t_start;
+        sum->device_time += rng->device_time;
+        sum->num_events += rng->num_events;
+    }
+
+    /* Show table. */
+    g_string_append(str_obj, " Host ranges               :\n");
+    g_string_append(str_obj,
+        "   -----------------------------------------------------------------"
+        "---------------------\n");
+    g_string_append(str_obj,
+        "   | Range                          |     Count |    Host (s) | "
+        " Device (s) |    Events |\n");
+    g_string_append(str_obj,
+        "   -----------------------------------------------------------------"
+        "---------------------\n");
+    for (guint i = 0; i < sums->len; ++i) {
+        sum = &g_array_index(sums, CCLProfRangeSum, i);
+        g_string_append_printf(str_obj,
+            "   | %-30.30s | %9u | %11.4e | %11.4e | %9u |\n",
+            sum->name, sum->count, sum->host_time * 1e-9,
+            sum->device_time * 1e-9, sum->num_events);
+    }
+    g_string_append(str_obj,
+        "   -----------------------------------------------------------------"
+        "---------------------\n");
+
+    /* Release range statistics. */
+    g_hash_table_destroy(idxs);
+    g_array_free(sums, TRUE);
+}
+
+/**
+ * Print a summary of the profiling info. More specifically, this function
+ * prints a table of aggregate event statistics (sorted by absolute time), and
+ * a table of event overlaps (sorted by overlap duration).
+ *
+ * For more control of where and how this summary is printed, use the
+ * ccl_prof_get_summary() function.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * */
+CCL_EXPORT
+void ccl_prof_print_summary(CCLProf * prof) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_if_fail(prof->calc == TRUE);
+
+    /* Summary to print. */
+    const char * summary;
+
+    /* Get the summary. */
+    summary = ccl_prof_get_summary(prof,
+        CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC,
+        CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC);
+
+    /* Print summary. */
     g_printf("%s", summary);
 }
 
 /**
- * Get a summary with the profiling info. More specifically, this function
- * returns a string containing a table of aggregate event statistics and a
- * table of event overlaps. The order of the returned information can be
- * specified in the function arguments.
+ * Get a summary with the profiling info. More specifically, this function
+ * returns a string containing a table of aggregate event statistics and a
+ * table of event overlaps. The order of the returned information can be
+ * specified in the function arguments.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] agg_sort Sorting performed on aggregate statistics (bitfield of
+ * ::CCLProfAggSort ORed with ::CCLProfSortOrder).
+ * @param[in] ovlp_sort Sorting performed on event overlaps (bitfield of
+ * ::CCLProfOverlapSort ORed with ::CCLProfSortOrder).
+ * @return A string containing the summary.
+ * */
+CCL_EXPORT
+const char * ccl_prof_get_summary(
+    CCLProf * prof, int agg_sort, int ovlp_sort) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, NULL);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, NULL);
+
+    /* Current aggregate statistic to print. */
+    const CCLProfAgg * agg = NULL;
+    /* Current overlap to print. */
+    const CCLProfOverlap * ovlp = NULL;
+    /* The summary string. */
+    GString * str_obj = g_string_new("\n");
+
+    /* Show aggregate event times */
+    g_string_append_printf(str_obj,
+        " Aggregate times by event  :\n");
+    g_string_append_printf(str_obj,
+        "   ------------------------------------------------------------------\n");
+    g_string_append_printf(str_obj,
+        "   | Event name                     | Rel. time (%%) | Abs. time (s) |\n");
+    g_string_append_printf(str_obj,
+        "   ------------------------------------------------------------------\n");
+    ccl_prof_iter_agg_init(prof, agg_sort);
+    while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+        g_string_append_printf(str_obj,
+            "   | %-30.30s | %13.4f | %13.4e |\n",
+            agg->event_name,
+            agg->relative_time * 100.0,
+            agg->absolute_time * 1e-9);
+    }
+    g_string_append_printf(str_obj,
+        "   ------------------------------------------------------------------\n");
+
+    /* Show total events time */
+    if (prof->total_events_time > 0) {
+        g_string_append_printf(str_obj,
+            "                                    |         Total | %13.4e |\n",
+            prof->total_events_time * 1e-9);
+        g_string_append_printf(str_obj,
+            "                                    ---------------------------------\n");
+    }
+
+    /* Show event duration statistics */
+    g_string_append_printf(str_obj,
+        " Event duration statistics :\n");
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "----------------------------------------\n");
+    g_string_append_printf(str_obj,
+        "   | Event name                     |    Count |    Mean (s) | "
+        "Std. dev. (s) |     Min (s) |     Max (s) |\n");
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "----------------------------------------\n");
+    ccl_prof_iter_agg_init(prof, agg_sort);
+    while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+        g_string_append_printf(str_obj,
+            "   | %-30.30s | %8u | %11.4e | %13.4e | %11.4e | %11.4e |\n",
+            agg->event_name, agg->count, agg->mean_time * 1e-9,
+            agg->std_time * 1e-9, agg->min_time * 1e-9,
+            agg->max_time * 1e-9);
+    }
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "----------------------------------------\n");
+
+    /* Show event duration percentiles */
+    g_string_append_printf(str_obj,
+        " Event duration percentiles:\n");
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "---------------------------\n");
+    g_string_append_printf(str_obj,
+        "   | Event name                     |     p50 (s) |     p90 (s) | "
+        "    p99 (s) |   p99.9 (s) |\n");
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "---------------------------\n");
+    ccl_prof_iter_agg_init(prof, agg_sort);
+    while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+        g_string_append_printf(str_obj,
+            "   | %-30.30s | %11.4e | %11.4e | %11.4e | %11.4e |\n",
+            agg->event_name, agg->p50_time * 1e-9, agg->p90_time * 1e-9,
+            agg->p99_time * 1e-9, agg->p999_time * 1e-9);
+    }
+    g_string_append_printf(str_obj,
+        "   ---------------------------------------------------------------"
+        "---------------------------\n");
+
+    /* Show metrics derived from performance counters */
+    if (prof->counters_fn != NULL) {
+        g_string_append_printf(str_obj,
+            " Derived metrics by event  :\n");
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+        g_string_append_printf(str_obj,
+            "   | Event name                     | Bandw. (GB/s) | Occupancy (%%) |\n");
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+        ccl_prof_iter_agg_init(prof, agg_sort);
+        while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+            if (agg->counters == NULL) continue;
+            g_string_append_printf(str_obj,
+                "   | %-30.30s | %13.4f | %13.4f |\n",
+                agg->event_name, agg->bandwidth * 1e-9,
+                agg->occupancy * 100.0);
+        }
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+    }
+
+    /* Show slowest instance of each event name */
+    if (prof->slowest_k > 0) {
+        const CCLProfSlow * slow;
+        cl_uint num_slow;
+        g_string_append_printf(str_obj,
+            " Slowest event instances   :\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------"
+            "-------------------------------------------\n");
+        g_string_append_printf(str_obj,
+            "   | Event name                     | Queue            | "
+            "Duration (s)  | Tag              |\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------"
+            "-------------------------------------------\n");
+        ccl_prof_iter_agg_init(prof, agg_sort);
+        while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+            slow = ccl_prof_get_slowest(prof, agg->event_name, &num_slow);
+            if (num_slow == 0) continue;
+            g_string_append_printf(str_obj,
+                "   | %-30.30s | %-16.16s | %13.4e | %-16.16s |\n",
+                agg->event_name, slow->info.queue_name,
+                ccl_prof_slow_duration(slow) * 1e-9,
+                slow->tag != NULL ? slow->tag : "");
+        }
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------"
+            "-------------------------------------------\n");
+    }
+
+    /* *** Show overlaps *** */
+
+    if (prof->overlaps->len > 0) {
+        /* Title the several overlaps. */
+        g_string_append_printf(str_obj,
+            " Event overlaps            :\n");
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+        g_string_append_printf(str_obj,
+            "   | Event 1                | Event2                 | Overlap (s)  |\n");
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+        /* Show overlaps table. */
+        ccl_prof_iter_overlap_init(prof, ovlp_sort);
+        while ((ovlp = ccl_prof_iter_overlap_next(prof)) != NULL) {
+            g_string_append_printf(str_obj, "   | %-22.22s | %-22.22s | %12.4e |\n",
+                ovlp->event1_name, ovlp->event2_name, ovlp->duration * 1e-9);
+        }
+        g_string_append_printf(str_obj,
+            "   ------------------------------------------------------------------\n");
+        /* Show total events effective time (discount overlaps) */
+        g_string_append_printf(str_obj,
+            "                            |                  Total | %12.4e |\n",
+            (prof->total_events_time - prof->total_events_eff_time) * 1e-9);
+        g_string_append_printf(str_obj,
+            "                            -----------------------------------------\n");
+        g_string_append_printf(str_obj,
+            " Tot. of all events (eff.) : %es\n",
+            prof->total_events_eff_time * 1e-9);
+    } else {
+        g_string_append_printf(str_obj,
+            " Event overlaps            : None\n");
+    }
+
+    /* *** Show critical path *** */
+
+    if (prof->slacks->len > 0) {
+        /* Critical path time per event name. */
+        GHashTable * crit_times = g_hash_table_new_full(
+            g_str_hash, g_str_equal, NULL, g_free);
+        const CCLProfSlack * slk;
+        cl_ulong * crit_time;
+        /* Sum durations of commands with zero slack per event name. */
+        ccl_prof_iter_slack_init(prof,
+            CCL_PROF_SLACK_SORT_T_START | CCL_PROF_SORT_ASC);
+        while ((slk = ccl_prof_iter_slack_next(prof)) != NULL) {
+            if ((slk->slack > 0) || (slk->t_end <= slk->t_start)) continue;
+            crit_time = g_hash_table_lookup(crit_times, slk->event_name);
+            if (crit_time == NULL) {
+                crit_time = g_new0(cl_ulong, 1);
+                g_hash_table_insert(crit_times,
+                    (gpointer) slk->event_name, crit_time);
+            }
+            *crit_time += slk->t_end - slk->t_start;
+        }
+        /* Show critical path table, in the order of aggregate events. */
+        g_string_append_printf(str_obj,
+            " Critical path             :\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------\n");
+        g_string_append_printf(str_obj,
+            "   | Event name                     | Time (s)     "
+            "| Rel. (%%) |\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------\n");
+        ccl_prof_iter_agg_init(prof, agg_sort);
+        while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
+            crit_time = g_hash_table_lookup(crit_times, agg->event_name);
+            if (crit_time == NULL) continue;
+            g_string_append_printf(str_obj,
+                "   | %-30.30s | %12.4e | %8.4f |\n",
+                agg->event_name, *crit_time * 1e-9,
+                prof->crit_duration > 0
+                    ? *crit_time * 100.0 / prof->crit_duration : 0);
+        }
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------\n");
+        g_string_append_printf(str_obj,
+            " Critical path duration    : %es\n",
+            prof->crit_duration * 1e-9);
+        g_hash_table_destroy(crit_times);
+    }
+
+    /* *** Show queue and device utilization *** */
+
+    if (prof->queue_utils != NULL) {
+        ccl_prof_summary_util(str_obj, " Queue utilization         :\n",
+            prof->queue_utils);
+        ccl_prof_summary_util(str_obj, " Device utilization        :\n",
+            prof->device_utils);
+    }
+
+    /* *** Show host-side calls *** */
+
+    if (prof->host_aggs->len > 0) {
+        g_string_append_printf(str_obj,
+            " Host-side calls           :\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------------"
+            "-------------------------\n");
+        g_string_append_printf(str_obj,
+            "   | Function                       |     Calls |   Total (s) | "
+            "   Mean (s) |     p99 (s) |\n");
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------------"
+            "-------------------------\n");
+        ccl_prof_iter_host_init(prof,
+            CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC);
+        while ((agg = ccl_prof_iter_host_next(prof)) != NULL) {
+            g_string_append_printf(str_obj,
+                "   | %-30.30s | %9u | %11.4e | %11.4e | %11.4e |\n",
+                agg->event_name, agg->count, agg->absolute_time * 1e-9,
+                agg->mean_time * 1e-9, agg->p99_time * 1e-9);
+        }
+        g_string_append_printf(str_obj,
+            "   ---------------------------------------------------------------"
+            "-------------------------\n");
+    }
+
+    /* *** Show host-side ranges *** */
+
+    if (prof->ranges->len > 0)
+        ccl_prof_summary_ranges(str_obj, prof);
+
+    /* Show total elapsed time */
+    if (prof->timer) {
+        double t_elapsed = g_timer_elapsed(prof->timer, NULL);
+        g_string_append_printf(str_obj,
+            " Total elapsed time        : %es\n", t_elapsed);
+        g_string_append_printf(str_obj,
+            " Time spent in device      : %.2f%%\n",
+            prof->total_events_eff_time * 1e-9 * 100 / t_elapsed);
+        g_string_append_printf(str_obj,
+            " Time spent in host        : %.2f%%\n",
+            100 - prof->total_events_eff_time * 1e-9 * 100 / t_elapsed);
+    }
+    g_string_append_printf(str_obj, "\n");
+
+    /* If a summary already exists, free it before keeping a new one. */
+    if (prof->summary != NULL)
+        g_free(prof->summary);
+
+    /* Free String object and keep underlying string in prof struct. */
+    prof->summary = g_string_free(str_obj, FALSE);
+
+    /* Return summary string. */
+    return (const char *) prof->summary;
+}
+
+/**
+ * Export event profiling information to a given stream.
+ *
+ * Each line of the exported data will have the following format,
+ * ordered by event start time:
+ *
+ *     queue start-time end-time event-name
+ *
+ * For example:
+ *
+ *     q0    100    120    load_data1
+ *     q1    100    132    load_data2
+ *     q0    121    159    process_data1
+ *     q1    133    145    process_data2
+ *     q0    146    157    read_result
+ *
+ * Several export parameters can be configured with the
+ * ccl_prof_get_export_opts() and ccl_prof_set_export_opts() functions,
+ * by manipulating a ::CCLProfExportOptions struct.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[out] stream Stream where export info to.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_info(CCLProf * prof, FILE * stream, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure stream is not NULL. */
+    g_return_val_if_fail(stream != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+
+    /* Stream write status. */
+    int write_status;
+    /* Return status. */
+    cl_bool ret_status;
+    /* Current event information. */
+    const CCLProfInfo * curr_ev;
+    /* Start time. */
+    cl_ulong t_start = 0;
+
+    /* Sort event information by START order, ascending. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+
+    /* If zero start is set, use the start time of the first event
+     * as zero time. */
+    if (export_options.zero_start)
+        t_start = prof->t_start;
+
+    /* Iterate through all event information and export it to stream. */
+    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL) {
+
+        /* Write to stream. */
+        write_status = fprintf(stream, "%s%s%s%s%lu%s%lu%s%s%s%s%s",
+            export_options.queue_delim,
+            curr_ev->queue_name,
+            export_options.queue_delim,
+            export_options.separator,
+            (unsigned long) (curr_ev->t_start - t_start),
+            export_options.separator,
+            (unsigned long) (curr_ev->t_end - t_start),
+            export_options.separator,
+            export_options.evname_delim,
+            curr_ev->event_name,
+            export_options.evname_delim,
+            export_options.newline);
+
+        ccl_if_err_create_goto(*err, CCL_ERROR, write_status < 0,
+            CCL_ERROR_STREAM_WRITE, error_handler,
+            "Error while exporting profiling information" \
+            "(writing to stream).");
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Helper function which exports profiling info to a given file, automatically
+ * opening and closing the file. See the ccl_prof_export_info() for more
+ * information.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] filename Name of file where information will be saved to.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_info_file(
+    CCLProf * prof, const char * filename, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+
+    /* Aux. var. */
+    cl_bool status;
+
+    /* Internal CCLErr object. */
+    CCLErr * err_internal = NULL;
+
+    /* Open file. */
+    FILE * fp = fopen(filename, "w");
+    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
+        CCL_ERROR_OPENFILE, error_handler,
+        "Unable to open file '%s' for exporting.", filename);
+
+    /* Export data. */
+    status = ccl_prof_export_info(prof, fp, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Close file. */
+    if (fp) fclose(fp);
+
+    /* Return file contents in string form. */
+    return status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Append a string to a `GString` as a JSON string literal.
+ *
+ * @param[in,out] json `GString` where to append the string literal.
+ * @param[in] str String to append.
+ * */
+static void ccl_prof_json_append_str(GString * json, const char * str) {
+
+    g_string_append_c(json, '"');
+    for (const char * c = str; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':
+                g_string_append(json, "\\\"");
+                break;
+            case '\\':
+                g_string_append(json, "\\\\");
+                break;
+            default:
+                if ((unsigned char) *c < 0x20)
+                    g_string_append_printf(json, "\\u%04x", (guint) *c);
+                else
+                    g_string_append_c(json, *c);
+        }
+    }
+    g_string_append_c(json, '"');
+}
+
+/**
+ * @internal
+ *
+ * @brief Command queue track in an exported trace.
+ * */
+typedef struct ccl_prof_trace_track {
+
+    /** Track ID. */
+    guint tid;
+
+    /** End instant of the latest event in the track. */
+    cl_ulong t_end;
+
+} CCLProfTraceTrack;
+
+/**
+ * Export event profiling information to a given stream in the Chrome
+ * trace event JSON format, which can be opened with `chrome://tracing`
+ * or [Perfetto](https://ui.perfetto.dev).
+ *
+ * Each command queue is exported as a track (thread) with the queue
+ * name, and each event as a slice with the event name, the command type
+ * as category, and the queued and submit instants as arguments. Periods in
+ * which a queue is idle between events are exported as `IDLE` slices,
+ * and a `Concurrent events` counter track shows how many events are
+ * executing at each instant, highlighting event overlaps. Host-side
+ * ranges are exported as nested slices of a separate `Host ranges`
+ * process, with the number of attributed events and their device time as
+ * arguments; they are only aligned with events if clocks were
+ * synchronized with ccl_prof_sync_clocks(). Total and effective durations
+ * are exported as trace metadata.
+ *
+ * Times are exported in microseconds. The `zero_start` export option
+ * (see ::CCLProfExportOptions) is taken into account, while the other
+ * export options are ignored.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[out] stream Stream where export info to.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_trace(CCLProf * prof, FILE * stream, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure stream is not NULL. */
+    g_return_val_if_fail(stream != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+
+    /* Stream write status. */
+    int write_status;
+    /* Return status. */
+    cl_bool ret_status;
+    /* Current event information. */
+    const CCLProfInfo * curr_ev;
+    /* Current host-side range. */
+    const CCLProfRange * rng;
+    /* Start time. */
+    cl_ulong t_start = 0;
+    /* JSON output. */
+    GString * json = g_string_new("{\"traceEvents\":[");
+    /* Table of command queue tracks (keys: queue names). */
+    GHashTable * tracks = g_hash_table_new_full(
+        g_str_hash, g_str_equal, NULL, g_free);
+    /* Current command queue track. */
+    CCLProfTraceTrack * track;
+    /* Type of sorting to perform on event instants. */
+    int sort_type;
+    /* Number of concurrent events. */
+    guint num_concurrent = 0;
+    /* Separator between trace events. */
+    const char * sep = "";
+
+    /* Sort event information by START order, ascending. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+
+    /* If zero start is set, use the start time of the first event
+     * as zero time. */
+    if (export_options.zero_start)
+        t_start = prof->t_start;
+
+    /* Iterate through all event information and export them as slices. */
+    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL) {
+
+        /* Get track of event queue, creating it if necessary. */
+        track = g_hash_table_lookup(tracks, curr_ev->queue_name);
+        if (track == NULL) {
+
+            track = g_new(CCLProfTraceTrack, 1);
+            track->tid = g_hash_table_size(tracks);
+            track->t_end = curr_ev->t_start;
+            g_hash_table_insert(
+                tracks, (gpointer) curr_ev->queue_name, track);
+
+            /* Name the track after the queue. */
+            g_string_append_printf(json, "%s{\"name\":\"thread_name\","
+                "\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":",
+                sep, track->tid);
+            ccl_prof_json_append_str(json, curr_ev->queue_name);
+            g_string_append(json, "}}");
+            sep = ",";
+        }
+
+        /* Export idle period in track, if any. */
+        if (curr_ev->t_start > track->t_end) {
+            g_string_append_printf(json, "%s{\"name\":\"IDLE\","
+                "\"cat\":\"idle\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                "\"ts\":%.3f,\"dur\":%.3f}", sep, track->tid,
+                (track->t_end - t_start) / 1000.0,
+                (curr_ev->t_start - track->t_end) / 1000.0);
+            sep = ",";
+        }
+        track->t_end = MAX(track->t_end, curr_ev->t_end);
+
+        /* Export event slice. */
+        g_string_append_printf(json, "%s{\"name\":", sep);
+        ccl_prof_json_append_str(json, curr_ev->event_name);
+        g_string_append(json, ",\"cat\":");
+        ccl_prof_json_append_str(json,
+            ccl_event_command_type_name(curr_ev->command_type) != NULL
+            ? ccl_event_command_type_name(curr_ev->command_type)
+            : "UNKNOWN");
+        g_string_append_printf(json, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"queued\":%.3f,"
+            "\"submit\":%.3f}}", track->tid,
+            (curr_ev->t_start - t_start) / 1000.0,
+            (curr_ev->t_end - curr_ev->t_start) / 1000.0,
+            (gdouble) ((gint64) (curr_ev->t_queued - t_start)) / 1000.0,
+            (gdouble) ((gint64) (curr_ev->t_submit - t_start)) / 1000.0);
+        sep = ",";
+    }
+
+    /* Export number of concurrent events, from event instants sorted by
+     * instant, emitting a single value per instant. */
+    sort_type = CCL_PROF_INST_SORT_INSTANT | CCL_PROF_SORT_ASC;
+    g_array_sort_with_data(
+        prof->instants, ccl_prof_inst_comp, (gpointer) &sort_type);
+    for (guint i = 0; i < prof->instants->len; ++i) {
+
+        CCLProfInst * inst = &g_array_index(prof->instants, CCLProfInst, i);
+
+        if (inst->type == CCL_PROF_INST_TYPE_START)
+            num_concurrent++;
+        else
+            num_concurrent--;
+
+        if ((i + 1 < prof->instants->len) && (inst->instant ==
+            g_array_index(prof->instants, CCLProfInst, i + 1).instant))
+            continue;
+
+        g_string_append_printf(json, "%s{\"name\":\"Concurrent events\","
+            "\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{\"events\":%u}}",
+            sep, (inst->instant - t_start) / 1000.0, num_concurrent);
+        sep = ",";
+    }
+
+    /* Export host-side ranges as slices of a separate process, which are
+     * nested according to their instants. */
+    if (prof->ranges->len > 0) {
+        g_string_append_printf(json, "%s{\"name\":\"process_name\","
+            "\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Host ranges\"}}",
+            sep);
+        sep = ",";
+    }
+    ccl_prof_iter_range_init(prof,
+        CCL_PROF_RANGE_SORT_T_START | CCL_PROF_SORT_ASC);
+    while ((rng = ccl_prof_iter_range_next(prof)) != NULL) {
+        g_string_append_printf(json, "%s{\"name\":", sep);
+        ccl_prof_json_append_str(json, rng->name);
+        g_string_append_printf(json, ",\"cat\":\"range\",\"ph\":\"X\","
+            "\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+            "\"args\":{\"events\":%u,\"device_time\":%.3f}}",
+            (gdouble) ((gint64) (rng->t_start - t_start)) / 1000.0,
+            (rng->t_end - rng->t_start) / 1000.0, rng->num_events,
+            rng->device_time / 1000.0);
+    }
+
+    /* Export durations as trace metadata. */
+    g_string_append_printf(json, "],\"displayTimeUnit\":\"ns\","
+        "\"otherData\":{\"duration_ns\":\"%lu\","
+        "\"effective_duration_ns\":\"%lu\"}}\n",
+        (unsigned long) prof->total_events_time,
+        (unsigned long) prof->total_events_eff_time);
+
+    /* Write to stream. */
+    write_status = fputs(json->str, stream);
+    ccl_if_err_create_goto(*err, CCL_ERROR, write_status < 0,
+        CCL_ERROR_STREAM_WRITE, error_handler,
+        "Error while exporting profiling trace (writing to stream).");
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release JSON output and table of tracks. */
+    g_string_free(json, TRUE);
+    g_hash_table_destroy(tracks);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Helper function which exports profiling info in the Chrome trace event
+ * JSON format to a given file, automatically opening and closing the
+ * file. See the ccl_prof_export_trace() for more information.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] filename Name of file where information will be saved to.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_trace_file(
+    CCLProf * prof, const char * filename, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+
+    /* Aux. var. */
+    cl_bool status;
+
+    /* Internal CCLErr object. */
+    CCLErr * err_internal = NULL;
+
+    /* Open file. */
+    FILE * fp = fopen(filename, "w");
+    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
+        CCL_ERROR_OPENFILE, error_handler,
+        "Unable to open file '%s' for exporting.", filename);
+
+    /* Export data. */
+    ccl_prof_export_trace(prof, fp, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Close file. */
+    if (fp) fclose(fp);
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Append a label value to an OpenMetrics exposition, escaping
+ * backslashes, double quotes and line feeds.
+ *
+ * @param[in,out] om OpenMetrics exposition.
+ * @param[in] str Label value.
+ * */
+static void ccl_prof_metrics_append_label(GString * om, const char * str) {
+
+    g_string_append_c(om, '"');
+    for (const char * c = str; *c != '\0'; ++c) {
+        switch (*c) {
+            case '"':
+                g_string_append(om, "\\\"");
+                break;
+            case '\\':
+                g_string_append(om, "\\\\");
+                break;
+            case '\n':
+                g_string_append(om, "\\n");
+                break;
+            default:
+                g_string_append_c(om, *c);
+        }
+    }
+    g_string_append_c(om, '"');
+}
+
+/**
+ * @internal
+ *
+ * @brief Append a histogram of durations to an OpenMetrics exposition,
+ * with buckets at powers of ten from 1 &mu;s to 10 s.
+ *
+ * Each internal histogram bucket is counted in the first bound not below
+ * its highest duration.
+ *
+ * @param[in,out] om OpenMetrics exposition.
+ * @param[in] metric Metric name.
+ * @param[in] label Name of label whose value is the histogram name.
+ * @param[in] hist Histogram of durations.
+ * */
+static void ccl_prof_metrics_append_hist(GString * om, const char * metric,
+    const char * label, CCLProfHist * hist) {
+
+    /* Upper bounds of histogram buckets, in nanoseconds. */
+    static const cl_ulong bounds[] = { 1000, 10000, 100000, 1000000,
+        10000000, 100000000, 1000000000, 10000000000 };
+    /* Cumulative count and current internal bucket. */
+    guint64 cumul = 0;
+    guint bucket = 0;
+
+    /* Cumulative bucket counts. */
+    for (guint b = 0; b < G_N_ELEMENTS(bounds); ++b) {
+        while ((bucket < hist->counts->len)
+                && (ccl_prof_hist_bucket_max(bucket) <= bounds[b])) {
+            cumul += g_array_index(hist->counts, guint, bucket);
+            bucket++;
+        }
+        g_string_append_printf(om, "%s_bucket{%s=", metric, label);
+        ccl_prof_metrics_append_label(om, hist->event_name);
+        g_string_append_printf(om, ",le=\"%lu\"} %lu\n",
+            (unsigned long) bounds[b], (unsigned long) cumul);
+    }
+    for (; bucket < hist->counts->len; ++bucket)
+        cumul += g_array_index(hist->counts, guint, bucket);
+
+    /* Infinity bucket, count and sum. */
+    g_string_append_printf(om, "%s_bucket{%s=", metric, label);
+    ccl_prof_metrics_append_label(om, hist->event_name);
+    g_string_append_printf(om, ",le=\"+Inf\"} %lu\n", (unsigned long) cumul);
+    g_string_append_printf(om, "%s_count{%s=", metric, label);
+    ccl_prof_metrics_append_label(om, hist->event_name);
+    g_string_append_printf(om, "} %lu\n", (unsigned long) cumul);
+    g_string_append_printf(om, "%s_sum{%s=", metric, label);
+    ccl_prof_metrics_append_label(om, hist->event_name);
+    g_string_append_printf(om, "} %lu\n", (unsigned long) hist->total_time);
+}
+
+/**
+ * @internal
+ *
+ * @brief Build the OpenMetrics exposition of a profile object.
+ *
+ * @param[in] prof Profile object.
+ * @return A new string with the OpenMetrics exposition, which should be
+ * freed with g_string_free().
+ * */
+static GString * ccl_prof_metrics_build(CCLProf * prof) {
+
+    /* OpenMetrics exposition. */
+    GString * om = g_string_new("");
+    /* Hash table iterator. */
+    GHashTableIter iter;
+    gpointer cq_name, p_live, p_call;
+
+    /* Event counters. */
+    g_string_append(om,
+        "# TYPE ccl_prof_events counter\n"
+        "# HELP ccl_prof_events Events seen, including events not "
+        "sampled.\n");
+    for (guint i = 0; i < prof->hists->len; ++i) {
+        CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+        g_string_append(om, "ccl_prof_events_total{event=");
+        ccl_prof_metrics_append_label(om, hist->event_name);
+        g_string_append_printf(om, "} %u\n", hist->seen);
+    }
+
+    /* Event duration histograms. */
+    g_string_append(om,
+        "# TYPE ccl_prof_event_duration_nanoseconds histogram\n"
+        "# UNIT ccl_prof_event_duration_nanoseconds nanoseconds\n"
+        "# HELP ccl_prof_event_duration_nanoseconds Duration of sampled "
+        "events.\n");
+    for (guint i = 0; i < prof->hists->len; ++i)
+        ccl_prof_metrics_append_hist(om,
+            "ccl_prof_event_duration_nanoseconds", "event",
+            &g_array_index(prof->hists, CCLProfHist, i));
+
+    /* Event latency counters. */
+    g_string_append(om,
+        "# TYPE ccl_prof_event_queue_latency_nanoseconds counter\n"
+        "# UNIT ccl_prof_event_queue_latency_nanoseconds nanoseconds\n"
+        "# HELP ccl_prof_event_queue_latency_nanoseconds Time from queued "
+        "to start of sampled events.\n");
+    for (guint i = 0; i < prof->hists->len; ++i) {
+        CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+        g_string_append(om,
+            "ccl_prof_event_queue_latency_nanoseconds_total{event=");
+        ccl_prof_metrics_append_label(om, hist->event_name);
+        g_string_append_printf(om, "} %lu\n",
+            (unsigned long) hist->total_latency);
+    }
+
+    /* Performance counters and derived metrics. */
+    if (prof->counters_fn != NULL) {
+        g_string_append(om,
+            "# TYPE ccl_prof_event_counter counter\n"
+            "# HELP ccl_prof_event_counter Sum of performance counters of "
+            "sampled events.\n");
+        for (guint i = 0; i < prof->hists->len; ++i) {
+            CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+            if (hist->counters == NULL) continue;
+            for (cl_uint c = 0; c < prof->num_counters; ++c) {
+                g_string_append(om, "ccl_prof_event_counter_total{event=");
+                ccl_prof_metrics_append_label(om, hist->event_name);
+                g_string_append(om, ",counter=");
+                ccl_prof_metrics_append_label(om, prof->counter_names[c]);
+                g_string_append_printf(om, "} %.17g\n", hist->counters[c]);
+            }
+        }
+    }
+    if ((prof->counters_fn != NULL) && (prof->counter_bytes >= 0)) {
+        g_string_append(om,
+            "# TYPE ccl_prof_event_bandwidth_bytes_per_second gauge\n"
+            "# UNIT ccl_prof_event_bandwidth_bytes_per_second "
+            "bytes_per_second\n"
+            "# HELP ccl_prof_event_bandwidth_bytes_per_second Achieved "
+            "bandwidth of sampled events.\n");
+        for (guint i = 0; i < prof->hists->len; ++i) {
+            CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+            if (hist->counters == NULL) continue;
+            g_string_append(om,
+                "ccl_prof_event_bandwidth_bytes_per_second{event=");
+            ccl_prof_metrics_append_label(om, hist->event_name);
+            g_string_append_printf(om, "} %.6e\n",
+                ccl_prof_hist_bandwidth(prof, hist));
+        }
+    }
+    if ((prof->counters_fn != NULL) && (prof->counter_occupancy >= 0)) {
+        g_string_append(om,
+            "# TYPE ccl_prof_event_occupancy_ratio gauge\n"
+            "# HELP ccl_prof_event_occupancy_ratio Mean occupancy of "
+            "sampled events, weighted by duration.\n");
+        for (guint i = 0; i < prof->hists->len; ++i) {
+            CCLProfHist * hist = &g_array_index(prof->hists, CCLProfHist, i);
+            if (hist->counters == NULL) continue;
+            g_string_append(om, "ccl_prof_event_occupancy_ratio{event=");
+            ccl_prof_metrics_append_label(om, hist->event_name);
+            g_string_append_printf(om, "} %.6f\n",
+                ccl_prof_hist_occupancy(prof, hist));
+        }
+    }
+
+    /* Queue busy ratios. */
+    g_string_append(om,
+        "# TYPE ccl_prof_queue_busy_ratio gauge\n"
+        "# HELP ccl_prof_queue_busy_ratio Sum of event durations over the "
+        "time spanned by events.\n");
+    g_hash_table_iter_init(&iter, prof->queue_live);
+    while (g_hash_table_iter_next(&iter, &cq_name, &p_live)) {
+        CCLProfQueueLive * live = (CCLProfQueueLive *) p_live;
+        g_string_append(om, "ccl_prof_queue_busy_ratio{queue=");
+        ccl_prof_metrics_append_label(om, (const char *) cq_name);
+        g_string_append_printf(om, "} %.6f\n", live->t_last > live->t_first
+            ? MIN(1.0, live->busy_time / (double)
+                (live->t_last - live->t_first))
+            : 0.0);
+    }
+
+    /* Host-side call histograms. */
+    g_mutex_lock(&host_calls_mutex);
+    if (host_calls != NULL) {
+        g_string_append(om,
+            "# TYPE ccl_prof_host_call_duration_nanoseconds histogram\n"
+            "# UNIT ccl_prof_host_call_duration_nanoseconds nanoseconds\n"
+            "# HELP ccl_prof_host_call_duration_nanoseconds Host time spent "
+            "in wrapper functions.\n");
+        g_hash_table_iter_init(&iter, host_calls);
+        while (g_hash_table_iter_next(&iter, NULL, &p_call))
+            ccl_prof_metrics_append_hist(om,
+                "ccl_prof_host_call_duration_nanoseconds", "function",
+                &((CCLProfHostCall *) p_call)->hist);
+    }
+    g_mutex_unlock(&host_calls_mutex);
+
+    /* Terminate exposition. */
+    g_string_append(om, "# EOF\n");
+
+    /* Return exposition. */
+    return om;
+}
+
+/**
+ * Export live profiling metrics to a given stream in the OpenMetrics
+ * text format, i.e. in a format which can be scraped by Prometheus.
+ *
+ * The following metrics are exported, labeled by event name or queue name:
+ *
+ * * `ccl_prof_events_total`: number of events seen, including events not
+ * sampled (see ::ccl_prof_set_sampling()).
+ * * `ccl_prof_event_duration_nanoseconds`: histogram of event durations,
+ * with buckets at powers of ten from 1 &mu;s to 10 s. Each internal
+ * duration bucket is counted in the first bucket whose bound is not below
+ * its highest duration, so counts are accurate up to the relative error of
+ * the internal histogram.
+ * * `ccl_prof_event_queue_latency_nanoseconds_total`: sum of times from
+ * queued to start instants.
+ * * `ccl_prof_event_counter_total`: sums of the performance counters of
+ * sampled events, also labeled by counter name, if counters are collected
+ * (see ::ccl_prof_set_counters()).
+ * * `ccl_prof_event_bandwidth_bytes_per_second` and
+ * `ccl_prof_event_occupancy_ratio`: achieved bandwidth and mean occupancy
+ * of sampled events, if the respective well-known counters are collected.
+ * * `ccl_prof_queue_busy_ratio`: sum of event durations over the time
+ * spanned by the events of each queue.
+ * * `ccl_prof_host_call_duration_nanoseconds`: histogram of host time
+ * spent in wrapper functions, labeled by function name, if host-side
+ * tracing was enabled with ::ccl_prof_host_trace_enable().
+ *
+ * Unlike other export functions, this function does not require
+ * ::ccl_prof_calc() to be called (and can still be called afterwards).
+ * Before that, the metrics reflect the events processed so far by
+ * ::ccl_prof_drain(), so a long-running workload can be monitored by
+ * periodically draining events and exporting metrics. Since profile
+ * objects are not thread-safe, this function should be called from the
+ * same thread which drains events.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] stream Stream where to export metrics.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_metrics(
+    CCLProf * prof, FILE * stream, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure stream is not NULL. */
+    g_return_val_if_fail(stream != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Return status. */
+    cl_bool ret_status;
+    /* Status of write operation. */
+    int write_status;
+    /* OpenMetrics exposition. */
+    GString * om = ccl_prof_metrics_build(prof);
+
+    /* Write to stream. */
+    write_status = fputs(om->str, stream);
+    ccl_if_err_create_goto(*err, CCL_ERROR, write_status < 0,
+        CCL_ERROR_STREAM_WRITE, error_handler,
+        "Error while exporting profiling metrics (writing to stream).");
+    fflush(stream);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release exposition. */
+    g_string_free(om, TRUE);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Helper function which exports live profiling metrics in the OpenMetrics
+ * text format to a given file.
+ *
+ * The file is replaced atomically, so it can be periodically rewritten
+ * while being read, e.g. by the textfile collector of the Prometheus node
+ * exporter. See ::ccl_prof_export_metrics() for details.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] filename Name of file where metrics will be exported.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_metrics_file(
+    CCLProf * prof, const char * filename, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Aux. var. */
+    cl_bool status;
+
+    /* Internal CCLErr object. */
+    CCLErr * err_internal = NULL;
+
+    /* OpenMetrics exposition. */
+    GString * om = ccl_prof_metrics_build(prof);
+
+    /* Atomically replace file contents. */
+    g_file_set_contents(filename, om->str, om->len, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Release exposition. */
+    g_string_free(om, TRUE);
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * @internal
+ *
+ * @brief Header of binary profile files.
+ * */
+typedef struct ccl_prof_bin_header {
+
+    /** File magic, ::CCL_PROF_BIN_MAGIC. */
+    char magic[8];
+
+    /** Format version, ::CCL_PROF_BIN_VERSION. */
+    guint32 version;
+
+    /** Byte order mark, ::CCL_PROF_BIN_BOM, written in host order. */
+    guint32 bom;
+
+    /** Size in bytes of the string table, including padding. */
+    guint64 strtab_size;
+
+    /** Number of event records. */
+    guint64 num_records;
+
+} CCLProfBinHeader;
+
+/**
+ * @internal
+ *
+ * @brief Fixed-width event record of binary profile files.
+ * */
+typedef struct ccl_prof_bin_record {
+
+    /** Offset of event name in the string table. */
+    guint32 event_name;
+
+    /** Offset of queue name in the string table. */
+    guint32 queue_name;
+
+    /** Type of command which produced the event. */
+    guint32 command_type;
+
+    /** Padding, always zero. */
+    guint32 reserved;
+
+    /** Queued, submit, start and end instants, in nanoseconds. */
+    guint64 t_queued, t_submit, t_start, t_end;
+
+} CCLProfBinRecord;
+
+/** @internal Magic bytes at the start of binary profile files. */
+#define CCL_PROF_BIN_MAGIC "CCLPROF"
+
+/** @internal Current version of the binary profile format. */
+#define CCL_PROF_BIN_VERSION 1
+
+/** @internal Byte order mark of binary profile files. */
+#define CCL_PROF_BIN_BOM 0x01020304
+
+/**
+ * @internal
+ *
+ * @brief Get the offset of a string in the binary profile string table,
+ * adding the string to the table if not yet there.
+ *
+ * @param[in,out] strtab String table being built.
+ * @param[in,out] offsets Table of string offsets (keys: strings).
+ * @param[in] str String to get the offset of.
+ * @return Offset of string in the string table.
+ * */
+static guint32 ccl_prof_bin_str(
+    GString * strtab, GHashTable * offsets, const char * str) {
+
+    gpointer offset;
+
+    if (!g_hash_table_lookup_extended(offsets, str, NULL, &offset)) {
+        offset = GUINT_TO_POINTER(strtab->len);
+        g_string_append_len(strtab, str, strlen(str) + 1);
+        g_hash_table_insert(offsets, (gpointer) str, offset);
+    }
+    return GPOINTER_TO_UINT(offset);
+}
+
+/**
+ * Export event profiling information to a given stream in a compact binary
+ * format, which can be read back with ::ccl_prof_file_open().
+ *
+ * The binary format is composed of a versioned header, a table with all
+ * event and queue names, and a fixed-width record for each event, with
+ * offsets of event and queue names in the string table, command type and
+ * queued, submit, start and end instants. Records are sorted by start
+ * instant and values are stored in host byte order. Export options (see
+ * ::CCLProfExportOptions) are ignored, and absolute instants are exported.
  *
  * @public @memberof ccl_prof
  *
  * @param[in] prof Profile object.
- * @param[in] agg_sort Sorting performed on aggregate statistics (bitfield of
- * ::CCLProfAggSort ORed with ::CCLProfSortOrder).
- * @param[in] ovlp_sort Sorting performed on event overlaps (bitfield of
- * ::CCLProfOverlapSort ORed with ::CCLProfSortOrder).
- * @return A string containing the summary.
+ * @param[out] stream Stream where export info to, which should have been
+ * opened in binary mode.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
  * */
 CCL_EXPORT
-const char * ccl_prof_get_summary(
-    CCLProf * prof, int agg_sort, int ovlp_sort) {
+cl_bool ccl_prof_export_binary(CCLProf * prof, FILE * stream, CCLErr ** err) {
 
     /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, NULL);
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure stream is not NULL. */
+    g_return_val_if_fail(stream != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
     /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, NULL);
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
 
-    /* Current aggregate statistic to print. */
-    const CCLProfAgg * agg = NULL;
-    /* Current overlap to print. */
-    const CCLProfOverlap * ovlp = NULL;
-    /* The summary string. */
-    GString * str_obj = g_string_new("\n");
+    /* Return status. */
+    cl_bool ret_status;
+    /* Current event information. */
+    const CCLProfInfo * curr_ev;
+    /* File header. */
+    CCLProfBinHeader header = { CCL_PROF_BIN_MAGIC, CCL_PROF_BIN_VERSION,
+        CCL_PROF_BIN_BOM, 0, 0 };
+    /* Event record. */
+    CCLProfBinRecord record = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    /* String table. */
+    GString * strtab = g_string_new(NULL);
+    /* Table of string offsets. */
+    GHashTable * offsets = g_hash_table_new(g_str_hash, g_str_equal);
+
+    /* Sort event information by START order, ascending, and build
+     * string table. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL) {
+        ccl_prof_bin_str(strtab, offsets, curr_ev->event_name);
+        ccl_prof_bin_str(strtab, offsets, curr_ev->queue_name);
+    }
 
-    /* Show aggregate event times */
-    g_string_append_printf(str_obj,
-        " Aggregate times by event  :\n");
-    g_string_append_printf(str_obj,
-        "   ------------------------------------------------------------------\n");
-    g_string_append_printf(str_obj,
-        "   | Event name                     | Rel. time (%%) | Abs. time (s) |\n");
-    g_string_append_printf(str_obj,
-        "   ------------------------------------------------------------------\n");
-    ccl_prof_iter_agg_init(prof, agg_sort);
-    while ((agg = ccl_prof_iter_agg_next(prof)) != NULL) {
-        g_string_append_printf(str_obj,
-            "   | %-30.30s | %13.4f | %13.4e |\n",
-            agg->event_name,
-            agg->relative_time * 100.0,
-            agg->absolute_time * 1e-9);
+    /* Pad string table so that records are aligned. */
+    while (strtab->len % sizeof(guint64) != 0)
+        g_string_append_c(strtab, '\0');
+
+    /* Write header and string table. */
+    header.strtab_size = strtab->len;
+    header.num_records = prof->infos->len;
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (fwrite(&header, sizeof(header), 1, stream) != 1)
+        || (fwrite(strtab->str, 1, strtab->len, stream) != strtab->len),
+        CCL_ERROR_STREAM_WRITE, error_handler,
+        "Error while exporting binary profiling info (writing to stream).");
+
+    /* Write event records. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL) {
+        record.event_name =
+            ccl_prof_bin_str(strtab, offsets, curr_ev->event_name);
+        record.queue_name =
+            ccl_prof_bin_str(strtab, offsets, curr_ev->queue_name);
+        record.command_type = curr_ev->command_type;
+        record.t_queued = curr_ev->t_queued;
+        record.t_submit = curr_ev->t_submit;
+        record.t_start = curr_ev->t_start;
+        record.t_end = curr_ev->t_end;
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            fwrite(&record, sizeof(record), 1, stream) != 1,
+            CCL_ERROR_STREAM_WRITE, error_handler,
+            "Error while exporting binary profiling info "
+            "(writing to stream).");
     }
-    g_string_append_printf(str_obj,
-        "   ------------------------------------------------------------------\n");
 
-    /* Show total events time */
-    if (prof->total_events_time > 0) {
-        g_string_append_printf(str_obj,
-            "                                    |         Total | %13.4e |\n",
-            prof->total_events_time * 1e-9);
-        g_string_append_printf(str_obj,
-            "                                    ---------------------------------\n");
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release string table and table of offsets. */
+    g_string_free(strtab, TRUE);
+    g_hash_table_destroy(offsets);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Helper function which exports profiling info in the compact binary
+ * format to a given file, automatically opening and closing the file.
+ * See the ccl_prof_export_binary() for more information.
+ *
+ * @public @memberof ccl_prof
+ *
+ * @param[in] prof Profile object.
+ * @param[in] filename Name of file where information will be saved to.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_export_binary_file(
+    CCLProf * prof, const char * filename, CCLErr ** err) {
+
+    /* Make sure prof is not NULL. */
+    g_return_val_if_fail(prof != NULL, CL_FALSE);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    /* This function can only be called after calculations are made. */
+    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+
+    /* Aux. var. */
+    cl_bool status;
+
+    /* Internal CCLErr object. */
+    CCLErr * err_internal = NULL;
+
+    /* Open file. */
+    FILE * fp = fopen(filename, "wb");
+    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
+        CCL_ERROR_OPENFILE, error_handler,
+        "Unable to open file '%s' for exporting.", filename);
+
+    /* Export data. */
+    ccl_prof_export_binary(prof, fp, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    status = CL_FALSE;
+
+finish:
+
+    /* Close file. */
+    if (fp) fclose(fp);
+
+    /* Return status. */
+    return status;
+}
+
+/**
+ * Create a background writer of event profiling info, which formats and
+ * writes records to the given file in a separate thread, with large
+ * buffered writes and optional compression.
+ *
+ * Records are given to the writer with ::ccl_prof_export_info_async(),
+ * after ::ccl_prof_calc(), or streamed to it while events are drained
+ * with ::ccl_prof_drain(), if set with ::ccl_prof_set_writer(). They have
+ * the format of ::ccl_prof_export_info(), according to the export options
+ * (see ::ccl_prof_set_export_opts()) at the time the writer is created.
+ *
+ * Once all records are given, ::ccl_prof_writer_finish() returns a future
+ * which completes when they are written and the file is closed. The
+ * writer is released with ::ccl_prof_writer_destroy(), which also reports
+ * write errors. A writer may be fed by several profile objects, but not
+ * concurrently.
+ *
+ * @public @memberof ccl_prof_writer
+ *
+ * @param[in] filename Name of file where records will be written to.
+ * @param[in] compress If `CL_TRUE`, records are compressed in the gzip
+ * format, which requires _cf4ocl_ to be built with the `PROF_ZLIB`
+ * option.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new background profile writer, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProfWriter * ccl_prof_writer_new(
+    const char * filename, cl_bool compress, CCLErr ** err) {
+
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Internal CCLErr object. */
+    CCLErr * err_internal = NULL;
+    /* Background writer. */
+    CCLProfWriter * writer;
+
+    /* Create writer, keeping a copy of current export options. */
+    writer = g_slice_new0(CCLProfWriter);
+    writer->batches = g_async_queue_new();
+    writer->opts.separator = g_strdup(export_options.separator);
+    writer->opts.newline = g_strdup(export_options.newline);
+    writer->opts.queue_delim = g_strdup(export_options.queue_delim);
+    writer->opts.evname_delim = g_strdup(export_options.evname_delim);
+    writer->opts.zero_start = export_options.zero_start;
+
+    /* Open file. */
+    if (compress) {
+#ifdef CCL_PROF_ZLIB
+        writer->gz = gzopen(filename, "wb");
+        ccl_if_err_create_goto(*err, CCL_ERROR, writer->gz == NULL,
+            CCL_ERROR_OPENFILE, error_handler,
+            "Unable to open file '%s' for exporting.", filename);
+#else
+        ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+            CCL_ERROR_ARGS, error_handler,
+            "%s: Compressed export requires cf4ocl to be built with the "
+            "PROF_ZLIB option.", CCL_STRD);
+#endif
+    } else {
+        writer->fp = fopen(filename, "w");
+        ccl_if_err_create_goto(*err, CCL_ERROR, writer->fp == NULL,
+            CCL_ERROR_OPENFILE, error_handler,
+            "Unable to open file '%s' for exporting.", filename);
     }
 
-    /* *** Show overlaps *** */
+    /* Start writer thread. */
+    writer->thread = g_thread_try_new(
+        "ccl_prof_writer", ccl_prof_writer_loop, writer, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    if (g_list_length(prof->overlaps) > 0) {
-        /* Title the several overlaps. */
-        g_string_append_printf(str_obj,
-            " Event overlaps            :\n");
-        g_string_append_printf(str_obj,
-            "   ------------------------------------------------------------------\n");
-        g_string_append_printf(str_obj,
-            "   | Event 1                | Event2                 | Overlap (s)  |\n");
-        g_string_append_printf(str_obj,
-            "   ------------------------------------------------------------------\n");
-        /* Show overlaps table. */
-        ccl_prof_iter_overlap_init(prof, ovlp_sort);
-        while ((ovlp = ccl_prof_iter_overlap_next(prof)) != NULL) {
-            g_string_append_printf(str_obj, "   | %-22.22s | %-22.22s | %12.4e |\n",
-                ovlp->event1_name, ovlp->event2_name, ovlp->duration * 1e-9);
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    ccl_prof_writer_destroy(writer, NULL);
+    writer = NULL;
+
+finish:
+
+    /* Return writer. */
+    return writer;
+}
+
+/**
+ * Signal that all records were given to a background profile writer.
+ *
+ * @public @memberof ccl_prof_writer
+ * @note Can only be called once for each writer.
+ *
+ * @param[in] writer Background profile writer.
+ * @return A future which completes when all records are written and the
+ * file is closed, with `CL_COMPLETE` if successful or a negative value if
+ * a write error occurred, in which case the error is reported by
+ * ::ccl_prof_writer_destroy(). It should be released with
+ * ::ccl_future_destroy().
+ * */
+CCL_EXPORT
+CCLFuture * ccl_prof_writer_finish(CCLProfWriter * writer) {
+
+    /* Make sure writer is not NULL. */
+    g_return_val_if_fail(writer != NULL, NULL);
+    /* End of records can only be signaled once. */
+    g_return_val_if_fail(writer->finished == CL_FALSE, NULL);
+
+    /* Create future before the writer thread can complete it. */
+    writer->fut = ccl_future_new_pending();
+
+    /* Pass remaining records to the writer thread, followed by the end
+     * of records. */
+    ccl_prof_writer_submit(writer);
+    writer->finished = CL_TRUE;
+    g_async_queue_push(writer->batches, writer);
+
+    /* Return future. */
+    return writer->fut;
+}
+
+/**
+ * Destroy a background profile writer, waiting for all given records to
+ * be written and the file to be closed. If ::ccl_prof_writer_finish() was
+ * not called, the end of records is signaled by this function.
+ *
+ * @public @memberof ccl_prof_writer
+ *
+ * @param[in] writer Background profile writer to destroy.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if all records were successfully written, `CL_FALSE`
+ * otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_prof_writer_destroy(CCLProfWriter * writer, CCLErr ** err) {
+
+    /* Make sure writer is not NULL. */
+    g_return_val_if_fail(writer != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Return status. */
+    cl_bool status;
+
+    if (writer->thread != NULL) {
+
+        /* Signal end of records, if not yet signaled, and wait for the
+         * writer thread to write them and close the file. */
+        if (!writer->finished) {
+            ccl_prof_writer_submit(writer);
+            writer->finished = CL_TRUE;
+            g_async_queue_push(writer->batches, writer);
         }
-        g_string_append_printf(str_obj,
-            "   ------------------------------------------------------------------\n");
-        /* Show total events effective time (discount overlaps) */
-        g_string_append_printf(str_obj,
-            "                            |                  Total | %12.4e |\n",
-            (prof->total_events_time - prof->total_events_eff_time) * 1e-9);
-        g_string_append_printf(str_obj,
-            "                            -----------------------------------------\n");
-        g_string_append_printf(str_obj,
-            " Tot. of all events (eff.) : %es\n",
-            prof->total_events_eff_time * 1e-9);
+        g_thread_join(writer->thread);
+
     } else {
-        g_string_append_printf(str_obj,
-            " Event overlaps            : None\n");
-    }
 
-    /* Show total elapsed time */
-    if (prof->timer) {
-        double t_elapsed = g_timer_elapsed(prof->timer, NULL);
-        g_string_append_printf(str_obj,
-            " Total elapsed time        : %es\n", t_elapsed);
-        g_string_append_printf(str_obj,
-            " Time spent in device      : %.2f%%\n",
-            prof->total_events_eff_time * 1e-9 * 100 / t_elapsed);
-        g_string_append_printf(str_obj,
-            " Time spent in host        : %.2f%%\n",
-            100 - prof->total_events_eff_time * 1e-9 * 100 / t_elapsed);
+        /* Writer thread was not started, just close the file. */
+        ccl_prof_writer_close(writer);
     }
-    g_string_append_printf(str_obj, "\n");
 
-    /* If a summary already exists, free it before keeping a new one. */
-    if (prof->summary != NULL)
-        g_free(prof->summary);
+    /* Report write errors, if any. */
+    status = (writer->err == NULL) ? CL_TRUE : CL_FALSE;
+    g_propagate_error(err, writer->err);
 
-    /* Free String object and keep underlying string in prof struct. */
-    prof->summary = g_string_free(str_obj, FALSE);
+    /* Release writer. */
+    g_async_queue_unref(writer->batches);
+    g_free((gchar *) writer->opts.separator);
+    g_free((gchar *) writer->opts.newline);
+    g_free((gchar *) writer->opts.queue_delim);
+    g_free((gchar *) writer->opts.evname_delim);
+    g_slice_free(CCLProfWriter, writer);
 
-    /* Return summary string. */
-    return (const char *) prof->summary;
+    /* Return status. */
+    return status;
 }
 
 /**
- * Export event profiling information to a given stream.
+ * Stream the profiling info of drained events to a background profile
+ * writer.
  *
- * Each line of the exported data will have the following format,
- * ordered by event start time:
- *
- *     queue start-time end-time event-name
+ * Each time events are drained with ::ccl_prof_drain(), including the
+ * last time in ::ccl_prof_calc(), their profiling info is passed to the
+ * writer, so records are written while the profiled workload runs. Since
+ * the start instant of the whole profile is not known until the end,
+ * streamed records have absolute instants, regardless of the
+ * `zero_start` export option, and are sorted by start instant only within
+ * each drain.
  *
- * For example:
+ * @public @memberof ccl_prof
  *
- *     q0    100    120    load_data1
- *     q1    100    132    load_data2
- *     q0    121    159    process_data1
- *     q1    133    145    process_data2
- *     q0    146    157    read_result
+ * @param[in] prof Profile object.
+ * @param[in] writer Background profile writer, or `NULL` to stop
+ * streaming. It should not be destroyed while set.
+ * */
+CCL_EXPORT
+void ccl_prof_set_writer(CCLProf * prof, CCLProfWriter * writer) {
+
+    /* Make sure prof is not NULL. */
+    g_return_if_fail(prof != NULL);
+    /* The writer can only be set before calculations. */
+    g_return_if_fail(prof->calc == FALSE);
+
+    prof->writer = writer;
+}
+
+/**
+ * Export event profiling info through a background profile writer.
  *
- * Several export parameters can be configured with the
- * ccl_prof_get_export_opts() and ccl_prof_set_export_opts() functions,
- * by manipulating a ::CCLProfExportOptions struct.
+ * This function has the same output as ::ccl_prof_export_info(), but
+ * only copies the event instants and names for the writer, which formats
+ * and writes them in a separate thread. The profile object can be
+ * destroyed before the records are written.
  *
  * @public @memberof ccl_prof
  *
  * @param[in] prof Profile object.
- * @param[out] stream Stream where export info to.
- * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
- * reporting is to be ignored.
- * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * @param[in] writer Background profile writer.
  * */
 CCL_EXPORT
-cl_bool ccl_prof_export_info(CCLProf * prof, FILE * stream, CCLErr ** err) {
+void ccl_prof_export_info_async(CCLProf * prof, CCLProfWriter * writer) {
 
     /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, CL_FALSE);
-    /* Make sure stream is not NULL. */
-    g_return_val_if_fail(stream != NULL, CL_FALSE);
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    g_return_if_fail(prof != NULL);
+    /* Make sure writer is not NULL. */
+    g_return_if_fail(writer != NULL);
+    /* Records cannot be given after the end of records is signaled. */
+    g_return_if_fail(writer->finished == CL_FALSE);
     /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
+    g_return_if_fail(prof->calc == TRUE);
 
-    /* Stream write status. */
-    int write_status;
-    /* Return status. */
-    cl_bool ret_status;
     /* Current event information. */
     const CCLProfInfo * curr_ev;
     /* Start time. */
@@ -1868,108 +6573,344 @@ cl_bool ccl_prof_export_info(CCLProf * prof, FILE * stream, CCLErr ** err) {
 
     /* If zero start is set, use the start time of the first event
      * as zero time. */
-    if (export_options.zero_start)
+    if (writer->opts.zero_start)
         t_start = prof->t_start;
 
-    /* Iterate through all event information and export it to stream. */
-    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL) {
+    /* Pass all event information to the writer. */
+    while ((curr_ev = ccl_prof_iter_info_next(prof)) != NULL)
+        ccl_prof_writer_push(writer, curr_ev->queue_name,
+            curr_ev->event_name, curr_ev->t_start - t_start,
+            curr_ev->t_end - t_start);
+    ccl_prof_writer_submit(writer);
+}
 
-        /* Write to stream. */
-        write_status = fprintf(stream, "%s%s%s%s%lu%s%lu%s%s%s%s%s",
-            export_options.queue_delim,
-            curr_ev->queue_name,
-            export_options.queue_delim,
-            export_options.separator,
-            (unsigned long) (curr_ev->t_start - t_start),
-            export_options.separator,
-            (unsigned long) (curr_ev->t_end - t_start),
-            export_options.separator,
-            export_options.evname_delim,
-            curr_ev->event_name,
-            export_options.evname_delim,
-            export_options.newline);
+/**
+ * Binary profile file reader class.
+ * */
+struct ccl_prof_file {
 
-        ccl_if_err_create_goto(*err, CCL_ERROR, write_status < 0,
-            CCL_ERROR_STREAM_WRITE, error_handler,
-            "Error while exporting profiling information" \
-            "(writing to stream).");
-    }
+    /**
+     * Memory-mapped file.
+     * @private
+     * */
+    GMappedFile * mfile;
 
-    /* If we got here, everything is OK. */
-    g_assert(err == NULL || *err == NULL);
-    ret_status = CL_TRUE;
-    goto finish;
+    /**
+     * String table.
+     * @private
+     * */
+    const char * strtab;
 
-error_handler:
-    /* If we got here there was an error, verify that it is so. */
-    g_assert(err == NULL || *err != NULL);
-    ret_status = CL_FALSE;
+    /**
+     * Event records.
+     * @private
+     * */
+    const CCLProfBinRecord * records;
 
-finish:
+    /**
+     * Number of event records.
+     * @private
+     * */
+    guint num_records;
 
-    /* Return status. */
-    return ret_status;
+    /**
+     * Record indexes in iteration order, or `NULL` if records are
+     * iterated in file order.
+     * @private
+     * */
+    guint * order;
+
+    /**
+     * Event info iterator (position in iteration order).
+     * @private
+     * */
+    guint info_iter;
+
+    /**
+     * Event info returned by the iterator.
+     * @private
+     * */
+    CCLProfInfo info;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Decode an event record of a binary profile file.
+ *
+ * @private @memberof ccl_prof_file
+ *
+ * @param[in] pfile Binary profile file object.
+ * @param[in] idx Index of event record.
+ * @param[out] info Location where to place the event information.
+ * */
+static void ccl_prof_file_get_info(
+    CCLProfFile * pfile, guint idx, CCLProfInfo * info) {
+
+    const CCLProfBinRecord * record = &pfile->records[idx];
+
+    info->event_name = pfile->strtab + record->event_name;
+    info->command_type = record->command_type;
+    info->queue_name = pfile->strtab + record->queue_name;
+    info->t_queued = record->t_queued;
+    info->t_submit = record->t_submit;
+    info->t_start = record->t_start;
+    info->t_end = record->t_end;
 }
 
 /**
- * Helper function which exports profiling info to a given file, automatically
- * opening and closing the file. See the ccl_prof_export_info() for more
- * information.
+ * @internal
  *
- * @public @memberof ccl_prof
+ * @brief Data passed to ccl_prof_file_order_comp().
+ * */
+typedef struct ccl_prof_file_sort_data {
+
+    /** Binary profile file object. */
+    CCLProfFile * pfile;
+
+    /** Sort criteria and order. */
+    int sort;
+
+} CCLProfFileSortData;
+
+/**
+ * @internal
  *
- * @param[in] prof Profile object.
- * @param[in] filename Name of file where information will be saved to.
+ * @brief Compares two event records of a binary profile file, given
+ * their indexes, for sorting purposes.
+ *
+ * @param[in] a Index of first event record to compare.
+ * @param[in] b Index of second event record to compare.
+ * @param[in] userdata A ::CCLProfFileSortData object.
+ * @return Negative value if `a < b`; zero if `a == b`; positive value if
+ * `a > b`.
+ */
+static gint ccl_prof_file_order_comp(
+    gconstpointer a, gconstpointer b, gpointer userdata) {
+
+    CCLProfFileSortData * data = (CCLProfFileSortData *) userdata;
+    CCLProfInfo info1, info2;
+
+    ccl_prof_file_get_info(data->pfile, *((guint *) a), &info1);
+    ccl_prof_file_get_info(data->pfile, *((guint *) b), &info2);
+    return ccl_prof_info_comp(&info1, &info2, &data->sort);
+}
+
+/**
+ * Open a binary profile file exported with ::ccl_prof_export_binary(),
+ * mapping it into memory.
+ *
+ * Event information is only decoded when iterated, so this function is
+ * fast and uses little memory even for very large files.
+ *
+ * @public @memberof ccl_prof_file
+ *
+ * @param[in] filename Name of binary profile file.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return `CL_TRUE` if function terminates successfully, `CL_FALSE` otherwise.
+ * @return A new binary profile file object, or `NULL` if an error
+ * occurred. Must be released with ::ccl_prof_file_close().
  * */
 CCL_EXPORT
-cl_bool ccl_prof_export_info_file(
-    CCLProf * prof, const char * filename, CCLErr ** err) {
+CCLProfFile * ccl_prof_file_open(const char * filename, CCLErr ** err) {
 
-    /* Make sure prof is not NULL. */
-    g_return_val_if_fail(prof != NULL, CL_FALSE);
     /* Make sure filename is not NULL. */
-    g_return_val_if_fail(filename != NULL, CL_FALSE);
+    g_return_val_if_fail(filename != NULL, NULL);
     /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
-    /* This function can only be called after calculations are made. */
-    g_return_val_if_fail(prof->calc == TRUE, CL_FALSE);
-
-    /* Aux. var. */
-    cl_bool status;
-
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Binary profile file object to return. */
+    CCLProfFile * pfile = NULL;
+    /* Memory-mapped file. */
+    GMappedFile * mfile;
+    /* File contents and size. */
+    const char * contents;
+    gsize size;
+    /* File header. */
+    const CCLProfBinHeader * header;
     /* Internal CCLErr object. */
     CCLErr * err_internal = NULL;
 
-    /* Open file. */
-    FILE * fp = fopen(filename, "w");
-    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
-        CCL_ERROR_OPENFILE, error_handler,
-        "Unable to open file '%s' for exporting.", filename);
-
-    /* Export data. */
-    status = ccl_prof_export_info(prof, fp, &err_internal);
+    /* Map file into memory. */
+    mfile = g_mapped_file_new(filename, FALSE, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    contents = g_mapped_file_get_contents(mfile);
+    size = g_mapped_file_get_length(mfile);
+    header = (const CCLProfBinHeader *) contents;
+
+    /* Check header. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (size < sizeof(CCLProfBinHeader))
+        || (memcmp(header->magic, CCL_PROF_BIN_MAGIC,
+            sizeof(CCL_PROF_BIN_MAGIC)) != 0),
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: '%s' is not a binary profile file.", CCL_STRD, filename);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (header->version != CCL_PROF_BIN_VERSION)
+        || (header->bom != CCL_PROF_BIN_BOM),
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: '%s' has an unsupported version or byte order.",
+        CCL_STRD, filename);
+
+    /* Check sizes. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (header->strtab_size % sizeof(guint64) != 0)
+        || (header->strtab_size > G_MAXUINT32)
+        || (header->num_records > G_MAXUINT)
+        || (size != sizeof(CCLProfBinHeader) + header->strtab_size
+            + header->num_records * sizeof(CCLProfBinRecord)),
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: '%s' is truncated or corrupted.", CCL_STRD, filename);
+
+    /* Create binary profile file object. */
+    pfile = g_slice_new0(CCLProfFile);
+    pfile->mfile = mfile;
+    pfile->strtab = contents + sizeof(CCLProfBinHeader);
+    pfile->records = (const CCLProfBinRecord *)
+        (pfile->strtab + header->strtab_size);
+    pfile->num_records = (guint) header->num_records;
+
+    /* Check that all names are within the string table, which must end
+     * with a null character. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (header->strtab_size > 0)
+        && (pfile->strtab[header->strtab_size - 1] != '\0'),
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: '%s' has an invalid string table.", CCL_STRD, filename);
+    for (guint i = 0; i < pfile->num_records; ++i) {
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (pfile->records[i].event_name >= header->strtab_size)
+            || (pfile->records[i].queue_name >= header->strtab_size),
+            CCL_ERROR_INVALID_DATA, error_handler,
+            "%s: '%s' has an invalid record (%u).", CCL_STRD, filename, i);
+    }
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
-    status = CL_TRUE;
     goto finish;
 
 error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
-    status = CL_FALSE;
+
+    /* Release resources. */
+    if (pfile != NULL) {
+        g_slice_free(CCLProfFile, pfile);
+        pfile = NULL;
+    }
+    if (mfile != NULL) g_mapped_file_unref(mfile);
 
 finish:
 
-    /* Close file. */
-    if (fp) fclose(fp);
+    /* Return binary profile file object. */
+    return pfile;
+}
 
-    /* Return file contents in string form. */
-    return status;
+/**
+ * Close a binary profile file, releasing all associated resources.
+ *
+ * @public @memberof ccl_prof_file
+ *
+ * @param[in] pfile Binary profile file object.
+ * */
+CCL_EXPORT
+void ccl_prof_file_close(CCLProfFile * pfile) {
+
+    /* Make sure pfile is not NULL. */
+    g_return_if_fail(pfile != NULL);
+
+    /* Release iteration order, mapped file and object. */
+    g_free(pfile->order);
+    g_mapped_file_unref(pfile->mfile);
+    g_slice_free(CCLProfFile, pfile);
+}
+
+/**
+ * Get number of events in a binary profile file.
+ *
+ * @public @memberof ccl_prof_file
+ *
+ * @param[in] pfile Binary profile file object.
+ * @return Number of events in binary profile file.
+ * */
+CCL_EXPORT
+cl_uint ccl_prof_file_get_num_events(CCLProfFile * pfile) {
+
+    /* Make sure pfile is not NULL. */
+    g_return_val_if_fail(pfile != NULL, 0);
+
+    /* Return number of events. */
+    return pfile->num_records;
+}
+
+/**
+ * Initialize an iterator for the event profiling info in a binary profile
+ * file. Behaves in the same way as ::ccl_prof_iter_info_init().
+ *
+ * Since records are stored by start instant, iterating in ascending start
+ * order does not require sorting.
+ *
+ * @public @memberof ccl_prof_file
+ *
+ * @param[in] pfile Binary profile file object.
+ * @param[in] sort Bitfield of ::CCLProfInfoSort OR ::CCLProfSortOrder,
+ * for example `CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC`.
+ * */
+CCL_EXPORT
+void ccl_prof_file_iter_info_init(CCLProfFile * pfile, int sort) {
+
+    /* Make sure pfile is not NULL. */
+    g_return_if_fail(pfile != NULL);
+
+    /* Data for sorting. */
+    CCLProfFileSortData data = { pfile, sort };
+
+    /* Release previous iteration order, if any. */
+    g_free(pfile->order);
+    pfile->order = NULL;
+
+    /* Sort record indexes as requested by client, unless file order is
+     * requested. */
+    if (sort != (CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC)) {
+        pfile->order = g_new(guint, pfile->num_records);
+        for (guint i = 0; i < pfile->num_records; ++i)
+            pfile->order[i] = i;
+        g_qsort_with_data(pfile->order, pfile->num_records, sizeof(guint),
+            ccl_prof_file_order_comp, &data);
+    }
+
+    /* Set the iterator as the first element. */
+    pfile->info_iter = 0;
+}
+
+/**
+ * Return the next event profiling info in a binary profile file.
+ * Behaves in the same way as ::ccl_prof_iter_info_next().
+ *
+ * @public @memberof ccl_prof_file
+ *
+ * @param[in] pfile Binary profile file object.
+ * @return The next event profiling info, or `NULL` if iterator has reached
+ * the end. The returned object is overwritten in the next call.
+ * */
+CCL_EXPORT
+const CCLProfInfo * ccl_prof_file_iter_info_next(CCLProfFile * pfile) {
+
+    /* Make sure pfile is not NULL. */
+    g_return_val_if_fail(pfile != NULL, NULL);
+
+    /* Check if iterator has reached the end. */
+    if (pfile->info_iter >= pfile->num_records)
+        return NULL;
+
+    /* Decode current record and advance iterator. */
+    ccl_prof_file_get_info(pfile, (pfile->order != NULL)
+        ? pfile->order[pfile->info_iter] : pfile->info_iter, &pfile->info);
+    pfile->info_iter++;
+
+    /* Return event info. */
+    return &pfile->info;
 }
 
 /**
@@ -32,6 +32,7 @@
 #include "ccl_errors.h"
 #include "ccl_common.h"
 #include "ccl_queue_wrapper.h"
+#include "ccl_future.h"
 
 /**
  * @defgroup CCL_PROFILER Profiler
@@ -60,6 +61,42 @@
  * function. The ccl_prof_calc() function can then be called to perform the
  * required analysis.
  *
+ * For long-running computations, where keeping all events until the end
+ * is not feasible, the ::ccl_prof_drain() function can be called
+ * periodically after adding the queues. Terminated events are then folded
+ * into running aggregate statistics and overlap totals and released, and
+ * only aggregate event information and event overlaps are available after
+ * ccl_prof_calc() is called.
+ *
+ * Event instants come from the clock of each device. If queues on more than
+ * one device are profiled, ::ccl_prof_sync_clocks() can be called after
+ * adding the queues so that all instants are converted to the host
+ * monotonic clock, and can be compared between devices and with host-side
+ * phases timed with `g_get_monotonic_time()`.
+ *
+ * Profiling overhead can be further reduced with ::ccl_prof_set_sampling(),
+ * in which case only a sample of events is analyzed, and aggregate times and
+ * counts are scaled to estimate the values for all events.
+ *
+ * Since timestamps alone do not show whether a command is memory or
+ * compute bound, ::ccl_prof_set_counters() can be used to collect
+ * performance counters of each sampled command, e.g. from the
+ * `CL_PROFILING_COMMAND_PERFCOUNTERS_INTEL` report of queues created with
+ * the `cl_intel_performance_query` extension, or from vendor tools. The
+ * counters are summed per event name in ::CCLProfAgg::counters, and the
+ * well-known ::CCL_PROF_COUNTER_BYTES and ::CCL_PROF_COUNTER_OCCUPANCY
+ * counters are used to derive the achieved bandwidth and the mean
+ * occupancy of each event name, which are shown in the summary and in the
+ * exported metrics.
+ *
+ * Since aggregate statistics hide outliers, and keeping all event
+ * profiling info to find them is not feasible in long-running
+ * computations, ::ccl_prof_set_slowest() can be used to keep only the
+ * slowest instances of each event name, with their instants, queue and
+ * user tag (see ::ccl_event_set_tag()). These are available with
+ * ::ccl_prof_get_slowest(), also when events are drained with
+ * ::ccl_prof_drain().
+ *
  * At this stage, different types of profiling information become available,
  * and can be iterated over:
  *
@@ -86,6 +123,40 @@
  * queue is used on the same device. A sequence of ::CCLProfOverlap* objects
  * can be iterated over using the ::ccl_prof_iter_overlap_init() and
  * ::ccl_prof_iter_overlap_next() functions.
+ * 5. _Command slacks_: the slack of each command in the graph of command
+ * dependencies, represented by the ::CCLProfSlack* class, where commands
+ * with zero slack are on the critical path, i.e. bound the end-to-end
+ * duration given by ::ccl_prof_get_critical_duration(). Commands on in-order
+ * queues depend on the previous command, and other dependencies, given by
+ * event wait lists, are considered if recorded with
+ * ::ccl_queue_set_record_deps(). A sequence of ::CCLProfSlack* objects can
+ * be iterated over using the ::ccl_prof_iter_slack_init() and
+ * ::ccl_prof_iter_slack_next() functions. Command slacks are not available
+ * if events are drained with ::ccl_prof_drain().
+ * 6. _Utilization_: busy time and idle gaps of each queue and of each
+ * device, represented by the ::CCLProfUtil* class, including the idle time
+ * during which the next command had not yet been queued by the host, i.e.
+ * in which the device was starved by the host. Utilization for a given
+ * queue or device can be obtained with the ::ccl_prof_get_queue_util() and
+ * ::ccl_prof_get_device_util() functions, respectively. Utilization is not
+ * available if events are drained with ::ccl_prof_drain().
+ * 7. _Host-side calls_: host time spent in wrapper functions which enqueue
+ * commands, wait for events or build programs, aggregated per function in
+ * ::CCLProfAgg* objects, which can be iterated over using the
+ * ::ccl_prof_iter_host_init() and ::ccl_prof_iter_host_next() functions.
+ * Host-side calls are only timed if the library was compiled with the
+ * `HOST_TRACE` option and tracing was enabled with
+ * ::ccl_prof_host_trace_enable(). Timings are shared by all profile
+ * objects, and can be discarded with ::ccl_prof_host_trace_reset().
+ * 8. _Host-side ranges_: named, possibly nested, host-side ranges, such as
+ * frames or requests, delimited with ::ccl_prof_range_push() and
+ * ::ccl_prof_range_pop(), represented by the ::CCLProfRange* class, and
+ * which can be iterated over using the ::ccl_prof_iter_range_init() and
+ * ::ccl_prof_iter_range_next() functions. Each profiled event is
+ * attributed to the ranges which were open when it was queued, so the
+ * device cost of each range is known. Since ranges are timed on the host,
+ * events are only attributed to ranges if the clocks of the profiled
+ * queues were synchronized with ::ccl_prof_sync_clocks().
  *
  * While this information can be subject to different types of examination by
  * client code, the profiler module also offers some functionality which allows
@@ -99,7 +170,25 @@
  * by the @ref ccl_plot_events "plot events" script to plot a Gantt-like chart
  * of the performed computation. Such list can be exported with the
  * ::ccl_prof_export_info() or ::ccl_prof_export_info_file() functions, using
- * the default export options.
+ * the default export options. For large profiles, the list can be exported
+ * in a separate thread, optionally compressed, with a background writer
+ * created with ::ccl_prof_writer_new(), to which records are given with
+ * ::ccl_prof_export_info_async() or, while events are drained with
+ * ::ccl_prof_drain(), streamed with ::ccl_prof_set_writer().
+ * 3. A timeline with one track per queue, event slices, idle periods and the
+ * number of concurrent events can be exported in the Chrome trace event JSON
+ * format with the ::ccl_prof_export_trace() or ::ccl_prof_export_trace_file()
+ * functions, and opened in `chrome://tracing` or in the Perfetto UI.
+ * 4. All ::CCLProfInfo* data can be exported in a compact binary format with
+ * the ::ccl_prof_export_binary() or ::ccl_prof_export_binary_file()
+ * functions, and later read back, for offline post-processing, with
+ * ::ccl_prof_file_open() and the `ccl_prof_file_iter_info_*()` functions.
+ * 5. Live metrics, namely event counts, duration histograms, queue
+ * latencies and queue busy ratios, can be exported in the OpenMetrics text
+ * format with the ::ccl_prof_export_metrics() or
+ * ::ccl_prof_export_metrics_file() functions, and scraped by Prometheus
+ * while events are being drained with ::ccl_prof_drain(), i.e. without
+ * calling ::ccl_prof_calc().
  *
  * _Example: Conway's game of life using double-buffered images_
  * (@ref ca.c "complete example")
@@ -200,6 +289,17 @@
   * */
 typedef struct ccl_prof CCLProf;
 
+/**
+ * Reader of binary profile files exported with ::ccl_prof_export_binary().
+ * */
+typedef struct ccl_prof_file CCLProfFile;
+
+/**
+ * Background writer of event profiling info, created with
+ * ::ccl_prof_writer_new().
+ * */
+typedef struct ccl_prof_writer CCLProfWriter;
+
 /**
  * Sort order for the profile module iterators.
  * */
@@ -210,6 +310,40 @@ typedef enum {
     CCL_PROF_SORT_DESC = 0x1
 } CCLProfSortOrder;
 
+/**
+ * Name of the performance counter with the number of bytes read and
+ * written by a command, from which the achieved bandwidth is derived.
+ * */
+#define CCL_PROF_COUNTER_BYTES "bytes"
+
+/**
+ * Name of the performance counter with the occupancy of the device during
+ * a command, between zero and one, from which the mean occupancy is
+ * derived.
+ * */
+#define CCL_PROF_COUNTER_OCCUPANCY "occupancy"
+
+/* Raw performance counter report of the cl_intel_performance_query
+ * extension, for OpenCL headers which predate it. */
+#ifndef CL_PROFILING_COMMAND_PERFCOUNTERS_INTEL
+    #define CL_PROFILING_COMMAND_PERFCOUNTERS_INTEL 0x407F
+#endif
+
+/**
+ * Function which collects the performance counters of a profiled command,
+ * set with ::ccl_prof_set_counters().
+ *
+ * @param[in] evt Event wrapper of the command.
+ * @param[in] command_type Type of command which produced the event.
+ * @param[out] values Location where to place the values of the counters,
+ * in the order given to ::ccl_prof_set_counters().
+ * @param[in] user_data User data given to ::ccl_prof_set_counters().
+ * @return `CL_TRUE` if the counters were collected, `CL_FALSE` otherwise,
+ * e.g. if counters are not available for this type of command.
+ * */
+typedef cl_bool (*ccl_prof_counters_fn)(CCLEvent * evt,
+    cl_command_type command_type, double * values, void * user_data);
+
 
 /**
  * Aggregate event info.
@@ -236,6 +370,93 @@ typedef struct ccl_prof_agg {
      * */
     double relative_time;
 
+    /**
+     * Number of events with name equal to ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_uint count;
+
+    /**
+     * Minimum duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong min_time;
+
+    /**
+     * Maximum duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong max_time;
+
+    /**
+     * Mean duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    double mean_time;
+
+    /**
+     * Standard deviation of the duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    double std_time;
+
+    /**
+     * Median (50th percentile) of the duration of events with name equal
+     * to ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong p50_time;
+
+    /**
+     * 90th percentile of the duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong p90_time;
+
+    /**
+     * 99th percentile of the duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong p99_time;
+
+    /**
+     * 99.9th percentile of the duration of events with name equal to
+     * ::CCLProfAgg::event_name.
+     * @public
+     * */
+    cl_ulong p999_time;
+
+    /**
+     * Sums of the performance counters of sampled events with name equal
+     * to ::CCLProfAgg::event_name, in the order given to
+     * ::ccl_prof_set_counters(), or `NULL` if no counters were collected
+     * for these events.
+     * @public
+     * */
+    const double * counters;
+
+    /**
+     * Achieved bandwidth, in bytes per second, of events with name equal
+     * to ::CCLProfAgg::event_name, derived from the ::CCL_PROF_COUNTER_BYTES
+     * counter, or zero if not available.
+     * @public
+     * */
+    double bandwidth;
+
+    /**
+     * Mean occupancy, weighted by duration, of events with name equal to
+     * ::CCLProfAgg::event_name, derived from the
+     * ::CCL_PROF_COUNTER_OCCUPANCY counter, or zero if not available.
+     * @public
+     * */
+    double occupancy;
+
 } CCLProfAgg;
 
 
@@ -306,6 +527,26 @@ typedef struct ccl_prof_info {
 
 } CCLProfInfo;
 
+/**
+ * One of the slowest instances of an event name, as kept by
+ * ::ccl_prof_set_slowest().
+ * */
+typedef struct ccl_prof_slow {
+
+    /**
+     * Profiling info of event instance.
+     * @public
+     * */
+    CCLProfInfo info;
+
+    /**
+     * User tag of event, as set with ::ccl_event_set_tag(), or `NULL`.
+     * @public
+     * */
+    const char * tag;
+
+} CCLProfSlow;
+
 /**
  * Sort criteria for event profiling info instances.
  */
@@ -434,6 +675,172 @@ typedef enum {
 
 } CCLProfOverlapSort;
 
+/**
+ * Slack of a profiled command in the dependency graph of all profiled
+ * commands. Commands with zero slack are on the critical path.
+ */
+typedef struct ccl_prof_slack {
+
+    /**
+     * Name of event.
+     * @public
+     * */
+    const char * event_name;
+
+    /**
+     * Name of command queue which generated this event.
+     * @public
+     * */
+    const char * queue_name;
+
+    /**
+     * Device time in nanoseconds when the command started execution.
+     * @public
+     * */
+    cl_ulong t_start;
+
+    /**
+     * Device time in nanoseconds when the command finished execution.
+     * @public
+     * */
+    cl_ulong t_end;
+
+    /**
+     * Time in nanoseconds by which the command could be delayed, or take
+     * longer, without increasing the duration of the critical path.
+     * @public
+     * */
+    cl_ulong slack;
+
+} CCLProfSlack;
+
+/**
+ * Sort criteria for command slacks (::CCLProfSlack).
+ */
+typedef enum {
+
+    /** Sort command slacks by slack. */
+    CCL_PROF_SLACK_SORT_SLACK   = 0xc0,
+
+    /** Sort command slacks by start time. */
+    CCL_PROF_SLACK_SORT_T_START = 0xd0
+
+} CCLProfSlackSort;
+
+/**
+ * Utilization of a command queue or device, i.e. of the union of the
+ * execution periods of the respective profiled events.
+ */
+typedef struct ccl_prof_util {
+
+    /**
+     * Name of command queue or device.
+     * @public
+     * */
+    const char * name;
+
+    /**
+     * Time in nanoseconds from the start of the first event to the end of
+     * the last event.
+     * @public
+     * */
+    cl_ulong span;
+
+    /**
+     * Time in nanoseconds during which at least one event was executing.
+     * @public
+     * */
+    cl_ulong busy_time;
+
+    /**
+     * Time in nanoseconds during which no events were executing, i.e. the
+     * sum of all idle gaps.
+     * @public
+     * */
+    cl_ulong idle_time;
+
+    /**
+     * Number of idle gaps.
+     * @public
+     * */
+    cl_uint num_gaps;
+
+    /**
+     * Duration in nanoseconds of the longest idle gap.
+     * @public
+     * */
+    cl_ulong max_gap;
+
+    /**
+     * Idle time in nanoseconds during which the event ending each idle gap
+     * had not yet been queued by the host, i.e. idle time caused by host
+     * submission lag.
+     * @public
+     * */
+    cl_ulong host_lag_time;
+
+} CCLProfUtil;
+
+/**
+ * Host-side range, delimited with ::ccl_prof_range_push() and
+ * ::ccl_prof_range_pop(), and the device cost of the profiled events
+ * enqueued while it was open.
+ */
+typedef struct ccl_prof_range {
+
+    /**
+     * Name of range.
+     * @public
+     * */
+    const char * name;
+
+    /**
+     * Host time in nanoseconds when the range was pushed.
+     * @public
+     * */
+    cl_ulong t_start;
+
+    /**
+     * Host time in nanoseconds when the range was popped.
+     * @public
+     * */
+    cl_ulong t_end;
+
+    /**
+     * Nesting depth of range, zero for outermost ranges.
+     * @public
+     * */
+    cl_uint depth;
+
+    /**
+     * Number of profiled events enqueued while the range, or any range
+     * nested in it, was open.
+     * @public
+     * */
+    cl_uint num_events;
+
+    /**
+     * Sum of the durations in nanoseconds of the profiled events enqueued
+     * while the range, or any range nested in it, was open.
+     * @public
+     * */
+    cl_ulong device_time;
+
+} CCLProfRange;
+
+/**
+ * Sort criteria for host-side ranges (::CCLProfRange).
+ */
+typedef enum {
+
+    /** Sort host-side ranges by start time. */
+    CCL_PROF_RANGE_SORT_T_START     = 0xe0,
+
+    /** Sort host-side ranges by device time. */
+    CCL_PROF_RANGE_SORT_DEVICE_TIME = 0xf0
+
+} CCLProfRangeSort;
+
 /**
  * Export options.
  * */
@@ -479,6 +886,21 @@ CCLProf * ccl_prof_new();
 CCL_EXPORT
 void ccl_prof_destroy(CCLProf * prof);
 
+/* Set the profile object to only analyze a sample of events. */
+CCL_EXPORT
+void ccl_prof_set_sampling(
+    CCLProf * prof, cl_uint period, double fraction, guint32 seed);
+
+/* Set a function which collects performance counters of profiled
+ * commands. */
+CCL_EXPORT
+void ccl_prof_set_counters(CCLProf * prof, cl_uint num_counters,
+    const char * const * names, ccl_prof_counters_fn fn, void * user_data);
+
+/* Keep the slowest instances of each event name. */
+CCL_EXPORT
+void ccl_prof_set_slowest(CCLProf * prof, cl_uint k);
+
 /* Starts the global profiler timer. Only required if client
  * wishes to compare the effectively elapsed time with the OpenCL
  * kernels time. */
@@ -500,6 +922,21 @@ double ccl_prof_time_elapsed(CCLProf * prof);
 CCL_EXPORT
 void ccl_prof_add_queue(CCLProf * prof, const char * cq_name, CCLQueue * cq);
 
+/* Add the profiling information of an event which was not profiled by
+ * this object, such as an event loaded from an exported profile. */
+CCL_EXPORT
+void ccl_prof_add_info(CCLProf * prof, const CCLProfInfo * info);
+
+/* Synchronize the clocks of the devices associated with the command
+ * queues added for profiling with the host. */
+CCL_EXPORT
+cl_bool ccl_prof_sync_clocks(CCLProf * prof, CCLErr ** err);
+
+/* Drain terminated events from the profiled queues, folding them into
+ * running statistics, and release them. */
+CCL_EXPORT
+cl_bool ccl_prof_drain(CCLProf * prof, CCLErr ** err);
+
 /* Determine aggregate statistics for the given profile object. */
 CCL_EXPORT
 cl_bool ccl_prof_calc(CCLProf * prof, CCLErr ** err);
@@ -508,6 +945,11 @@ cl_bool ccl_prof_calc(CCLProf * prof, CCLErr ** err);
 CCL_EXPORT
 const CCLProfAgg * ccl_prof_get_agg(CCLProf * prof, const char * event_name);
 
+/* Return the slowest instances of events with the given name. */
+CCL_EXPORT
+const CCLProfSlow * ccl_prof_get_slowest(
+    CCLProf * prof, const char * event_name, cl_uint * num_slow);
+
 /* Initialize an iterator for profiled aggregate event instances. */
 CCL_EXPORT
 void ccl_prof_iter_agg_init(CCLProf * prof, int sort);
@@ -540,6 +982,61 @@ void ccl_prof_iter_overlap_init(CCLProf * prof, int sort);
 CCL_EXPORT
 const CCLProfOverlap * ccl_prof_iter_overlap_next(CCLProf * prof);
 
+/* Open a named host-side range, nested in the currently open range. */
+CCL_EXPORT
+void ccl_prof_range_push(CCLProf * prof, const char * name);
+
+/* Close the innermost open host-side range. */
+CCL_EXPORT
+void ccl_prof_range_pop(CCLProf * prof);
+
+/* Initialize an iterator for host-side range instances. */
+CCL_EXPORT
+void ccl_prof_iter_range_init(CCLProf * prof, int sort);
+
+/* Return the next host-side range instance. */
+CCL_EXPORT
+const CCLProfRange * ccl_prof_iter_range_next(CCLProf * prof);
+
+/* Initialize an iterator for host-side call aggregates. */
+CCL_EXPORT
+void ccl_prof_iter_host_init(CCLProf * prof, int sort);
+
+/* Return the next host-side call aggregate. */
+CCL_EXPORT
+const CCLProfAgg * ccl_prof_iter_host_next(CCLProf * prof);
+
+/* Initialize an iterator for command slack instances. */
+CCL_EXPORT
+void ccl_prof_iter_slack_init(CCLProf * prof, int sort);
+
+/* Return the next command slack instance. */
+CCL_EXPORT
+const CCLProfSlack * ccl_prof_iter_slack_next(CCLProf * prof);
+
+/* Get duration of the critical path through the command dependencies, in
+ * nanoseconds. */
+CCL_EXPORT
+cl_ulong ccl_prof_get_critical_duration(CCLProf * prof);
+
+/* Return utilization of the command queue with the given name. */
+CCL_EXPORT
+const CCLProfUtil * ccl_prof_get_queue_util(
+    CCLProf * prof, const char * queue_name);
+
+/* Return utilization of the given device. */
+CCL_EXPORT
+const CCLProfUtil * ccl_prof_get_device_util(
+    CCLProf * prof, CCLDevice * dev);
+
+/* Enable or disable timing of host-side wrapper calls. */
+CCL_EXPORT
+void ccl_prof_host_trace_enable(cl_bool enable);
+
+/* Discard timings of host-side wrapper calls. */
+CCL_EXPORT
+void ccl_prof_host_trace_reset(void);
+
 /* Get duration of all events in nanoseconds. */
 CCL_EXPORT
 cl_ulong ccl_prof_get_duration(CCLProf * prof);
@@ -574,6 +1071,84 @@ CCL_EXPORT
 cl_bool ccl_prof_export_info_file(
     CCLProf * profile, const char * filename, CCLErr ** err);
 
+/* Export profiling info to a given stream in the Chrome trace event
+ * JSON format. */
+CCL_EXPORT
+cl_bool ccl_prof_export_trace(CCLProf * prof, FILE * stream, CCLErr ** err);
+
+/* Helper function which exports profiling info in the Chrome trace event
+ * JSON format to a given file, automatically opening and closing the
+ * file. */
+CCL_EXPORT
+cl_bool ccl_prof_export_trace_file(
+    CCLProf * prof, const char * filename, CCLErr ** err);
+
+/* Export live profiling metrics to a given stream in the OpenMetrics
+ * text format. */
+CCL_EXPORT
+cl_bool ccl_prof_export_metrics(
+    CCLProf * prof, FILE * stream, CCLErr ** err);
+
+/* Helper function which exports live profiling metrics in the OpenMetrics
+ * text format to a given file, atomically replacing it. */
+CCL_EXPORT
+cl_bool ccl_prof_export_metrics_file(
+    CCLProf * prof, const char * filename, CCLErr ** err);
+
+/* Export profiling info to a given stream in a compact binary format. */
+CCL_EXPORT
+cl_bool ccl_prof_export_binary(CCLProf * prof, FILE * stream, CCLErr ** err);
+
+/* Helper function which exports profiling info in the compact binary
+ * format to a given file, automatically opening and closing the file. */
+CCL_EXPORT
+cl_bool ccl_prof_export_binary_file(
+    CCLProf * prof, const char * filename, CCLErr ** err);
+
+/* Create a background writer of event profiling info. */
+CCL_EXPORT
+CCLProfWriter * ccl_prof_writer_new(
+    const char * filename, cl_bool compress, CCLErr ** err);
+
+/* Signal that all records were given to a background profile writer. */
+CCL_EXPORT
+CCLFuture * ccl_prof_writer_finish(CCLProfWriter * writer);
+
+/* Destroy a background profile writer, waiting for all given records to
+ * be written. */
+CCL_EXPORT
+cl_bool ccl_prof_writer_destroy(CCLProfWriter * writer, CCLErr ** err);
+
+/* Stream the profiling info of drained events to a background profile
+ * writer. */
+CCL_EXPORT
+void ccl_prof_set_writer(CCLProf * prof, CCLProfWriter * writer);
+
+/* Export event profiling info through a background profile writer. */
+CCL_EXPORT
+void ccl_prof_export_info_async(CCLProf * prof, CCLProfWriter * writer);
+
+/* Open a binary profile file, mapping it into memory. */
+CCL_EXPORT
+CCLProfFile * ccl_prof_file_open(const char * filename, CCLErr ** err);
+
+/* Close a binary profile file. */
+CCL_EXPORT
+void ccl_prof_file_close(CCLProfFile * pfile);
+
+/* Get number of events in a binary profile file. */
+CCL_EXPORT
+cl_uint ccl_prof_file_get_num_events(CCLProfFile * pfile);
+
+/* Initialize an iterator for the event profiling info in a binary
+ * profile file. */
+CCL_EXPORT
+void ccl_prof_file_iter_info_init(CCLProfFile * pfile, int sort);
+
+/* Return the next event profiling info in a binary profile file. */
+CCL_EXPORT
+const CCLProfInfo * ccl_prof_file_iter_info_next(CCLProfFile * pfile);
+
 /* Set export options using a ::CCLProfExportOptions struct. */
 CCL_EXPORT
 void ccl_prof_set_export_opts(CCLProfExportOptions export_opts);
@@ -0,0 +1,482 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of the on-disk program binary cache.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "_ccl_program_cache.h"
+#include "ccl_platform_wrapper.h"
+#include "_ccl_defs.h"
+#include <glib/gstdio.h>
+
+/**
+ * @internal
+ * Version of the cache key format, changing it invalidates existing
+ * cache entries.
+ * */
+#define CCL_PROGRAM_CACHE_KEY_VERSION "cf4ocl-program-cache-1"
+
+/**
+ * @internal
+ * Suffix of program binary cache files.
+ * */
+#define CCL_PROGRAM_CACHE_SUFFIX ".bin"
+
+/**
+ * @internal
+ *
+ * @brief A file in the program binary cache, considered for eviction.
+ * */
+struct ccl_program_cache_file {
+
+    /**
+     * Full path of file.
+     * @private
+     * */
+    gchar * path;
+
+    /**
+     * Size of file in bytes.
+     * @private
+     * */
+    goffset size;
+
+    /**
+     * Last modification time of file, updated on cache hits.
+     * @private
+     * */
+    gint64 mtime;
+
+};
+
+/* Lock protecting the program binary cache settings. */
+static GMutex cache_lock;
+
+/* Program binary cache directory, or NULL if the cache is disabled. */
+static gchar * cache_dir = NULL;
+
+/* Maximum size in bytes of the program binary cache. */
+static cl_ulong cache_max_size = CCL_PROGRAM_CACHE_MAX_SIZE;
+
+/**
+ * @internal
+ *
+ * @brief Get the program binary cache directory.
+ *
+ * @param[out] max_size Location where to put the maximum cache size, or
+ * `NULL`.
+ * @return A copy of the program binary cache directory (to be freed with
+ * g_free()), or `NULL` if the cache is disabled.
+ * */
+static gchar * ccl_program_cache_get_dir(cl_ulong * max_size) {
+
+    gchar * dir;
+
+    g_mutex_lock(&cache_lock);
+    dir = g_strdup(cache_dir);
+    if (max_size != NULL) *max_size = cache_max_size;
+    g_mutex_unlock(&cache_lock);
+
+    return dir;
+}
+
+/**
+ * @internal
+ *
+ * @brief Add a string, including its terminating null character, to a
+ * cache key checksum, so that consecutive fields can't be confused.
+ *
+ * @param[in] checksum The cache key checksum.
+ * @param[in] str String to add, `NULL` is treated as an empty string.
+ * */
+static void ccl_program_cache_key_add(GChecksum * checksum, const char * str) {
+
+    if (str == NULL) str = "";
+    g_checksum_update(checksum, (const guchar *) str, strlen(str) + 1);
+}
+
+/**
+ * @internal
+ *
+ * @brief Compare cache files by last modification time.
+ * */
+static gint ccl_program_cache_file_cmp(gconstpointer a, gconstpointer b) {
+
+    const struct ccl_program_cache_file * fa =
+        *((struct ccl_program_cache_file * const *) a);
+    const struct ccl_program_cache_file * fb =
+        *((struct ccl_program_cache_file * const *) b);
+
+    return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/**
+ * @internal
+ *
+ * @brief Destroy a cache file object.
+ * */
+static void ccl_program_cache_file_destroy(gpointer data) {
+
+    struct ccl_program_cache_file * file =
+        (struct ccl_program_cache_file *) data;
+
+    g_free(file->path);
+    g_slice_free(struct ccl_program_cache_file, file);
+}
+
+/**
+ * @internal
+ *
+ * @brief Remove the least recently used binaries from the cache directory
+ * until its total size does not exceed the given maximum.
+ *
+ * @param[in] dir Cache directory.
+ * @param[in] max_size Maximum cache size in bytes.
+ * */
+static void ccl_program_cache_evict(const gchar * dir, cl_ulong max_size) {
+
+    GDir * gdir;
+    const gchar * name;
+    GPtrArray * files;
+    cl_ulong total = 0;
+
+    /* Open cache directory. */
+    gdir = g_dir_open(dir, 0, NULL);
+    if (gdir == NULL) return;
+
+    /* Collect cache files and determine total cache size. */
+    files = g_ptr_array_new_with_free_func(ccl_program_cache_file_destroy);
+    while ((name = g_dir_read_name(gdir)) != NULL) {
+
+        GStatBuf st;
+        struct ccl_program_cache_file * file;
+        gchar * path;
+
+        if (!g_str_has_suffix(name, CCL_PROGRAM_CACHE_SUFFIX)) continue;
+
+        path = g_build_filename(dir, name, NULL);
+        if (g_stat(path, &st) != 0) {
+            g_free(path);
+            continue;
+        }
+        file = g_slice_new(struct ccl_program_cache_file);
+        file->path = path;
+        file->size = (goffset) st.st_size;
+        file->mtime = (gint64) st.st_mtime;
+        g_ptr_array_add(files, file);
+        total += (cl_ulong) st.st_size;
+    }
+    g_dir_close(gdir);
+
+    /* Remove oldest files first until the cache fits. */
+    if (total > max_size) {
+        g_ptr_array_sort(files, ccl_program_cache_file_cmp);
+        for (guint i = 0; (i < files->len) && (total > max_size); ++i) {
+            struct ccl_program_cache_file * file = g_ptr_array_index(files, i);
+            if (g_unlink(file->path) == 0)
+                total -= (cl_ulong) file->size;
+        }
+    }
+
+    g_ptr_array_free(files, TRUE);
+}
+
+/**
+ * @internal
+ *
+ * @brief Get the cache keys of the program binaries for the given devices.
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] num_devices Number of devices in `devs`.
+ * @param[in] devs Devices for which to get the cache keys.
+ * @param[in] options Build options.
+ * @return A `NULL`-terminated array of cache keys, one per device, to be
+ * freed with g_strfreev(), or `NULL` if the cache is disabled, if the
+ * program was not created from source, or if some required information
+ * is not available.
+ * */
+gchar ** ccl_program_cache_get_keys(CCLProgram * prg, cl_uint num_devices,
+    CCLDevice * const * devs, const char * options) {
+
+    /* Cache directory. */
+    gchar * dir;
+    /* Program source. */
+    const char * src;
+    /* Cache keys. */
+    gchar ** keys = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* If cache is disabled, there are no keys. */
+    dir = ccl_program_cache_get_dir(NULL);
+    if (dir == NULL) return NULL;
+    g_free(dir);
+
+    /* Only programs created from source are cached. */
+    src = ccl_program_get_info_array(prg, CL_PROGRAM_SOURCE, char, NULL);
+    if ((src == NULL) || (*src == '\0')) return NULL;
+
+    /* Determine the key of each device binary. */
+    keys = g_new0(gchar *, num_devices + 1);
+    for (cl_uint i = 0; i < num_devices; ++i) {
+
+        GChecksum * checksum;
+        CCLPlatform * platf;
+        const char * dev_name, * dev_ver, * drv_ver, * platf_ver;
+
+        /* Get device and platform information. */
+        dev_name = ccl_device_get_info_array(
+            devs[i], CL_DEVICE_NAME, char, &err_internal);
+        if (err_internal != NULL) break;
+        dev_ver = ccl_device_get_info_array(
+            devs[i], CL_DEVICE_VERSION, char, &err_internal);
+        if (err_internal != NULL) break;
+        drv_ver = ccl_device_get_info_array(
+            devs[i], CL_DRIVER_VERSION, char, &err_internal);
+        if (err_internal != NULL) break;
+        platf = ccl_platform_new_from_device(devs[i], &err_internal);
+        if (err_internal != NULL) break;
+        platf_ver = ccl_platform_get_info_string(
+            platf, CL_PLATFORM_VERSION, &err_internal);
+
+        /* Hash everything which influences the binary. */
+        if (err_internal == NULL) {
+            checksum = g_checksum_new(G_CHECKSUM_SHA256);
+            ccl_program_cache_key_add(checksum, CCL_PROGRAM_CACHE_KEY_VERSION);
+            ccl_program_cache_key_add(checksum, src);
+            ccl_program_cache_key_add(checksum, options);
+            ccl_program_cache_key_add(checksum, dev_name);
+            ccl_program_cache_key_add(checksum, dev_ver);
+            ccl_program_cache_key_add(checksum, drv_ver);
+            ccl_program_cache_key_add(checksum, platf_ver);
+            keys[i] = g_strdup(g_checksum_get_string(checksum));
+            g_checksum_free(checksum);
+        }
+        ccl_platform_destroy(platf);
+        if (err_internal != NULL) break;
+    }
+
+    /* If some information is not available, don't use the cache. */
+    if (err_internal != NULL) {
+        g_error_free(err_internal);
+        g_strfreev(keys);
+        keys = NULL;
+    }
+
+    return keys;
+}
+
+/**
+ * @internal
+ *
+ * @brief Create and build a program from the cached binaries with the
+ * given keys. Cached binaries which the OpenCL implementation does not
+ * accept are removed from the cache.
+ *
+ * @param[in] context OpenCL context of program.
+ * @param[in] num_devices Number of devices in `devs`.
+ * @param[in] devs Devices for which to create the program.
+ * @param[in] keys Cache keys of binaries, one per device.
+ * @param[in] options Build options.
+ * @return A new, built, OpenCL program, or `NULL` if the binaries are not
+ * in the cache or could not be used.
+ * */
+cl_program ccl_program_cache_load(cl_context context, cl_uint num_devices,
+    CCLDevice * const * devs, gchar ** keys, const char * options) {
+
+    /* Cache directory. */
+    gchar * dir;
+    /* Cache file paths. */
+    gchar ** paths;
+    /* Unwrapped devices, binaries and their sizes. */
+    cl_device_id * cl_devices;
+    unsigned char ** bins;
+    size_t * sizes;
+    cl_int * bin_status;
+    /* Program to return. */
+    cl_program program = NULL;
+    /* OpenCL function status. */
+    cl_int ocl_status;
+    /* Were all binaries found? */
+    cl_bool found = CL_TRUE;
+
+    /* If cache was disabled meanwhile, nothing to load. */
+    dir = ccl_program_cache_get_dir(NULL);
+    if (dir == NULL) return NULL;
+
+    /* Read cached binaries. */
+    paths = g_new0(gchar *, num_devices + 1);
+    cl_devices = g_new0(cl_device_id, num_devices);
+    bins = g_new0(unsigned char *, num_devices);
+    sizes = g_new0(size_t, num_devices);
+    bin_status = g_new0(cl_int, num_devices);
+    for (cl_uint i = 0; (i < num_devices) && found; ++i) {
+        gsize size;
+        paths[i] = g_strconcat(dir, G_DIR_SEPARATOR_S, keys[i],
+            CCL_PROGRAM_CACHE_SUFFIX, NULL);
+        cl_devices[i] = ccl_device_unwrap(devs[i]);
+        found = g_file_get_contents(
+            paths[i], (gchar **) &bins[i], &size, NULL) && (size > 0);
+        sizes[i] = size;
+    }
+
+    if (found) {
+
+        /* Create program from binaries. */
+        program = clCreateProgramWithBinary(context, num_devices,
+            cl_devices, sizes, (const unsigned char **) bins, bin_status,
+            &ocl_status);
+        for (cl_uint i = 0; (i < num_devices) && (program != NULL); ++i) {
+            if (bin_status[i] != CL_SUCCESS) ocl_status = bin_status[i];
+        }
+
+        /* Build it. */
+        if ((program != NULL) && (ocl_status == CL_SUCCESS)) {
+            ocl_status = clBuildProgram(
+                program, num_devices, cl_devices, options, NULL, NULL);
+        }
+
+        if (ocl_status == CL_SUCCESS) {
+
+            /* Cache hit, mark binaries as recently used. */
+            for (cl_uint i = 0; i < num_devices; ++i)
+                g_utime(paths[i], NULL);
+
+        } else {
+
+            /* Cache miss. If binaries were rejected they are stale,
+             * so remove them from the cache. */
+            if (program != NULL) clReleaseProgram(program);
+            program = NULL;
+            if ((ocl_status == CL_INVALID_BINARY)
+                || (ocl_status == CL_BUILD_PROGRAM_FAILURE)) {
+                for (cl_uint i = 0; i < num_devices; ++i)
+                    g_unlink(paths[i]);
+            }
+        }
+    }
+
+    /* Free stuff. */
+    for (cl_uint i = 0; i < num_devices; ++i)
+        g_free(bins[i]);
+    g_free(bins);
+    g_free(sizes);
+    g_free(bin_status);
+    g_free(cl_devices);
+    g_strfreev(paths);
+    g_free(dir);
+
+    return program;
+}
+
+/**
+ * @internal
+ *
+ * @brief Save the binaries of a built program in the cache, evicting the
+ * least recently used binaries if the cache becomes too large. Failing to
+ * save binaries is not an error, but a warning is issued.
+ *
+ * @param[in] prg The built program wrapper object.
+ * @param[in] num_devices Number of devices in `devs`.
+ * @param[in] devs Devices for which to save the program binaries.
+ * @param[in] keys Cache keys of binaries, one per device.
+ * */
+void ccl_program_cache_store(CCLProgram * prg, cl_uint num_devices,
+    CCLDevice * const * devs, gchar ** keys) {
+
+    /* Cache directory and maximum size. */
+    gchar * dir;
+    cl_ulong max_size;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* If cache was disabled meanwhile, nothing to store. */
+    dir = ccl_program_cache_get_dir(&max_size);
+    if (dir == NULL) return;
+
+    /* Save binaries, one file per device. Files are written atomically
+     * by ccl_program_save_binary(), so concurrent processes never see
+     * partial binaries. */
+    g_mkdir_with_parents(dir, 0755);
+    for (cl_uint i = 0; i < num_devices; ++i) {
+
+        gchar * path = g_strconcat(dir, G_DIR_SEPARATOR_S, keys[i],
+            CCL_PROGRAM_CACHE_SUFFIX, NULL);
+
+        ccl_program_save_binary(prg, devs[i], path, &err_internal);
+        g_free(path);
+        if (err_internal != NULL) {
+            g_warning("Unable to save program binary in cache: %s",
+                err_internal->message);
+            g_clear_error(&err_internal);
+        }
+    }
+
+    /* Keep cache size bounded. */
+    ccl_program_cache_evict(dir, max_size);
+
+    g_free(dir);
+}
+
+/**
+ * @addtogroup CCL_PROGRAM_CACHE
+ * @{
+ */
+
+/**
+ * Enable the on-disk program binary cache, which is used by
+ * ::ccl_program_build_full() for programs created from source.
+ *
+ * @param[in] dir Directory where to keep the cache, or `NULL` to use
+ * `cf4ocl/programs` under the user cache directory.
+ * @param[in] max_size Maximum size of the cache in bytes, or zero for
+ * ::CCL_PROGRAM_CACHE_MAX_SIZE.
+ * */
+CCL_EXPORT
+void ccl_program_cache_enable(const char * dir, cl_ulong max_size) {
+
+    g_mutex_lock(&cache_lock);
+    g_free(cache_dir);
+    cache_dir = (dir != NULL)
+        ? g_strdup(dir)
+        : g_build_filename(
+            g_get_user_cache_dir(), "cf4ocl", "programs", NULL);
+    cache_max_size = (max_size > 0) ? max_size : CCL_PROGRAM_CACHE_MAX_SIZE;
+    g_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Disable the on-disk program binary cache. Cached binaries are kept on
+ * disk.
+ * */
+CCL_EXPORT
+void ccl_program_cache_disable(void) {
+
+    g_mutex_lock(&cache_lock);
+    g_free(cache_dir);
+    cache_dir = NULL;
+    g_mutex_unlock(&cache_lock);
+}
+
+/** @} */
@@ -0,0 +1,91 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of the on-disk program binary cache.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_PROGRAM_CACHE_H_
+#define _CCL_PROGRAM_CACHE_H_
+
+#include "ccl_common.h"
+
+/**
+ * @defgroup CCL_PROGRAM_CACHE Program binary cache
+ * @ingroup CCL_PROGRAM_WRAPPER
+ *
+ * This module provides an opt-in, on-disk, cache of program binaries,
+ * which avoids building programs from source every time an application
+ * starts.
+ *
+ * Once enabled with ::ccl_program_cache_enable(),
+ * ::ccl_program_build_full() (and ::ccl_program_build()) transparently
+ * look up the cache when building a program created from source for all
+ * its devices. The cache key of each device binary is a hash of the
+ * complete program source, of the build options, and of the device
+ * name, device version, driver version and platform version. On a
+ * hit, the program wrapper is switched to a program created from the
+ * cached binaries with ::ccl_program_new_from_binaries(), which is then
+ * built with the same options. On a miss, the program is built from
+ * source and its binaries are saved in the cache.
+ *
+ * Cache files are written atomically, so the cache can be shared by
+ * several processes. When the total size of the cache exceeds the
+ * specified maximum, the least recently used binaries are evicted.
+ *
+ * @attention The cache is not used when a notification callback is
+ * passed to ::ccl_program_build_full(), since in that case the build may
+ * be asynchronous. Headers included from disk with `#include` are not
+ * part of the cache key, so if they change, the cache should be
+ * cleared (or the build options changed, e.g. with a version `-D`
+ * option). Since the program wrapper is switched to a new OpenCL
+ * program object on a cache hit, `cl_program` objects unwrapped from it
+ * before building should not be used afterwards.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * ccl_program_cache_enable(NULL, 0);
+ * @endcode
+ * @code{.c}
+ * prg = ccl_program_new_from_source_files(ctx, 2, files, NULL);
+ * ccl_program_build(prg, "-cl-fast-relaxed-math", NULL);
+ * @endcode
+ *
+ * @{
+ */
+
+/** Default maximum size in bytes of the program binary cache. */
+#define CCL_PROGRAM_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+/* Enable the on-disk program binary cache. */
+CCL_EXPORT
+void ccl_program_cache_enable(const char * dir, cl_ulong max_size);
+
+/* Disable the on-disk program binary cache. */
+CCL_EXPORT
+void ccl_program_cache_disable(void);
+
+/** @} */
+
+#endif
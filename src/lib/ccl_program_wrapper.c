@@ -28,7 +28,17 @@
 
 #include "ccl_program_wrapper.h"
 #include "_ccl_abstract_dev_container_wrapper.h"
+#include "_ccl_kernel_wrapper.h"
+#include "_ccl_program_cache.h"
+#include "_ccl_context_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
+#include <errno.h>
+#ifdef G_OS_WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
 
 /* Valid file name characters. */
 #define CCL_VALIDFILECHARS "abcdefghijklmnopqrstuvwxyzABCDEFGH" \
@@ -59,6 +69,12 @@ struct ccl_program {
      * */
     GHashTable * krnls;
 
+    /**
+     * Per-thread program kernels, indexed by kernel name.
+     * @private
+     * */
+    GHashTable * thread_krnls;
+
     /**
      * Build logs of most recent build for each device.
      * @private
@@ -70,6 +86,18 @@ struct ccl_program {
      * @private
      * */
     gchar * build_logs_concat;
+
+    /**
+     * When build logs are retrieved.
+     * @private
+     * */
+    CCLProgramBuildLogMode build_log_mode;
+
+    /**
+     * Built variants of this program, indexed by build options.
+     * @private
+     * */
+    GHashTable * variants;
 };
 
 /**
@@ -91,6 +119,122 @@ struct ccl_program_binary {
     size_t size;
 };
 
+/**
+ * @internal
+ *
+ * @brief Per-thread instances of a program kernel function.
+ * */
+struct ccl_program_thread_kernels {
+
+    /**
+     * Kernel which is never used for execution, and from which
+     * per-thread instances are cloned, or `NULL` if kernels are not
+     * cloned.
+     * @private
+     * */
+    CCLKernel * tmpl;
+
+    /**
+     * Kernel instances, indexed by thread.
+     * @private
+     * */
+    GHashTable * krnls;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Asynchronous program build handle.
+ * */
+struct ccl_async_build {
+
+    /**
+     * Program being built.
+     * @private
+     * */
+    CCLProgram * prg;
+
+    /**
+     * Number of devices for which the program is being built.
+     * @private
+     * */
+    cl_uint num_devices;
+
+    /**
+     * Devices for which the program is being built.
+     * @private
+     * */
+    cl_device_id * devices;
+
+    /**
+     * Callback invoked when the build completes, may be `NULL`.
+     * @private
+     * */
+    ccl_async_build_callback callback;
+
+    /**
+     * User data for callback.
+     * @private
+     * */
+    void * user_data;
+
+    /**
+     * Was the program successfully built for all devices?
+     * @private
+     * */
+    cl_bool success;
+
+    /**
+     * Has the build completed? Only set while holding the lock.
+     * @private
+     * */
+    gint done;
+
+    /**
+     * Lock protecting the completion state.
+     * @private
+     * */
+    GMutex lock;
+
+    /**
+     * Condition signaled when the build completes.
+     * @private
+     * */
+    GCond cond;
+
+    /**
+     * Reference count, one reference is owned by the client, the other by
+     * the OpenCL build callback.
+     * @private
+     * */
+    gint ref_count;
+
+};
+
+/* Lock protecting the per-thread kernel tables of all programs. */
+static GMutex thread_krnls_lock;
+
+/* Lock protecting the variant tables of all programs. */
+static GMutex variants_lock;
+
+/**
+ * @internal
+ *
+ * @brief Destroy the per-thread instances of a program kernel function.
+ *
+ * @param[in] data A ::ccl_program_thread_kernels object.
+ * */
+static void ccl_program_thread_kernels_destroy(gpointer data) {
+
+    struct ccl_program_thread_kernels * tkrnls =
+        (struct ccl_program_thread_kernels *) data;
+
+    if (tkrnls->tmpl != NULL) ccl_kernel_destroy(tkrnls->tmpl);
+    g_hash_table_destroy(tkrnls->krnls);
+    g_slice_free(struct ccl_program_thread_kernels, tkrnls);
+}
+
 /**
  * @internal
  *
@@ -116,6 +260,29 @@ static void ccl_program_clear_build_logs(CCLProgram * prg) {
     }
 }
 
+/**
+ * @internal
+ *
+ * @brief Destroy table of program binaries, which are no longer valid
+ * after the program is built again.
+ *
+ * @private @memberof ccl_program
+ *
+ * @param[in] prg A ::CCLProgram wrapper object.
+ * */
+static void ccl_program_clear_binaries(CCLProgram * prg) {
+
+    /* Make sure prg is not NULL. */
+    g_return_if_fail(prg != NULL);
+
+    /* If the binaries table was created, free it and the included
+     * binaries, and set it to NULL to allow reuse. */
+    if (prg->binaries != NULL) {
+        g_hash_table_destroy(prg->binaries);
+        prg->binaries = NULL;
+    }
+}
+
 /**
  * @internal
  *
@@ -145,6 +312,16 @@ static void ccl_program_release_fields(CCLProgram * prg) {
 
     }
 
+    /* If the per-thread kernels table was created, free it and release
+     * the kernels therein. */
+    if (prg->thread_krnls != NULL)
+        g_hash_table_destroy(prg->thread_krnls);
+
+    /* If the variants table was created, free it and release the
+     * variants therein. */
+    if (prg->variants != NULL)
+        g_hash_table_destroy(prg->variants);
+
     /* If the binaries table was created... */
     if (prg->binaries != NULL) {
 
@@ -301,7 +478,8 @@ CCLProgram * ccl_program_new_from_source_file(
 /**
  * Create a new program wrapper object from several source files. This function
  * delegates the actual program creation to the ccl_program_new_from_sources()
- * function.
+ * function. Files are memory-mapped, so their contents are not copied before
+ * being handed to the OpenCL implementation.
  *
  * @public @memberof ccl_program
  *
@@ -329,24 +507,34 @@ CCLProgram * ccl_program_new_from_source_files(
     CCLErr * err_internal = NULL;
     /* Program wrapper object to return. */
     CCLProgram * prg = NULL;
-    /* Source files contents. */
-    gchar ** strings = NULL;
+    /* Source files mapped into memory. */
+    GMappedFile ** files = NULL;
+    /* Source files contents and lengths. */
+    const gchar ** strings = NULL;
+    size_t * lengths = NULL;
 
-    /* Allocate space for the specified number of source file
-     * strings. */
+    /* Allocate space for the specified number of source files. */
+    files = g_slice_alloc0(count * sizeof(GMappedFile *));
     strings = g_slice_alloc0(count * sizeof(gchar *));
+    lengths = g_slice_alloc0(count * sizeof(size_t));
 
-    /* Read source files contents. */
+    /* Map source files into memory, avoiding copies of their contents.
+     * Mapped contents are not null-terminated, so their lengths are
+     * passed along. Empty files can't be mapped, and are passed as empty
+     * null-terminated strings. */
     for (cl_uint i = 0; i < count; ++i) {
 
-        g_file_get_contents(
-            filenames[i], &strings[i], NULL, &err_internal);
+        files[i] = g_mapped_file_new(filenames[i], FALSE, &err_internal);
         ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        lengths[i] = g_mapped_file_get_length(files[i]);
+        strings[i] = (lengths[i] > 0)
+            ? g_mapped_file_get_contents(files[i]) : "";
     }
 
     /* Create program from sources. */
-    prg = ccl_program_new_from_sources(ctx, count,
-        (const char **) strings, NULL, &err_internal);
+    prg = ccl_program_new_from_sources(
+        ctx, count, (const char **) strings, lengths, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
     /* If we got here, everything is OK. */
@@ -360,15 +548,15 @@ error_handler:
 
 finish:
 
-    /* Free stuff. */
-    if (strings != NULL) {
-        for (cl_uint i = 0; i < count; ++i) {
-            if (strings[i] != NULL) {
-                g_free(strings[i]);
-            }
+    /* Unmap files and free stuff. */
+    for (cl_uint i = 0; i < count; ++i) {
+        if (files[i] != NULL) {
+            g_mapped_file_unref(files[i]);
         }
-        g_slice_free1(count * sizeof(gchar *), strings);
     }
+    g_slice_free1(count * sizeof(GMappedFile *), files);
+    g_slice_free1(count * sizeof(gchar *), strings);
+    g_slice_free1(count * sizeof(size_t), lengths);
 
     /* Return prg. */
     return prg;
@@ -482,7 +670,8 @@ CCLProgram * ccl_program_new_from_binary_file(CCLContext * ctx,
  * Create a new program wrapper object from files containing binary code
  * executable on the given device list, one file per device. This function
  * delegates the actual program creation to the ccl_program_new_from_binaries()
- * function.
+ * function. Files are memory-mapped, so their contents are not copied before
+ * being handed to the OpenCL implementation.
  *
  * @public @memberof ccl_program
  *
@@ -515,15 +704,23 @@ CCLProgram * ccl_program_new_from_binary_files(CCLContext * ctx,
 
     CCLErr * err_internal = NULL;
     CCLProgramBinary ** bins = NULL;
+    CCLProgramBinary * bins_mapped = NULL;
+    GMappedFile ** files = NULL;
     CCLProgram * prg = NULL;
 
-    /* Open files and create binaries. */
+    /* Map files into memory and create binaries which refer to the
+     * mappings, so that binaries are not copied before being handed to
+     * the OpenCL implementation. */
+    files = g_slice_alloc0(num_devices * sizeof(GMappedFile *));
     bins = g_slice_alloc0(num_devices * sizeof(CCLProgramBinary *));
+    bins_mapped = g_slice_alloc0(num_devices * sizeof(CCLProgramBinary));
     for (cl_uint i = 0; i < num_devices; ++i) {
-        bins[i] = ccl_program_binary_new_empty();
-        g_file_get_contents(filenames[i], (char **) &bins[i]->data,
-            &bins[i]->size, &err_internal);
+        files[i] = g_mapped_file_new(filenames[i], FALSE, &err_internal);
         ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        bins_mapped[i].data =
+            (unsigned char *) g_mapped_file_get_contents(files[i]);
+        bins_mapped[i].size = g_mapped_file_get_length(files[i]);
+        bins[i] = &bins_mapped[i];
     }
 
     /* Create program. */
@@ -542,15 +739,15 @@ error_handler:
 
 finish:
 
-    /* Free stuff if necessary. */
-    if (bins != NULL) {
-        for (cl_uint i = 0; i < num_devices; ++i) {
-            if (bins[i] != NULL) {
-                ccl_program_binary_destroy(bins[i]);
-            }
+    /* Unmap files and free stuff. */
+    for (cl_uint i = 0; i < num_devices; ++i) {
+        if (files[i] != NULL) {
+            g_mapped_file_unref(files[i]);
         }
-        g_slice_free1(num_devices * sizeof(CCLProgramBinary *), bins);
     }
+    g_slice_free1(num_devices * sizeof(GMappedFile *), files);
+    g_slice_free1(num_devices * sizeof(CCLProgramBinary *), bins);
+    g_slice_free1(num_devices * sizeof(CCLProgramBinary), bins_mapped);
 
     /* Return prg. */
     return prg;
@@ -782,92 +979,145 @@ finish:
 }
 
 /**
- * Utility function which builds (compiles and links) a program executable from
- * the program source or binary. This function calls the
- * ccl_program_build_full() function, passing `NULL` to the following
- * parameters: `devices`, `pfn_notify` and `user_data`. In other words, the
- * program executable is built for all devices associated with the program and
- * no callback function is registered.
+ * Create a new program wrapper object from a file containing an
+ * intermediate language (IL), such as SPIR-V. This is a utility function
+ * which maps the file in memory and calls ::ccl_program_new_from_il().
  *
  * @public @memberof ccl_program
+ * @note Requires OpenCL >= 2.1
  *
- * @param[in] prg The program wrapper object.
- * @param[in] options A null-terminated string of characters that describes the
- * build options to be used for building the program executable.
+ * @param[in] ctx The context wrapper object.
+ * @param[in] filename Name of file containing the IL.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * @return A new program wrapper object, or `NULL` if an error occurs.
  * */
 CCL_EXPORT
-cl_bool ccl_program_build(
-    CCLProgram * prg, const char * options, CCLErr ** err) {
+CCLProgram * ccl_program_new_from_il_file(
+    CCLContext * ctx, const char * filename, CCLErr ** err) {
 
-    return ccl_program_build_full(
-        prg, 0, NULL, options, NULL, NULL, err);
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Program wrapper object. */
+    CCLProgram * prg = NULL;
+    /* Mapped IL file. */
+    GMappedFile * file = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Map file in memory. */
+    file = g_mapped_file_new(filename, FALSE, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create program from IL. */
+    prg = ccl_program_new_from_il(ctx, g_mapped_file_get_contents(file),
+        g_mapped_file_get_length(file), &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Unmap file. */
+    if (file != NULL) g_mapped_file_unref(file);
+
+    /* Return prg. */
+    return prg;
 }
 
 /**
- * Builds (compiles and links) a program executable from the program source or
- * binary. This function wraps the clBuildProgram() OpenCL function.
+ * Create a new program wrapper object from an intermediate language (IL),
+ * such as SPIR-V. This function is a wrapper for the
+ * clCreateProgramWithIL() OpenCL function. Programs created from IL skip
+ * the front-end compilation of OpenCL C sources, and are built with
+ * ::ccl_program_build() and related functions. The ILs supported by a
+ * device are given by its `CL_DEVICE_IL_VERSION` information parameter.
  *
  * @public @memberof ccl_program
+ * @note Requires OpenCL >= 2.1
  *
- * @param[in] prg The program wrapper object.
- * @param[in] num_devices The number of devices listed in `devs`.
- * @param[in] devs List of device wrappers associated with program. If `NULL`,
- * the program executable is built for all devices associated with program for
- * which a source or binary has been loaded.
- * @param[in] options A null-terminated string of characters that describes the
- * build options to be used for building the program executable.
- * @param[in] pfn_notify A callback function that can be registered and which
- * will be called when the program executable has been built (successfully or
- * unsuccessfully).
- * @param[in] user_data User supplied data for the callback function.
+ * @param[in] ctx The context wrapper object.
+ * @param[in] il Pointer to `length` bytes of IL.
+ * @param[in] length Length in bytes of the IL.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * @return A new program wrapper object, or `NULL` if an error occurs.
  * */
 CCL_EXPORT
-cl_bool ccl_program_build_full(CCLProgram * prg,
-    cl_uint num_devices, CCLDevice * const * devs, const char * options,
-    ccl_program_callback pfn_notify, void * user_data, CCLErr ** err) {
+CCLProgram * ccl_program_new_from_il(CCLContext * ctx,
+    const void * il, size_t length, CCLErr ** err) {
 
-    /* Make sure prg is not NULL. */
-    g_return_val_if_fail(prg != NULL, CL_FALSE);
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
     /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-    /* Array of unwrapped devices. */
-    cl_device_id * cl_devices = NULL;
-    /* Status of OpenCL function call. */
-    cl_int ocl_status;
-    /* Result of function call. */
-    cl_bool result;
+    /* Program wrapper object. */
+    CCLProgram * prg = NULL;
 
-    /* Clear build logs cache. */
-    ccl_program_clear_build_logs(prg);
+#ifndef CL_VERSION_2_1
 
-    /* Check if its necessary to unwrap devices. */
-    if ((devs != NULL) && (num_devices > 0)) {
-        cl_devices = g_slice_alloc0(sizeof(cl_device_id) * num_devices);
-        /* Unwrap devices. */
-        for (guint i = 0; i < num_devices; ++i)
-            cl_devices[i] = ccl_device_unwrap(devs[i]);
-    }
+    /* Mark unused variables to avoid compiler warnings. */
+    CCL_UNUSED(il);
+    CCL_UNUSED(length);
 
-    /* Build program. */
-    ocl_status = clBuildProgram(ccl_program_unwrap(prg),
-        num_devices, cl_devices, options, pfn_notify, user_data);
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.1, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Program creation from IL requires cf4ocl to be deployed "
+        "with support for OpenCL version 2.1 or newer.",
+        CCL_STRD);
 
-    /* Check for any other errors. */
+#else
+
+    /* OpenCL function return status. */
+    cl_int ocl_status;
+    /* OpenCL program object. */
+    cl_program program = NULL;
+    /* OpenCL version of underlying platform. */
+    cl_uint ocl_ver;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that context platform is >= OpenCL 2.1 */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If OpenCL version is not >= 2.1, throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 210,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Program creation from IL requires OpenCL version 2.1 or "
+        "newer.", CCL_STRD);
+
+    /* Create program. */
+    program = clCreateProgramWithIL(
+        ccl_context_unwrap(ctx), il, length, &ocl_status);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: unable to build program (OpenCL error %d: %s).",
+        "%s: unable to create cl_program from IL "
+        "(OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
+    /* Wrap OpenCL program object. */
+    prg = ccl_program_new_wrap(program);
+
+#endif
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
-    result = CL_TRUE;
     goto finish;
 
 error_handler:
@@ -875,27 +1125,844 @@ error_handler:
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
 
-    /* Bad result. */
-    result = CL_FALSE;
-
 finish:
 
-    /* Check if necessary to release array of unwrapped devices. */
-    if (cl_devices != NULL) {
-        g_slice_free1(sizeof(cl_device_id) * num_devices, cl_devices);
-    }
-
-    /* Return result of function call. */
-    return result;
+    /* Return prg. */
+    return prg;
 }
 
 /**
- * Get a general build log of most recent build, compile or link, for all
- * devices.
+ * @internal
  *
- * Individual build logs for each device associated with the program are
- * returned in a concatenated fashion, with a header (identifying the device)
- * and footer separating them.
+ * @brief Find the embedded binary built for the given device.
+ *
+ * @param[in] dev Device wrapper object.
+ * @param[in] platf_name Name of the device platform.
+ * @param[in] embedded Table of embedded binaries and IL.
+ * @param[in] num_embedded Number of entries in `embedded`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The matching embedded binary, or `NULL` if none matches or if an
+ * error occurs.
+ * */
+static const CCLProgramEmbedded * ccl_program_embedded_find(
+    CCLDevice * dev, const char * platf_name,
+    const CCLProgramEmbedded * embedded, cl_uint num_embedded,
+    CCLErr ** err) {
+
+    /* Name of device. */
+    const char * dev_name;
+
+    dev_name = ccl_device_get_info_array(dev, CL_DEVICE_NAME, char, err);
+    if (dev_name == NULL) return NULL;
+
+    for (cl_uint i = 0; i < num_embedded; ++i) {
+        if (embedded[i].il || (embedded[i].device_name == NULL))
+            continue;
+        if ((g_strcmp0(embedded[i].device_name, dev_name) == 0)
+            && ((embedded[i].platform_name == NULL)
+                || (g_strcmp0(embedded[i].platform_name, platf_name) == 0)))
+            return &embedded[i];
+    }
+    return NULL;
+}
+
+/**
+ * Create and build a new program wrapper object from binaries or IL
+ * embedded in the executable, such as the ones generated by the
+ * `ccl_embed_kernels()` CMake function.
+ *
+ * Embedded binaries are matched against the context devices by device and
+ * platform name. If all devices have a matching binary, the program is
+ * created from these binaries. Otherwise, or if the binaries fail to
+ * load or build, the first embedded IL entry is used, if any and if the
+ * platform supports OpenCL 2.1. As a last resort, the program is built from
+ * the given source. Failures in the first two steps are not errors, since
+ * there is still a fallback; only the failure of the last attempted step
+ * is reported.
+ *
+ * Unlike other constructors, the returned program is already built with
+ * the given options, so it can be directly used for creating kernels.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] embedded Table of embedded binaries and IL. Can be `NULL` if
+ * `num_embedded` is zero.
+ * @param[in] num_embedded Number of entries in `embedded`.
+ * @param[in] src Null-terminated program source used as fallback, or `NULL`
+ * if there is no fallback.
+ * @param[in] options Build options, which should be the same used for
+ * building the embedded binaries (can be `NULL`).
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new built program wrapper object, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProgram * ccl_program_new_from_embedded(CCLContext * ctx,
+    const CCLProgramEmbedded * embedded, cl_uint num_embedded,
+    const char * src, const char * options, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure embedded is not NULL if there are embedded entries. */
+    g_return_val_if_fail(embedded != NULL || num_embedded == 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Program wrapper object. */
+    CCLProgram * prg = NULL;
+    /* Context platform and its name. */
+    CCLPlatform * platf;
+    const char * platf_name;
+    /* Context devices. */
+    CCLDevice * const * devs;
+    cl_uint num_devs;
+    /* Binary objects, one per device, pointing to embedded data. */
+    CCLProgramBinary * bin_objs = NULL;
+    CCLProgramBinary ** bins = NULL;
+    /* Embedded entry being considered. */
+    const CCLProgramEmbedded * entry;
+    /* Whether all devices have a matching embedded binary. */
+    cl_bool all_match = CL_TRUE;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Get context platform and devices. */
+    platf = ccl_context_get_platform(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    platf_name = ccl_platform_get_info_array(
+        platf, CL_PLATFORM_NAME, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    devs = ccl_context_get_all_devices(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* 1. Try the embedded binaries, if there is one for each device. */
+    bin_objs = g_slice_alloc(num_devs * sizeof(CCLProgramBinary));
+    bins = g_slice_alloc(num_devs * sizeof(CCLProgramBinary *));
+    for (cl_uint i = 0; i < num_devs; ++i) {
+        entry = ccl_program_embedded_find(
+            devs[i], platf_name, embedded, num_embedded, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (entry == NULL) {
+            all_match = CL_FALSE;
+            break;
+        }
+        bin_objs[i].data = (unsigned char *) entry->data;
+        bin_objs[i].size = entry->size;
+        bins[i] = &bin_objs[i];
+    }
+    if (all_match) {
+        prg = ccl_program_new_from_binaries(
+            ctx, num_devs, devs, bins, NULL, &err_internal);
+        if ((prg != NULL)
+            && !ccl_program_build(prg, options, &err_internal)) {
+            ccl_program_destroy(prg);
+            prg = NULL;
+        }
+        g_clear_error(&err_internal);
+    }
+
+    /* 2. Try the embedded IL, if any. */
+    for (cl_uint i = 0; (prg == NULL) && (i < num_embedded); ++i) {
+        if (!embedded[i].il) continue;
+        prg = ccl_program_new_from_il(
+            ctx, embedded[i].data, embedded[i].size, &err_internal);
+        if ((prg != NULL)
+            && !ccl_program_build(prg, options, &err_internal)) {
+            ccl_program_destroy(prg);
+            prg = NULL;
+        }
+        g_clear_error(&err_internal);
+        break;
+    }
+
+    /* 3. Fall back to source. */
+    if (prg == NULL) {
+        ccl_if_err_create_goto(*err, CCL_ERROR, src == NULL,
+            CCL_ERROR_ARGS, error_handler,
+            "%s: No embedded binary or IL could be used for the context "
+            "devices and no fallback source was given.", CCL_STRD);
+        prg = ccl_program_new_from_source(ctx, src, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_program_build(prg, options, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Destroy program, if it was created. */
+    if (prg != NULL) {
+        ccl_program_destroy(prg);
+        prg = NULL;
+    }
+
+finish:
+
+    /* Free binary objects. Embedded data belongs to the caller. */
+    if (bin_objs != NULL)
+        g_slice_free1(num_devs * sizeof(CCLProgramBinary), bin_objs);
+    if (bins != NULL)
+        g_slice_free1(num_devs * sizeof(CCLProgramBinary *), bins);
+
+    /* Return prg. */
+    return prg;
+}
+
+/**
+ * Utility function which builds (compiles and links) a program executable from
+ * the program source or binary. This function calls the
+ * ccl_program_build_full() function, passing `NULL` to the following
+ * parameters: `devices`, `pfn_notify` and `user_data`. In other words, the
+ * program executable is built for all devices associated with the program and
+ * no callback function is registered.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] options A null-terminated string of characters that describes the
+ * build options to be used for building the program executable.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_program_build(
+    CCLProgram * prg, const char * options, CCLErr ** err) {
+
+    return ccl_program_build_full(
+        prg, 0, NULL, options, NULL, NULL, err);
+}
+
+/**
+ * Builds (compiles and links) a program executable from the program source or
+ * binary. This function wraps the clBuildProgram() OpenCL function.
+ *
+ * If the @ref CCL_PROGRAM_CACHE "program binary cache" is enabled, the
+ * program was created from source, the build targets all program devices
+ * and no `pfn_notify` callback is given, the program is built from cached
+ * binaries when available, in which case the program wrapper is switched to
+ * a new OpenCL program object. Querying `CL_PROGRAM_SOURCE` on the program
+ * wrapper still returns the original source, even though the new program
+ * object has none.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] num_devices The number of devices listed in `devs`.
+ * @param[in] devs List of device wrappers associated with program. If `NULL`,
+ * the program executable is built for all devices associated with program for
+ * which a source or binary has been loaded.
+ * @param[in] options A null-terminated string of characters that describes the
+ * build options to be used for building the program executable.
+ * @param[in] pfn_notify A callback function that can be registered and which
+ * will be called when the program executable has been built (successfully or
+ * unsuccessfully).
+ * @param[in] user_data User supplied data for the callback function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_program_build_full(CCLProgram * prg,
+    cl_uint num_devices, CCLDevice * const * devs, const char * options,
+    ccl_program_callback pfn_notify, void * user_data, CCLErr ** err) {
+
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    /* Array of unwrapped devices. */
+    cl_device_id * cl_devices = NULL;
+    /* Status of OpenCL function call. */
+    cl_int ocl_status;
+    /* Result of function call. */
+    cl_bool result;
+    /* Program devices and their binary cache keys. */
+    CCLDevice * const * cache_devs = NULL;
+    cl_uint cache_num_devs = 0;
+    gchar ** cache_keys = NULL;
+    /* Program built from cached binaries. */
+    cl_program cached = NULL;
+    /* Source of program built from cached binaries. */
+    CCLWrapperInfo * info;
+    CCLWrapperInfo * src;
+
+    /* Clear build logs and binaries caches. */
+    ccl_program_clear_build_logs(prg);
+    ccl_program_clear_binaries(prg);
+
+    /* Look up program binary cache, if the build is synchronous and
+     * targets all program devices. */
+    if ((pfn_notify == NULL) && ((prg->krnls == NULL)
+            || (g_hash_table_size(prg->krnls) == 0))) {
+
+        cache_num_devs = ccl_program_get_num_devices(prg, NULL);
+        cache_devs = ccl_program_get_all_devices(prg, NULL);
+        if ((cache_devs != NULL) && ((devs == NULL) || (num_devices == 0)
+                || (num_devices == cache_num_devs))) {
+
+            cache_keys = ccl_program_cache_get_keys(
+                prg, cache_num_devs, cache_devs, options);
+        }
+        if (cache_keys != NULL) {
+            cached = ccl_program_cache_load(
+                ccl_program_get_info_scalar(
+                    prg, CL_PROGRAM_CONTEXT, cl_context, NULL),
+                cache_num_devs, cache_devs, cache_keys, options);
+        }
+        if (cached != NULL) {
+
+            /* Keep a copy of the program source, which was used for
+             * determining the cache keys. */
+            src = NULL;
+            info = ccl_program_get_info(prg, CL_PROGRAM_SOURCE, NULL);
+            if (info != NULL) {
+                src = ccl_wrapper_info_new(info->size);
+                memcpy(src->value, info->value, info->size);
+            }
+
+            /* Cache hit, switch wrapper to program built from cached
+             * binaries. */
+            ccl_wrapper_rewrap((CCLWrapper *) prg, cached,
+                (ccl_wrapper_release_cl_object) clReleaseProgram);
+
+            /* Programs created from binaries have no source, so keep
+             * answering source queries with the original one. */
+            if (src != NULL) {
+                ccl_wrapper_cache_info((CCLWrapper *) prg,
+                    CL_PROGRAM_SOURCE, CCL_INFO_PROGRAM, src);
+            }
+            result = CL_TRUE;
+            goto finish;
+        }
+    }
+
+    /* Check if its necessary to unwrap devices. */
+    if ((devs != NULL) && (num_devices > 0)) {
+        cl_devices = g_slice_alloc0(sizeof(cl_device_id) * num_devices);
+        /* Unwrap devices. */
+        for (guint i = 0; i < num_devices; ++i)
+            cl_devices[i] = ccl_device_unwrap(devs[i]);
+    }
+
+    /* Build program. */
+    ocl_status = clBuildProgram(ccl_program_unwrap(prg),
+        num_devices, cl_devices, options, pfn_notify, user_data);
+
+    /* Check for any other errors. */
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to build program (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Save binaries in program binary cache, if enabled. */
+    if (cache_keys != NULL)
+        ccl_program_cache_store(prg, cache_num_devs, cache_devs, cache_keys);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    result = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Bad result. */
+    result = CL_FALSE;
+
+finish:
+
+    /* Check if necessary to release array of unwrapped devices. */
+    if (cl_devices != NULL) {
+        g_slice_free1(sizeof(cl_device_id) * num_devices, cl_devices);
+    }
+
+    /* Release program binary cache keys. */
+    g_strfreev(cache_keys);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return result of function call. */
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release a reference to an asynchronous build handle, freeing it
+ * if no references remain.
+ *
+ * @param[in] build Asynchronous build handle.
+ * */
+static void ccl_async_build_unref(CCLAsyncBuild * build) {
+
+    if (g_atomic_int_dec_and_test(&build->ref_count)) {
+        g_mutex_clear(&build->lock);
+        g_cond_clear(&build->cond);
+        g_slice_free1(sizeof(cl_device_id) * build->num_devices,
+            build->devices);
+        g_slice_free(CCLAsyncBuild, build);
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief OpenCL build callback which completes an asynchronous build.
+ *
+ * @param[in] program The OpenCL program object.
+ * @param[in] user_data The asynchronous build handle.
+ * */
+static void CL_CALLBACK ccl_async_build_notify(
+    cl_program program, void * user_data) {
+
+    CCLAsyncBuild * build = (CCLAsyncBuild *) user_data;
+    cl_bool success = CL_TRUE;
+
+    /* The build succeeded only if it succeeded for all devices. */
+    for (cl_uint i = 0; i < build->num_devices; ++i) {
+        cl_build_status status = CL_BUILD_ERROR;
+        clGetProgramBuildInfo(program, build->devices[i],
+            CL_PROGRAM_BUILD_STATUS, sizeof(cl_build_status), &status, NULL);
+        if (status != CL_BUILD_SUCCESS) success = CL_FALSE;
+    }
+    build->success = success;
+
+    /* Invoke client callback, if any. */
+    if (build->callback != NULL)
+        build->callback(build->prg, success, build->user_data);
+
+    /* Signal completion. */
+    g_mutex_lock(&build->lock);
+    g_atomic_int_set(&build->done, TRUE);
+    g_cond_broadcast(&build->cond);
+    g_mutex_unlock(&build->lock);
+
+    /* Release the reference owned by this callback. */
+    ccl_async_build_unref(build);
+}
+
+/**
+ * Start building (compiling and linking) a program executable from the
+ * program source or binary, returning immediately. This function wraps
+ * the clBuildProgram() OpenCL function, passing it a notification
+ * callback which completes the returned handle.
+ *
+ * The program should not be used (e.g. for getting kernels or build logs)
+ * until the build completes. The callback, if given, is invoked from a
+ * thread of the OpenCL implementation, so it should not call blocking
+ * OpenCL functions.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] num_devices The number of devices listed in `devs`.
+ * @param[in] devs List of device wrappers associated with program. If `NULL`,
+ * the program executable is built for all devices associated with program for
+ * which a source or binary has been loaded.
+ * @param[in] options A null-terminated string of characters that describes the
+ * build options to be used for building the program executable.
+ * @param[in] callback Function invoked when the build completes, or `NULL`.
+ * @param[in] user_data User supplied data for the callback function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A handle for the asynchronous build, which must be destroyed with
+ * ::ccl_async_build_destroy(), or `NULL` if the build could not be started.
+ * */
+CCL_EXPORT
+CCLAsyncBuild * ccl_program_build_async(CCLProgram * prg,
+    cl_uint num_devices, CCLDevice * const * devs, const char * options,
+    ccl_async_build_callback callback, void * user_data, CCLErr ** err) {
+
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Asynchronous build handle. */
+    CCLAsyncBuild * build;
+    /* Program devices. */
+    CCLWrapperInfo * info;
+    /* Status of OpenCL function call. */
+    cl_int ocl_status;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Create handle, owned by the client and by the build callback. */
+    build = g_slice_new0(CCLAsyncBuild);
+    build->prg = prg;
+    build->callback = callback;
+    build->user_data = user_data;
+    build->ref_count = 2;
+    g_mutex_init(&build->lock);
+    g_cond_init(&build->cond);
+
+    /* Keep the devices for which the program is built, which are required
+     * for determining the build status. */
+    if ((devs != NULL) && (num_devices > 0)) {
+        build->num_devices = num_devices;
+        build->devices = g_slice_alloc(sizeof(cl_device_id) * num_devices);
+        for (guint i = 0; i < num_devices; ++i)
+            build->devices[i] = ccl_device_unwrap(devs[i]);
+    } else {
+        info = ccl_program_get_info(prg, CL_PROGRAM_DEVICES, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        build->num_devices = (cl_uint) (info->size / sizeof(cl_device_id));
+        build->devices = g_slice_copy(
+            sizeof(cl_device_id) * build->num_devices, info->value);
+    }
+
+    /* Clear build logs and binaries caches. */
+    ccl_program_clear_build_logs(prg);
+    ccl_program_clear_binaries(prg);
+
+    /* Start build. Devices are only specified if given by the client. */
+    ocl_status = clBuildProgram(ccl_program_unwrap(prg),
+        (devs != NULL) ? num_devices : 0,
+        (devs != NULL) ? build->devices : NULL,
+        options, ccl_async_build_notify, build);
+
+    /* A failed build is reported through the callback, any other error
+     * means that the build was not started. */
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        (CL_SUCCESS != ocl_status) && (CL_BUILD_PROGRAM_FAILURE != ocl_status),
+        ocl_status, error_handler,
+        "%s: unable to start building program (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Callback will not be invoked, release handle. */
+    build->ref_count = 1;
+    ccl_async_build_unref(build);
+    build = NULL;
+
+finish:
+
+    /* Return handle. */
+    return build;
+}
+
+/**
+ * Check if an asynchronous program build has completed.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] build Asynchronous build handle.
+ * @return `CL_TRUE` if the build has completed (successfully or not),
+ * `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_async_build_poll(CCLAsyncBuild * build) {
+
+    /* Make sure build is not NULL. */
+    g_return_val_if_fail(build != NULL, CL_FALSE);
+
+    return g_atomic_int_get(&build->done) ? CL_TRUE : CL_FALSE;
+}
+
+/**
+ * Wait for an asynchronous program build to complete.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] build Asynchronous build handle.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the program was built successfully for all devices,
+ * or `CL_FALSE` otherwise, in which case the build log can be obtained with
+ * ::ccl_program_get_build_log().
+ * */
+CCL_EXPORT
+cl_bool ccl_async_build_wait(CCLAsyncBuild * build, CCLErr ** err) {
+
+    /* Make sure build is not NULL. */
+    g_return_val_if_fail(build != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    /* Wait for build callback. */
+    g_mutex_lock(&build->lock);
+    while (!g_atomic_int_get(&build->done))
+        g_cond_wait(&build->cond, &build->lock);
+    g_mutex_unlock(&build->lock);
+
+    /* Report build failure. */
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR, !build->success,
+        CL_BUILD_PROGRAM_FAILURE, error_handler,
+        "%s: unable to build program (OpenCL error %d: %s).",
+        CCL_STRD, CL_BUILD_PROGRAM_FAILURE, ccl_err(CL_BUILD_PROGRAM_FAILURE));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * Destroy an asynchronous program build handle, waiting for the build to
+ * complete if necessary.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] build Asynchronous build handle.
+ * */
+CCL_EXPORT
+void ccl_async_build_destroy(CCLAsyncBuild * build) {
+
+    /* Make sure build is not NULL. */
+    g_return_if_fail(build != NULL);
+
+    /* Wait for build to complete, ignoring its result. */
+    ccl_async_build_wait(build, NULL);
+
+    /* Release the reference owned by the client. */
+    ccl_async_build_unref(build);
+}
+
+/**
+ * @internal
+ *
+ * @brief Compare two strings given as pointers to string pointers, for
+ * sorting variant build options.
+ *
+ * @param[in] a Pointer to first string.
+ * @param[in] b Pointer to second string.
+ * @return A negative, zero or positive value, as strcmp().
+ * */
+static gint ccl_program_variant_cmp(gconstpointer a, gconstpointer b) {
+    return strcmp(*((const char * const *) a), *((const char * const *) b));
+}
+
+/**
+ * Get a variant of a program, built from the program source with the
+ * given compile-time constants. This is a wrapper for the
+ * ::ccl_program_get_variant_v() function, accepting the constants as a
+ * `NULL`-terminated variable list of name/value string pairs.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The base program wrapper object, created from source.
+ * @param[in] options Additional build options, or `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @param[in] ... A `NULL`-terminated list of name/value string pairs, each
+ * pair representing a compile-time constant.
+ * @return The program variant, which belongs to the base program and should
+ * not be destroyed by client code, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProgram * ccl_program_get_variant(CCLProgram * prg,
+    const char * options, CCLErr ** err, ...) {
+
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* The va_list, which represents the variable argument list. */
+    va_list constants_va;
+    /* Array of constants, to be created from the va_list. */
+    GPtrArray * constants = g_ptr_array_new();
+    /* Aux. string when cycling through the va_list. */
+    const char * aux;
+    /* Program variant. */
+    CCLProgram * variant;
+
+    /* Collect the constants in a NULL-terminated array. */
+    va_start(constants_va, err);
+    while ((aux = va_arg(constants_va, const char *)) != NULL)
+        g_ptr_array_add(constants, (gpointer) aux);
+    va_end(constants_va);
+    g_ptr_array_add(constants, NULL);
+
+    /* Get the variant. */
+    variant = ccl_program_get_variant_v(prg, options,
+        (const char * const *) constants->pdata, err);
+
+    /* Release array of constants. */
+    g_ptr_array_free(constants, TRUE);
+
+    /* Return the variant. */
+    return variant;
+}
+
+/**
+ * Get a variant of a program, built from the program source with the
+ * given compile-time constants. Each constant is passed to the compiler
+ * as a `-D name=value` build option, so kernels can be specialized (e.g.
+ * for tile sizes or data types) in the same way as C++ templates.
+ *
+ * Each distinct variant is built only once for all devices associated with
+ * the program, and is kept in memory until the base program is destroyed.
+ * Variants are identified by their constants and options, independently of
+ * the order in which constants are specified. If the
+ * @ref CCL_PROGRAM_CACHE "program binary cache" is enabled, variant
+ * binaries are also cached on disk, so they are not rebuilt in later runs.
+ * Kernels of a variant are obtained with ::ccl_program_get_kernel().
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The base program wrapper object, created from source.
+ * @param[in] options Additional build options, or `NULL`.
+ * @param[in] constants A `NULL`-terminated array of name/value string pairs,
+ * each pair representing a compile-time constant.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The program variant, which belongs to the base program and should
+ * not be destroyed by client code, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProgram * ccl_program_get_variant_v(CCLProgram * prg,
+    const char * options, const char * const * constants, CCLErr ** err) {
+
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, NULL);
+    /* Make sure constants is not NULL. */
+    g_return_val_if_fail(constants != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Program variant to return. */
+    CCLProgram * variant = NULL;
+    /* Variant found in table after build. */
+    CCLProgram * variant_cached;
+    /* Build options of individual constants. */
+    GPtrArray * defines = g_ptr_array_new_with_free_func(g_free);
+    /* Complete build options, also used as key in variants table. */
+    GString * build_opts = g_string_new("");
+    /* Base program source. */
+    const char * src;
+    /* Base program context. */
+    cl_context context;
+    CCLContext * ctx;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Determine build options for the given constants. Names come in
+     * pairs with values, and are sorted so that the same set of
+     * constants always yields the same options. */
+    for (guint i = 0; constants[i] != NULL; i += 2) {
+        ccl_if_err_create_goto(*err, CCL_ERROR, constants[i + 1] == NULL,
+            CCL_ERROR_ARGS, error_handler,
+            "%s: constant '%s' has no value.", CCL_STRD, constants[i]);
+        g_ptr_array_add(defines,
+            g_strdup_printf("-D%s=%s", constants[i], constants[i + 1]));
+    }
+    g_ptr_array_sort(defines, ccl_program_variant_cmp);
+    for (guint i = 0; i < defines->len; ++i)
+        g_string_append_printf(build_opts, "%s%s",
+            i > 0 ? " " : "", (const char *) g_ptr_array_index(defines, i));
+    if ((options != NULL) && (*options != '\0'))
+        g_string_append_printf(build_opts, "%s%s",
+            build_opts->len > 0 ? " " : "", options);
+
+    /* Check if variant was already built. */
+    g_mutex_lock(&variants_lock);
+    if (prg->variants != NULL)
+        variant = g_hash_table_lookup(prg->variants, build_opts->str);
+    g_mutex_unlock(&variants_lock);
+    if (variant != NULL) goto finish;
+
+    /* Get base program source. */
+    src = ccl_program_get_info_array(
+        prg, CL_PROGRAM_SOURCE, char, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, (src == NULL) || (*src == '\0'),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: program variants require a program created from source.",
+        CCL_STRD);
+
+    /* Get base program context. */
+    context = ccl_program_get_info_scalar(
+        prg, CL_PROGRAM_CONTEXT, cl_context, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create variant from base program source. */
+    ctx = ccl_context_new_wrap(context);
+    variant = ccl_program_new_from_source(ctx, src, &err_internal);
+    ccl_context_unref(ctx);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Build variant. */
+    ccl_program_build(variant, build_opts->str, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Keep variant in table, unless another thread built the same variant
+     * in the meantime, in which case the latter is used instead. */
+    g_mutex_lock(&variants_lock);
+    if (prg->variants == NULL)
+        prg->variants = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, (GDestroyNotify) ccl_program_destroy);
+    variant_cached = g_hash_table_lookup(prg->variants, build_opts->str);
+    if (variant_cached == NULL) {
+        g_hash_table_insert(
+            prg->variants, g_strdup(build_opts->str), variant);
+    } else {
+        ccl_program_destroy(variant);
+        variant = variant_cached;
+    }
+    g_mutex_unlock(&variants_lock);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release variant, if created. */
+    if (variant != NULL) ccl_program_destroy(variant);
+    variant = NULL;
+
+finish:
+
+    /* Release build options. */
+    g_ptr_array_free(defines, TRUE);
+    g_string_free(build_opts, TRUE);
+
+    /* Return program variant. */
+    return variant;
+}
+
+/**
+ * Get a general build log of most recent build, compile or link, for all
+ * devices.
+ *
+ * Individual build logs for each device associated with the program are
+ * returned in a concatenated fashion, with a header (identifying the device)
+ * and footer separating them.
  *
  * @param[in] prg Program wrapper object.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
@@ -958,6 +2025,12 @@ const char * ccl_program_get_build_log(CCLProgram * prg, CCLErr ** err) {
                 prg, dev, &err_internal);
             ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
+            /* Skip devices without failed builds, if only logs of failed
+             * builds are required. */
+            if ((build_log == NULL) && (prg->build_log_mode
+                    == CCL_PROGRAM_BUILD_LOG_ON_FAILURE))
+                continue;
+
             /* Append build log to string of concatenated build logs. */
             g_string_append_printf(build_log_obj, "\n### Build log "
                 "for device '%s'\n\n%s\n\n", dev_name,
@@ -986,6 +2059,31 @@ finish:
     return (const char *) prg->build_logs_concat;
 }
 
+/**
+ * Set when build logs are retrieved from the OpenCL implementation. Build
+ * logs are never retrieved, and thus do not take up memory, until they are
+ * requested with ::ccl_program_get_build_log() or
+ * ::ccl_program_get_device_build_log(). With
+ * ::CCL_PROGRAM_BUILD_LOG_ON_FAILURE, logs are also not retrieved for
+ * devices on which the most recent build succeeded, which avoids keeping
+ * large logs produced by verbose compiler options when builds succeed.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] mode When build logs are retrieved.
+ * */
+CCL_EXPORT
+void ccl_program_set_build_log_mode(
+    CCLProgram * prg, CCLProgramBuildLogMode mode) {
+
+    /* Make sure prg is not NULL. */
+    g_return_if_fail(prg != NULL);
+
+    /* Set build log mode. */
+    prg->build_log_mode = mode;
+}
+
 /**
  * Get build log for most recent build, compile or link for the specified
  * device.
@@ -995,8 +2093,10 @@ finish:
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
  * @return The build log for most recent build, compile or link. May be `NULL`
- * or an empty string if no build, compile or link was performed, or if no
- * build log is available.
+ * or an empty string if no build, compile or link was performed, if no
+ * build log is available, or if the build log mode is
+ * ::CCL_PROGRAM_BUILD_LOG_ON_FAILURE and the most recent build did not fail
+ * for the specified device.
  * */
 CCL_EXPORT
 const char * ccl_program_get_device_build_log(
@@ -1011,9 +2111,20 @@ const char * ccl_program_get_device_build_log(
 
     /* Build log for current device.*/
     char * build_log_dev = NULL;
+    /* Build status for current device. */
+    cl_build_status build_status;
     /* Error reporting object. */
     CCLErr * err_internal = NULL;
 
+    /* If build logs are only required for failed builds, check if the
+     * build failed for this device. */
+    if (prg->build_log_mode == CCL_PROGRAM_BUILD_LOG_ON_FAILURE) {
+        build_status = ccl_program_get_build_info_scalar(prg, dev,
+            CL_PROGRAM_BUILD_STATUS, cl_build_status, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (build_status != CL_BUILD_ERROR) goto finish;
+    }
+
     /* Is build log for this device already in cache? */
     if ((prg->build_logs == NULL) || ((build_log_dev = (char *)
         g_hash_table_lookup(prg->build_logs, (gconstpointer) dev)) == NULL)) {
@@ -1142,8 +2253,9 @@ cl_bool ccl_program_compile(CCLProgram * prg, cl_uint num_devices,
         "%s: Program compilation requires OpenCL version 1.2 or newer.",
         CCL_STRD);
 
-    /* Clear build logs cache. */
+    /* Clear build logs and binaries caches. */
     ccl_program_clear_build_logs(prg);
+    ccl_program_clear_binaries(prg);
 
     /* Check if its necessary to unwrap devices. */
     if ((devs != NULL) && (num_devices > 0)) {
@@ -1205,6 +2317,127 @@ finish:
     return result;
 }
 
+/**
+ * Get a compiled (not linked) program object for the given sources, headers
+ * and options, compiling it for all context devices only if an equivalent
+ * program was not yet compiled in the same context. Compiled programs are
+ * cached in the context, indexed by a hash of the sources, of the build
+ * options, and of the include names and sources of the embedded headers,
+ * and are kept until the context is destroyed. This allows shared units to
+ * be compiled once and linked into several programs with
+ * ::ccl_program_link().
+ *
+ * Cached programs are shared, and should therefore not be compiled or
+ * built again by client code.
+ *
+ * @public @memberof ccl_program
+ * @note Requires OpenCL >= 1.2
+ *
+ * @param[in] ctx The context wrapper object.
+ * @param[in] count Number of source strings.
+ * @param[in] strings Null-terminated source strings.
+ * @param[in] options A null-terminated string of characters that describes
+ * the compilation options to be used for building the program executable.
+ * @param[in] num_input_headers The number of programs that describe
+ * headers in the array referenced by `prg_input_headers`.
+ * @param[in] prg_input_headers An array of program wrapper embedded headers
+ * created with any of the `ccl_program_new_from_source*()` functions.
+ * @param[in] header_include_names An array that has a one to one
+ * correspondence with `prg_input_headers`. Each entry specifies the include
+ * name used by source in program that comes from an embedded header.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A compiled program wrapper object, which should be released with
+ * ::ccl_program_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLProgram * ccl_program_compile_cached(CCLContext * ctx, cl_uint count,
+    const char ** strings, const char * options, cl_uint num_input_headers,
+    CCLProgram ** prg_input_headers, const char ** header_include_names,
+    CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure strings is not NULL. */
+    g_return_val_if_fail(strings != NULL, NULL);
+    /* Make sure count > 0. */
+    g_return_val_if_fail(count > 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Compiled program to return. */
+    CCLProgram * prg = NULL;
+    /* Key of compiled program. */
+    GChecksum * checksum;
+    gchar * key = NULL;
+    /* Header source. */
+    const char * hdr_src;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Determine key of compiled program. Each field is hashed with its
+     * terminating null character, so that consecutive fields can't be
+     * confused. */
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    for (cl_uint i = 0; i < count; ++i)
+        g_checksum_update(checksum,
+            (const guchar *) strings[i], strlen(strings[i]) + 1);
+    g_checksum_update(checksum, (const guchar *) "", 1);
+    if (options != NULL)
+        g_checksum_update(
+            checksum, (const guchar *) options, strlen(options) + 1);
+    g_checksum_update(checksum, (const guchar *) "", 1);
+    for (cl_uint i = 0; i < num_input_headers; ++i) {
+        hdr_src = ccl_program_get_info_array(
+            prg_input_headers[i], CL_PROGRAM_SOURCE, char, &err_internal);
+        if (err_internal != NULL) g_checksum_free(checksum);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        g_checksum_update(checksum, (const guchar *) header_include_names[i],
+            strlen(header_include_names[i]) + 1);
+        g_checksum_update(
+            checksum, (const guchar *) hdr_src, strlen(hdr_src) + 1);
+    }
+    key = g_strdup(g_checksum_get_string(checksum));
+    g_checksum_free(checksum);
+
+    /* If program was already compiled in this context, we're done. */
+    prg = ccl_context_get_compiled_program(ctx, key);
+    if (prg != NULL) goto finish;
+
+    /* Otherwise, compile it. */
+    prg = ccl_program_new_from_sources(
+        ctx, count, strings, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    ccl_program_compile(prg, 0, NULL, options, num_input_headers,
+        prg_input_headers, header_include_names, NULL, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Keep compiled program in context cache. */
+    prg = ccl_context_add_compiled_program(ctx, key, prg);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release program, if created. */
+    if (prg != NULL) ccl_program_destroy(prg);
+    prg = NULL;
+
+finish:
+
+    /* Free key. */
+    g_free(key);
+
+    /* Return compiled program. */
+    return prg;
+}
+
 /**
  * Link a set of compiled programs and create an executable program wrapper.
  * The return program wrapper must be freed with ::ccl_program_destroy(). This
@@ -1491,6 +2724,363 @@ finish:
     return krnl;
 }
 
+/**
+ * @internal
+ *
+ * @brief Query and cache the argument and work group information of a
+ * program kernel, so that it is readily available when the kernel is
+ * used.
+ *
+ * @private @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] krnl A kernel of the program.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_program_prepare_kernel(
+    CCLProgram * prg, CCLKernel * krnl, CCLErr ** err) {
+
+    /* Number of program devices. */
+    cl_uint num_devs;
+    /* Current device. */
+    CCLDevice * dev;
+    /* Function return status. */
+    cl_bool ret_status;
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
+
+#ifdef CL_VERSION_1_2
+
+    /* Argument information parameters to cache. */
+    static const cl_kernel_arg_info arg_params[] = {
+        CL_KERNEL_ARG_ADDRESS_QUALIFIER, CL_KERNEL_ARG_ACCESS_QUALIFIER,
+        CL_KERNEL_ARG_TYPE_NAME, CL_KERNEL_ARG_TYPE_QUALIFIER,
+        CL_KERNEL_ARG_NAME };
+    /* Number of kernel arguments. */
+    cl_uint num_args;
+
+    /* Cache argument information, if the platform supports it. */
+    if (ccl_program_get_opencl_version(prg, NULL) >= 120) {
+
+        num_args = ccl_kernel_get_info_scalar(
+            krnl, CL_KERNEL_NUM_ARGS, cl_uint, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        for (cl_uint i = 0; i < num_args; ++i) {
+            for (guint j = 0; j < G_N_ELEMENTS(arg_params); ++j) {
+
+                ccl_kernel_get_arg_info(
+                    krnl, i, arg_params[j], &err_internal);
+
+                /* Argument information is only available if the program
+                 * was built with the -cl-kernel-arg-info option, so it is
+                 * not an error if it is unavailable. */
+                if ((err_internal != NULL)
+                    && (err_internal->domain == CCL_OCL_ERROR)
+                    && (err_internal->code
+                        == CL_KERNEL_ARG_INFO_NOT_AVAILABLE))
+                {
+                    ccl_err_clear(&err_internal);
+                    i = num_args;
+                    break;
+                }
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            }
+        }
+    }
+
+#endif
+
+    /* Cache work group information for each program device. */
+    num_devs = ccl_program_get_num_devices(prg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    for (cl_uint i = 0; i < num_devs; ++i) {
+
+        dev = ccl_program_get_device(prg, i, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Work size limits, as used for determining work sizes. */
+        ccl_kernel_get_ws_profile(krnl, dev, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Work group size given in the kernel source, if any. */
+        ccl_kernel_get_workgroup_info(
+            krnl, dev, CL_KERNEL_COMPILE_WORK_GROUP_SIZE, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Create the kernel wrapper objects for all kernel functions in a program
+ * at once, so that the kernels returned by ccl_program_get_kernel() and
+ * used by ccl_program_enqueue_kernel() are readily available. This function
+ * should be called after the program is built, e.g. during application
+ * start-up, in order to avoid kernel creation latency on first use.
+ *
+ * Kernels are created with a single clCreateKernelsInProgram() call. Their
+ * argument information (if available) and work group information for each
+ * program device is queried and cached as well.
+ *
+ * Kernel functions which already have a kernel wrapper instance kept by the
+ * program keep it.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object, which must have been built.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_program_prepare_kernels(CCLProgram * prg, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, CL_FALSE);
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, CL_FALSE);
+
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
+    /* OpenCL return status. */
+    cl_int ocl_status;
+    /* Number of kernels in program. */
+    cl_uint num_kernels = 0;
+    /* OpenCL kernel objects. */
+    cl_kernel * kernels = NULL;
+    /* Kernel wrapper objects. */
+    CCLKernel ** krnls = NULL;
+    /* Number of kernel wrappers already handled. */
+    cl_uint num_handled = 0;
+    /* Kernel function name. */
+    char * kernel_name;
+    /* Iterator for the kernels table. */
+    GHashTableIter iter;
+    gpointer krnl;
+    /* Function return status. */
+    cl_bool ret_status;
+
+    /* Determine number of kernels in program. */
+    ocl_status = clCreateKernelsInProgram(
+        ccl_program_unwrap(prg), 0, NULL, &num_kernels);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to get number of kernels in program "
+        "(OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Create all kernels. */
+    if (num_kernels > 0) {
+        kernels = g_slice_alloc(num_kernels * sizeof(cl_kernel));
+        ocl_status = clCreateKernelsInProgram(
+            ccl_program_unwrap(prg), num_kernels, kernels, NULL);
+        ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+            CL_SUCCESS != ocl_status, ocl_status, error_handler,
+            "%s: unable to create kernels in program "
+            "(OpenCL error %d: %s).",
+            CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+        /* Wrap them. */
+        krnls = g_slice_alloc(num_kernels * sizeof(CCLKernel *));
+        for (cl_uint i = 0; i < num_kernels; ++i)
+            krnls[i] = ccl_kernel_new_wrap(kernels[i]);
+    }
+
+    /* If kernels table is not yet initialized, then initialize it. */
+    if (prg->krnls == NULL) {
+        prg->krnls = g_hash_table_new_full(g_str_hash, g_str_equal,
+            NULL, (GDestroyNotify) ccl_kernel_destroy);
+    }
+
+    /* Keep new kernel wrappers in table, using the kernel function name
+     * kept by each kernel wrapper as key. */
+    for (; num_handled < num_kernels; ++num_handled) {
+
+        kernel_name = ccl_kernel_get_info_array(krnls[num_handled],
+            CL_KERNEL_FUNCTION_NAME, char, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        if (g_hash_table_contains(prg->krnls, kernel_name))
+            ccl_kernel_destroy(krnls[num_handled]);
+        else
+            g_hash_table_insert(
+                prg->krnls, kernel_name, krnls[num_handled]);
+    }
+
+    /* Cache information of all kernels in table. */
+    g_hash_table_iter_init(&iter, prg->krnls);
+    while (g_hash_table_iter_next(&iter, NULL, &krnl)) {
+        ccl_program_prepare_kernel(prg, (CCLKernel *) krnl, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+    /* Release kernel wrappers not yet kept in table. */
+    if (krnls != NULL) {
+        for (cl_uint i = num_handled; i < num_kernels; ++i)
+            ccl_kernel_destroy(krnls[i]);
+    }
+
+finish:
+
+    /* Release temporary arrays. */
+    if (kernels != NULL)
+        g_slice_free1(num_kernels * sizeof(cl_kernel), kernels);
+    if (krnls != NULL)
+        g_slice_free1(num_kernels * sizeof(CCLKernel *), krnls);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Get the kernel wrapper object for the given program kernel function which
+ * is exclusive to the calling thread. This function returns the same kernel
+ * wrapper instance for each kernel function name when called from the same
+ * thread, but different instances (and thus different OpenCL kernel objects)
+ * when called from different threads. As such, different threads can set
+ * arguments and enqueue the same kernel function of a shared program without
+ * external locks.
+ *
+ * On OpenCL >= 2.1, instances are cloned with clCloneKernel() from a
+ * template kernel which is created once per kernel function name. Otherwise,
+ * each instance is created with clCreateKernel().
+ *
+ * The returned kernel wrapper object is automatically released when the
+ * program wrapper object which contains it is destroyed; as such, it must not
+ * be externally destroyed with ccl_kernel_destroy(). Instances are kept until
+ * then, even if the thread which requested them terminates.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] kernel_name Name of kernel function.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The kernel wrapper object for the given program kernel function
+ * and the calling thread.
+ * */
+CCL_EXPORT
+CCLKernel * ccl_program_get_thread_kernel(
+    CCLProgram * prg, const char * kernel_name, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, NULL);
+    /* Make sure kernel_name is not NULL. */
+    g_return_val_if_fail(kernel_name != NULL, NULL);
+
+    /* Internal error reporting object. */
+    CCLErr * err_internal = NULL;
+    /* Kernel wrapper object. */
+    CCLKernel * krnl = NULL;
+    /* Per-thread instances of kernel function. */
+    struct ccl_program_thread_kernels * tkrnls = NULL;
+    /* Calling thread. */
+    GThread * thread = g_thread_self();
+
+    g_mutex_lock(&thread_krnls_lock);
+
+    /* If per-thread kernels table is not yet initialized, then
+     * initialize it. */
+    if (prg->thread_krnls == NULL) {
+        prg->thread_krnls = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, ccl_program_thread_kernels_destroy);
+    }
+
+    /* Get per-thread instances of the requested kernel function, creating
+     * the respective table if necessary. */
+    tkrnls = g_hash_table_lookup(prg->thread_krnls, kernel_name);
+    if (tkrnls == NULL) {
+
+        tkrnls = g_slice_new0(struct ccl_program_thread_kernels);
+        tkrnls->krnls = g_hash_table_new_full(g_direct_hash,
+            g_direct_equal, NULL, (GDestroyNotify) ccl_kernel_destroy);
+        g_hash_table_insert(
+            prg->thread_krnls, g_strdup(kernel_name), tkrnls);
+
+#ifdef CL_VERSION_2_1
+
+        /* If platform supports kernel cloning, create template kernel. */
+        if (ccl_program_get_opencl_version(prg, NULL) >= 210) {
+            tkrnls->tmpl = ccl_kernel_new(prg, kernel_name, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        }
+
+#endif
+
+    }
+
+    /* Check if calling thread already has an instance of the kernel. */
+    krnl = g_hash_table_lookup(tkrnls->krnls, thread);
+    if (krnl == NULL) {
+
+        /* If not, clone it from the template or create it. */
+        if (tkrnls->tmpl != NULL)
+            krnl = ccl_kernel_clone(tkrnls->tmpl, &err_internal);
+        else
+            krnl = ccl_kernel_new(prg, kernel_name, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Keep new kernel wrapper in table. */
+        g_hash_table_insert(tkrnls->krnls, thread, krnl);
+
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Remove the per-thread instances entry if it holds no kernels (e.g.
+     * because its template kernel could not be created), so that later
+     * calls do not take it as initialized. */
+    if ((tkrnls != NULL) && (tkrnls->tmpl == NULL)
+            && (g_hash_table_size(tkrnls->krnls) == 0)) {
+        g_hash_table_remove(prg->thread_krnls, kernel_name);
+    }
+
+finish:
+
+    g_mutex_unlock(&thread_krnls_lock);
+
+    /* Return kernel wrapper. */
+    return krnl;
+}
+
 /**
  * Enqueues a program kernel function for execution on a device. This is a
  * utility function which handles one kernel wrapper instance for each kernel
@@ -1640,8 +3230,8 @@ CCLEvent * ccl_program_enqueue_kernel(CCLProgram * prg,
  * command can be executed. The list will be cleared and can be reused by
  * client code.
  * @param[in] args A `NULL`-terminated array of arguments to set.
- * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage* or
- * ::CCLSampler*.
+ * Arguments must be of type ::CCLArg*, ::CCLBuffer*, ::CCLImage*,
+ * ::CCLPipe* or ::CCLSampler*.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
  * @return Event wrapper object that identifies this command.
@@ -1671,93 +3261,102 @@ CCLEvent * ccl_program_enqueue_kernel_v(CCLProgram * prg,
 /**
  * @internal
  *
- * @brief Load the program binaries into the binaries table of the program
- * wrapper object.
+ * @brief Fetch the program binary for a single device. Only the binary for
+ * the given device is copied by the OpenCL implementation.
  *
  * @private @memberof ccl_program
  *
  * @param[in] prg The program wrapper object.
+ * @param[in] device The device for which to fetch the binary.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
+ * @return A new program binary object, which will have size 0 if the
+ * program isn't built for the given device, or `NULL` if an error occurs.
  * */
-static void ccl_program_load_binaries(CCLProgram * prg, CCLErr ** err) {
+static CCLProgramBinary * ccl_program_fetch_binary(
+    CCLProgram * prg, cl_device_id device, CCLErr ** err) {
 
     /* Make sure err is NULL or it is not set. */
-    g_return_if_fail((err) == NULL || *(err) == NULL);
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
 
     /* Make sure prg is not NULL. */
-    g_return_if_fail(prg != NULL);
-
-    /* Make sure binaries table is initialized. */
-    g_return_if_fail(prg->binaries != NULL);
+    g_return_val_if_fail(prg != NULL, NULL);
 
     cl_uint num_devices;
     cl_device_id * devices;
     size_t * binary_sizes;
     CCLWrapperInfo * info;
-    unsigned char ** bins_raw;
+    unsigned char ** bins_raw = NULL;
+    CCLProgramBinary * bin = NULL;
     CCLErr * err_internal = NULL;
     cl_int ocl_status;
-
-    /* Get number of program devices. */
-    info = ccl_program_get_info(prg, CL_PROGRAM_NUM_DEVICES, &err_internal);
-    ccl_if_err_propagate_goto(err, err_internal, error_handler);
-    num_devices = *((cl_uint *) info->value);
+    cl_uint index;
 
     /* Get program devices. */
     info = ccl_program_get_info(prg, CL_PROGRAM_DEVICES, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
     devices = (cl_device_id *) info->value;
+    num_devices = (cl_uint) (info->size / sizeof(cl_device_id));
+
+    /* Find index of given device in program devices. */
+    for (index = 0; index < num_devices; ++index)
+        if (devices[index] == device) break;
+    ccl_if_err_create_goto(*err, CCL_ERROR, index == num_devices,
+        CCL_ERROR_DEVICE_NOT_FOUND, error_handler,
+        "%s: device is not part of program devices.", CCL_STRD);
 
     /* Get binary sizes. */
     info = ccl_program_get_info(prg, CL_PROGRAM_BINARY_SIZES, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
     binary_sizes = (size_t *) info->value;
 
-    /* Allocate memory for binaries. */
+    /* Create binary object, empty if program isn't built for device. */
+    bin = ccl_program_binary_new_empty();
+    if (binary_sizes[index] == 0) goto finish;
+
+    /* Allocate memory for the binary of the given device only, the
+     * OpenCL implementation skips devices with NULL entries. */
     bins_raw = g_slice_alloc0(num_devices * sizeof(unsigned char *));
-    for (guint i = 0; i < num_devices; i++) {
-        if (binary_sizes[i] > 0) {
-            bins_raw[i] = g_malloc(binary_sizes[i]);
-        }
-    }
+    bins_raw[index] = g_malloc(binary_sizes[index]);
+    bin->data = bins_raw[index];
+    bin->size = binary_sizes[index];
 
-    /* Get binaries. */
+    /* Get binary. */
     ocl_status = clGetProgramInfo(ccl_program_unwrap(prg),
         CL_PROGRAM_BINARIES, num_devices * sizeof(unsigned char *),
         bins_raw, NULL);
     ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
         CL_SUCCESS != ocl_status, ocl_status, error_handler,
-        "%s: unable to get binaries from program (OpenCL error %d: %s).",
+        "%s: unable to get binary from program (OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
-    /* Fill binaries table, associating each device with a
-     * CCLProgramBinary* object containing the binary and its size. */
-    for (guint i = 0; i < num_devices; ++i) {
-
-        CCLProgramBinary * bin = ccl_program_binary_new_empty();
-        bin->size = binary_sizes[i];
-        bin->data = bins_raw[i];
-
-        g_hash_table_replace(prg->binaries, devices[i], bin);
-    }
-
-    /* Free memory allocated for binary array. */
-    g_slice_free1(num_devices * sizeof(unsigned char *), bins_raw);
-
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
-    return;
+    goto finish;
 
 error_handler:
 
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
-    return;
+
+    /* Destroy binary object, if created. */
+    if (bin != NULL) ccl_program_binary_destroy(bin);
+    bin = NULL;
+
+finish:
+
+    /* Free memory allocated for binary array. */
+    if (bins_raw != NULL)
+        g_slice_free1(num_devices * sizeof(unsigned char *), bins_raw);
+
+    /* Return binary object. */
+    return bin;
 }
 
 /**
- * Get the program binary object for the specified device.
+ * Get the program binary object for the specified device. Binaries are
+ * fetched from the OpenCL implementation on first request and only for the
+ * requested device, being kept until the program is built again.
  *
  * @public @memberof ccl_program
  *
@@ -1791,36 +3390,19 @@ CCLProgramBinary * ccl_program_get_binary(
         prg->binaries = g_hash_table_new_full(
             g_direct_hash, g_direct_equal, NULL,
             (GDestroyNotify) ccl_program_binary_destroy);
-
-        /* Load binaries. */
-        ccl_program_load_binaries(prg, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
     }
 
-    /* Check if given device exists in the list of program devices. */
-    if (g_hash_table_contains(prg->binaries, ccl_device_unwrap(dev))) {
+    /* Check if binary for given device was already fetched. */
+    binary = g_hash_table_lookup(prg->binaries, ccl_device_unwrap(dev));
 
-        /* It exists, get it. */
-        binary = g_hash_table_lookup(
-            prg->binaries, ccl_device_unwrap(dev));
+    /* If not, fetch it and keep it. */
+    if (binary == NULL) {
 
-        /* If NULL, then perform a new binary fetch on the CL program
-         * object... */
-        ccl_program_load_binaries(prg, &err_internal);
+        binary = ccl_program_fetch_binary(
+            prg, ccl_device_unwrap(dev), &err_internal);
         ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-        /* ...and get it again. If it's NULL it's because binary isn't
-         * compiled for given device. */
-        binary = g_hash_table_lookup(
-            prg->binaries, ccl_device_unwrap(dev));
-
-    } else {
-
-        /* Device does not exist in list of program devices. */
-        ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
-            CCL_ERROR_DEVICE_NOT_FOUND,
-            error_handler, "%s: device is not part of program devices.",
-            CCL_STRD);
+        g_hash_table_insert(prg->binaries, ccl_device_unwrap(dev), binary);
     }
 
     /* If we got here, everything is OK. */
@@ -1834,7 +3416,7 @@ error_handler:
 
 finish:
 
-    /* Return kernel wrapper. */
+    /* Return binary object. */
     return binary;
 }
 
@@ -1900,6 +3482,92 @@ finish:
     return status;
 }
 
+/**
+ * Write the program binary code for a specified device to a file
+ * descriptor. If the binary was not yet fetched with
+ * ::ccl_program_get_binary(), it is fetched into a temporary buffer which is
+ * released after writing, so no copy of the binary is kept by the program
+ * wrapper.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg The program wrapper object.
+ * @param[in] dev The device wrapper object.
+ * @param[in] fd File descriptor open for writing, where to write the
+ * program's binary code. The file descriptor is not closed.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_program_write_binary(
+    CCLProgram * prg, CCLDevice * dev, int fd, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, CL_FALSE);
+    /* Make sure prg is not NULL. */
+    g_return_val_if_fail(prg != NULL, CL_FALSE);
+    /* Make sure dev is not NULL. */
+    g_return_val_if_fail(dev != NULL, CL_FALSE);
+
+    /* Function status. */
+    cl_bool status;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* The binary code object. */
+    CCLProgramBinary * binary = NULL;
+    /* Temporary binary code object, if binary was not yet fetched. */
+    CCLProgramBinary * binary_tmp = NULL;
+    /* Number of bytes written so far. */
+    size_t written = 0;
+
+    /* Use the binary code object for the specified device if already
+     * fetched, otherwise fetch it temporarily. */
+    if (prg->binaries != NULL)
+        binary = g_hash_table_lookup(prg->binaries, ccl_device_unwrap(dev));
+    if (binary == NULL) {
+        binary_tmp = ccl_program_fetch_binary(
+            prg, ccl_device_unwrap(dev), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        binary = binary_tmp;
+    }
+
+    ccl_if_err_create_goto(*err, CCL_ERROR, binary->size == 0,
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: binary for given device has size 0.", CCL_STRD);
+
+    /* Write binary code to file descriptor, handling partial writes. */
+    while (written < binary->size) {
+        gssize n = write(fd, binary->data + written, binary->size - written);
+        if ((n < 0) && (errno == EINTR)) continue;
+        ccl_if_err_create_goto(*err, CCL_ERROR, n <= 0,
+            CCL_ERROR_STREAM_WRITE, error_handler,
+            "%s: unable to write binary to file descriptor (%s).",
+            CCL_STRD, g_strerror(errno));
+        written += (size_t) n;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    status = CL_FALSE;
+
+finish:
+
+    /* Release temporary binary code object. */
+    if (binary_tmp != NULL) ccl_program_binary_destroy(binary_tmp);
+
+    /* Return function status. */
+    return status;
+}
+
 /**
  * Save the program binaries for all associated devices to files, one file per
  * device.
@@ -79,6 +79,21 @@
  * create programs from built-in kernels. This method is only available for
  * platforms which support OpenCL version 1.2 or higher.
  *
+ * Programs can also be created from a portable intermediate language (IL),
+ * such as SPIR-V, with the ::ccl_program_new_from_il() and
+ * ::ccl_program_new_from_il_file() constructors, which wrap the
+ * clCreateProgramWithIL() function and avoid the front-end compilation of
+ * OpenCL C sources. These constructors require OpenCL 2.1 or higher.
+ *
+ * Binaries and IL built offline with the `ccl_embed_kernels()` CMake
+ * function (provided by the `CCLEmbedKernels` CMake module, which runs the
+ * @ref ccl_c "ccl_c" utility at build time) can be embedded in the client
+ * executable as a table of ::CCLProgramEmbedded entries. The
+ * ::ccl_program_new_from_embedded() constructor picks the entries matching
+ * the context devices and builds the program, falling back to IL and then
+ * to the program source if no entry matches or if the embedded binaries
+ * are rejected by the OpenCL implementation, e.g. after a driver update.
+ *
  * Like most _cf4ocl_ wrapper objects, program wrapper objects follow the
  * @ref ug_new_destroy "new/destroy" rule, and should be released with the
  * ::ccl_program_destroy() destructor.
@@ -106,9 +121,14 @@
  *   the specified device.
  * * ::ccl_program_save_binary() - Save the program binary code for a specified
  *   device to a file.
+ * * ::ccl_program_write_binary() - Write the program binary code for a
+ *   specified device to a file descriptor.
  * * ::ccl_program_save_all_binaries() - Save the program binaries for all
  *   associated devices to files, one file per device.
  *
+ * Binaries are fetched lazily, and only for the devices for which they are
+ * requested.
+ *
  * Program build information can be obtained using a specific set of
  * @ref ug_getinfo "info macros":
  *
@@ -116,6 +136,23 @@
  * * ::ccl_program_get_build_info_array()
  * * ::ccl_program_get_build_info()
  *
+ * When using separate compilation, ::ccl_program_compile_cached() returns
+ * compiled program objects cached in the context, so that units shared by
+ * several programs are compiled only once before being linked with
+ * ::ccl_program_link().
+ *
+ * Programs can also be built asynchronously with ::ccl_program_build_async(),
+ * which returns immediately with a ::CCLAsyncBuild* handle. The handle can be
+ * polled with ::ccl_async_build_poll() or waited on with
+ * ::ccl_async_build_wait(), and an optional callback is invoked when the
+ * build completes. This allows several programs to be built concurrently
+ * while the host performs other tasks.
+ *
+ * Kernel variants specialized with compile-time constants (e.g. tile sizes
+ * or data types) can be obtained with ::ccl_program_get_variant(), which
+ * builds each distinct variant of a base program only once, keeping it in
+ * memory and, if enabled, in the @ref CCL_PROGRAM_CACHE "program cache".
+ *
  * For simple programs and kernels, the program wrapper module offers three
  * functions, which can be used after a program is built:
  *
@@ -128,13 +165,19 @@
  *   execution on a device, accepting kernel arguments as `NULL`-terminated
  *   array of parameters.
  *
+ * Kernel wrapper instances are created on first use. In order to avoid kernel
+ * creation latency in the first uses, ::ccl_program_prepare_kernels() creates
+ * the kernel wrapper instances for all kernel functions at once.
+ *
  * Program wrapper objects only keep one kernel wrapper instance per kernel
  * function; as such, for a given kernel function, these methods will always
  * use the same  kernel wrapper instance (and consequently, the same OpenCL
  * kernel object). While this will work for single-threaded host code, it will
  * fail if the same kernel wrapper is invoked from different threads. In such
- * cases, use the @ref CCL_KERNEL_WRAPPER "kernel wrapper module" API for
- * handling kernel wrapper objects.
+ * cases, use ::ccl_program_get_thread_kernel(), which returns a kernel
+ * wrapper instance exclusive to the calling thread, or the
+ * @ref CCL_KERNEL_WRAPPER "kernel wrapper module" API for handling kernel
+ * wrapper objects.
  *
  * The ::CCLProgram* class extends the ::CCLDevContainer* class; as such, it
  * provides methods for handling a list of devices associated with the program:
@@ -187,6 +230,46 @@
  * */
 typedef struct ccl_program_binary CCLProgramBinary;
 
+/**
+ * A program binary or IL embedded in an executable, as generated by the
+ * `ccl_embed_kernels()` CMake function.
+ * */
+typedef struct ccl_program_embedded {
+
+    /**
+     * Name of the device (`CL_DEVICE_NAME`) the binary was built for, or
+     * `NULL` for IL.
+     * */
+    const char * device_name;
+
+    /**
+     * Name of the platform (`CL_PLATFORM_NAME`) the binary was built for,
+     * or `NULL` if any platform matches.
+     * */
+    const char * platform_name;
+
+    /**
+     * Binary or IL data.
+     * */
+    const unsigned char * data;
+
+    /**
+     * Size in bytes of binary or IL data.
+     * */
+    size_t size;
+
+    /**
+     * Whether the data is IL (e.g. SPIR-V) instead of a device binary.
+     * */
+    cl_bool il;
+
+} CCLProgramEmbedded;
+
+/**
+ * Handle of an asynchronous program build.
+ * */
+typedef struct ccl_async_build CCLAsyncBuild;
+
 /**
  * Prototype of callback functions for program build, compile and link.
  *
@@ -198,6 +281,34 @@ typedef struct ccl_program_binary CCLProgramBinary;
 typedef void (CL_CALLBACK * ccl_program_callback)(
     cl_program program, void * user_data);
 
+/**
+ * Prototype of callback functions invoked when an asynchronous program
+ * build completes.
+ *
+ * @public @memberof ccl_program
+ *
+ * @param[in] prg Program wrapper object.
+ * @param[in] success `CL_TRUE` if the program was built successfully for
+ * all devices, `CL_FALSE` otherwise.
+ * @param[in] user_data A pointer to user supplied data.
+ * */
+typedef void (*ccl_async_build_callback)(
+    CCLProgram * prg, cl_bool success, void * user_data);
+
+/**
+ * When are program build logs retrieved from the OpenCL implementation.
+ * */
+typedef enum ccl_program_build_log_mode {
+
+    /** Build logs are retrieved on first request (default). */
+    CCL_PROGRAM_BUILD_LOG_LAZY = 0,
+
+    /** Build logs are retrieved on first request, but only for devices
+     * for which the most recent build failed. */
+    CCL_PROGRAM_BUILD_LOG_ON_FAILURE = 1
+
+} CCLProgramBuildLogMode;
+
 /* *********** */
 /* WRAPPER API */
 /* *********** */
@@ -278,6 +389,33 @@ CCLProgram * ccl_program_new_from_built_in_kernels(CCLContext * ctx,
     cl_uint num_devices, CCLDevice * const * devs, const char * kernel_names,
     CCLErr ** err);
 
+/* ****************** */
+/* CREATE FROM IL API */
+/* ****************** */
+
+/* Create a new program wrapper object from a file containing an
+ * intermediate language (IL), such as SPIR-V. */
+CCL_EXPORT
+CCLProgram * ccl_program_new_from_il_file(
+    CCLContext * ctx, const char * filename, CCLErr ** err);
+
+/* Create a new program wrapper object from an intermediate language (IL),
+ * such as SPIR-V. */
+CCL_EXPORT
+CCLProgram * ccl_program_new_from_il(CCLContext * ctx,
+    const void * il, size_t length, CCLErr ** err);
+
+/* ************************ */
+/* CREATE FROM EMBEDDED API */
+/* ************************ */
+
+/* Create and build a new program wrapper object from embedded binaries or
+ * IL, falling back to source if none matches the context devices. */
+CCL_EXPORT
+CCLProgram * ccl_program_new_from_embedded(CCLContext * ctx,
+    const CCLProgramEmbedded * embedded, cl_uint num_embedded,
+    const char * src, const char * options, CCLErr ** err);
+
 /* ************************ */
 /* BUILD, COMPILE, LINK API */
 /* ************************ */
@@ -296,6 +434,43 @@ cl_bool ccl_program_build_full(CCLProgram * prg,
     cl_uint num_devices, CCLDevice * const * devs, const char * options,
     ccl_program_callback pfn_notify, void * user_data, CCLErr ** err);
 
+/* Start building a program executable asynchronously, returning a
+ * handle which can be polled or waited on. */
+CCL_EXPORT
+CCLAsyncBuild * ccl_program_build_async(CCLProgram * prg,
+    cl_uint num_devices, CCLDevice * const * devs, const char * options,
+    ccl_async_build_callback callback, void * user_data, CCLErr ** err);
+
+/* Check if an asynchronous program build has completed. */
+CCL_EXPORT
+cl_bool ccl_async_build_poll(CCLAsyncBuild * build);
+
+/* Wait for an asynchronous program build to complete. */
+CCL_EXPORT
+cl_bool ccl_async_build_wait(CCLAsyncBuild * build, CCLErr ** err);
+
+/* Destroy an asynchronous program build handle, waiting for the build to
+ * complete if necessary. */
+CCL_EXPORT
+void ccl_async_build_destroy(CCLAsyncBuild * build);
+
+/* Get a variant of a program built with the given compile-time constants,
+ * which are specified as a NULL-terminated list of name/value pairs. */
+CCL_EXPORT
+CCLProgram * ccl_program_get_variant(CCLProgram * prg,
+    const char * options, CCLErr ** err, ...) G_GNUC_NULL_TERMINATED;
+
+/* Get a variant of a program built with the given compile-time constants,
+ * which are specified as a NULL-terminated array of name/value pairs. */
+CCL_EXPORT
+CCLProgram * ccl_program_get_variant_v(CCLProgram * prg,
+    const char * options, const char * const * constants, CCLErr ** err);
+
+/* Set when build logs are retrieved from the OpenCL implementation. */
+CCL_EXPORT
+void ccl_program_set_build_log_mode(
+    CCLProgram * prg, CCLProgramBuildLogMode mode);
+
 /* Get a general build log of most recent build, compile or link, for
  * all devices. */
 CCL_EXPORT
@@ -314,6 +489,14 @@ cl_bool ccl_program_compile(CCLProgram * prg, cl_uint num_devices,
     CCLProgram ** prg_input_headers, const char ** header_include_names,
     ccl_program_callback pfn_notify, void * user_data, CCLErr ** err);
 
+/* Get a compiled program object for the given sources, headers and
+ * options, compiling it only if it is not cached in the context. */
+CCL_EXPORT
+CCLProgram * ccl_program_compile_cached(CCLContext * ctx, cl_uint count,
+    const char ** strings, const char * options, cl_uint num_input_headers,
+    CCLProgram ** prg_input_headers, const char ** header_include_names,
+    CCLErr ** err);
+
 /* Link a set of compiled programs. */
 CCL_EXPORT
 CCLProgram * ccl_program_link(CCLContext * ctx, cl_uint num_devices,
@@ -338,6 +521,17 @@ CCL_EXPORT
 CCLKernel * ccl_program_get_kernel(
     CCLProgram * prg, const char * kernel_name, CCLErr ** err);
 
+/* Create the kernel wrapper objects for all kernel functions in a
+ * program at once. */
+CCL_EXPORT
+cl_bool ccl_program_prepare_kernels(CCLProgram * prg, CCLErr ** err);
+
+/* Get the kernel wrapper object for the given program kernel function
+ * which is exclusive to the calling thread. */
+CCL_EXPORT
+CCLKernel * ccl_program_get_thread_kernel(
+    CCLProgram * prg, const char * kernel_name, CCLErr ** err);
+
 /* Enqueues a program kernel function for execution on a device. */
 CCL_EXPORT
 CCLEvent * ccl_program_enqueue_kernel(CCLProgram * prg,
@@ -368,6 +562,12 @@ CCL_EXPORT
 cl_bool ccl_program_save_binary(
     CCLProgram * prg, CCLDevice * dev, const char * filename, CCLErr ** err);
 
+/* Write the program binary code for a specified device to a file
+ * descriptor. */
+CCL_EXPORT
+cl_bool ccl_program_write_binary(
+    CCLProgram * prg, CCLDevice * dev, int fd, CCLErr ** err);
+
 /* Save the program binaries for all associated devices to files, one
  * file per device. */
 CCL_EXPORT
@@ -441,7 +641,7 @@ CCLDevice * const * ccl_program_get_all_devices(
 #define ccl_program_get_info_scalar(prg, param_name, param_type, err) \
     (param_name == CL_PROGRAM_BINARIES) \
     ? (param_type) 0 \
-    : *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) prg, \
+    : *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) prg, \
         NULL, param_name, sizeof(param_type), \
         CCL_INFO_PROGRAM, CL_FALSE, err))
 
@@ -513,7 +713,7 @@ CCLDevice * const * ccl_program_get_all_devices(
  * */
 #define ccl_program_get_build_info_scalar(prg, dev, param_name, \
     param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) prg, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) prg, \
         (CCLWrapper *) dev, param_name, sizeof(param_type), \
         CCL_INFO_PROGRAM_BUILD, CL_FALSE, err))
 
@@ -27,7 +27,18 @@
 
 #include "ccl_queue_wrapper.h"
 #include "_ccl_abstract_wrapper.h"
+#include "_ccl_queue_wrapper.h"
+#include "_ccl_event_wrapper.h"
 #include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
+
+/* Initial size of the ring buffer of events associated with a command
+ * queue. Must be a power of two. */
+#define CCL_QUEUE_EVTS_INIT_SIZE 16
+
+/* Default maximum number of commands in flight in a low priority queue
+ * while high priority queues on the same device have pending commands. */
+#define CCL_QUEUE_BACKGROUND_DEPTH 2
 
 /**
  * Command queue wrapper class.
@@ -55,18 +66,333 @@ struct ccl_queue {
     CCLDevice * dev;
 
     /**
-     * Events associated with the command queue.
+     * Ring buffer of events associated with the command queue, ordered from
+     * oldest to newest.
+     * @private
+     * */
+    CCLEvent ** evts;
+
+    /**
+     * Size of the ring buffer of events (zero or a power of two).
+     * @private
+     * */
+    cl_uint evts_size;
+
+    /**
+     * Index of the oldest event in the ring buffer.
+     * @private
+     * */
+    cl_uint evts_head;
+
+    /**
+     * Number of events in the ring buffer.
+     * @private
+     * */
+    cl_uint evts_num;
+
+    /**
+     * Number of events after which completed events are automatically
+     * released, or zero if events are only released by ccl_queue_gc().
+     * @private
+     * */
+    cl_uint evts_cap;
+
+    /**
+     * Number of events at which the next automatic release of terminated
+     * events is attempted.
+     * @private
+     * */
+    cl_uint evts_reclaim_at;
+
+    /**
+     * Is the queue in event-less mode?
+     * @private
+     * */
+    cl_bool eventless;
+
+    /**
+     * Are the wait lists of enqueued commands recorded in the respective
+     * events?
+     * @private
+     * */
+    cl_bool record_deps;
+
+    /**
+     * Number of profile objects to which the queue is attached.
+     * @private
+     * */
+    cl_uint prof_refs;
+
+    /**
+     * Event iterator, i.e. position of next event relative to the oldest
+     * one.
+     * @private
+     * */
+    cl_uint evt_iter;
+
+    /**
+     * Number of enqueued commands after which the queue is automatically
+     * flushed, zero if disabled.
+     * @private
+     * */
+    cl_uint flush_cmds;
+
+    /**
+     * Time in microseconds since the first unflushed command after which
+     * the queue is automatically flushed, zero if disabled.
+     * @private
+     * */
+    cl_ulong flush_usec;
+
+    /**
+     * Number of commands enqueued since the queue was last flushed.
+     * @private
+     * */
+    cl_uint num_unflushed;
+
+    /**
+     * Monotonic time at which the first unflushed command was enqueued.
+     * @private
+     * */
+    gint64 unflushed_since;
+
+    /**
+     * Are redundant barriers and markers elided?
+     * @private
+     * */
+    cl_bool elide_sync;
+
+    /**
+     * Event of the last command enqueued in the queue, or `NULL` if it is
+     * not known, e.g. if the command was enqueued in event-less mode or
+     * its event was released.
+     * @private
+     * */
+    CCLEvent * last_evt;
+
+    /**
+     * Was the last command a barrier without a wait list?
+     * @private
+     * */
+    cl_bool last_full_barrier;
+
+    /**
+     * Is the queue an in-order queue? Positive if so, negative if not,
+     * and zero if not yet determined.
+     * @private
+     * */
+    cl_int in_order;
+
+    /**
+     * Number of barriers and markers elided.
+     * @private
+     * */
+    cl_uint num_elided;
+
+    /**
+     * Priority hint emulated by the submission scheduler
+     * (`CL_QUEUE_PRIORITY_HIGH_KHR` or `CL_QUEUE_PRIORITY_LOW_KHR`), or zero
+     * if the queue is not scheduled.
+     * @private
+     * */
+    cl_uint sched_priority;
+
+    /**
+     * OpenCL event of the last command enqueued in a scheduled high
+     * priority queue, retained by the queue.
+     * @private
+     * */
+    cl_event sched_last;
+
+    /**
+     * OpenCL events of the commands possibly in flight in a scheduled low
+     * priority queue, retained by the queue, from oldest to newest.
      * @private
      * */
-    GHashTable * evts;
+    GQueue sched_evts;
 
     /**
-     * Event iterator.
+     * Maximum number of commands in flight in a scheduled low priority
+     * queue while high priority queues have pending commands.
      * @private
      * */
-    GHashTableIter evt_iter;
+    cl_uint sched_depth;
 };
 
+/* Scheduled high priority queues. */
+static GSList * ccl_queue_sched_high = NULL;
+
+/* Lock protecting the scheduled high priority queues and their last
+ * events. */
+static GMutex ccl_queue_sched_lock;
+
+/**
+ * @internal
+ *
+ * @brief Get the event in the given position of the ring buffer of events,
+ * relative to the oldest event.
+ * */
+#define ccl_queue_evt_at(cq, i) \
+    (cq)->evts[((cq)->evts_head + (i)) & ((cq)->evts_size - 1)]
+
+/**
+ * @internal
+ *
+ * @brief Release all events in the ring buffer of events.
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] cq A ::CCLQueue wrapper object.
+ * */
+static void ccl_queue_evts_release(CCLQueue * cq) {
+
+    for (cl_uint i = 0; i < cq->evts_num; ++i)
+        ccl_event_destroy(ccl_queue_evt_at(cq, i));
+    cq->evts_num = 0;
+    cq->last_evt = NULL;
+    cq->evts_head = 0;
+    cq->evt_iter = 0;
+}
+
+/**
+ * @internal
+ *
+ * @brief Double the size of the ring buffer of events, keeping their order.
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] cq A ::CCLQueue wrapper object.
+ * */
+static void ccl_queue_evts_grow(CCLQueue * cq) {
+
+    /* New size of ring buffer. */
+    cl_uint size = (cq->evts_size == 0)
+        ? CCL_QUEUE_EVTS_INIT_SIZE : 2 * cq->evts_size;
+
+    /* New ring buffer. */
+    CCLEvent ** evts = g_slice_alloc(size * sizeof(CCLEvent *));
+
+    /* Copy events in order, starting at index zero. */
+    for (cl_uint i = 0; i < cq->evts_num; ++i)
+        evts[i] = ccl_queue_evt_at(cq, i);
+
+    /* Replace existing ring buffer. */
+    if (cq->evts != NULL)
+        g_slice_free1(cq->evts_size * sizeof(CCLEvent *), cq->evts);
+    cq->evts = evts;
+    cq->evts_size = size;
+    cq->evts_head = 0;
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine if an event associated with a queue can be released,
+ * i.e., if it has terminated and, optionally, if it is not referenced by
+ * client code.
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] evt Event wrapper object.
+ * @param[in] unreferenced If `CL_TRUE`, the event can only be released if
+ * it is not referenced by client code.
+ * @return `CL_TRUE` if the event can be released, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_queue_evt_is_reclaimable(
+    CCLEvent * evt, cl_bool unreferenced) {
+
+    /* Event execution status. */
+    cl_int * exec_status;
+
+    /* Query status. */
+    cl_int status;
+
+    /* Is the event referenced elsewhere? */
+    if (unreferenced && (ccl_wrapper_ref_count((CCLWrapper *) evt) > 1))
+        return CL_FALSE;
+
+    /* Has the event terminated, either successfully or not? Failed queries
+     * are frequent while polling and are simply reported as not
+     * reclaimable, so don't create error objects for them. */
+    exec_status = ccl_wrapper_get_info_scalar_status((CCLWrapper *) evt,
+        NULL, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int),
+        CCL_INFO_EVENT, CL_FALSE, &status);
+    if (status != CL_SUCCESS) return CL_FALSE;
+    return *exec_status <= CL_COMPLETE ? CL_TRUE : CL_FALSE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Release terminated events, starting from the oldest one and
+ * keeping the order of the remaining events.
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] cq A ::CCLQueue wrapper object.
+ * @param[in] unreferenced If `CL_TRUE`, only events not referenced by
+ * client code are released.
+ * @param[in] max_evts Maximum number of events to examine, or zero for no
+ * limit.
+ * @param[in] deadline Monotonic time, in microseconds, after which no more
+ * events are examined, or zero for no limit.
+ * @param[in] drain_fn Function called for each reclaimable event, which
+ * returns `CL_TRUE` if the event can actually be released, or `NULL`.
+ * @param[in] data Data passed to `drain_fn`.
+ * @return Number of released events.
+ * */
+static cl_uint ccl_queue_evts_reclaim(CCLQueue * cq, cl_bool unreferenced,
+    cl_uint max_evts, gint64 deadline, ccl_queue_drain_fn drain_fn,
+    void * data) {
+
+    /* Number of kept events. */
+    cl_uint num_kept = 0;
+    /* Number of events before reclaiming. */
+    cl_uint num = cq->evts_num;
+    /* Number of examined events. */
+    cl_uint num_seen;
+
+    /* Compact the ring buffer, releasing reclaimable events, until the
+     * budget is exhausted. */
+    for (num_seen = 0; num_seen < num; ++num_seen) {
+
+        CCLEvent * evt;
+
+        if ((max_evts > 0) && (num_seen >= max_evts)) break;
+        if ((deadline > 0) && (g_get_monotonic_time() >= deadline)) break;
+
+        evt = ccl_queue_evt_at(cq, num_seen);
+        if (ccl_queue_evt_is_reclaimable(evt, unreferenced)
+            && ((drain_fn == NULL) || drain_fn(evt, data))) {
+            if (evt == cq->last_evt) cq->last_evt = NULL;
+            ccl_event_destroy(evt);
+        } else {
+            ccl_queue_evt_at(cq, num_kept) = evt;
+            num_kept++;
+        }
+    }
+
+    if (num_kept == 0) {
+
+        /* All examined events were released, just advance the oldest
+         * event position. */
+        cq->evts_head = (cq->evts_head + num_seen) & (cq->evts_size - 1);
+        num_kept = num - num_seen;
+
+    } else {
+
+        /* Move events which were not examined next to the kept ones. */
+        for (cl_uint i = num_seen; i < num; ++i) {
+            ccl_queue_evt_at(cq, num_kept) = ccl_queue_evt_at(cq, i);
+            num_kept++;
+        }
+    }
+    cq->evts_num = num_kept;
+
+    /* Return number of released events. */
+    return num - num_kept;
+}
+
 /**
  * @internal
  *
@@ -89,9 +415,192 @@ static void ccl_queue_release_fields(CCLQueue * cq) {
      if (cq->dev != NULL)
         ccl_device_unref(cq->dev);
 
-    /* Destroy the events table. */
+    /* Destroy the events ring buffer. */
     if (cq->evts != NULL) {
-        g_hash_table_destroy(cq->evts);
+        ccl_queue_evts_release(cq);
+        g_slice_free1(cq->evts_size * sizeof(CCLEvent *), cq->evts);
+    }
+
+    /* Remove queue from the submission scheduler. */
+    if (cq->sched_priority == CL_QUEUE_PRIORITY_HIGH_KHR) {
+        g_mutex_lock(&ccl_queue_sched_lock);
+        ccl_queue_sched_high = g_slist_remove(ccl_queue_sched_high, cq);
+        g_mutex_unlock(&ccl_queue_sched_lock);
+        if (cq->sched_last != NULL) clReleaseEvent(cq->sched_last);
+    }
+    while (!g_queue_is_empty(&cq->sched_evts))
+        clReleaseEvent((cl_event) g_queue_pop_head(&cq->sched_evts));
+}
+
+/**
+ * @internal
+ *
+ * @brief Account for a command enqueued in the command queue, flushing the
+ * queue if required by its flush policy.
+ *
+ * @param[in] cq The command queue wrapper object.
+ * */
+static void ccl_queue_count_unflushed(CCLQueue * cq) {
+
+    /* Current time. */
+    gint64 now;
+
+    /* Nothing to do if there is no flush policy. */
+    if ((cq->flush_cmds == 0) && (cq->flush_usec == 0)) return;
+
+    /* Count command, flushing when the command or the time limit is
+     * reached. */
+    now = cq->flush_usec > 0 ? g_get_monotonic_time() : 0;
+    if (cq->num_unflushed == 0) cq->unflushed_since = now;
+    cq->num_unflushed++;
+    if (((cq->flush_cmds > 0) && (cq->num_unflushed >= cq->flush_cmds))
+        || ((cq->flush_usec > 0)
+            && ((cl_ulong) (now - cq->unflushed_since) >= cq->flush_usec))) {
+
+        /* Errors are reported by the next explicit flush, finish or
+         * blocking command. */
+        clFlush(ccl_queue_unwrap(cq));
+        cq->num_unflushed = 0;
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Determine if a barrier or marker about to be enqueued in the
+ * command queue is redundant, in which case the event of the previous
+ * command can be returned instead.
+ *
+ * A barrier or marker without a wait list is redundant if the previous
+ * command was a barrier without a wait list, or if the queue is an
+ * in-order queue, since in both cases the previous command only completes
+ * after all commands enqueued before it.
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] evt_wait_lst Wait list of the barrier or marker.
+ * @return The event wrapper of the previous command if the barrier or
+ * marker is redundant, or `NULL` otherwise.
+ * */
+static CCLEvent * ccl_queue_elide_sync(
+    CCLQueue * cq, CCLEventWaitList * evt_wait_lst) {
+
+    /* Command queue properties. */
+    cl_command_queue_properties props;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Nothing to elide if disabled, if the previous command is unknown or
+     * if there are events to wait on. */
+    if ((!cq->elide_sync) || (cq->last_evt == NULL)
+        || (ccl_event_wait_list_get_num_events(evt_wait_lst) > 0))
+        return NULL;
+
+    /* Determine if queue is in-order, assuming it is not if the queue
+     * properties can't be obtained. */
+    if (cq->in_order == 0) {
+        props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+            cl_command_queue_properties, &err_internal);
+        cq->in_order = ((err_internal == NULL)
+            && !(props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE)) ? 1 : -1;
+        ccl_err_clear(&err_internal);
+    }
+
+    /* Check if previous command already acts as a barrier. */
+    if ((!cq->last_full_barrier) && (cq->in_order < 0)) return NULL;
+
+    /* Barrier or marker is redundant. */
+    cq->num_elided++;
+    return cq->last_evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Check if any scheduled high priority queue on the same device as
+ * the given queue has pending commands.
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @return `CL_TRUE` if a high priority queue has pending commands,
+ * `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_queue_sched_high_pending(CCLQueue * cq) {
+
+    /* Execution status of last command of high priority queue. */
+    cl_int exec_status;
+    /* Does a high priority queue have pending commands? */
+    cl_bool pending = CL_FALSE;
+
+    g_mutex_lock(&ccl_queue_sched_lock);
+    for (GSList * node = ccl_queue_sched_high;
+        (node != NULL) && !pending; node = node->next) {
+
+        CCLQueue * cq_high = (CCLQueue *) node->data;
+
+        /* Commands of an in-order queue complete in order, so the queue
+         * is idle once its last command completes. */
+        if ((cq_high->dev != cq->dev) || (cq_high->sched_last == NULL))
+            continue;
+        if ((clGetEventInfo(cq_high->sched_last,
+            CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int),
+            &exec_status, NULL) == CL_SUCCESS)
+            && (exec_status > CL_COMPLETE))
+            pending = CL_TRUE;
+    }
+    g_mutex_unlock(&ccl_queue_sched_lock);
+
+    return pending;
+}
+
+/**
+ * @internal
+ *
+ * @brief Account for a command enqueued in a queue whose priority hint is
+ * emulated by the submission scheduler.
+ *
+ * The last command of high priority queues is recorded. For low priority
+ * queues, if a high priority queue on the same device has pending commands,
+ * the host waits until at most `sched_depth` commands of the queue are in
+ * flight.
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] event OpenCL event of the enqueued command.
+ * */
+static void ccl_queue_sched_submit(CCLQueue * cq, cl_event event) {
+
+    /* Oldest command possibly in flight. */
+    cl_event oldest;
+    /* Has the queue been flushed? */
+    cl_bool flushed = CL_FALSE;
+
+    clRetainEvent(event);
+
+    if (cq->sched_priority == CL_QUEUE_PRIORITY_HIGH_KHR) {
+
+        /* Keep the last command of a high priority queue. */
+        g_mutex_lock(&ccl_queue_sched_lock);
+        oldest = cq->sched_last;
+        cq->sched_last = event;
+        g_mutex_unlock(&ccl_queue_sched_lock);
+        if (oldest != NULL) clReleaseEvent(oldest);
+
+    } else {
+
+        /* Keep the last sched_depth commands of a low priority queue,
+         * waiting for the older ones while high priority work is
+         * pending. */
+        g_queue_push_tail(&cq->sched_evts, event);
+        while (g_queue_get_length(&cq->sched_evts) > cq->sched_depth) {
+            oldest = (cl_event) g_queue_pop_head(&cq->sched_evts);
+            if (ccl_queue_sched_high_pending(cq)) {
+                if (!flushed) {
+                    clFlush(ccl_queue_unwrap(cq));
+                    cq->num_unflushed = 0;
+                    flushed = CL_TRUE;
+                }
+                clWaitForEvents(1, &oldest);
+            }
+            clReleaseEvent(oldest);
+        }
     }
 }
 
@@ -138,6 +647,13 @@ CCLQueue * ccl_queue_new_wrap(cl_command_queue command_queue) {
  * OpenCL <= 1.2, a warning will be logged, and the queue will be created with
  * OpenCL <= 1.2 properties only.
  *
+ * The `CL_QUEUE_PRIORITY_KHR` and `CL_QUEUE_THROTTLE_KHR` properties are
+ * passed to OpenCL only if the device supports the `cl_khr_priority_hints`
+ * and `cl_khr_throttle_hints` extensions, respectively. Otherwise they are
+ * dropped without a warning and, for high and low priorities, the priority
+ * hint is emulated by the internal submission scheduler (see
+ * ::ccl_queue_set_background_depth()).
+ *
  * @public @memberof ccl_queue
  *
  * @param[in] ctx Context wrapper object.
@@ -169,6 +685,14 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
     cl_command_queue_properties properties = 0;
     /* Are there any OpenCL >= 2.0 properties? */
     cl_bool prop_other = CL_FALSE;
+    /* Priority and throttle hints, zero if not specified. */
+    cl_queue_properties priority = 0, throttle = 0;
+    /* Are the priority and throttle hints supported by the device? */
+    cl_bool priority_native = CL_FALSE, throttle_native = CL_FALSE;
+    /* Properties passed to OpenCL, if hints are dropped. */
+    cl_queue_properties * prop_native = NULL;
+    /* Device capabilities. */
+    const CCLDeviceCaps * caps;
 
     /* Extract <= 1.2 properties and initialize flag indicating if any >= 2.0
      * properties are passed. */
@@ -184,6 +708,16 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
                  * OpenCL <= 1.2. */
                 properties = prop_full[i + 1];
 
+            } else if (prop_full[i] == CL_QUEUE_PRIORITY_KHR) {
+
+                /* Priority hint, handled below. */
+                priority = prop_full[i + 1];
+
+            } else if (prop_full[i] == CL_QUEUE_THROTTLE_KHR) {
+
+                /* Throttle hint, handled below. */
+                throttle = prop_full[i + 1];
+
             } else {
 
                 /* No, current property name is valid only for OpenCL >= 2.0. */
@@ -209,6 +743,16 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
         ccl_if_err_propagate_goto(err, err_internal, error_handler);
     }
 
+    /* Check if the device supports the given hints. */
+    if ((priority != 0) || (throttle != 0)) {
+        caps = ccl_device_get_caps(dev, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        priority_native = (priority != 0)
+            && (caps->extensions & CCL_DEVICE_EXT_KHR_PRIORITY_HINTS);
+        throttle_native = (throttle != 0)
+            && (caps->extensions & CCL_DEVICE_EXT_KHR_THROTTLE_HINTS);
+    }
+
 #ifdef CL_VERSION_2_0
 
     /* OpenCL platform version of the given context. */
@@ -221,16 +765,36 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
     /* Create and keep the OpenCL command queue object. */
     if (platf_ver >= 200) {
 
+        /* Drop hints not supported by the device. */
+        if (((priority != 0) && !priority_native)
+            || ((throttle != 0) && !throttle_native)) {
+
+            cl_uint n = 0, j = 0;
+            while (prop_full[n] != 0) n += 2;
+            prop_native = g_new(cl_queue_properties, n + 1);
+            for (cl_uint i = 0; i < n; i += 2) {
+                if (((prop_full[i] == CL_QUEUE_PRIORITY_KHR)
+                        && !priority_native)
+                    || ((prop_full[i] == CL_QUEUE_THROTTLE_KHR)
+                        && !throttle_native))
+                    continue;
+                prop_native[j++] = prop_full[i];
+                prop_native[j++] = prop_full[i + 1];
+            }
+            prop_native[j] = 0;
+        }
+
         /* Platform is OpenCL >= 2.0 and supports
          * clCreateCommandQueueWithProperties(). */
         queue = clCreateCommandQueueWithProperties(
             ccl_context_unwrap(ctx), ccl_device_unwrap(dev),
-            prop_full, &ocl_status);
+            prop_native != NULL ? prop_native : prop_full, &ocl_status);
 
     } else {
 
         /* Platform is OpenCL <= 1.2 and we should use
-         * clCreateCommandQueue(). */
+         * clCreateCommandQueue(), so hints can't be passed to OpenCL. */
+        priority_native = CL_FALSE;
 
         /* Where any OpenCL >= 2.0 property names or values specified? */
         if (prop_other) {
@@ -252,6 +816,9 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
 
 #else
 
+    /* Hints can't be passed to clCreateCommandQueue(). */
+    priority_native = CL_FALSE;
+
     /* Were any OpenCL >= 2.0 property names or values specified? */
     if (prop_other) {
 
@@ -285,6 +852,19 @@ CCLQueue * ccl_queue_new_full(CCLContext * ctx, CCLDevice * dev,
     cq->dev = dev;
     ccl_device_ref(dev);
 
+    /* Emulate high and low priority hints not supported by the device. */
+    cq->sched_depth = CCL_QUEUE_BACKGROUND_DEPTH;
+    if (!priority_native && ((priority == CL_QUEUE_PRIORITY_HIGH_KHR)
+        || (priority == CL_QUEUE_PRIORITY_LOW_KHR))) {
+
+        cq->sched_priority = (cl_uint) priority;
+        if (priority == CL_QUEUE_PRIORITY_HIGH_KHR) {
+            g_mutex_lock(&ccl_queue_sched_lock);
+            ccl_queue_sched_high = g_slist_prepend(ccl_queue_sched_high, cq);
+            g_mutex_unlock(&ccl_queue_sched_lock);
+        }
+    }
+
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
@@ -295,6 +875,9 @@ error_handler:
 
 finish:
 
+    /* Release properties passed to OpenCL, if any. */
+    g_free(prop_native);
+
     /* Return the new command queue wrapper object. */
     return cq;
 }
@@ -333,213 +916,899 @@ CCLQueue * ccl_queue_new(CCLContext * ctx, CCLDevice * dev,
 }
 
 /**
- * Decrements the reference count of the command queue wrapper object. If it
- * reaches 0, the command queue wrapper object is destroyed.
+ * Create a new on-device command queue wrapper object, to which kernels
+ * can enqueue child kernels (OpenCL >= 2.0 device-side enqueue).
+ *
+ * On-device queues are always out-of-order. Besides validating that the
+ * device supports on-device queues, this constructor checks the requested
+ * properties against `CL_DEVICE_QUEUE_ON_DEVICE_PROPERTIES` and the queue
+ * size against `CL_DEVICE_QUEUE_ON_DEVICE_MAX_SIZE`, reporting errors
+ * which OpenCL would otherwise only signal with a generic error code. A
+ * size of zero selects `CL_DEVICE_QUEUE_ON_DEVICE_PREFERRED_SIZE`.
+ *
+ * If `CL_QUEUE_ON_DEVICE_DEFAULT` is given, the queue becomes the default
+ * device queue, returned by `get_default_queue()` in kernels. Only one
+ * default device queue can exist per device and context; with OpenCL >=
+ * 2.1 it can be replaced with ::ccl_queue_set_default_device().
+ *
+ * On-device queues are not used to enqueue commands from the host, so no
+ * event wrappers are associated with them. Commands they execute are
+ * profiled through the parent command, whose ::CCLEventTimings::complete
+ * instant marks the completion of all its child commands. Programs with
+ * kernels which enqueue child kernels must be built with the
+ * ::CCL_QUEUE_DEVICE_ENQUEUE_BUILD_OPTS options.
  *
  * @public @memberof ccl_queue
+ * @note Requires OpenCL >= 2.0
  *
- * @param[in] cq The command queue wrapper object.
+ * @param[in] ctx Context wrapper object.
+ * @param[in] dev Device wrapper object, must be associated with `ctx`, or
+ * `NULL` to use the first device in the context.
+ * @param[in] properties Bitfield of additional properties:
+ * `CL_QUEUE_PROFILING_ENABLE` and `CL_QUEUE_ON_DEVICE_DEFAULT`.
+ * @param[in] size Size of the queue in bytes, or zero for the device's
+ * preferred size.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The ::CCLQueue wrapper for the on-device queue, or `NULL` if an
+ * error occurs.
  * */
 CCL_EXPORT
-void ccl_queue_destroy(CCLQueue * cq) {
+CCLQueue * ccl_queue_new_device(CCLContext * ctx, CCLDevice * dev,
+    cl_command_queue_properties properties, cl_uint size, CCLErr ** err) {
 
-    ccl_wrapper_unref((CCLWrapper *) cq, sizeof(CCLQueue),
-        (ccl_wrapper_release_fields) ccl_queue_release_fields,
-        (ccl_wrapper_release_cl_object) clReleaseCommandQueue, NULL);
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* The command queue wrapper object. */
+    CCLQueue * cq = NULL;
+
+#ifndef CL_VERSION_2_0
+
+    CCL_UNUSED(dev);
+    CCL_UNUSED(properties);
+    CCL_UNUSED(size);
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.0, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: On-device queues require cf4ocl to be deployed with support "
+        "for OpenCL version 2.0 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+    /* OpenCL version of the device. */
+    cl_uint ocl_ver;
+    /* On-device queue properties supported by the device. */
+    cl_command_queue_properties dev_props;
+    /* Maximum queue size. */
+    cl_uint max_size;
+
+    /* If dev is NULL, get first device in context. */
+    if (dev == NULL) {
+        dev = ccl_context_get_device(ctx, 0, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Check that only supported properties were requested. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (properties & ~(CL_QUEUE_PROFILING_ENABLE
+            | CL_QUEUE_ON_DEVICE_DEFAULT)) != 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: On-device queues only accept the CL_QUEUE_PROFILING_ENABLE "
+        "and CL_QUEUE_ON_DEVICE_DEFAULT properties.", CCL_STRD);
+
+    /* Check that the device is OpenCL >= 2.0. */
+    ocl_ver = ccl_device_get_opencl_version(dev, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 200,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: On-device queues require OpenCL version 2.0 or newer.",
+        CCL_STRD);
+
+    /* Check that the device supports on-device queues with the requested
+     * properties (OpenCL >= 3.0 devices may not support them at all). */
+    dev_props = ccl_device_get_info_scalar(dev,
+        CL_DEVICE_QUEUE_ON_DEVICE_PROPERTIES, cl_command_queue_properties,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        !(dev_props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE),
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Device does not support on-device queues.", CCL_STRD);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (properties & CL_QUEUE_PROFILING_ENABLE)
+            && !(dev_props & CL_QUEUE_PROFILING_ENABLE),
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Device does not support profiling of on-device queues.",
+        CCL_STRD);
+
+    /* Determine and check queue size. */
+    if (size == 0) {
+        size = ccl_device_get_info_scalar(dev,
+            CL_DEVICE_QUEUE_ON_DEVICE_PREFERRED_SIZE, cl_uint,
+            &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+    max_size = ccl_device_get_info_scalar(dev,
+        CL_DEVICE_QUEUE_ON_DEVICE_MAX_SIZE, cl_uint, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, size > max_size,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: On-device queue size (%u bytes) exceeds the device maximum "
+        "(%u bytes).", CCL_STRD, size, max_size);
+
+    /* Create the queue. */
+    const cl_queue_properties prop_full[] = {
+        CL_QUEUE_PROPERTIES, CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE
+            | CL_QUEUE_ON_DEVICE | properties,
+        CL_QUEUE_SIZE, size, 0 };
+    cq = ccl_queue_new_full(ctx, dev, prop_full, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return the new command queue wrapper object. */
+    return cq;
+}
+
+/**
+ * Replace the default on-device queue of a device. This function wraps
+ * the clSetDefaultDeviceCommandQueue() OpenCL function.
+ *
+ * @public @memberof ccl_queue
+ * @note Requires OpenCL >= 2.1
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] dev Device wrapper object, must be associated with `ctx`.
+ * @param[in] cq On-device queue created with ::ccl_queue_new_device() for
+ * `ctx` and `dev`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if operation is successful, or `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_queue_set_default_device(CCLContext * ctx, CCLDevice * dev,
+    CCLQueue * cq, CCLErr ** err) {
+
+    /* Make sure ctx, dev and cq are not NULL. */
+    g_return_val_if_fail(ctx != NULL, CL_FALSE);
+    g_return_val_if_fail(dev != NULL, CL_FALSE);
+    g_return_val_if_fail(cq != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+#ifndef CL_VERSION_2_1
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.1, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Setting the default device queue requires cf4ocl to be "
+        "deployed with support for OpenCL version 2.1 or newer.",
+        CCL_STRD);
+
+#else
+
+    /* OpenCL status flag. */
+    cl_int ocl_status;
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check that platform is >= OpenCL 2.1. */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < 210,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: Setting the default device queue requires OpenCL version 2.1 "
+        "or newer.", CCL_STRD);
+
+    /* Set default device queue. */
+    ocl_status = clSetDefaultDeviceCommandQueue(ccl_context_unwrap(ctx),
+        ccl_device_unwrap(dev), ccl_queue_unwrap(cq));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to set default device queue (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * Decrements the reference count of the command queue wrapper object. If it
+ * reaches 0, the command queue wrapper object is destroyed.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * */
+CCL_EXPORT
+void ccl_queue_destroy(CCLQueue * cq) {
+
+    ccl_wrapper_unref((CCLWrapper *) cq, sizeof(CCLQueue),
+        (ccl_wrapper_release_fields) ccl_queue_release_fields,
+        (ccl_wrapper_release_cl_object) clReleaseCommandQueue, NULL);
+}
+
+/**
+ * Get the context associated with the given command queue wrapper object.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The context associated with the given command queue wrapper object,
+ * or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLContext * ccl_queue_get_context(CCLQueue * cq, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLContext * ctx = NULL;
+
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check if context wrapper is already kept by the queue wrapper. */
+    if (cq->ctx != NULL) {
+        /* If so, return it. */
+        ctx = cq->ctx;
+    } else {
+        /* Otherwise, get it using a query. */
+        CCLWrapperInfo * info = NULL;
+        info = ccl_queue_get_info(cq, CL_QUEUE_CONTEXT, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ctx = ccl_context_new_wrap(*((cl_context *) info->value));
+        cq->ctx = ctx;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return the command queue context wrapper. */
+    return ctx;
+}
+
+/**
+ * Get the device associated with the given command queue wrapper object.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The device associated with the given command queue wrapper object,
+ * or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLDevice * ccl_queue_get_device(CCLQueue * cq, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* The device wrapper object to return. */
+    CCLDevice * dev = NULL;
+
+    /* Internal error object. */
+    CCLErr * err_internal = NULL;
+
+    /* Check if device wrapper is already kept by the queue wrapper. */
+    if (cq->dev != NULL) {
+        /* If so, return it. */
+        dev = cq->dev;
+    } else {
+        /* Otherwise, get it using a query. */
+        CCLWrapperInfo * info = NULL;
+        info = ccl_queue_get_info(cq, CL_QUEUE_DEVICE, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        dev = ccl_device_new_wrap(*((cl_device_id *) info->value));
+        cq->dev = dev;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return the command queue device wrapper object. */
+    return dev;
+}
+
+/**
+ * @brief Create an event wrapper from a given OpenCL event object and
+ * associate it with the command queue.
+ *
+ * This function is used by the `ccl_*_enqueue_*()` functions and will rarely
+ * be called from client code.
+ *
+ * If the queue is in event-less mode (see ccl_queue_set_eventless()),
+ * `event` is `NULL` and no event wrapper is produced.
+ *
+ * If an event capacity was set with ccl_queue_set_event_capacity() and the
+ * queue already holds that many events, events which have terminated and
+ * are not referenced by client code are released first, unless the queue is
+ * attached to a profile object.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] event The OpenCL event to wrap and associate with the given
+ * command queue.
+ * @return The event wrapper object for the given OpenCL event object, or
+ * `NULL` if the queue is in event-less mode.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_queue_produce_event(CCLQueue * cq, cl_event event) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+
+    /* Apply flush policy. */
+    ccl_queue_count_unflushed(cq);
+
+    /* The previous command is no longer the last one. */
+    cq->last_evt = NULL;
+    cq->last_full_barrier = CL_FALSE;
+
+    /* In event-less mode no OpenCL event was requested, so there's nothing
+     * to wrap. */
+    if ((event == NULL) && cq->eventless) return NULL;
+
+    /* Make sure event is not NULL. */
+    g_return_val_if_fail(event != NULL, NULL);
+
+    /* Wrap the OpenCL event. */
+    CCLEvent * evt = ccl_event_new_wrap(event);
+
+    /* If the event capacity has been reached, try to release terminated
+     * events, unless they may be required by a profile object. */
+    if ((cq->evts_cap > 0) && (cq->evts_num >= cq->evts_reclaim_at)
+        && (cq->prof_refs == 0)) {
+
+        ccl_queue_evts_reclaim(cq, CL_TRUE, 0, 0, NULL, NULL);
+
+        /* If many events remain (e.g. they're still executing), postpone
+         * the next attempt, so that the cost of scanning the events is
+         * amortized. */
+        cq->evts_reclaim_at = MAX(cq->evts_cap, 2 * cq->evts_num);
+    }
+
+    /* Grow the ring buffer of events if it's full. */
+    if (cq->evts_num == cq->evts_size)
+        ccl_queue_evts_grow(cq);
+
+    /* Add the wrapped event to the ring buffer of events of this command
+     * queue. */
+    ccl_queue_evt_at(cq, cq->evts_num) = evt;
+    cq->evts_num++;
+    cq->last_evt = evt;
+
+    /* Apply emulated priority hint. */
+    if (cq->sched_priority != 0)
+        ccl_queue_sched_submit(cq, event);
+
+    /* Return the wrapped event. */
+    return evt;
+}
+
+/**
+ * @internal
+ *
+ * @brief Create an event wrapper from a given OpenCL event object and
+ * associate it with the command queue, as ccl_queue_produce_event(), also
+ * recording the wait list of the enqueued command if the queue records
+ * dependencies (see ccl_queue_set_record_deps()).
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] event The OpenCL event to wrap and associate with the given
+ * command queue.
+ * @param[in] evt_wait_lst Event wait list with which the command was
+ * enqueued.
+ * @return The event wrapper object for the given OpenCL event object, or
+ * `NULL` if the queue is in event-less mode.
+ * */
+CCLEvent * ccl_queue_produce_event_deps(
+    CCLQueue * cq, cl_event event, CCLEventWaitList * evt_wait_lst) {
+
+    /* Wrap the OpenCL event. */
+    CCLEvent * evt = ccl_queue_produce_event(cq, event);
+
+    /* Record dependencies, if required. */
+    if ((evt != NULL) && cq->record_deps)
+        ccl_event_set_deps(evt, evt_wait_lst);
+
+    /* Return the wrapped event. */
+    return evt;
+}
+
+/**
+ * Initialize an iterator for this command queue's list of event wrappers. The
+ * event wrappers can be iterated in a loop using the
+ * ccl_queue_iter_event_next() function.
+ *
+ * This function is used by @ref CCL_PROFILER "profile module" functions and
+ * will rarely be called from client code.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ *
+ * */
+CCL_EXPORT
+void ccl_queue_iter_event_init(CCLQueue * cq) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Initialize iterator. */
+    cq->evt_iter = 0;
+}
+
+/**
+ * Get the next event wrapper associated with this queue.
+ *
+ * This function is used by @ref CCL_PROFILER "profile module" functions and
+ * will rarely be called from client code.
+ *
+ * @attention Calling this before ccl_queue_iter_event_init() is undefined
+ * behavior.
+ * @warning This function is not thread-safe.
+ * @warning No events should be enqueued on this queue while the iteration is
+ * ongoing.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @return The next event wrapper associated with this queue, or `NULL` if no
+ * more event wrappers are available.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_queue_iter_event_next(CCLQueue * cq) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+
+    /* Return next event, if any. */
+    if (cq->evt_iter >= cq->evts_num) return NULL;
+    cq->evt_iter++;
+    return ccl_queue_evt_at(cq, cq->evt_iter - 1);
+}
+
+/**
+ * Set the number of events kept by the command queue after which events
+ * which have terminated and are not referenced by client code are
+ * automatically released.
+ *
+ * By default (`capacity` equal to zero), events are kept until
+ * ccl_queue_gc() is called or the queue is destroyed. With a non-zero
+ * capacity, long-running applications which don't keep references to the
+ * events produced by the `ccl_*_enqueue_*()` functions use a bounded amount
+ * of memory. Events still executing or referenced by client code are never
+ * released, so the number of kept events may temporarily exceed the
+ * capacity.
+ *
+ * Events are not automatically released while the queue is attached to a
+ * profile object (see ccl_prof_add_queue()). As such, queues to be profiled
+ * should be added to the profile object before commands are enqueued.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] capacity Number of kept events after which terminated events
+ * are released, or zero to disable automatic release of events.
+ * */
+CCL_EXPORT
+void ccl_queue_set_event_capacity(CCLQueue * cq, cl_uint capacity) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Set capacity. */
+    cq->evts_cap = capacity;
+    cq->evts_reclaim_at = capacity;
+}
+
+/**
+ * Enable or disable event-less mode for the command queue.
+ *
+ * In event-less mode, the `ccl_*_enqueue_*()` functions don't request an
+ * OpenCL event for the enqueued command, thus avoiding the creation,
+ * wrapping and later release of events, and return `NULL` instead of an
+ * event wrapper. This is useful in hot paths which enqueue many small
+ * commands and don't need to wait on or profile them individually. Errors
+ * must then be checked through the `err` argument, since a `NULL` return
+ * value no longer signals an error. Barrier and marker commands, which are
+ * useful only because of their events, always produce events.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] eventless `CL_TRUE` to enable event-less mode, `CL_FALSE` to
+ * disable it (the default).
+ * */
+CCL_EXPORT
+void ccl_queue_set_eventless(CCLQueue * cq, cl_bool eventless) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Set mode. */
+    cq->eventless = eventless;
+}
+
+/**
+ * Enable or disable the recording of command dependencies for the command
+ * queue.
+ *
+ * When enabled, the events in the wait list passed to each
+ * `ccl_*_enqueue_*()` function are recorded with the event of the enqueued
+ * command, so that the @ref CCL_PROFILER "profiler module" can determine
+ * the critical path through the dependencies of profiled commands (see
+ * ccl_prof_iter_slack_init()). Commands enqueued on an in-order queue
+ * implicitly depend on the previous command, so recording is only required
+ * for explicit dependencies, e.g. between queues.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] record_deps `CL_TRUE` to enable recording of command
+ * dependencies, `CL_FALSE` to disable it (the default).
+ * */
+CCL_EXPORT
+void ccl_queue_set_record_deps(CCLQueue * cq, cl_bool record_deps) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Set mode. */
+    cq->record_deps = record_deps;
+}
+
+/**
+ * Set the flush policy of the command queue, i.e. when the queue is
+ * automatically flushed by the `ccl_*_enqueue_*()` functions.
+ *
+ * Flushing after every command adds driver overhead, while never flushing
+ * may leave the device idle until a blocking call is made. With a flush
+ * policy, the commands enqueued since the last flush are counted, and the
+ * queue is flushed once `max_cmds` commands have been enqueued, or when a
+ * command is enqueued `max_usec` microseconds or more after the first
+ * unflushed command. Explicit flushes or finishes restart the count.
+ * Commands are also submitted when the host blocks on them, since
+ * ccl_event_wait() flushes the queues of the events it spin-polls, and
+ * blocking OpenCL calls flush implicitly.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] max_cmds Number of commands after which the queue is flushed,
+ * or zero to disable this condition.
+ * @param[in] max_usec Time in microseconds after the first unflushed
+ * command after which the queue is flushed, or zero to disable this
+ * condition.
+ * */
+CCL_EXPORT
+void ccl_queue_set_flush_policy(
+    CCLQueue * cq, cl_uint max_cmds, cl_ulong max_usec) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Set policy and restart count. */
+    cq->flush_cmds = max_cmds;
+    cq->flush_usec = max_usec;
+    cq->num_unflushed = 0;
+}
+
+/**
+ * Enable or disable the elision of redundant barriers and markers enqueued
+ * with ::ccl_enqueue_barrier() and ::ccl_enqueue_marker().
+ *
+ * A barrier or marker without a wait list is redundant if it immediately
+ * follows a barrier without a wait list, or if the queue is an in-order
+ * queue, since the previous command then only completes after all commands
+ * enqueued before it. When elision is enabled, such barriers and markers
+ * are not enqueued, and the event wrapper of the previous command is
+ * returned instead. Elision is disabled by default, because client code
+ * may rely on the returned event being a distinct barrier or marker
+ * event, e.g. to name it for profiling.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @attention Only commands enqueued with cf4ocl functions producing event
+ * wrappers are taken into account. Elision does not take place after
+ * commands enqueued in event-less mode, and must not be enabled if
+ * commands are enqueued in the queue directly with OpenCL functions.
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] elide_sync Indicates whether redundant barriers and markers
+ * are elided (`CL_TRUE`) or not (`CL_FALSE`).
+ * */
+CCL_EXPORT
+void ccl_queue_set_elide_sync(CCLQueue * cq, cl_bool elide_sync) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+
+    /* Set elision mode. */
+    cq->elide_sync = elide_sync;
+}
+
+/**
+ * Get the number of barriers and markers elided in the command queue.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @return Number of elided barriers and markers.
+ *
+ * @see ccl_queue_set_elide_sync()
+ * */
+CCL_EXPORT
+cl_uint ccl_queue_get_num_elided(CCLQueue * cq) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, 0);
+
+    /* Return number of elided barriers and markers. */
+    return cq->num_elided;
+}
+
+/**
+ * Get the number of commands enqueued in the command queue since it was
+ * last flushed, as counted by its flush policy. If the queue has no flush
+ * policy, commands are not counted and zero is returned.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @return Number of unflushed commands.
+ * */
+CCL_EXPORT
+cl_uint ccl_queue_get_num_unflushed(CCLQueue * cq) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, 0);
+
+    /* Return number of unflushed commands. */
+    return cq->num_unflushed;
+}
+
+/**
+ * Set the maximum number of commands in flight in a low priority queue
+ * while high priority queues on the same device have pending commands.
+ *
+ * This setting only applies to queues created with the
+ * `CL_QUEUE_PRIORITY_LOW_KHR` priority hint on devices which do not support
+ * the `cl_khr_priority_hints` extension, in which case the hint is emulated
+ * by the internal submission scheduler. Each command enqueued in such a
+ * queue while a high priority queue has pending commands makes the host
+ * wait until at most `depth` commands of the queue are in flight. Lower
+ * values bound the latency of high priority work more tightly, at the cost
+ * of background throughput. The default is 2.
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] depth Maximum number of commands in flight, at least 1.
+ * */
+CCL_EXPORT
+void ccl_queue_set_background_depth(CCLQueue * cq, cl_uint depth) {
+
+    /* Make sure cq is not NULL. */
+    g_return_if_fail(cq != NULL);
+    /* Make sure depth is positive. */
+    g_return_if_fail(depth > 0);
+
+    cq->sched_depth = depth;
+}
+
+/**
+ * Is the priority hint of the command queue emulated by the internal
+ * submission scheduler?
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @return `CL_TRUE` if the queue was created with a high or low priority
+ * hint not supported by the device, `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_queue_is_priority_emulated(CCLQueue * cq) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, CL_FALSE);
+
+    return cq->sched_priority != 0 ? CL_TRUE : CL_FALSE;
 }
 
 /**
- * Get the context associated with the given command queue wrapper object.
+ * Get the number of event wrappers currently associated with the command
+ * queue.
  *
  * @public @memberof ccl_queue
  *
  * @param[in] cq The command queue wrapper object.
- * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
- * reporting is to be ignored.
- * @return The context associated with the given command queue wrapper object,
- * or `NULL` if an error occurs.
+ * @return Number of event wrappers associated with the command queue.
  * */
 CCL_EXPORT
-CCLContext * ccl_queue_get_context(CCLQueue * cq, CCLErr ** err) {
+cl_uint ccl_queue_get_num_events(CCLQueue * cq) {
 
     /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
-
-    CCLContext * ctx = NULL;
-
-    /* Internal error object. */
-    CCLErr * err_internal = NULL;
-
-    /* Check if context wrapper is already kept by the queue wrapper. */
-    if (cq->ctx != NULL) {
-        /* If so, return it. */
-        ctx = cq->ctx;
-    } else {
-        /* Otherwise, get it using a query. */
-        CCLWrapperInfo * info = NULL;
-        info = ccl_queue_get_info(cq, CL_QUEUE_CONTEXT, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-        ctx = ccl_context_new_wrap(*((cl_context *) info->value));
-        cq->ctx = ctx;
-    }
-
-    /* If we got here, everything is OK. */
-    g_assert(err == NULL || *err == NULL);
-    goto finish;
+    g_return_val_if_fail(cq != NULL, 0);
 
-error_handler:
-    /* If we got here there was an error, verify that it is so. */
-    g_assert(err == NULL || *err != NULL);
+    /* Return number of events. */
+    return cq->evts_num;
+}
 
-finish:
+/**
+ * @internal
+ *
+ * @brief Get the location where the OpenCL event of a command enqueued on
+ * the queue should be placed, taking into account the event-less mode.
+ *
+ * @private @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] event Location for the OpenCL event.
+ * @return `event`, or `NULL` if the queue is in event-less mode.
+ * */
+cl_event * ccl_queue_event_ptr(CCLQueue * cq, cl_event * event) {
 
-    /* Return the command queue context wrapper. */
-    return ctx;
+    return cq->eventless ? NULL : event;
 }
 
 /**
- * Get the device associated with the given command queue wrapper object.
+ * @internal
  *
- * @public @memberof ccl_queue
+ * @brief Get an event which completes after the last command enqueued on
+ * the queue. If that command has no event, e.g. because the queue is in
+ * event-less mode, a marker is enqueued, and its event is returned for
+ * later requests until another command is enqueued.
+ *
+ * @private @memberof ccl_queue
  *
  * @param[in] cq The command queue wrapper object.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return The device associated with the given command queue wrapper object,
- * or `NULL` if an error occurs.
+ * @return Event of the last command or of the marker, or `NULL` if an error
+ * occurs.
  * */
-CCL_EXPORT
-CCLDevice * ccl_queue_get_device(CCLQueue * cq, CCLErr ** err) {
+CCLEvent * ccl_queue_last_event(CCLQueue * cq, CCLErr ** err) {
 
-    /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+    /* Event to return. */
+    CCLEvent * evt = cq->last_evt;
+    /* OpenCL event of the marker. */
+    cl_event event;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
 
-    /* The device wrapper object to return. */
-    CCLDevice * dev = NULL;
+    /* Event of the last command is known. */
+    if (evt != NULL) goto finish;
 
-    /* Internal error object. */
-    CCLErr * err_internal = NULL;
+    /* Enqueue a marker, which completes after all previous commands. */
+    event = ccl_queue_enqueue_marker_raw(cq, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
 
-    /* Check if device wrapper is already kept by the queue wrapper. */
-    if (cq->dev != NULL) {
-        /* If so, return it. */
-        dev = cq->dev;
-    } else {
-        /* Otherwise, get it using a query. */
-        CCLWrapperInfo * info = NULL;
-        info = ccl_queue_get_info(cq, CL_QUEUE_DEVICE, &err_internal);
-        ccl_if_err_propagate_goto(err, err_internal, error_handler);
-        dev = ccl_device_new_wrap(*((cl_device_id *) info->value));
-        cq->dev = dev;
-    }
+    /* Wrap marker event, which becomes the last command's event. */
+    evt = ccl_queue_produce_event_deps(cq, event, NULL);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
     goto finish;
 
 error_handler:
+
     /* If we got here there was an error, verify that it is so. */
     g_assert(err == NULL || *err != NULL);
 
 finish:
 
-    /* Return the command queue device wrapper object. */
-    return dev;
-}
-
-/**
- * @brief Create an event wrapper from a given OpenCL event object and
- * associate it with the command queue.
- *
- * This function is used by the `ccl_*_enqueue_*()` functions and will rarely
- * be called from client code.
- *
- * @public @memberof ccl_queue
- *
- * @param[in] cq The command queue wrapper object.
- * @param[in] event The OpenCL event to wrap and associate with the given
- * command queue.
- * @return The event wrapper object for the given OpenCL event object.
- * */
-CCL_EXPORT
-CCLEvent * ccl_queue_produce_event(CCLQueue * cq, cl_event event) {
-
-    /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
-    /* Make sure event is not NULL. */
-    g_return_val_if_fail(event != NULL, NULL);
-
-    /* Wrap the OpenCL event. */
-    CCLEvent * evt = ccl_event_new_wrap(event);
-
-    /* Initialize the list of events of this command queue. */
-    if (cq->evts == NULL) {
-        cq->evts = g_hash_table_new_full(g_direct_hash, g_direct_equal,
-            (GDestroyNotify) ccl_event_destroy, NULL);
-    }
-
-    /* Add the wrapped event to the list of events of this command
-     * queue. */
-    g_hash_table_add(cq->evts, (gpointer) evt);
-
-    /* Return the wrapped event. */
+    /* Return event. */
     return evt;
 }
 
 /**
- * Initialize an iterator for this command queue's list of event wrappers. The
- * event wrappers can be iterated in a loop using the
- * ccl_queue_iter_event_next() function.
+ * @internal
  *
- * This function is used by @ref CCL_PROFILER "profile module" functions and
- * will rarely be called from client code.
+ * @brief Attach the command queue to, or detach it from, a profile object.
+ * Events are not automatically released while the queue is attached to at
+ * least one profile object.
  *
- * @public @memberof ccl_queue
+ * @private @memberof ccl_queue
  *
  * @param[in] cq The command queue wrapper object.
- *
+ * @param[in] attach `CL_TRUE` to attach queue, `CL_FALSE` to detach it.
  * */
-CCL_EXPORT
-void ccl_queue_iter_event_init(CCLQueue * cq) {
+void ccl_queue_prof_attach(CCLQueue * cq, cl_bool attach) {
 
     /* Make sure cq is not NULL. */
     g_return_if_fail(cq != NULL);
 
-    /* Initialize iterator. */
-    g_hash_table_iter_init(&cq->evt_iter, cq->evts);
+    /* Update number of profile objects to which the queue is attached. */
+    if (attach) {
+        cq->prof_refs++;
+    } else {
+        g_return_if_fail(cq->prof_refs > 0);
+        cq->prof_refs--;
+    }
 }
 
 /**
- * Get the next event wrapper associated with this queue.
+ * @internal
  *
- * This function is used by @ref CCL_PROFILER "profile module" functions and
- * will rarely be called from client code.
+ * @brief Release terminated events associated with the command queue,
+ * passing each one to the given function before releasing it. Events for
+ * which the function returns `CL_FALSE` are kept.
  *
- * @attention Calling this before ccl_queue_iter_event_init() is undefined
- * behavior.
- * @warning This function is not thread-safe.
- * @warning No events should be enqueued on this queue while the iteration is
- * ongoing.
+ * This is used by profile objects in incremental mode, so that terminated
+ * events are released only after their profiling information is processed.
  *
- * @public @memberof ccl_queue
+ * @private @memberof ccl_queue
  *
  * @param[in] cq The command queue wrapper object.
- * @return The next event wrapper associated with this queue, or `NULL` if no
- * more event wrappers are available.
+ * @param[in] drain_fn Function called for each terminated event.
+ * @param[in] data Data passed to `drain_fn`.
+ * @return Number of released events.
  * */
-CCL_EXPORT
-CCLEvent * ccl_queue_iter_event_next(CCLQueue * cq) {
+cl_uint ccl_queue_prof_drain(
+    CCLQueue * cq, ccl_queue_drain_fn drain_fn, void * data) {
 
     /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
+    g_return_val_if_fail(cq != NULL, 0);
 
-    gpointer evt;
-    gboolean exists = g_hash_table_iter_next(&cq->evt_iter, &evt, NULL);
-    return exists ? (CCLEvent *) evt : NULL;
+    /* Release terminated events, letting the given function process
+     * them first. */
+    return ccl_queue_evts_reclaim(cq, CL_FALSE, 0, 0, drain_fn, data);
 }
 
 /**
@@ -561,16 +1830,23 @@ cl_bool ccl_queue_flush(CCLQueue * cq, CCLErr ** err) {
     /* Make sure cq is not NULL. */
     g_return_val_if_fail(cq != NULL, CL_INVALID_COMMAND_QUEUE);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL status flag. */
     cl_int ocl_status;
 
     /* Flush queue. */
     ocl_status = clFlush(ccl_queue_unwrap(cq));
+    cq->num_unflushed = 0;
     if (ocl_status != CL_SUCCESS)
         g_set_error(err, CCL_OCL_ERROR, ocl_status,
             "%s: unable to flush queue (OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return status. */
     return ocl_status == CL_SUCCESS ? CL_TRUE : CL_FALSE;
 }
@@ -595,16 +1871,23 @@ cl_bool ccl_queue_finish(CCLQueue * cq, CCLErr ** err) {
     /* Make sure cq is not NULL. */
     g_return_val_if_fail(cq != NULL, CL_INVALID_COMMAND_QUEUE);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* OpenCL status flag. */
     cl_int ocl_status;
 
     /* Finish queue. */
     ocl_status = clFinish(ccl_queue_unwrap(cq));
+    cq->num_unflushed = 0;
     if (ocl_status != CL_SUCCESS)
         g_set_error(err, CCL_OCL_ERROR, ocl_status,
             "%s: unable to finish queue (OpenCL error %d: %s).",
         CCL_STRD, ocl_status, ccl_err(ocl_status));
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return status. */
     return ocl_status == CL_SUCCESS ? CL_TRUE : CL_FALSE;
 }
@@ -631,9 +1914,57 @@ void ccl_queue_gc(CCLQueue * cq) {
     g_return_if_fail(cq != NULL);
 
     /* Release events. */
-    if (cq->evts != NULL) {
-        g_hash_table_remove_all(cq->evts);
-    }
+    ccl_queue_evts_release(cq);
+}
+
+/**
+ * Release completed events associated with the command queue, without
+ * blocking.
+ *
+ * Unlike ccl_queue_gc(), which releases all events associated with the
+ * queue, this function only releases events which have terminated (i.e.,
+ * whose execution status is `CL_COMPLETE` or an error code), and can be
+ * given a budget, so that it can be called on every iteration of a
+ * submission loop without stalling it. Events are examined from the oldest
+ * to the newest, so for in-order queues events are released in the same
+ * order in which they complete.
+ *
+ * As with ccl_queue_gc(), this function releases the queue reference to the
+ * events. Events referenced by client code remain valid until client code
+ * releases them.
+ *
+ * No events are released while the queue is attached to a profile object,
+ * since they may not yet have been processed by it. In that case, events
+ * are released by ccl_prof_drain() or ccl_prof_calc().
+ *
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq The command queue wrapper object.
+ * @param[in] max_evts Maximum number of events to examine, or zero to
+ * examine all events.
+ * @param[in] max_usecs Maximum time to spend examining events, in
+ * microseconds, or zero for no time limit.
+ * @return Number of released events.
+ * */
+CCL_EXPORT
+cl_uint ccl_queue_gc_incremental(
+    CCLQueue * cq, cl_uint max_evts, cl_ulong max_usecs) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, 0);
+
+    /* Time after which no more events are examined. */
+    gint64 deadline;
+
+    /* Keep events which may be required by a profile object. */
+    if (cq->prof_refs > 0) return 0;
+
+    deadline = (max_usecs > 0)
+        ? g_get_monotonic_time() + (gint64) max_usecs : 0;
+
+    /* Release terminated events within budget. */
+    return ccl_queue_evts_reclaim(
+        cq, CL_FALSE, max_evts, deadline, NULL, NULL);
 }
 
 /**
@@ -747,6 +2078,9 @@ CCLEvent * ccl_enqueue_barrier(
     /* Make sure err is NULL or it is not set. */
     g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
     /* Event wrapper to return. */
     CCLEvent * evt;
     /* OpenCL event object. */
@@ -767,6 +2101,14 @@ CCLEvent * ccl_enqueue_barrier(
     /* OpenCL status. */
     cl_int ocl_status;
 
+#endif
+
+    /* Return event of previous command if barrier is redundant. */
+    evt = ccl_queue_elide_sync(cq, evt_wait_lst);
+    if (evt != NULL) goto finish;
+
+#ifdef CL_VERSION_1_2
+
     /* Get platform version. */
     ctx = ccl_queue_get_context(cq, &err_internal);
     ccl_if_err_propagate_goto(err, err_internal, error_handler);
@@ -807,7 +2149,12 @@ CCLEvent * ccl_enqueue_barrier(
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+    /* Keep track of barriers which wait on all previous commands. */
+    if (evt != NULL)
+        cq->last_full_barrier =
+            (ccl_event_wait_list_get_num_events(evt_wait_lst) == 0);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -826,6 +2173,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -896,36 +2246,26 @@ finish:
 }
 
 /**
- * Enqueues a marker command on the given command queue. The marker can wait on
- * a given list of events, or wait until all previous enqueued commands have
- * completed if `evt_wait_lst` is `NULL`. This function is a wrapper for the
- * clEnqueueMarkerWithWaitList() OpenCL function (OpenCL >= 1.2).
+ * @internal
  *
- * @copybrief ccl_enqueue_marker_deprecated()
- * @note Requires OpenCL >= 1.2 if `evt_wait_lst` is not `NULL`.
- * @public @memberof ccl_queue
+ * @brief Enqueues a marker command on the given command queue, using
+ * clEnqueueMarkerWithWaitList() or clEnqueueMarker() depending on the
+ * platform's OpenCL version, without wrapping the resulting event.
  *
  * @param[in] cq Command queue wrapper object.
  * @param[in,out] evt_wait_lst List of events that need to complete before this
- * command can be executed. The list will be cleared and can be reused by
- * client code. Must be `NULL` if OpenCL platform version is <= 1.1.
+ * command can be executed. Must be `NULL` if OpenCL platform version is
+ * <= 1.1.
  * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
  * reporting is to be ignored.
- * @return An event wrapper object that identifies this particular command.
+ * @return An OpenCL marker event, which must be released by the caller, or
+ * `NULL` if an error occurs.
  * */
-CCL_EXPORT
-CCLEvent * ccl_enqueue_marker(
+cl_event ccl_queue_enqueue_marker_raw(
     CCLQueue * cq, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
 
-    /* Make sure cq is not NULL. */
-    g_return_val_if_fail(cq != NULL, NULL);
-    /* Make sure err is NULL or it is not set. */
-    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
-
-    /* Event wrapper to return. */
-    CCLEvent * evt;
     /* OpenCL event object. */
-    cl_event event;
+    cl_event event = NULL;
     /* Internal error handling object. */
     CCLErr * err_internal = NULL;
 
@@ -976,10 +2316,72 @@ CCLEvent * ccl_enqueue_marker(
 
 #endif
 
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* In case of error, return a NULL event. */
+    event = NULL;
+
+finish:
+
+    /* Return OpenCL event. */
+    return event;
+}
+
+/**
+ * Enqueues a marker command on the given command queue. The marker can wait on
+ * a given list of events, or wait until all previous enqueued commands have
+ * completed if `evt_wait_lst` is `NULL`. This function is a wrapper for the
+ * clEnqueueMarkerWithWaitList() OpenCL function (OpenCL >= 1.2).
+ *
+ * @copybrief ccl_enqueue_marker_deprecated()
+ * @note Requires OpenCL >= 1.2 if `evt_wait_lst` is not `NULL`.
+ * @public @memberof ccl_queue
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in,out] evt_wait_lst List of events that need to complete before this
+ * command can be executed. The list will be cleared and can be reused by
+ * client code. Must be `NULL` if OpenCL platform version is <= 1.1.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event wrapper object that identifies this particular command.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_enqueue_marker(
+    CCLQueue * cq, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    /* Event wrapper to return. */
+    CCLEvent * evt;
+    /* OpenCL event object. */
+    cl_event event;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Return event of previous command if marker is redundant. */
+    evt = ccl_queue_elide_sync(cq, evt_wait_lst);
+    if (evt != NULL) goto finish;
+
+    /* Enqueue marker. */
+    event = ccl_queue_enqueue_marker_raw(cq, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
     /* Wrap event and associate it with the respective command queue.
      * The event object will be released automatically when the command
      * queue is released. */
-    evt = ccl_queue_produce_event(cq, event);
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL || *err == NULL);
@@ -998,6 +2400,9 @@ finish:
     /* Clear event wait list. */
     ccl_event_wait_list_clear(evt_wait_lst);
 
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
     /* Return event. */
     return evt;
 }
@@ -34,6 +34,21 @@
 #include "ccl_context_wrapper.h"
 #include "ccl_event_wrapper.h"
 
+/* Queue priority and throttle hints, for OpenCL headers which predate the
+ * cl_khr_priority_hints and cl_khr_throttle_hints extensions. */
+#ifndef CL_QUEUE_PRIORITY_KHR
+    #define CL_QUEUE_PRIORITY_KHR 0x1096
+    #define CL_QUEUE_PRIORITY_HIGH_KHR (1 << 0)
+    #define CL_QUEUE_PRIORITY_MED_KHR (1 << 1)
+    #define CL_QUEUE_PRIORITY_LOW_KHR (1 << 2)
+#endif
+#ifndef CL_QUEUE_THROTTLE_KHR
+    #define CL_QUEUE_THROTTLE_KHR 0x1097
+    #define CL_QUEUE_THROTTLE_HIGH_KHR (1 << 0)
+    #define CL_QUEUE_THROTTLE_MED_KHR (1 << 1)
+    #define CL_QUEUE_THROTTLE_LOW_KHR (1 << 2)
+#endif
+
 /**
  * @defgroup CCL_QUEUE_WRAPPER Command queue wrapper
  *
@@ -51,6 +66,26 @@
  * @ref ug_new_destroy "new/destroy" rule; as such, queues should be freed with
  * the ::ccl_queue_destroy() destructor.
  *
+ * The `CL_QUEUE_PRIORITY_KHR` and `CL_QUEUE_THROTTLE_KHR` properties are
+ * passed to the OpenCL implementation if the device supports the
+ * `cl_khr_priority_hints` and `cl_khr_throttle_hints` extensions,
+ * respectively, and are otherwise silently dropped. A dropped priority hint
+ * is emulated by an internal submission scheduler: while a high priority
+ * queue on the same device has pending commands, each command enqueued in a
+ * low priority queue waits until at most a few commands of the latter are
+ * in flight (see ::ccl_queue_set_background_depth()), which keeps
+ * background work from building a backlog in front of latency-critical
+ * work. The scheduler only sees commands enqueued through _cf4ocl_ with
+ * event wrappers, i.e. not in event-less mode.
+ *
+ * On-device queues, to which kernels enqueue child kernels (OpenCL >= 2.0
+ * device-side enqueue), are created with ::ccl_queue_new_device(), which
+ * validates the requested properties and size against the device limits.
+ * The default on-device queue can be replaced with
+ * ::ccl_queue_set_default_device() (OpenCL >= 2.1). Programs whose kernels
+ * enqueue child kernels must be built with the
+ * ::CCL_QUEUE_DEVICE_ENQUEUE_BUILD_OPTS options.
+ *
  * Queue wrappers created with the `CL_QUEUE_PROFILING_ENABLE` property can be
  * automatically profiled with the @ref CCL_PROFILER "profiler module".
  *
@@ -92,6 +127,16 @@ CCL_EXPORT
 CCLQueue * ccl_queue_new(CCLContext * ctx, CCLDevice * dev,
     cl_command_queue_properties properties, CCLErr ** err);
 
+/* Create a new on-device command queue wrapper object. */
+CCL_EXPORT
+CCLQueue * ccl_queue_new_device(CCLContext * ctx, CCLDevice * dev,
+    cl_command_queue_properties properties, cl_uint size, CCLErr ** err);
+
+/* Replace the default on-device queue of a device. */
+CCL_EXPORT
+cl_bool ccl_queue_set_default_device(CCLContext * ctx, CCLDevice * dev,
+    CCLQueue * cq, CCLErr ** err);
+
 /* Decrements the reference count of the command queue wrapper object. If it
  * reaches 0, the command queue wrapper object is destroyed. */
 CCL_EXPORT
@@ -118,6 +163,53 @@ void ccl_queue_iter_event_init(CCLQueue * cq);
 CCL_EXPORT
 CCLEvent * ccl_queue_iter_event_next(CCLQueue * cq);
 
+/* Set the number of events kept by the command queue after which terminated
+ * events are automatically released. */
+CCL_EXPORT
+void ccl_queue_set_event_capacity(CCLQueue * cq, cl_uint capacity);
+
+/* Enable or disable event-less mode for the command queue. */
+CCL_EXPORT
+void ccl_queue_set_eventless(CCLQueue * cq, cl_bool eventless);
+
+/* Enable or disable the recording of command dependencies for the command
+ * queue. */
+CCL_EXPORT
+void ccl_queue_set_record_deps(CCLQueue * cq, cl_bool record_deps);
+
+/* Set the flush policy of the command queue. */
+CCL_EXPORT
+void ccl_queue_set_flush_policy(
+    CCLQueue * cq, cl_uint max_cmds, cl_ulong max_usec);
+
+/* Get the number of commands enqueued in the command queue since it was
+ * last flushed. */
+CCL_EXPORT
+cl_uint ccl_queue_get_num_unflushed(CCLQueue * cq);
+
+/* Enable or disable the elision of redundant barriers and markers. */
+CCL_EXPORT
+void ccl_queue_set_elide_sync(CCLQueue * cq, cl_bool elide_sync);
+
+/* Get the number of barriers and markers elided in the command queue. */
+CCL_EXPORT
+cl_uint ccl_queue_get_num_elided(CCLQueue * cq);
+
+/* Set the maximum number of commands in flight in a low priority queue
+ * while high priority queues have pending commands. */
+CCL_EXPORT
+void ccl_queue_set_background_depth(CCLQueue * cq, cl_uint depth);
+
+/* Is the priority hint of the command queue emulated by the internal
+ * submission scheduler? */
+CCL_EXPORT
+cl_bool ccl_queue_is_priority_emulated(CCLQueue * cq);
+
+/* Get the number of event wrappers currently associated with the command
+ * queue. */
+CCL_EXPORT
+cl_uint ccl_queue_get_num_events(CCLQueue * cq);
+
 /* Issues all previously queued commands in a command queue to the
  * associated device. */
 CCL_EXPORT
@@ -132,6 +224,12 @@ cl_bool ccl_queue_finish(CCLQueue * cq, CCLErr ** err);
 CCL_EXPORT
 void ccl_queue_gc(CCLQueue * cq);
 
+/* Release completed events associated with the command queue, without
+ * blocking. */
+CCL_EXPORT
+cl_uint ccl_queue_gc_incremental(
+    CCLQueue * cq, cl_uint max_evts, cl_ulong max_usecs);
+
 /* Enqueues a barrier command on the given command queue. */
 CCL_EXPORT
 CCLEvent * ccl_enqueue_barrier(
@@ -142,6 +240,12 @@ CCL_EXPORT
 CCLEvent * ccl_enqueue_marker(
     CCLQueue * cq, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
 
+/**
+ * Build options for programs whose kernels enqueue child kernels in
+ * on-device queues, which require the OpenCL C 2.0 language.
+ * */
+#define CCL_QUEUE_DEVICE_ENQUEUE_BUILD_OPTS "-cl-std=CL2.0"
+
 /**
  * Get a ::CCLWrapperInfo command queue information object.
  *
@@ -178,7 +282,7 @@ CCLEvent * ccl_enqueue_marker(
  * an error occurs, zero is returned.
  * */
 #define ccl_queue_get_info_scalar(cq, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) cq, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) cq, \
         NULL, param_name, sizeof(param_type), CCL_INFO_QUEUE, CL_FALSE, err))
 
 /**
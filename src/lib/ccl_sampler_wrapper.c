@@ -28,6 +28,7 @@
 
 #include "ccl_sampler_wrapper.h"
 #include "_ccl_abstract_wrapper.h"
+#include "_ccl_context_wrapper.h"
 #include "_ccl_defs.h"
 
 /**
@@ -296,5 +297,95 @@ finish:
     return smplr;
 }
 
+/**
+ * Get a sampler wrapper object with the given list of properties, shared
+ * with all other callers requesting the same properties in the same
+ * context.
+ *
+ * Samplers are immutable, so identical property lists can safely share
+ * one OpenCL sampler object. The property list is put in a canonical form,
+ * with defaults filled in for basic properties not specified, and is used
+ * as key into a context-scoped cache of samplers. Only the first request
+ * for a given key creates a sampler, using ccl_sampler_new_full(); further
+ * requests return the cached wrapper with its reference count increased.
+ * Cached samplers are released when the context is destroyed.
+ *
+ * @public @memberof ccl_sampler
+ *
+ * @param[in] ctx A context wrapper object.
+ * @param[in] sampler_properties A list of sampler property names and their
+ * corresponding values, terminated with 0, as in ccl_sampler_new_full(). If
+ * `NULL`, default values for supported sampler properties will be used.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A shared sampler wrapper object, which should be released with
+ * ccl_sampler_destroy(), or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLSampler * ccl_sampler_new_cached(CCLContext * ctx,
+    const cl_sampler_properties * sampler_properties, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail((err) == NULL || *(err) == NULL, NULL);
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+
+    /* Shared sampler wrapper object. */
+    CCLSampler * smplr = NULL;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+    /* Canonical property list. */
+    GString * key;
+    /* Basic sampler properties, with defaults filled in. */
+    struct ccl_sampler_basic_properties sbp =
+        ccl_sampler_get_basic_properties(sampler_properties);
+
+    /* Build key from basic properties, followed by any other properties
+     * in the order given. */
+    key = g_string_new(NULL);
+    g_string_printf(key, "n%u:a%x:f%x", (unsigned int) sbp.normalized_coords,
+        (unsigned int) sbp.addressing_mode, (unsigned int) sbp.filter_mode);
+    if (sampler_properties != NULL) {
+        for (guint i = 0; sampler_properties[i] != 0; i = i + 2) {
+            switch (sampler_properties[i]) {
+                case CL_SAMPLER_NORMALIZED_COORDS:
+                case CL_SAMPLER_ADDRESSING_MODE:
+                case CL_SAMPLER_FILTER_MODE:
+                    break;
+                default:
+                    g_string_append_printf(key, ":%lx=%lx",
+                        (unsigned long) sampler_properties[i],
+                        (unsigned long) sampler_properties[i + 1]);
+            }
+        }
+    }
+
+    /* Look for sampler in context cache. */
+    smplr = ccl_context_get_cached_sampler(ctx, key->str);
+
+    /* Create and cache sampler if not found. */
+    if (smplr == NULL) {
+        smplr = ccl_sampler_new_full(ctx, sampler_properties, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        smplr = ccl_context_add_cached_sampler(ctx, key->str, smplr);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release key. */
+    g_string_free(key, TRUE);
+
+    /* Return sampler wrapper. */
+    return smplr;
+}
 
 /** @} */
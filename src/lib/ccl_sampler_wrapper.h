@@ -51,6 +51,10 @@
  * OpenCL version, because _cf4ocl_ will automatically select the most adequate
  * OpenCL constructor.
  *
+ * Since samplers are immutable, ::ccl_sampler_new_cached() returns a sampler
+ * shared by all requests for the same properties in a context, avoiding
+ * the creation of duplicate OpenCL sampler objects.
+ *
  * Sampler wrapper objects should be freed with the ::ccl_sampler_destroy()
  * function, in accordance with the _cf4ocl_ @ref ug_new_destroy "new/destroy"
  * rule.
@@ -102,6 +106,12 @@ CCL_EXPORT
 CCLSampler * ccl_sampler_new_full(CCLContext * ctx,
     const cl_sampler_properties * sampler_properties, CCLErr ** err);
 
+/* Get a sampler wrapper object shared by all requests for the same
+ * properties in a context. */
+CCL_EXPORT
+CCLSampler * ccl_sampler_new_cached(CCLContext * ctx,
+    const cl_sampler_properties * sampler_properties, CCLErr ** err);
+
 /**
  * Get a ::CCLWrapperInfo sampler information object.
  *
@@ -138,7 +148,7 @@ CCLSampler * ccl_sampler_new_full(CCLContext * ctx,
  * error occurs, zero is returned.
  * */
 #define ccl_sampler_get_info_scalar(smplr, param_name, param_type, err) \
-    *((param_type *) ccl_wrapper_get_info_value((CCLWrapper *) smplr, \
+    *((param_type *) ccl_wrapper_get_info_scalar((CCLWrapper *) smplr, \
         NULL, param_name, sizeof(param_type), CCL_INFO_SAMPLER, CL_FALSE, err))
 
 /**
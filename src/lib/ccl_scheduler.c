@@ -0,0 +1,568 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of a work-stealing scheduler over a set of command
+ * queues.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_scheduler.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief A task submitted to a scheduler which has not yet run.
+ * */
+struct ccl_scheduler_pending {
+
+    /**
+     * Task function.
+     * @private
+     * */
+    ccl_scheduler_task fn;
+
+    /**
+     * User data for task function.
+     * @private
+     * */
+    void * user_data;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Scheduling state of a command queue.
+ * */
+struct ccl_scheduler_slot {
+
+    /**
+     * Scheduler to which the queue belongs, used by completion
+     * callbacks.
+     * @private
+     * */
+    CCLScheduler * sched;
+
+    /**
+     * Command queue wrapper.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Tasks waiting to run in this queue, oldest first.
+     * @private
+     * */
+    GQueue pending;
+
+    /**
+     * Number of tasks in flight in this queue.
+     * @private
+     * */
+    cl_uint inflight;
+
+    /**
+     * Number of tasks completed in this queue.
+     * @private
+     * */
+    cl_uint num_tasks;
+
+};
+
+/**
+ * Work-stealing scheduler class.
+ * */
+struct ccl_scheduler {
+
+    /**
+     * Scheduling state of each command queue.
+     * @private
+     * */
+    struct ccl_scheduler_slot * slots;
+
+    /**
+     * Number of command queues.
+     * @private
+     * */
+    cl_uint num_queues;
+
+    /**
+     * Maximum number of tasks in flight in each queue.
+     * @private
+     * */
+    cl_uint max_inflight;
+
+    /**
+     * Number of tasks stolen by idle queues.
+     * @private
+     * */
+    cl_uint num_steals;
+
+    /**
+     * Execution status of the first failed task since the last wait, or
+     * `CL_SUCCESS`.
+     * @private
+     * */
+    cl_int status;
+
+    /**
+     * Lock protecting the scheduling state, which is also updated by
+     * completion callbacks.
+     * @private
+     * */
+    GMutex lock;
+
+    /**
+     * Condition signaled when a task completes.
+     * @private
+     * */
+    GCond done;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Event callback which frees the slot of a completed task.
+ *
+ * @param[in] event Event of the last command of the task.
+ * @param[in] status Execution status of `event`.
+ * @param[in] user_data Scheduling state of the task queue.
+ * */
+static void CL_CALLBACK ccl_scheduler_task_done(
+    cl_event event, cl_int status, void * user_data) {
+
+    struct ccl_scheduler_slot * slot = (struct ccl_scheduler_slot *) user_data;
+    CCLScheduler * sched = slot->sched;
+
+    CCL_UNUSED(event);
+
+    g_mutex_lock(&sched->lock);
+    slot->inflight--;
+    slot->num_tasks++;
+    if ((status < 0) && (sched->status == CL_SUCCESS))
+        sched->status = status;
+    g_cond_broadcast(&sched->done);
+    g_mutex_unlock(&sched->lock);
+}
+
+/**
+ * @internal
+ *
+ * @brief Take the next task to run, if any queue has a free slot and
+ * there is a task for it, either its own or stolen from another queue.
+ * Must be called with the scheduler lock held.
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @param[out] task Location where to place the task.
+ * @return The queue where the task should run, or `NULL` if no task can
+ * run.
+ * */
+static struct ccl_scheduler_slot * ccl_scheduler_take(
+    CCLScheduler * sched, struct ccl_scheduler_pending ** task) {
+
+    struct ccl_scheduler_slot * slot, * victim;
+
+    for (cl_uint i = 0; i < sched->num_queues; ++i) {
+
+        slot = &sched->slots[i];
+        if (slot->inflight >= sched->max_inflight) continue;
+
+        /* Run oldest own task. */
+        *task = g_queue_pop_head(&slot->pending);
+
+        /* If there are none, steal the newest task of the queue with the
+         * most pending tasks. */
+        if (*task == NULL) {
+            victim = NULL;
+            for (cl_uint j = 0; j < sched->num_queues; ++j) {
+                if ((victim == NULL) || (sched->slots[j].pending.length
+                        > victim->pending.length))
+                    victim = &sched->slots[j];
+            }
+            *task = g_queue_pop_tail(&victim->pending);
+            if (*task != NULL) sched->num_steals++;
+        }
+
+        if (*task != NULL) {
+            slot->inflight++;
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Run pending tasks in the queues which have free slots.
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool ccl_scheduler_dispatch(CCLScheduler * sched, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status = CL_FALSE;
+    struct ccl_scheduler_slot * slot;
+    struct ccl_scheduler_pending * task = NULL;
+    CCLEvent * evt;
+
+    while (TRUE) {
+
+        /* Take next task, if any can run. */
+        g_mutex_lock(&sched->lock);
+        slot = ccl_scheduler_take(sched, &task);
+        g_mutex_unlock(&sched->lock);
+        if (slot == NULL) break;
+
+        /* Run task function without holding the lock, since it may take
+         * long to enqueue the task commands. */
+        evt = task->fn(slot->cq, task->user_data, &err_internal);
+        g_slice_free(struct ccl_scheduler_pending, task);
+        if (err_internal == NULL) {
+
+            /* Track task completion. Tasks without an event, e.g. in
+             * event-less queues, are complete as far as the scheduler
+             * can tell. */
+            if (evt != NULL) {
+                ccl_event_set_callback(evt, CL_COMPLETE,
+                    ccl_scheduler_task_done, slot, &err_internal);
+            } else {
+                ccl_scheduler_task_done(NULL, CL_COMPLETE, slot);
+            }
+        }
+        if (err_internal != NULL) {
+            g_mutex_lock(&sched->lock);
+            slot->inflight--;
+            g_mutex_unlock(&sched->lock);
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Make sure task commands are submitted to the device, so that
+         * completion callbacks are called. */
+        ccl_queue_flush(slot->cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    return ret_status;
+}
+
+/**
+ * @addtogroup CCL_SCHEDULER
+ * @{
+ */
+
+/**
+ * Create a new work-stealing scheduler over a set of command queues.
+ *
+ * @public @memberof ccl_scheduler
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] queues Command queue wrapper objects, which are kept alive
+ * by the scheduler.
+ * @param[in] num_queues Number of command queues.
+ * @param[in] max_inflight Maximum number of tasks in flight in each queue,
+ * or 0 for ::CCL_SCHEDULER_MAX_INFLIGHT.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new work-stealing scheduler, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLScheduler * ccl_scheduler_new(CCLQueue * const * queues,
+    cl_uint num_queues, cl_uint max_inflight, CCLErr ** err) {
+
+    /* Make sure queues is not NULL. */
+    g_return_val_if_fail(queues != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLScheduler * sched = NULL;
+
+    /* Check that there are queues to schedule tasks in. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, num_queues == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: at least one command queue is required.", CCL_STRD);
+
+    /* Create scheduler. */
+    sched = g_slice_new0(CCLScheduler);
+    sched->slots = g_new0(struct ccl_scheduler_slot, num_queues);
+    sched->num_queues = num_queues;
+    sched->max_inflight =
+        max_inflight > 0 ? max_inflight : CCL_SCHEDULER_MAX_INFLIGHT;
+    sched->status = CL_SUCCESS;
+    g_mutex_init(&sched->lock);
+    g_cond_init(&sched->done);
+    for (cl_uint i = 0; i < num_queues; ++i) {
+        ccl_queue_ref(queues[i]);
+        sched->slots[i].sched = sched;
+        sched->slots[i].cq = queues[i];
+        g_queue_init(&sched->slots[i].pending);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return scheduler. */
+    return sched;
+}
+
+/**
+ * Destroy a work-stealing scheduler, releasing its command queues.
+ * Tasks which are still pending are discarded, and tasks in flight are
+ * waited for, since their completion callbacks refer to the scheduler.
+ *
+ * @public @memberof ccl_scheduler
+ *
+ * @param[in] sched The work-stealing scheduler to destroy.
+ * */
+CCL_EXPORT
+void ccl_scheduler_destroy(CCLScheduler * sched) {
+
+    /* Make sure sched is not NULL. */
+    g_return_if_fail(sched != NULL);
+
+    /* Discard pending tasks and wait for tasks in flight. */
+    g_mutex_lock(&sched->lock);
+    for (cl_uint i = 0; i < sched->num_queues; ++i) {
+        struct ccl_scheduler_slot * slot = &sched->slots[i];
+        while (!g_queue_is_empty(&slot->pending))
+            g_slice_free(struct ccl_scheduler_pending,
+                g_queue_pop_head(&slot->pending));
+        while (slot->inflight > 0)
+            g_cond_wait(&sched->done, &sched->lock);
+    }
+    g_mutex_unlock(&sched->lock);
+
+    /* Release queues and scheduler. */
+    for (cl_uint i = 0; i < sched->num_queues; ++i)
+        ccl_queue_destroy(sched->slots[i].cq);
+    g_free(sched->slots);
+    g_mutex_clear(&sched->lock);
+    g_cond_clear(&sched->done);
+    g_slice_free(CCLScheduler, sched);
+}
+
+/**
+ * Submit a task to a work-stealing scheduler. The task is placed in the
+ * pending list of the queue with the fewest pending and in-flight tasks,
+ * and pending tasks are run in the queues which have free slots.
+ *
+ * @public @memberof ccl_scheduler
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @param[in] task Task function, which enqueues the commands of the task.
+ * @param[in] user_data User data passed to `task`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise, e.g. if a task function run by this call fails.
+ * */
+CCL_EXPORT
+cl_bool ccl_scheduler_submit(CCLScheduler * sched, ccl_scheduler_task task,
+    void * user_data, CCLErr ** err) {
+
+    /* Make sure sched is not NULL. */
+    g_return_val_if_fail(sched != NULL, CL_FALSE);
+    /* Make sure task is not NULL. */
+    g_return_val_if_fail(task != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    struct ccl_scheduler_pending * pending;
+    struct ccl_scheduler_slot * slot, * least = NULL;
+
+    pending = g_slice_new(struct ccl_scheduler_pending);
+    pending->fn = task;
+    pending->user_data = user_data;
+
+    /* Place task in least loaded queue. */
+    g_mutex_lock(&sched->lock);
+    for (cl_uint i = 0; i < sched->num_queues; ++i) {
+        slot = &sched->slots[i];
+        if ((least == NULL) || (slot->pending.length + slot->inflight
+                < least->pending.length + least->inflight))
+            least = slot;
+    }
+    g_queue_push_tail(&least->pending, pending);
+    g_mutex_unlock(&sched->lock);
+
+    /* Run tasks in free slots. */
+    return ccl_scheduler_dispatch(sched, err);
+}
+
+/**
+ * Run pending tasks as slots are freed, and wait for all submitted tasks
+ * to complete. The calling thread sleeps while no pending task can run.
+ *
+ * @public @memberof ccl_scheduler
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise, e.g. if a task function or the commands of a task failed.
+ * */
+CCL_EXPORT
+cl_bool ccl_scheduler_wait(CCLScheduler * sched, CCLErr ** err) {
+
+    /* Make sure sched is not NULL. */
+    g_return_val_if_fail(sched != NULL, CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    cl_bool ret_status = CL_FALSE;
+    cl_bool busy, runnable;
+    cl_uint num_free;
+    guint num_pending;
+    cl_int status;
+
+    while (TRUE) {
+
+        /* Run pending tasks in free slots. */
+        ccl_scheduler_dispatch(sched, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Check whether tasks are in flight, and whether a pending task
+         * can run, since a slot may have been freed meanwhile. */
+        g_mutex_lock(&sched->lock);
+        busy = CL_FALSE;
+        num_free = 0;
+        num_pending = 0;
+        for (cl_uint i = 0; i < sched->num_queues; ++i) {
+            busy = busy || (sched->slots[i].inflight > 0);
+            num_free += sched->slots[i].inflight < sched->max_inflight;
+            num_pending += sched->slots[i].pending.length;
+        }
+        runnable = (num_free > 0) && (num_pending > 0);
+
+        /* Sleep until a task completes, if there is nothing to run. */
+        if (busy && !runnable)
+            g_cond_wait(&sched->done, &sched->lock);
+        g_mutex_unlock(&sched->lock);
+
+        if (!busy && !runnable) break;
+    }
+
+    /* Report failure of task commands, if any. */
+    g_mutex_lock(&sched->lock);
+    status = sched->status;
+    sched->status = CL_SUCCESS;
+    g_mutex_unlock(&sched->lock);
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR, status != CL_SUCCESS,
+        status, error_handler,
+        "%s: commands of scheduled task failed (OpenCL error %d: %s).",
+        CCL_STRD, status, ccl_err(status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    return ret_status;
+}
+
+/**
+ * Get number of tasks completed in a queue of a work-stealing scheduler,
+ * including stolen tasks.
+ *
+ * @public @memberof ccl_scheduler
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @param[in] index Index of queue, in the order given to
+ * ::ccl_scheduler_new().
+ * @return Number of tasks completed in queue.
+ * */
+CCL_EXPORT
+cl_uint ccl_scheduler_get_num_tasks(CCLScheduler * sched, cl_uint index) {
+
+    /* Make sure sched is not NULL. */
+    g_return_val_if_fail(sched != NULL, 0);
+    /* Make sure index is valid. */
+    g_return_val_if_fail(index < sched->num_queues, 0);
+
+    cl_uint num_tasks;
+
+    g_mutex_lock(&sched->lock);
+    num_tasks = sched->slots[index].num_tasks;
+    g_mutex_unlock(&sched->lock);
+
+    return num_tasks;
+}
+
+/**
+ * Get number of tasks stolen by idle queues of a work-stealing scheduler.
+ *
+ * @public @memberof ccl_scheduler
+ *
+ * @param[in] sched A work-stealing scheduler.
+ * @return Number of stolen tasks.
+ * */
+CCL_EXPORT
+cl_uint ccl_scheduler_get_num_steals(CCLScheduler * sched) {
+
+    /* Make sure sched is not NULL. */
+    g_return_val_if_fail(sched != NULL, 0);
+
+    cl_uint num_steals;
+
+    g_mutex_lock(&sched->lock);
+    num_steals = sched->num_steals;
+    g_mutex_unlock(&sched->lock);
+
+    return num_steals;
+}
+
+/** @} */
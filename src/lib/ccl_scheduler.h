@@ -0,0 +1,142 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of a work-stealing scheduler over a set of command queues.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_SCHEDULER_H_
+#define _CCL_SCHEDULER_H_
+
+#include "ccl_common.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_SCHEDULER Work-stealing scheduler
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides a scheduler which distributes many small
+ * independent tasks over a set of command queues, e.g. queues of
+ * different devices, keeping all of them busy even if task durations
+ * are irregular.
+ *
+ * A scheduler is created with ::ccl_scheduler_new(), which takes the
+ * command queues and the maximum number of tasks in flight in each
+ * queue. A task is a function which enqueues some commands in the queue
+ * it is given and returns the event of its last command. Tasks are
+ * submitted with ::ccl_scheduler_submit(), which places them in the
+ * pending list of the least loaded queue, and runs them immediately if
+ * the queue has a free slot. When a queue has a free slot but no pending
+ * tasks of its own, it steals the most recently submitted pending task
+ * of the queue with the most pending tasks.
+ *
+ * Task completion is tracked with event callbacks, so that no events are
+ * polled by the host. ::ccl_scheduler_wait() runs pending tasks as slots
+ * are freed, sleeping while all the slots with pending work are in use,
+ * and returns once all submitted tasks have completed. Task functions
+ * always run in the thread which calls ::ccl_scheduler_submit() or
+ * ::ccl_scheduler_wait(), and never in OpenCL callbacks.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLEvent * process_tile(CCLQueue * cq, void * user_data, CCLErr ** err) {
+ *     struct tile * t = (struct tile *) user_data;
+ *     return ccl_kernel_set_args_and_enqueue_ndrange(t->krnl, cq, 2,
+ *         t->offset, t->size, NULL, NULL, err, t->img, NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * CCLQueue * queues[] = { cq_gpu0, cq_gpu1, cq_cpu };
+ * CCLScheduler * sched = ccl_scheduler_new(queues, 3, 0, NULL);
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < num_tiles; ++i)
+ *     ccl_scheduler_submit(sched, process_tile, &tiles[i], NULL);
+ * ccl_scheduler_wait(sched, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_scheduler_destroy(sched);
+ * @endcode
+ *
+ * @attention A scheduler must only be used by one host thread at a time.
+ * Commands of different tasks may run concurrently in different queues,
+ * so tasks should not depend on each other.
+ *
+ * @note Requires OpenCL >= 1.1
+ *
+ * @{
+ */
+
+/**
+ * Default maximum number of tasks in flight in each queue.
+ * */
+#define CCL_SCHEDULER_MAX_INFLIGHT 2
+
+/**
+ * Work-stealing scheduler class.
+ * */
+typedef struct ccl_scheduler CCLScheduler;
+
+/**
+ * A scheduler task function, which enqueues the commands of the task.
+ *
+ * @param[in] cq Command queue in which the commands must be enqueued.
+ * @param[in] user_data User data given to ::ccl_scheduler_submit().
+ * @param[out] err Return location for a ::CCLErr object.
+ * @return Event of the last command of the task, which completes when
+ * the task completes, or `NULL` if an error occurs.
+ * */
+typedef CCLEvent * (*ccl_scheduler_task)(
+    CCLQueue * cq, void * user_data, CCLErr ** err);
+
+/* Create a new work-stealing scheduler over a set of command queues. */
+CCL_EXPORT
+CCLScheduler * ccl_scheduler_new(CCLQueue * const * queues,
+    cl_uint num_queues, cl_uint max_inflight, CCLErr ** err);
+
+/* Destroy a work-stealing scheduler. */
+CCL_EXPORT
+void ccl_scheduler_destroy(CCLScheduler * sched);
+
+/* Submit a task to a work-stealing scheduler. */
+CCL_EXPORT
+cl_bool ccl_scheduler_submit(CCLScheduler * sched, ccl_scheduler_task task,
+    void * user_data, CCLErr ** err);
+
+/* Run pending tasks and wait for all submitted tasks to complete. */
+CCL_EXPORT
+cl_bool ccl_scheduler_wait(CCLScheduler * sched, CCLErr ** err);
+
+/* Get number of tasks completed in a queue of a scheduler. */
+CCL_EXPORT
+cl_uint ccl_scheduler_get_num_tasks(CCLScheduler * sched, cl_uint index);
+
+/* Get number of tasks stolen by idle queues of a scheduler. */
+CCL_EXPORT
+cl_uint ccl_scheduler_get_num_steals(CCLScheduler * sched);
+
+/** @} */
+
+#endif
@@ -0,0 +1,1101 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of pinned host staging rings for asynchronous transfers.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_staging.h"
+#include "ccl_half.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+#include "_ccl_defs.h"
+#include <glib/gstdio.h>
+#include <string.h>
+
+/**
+ * Pinned host staging ring class.
+ *
+ * @extends ccl_buffer
+ * */
+struct ccl_staging {
+
+    /**
+     * Command queue where transfers are enqueued.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Pinned buffer holding all slots.
+     * @private
+     * */
+    CCLBuffer * buf;
+
+    /**
+     * Host address where the pinned buffer is mapped.
+     * @private
+     * */
+    char * base;
+
+    /**
+     * Event of the last transfer using each slot, or `NULL` if none is
+     * pending (array of `cl_event`, of size
+     * ::ccl_staging::num_slots).
+     * @private
+     * */
+    cl_event * evts;
+
+    /**
+     * Size of each slot in bytes.
+     * @private
+     * */
+    size_t slot_size;
+
+    /**
+     * Number of slots.
+     * @private
+     * */
+    cl_uint num_slots;
+
+    /**
+     * Next slot to use.
+     * @private
+     * */
+    cl_uint next;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Acquire the next slot of a staging ring, waiting for the last
+ * transfer using it to complete, if necessary.
+ *
+ * @param[in] stg A staging ring.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Host address of the acquired slot, or `NULL` if an error occurs.
+ * */
+static char * ccl_staging_acquire(CCLStaging * stg, CCLErr ** err) {
+
+    /* Acquired slot. */
+    cl_uint slot = stg->next;
+    /* OpenCL status. */
+    cl_int ocl_status = CL_SUCCESS;
+
+    /* Wait for the last transfer using the slot. */
+    if (stg->evts[slot] != NULL) {
+        ocl_status = clWaitForEvents(1, &stg->evts[slot]);
+        clReleaseEvent(stg->evts[slot]);
+        stg->evts[slot] = NULL;
+    }
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: error while waiting for staging slot (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Advance to the next slot. */
+    stg->next = (slot + 1) % stg->num_slots;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return stg->base + (size_t) slot * stg->slot_size;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Keep the event of a transfer using the last acquired slot.
+ *
+ * @param[in] stg A staging ring.
+ * @param[in] evt Event of transfer.
+ * */
+static void ccl_staging_keep(CCLStaging * stg, CCLEvent * evt) {
+
+    /* Last acquired slot. */
+    cl_uint slot = (stg->next + stg->num_slots - 1) % stg->num_slots;
+
+    /* Keep a reference to the OpenCL event, since event wrappers are
+     * owned by the command queue. */
+    stg->evts[slot] = ccl_event_unwrap(evt);
+    clRetainEvent(stg->evts[slot]);
+}
+
+/**
+ * @internal
+ *
+ * @brief Tile of an image read through a staging ring, which is copied to
+ * host memory once the read completes.
+ * */
+typedef struct ccl_staging_tile {
+
+    /**
+     * Origin of tile in image.
+     * @private
+     * */
+    size_t origin[3];
+
+    /**
+     * Region of tile in image.
+     * @private
+     * */
+    size_t region[3];
+
+    /**
+     * Staging slot where tile is read to.
+     * @private
+     * */
+    const char * src;
+
+    /**
+     * Host memory where tile is copied to.
+     * @private
+     * */
+    char * dst;
+
+    /**
+     * Event of read.
+     * @private
+     * */
+    CCLEvent * evt;
+
+} CCLStagingTile;
+
+/**
+ * @internal
+ *
+ * @brief Determine how an image region is split into tiles which fit in
+ * the slots of a staging ring. Each tile is a band of rows of a slice,
+ * staged with a row pitch aligned to ::CCL_STAGING_ROW_PITCH_ALIGN.
+ *
+ * @param[in] stg A staging ring.
+ * @param[in] img Image wrapper object.
+ * @param[in] region Region of image to transfer.
+ * @param[in,out] row_pitch Host row pitch, set if 0.
+ * @param[in,out] slice_pitch Host slice pitch, set if 0.
+ * @param[out] row_size Size in bytes of each row of the region.
+ * @param[out] tile_pitch Row pitch of tiles in staging slots.
+ * @param[out] tile_rows Maximum number of rows in each tile.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if tiling was determined, or `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_staging_image_tiling(CCLStaging * stg, CCLImage * img,
+    const size_t * region, size_t * row_pitch, size_t * slice_pitch,
+    size_t * row_size, size_t * tile_pitch, size_t * tile_rows,
+    CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    size_t elem_size;
+
+    /* Get size of image elements. */
+    elem_size = ccl_image_get_info_scalar(
+        img, CL_IMAGE_ELEMENT_SIZE, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Determine host pitches, as OpenCL does when they are 0. */
+    *row_size = region[0] * elem_size;
+    if (*row_pitch == 0) *row_pitch = *row_size;
+    if (*slice_pitch == 0) *slice_pitch = *row_pitch * region[1];
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (*row_pitch < *row_size) || (*slice_pitch < *row_pitch * region[1]),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: host row or slice pitch is too small for region.", CCL_STRD);
+
+    /* Determine staged row pitch and how many rows fit in a slot. */
+    *tile_pitch = ((*row_size + CCL_STAGING_ROW_PITCH_ALIGN - 1)
+        / CCL_STAGING_ROW_PITCH_ALIGN) * CCL_STAGING_ROW_PITCH_ALIGN;
+    *tile_rows = stg->slot_size / *tile_pitch;
+    ccl_if_err_create_goto(*err, CCL_ERROR, *tile_rows == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: staging slot size is too small for one image row.", CCL_STRD);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Copy a tile read through a staging ring to host memory, whose
+ * slot has just been acquired again, and notify client code.
+ *
+ * @param[in,out] tile Tile to copy, which is marked as done.
+ * @param[in] row_size Size in bytes of each row of the tile.
+ * @param[in] tile_pitch Row pitch of tile in staging slot.
+ * @param[in] row_pitch Host row pitch.
+ * @param[in] tile_fn Callback to invoke for tile, or `NULL`.
+ * @param[in] user_data Data to pass to callback.
+ * */
+static void ccl_staging_tile_done(CCLStagingTile * tile, size_t row_size,
+    size_t tile_pitch, size_t row_pitch, ccl_staging_tile_fn tile_fn,
+    void * user_data) {
+
+    for (size_t r = 0; r < tile->region[1]; ++r)
+        memcpy(tile->dst + r * row_pitch, tile->src + r * tile_pitch,
+            row_size);
+    if (tile_fn != NULL)
+        tile_fn(tile->origin, tile->region, tile->evt, user_data);
+    tile->evt = NULL;
+}
+
+/**
+ * @addtogroup CCL_STAGING
+ * @{
+ */
+
+/**
+ * Create a new pinned host staging ring for the given command queue. The
+ * pinned memory is allocated and mapped at once.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] cq In-order command queue wrapper object where transfers
+ * are enqueued.
+ * @param[in] slot_size Size of each slot in bytes, i.e. the maximum size
+ * of reads and of each part of writes.
+ * @param[in] num_slots Number of slots, i.e. the maximum number of pending
+ * transfers.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new staging ring, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLStaging * ccl_staging_new(CCLQueue * cq, size_t slot_size,
+    cl_uint num_slots, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLStaging * stg = NULL;
+    CCLContext * ctx;
+    cl_command_queue_properties props;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (cq == NULL) || (slot_size == 0) || (num_slots == 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: command queue, slot size and number of slots must be set.",
+        CCL_STRD);
+
+    /* Transfers of the same write may use several slots, so they must
+     * execute in order. */
+    props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, CCL_ERROR_ARGS,
+        error_handler, "%s: staging rings require in-order queues.",
+        CCL_STRD);
+
+    /* Get queue context. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create staging ring. */
+    stg = g_slice_new0(CCLStaging);
+    stg->cq = cq;
+    ccl_queue_ref(cq);
+    stg->evts = g_new0(cl_event, num_slots);
+    stg->slot_size = slot_size;
+    stg->num_slots = num_slots;
+
+    /* Allocate pinned memory for all slots. */
+    stg->buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+        slot_size * num_slots, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Map pinned memory once, for the lifetime of the staging ring. */
+    stg->base = ccl_buffer_enqueue_map(stg->buf, cq, CL_TRUE,
+        CL_MAP_READ | CL_MAP_WRITE, 0, slot_size * num_slots, NULL, NULL,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Destroy partially created staging ring. */
+    if (stg != NULL) {
+        ccl_staging_destroy(stg);
+        stg = NULL;
+    }
+
+finish:
+
+    /* Return staging ring. */
+    return stg;
+}
+
+/**
+ * Destroy a staging ring, waiting for pending transfers and unmapping and
+ * releasing its pinned memory.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg The staging ring to destroy.
+ * */
+CCL_EXPORT
+void ccl_staging_destroy(CCLStaging * stg) {
+
+    /* Make sure stg is not NULL. */
+    g_return_if_fail(stg != NULL);
+
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+
+    /* Wait for pending transfers. */
+    for (cl_uint i = 0; i < stg->num_slots; ++i) {
+        if (stg->evts[i] != NULL) {
+            clWaitForEvents(1, &stg->evts[i]);
+            clReleaseEvent(stg->evts[i]);
+        }
+    }
+
+    /* Unmap and release pinned memory. */
+    if (stg->base != NULL) {
+        evt = ccl_buffer_enqueue_unmap(stg->buf, stg->cq, stg->base, NULL,
+            NULL);
+        if (evt != NULL)
+            ccl_event_wait(ccl_ewl(&ewl, evt, NULL), NULL);
+    }
+    if (stg->buf != NULL)
+        ccl_buffer_destroy(stg->buf);
+
+    g_free(stg->evts);
+    ccl_queue_unref(stg->cq);
+    g_slice_free(CCLStaging, stg);
+}
+
+/**
+ * Asynchronously write host memory to a buffer through a staging ring.
+ * Host data is copied to pinned memory, from where a non-blocking write
+ * is enqueued, so host memory can be reused as soon as this function
+ * returns. Writes larger than the slot size are split across slots.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg A staging ring.
+ * @param[out] buf Buffer wrapper object where to write to.
+ * @param[in] offset The offset in bytes in the buffer object to write to.
+ * @param[in] size The size in bytes of data being written.
+ * @param[in] ptr The pointer to buffer in host memory where data is to be
+ * written from.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the (last part of the)
+ * write, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, size_t size, const void * ptr,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    char * slot;
+    size_t chunk;
+
+    /* Write each part through the next slot. The wait list only applies
+     * to the first part, since the queue is in-order. */
+    for (size_t done = 0; done < size; done += chunk) {
+
+        chunk = MIN(stg->slot_size, size - done);
+
+        /* Copy part of host data to pinned memory. */
+        slot = ccl_staging_acquire(stg, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        memcpy(slot, (const char *) ptr + done, chunk);
+
+        /* Enqueue non-blocking write from pinned memory. */
+        evt = ccl_buffer_enqueue_write(buf, stg->cq, CL_FALSE,
+            offset + done, chunk, slot, done == 0 ? evt_wait_lst : NULL,
+            &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_staging_keep(stg, evt);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Asynchronously convert single precision values to half precision and
+ * write them to a buffer through a staging ring. Values are converted
+ * directly into pinned memory with ::ccl_half_from_float_array(), from
+ * where a non-blocking write is enqueued, so no intermediate half
+ * precision copy of the data is required, and host memory can be reused
+ * as soon as this function returns. Writes larger than the slot size are
+ * split across slots.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg A staging ring.
+ * @param[out] buf Buffer wrapper object where to write to.
+ * @param[in] offset The offset in bytes in the buffer object to write to.
+ * @param[in] ptr Single precision values to convert and write.
+ * @param[in] n Number of values to convert and write.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the (last part of the)
+ * write, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write_half(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, const cl_float * ptr, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    char * slot;
+    size_t chunk;
+    size_t slot_len = stg->slot_size / sizeof(cl_half);
+
+    /* Check that at least one value fits in a slot. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, slot_len == 0,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: staging slot size is too small for half values.", CCL_STRD);
+
+    /* Convert and write each part through the next slot. The wait list
+     * only applies to the first part, since the queue is in-order. */
+    for (size_t done = 0; done < n; done += chunk) {
+
+        chunk = MIN(slot_len, n - done);
+
+        /* Convert part of host data into pinned memory. */
+        slot = ccl_staging_acquire(stg, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_half_from_float_array((cl_half *) slot, ptr + done, chunk);
+
+        /* Enqueue non-blocking write from pinned memory. */
+        evt = ccl_buffer_enqueue_write(buf, stg->cq, CL_FALSE,
+            offset + done * sizeof(cl_half), chunk * sizeof(cl_half),
+            slot, done == 0 ? evt_wait_lst : NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_staging_keep(stg, evt);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Asynchronously read a buffer to a slot of a staging ring. A
+ * non-blocking read to pinned memory is enqueued, and the address of the
+ * pinned memory is returned, where data is available once the read
+ * completes. This address is valid until the slot is reused.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg A staging ring.
+ * @param[in] buf Buffer wrapper object where to read from.
+ * @param[in] offset The offset in bytes in the buffer object to read from.
+ * @param[in] size The size in bytes of data being read, which cannot be
+ * larger than the slot size.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] evt An event wrapper object that identifies this read
+ * command. If `NULL`, no event will be returned.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Address of pinned memory where data is read to, or `NULL` if an
+ * error occurs.
+ * */
+CCL_EXPORT
+void * ccl_staging_enqueue_read(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, size_t size, CCLEventWaitList * evt_wait_lst,
+    CCLEvent ** evt, CCLErr ** err) {
+
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, NULL);
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt_inner;
+    char * slot = NULL;
+
+    /* Check that data fits in a slot. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, size > stg->slot_size,
+        CCL_ERROR_ARGS, error_handler,
+        "%s: read size is larger than the staging slot size.", CCL_STRD);
+
+    /* Acquire slot. */
+    slot = ccl_staging_acquire(stg, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Enqueue non-blocking read to pinned memory. */
+    evt_inner = ccl_buffer_enqueue_read(buf, stg->cq, CL_FALSE, offset,
+        size, slot, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_staging_keep(stg, evt_inner);
+
+    /* Set event, if required by client. */
+    if (evt != NULL) *evt = evt_inner;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    slot = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return address of pinned memory. */
+    return slot;
+}
+
+/**
+ * Asynchronously write an image region tile by tile through a staging
+ * ring. The region is split into bands of rows which fit in a slot. The
+ * rows of each band are copied to pinned memory with a row pitch aligned
+ * to ::CCL_STAGING_ROW_PITCH_ALIGN, and a non-blocking write of the band
+ * is enqueued and flushed, so that the transfer of a tile overlaps with
+ * the staging of the following ones. Host memory can be reused as soon as
+ * this function returns.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg A staging ring.
+ * @param[out] img Image wrapper object where to write to.
+ * @param[in] origin Origin of region in image (array of three elements).
+ * @param[in] region Region of image to write (array of three elements).
+ * @param[in] row_pitch Length of each row in bytes in host memory, or 0
+ * if rows are tightly packed.
+ * @param[in] slice_pitch Size of each slice in bytes in host memory, or 0
+ * if slices are tightly packed.
+ * @param[in] ptr The pointer to host memory where data is to be written
+ * from.
+ * @param[in] tile_fn Callback invoked after the write of each tile is
+ * enqueued, with the tile's event, or `NULL`.
+ * @param[in] user_data Data to pass to callback.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first tile can be written. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the write of the last
+ * tile, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write_image(CCLStaging * stg, CCLImage * img,
+    const size_t * origin, const size_t * region, size_t row_pitch,
+    size_t slice_pitch, const void * ptr, ccl_staging_tile_fn tile_fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, NULL);
+    /* Make sure img is not NULL. */
+    g_return_val_if_fail(img != NULL, NULL);
+    /* Make sure origin and region are not NULL. */
+    g_return_val_if_fail((origin != NULL) && (region != NULL), NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    cl_bool first = CL_TRUE;
+    size_t row_size, tile_pitch, tile_rows;
+    size_t t_origin[3], t_region[3];
+    const char * src;
+    char * slot;
+
+    /* Determine tiling. */
+    ccl_staging_image_tiling(stg, img, region, &row_pitch, &slice_pitch,
+        &row_size, &tile_pitch, &tile_rows, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Write each band of rows of each slice through the next slot. The
+     * wait list only applies to the first tile, since the queue is
+     * in-order. */
+    t_origin[0] = origin[0];
+    t_region[0] = region[0];
+    t_region[2] = 1;
+    for (size_t z = 0; z < region[2]; ++z) {
+        for (size_t y = 0; y < region[1]; y += tile_rows) {
+
+            t_origin[1] = origin[1] + y;
+            t_origin[2] = origin[2] + z;
+            t_region[1] = MIN(tile_rows, region[1] - y);
+
+            /* Stage rows of tile in pinned memory. */
+            slot = ccl_staging_acquire(stg, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            src = (const char *) ptr + z * slice_pitch + y * row_pitch;
+            for (size_t r = 0; r < t_region[1]; ++r)
+                memcpy(slot + r * tile_pitch, src + r * row_pitch,
+                    row_size);
+
+            /* Enqueue non-blocking write of tile from pinned memory, and
+             * submit it so that it proceeds while the next tile is
+             * staged. */
+            evt = ccl_image_enqueue_write(img, stg->cq, CL_FALSE, t_origin,
+                t_region, tile_pitch, 0, slot,
+                first ? evt_wait_lst : NULL, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            ccl_staging_keep(stg, evt);
+            ccl_queue_flush(stg->cq, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            first = CL_FALSE;
+
+            /* Let client code use the tile. */
+            if (tile_fn != NULL)
+                tile_fn(t_origin, t_region, evt, user_data);
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Read an image region tile by tile through a staging ring. The region is
+ * split into bands of rows which fit in a slot, and a non-blocking read
+ * of each band to pinned memory is enqueued and flushed. Each band is
+ * copied to host memory when its slot is about to be reused, or at the
+ * end, so that the copies overlap with the transfer of the following
+ * tiles. This function returns when the whole region is in host memory.
+ *
+ * @public @memberof ccl_staging
+ *
+ * @param[in] stg A staging ring.
+ * @param[in] img Image wrapper object where to read from.
+ * @param[in] origin Origin of region in image (array of three elements).
+ * @param[in] region Region of image to read (array of three elements).
+ * @param[in] row_pitch Length of each row in bytes in host memory, or 0
+ * if rows are tightly packed.
+ * @param[in] slice_pitch Size of each slice in bytes in host memory, or 0
+ * if slices are tightly packed.
+ * @param[out] ptr The pointer to host memory where data is to be read
+ * into.
+ * @param[in] tile_fn Callback invoked when each tile is available in host
+ * memory, or `NULL`.
+ * @param[in] user_data Data to pass to callback.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first tile can be read. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the region was read, or `CL_FALSE` otherwise.
+ * */
+CCL_EXPORT
+cl_bool ccl_staging_read_image(CCLStaging * stg, CCLImage * img,
+    const size_t * origin, const size_t * region, size_t row_pitch,
+    size_t slice_pitch, void * ptr, ccl_staging_tile_fn tile_fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, CL_FALSE);
+    /* Make sure img is not NULL. */
+    g_return_val_if_fail(img != NULL, CL_FALSE);
+    /* Make sure origin and region are not NULL. */
+    g_return_val_if_fail((origin != NULL) && (region != NULL), CL_FALSE);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+    CCLErr * err_internal = NULL;
+    CCLStagingTile * tiles;
+    CCLStagingTile * tile;
+    cl_bool ret_status;
+    cl_bool first = CL_TRUE;
+    size_t row_size, tile_pitch, tile_rows;
+    char * slot;
+
+    /* Tiles pending copy to host, by slot. */
+    tiles = g_new0(CCLStagingTile, stg->num_slots);
+
+    /* Determine tiling. */
+    ccl_staging_image_tiling(stg, img, region, &row_pitch, &slice_pitch,
+        &row_size, &tile_pitch, &tile_rows, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Read each band of rows of each slice to the next slot. The wait list
+     * only applies to the first tile, since the queue is in-order. */
+    for (size_t z = 0; z < region[2]; ++z) {
+        for (size_t y = 0; y < region[1]; y += tile_rows) {
+
+            /* Acquire slot, copying the tile previously read to it. */
+            tile = &tiles[stg->next];
+            slot = ccl_staging_acquire(stg, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            if (tile->evt != NULL)
+                ccl_staging_tile_done(tile, row_size, tile_pitch,
+                    row_pitch, tile_fn, user_data);
+
+            /* Describe tile. */
+            tile->origin[0] = origin[0];
+            tile->origin[1] = origin[1] + y;
+            tile->origin[2] = origin[2] + z;
+            tile->region[0] = region[0];
+            tile->region[1] = MIN(tile_rows, region[1] - y);
+            tile->region[2] = 1;
+            tile->src = slot;
+            tile->dst = (char *) ptr + z * slice_pitch + y * row_pitch;
+
+            /* Enqueue non-blocking read of tile to pinned memory, and
+             * submit it so that it proceeds while previous tiles are
+             * copied. */
+            tile->evt = ccl_image_enqueue_read(img, stg->cq, CL_FALSE,
+                tile->origin, tile->region, tile_pitch, 0, slot,
+                first ? evt_wait_lst : NULL, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            ccl_staging_keep(stg, tile->evt);
+            ccl_queue_flush(stg->cq, &err_internal);
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+            first = CL_FALSE;
+        }
+    }
+
+    /* Copy remaining tiles, acquiring slots from the oldest one. */
+    for (cl_uint i = 0; i < stg->num_slots; ++i) {
+        tile = &tiles[stg->next];
+        ccl_staging_acquire(stg, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (tile->evt != NULL)
+            ccl_staging_tile_done(tile, row_size, tile_pitch, row_pitch,
+                tile_fn, user_data);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release tile descriptions. */
+    g_free(tiles);
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Stream a file into a buffer through a staging ring. The file is read in
+ * chunks of the slot size directly into pinned memory, and a non-blocking
+ * write is enqueued and flushed for each chunk, so that the upload of a
+ * chunk overlaps with reading the following ones from disk. Host memory
+ * used is therefore limited to the staging ring.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[out] buf Buffer wrapper object where to write to.
+ * @param[in] stg A staging ring, whose command queue is used for the
+ * writes.
+ * @param[in] offset The offset in bytes in the buffer object to write to.
+ * The whole file must fit in the buffer after this offset.
+ * @param[in] filename Name of file to write to buffer.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the first write can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the last write, or `NULL`
+ * if an error occurs or if the file is empty.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_write_from_file(CCLBuffer * buf,
+    CCLStaging * stg, size_t offset, const char * filename,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure buf is not NULL. */
+    g_return_val_if_fail(buf != NULL, NULL);
+    /* Make sure stg is not NULL. */
+    g_return_val_if_fail(stg != NULL, NULL);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    FILE * fp = NULL;
+    char * slot;
+    size_t buf_size, chunk, done = 0;
+
+    /* Get buffer size. */
+    buf_size = ccl_memobj_get_info_scalar(
+        buf, CL_MEM_SIZE, size_t, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Open file. */
+    fp = g_fopen(filename, "rb");
+    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
+        CCL_ERROR_OPENFILE, error_handler,
+        "%s: unable to open file '%s'.", CCL_STRD, filename);
+
+    /* Read file into each slot in turn, until the end of file, and write
+     * it from there. The wait list only applies to the first write, since
+     * the queue is in-order. */
+    do {
+
+        /* Read next chunk into pinned memory. */
+        slot = ccl_staging_acquire(stg, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        chunk = fread(slot, 1, stg->slot_size, fp);
+        ccl_if_err_create_goto(*err, CCL_ERROR, ferror(fp),
+            CCL_ERROR_OPENFILE, error_handler,
+            "%s: unable to read file '%s'.", CCL_STRD, filename);
+        if (chunk == 0) break;
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (offset > buf_size) || (done + chunk > buf_size - offset),
+            CCL_ERROR_ARGS, error_handler,
+            "%s: file '%s' does not fit in buffer.", CCL_STRD, filename);
+
+        /* Enqueue non-blocking write from pinned memory, and submit it so
+         * that it proceeds while the next chunk is read. */
+        evt = ccl_buffer_enqueue_write(buf, stg->cq, CL_FALSE,
+            offset + done, chunk, slot, done == 0 ? evt_wait_lst : NULL,
+            &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_staging_keep(stg, evt);
+        ccl_queue_flush(stg->cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        done += chunk;
+
+    } while (chunk == stg->slot_size);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Close file. */
+    if (fp != NULL) fclose(fp);
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Create a buffer with the size and contents of a file. The file is
+ * streamed into the buffer with ::ccl_buffer_enqueue_write_from_file()
+ * through a temporary staging ring of ::CCL_STAGING_FILE_NUM_SLOTS slots
+ * of `chunk_size` bytes each, so that the whole file is never held in
+ * host memory. This function returns when the upload is complete.
+ *
+ * @public @memberof ccl_buffer
+ *
+ * @param[in] cq In-order command queue wrapper object where the file is
+ * uploaded. The buffer is created in the queue context.
+ * @param[in] flags OpenCL memory flags as used in clCreateBuffer(), which
+ * cannot include `CL_MEM_USE_HOST_PTR` nor `CL_MEM_COPY_HOST_PTR`.
+ * @param[in] filename Name of file to create buffer from.
+ * @param[in] chunk_size Size in bytes of the chunks in which the file is
+ * read and uploaded, or 0 for ::CCL_STAGING_FILE_CHUNK_SIZE.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new buffer wrapper object, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_from_file(CCLQueue * cq, cl_mem_flags flags,
+    const char * filename, size_t chunk_size, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure filename is not NULL. */
+    g_return_val_if_fail(filename != NULL, NULL);
+    /* Make sure no host pointer is required. */
+    g_return_val_if_fail(
+        (flags & (CL_MEM_USE_HOST_PTR | CL_MEM_COPY_HOST_PTR)) == 0, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx;
+    CCLBuffer * buf = NULL;
+    CCLStaging * stg = NULL;
+    GStatBuf st;
+    size_t size;
+
+    /* Determine file size. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, g_stat(filename, &st) != 0,
+        CCL_ERROR_OPENFILE, error_handler,
+        "%s: unable to open file '%s'.", CCL_STRD, filename);
+    size = (size_t) st.st_size;
+    ccl_if_err_create_goto(*err, CCL_ERROR, size == 0,
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "%s: file '%s' is empty.", CCL_STRD, filename);
+
+    /* Create buffer. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    buf = ccl_buffer_new(ctx, flags, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create staging ring, with slots no larger than the file. */
+    if (chunk_size == 0) chunk_size = CCL_STAGING_FILE_CHUNK_SIZE;
+    stg = ccl_staging_new(cq, MIN(chunk_size, size),
+        CCL_STAGING_FILE_NUM_SLOTS, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Stream file into buffer. */
+    ccl_buffer_enqueue_write_from_file(
+        buf, stg, 0, filename, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release buffer, if it was created. A staging ring, if any, is
+     * destroyed first, waiting for pending writes. */
+    if (stg != NULL) {
+        ccl_staging_destroy(stg);
+        stg = NULL;
+    }
+    if (buf != NULL) {
+        ccl_buffer_destroy(buf);
+        buf = NULL;
+    }
+
+finish:
+
+    /* Destroy staging ring, which waits for the upload to complete. */
+    if (stg != NULL) ccl_staging_destroy(stg);
+
+    /* Return buffer. */
+    return buf;
+}
+
+/** @} */
@@ -0,0 +1,213 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of pinned host staging rings for asynchronous transfers.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_STAGING_H_
+#define _CCL_STAGING_H_
+
+#include "ccl_common.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_image_wrapper.h"
+
+/**
+ * @defgroup CCL_STAGING Staging rings
+ * @ingroup CCL_BUFFER_WRAPPER
+ *
+ * This module provides rings of pinned host staging memory for
+ * asynchronous transfers between host and buffers.
+ *
+ * Non-blocking ::ccl_buffer_enqueue_write() and
+ * ::ccl_buffer_enqueue_read() calls on pageable host memory usually
+ * require the driver to perform an internal staging copy, which prevents
+ * transfers from overlapping with computations. A staging ring keeps a
+ * fixed number of slots of pinned host memory, allocated with
+ * `CL_MEM_ALLOC_HOST_PTR` and mapped once, from and to which transfers are
+ * performed by DMA.
+ *
+ * Writes with ::ccl_staging_enqueue_write() copy host data to the next
+ * slot and enqueue a non-blocking write from it, so host data can be
+ * reused as soon as the function returns. Writes larger than a slot are
+ * split across slots. Reads with ::ccl_staging_enqueue_read() enqueue a
+ * non-blocking read to the next slot and return a pointer to it, from
+ * where data can be used (or copied) once the read completes. Slots are
+ * used in a round-robin fashion: if the transfer which last used a slot
+ * has not completed, the host waits for it before reusing the slot.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLStaging * stg;
+ * CCLEvent * evt;
+ * cl_float * res;
+ * @endcode
+ * @code{.c}
+ * stg = ccl_staging_new(cq, 1024 * 1024, 4, NULL);
+ * @endcode
+ * @code{.c}
+ * for (frame = 0; frame < num_frames; ++frame) {
+ *     ccl_staging_enqueue_write(stg, buf_in, 0, size, host_in, NULL, NULL);
+ *     ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, NULL, NULL, NULL);
+ *     res = ccl_staging_enqueue_read(
+ *         stg, buf_out, 0, size, NULL, &evt, NULL);
+ *     ccl_event_wait(ccl_ewl(&ewl, evt, NULL), NULL);
+ *     consume_results(res);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_staging_destroy(stg);
+ * @endcode
+ *
+ * Single precision data can be converted to half precision on the fly
+ * while being staged with ::ccl_staging_enqueue_write_half().
+ *
+ * Image regions are transferred tile by tile with
+ * ::ccl_staging_enqueue_write_image() and ::ccl_staging_read_image().
+ * Each tile is a band of image rows which fits in a slot, staged with a
+ * row pitch aligned to ::CCL_STAGING_ROW_PITCH_ALIGN bytes. An optional
+ * ::ccl_staging_tile_fn callback is invoked for each tile, so that, for
+ * example, a kernel processing the tile can be enqueued in another
+ * queue, waiting only for the tile's event, before the remaining tiles
+ * have arrived:
+ *
+ * @code{.c}
+ * void filter_tile(const size_t * origin, const size_t * region,
+ *     CCLEvent * evt, void * user_data) {
+ *     CCLEventWaitList ewl = NULL;
+ *     size_t offset[2] = { origin[0], origin[1] };
+ *     ccl_kernel_enqueue_ndrange(krnl, cq_comp, 2, offset, region, NULL,
+ *         ccl_ewl(&ewl, evt, NULL), NULL);
+ * }
+ * @endcode
+ * @code{.c}
+ * ccl_staging_enqueue_write_image(stg, img, origin, region, 0, 0,
+ *     host_img, filter_tile, NULL, NULL, NULL);
+ * @endcode
+ *
+ * Files are streamed into buffers with
+ * ::ccl_buffer_enqueue_write_from_file(), which reads each chunk of the
+ * file directly into the next slot, or with ::ccl_buffer_new_from_file(),
+ * which creates a buffer with the size of the file and streams it through
+ * a temporary staging ring. Peak host memory is thus limited to a few
+ * chunks, and disk reads overlap with uploads.
+ *
+ * @attention Staging rings are not thread-safe. Data returned by
+ * ::ccl_staging_enqueue_read() is only valid until its slot is reused,
+ * i.e. until as many further transfers as there are slots are enqueued.
+ *
+ * @{
+ */
+
+/**
+ * Default size in bytes of the chunks in which ::ccl_buffer_new_from_file()
+ * reads and uploads files.
+ * */
+#define CCL_STAGING_FILE_CHUNK_SIZE (4 << 20)
+
+/**
+ * Number of staging slots used by ::ccl_buffer_new_from_file().
+ * */
+#define CCL_STAGING_FILE_NUM_SLOTS 3
+
+/**
+ * Alignment in bytes of the row pitch of image tiles staged by
+ * ::ccl_staging_enqueue_write_image() and ::ccl_staging_read_image().
+ * */
+#define CCL_STAGING_ROW_PITCH_ALIGN 256
+
+/**
+ * Callback invoked for each tile of an image transfer performed through a
+ * staging ring.
+ *
+ * @param[in] origin Origin of tile in image (array of three elements).
+ * @param[in] region Region of tile in image (array of three elements).
+ * @param[in] evt Event wrapper object of the transfer of the tile.
+ * @param[in] user_data Data supplied by client code.
+ * */
+typedef void (*ccl_staging_tile_fn)(const size_t * origin,
+    const size_t * region, CCLEvent * evt, void * user_data);
+
+/**
+ * Pinned host staging ring class.
+ * */
+typedef struct ccl_staging CCLStaging;
+
+/* Create a new pinned host staging ring for the given command queue. */
+CCL_EXPORT
+CCLStaging * ccl_staging_new(CCLQueue * cq, size_t slot_size,
+    cl_uint num_slots, CCLErr ** err);
+
+/* Destroy a staging ring, waiting for pending transfers. */
+CCL_EXPORT
+void ccl_staging_destroy(CCLStaging * stg);
+
+/* Asynchronously write host memory to a buffer through a staging ring. */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, size_t size, const void * ptr,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Asynchronously convert single precision values to half precision and
+ * write them to a buffer through a staging ring. */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write_half(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, const cl_float * ptr, size_t n,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Asynchronously read a buffer to a slot of a staging ring. */
+CCL_EXPORT
+void * ccl_staging_enqueue_read(CCLStaging * stg, CCLBuffer * buf,
+    size_t offset, size_t size, CCLEventWaitList * evt_wait_lst,
+    CCLEvent ** evt, CCLErr ** err);
+
+/* Asynchronously write an image region tile by tile through a staging
+ * ring. */
+CCL_EXPORT
+CCLEvent * ccl_staging_enqueue_write_image(CCLStaging * stg, CCLImage * img,
+    const size_t * origin, const size_t * region, size_t row_pitch,
+    size_t slice_pitch, const void * ptr, ccl_staging_tile_fn tile_fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Read an image region tile by tile through a staging ring. */
+CCL_EXPORT
+cl_bool ccl_staging_read_image(CCLStaging * stg, CCLImage * img,
+    const size_t * origin, const size_t * region, size_t row_pitch,
+    size_t slice_pitch, void * ptr, ccl_staging_tile_fn tile_fn,
+    void * user_data, CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Stream a file into a buffer through a staging ring. */
+CCL_EXPORT
+CCLEvent * ccl_buffer_enqueue_write_from_file(CCLBuffer * buf,
+    CCLStaging * stg, size_t offset, const char * filename,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Create a buffer with the size and contents of a file. */
+CCL_EXPORT
+CCLBuffer * ccl_buffer_new_from_file(CCLQueue * cq, cl_mem_flags flags,
+    const char * filename, size_t chunk_size, CCLErr ** err);
+
+/** @} */
+
+#endif
@@ -0,0 +1,418 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of a multi-producer submission front-end for command
+ * queues.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_submitter.h"
+#include "_ccl_future.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief A slot of the ring of submitted commands.
+ *
+ * Each slot has a sequence number, which tells producers and the
+ * submitter thread whether the slot is free or holds a command for the
+ * current round of the ring.
+ * */
+struct ccl_submitter_slot {
+
+    /**
+     * Sequence number of slot. A slot at ring position `pos` is free if
+     * its sequence number is `pos`, and holds a command if it is
+     * `pos + 1`.
+     * @private
+     * */
+    gint seq;
+
+    /**
+     * Command function.
+     * @private
+     * */
+    ccl_submitter_cmd cmd;
+
+    /**
+     * User data for command function.
+     * @private
+     * */
+    void * user_data;
+
+    /**
+     * Future completed when the command completes.
+     * @private
+     * */
+    CCLFuture * fut;
+
+};
+
+/**
+ * Multi-producer submission front-end class.
+ * */
+struct ccl_submitter {
+
+    /**
+     * Command queue wrapper.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Ring of submitted commands.
+     * @private
+     * */
+    struct ccl_submitter_slot * ring;
+
+    /**
+     * Mask giving the slot of a ring position, i.e. number of slots
+     * minus one.
+     * @private
+     * */
+    guint mask;
+
+    /**
+     * Next ring position to be claimed by a producer.
+     * @private
+     * */
+    gint head;
+
+    /**
+     * Next ring position to be taken by the submitter thread, which is
+     * the only one to access it.
+     * @private
+     * */
+    guint tail;
+
+    /**
+     * Is the submitter thread sleeping, or about to, on an empty ring?
+     * @private
+     * */
+    gint sleeping;
+
+    /**
+     * Was the submitter asked to stop?
+     * @private
+     * */
+    gint stop;
+
+    /**
+     * Lock used to put the submitter thread to sleep.
+     * @private
+     * */
+    GMutex lock;
+
+    /**
+     * Condition signaled when commands are submitted to a sleeping
+     * submitter thread, or when it is asked to stop.
+     * @private
+     * */
+    GCond wake;
+
+    /**
+     * Submitter thread.
+     * @private
+     * */
+    GThread * thread;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Get the slot at the tail of the ring if it holds a command.
+ * Only called by the submitter thread.
+ *
+ * @param[in] sub A submission front-end.
+ * @return The slot at the tail of the ring, or `NULL` if the ring is
+ * empty.
+ * */
+static struct ccl_submitter_slot * ccl_submitter_peek(CCLSubmitter * sub) {
+
+    struct ccl_submitter_slot * slot = &sub->ring[sub->tail & sub->mask];
+
+    return (guint) g_atomic_int_get(&slot->seq) == sub->tail + 1
+        ? slot : NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Enqueue a submitted command and track its completion with its
+ * future. Errors are reported through the execution status of the
+ * future.
+ *
+ * @param[in] sub A submission front-end.
+ * @param[in] slot Slot holding the command.
+ * */
+static void ccl_submitter_run(
+    CCLSubmitter * sub, struct ccl_submitter_slot * slot) {
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt;
+
+    evt = slot->cmd(sub->cq, slot->user_data, &err_internal);
+    if (err_internal != NULL) {
+        ccl_future_resolve(slot->fut, err_internal->domain == CCL_OCL_ERROR
+            ? err_internal->code : CL_INVALID_OPERATION);
+        g_error_free(err_internal);
+    } else if (evt != NULL) {
+        ccl_future_resolve_event(slot->fut, evt);
+    } else {
+        /* Commands in event-less queues are complete as far as the
+         * submitter can tell. */
+        ccl_future_resolve(slot->fut, CL_COMPLETE);
+    }
+}
+
+/**
+ * @internal
+ *
+ * @brief Submitter thread function, which enqueues submitted commands
+ * until the submitter is asked to stop and its ring is empty.
+ *
+ * @param[in] data The submission front-end.
+ * @return `NULL`.
+ * */
+static gpointer ccl_submitter_loop(gpointer data) {
+
+    CCLSubmitter * sub = (CCLSubmitter *) data;
+    struct ccl_submitter_slot * slot;
+    cl_bool flush = CL_FALSE;
+
+    while (TRUE) {
+
+        /* Take next command, freeing its slot for the next round of the
+         * ring. */
+        slot = ccl_submitter_peek(sub);
+        if (slot != NULL) {
+            ccl_submitter_run(sub, slot);
+            g_atomic_int_set(&slot->seq, (gint) (sub->tail + sub->mask + 1));
+            sub->tail++;
+            flush = CL_TRUE;
+            continue;
+        }
+
+        /* The ring is empty, submit enqueued commands to the device, so
+         * that their futures are completed. */
+        if (flush) {
+            ccl_queue_flush(sub->cq, NULL);
+            flush = CL_FALSE;
+            continue;
+        }
+
+        /* Sleep until commands are submitted or the submitter is asked
+         * to stop. The ring is checked again after announcing that the
+         * thread is going to sleep, since a producer which placed a
+         * command before that does not know it should wake the thread. */
+        g_mutex_lock(&sub->lock);
+        g_atomic_int_set(&sub->sleeping, 1);
+        if ((ccl_submitter_peek(sub) == NULL)
+                && !g_atomic_int_get(&sub->stop))
+            g_cond_wait(&sub->wake, &sub->lock);
+        g_atomic_int_set(&sub->sleeping, 0);
+        g_mutex_unlock(&sub->lock);
+
+        /* Stop if asked to and there are no commands left. */
+        if (g_atomic_int_get(&sub->stop) && (ccl_submitter_peek(sub) == NULL))
+            break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @addtogroup CCL_SUBMITTER
+ * @{
+ */
+
+/**
+ * Create a submission front-end for a command queue, starting its
+ * submitter thread.
+ *
+ * @public @memberof ccl_submitter
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] cq Command queue wrapper object, which is kept alive by the
+ * submitter.
+ * @param[in] ring_size Number of commands which fit in the ring, rounded
+ * up to a power of two, or 0 for ::CCL_SUBMITTER_RING_SIZE. Producers
+ * wait for free slots when the ring is full.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new submission front-end, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLSubmitter * ccl_submitter_new(
+    CCLQueue * cq, cl_uint ring_size, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLSubmitter * sub;
+    guint num_slots;
+
+    /* Determine number of slots, a power of two. */
+    num_slots = 1u << g_bit_storage(
+        (ring_size > 0 ? ring_size : CCL_SUBMITTER_RING_SIZE) - 1);
+
+    /* Create submitter, with all slots free for the first round. */
+    sub = g_slice_new0(CCLSubmitter);
+    sub->ring = g_new0(struct ccl_submitter_slot, num_slots);
+    sub->mask = num_slots - 1;
+    for (guint i = 0; i < num_slots; ++i)
+        sub->ring[i].seq = (gint) i;
+    g_mutex_init(&sub->lock);
+    g_cond_init(&sub->wake);
+    ccl_queue_ref(cq);
+    sub->cq = cq;
+
+    /* Start submitter thread. */
+    sub->thread = g_thread_try_new(
+        "ccl_submitter", ccl_submitter_loop, sub, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Release what was created so far. */
+    ccl_submitter_destroy(sub);
+    sub = NULL;
+
+finish:
+
+    /* Return submitter. */
+    return sub;
+}
+
+/**
+ * Destroy a submission front-end, releasing its queue. Commands
+ * submitted before this call are enqueued before it returns, although
+ * they might not have completed yet.
+ *
+ * @public @memberof ccl_submitter
+ *
+ * @param[in] sub The submission front-end to destroy.
+ * */
+CCL_EXPORT
+void ccl_submitter_destroy(CCLSubmitter * sub) {
+
+    /* Make sure sub is not NULL. */
+    g_return_if_fail(sub != NULL);
+
+    /* Stop submitter thread and wait for it to enqueue the commands left
+     * in the ring. */
+    if (sub->thread != NULL) {
+        g_mutex_lock(&sub->lock);
+        g_atomic_int_set(&sub->stop, 1);
+        g_cond_signal(&sub->wake);
+        g_mutex_unlock(&sub->lock);
+        g_thread_join(sub->thread);
+    }
+
+    /* Submit last commands to the device. */
+    ccl_queue_flush(sub->cq, NULL);
+
+    /* Release submitter. */
+    ccl_queue_destroy(sub->cq);
+    g_free(sub->ring);
+    g_mutex_clear(&sub->lock);
+    g_cond_clear(&sub->wake);
+    g_slice_free(CCLSubmitter, sub);
+}
+
+/**
+ * Submit a command to a submission front-end. This function is
+ * thread-safe and lock-free, unless the ring is full, in which case it
+ * waits for a free slot, or the submitter thread has to be woken up.
+ *
+ * @public @memberof ccl_submitter
+ * @note Requires OpenCL >= 1.1
+ *
+ * @param[in] sub A submission front-end.
+ * @param[in] cmd Command function, which will run in the submitter
+ * thread.
+ * @param[in] user_data User data passed to `cmd`.
+ * @return A future which completes with the execution status of the
+ * command, or with an error status if the command function fails. It
+ * should be released with ::ccl_future_destroy().
+ * */
+CCL_EXPORT
+CCLFuture * ccl_submitter_submit(
+    CCLSubmitter * sub, ccl_submitter_cmd cmd, void * user_data) {
+
+    /* Make sure sub is not NULL. */
+    g_return_val_if_fail(sub != NULL, NULL);
+    /* Make sure cmd is not NULL. */
+    g_return_val_if_fail(cmd != NULL, NULL);
+
+    struct ccl_submitter_slot * slot;
+    CCLFuture * fut = ccl_future_new_pending();
+    gint pos, diff;
+
+    /* Claim a ring position whose slot is free. */
+    pos = g_atomic_int_get(&sub->head);
+    while (TRUE) {
+        slot = &sub->ring[(guint) pos & sub->mask];
+        diff = (gint) ((guint) g_atomic_int_get(&slot->seq) - (guint) pos);
+        if (diff == 0) {
+            /* Slot is free, try to claim its position. */
+            if (g_atomic_int_compare_and_exchange(
+                    &sub->head, pos, (gint) ((guint) pos + 1)))
+                break;
+        } else if (diff < 0) {
+            /* Ring is full, let the submitter thread run. */
+            g_thread_yield();
+        }
+        pos = g_atomic_int_get(&sub->head);
+    }
+
+    /* Fill slot and publish it to the submitter thread. */
+    slot->cmd = cmd;
+    slot->user_data = user_data;
+    slot->fut = fut;
+    g_atomic_int_set(&slot->seq, (gint) ((guint) pos + 1));
+
+    /* Wake up submitter thread if it is sleeping. */
+    if (g_atomic_int_get(&sub->sleeping)) {
+        g_mutex_lock(&sub->lock);
+        g_cond_signal(&sub->wake);
+        g_mutex_unlock(&sub->lock);
+    }
+
+    /* Return future. */
+    return fut;
+}
+
+/** @} */
@@ -0,0 +1,127 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of a multi-producer submission front-end for command queues.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_SUBMITTER_H_
+#define _CCL_SUBMITTER_H_
+
+#include "ccl_common.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+#include "ccl_future.h"
+
+/**
+ * @defgroup CCL_SUBMITTER Multi-producer submission
+ * @ingroup CCL_QUEUE_WRAPPER
+ *
+ * This module provides a submission front-end which lets many host
+ * threads submit commands to the same command queue.
+ *
+ * Queue wrappers are not thread-safe, since each enqueued command adds
+ * an event to the queue, and some OpenCL implementations serialize
+ * concurrent `clEnqueue*()` calls on the same queue anyway. A submitter,
+ * created with ::ccl_submitter_new(), instead owns a dedicated thread
+ * which is the only one to enqueue commands in the queue. Producer
+ * threads submit commands with ::ccl_submitter_submit(), which places
+ * them in a bounded lock-free ring and returns immediately with a
+ * future. The submitter thread takes commands from the ring, enqueues
+ * them in the queue, and completes each future when the respective
+ * command completes. Producers only take a lock to wake up the
+ * submitter thread if it is sleeping on an empty ring.
+ *
+ * Commands are enqueued in the order in which they were placed in the
+ * ring. In an in-order queue, a command therefore only starts after all
+ * the commands whose submission returned before its own submission
+ * started, in any producer thread, have completed.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLEvent * upload(CCLQueue * cq, void * user_data, CCLErr ** err) {
+ *     struct chunk * c = (struct chunk *) user_data;
+ *     return ccl_buffer_enqueue_write(c->buf, cq, CL_FALSE, c->offset,
+ *         c->size, c->data, NULL, err);
+ * }
+ * @endcode
+ * @code{.c}
+ * CCLSubmitter * sub = ccl_submitter_new(cq, 0, NULL);
+ * @endcode
+ * @code{.c}
+ * // In any producer thread
+ * CCLFuture * fut = ccl_submitter_submit(sub, upload, chunk);
+ * ccl_future_wait(fut);
+ * ccl_future_destroy(fut);
+ * @endcode
+ * @code{.c}
+ * ccl_submitter_destroy(sub);
+ * @endcode
+ *
+ * @attention While a submitter exists, its queue must only be used
+ * through the submitter. Command functions run in the submitter thread.
+ *
+ * @note Requires OpenCL >= 1.1
+ *
+ * @{
+ */
+
+/**
+ * Default number of commands which fit in the ring of a submitter.
+ * */
+#define CCL_SUBMITTER_RING_SIZE 1024
+
+/**
+ * Multi-producer submission front-end class.
+ * */
+typedef struct ccl_submitter CCLSubmitter;
+
+/**
+ * A command function, which enqueues a command in the submitter queue.
+ *
+ * @param[in] cq Command queue of the submitter.
+ * @param[in] user_data User data given to ::ccl_submitter_submit().
+ * @param[out] err Return location for a ::CCLErr object.
+ * @return Event of the enqueued command, or `NULL` if an error occurs.
+ * */
+typedef CCLEvent * (*ccl_submitter_cmd)(
+    CCLQueue * cq, void * user_data, CCLErr ** err);
+
+/* Create a submission front-end for a command queue. */
+CCL_EXPORT
+CCLSubmitter * ccl_submitter_new(
+    CCLQueue * cq, cl_uint ring_size, CCLErr ** err);
+
+/* Destroy a submission front-end, after enqueuing submitted commands. */
+CCL_EXPORT
+void ccl_submitter_destroy(CCLSubmitter * sub);
+
+/* Submit a command to a submission front-end. */
+CCL_EXPORT
+CCLFuture * ccl_submitter_submit(
+    CCLSubmitter * sub, ccl_submitter_cmd cmd, void * user_data);
+
+/** @} */
+
+#endif
@@ -0,0 +1,786 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of a wrapper for shared virtual memory (SVM) allocations.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_svm.h"
+#include "_ccl_queue_wrapper.h"
+#include "_ccl_defs.h"
+#include "_ccl_host_trace.h"
+
+/**
+ * Shared virtual memory allocation class.
+ * */
+struct ccl_svm {
+
+    /**
+     * Context where memory is allocated.
+     * @private
+     * */
+    CCLContext * ctx;
+
+    /**
+     * Host address of allocated memory.
+     * @private
+     * */
+    void * ptr;
+
+    /**
+     * Size in bytes of allocated memory.
+     * @private
+     * */
+    size_t size;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Check that cf4ocl and the platform of the given context support
+ * the required OpenCL version for SVM operations.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] min_ver Minimum OpenCL version.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if version is supported, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_svm_check_version(
+    CCLContext * ctx, cl_uint min_ver, CCLErr ** err) {
+
+    /* OpenCL version of the underlying platform. */
+    cl_uint ocl_ver;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+#ifndef CL_VERSION_2_0
+
+    CCL_UNUSED(ctx);
+    CCL_UNUSED(ocl_ver);
+    CCL_UNUSED(err_internal);
+
+    /* If cf4ocl was not compiled with support for OpenCL >= 2.0, always
+     * throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: SVM requires cf4ocl to be deployed with support for OpenCL "
+        "version %d.%d or newer.", CCL_STRD, min_ver / 100,
+        (min_ver % 100) / 10);
+
+#else
+
+    /* Get platform OpenCL version. */
+    ocl_ver = ccl_context_get_opencl_version(ctx, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If OpenCL version is not high enough, throw error. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ocl_ver < min_ver,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: SVM operation requires OpenCL version %d.%d or newer.",
+        CCL_STRD, min_ver / 100, (min_ver % 100) / 10);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Check that the context of a command queue supports the required
+ * OpenCL version for SVM operations.
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] min_ver Minimum OpenCL version.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if version is supported, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_svm_check_queue_version(
+    CCLQueue * cq, cl_uint min_ver, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx;
+
+    /* Get queue context. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Check its version. */
+    ccl_svm_check_version(ctx, min_ver, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @addtogroup CCL_SVM
+ * @{
+ */
+
+/**
+ * Allocate shared virtual memory. This function wraps the clSVMAlloc()
+ * OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] ctx Context wrapper object. A reference to the context is
+ * kept until the allocation is destroyed.
+ * @param[in] flags SVM memory flags, as used in clSVMAlloc().
+ * @param[in] size Size in bytes of memory to allocate.
+ * @param[in] alignment Minimum alignment in bytes, or 0 for the default
+ * alignment of the OpenCL implementation.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new SVM allocation, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLSvm * ccl_svm_new(CCLContext * ctx, cl_svm_mem_flags flags,
+    size_t size, cl_uint alignment, CCLErr ** err) {
+
+    /* Make sure ctx is not NULL. */
+    g_return_val_if_fail(ctx != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLSvm * svm = NULL;
+    void * ptr = NULL;
+
+    /* Check that SVM is supported. */
+    ccl_svm_check_version(ctx, 200, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_0
+
+    /* Allocate memory. */
+    ptr = clSVMAlloc(ccl_context_unwrap(ctx), flags, size, alignment);
+
+#else
+
+    CCL_UNUSED(flags);
+    CCL_UNUSED(alignment);
+
+#endif
+
+    /* OpenCL does not report why allocation failed. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, ptr == NULL,
+        CCL_ERROR_OTHER, error_handler,
+        "%s: unable to allocate %lu bytes of SVM memory.",
+        CCL_STRD, (unsigned long) size);
+
+    /* Wrap allocation, keep a reference to context. */
+    svm = g_slice_new(CCLSvm);
+    svm->ctx = ctx;
+    svm->ptr = ptr;
+    svm->size = size;
+    ccl_context_ref(ctx);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return SVM allocation. */
+    return svm;
+}
+
+/**
+ * Free shared virtual memory, and release the reference to its context.
+ * This function wraps the clSVMFree() OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @attention Memory is freed immediately, so commands using it must
+ * have completed.
+ *
+ * @param[in] svm SVM allocation to destroy.
+ * */
+CCL_EXPORT
+void ccl_svm_destroy(CCLSvm * svm) {
+
+    /* Make sure svm is not NULL. */
+    g_return_if_fail(svm != NULL);
+
+#ifdef CL_VERSION_2_0
+    clSVMFree(ccl_context_unwrap(svm->ctx), svm->ptr);
+#endif
+
+    ccl_context_unref(svm->ctx);
+    g_slice_free(CCLSvm, svm);
+}
+
+/**
+ * Get host address of shared virtual memory allocation, which is also
+ * valid on the devices of its context.
+ *
+ * @public @memberof ccl_svm
+ *
+ * @param[in] svm SVM allocation.
+ * @return Address of allocated memory.
+ * */
+CCL_EXPORT
+void * ccl_svm_get_ptr(CCLSvm * svm) {
+
+    /* Make sure svm is not NULL. */
+    g_return_val_if_fail(svm != NULL, NULL);
+
+    return svm->ptr;
+}
+
+/**
+ * Get size in bytes of shared virtual memory allocation.
+ *
+ * @public @memberof ccl_svm
+ *
+ * @param[in] svm SVM allocation.
+ * @return Size in bytes of allocated memory.
+ * */
+CCL_EXPORT
+size_t ccl_svm_get_size(CCLSvm * svm) {
+
+    /* Make sure svm is not NULL. */
+    g_return_val_if_fail(svm != NULL, 0);
+
+    return svm->size;
+}
+
+/**
+ * Get context of shared virtual memory allocation.
+ *
+ * @public @memberof ccl_svm
+ *
+ * @param[in] svm SVM allocation.
+ * @return Context wrapper object where memory is allocated.
+ * */
+CCL_EXPORT
+CCLContext * ccl_svm_get_context(CCLSvm * svm) {
+
+    /* Make sure svm is not NULL. */
+    g_return_val_if_fail(svm != NULL, NULL);
+
+    return svm->ctx;
+}
+
+/**
+ * Enqueue a memory copy involving shared virtual memory. This function
+ * wraps the clEnqueueSVMMemcpy() OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] blocking_copy Indicates if the copy operation is blocking or
+ * non-blocking.
+ * @param[in] dst_ptr Host or SVM address where to copy to.
+ * @param[in] src_ptr Host or SVM address where to copy from.
+ * @param[in] size Size in bytes of data being copied.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL`
+ * if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_memcpy(CCLQueue * cq, cl_bool blocking_copy,
+    void * dst_ptr, const void * src_ptr, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    cl_int ocl_status;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err_internal = NULL;
+
+    /* Check that SVM is supported. */
+    ccl_svm_check_queue_version(cq, 200, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_0
+
+    /* Enqueue copy. */
+    ocl_status = clEnqueueSVMMemcpy(ccl_queue_unwrap(cq), blocking_copy,
+        dst_ptr, src_ptr, size,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue SVM memcpy (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+#else
+
+    CCL_UNUSED(blocking_copy);
+    CCL_UNUSED(dst_ptr);
+    CCL_UNUSED(src_ptr);
+    CCL_UNUSED(size);
+    CCL_UNUSED(ocl_status);
+    CCL_UNUSED(event);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue a fill of shared virtual memory with a pattern. This function
+ * wraps the clEnqueueSVMMemFill() OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] svm_ptr SVM address of region to fill.
+ * @param[in] pattern Pointer to the pattern to fill the region with.
+ * @param[in] pattern_size Size in bytes of the pattern.
+ * @param[in] size Size in bytes of the region, which must be a multiple of
+ * the pattern size.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL`
+ * if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_fill(CCLQueue * cq, void * svm_ptr,
+    const void * pattern, size_t pattern_size, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    cl_int ocl_status;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err_internal = NULL;
+
+    /* Check that SVM is supported. */
+    ccl_svm_check_queue_version(cq, 200, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_0
+
+    /* Enqueue fill. */
+    ocl_status = clEnqueueSVMMemFill(ccl_queue_unwrap(cq), svm_ptr,
+        pattern, pattern_size, size,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue SVM fill (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+#else
+
+    CCL_UNUSED(svm_ptr);
+    CCL_UNUSED(pattern);
+    CCL_UNUSED(pattern_size);
+    CCL_UNUSED(size);
+    CCL_UNUSED(ocl_status);
+    CCL_UNUSED(event);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue a map of shared virtual memory, allowing the host to access
+ * coarse-grained SVM memory. This function wraps the clEnqueueSVMMap()
+ * OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] blocking_map Indicates if the map operation is blocking or
+ * non-blocking.
+ * @param[in] map_flags Flags which specify the type of mapping to
+ * perform.
+ * @param[in] svm_ptr SVM address of region to map.
+ * @param[in] size Size in bytes of the region to map.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL`
+ * if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_map(CCLQueue * cq, cl_bool blocking_map,
+    cl_map_flags map_flags, void * svm_ptr, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    cl_int ocl_status;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err_internal = NULL;
+
+    /* Check that SVM is supported. */
+    ccl_svm_check_queue_version(cq, 200, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_0
+
+    /* Enqueue map. */
+    ocl_status = clEnqueueSVMMap(ccl_queue_unwrap(cq), blocking_map,
+        map_flags, svm_ptr, size,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue SVM map (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+#else
+
+    CCL_UNUSED(blocking_map);
+    CCL_UNUSED(map_flags);
+    CCL_UNUSED(svm_ptr);
+    CCL_UNUSED(size);
+    CCL_UNUSED(ocl_status);
+    CCL_UNUSED(event);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue an unmap of shared virtual memory previously mapped with
+ * ::ccl_svm_enqueue_map(). This function wraps the clEnqueueSVMUnmap()
+ * OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.0
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] svm_ptr SVM address of mapped region.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL`
+ * if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_unmap(CCLQueue * cq, void * svm_ptr,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    cl_int ocl_status;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err_internal = NULL;
+
+    /* Check that SVM is supported. */
+    ccl_svm_check_queue_version(cq, 200, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_0
+
+    /* Enqueue unmap. */
+    ocl_status = clEnqueueSVMUnmap(ccl_queue_unwrap(cq), svm_ptr,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue SVM unmap (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+#else
+
+    CCL_UNUSED(svm_ptr);
+    CCL_UNUSED(ocl_status);
+    CCL_UNUSED(event);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Enqueue a migration of shared virtual memory regions to the device
+ * associated with the command queue, or to the host. This function wraps
+ * the clEnqueueSVMMigrateMem() OpenCL function.
+ *
+ * @public @memberof ccl_svm
+ * @note Requires OpenCL >= 2.1
+ *
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] num_svm_ptrs Number of regions to migrate.
+ * @param[in] svm_ptrs SVM addresses of regions to migrate.
+ * @param[in] sizes Sizes in bytes of regions to migrate, or `NULL` to
+ * migrate whole allocations. Individual sizes may be 0 for the same
+ * effect.
+ * @param[in] flags Migration flags, as in ::ccl_memobj_enqueue_migrate().
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before this command can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies this command, or `NULL`
+ * if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_migrate(CCLQueue * cq, cl_uint num_svm_ptrs,
+    const void ** svm_ptrs, const size_t * sizes,
+    cl_mem_migration_flags flags, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err) {
+
+    /* Make sure cq is not NULL. */
+    g_return_val_if_fail(cq != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Time host call. */
+    CCL_HOST_TRACE_BEGIN;
+
+    cl_int ocl_status;
+    cl_event event = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err_internal = NULL;
+
+    /* Check that SVM migration is supported. */
+    ccl_svm_check_queue_version(cq, 210, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+#ifdef CL_VERSION_2_1
+
+    /* Enqueue migration. */
+    ocl_status = clEnqueueSVMMigrateMem(ccl_queue_unwrap(cq), num_svm_ptrs,
+        svm_ptrs, sizes, flags,
+        ccl_event_wait_list_get_num_events(evt_wait_lst),
+        ccl_event_wait_list_get_clevents(evt_wait_lst),
+        ccl_queue_event_ptr(cq, &event));
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: unable to enqueue SVM migration (OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* Wrap event and associate it with the respective command queue.
+     * The event object will be released automatically when the command
+     * queue is released. */
+    evt = ccl_queue_produce_event_deps(cq, event, evt_wait_lst);
+
+#else
+
+    CCL_UNUSED(num_svm_ptrs);
+    CCL_UNUSED(svm_ptrs);
+    CCL_UNUSED(sizes);
+    CCL_UNUSED(flags);
+    CCL_UNUSED(ocl_status);
+    CCL_UNUSED(event);
+
+    /* Compiled with OpenCL 2.0 headers, which lack SVM migration. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+        CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+        "%s: SVM migration requires cf4ocl to be deployed with support "
+        "for OpenCL version 2.1 or newer.", CCL_STRD);
+
+#endif
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Record host call time. */
+    CCL_HOST_TRACE_END;
+
+    /* Return event. */
+    return evt;
+}
+
+/** @} */
@@ -0,0 +1,148 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of a wrapper for shared virtual memory (SVM) allocations.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_SVM_H_
+#define _CCL_SVM_H_
+
+#include "ccl_common.h"
+#include "ccl_context_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_SVM Shared virtual memory
+ *
+ * This module provides a wrapper for shared virtual memory (SVM)
+ * allocations, available since OpenCL 2.0, and for the respective
+ * enqueue functions.
+ *
+ * SVM allocations are created with ::ccl_svm_new(), which wraps
+ * clSVMAlloc(). The host address of an allocation, obtained with
+ * ::ccl_svm_get_ptr(), is also valid on the devices of the context, so
+ * that pointer-based data structures, such as graphs or trees, can be
+ * shared between host and devices without serializing them into flat
+ * buffers. Each allocation keeps a reference to its context, which
+ * therefore remains valid until all its allocations are destroyed with
+ * ::ccl_svm_destroy().
+ *
+ * Pointers to SVM memory, including pointers within an allocation, are
+ * passed as kernel arguments with the ::ccl_arg_svm() macro. The
+ * `ccl_svm_enqueue_*()` functions wrap the SVM memcpy, fill, map, unmap
+ * and migrate OpenCL commands, and return event wrappers associated with
+ * the command queue, as other `ccl_*_enqueue_*()` functions do.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLSvm * svm;
+ * struct node * nodes;
+ * size_t size = NUM_NODES * sizeof(struct node);
+ * @endcode
+ * @code{.c}
+ * svm = ccl_svm_new(ctx, CL_MEM_READ_WRITE, size, 0, NULL);
+ * nodes = ccl_svm_get_ptr(svm);
+ * @endcode
+ * @code{.c}
+ * ccl_svm_enqueue_map(cq, CL_TRUE, CL_MAP_WRITE, nodes, size, NULL, NULL);
+ * build_graph(nodes);
+ * ccl_svm_enqueue_unmap(cq, nodes, NULL, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws, NULL,
+ *     NULL, NULL, ccl_arg_svm(nodes), NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_queue_finish(cq, NULL);
+ * ccl_svm_destroy(svm);
+ * @endcode
+ *
+ * @attention Coarse-grained SVM memory must be mapped before the host
+ * accesses it. SVM memory must not be destroyed while commands using it
+ * are pending.
+ *
+ * @{
+ */
+
+/**
+ * Shared virtual memory allocation class.
+ * */
+typedef struct ccl_svm CCLSvm;
+
+/* Allocate shared virtual memory. */
+CCL_EXPORT
+CCLSvm * ccl_svm_new(CCLContext * ctx, cl_svm_mem_flags flags,
+    size_t size, cl_uint alignment, CCLErr ** err);
+
+/* Free shared virtual memory. */
+CCL_EXPORT
+void ccl_svm_destroy(CCLSvm * svm);
+
+/* Get host address of shared virtual memory allocation. */
+CCL_EXPORT
+void * ccl_svm_get_ptr(CCLSvm * svm);
+
+/* Get size in bytes of shared virtual memory allocation. */
+CCL_EXPORT
+size_t ccl_svm_get_size(CCLSvm * svm);
+
+/* Get context of shared virtual memory allocation. */
+CCL_EXPORT
+CCLContext * ccl_svm_get_context(CCLSvm * svm);
+
+/* Enqueue a memory copy involving shared virtual memory. */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_memcpy(CCLQueue * cq, cl_bool blocking_copy,
+    void * dst_ptr, const void * src_ptr, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue a fill of shared virtual memory with a pattern. */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_fill(CCLQueue * cq, void * svm_ptr,
+    const void * pattern, size_t pattern_size, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue a map of shared virtual memory for host access. */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_map(CCLQueue * cq, cl_bool blocking_map,
+    cl_map_flags map_flags, void * svm_ptr, size_t size,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue an unmap of shared virtual memory. */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_unmap(CCLQueue * cq, void * svm_ptr,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Enqueue a migration of shared virtual memory regions. */
+CCL_EXPORT
+CCLEvent * ccl_svm_enqueue_migrate(CCLQueue * cq, cl_uint num_svm_ptrs,
+    const void ** svm_ptrs, const size_t * sizes,
+    cl_mem_migration_flags flags, CCLEventWaitList * evt_wait_lst,
+    CCLErr ** err);
+
+/** @} */
+
+#endif
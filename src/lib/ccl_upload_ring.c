@@ -0,0 +1,545 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Implementation of persistently mapped upload rings for streaming data to
+ * the device.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#include "ccl_upload_ring.h"
+#include "_ccl_defs.h"
+
+/**
+ * @internal
+ *
+ * @brief Data transferred to the device by one flush of an upload ring.
+ * */
+typedef struct ccl_upload_ring_seg {
+
+    /**
+     * Position in the ring stream where the flushed data ends.
+     * @private
+     * */
+    cl_ulong end;
+
+    /**
+     * Event of the (last) write of the flush.
+     * @private
+     * */
+    cl_event write_evt;
+
+    /**
+     * Event after which the flushed data is consumed, or `NULL` if not
+     * declared.
+     * @private
+     * */
+    cl_event consumer_evt;
+
+} CCLUploadRingSeg;
+
+/**
+ * Persistently mapped upload ring class.
+ *
+ * Positions in the ring are kept as the total number of bytes streamed
+ * through it, so that the offset of a position is its remainder by the
+ * size of the ring.
+ * */
+struct ccl_upload_ring {
+
+    /**
+     * Command queue where transfers are enqueued.
+     * @private
+     * */
+    CCLQueue * cq;
+
+    /**
+     * Pinned host buffer.
+     * @private
+     * */
+    CCLBuffer * host_buf;
+
+    /**
+     * Device buffer to which data is transferred.
+     * @private
+     * */
+    CCLBuffer * dev_buf;
+
+    /**
+     * Host address where the pinned buffer is mapped.
+     * @private
+     * */
+    char * base;
+
+    /**
+     * Size of the ring in bytes.
+     * @private
+     * */
+    size_t size;
+
+    /**
+     * Size of the reserved region, or 0 if no region is reserved.
+     * @private
+     * */
+    size_t reserved;
+
+    /**
+     * Position where committed data ends and the next region starts.
+     * @private
+     * */
+    cl_ulong head;
+
+    /**
+     * Position where flushed data ends.
+     * @private
+     * */
+    cl_ulong flushed;
+
+    /**
+     * Position where data which may still be in use starts.
+     * @private
+     * */
+    cl_ulong tail;
+
+    /**
+     * Flushes whose data may still be in use, oldest first (queue of
+     * ::CCLUploadRingSeg).
+     * @private
+     * */
+    GQueue segs;
+
+};
+
+/**
+ * @internal
+ *
+ * @brief Wait for the data of the oldest flush of an upload ring to be
+ * transferred and consumed, and release its region.
+ *
+ * @param[in] ring An upload ring with at least one flush in use.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if the region was released, or `CL_FALSE` if an error
+ * occurs.
+ * */
+static cl_bool ccl_upload_ring_reclaim(CCLUploadRing * ring, CCLErr ** err) {
+
+    CCLUploadRingSeg * seg = g_queue_pop_head(&ring->segs);
+    cl_int ocl_status;
+
+    /* Wait for the transfer and for the consumer, if any. */
+    ocl_status = clWaitForEvents(1, &seg->write_evt);
+    if ((ocl_status == CL_SUCCESS) && (seg->consumer_evt != NULL))
+        ocl_status = clWaitForEvents(1, &seg->consumer_evt);
+
+    /* Release region. */
+    ring->tail = seg->end;
+    clReleaseEvent(seg->write_evt);
+    if (seg->consumer_evt != NULL) clReleaseEvent(seg->consumer_evt);
+    g_slice_free(CCLUploadRingSeg, seg);
+
+    ccl_if_err_create_goto(*err, CCL_OCL_ERROR,
+        CL_SUCCESS != ocl_status, ocl_status, error_handler,
+        "%s: error while waiting for upload ring region "
+        "(OpenCL error %d: %s).",
+        CCL_STRD, ocl_status, ccl_err(ocl_status));
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return CL_TRUE;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return CL_FALSE;
+}
+
+/**
+ * @addtogroup CCL_UPLOAD_RING
+ * @{
+ */
+
+/**
+ * Create a new upload ring for the given command queue. The pinned host
+ * memory and the device buffer are allocated, and the pinned memory is
+ * mapped, at once.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] cq In-order command queue wrapper object where transfers
+ * are enqueued.
+ * @param[in] size Size of the ring in bytes, i.e. the maximum size of data
+ * in flight, and of each reserved region.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new upload ring, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLUploadRing * ccl_upload_ring_new(CCLQueue * cq, size_t size,
+    CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLUploadRing * ring = NULL;
+    CCLContext * ctx;
+    cl_command_queue_properties props;
+
+    /* Check arguments. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, (cq == NULL) || (size == 0),
+        CCL_ERROR_ARGS, error_handler,
+        "%s: command queue and ring size must be set.", CCL_STRD);
+
+    /* Flushes may require two writes, and regions of the device buffer
+     * are overwritten after commands of the queue reading them, so the
+     * queue must be in-order. */
+    props = ccl_queue_get_info_scalar(cq, CL_QUEUE_PROPERTIES,
+        cl_command_queue_properties, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, CCL_ERROR_ARGS,
+        error_handler, "%s: upload rings require in-order queues.",
+        CCL_STRD);
+
+    /* Get queue context. */
+    ctx = ccl_queue_get_context(cq, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create upload ring. */
+    ring = g_slice_new0(CCLUploadRing);
+    ring->cq = cq;
+    ccl_queue_ref(cq);
+    ring->size = size;
+    g_queue_init(&ring->segs);
+
+    /* Allocate pinned host memory and device buffer. */
+    ring->host_buf = ccl_buffer_new(ctx,
+        CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ring->dev_buf = ccl_buffer_new(ctx, CL_MEM_READ_ONLY, size, NULL,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Map pinned memory once, for the lifetime of the upload ring. */
+    ring->base = ccl_buffer_enqueue_map(ring->host_buf, cq, CL_TRUE,
+        CL_MAP_WRITE, 0, size, NULL, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* Destroy partially created upload ring. */
+    if (ring != NULL) {
+        ccl_upload_ring_destroy(ring);
+        ring = NULL;
+    }
+
+finish:
+
+    /* Return upload ring. */
+    return ring;
+}
+
+/**
+ * Destroy an upload ring, waiting for pending transfers and consumers,
+ * and unmapping and releasing its memory.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring The upload ring to destroy.
+ * */
+CCL_EXPORT
+void ccl_upload_ring_destroy(CCLUploadRing * ring) {
+
+    /* Make sure ring is not NULL. */
+    g_return_if_fail(ring != NULL);
+
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+
+    /* Wait for pending transfers and consumers. */
+    while (!g_queue_is_empty(&ring->segs))
+        ccl_upload_ring_reclaim(ring, NULL);
+
+    /* Unmap and release memory. */
+    if (ring->base != NULL) {
+        evt = ccl_buffer_enqueue_unmap(ring->host_buf, ring->cq, ring->base,
+            NULL, NULL);
+        if (evt != NULL)
+            ccl_event_wait(ccl_ewl(&ewl, evt, NULL), NULL);
+    }
+    if (ring->host_buf != NULL)
+        ccl_buffer_destroy(ring->host_buf);
+    if (ring->dev_buf != NULL)
+        ccl_buffer_destroy(ring->dev_buf);
+
+    ccl_queue_unref(ring->cq);
+    g_slice_free(CCLUploadRing, ring);
+}
+
+/**
+ * Get the device buffer to which an upload ring transfers data. Data
+ * committed at a given offset of the ring is transferred to the same
+ * offset of this buffer.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring An upload ring.
+ * @return The device buffer, owned by the upload ring.
+ * */
+CCL_EXPORT
+CCLBuffer * ccl_upload_ring_get_buffer(CCLUploadRing * ring) {
+
+    /* Make sure ring is not NULL. */
+    g_return_val_if_fail(ring != NULL, NULL);
+
+    return ring->dev_buf;
+}
+
+/**
+ * Reserve a contiguous region of an upload ring for writing. If the region
+ * does not fit before the end of the ring, it is placed at its start. If
+ * the region overlaps data which is still being transferred or consumed,
+ * this function waits for it. Reserving a region discards a previously
+ * reserved region which was not committed.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring An upload ring.
+ * @param[in] size Size of region in bytes, which cannot be larger than
+ * the ring.
+ * @param[out] offset Location where to put the offset of the region in
+ * the ring and in the device buffer, or `NULL`.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Host address of the region, where data can be written until it
+ * is committed, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+void * ccl_upload_ring_reserve(CCLUploadRing * ring, size_t size,
+    size_t * offset, CCLErr ** err) {
+
+    /* Make sure ring is not NULL. */
+    g_return_val_if_fail(ring != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    size_t pos, gap;
+
+    /* Check region size. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (size == 0) || (size > ring->size), CCL_ERROR_ARGS, error_handler,
+        "%s: region size must be larger than 0 and not larger than the "
+        "ring.", CCL_STRD);
+
+    /* Discard uncommitted region. */
+    ring->reserved = 0;
+
+    /* Find room for region. */
+    for (;;) {
+
+        /* Bytes skipped at the end of the ring, if the region does not
+         * fit there. */
+        pos = (size_t) (ring->head % ring->size);
+        gap = (pos + size > ring->size) ? ring->size - pos : 0;
+
+        /* If the ring is empty, simply restart at its start. */
+        if ((gap > 0) && (ring->tail == ring->head)) {
+            ring->head += gap;
+            ring->flushed = ring->tail = ring->head;
+            continue;
+        }
+
+        /* Stop if region fits. */
+        if (ring->size - (size_t) (ring->head - ring->tail) >= gap + size)
+            break;
+
+        /* Otherwise release the oldest flushed data. */
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            g_queue_is_empty(&ring->segs), CCL_ERROR_OTHER, error_handler,
+            "%s: upload ring is full of data which was not flushed.",
+            CCL_STRD);
+        ccl_upload_ring_reclaim(ring, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Skipped bytes are transferred with the committed data. */
+    ring->head += gap;
+    ring->reserved = size;
+    if (offset != NULL) *offset = (size_t) (ring->head % ring->size);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    return ring->base + (size_t) (ring->head % ring->size);
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    return NULL;
+}
+
+/**
+ * Commit data written to the reserved region of an upload ring. Only the
+ * first `size` bytes of the region are committed, and the next region
+ * starts right after them. Committed data is transferred to the device by
+ * the next call to ::ccl_upload_ring_flush().
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring An upload ring with a reserved region.
+ * @param[in] size Number of bytes written to the reserved region, which
+ * cannot be larger than the region.
+ * */
+CCL_EXPORT
+void ccl_upload_ring_commit(CCLUploadRing * ring, size_t size) {
+
+    /* Make sure ring is not NULL. */
+    g_return_if_fail(ring != NULL);
+    /* Make sure size is not larger than the reserved region. */
+    g_return_if_fail(size <= ring->reserved);
+
+    ring->head += size;
+    ring->reserved = 0;
+}
+
+/**
+ * Asynchronously transfer data committed to an upload ring since the last
+ * flush to the device buffer, with a single non-blocking write, or two if
+ * the data wraps around the end of the ring. If there is no data to
+ * transfer, a marker is enqueued instead.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring An upload ring.
+ * @param[in,out] evt_wait_lst List of events that need to complete
+ * before the transfer can be executed. The list will be cleared and
+ * can be reused by client code.
+ * @param[out] err Return location for a ::CCLErr object, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper object that identifies the (last part of the)
+ * transfer, or `NULL` if an error occurs.
+ * */
+CCL_EXPORT
+CCLEvent * ccl_upload_ring_flush(CCLUploadRing * ring,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err) {
+
+    /* Make sure ring is not NULL. */
+    g_return_val_if_fail(ring != NULL, NULL);
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    CCLErr * err_internal = NULL;
+    CCLEvent * evt = NULL;
+    CCLUploadRingSeg * seg;
+    size_t start, len, first;
+
+    /* If there is nothing to transfer, enqueue a marker. */
+    if (ring->flushed == ring->head) {
+        evt = ccl_enqueue_marker(ring->cq, evt_wait_lst, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        goto finish;
+    }
+
+    /* Transfer data up to the end of the ring. */
+    start = (size_t) (ring->flushed % ring->size);
+    len = (size_t) (ring->head - ring->flushed);
+    first = MIN(len, ring->size - start);
+    evt = ccl_buffer_enqueue_write(ring->dev_buf, ring->cq, CL_FALSE, start,
+        first, ring->base + start, evt_wait_lst, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Transfer remaining data from the start of the ring. The queue is
+     * in-order, so there is no need to wait for the first part. */
+    if (len > first) {
+        evt = ccl_buffer_enqueue_write(ring->dev_buf, ring->cq, CL_FALSE, 0,
+            len - first, ring->base, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Keep track of transfer, keeping a reference to the OpenCL event,
+     * since event wrappers are owned by the command queue. */
+    seg = g_slice_new0(CCLUploadRingSeg);
+    seg->end = ring->head;
+    seg->write_evt = ccl_event_unwrap(evt);
+    clRetainEvent(seg->write_evt);
+    g_queue_push_tail(&ring->segs, seg);
+    ring->flushed = ring->head;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+    /* An error occurred, return NULL to signal it. */
+    evt = NULL;
+
+finish:
+
+    /* Clear event wait list, in case it was not used. */
+    ccl_event_wait_list_clear(evt_wait_lst);
+
+    /* Return event. */
+    return evt;
+}
+
+/**
+ * Declare that data flushed from an upload ring since the last call to
+ * this function is consumed once the given event completes. The regions
+ * of this data are not reused before then. This is only required if the
+ * device buffer is read by commands in a queue other than the ring's.
+ *
+ * @public @memberof ccl_upload_ring
+ *
+ * @param[in] ring An upload ring.
+ * @param[in] evt Event of the last command reading the flushed data.
+ * */
+CCL_EXPORT
+void ccl_upload_ring_consumed(CCLUploadRing * ring, CCLEvent * evt) {
+
+    /* Make sure ring is not NULL. */
+    g_return_if_fail(ring != NULL);
+    /* Make sure evt is not NULL. */
+    g_return_if_fail(evt != NULL);
+
+    /* Set consumer of the most recent flushes which don't have one. */
+    for (GList * it = g_queue_peek_tail_link(&ring->segs);
+        (it != NULL) && (((CCLUploadRingSeg *) it->data)->consumer_evt == NULL);
+        it = it->prev) {
+
+        CCLUploadRingSeg * seg = (CCLUploadRingSeg *) it->data;
+        seg->consumer_evt = ccl_event_unwrap(evt);
+        clRetainEvent(seg->consumer_evt);
+    }
+}
+
+/** @} */
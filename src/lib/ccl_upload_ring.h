@@ -0,0 +1,138 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with cf4ocl. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+ /**
+ * @file
+ * Definition of persistently mapped upload rings for streaming data to
+ * the device.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU Lesser General Public License version 3 (LGPLv3)](http://www.gnu.org/licenses/lgpl.html)
+ * */
+
+#ifndef _CCL_UPLOAD_RING_H_
+#define _CCL_UPLOAD_RING_H_
+
+#include "ccl_common.h"
+#include "ccl_buffer_wrapper.h"
+#include "ccl_queue_wrapper.h"
+#include "ccl_event_wrapper.h"
+
+/**
+ * @defgroup CCL_UPLOAD_RING Upload rings
+ * @ingroup CCL_BUFFER_WRAPPER
+ *
+ * This module provides persistently mapped rings for streaming many small
+ * records from host to device.
+ *
+ * Writing each record with ::ccl_buffer_enqueue_write() enqueues one
+ * command with its own event per record, whose overhead easily exceeds
+ * the cost of the transfer itself. An upload ring keeps pinned host
+ * memory, allocated with `CL_MEM_ALLOC_HOST_PTR` and mapped once, and a
+ * device buffer of the same size. Producers reserve a region of the ring
+ * with ::ccl_upload_ring_reserve(), write records directly to the
+ * returned host address, and commit the bytes actually written with
+ * ::ccl_upload_ring_commit(). Committed records are transferred to the
+ * device buffer, at the same offsets, with a single write per call to
+ * ::ccl_upload_ring_flush() (two writes if the records wrap around the end
+ * of the ring). Streaming a record thus costs little more than writing it
+ * to memory.
+ *
+ * Regions are never split across the end of the ring, so each reserved
+ * region is contiguous both in host memory and in the device buffer. The
+ * ring keeps track of the write of each flush, and reserving a region
+ * which overlaps data still being transferred waits for the transfer to
+ * complete. If the device buffer is read by commands in another queue,
+ * ::ccl_upload_ring_consumed() should be called with the event of the
+ * last such command, so that the respective regions are not overwritten
+ * before it completes. Commands in the ring's own in-order queue don't
+ * require this, since further writes are executed after them.
+ *
+ * _Example:_
+ *
+ * @code{.c}
+ * CCLUploadRing * ring;
+ * CCLEvent * evt;
+ * CCLEventWaitList ewl = NULL;
+ * struct record * rec;
+ * size_t off;
+ * @endcode
+ * @code{.c}
+ * ring = ccl_upload_ring_new(cq, 1 << 20, NULL);
+ * ccl_kernel_set_arg(krnl, 0, ccl_upload_ring_get_buffer(ring));
+ * @endcode
+ * @code{.c}
+ * for (i = 0; i < num_records; ++i) {
+ *     rec = ccl_upload_ring_reserve(ring, sizeof(struct record), &off, NULL);
+ *     fill_record(rec, i);
+ *     ccl_upload_ring_commit(ring, sizeof(struct record));
+ * }
+ * evt = ccl_upload_ring_flush(ring, NULL, NULL);
+ * @endcode
+ * @code{.c}
+ * ccl_upload_ring_destroy(ring);
+ * @endcode
+ *
+ * @attention Upload rings are not thread-safe, and only one region can be
+ * reserved at a time.
+ *
+ * @{
+ */
+
+/**
+ * Persistently mapped upload ring class.
+ * */
+typedef struct ccl_upload_ring CCLUploadRing;
+
+/* Create a new upload ring for the given command queue. */
+CCL_EXPORT
+CCLUploadRing * ccl_upload_ring_new(CCLQueue * cq, size_t size,
+    CCLErr ** err);
+
+/* Destroy an upload ring, waiting for pending transfers. */
+CCL_EXPORT
+void ccl_upload_ring_destroy(CCLUploadRing * ring);
+
+/* Get the device buffer to which an upload ring transfers data. */
+CCL_EXPORT
+CCLBuffer * ccl_upload_ring_get_buffer(CCLUploadRing * ring);
+
+/* Reserve a contiguous region of an upload ring for writing. */
+CCL_EXPORT
+void * ccl_upload_ring_reserve(CCLUploadRing * ring, size_t size,
+    size_t * offset, CCLErr ** err);
+
+/* Commit data written to the reserved region of an upload ring. */
+CCL_EXPORT
+void ccl_upload_ring_commit(CCLUploadRing * ring, size_t size);
+
+/* Asynchronously transfer committed data of an upload ring to the
+ * device. */
+CCL_EXPORT
+CCLEvent * ccl_upload_ring_flush(CCLUploadRing * ring,
+    CCLEventWaitList * evt_wait_lst, CCLErr ** err);
+
+/* Declare that data flushed from an upload ring is consumed once an event
+ * completes. */
+CCL_EXPORT
+void ccl_upload_ring_consumed(CCLUploadRing * ring, CCLEvent * evt);
+
+/** @} */
+
+#endif
@@ -33,25 +33,52 @@ extern "C" {
 #endif
 
 #include <cf4ocl2/ccl_abstract_wrapper.h>
+#include <cf4ocl2/ccl_algo.h>
+#include <cf4ocl2/ccl_buffer_arena.h>
+#include <cf4ocl2/ccl_buffer_pool.h>
 #include <cf4ocl2/ccl_buffer_wrapper.h>
+#include <cf4ocl2/ccl_cmdseq.h>
 #include <cf4ocl2/ccl_common.h>
+#include <cf4ocl2/ccl_context_pool.h>
 #include <cf4ocl2/ccl_context_wrapper.h>
+#include <cf4ocl2/ccl_device_partition.h>
 #include <cf4ocl2/ccl_device_query.h>
 #include <cf4ocl2/ccl_device_selector.h>
 #include <cf4ocl2/ccl_device_wrapper.h>
+#include <cf4ocl2/ccl_devsel_bench.h>
 #include <cf4ocl2/ccl_errors.h>
+#include <cf4ocl2/ccl_event_source.h>
 #include <cf4ocl2/ccl_event_wrapper.h>
+#include <cf4ocl2/ccl_future.h>
+#include <cf4ocl2/ccl_gl.h>
+#include <cf4ocl2/ccl_graph.h>
+#include <cf4ocl2/ccl_half.h>
+#include <cf4ocl2/ccl_host_task.h>
+#include <cf4ocl2/ccl_image_pool.h>
+#include <cf4ocl2/ccl_image_pyramid.h>
 #include <cf4ocl2/ccl_image_wrapper.h>
 #include <cf4ocl2/ccl_kernel_arg.h>
+#include <cf4ocl2/ccl_kernel_batch.h>
+#include <cf4ocl2/ccl_kernel_launch.h>
+#include <cf4ocl2/ccl_kernel_tune.h>
 #include <cf4ocl2/ccl_kernel_wrapper.h>
 #include <cf4ocl2/ccl_memobj_wrapper.h>
+#include <cf4ocl2/ccl_multi_dispatch.h>
 #include <cf4ocl2/ccl_oclversions.h>
+#include <cf4ocl2/ccl_pipe_wrapper.h>
+#include <cf4ocl2/ccl_pipeline.h>
 #include <cf4ocl2/ccl_platforms.h>
 #include <cf4ocl2/ccl_platform_wrapper.h>
 #include <cf4ocl2/ccl_profiler.h>
+#include <cf4ocl2/ccl_program_cache.h>
 #include <cf4ocl2/ccl_program_wrapper.h>
 #include <cf4ocl2/ccl_queue_wrapper.h>
 #include <cf4ocl2/ccl_sampler_wrapper.h>
+#include <cf4ocl2/ccl_scheduler.h>
+#include <cf4ocl2/ccl_submitter.h>
+#include <cf4ocl2/ccl_staging.h>
+#include <cf4ocl2/ccl_svm.h>
+#include <cf4ocl2/ccl_upload_ring.h>
 
 #ifdef __cplusplus
 }
@@ -45,6 +45,13 @@
  * <dd>List available devices and exit.</dd>
  * <dt>-d, --device=DEV</dt>
  * <dd>Specify a device on which to perform the task.</dd>
+ * <dt>-a, --all-devices</dt>
+ * <dd>Build for all devices in parallel, showing the build status and time
+ * for each device, and populating the program binary cache. Only available
+ * for the build task.</dd>
+ * <dt>-c, --cache-dir=DIR</dt>
+ * <dd>Enable the program binary cache in the specified directory. If not
+ * given, the --all-devices option uses the default cache directory.</dd>
  * <dt>-t, --task=TASK</dt>
  * <dd>0 (Build, default), 1 (Compile) or 2 (Link). Tasks 1 and 2 are only
  * available for platforms with support for OpenCL 1.2 or higher.</dd>
@@ -61,14 +68,32 @@
  * --input-headers.</dd>
  * <dt>-b, --bin=FILE</dt>
  * <dd>Binary input file. This option can be specified multiple times.</dd>
+ * <dt>-I, --il=FILE</dt>
+ * <dd>Intermediate language (e.g. SPIR-V) input file for the build and
+ * compile tasks. Only available for platforms with support for OpenCL 2.1 or
+ * higher.</dd>
  * <dt>-o, --output=FILE</dt>
  * <dd>Binary output file.</dd>
+ * <dt>-O, --il-output=FILE</dt>
+ * <dd>Intermediate language output file, if the platform makes the program
+ * IL available.</dd>
  * <dt>-k, --kernel-info=STRING</dt>
  * <dd>Show information about the specified kernel. This option can be
  * specified multiple times.</dd>
  * <dt>-u, --build-log=FILE</dt>
  * <dd>Save build log to the specified file. By default the build log is
  * printed to stderr.</dd>
+ * <dt>-w, --sweep=OPTIONS</dt>
+ * <dd>Build with the specified compiler options variant, showing build time
+ * and binary size. This option can be specified multiple times for
+ * comparing variants on the selected device, or on all devices with
+ * --all-devices.</dd>
+ * <dt>-r, --run=KERNEL</dt>
+ * <dd>With --sweep, run the specified kernel for each variant and show its
+ * execution time.</dd>
+ * <dt>-z, --run-size=SIZE</dt>
+ * <dd>Number of work-items with which to run the kernel given with --run
+ * (default is 1048576). This option can be specified multiple times.</dd>
  * <dt>--version</dt>
  * <dd>Output version information and exit.</dd>
  * <dt>-h, --help, -?</dt>
@@ -119,6 +144,15 @@
     ((err) != NULL) && ((err)->domain == CCL_ERROR) && \
     ((err)->code == CCL_ERROR_INFO_UNAVAILABLE_OCL)
 
+/* Bytes per work-item in buffers given to kernels run in sweep mode. */
+#define CCL_C_SWEEP_ELEM_SIZE 16
+
+/* Number of measured kernel runs in sweep mode, after one warm-up run. */
+#define CCL_C_SWEEP_RUNS 5
+
+/* Default sample size for kernels run in sweep mode. */
+#define CCL_C_SWEEP_DEFAULT_SIZE "1048576"
+
 /* Available tasks. */
 typedef enum ccl_c_tasks {
     CCL_C_BUILD = 0,
@@ -126,18 +160,42 @@ typedef enum ccl_c_tasks {
     CCL_C_LINK = 2
 } CCLCTasks;
 
+/* Build performed on one device in --all-devices mode. */
+typedef struct ccl_c_dev_build {
+
+    /* Device on which to build. */
+    CCLDevice * dev;
+
+    /* Build status. */
+    cl_build_status build_status;
+
+    /* Build time in seconds. */
+    gdouble time;
+
+    /* Build error, if any. */
+    CCLErr * err;
+
+} CCLCDevBuild;
+
 /* Command line arguments and respective default values. */
 static gboolean opt_list = FALSE;
 static guint dev_idx = CCL_UTILS_NODEVICE;
+static gboolean all_devs = FALSE;
+static gchar * cache_dir = NULL;
 static guint task = CCL_C_BUILD;
 static gchar * options = NULL;
 static gchar ** src_files = NULL;
 static gchar ** bin_files = NULL;
+static gchar * il_file = NULL;
 static gchar ** src_h_files = NULL;
 static gchar ** src_h_names = NULL;
 static gchar ** kernel_names = NULL;
 static gchar * output = NULL;
+static gchar * il_output = NULL;
 static gchar * bld_log_out = NULL;
+static gchar ** sweep_opts = NULL;
+static gchar * run_kernel = NULL;
+static gchar ** run_sizes = NULL;
 static gboolean version = FALSE;
 
 /* Valid command line options. */
@@ -146,6 +204,14 @@ static GOptionEntry entries[] = {
      "List available devices and exit.",                          NULL},
     {"device",               'd', 0, G_OPTION_ARG_INT,            &dev_idx,
      "Specify a device on which to perform the task.",            "DEV"},
+    {"all-devices",          'a', 0, G_OPTION_ARG_NONE,           &all_devs,
+     "Build for all devices in parallel, showing the build status and time "
+     "for each device, and populating the program binary cache. Only "
+     "available for the build task.",                             NULL},
+    {"cache-dir",            'c', 0, G_OPTION_ARG_FILENAME,       &cache_dir,
+     "Enable the program binary cache in the specified directory. If not "
+     "given, the --all-devices option uses the default cache directory.",
+                                                                  "DIR"},
     {"task",                 't', 0, G_OPTION_ARG_INT,            &task,
      "0 (Build, default), 1 (Compile) or 2 (Link). Tasks 1 and 2 are only "
      "available for platforms with support for OpenCL 1.2 or higher.",
@@ -165,14 +231,33 @@ static GOptionEntry entries[] = {
     {"bin",                  'b', 0, G_OPTION_ARG_FILENAME_ARRAY, &bin_files,
      "Binary input file. This option can be specified multiple times.",
                                                                   "FILE"},
+    {"il",                   'I', 0, G_OPTION_ARG_FILENAME,       &il_file,
+     "Intermediate language (e.g. SPIR-V) input file for the build and "
+     "compile tasks. Only available for platforms with support for OpenCL "
+     "2.1 or higher.",                                            "FILE"},
     {"output",               'o', 0, G_OPTION_ARG_FILENAME,       &output,
      "Binary output file.",                                       "FILE"},
+    {"il-output",            'O', 0, G_OPTION_ARG_FILENAME,       &il_output,
+     "Intermediate language output file, if the platform makes the program "
+     "IL available.",                                             "FILE"},
     {"kernel-info",          'k', 0, G_OPTION_ARG_STRING_ARRAY,   &kernel_names,
      "Show information about the specified kernel. This option can be "
      "specified multiple times.",                                "STRING"},
     {"build-log",            'u', 0, G_OPTION_ARG_FILENAME,       &bld_log_out,
      "Save build log to the specified file. By default the build log is "
      "printed to stderr.",                                       "FILE"},
+    {"sweep",                'w', 0, G_OPTION_ARG_STRING_ARRAY,   &sweep_opts,
+     "Build with the specified compiler options variant, showing build "
+     "time and binary size. This option can be specified multiple times "
+     "for comparing variants on the selected device, or on all devices "
+     "with --all-devices.",                                       "OPTIONS"},
+    {"run",                  'r', 0, G_OPTION_ARG_STRING,         &run_kernel,
+     "With --sweep, run the specified kernel for each variant and show "
+     "its execution time.",                                       "KERNEL"},
+    {"run-size",             'z', 0, G_OPTION_ARG_STRING_ARRAY,   &run_sizes,
+     "Number of work-items with which to run the kernel given with --run "
+     "(default is " CCL_C_SWEEP_DEFAULT_SIZE "). This option can be "
+     "specified multiple times.",                                 "SIZE"},
     {"version",               0,  0, G_OPTION_ARG_NONE,           &version,
      "Output version information and exit.",                      NULL},
     { NULL, 0, 0, 0, NULL, NULL, NULL }
@@ -342,6 +427,615 @@ finish:
     return;
 }
 
+/**
+ * Build the input files on one device, in its own thread.
+ *
+ * @param[in,out] data A ::CCLCDevBuild object.
+ * @return Always `NULL`.
+ * */
+static gpointer ccl_c_dev_build_run(gpointer data) {
+
+    /* Device build. */
+    CCLCDevBuild * bld = (CCLCDevBuild *) data;
+
+    /* Context and program wrappers. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+
+    /* Build timer. */
+    GTimer * timer = NULL;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Create a context for the device. */
+    ctx = ccl_context_new_from_devices(1, &bld->dev, &err_internal);
+    ccl_if_err_propagate_goto(&bld->err, err_internal, error_handler);
+
+    /* Create program from IL or from source. */
+    if (il_file != NULL) {
+        prg = ccl_program_new_from_il_file(ctx, il_file, &err_internal);
+    } else {
+        prg = ccl_program_new_from_source_files(ctx,
+            g_strv_length(src_files), (const char **) src_files,
+            &err_internal);
+    }
+    ccl_if_err_propagate_goto(&bld->err, err_internal, error_handler);
+
+    /* Build program, measuring build time. */
+    timer = g_timer_new();
+    ccl_program_build(prg, options, &err_internal);
+    bld->time = g_timer_elapsed(timer, NULL);
+    ccl_if_err_propagate_goto(&bld->err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    bld->build_status = CL_BUILD_SUCCESS;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(bld->err != NULL);
+    bld->build_status = CL_BUILD_ERROR;
+
+finish:
+
+    /* Free stuff. */
+    if (timer) g_timer_destroy(timer);
+    if (prg) ccl_program_destroy(prg);
+    if (ctx) ccl_context_destroy(ctx);
+
+    /* Return. */
+    return NULL;
+}
+
+/**
+ * Build the input files for all devices in parallel, populating the
+ * program binary cache, and show build status and time for each device.
+ *
+ * @param[out] err Return location for a CCLErr object.
+ * @return The number of devices for which the build failed.
+ * */
+static guint ccl_c_build_all_devices(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+    /* All devices in the system. */
+    CCLDevSelDevices devices = NULL;
+    /* Builds, one per device. */
+    CCLCDevBuild * blds = NULL;
+    /* Build threads, one per device. */
+    GThread ** threads = NULL;
+    /* Device name. */
+    char * dname;
+    /* Number of failed builds. */
+    guint n_failed = 0;
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Parallel builds are only supported for the build task. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, task != CCL_C_BUILD,
+        CCL_ERROR_ARGS, error_handler,
+        "The --all-devices option is only available for the 'build' task.");
+
+    /* Parallel builds require either source files or one IL file. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        ((src_files == NULL) == (il_file == NULL)) || (bin_files != NULL)
+        || (src_h_files != NULL) || (src_h_names != NULL),
+        CCL_ERROR_ARGS, error_handler,
+        "The --all-devices option requires either: 1) one or more source "
+        "files; or, 2) one IL file.");
+
+    /* Get all devices in the system. */
+    devices = ccl_devsel_devices_new(&err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Start one build thread per device. */
+    blds = g_new0(CCLCDevBuild, devices->len);
+    threads = g_new0(GThread *, devices->len);
+    for (guint i = 0; i < devices->len; ++i) {
+        blds[i].dev = (CCLDevice *) devices->pdata[i];
+        threads[i] = g_thread_new(
+            "ccl_c_build", ccl_c_dev_build_run, &blds[i]);
+    }
+
+    /* Wait for all builds to finish. */
+    for (guint i = 0; i < devices->len; ++i)
+        g_thread_join(threads[i]);
+
+    /* Show build results for each device. */
+    for (guint i = 0; i < devices->len; ++i) {
+
+        dname = ccl_device_get_info_array(
+            blds[i].dev, CL_DEVICE_NAME, char, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        g_printf("* Device                 : %s\n", dname);
+        g_printf("  - Build status         : %s\n",
+            ccl_c_get_build_status_str(blds[i].build_status));
+        if (blds[i].err == NULL) {
+            g_printf("  - Build time           : %.4f s\n", blds[i].time);
+        } else {
+            g_printf("  - Additional info.     : %s\n",
+                blds[i].err->message);
+            n_failed++;
+        }
+    }
+
+    /* Show cache location. */
+    g_printf("* Program cache          : %s\n",
+        cache_dir != NULL ? cache_dir : "Default location");
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Free stuff. */
+    if (blds) {
+        for (guint i = 0; i < devices->len; ++i)
+            ccl_err_clear(&blds[i].err);
+        g_free(blds);
+    }
+    g_free(threads);
+    if (devices) ccl_devsel_devices_destroy(devices);
+
+    /* Return number of failed builds. */
+    return n_failed;
+}
+
+/**
+ * Determine the size of a private kernel argument from its type name.
+ *
+ * @param[in] type_name Argument type name, as given by the
+ * `CL_KERNEL_ARG_TYPE_NAME` kernel argument information.
+ * @param[out] size Argument size in bytes.
+ * @param[out] is_int Is the argument a scalar integer?
+ * @return `CL_TRUE` if the type is a known scalar or vector type,
+ * `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_c_sweep_arg_size(
+    const char * type_name, size_t * size, gboolean * is_int) {
+
+    /* Known scalar types. */
+    static const struct { const char * name; size_t size; gboolean is_int; }
+    types[] = {
+        {"char", 1, TRUE}, {"uchar", 1, TRUE}, {"short", 2, TRUE},
+        {"ushort", 2, TRUE}, {"int", 4, TRUE}, {"uint", 4, TRUE},
+        {"long", 8, TRUE}, {"ulong", 8, TRUE}, {"half", 2, FALSE},
+        {"float", 4, FALSE}, {"double", 8, FALSE}, {NULL, 0, FALSE}
+    };
+
+    gchar * name = g_strstrip(g_strdup(type_name));
+    gchar * suffix, * end;
+    guint64 n;
+    cl_bool found = CL_FALSE;
+
+    for (guint i = 0; types[i].name != NULL; ++i) {
+
+        if (!g_str_has_prefix(name, types[i].name)) continue;
+        suffix = name + strlen(types[i].name);
+
+        if (*suffix == '\0') {
+
+            /* Scalar type. */
+            *size = types[i].size;
+            *is_int = types[i].is_int;
+            found = CL_TRUE;
+
+        } else {
+
+            /* Vector type, three-component vectors are sized as four. */
+            n = g_ascii_strtoull(suffix, &end, 10);
+            if ((*end == '\0') && ((n == 2) || (n == 3) || (n == 4)
+                    || (n == 8) || (n == 16))) {
+                *size = types[i].size * (n == 3 ? 4 : n);
+                *is_int = FALSE;
+                found = CL_TRUE;
+            }
+        }
+        if (found) break;
+    }
+
+    g_free(name);
+    return found;
+}
+
+/**
+ * Run the kernel specified with the --run option and measure its
+ * execution time.
+ *
+ * Global and constant memory arguments are given zero-initialized
+ * buffers with ::CCL_C_SWEEP_ELEM_SIZE bytes per work-item, local memory
+ * arguments are given ::CCL_C_SWEEP_ELEM_SIZE bytes per work-item in a
+ * workgroup, and private scalar integer arguments are set to the sample
+ * size, with remaining private arguments set to zero.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] dev Device wrapper object.
+ * @param[in] prg Built program containing the kernel.
+ * @param[in] rws Sample size, i.e. the real number of work-items.
+ * @param[out] err Return location for a CCLErr object.
+ * @return Minimum kernel execution time in milliseconds, over
+ * ::CCL_C_SWEEP_RUNS runs after a warm-up run, or a negative value if an
+ * error occurred.
+ * */
+static double ccl_c_sweep_run(CCLContext * ctx, CCLDevice * dev,
+    CCLProgram * prg, size_t rws, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, -1);
+
+    /* Queue, kernel and kernel argument buffers. */
+    CCLQueue * cq = NULL;
+    CCLKernel * krnl = NULL;
+    GPtrArray * bufs = NULL;
+    CCLBuffer * buf;
+
+    /* Zero-initialized host memory for initializing buffers. */
+    void * zeros = NULL;
+
+    /* Kernel argument information. */
+    cl_uint num_args;
+    cl_kernel_arg_address_qualifier addr;
+    const char * type_name;
+    size_t arg_size;
+    gboolean is_int;
+    guint64 arg_value[16];
+
+    /* Work sizes. */
+    size_t gws, lws;
+
+    /* Kernel execution event and timings. */
+    CCLEvent * evt;
+    cl_ulong t_start, t_end;
+    double t_best = -1;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Create a profiling enabled queue and get the kernel. */
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_program_get_kernel(prg, run_kernel, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Determine work sizes. */
+    ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, &gws, &lws,
+        &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Set kernel arguments. */
+    num_args = ccl_kernel_get_info_scalar(
+        krnl, CL_KERNEL_NUM_ARGS, cl_uint, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    bufs = g_ptr_array_new_with_free_func(
+        (GDestroyNotify) ccl_buffer_destroy);
+    zeros = g_malloc0(gws * CCL_C_SWEEP_ELEM_SIZE);
+
+    for (cl_uint i = 0; i < num_args; ++i) {
+
+        addr = ccl_kernel_get_arg_info_scalar(krnl, i,
+            CL_KERNEL_ARG_ADDRESS_QUALIFIER, cl_kernel_arg_address_qualifier,
+            &err_internal);
+        if (ccl_c_info_unavailable(err_internal)) {
+            ccl_err_clear(&err_internal);
+            ccl_if_err_create_goto(*err, CCL_ERROR, TRUE,
+                CCL_ERROR_INFO_UNAVAILABLE_OCL, error_handler,
+                "Kernel argument information is not available, add the "
+                "-cl-kernel-arg-info compiler option.");
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        switch (addr) {
+
+            case CL_KERNEL_ARG_ADDRESS_GLOBAL:
+            case CL_KERNEL_ARG_ADDRESS_CONSTANT:
+                buf = ccl_buffer_new(ctx,
+                    CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                    gws * CCL_C_SWEEP_ELEM_SIZE, zeros, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                g_ptr_array_add(bufs, buf);
+                ccl_kernel_set_arg(krnl, i, buf);
+                break;
+
+            case CL_KERNEL_ARG_ADDRESS_LOCAL:
+                ccl_kernel_set_arg(krnl, i,
+                    ccl_arg_full(NULL, lws * CCL_C_SWEEP_ELEM_SIZE));
+                break;
+
+            default:
+                type_name = ccl_kernel_get_arg_info_array(krnl, i,
+                    CL_KERNEL_ARG_TYPE_NAME, char, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                ccl_if_err_create_goto(*err, CCL_ERROR,
+                    !ccl_c_sweep_arg_size(type_name, &arg_size, &is_int),
+                    CCL_ERROR_ARGS, error_handler,
+                    "Unsupported type '%s' for argument %u of kernel '%s'.",
+                    type_name, i, run_kernel);
+
+                /* Integer scalars are set to the sample size, which is
+                 * usually what bounds checks expect. */
+                memset(arg_value, 0, sizeof(arg_value));
+                if (is_int) {
+                    switch (arg_size) {
+                        case 1: *((cl_uchar *) arg_value) = (cl_uchar) rws;
+                            break;
+                        case 2: *((cl_ushort *) arg_value) = (cl_ushort) rws;
+                            break;
+                        case 4: *((cl_uint *) arg_value) = (cl_uint) rws;
+                            break;
+                        default: *((cl_ulong *) arg_value) = (cl_ulong) rws;
+                    }
+                }
+                ccl_kernel_set_arg(krnl, i, ccl_arg_full(arg_value, arg_size));
+        }
+    }
+
+    /* Run the kernel, once for warm-up and then for measuring. */
+    for (guint r = 0; r <= CCL_C_SWEEP_RUNS; ++r) {
+
+        evt = ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, &lws,
+            NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_queue_finish(cq, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        if (r == 0) continue;
+
+        t_start = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        t_end = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        if ((t_best < 0) || ((t_end - t_start) * 1e-6 < t_best))
+            t_best = (t_end - t_start) * 1e-6;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    t_best = -1;
+
+finish:
+
+    /* Free stuff. */
+    if (bufs) g_ptr_array_free(bufs, TRUE);
+    g_free(zeros);
+    if (cq) ccl_queue_destroy(cq);
+
+    /* Return best execution time. */
+    return t_best;
+}
+
+/**
+ * Build the input files with each of the option variants given with the
+ * --sweep option, showing build time and binary size for each variant,
+ * and optionally the execution time of a kernel for each sample size.
+ *
+ * Builds are performed one at a time, so that build times are not
+ * affected by concurrent builds. The program binary cache is not used.
+ *
+ * @param[out] err Return location for a CCLErr object.
+ * @return The number of failed builds.
+ * */
+static guint ccl_c_sweep(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+    /* Devices on which to build, system-wide or from a context. */
+    CCLDevSelDevices devices = NULL;
+    CCLContext * ctx_sel = NULL;
+    GPtrArray * devs = g_ptr_array_new();
+    CCLDevice * dev;
+
+    /* Context and program for the current build. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+
+    /* Sample sizes for running the kernel. */
+    size_t * sizes = NULL;
+    guint n_sizes = 0;
+    const char * size_str;
+    gchar * end;
+    guint64 size;
+
+    /* Build information. */
+    GTimer * timer = g_timer_new();
+    gdouble time;
+    size_t * bin_sizes;
+    char * dname;
+    const char * opts;
+
+    /* Kernel execution time. */
+    double t_run;
+
+    /* Number of failed builds. */
+    guint n_failed = 0;
+
+    /* Internal error handling objects. */
+    CCLErr * err_internal = NULL, * err_build = NULL;
+
+    /* Option sweeps are only supported for the build task. */
+    ccl_if_err_create_goto(*err, CCL_ERROR, task != CCL_C_BUILD,
+        CCL_ERROR_ARGS, error_handler,
+        "The --sweep option is only available for the 'build' task.");
+
+    /* Option sweeps require either source files or one IL file. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        ((src_files == NULL) == (il_file == NULL)) || (bin_files != NULL)
+        || (src_h_files != NULL) || (src_h_names != NULL),
+        CCL_ERROR_ARGS, error_handler,
+        "The --sweep option requires either: 1) one or more source "
+        "files; or, 2) one IL file.");
+
+    /* Sample sizes are only meaningful if a kernel is to be run. */
+    ccl_if_err_create_goto(*err, CCL_ERROR,
+        (run_sizes != NULL) && (run_kernel == NULL),
+        CCL_ERROR_ARGS, error_handler,
+        "The --run-size option requires the --run option.");
+
+    /* Parse sample sizes. */
+    if (run_kernel != NULL) {
+        n_sizes = run_sizes != NULL ? g_strv_length(run_sizes) : 1;
+        sizes = g_new(size_t, n_sizes);
+        for (guint i = 0; i < n_sizes; ++i) {
+            size_str = run_sizes != NULL
+                ? run_sizes[i] : CCL_C_SWEEP_DEFAULT_SIZE;
+            size = g_ascii_strtoull(size_str, &end, 10);
+            ccl_if_err_create_goto(*err, CCL_ERROR,
+                (end == size_str) || (*end != '\0') || (size == 0)
+                    || (size > G_MAXSIZE),
+                CCL_ERROR_ARGS, error_handler,
+                "Invalid sample size: '%s'.", size_str);
+            sizes[i] = (size_t) size;
+        }
+    }
+
+    /* Get devices. */
+    if (all_devs) {
+        devices = ccl_devsel_devices_new(&err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        for (guint i = 0; i < devices->len; ++i)
+            g_ptr_array_add(devs, devices->pdata[i]);
+    } else {
+        if (dev_idx == CCL_UTILS_NODEVICE) {
+            ctx_sel = ccl_context_new_from_menu(&err_internal);
+        } else {
+            ctx_sel = ccl_context_new_from_device_index(
+                &dev_idx, &err_internal);
+        }
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        dev = ccl_context_get_device(ctx_sel, 0, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        g_ptr_array_add(devs, dev);
+    }
+
+    /* Build each option variant on each device. */
+    for (guint d = 0; d < devs->len; ++d) {
+
+        dev = (CCLDevice *) devs->pdata[d];
+        dname = ccl_device_get_info_array(
+            dev, CL_DEVICE_NAME, char, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        g_printf("* Device                 : %s\n", dname);
+
+        ctx = ccl_context_new_from_devices(1, &dev, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        for (guint v = 0; sweep_opts[v] != NULL; ++v) {
+
+            opts = sweep_opts[v];
+            g_printf("  - Options              : %s\n",
+                *opts != '\0' ? opts : "(none)");
+
+            /* Create program from IL or from source. */
+            if (il_file != NULL) {
+                prg = ccl_program_new_from_il_file(ctx, il_file,
+                    &err_internal);
+            } else {
+                prg = ccl_program_new_from_source_files(ctx,
+                    g_strv_length(src_files), (const char **) src_files,
+                    &err_internal);
+            }
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+            /* Build program, measuring build time. */
+            g_timer_start(timer);
+            ccl_program_build(prg, opts, &err_build);
+            time = g_timer_elapsed(timer, NULL);
+
+            /* Only stop for errors that are not build failures. */
+            if (!ccl_c_is_build_error(err_build)) {
+                ccl_if_err_propagate_goto(err, err_build, error_handler);
+            }
+
+            g_printf("    . Build status       : %s\n",
+                err_build == NULL ? "Success" : "Error");
+
+            if (err_build != NULL) {
+
+                g_printf("    . Additional info.   : %s\n",
+                    err_build->message);
+                ccl_err_clear(&err_build);
+                n_failed++;
+
+            } else {
+
+                g_printf("    . Build time         : %.4f s\n", time);
+
+                /* Program has a single device, so only one binary. */
+                bin_sizes = ccl_program_get_info_array(
+                    prg, CL_PROGRAM_BINARY_SIZES, size_t, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                g_printf("    . Binary size        : %lu bytes\n",
+                    (unsigned long) bin_sizes[0]);
+
+                /* Run kernel with each sample size, if requested. */
+                for (guint s = 0; s < n_sizes; ++s) {
+                    t_run = ccl_c_sweep_run(
+                        ctx, dev, prg, sizes[s], &err_internal);
+                    if (err_internal == NULL) {
+                        g_printf("    . Kernel time        : %.4f ms "
+                            "(n = %lu)\n", t_run, (unsigned long) sizes[s]);
+                    } else {
+                        g_printf("    . Kernel time        : N/A "
+                            "(n = %lu, %s)\n", (unsigned long) sizes[s],
+                            err_internal->message);
+                        ccl_err_clear(&err_internal);
+                    }
+                }
+            }
+
+            ccl_program_destroy(prg);
+            prg = NULL;
+        }
+
+        ccl_context_destroy(ctx);
+        ctx = NULL;
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Free stuff. */
+    ccl_err_clear(&err_build);
+    g_timer_destroy(timer);
+    g_free(sizes);
+    g_ptr_array_free(devs, TRUE);
+    if (prg) ccl_program_destroy(prg);
+    if (ctx) ccl_context_destroy(ctx);
+    if (ctx_sel) ccl_context_destroy(ctx_sel);
+    if (devices) ccl_devsel_devices_destroy(devices);
+
+    /* Return number of failed builds. */
+    return n_failed;
+}
+
 /**
  * Kernel analyzer main program function.
  *
@@ -363,7 +1057,7 @@ int main(int argc, char * argv[]) {
 
     /* Number of types of files, file names and kernel names. */
     guint n_src_files, n_bin_files, n_src_h_files,
-        n_src_h_names, n_kernel_names;
+        n_src_h_names, n_kernel_names, n_il_files;
 
     /* Context wrapper. */
     CCLContext * ctx = NULL;
@@ -392,6 +1086,12 @@ int main(int argc, char * argv[]) {
     /* Build log. */
     const char * build_log;
 
+    /* Program IL. */
+    CCLWrapperInfo * il_info;
+
+    /* Number of failed builds in --all-devices mode. */
+    guint n_failed = 0;
+
     /* Parse command line options. */
     ccl_c_args_parse(argc, argv, &err);
     ccl_if_err_goto(err, error_handler);
@@ -410,14 +1110,32 @@ int main(int argc, char * argv[]) {
         ccl_devsel_print_device_strings(&err);
         ccl_if_err_goto(err, error_handler);
 
+    } else if (sweep_opts) {
+
+        /* If user requested an options sweep, build and optionally run
+         * each variant. */
+        n_failed = ccl_c_sweep(&err);
+        ccl_if_err_goto(err, error_handler);
+
+    } else if (all_devs) {
+
+        /* If user requested a build for all devices, populate the program
+         * binary cache in the given or default location. */
+        ccl_program_cache_enable(cache_dir, 0);
+        n_failed = ccl_c_build_all_devices(&err);
+        ccl_if_err_goto(err, error_handler);
+
     } else {
 
+        /* Enable program binary cache, if requested. */
+        if (cache_dir) ccl_program_cache_enable(cache_dir, 0);
+
         /* Otherwise perform a task, which requires at least one input
          * file and the specification of a device. */
 
         /* Check for input files. */
         ccl_if_err_create_goto(err, CCL_ERROR, (src_files == NULL) &&
-            (src_h_files == NULL) && (bin_files == NULL),
+            (src_h_files == NULL) && (bin_files == NULL) && (il_file == NULL),
             CCL_ERROR_ARGS, error_handler,
             "No source or binary input files have been specified.");
 
@@ -427,6 +1145,7 @@ int main(int argc, char * argv[]) {
         n_src_h_files = src_h_files != NULL ? g_strv_length(src_h_files) : 0;
         n_src_h_names = src_h_names != NULL ? g_strv_length(src_h_names) : 0;
         n_kernel_names = kernel_names != NULL ? g_strv_length(kernel_names) : 0;
+        n_il_files = il_file != NULL ? 1 : 0;
 
         /* Select a context/device. */
         if (dev_idx == CCL_UTILS_NODEVICE) {
@@ -444,13 +1163,13 @@ int main(int argc, char * argv[]) {
         switch (task) {
             case CCL_C_BUILD:
 
-                /* For direct builds we can only have either one binary
-                 * or one or more source files (but not both). */
+                /* For direct builds we can only have either one binary,
+                 * one IL file or one or more source files. */
                 ccl_if_err_create_goto(err, CCL_ERROR,
-                    (n_src_files > 0) && (n_bin_files > 0),
+                    ((n_src_files > 0) + (n_bin_files > 0) + n_il_files) > 1,
                     CCL_ERROR_ARGS, error_handler,
                     "The 'build' task requires either: 1) one or more "
-                    "source files; or, 2) one binary file.");
+                    "source files; 2) one binary file; or, 3) one IL file.");
                 ccl_if_err_create_goto(err, CCL_ERROR, n_bin_files > 1,
                     CCL_ERROR_ARGS, error_handler,
                     "The 'build' task accepts at most one binary file.");
@@ -469,6 +1188,11 @@ int main(int argc, char * argv[]) {
                     prg = ccl_program_new_from_binary_file(
                         ctx, dev, *bin_files, NULL, &err);
 
+                } else if (n_il_files == 1) {
+
+                    /* Create program from IL file. */
+                    prg = ccl_program_new_from_il_file(ctx, il_file, &err);
+
                 } else {
 
                     /* Create program from source. */
@@ -491,10 +1215,20 @@ int main(int argc, char * argv[]) {
 
             case CCL_C_COMPILE:
 
-                /* Compilation requires at least one source file. */
-                ccl_if_err_create_goto(err, CCL_ERROR, n_src_files == 0,
+                /* Compilation requires at least one source file or one IL
+                 * file. */
+                ccl_if_err_create_goto(err, CCL_ERROR,
+                    (n_src_files == 0) && (n_il_files == 0),
                     CCL_ERROR_ARGS, error_handler,
-                    "The 'compile' task requires at least one source file.");
+                    "The 'compile' task requires at least one source file "
+                    "or one IL file.");
+
+                /* Compilation does not support both sources and IL. */
+                ccl_if_err_create_goto(err, CCL_ERROR,
+                    (n_src_files > 0) && (n_il_files > 0),
+                    CCL_ERROR_ARGS, error_handler,
+                    "The 'compile' task does not support both source and IL "
+                    "files.");
 
                 /* Compilation does not support binaries. */
                 ccl_if_err_create_goto(err, CCL_ERROR, n_bin_files > 0,
@@ -529,9 +1263,13 @@ int main(int argc, char * argv[]) {
                     }
                 }
 
-                /* Create main program from source. */
-                prg = ccl_program_new_from_source_files(
-                    ctx, n_src_files, (const char **) src_files, &err);
+                /* Create main program from source or IL. */
+                if (n_il_files == 1) {
+                    prg = ccl_program_new_from_il_file(ctx, il_file, &err);
+                } else {
+                    prg = ccl_program_new_from_source_files(
+                        ctx, n_src_files, (const char **) src_files, &err);
+                }
                 ccl_if_err_goto(err, error_handler);
 
                 /* Compile program. */
@@ -553,10 +1291,11 @@ int main(int argc, char * argv[]) {
                 /* Linking requires at least one binary file and does
                  * not support source files. */
                 ccl_if_err_create_goto(err, CCL_ERROR, (n_bin_files == 0) ||
-                    (n_src_files > 0) || (n_src_h_files > 0),
+                    (n_src_files > 0) || (n_src_h_files > 0) ||
+                    (n_il_files > 0),
                     CCL_ERROR_ARGS, error_handler,
                     "The 'link' task requires at least one binary file "
-                    "and does not support source files.");
+                    "and does not support source files or IL files.");
 
                 /* Instantiate array of programs. */
                 prgs = g_ptr_array_new_full(
@@ -625,6 +1364,37 @@ int main(int argc, char * argv[]) {
             g_printf("* Binary output file     : %s\n", output);
         }
 
+        /* If build successful, save IL? */
+        if (il_output && prg && (build_status == CL_BUILD_SUCCESS)) {
+
+#ifndef CL_VERSION_2_1
+
+            /* Program IL can't be queried without OpenCL 2.1 support. */
+            CCL_UNUSED(il_info);
+            ccl_if_err_create_goto(err, CCL_ERROR, TRUE,
+                CCL_ERROR_UNSUPPORTED_OCL, error_handler,
+                "IL output requires cf4ocl to be deployed with support for "
+                "OpenCL version 2.1 or newer.");
+
+#else
+
+            /* Get program IL, which may not be available. */
+            il_info = ccl_program_get_info(prg, CL_PROGRAM_IL, &err);
+            ccl_if_err_goto(err, error_handler);
+            ccl_if_err_create_goto(err, CCL_ERROR, il_info->size == 0,
+                CCL_ERROR_INFO_UNAVAILABLE_OCL, error_handler,
+                "The program IL is not available in this platform.");
+
+            /* Save it. */
+            g_file_set_contents(il_output, (const gchar *) il_info->value,
+                (gssize) il_info->size, &err);
+            ccl_if_err_goto(err, error_handler);
+            g_printf("* IL output file         : %s\n", il_output);
+
+#endif
+
+        }
+
         /* Show build error message, if any. */
         if (err_build) {
             g_printf("* Additional information : %s\n", err_build->message);
@@ -695,7 +1465,7 @@ int main(int argc, char * argv[]) {
 
     /* If we got here, everything is OK. */
     g_assert(err == NULL);
-    status = err_build ? EXIT_FAILURE : EXIT_SUCCESS;
+    status = (err_build || n_failed) ? EXIT_FAILURE : EXIT_SUCCESS;
     goto cleanup;
 
 error_handler:
@@ -722,8 +1492,14 @@ cleanup:
     if (kernel_names) g_strfreev(kernel_names);
     if (bin_files) g_strfreev(bin_files);
     if (options) g_free(options);
+    if (sweep_opts) g_strfreev(sweep_opts);
+    if (run_kernel) g_free(run_kernel);
+    if (run_sizes) g_strfreev(run_sizes);
     if (bld_log_out) g_free(bld_log_out);
     if (output) g_free(output);
+    if (il_file) g_free(il_file);
+    if (il_output) g_free(il_output);
+    if (cache_dir) g_free(cache_dir);
     if (ctx) ccl_context_destroy(ctx);
     if (prg) ccl_program_destroy(prg);
     if (prgs) g_ptr_array_free(prgs, TRUE);
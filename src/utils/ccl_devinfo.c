@@ -67,6 +67,40 @@
  * and lists available devices independently of their platform. In this case,
  * the <strong>-d</strong> option will indicate the system-wise device index.
  *
+ * The <strong>--bench</strong> option runs a set of microbenchmarks on each
+ * device and outputs the results in JSON format, instead of showing device
+ * information. Devices are selected as with the <strong>-o</strong> option,
+ * so the <strong>-d</strong> option indicates the system-wise device index.
+ * For each device, the following measurements are reported:
+ *
+ * * `h2d_pageable_gbs`, `d2h_pageable_gbs` - host to device and device to
+ *   host bandwidth (GB/s) with pageable host memory;
+ * * `h2d_pinned_gbs`, `d2h_pinned_gbs` - host to device and device to host
+ *   bandwidth (GB/s) with pinned host memory, obtained by mapping a buffer
+ *   created with `CL_MEM_ALLOC_HOST_PTR`;
+ * * `d2d_gbs` - device to device copy bandwidth (GB/s), counting both the
+ *   bytes read and written;
+ * * `launch_latency_us` - median host time (&mu;s) to enqueue an empty
+ *   kernel and wait for its completion;
+ * * `event_overhead_us` - median host time (&mu;s) to enqueue a marker and
+ *   wait for its event;
+ * * `fp32_gflops`, `fp16_gflops` - peak single and half precision
+ *   throughput (GFLOP/s), with dependent multiply-adds. Half precision
+ *   throughput is `null` if the device does not support `cl_khr_fp16`.
+ *
+ * Measurements which could not be performed are `null`, and the
+ * respective error is reported in the `error` field of the device.
+ *
+ * The <strong>--json</strong> option outputs the selected device
+ * information in JSON format, which is faster when querying many
+ * parameters in systems with several devices. The information of each
+ * device is queried in a separate thread, concurrently with the other
+ * devices. The <strong>-a</strong>, <strong>-b</strong>, <strong>-c</strong>,
+ * <strong>-n</strong>, <strong>-p</strong>, <strong>-d</strong> and
+ * <strong>-o</strong> options work as in the default text output.
+ * Parameters not provided by a device are `null` if the <strong>-n</strong>
+ * option is given, and are omitted otherwise.
+ *
  * <dl>
  * <dt>-a, --all</dt>
  * <dd>Show all the available device information</dd>
@@ -87,6 +121,11 @@
  * <dd>Show known parameters even if not found in device</dd>
  * <dt>-v, --verbose</dt>
  * <dd>Show description of each parameter</dd>
+ * <dt>--bench</dt>
+ * <dd>Run device microbenchmarks and output results in JSON format</dd>
+ * <dt>--json</dt>
+ * <dd>Output device information in JSON format, querying devices
+ * concurrently</dd>
  * <dt>--version</dt>
  * <dd>Output version information and exit</dd>
  * <dt>-h, --help, -?</dt>
@@ -134,6 +173,72 @@
 /** Maximum length of device information output, per parameter. */
 #define CCL_DEVINFO_MAXINFOLEN 500
 
+/** Number of timed repetitions of each microbenchmark. */
+#define CCL_DEVINFO_BENCH_REPS 16
+
+/** Maximum size in bytes of the buffers used to measure bandwidth. */
+#define CCL_DEVINFO_BENCH_BUFSIZE (64 << 20)
+
+/** Number of work-items of the throughput microbenchmarks. */
+#define CCL_DEVINFO_BENCH_WI (1 << 20)
+
+/** Number of floating-point operations per work-item of the throughput
+ * microbenchmarks (64 iterations of two multiply-adds on 4-wide
+ * vectors). */
+#define CCL_DEVINFO_BENCH_FLOPS (64 * 2 * 2 * 4)
+
+/** Source of the multiply-add microbenchmark kernel for a given
+ * floating-point type. */
+#define CCL_DEVINFO_BENCH_FMA_SRC(type) \
+    "__kernel void ccl_bench_fma(__global " type " * out, " type " a) {\n" \
+    "    " type "4 x = (" type "4) (get_global_id(0) & 0xff);\n" \
+    "    " type "4 y = (" type "4) (a, a + a, a * a, a * a * a);\n" \
+    "    for (int i = 0; i < 64; ++i) {\n" \
+    "        x = mad(x, (" type "4) a, y);\n" \
+    "        y = mad(y, (" type "4) a, x);\n" \
+    "    }\n" \
+    "    out[get_global_id(0)] = x.s0 + x.s1 + x.s2 + x.s3\n" \
+    "        + y.s0 + y.s1 + y.s2 + y.s3;\n" \
+    "}\n"
+
+/** Source of the single precision microbenchmark kernels. */
+static const char * ccl_devinfo_bench_src =
+    "__kernel void ccl_bench_empty() {\n"
+    "}\n"
+    CCL_DEVINFO_BENCH_FMA_SRC("float");
+
+/** Source of the half precision microbenchmark kernel. */
+static const char * ccl_devinfo_bench_src_half =
+    "#pragma OPENCL EXTENSION cl_khr_fp16 : enable\n"
+    CCL_DEVINFO_BENCH_FMA_SRC("half");
+
+/**
+ * Results of the device microbenchmarks. Negative values indicate that
+ * the respective measurement was not performed.
+ * */
+typedef struct ccl_devinfo_bench {
+
+    /** Host to device bandwidth with pageable memory, in GB/s. */
+    double h2d_pageable;
+    /** Device to host bandwidth with pageable memory, in GB/s. */
+    double d2h_pageable;
+    /** Host to device bandwidth with pinned memory, in GB/s. */
+    double h2d_pinned;
+    /** Device to host bandwidth with pinned memory, in GB/s. */
+    double d2h_pinned;
+    /** Device to device copy bandwidth, in GB/s. */
+    double d2d;
+    /** Kernel launch latency, in microseconds. */
+    double launch_latency;
+    /** Event overhead, in microseconds. */
+    double event_overhead;
+    /** Single precision throughput, in GFLOP/s. */
+    double fp32;
+    /** Half precision throughput, in GFLOP/s. */
+    double fp16;
+
+} CCLDevInfoBench;
+
 /* Command line arguments and respective default values. */
 static gboolean opt_all = FALSE;
 static gboolean opt_basic = TRUE; /* Default. */
@@ -144,6 +249,8 @@ static guint opt_dev = G_MAXUINT;
 static gboolean opt_nfound = FALSE;
 static gboolean opt_verb = FALSE;
 static gboolean opt_list = FALSE;
+static gboolean opt_bench = FALSE;
+static gboolean opt_json = FALSE;
 static gboolean version = FALSE;
 
 /* Valid command line options. */
@@ -167,6 +274,12 @@ static GOptionEntry entries[] = {
      "Show known parameters even if not found in device", NULL},
     {"verbose",  'v', 0, G_OPTION_ARG_NONE,               &opt_verb,
      "Show description of each parameter",                NULL},
+    {"bench",      0, 0, G_OPTION_ARG_NONE,               &opt_bench,
+     "Run device microbenchmarks and output results in "
+     "JSON format",                                       NULL},
+    {"json",       0, 0, G_OPTION_ARG_NONE,               &opt_json,
+     "Output device information in JSON format, querying "
+     "devices concurrently",                              NULL},
     {"version",    0, 0, G_OPTION_ARG_NONE,               &version,
      "Output version information and exit",               NULL},
     { NULL, 0, 0, 0, NULL, NULL, NULL }
@@ -497,6 +610,865 @@ void ccl_devinfo_show_device_info_basic(CCLDevice * d) {
     }
 }
 
+/**
+ * Output a string as a JSON string literal.
+ *
+ * @param[in] str String to output, or `NULL`, in which case `null` is
+ * output.
+ * */
+void ccl_devinfo_json_string(const char * str) {
+
+    if (str == NULL) {
+        g_fprintf(CCL_DEVINFO_OUT, "null");
+        return;
+    }
+
+    g_fprintf(CCL_DEVINFO_OUT, "\"");
+    for (const guchar * c = (const guchar *) str; *c != '\0'; ++c) {
+        if ((*c == '"') || (*c == '\\'))
+            g_fprintf(CCL_DEVINFO_OUT, "\\%c", *c);
+        else if (*c < 0x20)
+            g_fprintf(CCL_DEVINFO_OUT, "\\u%04x", *c);
+        else
+            g_fprintf(CCL_DEVINFO_OUT, "%c", *c);
+    }
+    g_fprintf(CCL_DEVINFO_OUT, "\"");
+}
+
+/**
+ * Output a JSON object member with a numeric value, or `null` if the value
+ * is negative.
+ *
+ * @param[in] key Member name.
+ * @param[in] value Member value.
+ * @param[in] last Is this the last member of the object?
+ * */
+void ccl_devinfo_json_number(const char * key, double value, gboolean last) {
+
+    if (value < 0)
+        g_fprintf(CCL_DEVINFO_OUT, "      \"%s\": null", key);
+    else
+        g_fprintf(CCL_DEVINFO_OUT, "      \"%s\": %.3f", key, value);
+    g_fprintf(CCL_DEVINFO_OUT, last ? "\n" : ",\n");
+}
+
+/**
+ * Compare two doubles, for sorting.
+ *
+ * @param[in] a First double.
+ * @param[in] b Second double.
+ * @return A negative value if `a < b`, a positive value if `a > b`, or 0
+ * if they are equal.
+ * */
+static int ccl_devinfo_bench_cmp(const void * a, const void * b) {
+
+    double da = *((const double *) a);
+    double db = *((const double *) b);
+
+    return (da < db) ? -1 : ((da > db) ? 1 : 0);
+}
+
+/**
+ * Get the median of a set of samples, sorting them in the process.
+ *
+ * @param[in,out] samples Samples.
+ * @param[in] n Number of samples.
+ * @return The median of the samples.
+ * */
+static double ccl_devinfo_bench_median(double * samples, guint n) {
+
+    qsort(samples, n, sizeof(double), ccl_devinfo_bench_cmp);
+    return (n % 2) ? samples[n / 2]
+        : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+}
+
+/**
+ * Measure the best host to device and device to host bandwidth between a
+ * buffer and host memory, using blocking transfers.
+ *
+ * @param[in] buf Device buffer.
+ * @param[in] cq Command queue wrapper object.
+ * @param[in] host Host memory, with at least `size` bytes.
+ * @param[in] size Number of bytes to transfer.
+ * @param[out] h2d Location where to place the host to device bandwidth,
+ * in GB/s.
+ * @param[out] d2h Location where to place the device to host bandwidth,
+ * in GB/s.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devinfo_bench_transfer(CCLBuffer * buf, CCLQueue * cq,
+    void * host, size_t size, double * h2d, double * d2h, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    gint64 t0, t1, t2;
+    double best_h2d = 0, best_d2h = 0;
+    cl_bool ret_status;
+
+    /* First transfer is a warm-up run, and is not timed. */
+    for (guint r = 0; r <= CCL_DEVINFO_BENCH_REPS; ++r) {
+
+        t0 = g_get_monotonic_time();
+        ccl_buffer_enqueue_write(
+            buf, cq, CL_TRUE, 0, size, host, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        t1 = g_get_monotonic_time();
+        ccl_buffer_enqueue_read(
+            buf, cq, CL_TRUE, 0, size, host, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        t2 = g_get_monotonic_time();
+
+        /* Release events of finished transfers. */
+        ccl_queue_gc(cq);
+
+        /* Skip warm-up run and keep best bandwidth. */
+        if (r == 0) continue;
+        best_h2d = MAX(best_h2d, size / (1000.0 * MAX(t1 - t0, 1)));
+        best_d2h = MAX(best_d2h, size / (1000.0 * MAX(t2 - t1, 1)));
+    }
+    *h2d = best_h2d;
+    *d2h = best_d2h;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Execute a kernel several times, measuring the fastest device execution
+ * time and the median host time from enqueuing to completion.
+ *
+ * @param[in] krnl Kernel wrapper object, with all arguments set.
+ * @param[in] cq Command queue wrapper object, with profiling enabled.
+ * @param[in] gws Global work size.
+ * @param[out] dev_ns Location where to place the fastest device execution
+ * time, in nanoseconds.
+ * @param[out] host_us Location where to place the median host time, in
+ * microseconds.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devinfo_bench_kernel(CCLKernel * krnl, CCLQueue * cq,
+    size_t gws, double * dev_ns, double * host_us, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt;
+    double samples[CCL_DEVINFO_BENCH_REPS];
+    double best = G_MAXDOUBLE;
+    cl_ulong tstart, tend;
+    gint64 t0;
+    cl_bool ret_status;
+
+    /* First execution is a warm-up run, and is not timed. */
+    for (guint r = 0; r <= CCL_DEVINFO_BENCH_REPS; ++r) {
+
+        t0 = g_get_monotonic_time();
+        evt = ccl_kernel_enqueue_ndrange(
+            krnl, cq, 1, NULL, &gws, NULL, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        /* Skip warm-up run. */
+        if (r == 0) continue;
+        samples[r - 1] = (double) (g_get_monotonic_time() - t0);
+
+        tstart = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        tend = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        best = MIN(best, (double) MAX(tend - tstart, 1));
+    }
+    *dev_ns = best;
+    *host_us = ccl_devinfo_bench_median(samples, CCL_DEVINFO_BENCH_REPS);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release events of executed kernels. */
+    ccl_queue_gc(cq);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Measure the peak throughput of a device with the multiply-add
+ * microbenchmark kernel.
+ *
+ * @param[in] ctx Context wrapper object.
+ * @param[in] cq Command queue wrapper object, with profiling enabled.
+ * @param[in] src Source of the microbenchmark kernel.
+ * @param[in] half Is the kernel floating-point type `half`? Otherwise it
+ * is `float`.
+ * @param[out] gflops Location where to place the throughput, in GFLOP/s.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devinfo_bench_flops(CCLContext * ctx, CCLQueue * cq,
+    const char * src, gboolean half, double * gflops, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLProgram * prg = NULL;
+    CCLBuffer * out = NULL;
+    CCLKernel * krnl;
+    double dev_ns, host_us;
+    cl_float a = 0.999f;
+    cl_half a_half = 0x3bfe; /* 0.999 in half precision. */
+    size_t elem_size = half ? sizeof(cl_half) : sizeof(cl_float);
+    cl_bool ret_status;
+
+    prg = ccl_program_new_from_source(ctx, src, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_program_build(prg, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    out = ccl_buffer_new(ctx, CL_MEM_WRITE_ONLY,
+        CCL_DEVINFO_BENCH_WI * elem_size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_program_get_kernel(prg, "ccl_bench_fma", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    if (half)
+        ccl_kernel_set_args(krnl, out, ccl_arg_priv(a_half, cl_half), NULL);
+    else
+        ccl_kernel_set_args(krnl, out, ccl_arg_priv(a, cl_float), NULL);
+    ccl_devinfo_bench_kernel(krnl, cq, CCL_DEVINFO_BENCH_WI,
+        &dev_ns, &host_us, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    *gflops = ((double) CCL_DEVINFO_BENCH_WI * CCL_DEVINFO_BENCH_FLOPS)
+        / dev_ns;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release microbenchmark objects. */
+    if (out != NULL) ccl_buffer_destroy(out);
+    if (prg != NULL) ccl_program_destroy(prg);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Run the microbenchmarks on a device. Measurements performed before an
+ * error occurs are kept in `bench`.
+ *
+ * @param[in] d Device wrapper object.
+ * @param[out] bench Location where to place microbenchmark results.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE` otherwise.
+ * */
+static cl_bool ccl_devinfo_bench_device(
+    CCLDevice * d, CCLDevInfoBench * bench, CCLErr ** err) {
+
+    CCLErr * err_internal = NULL;
+    CCLContext * ctx = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl;
+    CCLBuffer * a = NULL, * b = NULL, * pin = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt;
+    const CCLDeviceCaps * caps;
+    void * host = NULL, * pinned = NULL;
+    double samples[CCL_DEVINFO_BENCH_REPS];
+    double dev_ns;
+    cl_ulong tstart, tend;
+    gint64 t0;
+    size_t size;
+    cl_bool ret_status;
+
+    /* No measurements yet. */
+    bench->h2d_pageable = bench->d2h_pageable = -1;
+    bench->h2d_pinned = bench->d2h_pinned = -1;
+    bench->d2d = bench->launch_latency = bench->event_overhead = -1;
+    bench->fp32 = bench->fp16 = -1;
+
+    /* Determine size of bandwidth buffers. */
+    caps = ccl_device_get_caps(d, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    size = MIN(CCL_DEVINFO_BENCH_BUFSIZE, caps->max_mem_alloc_size / 2);
+
+    /* Create context and profiling queue for the device. */
+    ctx = ccl_context_new_from_devices(1, &d, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    cq = ccl_queue_new(ctx, d, CL_QUEUE_PROFILING_ENABLE, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Create device buffers. */
+    a = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Host to device and device to host bandwidth, pageable memory. Host
+     * memory is touched so that its pages are mapped before timing. */
+    host = g_malloc(size);
+    memset(host, 0, size);
+    ccl_devinfo_bench_transfer(a, cq, host, size,
+        &bench->h2d_pageable, &bench->d2h_pageable, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Host to device and device to host bandwidth, pinned memory. */
+    pin = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+        size, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    pinned = ccl_buffer_enqueue_map(pin, cq, CL_TRUE,
+        CL_MAP_READ | CL_MAP_WRITE, 0, size, NULL, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_devinfo_bench_transfer(a, cq, pinned, size,
+        &bench->h2d_pinned, &bench->d2h_pinned, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Device to device copy bandwidth, counting bytes read and written. */
+    dev_ns = G_MAXDOUBLE;
+    for (guint r = 0; r <= CCL_DEVINFO_BENCH_REPS; ++r) {
+        evt = ccl_buffer_enqueue_copy(
+            a, b, cq, 0, 0, size, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (r == 0) continue;
+        tstart = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_START, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        tend = ccl_event_get_profiling_info_scalar(
+            evt, CL_PROFILING_COMMAND_END, cl_ulong, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        dev_ns = MIN(dev_ns, (double) MAX(tend - tstart, 1));
+    }
+    ccl_queue_gc(cq);
+    bench->d2d = (2.0 * size) / dev_ns;
+
+    /* Kernel launch latency, with an empty kernel. */
+    prg = ccl_program_new_from_source(
+        ctx, ccl_devinfo_bench_src, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_program_build(prg, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    krnl = ccl_program_get_kernel(prg, "ccl_bench_empty", &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    ccl_devinfo_bench_kernel(krnl, cq, 1, &dev_ns,
+        &bench->launch_latency, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Event overhead, with a marker on an idle queue. */
+    for (guint r = 0; r <= CCL_DEVINFO_BENCH_REPS; ++r) {
+        t0 = g_get_monotonic_time();
+        evt = ccl_enqueue_marker(cq, NULL, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        if (r > 0) samples[r - 1] = (double) (g_get_monotonic_time() - t0);
+    }
+    ccl_queue_gc(cq);
+    bench->event_overhead =
+        ccl_devinfo_bench_median(samples, CCL_DEVINFO_BENCH_REPS);
+
+    /* Peak single precision throughput. */
+    ccl_devinfo_bench_flops(ctx, cq, ccl_devinfo_bench_src, FALSE,
+        &bench->fp32, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Peak half precision throughput, if supported. */
+    if (caps->extensions & CCL_DEVICE_EXT_KHR_FP16) {
+        ccl_devinfo_bench_flops(ctx, cq, ccl_devinfo_bench_src_half, TRUE,
+            &bench->fp16, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    ret_status = CL_TRUE;
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ret_status = CL_FALSE;
+
+finish:
+
+    /* Release microbenchmark objects. */
+    if (pinned != NULL) {
+        ccl_buffer_enqueue_unmap(pin, cq, pinned, NULL, NULL);
+        ccl_queue_finish(cq, NULL);
+    }
+    if (pin != NULL) ccl_buffer_destroy(pin);
+    if (a != NULL) ccl_buffer_destroy(a);
+    if (b != NULL) ccl_buffer_destroy(b);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (cq != NULL) ccl_queue_destroy(cq);
+    if (ctx != NULL) ccl_context_destroy(ctx);
+    g_free(host);
+
+    /* Return status. */
+    return ret_status;
+}
+
+/**
+ * Run the microbenchmarks on the selected devices and output the results
+ * in JSON format. Errors in individual devices are reported in the output
+ * and do not stop the remaining devices from being benchmarked.
+ *
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * */
+void ccl_devinfo_bench(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_if_fail(err == NULL || *err == NULL);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Error in the microbenchmarks of the current device. */
+    CCLErr * err_bench = NULL;
+
+    /* List of device wrapper objects. */
+    CCLDevSelDevices devices = NULL;
+
+    /* Results of the microbenchmarks of the current device. */
+    CCLDevInfoBench bench;
+
+    /* Current device. */
+    CCLDevice * d;
+
+    /* Is the current device the first one to be output? */
+    gboolean first = TRUE;
+
+    /* Get all devices in the system. */
+    devices = ccl_devsel_devices_new(&err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    g_fprintf(CCL_DEVINFO_OUT, "{\n  \"cf4ocl\": ");
+    ccl_devinfo_json_string(CCL_VERSION_STRING_FINAL);
+    g_fprintf(CCL_DEVINFO_OUT, ",\n  \"devices\": [");
+
+    /* Cycle through devices. */
+    for (guint j = 0; j < devices->len; j++) {
+
+        /* Get out if this device is not to be queried. */
+        if ((opt_dev != G_MAXUINT) && (j != opt_dev))
+            continue;
+
+        /* Get current device and benchmark it. */
+        d = (CCLDevice *) devices->pdata[j];
+        ccl_devinfo_bench_device(d, &bench, &err_bench);
+
+        /* Output results. */
+        g_fprintf(CCL_DEVINFO_OUT, "%s\n    {\n      \"index\": %u,\n"
+            "      \"name\": ", first ? "" : ",", j);
+        ccl_devinfo_json_string(
+            ccl_device_get_info_array(d, CL_DEVICE_NAME, char, NULL));
+        g_fprintf(CCL_DEVINFO_OUT, ",\n      \"vendor\": ");
+        ccl_devinfo_json_string(
+            ccl_device_get_info_array(d, CL_DEVICE_VENDOR, char, NULL));
+        g_fprintf(CCL_DEVINFO_OUT, ",\n      \"driver\": ");
+        ccl_devinfo_json_string(
+            ccl_device_get_info_array(d, CL_DRIVER_VERSION, char, NULL));
+        g_fprintf(CCL_DEVINFO_OUT, ",\n      \"error\": ");
+        ccl_devinfo_json_string(
+            (err_bench != NULL) ? err_bench->message : NULL);
+        g_fprintf(CCL_DEVINFO_OUT, ",\n");
+        ccl_devinfo_json_number(
+            "h2d_pageable_gbs", bench.h2d_pageable, FALSE);
+        ccl_devinfo_json_number(
+            "d2h_pageable_gbs", bench.d2h_pageable, FALSE);
+        ccl_devinfo_json_number("h2d_pinned_gbs", bench.h2d_pinned, FALSE);
+        ccl_devinfo_json_number("d2h_pinned_gbs", bench.d2h_pinned, FALSE);
+        ccl_devinfo_json_number("d2d_gbs", bench.d2d, FALSE);
+        ccl_devinfo_json_number(
+            "launch_latency_us", bench.launch_latency, FALSE);
+        ccl_devinfo_json_number(
+            "event_overhead_us", bench.event_overhead, FALSE);
+        ccl_devinfo_json_number("fp32_gflops", bench.fp32, FALSE);
+        ccl_devinfo_json_number("fp16_gflops", bench.fp16, TRUE);
+        g_fprintf(CCL_DEVINFO_OUT, "    }");
+
+        ccl_err_clear(&err_bench);
+        first = FALSE;
+    }
+    g_fprintf(CCL_DEVINFO_OUT, "\n  ]\n}\n");
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Release devices. */
+    if (devices) ccl_devsel_devices_destroy(devices);
+}
+
+/**
+ * Device whose information is queried in a separate thread for JSON
+ * output.
+ * */
+typedef struct ccl_devinfo_json_dev {
+
+    /** Device wrapper object. */
+    CCLDevice * dev;
+
+    /** Device index, platform-wise or system-wise. */
+    guint index;
+
+    /** Index of the device platform in the list of JSON platforms, or
+     * `G_MAXUINT` if platforms are ignored. */
+    guint platf;
+
+    /** Indexes of rows of the device info map to query. */
+    const GArray * rows;
+
+    /** Formatted information values, in the same order as `rows`, `NULL`
+     * for information not available in the device. */
+    gchar ** values;
+
+    /** Thread which queries the device information. */
+    GThread * thread;
+
+} CCLDevInfoJsonDev;
+
+/**
+ * Get the indexes of the rows of the device info map selected by the
+ * command line options, without duplicates.
+ *
+ * @return Array of indexes of rows of the device info map.
+ * */
+static GArray * ccl_devinfo_json_rows(void) {
+
+    GArray * rows = g_array_new(FALSE, FALSE, sizeof(gint));
+    gboolean * selected = g_new0(gboolean, ccl_devquery_info_map_size);
+    const CCLDevQueryMap * info_row;
+    gchar * custom_param_name;
+    gint idx;
+
+    if (opt_all) {
+
+        /* All known parameters. */
+        for (gint k = 0; k < ccl_devquery_info_map_size; k++)
+            selected[k] = TRUE;
+
+    } else if (opt_custom) {
+
+        /* Parameters matching any of the user specified substrings. */
+        for (guint i = 0; opt_custom[i] != NULL; i++) {
+            idx = 0;
+            custom_param_name = ccl_devquery_get_prefix_final(opt_custom[i]);
+            while ((info_row = ccl_devquery_match(custom_param_name, &idx))
+                    != NULL)
+                selected[info_row - ccl_devquery_info_map] = TRUE;
+            g_free(custom_param_name);
+        }
+
+    } else {
+
+        /* Basic parameters. */
+        for (guint i = 0; basic_info[i] != NULL; i++) {
+            idx = ccl_devquery_get_index(basic_info[i]);
+            g_assert_cmpint(idx, >=, 0);
+            g_assert_cmpint(idx, <, ccl_devquery_info_map_size);
+            selected[idx] = TRUE;
+        }
+    }
+
+    /* Keep selected rows in the order of the device info map. */
+    for (gint k = 0; k < ccl_devquery_info_map_size; k++)
+        if (selected[k])
+            g_array_append_val(rows, k);
+    g_free(selected);
+
+    return rows;
+}
+
+/**
+ * Query and format the selected information of a device. Runs in a
+ * separate thread for each device.
+ *
+ * Information queries are performed back to back by each thread. Since
+ * the size of each parameter is remembered by the cf4ocl information
+ * cache, parameters whose size doesn't vary between devices are obtained
+ * with a single OpenCL call in all devices but the first.
+ *
+ * @param[in] data A ::CCLDevInfoJsonDev object.
+ * @return Always `NULL`.
+ * */
+static gpointer ccl_devinfo_json_query(gpointer data) {
+
+    CCLDevInfoJsonDev * jdev = (CCLDevInfoJsonDev *) data;
+    const CCLDevQueryMap * info_row;
+    CCLWrapperInfo * param_value;
+    gchar param_value_str[CCL_DEVINFO_MAXINFOLEN];
+    CCLErr * err = NULL;
+
+    for (guint i = 0; i < jdev->rows->len; i++) {
+
+        info_row = &ccl_devquery_info_map[g_array_index(jdev->rows, gint, i)];
+
+        /* Get and format the device information value, if available. */
+        param_value = ccl_device_get_info(jdev->dev, info_row->device_info,
+            &err);
+        if (err == NULL) {
+            jdev->values[i] = g_strdup(info_row->format(param_value,
+                param_value_str, CCL_DEVINFO_MAXINFOLEN, info_row->units));
+        } else {
+            ccl_err_clear(&err);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Output the information of a device in JSON format.
+ *
+ * @param[in] jdev Device with queried information.
+ * @param[in] indent Indentation of the device object.
+ * */
+static void ccl_devinfo_json_output_dev(
+    CCLDevInfoJsonDev * jdev, const char * indent) {
+
+    const CCLDevQueryMap * info_row;
+    gboolean first = TRUE;
+
+    g_fprintf(CCL_DEVINFO_OUT, "%s{\n%s  \"index\": %u,\n%s  \"name\": ",
+        indent, indent, jdev->index, indent);
+    ccl_devinfo_json_string(
+        ccl_device_get_info_array(jdev->dev, CL_DEVICE_NAME, char, NULL));
+    g_fprintf(CCL_DEVINFO_OUT, ",\n%s  \"info\": {", indent);
+
+    for (guint i = 0; i < jdev->rows->len; i++) {
+
+        /* Skip information not available, unless requested. */
+        if ((jdev->values[i] == NULL) && !opt_nfound) continue;
+
+        info_row = &ccl_devquery_info_map[g_array_index(jdev->rows, gint, i)];
+        g_fprintf(CCL_DEVINFO_OUT, "%s\n%s    ", first ? "" : ",", indent);
+        ccl_devinfo_json_string(info_row->param_name);
+        g_fprintf(CCL_DEVINFO_OUT, ": ");
+        ccl_devinfo_json_string(jdev->values[i]);
+        first = FALSE;
+    }
+
+    g_fprintf(CCL_DEVINFO_OUT, "\n%s  }\n%s}", indent, indent);
+}
+
+/**
+ * Output platform and device information in JSON format. The information
+ * of each device is queried in a separate thread, concurrently with the
+ * other devices.
+ *
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * */
+void ccl_devinfo_json(CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_if_fail(err == NULL || *err == NULL);
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* List of platform wrapper objects. */
+    CCLPlatforms * platforms = NULL;
+
+    /* List of device wrapper objects. */
+    CCLDevSelDevices devices = NULL;
+
+    /* Selected platforms, and devices to query. */
+    GPtrArray * jplatfs = g_ptr_array_new();
+    GArray * jplatf_idxs = g_array_new(FALSE, FALSE, sizeof(guint));
+    GArray * jdevs = g_array_new(FALSE, TRUE, sizeof(CCLDevInfoJsonDev));
+
+    /* Indexes of the rows of the device info map to query. */
+    GArray * rows = ccl_devinfo_json_rows();
+
+    /* Current platform and device. */
+    CCLPlatform * p;
+    CCLDevInfoJsonDev jdev = { NULL, 0, G_MAXUINT, rows, NULL, NULL };
+
+    /* Number of devices in platform. */
+    guint num_devs;
+
+    /* Is the current object the first one to be output? */
+    gboolean first;
+
+    if (no_platf) {
+
+        /* Ignore platforms, select devices system-wise. */
+        devices = ccl_devsel_devices_new(&err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        for (guint j = 0; j < devices->len; j++) {
+            if ((opt_dev != G_MAXUINT) && (j != opt_dev)) continue;
+            jdev.dev = (CCLDevice *) devices->pdata[j];
+            jdev.index = j;
+            g_array_append_val(jdevs, jdev);
+        }
+
+    } else {
+
+        /* Select devices platform-wise. */
+        platforms = ccl_platforms_new(&err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+        for (guint i = 0; i < ccl_platforms_count(platforms); i++) {
+
+            if ((opt_platf != G_MAXUINT) && (i != opt_platf)) continue;
+
+            p = ccl_platforms_get(platforms, i);
+            jdev.platf = jplatfs->len;
+            g_ptr_array_add(jplatfs, p);
+            g_array_append_val(jplatf_idxs, i);
+
+            /* A platform without devices is not an error. */
+            num_devs = ccl_platform_get_num_devices(p, &err_internal);
+            if ((err_internal) && (err_internal->domain == CCL_OCL_ERROR)
+                    && (err_internal->code == CL_DEVICE_NOT_FOUND)) {
+                ccl_err_clear(&err_internal);
+                continue;
+            }
+            ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+            for (guint j = 0; j < num_devs; j++) {
+                if ((opt_dev != G_MAXUINT) && (j != opt_dev)) continue;
+                jdev.dev = ccl_platform_get_device(p, j, &err_internal);
+                ccl_if_err_propagate_goto(err, err_internal, error_handler);
+                jdev.index = j;
+                g_array_append_val(jdevs, jdev);
+            }
+        }
+    }
+
+    /* Query devices concurrently, one thread per device. */
+    for (guint j = 0; j < jdevs->len; j++) {
+        CCLDevInfoJsonDev * jd = &g_array_index(jdevs, CCLDevInfoJsonDev, j);
+        jd->values = g_new0(gchar *, rows->len + 1);
+        jd->thread = g_thread_new("ccl_devinfo", ccl_devinfo_json_query, jd);
+    }
+    for (guint j = 0; j < jdevs->len; j++) {
+        CCLDevInfoJsonDev * jd = &g_array_index(jdevs, CCLDevInfoJsonDev, j);
+        g_thread_join(jd->thread);
+        jd->thread = NULL;
+    }
+
+    /* Output results. */
+    g_fprintf(CCL_DEVINFO_OUT, "{\n  \"cf4ocl\": ");
+    ccl_devinfo_json_string(CCL_VERSION_STRING_FINAL);
+
+    if (no_platf) {
+
+        g_fprintf(CCL_DEVINFO_OUT, ",\n  \"devices\": [");
+        for (guint j = 0; j < jdevs->len; j++) {
+            g_fprintf(CCL_DEVINFO_OUT, "%s\n", (j > 0) ? "," : "");
+            ccl_devinfo_json_output_dev(
+                &g_array_index(jdevs, CCLDevInfoJsonDev, j), "    ");
+        }
+        g_fprintf(CCL_DEVINFO_OUT, "\n  ]\n}\n");
+
+    } else {
+
+        g_fprintf(CCL_DEVINFO_OUT, ",\n  \"platforms\": [");
+        for (guint i = 0; i < jplatfs->len; i++) {
+
+            p = (CCLPlatform *) g_ptr_array_index(jplatfs, i);
+
+            g_fprintf(CCL_DEVINFO_OUT,
+                "%s\n    {\n      \"index\": %u,\n      \"name\": ",
+                (i > 0) ? "," : "", g_array_index(jplatf_idxs, guint, i));
+            ccl_devinfo_json_string(
+                ccl_platform_get_info_string(p, CL_PLATFORM_NAME, NULL));
+            g_fprintf(CCL_DEVINFO_OUT, ",\n      \"vendor\": ");
+            ccl_devinfo_json_string(
+                ccl_platform_get_info_string(p, CL_PLATFORM_VENDOR, NULL));
+            g_fprintf(CCL_DEVINFO_OUT, ",\n      \"version\": ");
+            ccl_devinfo_json_string(
+                ccl_platform_get_info_string(p, CL_PLATFORM_VERSION, NULL));
+            g_fprintf(CCL_DEVINFO_OUT, ",\n      \"profile\": ");
+            ccl_devinfo_json_string(
+                ccl_platform_get_info_string(p, CL_PLATFORM_PROFILE, NULL));
+            g_fprintf(CCL_DEVINFO_OUT, ",\n      \"devices\": [");
+
+            first = TRUE;
+            for (guint j = 0; j < jdevs->len; j++) {
+                CCLDevInfoJsonDev * jd =
+                    &g_array_index(jdevs, CCLDevInfoJsonDev, j);
+                if (jd->platf != i) continue;
+                g_fprintf(CCL_DEVINFO_OUT, "%s\n", first ? "" : ",");
+                ccl_devinfo_json_output_dev(jd, "        ");
+                first = FALSE;
+            }
+            g_fprintf(CCL_DEVINFO_OUT, "\n      ]\n    }");
+        }
+        g_fprintf(CCL_DEVINFO_OUT, "\n  ]\n}\n");
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Free stuff. */
+    for (guint j = 0; j < jdevs->len; j++)
+        g_strfreev(g_array_index(jdevs, CCLDevInfoJsonDev, j).values);
+    g_array_free(jdevs, TRUE);
+    g_ptr_array_free(jplatfs, TRUE);
+    g_array_free(jplatf_idxs, TRUE);
+    g_array_free(rows, TRUE);
+    if (platforms) ccl_platforms_destroy(platforms);
+    if (devices) ccl_devsel_devices_destroy(devices);
+}
+
 /**
  * Device info main program function.
  *
@@ -542,8 +1514,14 @@ int main(int argc, char * argv[]) {
         exit(0);
     }
 
-    /* Check if user requested a list of known information parameters. */
-    if (opt_list) {
+    /* Check if user requested device microbenchmarks. */
+    if (opt_bench) {
+
+        /* Yes, run microbenchmarks and output results as JSON. */
+        ccl_devinfo_bench(&err);
+        ccl_if_err_goto(err, error_handler);
+
+    } else if (opt_list) {
 
         /*Yes, user requested list, present it. */
 
@@ -562,6 +1540,12 @@ int main(int argc, char * argv[]) {
         }
         g_fprintf(CCL_DEVINFO_OUT, "\n");
 
+    } else if (opt_json) {
+
+        /* User requested JSON output, query devices concurrently. */
+        ccl_devinfo_json(&err);
+        ccl_if_err_goto(err, error_handler);
+
     } else {
 
         /* User didn't request list, proceed as normal query. */
@@ -0,0 +1,613 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Utility to aggregate and compare exported profiles.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ */
+
+/**
+ * @page ccl_prof
+ *
+ * @brief Utility to aggregate and compare exported profiles.
+ *
+ * SYNOPSIS
+ * ========
+ *
+ * **ccl_prof** [_OPTION_]... _FILE_...
+ *
+ * DESCRIPTION
+ * ===========
+ *
+ * The `ccl_prof` program loads one or more profiles exported with
+ * ::ccl_prof_export_info_file() (text format, with the default export
+ * options) or with ::ccl_prof_export_binary_file() (binary format). The
+ * format of each file is detected automatically.
+ *
+ * By default, the events of all the given files are merged in a single
+ * profile, and a summary with aggregate statistics, duration percentiles
+ * and event overlaps is shown, as produced by ::ccl_prof_print_summary().
+ * Statistics are determined with ::ccl_prof_calc(), so they are the same
+ * as those determined in the profiled program. The timelines of the
+ * several files are placed one after the other, so event overlaps are
+ * only determined between events of the same file. The merged profile can
+ * be saved in the binary format with the <strong>-o</strong> option.
+ *
+ * With the <strong>--diff</strong> option, exactly two files must be
+ * given, a baseline profile and a current profile, and the aggregate
+ * statistics of both are compared for each event name. Events whose mean
+ * duration increased by more than the threshold percentage given with the
+ * <strong>-t</strong> option are highlighted as regressions.
+ *
+ * <dl>
+ * <dt>-d, --diff</dt>
+ * <dd>Compare two profiles, a baseline and a current one, per event
+ * name</dd>
+ * <dt>-t, --threshold=PERCENT</dt>
+ * <dd>Minimum change of mean event duration highlighted as a regression
+ * or an improvement (default is 5)</dd>
+ * <dt>-f, --fail</dt>
+ * <dd>With --diff, exit with failure status if regressions are found</dd>
+ * <dt>-o, --output=FILE</dt>
+ * <dd>Save merged profile to file, in binary format</dd>
+ * <dt>--version</dt>
+ * <dd>Output version information and exit</dd>
+ * <dt>-h, --help, -?</dt>
+ * <dd>Show help options and exit</dd>
+ * </dl>
+ *
+ * AUTHOR
+ * ======
+ *
+ * Written by Nuno Fachada.
+ *
+ * REPORTING BUGS
+ * ==============
+ *
+ * * Report ccl_prof bugs at https://github.com/nunofachada/cf4ocl/issues
+ * * cf4ocl home page: http://nunofachada.github.io/cf4ocl/
+ * * cf4ocl wiki: https://github.com/nunofachada/cf4ocl/wiki
+ *
+ * COPYRIGHT
+ * =========
+ *
+ * Copyright (C) 2019 Nuno Fachada<br/>
+ * License GPLv3+: GNU GPL version 3 or later
+ * <http://gnu.org/licenses/gpl.html>.<br/>
+ * This is free software: you are free to change and redistribute it.<br/>
+ * There is NO WARRANTY, to the extent permitted by law.
+ *
+ * */
+
+#include <glib/gstdio.h>
+#include "ccl_utils.h"
+
+#define CCL_PROF_DESCRIPTION "Utility to aggregate and compare exported " \
+    "profiles"
+
+/* Magic string which starts binary profile files. */
+#define CCL_PROF_BIN_MAGIC "CCLPROF"
+
+/* Command line arguments and respective default values. */
+static gboolean opt_diff = FALSE;
+static gdouble opt_threshold = 5.0;
+static gboolean opt_fail = FALSE;
+static gchar * opt_output = NULL;
+static gchar ** files = NULL;
+static gboolean version = FALSE;
+
+/* Valid command line options. */
+static GOptionEntry entries[] = {
+    {"diff",      'd', 0, G_OPTION_ARG_NONE,           &opt_diff,
+     "Compare two profiles, a baseline and a current one, per event name",
+                                                       NULL},
+    {"threshold", 't', 0, G_OPTION_ARG_DOUBLE,         &opt_threshold,
+     "Minimum change of mean event duration highlighted as a regression "
+     "or an improvement (default is 5)",               "PERCENT"},
+    {"fail",      'f', 0, G_OPTION_ARG_NONE,           &opt_fail,
+     "With --diff, exit with failure status if regressions are found",
+                                                       NULL},
+    {"output",    'o', 0, G_OPTION_ARG_FILENAME,       &opt_output,
+     "Save merged profile to file, in binary format",  "FILE"},
+    {"version",     0, 0, G_OPTION_ARG_NONE,           &version,
+     "Output version information and exit",            NULL},
+    {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &files,
+     NULL,                                             "FILE..."},
+    { NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+/**
+ * Parse and verify command line arguments.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * */
+void ccl_prof_args_parse(int argc, char * argv[], CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_if_fail(err == NULL || *err == NULL);
+
+    /* Command line options context. */
+    GOptionContext * context = NULL;
+
+    /* Create parsing context. */
+    context = g_option_context_new(" - " CCL_PROF_DESCRIPTION);
+
+    /* Add acceptable command line options to context. */
+    g_option_context_add_main_entries(context, entries, NULL);
+
+    /* Use context to parse command line options. */
+    g_option_context_parse(context, &argc, &argv, err);
+    ccl_if_err_goto(*err, error_handler);
+
+    /* If we get here, no need for error treatment, jump to cleanup. */
+    g_assert(*err == NULL);
+    goto cleanup;
+
+error_handler:
+
+    /* If we got here, everything is OK. */
+    g_assert(*err != NULL);
+
+cleanup:
+
+    /* Free context. */
+    if (context) g_option_context_free(context);
+
+    /* Return. */
+    return;
+}
+
+/**
+ * Load the event profiling information in a text profile file, exported
+ * with the default export options.
+ *
+ * @param[in] filename Name of text profile file.
+ * @param[out] infos Array where to add the event profiling information.
+ * @param[out] contents Location where to place the file contents, which
+ * the event and queue names of the loaded information point to, and
+ * which should be freed with `g_free()`.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * */
+static void ccl_prof_load_text(const char * filename, GArray * infos,
+    gchar ** contents, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_if_fail(err == NULL || *err == NULL);
+
+    /* Current line, start of next line and fields of current line. */
+    gchar * line, * next, * end;
+    gchar * fields[4];
+    guint lineno = 0;
+
+    /* Event information of current line. */
+    CCLProfInfo info;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Read file. */
+    g_file_get_contents(filename, contents, NULL, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* Parse each line, i.e. queue, start, end and event name separated by
+     * tabs. Lines are split in place, so that event and queue names point
+     * to the file contents. */
+    for (line = *contents; line != NULL; line = next) {
+
+        lineno++;
+        next = strchr(line, '\n');
+        if (next != NULL) *(next++) = '\0';
+        g_strchomp(line);
+        if (*line == '\0') continue;
+
+        fields[0] = line;
+        for (guint j = 1; j < 4; ++j) {
+            fields[j] = (fields[j - 1] != NULL)
+                ? strchr(fields[j - 1], '\t') : NULL;
+            if (fields[j] != NULL) *(fields[j]++) = '\0';
+        }
+        ccl_if_err_create_goto(*err, CCL_ERROR, fields[3] == NULL,
+            CCL_ERROR_INVALID_DATA, error_handler,
+            "%s:%u: expected four tab separated fields.", filename, lineno);
+
+        info.queue_name = fields[0];
+        info.event_name = fields[3];
+        info.command_type = 0;
+        info.t_start = g_ascii_strtoull(fields[1], &end, 10);
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (end == fields[1]) || (*end != '\0'),
+            CCL_ERROR_INVALID_DATA, error_handler,
+            "%s:%u: invalid start instant.", filename, lineno);
+        info.t_end = g_ascii_strtoull(fields[2], &end, 10);
+        ccl_if_err_create_goto(*err, CCL_ERROR,
+            (end == fields[2]) || (*end != '\0')
+                || (info.t_end < info.t_start),
+            CCL_ERROR_INVALID_DATA, error_handler,
+            "%s:%u: invalid end instant.", filename, lineno);
+
+        /* Queued and submit instants are not exported in this format. */
+        info.t_queued = info.t_start;
+        info.t_submit = info.t_start;
+
+        g_array_append_val(infos, info);
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Return. */
+    return;
+}
+
+/**
+ * Load an exported profile file into a profile object.
+ *
+ * @param[in] prof Profile object.
+ * @param[in] filename Name of text or binary profile file.
+ * @param[in,out] offset Instant where the timeline of the file starts in
+ * the profile object, updated to the instant after the last event of the
+ * file.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return The number of loaded events.
+ * */
+static guint ccl_prof_load(CCLProf * prof, const char * filename,
+    cl_ulong * offset, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+    /* File and first bytes, for detecting the file format. */
+    FILE * fp = NULL;
+    char magic[sizeof(CCL_PROF_BIN_MAGIC)] = { 0 };
+
+    /* Binary profile file, or contents of text profile file. */
+    CCLProfFile * pfile = NULL;
+    gchar * contents = NULL;
+
+    /* Loaded event information. */
+    GArray * infos = g_array_new(FALSE, FALSE, sizeof(CCLProfInfo));
+    const CCLProfInfo * info_ptr;
+    CCLProfInfo * info;
+    guint num_events = 0;
+
+    /* Oldest and newest instants in file. */
+    cl_ulong t_first = CL_ULONG_MAX, t_last = 0;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    /* Detect file format. */
+    fp = g_fopen(filename, "rb");
+    ccl_if_err_create_goto(*err, CCL_ERROR, fp == NULL,
+        CCL_ERROR_OPENFILE, error_handler,
+        "Unable to open file '%s'.", filename);
+    if (fread(magic, 1, sizeof(CCL_PROF_BIN_MAGIC) - 1, fp) == 0)
+        magic[0] = '\0';
+    fclose(fp);
+
+    if (g_strcmp0(magic, CCL_PROF_BIN_MAGIC) == 0) {
+
+        /* Binary format, names point to the mapped file. */
+        pfile = ccl_prof_file_open(filename, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+        ccl_prof_file_iter_info_init(
+            pfile, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+        while ((info_ptr = ccl_prof_file_iter_info_next(pfile)) != NULL)
+            g_array_append_vals(infos, info_ptr, 1);
+
+    } else {
+
+        /* Text format, names point to the file contents. */
+        ccl_prof_load_text(filename, infos, &contents, &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+
+    /* Determine the timeline of the file. */
+    for (guint i = 0; i < infos->len; ++i) {
+        info = &g_array_index(infos, CCLProfInfo, i);
+        t_first = MIN(t_first, MIN(info->t_queued, info->t_start));
+        t_last = MAX(t_last, info->t_end);
+    }
+
+    /* Add events to profile object, shifting them to the given offset, so
+     * that events of different files do not overlap. */
+    for (guint i = 0; i < infos->len; ++i) {
+        info = &g_array_index(infos, CCLProfInfo, i);
+        info->t_queued = info->t_queued - t_first + *offset;
+        info->t_submit = MAX(info->t_submit, t_first) - t_first + *offset;
+        info->t_start = info->t_start - t_first + *offset;
+        info->t_end = MAX(info->t_end, t_first) - t_first + *offset;
+        ccl_prof_add_info(prof, info);
+    }
+    num_events = infos->len;
+    if (num_events > 0) *offset += t_last - t_first + 1;
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+
+finish:
+
+    /* Free stuff. */
+    g_array_free(infos, TRUE);
+    if (pfile) ccl_prof_file_close(pfile);
+    g_free(contents);
+
+    /* Return number of loaded events. */
+    return num_events;
+}
+
+/**
+ * Load exported profile files into a new profile object, and perform the
+ * profile calculations.
+ *
+ * @param[in] filenames Names of profile files.
+ * @param[in] num_files Number of profile files.
+ * @param[out] err Return location for a CCLErr, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new profile object with calculations performed, or `NULL` if
+ * an error occurs.
+ * */
+static CCLProf * ccl_prof_load_all(
+    gchar ** filenames, guint num_files, CCLErr ** err) {
+
+    /* Make sure err is NULL or it is not set. */
+    g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+    /* Profile object. */
+    CCLProf * prof = ccl_prof_new();
+
+    /* Start of timeline of next file, and total number of events. */
+    cl_ulong offset = 0;
+    guint num_events = 0;
+
+    /* Internal error handling object. */
+    CCLErr * err_internal = NULL;
+
+    for (guint i = 0; i < num_files; ++i) {
+        num_events += ccl_prof_load(prof, filenames[i], &offset,
+            &err_internal);
+        ccl_if_err_propagate_goto(err, err_internal, error_handler);
+    }
+    ccl_if_err_create_goto(*err, CCL_ERROR, num_events == 0,
+        CCL_ERROR_INVALID_DATA, error_handler,
+        "No events found in the given profile files.");
+
+    /* Determine statistics. */
+    ccl_prof_calc(prof, &err_internal);
+    ccl_if_err_propagate_goto(err, err_internal, error_handler);
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL || *err == NULL);
+    goto finish;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err == NULL || *err != NULL);
+    ccl_prof_destroy(prof);
+    prof = NULL;
+
+finish:
+
+    /* Return profile object. */
+    return prof;
+}
+
+/**
+ * Compare the aggregate statistics of a current profile with the ones of
+ * a baseline profile, per event name, and show the result.
+ *
+ * @param[in] base Baseline profile object.
+ * @param[in] curr Current profile object.
+ * @return Number of events with regressions.
+ * */
+static guint ccl_prof_diff(CCLProf * base, CCLProf * curr) {
+
+    /* Aggregate statistics of baseline and current profiles. */
+    const CCLProfAgg * agg_b, * agg_c;
+
+    /* Change of mean duration, in percentage. */
+    double change;
+
+    /* Result of comparison. */
+    const char * mark;
+
+    /* Number of regressions. */
+    guint n_regress = 0;
+
+    g_printf("\n Event duration comparison (baseline vs. current):\n");
+    g_printf("   -------------------------------------------------------"
+        "-------------------------------------------------------\n");
+    g_printf("   | Event name                     |   Count b. |   Count c. "
+        "| Mean b. (s) | Mean c. (s) | Change (%%) | p90 c. (s)  |\n");
+    g_printf("   -------------------------------------------------------"
+        "-------------------------------------------------------\n");
+
+    /* Events in baseline profile. */
+    ccl_prof_iter_agg_init(base, CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_ASC);
+    while ((agg_b = ccl_prof_iter_agg_next(base)) != NULL) {
+
+        agg_c = ccl_prof_get_agg(curr, agg_b->event_name);
+
+        if ((agg_c == NULL) || (agg_c->count == 0)) {
+            g_printf("   | %-30.30s | %10u | %10u | %11.4e | %11s | %10s "
+                "| %11s | removed\n", agg_b->event_name, agg_b->count, 0,
+                agg_b->mean_time * 1e-9, "-", "-", "-");
+            continue;
+        }
+
+        change = (agg_b->mean_time > 0)
+            ? (agg_c->mean_time - agg_b->mean_time) * 100.0
+                / agg_b->mean_time
+            : 0.0;
+        if (change > opt_threshold) {
+            mark = "<< REGRESSION";
+            n_regress++;
+        } else if (change < -opt_threshold) {
+            mark = "improved";
+        } else {
+            mark = "";
+        }
+
+        g_printf("   | %-30.30s | %10u | %10u | %11.4e | %11.4e | %+10.2f "
+            "| %11.4e | %s\n", agg_b->event_name, agg_b->count,
+            agg_c->count, agg_b->mean_time * 1e-9, agg_c->mean_time * 1e-9,
+            change, agg_c->p90_time * 1e-9, mark);
+    }
+
+    /* Events only in current profile. */
+    ccl_prof_iter_agg_init(curr, CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_ASC);
+    while ((agg_c = ccl_prof_iter_agg_next(curr)) != NULL) {
+        if (ccl_prof_get_agg(base, agg_c->event_name) != NULL) continue;
+        g_printf("   | %-30.30s | %10u | %10u | %11s | %11.4e | %10s "
+            "| %11.4e | new\n", agg_c->event_name, 0, agg_c->count, "-",
+            agg_c->mean_time * 1e-9, "-", agg_c->p90_time * 1e-9);
+    }
+
+    g_printf("   -------------------------------------------------------"
+        "-------------------------------------------------------\n");
+    g_printf("   Effective duration (s): baseline %.4e, current %.4e\n",
+        ccl_prof_get_eff_duration(base) * 1e-9,
+        ccl_prof_get_eff_duration(curr) * 1e-9);
+    g_printf("   Regressions above %.2f%%: %u\n\n", opt_threshold, n_regress);
+
+    return n_regress;
+}
+
+/**
+ * Profile aggregation utility main program function.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Vector of command line arguments.
+ * @return ::CCL_SUCCESS if program returns with no error, or another
+ * ::CCLErrorCode value otherwise.
+ */
+int main(int argc, char * argv[]) {
+
+    /* Error object. */
+    CCLErr * err = NULL;
+
+    /* Merged, baseline and current profile objects. */
+    CCLProf * prof = NULL, * base = NULL, * curr = NULL;
+
+    /* Number of input files. */
+    guint num_files;
+
+    /* Number of regressions found. */
+    guint n_regress = 0;
+
+    /* Program return status. */
+    gint status;
+
+    /* Parse command line options. */
+    ccl_prof_args_parse(argc, argv, &err);
+    ccl_if_err_goto(err, error_handler);
+
+    /* If version was requested, output version and exit. */
+    if (version) {
+        ccl_common_version_print("ccl_prof");
+        exit(0);
+    }
+
+    /* Check input files. */
+    num_files = files != NULL ? g_strv_length(files) : 0;
+    ccl_if_err_create_goto(err, CCL_ERROR, num_files == 0,
+        CCL_ERROR_ARGS, error_handler, "No profile files specified.");
+
+    if (opt_diff) {
+
+        /* Compare a baseline profile with a current profile. */
+        ccl_if_err_create_goto(err, CCL_ERROR, num_files != 2,
+            CCL_ERROR_ARGS, error_handler,
+            "The --diff option requires exactly two profile files.");
+        ccl_if_err_create_goto(err, CCL_ERROR, opt_output != NULL,
+            CCL_ERROR_ARGS, error_handler,
+            "The --output option is not available with --diff.");
+
+        base = ccl_prof_load_all(&files[0], 1, &err);
+        ccl_if_err_goto(err, error_handler);
+        curr = ccl_prof_load_all(&files[1], 1, &err);
+        ccl_if_err_goto(err, error_handler);
+
+        n_regress = ccl_prof_diff(base, curr);
+
+    } else {
+
+        /* Merge profiles and show summary. */
+        prof = ccl_prof_load_all(files, num_files, &err);
+        ccl_if_err_goto(err, error_handler);
+
+        g_printf("\n Profiles merged           : %u\n", num_files);
+        ccl_prof_print_summary(prof);
+
+        /* Save merged profile, if requested. */
+        if (opt_output != NULL) {
+            ccl_prof_export_binary_file(prof, opt_output, &err);
+            ccl_if_err_goto(err, error_handler);
+        }
+    }
+
+    /* If we got here, everything is OK. */
+    g_assert(err == NULL);
+    status = (opt_fail && (n_regress > 0)) ? EXIT_FAILURE : EXIT_SUCCESS;
+    goto cleanup;
+
+error_handler:
+
+    /* If we got here there was an error, verify that it is so. */
+    g_assert(err != NULL);
+
+    g_fprintf(stderr, "%s\n", err->message);
+
+    status = (err->domain == CCL_ERROR) ? err->code : EXIT_FAILURE;
+    g_error_free(err);
+
+cleanup:
+
+    /* Free stuff. */
+    if (prof) ccl_prof_destroy(prof);
+    if (base) ccl_prof_destroy(base);
+    if (curr) ccl_prof_destroy(curr);
+    if (files) g_strfreev(files);
+    g_free(opt_output);
+
+    /* Return status. */
+    return status;
+}
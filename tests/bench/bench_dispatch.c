@@ -0,0 +1,205 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Benchmark of OpenCL calls through the ICD loader versus direct calls
+ * through the dispatch table of OpenCL objects.
+ *
+ * For each OpenCL function dispatched directly by cf4ocl when built with
+ * the `ICD_DIRECT_DISPATCH` option, the average time per call through the
+ * ICD loader and through the object's dispatch table is reported, in
+ * JSON format. The time of the equivalent cf4ocl calls, using the mode
+ * cf4ocl was built with, is also reported.
+ *
+ * Usage: `bench_dispatch [iterations]`
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include "test.h"
+#include <CL/cl_icd.h>
+
+/* Default number of calls per measurement. */
+#define CCL_BENCH_ITERS 100000
+
+/* Number of kernel launches between queue finishes. */
+#define CCL_BENCH_FINISH_EVERY 256
+
+/* Dispatch table of an OpenCL object. */
+#define bench_table(obj) (*((struct _cl_icd_dispatch * const *) (obj)))
+
+/* Print one result in JSON format. A negative cf4ocl time is not
+ * reported. */
+static void bench_print(const char * name, double loader, double direct,
+    double ccl, cl_bool last) {
+
+    g_print("    {\"name\": \"%s\", \"loader_ns\": %.1f, "
+        "\"direct_ns\": %.1f, ", name, loader, direct);
+    if (ccl < 0)
+        g_print("\"cf4ocl_ns\": null}%s\n", last ? "" : ",");
+    else
+        g_print("\"cf4ocl_ns\": %.1f}%s\n", ccl, last ? "" : ",");
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return `EXIT_SUCCESS` if benchmark runs, `EXIT_FAILURE` otherwise.
+ * */
+int main(int argc, char ** argv) {
+
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    GTimer * timer = g_timer_new();
+    cl_kernel kernel;
+    cl_command_queue queue;
+    cl_event event;
+    cl_mem mem;
+    cl_uint d = 1;
+    cl_int exec_status;
+    size_t gws = 1;
+    double loader, direct, ccl;
+    gulong iters = (argc > 1) ? strtoul(argv[1], NULL, 10) : CCL_BENCH_ITERS;
+
+    if (iters == 0) iters = CCL_BENCH_ITERS;
+
+    /* Setup context, queue, kernel with its arguments, and one event. */
+    ctx = ccl_test_context_new(0, &err);
+    if (err != NULL) goto error_handler;
+    dev = ccl_context_get_device(ctx, 0, &err);
+    if (err != NULL) goto error_handler;
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    if (err != NULL) goto error_handler;
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    if (err != NULL) goto error_handler;
+    ccl_program_build(prg, NULL, &err);
+    if (err != NULL) goto error_handler;
+    krnl = ccl_program_get_kernel(prg, "test_sum_full", &err);
+    if (err != NULL) goto error_handler;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, &err);
+    if (err != NULL) goto error_handler;
+    ccl_kernel_set_args(krnl, buf, buf, buf, ccl_arg_priv(d, cl_uint), NULL);
+    evt = ccl_kernel_enqueue_ndrange(
+        krnl, cq, 1, NULL, &gws, NULL, NULL, &err);
+    if (err != NULL) goto error_handler;
+    ccl_queue_finish(cq, &err);
+    if (err != NULL) goto error_handler;
+
+    kernel = ccl_kernel_unwrap(krnl);
+    queue = ccl_queue_unwrap(cq);
+    event = ccl_event_unwrap(evt);
+    mem = ccl_buffer_unwrap(buf);
+
+    g_print("{\n  \"benchmark\": \"dispatch\",\n");
+    g_print("  \"iterations\": %lu,\n  \"results\": [\n", iters);
+
+    /* clSetKernelArg(). */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        clSetKernelArg(kernel, 0, sizeof(cl_mem), &mem);
+    loader = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        bench_table(kernel)->clSetKernelArg(kernel, 0, sizeof(cl_mem), &mem);
+    direct = g_timer_elapsed(timer, NULL);
+    bench_print("clSetKernelArg", 1e9 * loader / iters,
+        1e9 * direct / iters, -1, CL_FALSE);
+
+    /* clGetEventInfo(). */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        clGetEventInfo(event, CL_EVENT_COMMAND_EXECUTION_STATUS,
+            sizeof(cl_int), &exec_status, NULL);
+    loader = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        bench_table(event)->clGetEventInfo(event,
+            CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int),
+            &exec_status, NULL);
+    direct = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        ccl_event_get_info_scalar(evt, CL_EVENT_COMMAND_EXECUTION_STATUS,
+            cl_int, NULL);
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("clGetEventInfo", 1e9 * loader / iters,
+        1e9 * direct / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* clEnqueueNDRangeKernel(), finishing the queue periodically. The
+     * cf4ocl launches also change an argument each time, so they include
+     * a clSetKernelArg() call. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        clEnqueueNDRangeKernel(
+            queue, kernel, 1, NULL, &gws, NULL, 0, NULL, NULL);
+        if (i % CCL_BENCH_FINISH_EVERY == 0) clFinish(queue);
+    }
+    clFinish(queue);
+    loader = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        bench_table(queue)->clEnqueueNDRangeKernel(
+            queue, kernel, 1, NULL, &gws, NULL, 0, NULL, NULL);
+        if (i % CCL_BENCH_FINISH_EVERY == 0) clFinish(queue);
+    }
+    clFinish(queue);
+    direct = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        d = (cl_uint) i;
+        ccl_kernel_set_arg(krnl, 3, ccl_arg_priv(d, cl_uint));
+        ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, NULL, NULL, NULL);
+        if (i % CCL_BENCH_FINISH_EVERY == 0) ccl_queue_finish(cq, NULL);
+    }
+    ccl_queue_finish(cq, NULL);
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("clEnqueueNDRangeKernel", 1e9 * loader / iters,
+        1e9 * direct / iters, 1e9 * ccl / iters, CL_TRUE);
+
+    g_print("  ]\n}\n");
+
+error_handler:
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    /* Destroy stuff. */
+    if (buf != NULL) ccl_buffer_destroy(buf);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (cq != NULL) ccl_queue_destroy(cq);
+    if (ctx != NULL) ccl_context_destroy(ctx);
+    g_timer_destroy(timer);
+
+    return (evt != NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,296 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Benchmark of the overhead of cf4ocl calls versus equivalent raw OpenCL
+ * calls.
+ *
+ * The average time per operation with raw OpenCL calls and with cf4ocl
+ * calls is reported in JSON format, for wrapper creation and destruction,
+ * kernel argument setting and launching, event wait lists and info
+ * queries. The time of profile calculations on synthetic event sets of
+ * increasing size, which have no raw OpenCL equivalent, is also reported.
+ *
+ * Usage: `bench_overhead [iterations]`
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include "test.h"
+
+/* Default number of operations per measurement. */
+#define CCL_BENCH_ITERS 10000
+
+/* Number of kernel launches between queue finishes. */
+#define CCL_BENCH_FINISH_EVERY 256
+
+/* Number of distinct event names and queues in synthetic profiles. */
+#define CCL_BENCH_PROF_NAMES 16
+#define CCL_BENCH_PROF_QUEUES 4
+
+/* Print one result in JSON format. A negative raw OpenCL time is not
+ * reported, and in that case the overhead is not reported either. */
+static void bench_print(const char * name, gulong ops, double raw,
+    double ccl, cl_bool last) {
+
+    g_print("    {\"name\": \"%s\", \"ops\": %lu, ", name, ops);
+    if (raw < 0)
+        g_print("\"raw_ns\": null, \"cf4ocl_ns\": %.1f, "
+            "\"overhead_ns\": null}%s\n", ccl, last ? "" : ",");
+    else
+        g_print("\"raw_ns\": %.1f, \"cf4ocl_ns\": %.1f, "
+            "\"overhead_ns\": %.1f}%s\n",
+            raw, ccl, ccl - raw, last ? "" : ",");
+}
+
+/* Time profile calculations on a synthetic set of events with
+ * overlapping executions in several queues. Returns the time in seconds,
+ * or a negative value on error. */
+static double bench_prof_calc(guint num_events, GTimer * timer) {
+
+    CCLProf * prof = ccl_prof_new();
+    CCLProfInfo info;
+    CCLErr * err = NULL;
+    gchar * names[CCL_BENCH_PROF_NAMES];
+    gchar * queues[CCL_BENCH_PROF_QUEUES];
+    double t;
+
+    for (guint i = 0; i < CCL_BENCH_PROF_NAMES; ++i)
+        names[i] = g_strdup_printf("EVENT_%02u", i);
+    for (guint i = 0; i < CCL_BENCH_PROF_QUEUES; ++i)
+        queues[i] = g_strdup_printf("queue_%u", i);
+
+    /* Events in each queue follow each other, with pseudo-random
+     * durations, so that events in different queues overlap. */
+    for (guint i = 0; i < num_events; ++i) {
+        info.event_name = names[(i * 7) % CCL_BENCH_PROF_NAMES];
+        info.queue_name = queues[i % CCL_BENCH_PROF_QUEUES];
+        info.command_type = CL_COMMAND_NDRANGE_KERNEL;
+        info.t_queued = 1000 * (cl_ulong) (i / CCL_BENCH_PROF_QUEUES);
+        info.t_submit = info.t_queued + 10;
+        info.t_start = info.t_queued + 50;
+        info.t_end = info.t_start + 200 + (i * 2654435761u) % 1500;
+        ccl_prof_add_info(prof, &info);
+    }
+
+    g_timer_start(timer);
+    ccl_prof_calc(prof, &err);
+    t = g_timer_elapsed(timer, NULL);
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+        t = -1;
+    }
+
+    ccl_prof_destroy(prof);
+    for (guint i = 0; i < CCL_BENCH_PROF_NAMES; ++i) g_free(names[i]);
+    for (guint i = 0; i < CCL_BENCH_PROF_QUEUES; ++i) g_free(queues[i]);
+
+    return t;
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return `EXIT_SUCCESS` if benchmark runs, `EXIT_FAILURE` otherwise.
+ * */
+int main(int argc, char ** argv) {
+
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * buf = NULL;
+    CCLBuffer * tmp_buf;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    GTimer * timer = g_timer_new();
+    cl_context context;
+    cl_device_id device;
+    cl_kernel kernel;
+    cl_command_queue queue;
+    cl_event event;
+    cl_mem mem, tmp_mem;
+    cl_uint d = 1, cu;
+    size_t gws = 1;
+    double raw, ccl;
+    gboolean ok = FALSE;
+    gulong iters = (argc > 1) ? strtoul(argv[1], NULL, 10) : CCL_BENCH_ITERS;
+    const guint prof_sizes[] = { 1000, 10000, 100000 };
+
+    if (iters == 0) iters = CCL_BENCH_ITERS;
+
+    /* Setup context, queue, kernel with its arguments, and one event. */
+    ctx = ccl_test_context_new(0, &err);
+    if (err != NULL) goto error_handler;
+    dev = ccl_context_get_device(ctx, 0, &err);
+    if (err != NULL) goto error_handler;
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    if (err != NULL) goto error_handler;
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    if (err != NULL) goto error_handler;
+    ccl_program_build(prg, NULL, &err);
+    if (err != NULL) goto error_handler;
+    krnl = ccl_program_get_kernel(prg, "test_sum_full", &err);
+    if (err != NULL) goto error_handler;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, &err);
+    if (err != NULL) goto error_handler;
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+        NULL, NULL, &err, buf, buf, buf, ccl_arg_priv(d, cl_uint), NULL);
+    if (err != NULL) goto error_handler;
+    ccl_queue_finish(cq, &err);
+    if (err != NULL) goto error_handler;
+
+    context = ccl_context_unwrap(ctx);
+    device = ccl_device_unwrap(dev);
+    kernel = ccl_kernel_unwrap(krnl);
+    queue = ccl_queue_unwrap(cq);
+    event = ccl_event_unwrap(evt);
+    mem = ccl_buffer_unwrap(buf);
+
+    g_print("{\n  \"benchmark\": \"overhead\",\n");
+    g_print("  \"version\": \"%s\",\n", CCL_VERSION_STRING_FINAL);
+    g_print("  \"iterations\": %lu,\n  \"results\": [\n", iters);
+
+    /* Buffer creation and destruction. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        tmp_mem = clCreateBuffer(
+            context, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, NULL);
+        clReleaseMemObject(tmp_mem);
+    }
+    raw = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        tmp_buf = ccl_buffer_new(
+            ctx, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, NULL);
+        ccl_buffer_destroy(tmp_buf);
+    }
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("buffer_new_destroy", iters,
+        1e9 * raw / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* Wrapping and destruction of an existing OpenCL object. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        clRetainMemObject(mem);
+        clReleaseMemObject(mem);
+    }
+    raw = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        tmp_buf = ccl_buffer_new_wrap(mem);
+        ccl_buffer_destroy(tmp_buf);
+    }
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("buffer_wrap_destroy", iters,
+        1e9 * raw / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* Setting all kernel arguments and launching the kernel, finishing
+     * the queue periodically. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        d = (cl_uint) i;
+        clSetKernelArg(kernel, 0, sizeof(cl_mem), &mem);
+        clSetKernelArg(kernel, 1, sizeof(cl_mem), &mem);
+        clSetKernelArg(kernel, 2, sizeof(cl_mem), &mem);
+        clSetKernelArg(kernel, 3, sizeof(cl_uint), &d);
+        clEnqueueNDRangeKernel(
+            queue, kernel, 1, NULL, &gws, NULL, 0, NULL, NULL);
+        if (i % CCL_BENCH_FINISH_EVERY == 0) clFinish(queue);
+    }
+    clFinish(queue);
+    raw = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i) {
+        d = (cl_uint) i;
+        ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+            NULL, NULL, NULL, buf, buf, buf, ccl_arg_priv(d, cl_uint), NULL);
+        if (i % CCL_BENCH_FINISH_EVERY == 0) ccl_queue_finish(cq, NULL);
+    }
+    ccl_queue_finish(cq, NULL);
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("kernel_set_args_and_enqueue_ndrange", iters,
+        1e9 * raw / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* Waiting on a completed event, building the wait list each time. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        clWaitForEvents(1, &event);
+    raw = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), NULL);
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("event_wait_list", iters,
+        1e9 * raw / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* Scalar device info query, cached by cf4ocl after the first query. */
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS,
+            sizeof(cl_uint), &cu, NULL);
+    raw = g_timer_elapsed(timer, NULL);
+    g_timer_start(timer);
+    for (gulong i = 0; i < iters; ++i)
+        cu = ccl_device_get_info_scalar(
+            dev, CL_DEVICE_MAX_COMPUTE_UNITS, cl_uint, NULL);
+    ccl = g_timer_elapsed(timer, NULL);
+    bench_print("device_info_scalar", iters,
+        1e9 * raw / iters, 1e9 * ccl / iters, CL_FALSE);
+
+    /* Profile calculations on synthetic event sets, reported per event. */
+    for (guint i = 0; i < G_N_ELEMENTS(prof_sizes); ++i) {
+        gchar * name = g_strdup_printf("prof_calc_%u", prof_sizes[i]);
+        ccl = bench_prof_calc(prof_sizes[i], timer);
+        if (ccl < 0) { g_free(name); goto error_handler; }
+        bench_print(name, prof_sizes[i], -1, 1e9 * ccl / prof_sizes[i],
+            i == G_N_ELEMENTS(prof_sizes) - 1);
+        g_free(name);
+    }
+
+    g_print("  ]\n}\n");
+    ok = TRUE;
+
+error_handler:
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    /* Destroy stuff. */
+    if (buf != NULL) ccl_buffer_destroy(buf);
+    if (prg != NULL) ccl_program_destroy(prg);
+    if (cq != NULL) ccl_queue_destroy(cq);
+    if (ctx != NULL) ccl_context_destroy(ctx);
+    g_timer_destroy(timer);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
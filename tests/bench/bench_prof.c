@@ -0,0 +1,247 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Profiler stress benchmark with synthetic events.
+ *
+ * Synthetic events are generated and added to a profile object with
+ * ::ccl_prof_add_info(), so no OpenCL device is required. The number of
+ * events, the number of distinct event names and the overlap density,
+ * i.e. the number of queues with events executing concurrently, are
+ * configurable. The time and peak memory of adding the events, of
+ * ::ccl_prof_calc(), of the iterators and of the exports are reported in
+ * JSON format. Peak memory is only available on Linux, where the peak
+ * resident set size is reset before each phase.
+ *
+ * Usage: `bench_prof [events] [names] [overlap]`
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include "test.h"
+#include <glib/gstdio.h>
+
+/* Default number of events, event names and concurrent queues. */
+#define CCL_BENCH_EVENTS 1000000
+#define CCL_BENCH_NAMES 64
+#define CCL_BENCH_OVERLAP 4
+
+/* Reset the peak resident set size of the process, if possible. */
+static void bench_mem_reset(void) {
+#ifdef __linux__
+    FILE * fp = fopen("/proc/self/clear_refs", "w");
+    if (fp != NULL) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+/* Get the peak resident set size of the process in kilobytes, or a
+ * negative value if not available. */
+static glong bench_mem_peak(void) {
+
+    glong peak = -1;
+#ifdef __linux__
+    char line[256];
+    FILE * fp = fopen("/proc/self/status", "r");
+    if (fp != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (g_str_has_prefix(line, "VmHWM:")) {
+                peak = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(fp);
+    }
+#endif
+    return peak;
+}
+
+/* Print the results of one phase in JSON format. */
+static void bench_print(const char * phase, double seconds, glong peak_kb,
+    cl_bool last) {
+
+    g_print("    {\"phase\": \"%s\", \"seconds\": %.4f, ", phase, seconds);
+    if (peak_kb < 0)
+        g_print("\"peak_rss_kb\": null}%s\n", last ? "" : ",");
+    else
+        g_print("\"peak_rss_kb\": %ld}%s\n", peak_kb, last ? "" : ",");
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return `EXIT_SUCCESS` if benchmark runs, `EXIT_FAILURE` otherwise.
+ * */
+int main(int argc, char ** argv) {
+
+    CCLProf * prof = ccl_prof_new();
+    CCLProfInfo info;
+    CCLErr * err = NULL;
+    GTimer * timer = g_timer_new();
+    gchar ** names = NULL;
+    gchar ** queues = NULL;
+    gchar * tmp_dir = NULL;
+    gchar * fname = NULL;
+    gboolean ok = FALSE;
+    gulong n, count;
+    cl_ulong * t_next;
+    cl_ulong dur;
+    guint32 rnd = 12345;
+    double t;
+
+    /* Parse command line arguments. */
+    gulong num_events =
+        (argc > 1) ? strtoul(argv[1], NULL, 10) : CCL_BENCH_EVENTS;
+    guint num_names =
+        (argc > 2) ? (guint) strtoul(argv[2], NULL, 10) : CCL_BENCH_NAMES;
+    guint overlap =
+        (argc > 3) ? (guint) strtoul(argv[3], NULL, 10) : CCL_BENCH_OVERLAP;
+    if (num_events == 0) num_events = CCL_BENCH_EVENTS;
+    if (num_names == 0) num_names = CCL_BENCH_NAMES;
+    if (overlap == 0) overlap = CCL_BENCH_OVERLAP;
+
+    names = g_new0(gchar *, num_names + 1);
+    for (guint i = 0; i < num_names; ++i)
+        names[i] = g_strdup_printf("EVENT_%u", i);
+    queues = g_new0(gchar *, overlap + 1);
+    for (guint i = 0; i < overlap; ++i)
+        queues[i] = g_strdup_printf("queue_%u", i);
+    t_next = g_new0(cl_ulong, overlap);
+
+    g_print("{\n  \"benchmark\": \"profiler\",\n");
+    g_print("  \"version\": \"%s\",\n", CCL_VERSION_STRING_FINAL);
+    g_print("  \"events\": %lu,\n  \"names\": %u,\n  \"overlap\": %u,\n",
+        num_events, num_names, overlap);
+    g_print("  \"results\": [\n");
+
+    /* Add events. Events of each queue follow each other with small
+     * random gaps, so that each instant has about as many events in
+     * execution as there are queues. */
+    bench_mem_reset();
+    g_timer_start(timer);
+    for (n = 0; n < num_events; ++n) {
+        guint q = (guint) (n % overlap);
+        rnd = rnd * 1664525u + 1013904223u;
+        dur = 100 + (rnd >> 8) % 10000;
+        info.event_name = names[(rnd >> 4) % num_names];
+        info.queue_name = queues[q];
+        info.command_type = CL_COMMAND_NDRANGE_KERNEL;
+        info.t_queued = t_next[q];
+        info.t_submit = info.t_queued + 5;
+        info.t_start = info.t_queued + 10 + (rnd & 0xf);
+        info.t_end = info.t_start + dur;
+        t_next[q] = info.t_end + (rnd & 0x3f);
+        ccl_prof_add_info(prof, &info);
+    }
+    bench_print("add", g_timer_elapsed(timer, NULL), bench_mem_peak(),
+        CL_FALSE);
+
+    /* Perform calculations. */
+    bench_mem_reset();
+    g_timer_start(timer);
+    ccl_prof_calc(prof, &err);
+    t = g_timer_elapsed(timer, NULL);
+    if (err != NULL) goto error_handler;
+    bench_print("calc", t, bench_mem_peak(), CL_FALSE);
+
+    /* Iterate over the results. The count is only kept so that the
+     * iterations are not optimized away. */
+    count = 0;
+    bench_mem_reset();
+    g_timer_start(timer);
+    ccl_prof_iter_agg_init(prof, CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC);
+    while (ccl_prof_iter_agg_next(prof) != NULL) count++;
+    ccl_prof_iter_overlap_init(
+        prof, CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC);
+    while (ccl_prof_iter_overlap_next(prof) != NULL) count++;
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    while (ccl_prof_iter_info_next(prof) != NULL) count++;
+    ccl_prof_iter_inst_init(
+        prof, CCL_PROF_INST_SORT_INSTANT | CCL_PROF_SORT_ASC);
+    while (ccl_prof_iter_inst_next(prof) != NULL) count++;
+    t = g_timer_elapsed(timer, NULL);
+    g_assert_cmpuint(count, >=, 3 * num_events);
+    bench_print("iterate", t, bench_mem_peak(), CL_FALSE);
+
+    /* Export in each format to temporary files. */
+    tmp_dir = g_dir_make_tmp("bench_prof_XXXXXX", &err);
+    if (err != NULL) goto error_handler;
+
+    fname = g_build_filename(tmp_dir, "prof.tsv", NULL);
+    bench_mem_reset();
+    g_timer_start(timer);
+    ccl_prof_export_info_file(prof, fname, &err);
+    t = g_timer_elapsed(timer, NULL);
+    g_unlink(fname);
+    g_free(fname);
+    if (err != NULL) goto error_handler;
+    bench_print("export_info", t, bench_mem_peak(), CL_FALSE);
+
+    fname = g_build_filename(tmp_dir, "prof.json", NULL);
+    bench_mem_reset();
+    g_timer_start(timer);
+    ccl_prof_export_trace_file(prof, fname, &err);
+    t = g_timer_elapsed(timer, NULL);
+    g_unlink(fname);
+    g_free(fname);
+    if (err != NULL) goto error_handler;
+    bench_print("export_trace", t, bench_mem_peak(), CL_FALSE);
+
+    fname = g_build_filename(tmp_dir, "prof.bin", NULL);
+    bench_mem_reset();
+    g_timer_start(timer);
+    ccl_prof_export_binary_file(prof, fname, &err);
+    t = g_timer_elapsed(timer, NULL);
+    g_unlink(fname);
+    g_free(fname);
+    if (err != NULL) goto error_handler;
+    bench_print("export_binary", t, bench_mem_peak(), CL_TRUE);
+
+    g_print("  ]\n}\n");
+    ok = TRUE;
+
+error_handler:
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    /* Destroy stuff. */
+    if (tmp_dir != NULL) {
+        g_rmdir(tmp_dir);
+        g_free(tmp_dir);
+    }
+    ccl_prof_destroy(prof);
+    g_strfreev(names);
+    g_strfreev(queues);
+    g_free(t_next);
+    g_timer_destroy(timer);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,277 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Benchmark of the scaling of cf4ocl operations with the number of host
+ * threads.
+ *
+ * For 1 up to N threads, each thread performs a mix of wrapper creation
+ * and destruction, info queries, kernel launches and event queries on a
+ * shared context, device and program. Throughput is reported in JSON
+ * format for each thread count, together with a contention profile, i.e.
+ * the mean time per operation of each kind, which shows which operations
+ * slow down as threads are added.
+ *
+ * Usage: `bench_threads [max_threads] [ops_per_thread]`
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include "test.h"
+
+/* Default number of operations per thread. */
+#define CCL_BENCH_OPS 20000
+
+/* Number of kernel launches between queue finishes. */
+#define CCL_BENCH_FINISH_EVERY 64
+
+/* Kinds of operation performed by each thread, in turn. */
+typedef enum {
+    BENCH_OP_WRAP = 0,
+    BENCH_OP_DEV_INFO,
+    BENCH_OP_KRNL_INFO,
+    BENCH_OP_LAUNCH,
+    BENCH_OP_EVT_INFO,
+    BENCH_OP_NUM
+} BenchOp;
+
+/* Names of kinds of operation, for JSON output. */
+static const char * const bench_op_names[BENCH_OP_NUM] = {
+    "wrap_destroy", "device_info", "kernel_info", "kernel_launch",
+    "event_info"
+};
+
+/* Objects shared by all threads. */
+typedef struct {
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLProgram * prg;
+    CCLBuffer * buf;
+    gulong ops;
+} BenchShared;
+
+/* Per-thread state and results. */
+typedef struct {
+    BenchShared * shared;
+    GThread * thread;
+    gboolean ok;
+    gulong count[BENCH_OP_NUM];
+    gdouble time[BENCH_OP_NUM];
+} BenchThread;
+
+/* Thread function, performs the mix of operations. */
+static gpointer bench_thread_run(gpointer data) {
+
+    BenchThread * bt = (BenchThread *) data;
+    BenchShared * sh = bt->shared;
+    CCLQueue * cq = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * tmp_buf;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    GTimer * timer = g_timer_new();
+    cl_mem mem = ccl_buffer_unwrap(sh->buf);
+    cl_uint d = 1, val;
+    cl_int status;
+    size_t gws = 1;
+    BenchOp op;
+
+    /* Each thread uses its own queue and kernel, since setting kernel
+     * arguments is not thread-safe. */
+    cq = ccl_queue_new(sh->ctx, sh->dev, 0, &err);
+    if (err != NULL) goto finish;
+    krnl = ccl_kernel_new(sh->prg, "test_sum_full", &err);
+    if (err != NULL) goto finish;
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws,
+        NULL, NULL, &err, sh->buf, sh->buf, sh->buf,
+        ccl_arg_priv(d, cl_uint), NULL);
+    if (err != NULL) goto finish;
+
+    for (gulong i = 0; i < sh->ops; ++i) {
+
+        op = (BenchOp) (i % BENCH_OP_NUM);
+        g_timer_start(timer);
+
+        switch (op) {
+            case BENCH_OP_WRAP:
+                tmp_buf = ccl_buffer_new_wrap(mem);
+                ccl_buffer_destroy(tmp_buf);
+                break;
+            case BENCH_OP_DEV_INFO:
+                val = ccl_device_get_info_scalar(
+                    sh->dev, CL_DEVICE_MAX_COMPUTE_UNITS, cl_uint, NULL);
+                break;
+            case BENCH_OP_KRNL_INFO:
+                val = ccl_kernel_get_info_scalar(
+                    krnl, CL_KERNEL_NUM_ARGS, cl_uint, NULL);
+                break;
+            case BENCH_OP_LAUNCH:
+                d = (cl_uint) i;
+                ccl_kernel_set_arg(krnl, 3, ccl_arg_priv(d, cl_uint));
+                evt = ccl_kernel_enqueue_ndrange(
+                    krnl, cq, 1, NULL, &gws, NULL, NULL, NULL);
+                if ((i / BENCH_OP_NUM) % CCL_BENCH_FINISH_EVERY == 0)
+                    ccl_queue_finish(cq, NULL);
+                break;
+            case BENCH_OP_EVT_INFO:
+                if (evt != NULL)
+                    status = ccl_event_get_info_scalar(evt,
+                        CL_EVENT_COMMAND_EXECUTION_STATUS, cl_int, NULL);
+                break;
+            default:
+                g_assert_not_reached();
+        }
+
+        bt->time[op] += g_timer_elapsed(timer, NULL);
+        bt->count[op]++;
+    }
+    ccl_queue_finish(cq, &err);
+    if (err != NULL) goto finish;
+
+    CCL_UNUSED(val);
+    CCL_UNUSED(status);
+    bt->ok = TRUE;
+
+finish:
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+    }
+    if (krnl != NULL) ccl_kernel_destroy(krnl);
+    if (cq != NULL) ccl_queue_destroy(cq);
+    g_timer_destroy(timer);
+
+    return NULL;
+}
+
+/* Run the benchmark with the given number of threads and print results
+ * in JSON format. Returns FALSE if some thread fails. */
+static gboolean bench_run(BenchShared * sh, guint num_threads,
+    double * base_rate, cl_bool last) {
+
+    BenchThread * bts = g_new0(BenchThread, num_threads);
+    GTimer * timer = g_timer_new();
+    gulong count[BENCH_OP_NUM] = { 0 };
+    gdouble time[BENCH_OP_NUM] = { 0 };
+    gulong total = 0;
+    gboolean ok = TRUE;
+    double wall, rate;
+
+    g_timer_start(timer);
+    for (guint t = 0; t < num_threads; ++t) {
+        bts[t].shared = sh;
+        bts[t].thread = g_thread_new("bench", bench_thread_run, &bts[t]);
+    }
+    for (guint t = 0; t < num_threads; ++t)
+        g_thread_join(bts[t].thread);
+    wall = g_timer_elapsed(timer, NULL);
+
+    for (guint t = 0; t < num_threads; ++t) {
+        ok = ok && bts[t].ok;
+        for (guint o = 0; o < BENCH_OP_NUM; ++o) {
+            count[o] += bts[t].count[o];
+            time[o] += bts[t].time[o];
+            total += bts[t].count[o];
+        }
+    }
+
+    /* Efficiency is the throughput relative to perfect scaling of the
+     * single thread throughput. */
+    rate = total / wall;
+    if (num_threads == 1) *base_rate = rate;
+    g_print("    {\"threads\": %u, \"ops\": %lu, \"seconds\": %.4f, "
+        "\"ops_per_sec\": %.0f, \"ops_per_sec_per_thread\": %.0f, "
+        "\"efficiency\": %.3f,\n", num_threads, total, wall, rate,
+        rate / num_threads, rate / (num_threads * *base_rate));
+    g_print("     \"contention_ns\": {");
+    for (guint o = 0; o < BENCH_OP_NUM; ++o)
+        g_print("\"%s\": %.1f%s", bench_op_names[o],
+            count[o] > 0 ? 1e9 * time[o] / count[o] : 0.0,
+            o < BENCH_OP_NUM - 1 ? ", " : "");
+    g_print("}}%s\n", last ? "" : ",");
+
+    g_timer_destroy(timer);
+    g_free(bts);
+
+    return ok;
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return `EXIT_SUCCESS` if benchmark runs, `EXIT_FAILURE` otherwise.
+ * */
+int main(int argc, char ** argv) {
+
+    BenchShared sh = { NULL, NULL, NULL, NULL, 0 };
+    CCLErr * err = NULL;
+    gboolean ok = FALSE;
+    double base_rate = 0;
+    guint max_threads = (argc > 1)
+        ? (guint) strtoul(argv[1], NULL, 10) : g_get_num_processors();
+
+    sh.ops = (argc > 2) ? strtoul(argv[2], NULL, 10) : CCL_BENCH_OPS;
+    if (max_threads == 0) max_threads = g_get_num_processors();
+    if (sh.ops == 0) sh.ops = CCL_BENCH_OPS;
+
+    /* Setup shared context, program and buffer. */
+    sh.ctx = ccl_test_context_new(0, &err);
+    if (err != NULL) goto error_handler;
+    sh.dev = ccl_context_get_device(sh.ctx, 0, &err);
+    if (err != NULL) goto error_handler;
+    sh.prg = ccl_program_new_from_source(
+        sh.ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    if (err != NULL) goto error_handler;
+    ccl_program_build(sh.prg, NULL, &err);
+    if (err != NULL) goto error_handler;
+    sh.buf = ccl_buffer_new(
+        sh.ctx, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, &err);
+    if (err != NULL) goto error_handler;
+
+    g_print("{\n  \"benchmark\": \"threads\",\n");
+    g_print("  \"version\": \"%s\",\n", CCL_VERSION_STRING_FINAL);
+    g_print("  \"ops_per_thread\": %lu,\n  \"results\": [\n", sh.ops);
+
+    ok = TRUE;
+    for (guint n = 1; ok && n <= max_threads; ++n)
+        ok = bench_run(&sh, n, &base_rate, n == max_threads);
+
+    g_print("  ]\n}\n");
+
+error_handler:
+
+    if (err != NULL) {
+        g_printerr("Error: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    /* Destroy stuff. */
+    if (sh.buf != NULL) ccl_buffer_destroy(sh.buf);
+    if (sh.prg != NULL) ccl_program_destroy(sh.prg);
+    if (sh.ctx != NULL) ccl_context_destroy(sh.ctx);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
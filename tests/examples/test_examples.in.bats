@@ -134,3 +134,19 @@ setup() {
     rm -rf out.png
 
 }
+
+# Test image filter example in tiled mode
+@test "Image filter example with tiles" {
+
+    run ${CCL_EXBIN_PATH}/image_filter \
+        @CMAKE_SOURCE_DIR@/images/gantt_ca.png ${CCL_TEST_DEVICE_INDEX} 100
+
+    # There should be no problems
+    [ "$status" -eq 0 ]
+    [[ "$output" =~ "Tiles:" ]]
+
+    # Check that output image was created
+    [ -f out.png ]
+    rm -rf out.png
+
+}
@@ -145,6 +145,262 @@ static void info_zero_size_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/* Number of threads in the concurrent wrapping test. */
+#define CCL_TEST_ABSTRACT_NTHREADS 8
+
+/* Number of wrap/unwrap iterations per thread in the concurrent wrapping
+ * test. */
+#define CCL_TEST_ABSTRACT_NITER 10000
+
+/* Mock OpenCL objects shared by the threads in the concurrent wrapping
+ * test. */
+static int mock_cl_objects[4];
+
+/**
+ * @internal
+ *
+ * @brief Thread function which repeatedly wraps and releases a small set of
+ * mock OpenCL objects.
+ * */
+static gpointer concurrent_wrap_thread(gpointer data) {
+
+    CCL_UNUSED(data);
+
+    for (guint i = 0; i < CCL_TEST_ABSTRACT_NITER; ++i) {
+
+        /* Wrap one of the mock objects. */
+        void * cl_object = &mock_cl_objects[i % G_N_ELEMENTS(mock_cl_objects)];
+        CCLWrapper * w =
+            ccl_wrapper_new(CCL_NONE, cl_object, sizeof(CCLWrapper));
+
+        /* Check that the wrapper refers to the correct object and is
+         * alive. */
+        g_assert_true(ccl_wrapper_unwrap(w) == cl_object);
+        g_assert_cmpint(ccl_wrapper_ref_count(w), >, 0);
+
+        /* Release it, possibly destroying it. */
+        ccl_wrapper_unref(w, sizeof(CCLWrapper), NULL, NULL, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests concurrent wrapping and releasing of the same OpenCL objects
+ * from several threads, which exercises the race between dropping the last
+ * reference to a wrapper and obtaining the same wrapper again.
+ * */
+static void concurrent_wrap_test() {
+
+    /* Test threads. */
+    GThread * threads[CCL_TEST_ABSTRACT_NTHREADS];
+
+    /* Launch threads. */
+    for (guint i = 0; i < CCL_TEST_ABSTRACT_NTHREADS; ++i)
+        threads[i] = g_thread_new(NULL, concurrent_wrap_thread, NULL);
+
+    /* Wait for threads to finish. */
+    for (guint i = 0; i < CCL_TEST_ABSTRACT_NTHREADS; ++i)
+        g_thread_join(threads[i]);
+
+    /* Confirm that no memory was allocated for wrappers. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the wrapper runtime statistics.
+ * */
+static void stats_test() {
+
+    /* Mock OpenCL objects. */
+    int mock_objs[3];
+
+    /* Wrappers for the mock objects. */
+    CCLWrapper * ws[G_N_ELEMENTS(mock_objs)];
+
+    /* Statistics before, during and after wrapping the mock objects. */
+    CCLWrapperStats stats_before, stats_during, stats_after;
+
+    /* Get initial statistics. */
+    ccl_wrapper_get_stats(&stats_before);
+
+    /* Wrap the mock objects. */
+    for (guint i = 0; i < G_N_ELEMENTS(mock_objs); ++i)
+        ws[i] = ccl_wrapper_new(CCL_NONE, &mock_objs[i], sizeof(CCLWrapper));
+
+    /* Check that the new wrappers are accounted for. */
+    ccl_wrapper_get_stats(&stats_during);
+    g_assert_cmpuint(stats_during.classes[CCL_NONE].live, ==,
+        stats_before.classes[CCL_NONE].live + G_N_ELEMENTS(mock_objs));
+    g_assert_cmpuint(stats_during.classes[CCL_NONE].peak, >=,
+        stats_during.classes[CCL_NONE].live);
+    g_assert_cmpuint(stats_during.table_locks, >=,
+        stats_before.table_locks + G_N_ELEMENTS(mock_objs));
+    g_assert_cmpuint(stats_during.table_contentions, <=,
+        stats_during.table_locks);
+
+    /* Release the wrappers. */
+    for (guint i = 0; i < G_N_ELEMENTS(mock_objs); ++i)
+        ccl_wrapper_unref(ws[i], sizeof(CCLWrapper), NULL, NULL, NULL);
+
+    /* Check that the wrappers are no longer accounted for, but the peak is
+     * kept. */
+    ccl_wrapper_get_stats(&stats_after);
+    g_assert_cmpuint(stats_after.classes[CCL_NONE].live, ==,
+        stats_before.classes[CCL_NONE].live);
+    g_assert_cmpuint(stats_after.classes[CCL_NONE].peak, ==,
+        stats_during.classes[CCL_NONE].peak);
+    g_assert_cmpuint(stats_after.classes[CCL_NONE].info_bytes, ==, 0);
+
+    /* Confirm that no memory was allocated for wrappers. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* Number of queries in the information cache test. */
+#define CCL_TEST_ABSTRACT_NQUERIES 1000
+
+/**
+ * @internal
+ *
+ * @brief Tests the information cache of wrappers: immutable parameters are
+ * served from cache, mutable parameters are queried again, and polling
+ * mutable or failing parameters doesn't keep replaced values around.
+ * */
+static void info_cache_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLWrapperInfo * info1 = NULL;
+    CCLWrapperInfo * info2 = NULL;
+    CCLWrapperStats stats_before, stats_after;
+    CCLErr * err = NULL;
+    size_t max_wgs;
+    cl_uint ref_count;
+
+    /* Get the test context and its first device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Immutable parameters should be served from cache, even if the cache
+     * is not to be used. Check this by tampering with the cached value. */
+    info1 = ccl_wrapper_get_info((CCLWrapper *) dev, NULL,
+        CL_DEVICE_MAX_WORK_GROUP_SIZE, 0, CCL_INFO_DEVICE, CL_TRUE, &err);
+    g_assert_no_error(err);
+    max_wgs = *((size_t *) info1->value);
+    *((size_t *) info1->value) = max_wgs + 1;
+    info2 = ccl_wrapper_get_info((CCLWrapper *) dev, NULL,
+        CL_DEVICE_MAX_WORK_GROUP_SIZE, 0, CCL_INFO_DEVICE, CL_FALSE, &err);
+    g_assert_no_error(err);
+    g_assert_true(info1 == info2);
+    g_assert_cmpuint(*((size_t *) info2->value), ==, max_wgs + 1);
+    *((size_t *) info1->value) = max_wgs;
+
+    /* Mutable parameters should be queried again, with the new value
+     * refreshed in place. */
+    info1 = ccl_wrapper_get_info((CCLWrapper *) ctx, NULL,
+        CL_CONTEXT_REFERENCE_COUNT, 0, CCL_INFO_CONTEXT, CL_FALSE, &err);
+    g_assert_no_error(err);
+    ref_count = *((cl_uint *) info1->value);
+    *((cl_uint *) info1->value) = ref_count + 100;
+    info2 = ccl_wrapper_get_info((CCLWrapper *) ctx, NULL,
+        CL_CONTEXT_REFERENCE_COUNT, 0, CCL_INFO_CONTEXT, CL_FALSE, &err);
+    g_assert_no_error(err);
+    g_assert_true(info1 == info2);
+    g_assert_cmpuint(*((cl_uint *) info2->value), ==, ref_count);
+
+    /* Repeatedly polling a mutable parameter or a failing parameter should
+     * not grow the memory held by the information cache. */
+    ccl_wrapper_get_info((CCLWrapper *) ctx, NULL, 0xFFFF,
+        sizeof(cl_ulong), CCL_INFO_CONTEXT, CL_FALSE, NULL);
+    ccl_wrapper_get_stats(&stats_before);
+    for (guint i = 0; i < CCL_TEST_ABSTRACT_NQUERIES; ++i) {
+
+        info1 = ccl_wrapper_get_info((CCLWrapper *) ctx, NULL,
+            CL_CONTEXT_REFERENCE_COUNT, 0, CCL_INFO_CONTEXT, CL_FALSE, &err);
+        g_assert_no_error(err);
+        g_assert_true(info1 == info2);
+
+        info1 = ccl_wrapper_get_info((CCLWrapper *) ctx, NULL, 0xFFFF,
+            sizeof(cl_ulong), CCL_INFO_CONTEXT, CL_FALSE, &err);
+        g_assert_nonnull(err);
+        ccl_err_clear(&err);
+        g_assert_nonnull(info1);
+        g_assert_cmpuint(*((cl_ulong *) info1->value), ==, 0);
+    }
+    ccl_wrapper_get_stats(&stats_after);
+    g_assert_cmpuint(stats_after.classes[CCL_CONTEXT].info_bytes, ==,
+        stats_before.classes[CCL_CONTEXT].info_bytes);
+    g_assert_cmpuint(stats_after.classes[CCL_CONTEXT].old_info_bytes, ==,
+        stats_before.classes[CCL_CONTEXT].old_info_bytes);
+
+    /* Destroy context. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests status-only information queries, which report failures
+ * through a status code only.
+ * */
+static void info_status_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLWrapperStats stats_before, stats_after;
+    CCLErr * err = NULL;
+    cl_uint * ref_count;
+    cl_ulong * bogus;
+    cl_int status;
+
+    /* Get the test context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* A successful query should return the value with a success status. */
+    status = CL_INVALID_VALUE;
+    ref_count = ccl_wrapper_get_info_scalar_status((CCLWrapper *) ctx, NULL,
+        CL_CONTEXT_REFERENCE_COUNT, sizeof(cl_uint), CCL_INFO_CONTEXT,
+        CL_FALSE, &status);
+    g_assert_nonnull(ref_count);
+    g_assert_cmpint(status, ==, CL_SUCCESS);
+    g_assert_cmpuint(*ref_count, ==, ccl_context_get_info_scalar(
+        ctx, CL_CONTEXT_REFERENCE_COUNT, cl_uint, &err));
+    g_assert_no_error(err);
+
+    /* A failing query should return NULL with the OpenCL error as status,
+     * and neither keep an all-zeros value nor any other information. */
+    ccl_wrapper_get_stats(&stats_before);
+    for (guint i = 0; i < CCL_TEST_ABSTRACT_NQUERIES; ++i) {
+        status = CL_SUCCESS;
+        bogus = ccl_wrapper_get_info_scalar_status((CCLWrapper *) ctx, NULL,
+            0xFFFE, sizeof(cl_ulong), CCL_INFO_CONTEXT, CL_FALSE, &status);
+        g_assert_null(bogus);
+        g_assert_cmpint(status, <, CL_SUCCESS);
+    }
+    ccl_wrapper_get_stats(&stats_after);
+    g_assert_cmpuint(stats_after.classes[CCL_CONTEXT].info_bytes, ==,
+        stats_before.classes[CCL_CONTEXT].info_bytes);
+    g_assert_cmpuint(stats_after.classes[CCL_CONTEXT].old_info_bytes, ==,
+        stats_before.classes[CCL_CONTEXT].old_info_bytes);
+
+    /* Destroy context. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -169,5 +425,21 @@ int main(int argc, char ** argv) {
         "/wrappers/abstract/info_zero_size",
         info_zero_size_test);
 
+    g_test_add_func(
+        "/wrappers/abstract/concurrent-wrap",
+        concurrent_wrap_test);
+
+    g_test_add_func(
+        "/wrappers/abstract/stats",
+        stats_test);
+
+    g_test_add_func(
+        "/wrappers/abstract/info-cache",
+        info_cache_test);
+
+    g_test_add_func(
+        "/wrappers/abstract/info-status",
+        info_status_test);
+
     return g_test_run();
 }
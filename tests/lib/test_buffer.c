@@ -27,6 +27,7 @@
  * */
 
 #include <cf4ocl2.h>
+#include <glib/gstdio.h>
 #include "test.h"
 #include "_ccl_defs.h"
 
@@ -895,10 +896,23 @@ static void fill_test() {
         for (guint j = 0; j < 8; ++j)
             g_assert_cmpuint(h[i].s[j], ==, pattern.s[j]);
 
-    /* Test erroneous call to fill buffer (invalid pattern size). */
+    /* Fill buffer with a pattern whose size is not a power of two, which
+     * is performed by a kernel. */
     ccl_buffer_enqueue_fill(
-        b, q, &pattern, 3 /* Invalid */, 0, buf_size, NULL, &err);
-    g_assert_error(err, CCL_OCL_ERROR, CL_INVALID_VALUE);
+        b, q, &pattern, 3, 0, 3 * CCL_TEST_BUFFER_SIZE, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b, q, CL_TRUE, 0, buf_size, h, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < 3 * CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpint(((cl_char *) h)[i], ==, pattern.s[i % 3]);
+    for (guint i = 3 * CCL_TEST_BUFFER_SIZE; i < buf_size; ++i)
+        g_assert_cmpint(((cl_char *) h)[i], ==, pattern.s[i % 8]);
+
+    /* Test erroneous call to fill buffer (size not a multiple of pattern
+     * size). */
+    ccl_buffer_enqueue_fill(
+        b, q, &pattern, 3, 0, buf_size /* Invalid */, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
     ccl_err_clear(&err);
 
     /* Confirm that memory allocated by wrappers has not yet been freed. */
@@ -1000,58 +1014,1600 @@ static void migrate_test() {
 /**
  * @internal
  *
- * @brief Main function.
- * @param[in] argc Number of command line arguments.
- * @param[in] argv Command line arguments.
- * @return Result of test run.
+ * @brief Tests reuse of buffers with a context buffer pool.
  * */
-int main(int argc, char ** argv) {
+static void pool_test() {
 
-    g_test_init(&argc, &argv, NULL);
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLBuffer * b1 = NULL;
+    CCLBuffer * b2 = NULL;
+    CCLBuffer * b3 = NULL;
+    cl_mem mem1;
+    size_t size;
+    CCLErr * err = NULL;
 
-    g_test_add_func(
-        "/wrappers/buffer/create-info-destroy",
-        create_info_destroy_test);
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
 
-    g_test_add_func(
-        "/wrappers/buffer/ref-unref",
-        ref_unref_test);
+    /* Without a pool, buffers have the requested size and are not
+     * pooled. */
+    b1 = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, 1000, &err);
+    g_assert_no_error(err);
+    size = ccl_memobj_get_info_scalar(b1, CL_MEM_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(size, ==, 1000);
+    ccl_buffer_pool_put(ctx, b1);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 0);
 
-    g_test_add_func(
-        "/wrappers/buffer/wrap-unwrap",
-        wrap_unwrap_test);
+    /* Enable pool with a high-water mark of 2048 bytes. */
+    ccl_buffer_pool_enable(ctx, 2048);
 
-    g_test_add_func(
-        "/wrappers/buffer/read-write",
-        read_write_test);
+    /* Buffers are created with the size class of the requested size. */
+    b1 = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, 1000, &err);
+    g_assert_no_error(err);
+    size = ccl_memobj_get_info_scalar(b1, CL_MEM_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(size, ==, 1024);
+    mem1 = ccl_memobj_unwrap(b1);
 
-    g_test_add_func(
-        "/wrappers/buffer/copy",
-        copy_test);
+    /* Returned buffers are pooled... */
+    ccl_buffer_pool_put(ctx, b1);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 1024);
 
-    g_test_add_func(
-        "/wrappers/buffer/map-unmap",
-        map_unmap_test);
+    /* ...and reused for requests in the same size class and flags. */
+    b1 = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, 900, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(b1) == mem1);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 0);
 
-    g_test_add_func(
-        "/wrappers/buffer/destruct_callback",
-        destructor_callback_test);
+    /* Other flags get different buffers. */
+    b2 = ccl_buffer_pool_get(ctx, CL_MEM_READ_ONLY, 1000, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(b2) != mem1);
 
-    g_test_add_func(
-        "/wrappers/buffer/rect-read-write-copy",
-        rect_read_write_copy_test);
+    /* Buffers beyond the high-water mark are released. */
+    b3 = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, 1024, &err);
+    g_assert_no_error(err);
+    ccl_buffer_pool_put(ctx, b1);
+    ccl_buffer_pool_put(ctx, b2);
+    ccl_buffer_pool_put(ctx, b3);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 2048);
 
-    g_test_add_func(
-        "/wrappers/buffer/create-from-region",
-        create_from_region_test);
+    /* Trim pool. */
+    g_assert_cmpuint(ccl_buffer_pool_trim(ctx, 1024), ==, 1024);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 1024);
 
-    g_test_add_func(
-        "/wrappers/buffer/fill",
-        fill_test);
+    /* Pooled buffers are still alive. */
+    g_assert_false(ccl_wrapper_memcheck());
 
-    g_test_add_func(
-        "/wrappers/buffer/migrate",
-        migrate_test);
+    /* Destroying the context releases pooled buffers. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests asynchronous transfers through a pinned host staging ring.
+ * */
+static void staging_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLBuffer * b = NULL;
+    CCLQueue * q = NULL;
+    CCLStaging * stg = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint * h_out;
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+    size_t slot_size = buf_size / 8;
+    size_t slot_len = CCL_TEST_BUFFER_SIZE / 8;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create regular buffer. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create staging ring with two slots, smaller than the buffer. */
+    stg = ccl_staging_new(q, slot_size, 2, &err);
+    g_assert_no_error(err);
+
+    /* Write host data through the staging ring, which splits it across
+     * slots. */
+    evt = ccl_staging_enqueue_write(
+        stg, b, 0, buf_size, h_in, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+
+    /* Host data can be changed right away. */
+    h_in[0] = ~h_in[0];
+
+    /* Read data back, one slot at a time, and check it is OK. */
+    for (guint j = 0; j < 8; ++j) {
+        h_out = ccl_staging_enqueue_read(
+            stg, b, j * slot_size, slot_size, NULL, &evt, &err);
+        g_assert_no_error(err);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+        g_assert_no_error(err);
+        for (guint i = 0; i < slot_len; ++i) {
+            if (i + j == 0)
+                g_assert_cmpuint(~h_in[0], ==, h_out[0]);
+            else
+                g_assert_cmpuint(h_in[j * slot_len + i], ==, h_out[i]);
+        }
+    }
+
+    /* Reads larger than a slot are not allowed. */
+    h_out = ccl_staging_enqueue_read(
+        stg, b, 0, buf_size, NULL, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(h_out);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_staging_destroy(stg);
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests streaming records through a persistently mapped upload
+ * ring.
+ * */
+static void upload_ring_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLUploadRing * ring = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint * rec;
+    cl_uint h_out[3];
+    size_t offs[4];
+    cl_uint n = 0;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create upload ring whose size is not a multiple of the record
+     * size, so that records wrap around its end. */
+    ring = ccl_upload_ring_new(q, 100, &err);
+    g_assert_no_error(err);
+
+    /* Stream records in batches of four, each record reserving more than
+     * it commits. */
+    for (guint b = 0; b < 16; ++b) {
+
+        for (guint r = 0; r < 4; ++r) {
+            rec = ccl_upload_ring_reserve(
+                ring, 4 * sizeof(cl_uint), &offs[r], &err);
+            g_assert_no_error(err);
+            g_assert_nonnull(rec);
+            g_assert_cmpuint(offs[r] + 4 * sizeof(cl_uint), <=, 100);
+            for (guint i = 0; i < 3; ++i) rec[i] = n * 3 + i;
+            ccl_upload_ring_commit(ring, 3 * sizeof(cl_uint));
+            n++;
+        }
+
+        evt = ccl_upload_ring_flush(ring, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_nonnull(evt);
+
+        /* Check records in the device buffer. */
+        for (guint r = 0; r < 4; ++r) {
+            ccl_buffer_enqueue_read(ccl_upload_ring_get_buffer(ring), q,
+                CL_TRUE, offs[r], sizeof(h_out), h_out,
+                ccl_ewl(&ewl, evt, NULL), &err);
+            g_assert_no_error(err);
+            for (guint i = 0; i < 3; ++i)
+                g_assert_cmpuint(h_out[i], ==, (n - 4 + r) * 3 + i);
+        }
+    }
+
+    /* Flushing without committed data enqueues a marker. */
+    evt = ccl_upload_ring_flush(ring, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+
+    /* Regions larger than the ring are not allowed. */
+    rec = ccl_upload_ring_reserve(ring, 101, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(rec);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_upload_ring_destroy(ring);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests bulk conversion between single and half precision, and
+ * half precision writes through staging rings.
+ * */
+static void half_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLBuffer * b = NULL;
+    CCLQueue * q = NULL;
+    CCLStaging * stg = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_float f_in[CCL_TEST_BUFFER_SIZE];
+    cl_float f_out[CCL_TEST_BUFFER_SIZE];
+    cl_half h[CCL_TEST_BUFFER_SIZE];
+    cl_half h_dev[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_half) * CCL_TEST_BUFFER_SIZE;
+    cl_float special[] = { 0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65520.0f,
+        1.0f / 16777216.0f, 1.0f / 33554432.0f, 1.0f + 1.0f / 2048.0f };
+    cl_half special_h[] = { 0x0000, 0x8000, 0x3C00, 0xC100, 0x7BFF, 0x7C00,
+        0x0001, 0x0000, 0x3C00 };
+
+    /* Values with an exact half representation, including rounding ties
+     * and out of range values, are converted as expected. */
+    ccl_half_from_float_array(h, special, G_N_ELEMENTS(special));
+    for (guint i = 0; i < G_N_ELEMENTS(special); ++i)
+        g_assert_cmphex(h[i], ==, special_h[i]);
+
+    /* All half values survive a round trip through single precision,
+     * using arrays long enough to be vectorized, with an odd tail. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h[i] = (cl_half) ((i * 7919) & 0x7BFF);
+    ccl_half_to_float_array(f_out, h, CCL_TEST_BUFFER_SIZE - 3);
+    ccl_half_from_float_array(h_dev, f_out, CCL_TEST_BUFFER_SIZE - 3);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE - 3; ++i)
+        g_assert_cmphex(h_dev[i], ==, h[i]);
+
+    /* Create a host array of random single precision values. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        f_in[i] = (cl_float) g_test_rand_double_range(-1000.0, 1000.0);
+    ccl_half_from_float_array(h, f_in, CCL_TEST_BUFFER_SIZE);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create regular buffer. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create staging ring with slots smaller than the buffer. */
+    stg = ccl_staging_new(q, buf_size / 4, 2, &err);
+    g_assert_no_error(err);
+
+    /* Convert and write host data through the staging ring. */
+    evt = ccl_staging_enqueue_write_half(
+        stg, b, 0, f_in, CCL_TEST_BUFFER_SIZE, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+
+    /* Read data back and check it was converted as on the host. */
+    evt = ccl_buffer_enqueue_read(
+        b, q, CL_FALSE, 0, buf_size, h_dev, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmphex(h_dev[i], ==, h[i]);
+
+    /* Destroy stuff. */
+    ccl_staging_destroy(stg);
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests reads and writes of buffers created in zero-copy mode.
+ * */
+static void zero_copy_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLBuffer * b = NULL;
+    CCLQueue * q = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_out[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+    cl_mem_flags flags;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Host pointer flags are not accepted. */
+    b = ccl_buffer_new_zero_copy(
+        ctx, CL_MEM_USE_HOST_PTR, buf_size, h_in, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(b);
+    g_clear_error(&err);
+
+    /* Create zero-copy buffer initialized with the host data. */
+    b = ccl_buffer_new_zero_copy(
+        ctx, CL_MEM_READ_WRITE, buf_size, h_in, &err);
+    g_assert_no_error(err);
+
+    /* Zero-copy buffers are allocated by the OpenCL implementation. */
+    flags = ccl_memobj_get_info_scalar(b, CL_MEM_FLAGS, cl_mem_flags, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_buffer_is_zero_copy(b), ==,
+        (flags & CL_MEM_ALLOC_HOST_PTR) ? CL_TRUE : CL_FALSE);
+
+    /* Read data back to host. */
+    ccl_buffer_enqueue_read(b, q, CL_TRUE, 0, buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Check data is OK. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_in[i], ==, h_out[i]);
+
+    /* Set some other data in host array and write part of it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+    evt = ccl_buffer_enqueue_write(b, q, CL_FALSE, buf_size / 2,
+        buf_size / 2, h_in + CCL_TEST_BUFFER_SIZE / 2, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Read it back, waiting on the write. */
+    ccl_buffer_enqueue_read(b, q, CL_TRUE, buf_size / 2, buf_size / 2,
+        h_out + CCL_TEST_BUFFER_SIZE / 2, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    /* Check data is OK. */
+    for (guint i = CCL_TEST_BUFFER_SIZE / 2; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_in[i], ==, h_out[i]);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests allocation, reset and reuse of sub-buffers from arenas.
+ * */
+static void arena_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBufferArena * arena = NULL;
+    CCLBuffer * b1 = NULL;
+    CCLBuffer * b2 = NULL;
+    CCLBuffer * b3 = NULL;
+    CCLErr * err = NULL;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_out[CCL_TEST_BUFFER_SIZE];
+    size_t chunk = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+    size_t align, size, origin;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create arena with room for three aligned chunks. */
+    align = ccl_device_get_info_scalar(
+        d, CL_DEVICE_MEM_BASE_ADDR_ALIGN, cl_uint, &err) / 8;
+    g_assert_no_error(err);
+    size = 3 * ((chunk + align - 1) / align) * align;
+    arena = ccl_buffer_arena_new(ctx, CL_MEM_READ_WRITE, size, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_buffer_arena_get_alignment(arena), ==, align);
+
+    /* Allocate sub-buffers, which must be aligned. */
+    b1 = ccl_buffer_arena_alloc(arena, chunk, &err);
+    g_assert_no_error(err);
+    b2 = ccl_buffer_arena_alloc(arena, chunk, &err);
+    g_assert_no_error(err);
+    origin = ccl_memobj_get_info_scalar(
+        b2, CL_MEM_OFFSET, size_t, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(origin % align, ==, 0);
+    g_assert_cmpuint(origin, >=, chunk);
+
+    /* Sub-buffers can be used as regular buffers. */
+    ccl_buffer_enqueue_write(b2, q, CL_TRUE, 0, chunk, h_in, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(ccl_buffer_arena_get_parent(arena), q, CL_TRUE,
+        origin, chunk, h_out, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_in[i], ==, h_out[i]);
+
+    /* Arena memory is limited. */
+    b3 = ccl_buffer_arena_alloc(arena, size, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_OTHER);
+    g_assert_null(b3);
+    g_clear_error(&err);
+
+    /* After a reset, the same allocation sequence reuses sub-buffers... */
+    ccl_buffer_arena_reset(arena);
+    g_assert_cmpuint(ccl_buffer_arena_get_used(arena), ==, 0);
+    b3 = ccl_buffer_arena_alloc(arena, chunk, &err);
+    g_assert_no_error(err);
+    g_assert_true(b3 == b1);
+
+    /* ...while a different one creates new sub-buffers. */
+    b3 = ccl_buffer_arena_alloc(arena, chunk / 2, &err);
+    g_assert_no_error(err);
+    size = ccl_memobj_get_info_scalar(b3, CL_MEM_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(size, ==, chunk / 2);
+
+    /* Destroy stuff. */
+    ccl_buffer_arena_destroy(arena);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests batched writes and reads of buffer ranges.
+ * */
+static void ranges_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_out[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_dev[CCL_TEST_BUFFER_SIZE];
+    cl_bool in_range[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+    /* Offsets and sizes of ranges, in elements: one single range, two
+     * contiguous ranges and four strided ranges, deliberately unsorted. */
+    guint offs[] = { 104, 200, 10, 248, 216, 100, 232 };
+    guint sizes[] = { 8, 2, 3, 2, 2, 4, 2 };
+    CCLBufferRange ranges[G_N_ELEMENTS(offs)];
+    CCLBufferRange overlap[2];
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i) {
+        h_in[i] = g_test_rand_int();
+        h_out[i] = 0;
+        in_range[i] = FALSE;
+    }
+
+    /* Ranges point to the same position in host arrays. */
+    for (guint i = 0; i < G_N_ELEMENTS(offs); ++i) {
+        ranges[i].offset = offs[i] * sizeof(cl_uint);
+        ranges[i].size = sizes[i] * sizeof(cl_uint);
+        ranges[i].ptr = h_in + offs[i];
+        for (guint j = offs[i]; j < offs[i] + sizes[i]; ++j)
+            in_range[j] = TRUE;
+    }
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a buffer initialized with zeros. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        buf_size, h_out, &err);
+    g_assert_no_error(err);
+
+    /* Write ranges and check that only they changed in the buffer. */
+    evt = ccl_buffer_enqueue_write_ranges(b, q, CL_FALSE, ranges,
+        G_N_ELEMENTS(ranges), NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+    ccl_buffer_enqueue_read(b, q, CL_TRUE, 0, buf_size, h_dev, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_dev[i], ==, in_range[i] ? h_in[i] : 0);
+
+    /* Read ranges back into another host array. */
+    for (guint i = 0; i < G_N_ELEMENTS(offs); ++i)
+        ranges[i].ptr = h_out + offs[i];
+    ccl_buffer_enqueue_read_ranges(b, q, ranges, G_N_ELEMENTS(ranges),
+        NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, in_range[i] ? h_in[i] : 0);
+
+    /* Overlapping ranges are not accepted. */
+    overlap[0] = ranges[0];
+    overlap[1] = ranges[0];
+    overlap[1].offset += sizeof(cl_uint);
+    evt = ccl_buffer_enqueue_write_ranges(b, q, CL_TRUE, overlap, 2,
+        NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests streaming files into buffers.
+ * */
+static void from_file_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b = NULL;
+    CCLBuffer * b2 = NULL;
+    CCLStaging * stg = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_out[2 * CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+    gchar * tmp_dir_name, * tmp_file_name;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Save it to a temporary file. */
+    tmp_dir_name = g_dir_make_tmp("test_buffer_XXXXXX", &err);
+    g_assert_no_error(err);
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "data.bin", NULL);
+    g_file_set_contents(
+        tmp_file_name, (const gchar *) h_in, buf_size, &err);
+    g_assert_no_error(err);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create buffer from file in chunks smaller than the file. */
+    b = ccl_buffer_new_from_file(
+        q, CL_MEM_READ_WRITE, tmp_file_name, buf_size / 5, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(
+        ccl_memobj_get_info_scalar(b, CL_MEM_SIZE, size_t, &err), ==,
+        buf_size);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b, q, CL_TRUE, 0, buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i]);
+    ccl_buffer_destroy(b);
+
+    /* Stream file twice into a larger buffer, through a staging ring. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 2 * buf_size, NULL, &err);
+    g_assert_no_error(err);
+    stg = ccl_staging_new(q, buf_size / 8, 2, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_write_from_file(
+        b, stg, 0, tmp_file_name, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_buffer_enqueue_write_from_file(
+        b, stg, buf_size, tmp_file_name, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+    ccl_buffer_enqueue_read(
+        b, q, CL_TRUE, 0, 2 * buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < 2 * CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i % CCL_TEST_BUFFER_SIZE]);
+
+    /* File must fit in buffer. */
+    evt = ccl_buffer_enqueue_write_from_file(
+        b, stg, buf_size + 4, tmp_file_name, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    g_clear_error(&err);
+
+    /* File must exist. */
+    g_unlink(tmp_file_name);
+    b2 = ccl_buffer_new_from_file(
+        q, CL_MEM_READ_WRITE, tmp_file_name, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_OPENFILE);
+    g_assert_null(b2);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_staging_destroy(stg);
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+    g_rmdir(tmp_dir_name);
+    g_free(tmp_file_name);
+    g_free(tmp_dir_name);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests hazard tracking of buffers used in two command queues,
+ * without explicit event dependencies.
+ * */
+static void hazards_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q1 = NULL;
+    CCLQueue * q2 = NULL;
+    CCLBuffer * b1 = NULL;
+    CCLBuffer * b2 = NULL;
+    CCLErr * err = NULL;
+    cl_bool status;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    cl_uint h_out[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create two command queues. */
+    q1 = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+    q2 = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create regular buffers and enable hazard tracking. */
+    b1 = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+    b2 = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+
+    status = ccl_memobj_set_hazard_tracking((CCLMemObj *) b1, CL_TRUE, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    status = ccl_memobj_set_hazard_tracking((CCLMemObj *) b2, CL_TRUE, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Write to first buffer in first queue, copy it to second buffer in
+     * second queue and read second buffer in first queue. The copy waits
+     * for the write and the read waits for the copy. */
+    ccl_buffer_enqueue_write(b1, q1, CL_FALSE, 0, buf_size, h_in, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_copy(b1, b2, q2, 0, 0, buf_size, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b2, q1, CL_TRUE, 0, buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i]);
+
+    /* Overwrite first buffer in first queue after the copy read it, and
+     * read it back in second queue. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = ~h_in[i];
+    ccl_buffer_enqueue_write(b1, q1, CL_FALSE, 0, buf_size, h_in, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b1, q2, CL_TRUE, 0, buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i]);
+
+    /* Writes on event-less queues produce no event, but must still be
+     * waited for by reads in other queues. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = i;
+    ccl_queue_set_eventless(q1, CL_TRUE);
+    g_assert_null(ccl_buffer_enqueue_write(
+        b1, q1, CL_FALSE, 0, buf_size, h_in, NULL, &err));
+    g_assert_no_error(err);
+    ccl_queue_set_eventless(q1, CL_FALSE);
+    ccl_buffer_enqueue_read(b1, q2, CL_TRUE, 0, buf_size, h_out, NULL, &err);
+    g_assert_no_error(err);
+
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i]);
+
+    /* Disable tracking in one of the buffers. */
+    status = ccl_memobj_set_hazard_tracking((CCLMemObj *) b1, CL_FALSE, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b1);
+    ccl_buffer_destroy(b2);
+    ccl_queue_destroy(q2);
+    ccl_queue_destroy(q1);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests deferred destruction of buffers still in use by commands.
+ * */
+static void destroy_deferred_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_bool status;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create buffer and write to it without waiting. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_buffer_enqueue_write(b, q, CL_FALSE, 0, buf_size, h_in,
+        NULL, &err);
+    g_assert_no_error(err);
+
+    /* Release buffer once the write completes. */
+    status = ccl_memobj_destroy_deferred(
+        (CCLMemObj *) b, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Wait for the write and destroy remaining stuff. */
+    ccl_queue_finish(q, &err);
+    g_assert_no_error(err);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Event callbacks run asynchronously, so wait a bit for the buffer to
+     * be released. */
+    for (guint i = 0; (i < 500) && !ccl_wrapper_memcheck(); ++i)
+        g_usleep(10000);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests parallel reduction, scan and compaction of buffers.
+ * */
+static void algo_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b_in = NULL, * b_out = NULL, * b_flags = NULL;
+    CCLBuffer * b_res = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    const size_t n = 100003;
+    cl_int * h_in = g_new(cl_int, n);
+    cl_int * h_out = g_new(cl_int, n);
+    cl_uint * h_flags = g_new(cl_uint, n);
+    cl_int res, sum = 0, max = CL_INT_MIN;
+    cl_uint count, selected = 0;
+
+    /* Create host data, with small values so that sums don't overflow,
+     * and the expected results. */
+    for (size_t i = 0; i < n; ++i) {
+        h_in[i] = g_test_rand_int_range(-1000, 1000);
+        h_flags[i] = (h_in[i] % 3 == 0) ? 1 : 0;
+        sum += h_in[i];
+        max = MAX(max, h_in[i]);
+        if (h_flags[i]) selected++;
+    }
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffers. */
+    b_in = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        n * sizeof(cl_int), h_in, &err);
+    g_assert_no_error(err);
+    b_flags = ccl_buffer_new(ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        n * sizeof(cl_uint), h_flags, &err);
+    g_assert_no_error(err);
+    b_out = ccl_buffer_new(
+        ctx, CL_MEM_READ_WRITE, n * sizeof(cl_int), NULL, &err);
+    g_assert_no_error(err);
+    b_res = ccl_buffer_new(
+        ctx, CL_MEM_READ_WRITE, sizeof(cl_int), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Sum reduction. */
+    evt = ccl_algo_reduce(q, b_in, b_res, CCL_ALGO_INT, CCL_ALGO_SUM, n,
+        NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_res, q, CL_TRUE, 0, sizeof(cl_int), &res,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(res, ==, sum);
+
+    /* Max reduction. */
+    evt = ccl_algo_reduce(q, b_in, b_res, CCL_ALGO_INT, CCL_ALGO_MAX, n,
+        NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_res, q, CL_TRUE, 0, sizeof(cl_int), &res,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(res, ==, max);
+
+    /* Inclusive sum scan. */
+    evt = ccl_algo_scan(q, b_in, b_out, CCL_ALGO_INT, CCL_ALGO_SUM,
+        CL_TRUE, n, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_out, q, CL_TRUE, 0, n * sizeof(cl_int),
+        h_out, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    res = 0;
+    for (size_t i = 0; i < n; ++i) {
+        res += h_in[i];
+        g_assert_cmpint(h_out[i], ==, res);
+    }
+
+    /* In-place exclusive max scan. */
+    evt = ccl_algo_scan(q, b_out, b_out, CCL_ALGO_INT, CCL_ALGO_MAX,
+        CL_FALSE, n, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_out, q, CL_TRUE, 0, n * sizeof(cl_int),
+        h_out, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(h_out[0], ==, CL_INT_MIN);
+    res = 0;
+    max = CL_INT_MIN;
+    for (size_t i = 1; i < n; ++i) {
+        res += h_in[i - 1];
+        max = MAX(max, res);
+        g_assert_cmpint(h_out[i], ==, max);
+    }
+
+    /* Compaction. */
+    evt = ccl_algo_compact(q, b_in, b_flags, b_out, b_res, CCL_ALGO_INT, n,
+        NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_res, q, CL_TRUE, 0, sizeof(cl_uint), &count,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(count, ==, selected);
+    ccl_buffer_enqueue_read(b_out, q, CL_TRUE, 0, count * sizeof(cl_int),
+        h_out, NULL, &err);
+    g_assert_no_error(err);
+    count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (h_flags[i]) {
+            g_assert_cmpint(h_out[count], ==, h_in[i]);
+            count++;
+        }
+    }
+
+    /* Invalid number of elements. */
+    evt = ccl_algo_reduce(q, b_in, b_res, CCL_ALGO_INT, CCL_ALGO_SUM, 0,
+        NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b_in);
+    ccl_buffer_destroy(b_out);
+    ccl_buffer_destroy(b_flags);
+    ccl_buffer_destroy(b_res);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+    g_free(h_in);
+    g_free(h_out);
+    g_free(h_flags);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Compare two cl_int values, for qsort().
+ * */
+static int algo_sort_cmp(const void * a, const void * b) {
+    cl_int x = *((const cl_int *) a), y = *((const cl_int *) b);
+    return (x > y) - (x < y);
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests radix sort of keys and of key-value pairs.
+ * */
+static void algo_sort_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b_keys = NULL, * b_fkeys = NULL, * b_vals = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    const size_t n = 70001;
+    cl_int * h_keys = g_new(cl_int, n);
+    cl_int * h_sorted = g_new(cl_int, n);
+    cl_float * h_fkeys = g_new(cl_float, n);
+    cl_float * h_fout = g_new(cl_float, n);
+    cl_uint * h_vals = g_new(cl_uint, n);
+
+    /* Create host data, with many repeated float keys, so that
+     * stability can be checked, and the expected sorted keys. */
+    for (size_t i = 0; i < n; ++i) {
+        h_keys[i] = (cl_int) g_test_rand_int();
+        h_fkeys[i] = (cl_float) g_test_rand_int_range(-100, 100) / 4.0f;
+        h_vals[i] = (cl_uint) i;
+    }
+    memcpy(h_sorted, h_keys, n * sizeof(cl_int));
+    qsort(h_sorted, n, sizeof(cl_int), algo_sort_cmp);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Temporary buffers are taken from the pool. */
+    ccl_buffer_pool_enable(ctx, 0);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffers. */
+    b_keys = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        n * sizeof(cl_int), h_keys, &err);
+    g_assert_no_error(err);
+    b_fkeys = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        n * sizeof(cl_float), h_fkeys, &err);
+    g_assert_no_error(err);
+    b_vals = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        n * sizeof(cl_uint), h_vals, &err);
+    g_assert_no_error(err);
+
+    /* Sort signed keys. */
+    evt = ccl_algo_sort(q, b_keys, CCL_ALGO_INT, n, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_keys, q, CL_TRUE, 0, n * sizeof(cl_int),
+        h_keys, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (size_t i = 0; i < n; ++i)
+        g_assert_cmpint(h_keys[i], ==, h_sorted[i]);
+
+    /* Sort float keys with their indexes as values. */
+    evt = ccl_algo_sort_by_key(q, b_fkeys, b_vals, CCL_ALGO_FLOAT,
+        sizeof(cl_uint), n, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_fkeys, q, CL_TRUE, 0, n * sizeof(cl_float),
+        h_fout, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(b_vals, q, CL_TRUE, 0, n * sizeof(cl_uint),
+        h_vals, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Keys must be sorted, values must point to their keys, and values
+     * of equal keys must keep their order. */
+    for (size_t i = 0; i < n; ++i) {
+        g_assert_cmpfloat(h_fout[i], ==, h_fkeys[h_vals[i]]);
+        if (i > 0) {
+            g_assert_cmpfloat(h_fout[i - 1], <=, h_fout[i]);
+            if (h_fout[i - 1] == h_fout[i])
+                g_assert_cmpuint(h_vals[i - 1], <, h_vals[i]);
+        }
+    }
+
+    /* Invalid value size. */
+    evt = ccl_algo_sort_by_key(q, b_fkeys, b_vals, CCL_ALGO_FLOAT, 2, n,
+        NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b_keys);
+    ccl_buffer_destroy(b_fkeys);
+    ccl_buffer_destroy(b_vals);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+    g_free(h_keys);
+    g_free(h_sorted);
+    g_free(h_fkeys);
+    g_free(h_fout);
+    g_free(h_vals);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests that OpenGL interoperability functions fail gracefully
+ * without an OpenGL context.
+ * */
+static void gl_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLContext * ctx_gl = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLBuffer * b = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+
+    /* Creating a context from a non-existing OpenGL context fails. */
+    ctx_gl = ccl_context_new_from_gl(NULL, NULL, &err);
+    g_assert(ctx_gl == NULL);
+    g_assert(err != NULL);
+    g_clear_error(&err);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a regular buffer. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 16 * sizeof(cl_uint), NULL,
+        &err);
+    g_assert_no_error(err);
+
+    /* Acquiring and releasing a buffer not created from an OpenGL object
+     * fails. */
+    evt = ccl_memobj_enqueue_acquire_gl(
+        (CCLMemObj **) &b, 1, q, NULL, &err);
+    g_assert(evt == NULL);
+    g_assert(err != NULL);
+    g_clear_error(&err);
+
+    evt = ccl_memobj_enqueue_release_gl(
+        (CCLMemObj **) &b, 1, q, NULL, &err);
+    g_assert(evt == NULL);
+    g_assert(err != NULL);
+    g_clear_error(&err);
+
+    /* The queue is still usable. */
+    ccl_queue_finish(q, &err);
+    g_assert_no_error(err);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* Number of packets streamed in the pipe test. */
+#define CCL_TEST_PIPE_PACKETS 64
+
+/**
+ * @internal
+ *
+ * @brief Tests creation, information queries and kernel-to-kernel
+ * streaming of pipe wrapper objects.
+ * */
+static void pipe_test() {
+
+#ifndef CL_VERSION_2_0
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 2.0 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLPipe * pipe = NULL;
+    CCLBuffer * bin = NULL;
+    CCLBuffer * bout = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl_prod = NULL;
+    CCLKernel * krnl_cons = NULL;
+    CCLErr * err = NULL;
+    cl_int hin[CCL_TEST_PIPE_PACKETS];
+    cl_int hout[CCL_TEST_PIPE_PACKETS];
+    cl_long sum_in = 0, sum_out = 0;
+    size_t gws = CCL_TEST_PIPE_PACKETS;
+    const char * src =
+        "__kernel void prod(__write_only pipe int p,\n"
+        "    __global const int * in) {\n"
+        "    write_pipe(p, &in[get_global_id(0)]);\n"
+        "}\n"
+        "__kernel void cons(__read_only pipe int p,\n"
+        "    __global int * out) {\n"
+        "    int v = 0;\n"
+        "    read_pipe(p, &v);\n"
+        "    out[get_global_id(0)] = v;\n"
+        "}\n";
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(200, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create pipe, if supported by device. */
+    pipe = ccl_pipe_new(ctx, 0, sizeof(cl_int), CCL_TEST_PIPE_PACKETS, &err);
+    if ((err != NULL) && (err->domain == CCL_ERROR)
+        && (err->code == CCL_ERROR_UNSUPPORTED_OCL)) {
+        g_test_skip(err->message);
+        g_clear_error(&err);
+        ccl_context_destroy(ctx);
+        return;
+    }
+    g_assert_no_error(err);
+
+    /* Check pipe information. */
+    g_assert_cmpuint(ccl_pipe_get_info_scalar(
+        pipe, CL_PIPE_PACKET_SIZE, cl_uint, &err), ==, sizeof(cl_int));
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_pipe_get_info_scalar(
+        pipe, CL_PIPE_MAX_PACKETS, cl_uint, &err), ==,
+        CCL_TEST_PIPE_PACKETS);
+    g_assert_no_error(err);
+    g_assert_cmphex(ccl_memobj_get_info_scalar(
+        pipe, CL_MEM_TYPE, cl_mem_object_type, &err), ==,
+        CL_MEM_OBJECT_PIPE);
+    g_assert_no_error(err);
+
+    /* Packets larger than supported by the device are rejected. */
+    g_assert_null(ccl_pipe_new(ctx, 0, G_MAXUINT32, 1, &err));
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_clear_error(&err);
+
+    /* Stream data from a producer kernel to a consumer kernel. */
+    for (cl_uint i = 0; i < CCL_TEST_PIPE_PACKETS; ++i) {
+        hin[i] = (cl_int) (g_test_rand_int() % 1000);
+        sum_in += hin[i];
+    }
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    bin = ccl_buffer_new(ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        sizeof(hin), hin, &err);
+    g_assert_no_error(err);
+    bout = ccl_buffer_new(
+        ctx, CL_MEM_WRITE_ONLY, sizeof(hout), NULL, &err);
+    g_assert_no_error(err);
+    prg = ccl_program_new_from_source(ctx, src, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, "-cl-std=CL2.0", &err);
+    g_assert_no_error(err);
+    krnl_prod = ccl_kernel_new(prg, "prod", &err);
+    g_assert_no_error(err);
+    krnl_cons = ccl_kernel_new(prg, "cons", &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_args_and_enqueue_ndrange(krnl_prod, cq, 1, NULL, &gws,
+        NULL, NULL, &err, pipe, bin, NULL);
+    g_assert_no_error(err);
+    ccl_kernel_set_args_and_enqueue_ndrange(krnl_cons, cq, 1, NULL, &gws,
+        NULL, NULL, &err, pipe, bout, NULL);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(bout, cq, CL_TRUE, 0, sizeof(hout), hout,
+        NULL, &err);
+    g_assert_no_error(err);
+
+    /* Packets may be read in any order. */
+    for (cl_uint i = 0; i < CCL_TEST_PIPE_PACKETS; ++i)
+        sum_out += hout[i];
+    g_assert_cmpint(sum_out, ==, sum_in);
+
+    /* Release wrappers. */
+    ccl_kernel_destroy(krnl_cons);
+    ccl_kernel_destroy(krnl_prod);
+    ccl_program_destroy(prg);
+    ccl_buffer_destroy(bout);
+    ccl_buffer_destroy(bin);
+    ccl_pipe_destroy(pipe);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests reading buffers into GBytes objects backed by mapped
+ * buffer regions.
+ * */
+static void read_bytes_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLBuffer * b = NULL;
+    CCLQueue * q = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    GBytes * bytes = NULL;
+    const cl_uint * data;
+    gsize data_size;
+    cl_uint h_in[CCL_TEST_BUFFER_SIZE];
+    size_t buf_size = sizeof(cl_uint) * CCL_TEST_BUFFER_SIZE;
+
+    /* Create a host array, put some stuff in it. */
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create zero-copy buffer initialized with the host data. */
+    b = ccl_buffer_new_zero_copy(
+        ctx, CL_MEM_READ_WRITE, buf_size, h_in, &err);
+    g_assert_no_error(err);
+
+    /* Read second half of buffer into a GBytes object. */
+    bytes = ccl_buffer_enqueue_read_bytes(b, q, buf_size / 2, buf_size / 2,
+        NULL, &evt, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(bytes);
+    g_assert_nonnull(evt);
+
+    /* Check data is OK. */
+    data = (const cl_uint *) g_bytes_get_data(bytes, &data_size);
+    g_assert_cmpuint(data_size, ==, buf_size / 2);
+    for (guint i = 0; i < CCL_TEST_BUFFER_SIZE / 2; ++i)
+        g_assert_cmpuint(data[i], ==, h_in[CCL_TEST_BUFFER_SIZE / 2 + i]);
+
+    /* GBytes object keeps buffer and queue alive after their wrappers
+     * are destroyed by client code. */
+    ccl_buffer_destroy(b);
+    ccl_queue_finish(q, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(data[0], ==, h_in[CCL_TEST_BUFFER_SIZE / 2]);
+
+    /* Dropping the last reference unmaps the region. */
+    g_bytes_unref(bytes);
+
+    /* Reading out of bounds fails. */
+    b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, buf_size, NULL, &err);
+    g_assert_no_error(err);
+    bytes = ccl_buffer_enqueue_read_bytes(
+        b, q, buf_size, buf_size, NULL, NULL, &err);
+    g_assert_error(err, CCL_OCL_ERROR, CL_INVALID_VALUE);
+    g_assert_null(bytes);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(b);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char ** argv) {
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func(
+        "/wrappers/buffer/create-info-destroy",
+        create_info_destroy_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/ref-unref",
+        ref_unref_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/wrap-unwrap",
+        wrap_unwrap_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/read-write",
+        read_write_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/copy",
+        copy_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/map-unmap",
+        map_unmap_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/destruct_callback",
+        destructor_callback_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/rect-read-write-copy",
+        rect_read_write_copy_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/create-from-region",
+        create_from_region_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/fill",
+        fill_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/migrate",
+        migrate_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/pool",
+        pool_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/staging",
+        staging_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/upload-ring",
+        upload_ring_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/half",
+        half_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/zero-copy",
+        zero_copy_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/arena",
+        arena_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/ranges",
+        ranges_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/from-file",
+        from_file_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/hazards",
+        hazards_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/destroy-deferred",
+        destroy_deferred_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/algo",
+        algo_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/algo-sort",
+        algo_sort_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/gl",
+        gl_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/pipe",
+        pipe_test);
+
+    g_test_add_func(
+        "/wrappers/buffer/read-bytes",
+        read_bytes_test);
 
     return g_test_run();
 }
@@ -818,8 +818,9 @@ static void get_supported_image_formats_test() {
     if (c) {
 
         /* Test variables. */
-        const cl_image_format * image_formats;
-        cl_uint num_image_formats;
+        const cl_image_format * image_formats, * image_formats_cached;
+        cl_uint num_image_formats, num_image_formats_cached;
+        cl_image_format bogus_format = { 0, 0 };
 
         /* Test the ccl_context_get_supported_image_formats() function. */
         image_formats = ccl_context_get_supported_image_formats(
@@ -827,6 +828,24 @@ static void get_supported_image_formats_test() {
             &num_image_formats, &err);
         g_assert_no_error(err);
 
+        /* A second query should return the cached list. */
+        image_formats_cached = ccl_context_get_supported_image_formats(
+            c, CL_MEM_READ_WRITE, CL_MEM_OBJECT_IMAGE2D,
+            &num_image_formats_cached, &err);
+        g_assert_no_error(err);
+        g_assert_true(image_formats_cached == image_formats);
+        g_assert_cmpuint(num_image_formats_cached, ==, num_image_formats);
+
+        /* Check format support lookups. */
+        g_assert_true(ccl_context_is_image_format_supported(
+            c, CL_MEM_READ_WRITE, CL_MEM_OBJECT_IMAGE2D,
+            &image_formats[num_image_formats - 1], &err));
+        g_assert_no_error(err);
+        g_assert_false(ccl_context_is_image_format_supported(
+            c, CL_MEM_READ_WRITE, CL_MEM_OBJECT_IMAGE2D,
+            &bogus_format, &err));
+        g_assert_no_error(err);
+
         /* Cycle through image formats and print them to debug output. */
         for (guint i = 0; i < num_image_formats; ++i) {
 
@@ -892,6 +911,164 @@ static void device_container_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests memory accounting and memory budgets of a context.
+ * */
+static void mem_accounting_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLBuffer * b1 = NULL;
+    CCLBuffer * b2 = NULL;
+    CCLBuffer * b3 = NULL;
+    CCLErr * err = NULL;
+    size_t size;
+
+    /* Create some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* No memory is allocated in a new context. */
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, 0);
+    g_assert_cmpuint(ccl_context_get_mem_peak(ctx), ==, 0);
+    g_assert_cmpuint(ccl_context_get_mem_budget(ctx), ==, 0);
+
+    /* Buffers are accounted for while they are alive. */
+    b1 = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 1024, NULL, &err);
+    g_assert_no_error(err);
+    b2 = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 512, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, 1536);
+    ccl_buffer_destroy(b1);
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, 512);
+    g_assert_cmpuint(ccl_context_get_mem_peak(ctx), ==, 1536);
+    ccl_context_reset_mem_peak(ctx);
+    g_assert_cmpuint(ccl_context_get_mem_peak(ctx), ==, 512);
+
+    /* Buffers which do not fit in the budget are not created. */
+    ccl_context_set_mem_budget(ctx, 1024);
+    g_assert_cmpuint(ccl_context_get_mem_budget(ctx), ==, 1024);
+    b1 = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 1024, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_MEM_BUDGET);
+    g_assert_null(b1);
+    g_clear_error(&err);
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, 512);
+    ccl_buffer_destroy(b2);
+
+    /* Pooled buffers are released to keep within the budget. */
+    ccl_context_set_mem_budget(ctx, 0);
+    ccl_buffer_pool_enable(ctx, 0);
+    b3 = ccl_buffer_pool_get(ctx, CL_MEM_READ_WRITE, 1024, &err);
+    g_assert_no_error(err);
+    size = ccl_memobj_get_info_scalar(b3, CL_MEM_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    ccl_buffer_pool_put(ctx, b3);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, size);
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, size);
+    ccl_context_set_mem_budget(ctx, size);
+    b1 = ccl_buffer_new(ctx, CL_MEM_READ_ONLY, size, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_buffer_pool_get_size(ctx), ==, 0);
+    g_assert_cmpuint(ccl_context_get_mem_used(ctx), ==, size);
+
+    /* Buffers can outlive the context wrapper. */
+    ccl_context_destroy(ctx);
+    g_assert_false(ccl_wrapper_memcheck());
+    ccl_buffer_destroy(b1);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests pools of warm contexts.
+ * */
+static void pool_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLContextPool * pool = NULL;
+    CCLContextLease * l1 = NULL;
+    CCLContextLease * l2 = NULL;
+    CCLContext * ctx1 = NULL;
+    CCLProgram * prg = NULL;
+    CCLErr * err = NULL;
+    const char * src = "__kernel void k(__global int * x) { x[0] = 1; }";
+
+    /* Get a device from some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create pool with one warm context. */
+    pool = ccl_context_pool_new_from_devices(1, &dev, 0, 1, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_context_pool_get_num_idle(pool), ==, 1);
+
+    /* The pool keeps its own device references. */
+    ccl_context_destroy(ctx);
+
+    /* Leases have a context and one queue per device. */
+    l1 = ccl_context_pool_acquire(pool, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_context_pool_get_num_idle(pool), ==, 0);
+    ctx1 = ccl_context_lease_get_context(l1);
+    g_assert_nonnull(ctx1);
+    g_assert_nonnull(ccl_context_lease_get_queue(l1, 0));
+
+    /* Programs are only built once per lease. */
+    prg = ccl_context_lease_get_program(l1, 1, &src, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(
+        prg == ccl_context_lease_get_program(l1, 1, &src, NULL, &err));
+    g_assert_no_error(err);
+    g_assert_true(
+        prg != ccl_context_lease_get_program(l1, 1, &src, "-DX", &err));
+    g_assert_no_error(err);
+
+    /* A new lease is created if no idle lease is available. */
+    l2 = ccl_context_pool_acquire(pool, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_context_lease_get_context(l2) != ctx1);
+
+    /* Returned leases are reused, keeping their programs. */
+    ccl_context_pool_release(pool, l1);
+    ccl_context_pool_release(pool, l2);
+    g_assert_cmpuint(ccl_context_pool_get_num_idle(pool), ==, 2);
+    l1 = ccl_context_pool_acquire(pool, &err);
+    g_assert_no_error(err);
+    l2 = ccl_context_pool_acquire(pool, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_context_lease_get_context(l2) == ctx1);
+    g_assert_true(
+        prg == ccl_context_lease_get_program(l2, 1, &src, NULL, &err));
+    g_assert_no_error(err);
+    ccl_context_pool_release(pool, l2);
+    ccl_context_pool_release(pool, l1);
+
+    /* Trim idle leases. */
+    g_assert_cmpuint(ccl_context_pool_trim(pool, 1), ==, 1);
+    g_assert_cmpuint(ccl_context_pool_get_num_idle(pool), ==, 1);
+    g_assert_cmpuint(ccl_context_pool_trim(pool, 1), ==, 0);
+
+    /* Confirm that memory allocated by wrappers has not yet been freed. */
+    g_assert_false(ccl_wrapper_memcheck());
+
+    /* Destroy pool. */
+    ccl_context_pool_destroy(pool);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -920,5 +1097,13 @@ int main(int argc, char ** argv) {
         "/wrappers/context/device-container",
         device_container_test);
 
+    g_test_add_func(
+        "/wrappers/context/mem-accounting",
+        mem_accounting_test);
+
+    g_test_add_func(
+        "/wrappers/context/pool",
+        pool_test);
+
     return g_test_run();
 }
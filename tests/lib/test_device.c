@@ -29,6 +29,8 @@
 #include <cf4ocl2.h>
 #include "test.h"
 
+#define CCL_TEST_DEVICE_PARTITION_BUFSIZE 1024
+
 /**
  * @internal
  *
@@ -327,6 +329,165 @@ static void sub_devices_test() {
 
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests the device capabilities snapshot.
+ * */
+static void caps_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    const CCLDeviceCaps * caps = NULL;
+    const char * exts;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Get capabilities. */
+    caps = ccl_device_get_caps(d, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(caps);
+
+    /* Capabilities are only queried once. */
+    g_assert_true(caps == ccl_device_get_caps(d, NULL));
+
+    /* Check that capabilities match device information. */
+    g_assert_cmpuint(caps->opencl_version, ==,
+        ccl_device_get_opencl_version(d, NULL));
+    g_assert_cmpuint(caps->max_work_group_size, ==,
+        ccl_device_get_info_scalar(
+            d, CL_DEVICE_MAX_WORK_GROUP_SIZE, size_t, NULL));
+    g_assert_cmpuint(caps->mem_base_addr_align * 8, ==,
+        ccl_device_get_info_scalar(
+            d, CL_DEVICE_MEM_BASE_ADDR_ALIGN, cl_uint, NULL));
+    g_assert_cmpuint(caps->image_support, ==,
+        ccl_device_get_info_scalar(
+            d, CL_DEVICE_IMAGE_SUPPORT, cl_bool, NULL));
+
+    exts = ccl_device_get_info_array(d, CL_DEVICE_EXTENSIONS, char, &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(
+        (caps->extensions & CCL_DEVICE_EXT_KHR_FP64) != 0, ==,
+        strstr(exts, "cl_khr_fp64") != NULL);
+    g_assert_cmpint(
+        (caps->extensions & CCL_DEVICE_EXT_KHR_GLOBAL_INT32_BASE_ATOMICS)
+            != 0, ==,
+        strstr(exts, "cl_khr_global_int32_base_atomics") != NULL);
+
+    /* Destroy context. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests partitioning devices by affinity domain.
+ * */
+static void partition_test() {
+
+#ifndef CL_VERSION_1_2
+
+    g_test_skip("Test skipped due to lack of OpenCL 1.2 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * pdev = NULL;
+    CCLDevicePartition * part = NULL;
+    CCLBuffer * buf = NULL;
+    CCLErr * err = NULL;
+    cl_uchar h[CCL_TEST_DEVICE_PARTITION_BUFSIZE];
+    cl_uint n;
+    const char * pexts;
+    const char * exts;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(120, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get parent device. */
+    pdev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Partition device by the next partitionable affinity domain. */
+    part = ccl_device_partition_new(pdev, 0, 0, &err);
+    if (part == NULL) {
+        g_test_message("Test device could not be partitioned by affinity "
+            "domain (%s), as such partition test will not be performed.",
+            err->message);
+        ccl_err_clear(&err);
+        ccl_context_destroy(ctx);
+        return;
+    }
+    g_assert_no_error(err);
+
+    /* Check domains. */
+    n = ccl_device_partition_get_num_domains(part);
+    g_assert_cmpuint(n, >, 0);
+    for (cl_uint i = 0; i < n; ++i) {
+
+        CCLDevice * subdev = ccl_device_partition_get_device(part, i);
+        CCLQueue * q = ccl_device_partition_get_queue(part, i);
+
+        g_assert_true(ccl_queue_get_device(q, NULL) == subdev);
+        g_assert_cmphex(GPOINTER_TO_SIZE(ccl_device_get_info_scalar(
+                subdev, CL_DEVICE_PARENT_DEVICE, cl_device_id, NULL)),
+            ==, GPOINTER_TO_SIZE(ccl_device_unwrap(pdev)));
+
+        /* Equal extension strings are shared between devices. */
+        pexts = ccl_device_get_info_array(
+            pdev, CL_DEVICE_EXTENSIONS, char, &err);
+        g_assert_no_error(err);
+        exts = ccl_device_get_info_array(
+            subdev, CL_DEVICE_EXTENSIONS, char, &err);
+        g_assert_no_error(err);
+        if (g_strcmp0(pexts, exts) == 0)
+            g_assert_true(pexts == exts);
+
+        /* Create domain-local buffer, which is zeroed. */
+        buf = ccl_device_partition_buffer_new(part, i, CL_MEM_READ_WRITE,
+            sizeof(h), &err);
+        g_assert_no_error(err);
+        ccl_buffer_enqueue_read(buf, q, CL_TRUE, 0, sizeof(h), h, NULL,
+            &err);
+        g_assert_no_error(err);
+        for (guint j = 0; j < sizeof(h); ++j)
+            g_assert_cmpuint(h[j], ==, 0);
+        ccl_buffer_destroy(buf);
+    }
+
+    /* Buffers cannot use host memory. */
+    buf = ccl_device_partition_buffer_new(part, 0, CL_MEM_USE_HOST_PTR,
+        sizeof(h), &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(buf);
+    ccl_err_clear(&err);
+
+    /* Destroy stuff. */
+    ccl_device_partition_destroy(part);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
 /**
  * @internal
  *
@@ -347,5 +508,13 @@ int main(int argc, char ** argv) {
         "/wrappers/device/sub-devices",
         sub_devices_test);
 
+    g_test_add_func(
+        "/wrappers/device/caps",
+        caps_test);
+
+    g_test_add_func(
+        "/wrappers/device/partition",
+        partition_test);
+
     return g_test_run();
 }
@@ -516,6 +516,51 @@ static void format_rare_test() {
 
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests the indexed lookups of the ccl_devquery_get_index() and
+ * ccl_devquery_match() functions against a linear search of the
+ * ccl_devquery_info_map array.
+ * */
+static void lookup_test() {
+
+    /* Substrings to match. */
+    const char * substrs[] = { "", "E", "MAX", "SIZE", "_", "VERSION",
+        "NAME", "_AMD", "WIDTH_", "NOT_A_PARAM", NULL };
+
+    const CCLDevQueryMap * info_row;
+    gint idx;
+    gint k;
+
+    /* Every parameter name is found at its own index. */
+    for (k = 0; k < ccl_devquery_info_map_size; k++) {
+        g_assert_cmpint(ccl_devquery_get_index(
+            ccl_devquery_info_map[k].param_name), ==, k);
+    }
+    g_assert_cmpint(ccl_devquery_get_index("MAX"), ==, -1);
+    g_assert_cmpint(ccl_devquery_get_index("ZZZ"), ==, -1);
+
+    /* Matches are the same as with a linear substring search, and in the
+     * same order. */
+    for (guint i = 0; substrs[i] != NULL; i++) {
+        idx = 0;
+        k = 0;
+        while ((info_row = ccl_devquery_match(substrs[i], &idx)) != NULL) {
+            while ((k < ccl_devquery_info_map_size) && !g_strstr_len(
+                ccl_devquery_info_map[k].param_name, -1, substrs[i]))
+                k++;
+            g_assert_cmpint(k, <, ccl_devquery_info_map_size);
+            g_assert(info_row == &ccl_devquery_info_map[k]);
+            k++;
+        }
+        for ( ; k < ccl_devquery_info_map_size; k++) {
+            g_assert(!g_strstr_len(
+                ccl_devquery_info_map[k].param_name, -1, substrs[i]));
+        }
+    }
+}
+
 /**
  * @internal
  *
@@ -536,5 +581,7 @@ int main(int argc, char ** argv) {
 
     g_test_add_func("/devquery/format_rare", format_rare_test);
 
+    g_test_add_func("/devquery/lookup", lookup_test);
+
     return g_test_run();
 }
@@ -29,6 +29,7 @@
  * */
 
 #include <cf4ocl2.h>
+#include <glib/gstdio.h>
 #include "test.h"
 
 /**
@@ -154,6 +155,155 @@ static void independent_filters_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Test the benchmark-ranked dependent filter.
+ * */
+static void fastest_filter_test() {
+
+    /* Variables. */
+    CCLErr * err = NULL;
+    CCLDevSelDevices devs = NULL;
+    CCLDevSelFilters filters = NULL;
+    CCLDevSelBench bench, bench_cached;
+    CCLDevSelFastest fastest = { CCL_DEVSEL_METRIC_BANDWIDTH, 0 };
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    cl_bool status;
+    guint num_devs;
+
+    /* Create test context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Benchmark test device, and check that results are cached. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+    status = ccl_devsel_bench(dev, &bench, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpfloat(bench.bandwidth, >, 0);
+    g_assert_cmpfloat(bench.latency, >=, 0);
+    g_assert_cmpfloat(bench.compute, >, 0);
+    status = ccl_devsel_bench(dev, &bench_cached, &err);
+    g_assert_no_error(err);
+    g_assert_cmpfloat(bench.bandwidth, ==, bench_cached.bandwidth);
+    g_assert_cmpfloat(bench.latency, ==, bench_cached.latency);
+    g_assert_cmpfloat(bench.compute, ==, bench_cached.compute);
+
+    /* With top_k == 0, all devices of the test device's platform are kept. */
+    devs = ccl_devsel_devices_new(&err);
+    g_assert_no_error(err);
+    num_devs = devs->len;
+    ccl_devsel_devices_destroy(devs);
+    devs = NULL;
+    ccl_devsel_add_indep_filter(&filters, ccl_devsel_indep_platform,
+        (void *) ccl_device_get_info_scalar(
+            dev, CL_DEVICE_PLATFORM, cl_platform_id, NULL));
+    ccl_devsel_add_dep_filter(&filters, ccl_devsel_dep_fastest, &fastest);
+    devs = ccl_devsel_select(&filters, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(devs->len, >=, 1);
+    g_assert_cmpuint(devs->len, <=, num_devs);
+    ccl_devsel_devices_destroy(devs);
+
+    /* Keep only the best device. */
+    fastest.metric = CCL_DEVSEL_METRIC_LATENCY;
+    fastest.top_k = 1;
+    ccl_devsel_add_indep_filter(&filters, ccl_devsel_indep_platform,
+        (void *) ccl_device_get_info_scalar(
+            dev, CL_DEVICE_PLATFORM, cl_platform_id, NULL));
+    ccl_devsel_add_dep_filter(&filters, ccl_devsel_dep_fastest, &fastest);
+    devs = ccl_devsel_select(&filters, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(devs->len, ==, 1);
+    ccl_devsel_devices_destroy(devs);
+
+    /* Destroy test context. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Independent filter which accepts all devices, counting how many
+ * times it was evaluated.
+ * */
+static cl_bool counting_filter(
+    CCLDevice * dev, void * data, CCLErr ** err) {
+
+    CCL_UNUSED(dev);
+    CCL_UNUSED(err);
+    (*((guint *) data))++;
+    return CL_TRUE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Test cached device selection.
+ * */
+static void select_cached_test() {
+
+    /* Variables. */
+    CCLErr * err = NULL;
+    CCLDevSelDevices devs = NULL, devs_cached = NULL;
+    CCLDevSelFilters filters = NULL;
+    gchar * cache_file;
+    guint num_evals = 0;
+
+    /* Use a temporary cache file. */
+    cache_file = g_build_filename(
+        g_get_tmp_dir(), "cf4ocl_test_devsel.ini", NULL);
+    g_remove(cache_file);
+    ccl_devsel_cache_set_file(cache_file);
+
+    /* First selection evaluates the filters and caches the result. */
+    ccl_devsel_add_indep_filter(&filters, counting_filter, &num_evals);
+    devs = ccl_devsel_select_cached(&filters, "test", &err);
+    g_assert_no_error(err);
+    g_assert_null(filters);
+    g_assert_cmpuint(num_evals, >, 0);
+    g_assert_true(g_file_test(cache_file, G_FILE_TEST_EXISTS));
+
+    /* Discard the in-memory cache so that the cache file is reloaded. */
+    ccl_devsel_cache_set_file(cache_file);
+
+    /* Second selection with the same key reuses the cached result. */
+    num_evals = 0;
+    ccl_devsel_add_indep_filter(&filters, counting_filter, &num_evals);
+    devs_cached = ccl_devsel_select_cached(&filters, "test", &err);
+    g_assert_no_error(err);
+    g_assert_null(filters);
+    g_assert_cmpuint(num_evals, ==, 0);
+    g_assert_cmpuint(devs_cached->len, ==, devs->len);
+    for (guint i = 0; i < devs->len; ++i)
+        g_assert_true(g_ptr_array_index(devs_cached, i)
+            == g_ptr_array_index(devs, i));
+
+    /* A different key evaluates the filters again. */
+    ccl_devsel_devices_destroy(devs_cached);
+    ccl_devsel_add_indep_filter(&filters, counting_filter, &num_evals);
+    devs_cached = ccl_devsel_select_cached(&filters, "test2", &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(num_evals, >, 0);
+
+    /* Release devices and cache file. */
+    ccl_devsel_devices_destroy(devs);
+    ccl_devsel_devices_destroy(devs_cached);
+    ccl_devsel_cache_set_file(NULL);
+    g_remove(cache_file);
+    g_free(cache_file);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -172,5 +322,10 @@ int main(int argc, char ** argv) {
     g_test_add_func("/devsel/independent_filters",
         independent_filters_test);
 
+    g_test_add_func("/devsel/fastest_filter",
+        fastest_filter_test);
+    g_test_add_func("/devsel/select_cached",
+        select_cached_test);
+
     return g_test_run();
 }
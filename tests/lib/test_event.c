@@ -172,6 +172,7 @@ static void name_test() {
     cl_int exec_status = -1;
     cl_command_type ct = 0;
     const char * evt_name = NULL;
+    char * tmp_name = NULL;
 
     /* Get the test context with the pre-defined device. */
     ctx = ccl_test_context_new(0, &err);
@@ -215,13 +216,17 @@ static void name_test() {
     /* Check that final event name is "MAP_BUFFER". */
     evt_name = ccl_event_get_final_name(evt);
     g_assert_cmpstr("MAP_BUFFER", ==, evt_name);
+    g_assert_true(evt_name == g_intern_string("MAP_BUFFER"));
 
-    /* Set another name for the event. */
-    ccl_event_set_name(evt, "SomeOtherName");
+    /* Set another name for the event, from a temporary string. */
+    tmp_name = g_strdup("SomeOtherName");
+    ccl_event_set_name(evt, tmp_name);
+    g_free(tmp_name);
 
-    /* Get the final event name now. */
+    /* Get the final event name now, which should be interned. */
     evt_name = ccl_event_get_name(evt);
     g_assert_cmpstr("SomeOtherName", ==, evt_name);
+    g_assert_true(evt_name == g_intern_string("SomeOtherName"));
 
     /* Unmap buffer, get resulting event. */
     evt = ccl_buffer_enqueue_unmap(buf, cq, host_buf, NULL, &err);
@@ -360,6 +365,24 @@ static void event_wait_lists_test() {
     ccl_event_wait_list_clear(&ewl);
     g_assert_true(ewl == NULL);
 
+    /* Add more events than fit in inline storage. */
+    for (cl_uint i = 0; i < 3 * CCL_EVENT_WAIT_LIST_INLINE_SIZE; ++i)
+        ccl_event_wait_list_add(&ewl, evt, NULL);
+    num_evts = ccl_event_wait_list_get_num_events(ewl_test_aux(&ewl));
+    g_assert_cmpuint(num_evts, ==, 3 * CCL_EVENT_WAIT_LIST_INLINE_SIZE);
+    clevent_ptr = ccl_event_wait_list_get_clevents(ewl_test_aux(&ewl));
+    for (cl_uint i = 0; i < num_evts; ++i)
+        g_assert_true(clevent_ptr[i] == ccl_event_unwrap(evt));
+    ccl_event_wait_list_clear(&ewl);
+    g_assert_true(ewl == NULL);
+
+    /* Reused list should start empty. */
+    ccl_event_wait_list_add(&ewl, evt, NULL);
+    num_evts = ccl_event_wait_list_get_num_events(ewl_test_aux(&ewl));
+    g_assert_cmpuint(num_evts, ==, 1);
+    ccl_event_wait_list_clear(&ewl);
+    g_assert_true(ewl == NULL);
+
     /* Confirm that memory allocated by wrappers has not yet been freed. */
     g_assert_false(ccl_wrapper_memcheck());
 
@@ -374,6 +397,85 @@ static void event_wait_lists_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests polling and pruning of event wait lists.
+ * */
+static void wait_list_poll_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLEvent * uevt1 = NULL;
+    CCLEvent * uevt2 = NULL;
+    CCLContext * ctx = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_bool finished[3];
+    cl_uint num_finished;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create user events. */
+    uevt1 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+    uevt2 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+
+    /* Polling an empty list finds no finished events. */
+    num_finished = ccl_event_wait_list_poll(&ewl, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(num_finished, ==, 0);
+
+    /* No events have finished yet. */
+    ccl_event_wait_list_add(&ewl, uevt1, uevt2, uevt1, NULL);
+    num_finished = ccl_event_wait_list_poll(&ewl, finished, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(num_finished, ==, 0);
+    g_assert_false(finished[0] || finished[1] || finished[2]);
+
+    /* Complete second event, which is found by polling, and pruned. */
+    ccl_user_event_set_status(uevt2, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+    num_finished = ccl_event_wait_list_poll(&ewl, finished, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(num_finished, ==, 1);
+    g_assert_false(finished[0]);
+    g_assert_true(finished[1]);
+    g_assert_false(finished[2]);
+    g_assert_true(ccl_event_wait_list_prune(&ewl) == &ewl);
+    g_assert_cmpuint(ccl_event_wait_list_get_num_events(&ewl), ==, 2);
+    g_assert_true(ccl_event_wait_list_get_clevents(&ewl)[0]
+        == ccl_event_unwrap(uevt1));
+
+    /* Complete first event, after which the pruned list is empty. */
+    ccl_user_event_set_status(uevt1, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_event_wait_list_prune(&ewl) == NULL);
+    g_assert_true(ewl == NULL);
+
+    /* Release wrappers. */
+    ccl_event_destroy(uevt1);
+    ccl_event_destroy(uevt2);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
 /**
  * @internal
  *
@@ -582,6 +684,284 @@ static void callback_test() {
 }
 
 
+/**
+ * @internal
+ *
+ * @brief Continuation used by the futures test, which counts how many
+ * times it runs.
+ * */
+static cl_int future_cont(cl_int status, void * user_data) {
+
+    gint * count = (gint *) user_data;
+
+    g_assert_cmpint(status, ==, CL_COMPLETE);
+    g_atomic_int_inc(count);
+    return CL_COMPLETE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests futures and continuations.
+ * */
+static void future_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLEvent * uevt1 = NULL;
+    CCLEvent * uevt2 = NULL;
+    CCLFuture * futs[2];
+    CCLFuture * fut_then, * fut_then2, * fut_all, * fut_any;
+    CCLErr * err = NULL;
+    gint count = 0;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create futures from user events. */
+    uevt1 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+    uevt2 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+    futs[0] = ccl_future_new(uevt1, &err);
+    g_assert_no_error(err);
+    futs[1] = ccl_future_new(uevt2, &err);
+    g_assert_no_error(err);
+
+    /* Chain and combine futures. */
+    fut_then = ccl_future_then(futs[0], future_cont, &count);
+    fut_then2 = ccl_future_then(fut_then, future_cont, &count);
+    fut_all = ccl_future_when_all(2, futs);
+    fut_any = ccl_future_when_any(2, futs);
+
+    /* Nothing should be complete yet. */
+    g_assert_false(ccl_future_is_ready(fut_then));
+    g_assert_false(ccl_future_is_ready(fut_all));
+    g_assert_false(ccl_future_is_ready(fut_any));
+    g_assert_cmpint(g_atomic_int_get(&count), ==, 0);
+
+    /* Complete first event, which completes the chain and the any
+     * future, but not the all future. */
+    ccl_user_event_set_status(uevt1, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(ccl_future_wait(fut_any), ==, CL_COMPLETE);
+    g_assert_cmpint(ccl_future_wait(fut_then2), ==, CL_COMPLETE);
+    g_assert_true(ccl_future_is_ready(fut_then));
+    g_assert_cmpint(g_atomic_int_get(&count), ==, 2);
+    g_assert_false(ccl_future_is_ready(fut_all));
+
+    /* Fail second event, the all future should get its error status. */
+    ccl_user_event_set_status(uevt2, -1, &err);
+    g_assert_no_error(err);
+    g_assert_cmpint(ccl_future_wait(fut_all), ==, -1);
+
+    /* Chaining after a completed future runs the continuation. */
+    ccl_future_destroy(fut_then2);
+    fut_then2 = ccl_future_then(fut_then, future_cont, &count);
+    g_assert_cmpint(ccl_future_wait(fut_then2), ==, CL_COMPLETE);
+    g_assert_cmpint(g_atomic_int_get(&count), ==, 3);
+
+    /* Release futures and wrappers. */
+    ccl_future_destroy(fut_then2);
+    ccl_future_destroy(fut_then);
+    ccl_future_destroy(fut_all);
+    ccl_future_destroy(fut_any);
+    ccl_future_destroy(futs[0]);
+    ccl_future_destroy(futs[1]);
+    ccl_event_destroy(uevt1);
+    ccl_event_destroy(uevt2);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+
+/**
+ * @internal
+ *
+ * @brief Callback used by the event sources test, which keeps the
+ * execution status it received.
+ * */
+static gboolean event_source_cb(cl_int status, gpointer user_data) {
+
+    cl_int * status_out = (cl_int *) user_data;
+
+    *status_out = status;
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests GLib main loop sources for event completion.
+ * */
+static void event_source_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLEvent * uevt1 = NULL;
+    CCLEvent * uevt2 = NULL;
+    CCLEventWaitList ewl = NULL;
+    GMainContext * mctx = NULL;
+    GSource * src1 = NULL;
+    GSource * src2 = NULL;
+    cl_int status1 = 1;
+    cl_int status2 = 1;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create user events. */
+    uevt1 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+    uevt2 = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+
+    /* Create a source for the first event and another for both events,
+     * and attach them to a new main context. */
+    mctx = g_main_context_new();
+    src1 = ccl_event_source_new(uevt1, &err);
+    g_assert_no_error(err);
+    src2 = ccl_event_wait_list_source_new(
+        ccl_ewl(&ewl, uevt1, uevt2, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_null(ewl);
+    g_source_set_callback(src1, (GSourceFunc) event_source_cb, &status1, NULL);
+    g_source_set_callback(src2, (GSourceFunc) event_source_cb, &status2, NULL);
+    g_source_attach(src1, mctx);
+    g_source_attach(src2, mctx);
+
+    /* Nothing should be dispatched yet. */
+    g_main_context_iteration(mctx, FALSE);
+    g_assert_cmpint(status1, ==, 1);
+    g_assert_cmpint(status2, ==, 1);
+
+    /* Complete first event, only the first source should dispatch. */
+    ccl_user_event_set_status(uevt1, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+    while (status1 == 1) g_main_context_iteration(mctx, TRUE);
+    g_assert_cmpint(status1, ==, CL_COMPLETE);
+    g_assert_cmpint(status2, ==, 1);
+
+    /* Fail second event, the second source should get its status. */
+    ccl_user_event_set_status(uevt2, -1, &err);
+    g_assert_no_error(err);
+    while (status2 == 1) g_main_context_iteration(mctx, TRUE);
+    g_assert_cmpint(status2, ==, -1);
+
+    /* Release sources and wrappers. */
+    g_source_unref(src1);
+    g_source_unref(src2);
+    g_main_context_unref(mctx);
+    ccl_event_destroy(uevt1);
+    ccl_event_destroy(uevt2);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+
+/**
+ * @internal
+ *
+ * @brief Tests hybrid (spin-poll then block) waits with timeouts.
+ * */
+static void wait_full_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLEvent * uevt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_bool status;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create user event. */
+    uevt = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+
+    /* Waiting on an incomplete event should time out and clear the
+     * wait list. */
+    status = ccl_event_wait_full(
+        ccl_ewl(&ewl, uevt, NULL), 1000, 10000, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_TIMEOUT);
+    g_assert_false(status);
+    g_assert_null(ewl);
+    g_clear_error(&err);
+
+    /* Complete the event, waits should now succeed, with and without
+     * timeout. */
+    ccl_user_event_set_status(uevt, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+
+    status = ccl_event_wait_full(
+        ccl_ewl(&ewl, uevt, NULL), 1000, 10000, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    status = ccl_event_wait_full(ccl_ewl(&ewl, uevt, NULL), 0, -1, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Also test the default wait with spin-polling enabled. */
+    ccl_event_wait_set_spin_time(100);
+    status = ccl_event_wait(ccl_ewl(&ewl, uevt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    ccl_event_wait_set_spin_time(0);
+
+    /* Release wrappers. */
+    ccl_event_destroy(uevt);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
 /**
  * @internal
  *
@@ -606,6 +986,10 @@ int main(int argc, char ** argv) {
         "/wrappers/event/wait-lists",
         event_wait_lists_test);
 
+    g_test_add_func(
+        "/wrappers/event/wait-list-poll",
+        wait_list_poll_test);
+
     g_test_add_func(
         "/wrappers/event/user",
         user_event_test);
@@ -614,5 +998,17 @@ int main(int argc, char ** argv) {
         "/wrappers/event/callback",
         callback_test);
 
+    g_test_add_func(
+        "/wrappers/event/future",
+        future_test);
+
+    g_test_add_func(
+        "/wrappers/event/source",
+        event_source_test);
+
+    g_test_add_func(
+        "/wrappers/event/wait-full",
+        wait_full_test);
+
     return g_test_run();
 }
@@ -713,6 +713,469 @@ static void fill_test() {
 
 }
 
+/**
+ * @internal
+ *
+ * @brief Tile callback which counts the tiles of a staged transfer.
+ * */
+static void staging_tile_count(const size_t * origin, const size_t * region,
+    CCLEvent * evt, void * user_data) {
+
+    g_assert_nonnull(evt);
+    g_assert_cmpuint(origin[0] + region[0], <=, CCL_TEST_IMAGE_WIDTH);
+    g_assert_cmpuint(origin[1] + region[1], <=, CCL_TEST_IMAGE_HEIGHT);
+    g_assert_cmpuint(region[2], ==, 1);
+    (*((guint *) user_data))++;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests tiled image transfers through a pinned host staging ring.
+ * */
+static void staging_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLImage * img = NULL;
+    CCLQueue * q = NULL;
+    CCLStaging * stg = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
+    cl_uint himg_in[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    cl_uint himg_out[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    size_t origin[3] = {8, 0, 0};
+    size_t region[3] = {CCL_TEST_IMAGE_WIDTH - 16, CCL_TEST_IMAGE_HEIGHT, 1};
+    size_t row_pitch = CCL_TEST_IMAGE_WIDTH * sizeof(cl_uint);
+    size_t tile_rows = 5;
+    guint num_tiles = 0;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new_with_image_support(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create a random 4-channel 8-bit image. */
+    for (cl_uint i = 0; i < CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT; ++i) {
+        himg_in[i] = (cl_uint) g_test_rand_int();
+        himg_out[i] = 0;
+    }
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create 2D image. */
+    img = ccl_image_new(
+        ctx, CL_MEM_READ_WRITE, &image_format, NULL, &err,
+        "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+        "image_width", (size_t) CCL_TEST_IMAGE_WIDTH,
+        "image_height", (size_t) CCL_TEST_IMAGE_HEIGHT,
+        NULL);
+    g_assert_no_error(err);
+
+    /* Create staging ring with two slots of a few aligned rows each. */
+    stg = ccl_staging_new(q, tile_rows * CCL_STAGING_ROW_PITCH_ALIGN, 2,
+        &err);
+    g_assert_no_error(err);
+
+    /* Write a region of host image, with a larger row pitch, tile by
+     * tile. */
+    evt = ccl_staging_enqueue_write_image(stg, img, origin, region,
+        row_pitch, 0, himg_in + origin[0], staging_tile_count, &num_tiles,
+        NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+    g_assert_cmpuint(num_tiles, ==,
+        (CCL_TEST_IMAGE_HEIGHT + tile_rows - 1) / tile_rows);
+
+    /* Read region back tile by tile, and check it. */
+    num_tiles = 0;
+    ccl_staging_read_image(stg, img, origin, region, row_pitch, 0,
+        himg_out + origin[0], staging_tile_count, &num_tiles,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(num_tiles, ==,
+        (CCL_TEST_IMAGE_HEIGHT + tile_rows - 1) / tile_rows);
+    for (cl_uint y = 0; y < CCL_TEST_IMAGE_HEIGHT; ++y) {
+        for (cl_uint x = 0; x < CCL_TEST_IMAGE_WIDTH; ++x) {
+            cl_uint i = y * CCL_TEST_IMAGE_WIDTH + x;
+            if ((x >= origin[0]) && (x < origin[0] + region[0]))
+                g_assert_cmphex(himg_out[i], ==, himg_in[i]);
+            else
+                g_assert_cmphex(himg_out[i], ==, 0);
+        }
+    }
+
+    /* Slots smaller than a row are not allowed. */
+    ccl_staging_destroy(stg);
+    stg = ccl_staging_new(q, 16, 2, &err);
+    g_assert_no_error(err);
+    evt = ccl_staging_enqueue_write_image(stg, img, origin, region,
+        row_pitch, 0, himg_in, NULL, NULL, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_staging_destroy(stg);
+    ccl_image_destroy(img);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests images which share the storage of buffers.
+ * */
+static void from_buffer_test() {
+
+#ifndef CL_VERSION_1_2
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.2 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLBuffer * buf = NULL;
+    CCLImage * img = NULL;
+    CCLQueue * q = NULL;
+    cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
+    cl_uint hbuf[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    cl_uint himg[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    size_t origin[3] = {0, 0, 0};
+    size_t region[3] = {CCL_TEST_IMAGE_WIDTH, 1, 1};
+    size_t row_pitch;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new_with_image_support(120, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Put some data in a host array. */
+    for (cl_uint i = 0; i < CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT; ++i)
+        hbuf[i] = (cl_uint) g_test_rand_int();
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create buffer with data from host. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        sizeof(hbuf), hbuf, &err);
+    g_assert_no_error(err);
+
+    /* Create 1D image buffer over first row of data and read it. */
+    img = ccl_image_new_from_buffer(buf, CL_MEM_READ_ONLY, &image_format,
+        CCL_TEST_IMAGE_WIDTH, 0, 0, &err);
+    g_assert_no_error(err);
+    ccl_image_enqueue_read(img, q, CL_TRUE, origin, region, 0, 0, himg,
+        NULL, &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_IMAGE_WIDTH; ++i)
+        g_assert_cmphex(himg[i], ==, hbuf[i]);
+    ccl_image_destroy(img);
+
+    /* Images larger than the buffer are not allowed. */
+    img = ccl_image_new_from_buffer(buf, CL_MEM_READ_ONLY, &image_format,
+        2 * CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT, 0, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(img);
+    g_clear_error(&err);
+
+    /* Create 2D image over all data, if supported, and read it. */
+    img = ccl_image_new_from_buffer(buf, CL_MEM_READ_ONLY, &image_format,
+        CCL_TEST_IMAGE_WIDTH / 2, CCL_TEST_IMAGE_HEIGHT,
+        CCL_TEST_IMAGE_WIDTH * sizeof(cl_uint), &err);
+    if (g_error_matches(err, CCL_ERROR, CCL_ERROR_UNSUPPORTED_OCL)
+        || g_error_matches(err, CCL_ERROR, CCL_ERROR_ARGS)) {
+        /* Not supported, or pitch not aligned for this device. */
+        g_test_message("2D image from buffer not tested: %s", err->message);
+        g_clear_error(&err);
+    } else {
+        g_assert_no_error(err);
+        row_pitch = ccl_image_get_info_scalar(
+            img, CL_IMAGE_ROW_PITCH, size_t, &err);
+        g_assert_no_error(err);
+        g_assert_cmpuint(row_pitch, ==, CCL_TEST_IMAGE_WIDTH * sizeof(cl_uint));
+        region[0] = CCL_TEST_IMAGE_WIDTH / 2;
+        region[1] = CCL_TEST_IMAGE_HEIGHT;
+        ccl_image_enqueue_read(img, q, CL_TRUE, origin, region, 0, 0, himg,
+            NULL, &err);
+        g_assert_no_error(err);
+        for (cl_uint y = 0; y < CCL_TEST_IMAGE_HEIGHT; ++y)
+            for (cl_uint x = 0; x < CCL_TEST_IMAGE_WIDTH / 2; ++x)
+                g_assert_cmphex(himg[y * CCL_TEST_IMAGE_WIDTH / 2 + x], ==,
+                    hbuf[y * CCL_TEST_IMAGE_WIDTH + x]);
+        ccl_image_destroy(img);
+    }
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests image pools and image rings.
+ * */
+static void pool_ring_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLImage * img1 = NULL;
+    CCLImage * img2 = NULL;
+    CCLImageRing * ring = NULL;
+    CCLEvent * evt = NULL;
+    cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
+    CCLImageDesc img_dsc = CCL_IMAGE_DESC_BLANK;
+    cl_uint himg[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    size_t origin[3] = {0, 0, 0};
+    size_t region[3] = {CCL_TEST_IMAGE_WIDTH, CCL_TEST_IMAGE_HEIGHT, 1};
+    cl_mem mem1, mem2;
+    size_t size;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new_with_image_support(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Image description. */
+    img_dsc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    img_dsc.image_width = CCL_TEST_IMAGE_WIDTH;
+    img_dsc.image_height = CCL_TEST_IMAGE_HEIGHT;
+
+    /* Without a pool, images are not pooled. */
+    img1 = ccl_image_pool_get(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, &err);
+    g_assert_no_error(err);
+    size = ccl_memobj_get_info_scalar(img1, CL_MEM_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    ccl_image_pool_put(ctx, img1);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, 0);
+
+    /* Enable pool with room for one image. */
+    ccl_image_pool_enable(ctx, size);
+
+    /* Returned images are pooled... */
+    img1 = ccl_image_pool_get(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, &err);
+    g_assert_no_error(err);
+    mem1 = ccl_memobj_unwrap(img1);
+    ccl_image_pool_put(ctx, img1);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, size);
+
+    /* ...and reused for requests with the same description... */
+    img1 = ccl_image_pool_get(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(img1) == mem1);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, 0);
+
+    /* ...but not for requests with other dimensions. */
+    img_dsc.image_width = CCL_TEST_IMAGE_WIDTH / 2;
+    img2 = ccl_image_pool_get(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(img2) != mem1);
+    img_dsc.image_width = CCL_TEST_IMAGE_WIDTH;
+
+    /* Images beyond the high-water mark are released. */
+    ccl_image_pool_put(ctx, img1);
+    ccl_image_pool_put(ctx, img2);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, size);
+
+    /* A ring of two images reuses the pooled image... */
+    ring = ccl_image_ring_new(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, 2, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, 0);
+
+    /* ...and returns its images alternately. */
+    img1 = ccl_image_ring_next(ring, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(img1) == mem1);
+    evt = ccl_image_enqueue_read(img1, q, CL_FALSE, origin, region, 0, 0,
+        himg, NULL, &err);
+    g_assert_no_error(err);
+    img2 = ccl_image_ring_next(ring, evt, &err);
+    g_assert_no_error(err);
+    mem2 = ccl_memobj_unwrap(img2);
+    g_assert_true(mem2 != mem1);
+    evt = ccl_image_enqueue_read(img2, q, CL_FALSE, origin, region, 0, 0,
+        himg, NULL, &err);
+    g_assert_no_error(err);
+    img1 = ccl_image_ring_next(ring, evt, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(img1) == mem1);
+    img2 = ccl_image_ring_next(ring, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_unwrap(img2) == mem2);
+
+    /* Destroying the ring returns images to the pool. */
+    ccl_image_ring_destroy(ring);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, size);
+
+    /* Trim pool. */
+    g_assert_cmpuint(ccl_image_pool_trim(ctx, 0), ==, size);
+    g_assert_cmpuint(ccl_image_pool_get_size(ctx), ==, 0);
+
+    /* Destroying the context releases pooled images. */
+    ccl_image_pool_enable(ctx, 0);
+    img1 = ccl_image_pool_get(
+        ctx, CL_MEM_READ_WRITE, &image_format, &img_dsc, &err);
+    g_assert_no_error(err);
+    ccl_image_pool_put(ctx, img1);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests image pyramid generation.
+ * */
+static void pyramid_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLImage * img = NULL;
+    CCLImage * levels[3];
+    CCLEvent * evts[3];
+    CCLEventWaitList ewl = NULL;
+    cl_image_format image_format = { CL_RGBA, CL_UNSIGNED_INT8 };
+    cl_uchar himg[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT * 4];
+    cl_uchar hlvl[CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT];
+    size_t origin[3] = {0, 0, 0};
+    size_t region[3] =
+        {CCL_TEST_IMAGE_WIDTH / 2, CCL_TEST_IMAGE_HEIGHT / 2, 1};
+    size_t w = CCL_TEST_IMAGE_WIDTH;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new_with_image_support(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create a random 4-channel 8-bit image. */
+    for (cl_uint i = 0; i < CCL_TEST_IMAGE_WIDTH * CCL_TEST_IMAGE_HEIGHT * 4;
+            ++i)
+        himg[i] = (cl_uchar) g_test_rand_int();
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create base image. */
+    img = ccl_image_new(
+        ctx, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, &image_format, himg,
+        &err,
+        "image_type", (cl_mem_object_type) CL_MEM_OBJECT_IMAGE2D,
+        "image_width", (size_t) CCL_TEST_IMAGE_WIDTH,
+        "image_height", (size_t) CCL_TEST_IMAGE_HEIGHT,
+        NULL);
+    g_assert_no_error(err);
+
+    /* Generate pyramid with three levels. */
+    ccl_image_enqueue_pyramid(img, q, 3, levels, evts, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Check level sizes. */
+    for (cl_uint l = 0; l < 3; ++l) {
+        w /= 2;
+        g_assert_nonnull(evts[l]);
+        g_assert_cmpuint(ccl_image_get_info_scalar(
+            levels[l], CL_IMAGE_WIDTH, size_t, &err), ==, w);
+        g_assert_no_error(err);
+    }
+
+    /* Check that first level averages 2x2 blocks of the base image. */
+    ccl_image_enqueue_read(levels[0], q, CL_TRUE, origin, region, 0, 0,
+        hlvl, ccl_ewl(&ewl, evts[0], NULL), &err);
+    g_assert_no_error(err);
+    for (cl_uint y = 0; y < region[1]; ++y) {
+        for (cl_uint x = 0; x < region[0]; ++x) {
+            for (cl_uint c = 0; c < 4; ++c) {
+                cl_uint s = 0;
+                for (cl_uint dy = 0; dy < 2; ++dy)
+                    for (cl_uint dx = 0; dx < 2; ++dx)
+                        s += himg[((2 * y + dy) * CCL_TEST_IMAGE_WIDTH
+                            + 2 * x + dx) * 4 + c];
+                g_assert_cmpuint(hlvl[(y * region[0] + x) * 4 + c], ==,
+                    (s + 2) / 4);
+            }
+        }
+    }
+
+    /* Pyramids of non-2D images or without levels are not allowed. */
+    ccl_image_enqueue_pyramid(img, q, 0, levels, NULL, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_clear_error(&err);
+
+    /* Destroy stuff. */
+    ccl_queue_finish(q, &err);
+    g_assert_no_error(err);
+    for (cl_uint l = 0; l < 3; ++l)
+        ccl_image_destroy(levels[l]);
+    ccl_image_destroy(img);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -753,5 +1216,21 @@ int main(int argc, char ** argv) {
         "/wrappers/image/fill",
         fill_test);
 
+    g_test_add_func(
+        "/wrappers/image/staging",
+        staging_test);
+
+    g_test_add_func(
+        "/wrappers/image/from-buffer",
+        from_buffer_test);
+
+    g_test_add_func(
+        "/wrappers/image/pool-ring",
+        pool_ring_test);
+
+    g_test_add_func(
+        "/wrappers/image/pyramid",
+        pyramid_test);
+
     return g_test_run();
 }
@@ -27,6 +27,7 @@
  * */
 
 #include <cf4ocl2.h>
+#include <glib/gstdio.h>
 #include "test.h"
 
 #define CCL_TEST_KERNEL_NAME "test_krnl"
@@ -409,6 +410,144 @@ static void info_args_test() {
 
 }
 
+#define CCL_TEST_KERNEL_DESCS_NAME "test_krnl_descs"
+
+#define CCL_TEST_KERNEL_DESCS_CONTENT \
+    "__kernel void " CCL_TEST_KERNEL_DESCS_NAME "(" \
+    "	__global uint * buf,\n" \
+    "	__local float * loc,\n" \
+    "	uint4 v,\n" \
+    "	float f)\n" \
+    "{\n" \
+    "	uint gid = get_global_id(0);\n" \
+    "	loc[get_local_id(0)] = f;\n" \
+    "	buf[gid] = v.x + (uint) loc[get_local_id(0)];\n" \
+    "}\n"
+
+/**
+ * @internal
+ *
+ * @brief Tests cached kernel argument descriptors and validation of
+ * kernel arguments against them.
+ * */
+static void arg_descs_test() {
+
+#ifndef CL_VERSION_1_2
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.2 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * buf = NULL;
+    CCLErr * err = NULL;
+    const CCLKernelArgDesc * descs;
+    cl_uint num_args = 0;
+    cl_uint4 v = {{ 1, 2, 3, 4 }};
+    cl_float f = 1.0f;
+    cl_double d = 1.0;
+    cl_bool status;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(120, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create a new program from source and build it with argument info. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_KERNEL_DESCS_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, "-cl-kernel-arg-info", &err);
+    g_assert_no_error(err);
+
+    /* Get kernel wrapper and create a buffer. */
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_DESCS_NAME, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(
+        ctx, CL_MEM_READ_WRITE, 16 * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Get argument descriptors, which may not be available. */
+    descs = ccl_kernel_get_arg_descs(krnl, &num_args, &err);
+    g_assert_true((err == NULL)
+        || ((err->code == CL_KERNEL_ARG_INFO_NOT_AVAILABLE)
+            && (err->domain == CCL_OCL_ERROR)));
+    if (err != NULL) {
+        ccl_err_clear(&err);
+        goto cleanup;
+    }
+
+    /* Check descriptors. */
+    g_assert_cmpuint(num_args, ==, 4);
+    g_assert_cmphex(descs[0].address_qualifier, ==,
+        CL_KERNEL_ARG_ADDRESS_GLOBAL);
+    g_assert_cmpstr(descs[0].type_name, ==, "uint*");
+    g_assert_cmpuint(descs[0].size, ==, sizeof(cl_mem));
+    g_assert_cmphex(descs[1].address_qualifier, ==,
+        CL_KERNEL_ARG_ADDRESS_LOCAL);
+    g_assert_cmpuint(descs[1].size, ==, 0);
+    g_assert_cmphex(descs[2].address_qualifier, ==,
+        CL_KERNEL_ARG_ADDRESS_PRIVATE);
+    g_assert_cmpstr(descs[2].type_name, ==, "uint4");
+    g_assert_cmpuint(descs[2].size, ==, sizeof(cl_uint4));
+    g_assert_cmpuint(descs[3].size, ==, sizeof(cl_float));
+    if (descs[3].name != NULL)
+        g_assert_cmpstr(descs[3].name, ==, "f");
+
+    /* Descriptors are fetched only once. */
+    g_assert_true(descs == ccl_kernel_get_arg_descs(krnl, NULL, &err));
+    g_assert_no_error(err);
+
+    /* Not all arguments are set. */
+    ccl_kernel_set_args(krnl, buf, ccl_arg_local(8, cl_float), NULL);
+    status = ccl_kernel_check_args(krnl, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_false(status);
+    ccl_err_clear(&err);
+
+    /* All arguments correctly set. */
+    ccl_kernel_set_args(krnl, ccl_arg_skip, ccl_arg_skip,
+        ccl_arg_priv(v, cl_uint4), ccl_arg_priv(f, cl_float), NULL);
+    status = ccl_kernel_check_args(krnl, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Private argument with wrong size. */
+    ccl_kernel_set_arg(krnl, 3, ccl_arg_priv(d, cl_double));
+    status = ccl_kernel_check_args(krnl, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_false(status);
+    ccl_err_clear(&err);
+
+    /* Private value given for local memory argument. */
+    ccl_kernel_set_args(krnl, ccl_arg_skip, ccl_arg_priv(f, cl_float),
+        ccl_arg_skip, ccl_arg_priv(f, cl_float), NULL);
+    status = ccl_kernel_check_args(krnl, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_false(status);
+    ccl_err_clear(&err);
+
+cleanup:
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
 /**
  * @internal
  *
@@ -728,6 +867,7 @@ static void suggest_worksizes_test() {
     CCLErr * err = NULL;
     CCLProgram * prg = NULL;
     CCLKernel * krnl = NULL;
+    size_t rws, gws, lws, lws_first, sg_size, wg_size_max;
 
     /* Get the test context with the pre-defined device. */
     ctx = ccl_test_context_new(0, &err);
@@ -754,6 +894,43 @@ static void suggest_worksizes_test() {
     /* Test with non-NULL kernel. */
     suggest_worksizes_aux(dev, krnl);
 
+    /* Repeated suggestions, which use the limits kept by the kernel,
+     * should not be affected by the user limits of previous calls. */
+    rws = CCL_TEST_KERNEL_BUF_SIZE;
+    lws = 0;
+    ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, NULL, &lws, &err);
+    g_assert_no_error(err);
+    lws_first = lws;
+    lws = 1;
+    ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, NULL, &lws, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(lws, ==, 1);
+    lws = 0;
+    ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, NULL, &lws, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(lws, ==, lws_first);
+
+    /* If the subgroup size is known, suggested local work sizes should be
+     * made of full subgroups, even for a small real work size. */
+    sg_size = ccl_kernel_get_subgroup_size(krnl, dev, &err);
+    g_assert_no_error(err);
+    wg_size_max = ccl_kernel_get_workgroup_info_scalar(
+        krnl, dev, CL_KERNEL_WORK_GROUP_SIZE, size_t, &err);
+    g_assert_no_error(err);
+    if ((sg_size > 1) && (sg_size <= wg_size_max)) {
+        rws = 1 << 20;
+        lws = 0;
+        ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, &gws, &lws, &err);
+        g_assert_no_error(err);
+        g_assert_cmpuint(lws % sg_size, ==, 0);
+        rws = 3;
+        lws = 0;
+        ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws, &gws, &lws, &err);
+        g_assert_no_error(err);
+        g_assert_cmpuint(lws % sg_size, ==, 0);
+        g_assert_cmpuint(gws, >=, rws);
+    }
+
     /* Destroy program. */
     ccl_program_destroy(prg);
 
@@ -768,6 +945,198 @@ static void suggest_worksizes_test() {
 }
 
 
+/**
+ * @internal
+ *
+ * @brief Tests the ccl_kernel_tune_worksizes() function.
+ * */
+static void tune_worksizes_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLQueue * cq_noprof = NULL;
+    CCLBuffer * buf = NULL;
+    cl_bool status;
+    size_t rws = CCL_TEST_KERNEL_BUF_SIZE;
+    size_t lws, lws_tuned;
+    gchar * tmp_dir_name, * tmp_file_name, * file_contents;
+
+    /* Keep tuning cache in a temporary directory. */
+    tmp_dir_name = g_dir_make_tmp("test_kernel_XXXXXX", &err);
+    g_assert_no_error(err);
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "worksizes.ini", NULL);
+    ccl_kernel_tune_cache_set_file(tmp_file_name);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create command queues with and without profiling. */
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+    cq_noprof = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel and set its argument. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_arg(krnl, 0, buf);
+
+    /* Tuning requires a queue with profiling enabled. */
+    lws = 0;
+    status = ccl_kernel_tune_worksizes(
+        krnl, cq_noprof, 1, &rws, NULL, &lws, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_false(status);
+    ccl_err_clear(&err);
+
+    /* Tune local work size, which must be a divisor of the real work
+     * size, since no global work size is requested. */
+    lws = 0;
+    status = ccl_kernel_tune_worksizes(krnl, cq, 1, &rws, NULL, &lws, 2, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(lws, >, 0);
+    g_assert_cmpuint(rws % lws, ==, 0);
+    lws_tuned = lws;
+
+    /* Result should have been saved in the tuning cache file. */
+    g_assert_true(g_file_get_contents(
+        tmp_file_name, &file_contents, NULL, NULL));
+    g_assert_true(g_strrstr(file_contents, CCL_TEST_KERNEL_NAME));
+    g_free(file_contents);
+
+    /* Tune again after reloading cache from disk, result should be the
+     * same. */
+    ccl_kernel_tune_cache_set_file(tmp_file_name);
+    lws = 0;
+    status = ccl_kernel_tune_worksizes(krnl, cq, 1, &rws, NULL, &lws, 2, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(lws, ==, lws_tuned);
+
+    /* Restore default tuning cache file and remove temporary one. */
+    ccl_kernel_tune_cache_set_file(NULL);
+    g_unlink(tmp_file_name);
+    g_rmdir(tmp_dir_name);
+    g_free(tmp_file_name);
+    g_free(tmp_dir_name);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq_noprof);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the ccl_kernel_benchmark() and ccl_event_get_timings()
+ * functions.
+ * */
+static void benchmark_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventTimings timings;
+    CCLKernelBenchStats stats;
+    cl_bool status;
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create command queue with profiling. */
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel and set its argument. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_arg(krnl, 0, buf);
+
+    /* Profiling instants of a command are ordered. */
+    evt = ccl_kernel_enqueue_ndrange(
+        krnl, cq, 1, NULL, &gws, NULL, NULL, &err);
+    g_assert_no_error(err);
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+    status = ccl_event_get_timings(evt, &timings, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(timings.queued, <=, timings.submit);
+    g_assert_cmpuint(timings.submit, <=, timings.start);
+    g_assert_cmpuint(timings.start, <=, timings.end);
+
+    /* Benchmark kernel and check that statistics are consistent. */
+    status = ccl_kernel_benchmark(
+        krnl, cq, 1, NULL, &gws, NULL, 5, &stats, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(stats.num_runs, ==, 5);
+    g_assert_cmpuint(stats.min, <=, stats.median);
+    g_assert_cmpuint(stats.median, <=, stats.max);
+    g_assert_cmpfloat(stats.mean, >=, (double) stats.min);
+    g_assert_cmpfloat(stats.mean, <=, (double) stats.max);
+    g_assert_cmpfloat(stats.stddev, >=, 0.0);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /* ******************************************** */
 /* ********* Test kernel arguments ************ */
 /* ******************************************** */
@@ -1146,6 +1515,30 @@ static void args_test() {
             //~ himg[i].c[0] + himg[i].c[1] + himg[i].c[2] + himg[i].c[3] + to_sum,
             //~ himg[i].c[0], himg[i].c[1], himg[i].c[2], himg[i].c[3], to_sum);
 
+    /* Only update the private argument, twice with the same value,
+     * with the remaining arguments kept from the previous launch. */
+    to_sum = 7;
+    for (cl_uint n = 0; n < 2; ++n) {
+
+        if (n == 0)
+            ccl_kernel_set_arg(krnl, 4, ccl_arg_priv(to_sum, cl_uint));
+        else
+            ccl_kernel_set_arg(krnl, 4, ccl_arg_priv_stack(to_sum, cl_uint));
+        ccl_kernel_enqueue_ndrange(krnl, cq, 1, NULL, &gws, &lws, NULL, &err);
+        g_assert_no_error(err);
+
+        evt = ccl_buffer_enqueue_read(buf, cq, CL_FALSE, 0,
+            sizeof(cl_uint) * CCL_TEST_KERNEL_ARGS_BUF_SIZE, hbuf, NULL, &err);
+        g_assert_no_error(err);
+
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+        g_assert_no_error(err);
+
+        for (cl_uint i = 0; i < CCL_TEST_KERNEL_ARGS_BUF_SIZE; ++i)
+            g_assert_cmpuint(hbuf[i], ==, himg[i].c[0] + himg[i].c[1] +
+                himg[i].c[2] + himg[i].c[3] + to_sum);
+    }
+
     /* Destroy stuff. */
     ccl_sampler_destroy(smplr);
     ccl_image_destroy(img);
@@ -1176,53 +1569,52 @@ static void args_test() {
     g_assert_cmpfloat(c, ==, *((cl_char *) ccl_arg_value(arg_test)));
     ccl_arg_destroy(arg_test);
 
-    /* Confirm that memory allocated by wrappers has been properly freed. */
-    g_assert_true(ccl_wrapper_memcheck());
-}
-
-/* ******************************************** */
-/* **** Test ccl_kernel_enqueue_native() ****** */
-/* ******************************************** */
-
-#define CCL_TEST_KERNEL_NATIVE_BUF_SIZE 32
-
-/* Data structure used for for the native_test. */
-struct nk_args {
-    cl_int * buf;
-    cl_uint numel;
-};
+    /* Values larger than the inline storage. */
+    cl_ulong8 big = {{ 1, 2, 3, 4, 5, 6, 7, 8 }};
+    arg_test = ccl_arg_new(&big, sizeof(cl_ulong8));
+    g_assert_true(arg_test != NULL);
+    g_assert_cmpuint(ccl_arg_size(arg_test), ==, sizeof(cl_ulong8));
+    g_assert_cmpuint(
+        ((cl_ulong8 *) ccl_arg_value(arg_test))->s[7], ==, big.s[7]);
+    ccl_arg_destroy(arg_test);
 
-/* Native function used for the native_test. */
-static void CL_CALLBACK native_kernel(void * args) {
+    /* Arguments on the stack. */
+    CCLArgStack arg_storage;
+    arg_test = ccl_arg_init(&arg_storage, &pi, sizeof(cl_float));
+    g_assert_true(arg_test != NULL);
+    g_assert_cmpuint(ccl_arg_size(arg_test), ==, sizeof(cl_float));
+    g_assert_cmpfloat(pi, ==, *((cl_float *) ccl_arg_value(arg_test)));
+    ccl_arg_destroy(arg_test);
 
-    struct nk_args * nka = (struct nk_args *) args;
+    arg_test = ccl_arg_local_stack(64, cl_float);
+    g_assert_true(arg_test != NULL);
+    g_assert_cmpuint(ccl_arg_size(arg_test), ==, 64 * sizeof(cl_float));
+    g_assert_true(ccl_arg_value(arg_test) == NULL);
 
-    /* Perform some simple operation. */
-    for (cl_uint i = 0; i < nka->numel; ++i)
-        nka->buf[i] = nka->buf[i] + 1;
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
 }
 
 /**
  * @internal
  *
- * @brief Tests the ccl_kernel_enqueue_native() function.
+ * @brief Tests that memory objects set as kernel arguments are always
+ * sent to the driver, even if a new memory object has the same handle as
+ * a released one.
  * */
-static void native_test() {
+static void args_reuse_test() {
 
     /* Test variables. */
     CCLContext * ctx = NULL;
     CCLDevice * dev = NULL;
-    CCLBuffer * buf = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
     CCLQueue * cq = NULL;
-    CCLEvent * evt = NULL;
+    CCLBuffer * buf = NULL;
     CCLErr * err = NULL;
-    cl_int hbuf[CCL_TEST_KERNEL_NATIVE_BUF_SIZE];
-    cl_int hbuf_out[CCL_TEST_KERNEL_NATIVE_BUF_SIZE];
-    size_t bs = CCL_TEST_KERNEL_NATIVE_BUF_SIZE * sizeof(cl_int);
-    cl_device_exec_capabilities exec_cap;
-    struct nk_args args;
-    const void * args_mem_loc;
-    cl_uint i;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE;
+    size_t lws = CCL_TEST_KERNEL_LWS;
 
     /* Get the test context with the pre-defined device. */
     ctx = ccl_test_context_new(0, &err);
@@ -1232,29 +1624,668 @@ static void native_test() {
     dev = ccl_context_get_device(ctx, 0, &err);
     g_assert_no_error(err);
 
-    /* Check if the device supports the execution of native kernels. */
-    exec_cap = ccl_device_get_info_scalar(
-        dev, CL_DEVICE_EXECUTION_CAPABILITIES,
-        cl_device_exec_capabilities, &err);
-    g_assert_no_error(err);
-
-    /* If not, skip test. */
-    if (!(exec_cap & CL_EXEC_NATIVE_KERNEL)) {
-        g_test_skip("Test device doesn't support native kernels." \
-            "Native kernels test will not be performed.");
-        goto skip;
-    }
-
     /* Create a command queue. */
     cq = ccl_queue_new(ctx, dev, 0, &err);
     g_assert_no_error(err);
 
-    /* Initialize host buffer. */
-    for (i = 0; i < CCL_TEST_KERNEL_NATIVE_BUF_SIZE; ++i)
-        hbuf[i] = g_test_rand_int();
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
 
-    /* Create device buffer, copy contents from host buffer. */
-    buf = ccl_buffer_new(
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Each iteration releases the buffer of the previous one, so the
+     * OpenCL implementation may give the new buffer the same handle. */
+    for (cl_uint j = 0; j < 4; ++j) {
+
+        /* Create device buffer initialized with the iteration number. */
+        for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+            host_buf[i] = j;
+        buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, &err);
+        g_assert_no_error(err);
+
+        /* Set buffer as argument and run kernel. */
+        ccl_kernel_set_arg(krnl, 0, buf);
+        ccl_kernel_enqueue_ndrange(
+            krnl, cq, 1, NULL, &gws, &lws, NULL, &err);
+        g_assert_no_error(err);
+
+        /* Read back results and check that the kernel ran on the new
+         * buffer. */
+        ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+            CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL,
+            &err);
+        g_assert_no_error(err);
+
+        for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+            g_assert_cmpuint(host_buf[i], ==, j + 1);
+
+        /* Release buffer. */
+        ccl_queue_finish(cq, &err);
+        g_assert_no_error(err);
+        ccl_buffer_destroy(buf);
+    }
+
+    /* Destroy stuff. */
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests prepared kernel launch objects.
+ * */
+static void launch_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLLaunch * lnch = NULL;
+    CCLErr * err = NULL;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE / 2;
+    size_t lws = CCL_TEST_KERNEL_LWS / 2;
+    size_t offset;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer initialized with zeros. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = 0;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, &err);
+    g_assert_no_error(err);
+
+    /* Invalid launches should fail, and release the given arguments. */
+    lnch = ccl_launch_new(krnl, cq, 0, NULL, &gws, &lws, &err,
+        buf, ccl_arg_skip, ccl_arg_priv(gws, cl_uint), NULL);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_true(lnch == NULL);
+    ccl_err_clear(&err);
+
+    /* Prepare launch over half of the buffer. */
+    lnch = ccl_launch_new(krnl, cq, 1, NULL, &gws, &lws, &err, buf, NULL);
+    g_assert_no_error(err);
+
+    /* Launch over first half, then over second half, then again over
+     * first half. */
+    for (cl_uint i = 0; i < 3; ++i) {
+        offset = (i % 2) * gws;
+        ccl_launch_set_offset(lnch, &offset);
+        ccl_launch_enqueue(lnch, NULL, &err);
+        g_assert_no_error(err);
+    }
+
+    /* Re-binding the same buffer should work as well. */
+    ccl_launch_set_arg(lnch, 0, buf);
+    ccl_launch_set_offset(lnch, NULL);
+    ccl_launch_enqueue(lnch, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Read back results and check them. */
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err);
+    g_assert_no_error(err);
+
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, i < gws ? 3 : 1);
+
+    /* Destroy stuff. */
+    ccl_launch_destroy(lnch);
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests coalesced launches of many small invocations of a kernel.
+ * */
+static void batch_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLBatch * batch = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    cl_uint seg[2];
+    size_t lws = CCL_TEST_KERNEL_LWS;
+    const char * kernel_src =
+        "__kernel void add_seg(__global uint * data,\n"
+        "    CCL_BATCH_PARAMS(uint2)) {\n"
+        "    CCL_BATCH_PROLOGUE(launch, item);\n"
+        "    data[ccl_batch_args[launch].x + item] += ccl_batch_args[launch].y;\n"
+        "}\n";
+    const char * srcs[] = { CCL_BATCH_SRC, kernel_src };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_sources(ctx, 2, srcs, NULL, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, "add_seg", &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer initialized with zeros. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = 0;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, &err);
+    g_assert_no_error(err);
+
+    /* Invalid batches should fail. */
+    batch = ccl_batch_new(krnl, cq, 1, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_true(batch == NULL);
+    ccl_err_clear(&err);
+
+    /* Create batch. */
+    ccl_kernel_set_arg(krnl, 0, buf);
+    batch = ccl_batch_new(krnl, cq, 1, sizeof(seg), &err);
+    g_assert_no_error(err);
+
+    /* Enqueue batches of segments of increasing length, each segment
+     * adding its index plus one to its elements. Segments of the first
+     * batch cover the first half of the buffer, and of the second batch
+     * the whole buffer. */
+    for (cl_uint b = 0; b < 2; ++b) {
+        cl_uint end = (b + 1) * CCL_TEST_KERNEL_BUF_SIZE / 2;
+        seg[0] = 0;
+        for (cl_uint i = 1; seg[0] < end; ++i) {
+            cl_uint len = MIN(i, end - seg[0]);
+            seg[1] = i;
+            ccl_batch_add(batch, len, seg);
+            seg[0] += len;
+        }
+        g_assert_cmpuint(ccl_batch_get_num_launches(batch), >, 1);
+        evt = ccl_batch_enqueue(batch, &lws, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_nonnull(evt);
+        g_assert_cmpuint(ccl_batch_get_num_launches(batch), ==, 0);
+    }
+
+    /* Read back results and check them. */
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err);
+    g_assert_no_error(err);
+
+    for (cl_uint b = 0; b < 2; ++b) {
+        cl_uint end = (b + 1) * CCL_TEST_KERNEL_BUF_SIZE / 2;
+        cl_uint start = 0;
+        for (cl_uint i = 1; start < end; ++i) {
+            cl_uint len = MIN(i, end - start);
+            for (cl_uint j = start; j < start + len; ++j)
+                host_buf[j] -= i;
+            start += len;
+        }
+    }
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, 0);
+
+    /* An empty batch enqueues a marker. */
+    evt = ccl_batch_enqueue(batch, NULL, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+
+    /* Destroy stuff. */
+    ccl_batch_destroy(batch);
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests residency tracking of memory objects used as kernel
+ * arguments.
+ * */
+static void residency_test() {
+
+#ifndef CL_VERSION_1_2
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.2 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLErr * err = NULL;
+    cl_bool status;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE;
+    size_t lws = CCL_TEST_KERNEL_LWS;
+    cl_uint num_evts;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(120, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer and enable residency tracking. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+
+    status = ccl_memobj_set_residency_tracking(
+        (CCLMemObj *) buf, CL_TRUE, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Buffer was not written yet, so it is not resident anywhere. */
+    g_assert_true(ccl_memobj_get_resident_device((CCLMemObj *) buf) == NULL);
+
+    /* Writing the buffer makes it resident in the queue device. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = i;
+    ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_get_resident_device((CCLMemObj *) buf) == dev);
+
+    /* Running a kernel in the same device requires no migration. */
+    ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq, 1, NULL, &gws, &lws,
+        NULL, &err, buf, NULL);
+    g_assert_no_error(err);
+    g_assert_true(ccl_memobj_get_resident_device((CCLMemObj *) buf) == dev);
+
+    /* Read back results and check them. */
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err);
+    g_assert_no_error(err);
+
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, i + 1);
+
+    /* Writes on event-less queues have no event, so a marker is enqueued
+     * for a later migration to wait on. */
+    num_evts = ccl_queue_get_num_events(cq);
+    ccl_queue_set_eventless(cq, CL_TRUE);
+    g_assert_null(ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err));
+    g_assert_no_error(err);
+    ccl_queue_set_eventless(cq, CL_FALSE);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, num_evts + 1);
+    g_assert_true(ccl_memobj_get_resident_device((CCLMemObj *) buf) == dev);
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+
+    /* Disabling tracking forgets the resident device. */
+    status = ccl_memobj_set_residency_tracking(
+        (CCLMemObj *) buf, CL_FALSE, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_true(ccl_memobj_get_resident_device((CCLMemObj *) buf) == NULL);
+
+    /* Destroy stuff. Kernel keeps a reference to the buffer, which is
+     * released with the program. */
+    ccl_program_destroy(prg);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the ccl_kernel_enqueue_ndrange_tiled() function.
+ * */
+static void tiled_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE;
+    size_t lws = CCL_TEST_KERNEL_LWS / 2;
+    size_t tile, offset;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer initialized with zeros. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = 0;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_arg(krnl, 0, buf);
+
+    /* Tile sizes must be multiples of the local work size. */
+    tile = lws + 1;
+    evt = ccl_kernel_enqueue_ndrange_tiled(krnl, cq, 1, NULL, &gws, &lws,
+        &tile, 0, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_true(evt == NULL);
+    ccl_err_clear(&err);
+
+    /* Whole buffer in tiles of two work groups. */
+    tile = 2 * lws;
+    evt = ccl_kernel_enqueue_ndrange_tiled(krnl, cq, 1, NULL, &gws, &lws,
+        &tile, 1, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Second half of buffer in uneven tiles, without local work size,
+     * waiting on the previous launch. */
+    tile = 3;
+    offset = gws / 2;
+    gws = gws / 2;
+    evt = ccl_kernel_enqueue_ndrange_tiled(krnl, cq, 1, &offset, &gws, NULL,
+        &tile, 0, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    /* A single tile is also fine. */
+    tile = CCL_TEST_KERNEL_BUF_SIZE;
+    evt = ccl_kernel_enqueue_ndrange_tiled(krnl, cq, 1, &offset, &gws, NULL,
+        &tile, 0, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    /* Read back results and check them. */
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, i < offset ? 1 : 3);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the ccl_kernel_enqueue_ndrange_pipelined() function.
+ * */
+static void pipelined_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLQueue * cqs[3] = { NULL, NULL, NULL };
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t lws = CCL_TEST_KERNEL_LWS / 2;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create command queues. */
+    for (cl_uint i = 0; i < 3; ++i) {
+        cqs[i] = ccl_queue_new(ctx, dev, 0, &err);
+        g_assert_no_error(err);
+    }
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer and set it as kernel argument. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_arg(krnl, 0, buf);
+
+    /* Initialize host data. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = i;
+
+    /* Chunk sizes must be multiples of the local work size. */
+    evt = ccl_kernel_enqueue_ndrange_pipelined(krnl, cqs, 3, buf, host_buf,
+        sizeof(cl_uint), CCL_TEST_KERNEL_BUF_SIZE, lws + 1, &lws, NULL,
+        &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_true(evt == NULL);
+    ccl_err_clear(&err);
+
+    /* Process data in chunks of one work group, with three queues. */
+    evt = ccl_kernel_enqueue_ndrange_pipelined(krnl, cqs, 3, buf, host_buf,
+        sizeof(cl_uint), CCL_TEST_KERNEL_BUF_SIZE, lws, &lws, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, i + 1);
+
+    /* Process data again in uneven chunks, with two queues. */
+    evt = ccl_kernel_enqueue_ndrange_pipelined(krnl, cqs, 2, buf, host_buf,
+        sizeof(cl_uint), CCL_TEST_KERNEL_BUF_SIZE, 3, NULL, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, i + 2);
+
+    /* Destroy stuff. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    for (cl_uint i = 0; i < 3; ++i)
+        ccl_queue_destroy(cqs[i]);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* ******************************************** */
+/* **** Test ccl_kernel_enqueue_native() ****** */
+/* ******************************************** */
+
+#define CCL_TEST_KERNEL_NATIVE_BUF_SIZE 32
+
+/* Data structure used for for the native_test. */
+struct nk_args {
+    cl_int * buf;
+    cl_uint numel;
+};
+
+/* Native function used for the native_test. */
+static void CL_CALLBACK native_kernel(void * args) {
+
+    struct nk_args * nka = (struct nk_args *) args;
+
+    /* Perform some simple operation. */
+    for (cl_uint i = 0; i < nka->numel; ++i)
+        nka->buf[i] = nka->buf[i] + 1;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the ccl_kernel_enqueue_native() function.
+ * */
+static void native_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLBuffer * buf = NULL;
+    CCLQueue * cq = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_int hbuf[CCL_TEST_KERNEL_NATIVE_BUF_SIZE];
+    cl_int hbuf_out[CCL_TEST_KERNEL_NATIVE_BUF_SIZE];
+    size_t bs = CCL_TEST_KERNEL_NATIVE_BUF_SIZE * sizeof(cl_int);
+    cl_device_exec_capabilities exec_cap;
+    struct nk_args args;
+    const void * args_mem_loc;
+    cl_uint i;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Check if the device supports the execution of native kernels. */
+    exec_cap = ccl_device_get_info_scalar(
+        dev, CL_DEVICE_EXECUTION_CAPABILITIES,
+        cl_device_exec_capabilities, &err);
+    g_assert_no_error(err);
+
+    /* If not, skip test. */
+    if (!(exec_cap & CL_EXEC_NATIVE_KERNEL)) {
+        g_test_skip("Test device doesn't support native kernels." \
+            "Native kernels test will not be performed.");
+        goto skip;
+    }
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Initialize host buffer. */
+    for (i = 0; i < CCL_TEST_KERNEL_NATIVE_BUF_SIZE; ++i)
+        hbuf[i] = g_test_rand_int();
+
+    /* Create device buffer, copy contents from host buffer. */
+    buf = ccl_buffer_new(
         ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, bs, hbuf, &err);
     g_assert_no_error(err);
 
@@ -1306,6 +2337,102 @@ skip:
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests the multi-device dispatch module.
+ * */
+static void multi_dispatch_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * buf = NULL;
+    CCLMultiDispatch * md = NULL;
+    CCLEventWaitList * done = NULL;
+    CCLErr * err = NULL;
+    cl_uint host_buf[CCL_TEST_KERNEL_BUF_SIZE];
+    size_t gws = CCL_TEST_KERNEL_BUF_SIZE;
+    size_t lws = CCL_TEST_KERNEL_LWS;
+    size_t bad_gws = CCL_TEST_KERNEL_LWS + 1;
+    double share_total;
+    cl_uint num_devs;
+    cl_uint num_iters = 4;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+
+    /* Create device buffer initialized with zeros. */
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        host_buf[i] = 0;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, &err);
+    g_assert_no_error(err);
+    ccl_kernel_set_arg(krnl, 0, buf);
+
+    /* Create dispatcher, which initially gives equal shares to all
+     * devices in the context. */
+    md = ccl_multi_dispatch_new(ctx, &err);
+    g_assert_no_error(err);
+    num_devs = ccl_multi_dispatch_get_num_devices(md);
+    g_assert_cmpuint(num_devs, >=, 1);
+    for (cl_uint i = 0; i < num_devs; ++i) {
+        g_assert_nonnull(ccl_multi_dispatch_get_queue(md, i));
+        g_assert_cmpfloat(
+            ccl_multi_dispatch_get_share(md, i), ==, 1.0 / num_devs);
+    }
+
+    /* Global work size must be a multiple of local work size. */
+    done = ccl_multi_dispatch_enqueue_ndrange(
+        md, krnl, 1, NULL, &bad_gws, &lws, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(done);
+    ccl_err_clear(&err);
+
+    /* Dispatch several times, waiting for each dispatch to complete so
+     * that shares are updated with its profiling information. */
+    for (cl_uint iter = 0; iter < num_iters; ++iter) {
+        done = ccl_multi_dispatch_enqueue_ndrange(
+            md, krnl, 1, NULL, &gws, &lws, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_nonnull(done);
+        ccl_event_wait(done, &err);
+        g_assert_no_error(err);
+        share_total = 0;
+        for (cl_uint i = 0; i < num_devs; ++i)
+            share_total += ccl_multi_dispatch_get_share(md, i);
+        g_assert_cmpfloat(ABS(share_total - 1.0), <, 1e-9);
+    }
+
+    /* Read back results and check that each work-item ran once per
+     * dispatch. */
+    ccl_buffer_enqueue_read(buf, ccl_multi_dispatch_get_queue(md, 0), CL_TRUE,
+        0, CCL_TEST_KERNEL_BUF_SIZE * sizeof(cl_uint), host_buf, NULL, &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_KERNEL_BUF_SIZE; ++i)
+        g_assert_cmpuint(host_buf[i], ==, num_iters);
+
+    /* Destroy stuff. */
+    ccl_multi_dispatch_destroy(md);
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -1330,6 +2457,10 @@ int main(int argc, char ** argv) {
         "/wrappers/kernel/info-args",
         info_args_test);
 
+    g_test_add_func(
+        "/wrappers/kernel/arg-descs",
+        arg_descs_test);
+
     g_test_add_func(
         "/wrappers/kernel/ref-unref",
         ref_unref_test);
@@ -1338,13 +2469,49 @@ int main(int argc, char ** argv) {
         "/wrappers/kernel/suggest-worksizes",
         suggest_worksizes_test);
 
+    g_test_add_func(
+        "/wrappers/kernel/tune-worksizes",
+        tune_worksizes_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/benchmark",
+        benchmark_test);
+
     g_test_add_func(
         "/wrappers/kernel/args",
         args_test);
 
+    g_test_add_func(
+        "/wrappers/kernel/args-reuse",
+        args_reuse_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/launch",
+        launch_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/batch",
+        batch_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/residency",
+        residency_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/tiled",
+        tiled_test);
+
+    g_test_add_func(
+        "/wrappers/kernel/pipelined",
+        pipelined_test);
+
     g_test_add_func(
         "/wrappers/kernel/native",
         native_test);
 
+    g_test_add_func(
+        "/wrappers/kernel/multi-dispatch",
+        multi_dispatch_test);
+
     return g_test_run();
 }
@@ -707,6 +707,101 @@ static void ref_unref_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests that platforms and devices obtained from the discovery
+ * snapshot are consistent before and after a refresh.
+ * */
+static void snapshot_refresh_test() {
+
+    CCLPlatforms * platfs = NULL;
+    CCLDevSelDevices devs = NULL;
+    CCLErr * err = NULL;
+    cl_uint num_platfs;
+    guint num_devs;
+    cl_bool status;
+
+    /* Get platforms and devices, building the snapshot if required. */
+    platfs = ccl_platforms_new(&err);
+    g_assert_no_error(err);
+    num_platfs = ccl_platforms_count(platfs);
+    ccl_platforms_destroy(platfs);
+
+    devs = ccl_devsel_devices_new(&err);
+    g_assert_no_error(err);
+    num_devs = devs->len;
+    g_assert_cmpuint(num_devs, >, 0);
+    ccl_devsel_devices_destroy(devs);
+
+    /* Enumerate platforms and devices again. */
+    status = ccl_platforms_refresh(&err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* The same platforms and devices are found. */
+    platfs = ccl_platforms_new(&err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_platforms_count(platfs), ==, num_platfs);
+
+    devs = ccl_devsel_devices_new(&err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(devs->len, ==, num_devs);
+
+    ccl_devsel_devices_destroy(devs);
+    ccl_platforms_destroy(platfs);
+
+    /* The snapshot does not keep wrappers alive. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+#ifdef CCL_OCL_DLOPEN
+
+/**
+ * @internal
+ *
+ * @brief Tests that platform and device queries report a missing OpenCL
+ * library with the ::CCL_ERROR_OPENCL_UNAVAILABLE error. The OpenCL library
+ * is only opened once per process, so the queries are performed in a
+ * subprocess.
+ * */
+static void opencl_unavailable_test() {
+
+    CCLPlatforms * platfs = NULL;
+    CCLDevSelDevices devs = NULL;
+    CCLErr * err = NULL;
+
+    if (g_test_subprocess()) {
+
+        /* Point the library to a non-existing OpenCL library. */
+        g_setenv("CCL_OPENCL_LIBRARY", "/nonexistent", TRUE);
+
+        /* Platform query fails with the expected error. */
+        platfs = ccl_platforms_new(&err);
+        g_assert_error(err, CCL_ERROR, CCL_ERROR_OPENCL_UNAVAILABLE);
+        g_assert_null(platfs);
+        ccl_err_clear(&err);
+
+        /* So does device query. */
+        devs = ccl_devsel_devices_new(&err);
+        g_assert_error(err, CCL_ERROR, CCL_ERROR_OPENCL_UNAVAILABLE);
+        g_assert_null(devs);
+        ccl_err_clear(&err);
+
+        /* Confirm that memory allocated by wrappers has been properly
+         * freed. */
+        g_assert_true(ccl_wrapper_memcheck());
+
+        return;
+    }
+
+    /* Run the queries in a subprocess, which must not crash. */
+    g_test_trap_subprocess(NULL, 0, 0);
+    g_test_trap_assert_passed();
+}
+
+#endif
+
 /**
  * @internal
  *
@@ -727,5 +822,15 @@ int main(int argc, char ** argv) {
         "/wrappers/platforms/ref-unref",
         ref_unref_test);
 
+    g_test_add_func(
+        "/wrappers/platforms/snapshot-refresh",
+        snapshot_refresh_test);
+
+#ifdef CCL_OCL_DLOPEN
+    g_test_add_func(
+        "/wrappers/platforms/opencl-unavailable",
+        opencl_unavailable_test);
+#endif
+
     return g_test_run();
 }
@@ -290,6 +290,18 @@ static void features_test() {
         /* Just check that the event names are ordered properly. */
         g_assert_cmpstr(agg->event_name, <=, prev_name);
         prev_name = agg->event_name;
+
+        /* Each event name was given to a single event, so duration
+         * statistics must match its absolute time. */
+        g_assert_cmpuint(agg->count, <=, 1);
+        if (agg->count == 1) {
+            g_assert_cmpuint(agg->min_time, ==, agg->absolute_time);
+            g_assert_cmpuint(agg->max_time, ==, agg->absolute_time);
+            g_assert_cmpfloat(agg->mean_time, ==, agg->absolute_time);
+            g_assert_cmpfloat(agg->std_time, ==, 0.0);
+            g_assert_cmpuint(agg->p50_time, ==, agg->absolute_time);
+            g_assert_cmpuint(agg->p999_time, ==, agg->absolute_time);
+        }
     }
 
     /* **************** */
@@ -352,6 +364,36 @@ static void features_test() {
         }
     }
 
+    /* **************** */
+    /* Test utilization */
+    /* **************** */
+
+    const CCLProfUtil * util_q1, * util_q2, * util_dev;
+    util_q1 = ccl_prof_get_queue_util(prof, "Q1");
+    util_q2 = ccl_prof_get_queue_util(prof, "Q2");
+    util_dev = ccl_prof_get_device_util(prof, dev);
+    g_assert_nonnull(util_q1);
+    g_assert_nonnull(util_q2);
+    g_assert_nonnull(util_dev);
+    g_assert_null(ccl_prof_get_queue_util(prof, "Q3"));
+    g_assert_cmpstr(util_q1->name, ==, "Q1");
+
+    /* Busy and idle times must add up to the span, idle time can't be
+     * shorter than the longest gap or than the host lag. */
+    g_assert_cmpuint(util_q1->busy_time + util_q1->idle_time, ==,
+        util_q1->span);
+    g_assert_cmpuint(util_q1->max_gap, <=, util_q1->idle_time);
+    g_assert_cmpuint(util_q1->host_lag_time, <=, util_q1->idle_time);
+    g_assert_cmpuint(util_dev->busy_time + util_dev->idle_time, ==,
+        util_dev->span);
+
+    /* Both queues are on the same device, so the device is busy at least
+     * while each queue is busy, and at most while any queue is busy. */
+    g_assert_cmpuint(util_dev->busy_time, >=,
+        MAX(util_q1->busy_time, util_q2->busy_time));
+    g_assert_cmpuint(util_dev->busy_time, <=,
+        util_q1->busy_time + util_q2->busy_time);
+
     /* ******************* */
     /* Test export options */
     /* ******************* */
@@ -386,6 +428,56 @@ static void features_test() {
     g_assert_true(g_strrstr(file_contents, "Event3"));
     g_assert_true(g_strrstr(file_contents, "Event4"));
     g_free(file_contents);
+    g_free(tmp_file_name);
+
+    /* Export a trace. */
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "trace.json", NULL);
+
+    export_status = ccl_prof_export_trace_file(prof, tmp_file_name, &err);
+    g_assert_no_error(err);
+    g_assert_true(export_status);
+
+    /* Test if trace file was correctly written. */
+    read_flag = g_file_get_contents(
+        tmp_file_name, &file_contents, NULL, NULL);
+    g_assert_true(read_flag);
+    g_assert_true(g_str_has_prefix(file_contents, "{\"traceEvents\":["));
+    g_assert_true(g_strrstr(file_contents, "\"Event1\""));
+    g_assert_true(g_strrstr(file_contents, "\"Event4\""));
+    g_assert_true(g_strrstr(file_contents, "\"thread_name\""));
+    g_free(file_contents);
+    g_free(tmp_file_name);
+
+    /* Export profiling info in binary format and read it back. */
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "export.bin", NULL);
+
+    export_status = ccl_prof_export_binary_file(prof, tmp_file_name, &err);
+    g_assert_no_error(err);
+    g_assert_true(export_status);
+
+    CCLProfFile * pfile = ccl_prof_file_open(tmp_file_name, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_prof_file_get_num_events(pfile), ==, 4);
+
+    /* Check that event info read back matches the profiler's. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_NAME_EVENT | CCL_PROF_SORT_DESC);
+    ccl_prof_file_iter_info_init(
+        pfile, CCL_PROF_INFO_SORT_NAME_EVENT | CCL_PROF_SORT_DESC);
+    while ((info = ccl_prof_iter_info_next(prof)) != NULL) {
+        const CCLProfInfo * pfi = ccl_prof_file_iter_info_next(pfile);
+        g_assert_nonnull(pfi);
+        g_assert_cmpstr(pfi->event_name, ==, info->event_name);
+        g_assert_cmpstr(pfi->queue_name, ==, info->queue_name);
+        g_assert_cmphex(pfi->command_type, ==, info->command_type);
+        g_assert_cmpuint(pfi->t_start, ==, info->t_start);
+        g_assert_cmpuint(pfi->t_end, ==, info->t_end);
+    }
+    g_assert_null(ccl_prof_file_iter_info_next(pfile));
+    ccl_prof_file_close(pfile);
+
     g_free(tmp_dir_name);
     g_free(tmp_file_name);
 
@@ -421,6 +513,984 @@ static void features_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests incremental profiling, where terminated events are drained
+ * from the queues before performing the profiling calculations.
+ * */
+static void incremental_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * q1, * q2;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfAgg * agg;
+    cl_bool status;
+    FILE * fp;
+    char metrics[16384];
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    q1 = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+    q2 = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object and add queues for profiling. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q1", q1);
+    ccl_prof_add_queue(prof, "Q2", q2);
+
+    /* Write to buffer and wait for write to finish. */
+    evt = ccl_buffer_enqueue_write(buf, q1, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_set_name(evt, "Event1");
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    /* Drain terminated events, which should be released from the
+     * queue. */
+    status = ccl_prof_drain(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(ccl_queue_get_num_events(q1), ==, 0);
+
+    /* Live metrics should be available for the drained event. */
+    fp = tmpfile();
+    g_assert_nonnull(fp);
+    status = ccl_prof_export_metrics(prof, fp, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    rewind(fp);
+    metrics[fread(metrics, 1, sizeof(metrics) - 1, fp)] = '\0';
+    fclose(fp);
+    g_assert_nonnull(
+        g_strstr_len(metrics, -1, "ccl_prof_events_total{event=\"Event1\"} 1"));
+    g_assert_nonnull(g_strstr_len(metrics, -1, "{queue=\"Q1\"}"));
+    g_assert_true(g_str_has_suffix(metrics, "# EOF\n"));
+
+    /* Read twice from buffer using the other queue, and wait for reads
+     * to finish. */
+    for (guint i = 0; i < 2; ++i) {
+        evt = ccl_buffer_enqueue_read(buf, q2, CL_FALSE, 0,
+            sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_set_name(evt, "Event2");
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+        g_assert_no_error(err);
+    }
+
+    /* Perform profiling calculations, which drains remaining events. */
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(ccl_queue_get_num_events(q2), ==, 0);
+
+    /* Aggregate statistics should be available for both events. */
+    agg = ccl_prof_get_agg(prof, "Event1");
+    g_assert_true(agg != NULL);
+    agg = ccl_prof_get_agg(prof, "Event2");
+    g_assert_true(agg != NULL);
+    g_assert_cmpuint(ccl_prof_get_eff_duration(prof), <=,
+        ccl_prof_get_duration(prof));
+
+    /* Iterating over aggregate statistics reorders them, which should
+     * not mix up the metrics of different events. */
+    ccl_prof_iter_agg_init(prof, CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_DESC);
+    agg = ccl_prof_iter_agg_next(prof);
+    g_assert_cmpstr(agg->event_name, ==, "Event2");
+    fp = tmpfile();
+    g_assert_nonnull(fp);
+    status = ccl_prof_export_metrics(prof, fp, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    rewind(fp);
+    metrics[fread(metrics, 1, sizeof(metrics) - 1, fp)] = '\0';
+    fclose(fp);
+    g_assert_nonnull(
+        g_strstr_len(metrics, -1, "ccl_prof_events_total{event=\"Event1\"} 1"));
+    g_assert_nonnull(
+        g_strstr_len(metrics, -1, "ccl_prof_events_total{event=\"Event2\"} 2"));
+    g_assert_nonnull(g_strstr_len(metrics, -1,
+        "ccl_prof_event_duration_nanoseconds_count{event=\"Event1\"} 1"));
+    g_assert_nonnull(g_strstr_len(metrics, -1,
+        "ccl_prof_event_duration_nanoseconds_count{event=\"Event2\"} 2"));
+
+    /* Individual event information should not be kept. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    g_assert_null(ccl_prof_iter_info_next(prof));
+
+    /* Neither is utilization, which is determined from it. */
+    g_assert_null(ccl_prof_get_queue_util(prof, "Q1"));
+    g_assert_null(ccl_prof_get_device_util(prof, dev));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(q2);
+    ccl_queue_destroy(q1);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the profiler sampling mode.
+ * */
+static void sampling_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfAgg * agg;
+    cl_uint num_infos = 0;
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object which samples one in every two events. */
+    prof = ccl_prof_new();
+    ccl_prof_set_sampling(prof, 2, 0, 0);
+
+    /* Write to buffer five times and wait for writes to finish. */
+    for (guint i = 0; i < 5; ++i) {
+        evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+            sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_set_name(evt, "Write");
+    }
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+
+    /* Perform profiling calculations. */
+    ccl_prof_add_queue(prof, "Q", cq);
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Only the first, third and fifth events should have been kept. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    while (ccl_prof_iter_info_next(prof) != NULL)
+        num_infos++;
+    g_assert_cmpuint(num_infos, ==, 3);
+
+    /* Aggregate count should be scaled to all events. */
+    agg = ccl_prof_get_agg(prof, "Write");
+    g_assert_true(agg != NULL);
+    g_assert_cmpuint(agg->count, <=, 5);
+    g_assert_cmpuint(ccl_prof_get_eff_duration(prof), <=,
+        ccl_prof_get_duration(prof));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Fake performance counters, where the bytes counter is the size of
+ * buffer transfers and the occupancy is constant.
+ * */
+static cl_bool counters_fake(CCLEvent * evt, cl_command_type command_type,
+    double * values, void * user_data) {
+
+    CCL_UNUSED(evt);
+
+    /* Count calls. */
+    (*((cl_uint *) user_data))++;
+
+    /* Only buffer writes have counters. */
+    if (command_type != CL_COMMAND_WRITE_BUFFER) return CL_FALSE;
+
+    values[0] = sizeof(cl_int) * CCL_TEST_MAXBUF;
+    values[1] = 0.5;
+    values[2] = 1;
+    return CL_TRUE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests collection of performance counters and derived metrics.
+ * */
+static void counters_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfAgg * agg;
+    const char * names[] = { CCL_PROF_COUNTER_BYTES,
+        CCL_PROF_COUNTER_OCCUPANCY, "other" };
+    cl_uint num_calls = 0;
+    FILE * fp;
+    char metrics[8192];
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object which collects fake counters. */
+    prof = ccl_prof_new();
+    ccl_prof_set_counters(prof, 3, names, counters_fake, &num_calls);
+
+    /* Write to and read from buffer. */
+    for (guint i = 0; i < 3; ++i) {
+        evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+            sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_set_name(evt, "Write");
+    }
+    evt = ccl_buffer_enqueue_read(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_set_name(evt, "Read");
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+
+    /* Perform profiling calculations. */
+    ccl_prof_add_queue(prof, "Q", cq);
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* The function is only called for events with duration. */
+    g_assert_cmpuint(num_calls, <=, 4);
+
+    /* Counters of writes with duration should have been summed, and
+     * metrics derived from them. */
+    agg = ccl_prof_get_agg(prof, "Write");
+    g_assert_true(agg != NULL);
+    if (agg->count > 0) {
+        g_assert_true(agg->counters != NULL);
+        g_assert_cmpfloat(agg->counters[0], ==,
+            agg->counters[2] * sizeof(cl_int) * CCL_TEST_MAXBUF);
+        g_assert_cmpfloat(agg->bandwidth, >, 0);
+        g_assert_cmpfloat(ABS(agg->occupancy - 0.5), <, 1e-9);
+    }
+
+    /* Reads have no counters. */
+    agg = ccl_prof_get_agg(prof, "Read");
+    g_assert_true(agg != NULL);
+    g_assert_true(agg->counters == NULL);
+    g_assert_cmpfloat(agg->bandwidth, ==, 0);
+
+    /* Summary should show derived metrics. */
+    g_assert_true(g_strrstr(ccl_prof_get_summary(prof,
+        CCL_PROF_AGG_SORT_NAME, CCL_PROF_OVERLAP_SORT_NAME),
+        "Derived metrics") != NULL);
+
+    /* Exported metrics should include counters. */
+    fp = tmpfile();
+    g_assert_nonnull(fp);
+    status = ccl_prof_export_metrics(prof, fp, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    rewind(fp);
+    metrics[fread(metrics, 1, sizeof(metrics) - 1, fp)] = '\0';
+    fclose(fp);
+    g_assert_nonnull(g_strstr_len(metrics, -1,
+        "# TYPE ccl_prof_event_occupancy_ratio gauge"));
+    g_assert_null(g_strstr_len(metrics, -1,
+        "ccl_prof_event_counter_total{event=\"Read\""));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests keeping the slowest instances of each event name.
+ * */
+static void slowest_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfSlow * slow;
+    cl_uint num_slow;
+    gchar tag[8];
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object which keeps the two slowest instances of each
+     * event name, and which drains events. */
+    prof = ccl_prof_new();
+    ccl_prof_set_slowest(prof, 2);
+    ccl_prof_add_queue(prof, "Q", cq);
+
+    /* Write to buffer five times, tagging each write. */
+    for (guint i = 0; i < 5; ++i) {
+        evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+            sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_set_name(evt, "Write");
+        g_snprintf(tag, sizeof(tag), "w%u", i);
+        ccl_event_set_tag(evt, tag);
+        g_assert_cmpstr(ccl_event_get_tag(evt), ==, tag);
+    }
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+
+    /* Drain events, after which the slowest instances should be
+     * available. */
+    status = ccl_prof_drain(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    slow = ccl_prof_get_slowest(prof, "Write", &num_slow);
+    g_assert_cmpuint(num_slow, <=, 2);
+    for (cl_uint i = 0; i < num_slow; ++i) {
+        g_assert_cmpstr(slow[i].info.event_name, ==, "Write");
+        g_assert_cmpstr(slow[i].info.queue_name, ==, "Q");
+        g_assert_true(g_str_has_prefix(slow[i].tag, "w"));
+        if (i > 0)
+            g_assert_cmpuint(slow[i].info.t_end - slow[i].info.t_start,
+                <=, slow[i - 1].info.t_end - slow[i - 1].info.t_start);
+    }
+
+    /* No instances are kept for unknown names. */
+    g_assert_null(ccl_prof_get_slowest(prof, "Unknown", &num_slow));
+    g_assert_cmpuint(num_slow, ==, 0);
+
+    /* Slowest instances should be kept after calculations, and shown in
+     * the summary. */
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    slow = ccl_prof_get_slowest(prof, "Write", &num_slow);
+    g_assert_cmpuint(num_slow, <=, 2);
+    g_assert_nonnull(g_strrstr(ccl_prof_get_summary(prof,
+        CCL_PROF_AGG_SORT_NAME, CCL_PROF_OVERLAP_SORT_NAME),
+        "Slowest event instances"));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests synchronization of device clocks with the host.
+ * */
+static void sync_clocks_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfInfo * info;
+    gint64 host_before, host_after;
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object, add queue and synchronize clocks. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q", cq);
+    status = ccl_prof_sync_clocks(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Write to buffer, timing it on the host. */
+    host_before = g_get_monotonic_time();
+    evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    host_after = g_get_monotonic_time();
+
+    /* Perform profiling calculations. */
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Event instants should be in the host timebase, allowing for a
+     * generous estimation error of one second. */
+    ccl_prof_iter_info_init(
+        prof, CCL_PROF_INFO_SORT_T_START | CCL_PROF_SORT_ASC);
+    info = ccl_prof_iter_info_next(prof);
+    g_assert_nonnull(info);
+    g_assert_cmpint((gint64) info->t_start, >, host_before * 1000 - 1000000000);
+    g_assert_cmpint((gint64) info->t_end, <, host_after * 1000 + 1000000000);
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests critical-path and slack analysis over recorded command
+ * dependencies.
+ * */
+static void critical_path_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq1, * cq2;
+    CCLBuffer * buf;
+    CCLEvent * evt_w, * evt_r;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfSlack * slk;
+    cl_uint num_slacks = 0, num_critical = 0;
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq1 = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    cq2 = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Record dependencies given by event wait lists. */
+    ccl_queue_set_record_deps(cq1, CL_TRUE);
+    ccl_queue_set_record_deps(cq2, CL_TRUE);
+
+    /* Write to buffer in one queue, and read it back in the other queue
+     * after the write terminates. */
+    evt_w = ccl_buffer_enqueue_write(buf, cq1, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    evt_r = ccl_buffer_enqueue_read(buf, cq2, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf,
+        ccl_ewl(&ewl, evt_w, NULL), &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt_r, NULL), &err);
+    g_assert_no_error(err);
+
+    /* Profile both queues. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q1", cq1);
+    ccl_prof_add_queue(prof, "Q2", cq2);
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* The read depends on the write, so both commands should be on the
+     * critical path. */
+    ccl_prof_iter_slack_init(
+        prof, CCL_PROF_SLACK_SORT_SLACK | CCL_PROF_SORT_ASC);
+    while ((slk = ccl_prof_iter_slack_next(prof)) != NULL) {
+        g_assert_nonnull(slk->event_name);
+        g_assert_nonnull(slk->queue_name);
+        num_slacks++;
+        if (slk->slack == 0) num_critical++;
+    }
+    g_assert_cmpuint(num_slacks, ==, 2);
+    g_assert_cmpuint(num_critical, ==, 2);
+
+    /* The critical path can't take longer than all events together. */
+    g_assert_cmpuint(ccl_prof_get_critical_duration(prof), <=,
+        ccl_prof_get_duration(prof));
+
+    /* Summary should include the critical path. */
+    g_assert_nonnull(g_strstr_len(ccl_prof_get_summary(prof,
+        CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC,
+        CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC),
+        -1, "Critical path"));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq2);
+    ccl_queue_destroy(cq1);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests attribution of events to host-side ranges.
+ * */
+static void ranges_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfRange * rng;
+    cl_uint num_ranges = 0;
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create profile object, add queue and synchronize clocks. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q", cq);
+    status = ccl_prof_sync_clocks(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Write to buffer in a "write" range nested in a "frame" range, and
+     * then read it back in the "frame" range, leaving it open. */
+    ccl_prof_range_push(prof, "frame");
+    ccl_prof_range_push(prof, "write");
+    evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    ccl_prof_range_pop(prof);
+    evt = ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Perform profiling calculations, which close the "frame" range. */
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Check ranges, allowing for clock estimation errors of one second,
+     * in which case events may be attributed to no range at all. */
+    ccl_prof_iter_range_init(
+        prof, CCL_PROF_RANGE_SORT_T_START | CCL_PROF_SORT_ASC);
+    while ((rng = ccl_prof_iter_range_next(prof)) != NULL) {
+        g_assert_cmpuint(rng->t_end, >=, rng->t_start);
+        if (num_ranges == 0) {
+            g_assert_cmpstr(rng->name, ==, "frame");
+            g_assert_cmpuint(rng->depth, ==, 0);
+            g_assert_cmpuint(rng->num_events, <=, 2);
+        } else {
+            g_assert_cmpstr(rng->name, ==, "write");
+            g_assert_cmpuint(rng->depth, ==, 1);
+            g_assert_cmpuint(rng->num_events, <=, 1);
+        }
+        num_ranges++;
+    }
+    g_assert_cmpuint(num_ranges, ==, 2);
+
+    /* Summary should show host-side ranges. */
+    g_assert_nonnull(strstr(ccl_prof_get_summary(prof,
+        CCL_PROF_AGG_SORT_TIME | CCL_PROF_SORT_DESC,
+        CCL_PROF_OVERLAP_SORT_DURATION | CCL_PROF_SORT_DESC),
+        "Host ranges"));
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests host-side tracing of wrapper calls.
+ * */
+static void host_trace_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    const CCLProfAgg * agg;
+    cl_bool status;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Enable host-side tracing, discarding previous timings. */
+    ccl_prof_host_trace_reset();
+    ccl_prof_host_trace_enable(CL_TRUE);
+
+    /* Create profile object and add queue. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q", cq);
+
+    /* Write to buffer and wait for it. */
+    evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    /* Disable host-side tracing. */
+    ccl_prof_host_trace_enable(CL_FALSE);
+
+    /* Perform profiling calculations. */
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* If the library was compiled with host-side tracing, the write and
+     * the wait should have been timed once each; otherwise, there should
+     * be no host-side calls. */
+    ccl_prof_iter_host_init(prof, CCL_PROF_AGG_SORT_NAME | CCL_PROF_SORT_ASC);
+    while ((agg = ccl_prof_iter_host_next(prof)) != NULL) {
+        g_assert_cmpuint(agg->count, ==, 1);
+        g_assert_cmpuint(agg->min_time, <=, agg->max_time);
+        g_assert_true(
+            (g_strcmp0(agg->event_name, "ccl_buffer_enqueue_write") == 0)
+            || (g_strcmp0(agg->event_name, "ccl_event_wait_full") == 0));
+    }
+
+    /* Discard timings. */
+    ccl_prof_host_trace_reset();
+
+    /* Free wrappers. */
+    ccl_prof_destroy(prof);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the background profile writer, with records streamed
+ * while events are drained and exported after calculations.
+ * */
+static void writer_test() {
+
+    /* Aux vars. */
+    CCLContext * ctx;
+    CCLDevice * dev;
+    CCLQueue * cq;
+    CCLBuffer * buf;
+    CCLEvent * evt;
+    CCLEventWaitList ewl = NULL;
+    CCLProf * prof;
+    CCLProfWriter * writer;
+    CCLFuture * fut;
+    CCLErr * err = NULL;
+    cl_int h_buf[CCL_TEST_MAXBUF];
+    cl_bool status;
+    gchar * tmp_dir_name, * tmp_file_name, * file_contents;
+    gboolean read_flag;
+    CCLProfExportOptions export_options;
+
+    /* Put random stuff in host buffer. */
+    for (guint i = 0; i < CCL_TEST_MAXBUF; ++i)
+        h_buf[i] = g_test_rand_int();
+
+    /* Create OpenCL wrappers for testing. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+    g_assert_no_error(err);
+
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create writer for streamed records. */
+    tmp_dir_name = g_dir_make_tmp("test_profiler_XXXXXX", &err);
+    g_assert_no_error(err);
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "stream.tsv", NULL);
+    writer = ccl_prof_writer_new(tmp_file_name, CL_FALSE, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(writer);
+
+    /* Create profile object which streams drained events to writer. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q1", cq);
+    ccl_prof_set_writer(prof, writer);
+
+    /* Write to buffer, wait for write to finish and drain it. */
+    evt = ccl_buffer_enqueue_write(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_set_name(evt, "Event1");
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    status = ccl_prof_drain(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Read from buffer, and let calculations drain it. */
+    evt = ccl_buffer_enqueue_read(buf, cq, CL_FALSE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_set_name(evt, "Event2");
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    ccl_prof_destroy(prof);
+
+    /* Wait for writer to complete. */
+    fut = ccl_prof_writer_finish(writer);
+    g_assert_nonnull(fut);
+    g_assert_cmpint(ccl_future_wait(fut), ==, CL_COMPLETE);
+    ccl_future_destroy(fut);
+    status = ccl_prof_writer_destroy(writer, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Both events should have been written. */
+    read_flag = g_file_get_contents(
+        tmp_file_name, &file_contents, NULL, NULL);
+    g_assert_true(read_flag);
+    g_assert_true(g_str_has_prefix(file_contents, "Q1\t"));
+    g_assert_true(g_strrstr(file_contents, "\tEvent1\n"));
+    g_assert_true(g_strrstr(file_contents, "\tEvent2\n"));
+    g_free(file_contents);
+    g_free(tmp_file_name);
+
+    /* Create writer for records exported after calculations, starting
+     * at instant 0. */
+    export_options = ccl_prof_get_export_opts();
+    export_options.zero_start = CL_TRUE;
+    ccl_prof_set_export_opts(export_options);
+    tmp_file_name = g_strconcat(
+        tmp_dir_name, G_DIR_SEPARATOR_S, "export.tsv", NULL);
+    writer = ccl_prof_writer_new(tmp_file_name, CL_FALSE, &err);
+    g_assert_no_error(err);
+
+    /* Profile a write to buffer and export it. */
+    prof = ccl_prof_new();
+    evt = ccl_buffer_enqueue_write(buf, cq, CL_TRUE, 0,
+        sizeof(cl_int) * CCL_TEST_MAXBUF, h_buf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_set_name(evt, "Event3");
+    ccl_prof_add_queue(prof, "Q1", cq);
+    status = ccl_prof_calc(prof, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    ccl_prof_export_info_async(prof, writer);
+
+    /* Profile object can be destroyed before records are written, and
+     * the writer can be destroyed without explicitly finishing it. */
+    ccl_prof_destroy(prof);
+    status = ccl_prof_writer_destroy(writer, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Event should have been written with zero start. */
+    read_flag = g_file_get_contents(
+        tmp_file_name, &file_contents, NULL, NULL);
+    g_assert_true(read_flag);
+    g_assert_true(g_str_has_prefix(file_contents, "Q1\t0\t"));
+    g_assert_true(g_str_has_suffix(file_contents, "\tEvent3\n"));
+    g_free(file_contents);
+    g_free(tmp_file_name);
+    g_free(tmp_dir_name);
+
+    /* Free wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -435,6 +1505,15 @@ int main(int argc, char ** argv) {
 
     g_test_add_func("/profiler/create-add-destroy", create_add_destroy_test);
     g_test_add_func("/profiler/features", features_test);
+    g_test_add_func("/profiler/incremental", incremental_test);
+    g_test_add_func("/profiler/sampling", sampling_test);
+    g_test_add_func("/profiler/counters", counters_test);
+    g_test_add_func("/profiler/slowest", slowest_test);
+    g_test_add_func("/profiler/writer", writer_test);
+    g_test_add_func("/profiler/sync-clocks", sync_clocks_test);
+    g_test_add_func("/profiler/critical-path", critical_path_test);
+    g_test_add_func("/profiler/ranges", ranges_test);
+    g_test_add_func("/profiler/host-trace", host_trace_test);
 
     return g_test_run();
 
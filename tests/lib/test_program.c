@@ -58,6 +58,11 @@ static void create_info_destroy_test() {
     CCLErr * err = NULL;
     gchar * tmp_dir_name;
     gchar * tmp_file_prefix;
+    gchar * fd_file_name = NULL;
+    gchar * contents_file = NULL;
+    gchar * contents_fd = NULL;
+    gsize len_file, len_fd;
+    gint fd;
     const char * build_log;
     cl_device_id * devices = NULL;
     cl_context context = NULL;
@@ -406,6 +411,27 @@ static void create_info_destroy_test() {
     ccl_program_save_binary(prg, d, tmp_file_prefix, &err);
     g_assert_no_error(err);
 
+    /* Write the same binary to a file descriptor, contents should be
+     * equal to those of the saved file. */
+    fd = g_file_open_tmp("test_prg_XXXXXX.bin", &fd_file_name, &err);
+    g_assert_no_error(err);
+    ccl_program_write_binary(prg, d, fd, &err);
+    g_assert_no_error(err);
+    g_close(fd, &err);
+    g_assert_no_error(err);
+
+    g_file_get_contents(tmp_file_prefix, &contents_file, &len_file, &err);
+    g_assert_no_error(err);
+    g_file_get_contents(fd_file_name, &contents_fd, &len_fd, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(len_file, ==, len_fd);
+    g_assert_true(memcmp(contents_file, contents_fd, len_fd) == 0);
+
+    g_unlink(fd_file_name);
+    g_free(fd_file_name);
+    g_free(contents_file);
+    g_free(contents_fd);
+
     /* Save all binaries without keeping the filenames and an empty suffix
      * (these will be discarded, just test the function). */
     ccl_program_save_all_binaries(prg, tmp_file_prefix, "", NULL, &err);
@@ -539,6 +565,16 @@ static void create_info_destroy_test() {
     }
     ccl_err_clear(&err);
 
+    /* If build logs are only retrieved for failed builds, no build log
+     * should be available, since the build was successful. */
+    ccl_program_set_build_log_mode(prg, CCL_PROGRAM_BUILD_LOG_ON_FAILURE);
+    build_log = ccl_program_get_device_build_log(prg, d, &err);
+    g_assert_no_error(err);
+    g_assert_null(build_log);
+    build_log = ccl_program_get_build_log(prg, &err);
+    g_assert_no_error(err);
+    g_assert_cmpstr(build_log, ==, "");
+
     /* ***** */
     /* Done! */
     /* ***** */
@@ -809,6 +845,340 @@ static void ref_unref_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Test creation of all program kernels at once.
+ * */
+static void prepare_kernels_test() {
+
+    CCLContext * ctx = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl1 = NULL;
+    CCLKernel * krnl2 = NULL;
+    cl_bool status;
+
+    /* Get some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program from source. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create all kernels. */
+    status = ccl_program_prepare_kernels(prg, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Kernel should now be kept by the program. */
+    krnl1 = ccl_program_get_kernel(prg, CCL_TEST_PROGRAM_SUM, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_wrapper_ref_count((CCLWrapper *) krnl1), ==, 1);
+
+    /* Preparing kernels again should keep the existing kernel. */
+    status = ccl_program_prepare_kernels(prg, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    krnl2 = ccl_program_get_kernel(prg, CCL_TEST_PROGRAM_SUM, &err);
+    g_assert_no_error(err);
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl1), ==, GPOINTER_TO_SIZE(krnl2));
+
+    /* Destroy stuff. */
+    ccl_program_destroy(prg);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Thread function for thread_kernel_test(), which gets the
+ * per-thread sum kernel twice and returns it.
+ * */
+static gpointer thread_kernel_thread(gpointer data) {
+
+    CCLProgram * prg = (CCLProgram *) data;
+    CCLErr * err = NULL;
+    CCLKernel * krnl1 = NULL;
+    CCLKernel * krnl2 = NULL;
+
+    krnl1 = ccl_program_get_thread_kernel(prg, CCL_TEST_PROGRAM_SUM, &err);
+    g_assert_no_error(err);
+    krnl2 = ccl_program_get_thread_kernel(prg, CCL_TEST_PROGRAM_SUM, &err);
+    g_assert_no_error(err);
+
+    /* Same thread should always get the same kernel. */
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl1), ==, GPOINTER_TO_SIZE(krnl2));
+
+    return krnl1;
+}
+
+/**
+ * @internal
+ *
+ * @brief Test per-thread program kernels.
+ * */
+static void thread_kernel_test() {
+
+    CCLContext * ctx = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl_main = NULL;
+    CCLKernel * krnl_threads[2];
+    GThread * threads[2];
+
+    /* Get some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program from source. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    g_assert_no_error(err);
+
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Get kernels from the main thread and from two other threads. */
+    krnl_main = ccl_program_get_thread_kernel(
+        prg, CCL_TEST_PROGRAM_SUM, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < 2; ++i)
+        threads[i] = g_thread_new(NULL, thread_kernel_thread, prg);
+    for (guint i = 0; i < 2; ++i)
+        krnl_threads[i] = g_thread_join(threads[i]);
+
+    /* Each thread should have its own kernel, which is also different
+     * from the one returned by ccl_program_get_kernel(). */
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl_main), !=,
+        GPOINTER_TO_SIZE(krnl_threads[0]));
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl_main), !=,
+        GPOINTER_TO_SIZE(krnl_threads[1]));
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl_threads[0]), !=,
+        GPOINTER_TO_SIZE(krnl_threads[1]));
+    g_assert_cmphex(GPOINTER_TO_SIZE(krnl_main), !=, GPOINTER_TO_SIZE(
+        ccl_program_get_kernel(prg, CCL_TEST_PROGRAM_SUM, &err)));
+    g_assert_no_error(err);
+
+    /* Unknown kernel functions should fail, also on later calls. */
+    for (guint i = 0; i < 2; ++i) {
+        g_assert_true(ccl_program_get_thread_kernel(
+            prg, "no_such_kernel", &err) == NULL);
+        g_assert_nonnull(err);
+        ccl_err_clear(&err);
+    }
+
+    /* Destroy stuff. */
+    ccl_program_destroy(prg);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Callback for asynchronous builds, counts completed builds.
+ * */
+static void build_async_callback(
+    CCLProgram * prg, cl_bool success, void * user_data) {
+
+    CCL_UNUSED(prg);
+    CCL_UNUSED(success);
+    g_atomic_int_inc((gint *) user_data);
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests asynchronous program builds.
+ * */
+static void build_async_test() {
+
+    CCLContext * ctx = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prgs[2];
+    CCLProgram * prg_bad = NULL;
+    CCLAsyncBuild * builds[2];
+    CCLAsyncBuild * build_bad = NULL;
+    gint num_done = 0;
+
+    /* Get some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Start building two programs at once. */
+    for (guint i = 0; i < 2; ++i) {
+        prgs[i] = ccl_program_new_from_source(
+            ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+        g_assert_no_error(err);
+        builds[i] = ccl_program_build_async(prgs[i], 0, NULL, NULL,
+            build_async_callback, &num_done, &err);
+        g_assert_no_error(err);
+        g_assert_nonnull(builds[i]);
+    }
+
+    /* Wait for builds, callbacks should have been invoked. */
+    for (guint i = 0; i < 2; ++i) {
+        g_assert_true(ccl_async_build_wait(builds[i], &err));
+        g_assert_no_error(err);
+        g_assert_true(ccl_async_build_poll(builds[i]));
+        ccl_async_build_destroy(builds[i]);
+    }
+    g_assert_cmpint(g_atomic_int_get(&num_done), ==, 2);
+
+    /* Built programs should be usable. */
+    for (guint i = 0; i < 2; ++i) {
+        g_assert_nonnull(
+            ccl_program_get_kernel(prgs[i], CCL_TEST_PROGRAM_SUM, &err));
+        g_assert_no_error(err);
+        ccl_program_destroy(prgs[i]);
+    }
+
+    /* A program which doesn't build should report failure on wait. */
+    prg_bad = ccl_program_new_from_source(
+        ctx, "__kernel void bad(__global int * a) { a[0] = b; }", &err);
+    g_assert_no_error(err);
+    build_bad = ccl_program_build_async(prg_bad, 0, NULL, NULL, NULL, NULL,
+        &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(build_bad);
+    g_assert_false(ccl_async_build_wait(build_bad, &err));
+    g_assert_error(err, CCL_OCL_ERROR, CL_BUILD_PROGRAM_FAILURE);
+    g_clear_error(&err);
+    ccl_async_build_destroy(build_bad);
+    ccl_program_destroy(prg_bad);
+
+    /* Destroy stuff. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Count the files in a directory.
+ * */
+static guint count_files(const char * dir_name) {
+
+    GDir * dir;
+    guint count = 0;
+
+    dir = g_dir_open(dir_name, 0, NULL);
+    g_assert_nonnull(dir);
+    while (g_dir_read_name(dir) != NULL) ++count;
+    g_dir_close(dir);
+
+    return count;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the on-disk program binary cache.
+ * */
+static void cache_test() {
+
+    CCLContext * ctx = NULL;
+    CCLErr * err = NULL;
+    CCLProgram * prg = NULL;
+    gchar * tmp_dir_name;
+    cl_program program;
+    cl_uint num_devs;
+    GDir * dir;
+    const gchar * name;
+
+    /* Get some context. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Enable cache in a temporary directory. */
+    tmp_dir_name = g_dir_make_tmp("test_program_cache_XXXXXX", &err);
+    g_assert_no_error(err);
+    ccl_program_cache_enable(tmp_dir_name, 0);
+
+    /* Build program, which should be a cache miss and save one binary
+     * per device in the cache. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    g_assert_no_error(err);
+    num_devs = ccl_program_get_num_devices(prg, &err);
+    g_assert_no_error(err);
+    program = ccl_program_unwrap(prg);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(program == ccl_program_unwrap(prg));
+    g_assert_cmpuint(count_files(tmp_dir_name), ==, num_devs);
+    ccl_program_destroy(prg);
+
+    /* Build the same program again, which should be a cache hit, i.e.
+     * the program wrapper should now wrap a program created from the
+     * cached binaries. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    g_assert_no_error(err);
+    program = ccl_program_unwrap(prg);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(program != ccl_program_unwrap(prg));
+    g_assert_cmpuint(count_files(tmp_dir_name), ==, num_devs);
+
+    /* Source should still be available in program built from cached
+     * binaries. */
+    g_assert_cmpstr(ccl_program_get_info_array(
+        prg, CL_PROGRAM_SOURCE, char, &err), ==,
+        CCL_TEST_PROGRAM_SUM_CONTENT);
+    g_assert_no_error(err);
+
+    /* Kernels should be available in program built from cached
+     * binaries. */
+    g_assert_nonnull(ccl_program_get_kernel(prg, CCL_TEST_PROGRAM_SUM, &err));
+    g_assert_no_error(err);
+    ccl_program_destroy(prg);
+
+    /* Different build options are a different cache entry, and with a
+     * tiny maximum cache size everything should be evicted. */
+    ccl_program_cache_enable(tmp_dir_name, 1);
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_PROGRAM_SUM_CONTENT, &err);
+    g_assert_no_error(err);
+    program = ccl_program_unwrap(prg);
+    ccl_program_build(prg, "-DCCL_TEST_PROGRAM_CACHE", &err);
+    g_assert_no_error(err);
+    g_assert_true(program == ccl_program_unwrap(prg));
+    g_assert_cmpuint(count_files(tmp_dir_name), ==, 0);
+    ccl_program_destroy(prg);
+
+    /* Disable cache and remove temporary directory. */
+    ccl_program_cache_disable();
+    dir = g_dir_open(tmp_dir_name, 0, NULL);
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        gchar * file_name = g_build_filename(tmp_dir_name, name, NULL);
+        g_unlink(file_name);
+        g_free(file_name);
+    }
+    g_dir_close(dir);
+    g_rmdir(tmp_dir_name);
+    g_free(tmp_dir_name);
+
+    /* Destroy stuff. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 #ifdef CL_VERSION_1_2
 
 static const char * src_head[] = {
@@ -930,6 +1300,413 @@ static void compile_link_test() {
 
 }
 
+/**
+ * @internal
+ *
+ * @brief Test context cache of compiled programs.
+ * */
+static void compile_cached_test() {
+
+#ifndef CL_VERSION_1_2
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.2 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg_head = NULL;
+    CCLProgram * prg_main1 = NULL;
+    CCLProgram * prg_main2 = NULL;
+    CCLProgram * prg_main3 = NULL;
+    CCLProgram * prg_exec[2];
+    const char * src_main_ptr = src_main;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(120, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Create header program. */
+    prg_head =
+        ccl_program_new_from_sources(ctx, 2, src_head, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Compile main program twice with the same sources, headers and
+     * options: the same compiled program should be returned. */
+    prg_main1 = ccl_program_compile_cached(ctx, 1, &src_main_ptr, NULL,
+        1, &prg_head, &src_head_name, &err);
+    g_assert_no_error(err);
+    prg_main2 = ccl_program_compile_cached(ctx, 1, &src_main_ptr, NULL,
+        1, &prg_head, &src_head_name, &err);
+    g_assert_no_error(err);
+    g_assert_true(prg_main1 == prg_main2);
+
+    /* Different options should produce a different compiled program. */
+    prg_main3 = ccl_program_compile_cached(ctx, 1, &src_main_ptr,
+        "-DCCL_TEST_COMPILE_CACHED", 1, &prg_head, &src_head_name, &err);
+    g_assert_no_error(err);
+    g_assert_true(prg_main1 != prg_main3);
+
+    /* Link the same compiled program into two executables. */
+    for (guint i = 0; i < 2; ++i) {
+        prg_exec[i] = ccl_program_link(
+            ctx, 0, NULL, NULL, 1, &prg_main1, NULL, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_nonnull(
+            ccl_program_get_kernel(prg_exec[i], "complinktest", &err));
+        g_assert_no_error(err);
+    }
+
+    /* Free stuff. Cached compiled programs are only released with the
+     * context. */
+    ccl_program_destroy(prg_exec[0]);
+    ccl_program_destroy(prg_exec[1]);
+    ccl_program_destroy(prg_main3);
+    ccl_program_destroy(prg_main2);
+    ccl_program_destroy(prg_main1);
+    ccl_program_destroy(prg_head);
+    g_assert_false(ccl_wrapper_memcheck());
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Test program variants built with compile-time constants.
+ * */
+static void variant_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLProgram * var1 = NULL;
+    CCLProgram * var2 = NULL;
+    CCLProgram * var3 = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    const char * consts[] = { "MUL", "3", "VAL", "2", NULL };
+    const char * src =
+        "__kernel void fill(__global uint * a) {\n"
+        "    a[get_global_id(0)] = VAL * MUL;\n"
+        "}\n";
+    cl_uint res[CCL_TEST_PROGRAM_BUF_SIZE];
+    size_t gws = CCL_TEST_PROGRAM_BUF_SIZE;
+    CCLErr * err = NULL;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create base program, which is not built itself. */
+    prg = ccl_program_new_from_source(ctx, src, &err);
+    g_assert_no_error(err);
+
+    /* Get the same variant with constants in different orders: the same
+     * program should be returned. */
+    var1 = ccl_program_get_variant(prg, NULL, &err, "VAL", "2", "MUL", "3",
+        NULL);
+    g_assert_no_error(err);
+    var2 = ccl_program_get_variant_v(prg, NULL, consts, &err);
+    g_assert_no_error(err);
+    g_assert_true(var1 == var2);
+
+    /* Different constants should produce a different variant. */
+    var3 = ccl_program_get_variant(prg, NULL, &err, "VAL", "5", "MUL", "3",
+        NULL);
+    g_assert_no_error(err);
+    g_assert_true(var1 != var3);
+
+    /* Check that each variant uses its own constants. */
+    buf = ccl_buffer_new(ctx, CL_MEM_WRITE_ONLY,
+        CCL_TEST_PROGRAM_BUF_SIZE * sizeof(cl_uint), NULL, &err);
+    g_assert_no_error(err);
+
+    evt = ccl_program_enqueue_kernel(var1, "fill", cq, 1, NULL, &gws, NULL,
+        NULL, &err, buf, NULL);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0, sizeof(res), res,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_PROGRAM_BUF_SIZE; ++i)
+        g_assert_cmpuint(res[i], ==, 6);
+
+    evt = ccl_program_enqueue_kernel(var3, "fill", cq, 1, NULL, &gws, NULL,
+        NULL, &err, buf, NULL);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0, sizeof(res), res,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_PROGRAM_BUF_SIZE; ++i)
+        g_assert_cmpuint(res[i], ==, 15);
+
+    /* A constant without value is an error. */
+    var1 = ccl_program_get_variant(prg, NULL, &err, "VAL", NULL);
+    g_assert_null(var1);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_clear_error(&err);
+
+    /* Free stuff. Variants are released with the base program. */
+    ccl_buffer_destroy(buf);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Test program creation from intermediate language (IL).
+ * */
+static void il_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLProgram * prg = NULL;
+    CCLErr * err = NULL;
+    const char bad_il[] = "This is not valid IL";
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Invalid IL should produce an error, either because the platform
+     * doesn't support IL or because the IL is invalid. */
+    prg = ccl_program_new_from_il(ctx, bad_il, sizeof(bad_il), &err);
+    g_assert_null(prg);
+    g_assert_nonnull(err);
+    g_clear_error(&err);
+
+    /* A nonexistent IL file should produce an error. */
+    prg = ccl_program_new_from_il_file(ctx, "this_file_does_not_exist.spv",
+        &err);
+    g_assert_null(prg);
+    g_assert_error(err, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&err);
+
+    /* Free stuff. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Test program creation from embedded binaries.
+ * */
+static void embedded_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLPlatform * platf = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLErr * err = NULL;
+    CCLProgramEmbedded embedded[2];
+    gchar * tmp_file = NULL;
+    gchar * bin = NULL;
+    gsize bin_size;
+    gint fd;
+    const char * src =
+        "__kernel void embedded_test(__global uint * a) {\n"
+        "    a[get_global_id(0)] = VAL;\n"
+        "}\n";
+    const char * options = "-DVAL=5";
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+    platf = ccl_context_get_platform(ctx, &err);
+    g_assert_no_error(err);
+
+    /* Build program from source and get its binary, as ccl_c would. */
+    prg = ccl_program_new_from_source(ctx, src, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, options, &err);
+    g_assert_no_error(err);
+    fd = g_file_open_tmp("test_program_XXXXXX.bin", &tmp_file, &err);
+    g_assert_no_error(err);
+    g_close(fd, &err);
+    g_assert_no_error(err);
+    ccl_program_save_binary(prg, dev, tmp_file, &err);
+    g_assert_no_error(err);
+    g_file_get_contents(tmp_file, &bin, &bin_size, &err);
+    g_assert_no_error(err);
+    g_unlink(tmp_file);
+    ccl_program_destroy(prg);
+
+    /* Setup embedded binary table for the test device, followed by an
+     * invalid IL entry which should be ignored. */
+    embedded[0].device_name =
+        ccl_device_get_info_array(dev, CL_DEVICE_NAME, char, &err);
+    g_assert_no_error(err);
+    embedded[0].platform_name =
+        ccl_platform_get_info_array(platf, CL_PLATFORM_NAME, char, &err);
+    g_assert_no_error(err);
+    embedded[0].data = (const unsigned char *) bin;
+    embedded[0].size = bin_size;
+    embedded[0].il = CL_FALSE;
+    embedded[1].device_name = NULL;
+    embedded[1].platform_name = NULL;
+    embedded[1].data = (const unsigned char *) "Not IL";
+    embedded[1].size = 6;
+    embedded[1].il = CL_TRUE;
+
+    /* Matching binary, no source needed. */
+    prg = ccl_program_new_from_embedded(
+        ctx, embedded, 2, NULL, options, &err);
+    g_assert_no_error(err);
+    krnl = ccl_program_get_kernel(prg, "embedded_test", &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(krnl);
+    ccl_program_destroy(prg);
+
+    /* Binary for another device, fall back to source. */
+    embedded[0].device_name = "No such device";
+    prg = ccl_program_new_from_embedded(
+        ctx, embedded, 2, src, options, &err);
+    g_assert_no_error(err);
+    krnl = ccl_program_get_kernel(prg, "embedded_test", &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(krnl);
+    ccl_program_destroy(prg);
+
+    /* No matching binary and no source is an error. */
+    prg = ccl_program_new_from_embedded(
+        ctx, embedded, 2, NULL, options, &err);
+    g_assert_null(prg);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_clear_error(&err);
+
+    /* Free stuff. */
+    g_free(bin);
+    g_free(tmp_file);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests creation of programs from memory-mapped source and binary
+ * files.
+ * */
+static void mapped_files_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLProgram * prg = NULL;
+    CCLErr * err = NULL;
+    gchar * tmp_dir_name;
+    gchar * filenames[4];
+    const char * src = CCL_TEST_PROGRAM_SUM_CONTENT;
+    gsize half = strlen(src) / 2;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Source split across two files with an empty file in between, and a
+     * file for the binary. */
+    tmp_dir_name = g_dir_make_tmp("test_program_XXXXXX", &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < 4; ++i)
+        filenames[i] = g_strdup_printf(
+            "%s%cpart%u.cl", tmp_dir_name, G_DIR_SEPARATOR, i);
+    g_file_set_contents(filenames[0], src, half, &err);
+    g_assert_no_error(err);
+    g_file_set_contents(filenames[1], "", 0, &err);
+    g_assert_no_error(err);
+    g_file_set_contents(filenames[2], src + half, -1, &err);
+    g_assert_no_error(err);
+
+    /* *************************************************************** */
+    /* 1. Mapped source files are not null-terminated, program source */
+    /*    should be their exact concatenation.                         */
+    /* *************************************************************** */
+    prg = ccl_program_new_from_source_files(
+        ctx, 3, (const char **) filenames, &err);
+    g_assert_no_error(err);
+    g_assert_cmpstr(ccl_program_get_info_array(
+        prg, CL_PROGRAM_SOURCE, char, &err), ==, src);
+    g_assert_no_error(err);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    ccl_program_save_binary(prg, dev, filenames[3], &err);
+    g_assert_no_error(err);
+    ccl_program_destroy(prg);
+
+    /* ********************************************************** */
+    /* 2. Program created from mapped binary file should build and */
+    /*    provide its kernels.                                     */
+    /* ********************************************************** */
+    prg = ccl_program_new_from_binary_files(
+        ctx, 1, &dev, (const char **) &filenames[3], NULL, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(ccl_program_get_kernel(prg, CCL_TEST_PROGRAM_SUM, &err));
+    g_assert_no_error(err);
+    ccl_program_destroy(prg);
+
+    /* ********************************************************* */
+    /* 3. Files which can't be mapped should fail with an error. */
+    /* ********************************************************* */
+    for (guint i = 0; i < 4; ++i)
+        g_unlink(filenames[i]);
+    prg = ccl_program_new_from_source_files(
+        ctx, 3, (const char **) filenames, &err);
+    g_assert_null(prg);
+    g_assert_error(err, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&err);
+    prg = ccl_program_new_from_binary_files(
+        ctx, 1, &dev, (const char **) &filenames[3], NULL, &err);
+    g_assert_null(prg);
+    g_assert_error(err, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_clear_error(&err);
+
+    /* Free stuff. */
+    for (guint i = 0; i < 4; ++i)
+        g_free(filenames[i]);
+    g_rmdir(tmp_dir_name);
+    g_free(tmp_dir_name);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -1004,10 +1781,46 @@ int main(int argc, char ** argv) {
         "/wrappers/program/ref-unref",
         ref_unref_test);
 
+    g_test_add_func(
+        "/wrappers/program/prepare-kernels",
+        prepare_kernels_test);
+
+    g_test_add_func(
+        "/wrappers/program/thread-kernel",
+        thread_kernel_test);
+
+    g_test_add_func(
+        "/wrappers/program/cache",
+        cache_test);
+
+    g_test_add_func(
+        "/wrappers/program/mapped-files",
+        mapped_files_test);
+
+    g_test_add_func(
+        "/wrappers/program/build-async",
+        build_async_test);
+
     g_test_add_func(
         "/wrappers/program/compile-link",
         compile_link_test);
 
+    g_test_add_func(
+        "/wrappers/program/compile-cached",
+        compile_cached_test);
+
+    g_test_add_func(
+        "/wrappers/program/variant",
+        variant_test);
+
+    g_test_add_func(
+        "/wrappers/program/il",
+        il_test);
+
+    g_test_add_func(
+        "/wrappers/program/embedded",
+        embedded_test);
+
     g_test_add_func(
         "/wrappers/program/errors",
         errors_test);
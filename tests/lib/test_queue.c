@@ -531,6 +531,1417 @@ static void mult_ooo_test() {
     ccl_context_destroy(ctx);
 }
 
+/* Event capacity used in the event capacity test. */
+#define CCL_TEST_QUEUE_EVT_CAP 8
+
+/* Number of commands enqueued in the event capacity test. */
+#define CCL_TEST_QUEUE_NCMDS 100
+
+/**
+ * @internal
+ *
+ * @brief Tests automatic release of terminated events when the event
+ * capacity of a command queue is reached.
+ * */
+static void event_capacity_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEvent * evt_kept = NULL;
+    CCLEvent * evt_cq = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+    cl_bool evt_in_cq;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue and set its event capacity. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    ccl_queue_set_event_capacity(cq, CCL_TEST_QUEUE_EVT_CAP);
+
+    /* Create a device buffer. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Enqueue blocking writes, keeping a reference to the first event. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_NCMDS; ++i) {
+        evt = ccl_buffer_enqueue_write(
+            buf, cq, CL_TRUE, 0, sizeof(hbuf), hbuf, NULL, &err);
+        g_assert_no_error(err);
+        if (i == 0) {
+            evt_kept = evt;
+            ccl_event_ref(evt_kept);
+        }
+    }
+
+    /* Terminated events were released along the way, so the number of
+     * events kept by the queue is bounded. */
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), <=,
+        2 * CCL_TEST_QUEUE_EVT_CAP);
+
+    /* The referenced event must not have been released. */
+    evt_in_cq = CL_FALSE;
+    ccl_queue_iter_event_init(cq);
+    while ((evt_cq = ccl_queue_iter_event_next(cq)) != NULL) {
+        if (evt_cq == evt_kept) {
+            evt_in_cq = CL_TRUE;
+            break;
+        }
+    }
+    g_assert_true(evt_in_cq);
+
+    /* Release all events in queue. */
+    ccl_queue_gc(cq);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, 0);
+
+    /* Release wrappers. */
+    ccl_event_destroy(evt_kept);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests incremental release of completed events.
+ * */
+static void gc_incremental_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEvent * evt_kept = NULL;
+    CCLProf * prof = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+    cl_uint num_rel;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a device buffer. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Enqueue blocking writes, keeping a reference to the first event. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_NCMDS; ++i) {
+        evt = ccl_buffer_enqueue_write(
+            buf, cq, CL_TRUE, 0, sizeof(hbuf), hbuf, NULL, &err);
+        g_assert_no_error(err);
+        if (i == 0) {
+            evt_kept = evt;
+            ccl_event_ref(evt_kept);
+        }
+    }
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, CCL_TEST_QUEUE_NCMDS);
+
+    /* Events are not released while a profile object may require them. */
+    prof = ccl_prof_new();
+    ccl_prof_add_queue(prof, "Q", cq);
+    num_rel = ccl_queue_gc_incremental(cq, 0, 0);
+    g_assert_cmpuint(num_rel, ==, 0);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, CCL_TEST_QUEUE_NCMDS);
+    ccl_prof_destroy(prof);
+
+    /* Release a limited number of completed events. */
+    num_rel = ccl_queue_gc_incremental(cq, CCL_TEST_QUEUE_EVT_CAP, 0);
+    g_assert_cmpuint(num_rel, ==, CCL_TEST_QUEUE_EVT_CAP);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==,
+        CCL_TEST_QUEUE_NCMDS - CCL_TEST_QUEUE_EVT_CAP);
+
+    /* Release the remaining completed events. */
+    num_rel = ccl_queue_gc_incremental(cq, 0, 0);
+    g_assert_cmpuint(num_rel, ==,
+        CCL_TEST_QUEUE_NCMDS - CCL_TEST_QUEUE_EVT_CAP);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, 0);
+
+    /* The event referenced by the test is still valid. */
+    g_assert_cmpint(ccl_wrapper_ref_count((CCLWrapper *) evt_kept), ==, 1);
+
+    /* Release wrappers. */
+    ccl_event_destroy(evt_kept);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the event-less mode of command queues.
+ * */
+static void eventless_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue in event-less mode. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    ccl_queue_set_eventless(cq, CL_TRUE);
+
+    /* Create a device buffer. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Enqueue commands, no events should be produced. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_NCMDS; ++i) {
+        evt = ccl_buffer_enqueue_write(
+            buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_null(evt);
+    }
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, 0);
+
+    /* Disable event-less mode, events should be produced again. */
+    ccl_queue_set_eventless(cq, CL_FALSE);
+    evt = ccl_buffer_enqueue_read(
+        buf, cq, CL_TRUE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+    g_assert_cmpuint(ccl_queue_get_num_events(cq), ==, 1);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* Kernel used to test command sequences. */
+#define CCL_TEST_QUEUE_CMDSEQ_KERNEL \
+    "__kernel void inc(__global uint * b) {\n" \
+    "    b[get_global_id(0)] += 1;\n" \
+    "}\n"
+
+/* Number of elements in buffers used to test command sequences. */
+#define CCL_TEST_QUEUE_CMDSEQ_N 16
+
+/**
+ * @internal
+ *
+ * @brief Tests recording and replaying of command sequences.
+ * */
+static void cmdseq_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLBuffer * buf_a = NULL;
+    CCLBuffer * buf_b = NULL;
+    CCLCmdSeq * seq = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[CCL_TEST_QUEUE_CMDSEQ_N];
+    size_t gws = CCL_TEST_QUEUE_CMDSEQ_N;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create and build program, get kernel. */
+    prg = ccl_program_new_from_source(
+        ctx, CCL_TEST_QUEUE_CMDSEQ_KERNEL, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    krnl = ccl_program_get_kernel(prg, "inc", &err);
+    g_assert_no_error(err);
+
+    /* Create device buffers. */
+    buf_a = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+    buf_b = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Empty sequences can't be replayed. */
+    seq = ccl_cmdseq_new(cq, &err);
+    g_assert_no_error(err);
+    evt = ccl_cmdseq_replay(seq, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(evt);
+    ccl_err_clear(&err);
+
+    /* 1 - Sequence with host transfers: write, increment, read. */
+    ccl_kernel_set_args(krnl, buf_a, NULL);
+    ccl_cmdseq_add_write(seq, buf_a, 0, sizeof(hbuf), hbuf);
+    ccl_cmdseq_add_ndrange(seq, krnl, 1, NULL, &gws, NULL);
+    ccl_cmdseq_add_read(seq, buf_a, 0, sizeof(hbuf), hbuf);
+    g_assert_false(ccl_cmdseq_is_native(seq));
+
+    /* Replay it with new host data each time. */
+    for (cl_uint r = 0; r < 3; ++r) {
+        for (cl_uint i = 0; i < CCL_TEST_QUEUE_CMDSEQ_N; ++i)
+            hbuf[i] = i * r;
+        evt = ccl_cmdseq_replay(seq, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+        g_assert_no_error(err);
+        for (cl_uint i = 0; i < CCL_TEST_QUEUE_CMDSEQ_N; ++i)
+            g_assert_cmpuint(hbuf[i], ==, i * r + 1);
+    }
+    ccl_cmdseq_destroy(seq);
+
+    /* 2 - Device only sequence, possibly native: increment, copy. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_CMDSEQ_N; ++i)
+        hbuf[i] = i;
+    ccl_buffer_enqueue_write(
+        buf_a, cq, CL_TRUE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+
+    seq = ccl_cmdseq_new(cq, &err);
+    g_assert_no_error(err);
+    ccl_cmdseq_add_ndrange(seq, krnl, 1, NULL, &gws, NULL);
+    ccl_cmdseq_add_copy(seq, buf_a, buf_b, 0, 0, sizeof(hbuf));
+
+    /* Replay twice: buf_a and buf_b should hold i + 2. */
+    for (cl_uint r = 0; r < 2; ++r) {
+        evt = ccl_cmdseq_replay(seq, NULL, &err);
+        g_assert_no_error(err);
+        ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+        g_assert_no_error(err);
+    }
+
+    /* Change kernel argument, replay: buf_b is incremented and then
+     * overwritten with buf_a, which should be unchanged. */
+    ccl_kernel_set_args(krnl, buf_b, NULL);
+    evt = ccl_cmdseq_replay(seq, NULL, &err);
+    g_assert_no_error(err);
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+
+    ccl_buffer_enqueue_read(
+        buf_b, cq, CL_TRUE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_CMDSEQ_N; ++i)
+        g_assert_cmpuint(hbuf[i], ==, i + 2);
+
+    /* Release wrappers. */
+    ccl_cmdseq_destroy(seq);
+    ccl_buffer_destroy(buf_a);
+    ccl_buffer_destroy(buf_b);
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* Number of elements in buffers used to test host tasks. */
+#define CCL_TEST_QUEUE_HOST_TASK_N 8
+
+/**
+ * @internal
+ *
+ * @brief Host task function which doubles the elements of a host buffer.
+ * */
+static cl_int CL_CALLBACK host_task_double(void * user_data) {
+
+    cl_uint * hbuf = (cl_uint *) user_data;
+
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_HOST_TASK_N; ++i)
+        hbuf[i] *= 2;
+
+    return CL_COMPLETE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests host tasks.
+ * */
+static void host_task_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[CCL_TEST_QUEUE_HOST_TASK_N];
+    cl_uint hres[CCL_TEST_QUEUE_HOST_TASK_N];
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+
+    /* Initialize host data and create device buffer with it. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_HOST_TASK_N; ++i)
+        hbuf[i] = i;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        sizeof(hbuf), hbuf, &err);
+    g_assert_no_error(err);
+
+    /* Use only one host task thread. */
+    ccl_host_task_set_max_threads(1);
+
+    /* Read buffer, double its elements in a host task and write them
+     * back, without blocking the host in between. */
+    ccl_buffer_enqueue_read(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_enqueue_host_task(cq, host_task_double, hbuf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Restore default number of host task threads. */
+    ccl_host_task_set_max_threads(0);
+
+    /* Double the elements again, in a host task which also waits for an
+     * explicit event. */
+    evt = ccl_buffer_enqueue_read(
+        buf, cq, CL_FALSE, 0, sizeof(hres), hres, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_enqueue_host_task(
+        cq, host_task_double, hres, ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_nonnull(evt);
+
+    /* Wait for host task to complete and check results. */
+    ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_HOST_TASK_N; ++i)
+        g_assert_cmpuint(hres[i], ==, 4 * i);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+}
+
+/* Number of tasks used to test the work-stealing scheduler. */
+#define CCL_TEST_QUEUE_SCHED_N 32
+
+/**
+ * @internal
+ *
+ * @brief Data of a scheduler task used in tests.
+ * */
+struct sched_task_data {
+    CCLBuffer * buf;
+    cl_uint index;
+    cl_uint value;
+};
+
+/**
+ * @internal
+ *
+ * @brief Scheduler task which writes a value to an element of a buffer.
+ * */
+static CCLEvent * sched_task_write(
+    CCLQueue * cq, void * user_data, CCLErr ** err) {
+
+    struct sched_task_data * data = (struct sched_task_data *) user_data;
+
+    return ccl_buffer_enqueue_write(data->buf, cq, CL_FALSE,
+        data->index * sizeof(cl_uint), sizeof(cl_uint), &data->value,
+        NULL, err);
+}
+
+/**
+ * @internal
+ *
+ * @brief Scheduler task which fails.
+ * */
+static CCLEvent * sched_task_fail(
+    CCLQueue * cq, void * user_data, CCLErr ** err) {
+
+    CCL_UNUSED(cq);
+    CCL_UNUSED(user_data);
+    g_set_error(err, CCL_ERROR, CCL_ERROR_OTHER, "Task failed.");
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the work-stealing scheduler.
+ * */
+static void scheduler_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cqs[2] = { NULL, NULL };
+    CCLBuffer * buf = NULL;
+    CCLScheduler * sched = NULL;
+    CCLErr * err = NULL;
+    struct sched_task_data tasks[CCL_TEST_QUEUE_SCHED_N];
+    cl_uint hbuf[CCL_TEST_QUEUE_SCHED_N];
+    cl_bool status;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create two command queues. */
+    for (cl_uint i = 0; i < 2; ++i) {
+        cqs[i] = ccl_queue_new(ctx, dev, 0, &err);
+        g_assert_no_error(err);
+    }
+
+    /* Create device buffer. */
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* A scheduler requires queues. */
+    sched = ccl_scheduler_new(cqs, 0, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(sched);
+    ccl_err_clear(&err);
+
+    /* Create scheduler with one task in flight per queue, which owns
+     * references to the queues. */
+    sched = ccl_scheduler_new(cqs, 2, 1, &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < 2; ++i)
+        ccl_queue_destroy(cqs[i]);
+
+    /* Submit tasks which write each element of the buffer, and wait for
+     * all of them to complete. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SCHED_N; ++i) {
+        tasks[i].buf = buf;
+        tasks[i].index = i;
+        tasks[i].value = 3 * i + 1;
+        status = ccl_scheduler_submit(
+            sched, sched_task_write, &tasks[i], &err);
+        g_assert_no_error(err);
+        g_assert_true(status);
+    }
+    status = ccl_scheduler_wait(sched, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+    g_assert_cmpuint(ccl_scheduler_get_num_tasks(sched, 0)
+        + ccl_scheduler_get_num_tasks(sched, 1), ==, CCL_TEST_QUEUE_SCHED_N);
+    g_assert_cmpuint(
+        ccl_scheduler_get_num_steals(sched), <=, CCL_TEST_QUEUE_SCHED_N);
+
+    /* Check results. */
+    ccl_buffer_enqueue_read(buf, cqs[0], CL_TRUE, 0, sizeof(hbuf), hbuf,
+        NULL, &err);
+    g_assert_no_error(err);
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SCHED_N; ++i)
+        g_assert_cmpuint(hbuf[i], ==, 3 * i + 1);
+
+    /* Errors in task functions are reported. */
+    status = ccl_scheduler_submit(sched, sched_task_fail, NULL, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_OTHER);
+    g_assert_false(status);
+    ccl_err_clear(&err);
+    status = ccl_scheduler_wait(sched, &err);
+    g_assert_no_error(err);
+    g_assert_true(status);
+
+    /* Release wrappers. */
+    ccl_scheduler_destroy(sched);
+    ccl_buffer_destroy(buf);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+}
+
+/* Number of producer threads used to test the submitter. */
+#define CCL_TEST_QUEUE_SUBMIT_THREADS 4
+
+/* Number of commands submitted by each producer thread. */
+#define CCL_TEST_QUEUE_SUBMIT_N 64
+
+/* Total number of commands submitted in the submitter test. */
+#define CCL_TEST_QUEUE_SUBMIT_TOTAL \
+    (CCL_TEST_QUEUE_SUBMIT_THREADS * CCL_TEST_QUEUE_SUBMIT_N)
+
+/**
+ * @internal
+ *
+ * @brief A command submitted in the submitter test, which writes a value
+ * to an element of a buffer.
+ * */
+struct submit_cmd {
+    CCLBuffer * buf;
+    cl_uint index;
+    cl_uint value;
+    CCLFuture * fut;
+};
+
+/**
+ * @internal
+ *
+ * @brief A producer thread in the submitter test.
+ * */
+struct submit_producer {
+    CCLSubmitter * sub;
+    struct submit_cmd * cmds;
+};
+
+/**
+ * @internal
+ *
+ * @brief Submitter command function which writes a value to an element
+ * of a buffer.
+ * */
+static CCLEvent * submit_write(
+    CCLQueue * cq, void * user_data, CCLErr ** err) {
+
+    struct submit_cmd * cmd = (struct submit_cmd *) user_data;
+
+    return ccl_buffer_enqueue_write(cmd->buf, cq, CL_FALSE,
+        cmd->index * sizeof(cl_uint), sizeof(cl_uint), &cmd->value,
+        NULL, err);
+}
+
+/**
+ * @internal
+ *
+ * @brief Producer thread function in the submitter test.
+ * */
+static gpointer submit_producer_run(gpointer data) {
+
+    struct submit_producer * p = (struct submit_producer *) data;
+
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SUBMIT_N; ++i)
+        p->cmds[i].fut = ccl_submitter_submit(
+            p->sub, submit_write, &p->cmds[i]);
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the multi-producer submission front-end.
+ * */
+static void submitter_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLSubmitter * sub = NULL;
+    CCLFuture * fut = NULL;
+    CCLErr * err = NULL;
+    GThread * threads[CCL_TEST_QUEUE_SUBMIT_THREADS];
+    struct submit_producer producers[CCL_TEST_QUEUE_SUBMIT_THREADS];
+    struct submit_cmd cmds[CCL_TEST_QUEUE_SUBMIT_TOTAL + 1];
+    cl_uint hbuf[CCL_TEST_QUEUE_SUBMIT_TOTAL];
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue and a device buffer. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Create submitter with a small ring, so that producers also have to
+     * wait for free slots. */
+    sub = ccl_submitter_new(cq, 8, &err);
+    g_assert_no_error(err);
+
+    /* Each producer thread writes its own part of the buffer. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SUBMIT_TOTAL; ++i) {
+        cmds[i].buf = buf;
+        cmds[i].index = i;
+        cmds[i].value = 2 * i + 1;
+    }
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SUBMIT_THREADS; ++i) {
+        producers[i].sub = sub;
+        producers[i].cmds = &cmds[i * CCL_TEST_QUEUE_SUBMIT_N];
+        threads[i] = g_thread_new(
+            "producer", submit_producer_run, &producers[i]);
+    }
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SUBMIT_THREADS; ++i)
+        g_thread_join(threads[i]);
+
+    /* Commands are enqueued in submission order: overwrite first element
+     * after the producers' commands. */
+    cmds[CCL_TEST_QUEUE_SUBMIT_TOTAL].buf = buf;
+    cmds[CCL_TEST_QUEUE_SUBMIT_TOTAL].index = 0;
+    cmds[CCL_TEST_QUEUE_SUBMIT_TOTAL].value = 12345;
+    fut = ccl_submitter_submit(
+        sub, submit_write, &cmds[CCL_TEST_QUEUE_SUBMIT_TOTAL]);
+
+    /* Wait for all commands to complete. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_SUBMIT_TOTAL; ++i) {
+        g_assert_cmpint(ccl_future_wait(cmds[i].fut), ==, CL_COMPLETE);
+        ccl_future_destroy(cmds[i].fut);
+    }
+    g_assert_cmpint(ccl_future_wait(fut), ==, CL_COMPLETE);
+    ccl_future_destroy(fut);
+
+    /* Destroy submitter, so that the queue can be used directly again. */
+    ccl_submitter_destroy(sub);
+
+    /* Check results. */
+    ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0, sizeof(hbuf), hbuf,
+        NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(hbuf[0], ==, 12345);
+    for (cl_uint i = 1; i < CCL_TEST_QUEUE_SUBMIT_TOTAL; ++i)
+        g_assert_cmpuint(hbuf[i], ==, 2 * i + 1);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the flush policy of command queues.
+ * */
+static void flush_policy_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create a command queue and a device buffer. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Without a flush policy, commands are not counted. */
+    ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, 0);
+
+    /* Flush every three commands. */
+    ccl_queue_set_flush_policy(cq, 3, 0);
+    for (cl_uint i = 1; i <= 7; ++i) {
+        ccl_buffer_enqueue_write(
+            buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+        g_assert_no_error(err);
+        g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, i % 3);
+    }
+
+    /* Explicit flushes restart the count. */
+    ccl_queue_flush(cq, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, 0);
+
+    /* Flush commands enqueued some time after the first unflushed one. */
+    ccl_queue_set_flush_policy(cq, 0, 1000);
+    ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, 1);
+    g_usleep(2000);
+    ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, 0);
+
+    /* Finishing the queue also restarts the count. */
+    ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_queue_get_num_unflushed(cq), ==, 0);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests the elision of redundant barriers and markers.
+ * */
+static void elide_sync_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * evt_w = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create an in-order command queue and a device buffer. */
+    cq = ccl_queue_new(ctx, dev, 0, &err);
+    g_assert_no_error(err);
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Without elision, markers are always enqueued. */
+    evt_w = ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_enqueue_marker(cq, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(evt != evt_w);
+    g_assert_cmpuint(ccl_queue_get_num_elided(cq), ==, 0);
+
+    /* With elision, a marker following a command in an in-order queue
+     * returns the event of that command. */
+    ccl_queue_set_elide_sync(cq, CL_TRUE);
+    evt_w = ccl_buffer_enqueue_write(
+        buf, cq, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_enqueue_marker(cq, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(evt == evt_w);
+    g_assert_cmpuint(ccl_queue_get_num_elided(cq), ==, 1);
+
+    /* Barriers with events to wait on are not elided. */
+    evt = ccl_enqueue_barrier(cq, ccl_ewl(&ewl, evt_w, NULL), &err);
+    g_assert_no_error(err);
+    g_assert_true(evt != evt_w);
+    g_assert_cmpuint(ccl_queue_get_num_elided(cq), ==, 1);
+
+    /* A barrier directly following another barrier is elided. */
+    evt_w = ccl_enqueue_barrier(cq, NULL, &err);
+    g_assert_no_error(err);
+    evt = ccl_enqueue_barrier(cq, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(evt == evt_w);
+    g_assert_cmpuint(ccl_queue_get_num_elided(cq), ==, 2);
+
+    /* Wait for commands to complete. */
+    ccl_queue_finish(cq, &err);
+    g_assert_no_error(err);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests queue priority hints, emulated by the submission scheduler if
+ * the device does not support them.
+ * */
+static void priority_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq_high = NULL;
+    CCLQueue * cq_low = NULL;
+    CCLBuffer * buf = NULL;
+    CCLEvent * uevt = NULL;
+    CCLEvent * evts[3];
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_uint hbuf[4] = { 1, 2, 3, 4 };
+    cl_bool finished[3];
+    const cl_queue_properties prop_high[] =
+        { CL_QUEUE_PRIORITY_KHR, CL_QUEUE_PRIORITY_HIGH_KHR, 0 };
+    const cl_queue_properties prop_low[] =
+        { CL_QUEUE_PRIORITY_KHR, CL_QUEUE_PRIORITY_LOW_KHR,
+          CL_QUEUE_THROTTLE_KHR, CL_QUEUE_THROTTLE_LOW_KHR, 0 };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create high and low priority queues and a device buffer. */
+    cq_high = ccl_queue_new_full(ctx, dev, prop_high, &err);
+    g_assert_no_error(err);
+    cq_low = ccl_queue_new_full(ctx, dev, prop_low, &err);
+    g_assert_no_error(err);
+    ccl_queue_set_background_depth(cq_low, 1);
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(hbuf), NULL, &err);
+    g_assert_no_error(err);
+
+    /* Keep the high priority queue busy until a user event completes. */
+    uevt = ccl_user_event_new(ctx, &err);
+    g_assert_no_error(err);
+    ccl_enqueue_barrier(cq_high, ccl_ewl(&ewl, uevt, NULL), &err);
+    g_assert_no_error(err);
+    ccl_queue_flush(cq_high, &err);
+    g_assert_no_error(err);
+
+    /* Enqueue background commands. */
+    for (cl_uint i = 0; i < 3; ++i) {
+        evts[i] = ccl_buffer_enqueue_write(
+            buf, cq_low, CL_FALSE, 0, sizeof(hbuf), hbuf, NULL, &err);
+        g_assert_no_error(err);
+    }
+
+    /* If the priority hints are emulated, at most one background command
+     * is in flight while the high priority queue is busy. */
+    ccl_event_wait_list_add(&ewl, evts[0], evts[1], evts[2], NULL);
+    ccl_event_wait_list_poll(&ewl, finished, &err);
+    g_assert_no_error(err);
+    ccl_event_wait_list_clear(&ewl);
+    if (ccl_queue_is_priority_emulated(cq_low)) {
+        g_assert_true(ccl_queue_is_priority_emulated(cq_high));
+        g_assert_true(finished[0]);
+        g_assert_true(finished[1]);
+    }
+
+    /* Release the high priority queue and wait for all commands. */
+    ccl_user_event_set_status(uevt, CL_COMPLETE, &err);
+    g_assert_no_error(err);
+    ccl_queue_finish(cq_high, &err);
+    g_assert_no_error(err);
+    ccl_queue_finish(cq_low, &err);
+    g_assert_no_error(err);
+
+    /* Release wrappers. */
+    ccl_event_destroy(uevt);
+    ccl_buffer_destroy(buf);
+    ccl_queue_destroy(cq_low);
+    ccl_queue_destroy(cq_high);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests creation and validation of on-device queues.
+ * */
+static void device_queue_test() {
+
+#ifndef CL_VERSION_2_0
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 2.0 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * cq_dev = NULL;
+    CCLErr * err = NULL;
+    cl_uint size, max_size;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Properties other than profiling and default are rejected. */
+    cq_dev = ccl_queue_new_device(
+        ctx, dev, CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, 0, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    g_assert_null(cq_dev);
+    g_clear_error(&err);
+
+    /* Create default on-device queue with the preferred size, if
+     * supported. */
+    cq_dev = ccl_queue_new_device(
+        ctx, dev, CL_QUEUE_ON_DEVICE_DEFAULT, 0, &err);
+    if ((err != NULL) && (err->domain == CCL_ERROR)
+        && (err->code == CCL_ERROR_UNSUPPORTED_OCL)) {
+
+        g_test_message("On-device queues not supported: %s", err->message);
+        g_clear_error(&err);
+
+    } else {
+
+        g_assert_no_error(err);
+
+        /* Check queue properties and size. */
+        g_assert_cmphex(ccl_queue_get_info_scalar(cq_dev,
+            CL_QUEUE_PROPERTIES, cl_command_queue_properties, &err)
+            & CL_QUEUE_ON_DEVICE, ==, CL_QUEUE_ON_DEVICE);
+        g_assert_no_error(err);
+        size = ccl_queue_get_info_scalar(
+            cq_dev, CL_QUEUE_SIZE, cl_uint, &err);
+        g_assert_no_error(err);
+        g_assert_cmpuint(size, ==, ccl_device_get_info_scalar(dev,
+            CL_DEVICE_QUEUE_ON_DEVICE_PREFERRED_SIZE, cl_uint, &err));
+        g_assert_no_error(err);
+
+        /* Queue sizes above the device maximum are rejected. */
+        max_size = ccl_device_get_info_scalar(dev,
+            CL_DEVICE_QUEUE_ON_DEVICE_MAX_SIZE, cl_uint, &err);
+        g_assert_no_error(err);
+        if (max_size < G_MAXUINT) {
+            g_assert_null(
+                ccl_queue_new_device(ctx, dev, 0, max_size + 1, &err));
+            g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+            g_clear_error(&err);
+        }
+
+        ccl_queue_destroy(cq_dev);
+    }
+
+    /* Release wrappers. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/* Number of elements in each quarter of the buffer used in the task graph
+ * test. */
+#define CCL_TEST_QUEUE_GRAPH_SIZE 64
+
+/**
+ * @internal
+ *
+ * @brief Host node function for graph_test(), which counts its calls.
+ * */
+static cl_bool graph_test_host(void * user_data, CCLErr ** err) {
+
+    CCL_UNUSED(err);
+    (*((cl_uint *) user_data))++;
+    return CL_TRUE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests task graphs over one and two in-order queues.
+ * */
+static void graph_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLQueue * queues[2] = { NULL, NULL };
+    CCLBuffer * buf = NULL;
+    CCLGraph * graph = NULL;
+    CCLGraphNode * a, * b, * c, * d;
+    CCLErr * err = NULL;
+    cl_uint hbuf[CCL_TEST_QUEUE_GRAPH_SIZE * 4];
+    cl_uint calls = 0;
+    size_t qsize = CCL_TEST_QUEUE_GRAPH_SIZE * sizeof(cl_uint);
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create two in-order command queues. */
+    for (cl_uint i = 0; i < 2; ++i) {
+        queues[i] = ccl_queue_new(ctx, dev, 0, &err);
+        g_assert_no_error(err);
+    }
+
+    /* Create a buffer whose first quarter is copied to the others. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_GRAPH_SIZE * 4; ++i)
+        hbuf[i] = i < CCL_TEST_QUEUE_GRAPH_SIZE ? g_test_rand_int() : 0;
+    buf = ccl_buffer_new(ctx, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        4 * qsize, hbuf, &err);
+    g_assert_no_error(err);
+
+    for (cl_uint num_queues = 1; num_queues <= 2; ++num_queues) {
+
+        /* Build diamond graph, with a redundant edge from a to d. */
+        graph = ccl_graph_new();
+        a = ccl_graph_add_copy(graph, "a", buf, buf, 0, qsize, qsize);
+        b = ccl_graph_add_copy(graph, "b", buf, buf, qsize, 2 * qsize, qsize);
+        c = ccl_graph_add_copy(graph, "c", buf, buf, qsize, 3 * qsize, qsize);
+        d = ccl_graph_add_host(graph, "d", graph_test_host, &calls);
+        ccl_graph_add_edge(graph, a, b);
+        ccl_graph_add_edge(graph, a, c);
+        ccl_graph_add_edge(graph, b, d);
+        ccl_graph_add_edge(graph, c, d);
+        ccl_graph_add_edge(graph, a, d);
+        ccl_graph_instantiate(graph, queues, num_queues, &err);
+        g_assert_no_error(err);
+
+        /* With one in-order queue, only the host node waits, on b and c.
+         * With two queues, c goes to the second queue and waits on a. */
+        g_assert_true(ccl_graph_node_get_queue(a) == queues[0]);
+        g_assert_true(ccl_graph_node_get_queue(b) == queues[0]);
+        g_assert_true(ccl_graph_node_get_queue(c) == queues[num_queues - 1]);
+        g_assert_null(ccl_graph_node_get_queue(d));
+        g_assert_cmpuint(ccl_graph_get_num_deps(graph), ==, num_queues + 1);
+
+        /* Launch graph twice. */
+        for (cl_uint i = 0; i < 2; ++i) {
+            ccl_event_wait(ccl_graph_launch(graph, NULL, &err), &err);
+            g_assert_no_error(err);
+        }
+        g_assert_cmpuint(calls, ==, 2 * num_queues);
+        g_assert_cmpstr(
+            ccl_event_get_name(ccl_graph_node_get_event(b)), ==, "b");
+
+        /* Check that data was copied to all quarters of the buffer. */
+        ccl_buffer_enqueue_read(
+            buf, queues[0], CL_TRUE, 0, 4 * qsize, hbuf, NULL, &err);
+        g_assert_no_error(err);
+        for (cl_uint i = 0; i < CCL_TEST_QUEUE_GRAPH_SIZE * 4; ++i)
+            g_assert_cmpuint(
+                hbuf[i], ==, hbuf[i % CCL_TEST_QUEUE_GRAPH_SIZE]);
+
+        ccl_graph_destroy(graph);
+    }
+
+    /* Graphs with cycles can't be instantiated. */
+    graph = ccl_graph_new();
+    a = ccl_graph_add_host(graph, "a", graph_test_host, &calls);
+    b = ccl_graph_add_host(graph, "b", graph_test_host, &calls);
+    ccl_graph_add_edge(graph, a, b);
+    ccl_graph_add_edge(graph, b, a);
+    ccl_graph_instantiate(graph, queues, 1, &err);
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    ccl_err_clear(&err);
+    ccl_graph_destroy(graph);
+
+    /* Release wrappers. */
+    ccl_buffer_destroy(buf);
+    for (cl_uint i = 0; i < 2; ++i)
+        ccl_queue_destroy(queues[i]);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
+/* Number of slots, items and elements per item used to test pipelines. */
+#define CCL_TEST_QUEUE_PIPE_SLOTS 2
+#define CCL_TEST_QUEUE_PIPE_ITEMS 10
+#define CCL_TEST_QUEUE_PIPE_N 16
+
+/**
+ * @internal
+ *
+ * @brief Data shared by the stages of the pipeline test.
+ * */
+struct pipeline_test_data {
+    CCLBuffer * bufs[CCL_TEST_QUEUE_PIPE_SLOTS];
+    cl_uint hin[CCL_TEST_QUEUE_PIPE_SLOTS][CCL_TEST_QUEUE_PIPE_N];
+    cl_uint hout[CCL_TEST_QUEUE_PIPE_SLOTS][CCL_TEST_QUEUE_PIPE_N];
+    cl_uint produced;
+    cl_uint consumed;
+    cl_uint errors;
+};
+
+/**
+ * @internal
+ *
+ * @brief Host stage of the pipeline test, which produces an item.
+ * */
+static cl_int pipeline_test_produce(cl_uint slot, void * user_data) {
+
+    struct pipeline_test_data * td = (struct pipeline_test_data *) user_data;
+
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_PIPE_N; ++i)
+        td->hin[slot][i] = td->produced * CCL_TEST_QUEUE_PIPE_N + i;
+    td->produced++;
+    return CL_COMPLETE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Device stage of the pipeline test, which uploads an item.
+ * */
+static CCLEvent * pipeline_test_upload(
+    CCLQueue * cq, cl_uint slot, void * user_data, CCLErr ** err) {
+
+    struct pipeline_test_data * td = (struct pipeline_test_data *) user_data;
+
+    return ccl_buffer_enqueue_write(td->bufs[slot], cq, CL_FALSE, 0,
+        sizeof(td->hin[slot]), td->hin[slot], NULL, err);
+}
+
+/**
+ * @internal
+ *
+ * @brief Device stage of the pipeline test, which downloads an item.
+ * */
+static CCLEvent * pipeline_test_download(
+    CCLQueue * cq, cl_uint slot, void * user_data, CCLErr ** err) {
+
+    struct pipeline_test_data * td = (struct pipeline_test_data *) user_data;
+
+    return ccl_buffer_enqueue_read(td->bufs[slot], cq, CL_FALSE, 0,
+        sizeof(td->hout[slot]), td->hout[slot], NULL, err);
+}
+
+/**
+ * @internal
+ *
+ * @brief Host stage of the pipeline test, which checks an item.
+ * */
+static cl_int pipeline_test_consume(cl_uint slot, void * user_data) {
+
+    struct pipeline_test_data * td = (struct pipeline_test_data *) user_data;
+
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_PIPE_N; ++i)
+        if (td->hout[slot][i] != td->consumed * CCL_TEST_QUEUE_PIPE_N + i)
+            td->errors++;
+    td->consumed++;
+    return CL_COMPLETE;
+}
+
+/**
+ * @internal
+ *
+ * @brief Tests multi-stage pipelines with host and device stages.
+ * */
+static void pipeline_test() {
+
+#ifndef CL_VERSION_1_1
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 1.1 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * dev = NULL;
+    CCLPipeline * pl = NULL;
+    CCLErr * err = NULL;
+    struct pipeline_test_data td = { { NULL }, { { 0 } }, { { 0 } }, 0, 0, 0 };
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(110, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    dev = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Create one device buffer per slot. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_PIPE_SLOTS; ++i) {
+        td.bufs[i] = ccl_buffer_new(
+            ctx, CL_MEM_READ_WRITE, sizeof(td.hin[i]), NULL, &err);
+        g_assert_no_error(err);
+    }
+
+    /* Create pipeline. */
+    pl = ccl_pipeline_new(ctx, dev, 0, CCL_TEST_QUEUE_PIPE_SLOTS, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(
+        ccl_pipeline_get_num_slots(pl), ==, CCL_TEST_QUEUE_PIPE_SLOTS);
+
+    /* Pushing items into a pipeline without stages is an error. */
+    g_assert_false(ccl_pipeline_push(pl, &err));
+    g_assert_error(err, CCL_ERROR, CCL_ERROR_ARGS);
+    ccl_err_clear(&err);
+
+    /* Add stages, each with its own queue. */
+    ccl_pipeline_add_host_stage(
+        pl, "produce", pipeline_test_produce, &td, &err);
+    g_assert_no_error(err);
+    ccl_pipeline_add_device_stage(
+        pl, "upload", pipeline_test_upload, &td, &err);
+    g_assert_no_error(err);
+    ccl_pipeline_add_device_stage(
+        pl, "download", pipeline_test_download, &td, &err);
+    g_assert_no_error(err);
+    ccl_pipeline_add_host_stage(
+        pl, "consume", pipeline_test_consume, &td, &err);
+    g_assert_no_error(err);
+    g_assert_true(
+        ccl_pipeline_get_queue(pl, 0) != ccl_pipeline_get_queue(pl, 1));
+
+    /* Push items through pipeline, more than there are slots. */
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_PIPE_ITEMS; ++i) {
+        ccl_pipeline_push(pl, &err);
+        g_assert_no_error(err);
+    }
+    ccl_pipeline_finish(pl, &err);
+    g_assert_no_error(err);
+
+    /* Check that all items went through all stages, in order. */
+    g_assert_cmpuint(
+        ccl_pipeline_get_num_items(pl), ==, CCL_TEST_QUEUE_PIPE_ITEMS);
+    g_assert_cmpuint(td.produced, ==, CCL_TEST_QUEUE_PIPE_ITEMS);
+    g_assert_cmpuint(td.consumed, ==, CCL_TEST_QUEUE_PIPE_ITEMS);
+    g_assert_cmpuint(td.errors, ==, 0);
+
+    /* Release wrappers. */
+    ccl_pipeline_destroy(pl);
+    for (cl_uint i = 0; i < CCL_TEST_QUEUE_PIPE_SLOTS; ++i)
+        ccl_buffer_destroy(td.bufs[i]);
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+}
+
 /**
  * @internal
  *
@@ -559,5 +1970,57 @@ int main(int argc, char ** argv) {
         "/wrappers/queue/mult-ooo",
         mult_ooo_test);
 
+    g_test_add_func(
+        "/wrappers/queue/event-capacity",
+        event_capacity_test);
+
+    g_test_add_func(
+        "/wrappers/queue/gc-incremental",
+        gc_incremental_test);
+
+    g_test_add_func(
+        "/wrappers/queue/eventless",
+        eventless_test);
+
+    g_test_add_func(
+        "/wrappers/queue/cmdseq",
+        cmdseq_test);
+
+    g_test_add_func(
+        "/wrappers/queue/host-task",
+        host_task_test);
+
+    g_test_add_func(
+        "/wrappers/queue/scheduler",
+        scheduler_test);
+
+    g_test_add_func(
+        "/wrappers/queue/submitter",
+        submitter_test);
+
+    g_test_add_func(
+        "/wrappers/queue/flush-policy",
+        flush_policy_test);
+
+    g_test_add_func(
+        "/wrappers/queue/elide-sync",
+        elide_sync_test);
+
+    g_test_add_func(
+        "/wrappers/queue/priority",
+        priority_test);
+
+    g_test_add_func(
+        "/wrappers/queue/device-queue",
+        device_queue_test);
+
+    g_test_add_func(
+        "/wrappers/queue/graph",
+        graph_test);
+
+    g_test_add_func(
+        "/wrappers/queue/pipeline",
+        pipeline_test);
+
     return g_test_run();
 }
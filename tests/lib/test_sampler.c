@@ -235,6 +235,66 @@ static void ref_unref_test() {
     g_assert_true(ccl_wrapper_memcheck());
 }
 
+/**
+ * @internal
+ *
+ * @brief Tests the context cache of samplers.
+ * */
+static void cached_test() {
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLSampler * s1 = NULL;
+    CCLSampler * s2 = NULL;
+    CCLSampler * s3 = NULL;
+    CCLErr * err = NULL;
+    const cl_sampler_properties props_full[] = {
+        CL_SAMPLER_FILTER_MODE, CL_FILTER_NEAREST,
+        CL_SAMPLER_NORMALIZED_COORDS, CL_TRUE,
+        CL_SAMPLER_ADDRESSING_MODE, CL_ADDRESS_CLAMP,
+        0};
+    const cl_sampler_properties props_other[] = {
+        CL_SAMPLER_FILTER_MODE, CL_FILTER_LINEAR,
+        0};
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new_with_image_support(0, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Default properties, given implicitly or explicitly and in any
+     * order, yield the same sampler. */
+    s1 = ccl_sampler_new_cached(ctx, NULL, &err);
+    g_assert_no_error(err);
+    s2 = ccl_sampler_new_cached(ctx, props_full, &err);
+    g_assert_no_error(err);
+    g_assert_true(s1 == s2);
+    ccl_sampler_destroy(s2);
+
+    /* Different properties yield a different sampler. */
+    s3 = ccl_sampler_new_cached(ctx, props_other, &err);
+    g_assert_no_error(err);
+    g_assert_true(s1 != s3);
+    g_assert_cmpuint(CL_FILTER_LINEAR, ==, ccl_sampler_get_info_scalar(
+        s3, CL_SAMPLER_FILTER_MODE, cl_filter_mode, &err));
+    g_assert_no_error(err);
+
+    /* Cached samplers are kept by the context. */
+    ccl_sampler_destroy(s1);
+    ccl_sampler_destroy(s3);
+    g_assert_false(ccl_wrapper_memcheck());
+    s2 = ccl_sampler_new_cached(ctx, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_true(s1 == s2);
+    ccl_sampler_destroy(s2);
+
+    /* Destroying the context releases cached samplers. */
+    ccl_context_destroy(ctx);
+
+    /* Confirm that memory allocated by wrappers has been properly freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+}
+
 /**
  * @internal
  *
@@ -259,5 +319,9 @@ int main(int argc, char ** argv) {
         "/wrappers/sampler/ref-unref",
         ref_unref_test);
 
+    g_test_add_func(
+        "/wrappers/sampler/cached",
+        cached_test);
+
     return g_test_run();
 }
@@ -0,0 +1,190 @@
+/*
+ * This file is part of cf4ocl (C Framework for OpenCL).
+ *
+ * cf4ocl is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * cf4ocl is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with cf4ocl. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @internal
+ *
+ * @file
+ * Test the shared virtual memory wrapper and its methods.
+ *
+ * @author Nuno Fachada
+ * @date 2019
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cf4ocl2.h>
+#include "test.h"
+#include "_ccl_defs.h"
+
+#define CCL_TEST_SVM_SIZE 256
+
+#define CCL_TEST_SVM_KERNEL_NAME "test_svm"
+
+#define CCL_TEST_SVM_KERNEL_CONTENT \
+    "__kernel void " CCL_TEST_SVM_KERNEL_NAME "(__global uint * p)\n" \
+    "{\n" \
+    "	int gid = get_global_id(0);\n" \
+    "	p[gid] = p[gid] + 1;\n" \
+    "}\n"
+
+/**
+ * @internal
+ *
+ * @brief Tests SVM allocation, fill, map/unmap, memcpy and use as a
+ * kernel argument.
+ * */
+static void alloc_use_free_test() {
+
+#ifndef CL_VERSION_2_0
+
+    g_test_skip(
+        "Test skipped due to lack of OpenCL 2.0 support.");
+
+#else
+
+    /* Test variables. */
+    CCLContext * ctx = NULL;
+    CCLDevice * d = NULL;
+    CCLQueue * q = NULL;
+    CCLProgram * prg = NULL;
+    CCLKernel * krnl = NULL;
+    CCLSvm * svm = NULL;
+    CCLEvent * evt = NULL;
+    CCLEventWaitList ewl = NULL;
+    CCLErr * err = NULL;
+    cl_device_svm_capabilities svmc;
+    cl_uint * p;
+    cl_uint pattern = 7;
+    cl_uint h_in[CCL_TEST_SVM_SIZE];
+    cl_uint h_out[CCL_TEST_SVM_SIZE];
+    size_t size = CCL_TEST_SVM_SIZE * sizeof(cl_uint);
+    size_t gws = CCL_TEST_SVM_SIZE / 2;
+
+    /* Get the test context with the pre-defined device. */
+    ctx = ccl_test_context_new(200, &err);
+    g_assert_no_error(err);
+    if (!ctx) return;
+
+    /* Get first device in context. */
+    d = ccl_context_get_device(ctx, 0, &err);
+    g_assert_no_error(err);
+
+    /* Skip test if device does not support coarse-grained SVM. */
+    svmc = ccl_device_get_info_scalar(
+        d, CL_DEVICE_SVM_CAPABILITIES, cl_device_svm_capabilities, &err);
+    if ((err != NULL) || !(svmc & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER)) {
+        ccl_err_clear(&err);
+        ccl_context_destroy(ctx);
+        g_test_skip("Test skipped due to lack of SVM support.");
+        return;
+    }
+
+    /* Create a command queue. */
+    q = ccl_queue_new(ctx, d, 0, &err);
+    g_assert_no_error(err);
+
+    /* Allocate SVM memory. */
+    svm = ccl_svm_new(ctx, CL_MEM_READ_WRITE, size, 0, &err);
+    g_assert_no_error(err);
+    g_assert_cmpuint(ccl_svm_get_size(svm), ==, size);
+    g_assert_true(ccl_svm_get_context(svm) == ctx);
+    p = ccl_svm_get_ptr(svm);
+    g_assert_nonnull(p);
+
+    /* Fill SVM memory with pattern. */
+    evt = ccl_svm_enqueue_fill(
+        q, p, &pattern, sizeof(cl_uint), size, NULL, &err);
+    g_assert_no_error(err);
+    g_assert_cmpstr(ccl_event_get_final_name(evt), ==, "SVM_MEMFILL");
+
+    /* Map it and check pattern. */
+    ccl_svm_enqueue_map(q, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, p, size,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_SVM_SIZE; ++i)
+        g_assert_cmpuint(p[i], ==, pattern);
+
+    /* Change data on host. */
+    for (guint i = 0; i < CCL_TEST_SVM_SIZE; ++i)
+        p[i] = i;
+    evt = ccl_svm_enqueue_unmap(q, p, NULL, &err);
+    g_assert_no_error(err);
+
+    /* Increment second half of data with a kernel, passing a pointer
+     * within the allocation. */
+    prg = ccl_program_new_from_source(ctx, CCL_TEST_SVM_KERNEL_CONTENT, &err);
+    g_assert_no_error(err);
+    ccl_program_build(prg, NULL, &err);
+    g_assert_no_error(err);
+    krnl = ccl_program_get_kernel(prg, CCL_TEST_SVM_KERNEL_NAME, &err);
+    g_assert_no_error(err);
+    evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, q, 1, NULL, &gws,
+        NULL, ccl_ewl(&ewl, evt, NULL), &err, ccl_arg_svm(p + gws), NULL);
+    g_assert_no_error(err);
+
+    /* Copy data from SVM to host and check it. */
+    ccl_svm_enqueue_memcpy(q, CL_TRUE, h_out, p, size,
+        ccl_ewl(&ewl, evt, NULL), &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_SVM_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, i < gws ? i : i + 1);
+
+    /* Copy data from host to SVM and back. */
+    for (guint i = 0; i < CCL_TEST_SVM_SIZE; ++i)
+        h_in[i] = g_test_rand_int();
+    ccl_svm_enqueue_memcpy(q, CL_FALSE, p, h_in, size, NULL, &err);
+    g_assert_no_error(err);
+    ccl_svm_enqueue_memcpy(q, CL_TRUE, h_out, p, size, NULL, &err);
+    g_assert_no_error(err);
+    for (guint i = 0; i < CCL_TEST_SVM_SIZE; ++i)
+        g_assert_cmpuint(h_out[i], ==, h_in[i]);
+
+    /* Allocation keeps a reference to context. */
+    ccl_program_destroy(prg);
+    ccl_queue_destroy(q);
+    ccl_context_destroy(ctx);
+    g_assert_false(ccl_wrapper_memcheck());
+
+    /* Free SVM memory, which releases the context. */
+    ccl_svm_destroy(svm);
+
+    /* Confirm that memory allocated by wrappers has been properly
+     * freed. */
+    g_assert_true(ccl_wrapper_memcheck());
+
+#endif
+
+}
+
+/**
+ * @internal
+ *
+ * @brief Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char ** argv) {
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func(
+        "/wrappers/svm/alloc-use-free",
+        alloc_use_free_test);
+
+    return g_test_run();
+}
@@ -301,6 +301,39 @@ teardown() {
 
 }
 
+# Test parallel build for all devices, populating the program cache.
+@test "Build with one source file for all devices" {
+
+    # Temporary folder for program cache
+    CCL_C_TMP_CACHE="@CMAKE_CURRENT_BINARY_DIR@/temp_cache"
+    rm -rf ${CCL_C_TMP_CACHE}
+
+    run ${CCL_C_COM} -s ${CCL_C_K_SUM} -a -c ${CCL_C_TMP_CACHE}
+
+    # Check output
+    [[ "$output" =~  "Device" ]]
+    [[ "$output" =~  "Build status" ]]
+    [[ "$output" =~  "Build time" ]]
+    [[ "$output" =~  "Program cache" ]]
+
+    # There should be no problems
+    [ "$status" -eq 0 ]
+
+    # One build time should be shown per device
+    [ `echo "$output" | grep -c "Build time"` -eq ${CCL_C_NDEVS} ]
+
+    # Check if program cache was populated
+    [ `ls ${CCL_C_TMP_CACHE} | wc -l` -gt 0 ]
+
+    # Parallel builds are only available for the build task
+    run ${CCL_C_COM} -s ${CCL_C_K_SUM} -a -t 1 -c ${CCL_C_TMP_CACHE}
+    [[ "$output" =~  "Error" ]]
+    [ "$status" -ne 0 ]
+
+    rm -rf ${CCL_C_TMP_CACHE}
+
+}
+
 # Test build with source headers.
 @test "Build with source headers" {
 
@@ -388,6 +421,40 @@ teardown() {
 
 }
 
+# Test build option sweep with one source file
+@test "Build option sweep with one source file" {
+
+    run ${CCL_C_COM} -s ${CCL_C_K_SUM} -d ${CCL_TEST_DEVICE_INDEX} \
+        -w "" -w "-cl-fast-relaxed-math" -w "-cl-mad-enable -DUNROLL=4" \
+        -w "-an-incorrect-option"
+
+    # Check output
+    [[ "$output" =~  "Device" ]]
+    [[ "$output" =~  "Options" ]]
+    [[ "$output" =~  "Binary size" ]]
+
+    # One line per variant, three successful builds
+    [ `echo "$output" | grep -c "Options"` -eq 4 ]
+    [ `echo "$output" | grep -c "Build time"` -eq 3 ]
+
+    # One build fails
+    [ "$status" -ne 0 ]
+
+    # Run kernel with two sample sizes
+    run ${CCL_C_COM} -s ${CCL_C_K_SUM} -d ${CCL_TEST_DEVICE_INDEX} \
+        -w "-cl-kernel-arg-info" -r ${CCL_C_K_SUM_NAME} -z 1000 -z 65536
+
+    [ "$status" -eq 0 ]
+    [ `echo "$output" | grep -c "Kernel time"` -eq 2 ]
+
+    # Sample sizes require a kernel to run
+    run ${CCL_C_COM} -s ${CCL_C_K_SUM} -d ${CCL_TEST_DEVICE_INDEX} \
+        -w "" -z 1000
+    [[ "$output" =~  "Error" ]]
+    [ "$status" -ne 0 ]
+
+}
+
 # ################# #
 # Test compile task #
 # ################# #
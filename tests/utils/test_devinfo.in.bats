@@ -164,3 +164,29 @@ setup() {
     [ ${CCL_DI_TOTPNDEVS} -eq ${CCL_DI_NDEVS} ]
 
 }
+
+# Test microbenchmark option on the test device
+@test "Microbenchmark option" {
+
+    run ${CCL_DI_COM} --bench -d ${CCL_TEST_DEVICE_INDEX}
+    [ "$status" -eq 0 ]
+    [[ "$output" =~  "\"devices\"" ]]
+    [[ "$output" =~  "\"fp32_gflops\"" ]]
+    [[ "$output" =~  "\"error\": null" ]]
+
+}
+
+# Test JSON output option (--json option)
+@test "JSON output option (--json option)" {
+
+    run ${CCL_DI_COM} --json
+    [ "$status" -eq 0 ]
+    [[ "$output" =~  "\"platforms\"" ]]
+    [[ "$output" =~  "\"MAX_COMPUTE_UNITS\"" ]]
+
+    run ${CCL_DI_COM} --json -o -a
+    [ "$status" -eq 0 ]
+    [ `echo "$output" | grep -c "\"index\""` -eq ${CCL_DI_NDEVS} ]
+    [[ "$output" =~  "\"NAME\"" ]]
+
+}
@@ -0,0 +1,132 @@
+#!/usr/bin/env bats
+#
+# Test suite for ccl_prof utility
+#
+# Author: Nuno Fachada <faken@fakenmc.com>
+# Licence: GNU General Public License version 3 (GPLv3)
+# Date: 2019
+#
+
+# ##################################### #
+# Setup and teardown for each test case #
+# ##################################### #
+
+setup() {
+
+    # ccl_prof binary
+    CCL_PROF_COM="@CMAKE_BINARY_DIR@/src/utils/ccl_prof"
+
+    # Temporary profile files
+    CCL_PROF_TMP_BASE="@CMAKE_CURRENT_BINARY_DIR@/prof_base.tsv"
+    CCL_PROF_TMP_CURR="@CMAKE_CURRENT_BINARY_DIR@/prof_curr.tsv"
+    CCL_PROF_TMP_BAD="@CMAKE_CURRENT_BINARY_DIR@/prof_bad.tsv"
+    CCL_PROF_TMP_BIN="@CMAKE_CURRENT_BINARY_DIR@/prof_merged.bin"
+
+    # Baseline profile, in the default text export format
+    printf "q0\t100\t200\tKERNEL_A\n"  > ${CCL_PROF_TMP_BASE}
+    printf "q0\t200\t300\tKERNEL_A\n" >> ${CCL_PROF_TMP_BASE}
+    printf "q1\t150\t250\tREAD_B\n"   >> ${CCL_PROF_TMP_BASE}
+
+    # Current profile, where KERNEL_A is twice as slow
+    printf "q0\t100\t300\tKERNEL_A\n"  > ${CCL_PROF_TMP_CURR}
+    printf "q0\t300\t500\tKERNEL_A\n" >> ${CCL_PROF_TMP_CURR}
+    printf "q1\t150\t250\tREAD_B\n"   >> ${CCL_PROF_TMP_CURR}
+
+    # Malformed profile
+    printf "q0\t100\tKERNEL_A\n" > ${CCL_PROF_TMP_BAD}
+
+}
+
+teardown() {
+
+    # Remove temporary files
+    rm -f ${CCL_PROF_TMP_BASE} ${CCL_PROF_TMP_CURR} ${CCL_PROF_TMP_BAD} \
+        ${CCL_PROF_TMP_BIN}
+
+}
+
+# ############ #
+# Test options #
+# ############ #
+
+# Test invocation without arguments
+@test "Invocation without arguments" {
+
+    run ${CCL_PROF_COM}
+    [[ "$output" =~ "No profile files specified" ]]
+    [ "$status" -ne 0 ]
+
+}
+
+# Test help option, which should return status 0.
+@test "Help options" {
+
+    run ${CCL_PROF_COM} -h
+    [[ "$output" =~ "Utility to aggregate and compare exported profiles" ]]
+    [ "$status" -eq 0 ]
+
+}
+
+# Test version, which should return status 0.
+@test "Get version" {
+
+    run ${CCL_PROF_COM} --version
+    [[ "$output" =~ "ccl_prof v" ]]
+    [ "$status" -eq 0 ]
+
+}
+
+# Test merge of two profiles and export to binary format.
+@test "Merge profiles" {
+
+    run ${CCL_PROF_COM} -o ${CCL_PROF_TMP_BIN} \
+        ${CCL_PROF_TMP_BASE} ${CCL_PROF_TMP_CURR}
+    [[ "$output" =~ "Profiles merged           : 2" ]]
+    [[ "$output" =~ "KERNEL_A" ]]
+    [[ "$output" =~ "READ_B" ]]
+    [ "$status" -eq 0 ]
+    [ -s ${CCL_PROF_TMP_BIN} ]
+
+    # Binary profile can be loaded again
+    run ${CCL_PROF_COM} ${CCL_PROF_TMP_BIN}
+    [[ "$output" =~ "KERNEL_A" ]]
+    [ "$status" -eq 0 ]
+
+}
+
+# Test malformed profile.
+@test "Malformed profile" {
+
+    run ${CCL_PROF_COM} ${CCL_PROF_TMP_BAD}
+    [[ "$output" =~ "prof_bad.tsv:1" ]]
+    [ "$status" -ne 0 ]
+
+}
+
+# Test comparison of profiles.
+@test "Compare profiles (--diff option)" {
+
+    # Only two files accepted
+    run ${CCL_PROF_COM} -d ${CCL_PROF_TMP_BASE}
+    [ "$status" -ne 0 ]
+
+    # Regression is highlighted, but exit status is 0 by default
+    run ${CCL_PROF_COM} -d ${CCL_PROF_TMP_BASE} ${CCL_PROF_TMP_CURR}
+    [[ "$output" =~ "REGRESSION" ]]
+    [[ "$output" =~ "Regressions above 5.00%: 1" ]]
+    [ "$status" -eq 0 ]
+
+    # Regression makes program fail with --fail
+    run ${CCL_PROF_COM} -d -f ${CCL_PROF_TMP_BASE} ${CCL_PROF_TMP_CURR}
+    [ "$status" -ne 0 ]
+
+    # No regression when comparing the other way around
+    run ${CCL_PROF_COM} -d -f ${CCL_PROF_TMP_CURR} ${CCL_PROF_TMP_BASE}
+    [[ "$output" =~ "improved" ]]
+    [ "$status" -eq 0 ]
+
+    # No regression with a large enough threshold
+    run ${CCL_PROF_COM} -d -f -t 150 ${CCL_PROF_TMP_BASE} ${CCL_PROF_TMP_CURR}
+    [ "$status" -eq 0 ]
+
+}